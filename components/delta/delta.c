@@ -17,6 +17,7 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 
 #include "esp_partition.h"
 #include "esp_ota_ops.h"
@@ -132,14 +133,10 @@ static int delta_flash_seek_src(void *arg_p, int offset)
     return DELTA_OK;
 }
 
-static int delta_init_flash_mem(flash_mem_t *flash, const delta_opts_t *opts)
+static int delta_init_src_dest(flash_mem_t *flash, int is_full_update)
 {
-    if (!flash) {
-        return -DELTA_PARTITION_ERROR;
-    }
-
     // For full updates, we don't need a source partition (install from scratch)
-    if (opts->is_full_update) {
+    if (is_full_update) {
         flash->src = NULL;  // No source for full updates
     } else {
         flash->src = esp_ota_get_running_partition();
@@ -154,13 +151,29 @@ static int delta_init_flash_mem(flash_mem_t *flash, const delta_opts_t *opts)
     }
     
     flash->dest = esp_ota_get_next_update_partition(NULL);
-    flash->patch = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, opts->patch);
+    if (flash->dest == NULL || flash->dest->subtype >= ESP_PARTITION_SUBTYPE_APP_OTA_MAX) {
+        return -DELTA_PARTITION_ERROR;
+    }
 
-    if (flash->dest == NULL || flash->patch == NULL) {
+    flash->src_offset = 0;
+    flash->patch_offset = 0;
+
+    return DELTA_OK;
+}
+
+static int delta_init_flash_mem(flash_mem_t *flash, const delta_opts_t *opts)
+{
+    if (!flash) {
         return -DELTA_PARTITION_ERROR;
     }
 
-    if (flash->dest->subtype >= ESP_PARTITION_SUBTYPE_APP_OTA_MAX) {
+    int ret = delta_init_src_dest(flash, opts->is_full_update);
+    if (ret) {
+        return ret;
+    }
+
+    flash->patch = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, opts->patch);
+    if (flash->patch == NULL) {
         return -DELTA_PARTITION_ERROR;
     }
 
@@ -169,9 +182,6 @@ static int delta_init_flash_mem(flash_mem_t *flash, const delta_opts_t *opts)
     }
     esp_log_level_set("esp_image", ESP_LOG_ERROR);
 
-    flash->src_offset = 0;
-    flash->patch_offset = 0;
-
     return DELTA_OK;
 }
 
@@ -189,6 +199,36 @@ static int delta_set_boot_partition(flash_mem_t *flash)
     return DELTA_OK;
 }
 
+/* Patch partition writer: sector-sized writes, the region erased a block at a time ahead of them */
+static int delta_partition_flush(delta_partition_writer_t *writer)
+{
+    const esp_partition_t *patch = (const esp_partition_t *)writer->patch;
+
+    if (writer->buf_len == 0) {
+        return ESP_OK;
+    }
+    if (writer->offset + writer->buf_len > writer->erased) {
+        /* Up to the next 64 KB boundary; a resumed writer starts mid-block */
+        int erase_len = 16 * PARTITION_PAGE_SIZE - writer->erased % (16 * PARTITION_PAGE_SIZE);
+        if (writer->erased + erase_len > (int)patch->size) {
+            erase_len = patch->size - writer->erased;
+        }
+        if (esp_partition_erase_range(patch, writer->erased, erase_len) != ESP_OK) {
+            ESP_LOGE(TAG, "Partition Error: Could not erase '%s' region!", writer->name);
+            return ESP_FAIL;
+        }
+        writer->erased += erase_len;
+    }
+    if (esp_partition_write(patch, writer->offset, writer->buf, writer->buf_len) != ESP_OK) {
+        ESP_LOGE(TAG, "Partition Error: Could not write to '%s' region!", writer->name);
+        return ESP_FAIL;
+    }
+
+    writer->offset += writer->buf_len;
+    writer->buf_len = 0;
+    return ESP_OK;
+}
+
 int delta_partition_init(delta_partition_writer_t *writer, const char *partition, int patch_size)
 {
     if (writer == NULL || partition == NULL) {
@@ -201,40 +241,99 @@ int delta_partition_init(delta_partition_writer_t *writer, const char *partition
         ESP_LOGE(TAG, "Partition Error: Could not find '%s' partition", partition);
         return ESP_FAIL;
     }
+    if (patch_size <= 0 || patch_size > (int)patch->size) {
+        return -DELTA_OUT_OF_BOUNDS_ERROR;
+    }
 
-    size_t patch_page_size = (patch_size + PARTITION_PAGE_SIZE) - (patch_size % PARTITION_PAGE_SIZE);
-    if (esp_partition_erase_range(patch, 0, patch_page_size) != ESP_OK) {
-        ESP_LOGE(TAG, "Partition Error: Could not erase '%s' region!", partition);
-        return ESP_FAIL;
+    writer->buf = malloc(PARTITION_PAGE_SIZE);
+    if (writer->buf == NULL) {
+        return -DELTA_OUT_OF_MEMORY;
     }
 
     writer->name = partition;
     writer->patch = patch;
     writer->size = patch_size;
     writer->offset = 0;
+    writer->erased = 0;
+    writer->buf_len = 0;
 
     return ESP_OK;
 }
 
 int delta_partition_write(delta_partition_writer_t *writer, const char *buf, int size)
 {
-    if (writer == NULL || buf == NULL) {
+    if (writer == NULL || buf == NULL || writer->buf == NULL) {
         return -DELTA_INVALID_ARGUMENT_ERROR;
     }
 
-    if (writer->offset >= writer->size) {
+    if (writer->offset + writer->buf_len + size > writer->size) {
         return -DELTA_OUT_OF_BOUNDS_ERROR;
     }
 
-    if (esp_partition_write(writer->patch, writer->offset, buf, size) != ESP_OK) {
-        ESP_LOGE(TAG, "Partition Error: Could not write to '%s' region!", writer->name);
-        return ESP_FAIL;
-    };
+    while (size > 0) {
+        int n = PARTITION_PAGE_SIZE - writer->buf_len;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(writer->buf + writer->buf_len, buf, n);
+        writer->buf_len += n;
+        buf += n;
+        size -= n;
+
+        if (writer->buf_len == PARTITION_PAGE_SIZE && delta_partition_flush(writer) != ESP_OK) {
+            return ESP_FAIL;
+        }
+    }
+
+    return ESP_OK;
+}
+
+int delta_partition_resume(delta_partition_writer_t *writer, const char *partition, int patch_size, int offset)
+{
+    if (offset < 0 || offset % PARTITION_PAGE_SIZE) {
+        return -DELTA_INVALID_ARGUMENT_ERROR;
+    }
+
+    int ret = delta_partition_init(writer, partition, patch_size);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (offset > patch_size) {
+        delta_partition_finish(writer);
+        return -DELTA_OUT_OF_BOUNDS_ERROR;
+    }
+
+    // Sectors past offset may already hold bytes written after the checkpoint (a later batch,
+    // or the partial sector flushed when the writer closed): erase them again from offset on
+    writer->offset = offset;
+    writer->erased = offset;
+    return ESP_OK;
+}
+
+int delta_partition_read(delta_partition_writer_t *writer, int offset, char *buf, int size)
+{
+    if (writer == NULL || buf == NULL || offset < 0 || offset + size > writer->offset) {
+        return -DELTA_INVALID_ARGUMENT_ERROR;
+    }
 
-    writer->offset += size;
+    if (esp_partition_read((const esp_partition_t *)writer->patch, offset, buf, size) != ESP_OK) {
+        return -DELTA_READING_PATCH_ERROR;
+    }
     return ESP_OK;
 }
 
+int delta_partition_finish(delta_partition_writer_t *writer)
+{
+    if (writer == NULL || writer->buf == NULL) {
+        return -DELTA_INVALID_ARGUMENT_ERROR;
+    }
+
+    int ret = delta_partition_flush(writer);
+    free(writer->buf);
+    writer->buf = NULL;
+    return ret;
+}
+
 int delta_check_and_apply(int patch_size, const delta_opts_t *opts)
 {
     static const delta_opts_t DEFAULT_DELTA_OPTS = {
@@ -284,6 +383,190 @@ int delta_check_and_apply(int patch_size, const delta_opts_t *opts)
     return 0;
 }
 
+/* Streaming apply: detools emits at most 128 bytes per write, collect a sector per flash write */
+#define DELTA_STREAM_WRITE_BUF_SIZE PARTITION_PAGE_SIZE
+/* Erase a 64 KB block at a time ahead of the writes: one block erase instead of sixteen sector erases */
+#define DELTA_STREAM_ERASE_AHEAD_SIZE (16 * PARTITION_PAGE_SIZE)
+/* Flash encryption writes in 16 byte units; the tail is padded with erased bytes */
+#define DELTA_STREAM_WRITE_ALIGN 16
+
+struct delta_stream {
+    flash_mem_t flash;              /* First member: the source callbacks take the stream as flash_mem_t */
+    struct detools_apply_patch_t apply;
+    size_t write_len;
+    size_t write_offset;            /* Image bytes already in the destination */
+    size_t erased_end;              /* Destination erased up to here */
+    delta_stream_stats_t stats;
+    uint8_t write_buf[DELTA_STREAM_WRITE_BUF_SIZE];
+};
+
+static uint32_t delta_elapsed_us(int64_t start_us)
+{
+    return (uint32_t)(esp_timer_get_time() - start_us);
+}
+
+static int delta_stream_flush_sector(delta_stream_t *stream)
+{
+    const esp_partition_t *dest = stream->flash.dest;
+    size_t len = stream->write_len;
+
+    if (len == 0) {
+        return DELTA_OK;
+    }
+    if (len % DELTA_STREAM_WRITE_ALIGN) {
+        size_t padding = DELTA_STREAM_WRITE_ALIGN - (len % DELTA_STREAM_WRITE_ALIGN);
+        memset(stream->write_buf + len, 0xFF, padding);
+        len += padding;
+    }
+    if (stream->write_offset + len > dest->size) {
+        return -DELTA_OUT_OF_MEMORY;
+    }
+
+    if (stream->write_offset + len > stream->erased_end) {
+        size_t erase_len = DELTA_STREAM_ERASE_AHEAD_SIZE;
+        if (stream->erased_end + erase_len > dest->size) {
+            erase_len = dest->size - stream->erased_end;
+        }
+        int64_t erase_start_us = esp_timer_get_time();
+        if (esp_partition_erase_range(dest, stream->erased_end, erase_len) != ESP_OK) {
+            return -DELTA_CLEARING_ERROR;
+        }
+        stream->stats.erase_us += delta_elapsed_us(erase_start_us);
+        stream->erased_end += erase_len;
+    }
+
+    int64_t write_start_us = esp_timer_get_time();
+    if (esp_partition_write(dest, stream->write_offset, stream->write_buf, len) != ESP_OK) {
+        return -DELTA_WRITING_ERROR;
+    }
+    stream->stats.write_us += delta_elapsed_us(write_start_us);
+    stream->stats.image_bytes += stream->write_len;
+
+    stream->write_offset += len;
+    stream->write_len = 0;
+    return DELTA_OK;
+}
+
+static int delta_stream_write_dest(void *arg_p, const uint8_t *buf_p, size_t size)
+{
+    delta_stream_t *stream = (delta_stream_t *)arg_p;
+
+    if (!stream) {
+        return -DELTA_CASTING_ERROR;
+    }
+
+    while (size > 0) {
+        size_t n = DELTA_STREAM_WRITE_BUF_SIZE - stream->write_len;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(stream->write_buf + stream->write_len, buf_p, n);
+        stream->write_len += n;
+        buf_p += n;
+        size -= n;
+
+        if (stream->write_len == DELTA_STREAM_WRITE_BUF_SIZE) {
+            int ret = delta_stream_flush_sector(stream);
+            if (ret) {
+                return ret;
+            }
+        }
+    }
+
+    return DELTA_OK;
+}
+
+int delta_stream_begin(delta_stream_t **stream_pp, int patch_size, int is_full_update)
+{
+    if (stream_pp == NULL || patch_size <= 0) {
+        return -DELTA_INVALID_ARGUMENT_ERROR;
+    }
+
+    delta_stream_t *stream = calloc(1, sizeof(delta_stream_t));
+    if (!stream) {
+        return -DELTA_OUT_OF_MEMORY;
+    }
+
+    int ret = delta_init_src_dest(&stream->flash, is_full_update);
+    if (ret) {
+        free(stream);
+        return ret;
+    }
+
+    // The destination is written sector by sector with esp_partition_write() and erased
+    // block by block ahead of it; esp_ota_set_boot_partition() validates the image at the end
+    esp_log_level_set("esp_image", ESP_LOG_ERROR);
+
+    detools_apply_patch_init(&stream->apply,
+                             delta_flash_read_src,
+                             delta_flash_seek_src,
+                             (size_t) patch_size,
+                             delta_stream_write_dest,
+                             stream);
+
+    ESP_LOGI(TAG, "Streaming %s update of %d bytes", is_full_update ? "full" : "delta", patch_size);
+    *stream_pp = stream;
+    return DELTA_OK;
+}
+
+int delta_stream_write(delta_stream_t *stream_p, const char *buf, int size)
+{
+    if (stream_p == NULL || buf == NULL || size <= 0) {
+        return -DELTA_INVALID_ARGUMENT_ERROR;
+    }
+
+    // Decode time is what the call took less the flash work done from inside it
+    uint32_t flash_us = stream_p->stats.erase_us + stream_p->stats.write_us;
+    int64_t start_us = esp_timer_get_time();
+    int ret = detools_apply_patch_process(&stream_p->apply, (const uint8_t *)buf, (size_t) size);
+    flash_us = stream_p->stats.erase_us + stream_p->stats.write_us - flash_us;
+    stream_p->stats.apply_us += delta_elapsed_us(start_us) - flash_us;
+    stream_p->stats.patch_bytes += size;
+    return ret;
+}
+
+int delta_stream_finish(delta_stream_t *stream_p, delta_stream_stats_t *stats_out)
+{
+    if (stream_p == NULL) {
+        return -DELTA_INVALID_ARGUMENT_ERROR;
+    }
+
+    int ret = detools_apply_patch_finalize(&stream_p->apply);
+    if (ret < 0) {
+        delta_stream_abort(stream_p);
+        return ret;
+    }
+
+    ret = delta_stream_flush_sector(stream_p);
+    if (ret) {
+        delta_stream_abort(stream_p);
+        return ret;
+    }
+
+    // Validates the image before it switches the boot partition
+    int64_t verify_start_us = esp_timer_get_time();
+    esp_err_t err = esp_ota_set_boot_partition(stream_p->flash.dest);
+    stream_p->stats.verify_us = delta_elapsed_us(verify_start_us);
+    if (stats_out) {
+        *stats_out = stream_p->stats;
+    }
+    free(stream_p);
+    if (err != ESP_OK) {
+        return -DELTA_TARGET_IMAGE_ERROR;
+    }
+
+    ESP_LOGI(TAG, "Patch Successful!!!");
+    return DELTA_OK;
+}
+
+void delta_stream_abort(delta_stream_t *stream_p)
+{
+    if (stream_p == NULL) {
+        return;
+    }
+    free(stream_p);
+}
+
 const char *delta_error_as_string(int error)
 {
     if (error < 28) {
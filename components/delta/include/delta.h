@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 /* PARTITION LABELS */
 #define DEFAULT_PARTITION_LABEL_SRC "factory"
 #define DEFAULT_PARTITION_LABEL_DEST "ota_0"
@@ -49,14 +51,98 @@ typedef struct {
 typedef struct {
     const char *name;
     const void *patch;
-    int offset;
+    int offset;         /* Bytes in flash */
     int size;
+    int erased;         /* Partition erased up to here */
+    uint8_t *buf;       /* One sector, flushed when full */
+    int buf_len;
 } delta_partition_writer_t;
 
+/**
+ * Prepares a patch partition for patch_size bytes. Nothing is
+ * erased yet: writes are collected into sectors and the partition
+ * is erased a 64 KB block at a time ahead of them.
+ *
+ * @return ESP_OK or an error code.
+ */
 int delta_partition_init(delta_partition_writer_t *writer, const char *partition, int patch_size);
 
 int delta_partition_write(delta_partition_writer_t *writer, const char *buf, int size);
 
+/**
+ * Prepares to continue writing a patch partition at offset (a
+ * sector boundary), keeping the offset bytes already written.
+ * Everything after offset is erased again before it is rewritten.
+ *
+ * @return ESP_OK or an error code.
+ */
+int delta_partition_resume(delta_partition_writer_t *writer, const char *partition, int patch_size, int offset);
+
+/**
+ * Reads back patch bytes that are already in flash (below
+ * writer->offset).
+ *
+ * @return ESP_OK or a negative error code.
+ */
+int delta_partition_read(delta_partition_writer_t *writer, int offset, char *buf, int size);
+
+/**
+ * Writes the last partial sector and releases the buffer.
+ *
+ * @return ESP_OK or an error code.
+ */
+int delta_partition_finish(delta_partition_writer_t *writer);
+
+/* Where a streaming apply spent its time, for throughput (bytes per µs per phase) */
+typedef struct {
+    uint32_t patch_bytes;       /* Patch bytes decoded */
+    uint32_t image_bytes;       /* Image bytes written */
+    uint32_t apply_us;          /* Patch decoding and source reads, flash writes excluded */
+    uint32_t erase_us;
+    uint32_t write_us;
+    uint32_t verify_us;         /* Image validation and boot switch in delta_stream_finish() */
+} delta_stream_stats_t;
+
+typedef struct delta_stream delta_stream_t;
+
+/**
+ * Starts applying a patch while it is received: the patch goes
+ * straight to the next OTA partition, with no copy in the patch
+ * partition. The image is written a sector at a time, and the
+ * destination is erased a 64 KB block at a time ahead of it. A full update is a patch against an empty source.
+ *
+ * @param[out] stream_pp the new stream.
+ * @param[in] patch_size size of the whole patch.
+ * @param[in] is_full_update 1 to patch against zeros instead of
+ * the running partition.
+ *
+ * @return zero(0) or a negative error code.
+ */
+int delta_stream_begin(delta_stream_t **stream_pp, int patch_size, int is_full_update);
+
+/**
+ * Applies the next piece of the patch.
+ *
+ * @return zero(0) or a negative error code.
+ */
+int delta_stream_write(delta_stream_t *stream_p, const char *buf, int size);
+
+/**
+ * Completes the patch, validates the new image and makes it the
+ * boot partition. The stream is freed either way.
+ *
+ * @param[out] stats_out time per phase of the whole apply, or NULL.
+ * Filled once the image is written, whether or not it validates.
+ *
+ * @return zero(0) or a negative error code.
+ */
+int delta_stream_finish(delta_stream_t *stream_p, delta_stream_stats_t *stats_out);
+
+/**
+ * Drops a stream; the boot partition is left as it was.
+ */
+void delta_stream_abort(delta_stream_t *stream_p);
+
 /**
  * Checks if there is patch in the patch partition
  * and applies that patch if it exists. Then restarts
@@ -0,0 +1,2 @@
+#define GIT_COMMIT_ID "x"
+#define GIT_BRANCH "x"
@@ -40,7 +40,7 @@
  * - LV_STDLIB_RTTHREAD:    RT-Thread implementation
  * - LV_STDLIB_CUSTOM:      Implement the functions externally
  */
-#define LV_USE_STDLIB_MALLOC    LV_STDLIB_CLIB
+#define LV_USE_STDLIB_MALLOC    LV_STDLIB_BUILTIN
 
 /** Possible values
  * - LV_STDLIB_BUILTIN:     LVGL's built in implementation
@@ -69,17 +69,18 @@
 
 #if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
     /** Size of memory available for `lv_malloc()` in bytes (>= 2kB) */
-    #define LV_MEM_SIZE (96U * 1024U)          /**< [bytes] */
+    #define LV_MEM_SIZE (256U * 1024U)          /**< [bytes] */
 
     /** Size of the memory expand for `lv_malloc()` in bytes */
-    #define LV_MEM_POOL_EXPAND_SIZE 0
+    #define LV_MEM_POOL_EXPAND_SIZE (64U * 1024U)
 
     /** Set an address for the memory pool instead of allocating it as a normal array. Can be in external SRAM too. */
     #define LV_MEM_ADR 0     /**< 0: unused*/
     /* Instead of an address give a memory allocator that will be called to get a memory pool for LVGL. E.g. my_malloc */
     #if LV_MEM_ADR == 0
-        #undef LV_MEM_POOL_INCLUDE
-        #undef LV_MEM_POOL_ALLOC
+        /* TLSF pool and its expansions come from PSRAM; draw buffers are allocated by DisplayManager */
+        #define LV_MEM_POOL_INCLUDE "lv_mem_pool_psram.h"
+        #define LV_MEM_POOL_ALLOC   lv_mem_pool_psram_alloc
     #endif
 #endif  /*LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN*/
 
@@ -107,7 +108,7 @@
  * - LV_OS_MQX
  * - LV_OS_SDL2
  * - LV_OS_CUSTOM */
-#define LV_USE_OS   LV_OS_NONE
+#define LV_USE_OS   LV_OS_FREERTOS
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -118,7 +119,9 @@
      * than unblocking a task using an intermediary object such as a binary semaphore.
      * RTOS task notifications can only be used when there is only one task that can be the recipient of the event.
      */
-    #define LV_USE_FREERTOS_TASK_NOTIFY 1
+    /* 0: the UI task's notification value carries job and wake bits (SYS_UI_WAKE_NOTIFY_BIT),
+     * so LVGL's draw sync must use its own semaphores */
+    #define LV_USE_FREERTOS_TASK_NOTIFY 0
 #endif
 
 /*========================
@@ -163,7 +166,8 @@
  * Make sure the priority value aligns with the OS-specific priority levels.
  * On systems with limited priority levels (e.g., FreeRTOS), a higher value can improve
  * rendering performance but might cause other tasks to starve. */
-#define LV_DRAW_THREAD_PRIO LV_THREAD_PRIO_HIGH
+/* MID maps below GrindControl/WeightSampling; LVGL's threads are not pinned to a core */
+#define LV_DRAW_THREAD_PRIO LV_THREAD_PRIO_MID
 
 #define LV_USE_DRAW_SW 1
 #if LV_USE_DRAW_SW == 1
@@ -192,7 +196,9 @@
     /** Set number of draw units.
      * - > 1 requires operating system to be enabled in `LV_USE_OS`.
      * - > 1 means multiple threads will render the screen in parallel. */
-    #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #ifndef LV_DRAW_SW_DRAW_UNIT_CNT
+        #define LV_DRAW_SW_DRAW_UNIT_CNT    1   /* 2: render on both cores; override with -D to compare */
+    #endif
 
     /** Use Arm-2D to accelerate software (sw) rendering. */
     #define LV_USE_DRAW_ARM2D_SYNC      0
@@ -215,7 +221,7 @@
          * The circumference of 1/4 circle are saved for anti-aliasing.
          * `radius * 4` bytes are used per circle (the most often used radiuses are saved).
          * - 0: disables caching */
-        #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
+        #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 8
     #endif
 
     #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_NONE
@@ -453,11 +459,11 @@
  * If size is not set to 0, the decoder will fail to decode when the cache is full.
  * If size is 0, the cache function is not enabled and the decoded memory will be
  * released immediately after use. */
-#define LV_CACHE_DEF_SIZE       0
+#define LV_CACHE_DEF_SIZE       (64U * 1024U)   /* Decoded images, held in the PSRAM pool */
 
 /** Default number of image header cache entries. The cache is used to store the headers of images
  * The main logic is like `LV_CACHE_DEF_SIZE` but for image headers. */
-#define LV_IMAGE_HEADER_CACHE_DEF_CNT 0
+#define LV_IMAGE_HEADER_CACHE_DEF_CNT 16
 
 /** Number of stops allowed per gradient. Increase this to allow more stops.
  * This adds (sizeof(lv_color_t) + 1) bytes per additional stop. */
@@ -1013,10 +1019,10 @@
 #define LV_USE_SNAPSHOT 0
 
 /** 1: Enable system monitor component */
-#define LV_USE_SYSMON   0
+#define LV_USE_SYSMON   1
 #if LV_USE_SYSMON
     /** Get the idle percentage. E.g. uint32_t my_get_idle(void); */
-    #define LV_SYSMON_GET_IDLE lv_os_get_idle_percent
+    #define LV_SYSMON_GET_IDLE lv_timer_get_idle
 
     /** 1: Show CPU usage and FPS count.
      * - Requires `LV_USE_SYSMON = 1` */
@@ -1031,7 +1037,7 @@
     /** 1: Show used memory and memory fragmentation.
      * - Requires `LV_USE_STDLIB_MALLOC = LV_STDLIB_BUILTIN`
      * - Requires `LV_USE_SYSMON = 1`*/
-    #define LV_USE_MEM_MONITOR 0
+    #define LV_USE_MEM_MONITOR 1   /* Size LV_MEM_SIZE from its peak "used" figure */
     #if LV_USE_MEM_MONITOR
         #define LV_USE_MEM_MONITOR_POS LV_ALIGN_BOTTOM_LEFT
     #endif
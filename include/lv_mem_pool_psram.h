@@ -0,0 +1,15 @@
+/**
+ * PSRAM backing for LVGL's built-in TLSF heap (LV_MEM_POOL_ALLOC in lv_conf.h).
+ * Included from LVGL's C sources, so keep it plain C.
+ */
+#ifndef LV_MEM_POOL_PSRAM_H
+#define LV_MEM_POOL_PSRAM_H
+
+#include <stddef.h>
+#include <esp_heap_caps.h>
+
+static inline void* lv_mem_pool_psram_alloc(size_t size) {
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
+
+#endif /*LV_MEM_POOL_PSRAM_H*/
@@ -1,8 +1,11 @@
 #include "data_stream.h"
 #include "../logging/grind_logging.h"
+#include "../logging/grind_log_layout.h"
 #include "../config/constants.h"
+#include "../system/memory_arena.h"
 #include <Arduino.h>
 #include <LittleFS.h>
+#include <esp_heap_caps.h>
 
 extern GrindLogger grind_logger;
 
@@ -10,7 +13,25 @@ DataStreamManager::DataStreamManager()
     : current_session_id(0)
     , file_bytes_sent(0)
     , file_total_size(0)
-    , file_stream_active(false) {
+    , file_stream_active(false)
+    , query_reply(nullptr)
+    , batch_stage(BatchStage::IDLE)
+    , batch_next_id(0)
+    , batch_resume_id(0)
+    , batch_resume_offset(0)
+    , batch_crc(0)
+    , batch_session_count(0)
+    , batch_frame{}
+    , batch_frame_size(0)
+    , batch_frame_pos(0)
+    , batch_final_frame(false)
+    , batch_padding(false)
+    , batch_ids(nullptr)
+    , batch_id_count(0)
+    , compressed(false)
+    , raw_complete(false)
+    , compressed_header{}
+    , compressed_header_pos(0) {
 }
 
 DataStreamManager::~DataStreamManager() {
@@ -25,76 +46,32 @@ void DataStreamManager::close_stream() {
     if (file_stream_active) {
         LOG_BLE("DataStream: Closing file stream\n");
     }
-    if (active_file) {
-        active_file.close();
-    }
+    active_reader.close();
+    heap_caps_free(query_reply);
+    query_reply = nullptr;
+    heap_caps_free(batch_ids);
+    batch_ids = nullptr;
+    batch_id_count = 0;
     file_stream_active = false;
     current_session_id = 0;
     file_bytes_sent = 0;
     file_total_size = 0;
+    batch_stage = BatchStage::IDLE;
+    batch_frame_size = 0;
+    batch_frame_pos = 0;
+    compressed = false;
+    raw_complete = false;
 }
 
 uint32_t DataStreamManager::get_session_list(uint32_t* session_ids, uint32_t max_sessions) {
-    uint32_t total_sessions = grind_logger.count_sessions_in_flash();
-    if (total_sessions == 0 || !session_ids) {
-        return 0;
-    }
-    
-    // Reuse the session list logic from export_sessions_binary_chunk
-    uint32_t* session_list = (uint32_t*)heap_caps_malloc(total_sessions * sizeof(uint32_t), MALLOC_CAP_8BIT);
-    if (!session_list) {
-        LOG_BLE("ERROR: Failed to allocate session list memory\n");
+    if (!session_ids) {
         return 0;
     }
     
-    uint32_t list_count = 0;
-    
-    // Try individual session files first (new approach)
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File file = dir.openNextFile();
-            while (file && list_count < total_sessions) {
-                String filename = file.name();
-                bool is_session_file = (filename.startsWith("session_") || filename.indexOf("/session_") != -1)
-                                       && filename.endsWith(".bin");
-                if (is_session_file) {
-                    // Extract session ID from filename
-                    int start_pos = filename.indexOf('_') + 1;
-                    int end_pos = filename.lastIndexOf('.');
-                    if (start_pos > 0 && end_pos > start_pos) {
-                        uint32_t session_id = filename.substring(start_pos, end_pos).toInt();
-                        if (session_id > 0) {
-                            session_list[list_count++] = session_id;
-                        }
-                    }
-                }
-                file = dir.openNextFile();
-            }
-            dir.close();
-        }
-    }
-    
-    // Sort session IDs for consistent order
-    for (uint32_t i = 0; i < list_count - 1; i++) {
-        for (uint32_t j = i + 1; j < list_count; j++) {
-            if (session_list[i] > session_list[j]) {
-                uint32_t temp = session_list[i];
-                session_list[i] = session_list[j];
-                session_list[j] = temp;
-            }
-        }
-    }
-    
-    // Copy results to output array
-    uint32_t copy_count = (list_count < max_sessions) ? list_count : max_sessions;
-    for (uint32_t i = 0; i < copy_count; i++) {
-        session_ids[i] = session_list[i];
-    }
-    
-    heap_caps_free(session_list);
+    // The session index keeps finalized sessions sorted, so no directory walk is needed
+    uint32_t list_count = grind_logger.get_session_ids(session_ids, max_sessions);
     LOG_BLE("DataStream: Found %lu session files\n", list_count);
-    return copy_count;
+    return list_count;
 }
 
 bool DataStreamManager::initialize_file_stream(uint32_t session_id) {
@@ -104,24 +81,62 @@ bool DataStreamManager::initialize_file_stream(uint32_t session_id) {
     current_session_id = session_id;
     file_bytes_sent = 0;
 
+    // Session files or the session log partition, whichever holds the sessions
+    if (!grind_logger.open_session(session_id, &active_reader)) {
+        LOG_BLE("ERROR: Failed to open session %lu\n", session_id);
+        return false;
+    }
+
     // Get file size to estimate total transfer
-    char filename[64];
-    snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_id);
+    file_total_size = active_reader.size();
+    LOG_BLE("DataStream: Initialized file stream for session %lu (%lu bytes)\n", session_id, file_total_size);
+    file_stream_active = true;
+    return true;
+}
+
+bool DataStreamManager::initialize_query_stream(const SessionQuery& query) {
+    close_stream();
 
-    if (!LittleFS.exists(filename)) {
-        LOG_BLE("ERROR: Session file %s does not exist\n", filename);
+    uint32_t limit = session_query_limit(query);
+    size_t capacity = sizeof(SessionQueryReplyHeader) + limit * sizeof(SessionQueryRecord);
+    query_reply = (uint8_t*)heap_caps_malloc(capacity, MALLOC_CAP_SPIRAM);
+    if (!query_reply) {
+        LOG_BLE("ERROR: Failed to allocate a %lu byte session query reply\n", (unsigned long)capacity);
         return false;
     }
 
-    active_file = LittleFS.open(filename, "r");
-    if (!active_file) {
-        LOG_BLE("ERROR: Failed to open session file %s\n", filename);
+    SessionQueryReplyHeader header = {};
+    uint32_t count = run_session_query(query, (SessionQueryRecord*)(query_reply + sizeof(header)), limit,
+                                       &header.matched);
+    header.magic = SESSION_QUERY_MAGIC;
+    header.version = SESSION_QUERY_VERSION;
+    header.record_size = sizeof(SessionQueryRecord);
+    header.count = (uint16_t)count;
+    memcpy(query_reply, &header, sizeof(header));
+
+    file_total_size = sizeof(header) + count * sizeof(SessionQueryRecord);
+    file_bytes_sent = 0;
+    file_stream_active = true;
+    LOG_BLE("DataStream: Session query matched %lu sessions, replying with %lu\n",
+            (unsigned long)header.matched, (unsigned long)count);
+    return true;
+}
+
+bool DataStreamManager::initialize_layout_stream() {
+    close_stream();
+
+    size_t capacity = grind_log_layout_size();
+    query_reply = (uint8_t*)heap_caps_malloc(capacity, MALLOC_CAP_SPIRAM);
+    if (!query_reply) {
+        LOG_BLE("ERROR: Failed to allocate a %lu byte log layout reply\n", (unsigned long)capacity);
         return false;
     }
 
-    file_total_size = active_file.size();
-    LOG_BLE("DataStream: Initialized file stream for session %lu (%lu bytes)\n", session_id, file_total_size);
+    file_total_size = write_grind_log_layout(query_reply, capacity);
+    file_bytes_sent = 0;
     file_stream_active = true;
+    LOG_BLE("DataStream: Log layout for schema %u (%lu bytes)\n", GRIND_LOG_SCHEMA_VERSION,
+            (unsigned long)file_total_size);
     return true;
 }
 
@@ -130,14 +145,26 @@ bool DataStreamManager::read_file_chunk(uint8_t* buffer, size_t buffer_size, siz
         return false;
     }
 
-    if (!active_file) {
+    if (query_reply) {
+        size_t n = file_total_size - file_bytes_sent;
+        n = n < buffer_size ? n : buffer_size;
+        memcpy(buffer, query_reply + file_bytes_sent, n);
+        file_bytes_sent += n;
+        *actual_size = n;
+        if (file_bytes_sent >= file_total_size) {
+            file_stream_active = false;
+        }
+        return n > 0;
+    }
+
+    if (!active_reader.is_open()) {
         LOG_BLE("ERROR: Active file handle missing for session %lu\n", current_session_id);
         file_stream_active = false;
         return false;
     }
 
-    // Read next chunk at current file position
-    size_t bytes_read = active_file.read(buffer, buffer_size);
+    // Read next chunk where the previous one ended
+    size_t bytes_read = active_reader.read_bytes(file_bytes_sent, buffer, buffer_size);
 
     if (bytes_read > 0) {
         file_bytes_sent += bytes_read;
@@ -146,7 +173,7 @@ bool DataStreamManager::read_file_chunk(uint8_t* buffer, size_t buffer_size, siz
         // Check if file is complete
         if (file_bytes_sent >= file_total_size) {
             LOG_BLE("DataStream: Completed file stream for session %lu\n", current_session_id);
-            active_file.close();
+            active_reader.close();
             file_stream_active = false;
         }
 
@@ -155,7 +182,7 @@ bool DataStreamManager::read_file_chunk(uint8_t* buffer, size_t buffer_size, siz
 
     // No more data
     LOG_BLE("DataStream: End of file stream for session %lu\n", current_session_id);
-    active_file.close();
+    active_reader.close();
     file_stream_active = false;
     return false;
 }
@@ -171,3 +198,266 @@ uint8_t DataStreamManager::get_progress_percent() const {
     // Ensure we don't exceed 100%
     return (progress > 100) ? 100 : static_cast<uint8_t>(progress);
 }
+
+namespace {
+void put_u32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+} // namespace
+
+bool DataStreamManager::initialize_batch_stream(uint32_t start_session_id, uint32_t resume_offset,
+                                                const SessionQuery* query) {
+    close_stream();
+    if (query) {
+        // The matches are fixed when the batch starts; later sessions need a new query
+        uint32_t limit = session_query_limit(*query);
+        SessionQueryRecord* records = (SessionQueryRecord*)heap_caps_malloc(limit * sizeof(SessionQueryRecord),
+                                                                            MALLOC_CAP_SPIRAM);
+        batch_ids = (uint32_t*)heap_caps_malloc(limit * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+        if (!records || !batch_ids) {
+            LOG_BLE("ERROR: Failed to allocate the session query batch (%lu sessions)\n", (unsigned long)limit);
+            heap_caps_free(records);
+            close_stream();
+            return false;
+        }
+        SessionQuery stored_only = *query;
+        stored_only.flags |= SESSION_QUERY_FLAG_STORED;
+        uint32_t matched = 0;
+        uint32_t count = run_session_query(stored_only, records, limit, &matched);
+        for (uint32_t i = 0; i < count; i++) {
+            batch_ids[i] = records[count - 1 - i].session_id;     // Newest first to id order
+        }
+        batch_id_count = count;
+        heap_caps_free(records);
+        LOG_BLE("DataStream: Batch of %lu query matches\n", (unsigned long)count);
+    }
+    batch_next_id = start_session_id;
+    batch_resume_id = start_session_id;
+    batch_resume_offset = resume_offset;
+    batch_session_count = 0;
+    batch_final_frame = false;
+    batch_stage = BatchStage::FRAME;
+    LOG_BLE("DataStream: Batch from session %lu (offset %lu)\n",
+            (unsigned long)start_session_id, (unsigned long)resume_offset);
+    open_next_batch_session();
+    return true;
+}
+
+// Sessions are rotated and added while a batch runs, so look the next one up each time
+bool DataStreamManager::find_next_batch_session(uint32_t* session_id) const {
+    if (batch_ids) {
+        for (uint32_t i = 0; i < batch_id_count; i++) {
+            if (batch_ids[i] >= batch_next_id) {
+                *session_id = batch_ids[i];
+                return true;
+            }
+        }
+        return false;
+    }
+    uint32_t capacity = grind_logger.get_total_flash_sessions();
+    if (capacity == 0) {
+        return false;
+    }
+    ArenaScope scope(file_arena);
+    uint32_t* ids = scope.allocate_array<uint32_t>(capacity);
+    if (!ids) {
+        return false;
+    }
+    uint32_t count = grind_logger.get_session_ids(ids, capacity);
+    bool found = false;
+    for (uint32_t i = 0; i < count; i++) {
+        if (ids[i] >= batch_next_id && (!found || ids[i] < *session_id)) {
+            *session_id = ids[i];
+            found = true;
+        }
+    }
+    return found;
+}
+
+// Queue the next session's header, or the end marker when none is left
+void DataStreamManager::open_next_batch_session() {
+    active_reader.close();
+    file_stream_active = false;
+
+    uint32_t session_id = 0;
+    while (find_next_batch_session(&session_id)) {
+        batch_next_id = session_id + 1;
+        if (!grind_logger.open_session(session_id, &active_reader)) {
+            LOG_BLE("DataStream: Batch skips session %lu (open failed)\n", (unsigned long)session_id);
+            continue;
+        }
+
+        current_session_id = session_id;
+        file_total_size = active_reader.size();
+        file_bytes_sent = 0;
+        batch_crc = 0;
+        if (session_id == batch_resume_id && batch_resume_offset > 0) {
+            // The host keeps the bytes it already has; fold them into the CRC without sending them
+            uint32_t offset = batch_resume_offset < file_total_size ? batch_resume_offset : file_total_size;
+            uint8_t scratch[256];
+            while (file_bytes_sent < offset) {
+                size_t want = offset - file_bytes_sent < sizeof(scratch) ? offset - file_bytes_sent : sizeof(scratch);
+                size_t got = active_reader.read_bytes(file_bytes_sent, scratch, want);
+                if (got == 0) {
+                    break;
+                }
+                batch_crc = session_checksum_update(batch_crc, scratch, got);
+                file_bytes_sent += got;
+            }
+        }
+        file_stream_active = true;
+        batch_padding = false;
+        batch_session_count++;
+
+        put_u32(batch_frame, DATA_STREAM_BATCH_MAGIC);
+        put_u32(batch_frame + 4, session_id);
+        put_u32(batch_frame + 8, file_bytes_sent);
+        put_u32(batch_frame + 12, file_total_size - file_bytes_sent);
+        batch_frame_size = DATA_STREAM_BATCH_HEADER_BYTES;
+        batch_frame_pos = 0;
+        batch_stage = BatchStage::FRAME;
+        return;
+    }
+
+    current_session_id = 0;
+    put_u32(batch_frame, DATA_STREAM_BATCH_MAGIC);
+    memset(batch_frame + 4, 0, DATA_STREAM_BATCH_HEADER_BYTES - 4);
+    batch_frame_size = DATA_STREAM_BATCH_HEADER_BYTES;
+    batch_frame_pos = 0;
+    batch_final_frame = true;
+    batch_stage = BatchStage::FRAME;
+}
+
+bool DataStreamManager::read_batch_chunk(uint8_t* buffer, size_t buffer_size, size_t* actual_size) {
+    if (!buffer || !actual_size || batch_stage == BatchStage::IDLE || is_batch_complete()) {
+        return false;
+    }
+
+    size_t used = 0;
+    while (used < buffer_size && !is_batch_complete()) {
+        if (batch_frame_pos < batch_frame_size) {
+            size_t n = batch_frame_size - batch_frame_pos;
+            n = n < buffer_size - used ? n : buffer_size - used;
+            memcpy(buffer + used, batch_frame + batch_frame_pos, n);
+            batch_frame_pos += n;
+            used += n;
+            continue;
+        }
+
+        if (batch_stage == BatchStage::FRAME) {
+            // Header or trailer fully read: the end marker finishes, a header starts the payload,
+            // a trailer moves on to the next session
+            if (batch_final_frame) {
+                batch_stage = BatchStage::DONE;
+            } else if (file_stream_active) {
+                batch_stage = BatchStage::PAYLOAD;
+            } else {
+                open_next_batch_session();
+            }
+            continue;
+        }
+
+        // PAYLOAD
+        size_t bytes_read = 0;
+        if (file_bytes_sent < file_total_size && !batch_padding) {
+            bytes_read = active_reader.read_bytes(file_bytes_sent, buffer + used, buffer_size - used);
+        }
+        if (bytes_read > 0) {
+            batch_crc = session_checksum_update(batch_crc, buffer + used, bytes_read);
+            file_bytes_sent += bytes_read;
+            used += bytes_read;
+            continue;
+        }
+        if (file_bytes_sent < file_total_size) {
+            // Pad a failed read to the announced length so the framing holds; the CRC flags the session
+            if (!batch_padding) {
+                batch_padding = true;
+                LOG_BLE("DataStream: Batch read of session %lu failed at %lu of %lu bytes, padding\n",
+                        (unsigned long)current_session_id, (unsigned long)file_bytes_sent,
+                        (unsigned long)file_total_size);
+            }
+            size_t n = file_total_size - file_bytes_sent;
+            n = n < buffer_size - used ? n : buffer_size - used;
+            memset(buffer + used, 0, n);
+            file_bytes_sent += n;
+            used += n;
+            continue;
+        }
+        active_reader.close();
+        file_stream_active = false;
+        put_u32(batch_frame, batch_crc);
+        batch_frame_size = DATA_STREAM_BATCH_TRAILER_BYTES;
+        batch_frame_pos = 0;
+        batch_stage = BatchStage::FRAME;
+    }
+
+    *actual_size = used;
+    return used > 0;
+}
+
+void DataStreamManager::enable_compression() {
+    compressor.reset();
+    put_u32(compressed_header, DATA_STREAM_COMPRESSED_MAGIC);
+    compressed_header[4] = BLE_DATA_COMPRESS_WINDOW_BITS;
+    compressed_header[5] = BLE_DATA_COMPRESS_LOOKAHEAD_BITS;
+    compressed_header[6] = 0;
+    compressed_header[7] = 0;
+    compressed_header_pos = 0;
+    raw_complete = false;
+    compressed = true;
+}
+
+bool DataStreamManager::read_raw_chunk(uint8_t* buffer, size_t buffer_size, size_t* actual_size) {
+    return batch_stage != BatchStage::IDLE ? read_batch_chunk(buffer, buffer_size, actual_size)
+                                           : read_file_chunk(buffer, buffer_size, actual_size);
+}
+
+bool DataStreamManager::is_raw_complete() const {
+    return batch_stage != BatchStage::IDLE ? is_batch_complete() : !file_stream_active;
+}
+
+bool DataStreamManager::is_complete() const {
+    if (compressed) {
+        return raw_complete && compressed_header_pos >= DATA_STREAM_COMPRESSED_HEADER_BYTES &&
+               compressor.is_drained();
+    }
+    return is_raw_complete();
+}
+
+bool DataStreamManager::read_chunk(uint8_t* buffer, size_t buffer_size, size_t* actual_size) {
+    if (!compressed) {
+        return read_raw_chunk(buffer, buffer_size, actual_size);
+    }
+    if (!buffer || !actual_size || is_complete()) {
+        return false;
+    }
+
+    size_t used = 0;
+    while (used < buffer_size && compressed_header_pos < DATA_STREAM_COMPRESSED_HEADER_BYTES) {
+        buffer[used++] = compressed_header[compressed_header_pos++];
+    }
+    while (used < buffer_size) {
+        used += compressor.poll(buffer + used, buffer_size - used, raw_complete);
+        if (raw_complete) {
+            break;                              // Drained, or the rest goes in the next chunk
+        }
+        uint8_t* tail = nullptr;
+        size_t space = compressor.input_space(&tail);
+        if (space == 0) {
+            break;                              // Input is full, so the output is what ran out
+        }
+        size_t bytes_read = 0;
+        if (!read_raw_chunk(tail, space, &bytes_read) || bytes_read == 0) {
+            raw_complete = true;
+            continue;
+        }
+        compressor.commit(bytes_read);
+        raw_complete = is_raw_complete();
+    }
+
+    *actual_size = used;
+    return used > 0;
+}
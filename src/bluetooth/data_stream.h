@@ -2,7 +2,22 @@
 
 #include <cstdint>
 #include <cstddef>
-#include <LittleFS.h>
+#include "../logging/session_reader.h"
+#include "../logging/session_query.h"
+#include "export_compressor.h"
+
+// Batch export framing, little-endian. Each session is sent as
+//   [magic:4][session_id:4][offset:4][length:4] <length bytes of the file image from offset> [crc32:4]
+// where the CRC-32 (zlib) covers the whole file image, including bytes before offset that an
+// earlier, interrupted batch already delivered. A header with session_id 0 ends the batch.
+#define DATA_STREAM_BATCH_MAGIC 0x46534247u                // "GBSF"
+#define DATA_STREAM_BATCH_HEADER_BYTES 16
+#define DATA_STREAM_BATCH_TRAILER_BYTES 4
+
+// Compressed export: [magic:4][window_bits:1][lookahead_bits:1][reserved:2], then the heatshrink
+// bitstream of the bytes the export would otherwise send (file, query reply or batch framing)
+#define DATA_STREAM_COMPRESSED_MAGIC 0x4B534847u           // "GHSK"
+#define DATA_STREAM_COMPRESSED_HEADER_BYTES 8
 
 /**
  * DataStreamManager - Handles streaming data from the grind logger
@@ -17,7 +32,36 @@ private:
     uint32_t file_bytes_sent;
     uint32_t file_total_size;
     bool file_stream_active;
-    File active_file;                      // Persistent handle for efficient reads
+    SessionReader active_reader;           // Kept open across chunks; reads resume at file_bytes_sent
+    uint8_t* query_reply;                  // Session query or log layout reply streamed instead of a file (PSRAM)
+    
+    // Batch state: sessions are streamed in id order from batch_next_id
+    enum class BatchStage : uint8_t { IDLE, FRAME, PAYLOAD, DONE };
+    BatchStage batch_stage;
+    uint32_t batch_next_id;                // Lowest id not yet started
+    uint32_t batch_resume_id;              // Session the resume offset applies to
+    uint32_t batch_resume_offset;
+    uint32_t batch_crc;                    // Over the current session's file image so far
+    uint32_t batch_session_count;
+    uint8_t batch_frame[DATA_STREAM_BATCH_HEADER_BYTES];   // Pending header or trailer bytes
+    uint8_t batch_frame_size;
+    uint8_t batch_frame_pos;
+    bool batch_final_frame;                // The pending frame is the end marker
+    bool batch_padding;                    // A read failed; the rest of the payload is zeros
+    uint32_t* batch_ids;                   // Query matches in id order (PSRAM); nullptr: every stored session
+    uint32_t batch_id_count;
+    
+    // Compressed export: the raw stream above is read into the compressor and encoded into chunks
+    bool compressed;
+    bool raw_complete;                     // The raw stream has ended (or failed)
+    uint8_t compressed_header[DATA_STREAM_COMPRESSED_HEADER_BYTES];
+    uint8_t compressed_header_pos;
+    ExportCompressor compressor;
+    
+    bool read_raw_chunk(uint8_t* buffer, size_t buffer_size, size_t* actual_size);
+    bool is_raw_complete() const;
+    bool find_next_batch_session(uint32_t* session_id) const;
+    void open_next_batch_session();
     
 public:
     DataStreamManager();
@@ -62,4 +106,49 @@ public:
      * @return Progress percentage, or 0 if no stream is active
      */
     uint8_t get_progress_percent() const;
+    
+    uint32_t get_file_size() const { return file_total_size; }
+    
+    /**
+     * Run a session query and stream its reply (SessionQueryReplyHeader and records) like a file
+     * @return false if the reply buffer could not be allocated
+     */
+    bool initialize_query_stream(const SessionQuery& query);
+    
+    /**
+     * Stream the session file struct layout (write_grind_log_layout()) like a file
+     * @return false if the reply buffer could not be allocated
+     */
+    bool initialize_layout_stream();
+    
+    /**
+     * Start a batch of every stored session with id >= start_session_id, framed as above
+     * @param resume_offset Bytes of start_session_id's image the host already holds
+     * @param query Only the sessions it matches (from its first_session_id on); nullptr: all
+     * @return false if the query's matches could not be collected
+     */
+    bool initialize_batch_stream(uint32_t start_session_id, uint32_t resume_offset,
+                                 const SessionQuery* query = nullptr);
+    
+    /**
+     * Fill buffer with the next framed batch bytes
+     * @return false once the end marker has been read
+     */
+    bool read_batch_chunk(uint8_t* buffer, size_t buffer_size, size_t* actual_size);
+    bool is_batch_complete() const { return batch_stage == BatchStage::DONE && batch_frame_pos >= batch_frame_size; }
+    uint32_t get_batch_session_count() const { return batch_session_count; }
+    
+    /**
+     * Compress the stream just initialized (file, query reply or batch) from its first byte on
+     */
+    void enable_compression();
+    bool is_compressed() const { return compressed; }
+    uint32_t get_raw_bytes_read() const { return compressor.get_input_bytes(); }
+    
+    /**
+     * Next chunk of whichever stream is active, compressed when enabled
+     * @return false once nothing is left to send
+     */
+    bool read_chunk(uint8_t* buffer, size_t buffer_size, size_t* actual_size);
+    bool is_complete() const;
 };
@@ -0,0 +1,86 @@
+#include "debug_log_batcher.h"
+#include <string.h>
+
+DebugLogBatcher::DebugLogBatcher() {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+bool DebugLogBatcher::append(const char* text, size_t length) {
+    if (!text || length == 0) {
+        return true;
+    }
+    uint32_t now_ms = millis();
+    portENTER_CRITICAL(&lock);
+    if (length > sizeof(buffer) - count) {
+        unreported_dropped++;
+        total_dropped++;
+        portEXIT_CRITICAL(&lock);
+        return false;
+    }
+    if (count == 0) {
+        oldest_ms = now_ms;
+    }
+    size_t tail = (head + count) % sizeof(buffer);
+    size_t first = min(length, sizeof(buffer) - tail);
+    memcpy(buffer + tail, text, first);
+    memcpy(buffer, text + first, length - first);
+    count += length;
+    portEXIT_CRITICAL(&lock);
+    return true;
+}
+
+void DebugLogBatcher::clear() {
+    portENTER_CRITICAL(&lock);
+    head = 0;
+    count = 0;
+    unreported_dropped = 0;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool DebugLogBatcher::is_due(uint32_t now_ms, size_t payload_bytes) const {
+    portENTER_CRITICAL(&lock);
+    bool due = unreported_dropped > 0 || count >= payload_bytes ||
+               (count > 0 && now_ms - oldest_ms >= BLE_DEBUG_LOG_FLUSH_MS);
+    portEXIT_CRITICAL(&lock);
+    return due;
+}
+
+size_t DebugLogBatcher::read(char* out, size_t out_size) {
+    if (!out || out_size == 0) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&lock);
+    uint32_t dropped = unreported_dropped;
+    unreported_dropped = 0;
+    portEXIT_CRITICAL(&lock);
+
+    size_t written = 0;
+    if (dropped > 0) {
+        int length = snprintf(out, out_size, "BLE_DEBUG: %lu log lines dropped\n", (unsigned long)dropped);
+        written = length > 0 ? min((size_t)length, out_size - 1) : 0;
+    }
+
+    portENTER_CRITICAL(&lock);
+    size_t take = min(count, out_size - written);
+    if (take < count) {
+        // End on the last line break that fits; only a line longer than the whole notification is split
+        size_t cut = take;
+        while (cut > 0 && buffer[(head + cut - 1) % sizeof(buffer)] != '\n') {
+            cut--;
+        }
+        if (cut > 0) {
+            take = cut;
+        } else if (written > 0) {
+            take = 0;
+        }
+    }
+    size_t first = min(take, sizeof(buffer) - head);
+    memcpy(out + written, buffer + head, first);
+    memcpy(out + written + first, buffer, take - first);
+    head = (head + take) % sizeof(buffer);
+    count -= take;
+    portEXIT_CRITICAL(&lock);
+
+    return written + take;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "../config/bluetooth.h"
+
+/**
+ * DebugLogBatcher - Debug stream lines packed into MTU-sized notifications
+ *
+ * BluetoothManager::log() appends each line here instead of notifying it on
+ * its own; the BLE task sends the pending text once a full notification's
+ * worth has built up or the oldest line has waited BLE_DEBUG_LOG_FLUSH_MS.
+ * A notification ends on a line break when one fits, so hosts that split on
+ * '\n' see whole lines. A line that does not fit is dropped whole and
+ * counted; the count goes out as a line of its own ahead of the next text.
+ *
+ * Lines come from the BLE task and the BLE host callbacks, so the buffer is
+ * guarded by a short critical section (copies only, never a notify).
+ */
+class DebugLogBatcher {
+public:
+    DebugLogBatcher();
+
+    bool append(const char* text, size_t length);   // false = dropped (counted)
+    void clear();                                   // Stream stopped: forget pending text and drops
+
+    bool is_due(uint32_t now_ms, size_t payload_bytes) const;
+    // Pending text up to out_size bytes, ending on a line break when one fits; 0 when nothing is pending
+    size_t read(char* out, size_t out_size);
+
+    uint32_t get_dropped_lines() const { return total_dropped; }
+
+private:
+    char buffer[BLE_DEBUG_LOG_BUFFER_BYTES];
+    size_t head = 0;                    // Oldest pending byte
+    size_t count = 0;
+    uint32_t oldest_ms = 0;             // When the oldest pending line arrived
+    uint32_t unreported_dropped = 0;
+    uint32_t total_dropped = 0;
+    mutable portMUX_TYPE lock;
+};
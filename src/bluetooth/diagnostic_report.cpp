@@ -0,0 +1,879 @@
+#include "diagnostic_report.h"
+#include <cstdarg>
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <nvs_flash.h>
+#include <nvs.h>
+#include "../system/statistics_manager.h"
+#include "../system/memory_arena.h"
+#include "../system/boot_sequence.h"
+#include "../config/constants.h"
+#include "../config/user.h"
+#include "../config/grind_control.h"
+#include "../config/build_info.h"
+#include "../logging/grind_logging.h"
+#include "../logging/throughput_trend.h"
+#include "../hardware/hardware_manager.h"
+#include "../hardware/WeightSensor.h"
+#include "../controllers/grind_controller.h"
+#include "../controllers/grind_phase_table.h"
+#include "../tasks/task_manager.h"
+#include "../tasks/grind_control_task.h"
+
+extern HardwareManager hardware_manager;
+extern GrindController grind_controller;
+
+namespace {
+const char* const kTerminationNames[] = {
+    "COMPLETED", "TIMEOUT", "OVERSHOOT", "MAX_PULSES", "FLOW_STALLED", "FLOW_UNSTABLE", "PROJECTED_TIMEOUT",
+    "UNKNOWN"
+};
+const char* const kPhaseNames[] = {
+    "IDLE", "INITIALIZING", "SETUP", "TARING", "TARE_CONFIRM",
+    "PREDICTIVE", "PULSE_DECISION", "PULSE_EXECUTE", "PULSE_SETTLING",
+    "FINAL_SETTLING", "TIME_GRINDING", "TIME_ADDITIONAL_PULSE", "COMPLETED", "TIMEOUT"
+};
+} // namespace
+
+void DiagnosticReport::start() {
+    cancel();
+    stage = Stage::HEADER;
+    list_index = 0;
+    list_started = false;
+    nvs_namespace[0] = '\0';
+    recent_count = 0;
+    event_index = 0;
+}
+
+void DiagnosticReport::cancel() {
+    session_reader.close();
+    stage = Stage::IDLE;
+    section_size = 0;
+    section_sent = 0;
+}
+
+bool DiagnosticReport::read_chunk(uint8_t* buffer, size_t buffer_size, size_t* actual_size) {
+    *actual_size = 0;
+    if (stage == Stage::IDLE || buffer_size == 0) {
+        return false;
+    }
+    if (section_sent >= section_size) {
+        format_next_section();
+        if (section_size == 0) {
+            cancel();
+            return false;
+        }
+    }
+
+    size_t length = section_size - section_sent;
+    if (length > buffer_size) {
+        length = buffer_size;
+    }
+    memcpy(buffer, section + section_sent, length);
+    section_sent += length;
+    *actual_size = length;
+    return true;
+}
+
+// Appends to the current section; false when the text was cut at the end of the section
+bool DiagnosticReport::append(const char* format, ...) {
+    size_t room = sizeof(section) - section_size;
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(section + section_size, room, format, args);
+    va_end(args);
+    if (written < 0) {
+        section[section_size] = '\0';
+        return false;
+    }
+    if ((size_t)written >= room) {
+        section_size = sizeof(section) - 1;
+        return false;
+    }
+    section_size += written;
+    return true;
+}
+
+// List entries are kept whole: a cut one is rewound to mark and starts the next section.
+// Each list call begins on an empty section, so an entry at mark 0 is longer than a
+// whole section and goes out cut instead, which keeps the report moving.
+bool DiagnosticReport::keep_entry(bool fits, size_t mark) {
+    if (fits || mark == 0) {
+        return true;
+    }
+    section_size = mark;
+    section[mark] = '\0';
+    return false;
+}
+
+void DiagnosticReport::format_next_section() {
+    section_size = 0;
+    section_sent = 0;
+    section[0] = '\0';
+
+    // Stages that have nothing to say fall through to the next one
+    while (section_size == 0 && stage != Stage::DONE && stage != Stage::IDLE) {
+        switch (stage) {
+            case Stage::HEADER:
+                append(
+                    "=== SMART GRIND BY WEIGHT - DIAGNOSTIC REPORT ===\n"
+                    "Generated: %s\n"
+                    "\n"
+                    "[FIRMWARE]\n"
+                    "  Version: %s\n"
+                    "  Build: #%d\n"
+                    "  Git: %s (%s)\n"
+                    "  Built: %s\n"
+                    "\n",
+                    get_build_datetime(),
+                    BUILD_FIRMWARE_VERSION,
+                    BUILD_NUMBER,
+                    get_git_commit_id(),
+                    get_git_branch(),
+                    BUILD_TIMESTAMP
+                );
+                stage = Stage::SYSTEM;
+                break;
+
+            case Stage::SYSTEM: {
+                unsigned long uptime_s = millis() / 1000;
+                size_t heap_free = ESP.getFreeHeap();
+                size_t heap_total = ESP.getHeapSize();
+                float heap_used_pct = (float(heap_total - heap_free) / float(heap_total)) * 100.0f;
+                const char* driver_type =
+#ifdef MOCK_BUILD
+                    "MOCK";
+#else
+                    "REAL";
+#endif
+                append(
+                    "[SYSTEM]\n"
+                    "  Uptime: %02lu:%02lu:%02lu\n"
+                    "  CPU: %lu MHz\n"
+                    "  Heap: %u KB / %u KB (%.1f%% used)\n"
+                    "  Flash: %u MB\n"
+                    "  Driver: %s\n",
+                    uptime_s / 3600, (uptime_s % 3600) / 60, uptime_s % 60,
+                    (unsigned long)ESP.getCpuFreqMHz(),
+                    (unsigned int)(heap_free / 1024),
+                    (unsigned int)(heap_total / 1024),
+                    heap_used_pct,
+                    (unsigned int)(ESP.getFlashChipSize() / 1024 / 1024),
+                    driver_type
+                );
+                char timeline[128];
+                boot_sequence.format(timeline, sizeof(timeline));
+                append("  Boot (ms): %s\n\n", timeline);
+                stage = Stage::MEMORY;
+                break;
+            }
+
+            case Stage::MEMORY:
+                // Heap-heavy paths draw from the arenas; fallbacks mean an arena is too small
+                append(
+                    "[MEMORY]\n"
+                    "  Internal: %u KB free, %u KB min, %u KB largest\n"
+                    "  PSRAM: %u KB free, %u KB min, %u KB largest\n"
+                    "  Arena %s: %u/%u B (peak %u, fallbacks %lu)\n"
+                    "  Arena %s: %u/%u B (peak %u, fallbacks %lu, resets %lu)\n"
+                    "\n",
+                    (unsigned int)(heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024),
+                    (unsigned int)(heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL) / 1024),
+                    (unsigned int)(heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) / 1024),
+                    (unsigned int)(heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 1024),
+                    (unsigned int)(heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM) / 1024),
+                    (unsigned int)(heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) / 1024),
+                    file_arena.get_name(), (unsigned int)file_arena.get_used(), (unsigned int)file_arena.get_capacity(),
+                    (unsigned int)file_arena.get_high_water(), (unsigned long)file_arena.get_fallback_count(),
+                    session_arena.get_name(), (unsigned int)session_arena.get_used(), (unsigned int)session_arena.get_capacity(),
+                    (unsigned int)session_arena.get_high_water(), (unsigned long)session_arena.get_fallback_count(),
+                    (unsigned long)session_arena.get_reset_count()
+                );
+                stage = Stage::TASK_STACKS;
+                break;
+
+            case Stage::TASK_STACKS: {
+                // Least free stack since boot; sized in config/system.h
+                task_manager.sample_memory_stats();
+                TaskMemoryStats memory = task_manager.get_memory_stats();
+                append(
+                    "[TASK STACKS]\n"
+                    "  WeightSampling: %lu / %lu B free\n"
+                    "  GrindControl: %lu / %lu B free\n"
+                    "  UIRender: %lu / %lu B free\n"
+                    "  Bluetooth: %lu / %lu B free\n"
+                    "  FileIO: %lu / %lu B free\n"
+                    "  Alloc failures: %lu (last %lu B)\n"
+                    "\n",
+                    (unsigned long)memory.stack_min_free_bytes[0], (unsigned long)memory.stack_size_bytes[0],
+                    (unsigned long)memory.stack_min_free_bytes[1], (unsigned long)memory.stack_size_bytes[1],
+                    (unsigned long)memory.stack_min_free_bytes[2], (unsigned long)memory.stack_size_bytes[2],
+                    (unsigned long)memory.stack_min_free_bytes[3], (unsigned long)memory.stack_size_bytes[3],
+                    (unsigned long)memory.stack_min_free_bytes[4], (unsigned long)memory.stack_size_bytes[4],
+                    (unsigned long)memory.alloc_failure_count, (unsigned long)memory.last_alloc_failure_bytes
+                );
+                stage = Stage::CPU_LOAD;
+                break;
+            }
+
+            case Stage::CPU_LOAD: {
+                // Last sample window of the run-time stats; % of one core
+                TaskCpuStats cpu = task_manager.get_cpu_stats();
+                static const char* const task_names[TASK_MANAGER_TASK_COUNT] = {
+                    "WeightSampling", "GrindControl", "UIRender", "Bluetooth", "FileIO"
+                };
+                append("[CPU LOAD] (%lu ms window)\n", (unsigned long)cpu.window_ms);
+                for (int i = 0; i < TASK_MANAGER_TASK_COUNT; i++) {
+                    append("  %s: %u.%u%% on core %d, %u wakeups/s\n", task_names[i],
+                           cpu.task_permille[i] / 10, cpu.task_permille[i] % 10, cpu.task_core[i],
+                           cpu.task_wakeups_per_s[i]);
+                }
+                for (int core = 0; core < 2; core++) {
+                    append("  Core %d: idle %u.%u%%, other tasks %u.%u%%\n", core,
+                           cpu.idle_permille[core] / 10, cpu.idle_permille[core] % 10,
+                           cpu.other_permille[core] / 10, cpu.other_permille[core] % 10);
+                }
+                append("\n");
+                stage = Stage::CONTROL_LOOP;
+                break;
+            }
+
+            case Stage::CONTROL_LOOP: {
+                ControlLoopDeadlineStats deadlines = grind_control_task.get_deadline_stats();
+                append(
+                    "[CONTROL LOOP]\n"
+                    "  Missed deadlines: %lu (%lu in a row now)\n"
+                    "  Overrun: max %lu us, last %lu us\n"
+                    "  Last miss: %s in %s, %lu ms ago\n"
+                    "  Fail-safe stops: %lu\n"
+                    "\n",
+                    (unsigned long)deadlines.missed_count, (unsigned long)deadlines.consecutive_missed,
+                    (unsigned long)deadlines.max_overrun_us, (unsigned long)deadlines.last_overrun_us,
+                    GrindControlTask::get_cause_name(deadlines.last_cause),
+                    deadlines.missed_count > 0 && is_valid_grind_phase((GrindPhase)deadlines.last_phase_id)
+                        ? get_grind_phase_traits((GrindPhase)deadlines.last_phase_id).name : "-",
+                    deadlines.missed_count > 0 ? (unsigned long)(millis() - deadlines.last_missed_ms) : 0UL,
+                    (unsigned long)deadlines.safe_off_count
+                );
+                stage = Stage::RUNTIME;
+                break;
+            }
+
+            case Stage::RUNTIME: {
+                WeightSensor* weight_sensor = hardware_manager.get_weight_sensor();
+                if (weight_sensor) {
+                    FlowWindows windows = weight_sensor->get_flow_windows();
+                    append(
+                        "[RUNTIME DIAGNOSTICS]\n"
+                        "  Load Cell Status: %s\n"
+                        "  Calibration Factor: %.2f\n"
+                        "  Std Dev (g): %.4f\n"
+                        "  Std Dev (ADC): %ld\n"
+                        "  Noise Level: %s\n"
+                        "  Noise Floor (g): %.4f\n"
+                        "  Settling Tolerance (g): %.4f\n"
+                        "  Flow Start Threshold (g/s): %.2f\n"
+                        "  Flow Windows: detection %lu ms, prediction %lu ms, pulse %lu ms\n"
+                        "  Motor Latency: %.0f ms\n"
+                        "\n",
+                        weight_sensor->is_calibrated() ? "Calibrated" : "NOT CALIBRATED",
+                        weight_sensor->get_calibration_factor(),
+                        weight_sensor->get_standard_deviation_g(GRIND_SCALE_PRECISION_SETTLING_TIME_MS),
+                        (long)weight_sensor->get_standard_deviation_adc(GRIND_SCALE_PRECISION_SETTLING_TIME_MS),
+                        weight_sensor->noise_level_diagnostic() ? "OK" : "Too High",
+                        weight_sensor->get_noise_floor_g(),
+                        weight_sensor->get_settling_tolerance_g(),
+                        weight_sensor->get_flow_detection_threshold_gps(),
+                        (unsigned long)windows.detection_ms, (unsigned long)windows.prediction_ms,
+                        (unsigned long)windows.pulse_flow_ms,
+                        grind_controller.get_motor_response_latency()
+                    );
+                }
+                stage = Stage::PROFILES;
+                break;
+            }
+
+            case Stage::PROFILES:
+                append(
+                    "[COMPILE-TIME PARAMETERS - PROFILES]\n"
+                    "  USER_PROFILE_COUNT: %d\n"
+                    "  USER_SINGLE_ESPRESSO_WEIGHT_G: %.1f\n"
+                    "  USER_DOUBLE_ESPRESSO_WEIGHT_G: %.1f\n"
+                    "  USER_CUSTOM_PROFILE_WEIGHT_G: %.1f\n"
+                    "  USER_SINGLE_ESPRESSO_TIME_S: %.1f\n"
+                    "  USER_DOUBLE_ESPRESSO_TIME_S: %.1f\n"
+                    "  USER_CUSTOM_PROFILE_TIME_S: %.1f\n"
+                    "\n",
+                    USER_PROFILE_COUNT,
+                    USER_SINGLE_ESPRESSO_WEIGHT_G,
+                    USER_DOUBLE_ESPRESSO_WEIGHT_G,
+                    USER_CUSTOM_PROFILE_WEIGHT_G,
+                    USER_SINGLE_ESPRESSO_TIME_S,
+                    USER_DOUBLE_ESPRESSO_TIME_S,
+                    USER_CUSTOM_PROFILE_TIME_S
+                );
+                stage = Stage::USER_PART_1;
+                break;
+
+            case Stage::USER_PART_1:
+                append(
+                    "[COMPILE-TIME PARAMETERS - USER.H PART 1]\n"
+                    "  USER_MIN_TARGET_WEIGHT_G: %.1f\n"
+                    "  USER_MAX_TARGET_WEIGHT_G: %.1f\n"
+                    "  USER_MIN_TARGET_TIME_S: %.1f\n"
+                    "  USER_MAX_TARGET_TIME_S: %.1f\n"
+                    "  USER_FINE_WEIGHT_ADJUSTMENT_G: %.1f\n"
+                    "  USER_FINE_TIME_ADJUSTMENT_S: %.1f\n"
+                    "  USER_CALIBRATION_REFERENCE_WEIGHT_G: %.1f\n"
+                    "  USER_DEFAULT_CALIBRATION_FACTOR: %.1f\n"
+                    "\n",
+                    USER_MIN_TARGET_WEIGHT_G,
+                    USER_MAX_TARGET_WEIGHT_G,
+                    USER_MIN_TARGET_TIME_S,
+                    USER_MAX_TARGET_TIME_S,
+                    USER_FINE_WEIGHT_ADJUSTMENT_G,
+                    USER_FINE_TIME_ADJUSTMENT_S,
+                    USER_CALIBRATION_REFERENCE_WEIGHT_G,
+                    USER_DEFAULT_CALIBRATION_FACTOR
+                );
+                stage = Stage::USER_PART_2;
+                break;
+
+            case Stage::USER_PART_2:
+                append(
+                    "[COMPILE-TIME PARAMETERS - USER.H PART 2]\n"
+                    "  USER_SCREEN_AUTO_DIM_TIMEOUT_MS: %lu\n"
+                    "  USER_SCREEN_BRIGHTNESS_NORMAL: %.2f\n"
+                    "  USER_SCREEN_BRIGHTNESS_DIMMED: %.2f\n"
+                    "  USER_WEIGHT_ACTIVITY_THRESHOLD_G: %.1f\n"
+                    "  USER_AUTO_GRIND_TRIGGER_DELTA_G: %.1f\n"
+                    "  USER_AUTO_GRIND_CUP_SETTLE_MS: %lu\n"
+                    "  USER_AUTO_GRIND_CUP_MIN_SAMPLES: %u\n"
+                    "  USER_AUTO_GRIND_CUP_TARE_MAX_AGE_MS: %lu\n"
+                    "  USER_AUTO_GRIND_REARM_DELAY_MS: %lu\n"
+                    "\n",
+                    (unsigned long)USER_SCREEN_AUTO_DIM_TIMEOUT_MS,
+                    USER_SCREEN_BRIGHTNESS_NORMAL,
+                    USER_SCREEN_BRIGHTNESS_DIMMED,
+                    USER_WEIGHT_ACTIVITY_THRESHOLD_G,
+                    USER_AUTO_GRIND_TRIGGER_DELTA_G,
+                    (unsigned long)USER_AUTO_GRIND_CUP_SETTLE_MS,
+                    (unsigned)USER_AUTO_GRIND_CUP_MIN_SAMPLES,
+                    (unsigned long)USER_AUTO_GRIND_CUP_TARE_MAX_AGE_MS,
+                    (unsigned long)USER_AUTO_GRIND_REARM_DELAY_MS
+                );
+                stage = Stage::GRIND_PART_1;
+                break;
+
+            case Stage::GRIND_PART_1:
+                append(
+                    "[COMPILE-TIME PARAMETERS - GRIND_CONTROL.H PART 1]\n"
+                    "  GRIND_ACCURACY_TOLERANCE_G: %.3f\n"
+                    "  GRIND_TIMEOUT_SEC: %d\n"
+                    "  GRIND_MAX_PULSE_ATTEMPTS: %d\n"
+                    "  GRIND_FLOW_DETECTION_THRESHOLD_GPS: %.1f\n"
+                    "  GRIND_UNDERSHOOT_TARGET_G: %.1f\n"
+                    "  GRIND_LATENCY_TO_COAST_RATIO: %.1f\n"
+                    "  GRIND_SCALE_SETTLING_TOLERANCE_G: %.3f\n"
+                    "  GRIND_TIME_PULSE_DURATION_MS: %d\n"
+                    "\n",
+                    GRIND_ACCURACY_TOLERANCE_G,
+                    GRIND_TIMEOUT_SEC,
+                    GRIND_MAX_PULSE_ATTEMPTS,
+                    GRIND_FLOW_DETECTION_THRESHOLD_GPS,
+                    GRIND_UNDERSHOOT_TARGET_G,
+                    GRIND_LATENCY_TO_COAST_RATIO,
+                    GRIND_SCALE_SETTLING_TOLERANCE_G,
+                    GRIND_TIME_PULSE_DURATION_MS
+                );
+                stage = Stage::GRIND_PART_2;
+                break;
+
+            case Stage::GRIND_PART_2:
+                append(
+                    "[COMPILE-TIME PARAMETERS - GRIND_CONTROL.H PART 2]\n"
+                    "  GRIND_FLOW_RATE_MIN_SANE_GPS: %.1f\n"
+                    "  GRIND_FLOW_RATE_MAX_SANE_GPS: %.1f\n"
+                    "  GRIND_PULSE_FLOW_RATE_FALLBACK_GPS: %.1f\n"
+                    "  GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS: %.1f\n"
+                    "  GRIND_MOTOR_MAX_PULSE_DURATION_MS: %.1f\n"
+                    "  GRIND_MOTOR_SETTLING_TIME_MS: %d\n"
+                    "  GRIND_MECHANICAL_DROP_THRESHOLD_G: %.1f\n"
+                    "  GRIND_MECHANICAL_EVENT_COOLDOWN_MS: %d\n"
+                    "  GRIND_MECHANICAL_EVENT_REQUIRED_COUNT: %d\n"
+                    "\n",
+                    GRIND_FLOW_RATE_MIN_SANE_GPS,
+                    GRIND_FLOW_RATE_MAX_SANE_GPS,
+                    GRIND_PULSE_FLOW_RATE_FALLBACK_GPS,
+                    GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS,
+                    GRIND_MOTOR_MAX_PULSE_DURATION_MS,
+                    GRIND_MOTOR_SETTLING_TIME_MS,
+                    GRIND_MECHANICAL_DROP_THRESHOLD_G,
+                    GRIND_MECHANICAL_EVENT_COOLDOWN_MS,
+                    GRIND_MECHANICAL_EVENT_REQUIRED_COUNT
+                );
+                stage = Stage::GRIND_PART_3;
+                break;
+
+            case Stage::GRIND_PART_3:
+                append(
+                    "[COMPILE-TIME PARAMETERS - GRIND_CONTROL.H PART 3]\n"
+                    "  GRIND_SCALE_PRECISION_SETTLING_TIME_MS: %d\n"
+                    "  GRIND_SCALE_SETTLING_TIMEOUT_MS: %d\n"
+                    "  GRIND_TARE_SAMPLE_WINDOW_MS: %d\n"
+                    "  GRIND_TARE_TIMEOUT_MS: %d\n"
+                    "  GRIND_CALIBRATION_SAMPLE_WINDOW_MS: %d\n"
+                    "  GRIND_CALIBRATION_TIMEOUT_MS: %d\n"
+                    "\n",
+                    GRIND_SCALE_PRECISION_SETTLING_TIME_MS,
+                    GRIND_SCALE_SETTLING_TIMEOUT_MS,
+                    GRIND_TARE_SAMPLE_WINDOW_MS,
+                    GRIND_TARE_TIMEOUT_MS,
+                    GRIND_CALIBRATION_SAMPLE_WINDOW_MS,
+                    GRIND_CALIBRATION_TIMEOUT_MS
+                );
+                stage = Stage::AUTOTUNE_PARAMS;
+                break;
+
+            case Stage::AUTOTUNE_PARAMS:
+                append(
+                    "[COMPILE-TIME PARAMETERS - AUTOTUNE]\n"
+                    "  GRIND_AUTOTUNE_LATENCY_MIN_MS: %.1f\n"
+                    "  GRIND_AUTOTUNE_LATENCY_MAX_MS: %.1f\n"
+                    "  GRIND_AUTOTUNE_PRIMING_PULSE_MS: %d\n"
+                    "  GRIND_AUTOTUNE_TARGET_ACCURACY_MS: %.1f\n"
+                    "  GRIND_AUTOTUNE_SUCCESS_RATE: %.2f\n"
+                    "  GRIND_AUTOTUNE_VERIFICATION_PULSES: %d\n"
+                    "  GRIND_AUTOTUNE_MAX_ITERATIONS: %d\n"
+                    "  GRIND_AUTOTUNE_COLLECTION_DELAY_MS: %d\n"
+                    "  GRIND_AUTOTUNE_SETTLING_TIMEOUT_MS: %d\n"
+                    "  GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G: %.3f\n"
+                    "\n",
+                    GRIND_AUTOTUNE_LATENCY_MIN_MS,
+                    GRIND_AUTOTUNE_LATENCY_MAX_MS,
+                    GRIND_AUTOTUNE_PRIMING_PULSE_MS,
+                    GRIND_AUTOTUNE_TARGET_ACCURACY_MS,
+                    GRIND_AUTOTUNE_SUCCESS_RATE,
+                    GRIND_AUTOTUNE_VERIFICATION_PULSES,
+                    GRIND_AUTOTUNE_MAX_ITERATIONS,
+                    GRIND_AUTOTUNE_COLLECTION_DELAY_MS,
+                    GRIND_AUTOTUNE_SETTLING_TIMEOUT_MS,
+                    GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G
+                );
+                stage = Stage::STATISTICS;
+                break;
+
+            case Stage::STATISTICS: {
+                // The selected grinder's totals; the device uptime is kept by grinder 1's
+                channel_statistics(grind_channels.get_selected()).get_snapshot(&statistics);
+                uint64_t motor_runtime_ms = statistics.motor_runtime_ms();
+                append(
+                    "[STATISTICS]\n"
+                    "  Total Grinds: %lu\n"
+                    "  Shots: %lu Single / %lu Double / %lu Custom\n"
+                    "  Motor Runtime: %luh %lum\n"
+                    "  Device Uptime: %luh %lum\n"
+                    "\n",
+                    (unsigned long)statistics.total_grinds,
+                    (unsigned long)statistics.single_shots,
+                    (unsigned long)statistics.double_shots,
+                    (unsigned long)statistics.custom_shots,
+                    (unsigned long)(motor_runtime_ms / 3600000ULL),
+                    (unsigned long)((motor_runtime_ms % 3600000ULL) / 60000ULL),
+                    (unsigned long)statistics_manager.get_device_uptime_hrs(),
+                    (unsigned long)statistics_manager.get_device_uptime_min_remainder()
+                );
+                stage = Stage::STATISTICS_TOTALS;
+                break;
+            }
+
+            case Stage::STATISTICS_TOTALS:
+                append(
+                    "  Total Weight: %.2f kg\n"
+                    "  Mode Grinds: %lu Weight / %lu Time\n"
+                    "  Avg Accuracy: ±%.2f g\n"
+                    "  Total Pulses: %lu (avg %.1f)\n"
+                    "  Time Pulses: %lu\n",
+                    statistics.total_weight_kg,
+                    (unsigned long)statistics.weight_mode_grinds,
+                    (unsigned long)statistics.time_mode_grinds,
+                    statistics.avg_accuracy_g(),
+                    (unsigned long)statistics.total_pulses,
+                    statistics.avg_pulses(),
+                    (unsigned long)statistics.time_pulses
+                );
+                stage = Stage::STATISTICS_PERCENTILES;
+                break;
+
+            case Stage::STATISTICS_PERCENTILES:
+                // Streaming p50/p95 per profile, then over all profiles
+                append("  Percentiles p50/p95:\n");
+                for (uint8_t set = 0; set < kStatisticsQuantileSets; set++) {
+                    const StreamingQuantiles& error = statistics.percentiles(set, StatisticsMetric::ABS_ERROR_G);
+                    const StreamingQuantiles& time = statistics.percentiles(set, StatisticsMetric::GRIND_TIME_S);
+                    const StreamingQuantiles& pulses = statistics.percentiles(set, StatisticsMetric::PULSES);
+                    if (time.empty()) {
+                        continue;
+                    }
+                    char name[12];
+                    if (set == kStatisticsAllProfiles) {
+                        snprintf(name, sizeof(name), "All");
+                    } else {
+                        snprintf(name, sizeof(name), "Profile %u", (unsigned)set + 1);
+                    }
+                    append("    %s (%lu): error %.2f/%.2f g, time %.1f/%.1f s, pulses %.0f/%.0f\n", name,
+                           (unsigned long)time.count, error.p50(), error.p95(), time.p50(), time.p95(),
+                           pulses.p50(), pulses.p95());
+                }
+                append("\n");
+                stage = Stage::THROUGHPUT;
+                break;
+
+            case Stage::THROUGHPUT:
+                // Baseline -> newest sessions per profile; (n) = sessions since the change point, -1: none
+                append("[THROUGHPUT TREND]\n");
+                for (uint8_t profile = 0; profile < USER_PROFILE_COUNT; profile++) {
+                    ThroughputTrendResult trend;
+                    throughput_trend.get_result(profile, &trend);
+                    if (trend.sessions < GRIND_WEAR_MIN_SESSIONS) {
+                        append("  Profile %u: %u of %u sessions\n", (unsigned)profile + 1, (unsigned)trend.sessions,
+                               (unsigned)GRIND_WEAR_MIN_SESSIONS);
+                        continue;
+                    }
+                    append("  Profile %u%s: flow %.2f->%.2f g/s (%d), latency %.0f->%.0f ms (%d), "
+                           "dose %+.1f s, %+.1f s in %d\n",
+                           (unsigned)profile + 1, trend.degraded ? " DEGRADED" : "", trend.baseline_flow_g_per_s,
+                           trend.recent_flow_g_per_s, trend.flow_change_age, trend.baseline_latency_ms,
+                           trend.recent_latency_ms, trend.latency_change_age, trend.time_increase_s,
+                           trend.projected_increase_s, GRIND_WEAR_PROJECTION_DOSES);
+                }
+                append("\n");
+                stage = Stage::PREFERENCES;
+                break;
+
+            case Stage::PREFERENCES:
+                format_preferences();
+                break;
+
+            case Stage::SESSION_DATA:
+                append(
+                    "[SESSION DATA]\n"
+                    "  Sessions: %u\n"
+                    "  Events: %lu\n"
+                    "  Measurements: %lu\n"
+                    "\n",
+                    (unsigned int)grind_logger.get_total_flash_sessions(),
+                    (unsigned long)grind_logger.count_total_events_in_flash(),
+                    (unsigned long)grind_logger.count_total_measurements_in_flash()
+                );
+                stage = Stage::RECENT_SESSIONS;
+                break;
+
+            case Stage::RECENT_SESSIONS:
+                format_recent_sessions();
+                break;
+
+            case Stage::AUTOTUNE_LOG:
+                format_autotune_log();
+                break;
+
+            case Stage::END:
+                append("=== END OF REPORT ===\n");
+                stage = Stage::DONE;
+                break;
+
+            default:
+                stage = Stage::DONE;
+                break;
+        }
+    }
+}
+
+// One line per NVS entry, resumed by index: the iterator is not held across BLE ticks
+// because a preference write in between may move the entries it points at
+void DiagnosticReport::format_preferences() {
+    if (!list_started) {
+        append("[NVM STORED PREFERENCES]\n");
+        list_started = true;
+        list_index = 0;
+        nvs_namespace[0] = '\0';
+    }
+
+    nvs_iterator_t it = nullptr;
+    esp_err_t res = nvs_entry_find(NVS_DEFAULT_PART_NAME, nullptr, NVS_TYPE_ANY, &it);
+    if (res != ESP_OK && res != ESP_ERR_NVS_NOT_FOUND) {
+        size_t mark = section_size;
+        if (keep_entry(append("  [ERROR] Failed to create NVS iterator (code %d)\n\n", res), mark)) {
+            stage = Stage::SESSION_DATA;
+            list_started = false;
+        }
+        return;
+    }
+    for (uint32_t skip = 0; skip < list_index && res == ESP_OK && it != nullptr; skip++) {
+        res = nvs_entry_next(&it);
+    }
+
+    while (res == ESP_OK && it != nullptr) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+
+        size_t mark = section_size;
+        bool fits = true;
+        if (strcmp(nvs_namespace, info.namespace_name) != 0) {
+            fits = append("%s  Namespace: %s\n", nvs_namespace[0] ? "\n" : "", info.namespace_name);
+        }
+
+        Preferences pref;
+        if (fits && pref.begin(info.namespace_name, true)) {
+            switch (info.type) {
+                case NVS_TYPE_U8: {
+                    // Could be bool or uint8
+                    uint8_t val = pref.getUChar(info.key, 0);
+                    if (val <= 1) {
+                        fits = append("    %s: %s (bool)\n", info.key, val ? "true" : "false");
+                    } else {
+                        fits = append("    %s: %u (uint8)\n", info.key, val);
+                    }
+                    break;
+                }
+                case NVS_TYPE_I8:
+                    fits = append("    %s: %d (int8)\n", info.key, pref.getChar(info.key, 0));
+                    break;
+                case NVS_TYPE_U16:
+                    fits = append("    %s: %u (uint16)\n", info.key, pref.getUShort(info.key, 0));
+                    break;
+                case NVS_TYPE_I16:
+                    fits = append("    %s: %d (int16)\n", info.key, pref.getShort(info.key, 0));
+                    break;
+                case NVS_TYPE_U32:
+                    fits = append("    %s: %lu (uint32)\n", info.key, (unsigned long)pref.getUInt(info.key, 0));
+                    break;
+                case NVS_TYPE_I32:
+                    fits = append("    %s: %ld (int32)\n", info.key, (long)pref.getInt(info.key, 0));
+                    break;
+                case NVS_TYPE_U64:
+                    fits = append("    %s: %llu (uint64)\n", info.key, pref.getULong64(info.key, 0));
+                    break;
+                case NVS_TYPE_I64:
+                    fits = append("    %s: %lld (int64)\n", info.key, pref.getLong64(info.key, 0));
+                    break;
+                case NVS_TYPE_STR: {
+                    String val = pref.getString(info.key, "");
+                    fits = append("    %s: \"%s\" (string)\n", info.key, val.c_str());
+                    break;
+                }
+                case NVS_TYPE_BLOB: {
+                    size_t len = pref.getBytesLength(info.key);
+                    // Check if it's a float (4 bytes)
+                    if (len == sizeof(float)) {
+                        fits = append("    %s: %.2f (float)\n", info.key, pref.getFloat(info.key, 0.0f));
+                    } else if (len == sizeof(double)) {
+                        fits = append("    %s: %.2f (double)\n", info.key, pref.getDouble(info.key, 0.0));
+                    } else {
+                        fits = append("    %s: <blob %u bytes>\n", info.key, (unsigned int)len);
+                    }
+                    break;
+                }
+                default:
+                    fits = append("    %s: <unknown type %d>\n", info.key, info.type);
+                    break;
+            }
+            pref.end();
+        }
+
+        if (!keep_entry(fits, mark)) {
+            nvs_release_iterator(it);
+            return;
+        }
+        strncpy(nvs_namespace, info.namespace_name, sizeof(nvs_namespace) - 1);
+        nvs_namespace[sizeof(nvs_namespace) - 1] = '\0';
+        list_index++;
+        res = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+
+    size_t mark = section_size;
+    if (keep_entry(append("%s\n", list_index == 0 ? "  [EMPTY] No preferences stored\n" : ""), mark)) {
+        stage = Stage::SESSION_DATA;
+        list_started = false;
+    }
+}
+
+// Newest five sessions; the reader stays open while a session's events span several sections
+void DiagnosticReport::format_recent_sessions() {
+    if (!list_started) {
+        append("[LAST 5 GRIND SESSIONS]\n");
+        list_started = true;
+        list_index = 0;
+        recent_count = 0;
+        session_reader.close();
+
+        // Only the newest ids outlive the arena scope, so file operations on other tasks don't wait for the BLE sends
+        ArenaScope scope(file_arena);
+        uint32_t stored_sessions = grind_logger.count_sessions_in_flash();
+        uint32_t* session_ids = stored_sessions > 0 ? scope.allocate_array<uint32_t>(stored_sessions) : nullptr;
+        if (session_ids) {
+            // Listed oldest first: show the newest five
+            uint32_t count = grind_logger.get_session_ids(session_ids, stored_sessions);
+            recent_count = count < DIAGNOSTIC_REPORT_RECENT_SESSIONS ? count : DIAGNOSTIC_REPORT_RECENT_SESSIONS;
+            for (uint32_t i = 0; i < recent_count; i++) {
+                recent_ids[i] = session_ids[count - 1 - i];
+            }
+        }
+        if (recent_count == 0) {
+            append("  [NONE] No session files found\n");
+        }
+    }
+
+    while (list_index < recent_count) {
+        if (!session_reader.is_open()) {
+            if (!grind_logger.open_session(recent_ids[list_index], &session_reader)) {
+                list_index++;
+                continue;
+            }
+            const TimeSeriesSessionHeader& header = session_reader.header();
+            const GrindSession& session = session_reader.session();
+            const char* mode_name = (session.grind_mode == 0) ? "WEIGHT" : "TIME";
+            const char* term_name = kTerminationNames[session.termination_reason < 7 ? session.termination_reason : 7];
+
+            size_t mark = section_size;
+            bool fits = append(
+                "\n--- Session #%lu ---\n"
+                "  Mode: %s | Profile: %u | Status: %.*s\n"
+                "  Target: %.1fg | Final: %.1fg | Error: %+.2fg\n"
+                "  Total Time: %.1fs | Motor Time: %.1fs | Pulses: %u\n"
+                "  Termination: %s\n",
+                (unsigned long)session.session_id,
+                mode_name, session.profile_id, (int)sizeof(session.result_status), session.result_status,
+                session.target_weight, session.final_weight, session.error_grams,
+                session.total_time_ms / 1000.0f, session.total_motor_on_time_ms / 1000.0f, session.pulse_count,
+                term_name
+            );
+            if (fits && header.schema_version >= GRIND_LOG_SCHEMA_OVERFLOW_COUNTS &&
+                (session.events_dropped > 0 || session.measurements_dropped > 0)) {
+                fits = append("  Dropped: %u events, %u measurements\n", session.events_dropped,
+                              session.measurements_dropped);
+            }
+            if (fits && header.event_count > 0) {
+                fits = append("  Events (%u):\n", header.event_count);
+            }
+            if (!keep_entry(fits, mark)) {
+                session_reader.close();
+                return;
+            }
+            event_index = 0;
+        }
+
+        while (event_index < session_reader.header().event_count) {
+            GrindEvent event;
+            if (!session_reader.read_event(event_index, &event)) {
+                event_index++;
+                continue;
+            }
+            const char* phase_name = (event.phase_id < 14) ? kPhaseNames[event.phase_id] : "UNKNOWN";
+            float event_yield = event.end_weight - event.start_weight;
+
+            size_t mark = section_size;
+            bool fits;
+            if (event.pulse_attempt_number > 0) {
+                fits = append("    [%lums] %s (pulse #%u): %.2fg -> %.2fg (%+.2fg) (%.1fms pulse)",
+                              (unsigned long)event.timestamp_ms, phase_name, event.pulse_attempt_number,
+                              event.start_weight, event.end_weight, event_yield, event.pulse_duration_ms);
+            } else {
+                fits = append("    [%lums] %s: %.2fg -> %.2fg (%+.2fg) (%lums)",
+                              (unsigned long)event.timestamp_ms, phase_name,
+                              event.start_weight, event.end_weight, event_yield, (unsigned long)event.duration_ms);
+            }
+
+            // Phase-specific metrics suffix
+            switch (event.phase_id) {
+                case 5: // PREDICTIVE
+                    if (fits && (event.grind_latency_ms > 0 || event.pulse_flow_rate > 0 || event.motor_stop_target_weight > 0)) {
+                        fits = append(" | Latency: %lums, Flow: %.1fg/s, Target: %.1fg",
+                                      (unsigned long)event.grind_latency_ms, event.pulse_flow_rate,
+                                      event.motor_stop_target_weight);
+                    }
+                    break;
+                case 7: // PULSE_EXECUTE
+                    if (fits && (event.pulse_flow_rate > 0 || event.motor_stop_target_weight > 0)) {
+                        fits = append(" | Flow: %.1fg/s, Target: %.1fg", event.pulse_flow_rate, event.motor_stop_target_weight);
+                    }
+                    break;
+                case 8: // PULSE_SETTLING
+                    if (fits && (event.settling_duration_ms > 0 || event.motor_stop_target_weight > 0)) {
+                        fits = append(" | Settled: %lums, Target: %.1fg",
+                                      (unsigned long)event.settling_duration_ms, event.motor_stop_target_weight);
+                    }
+                    break;
+                case 9: // FINAL_SETTLING
+                    if (fits && event.settling_duration_ms > 0) {
+                        fits = append(" | Settled: %lums", (unsigned long)event.settling_duration_ms);
+                    }
+                    break;
+                case 10: // TIME_GRINDING
+                case 11: // TIME_ADDITIONAL_PULSE
+                    if (fits && event.pulse_flow_rate > 0) {
+                        fits = append(" | Flow: %.1fg/s", event.pulse_flow_rate);
+                    }
+                    break;
+            }
+            if (fits) {
+                fits = append("\n");
+            }
+            if (!keep_entry(fits, mark)) {
+                return;
+            }
+            event_index++;
+        }
+
+        session_reader.close();
+        list_index++;
+    }
+
+    size_t mark = section_size;
+    if (keep_entry(append("\n"), mark)) {
+        stage = Stage::AUTOTUNE_LOG;
+        list_started = false;
+    }
+}
+
+// Raw autotune.log, resumed by file offset
+void DiagnosticReport::format_autotune_log() {
+    if (!list_started) {
+        append("[AUTOTUNE RESULTS]\n");
+        list_started = true;
+        list_index = 0;
+        if (!LittleFS.exists("/autotune.log")) {
+            append("  [NOT RUN] Autotune has not been executed yet\n\n");
+            stage = Stage::END;
+            list_started = false;
+            return;
+        }
+    }
+
+    File autotune_file = LittleFS.open("/autotune.log", "r");
+    if (!autotune_file) {
+        append("  [ERROR] Failed to open autotune.log\n\n");
+        stage = Stage::END;
+        list_started = false;
+        return;
+    }
+    size_t room = sizeof(section) - 1 - section_size;
+    size_t bytes_read = 0;
+    if (autotune_file.seek(list_index)) {
+        bytes_read = autotune_file.read((uint8_t*)section + section_size, room);
+    }
+    autotune_file.close();
+    section_size += bytes_read;
+    section[section_size] = '\0';
+    list_index += bytes_read;
+
+    // Newline after the file contents once it has all been read
+    size_t mark = section_size;
+    if (bytes_read < room && keep_entry(append("\n"), mark)) {
+        stage = Stage::END;
+        list_started = false;
+    }
+}
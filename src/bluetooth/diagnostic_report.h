@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "../logging/session_reader.h"
+#include "../system/statistics_manager.h"
+
+#define DIAGNOSTIC_REPORT_SECTION_BYTES 512                 // One formatted section, sent in MTU-sized slices
+#define DIAGNOSTIC_REPORT_RECENT_SESSIONS 5
+
+/**
+ * DiagnosticReport - Incremental generator for the BLE diagnostic report
+ *
+ * The report is formatted one section at a time and handed out in slices no
+ * larger than the caller's notify payload, so the BLE task emits it across
+ * many handle() passes instead of blocking while the whole text is built.
+ * Lists (NVS entries, session events, autotune.log) resume from a cursor on
+ * the next section. Owned and driven by the BLE task only.
+ */
+class DiagnosticReport {
+public:
+    void start();
+    void cancel();
+    bool is_active() const { return stage != Stage::IDLE; }
+
+    /**
+     * Copy the next slice of report text
+     * @return false once the end marker has been handed out (the report is then idle)
+     */
+    bool read_chunk(uint8_t* buffer, size_t buffer_size, size_t* actual_size);
+
+private:
+    enum class Stage : uint8_t {
+        IDLE, HEADER, SYSTEM, MEMORY, TASK_STACKS, CPU_LOAD, CONTROL_LOOP, RUNTIME,
+        PROFILES, USER_PART_1, USER_PART_2, GRIND_PART_1, GRIND_PART_2, GRIND_PART_3, AUTOTUNE_PARAMS,
+        STATISTICS, STATISTICS_TOTALS, STATISTICS_PERCENTILES, THROUGHPUT, PREFERENCES, SESSION_DATA, RECENT_SESSIONS, AUTOTUNE_LOG, END, DONE
+    };
+
+    Stage stage = Stage::IDLE;
+    char section[DIAGNOSTIC_REPORT_SECTION_BYTES];
+    size_t section_size = 0;
+    size_t section_sent = 0;
+
+    // List cursors
+    uint32_t list_index = 0;                // NVS entry, recent session or autotune.log offset
+    bool list_started = false;
+    char nvs_namespace[16] = "";
+    uint32_t recent_ids[DIAGNOSTIC_REPORT_RECENT_SESSIONS];
+    uint32_t recent_count = 0;
+    uint16_t event_index = 0;
+    SessionReader session_reader;           // Kept open while its events are listed
+    StatisticsSnapshot statistics;          // Taken at STATISTICS, so the statistics sections agree
+
+    void format_next_section();
+    void format_preferences();
+    void format_recent_sessions();
+    void format_autotune_log();
+    bool append(const char* format, ...);
+    bool keep_entry(bool fits, size_t mark);
+};
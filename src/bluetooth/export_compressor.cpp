@@ -0,0 +1,95 @@
+#include "export_compressor.h"
+#include <string.h>
+
+void ExportCompressor::reset() {
+    pos = 0;
+    end = 0;
+    input_total = 0;
+    pending = 0;
+    pending_bits = 0;
+}
+
+size_t ExportCompressor::input_space(uint8_t** tail) {
+    // Keep one window of history ahead of pos and move the rest out of the way
+    if (pos > WINDOW_BYTES) {
+        size_t drop = pos - WINDOW_BYTES;
+        memmove(buffer, buffer + drop, end - drop);
+        pos -= drop;
+        end -= drop;
+    }
+    *tail = buffer + end;
+    return sizeof(buffer) - end;
+}
+
+void ExportCompressor::commit(size_t bytes) {
+    end += bytes;
+    input_total += bytes;
+}
+
+size_t ExportCompressor::find_match(size_t max_length, size_t* distance) const {
+    size_t best = 0;
+    size_t oldest = pos > WINDOW_BYTES ? pos - WINDOW_BYTES : 0;
+    const uint8_t* target = buffer + pos;
+    for (size_t candidate = pos; candidate-- > oldest;) {
+        // The byte that would extend the best match is the most likely to differ
+        if (buffer[candidate + best] != target[best] || buffer[candidate] != target[0]) {
+            continue;
+        }
+        size_t length = 1;
+        while (length < max_length && buffer[candidate + length] == target[length]) {
+            length++;
+        }
+        if (length > best) {
+            best = length;
+            *distance = pos - candidate;
+            if (best == max_length) {
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+void ExportCompressor::put_bits(uint8_t* out, size_t* written, uint16_t value, uint8_t count) {
+    while (count > 0) {
+        count--;
+        pending = (uint8_t)(pending << 1) | ((value >> count) & 1);
+        if (++pending_bits == 8) {
+            out[(*written)++] = pending;
+            pending = 0;
+            pending_bits = 0;
+        }
+    }
+}
+
+size_t ExportCompressor::poll(uint8_t* out, size_t capacity, bool finish) {
+    size_t written = 0;
+    while (pos < end) {
+        size_t available = end - pos;
+        if (!finish && available < LOOKAHEAD_BYTES) {
+            break;
+        }
+        if ((capacity - written) * 8 < (size_t)pending_bits + MAX_CODE_BITS) {
+            break;
+        }
+        size_t max_length = available < LOOKAHEAD_BYTES ? available : LOOKAHEAD_BYTES;
+        size_t distance = 0;
+        size_t length = find_match(max_length, &distance);
+        if (length >= MIN_MATCH_BYTES) {
+            put_bits(out, &written, 0, 1);
+            put_bits(out, &written, (uint16_t)(distance - 1), BLE_DATA_COMPRESS_WINDOW_BITS);
+            put_bits(out, &written, (uint16_t)(length - 1), BLE_DATA_COMPRESS_LOOKAHEAD_BITS);
+            pos += length;
+        } else {
+            put_bits(out, &written, 1, 1);
+            put_bits(out, &written, buffer[pos], 8);
+            pos++;
+        }
+    }
+    if (finish && pos == end && pending_bits > 0 && written < capacity) {
+        out[written++] = (uint8_t)(pending << (8 - pending_bits));
+        pending = 0;
+        pending_bits = 0;
+    }
+    return written;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "../config/bluetooth.h"
+
+/**
+ * ExportCompressor - heatshrink-format LZSS encoder for the data export stream
+ *
+ * Session files go out as they are stored; the 24-byte measurement records of
+ * older schemas, the event records and the batch framing repeat a lot within
+ * a few hundred bytes. This encoder writes the heatshrink bitstream (window
+ * 2^BLE_DATA_COMPRESS_WINDOW_BITS, lookahead 2^BLE_DATA_COMPRESS_LOOKAHEAD_BITS,
+ * the configuration of the heatshrink decoder the OTA patcher already carries):
+ *   literal:  1, byte (8 bits)
+ *   backref:  0, distance - 1 (window bits), length - 1 (lookahead bits)
+ * MSB first, the last byte padded with zero bits, so stock heatshrink decoders
+ * and the one in grinder-ble.py read it unchanged.
+ *
+ * Raw bytes are written straight into the input buffer (input_space/commit);
+ * poll() encodes as much as fits its output and keeps a lookahead's worth of
+ * input back until finish is set, so matches are not cut at read boundaries.
+ * The match search is a plain scan of the window, bounded by its 256 bytes,
+ * and all state is in the object: no allocation, one export at a time.
+ */
+class ExportCompressor {
+public:
+    static constexpr size_t WINDOW_BYTES = 1u << BLE_DATA_COMPRESS_WINDOW_BITS;
+    static constexpr size_t LOOKAHEAD_BYTES = 1u << BLE_DATA_COMPRESS_LOOKAHEAD_BITS;
+
+    void reset();
+
+    // Free input room at *tail; fill some of it, then commit what was written
+    size_t input_space(uint8_t** tail);
+    void commit(size_t bytes);
+
+    // Encoded bytes written to out; finish: the input is complete, encode and flush all of it
+    size_t poll(uint8_t* out, size_t capacity, bool finish);
+    bool is_drained() const { return pos == end && pending_bits == 0; }
+
+    uint32_t get_input_bytes() const { return input_total; }
+
+private:
+    static constexpr uint8_t MAX_CODE_BITS = 1 + BLE_DATA_COMPRESS_WINDOW_BITS + BLE_DATA_COMPRESS_LOOKAHEAD_BITS;
+    static constexpr uint8_t MIN_MATCH_BYTES = 2;   // Shorter matches cost more bits than literals
+
+    uint8_t buffer[WINDOW_BYTES + BLE_DATA_COMPRESS_INPUT_BYTES];
+    size_t pos = 0;                     // Next byte to encode; the window is the bytes before it
+    size_t end = 0;                     // Input committed so far
+    uint32_t input_total = 0;
+    uint8_t pending = 0;                // Output bits not yet a whole byte, left-aligned
+    uint8_t pending_bits = 0;
+
+    size_t find_match(size_t max_length, size_t* distance) const;
+    void put_bits(uint8_t* out, size_t* written, uint16_t value, uint8_t count);
+};
@@ -2,20 +2,61 @@
 #include <cstdarg>
 #include <Arduino.h>
 #include <esp_system.h>
-#include <LittleFS.h>
-#include <nvs_flash.h>
-#include <nvs.h>
-#include "../system/performance_monitor.h"
-#include "../system/statistics_manager.h"
+#include "../system/perf_counters.h"
+#include "../system/config_store.h"
 #include "../system/diagnostics_controller.h"
+#include "../system/radio_coexistence.h"
+#include "../system/memory_arena.h"
+#include "../system/trace.h"
+#include "../system/telemetry.h"
+#include "../system/hot_path_benchmark.h"
+#include "../system/storage_benchmark.h"
+#include "../system/noise_spectrum.h"
+#include "../system/grind_loop_profiler.h"
+#include "../system/crash_snapshot.h"
+#include "../system/binary_writer.h"
+#include "../system/statistics_manager.h"
+#include "../system/state_machine.h"
 #include "../config/constants.h"
-#include "../config/user.h"
-#include "../config/grind_control.h"
 #include "../config/build_info.h"
 #include "../logging/grind_logging.h"
-#include "../hardware/hardware_manager.h"
+#include "../logging/session_rollups.h"
+#include "../tasks/task_manager.h"
+#include "../tasks/weight_sampling_task.h"
 #include "../hardware/WeightSensor.h"
-#include "../controllers/grind_controller.h"
+#include "../network/mqtt_manager.h"
+#include "../controllers/grind_channels.h"
+#include "../controllers/profile_controller.h"
+#include "../controllers/profile_store.h"
+#include "../controllers/order_queue.h"
+#if defined(CONFIG_BT_NIMBLE_ENABLED)
+#include <host/ble_hs.h>
+#endif
+
+// The BLE controller/host core is fixed by sdkconfig, not at runtime
+#if defined(CONFIG_BT_CTRL_PINNED_TO_CORE) && CONFIG_BT_CTRL_PINNED_TO_CORE != SYS_BLE_STACK_CORE
+#warning "BT controller is not pinned to SYS_BLE_STACK_CORE - check custom_sdkconfig in platformio.ini"
+#endif
+#if defined(CONFIG_BT_BLUEDROID_PINNED_TO_CORE) && CONFIG_BT_BLUEDROID_PINNED_TO_CORE != SYS_BLE_STACK_CORE
+#warning "Bluedroid host is not pinned to SYS_BLE_STACK_CORE - check custom_sdkconfig in platformio.ini"
+#endif
+#if defined(CONFIG_BT_NIMBLE_PINNED_TO_CORE) && CONFIG_BT_NIMBLE_PINNED_TO_CORE != SYS_BLE_STACK_CORE
+#warning "NimBLE host is not pinned to SYS_BLE_STACK_CORE - check custom_sdkconfig in platformio.ini"
+#endif
+
+// Bluedroid registers each attribute through its BTC task and wants settling time
+// between GATT calls and before advertising again; NimBLE builds the GATT table in
+// the caller, registers it at start and restarts advertising at once
+static void settle_bluedroid(uint32_t delay_ms) {
+#if !defined(CONFIG_BT_NIMBLE_ENABLED)
+    delay(delay_ms);
+#endif
+}
+
+#if defined(CONFIG_BT_NIMBLE_MAX_CONNECTIONS)
+static_assert(BLE_MAX_CONNECTIONS <= CONFIG_BT_NIMBLE_MAX_CONNECTIONS,
+              "BLE_MAX_CONNECTIONS needs CONFIG_BT_NIMBLE_MAX_CONNECTIONS raised in platformio.ini");
+#endif
 
 BluetoothManager::BluetoothManager()
     : ble_server(nullptr)
@@ -30,6 +71,7 @@ BluetoothManager::BluetoothManager()
     , data_control_characteristic(nullptr)
     , data_transfer_characteristic(nullptr)
     , data_status_characteristic(nullptr)
+    , data_telemetry_characteristic(nullptr)
     , debug_rx_characteristic(nullptr)
     , debug_tx_characteristic(nullptr)
     , sysinfo_system_characteristic(nullptr)
@@ -37,22 +79,54 @@ BluetoothManager::BluetoothManager()
     , sysinfo_hardware_characteristic(nullptr)
     , sysinfo_sessions_characteristic(nullptr)
     , sysinfo_diagnostics_characteristic(nullptr)
+    , peers{}
+    , peer_count(0)
+    , writer_conn_id(BLE_CONN_NONE)
+    , export_owner(BLE_CONN_NONE)
+    , ota_owner(BLE_CONN_NONE)
     , device_connected(false)
     , ble_enabled(false), debug_stream_active(false)
     , enable_time(0)
     , timeout_ms(BLE_AUTO_DISABLE_TIMEOUT_MS)
     , last_disconnect_time(0)
+    , ota_ack_pending(false)
+    , ota_end_pending(false)
+    , ota_over_ble(false)
+    , ota_acked_bytes(0)
+    , ota_resume_pending(false)
     , data_export_in_progress(false)
     , data_status(BLE_DATA_IDLE)
     , current_chunk(0)
     , next_chunk_time(0)
+    , export_trickle_ms(0)
+    , bulk_transfer(false)
+    , batch_export(false)
+    , query_export(false)
+    , transfer_credits(0)
+    , transfer_bytes_sent(0)
+    , last_progress_time(0)
     , ui_status_queue(nullptr)
     , diagnostic_report_pending(false)
-    , diagnostic_report_in_progress(false) {
+    , trace_start_pending(false)
+    , trace_start_duration_ms(0)
+    , trace_dump_pending(false)
+    , telemetry_start_pending(false)
+    , telemetry_rate_hz(0)
+    , telemetry_stop_pending(false)
+    , last_telemetry_notify_ms(0)
+    , telemetry_stream(&telemetry)
+    , sysinfo_format(BLE_SYSINFO_FORMAT_BINARY)
+    , sysinfo_interval_ms(BLE_SYSINFO_REFRESH_INTERVAL_MS)
+    , last_sysinfo_update_ms(0)
+    , sysinfo_refresh_pending(false)
+    , ui_benchmark_requested(false)
+    , transfer_conn_id(BLE_CONN_NONE)
+    , transfer_session_active(false)
+    , last_transfer_activity_ms(0) {
 }
 
 BluetoothManager::~BluetoothManager() {
-    disable();
+    shutdown();
 }
 
 void BluetoothManager::init(Preferences* prefs) {
@@ -82,7 +156,9 @@ void BluetoothManager::enqueue_ui_status(const char* status) {
         msg.text[sizeof(msg.text) - 1] = '\0';
     }
     // Non-blocking send; drop if full to avoid blocking BLE task
-    xQueueSend(ui_status_queue, &msg, 0);
+    if (xQueueSend(ui_status_queue, &msg, 0) == pdPASS && ui_status_consumer) {
+        xTaskNotify(ui_status_consumer, SYS_UI_WAKE_NOTIFY_BIT, eSetBits);
+    }
 }
 
 bool BluetoothManager::dequeue_ui_status(char* out, size_t out_len) {
@@ -112,136 +188,167 @@ void BluetoothManager::enable(unsigned long timeout_ms) {
     enable_time = millis();
     last_disconnect_time = enable_time; // Start disconnected timeout from enable time
     
-    // Initialize BLE with delays for power stability
+    // The stack and GATT database outlive disable(); after the first enable only advertising restarts
+    if (!ble_server) {
+        init_stack();
+    }
+    
+    ble_enabled = true;
+    set_ota_status(BLE_OTA_READY);
+    
+    // Initialize system information
+    refresh_system_info();
+    
+    start_advertising();
+    log("Bluetooth: Ready - device is advertising (%lum timeout)\n", timeout_minutes);
+}
+
+// One-time bring-up of the stack, GATT database and advertising data
+void BluetoothManager::init_stack() {
+    // Initialize BLE (Bluedroid with delays for power stability). The controller ISR is
+    // allocated on the calling core, so this must not run on the realtime core.
+    if (xPortGetCoreID() == SYS_CORE_REALTIME) {
+        log("WARNING: BLE init called on Core %d - controller interrupts will share the sampling core\n",
+            xPortGetCoreID());
+    }
     BLEDevice::init(BLE_DEVICE_NAME);
+    verify_stack_core_affinity();
     
     // Request a larger MTU to improve throughput when the client supports it.
     // Some platforms (e.g., macOS/iOS) may ignore this request and keep a lower MTU.
     // That's fine — we also keep chunk sizes small and paced below.
     BLEDevice::setMTU(517);
-    delay(BLE_INIT_STACK_DELAY_MS);
+    settle_bluedroid(BLE_INIT_STACK_DELAY_MS);
     
     ble_server = BLEDevice::createServer();
-    delay(BLE_INIT_SERVER_DELAY_MS);
+    settle_bluedroid(BLE_INIT_SERVER_DELAY_MS);
     ble_server->setCallbacks(this);
     
     // Create OTA service
     ota_service = ble_server->createService(BLE_OTA_SERVICE_UUID);
-    delay(BLE_INIT_SERVICE_DELAY_MS);
+    settle_bluedroid(BLE_INIT_SERVICE_DELAY_MS);
     
+    // Write without response: the host paces itself by the window acks on the status characteristic
     ota_data_characteristic = ota_service->createCharacteristic(
         BLE_OTA_DATA_CHAR_UUID,
-        BLECharacteristic::PROPERTY_WRITE
+        BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR
     );
     ota_data_characteristic->setCallbacks(this);
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     ota_control_characteristic = ota_service->createCharacteristic(
         BLE_OTA_CONTROL_CHAR_UUID,
         BLECharacteristic::PROPERTY_WRITE
     );
     ota_control_characteristic->setCallbacks(this);
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     ota_status_characteristic = ota_service->createCharacteristic(
         BLE_OTA_STATUS_CHAR_UUID,
         BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
     );
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     build_number_characteristic = ota_service->createCharacteristic(
         BLE_OTA_BUILD_NUMBER_CHAR_UUID,
         BLECharacteristic::PROPERTY_READ
     );
     build_number_characteristic->setValue(ota_handler.get_build_number().c_str());
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     // Create measurement data service
     data_service = ble_server->createService(BLE_DATA_SERVICE_UUID);
-    delay(BLE_INIT_SERVICE_DELAY_MS);
+    settle_bluedroid(BLE_INIT_SERVICE_DELAY_MS);
     
+    // Write without response lets the host grant credits without a round trip
     data_control_characteristic = data_service->createCharacteristic(
         BLE_DATA_CONTROL_CHAR_UUID,
-        BLECharacteristic::PROPERTY_WRITE
+        BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR
     );
     data_control_characteristic->setCallbacks(this);
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     data_transfer_characteristic = data_service->createCharacteristic(
         BLE_DATA_TRANSFER_CHAR_UUID,
         BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
     );
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     data_status_characteristic = data_service->createCharacteristic(
         BLE_DATA_STATUS_CHAR_UUID,
         BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
     );
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    
+    data_telemetry_characteristic = data_service->createCharacteristic(
+        BLE_DATA_TELEMETRY_CHAR_UUID,
+        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
+    );
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     // Create debug service (Nordic UART)
     debug_service = ble_server->createService(BLE_DEBUG_SERVICE_UUID);
-    delay(BLE_INIT_SERVICE_DELAY_MS);
+    settle_bluedroid(BLE_INIT_SERVICE_DELAY_MS);
 
     debug_rx_characteristic = debug_service->createCharacteristic(
         BLE_DEBUG_RX_CHAR_UUID,
         BLECharacteristic::PROPERTY_WRITE
     );
     debug_rx_characteristic->setCallbacks(this);
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
 
     debug_tx_characteristic = debug_service->createCharacteristic(
         BLE_DEBUG_TX_CHAR_UUID,
         BLECharacteristic::PROPERTY_NOTIFY
     );
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     // Create system info service
     sysinfo_service = ble_server->createService(BLE_SYSINFO_SERVICE_UUID);
-    delay(BLE_INIT_SERVICE_DELAY_MS);
+    settle_bluedroid(BLE_INIT_SERVICE_DELAY_MS);
     
     sysinfo_system_characteristic = sysinfo_service->createCharacteristic(
         BLE_SYSINFO_SYSTEM_CHAR_UUID,
         BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
     );
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     sysinfo_performance_characteristic = sysinfo_service->createCharacteristic(
         BLE_SYSINFO_PERFORMANCE_CHAR_UUID,
         BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
     );
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     sysinfo_hardware_characteristic = sysinfo_service->createCharacteristic(
         BLE_SYSINFO_HARDWARE_CHAR_UUID,
         BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
     );
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
     
     sysinfo_sessions_characteristic = sysinfo_service->createCharacteristic(
         BLE_SYSINFO_SESSIONS_CHAR_UUID,
         BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
     );
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
 
     sysinfo_diagnostics_characteristic = sysinfo_service->createCharacteristic(
         BLE_SYSINFO_DIAGNOSTICS_CHAR_UUID,
         BLECharacteristic::PROPERTY_WRITE
     );
     sysinfo_diagnostics_characteristic->setCallbacks(this);
-    delay(BLE_INIT_CHARACTERISTIC_DELAY_MS);
+    settle_bluedroid(BLE_INIT_CHARACTERISTIC_DELAY_MS);
 
     ota_service->start();
-    delay(BLE_INIT_START_DELAY_MS);
+    settle_bluedroid(BLE_INIT_START_DELAY_MS);
     
     data_service->start();
-    delay(BLE_INIT_START_DELAY_MS);
+    settle_bluedroid(BLE_INIT_START_DELAY_MS);
     
     debug_service->start();
-    delay(BLE_INIT_START_DELAY_MS);
+    settle_bluedroid(BLE_INIT_START_DELAY_MS);
     
     sysinfo_service->start();
-    delay(BLE_INIT_START_DELAY_MS);
+    settle_bluedroid(BLE_INIT_START_DELAY_MS);
     
     BLEAdvertising* advertising = BLEDevice::getAdvertising();
     advertising->addServiceUUID(BLE_OTA_SERVICE_UUID);
@@ -261,48 +368,91 @@ void BluetoothManager::enable(unsigned long timeout_ms) {
     sr.setName(BLE_DEVICE_NAME);
     advertising->setScanResponseData(sr);
     
-    delay(BLE_INIT_ADVERTISING_DELAY_MS);
-    
-    ble_enabled = true;
-    set_ota_status(BLE_OTA_READY);
-    
-    // Initialize system information
-    refresh_system_info();
-    
-    start_advertising();
-    log("Bluetooth: Ready - device is advertising (%lum timeout)\n", timeout_minutes);
+    settle_bluedroid(BLE_INIT_ADVERTISING_DELAY_MS);
 }
 
 void BluetoothManager::enable_during_bootup() {
-    Preferences prefs;
-    prefs.begin("bluetooth", true);
-    if (prefs.getBool("startup", true)) {
+    if (config_store.get_flag(ConfigFlag::BLE_STARTUP)) {
         enable(BLE_BOOTUP_AUTO_DISABLE_TIMEOUT_MS);
     }
-    prefs.end();
 }
 
+bool BluetoothManager::verify_stack_core_affinity() {
+    // Controller and host task names for Bluedroid and NimBLE builds
+    static const char* const stack_task_names[] = {
+        "btController", "BTC_TASK", "BTU_TASK", "nimble_host"
+    };
+    
+    bool isolated = true;
+    for (const char* name : stack_task_names) {
+        TaskHandle_t handle = xTaskGetHandle(name);
+        if (!handle) {
+            continue;
+        }
+        BaseType_t core = xTaskGetCoreID(handle);
+        if (core != SYS_BLE_STACK_CORE) {
+            isolated = false;
+            log("WARNING: BLE task %s runs on %s (expected Core %d)\n", name,
+                core == tskNO_AFFINITY ? "any core" : (core == 0 ? "Core 0" : "Core 1"),
+                SYS_BLE_STACK_CORE);
+        }
+    }
+    if (isolated) {
+        log("Bluetooth: Stack tasks pinned to Core %d\n", SYS_BLE_STACK_CORE);
+    }
+    return isolated;
+}
+
+// Radio idle: the link is dropped and advertising stops, but the stack and its GATT
+// database stay up with the controller in modem sleep, so the next enable() only
+// restarts advertising
 void BluetoothManager::disable() {
     if (!ble_enabled) return;
     
-    log("Bluetooth: Disabling BLE and restoring normal power...\n");
+    log("Bluetooth: Radio idle, restoring normal power...\n");
     
-    if (ota_handler.is_ota_active()) {
-        ota_handler.abort_ota();
+    // Kept for a RESUME from the host when it reconnects (BLE_OTA_RESUME_TIMEOUT_MS)
+    if (ota_over_ble && ota_handler.is_ota_active()) {
+        ota_handler.park_ota();
+        ota_end_pending = false;
+        ota_resume_pending = false;
     }
     
     if (data_export_in_progress) {
         stop_data_export();
     }
+    telemetry_stream->stop();
     
-    stop_advertising();
-    delay(BLE_SHUTDOWN_ADVERTISING_DELAY_MS);
+    // Cleared first so onDisconnect() does not advertise again
+    ble_enabled = false;
+    BLEDevice::stopAdvertising();
+    if (ble_server) {
+        for (const Peer& peer : peers) {
+            if (peer.active) {
+                ble_server->disconnect(peer.conn_id);
+            }
+        }
+    }
+    debug_stream_active = false;
     
+    // Restore normal power settings
+    ota_handler.restore_normal_power_mode();
+    log("Bluetooth: Radio idle\n");
+}
+
+void BluetoothManager::shutdown() {
+    disable();
+    if (!ble_server) return;
+    
+    delay(BLE_SHUTDOWN_ADVERTISING_DELAY_MS);
     log("Bluetooth: Deinitializing BLE stack...\n");
     BLEDevice::deinit(false);
     delay(BLE_SHUTDOWN_DEINIT_DELAY_MS);
     
-    ble_enabled = false;
+    for (Peer& peer : peers) {
+        peer.active = false;
+    }
+    peer_count = 0;
     device_connected = false;
     ble_server = nullptr;
     ota_service = nullptr;
@@ -316,17 +466,15 @@ void BluetoothManager::disable() {
     data_control_characteristic = nullptr;
     data_transfer_characteristic = nullptr;
     data_status_characteristic = nullptr;
+    data_telemetry_characteristic = nullptr;
     debug_rx_characteristic = nullptr;
     debug_tx_characteristic = nullptr;
     sysinfo_system_characteristic = nullptr;
     sysinfo_performance_characteristic = nullptr;
     sysinfo_hardware_characteristic = nullptr;
     sysinfo_sessions_characteristic = nullptr;
-    debug_stream_active = false;
-    
-    // Restore normal power settings
-    ota_handler.restore_normal_power_mode();
-    log("Bluetooth: Disable complete\n");
+    sysinfo_diagnostics_characteristic = nullptr;
+    log("Bluetooth: Shutdown complete\n");
 }
 
 void BluetoothManager::handle() {
@@ -346,22 +494,58 @@ void BluetoothManager::handle() {
         timeout_ms = BLE_AUTO_DISABLE_TIMEOUT_MS;
     }
     
+    // OTA window acks and the deferred END
+    update_ota_transfer();
+
     // Handle data export updates
     update_data_export();
+    update_transfer_session();
 
-    // Run deferred diagnostic report generation on BLE task (not on NimBLE callback thread)
-    if (device_connected && debug_tx_characteristic && diagnostic_report_pending && !diagnostic_report_in_progress) {
-        diagnostic_report_in_progress = true;
+    // Diagnostic report, requested from the NimBLE callback and streamed from here a slice at a time
+    if (device_connected && debug_tx_characteristic && diagnostic_report_pending && !diagnostic_report.is_active()) {
         diagnostic_report_pending = false;
-        generate_diagnostic_report();
-        diagnostic_report_in_progress = false;
+        LOG_BLE("DIAGNOSTICS: Report started\n");
+        diagnostic_report.start();
+    }
+    update_diagnostic_report();
+    update_debug_log();
+
+    // Trace capture start, timeout and dump (deferred from the NimBLE callback as well)
+    if (trace_start_pending) {
+        trace_start_pending = false;
+        if (!trace.start(trace_start_duration_ms)) {
+            log("BLE_DEBUG: Trace capture unavailable\n");
+        }
     }
+    trace.service();
+    if (device_connected && debug_tx_characteristic && trace_dump_pending && !diagnostic_report.is_active()) {
+        trace_dump_pending = false;
+        send_trace_dump();
+    }
+
+    // Live telemetry, started and stopped from the NimBLE callback; it follows the selected grinder
+    Telemetry* selected_telemetry = &channel_telemetry(grind_channels.get_selected());
+    if (telemetry_stream != selected_telemetry && telemetry_stream->is_streaming() && !telemetry_stop_pending) {
+        telemetry_start_pending = true;
+    }
+    if (telemetry_stop_pending) {
+        telemetry_stop_pending = false;
+        telemetry_stream->stop();
+    }
+    if (device_connected && telemetry_start_pending) {
+        telemetry_start_pending = false;
+        last_telemetry_notify_ms = millis();
+        telemetry_stream->stop();
+        telemetry_stream = selected_telemetry;
+        telemetry_stream->start(telemetry_rate_hz);
+    }
+    update_telemetry();
     
-    // Update system info periodically if connected (every 10 seconds)
-    static unsigned long last_sysinfo_update = 0;
-    if (device_connected && millis() - last_sysinfo_update > 10000) {
+    // Update system info periodically if connected (BLE_DEBUG_CMD_SYSINFO_CONFIG sets the period)
+    if (device_connected && (sysinfo_refresh_pending || millis() - last_sysinfo_update_ms >= sysinfo_interval_ms)) {
+        sysinfo_refresh_pending = false;
         refresh_system_info();
-        last_sysinfo_update = millis();
+        last_sysinfo_update_ms = millis();
     }
 }
 
@@ -428,79 +612,302 @@ void BluetoothManager::stop_data_export() {
     current_chunk = 0;
     next_chunk_time = 0;
     current_file_session_id = 0;
+    bulk_transfer = false;
+    batch_export = false;
+    query_export = false;
+    transfer_credits.store(0);
     
     // Clean shutdown of stream
     data_stream.close_stream();
     
     set_data_status(BLE_DATA_IDLE);
+    export_owner = BLE_CONN_NONE;
 }
 
 void BluetoothManager::update_data_export() {
-    // Check if we need to send the next chunk
-    if (data_export_in_progress && millis() >= next_chunk_time) {
+    radio_coexistence.set_transfer(RadioWork::BLE_EXPORT, data_export_in_progress);
+    if (!data_export_in_progress) {
+        return;
+    }
+    // Flash reads and notify bursts wait for the grind; a trickle keeps the host from timing out
+    if (radio_coexistence.is_grind_active()) {
+        if (radio_coexistence.allow_trickle(RadioWork::BLE_EXPORT, millis(), &export_trickle_ms) &&
+            (!bulk_transfer || transfer_credits.load() > 0) && can_queue_notification(export_owner)) {
+            if (bulk_transfer) {
+                transfer_credits.fetch_sub(1);
+            }
+            send_next_data_chunk();
+        }
+        return;
+    }
+
+    if (!bulk_transfer) {
+        // Paced export for hosts that grant no credits
+        if (millis() >= next_chunk_time && send_next_data_chunk()) {
+            next_chunk_time = millis() + BLE_DATA_LEGACY_CHUNK_INTERVAL_MS;
+        }
+        return;
+    }
+
+    // Bulk export: burst while the host has credits and the controller has buffers
+    for (uint16_t burst = 0; burst < BLE_DATA_BULK_MAX_BURST && data_export_in_progress; burst++) {
+        if (transfer_credits.load() == 0 || !can_queue_notification(export_owner)) {
+            break;
+        }
+        // Spend the credit first: the last chunk ends the transfer and clears the credits
+        transfer_credits.fetch_sub(1);
         send_next_data_chunk();
     }
 }
 
-void BluetoothManager::send_next_data_chunk() {
-    if (!data_export_in_progress || !data_transfer_characteristic) {
+#if defined(CONFIG_BT_NIMBLE_ENABLED)
+// NimBLE copies each notification into an mbuf from the shared msys pool and fails
+// the notify once the pool is empty; the reserve keeps room for status notifies and
+// ATT responses queued on the same pass. Every link draws on the same pool.
+bool BluetoothManager::can_queue_notification(uint16_t conn_id) {
+    return ble_server && os_msys_num_free() > BLE_NIMBLE_NOTIFY_RESERVE_MBUFS;
+}
+#else
+// Bluedroid queues notifications without blocking; the controller's free ACL
+// buffers on each link the notify goes to are the congestion signal
+bool BluetoothManager::can_queue_notification(uint16_t conn_id) {
+    if (!ble_server) {
+        return false;
+    }
+    for (const Peer& peer : peers) {
+        if (peer.active && (conn_id == BLE_CONN_NONE || peer.conn_id == conn_id) &&
+            esp_ble_get_cur_sendable_packets_num(peer.conn_id) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+// One link's MTU, or for a notify to every subscriber the smallest, so no central gets it cut
+size_t BluetoothManager::get_data_chunk_payload_bytes(uint16_t conn_id) {
+    size_t payload = BLE_DATA_CHUNK_SIZE_BYTES;
+    if (!ble_server) {
+        return payload;
+    }
+    for (const Peer& peer : peers) {
+        if (!peer.active || (conn_id != BLE_CONN_NONE && peer.conn_id != conn_id)) {
+            continue;
+        }
+        uint16_t mtu = ble_server->getPeerMTU(peer.conn_id);
+        if (mtu > BLE_ATT_NOTIFY_HEADER_BYTES && (size_t)(mtu - BLE_ATT_NOTIFY_HEADER_BYTES) < payload) {
+            payload = mtu - BLE_ATT_NOTIFY_HEADER_BYTES;
+        }
+    }
+    return payload;
+}
+
+// BLE_CONN_NONE notifies every subscribed central through the characteristic value; a single
+// central gets the bytes directly and the value is left as it was
+void BluetoothManager::notify_peer(BLECharacteristic* characteristic, uint16_t conn_id, const uint8_t* data,
+                                   size_t size) {
+    if (!characteristic) {
+        return;
+    }
+    if (conn_id == BLE_CONN_NONE) {
+        characteristic->setValue((uint8_t*)data, size);
+        characteristic->notify();
+        return;
+    }
+    if (!find_peer(conn_id)) {
+        return;                             // The central left; nobody else wants its traffic
+    }
+#if defined(CONFIG_BT_NIMBLE_ENABLED)
+    struct os_mbuf* om = ble_hs_mbuf_from_flat(data, size);
+    if (om) {
+        ble_gatts_notify_custom(conn_id, characteristic->getHandle(), om);
+    }
+#else
+    esp_ble_gatts_send_indicate(ble_server->getGattsIf(), conn_id, characteristic->getHandle(), size,
+                                (uint8_t*)data, false);
+#endif
+}
+
+BluetoothManager::Peer* BluetoothManager::find_peer(uint16_t conn_id) {
+    if (conn_id == BLE_CONN_NONE) {
+        return nullptr;
+    }
+    for (Peer& peer : peers) {
+        if (peer.active && peer.conn_id == conn_id) {
+            return &peer;
+        }
+    }
+    return nullptr;
+}
+
+void BluetoothManager::add_peer(uint16_t conn_id, const uint8_t* address) {
+    Peer* slot = find_peer(conn_id);
+    for (Peer& peer : peers) {
+        if (!slot && !peer.active) {
+            slot = &peer;
+        }
+    }
+    if (!slot) {
+        log("BLE: No slot for connection %u\n", (unsigned)conn_id);
+        return;
+    }
+    if (!slot->active) {
+        peer_count++;
+    }
+    *slot = Peer{};
+    slot->active = true;
+    slot->conn_id = conn_id;
+#if !defined(CONFIG_BT_NIMBLE_ENABLED)
+    memcpy(slot->address, address, sizeof(esp_bd_addr_t));
+#endif
+    slot->sysinfo_interval_ms = BLE_SYSINFO_REFRESH_INTERVAL_MS;
+    device_connected = true;
+}
+
+void BluetoothManager::remove_peer(uint16_t conn_id) {
+    Peer* peer = find_peer(conn_id);
+    if (!peer) {
+        return;
+    }
+    peer->active = false;
+    peer_count--;
+    device_connected = peer_count > 0;
+}
+
+// Streams are shared by every central: each runs while at least one central wants it,
+// telemetry at the highest rate asked for (0 = every sample) and sysinfo at the shortest period
+void BluetoothManager::apply_peer_requests() {
+    bool debug_wanted = false;
+    bool telemetry_wanted = false;
+    bool every_sample = false;
+    uint16_t rate_hz = 0;
+    uint16_t interval_ms = BLE_SYSINFO_REFRESH_INTERVAL_MS;
+    bool first = true;
+    for (const Peer& peer : peers) {
+        if (!peer.active) {
+            continue;
+        }
+        debug_wanted |= peer.debug_stream;
+        if (peer.telemetry) {
+            telemetry_wanted = true;
+            every_sample |= peer.telemetry_rate_hz == 0;
+            rate_hz = peer.telemetry_rate_hz > rate_hz ? peer.telemetry_rate_hz : rate_hz;
+        }
+        interval_ms = first || peer.sysinfo_interval_ms < interval_ms ? peer.sysinfo_interval_ms : interval_ms;
+        first = false;
+    }
+    if (every_sample) {
+        rate_hz = 0;
+    }
+
+    debug_stream_active = debug_wanted;
+    sysinfo_interval_ms = interval_ms;
+    if (telemetry_wanted) {
+        if (!telemetry_stream->is_streaming() || rate_hz != telemetry_rate_hz) {
+            telemetry_rate_hz = rate_hz;
+            telemetry_stop_pending = false;
+            telemetry_start_pending = true;
+        }
+    } else {
+        telemetry_start_pending = false;
+        telemetry_stop_pending = true;
+    }
+}
+
+void BluetoothManager::send_data_progress() {
+    if (!data_status_characteristic) {
+        return;
+    }
+    unsigned long now = millis();
+    if (now - last_progress_time < BLE_DATA_PROGRESS_INTERVAL_MS) {
         return;
     }
+    last_progress_time = now;
+    uint8_t status_data[2] = { (uint8_t)BLE_DATA_EXPORTING, data_stream.get_progress_percent() };
+    notify_peer(data_status_characteristic, export_owner, status_data, sizeof(status_data));
+}
+
+// Returns true when a chunk went out; false when the transfer ended (complete or error) instead
+bool BluetoothManager::send_next_data_chunk() {
+    if (!data_export_in_progress || !data_transfer_characteristic) {
+        return false;
+    }
 
     // If client dropped mid-transfer, stop cleanly and avoid further notify attempts
     if (!device_connected) {
         stop_data_export();
         set_data_status(BLE_DATA_ERROR);
-        return;
+        return false;
     }
     
     uint8_t buffer[BLE_DATA_CHUNK_SIZE_BYTES];
     size_t actual_size = 0;
     
-    // Per-file streaming only
-    if (current_file_session_id == 0) {
+    if (!batch_export && !query_export && current_file_session_id == 0) {
         log("Bluetooth Data: No file session active for chunk request\n");
         stop_data_export();
         set_data_status(BLE_DATA_ERROR);
-        return;
+        return false;
     }
     
-    bool has_data = data_stream.read_file_chunk(buffer, sizeof(buffer), &actual_size);
+    size_t payload_bytes = get_data_chunk_payload_bytes(export_owner);
+    bool has_data = data_stream.read_chunk(buffer, payload_bytes, &actual_size);
     
     if (has_data && actual_size > 0) {
-        // Send the data chunk
-        data_transfer_characteristic->setValue(buffer, actual_size);
-        data_transfer_characteristic->notify();
+        trace.instant(TraceId::BLE_NOTIFY, (uint16_t)actual_size);
+        notify_peer(data_transfer_characteristic, export_owner, buffer, actual_size);
         
         current_chunk++;
-        
-        // Chunk sent (reduced logging)
-        
-        // Update progress
-        uint8_t progress = data_stream.get_progress_percent();
-        uint8_t status_data[2] = { (uint8_t)BLE_DATA_EXPORTING, progress };
-        if (data_status_characteristic) {
-            data_status_characteristic->setValue(status_data, 2);
-            data_status_characteristic->notify();
+        transfer_bytes_sent += actual_size;
+        send_data_progress();
+        // Finish with the last chunk rather than on a later read, which would need another credit
+        if (data_stream.is_complete()) {
+            finish_data_export();
         }
-        
-        // Pace notifications to avoid overflowing BLE buffers/OS queues.
-        // Combined with smaller chunk size this greatly reduces blocking in notify().
-        next_chunk_time = millis() + 25; // ~6.4 KB/s at 160 B per 25 ms
+        return true;
     }
     
-    // Check if file transfer is complete
-    if (!has_data) {
-        log("Bluetooth Data: File transfer complete for session %lu - sent %d chunks.\n", current_file_session_id, current_chunk);
-        data_export_in_progress = false;
-        current_chunk = 0;
-        current_file_session_id = 0;
-        
-        data_stream.close_stream();
-        
+    finish_data_export();
+    return false;
+}
+
+void BluetoothManager::finish_data_export() {
+    if (data_stream.is_compressed()) {
+        uint32_t raw_bytes = data_stream.get_raw_bytes_read();
+        log("Bluetooth Data: Compressed %lu bytes to %lu (%.2fx)\n", (unsigned long)raw_bytes,
+            (unsigned long)transfer_bytes_sent, transfer_bytes_sent > 0 ? (float)raw_bytes / transfer_bytes_sent : 0.0f);
+    }
+    if (batch_export) {
+        log("Bluetooth Data: Batch complete - %lu sessions, %d chunks (%lu bytes).\n",
+            (unsigned long)data_stream.get_batch_session_count(), current_chunk, (unsigned long)transfer_bytes_sent);
+    } else if (query_export) {
+        log("Bluetooth Data: Query reply sent - %d chunks (%lu bytes).\n",
+            current_chunk, (unsigned long)transfer_bytes_sent);
+    } else {
+        log("Bluetooth Data: File transfer complete for session %lu - sent %d chunks (%lu bytes).\n",
+            current_file_session_id, current_chunk, (unsigned long)transfer_bytes_sent);
+    }
+    data_export_in_progress = false;
+    batch_export = false;
+    query_export = false;
+    current_chunk = 0;
+    current_file_session_id = 0;
+    transfer_credits.store(0);
+    
+    data_stream.close_stream();
+    
+    if (bulk_transfer) {
+        // The byte count lets the host wait for chunks still in flight instead of a fixed drain delay
+        bulk_transfer = false;
+        data_status = BLE_DATA_COMPLETE;
+        uint8_t status_data[5] = { (uint8_t)BLE_DATA_COMPLETE };
+        memcpy(status_data + 1, &transfer_bytes_sent, sizeof(transfer_bytes_sent));
+        notify_peer(data_status_characteristic, export_owner, status_data, sizeof(status_data));
+    } else {
         delay(200); // Give the BLE buffer time to clear
         set_data_status(BLE_DATA_COMPLETE);
     }
+    export_owner = BLE_CONN_NONE;
 }
 
 float BluetoothManager::get_data_export_progress() const {
@@ -529,8 +936,7 @@ void BluetoothManager::send_measurement_count() {
 
 void BluetoothManager::send_log_message(const char* message) {
     if (debug_stream_active && device_connected && debug_tx_characteristic) {
-        debug_tx_characteristic->setValue((uint8_t*)message, strlen(message));
-        debug_tx_characteristic->notify();
+        debug_log.append(message, strlen(message));
     }
 }
 
@@ -547,50 +953,50 @@ void BluetoothManager::send_file_list() {
         return;
     }
     
-    // Get list of session files
-    const uint32_t max_sessions = 100;  // Limit to prevent memory issues
-    uint32_t* session_ids = (uint32_t*)malloc(max_sessions * sizeof(uint32_t));
-    if (!session_ids) {
-        log("ERROR: Failed to allocate memory for session list\n");
-        set_data_status(BLE_DATA_ERROR);
-        return;
-    }
-    
-    uint32_t session_count = data_stream.get_session_list(session_ids, max_sessions);
-    
-    // Send file list: [session_count:4][session_id1:4][session_id2:4]...
-    size_t total_size = 4 + (session_count * 4);
-    uint8_t* buffer = (uint8_t*)malloc(total_size);
-    if (!buffer) {
-        free(session_ids);
-        log("ERROR: Failed to allocate memory for file list buffer\n");
-        set_data_status(BLE_DATA_ERROR);
-        return;
-    }
+    // The arena scope ends before the delay below, so other tasks' file operations don't wait on it
+    {
+        // Get list of session files
+        const uint32_t max_sessions = 100;  // Limit to prevent memory issues
+        ArenaScope scope(file_arena);
+        uint32_t* session_ids = scope.allocate_array<uint32_t>(max_sessions);
+        if (!session_ids) {
+            log("ERROR: Failed to allocate memory for session list\n");
+            set_data_status(BLE_DATA_ERROR);
+            return;
+        }
     
-    // Write session count (little-endian)
-    buffer[0] = session_count & 0xFF;
-    buffer[1] = (session_count >> 8) & 0xFF;
-    buffer[2] = (session_count >> 16) & 0xFF;
-    buffer[3] = (session_count >> 24) & 0xFF;
+        uint32_t session_count = data_stream.get_session_list(session_ids, max_sessions);
     
-    // Write session IDs
-    for (uint32_t i = 0; i < session_count; i++) {
-        uint32_t offset = 4 + (i * 4);
-        buffer[offset + 0] = session_ids[i] & 0xFF;
-        buffer[offset + 1] = (session_ids[i] >> 8) & 0xFF;
-        buffer[offset + 2] = (session_ids[i] >> 16) & 0xFF;
-        buffer[offset + 3] = (session_ids[i] >> 24) & 0xFF;
-    }
+        // Send file list: [session_count:4][session_id1:4][session_id2:4]...
+        size_t total_size = 4 + (session_count * 4);
+        uint8_t* buffer = scope.allocate_array<uint8_t>(total_size);
+        if (!buffer) {
+            log("ERROR: Failed to allocate memory for file list buffer\n");
+            set_data_status(BLE_DATA_ERROR);
+            return;
+        }
     
-    // Send the file list
-    data_transfer_characteristic->setValue(buffer, total_size);
-    data_transfer_characteristic->notify();
+        // Write session count (little-endian)
+        buffer[0] = session_count & 0xFF;
+        buffer[1] = (session_count >> 8) & 0xFF;
+        buffer[2] = (session_count >> 16) & 0xFF;
+        buffer[3] = (session_count >> 24) & 0xFF;
+    
+        // Write session IDs
+        for (uint32_t i = 0; i < session_count; i++) {
+            uint32_t offset = 4 + (i * 4);
+            buffer[offset + 0] = session_ids[i] & 0xFF;
+            buffer[offset + 1] = (session_ids[i] >> 8) & 0xFF;
+            buffer[offset + 2] = (session_ids[i] >> 16) & 0xFF;
+            buffer[offset + 3] = (session_ids[i] >> 24) & 0xFF;
+        }
     
-    log("Bluetooth Data: Sent file list with %lu sessions\n", session_count);
+        // Send the file list
+        data_transfer_characteristic->setValue(buffer, total_size);
+        data_transfer_characteristic->notify();
     
-    free(session_ids);
-    free(buffer);
+        log("Bluetooth Data: Sent file list with %lu sessions\n", session_count);
+    }
     
     // Give the BLE buffer time to transmit the data before sending status
     delay(100);
@@ -599,15 +1005,39 @@ void BluetoothManager::send_file_list() {
     set_data_status(BLE_DATA_COMPLETE);
 }
 
-void BluetoothManager::send_individual_file(uint32_t session_id) {
+bool BluetoothManager::can_start_export() {
     if (!ble_enabled || !device_connected) {
         log("Bluetooth Data: Cannot start file transfer - BLE not enabled or not connected\n");
         set_data_status(BLE_DATA_ERROR);
-        return;
+        return false;
     }
     
     if (data_export_in_progress) {
         log("❌ FILE REQUEST ATTEMPT - Transfer already in progress! Client sent duplicate REQUEST command.\n");
+        return false;
+    }
+    return true;
+}
+
+// Runs from the data control write: the export belongs to the central that sent it
+void BluetoothManager::begin_export(uint16_t credits, uint8_t flags) {
+    export_owner = writer_conn_id;
+    if (flags & BLE_DATA_EXPORT_COMPRESSED) {
+        data_stream.enable_compression();
+    }
+    bulk_transfer = credits > 0;
+    current_chunk = 0;
+    transfer_bytes_sent = 0;
+    transfer_credits.store(credits < BLE_DATA_BULK_MAX_CREDITS ? credits : BLE_DATA_BULK_MAX_CREDITS);
+    next_chunk_time = millis(); // Start immediately
+    last_progress_time = millis();
+    set_data_status(BLE_DATA_EXPORTING);
+    data_export_in_progress = true;
+    state_machine.post(UIState::OTA_UPDATE, StateEventSource::BLUETOOTH);
+}
+
+void BluetoothManager::send_individual_file(uint32_t session_id, uint16_t credits, uint8_t flags) {
+    if (!can_start_export()) {
         return;
     }
     
@@ -618,13 +1048,86 @@ void BluetoothManager::send_individual_file(uint32_t session_id) {
         return;
     }
     
-    log("Bluetooth Data: Starting individual file transfer for session %lu\n", session_id);
+    log("Bluetooth Data: Starting %s file transfer for session %lu (%lu bytes, %u B chunks)\n",
+        credits > 0 ? "bulk" : "paced", session_id, (unsigned long)data_stream.get_file_size(),
+        (unsigned)get_data_chunk_payload_bytes());
     
-    data_export_in_progress = true;
+    batch_export = false;
+    query_export = false;
     current_file_session_id = session_id;
-    current_chunk = 0;
-    next_chunk_time = millis(); // Start immediately
-    set_data_status(BLE_DATA_EXPORTING);
+    begin_export(credits, flags);
+}
+
+// Every session from start_session_id on, back to back; resume_offset skips bytes of the first
+// one that an interrupted batch already delivered
+void BluetoothManager::send_session_batch(uint32_t start_session_id, uint32_t resume_offset, uint16_t credits,
+                                          uint8_t flags) {
+    if (!can_start_export()) {
+        return;
+    }
+    
+    if (credits == 0) {
+        log("Bluetooth Data: Batch export needs credits\n");
+        set_data_status(BLE_DATA_ERROR);
+        return;
+    }
+    
+    data_stream.initialize_batch_stream(start_session_id, resume_offset);
+    log("Bluetooth Data: Starting batch from session %lu (offset %lu, %u B chunks)\n",
+        (unsigned long)start_session_id, (unsigned long)resume_offset, (unsigned)get_data_chunk_payload_bytes());
+    
+    batch_export = true;
+    query_export = false;
+    current_file_session_id = 0;
+    begin_export(credits, flags);
+}
+
+// Matching records, or with SESSION_QUERY_FLAG_SESSIONS the matching session files as a batch;
+// a batch resumes with first_session_id at the interrupted session and resume_offset into it
+void BluetoothManager::send_session_query(const SessionQuery& query, uint16_t credits, uint32_t resume_offset,
+                                          uint8_t flags) {
+    if (!can_start_export()) {
+        return;
+    }
+
+    if (query.flags & SESSION_QUERY_FLAG_SESSIONS) {
+        if (credits == 0) {
+            log("Bluetooth Data: Session query batch needs credits\n");
+            set_data_status(BLE_DATA_ERROR);
+            return;
+        }
+        if (!data_stream.initialize_batch_stream(query.first_session_id, resume_offset, &query)) {
+            set_data_status(BLE_DATA_ERROR);
+            return;
+        }
+        batch_export = true;
+        query_export = false;
+    } else {
+        if (!data_stream.initialize_query_stream(query)) {
+            set_data_status(BLE_DATA_ERROR);
+            return;
+        }
+        batch_export = false;
+        query_export = true;
+    }
+    current_file_session_id = 0;
+    begin_export(credits, flags);
+}
+
+// The session file struct layout, so host tools decode with the firmware's offsets and types
+void BluetoothManager::send_log_layout(uint16_t credits, uint8_t flags) {
+    if (!can_start_export()) {
+        return;
+    }
+
+    if (!data_stream.initialize_layout_stream()) {
+        set_data_status(BLE_DATA_ERROR);
+        return;
+    }
+    batch_export = false;
+    query_export = true;
+    current_file_session_id = 0;
+    begin_export(credits, flags);
 }
 
 void BluetoothManager::log(const char* format, ...) {
@@ -643,21 +1146,52 @@ void BluetoothManager::log(const char* format, ...) {
     }
 }
 
+// Status goes to the central that owns the running OTA or export, otherwise to every subscriber
 void BluetoothManager::set_ota_status(BLEOTAStatus status) {
-    if (ota_status_characteristic) {
-        uint8_t status_value = static_cast<uint8_t>(status);
-        ota_status_characteristic->setValue(&status_value, 1);
-        ota_status_characteristic->notify();
-    }
+    uint8_t status_value = static_cast<uint8_t>(status);
+    notify_peer(ota_status_characteristic, ota_owner, &status_value, 1);
 }
 
 void BluetoothManager::set_data_status(BLEDataStatus status) {
     data_status = status;
-    if (data_status_characteristic) {
-        uint8_t status_value = static_cast<uint8_t>(status);
-        data_status_characteristic->setValue(&status_value, 1);
-        data_status_characteristic->notify();
+    uint8_t status_value = static_cast<uint8_t>(status);
+    notify_peer(data_status_characteristic, export_owner, &status_value, 1);
+}
+
+// [CMD][patch_size:4][is_full_update:1][build_length:1][build:N][version_length:1][version:N][patch_crc:4];
+// everything after the full-update flag is optional, the patch id needs the two length bytes before it
+bool BluetoothManager::parse_ota_start(const String& data, OtaStartRequest* request) {
+    if (data.length() < 6) {                // 1 + 4 + 1 bytes minimum (cmd + patch_size + full_update_flag)
+        return false;
+    }
+    request->patch_size = *(uint32_t*)(data.c_str() + 1);
+    request->is_full_update = data[5] != 0;
+    request->expected_build = "";
+    request->expected_firmware_version = "";
+    request->patch_crc = 0;
+
+    size_t offset = 6;
+    if (data.length() > offset) {
+        uint8_t build_length = data[offset++];
+        if (data.length() < offset + build_length) {
+            return true;
+        }
+        request->expected_build = String(data.c_str() + offset, build_length);
+        offset += build_length;
+    }
+    // Firmware version (backwards compatible extension)
+    if (data.length() > offset) {
+        uint8_t version_length = data[offset++];
+        if (data.length() < offset + version_length) {
+            return true;
+        }
+        request->expected_firmware_version = String(data.c_str() + offset, version_length);
+        offset += version_length;
+    }
+    if (data.length() >= offset + 4) {
+        memcpy(&request->patch_crc, data.c_str() + offset, 4);
     }
+    return true;
 }
 
 void BluetoothManager::handle_ota_control_command(BLECharacteristic* characteristic) {
@@ -666,81 +1200,174 @@ void BluetoothManager::handle_ota_control_command(BLECharacteristic* characteris
     
     uint8_t command = data[0];
     
+    // A running update answers only to its central; a parked one goes to whoever resumes it
+    if (ota_over_ble && ota_handler.is_ota_active() && !ota_handler.is_parked() && !is_owner(ota_owner)) {
+        log("Bluetooth OTA: Command 0x%02X refused - another central is updating\n", command);
+        uint8_t status_value = BLE_OTA_ERROR;
+        notify_peer(ota_status_characteristic, writer_conn_id, &status_value, 1);
+        return;
+    }
+    
     switch (command) {
         case BLE_OTA_CMD_START:
-            // New protocol: [CMD][patch_size:4][is_full_update:1][build_number_length:1][build_number:N]
-            if (data.length() >= 6) {  // 1 + 4 + 1 bytes minimum (cmd + patch_size + full_update_flag)
-                uint32_t patch_size = *(uint32_t*)(data.c_str() + 1);
-                bool is_full_update = data[5] != 0;
-                
-                log("Bluetooth OTA: Starting %s update (%lu KB)\n", 
-                    is_full_update ? "full" : "delta", (unsigned long)patch_size / 1024);
-                update_ui_status("Receiving update...");
-                
-                // Parse build number if present
-                String expected_build = "";
-                String expected_firmware_version = "";
-                size_t offset = 7;
-                
-                if (data.length() > 6) {
-                    uint8_t build_length = data[6];
-                    if (build_length > 0 && data.length() >= offset + build_length) {
-                        expected_build = String(data.c_str() + offset, build_length);
-                        log("Bluetooth OTA: Expected build after update: %s\n", expected_build.c_str());
-                        offset += build_length;
-                    }
-                    
-                    // Parse firmware version if present (backwards compatible extension)
-                    if (data.length() > offset) {
-                        uint8_t version_length = data[offset];
-                        offset++;
-                        if (version_length > 0 && data.length() >= offset + version_length) {
-                            expected_firmware_version = String(data.c_str() + offset, version_length);
-                            log("Bluetooth OTA: Expected firmware version after update: %s\n", expected_firmware_version.c_str());
-                        }
-                    }
-                }
-                
-                if (ota_handler.start_ota(patch_size, expected_build, is_full_update, expected_firmware_version)) {
-                    set_ota_status(BLE_OTA_RECEIVING);
-                } else {
-                    set_ota_status(BLE_OTA_ERROR);
-                }
-            } else {
+        case BLE_OTA_CMD_RESUME: {
+            OtaStartRequest request;
+            if (!parse_ota_start(data, &request)) {
                 log("Bluetooth OTA: ❌ Invalid start command format (need at least 6 bytes)\n");
                 set_ota_status(BLE_OTA_ERROR);
+                break;
+            }
+            if (request.expected_build.length() > 0) {
+                log("Bluetooth OTA: Expected build after update: %s\n", request.expected_build.c_str());
+            }
+            if (request.expected_firmware_version.length() > 0) {
+                log("Bluetooth OTA: Expected firmware version after update: %s\n",
+                    request.expected_firmware_version.c_str());
+            }
+
+            // RESUME continues a parked or mirrored update with this patch id, otherwise it starts over
+            if (command == BLE_OTA_CMD_RESUME &&
+                ota_handler.resume_ota(request.patch_size, request.patch_crc, request.is_full_update,
+                                       request.expected_build, request.expected_firmware_version)) {
+                log("Bluetooth OTA: Resuming %s update (%lu KB)\n", request.is_full_update ? "full" : "delta",
+                    (unsigned long)request.patch_size / 1024);
+                update_ui_status("Receiving update...");
+                ota_owner = writer_conn_id;
+                set_ota_status(BLE_OTA_RECEIVING);
+                ota_acked_bytes = 0;
+                ota_end_pending = false;
+                ota_ack_pending = false;
+                ota_resume_pending = true;      // Acked with the resume offset once drained
+                ota_over_ble = true;
+                break;
+            }
+            if (ota_handler.is_parked()) {
+                ota_handler.abort_ota();        // Another update replaces the parked one
+            }
+
+            log("Bluetooth OTA: Starting %s update (%lu KB)\n",
+                request.is_full_update ? "full" : "delta", (unsigned long)request.patch_size / 1024);
+            update_ui_status("Receiving update...");
+            if (ota_handler.start_ota(request.patch_size, request.expected_build, request.is_full_update,
+                                      request.expected_firmware_version, request.patch_crc)) {
+                ota_owner = writer_conn_id;
+                set_ota_status(BLE_OTA_RECEIVING);
+                ota_acked_bytes = 0;
+                ota_end_pending = false;
+                ota_ack_pending = true;
+                ota_resume_pending = false;
+                ota_over_ble = true;
+            } else {
+                set_ota_status(BLE_OTA_ERROR);
             }
             break;
+        }
             
         case BLE_OTA_CMD_END:            
             log("Bluetooth OTA: Received END command\n");
             LOG_OTA_DEBUG("BLE_OTA_CMD_END received, checking if OTA active...\n");
-            if (ota_handler.is_ota_active()) {
-                LOG_OTA_DEBUG("OTA is active, updating UI status...\n");
-                update_ui_status("Applying patch...");
-                LOG_OTA_DEBUG("UI status updated, calling complete_ota()...\n");
-                if (ota_handler.complete_ota()) {
-                    LOG_OTA_DEBUG("complete_ota() returned SUCCESS\n");
-                    set_ota_status(BLE_OTA_SUCCESS);
-                    update_ui_status("Restarting...");
-                } else {
-                    LOG_OTA_DEBUG("complete_ota() returned FAILED\n");
-                    set_ota_status(BLE_OTA_ERROR);
-                }
+            if (ota_over_ble && ota_handler.is_ota_active()) {
+                // Chunks may still be queued for flash; the BLE task finalizes once they are written
+                LOG_OTA_DEBUG("OTA is active, flushing queued data before finalizing...\n");
+                ota_handler.finish_writes();
+                ota_end_pending = true;
             } else {
                 LOG_OTA_DEBUG("OTA is NOT active - ignoring END command\n");
             }
             break;
             
         case BLE_OTA_CMD_ABORT:
-            ota_handler.abort_ota();
+            if (ota_over_ble) {
+                ota_handler.abort_ota();
+            }
             set_ota_status(BLE_OTA_ERROR);
             break;
     }
 }
 
+void BluetoothManager::send_ota_ack(uint32_t flushed_bytes) {
+    if (!ota_status_characteristic) {
+        return;
+    }
+    // The host may have sent up to window_end bytes; everything past flushed_bytes fits in the ring
+    uint8_t ack[9];
+    uint32_t window_end = flushed_bytes + BLE_OTA_RING_BYTES;
+    ack[0] = BLE_OTA_RECEIVING;
+    memcpy(ack + 1, &flushed_bytes, 4);
+    memcpy(ack + 5, &window_end, 4);
+    notify_peer(ota_status_characteristic, ota_owner, ack, sizeof(ack));
+    ota_acked_bytes = flushed_bytes;
+}
+
+// Runs on the BLE task: a window ack per BLE_OTA_ACK_WINDOW_BYTES flushed (or whenever the
+// writer has caught up), and the END command once every queued byte is in flash
+void BluetoothManager::update_ota_transfer() {
+    if (!ota_handler.is_ota_active()) {
+        ota_ack_pending = false;
+        ota_end_pending = false;
+        ota_resume_pending = false;
+        ota_over_ble = false;
+        ota_owner = BLE_CONN_NONE;
+        return;
+    }
+    if (!ota_over_ble) {
+        return;                             // A Wi-Fi download acks and finalizes itself
+    }
+
+    if (ota_handler.has_write_failed()) {
+        log("Bluetooth OTA: Flash write failed, aborting\n");
+        ota_handler.abort_ota();
+        set_ota_status(BLE_OTA_ERROR);
+        return;
+    }
+
+    if (ota_handler.is_parked()) {
+        if (ota_handler.has_park_expired()) {
+            log("Bluetooth OTA: No resume within %lus, aborting\n", (unsigned long)(BLE_OTA_RESUME_TIMEOUT_MS / 1000));
+            ota_handler.abort_ota(true);
+            update_ui_status("Update interrupted");
+        }
+        return;
+    }
+
+    uint32_t flushed = ota_handler.get_flushed_size();
+    bool drained = ota_handler.is_write_drained();
+    if (ota_resume_pending) {
+        // The host continues at the flushed offset, so nothing may still be queued behind it
+        if (drained) {
+            ota_resume_pending = false;
+            send_ota_ack(flushed);
+        }
+        return;
+    }
+    if (ota_ack_pending || flushed - ota_acked_bytes >= BLE_OTA_ACK_WINDOW_BYTES ||
+        (drained && flushed != ota_acked_bytes)) {
+        ota_ack_pending = false;
+        send_ota_ack(flushed);
+    }
+
+    if (ota_end_pending && drained) {
+        ota_end_pending = false;
+        finish_ota();
+    }
+}
+
+void BluetoothManager::finish_ota() {
+    LOG_OTA_DEBUG("OTA data drained, updating UI status...\n");
+    update_ui_status("Applying patch...");
+    LOG_OTA_DEBUG("UI status updated, calling complete_ota()...\n");
+    if (ota_handler.complete_ota()) {
+        LOG_OTA_DEBUG("complete_ota() returned SUCCESS\n");
+        set_ota_status(BLE_OTA_SUCCESS);
+        update_ui_status("Restarting...");
+    } else {
+        LOG_OTA_DEBUG("complete_ota() returned FAILED\n");
+        set_ota_status(BLE_OTA_ERROR);
+    }
+}
+
 void BluetoothManager::handle_ota_data_chunk(BLECharacteristic* characteristic) {
-    if (!ota_handler.is_ota_active()) return;
+    if (!ota_over_ble || !ota_handler.is_ota_active() || !is_owner(ota_owner)) return;
     
     String data = characteristic->getValue();
     size_t chunk_size = data.length();
@@ -757,7 +1384,13 @@ void BluetoothManager::handle_debug_command(BLECharacteristic* characteristic) {
         uint8_t command = value[0];
         switch (command) {
             case BLE_DEBUG_CMD_ENABLE:
-                debug_stream_active = true;
+                if (!debug_stream_active) {
+                    debug_log.clear();
+                }
+                if (Peer* peer = find_peer(writer_conn_id)) {
+                    peer->debug_stream = true;
+                }
+                apply_peer_requests();
                 log("BLE_DEBUG: Stream enabled\n");
 #if ENABLE_GRIND_DEBUG
                 // Print struct layout debug info immediately upon debug stream activation
@@ -770,9 +1403,242 @@ void BluetoothManager::handle_debug_command(BLECharacteristic* characteristic) {
 #endif
                 break;
             case BLE_DEBUG_CMD_DISABLE:
+                // The stream stays up while another central still has it enabled
+                if (Peer* peer = find_peer(writer_conn_id)) {
+                    peer->debug_stream = false;
+                }
                 log("BLE_DEBUG: Stream disabled\n");
-                debug_stream_active = false;
+                apply_peer_requests();
+                break;
+            case BLE_DEBUG_CMD_TIMING_REPORT:
+                perf_counters.print_report();
+                break;
+            case BLE_DEBUG_CMD_TIMING_RESET:
+                perf_counters.reset_histograms();
+                log("BLE_DEBUG: Timing histograms reset\n");
+                break;
+            case BLE_DEBUG_CMD_ADC_CAPTURE_ON:
+            case BLE_DEBUG_CMD_ADC_CAPTURE_OFF:
+                grind_logger.set_adc_capture_enabled(command == BLE_DEBUG_CMD_ADC_CAPTURE_ON);
+                log("BLE_DEBUG: ADC capture %s\n", command == BLE_DEBUG_CMD_ADC_CAPTURE_ON ? "on" : "off");
+                break;
+            case BLE_DEBUG_CMD_TRACE_START:
+                // Allocation and capture start run on bluetooth task context
+                trace_start_duration_ms = value.length() >= 3 ? (uint8_t)value[1] | ((uint8_t)value[2] << 8) : 0;
+                trace_start_pending = true;
+                break;
+            case BLE_DEBUG_CMD_TRACE_DUMP:
+                trace_dump_pending = true;
+                break;
+            case BLE_DEBUG_CMD_SYSINFO_CONFIG: {
+                // Formatting runs on the bluetooth task; only record the request here
+                // The format is shared by every subscriber; the period is this central's
+                sysinfo_format = value.length() >= 2 && (uint8_t)value[1] == BLE_SYSINFO_FORMAT_TEXT
+                    ? BLE_SYSINFO_FORMAT_TEXT : BLE_SYSINFO_FORMAT_BINARY;
+                Peer* peer = find_peer(writer_conn_id);
+                if (peer && value.length() >= 4) {
+                    uint16_t interval_ms = (uint8_t)value[2] | ((uint8_t)value[3] << 8);
+                    peer->sysinfo_interval_ms = interval_ms < BLE_SYSINFO_MIN_REFRESH_INTERVAL_MS
+                        ? BLE_SYSINFO_MIN_REFRESH_INTERVAL_MS : interval_ms;
+                    apply_peer_requests();
+                }
+                sysinfo_refresh_pending = true;
+                break;
+            }
+#if FEATURE_DEBUG_TOOLS
+            case BLE_DEBUG_CMD_UI_BENCHMARK:
+                // Screens are driven from the UI task; wake it in case the Ready screen is idle
+                ui_benchmark_requested.store(true, std::memory_order_relaxed);
+                if (ui_status_consumer) {
+                    xTaskNotify(ui_status_consumer, SYS_UI_WAKE_NOTIFY_BIT, eSetBits);
+                }
+                log("BLE_DEBUG: UI benchmark requested\n");
+                break;
+            case BLE_DEBUG_CMD_HOT_PATH_BENCHMARK:
+                // Runs on the UI task between frames, like the button on the Diagnostics page
+                hot_path_benchmark.request();
+                if (ui_status_consumer) {
+                    xTaskNotify(ui_status_consumer, SYS_UI_WAKE_NOTIFY_BIT, eSetBits);
+                }
+                log("BLE_DEBUG: Hot path benchmark requested\n");
+                break;
+            case BLE_DEBUG_CMD_STORAGE_BENCHMARK:
+                // Runs in FileIOTask once the grinder is idle
+                storage_benchmark.request();
+                log("BLE_DEBUG: Storage benchmark requested\n");
+                break;
+#else
+            case BLE_DEBUG_CMD_UI_BENCHMARK:
+            case BLE_DEBUG_CMD_HOT_PATH_BENCHMARK:
+            case BLE_DEBUG_CMD_STORAGE_BENCHMARK:
+                log("BLE_DEBUG: Benchmark ignored: built without FEATURE_DEBUG_TOOLS\n");
+                break;
+#endif
+            case BLE_DEBUG_CMD_GRIND_LOOP_PROFILE:
+                grind_loop_profiler.print_report();
+                break;
+            case BLE_DEBUG_CMD_ROLLUPS:
+                session_rollups.print_report();
+                break;
+            case BLE_DEBUG_CMD_CRASH_SNAPSHOT:
+                crash_snapshot.print_report();
+                break;
+            case BLE_DEBUG_CMD_GRIND_ORDER: {
+                // The OrderQueue logs its own events, accepted or not
+                const uint8_t* args = (const uint8_t*)value.c_str() + 2;
+                const size_t arg_count = value.length() > 2 ? value.length() - 2 : 0;
+                const uint8_t op = value.length() >= 2 ? (uint8_t)value[1] : BLE_GRIND_ORDER_STATUS;
+                if (op == BLE_GRIND_ORDER_SUBMIT && arg_count >= 7) {
+                    GrindOrder order = {};
+                    memcpy(&order.order_id, args, sizeof(order.order_id));
+                    order.count = args[4];
+                    order.profile = args[5] == 0xFF ? -1 : (int8_t)args[5];
+                    order.stored_profile = args[6] == 0xFF ? -1 : args[6];
+                    if (arg_count >= 11) {
+                        memcpy(&order.weight_g, args + 7, sizeof(order.weight_g));
+                    }
+                    if (order.stored_profile >= 0 && order.profile < 0) {
+                        order.order_id = 0;             // A stored profile needs a tab to go into
+                    }
+                    order_queue.submit(order);
+                } else if (op == BLE_GRIND_ORDER_CANCEL) {
+                    uint32_t order_id = 0;
+                    if (arg_count >= 4) {
+                        memcpy(&order_id, args, sizeof(order_id));
+                    }
+                    log("BLE_DEBUG: Grind order cancel: %u orders\n", (unsigned)order_queue.cancel(order_id));
+                } else if (op != BLE_GRIND_ORDER_STATUS) {
+                    log("BLE_DEBUG: Grind order: bad operation %u or arguments\n", (unsigned)op);
+                    break;
+                }
+                if (order_queue.has_active()) {
+                    log("BLE_DEBUG: Grind order %lu active: %u/%u doses%s\n",
+                        (unsigned long)order_queue.get_active().order_id, (unsigned)order_queue.get_active_completed(),
+                        (unsigned)order_queue.get_active().count, order_queue.is_cancel_requested() ? ", cancelling" : "");
+                }
+                log("BLE_DEBUG: Grind orders queued: %u/%u\n", (unsigned)order_queue.get_pending_count(),
+                    (unsigned)USER_ORDER_QUEUE_LENGTH);
+                break;
+            }
+            case BLE_DEBUG_CMD_NOISE_SPECTRUM: {
+                // Analysed on the UI task: idle at once, a motor capture when the next run stops
+                bool motor = value.length() >= 2 && (uint8_t)value[1] == 1;
+                noise_spectrum.request(motor ? NoiseCapture::MOTOR : NoiseCapture::IDLE);
+                if (ui_status_consumer) {
+                    xTaskNotify(ui_status_consumer, SYS_UI_WAKE_NOTIFY_BIT, eSetBits);
+                }
+                log("BLE_DEBUG: Noise spectrum (%s) requested\n", motor ? "next motor run" : "idle");
+                break;
+            }
+            case BLE_DEBUG_CMD_LOAD_CELL_CHANNELS: {
+                WeightSensor* weight_sensor = weight_sampling_task.get_weight_sensor();
+                if (!weight_sensor || weight_sensor->get_adc_channel_count() < 2) {
+                    log("BLE_DEBUG: Load cell channels: single channel\n");
+                    break;
+                }
+                if (value.length() >= 5) {
+                    float gain;
+                    memcpy(&gain, value.c_str() + 1, sizeof(gain));
+                    if (!weight_sensor->set_adc_channel_gain(1, gain)) {
+                        log("BLE_DEBUG: Load cell channel 2 gain %.4f rejected (0.5-2.0)\n", gain);
+                    }
+                }
+                log("BLE_DEBUG: Load cell channels: ch1 %ld ch2 %ld gain %.5f sum %ld\n",
+                    (long)weight_sensor->get_adc_channel_raw(0), (long)weight_sensor->get_adc_channel_raw(1),
+                    weight_sensor->get_adc_channel_gain(1), (long)weight_sensor->get_raw_adc_data());
+                break;
+            }
+            case BLE_DEBUG_CMD_PROFILE_STORE: {
+                extern ProfileController profile_controller;
+                const uint8_t* args = (const uint8_t*)value.c_str() + 2;
+                const size_t arg_count = value.length() > 2 ? value.length() - 2 : 0;
+                const uint8_t op = value.length() >= 2 ? (uint8_t)value[1] : BLE_PROFILE_STORE_LIST;
+                if (op == BLE_PROFILE_STORE_SAVE && arg_count >= 2) {
+                    char name[USER_PROFILE_STORE_NAME_LENGTH] = "";
+                    size_t name_length = min(arg_count - 2, sizeof(name) - 1);
+                    memcpy(name, args + 2, name_length);
+                    name[name_length] = '\0';
+                    int stored_id = profile_controller.store_profile(args[0], args[1] == 0xFF ? -1 : args[1], name);
+                    log("BLE_DEBUG: Profile store: tab %u %s\n", (unsigned)args[0],
+                        stored_id >= 0 ? "stored" : "not stored (grinding, store full or bad tab)");
+                } else if (op == BLE_PROFILE_STORE_RECALL && arg_count >= 2) {
+                    bool recalled = profile_controller.recall_profile(args[1], args[0]);
+                    log("BLE_DEBUG: Profile store: %u %s tab %u\n", (unsigned)args[0],
+                        recalled ? "recalled into" : "not recalled into", (unsigned)args[1]);
+                } else if (op == BLE_PROFILE_STORE_DELETE && arg_count >= 1) {
+                    log("BLE_DEBUG: Profile store: %u %s\n", (unsigned)args[0],
+                        profile_store.remove(args[0]) ? "deleted" : "not deleted");
+                } else if (op != BLE_PROFILE_STORE_LIST) {
+                    log("BLE_DEBUG: Profile store: bad operation %u\n", (unsigned)op);
+                    break;
+                }
+
+                log("BLE_DEBUG: Profile store: %u/%u used, cache %lu hits %lu misses\n",
+                    (unsigned)profile_store.get_count(), (unsigned)profile_store.get_capacity(),
+                    (unsigned long)profile_store.get_cache_hits(), (unsigned long)profile_store.get_cache_misses());
+                for (uint16_t id = 0; id < profile_store.get_capacity(); id++) {
+                    char name[USER_PROFILE_STORE_NAME_LENGTH];
+                    if (profile_store.get_name(id, name, sizeof(name))) {
+                        log("BLE_DEBUG:   %2u %s\n", (unsigned)id, name);
+                    }
+                }
+                for (int tab = 0; tab < USER_PROFILE_COUNT; tab++) {
+                    log("BLE_DEBUG:   tab %d %s -> %d\n", tab, profile_controller.get_profile_name(tab),
+                        profile_controller.get_linked_profile(tab));
+                }
+                break;
+            }
+            case BLE_DEBUG_CMD_LOG_LEVEL: {
+                // RAM only: every category is back at its compiled-in default after a reboot
+                if (value.length() >= 3) {
+                    uint8_t category = (uint8_t)value[1];
+                    uint8_t level = (uint8_t)value[2];
+                    if (level == 0xFE) {
+                        log_reset_levels();
+                    } else if (level >= LOG_LEVEL_COUNT && level != LOG_LEVEL_OFF) {
+                        log("BLE_DEBUG: Log level %u unknown\n", (unsigned)level);
+                        break;
+                    } else if (category == 0xFF) {
+                        for (uint8_t c = 0; c < LOG_CAT_COUNT; c++) {
+                            log_set_level((LogCategory)c, level);
+                        }
+                    } else if (category < LOG_CAT_COUNT) {
+                        log_set_level((LogCategory)category, level);
+                    } else {
+                        log("BLE_DEBUG: Log category %u unknown\n", (unsigned)category);
+                        break;
+                    }
+                }
+                for (uint8_t c = 0; c < LOG_CAT_COUNT; c++) {
+                    log("BLE_DEBUG: Log level %u %s: %s (built up to %s)\n", (unsigned)c,
+                        log_category_name((LogCategory)c), log_level_name(log_get_level((LogCategory)c)),
+                        log_level_name(log_compile_level(c)));
+                }
                 break;
+            }
+            case BLE_DEBUG_CMD_NETWORK_CONFIG: {
+#if NETWORK_MQTT_ENABLED
+                // Three NUL-separated fields after the command byte; the last terminator is optional
+                const char* fields[3] = {"", "", ""};
+                const char* cursor = value.c_str() + 1;
+                const char* end = value.c_str() + value.length();
+                int field_count = 0;
+                while (field_count < 3 && cursor < end) {
+                    fields[field_count++] = cursor;
+                    cursor += strnlen(cursor, end - cursor) + 1;
+                }
+                // The web dashboard needs no broker: the URI may then be left out
+                if (field_count < (NETWORK_WEB_ENABLED ? 2 : 3)) {
+                    log("BLE_DEBUG: Network config needs SSID, password and broker URI\n");
+                    break;
+                }
+                mqtt_manager.set_config(fields[0], fields[1], fields[2]);
+                log("BLE_DEBUG: Network config stored (SSID '%s', broker %s)\n", fields[0], fields[2]);
+#else
+                log("BLE_DEBUG: Network config ignored: built without NETWORK_MQTT_ENABLED\n");
+#endif
+                break;
+            }
             case 0x00: // Keepalive from python script
                 break;
             default:
@@ -788,7 +1654,20 @@ void BluetoothManager::handle_data_control_command(BLECharacteristic* characteri
     if (data.length() == 0) return;
     
     uint8_t command = data[0];
-    log("Bluetooth Data: Received command 0x%02X\n", command);
+    if (command != BLE_DATA_CMD_GRANT_CREDITS) {
+        log("Bluetooth Data: Received command 0x%02X\n", command);
+    }
+    
+    // A running export holds data control for its central; telemetry stays open to every central
+    if (data_export_in_progress && !is_owner(export_owner) && command != BLE_DATA_CMD_TELEMETRY_START &&
+        command != BLE_DATA_CMD_TELEMETRY_STOP) {
+        if (command != BLE_DATA_CMD_GRANT_CREDITS) {
+            log("Bluetooth Data: Command 0x%02X refused - another central is exporting\n", command);
+            uint8_t status_value = BLE_DATA_ERROR;
+            notify_peer(data_status_characteristic, writer_conn_id, &status_value, 1);
+        }
+        return;
+    }
     
     switch (command) {
         case BLE_DATA_CMD_STOP_EXPORT:
@@ -814,15 +1693,100 @@ void BluetoothManager::handle_data_control_command(BLECharacteristic* characteri
         case BLE_DATA_CMD_REQUEST_FILE:
             if (data.length() >= 5) {
                 uint32_t session_id = 0;
+                uint16_t credits = 0;
+                uint8_t flags = 0;
                 memcpy(&session_id, data.c_str() + 1, 4);
+                if (data.length() >= 7) {
+                    memcpy(&credits, data.c_str() + 5, 2);
+                }
+                if (data.length() >= 8) {
+                    flags = (uint8_t)data[7];
+                }
                 log("Bluetooth Data: Requesting file for session %lu\n", session_id);
-                send_individual_file(session_id);
+                send_individual_file(session_id, credits, flags);
             } else {
                 log("Bluetooth Data: Invalid REQUEST_FILE command length\n");
                 set_data_status(BLE_DATA_ERROR);
             }
             break;
             
+        case BLE_DATA_CMD_REQUEST_BATCH:
+            if (data.length() >= 11) {
+                uint32_t start_session_id = 0;
+                uint32_t resume_offset = 0;
+                uint16_t credits = 0;
+                memcpy(&start_session_id, data.c_str() + 1, 4);
+                memcpy(&resume_offset, data.c_str() + 5, 4);
+                memcpy(&credits, data.c_str() + 9, 2);
+                uint8_t flags = data.length() >= 12 ? (uint8_t)data[11] : 0;
+                send_session_batch(start_session_id, resume_offset, credits, flags);
+            } else {
+                log("Bluetooth Data: Invalid REQUEST_BATCH command length\n");
+                set_data_status(BLE_DATA_ERROR);
+            }
+            break;
+            
+        case BLE_DATA_CMD_QUERY_SESSIONS:
+            if (data.length() >= 1 + sizeof(SessionQuery) + 2) {
+                SessionQuery query;
+                uint16_t credits = 0;
+                uint32_t resume_offset = 0;
+                uint8_t flags = 0;
+                memcpy(&query, data.c_str() + 1, sizeof(query));
+                memcpy(&credits, data.c_str() + 1 + sizeof(query), 2);
+                if (data.length() >= 1 + sizeof(SessionQuery) + 6) {
+                    memcpy(&resume_offset, data.c_str() + 3 + sizeof(query), 4);
+                }
+                if (data.length() >= 1 + sizeof(SessionQuery) + 7) {
+                    flags = (uint8_t)data[7 + sizeof(query)];
+                }
+                send_session_query(query, credits, resume_offset, flags);
+            } else {
+                log("Bluetooth Data: Invalid QUERY_SESSIONS command length\n");
+                set_data_status(BLE_DATA_ERROR);
+            }
+            break;
+            
+        case BLE_DATA_CMD_GET_LOG_LAYOUT: {
+            uint16_t credits = 0;
+            if (data.length() >= 3) {
+                memcpy(&credits, data.c_str() + 1, 2);
+            }
+            send_log_layout(credits, data.length() >= 4 ? (uint8_t)data[3] : 0);
+            break;
+        }
+            
+        case BLE_DATA_CMD_TELEMETRY_START:
+            if (Peer* peer = find_peer(writer_conn_id)) {
+                peer->telemetry = true;
+                peer->telemetry_rate_hz = 0;
+                if (data.length() >= 3) {
+                    memcpy(&peer->telemetry_rate_hz, data.c_str() + 1, 2);
+                }
+            }
+            apply_peer_requests();
+            break;
+            
+        case BLE_DATA_CMD_TELEMETRY_STOP:
+            if (Peer* peer = find_peer(writer_conn_id)) {
+                peer->telemetry = false;
+            }
+            apply_peer_requests();
+            break;
+            
+        case BLE_DATA_CMD_GRANT_CREDITS:
+            // Hot path during a bulk export: no logging
+            if (data.length() >= 3 && bulk_transfer) {
+                uint16_t credits = 0;
+                memcpy(&credits, data.c_str() + 1, 2);
+                uint32_t current = transfer_credits.load();
+                uint32_t granted;
+                do {
+                    granted = current + credits < BLE_DATA_BULK_MAX_CREDITS ? current + credits : BLE_DATA_BULK_MAX_CREDITS;
+                } while (!transfer_credits.compare_exchange_weak(current, granted));
+            }
+            break;
+            
         default:
             log("Bluetooth Data: Unknown command: 0x%02X\n", command);
             set_data_status(BLE_DATA_ERROR);
@@ -830,34 +1794,187 @@ void BluetoothManager::handle_data_control_command(BLECharacteristic* characteri
     }
 }
 
-// BLE Callbacks
-void BluetoothManager::onConnect(BLEServer* server) {
-    device_connected = true;
-    log("BLE: Client connected - timeout paused while connected\n");
+// Runs on the BLE task: the fast link is held on the owner's link while an export or OTA is
+// active and for BLE_TRANSFER_SESSION_HOLD_MS after, so a multi-file export does not renegotiate
+// per file. Every other central stays on the idle parameters.
+void BluetoothManager::update_transfer_session() {
+    if (!device_connected) {
+        transfer_session_active = false;
+        transfer_conn_id = BLE_CONN_NONE;
+        return;
+    }
+
+    for (Peer& peer : peers) {
+        if (peer.active && !peer.link_params_requested) {
+            peer.link_params_requested = true;
+            request_link_params(peer, false);
+        }
+    }
+
+    uint16_t owner = data_export_in_progress ? export_owner
+                   : ota_handler.is_ota_active() ? ota_owner : BLE_CONN_NONE;
+    Peer* owner_peer = find_peer(owner);
+    unsigned long now = millis();
+    if (owner_peer) {
+        last_transfer_activity_ms = now;
+        if (!transfer_session_active || transfer_conn_id != owner) {
+            Peer* previous = transfer_session_active ? find_peer(transfer_conn_id) : nullptr;
+            if (previous) {
+                request_link_params(*previous, false);
+            }
+            transfer_session_active = true;
+            transfer_conn_id = owner;
+            log("BLE: Transfer session started on connection %u (2M PHY, %u B PDUs, %.1f-%.1f ms interval)\n",
+                (unsigned)owner, (unsigned)BLE_TRANSFER_DATA_LENGTH_BYTES, BLE_TRANSFER_CONN_INTERVAL_MIN * 1.25f,
+                BLE_TRANSFER_CONN_INTERVAL_MAX * 1.25f);
+            request_link_params(*owner_peer, true);
+        }
+    } else if (transfer_session_active && now - last_transfer_activity_ms >= BLE_TRANSFER_SESSION_HOLD_MS) {
+        transfer_session_active = false;
+        log("BLE: Transfer session ended, back to idle link parameters\n");
+        if (Peer* previous = find_peer(transfer_conn_id)) {
+            request_link_params(*previous, false);
+        }
+        transfer_conn_id = BLE_CONN_NONE;
+    }
 }
 
-void BluetoothManager::onDisconnect(BLEServer* server) {
-    device_connected = false;
-    last_disconnect_time = millis(); // Reset timeout countdown from now
-    
-    log("BLE: Client disconnected - timeout countdown resumed\n");
-    
-    if (ota_handler.is_ota_active()) {
-        ota_handler.abort_ota();
+// All requests are asynchronous and may be refused by the central; failures are only logged.
+// PHY and data length stay raised after a transfer: they shorten airtime and cost nothing idle.
+void BluetoothManager::request_link_params(Peer& peer, bool transfer) {
+#if defined(CONFIG_BT_NIMBLE_ENABLED)
+    if (transfer) {
+#if CONFIG_BT_NIMBLE_50_FEATURE_SUPPORT
+        int phy_rc = ble_gap_set_prefered_le_phy(peer.conn_id, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK,
+                                                 BLE_GAP_LE_PHY_CODED_ANY);
+        if (phy_rc != 0) {
+            log("BLE: 2M PHY request failed (%d)\n", phy_rc);
+        }
+#endif
+        // Air time of a full PDU on the 1M PHY: (payload + 14 bytes of framing) * 8 µs
+        int dle_rc = ble_gap_set_data_len(peer.conn_id, BLE_TRANSFER_DATA_LENGTH_BYTES,
+                                          (BLE_TRANSFER_DATA_LENGTH_BYTES + 14) * 8);
+        if (dle_rc != 0) {
+            log("BLE: Data length request failed (%d)\n", dle_rc);
+        }
     }
-    
-    if (data_export_in_progress) {
+
+    struct ble_gap_upd_params params = {};
+    params.itvl_min = transfer ? BLE_TRANSFER_CONN_INTERVAL_MIN : BLE_IDLE_CONN_INTERVAL_MIN;
+    params.itvl_max = transfer ? BLE_TRANSFER_CONN_INTERVAL_MAX : BLE_IDLE_CONN_INTERVAL_MAX;
+    params.latency = transfer ? BLE_TRANSFER_CONN_LATENCY : BLE_IDLE_CONN_LATENCY;
+    params.supervision_timeout = transfer ? BLE_TRANSFER_SUPERVISION_TIMEOUT : BLE_IDLE_SUPERVISION_TIMEOUT;
+    int conn_rc = ble_gap_update_params(peer.conn_id, &params);
+    if (conn_rc != 0) {
+        log("BLE: Connection parameter request failed (%d)\n", conn_rc);
+    }
+#else
+    if (transfer) {
+#if CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+        esp_err_t phy_err = esp_ble_gap_set_preferred_phy(peer.address, ESP_BLE_GAP_NO_PREFER_TRANSMIT_PHY |
+                                                          ESP_BLE_GAP_NO_PREFER_RECEIVE_PHY,
+                                                          ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                                          ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+        if (phy_err != ESP_OK) {
+            log("BLE: 2M PHY request failed (%d)\n", phy_err);
+        }
+#endif
+        esp_err_t dle_err = esp_ble_gap_set_pkt_data_len(peer.address, BLE_TRANSFER_DATA_LENGTH_BYTES);
+        if (dle_err != ESP_OK) {
+            log("BLE: Data length request failed (%d)\n", dle_err);
+        }
+    }
+
+    esp_ble_conn_update_params_t params = {};
+    memcpy(params.bda, peer.address, sizeof(esp_bd_addr_t));
+    params.min_int = transfer ? BLE_TRANSFER_CONN_INTERVAL_MIN : BLE_IDLE_CONN_INTERVAL_MIN;
+    params.max_int = transfer ? BLE_TRANSFER_CONN_INTERVAL_MAX : BLE_IDLE_CONN_INTERVAL_MAX;
+    params.latency = transfer ? BLE_TRANSFER_CONN_LATENCY : BLE_IDLE_CONN_LATENCY;
+    params.timeout = transfer ? BLE_TRANSFER_SUPERVISION_TIMEOUT : BLE_IDLE_SUPERVISION_TIMEOUT;
+    esp_err_t conn_err = esp_ble_gap_update_conn_params(&params);
+    if (conn_err != ESP_OK) {
+        log("BLE: Connection parameter request failed (%d)\n", conn_err);
+    }
+#endif
+}
+
+// BLE Callbacks: the descriptor variants carry the connection every per-central decision needs
+#if defined(CONFIG_BT_NIMBLE_ENABLED)
+void BluetoothManager::onConnect(BLEServer* server, ble_gap_conn_desc* desc) {
+    add_peer(desc->conn_handle, nullptr);
+#else
+void BluetoothManager::onConnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) {
+    add_peer(param->connect.conn_id, param->connect.remote_bda);
+#endif
+    log("BLE: Client connected (%u of %u) - timeout paused while connected\n", (unsigned)peer_count,
+        (unsigned)BLE_MAX_CONNECTIONS);
+
+    // Connecting stops advertising; keep a slot open for the second central
+    if (peer_count < BLE_MAX_CONNECTIONS) {
+        settle_bluedroid(BLE_RECONNECT_ADVERTISING_DELAY_MS);
+        start_advertising();
+    }
+}
+
+#if defined(CONFIG_BT_NIMBLE_ENABLED)
+void BluetoothManager::onDisconnect(BLEServer* server, ble_gap_conn_desc* desc) {
+    uint16_t conn_id = desc->conn_handle;
+#else
+void BluetoothManager::onDisconnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) {
+    uint16_t conn_id = param->disconnect.conn_id;
+#endif
+    remove_peer(conn_id);
+    log("BLE: Client disconnected (%u of %u left)\n", (unsigned)peer_count, (unsigned)BLE_MAX_CONNECTIONS);
+
+    // Transfers belong to the central that started them; the other one carries on
+    if (conn_id == ota_owner) {
+        ota_owner = BLE_CONN_NONE;
+        if (ota_over_ble && ota_handler.is_ota_active()) {
+            ota_handler.abort_ota();
+        }
+    }
+    if (conn_id == export_owner && data_export_in_progress) {
         stop_data_export();
     }
-    
-    debug_stream_active = false;
+    if (conn_id == transfer_conn_id) {
+        transfer_session_active = false;
+        transfer_conn_id = BLE_CONN_NONE;
+    }
+    apply_peer_requests();
+
+    if (!device_connected) {
+        sysinfo_format = BLE_SYSINFO_FORMAT_BINARY;
+        last_disconnect_time = millis(); // Reset timeout countdown from now
+        log("BLE: Last client gone - timeout countdown resumed\n");
+    }
     
     // Restart advertising for next connection
-    delay(500);
+    settle_bluedroid(BLE_RECONNECT_ADVERTISING_DELAY_MS);
     start_advertising();
 }
 
+#if defined(CONFIG_BT_NIMBLE_ENABLED)
+void BluetoothManager::onWrite(BLECharacteristic* characteristic, ble_gap_conn_desc* desc) {
+    writer_conn_id = desc->conn_handle;
+#else
+void BluetoothManager::onWrite(BLECharacteristic* characteristic, esp_ble_gatts_cb_param_t* param) {
+    writer_conn_id = param->write.conn_id;
+#endif
+    onWrite(characteristic);
+    writer_conn_id = BLE_CONN_NONE;
+}
+
 void BluetoothManager::onWrite(BLECharacteristic* characteristic) {
+    // Credit grants arrive many times a second during a bulk export, OTA chunks during an update
+    if (characteristic == data_control_characteristic && bulk_transfer) {
+        handle_data_control_command(characteristic);
+        return;
+    }
+    if (characteristic == ota_data_characteristic && ota_handler.is_ota_active()) {
+        handle_ota_data_chunk(characteristic);
+        return;
+    }
+
     LOG_BLE("DEBUG: onWrite() called, characteristic=%p\n", characteristic);
     LOG_BLE("  ota_control=%p, ota_data=%p, debug_rx=%p, data_control=%p, diagnostics=%p\n",
         ota_control_characteristic, ota_data_characteristic, debug_rx_characteristic,
@@ -900,8 +2017,33 @@ void BluetoothManager::refresh_system_info() {
     update_sessions_info();
 }
 
+void BluetoothManager::notify_sysinfo(BLECharacteristic* characteristic, const uint8_t* payload, size_t size) {
+    if (size == 0) {
+        log("BLE: Sysinfo payload does not fit %u bytes\n", (unsigned)BLE_SYSINFO_MAX_PAYLOAD_BYTES);
+        return;
+    }
+    characteristic->setValue((uint8_t*)payload, size);
+    characteristic->notify();
+}
+
 void BluetoothManager::update_system_info() {
     if (!sysinfo_system_characteristic) return;
+
+    // [v][build u16][uptime_s u32][heap free u32][heap total u32][flash u32][cpu MHz u16][version str8]
+    if (sysinfo_format == BLE_SYSINFO_FORMAT_BINARY) {
+        uint8_t payload[BLE_SYSINFO_MAX_PAYLOAD_BYTES];
+        BinaryWriter writer(payload, sizeof(payload));
+        writer.u8(BLE_SYSINFO_BINARY_VERSION);
+        writer.u16(BUILD_NUMBER);
+        writer.u32(millis() / 1000);
+        writer.u32(ESP.getFreeHeap());
+        writer.u32(ESP.getHeapSize());
+        writer.u32(ESP.getFlashChipSize());
+        writer.u16(ESP.getCpuFreqMHz());
+        writer.str8(BUILD_FIRMWARE_VERSION);
+        notify_sysinfo(sysinfo_system_characteristic, payload, writer.size());
+        return;
+    }
     
     // Create JSON-like structure for system info
     char buffer[BLE_SYSINFO_MAX_PAYLOAD_BYTES];
@@ -948,23 +2090,48 @@ void BluetoothManager::update_system_info() {
 
 void BluetoothManager::update_performance_info() {
     if (!sysinfo_performance_characteristic) return;
+
+    // [v][healthy u8][tasks u8] + PerfCounters::format_binary() + TaskManager::format_memory_binary()
+    // + TaskManager::format_cpu_binary()
+    if (sysinfo_format == BLE_SYSINFO_FORMAT_BINARY) {
+        uint8_t payload[BLE_SYSINFO_MAX_PAYLOAD_BYTES];
+        BinaryWriter writer(payload, sizeof(payload));
+        writer.u8(BLE_SYSINFO_BINARY_VERSION);
+        writer.u8(task_manager.are_tasks_healthy() ? 1 : 0);
+        writer.u8(TASK_MANAGER_TASK_COUNT);
+        perf_counters.format_binary(writer);
+        task_manager.format_memory_binary(writer);
+        task_manager.format_cpu_binary(writer);
+        notify_sysinfo(sysinfo_performance_characteristic, payload, writer.size());
+        return;
+    }
     
     // Get performance metrics from the performance monitor
     char buffer[BLE_SYSINFO_MAX_PAYLOAD_BYTES];
     
-    // For now, create a simple performance summary
-    // In a full implementation, we'd extract actual performance data
-    snprintf(buffer, sizeof(buffer),
+    // Timing histograms are [count,p50,p90,p99,max] in µs, task cycles [count,avg,max] in µs.
+    // Memory: least free stack per task in bytes, heap figures in KB (TaskManager).
+    // CPU load in permille of a core, left out when the text would not fit the payload
+    char perf_json[384];
+    perf_counters.format_json(perf_json, sizeof(perf_json));
+    char memory_json[160];
+    task_manager.format_memory_json(memory_json, sizeof(memory_json));
+    char cpu_json[112];
+    size_t cpu_size = task_manager.format_cpu_json(cpu_json + 1, sizeof(cpu_json) - 1);
+    cpu_json[0] = cpu_size > 0 ? ',' : '\0';
+    const char* format =
         "{"
-        "\"tasks_registered\":6,"
-        "\"system_healthy\":true,"
-        "\"load_cell_freq_hz\":50,"
-        "\"grind_control_freq_hz\":50,"
-        "\"ui_freq_hz\":10,"
-        "\"bluetooth_freq_hz\":20,"
-        "\"debug_freq_hz\":1"
-        "}"
-    );
+        "\"tasks_registered\":%d,"
+        "\"system_healthy\":%s,"
+        "%s,"
+        "%s%s"
+        "}";
+    int written = snprintf(buffer, sizeof(buffer), format, TASK_MANAGER_TASK_COUNT,
+                           task_manager.are_tasks_healthy() ? "true" : "false", perf_json, memory_json, cpu_json);
+    if (written < 0 || (size_t)written >= sizeof(buffer)) {
+        snprintf(buffer, sizeof(buffer), format, TASK_MANAGER_TASK_COUNT,
+                 task_manager.are_tasks_healthy() ? "true" : "false", perf_json, memory_json, "");
+    }
     
     sysinfo_performance_characteristic->setValue(buffer);
     sysinfo_performance_characteristic->notify();
@@ -972,6 +2139,14 @@ void BluetoothManager::update_performance_info() {
 
 void BluetoothManager::update_hardware_info() {
     if (!sysinfo_hardware_characteristic) return;
+
+    // [v][flags u8]: bit 0 load cell, 1 motor, 2 display, 3 touch, 4 BLE, 5 WiFi, 6 flash
+    if (sysinfo_format == BLE_SYSINFO_FORMAT_BINARY) {
+        uint8_t payload[2] = {BLE_SYSINFO_BINARY_VERSION,
+                              (uint8_t)(0x01 | 0x02 | 0x04 | 0x08 | 0x10 | (NETWORK_MQTT_ENABLED ? 0x20 : 0) | 0x40)};
+        notify_sysinfo(sysinfo_hardware_characteristic, payload, sizeof(payload));
+        return;
+    }
     
     char buffer[BLE_SYSINFO_MAX_PAYLOAD_BYTES];
     
@@ -982,9 +2157,10 @@ void BluetoothManager::update_hardware_info() {
         "\"display_active\":true,"
         "\"touch_active\":true,"
         "\"ble_enabled\":true,"
-        "\"wifi_available\":false,"
+        "\"wifi_available\":%s,"
         "\"flash_available\":true"
-        "}"
+        "}",
+        NETWORK_MQTT_ENABLED ? "true" : "false"
     );
     
     sysinfo_hardware_characteristic->setValue(buffer);
@@ -994,726 +2170,192 @@ void BluetoothManager::update_hardware_info() {
 void BluetoothManager::update_sessions_info() {
     if (!sysinfo_sessions_characteristic) return;
     
-    char buffer[BLE_SYSINFO_MAX_PAYLOAD_BYTES];
     uint16_t session_count = data_stream.get_total_sessions();
     
+    // Trend of the selected grinder's newest sessions (all modes) from the session summary table
+    SessionTrend trend;
+    grind_logger.get_session_summaries().get_trend(SYS_LOG_SUMMARY_TREND_SESSIONS, -1, &trend, -1, grind_channels.get_selected());
+
+    // The selected grinder's lifetime streaming percentiles over all profiles (StatisticsManager), 0 before its first grind
+    const StatisticsManager& statistics = channel_statistics(grind_channels.get_selected());
+    float lifetime[6] = {};
+    statistics.get_percentiles(kStatisticsAllProfiles, StatisticsMetric::ABS_ERROR_G, &lifetime[0], &lifetime[1]);
+    statistics.get_percentiles(kStatisticsAllProfiles, StatisticsMetric::GRIND_TIME_S, &lifetime[2], &lifetime[3]);
+    statistics.get_percentiles(kStatisticsAllProfiles, StatisticsMetric::PULSES, &lifetime[4], &lifetime[5]);
+
+    // [v][total u16][flags u8: bit 0 data available, 1 export active][recent u16][completed u16]
+    // then f32 mean error g, abs error g, flow g/s, latency ms, coast g, pulses, final settle ms,
+    // then f32 lifetime p50/p95 of abs error g, grind time s, pulses
+    if (sysinfo_format == BLE_SYSINFO_FORMAT_BINARY) {
+        uint8_t payload[BLE_SYSINFO_MAX_PAYLOAD_BYTES];
+        BinaryWriter writer(payload, sizeof(payload));
+        writer.u8(BLE_SYSINFO_BINARY_VERSION);
+        writer.u16(session_count);
+        writer.u8((session_count > 0 ? 0x01 : 0) | (data_export_in_progress ? 0x02 : 0));
+        writer.u16(trend.session_count);
+        writer.u16(trend.completed_count);
+        writer.f32(trend.mean_error_grams);
+        writer.f32(trend.mean_abs_error_grams);
+        writer.f32(trend.mean_flow_g_per_s);
+        writer.f32(trend.mean_latency_ms);
+        writer.f32(trend.mean_coast_grams);
+        writer.f32(trend.mean_pulses);
+        writer.f32(trend.mean_final_settle_ms);
+        for (float value : lifetime) {
+            writer.f32(value);
+        }
+        notify_sysinfo(sysinfo_sessions_characteristic, payload, writer.size());
+        return;
+    }
+    
+    char buffer[BLE_SYSINFO_MAX_PAYLOAD_BYTES];
     snprintf(buffer, sizeof(buffer),
         "{"
         "\"total_sessions\":%u,"
         "\"data_available\":%s,"
         "\"export_active\":%s,"
-        "\"last_export_time\":0"
+        "\"last_export_time\":0,"
+        "\"recent\":{"
+        "\"sessions\":%u,"
+        "\"completed\":%u,"
+        "\"mean_error_g\":%.3f,"
+        "\"mean_abs_error_g\":%.3f,"
+        "\"mean_flow_gps\":%.2f,"
+        "\"mean_latency_ms\":%.0f,"
+        "\"mean_coast_g\":%.3f,"
+        "\"mean_pulses\":%.2f,"
+        "\"mean_final_settle_ms\":%.0f"
+        "},"
+        "\"lifetime\":{"
+        "\"abs_error_p50_g\":%.3f,"
+        "\"abs_error_p95_g\":%.3f,"
+        "\"grind_time_p50_s\":%.2f,"
+        "\"grind_time_p95_s\":%.2f,"
+        "\"pulses_p50\":%.1f,"
+        "\"pulses_p95\":%.1f"
+        "}"
         "}",
         session_count,
         session_count > 0 ? "true" : "false",
-        data_export_in_progress ? "true" : "false"
+        data_export_in_progress ? "true" : "false",
+        trend.session_count, trend.completed_count,
+        trend.mean_error_grams, trend.mean_abs_error_grams,
+        trend.mean_flow_g_per_s, trend.mean_latency_ms,
+        trend.mean_coast_grams, trend.mean_pulses, trend.mean_final_settle_ms,
+        lifetime[0], lifetime[1], lifetime[2], lifetime[3], lifetime[4], lifetime[5]
     );
     
     sysinfo_sessions_characteristic->setValue(buffer);
     sysinfo_sessions_characteristic->notify();
 }
 
-void BluetoothManager::generate_diagnostic_report() {
-    LOG_BLE("=== DIAGNOSTICS: generate_diagnostic_report() CALLED ===\n");
-
-    if (!debug_tx_characteristic) {
-        LOG_BLE("ERROR: debug_tx_characteristic is NULL\n");
+// Slices go out only while the controller has buffers for the link, so OTA acks,
+// export chunks and status notifies queued on the same pass are never starved
+void BluetoothManager::update_diagnostic_report() {
+    if (!diagnostic_report.is_active()) {
+        return;
+    }
+    if (!device_connected || !debug_tx_characteristic) {
+        diagnostic_report.cancel();
+        LOG_BLE("DIAGNOSTICS: Report cancelled\n");
         return;
     }
 
-    LOG_BLE("DEBUG: debug_tx_characteristic is valid, starting report generation\n");
-
-    // Access global instances
-    extern HardwareManager hardware_manager;
-    extern GrindController grind_controller;
-
-    char buf[512];
-
-    // Helper lambda to send chunk and flush
-    auto send_chunk = [this](const char* chunk) {
-        if (!debug_tx_characteristic) return;
-        size_t len = strlen(chunk);
-        LOG_BLE("TX: %zu bytes\n", len);
-        debug_tx_characteristic->setValue((uint8_t*)chunk, len);
+    uint8_t chunk[BLE_DATA_CHUNK_SIZE_BYTES];
+    size_t payload_bytes = get_data_chunk_payload_bytes();
+    for (int sent = 0; sent < BLE_DIAGNOSTIC_MAX_BURST && can_queue_notification(); sent++) {
+        size_t size;
+        if (!diagnostic_report.read_chunk(chunk, payload_bytes, &size)) {
+            LOG_BLE("DIAGNOSTICS: Report completed\n");
+            return;
+        }
+        debug_tx_characteristic->setValue(chunk, size);
         debug_tx_characteristic->notify();
-        // Explicitly yield to BLE task to process notification queue
-        vTaskDelay(pdMS_TO_TICKS(50)); // Give BLE stack time to drain queue
-    };
-
-    // Section 1: Header & Firmware Info
-    unsigned long uptime_ms = millis();
-    unsigned long uptime_s = uptime_ms / 1000;
-    unsigned long uptime_h = uptime_s / 3600;
-    unsigned long uptime_m = (uptime_s % 3600) / 60;
-    unsigned long uptime_sec = uptime_s % 60;
-
-    snprintf(buf, sizeof(buf),
-        "=== SMART GRIND BY WEIGHT - DIAGNOSTIC REPORT ===\n"
-        "Generated: %s\n"
-        "\n"
-        "[FIRMWARE]\n"
-        "  Version: %s\n"
-        "  Build: #%d\n"
-        "  Git: %s (%s)\n"
-        "  Built: %s\n"
-        "\n",
-        get_build_datetime(),
-        BUILD_FIRMWARE_VERSION,
-        BUILD_NUMBER,
-        get_git_commit_id(),
-        get_git_branch(),
-        BUILD_TIMESTAMP
-    );
-    send_chunk(buf);
-
-    // Section 2: System Runtime
-    size_t heap_free = ESP.getFreeHeap();
-    size_t heap_total = ESP.getHeapSize();
-    float heap_used_pct = (float(heap_total - heap_free) / float(heap_total)) * 100.0f;
-    uint32_t flash_size = ESP.getFlashChipSize();
-
-    const char* driver_type =
-#ifdef MOCK_BUILD
-        "MOCK";
-#else
-        "REAL";
-#endif
-
-    snprintf(buf, sizeof(buf),
-        "[SYSTEM]\n"
-        "  Uptime: %02lu:%02lu:%02lu\n"
-        "  CPU: %lu MHz\n"
-        "  Heap: %u KB / %u KB (%.1f%% used)\n"
-        "  Flash: %u MB\n"
-        "  Driver: %s\n"
-        "\n",
-        uptime_h, uptime_m, uptime_sec,
-        (unsigned long)ESP.getCpuFreqMHz(),
-        (unsigned int)(heap_free / 1024),
-        (unsigned int)(heap_total / 1024),
-        heap_used_pct,
-        (unsigned int)(flash_size / 1024 / 1024),
-        driver_type
-    );
-    send_chunk(buf);
-
-    // Section 3: Runtime Diagnostics
-    WeightSensor* weight_sensor = hardware_manager.get_weight_sensor();
-
-    if (weight_sensor) {
-        // Get load cell noise measurements
-        float std_dev_g = weight_sensor->get_standard_deviation_g(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
-        int32_t std_dev_adc = weight_sensor->get_standard_deviation_adc(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
-        bool noise_acceptable = weight_sensor->noise_level_diagnostic();
-        float cal_factor = weight_sensor->get_calibration_factor();
-        bool is_calibrated = weight_sensor->is_calibrated();
-
-        // Get motor latency
-        float motor_latency = grind_controller.get_motor_response_latency();
-
-        snprintf(buf, sizeof(buf),
-            "[RUNTIME DIAGNOSTICS]\n"
-            "  Load Cell Status: %s\n"
-            "  Calibration Factor: %.2f\n"
-            "  Std Dev (g): %.4f\n"
-            "  Std Dev (ADC): %ld\n"
-            "  Noise Level: %s\n"
-            "  Motor Latency: %.0f ms\n"
-            "\n",
-            is_calibrated ? "Calibrated" : "NOT CALIBRATED",
-            cal_factor,
-            std_dev_g,
-            (long)std_dev_adc,
-            noise_acceptable ? "OK" : "Too High",
-            motor_latency
-        );
-        send_chunk(buf);
-    }
-
-    // Section 4: Profiles (requires access to hardware manager's preferences)
-    // This will be populated at runtime - for now show defaults
-    snprintf(buf, sizeof(buf),
-        "[COMPILE-TIME PARAMETERS - PROFILES]\n"
-        "  USER_PROFILE_COUNT: %d\n"
-        "  USER_SINGLE_ESPRESSO_WEIGHT_G: %.1f\n"
-        "  USER_DOUBLE_ESPRESSO_WEIGHT_G: %.1f\n"
-        "  USER_CUSTOM_PROFILE_WEIGHT_G: %.1f\n"
-        "  USER_SINGLE_ESPRESSO_TIME_S: %.1f\n"
-        "  USER_DOUBLE_ESPRESSO_TIME_S: %.1f\n"
-        "  USER_CUSTOM_PROFILE_TIME_S: %.1f\n"
-        "\n",
-        USER_PROFILE_COUNT,
-        USER_SINGLE_ESPRESSO_WEIGHT_G,
-        USER_DOUBLE_ESPRESSO_WEIGHT_G,
-        USER_CUSTOM_PROFILE_WEIGHT_G,
-        USER_SINGLE_ESPRESSO_TIME_S,
-        USER_DOUBLE_ESPRESSO_TIME_S,
-        USER_CUSTOM_PROFILE_TIME_S
-    );
-    send_chunk(buf);
-
-    // Section 5: User.h Compile Constants (Part 1)
-    snprintf(buf, sizeof(buf),
-        "[COMPILE-TIME PARAMETERS - USER.H PART 1]\n"
-        "  USER_MIN_TARGET_WEIGHT_G: %.1f\n"
-        "  USER_MAX_TARGET_WEIGHT_G: %.1f\n"
-        "  USER_MIN_TARGET_TIME_S: %.1f\n"
-        "  USER_MAX_TARGET_TIME_S: %.1f\n"
-        "  USER_FINE_WEIGHT_ADJUSTMENT_G: %.1f\n"
-        "  USER_FINE_TIME_ADJUSTMENT_S: %.1f\n"
-        "  USER_CALIBRATION_REFERENCE_WEIGHT_G: %.1f\n"
-        "  USER_DEFAULT_CALIBRATION_FACTOR: %.1f\n"
-        "\n",
-        USER_MIN_TARGET_WEIGHT_G,
-        USER_MAX_TARGET_WEIGHT_G,
-        USER_MIN_TARGET_TIME_S,
-        USER_MAX_TARGET_TIME_S,
-        USER_FINE_WEIGHT_ADJUSTMENT_G,
-        USER_FINE_TIME_ADJUSTMENT_S,
-        USER_CALIBRATION_REFERENCE_WEIGHT_G,
-        USER_DEFAULT_CALIBRATION_FACTOR
-    );
-    send_chunk(buf);
-
-    // Section 6: User.h Compile Constants (Part 2 - Screen & Auto)
-    snprintf(buf, sizeof(buf),
-        "[COMPILE-TIME PARAMETERS - USER.H PART 2]\n"
-        "  USER_SCREEN_AUTO_DIM_TIMEOUT_MS: %lu\n"
-        "  USER_SCREEN_BRIGHTNESS_NORMAL: %.2f\n"
-        "  USER_SCREEN_BRIGHTNESS_DIMMED: %.2f\n"
-        "  USER_WEIGHT_ACTIVITY_THRESHOLD_G: %.1f\n"
-        "  USER_AUTO_GRIND_TRIGGER_DELTA_G: %.1f\n"
-        "  USER_AUTO_GRIND_TRIGGER_WINDOW_MS: %lu\n"
-        "  USER_AUTO_GRIND_TRIGGER_SETTLING_MS: %lu\n"
-        "  USER_AUTO_GRIND_REARM_DELAY_MS: %lu\n"
-        "\n",
-        (unsigned long)USER_SCREEN_AUTO_DIM_TIMEOUT_MS,
-        USER_SCREEN_BRIGHTNESS_NORMAL,
-        USER_SCREEN_BRIGHTNESS_DIMMED,
-        USER_WEIGHT_ACTIVITY_THRESHOLD_G,
-        USER_AUTO_GRIND_TRIGGER_DELTA_G,
-        (unsigned long)USER_AUTO_GRIND_TRIGGER_WINDOW_MS,
-        (unsigned long)USER_AUTO_GRIND_TRIGGER_SETTLING_MS,
-        (unsigned long)USER_AUTO_GRIND_REARM_DELAY_MS
-    );
-    send_chunk(buf);
-
-    // Section 7: Grind Control Constants (Part 1 - Core)
-    snprintf(buf, sizeof(buf),
-        "[COMPILE-TIME PARAMETERS - GRIND_CONTROL.H PART 1]\n"
-        "  GRIND_ACCURACY_TOLERANCE_G: %.3f\n"
-        "  GRIND_TIMEOUT_SEC: %d\n"
-        "  GRIND_MAX_PULSE_ATTEMPTS: %d\n"
-        "  GRIND_FLOW_DETECTION_THRESHOLD_GPS: %.1f\n"
-        "  GRIND_UNDERSHOOT_TARGET_G: %.1f\n"
-        "  GRIND_LATENCY_TO_COAST_RATIO: %.1f\n"
-        "  GRIND_SCALE_SETTLING_TOLERANCE_G: %.3f\n"
-        "  GRIND_TIME_PULSE_DURATION_MS: %d\n"
-        "\n",
-        GRIND_ACCURACY_TOLERANCE_G,
-        GRIND_TIMEOUT_SEC,
-        GRIND_MAX_PULSE_ATTEMPTS,
-        GRIND_FLOW_DETECTION_THRESHOLD_GPS,
-        GRIND_UNDERSHOOT_TARGET_G,
-        GRIND_LATENCY_TO_COAST_RATIO,
-        GRIND_SCALE_SETTLING_TOLERANCE_G,
-        GRIND_TIME_PULSE_DURATION_MS
-    );
-    send_chunk(buf);
-
-    // Section 8: Grind Control Constants (Part 2 - Flow & Motor)
-    snprintf(buf, sizeof(buf),
-        "[COMPILE-TIME PARAMETERS - GRIND_CONTROL.H PART 2]\n"
-        "  GRIND_FLOW_RATE_MIN_SANE_GPS: %.1f\n"
-        "  GRIND_FLOW_RATE_MAX_SANE_GPS: %.1f\n"
-        "  GRIND_PULSE_FLOW_RATE_FALLBACK_GPS: %.1f\n"
-        "  GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS: %.1f\n"
-        "  GRIND_MOTOR_MAX_PULSE_DURATION_MS: %.1f\n"
-        "  GRIND_MOTOR_SETTLING_TIME_MS: %d\n"
-        "  GRIND_MECHANICAL_DROP_THRESHOLD_G: %.1f\n"
-        "  GRIND_MECHANICAL_EVENT_COOLDOWN_MS: %d\n"
-        "  GRIND_MECHANICAL_EVENT_REQUIRED_COUNT: %d\n"
-        "\n",
-        GRIND_FLOW_RATE_MIN_SANE_GPS,
-        GRIND_FLOW_RATE_MAX_SANE_GPS,
-        GRIND_PULSE_FLOW_RATE_FALLBACK_GPS,
-        GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS,
-        GRIND_MOTOR_MAX_PULSE_DURATION_MS,
-        GRIND_MOTOR_SETTLING_TIME_MS,
-        GRIND_MECHANICAL_DROP_THRESHOLD_G,
-        GRIND_MECHANICAL_EVENT_COOLDOWN_MS,
-        GRIND_MECHANICAL_EVENT_REQUIRED_COUNT
-    );
-    send_chunk(buf);
-
-    // Section 9: Grind Control Constants (Part 3 - Settling & Calibration)
-    snprintf(buf, sizeof(buf),
-        "[COMPILE-TIME PARAMETERS - GRIND_CONTROL.H PART 3]\n"
-        "  GRIND_SCALE_PRECISION_SETTLING_TIME_MS: %d\n"
-        "  GRIND_SCALE_SETTLING_TIMEOUT_MS: %d\n"
-        "  GRIND_TARE_SAMPLE_WINDOW_MS: %d\n"
-        "  GRIND_TARE_TIMEOUT_MS: %d\n"
-        "  GRIND_CALIBRATION_SAMPLE_WINDOW_MS: %d\n"
-        "  GRIND_CALIBRATION_TIMEOUT_MS: %d\n"
-        "\n",
-        GRIND_SCALE_PRECISION_SETTLING_TIME_MS,
-        GRIND_SCALE_SETTLING_TIMEOUT_MS,
-        GRIND_TARE_SAMPLE_WINDOW_MS,
-        GRIND_TARE_TIMEOUT_MS,
-        GRIND_CALIBRATION_SAMPLE_WINDOW_MS,
-        GRIND_CALIBRATION_TIMEOUT_MS
-    );
-    send_chunk(buf);
-
-    // Section 10: Autotune Constants
-    snprintf(buf, sizeof(buf),
-        "[COMPILE-TIME PARAMETERS - AUTOTUNE]\n"
-        "  GRIND_AUTOTUNE_LATENCY_MIN_MS: %.1f\n"
-        "  GRIND_AUTOTUNE_LATENCY_MAX_MS: %.1f\n"
-        "  GRIND_AUTOTUNE_PRIMING_PULSE_MS: %d\n"
-        "  GRIND_AUTOTUNE_TARGET_ACCURACY_MS: %.1f\n"
-        "  GRIND_AUTOTUNE_SUCCESS_RATE: %.2f\n"
-        "  GRIND_AUTOTUNE_VERIFICATION_PULSES: %d\n"
-        "  GRIND_AUTOTUNE_MAX_ITERATIONS: %d\n"
-        "  GRIND_AUTOTUNE_COLLECTION_DELAY_MS: %d\n"
-        "  GRIND_AUTOTUNE_SETTLING_TIMEOUT_MS: %d\n"
-        "  GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G: %.3f\n"
-        "\n",
-        GRIND_AUTOTUNE_LATENCY_MIN_MS,
-        GRIND_AUTOTUNE_LATENCY_MAX_MS,
-        GRIND_AUTOTUNE_PRIMING_PULSE_MS,
-        GRIND_AUTOTUNE_TARGET_ACCURACY_MS,
-        GRIND_AUTOTUNE_SUCCESS_RATE,
-        GRIND_AUTOTUNE_VERIFICATION_PULSES,
-        GRIND_AUTOTUNE_MAX_ITERATIONS,
-        GRIND_AUTOTUNE_COLLECTION_DELAY_MS,
-        GRIND_AUTOTUNE_SETTLING_TIMEOUT_MS,
-        GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G
-    );
-    send_chunk(buf);
-
-    // Section 11: Statistics
-    uint32_t total_grinds = statistics_manager.get_total_grinds();
-    uint32_t single_shots = statistics_manager.get_single_shots();
-    uint32_t double_shots = statistics_manager.get_double_shots();
-    uint32_t custom_shots = statistics_manager.get_custom_shots();
-    uint64_t motor_runtime_ms = statistics_manager.get_motor_runtime_ms();
-    uint32_t motor_hrs = (uint32_t)(motor_runtime_ms / 3600000ULL);
-    uint32_t motor_min = (uint32_t)((motor_runtime_ms % 3600000ULL) / 60000ULL);
-    uint32_t device_uptime_hrs = statistics_manager.get_device_uptime_hrs();
-    uint32_t device_uptime_min = statistics_manager.get_device_uptime_min_remainder();
-    float total_weight_kg = statistics_manager.get_total_weight_kg();
-    uint32_t weight_grinds = statistics_manager.get_weight_mode_grinds();
-    uint32_t time_grinds = statistics_manager.get_time_mode_grinds();
-    float avg_accuracy = statistics_manager.get_avg_accuracy_g();
-    uint32_t total_pulses = statistics_manager.get_total_pulses();
-    float avg_pulses = statistics_manager.get_avg_pulses();
-    uint32_t time_pulses = statistics_manager.get_time_pulses();
-
-    snprintf(buf, sizeof(buf),
-        "[STATISTICS]\n"
-        "  Total Grinds: %lu\n"
-        "  Shots: %lu Single / %lu Double / %lu Custom\n"
-        "  Motor Runtime: %luh %lum\n"
-        "  Device Uptime: %luh %lum\n"
-        "\n",
-        total_grinds,
-        single_shots, double_shots, custom_shots,
-        motor_hrs, motor_min,
-        device_uptime_hrs, device_uptime_min
-    );
-    send_chunk(buf);
-
-    snprintf(buf, sizeof(buf),
-        "  Total Weight: %.2f kg\n"
-        "  Mode Grinds: %lu Weight / %lu Time\n"
-        "  Avg Accuracy: ±%.2f g\n"
-        "  Total Pulses: %lu (avg %.1f)\n"
-        "  Time Pulses: %lu\n"
-        "\n",
-        total_weight_kg,
-        weight_grinds, time_grinds,
-        avg_accuracy,
-        total_pulses, avg_pulses,
-        time_pulses
-    );
-    send_chunk(buf);
-
-    // Section 12: NVM Stored Preferences (Auto-Detected)
-    snprintf(buf, sizeof(buf), "[NVM STORED PREFERENCES]\n");
-    send_chunk(buf);
-
-    // Use NVS iterator to enumerate all entries
-    nvs_iterator_t it = nullptr;
-    esp_err_t res = nvs_entry_find(NVS_DEFAULT_PART_NAME, nullptr, NVS_TYPE_ANY, &it);
-
-    if (res != ESP_OK) {
-        snprintf(buf, sizeof(buf), "  [ERROR] Failed to create NVS iterator (code %d)\n\n", res);
-        send_chunk(buf);
-    } else {
-        char current_namespace[16] = "";
-        bool namespace_started = false;
-        int entry_count = 0;
-
-        while (res == ESP_OK && it != nullptr) {
-            nvs_entry_info_t info;
-            nvs_entry_info(it, &info);
-
-            // Check if we've moved to a new namespace
-            if (strcmp(current_namespace, info.namespace_name) != 0) {
-                if (namespace_started) {
-                    // End previous namespace
-                    snprintf(buf, sizeof(buf), "\n");
-                    send_chunk(buf);
-                }
-
-                // Start new namespace
-                strncpy(current_namespace, info.namespace_name, sizeof(current_namespace) - 1);
-                current_namespace[sizeof(current_namespace) - 1] = '\0';
-                snprintf(buf, sizeof(buf), "  Namespace: %s\n", current_namespace);
-                send_chunk(buf);
-                namespace_started = true;
-            }
+    }
+}
 
-            // Open preferences for this namespace to read the value
-            Preferences pref;
-            if (pref.begin(info.namespace_name, true)) {
-                // Format based on type
-                switch (info.type) {
-                    case NVS_TYPE_U8: {
-                        // Could be bool or uint8
-                        uint8_t val = pref.getUChar(info.key, 0);
-                        if (val <= 1) {
-                            // Likely a boolean
-                            snprintf(buf, sizeof(buf), "    %s: %s (bool)\n", info.key, val ? "true" : "false");
-                        } else {
-                            snprintf(buf, sizeof(buf), "    %s: %u (uint8)\n", info.key, val);
-                        }
-                        break;
-                    }
-                    case NVS_TYPE_I8: {
-                        int8_t val = pref.getChar(info.key, 0);
-                        snprintf(buf, sizeof(buf), "    %s: %d (int8)\n", info.key, val);
-                        break;
-                    }
-                    case NVS_TYPE_U16: {
-                        uint16_t val = pref.getUShort(info.key, 0);
-                        snprintf(buf, sizeof(buf), "    %s: %u (uint16)\n", info.key, val);
-                        break;
-                    }
-                    case NVS_TYPE_I16: {
-                        int16_t val = pref.getShort(info.key, 0);
-                        snprintf(buf, sizeof(buf), "    %s: %d (int16)\n", info.key, val);
-                        break;
-                    }
-                    case NVS_TYPE_U32: {
-                        uint32_t val = pref.getUInt(info.key, 0);
-                        snprintf(buf, sizeof(buf), "    %s: %lu (uint32)\n", info.key, (unsigned long)val);
-                        break;
-                    }
-                    case NVS_TYPE_I32: {
-                        int32_t val = pref.getInt(info.key, 0);
-                        snprintf(buf, sizeof(buf), "    %s: %ld (int32)\n", info.key, (long)val);
-                        break;
-                    }
-                    case NVS_TYPE_U64: {
-                        uint64_t val = pref.getULong64(info.key, 0);
-                        snprintf(buf, sizeof(buf), "    %s: %llu (uint64)\n", info.key, val);
-                        break;
-                    }
-                    case NVS_TYPE_I64: {
-                        int64_t val = pref.getLong64(info.key, 0);
-                        snprintf(buf, sizeof(buf), "    %s: %lld (int64)\n", info.key, val);
-                        break;
-                    }
-                    case NVS_TYPE_STR: {
-                        String val = pref.getString(info.key, "");
-                        snprintf(buf, sizeof(buf), "    %s: \"%s\" (string)\n", info.key, val.c_str());
-                        break;
-                    }
-                    case NVS_TYPE_BLOB: {
-                        size_t len = pref.getBytesLength(info.key);
-                        // Check if it's a float (4 bytes)
-                        if (len == sizeof(float)) {
-                            float val = pref.getFloat(info.key, 0.0f);
-                            snprintf(buf, sizeof(buf), "    %s: %.2f (float)\n", info.key, val);
-                        } else if (len == sizeof(double)) {
-                            double val = pref.getDouble(info.key, 0.0);
-                            snprintf(buf, sizeof(buf), "    %s: %.2f (double)\n", info.key, val);
-                        } else {
-                            snprintf(buf, sizeof(buf), "    %s: <blob %u bytes>\n", info.key, (unsigned int)len);
-                        }
-                        break;
-                    }
-                    default: {
-                        snprintf(buf, sizeof(buf), "    %s: <unknown type %d>\n", info.key, info.type);
-                        break;
-                    }
-                }
-                send_chunk(buf);
-                pref.end();
-            }
+// Stream lines go out a notification's worth at a time, or once the oldest has waited
+// BLE_DEBUG_LOG_FLUSH_MS; lines logged while the link is congested wait in the batcher
+void BluetoothManager::update_debug_log() {
+    if (!device_connected || !debug_tx_characteristic) {
+        debug_log.clear();
+        return;
+    }
 
-            entry_count++;
-            res = nvs_entry_next(&it);
+    char chunk[BLE_DATA_CHUNK_SIZE_BYTES];
+    size_t payload_bytes = get_data_chunk_payload_bytes();
+    for (int sent = 0; sent < BLE_DEBUG_LOG_MAX_BURST && can_queue_notification(); sent++) {
+        if (!debug_log.is_due(millis(), payload_bytes)) {
+            return;
         }
-
-        nvs_release_iterator(it);
-
-        if (entry_count == 0) {
-            snprintf(buf, sizeof(buf), "  [EMPTY] No preferences stored\n");
-            send_chunk(buf);
+        size_t size = debug_log.read(chunk, payload_bytes);
+        if (size == 0) {
+            return;
         }
-
-        snprintf(buf, sizeof(buf), "\n");
-        send_chunk(buf);
+        debug_tx_characteristic->setValue((uint8_t*)chunk, size);
+        trace.instant(TraceId::BLE_NOTIFY, (uint16_t)size);
+        debug_tx_characteristic->notify();
     }
+}
 
-    // Section 13: Session Data
-    uint16_t session_count = data_stream.get_total_sessions();
-
-    snprintf(buf, sizeof(buf),
-        "[SESSION DATA]\n"
-        "  Sessions: %u\n"
-        "  Events: %lu\n"
-        "  Measurements: %lu\n"
-        "\n",
-        session_count,
-        grind_logger.count_total_events_in_flash(),
-        grind_logger.count_total_measurements_in_flash()
-    );
-    send_chunk(buf);
-
-    // Section 14: Last 5 Grind Sessions Detail
-    snprintf(buf, sizeof(buf), "[LAST 5 GRIND SESSIONS]\n");
-    send_chunk(buf);
-
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            // Collect all session IDs
-            const int MAX_SESSIONS = 100;
-            uint32_t* session_ids = (uint32_t*)malloc(MAX_SESSIONS * sizeof(uint32_t));
-            int count = 0;
-
-            if (session_ids) {
-                File file = dir.openNextFile();
-                while (file && count < MAX_SESSIONS) {
-                    String filename = file.name();
-                    if ((filename.startsWith("session_") || filename.indexOf("/session_") != -1) && filename.endsWith(".bin")) {
-                        int start_pos = filename.indexOf('_') + 1;
-                        int end_pos = filename.lastIndexOf('.');
-                        if (start_pos > 0 && end_pos > start_pos) {
-                            session_ids[count++] = filename.substring(start_pos, end_pos).toInt();
-                        }
-                    }
-                    file = dir.openNextFile();
-                }
-                dir.close();
-
-                // Sort session IDs descending (highest/newest first)
-                for (int i = 0; i < count - 1; i++) {
-                    for (int j = i + 1; j < count; j++) {
-                        if (session_ids[i] < session_ids[j]) {
-                            uint32_t temp = session_ids[i];
-                            session_ids[i] = session_ids[j];
-                            session_ids[j] = temp;
-                        }
-                    }
-                }
-
-                // Read and output last 5 sessions
-                int sessions_to_show = (count < 5) ? count : 5;
-                for (int i = 0; i < sessions_to_show; i++) {
-                    char filename[64];
-                    snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_ids[i]);
-
-                    File sessionFile = LittleFS.open(filename, "r");
-                    if (sessionFile) {
-                        TimeSeriesSessionHeader header;
-                        GrindSession session;
-
-                        if (sessionFile.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
-                            sessionFile.read((uint8_t*)&session, sizeof(session)) == sizeof(session)) {
-
-                            const char* mode_name = (session.grind_mode == 0) ? "WEIGHT" : "TIME";
-                            const char* term_names[] = {"COMPLETED", "TIMEOUT", "OVERSHOOT", "MAX_PULSES", "UNKNOWN"};
-                            const char* term_name = (session.termination_reason < 4) ? term_names[session.termination_reason] : term_names[4];
-
-                            snprintf(buf, sizeof(buf),
-                                "\n--- Session #%lu ---\n"
-                                "  Mode: %s | Profile: %u | Status: %.16s\n"
-                                "  Target: %.1fg | Final: %.1fg | Error: %+.2fg\n"
-                                "  Total Time: %.1fs | Motor Time: %.1fs | Pulses: %u\n"
-                                "  Termination: %s\n",
-                                session.session_id,
-                                mode_name, session.profile_id, session.result_status,
-                                session.target_weight, session.final_weight, session.error_grams,
-                                session.total_time_ms / 1000.0f, session.total_motor_on_time_ms / 1000.0f, session.pulse_count,
-                                term_name
-                            );
-                            send_chunk(buf);
-
-                            // Read and output events
-                            if (header.event_count > 0) {
-                                snprintf(buf, sizeof(buf), "  Events (%u):\n", header.event_count);
-                                send_chunk(buf);
-
-                                const char* phase_names[] = {
-                                    "IDLE", "INITIALIZING", "SETUP", "TARING", "TARE_CONFIRM",
-                                    "PREDICTIVE", "PULSE_DECISION", "PULSE_EXECUTE", "PULSE_SETTLING",
-                                    "FINAL_SETTLING", "TIME_GRINDING", "TIME_ADDITIONAL_PULSE", "COMPLETED", "TIMEOUT"
-                                };
-
-                                for (uint16_t e = 0; e < header.event_count; e++) {
-                                    GrindEvent event;
-                                    if (sessionFile.read((uint8_t*)&event, sizeof(event)) == sizeof(event)) {
-                                        const char* phase_name = (event.phase_id < 14) ? phase_names[event.phase_id] : "UNKNOWN";
-
-                                        // Calculate event yield (delta)
-                                        float event_yield = event.end_weight - event.start_weight;
-
-                                        // Build base event string
-                                        char base_str[256];
-                                        if (event.pulse_attempt_number > 0) {
-                                            snprintf(base_str, sizeof(base_str),
-                                                "    [%lums] %s (pulse #%u): %.2fg -> %.2fg (%+.2fg) (%.1fms pulse)",
-                                                event.timestamp_ms,
-                                                phase_name,
-                                                event.pulse_attempt_number,
-                                                event.start_weight,
-                                                event.end_weight,
-                                                event_yield,
-                                                event.pulse_duration_ms
-                                            );
-                                        } else {
-                                            snprintf(base_str, sizeof(base_str),
-                                                "    [%lums] %s: %.2fg -> %.2fg (%+.2fg) (%lums)",
-                                                event.timestamp_ms,
-                                                phase_name,
-                                                event.start_weight,
-                                                event.end_weight,
-                                                event_yield,
-                                                event.duration_ms
-                                            );
-                                        }
-
-                                        // Build phase-specific metrics suffix
-                                        char metrics_str[256] = "";
-
-                                        switch (event.phase_id) {
-                                            case 5: // PREDICTIVE
-                                                if (event.grind_latency_ms > 0 || event.pulse_flow_rate > 0 || event.motor_stop_target_weight > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Latency: %lums, Flow: %.1fg/s, Target: %.1fg",
-                                                        event.grind_latency_ms,
-                                                        event.pulse_flow_rate,
-                                                        event.motor_stop_target_weight
-                                                    );
-                                                }
-                                                break;
-
-                                            case 7: // PULSE_EXECUTE
-                                                if (event.pulse_flow_rate > 0 || event.motor_stop_target_weight > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Flow: %.1fg/s, Target: %.1fg",
-                                                        event.pulse_flow_rate,
-                                                        event.motor_stop_target_weight
-                                                    );
-                                                }
-                                                break;
-
-                                            case 8: // PULSE_SETTLING
-                                                if (event.settling_duration_ms > 0 || event.motor_stop_target_weight > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Settled: %lums, Target: %.1fg",
-                                                        event.settling_duration_ms,
-                                                        event.motor_stop_target_weight
-                                                    );
-                                                }
-                                                break;
-
-                                            case 9: // FINAL_SETTLING
-                                                if (event.settling_duration_ms > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Settled: %lums",
-                                                        event.settling_duration_ms
-                                                    );
-                                                }
-                                                break;
-
-                                            case 10: // TIME_GRINDING
-                                                if (event.pulse_flow_rate > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Flow: %.1fg/s",
-                                                        event.pulse_flow_rate
-                                                    );
-                                                }
-                                                break;
-
-                                            case 11: // TIME_ADDITIONAL_PULSE
-                                                if (event.pulse_flow_rate > 0) {
-                                                    snprintf(metrics_str, sizeof(metrics_str), " | Flow: %.1fg/s",
-                                                        event.pulse_flow_rate
-                                                    );
-                                                }
-                                                break;
-                                        }
-
-                                        // Combine base and metrics, add newline
-                                        snprintf(buf, sizeof(buf), "%s%s\n", base_str, metrics_str);
-                                        send_chunk(buf);
-                                    }
-                                }
-                            }
-                        }
-                        sessionFile.close();
-                    }
-                }
+// Full batches go out as soon as the ring holds one, a partial batch once its oldest
+// frame has waited BLE_TELEMETRY_MAX_LATENCY_MS; backlog beyond the ring is dropped
+// on the sampling side, never queued here
+void BluetoothManager::update_telemetry() {
+    if (!telemetry_stream->is_streaming()) {
+        return;
+    }
+    if (!device_connected || !data_telemetry_characteristic) {
+        telemetry_stream->stop();
+        return;
+    }
 
-                free(session_ids);
-            }
-        } else {
-            snprintf(buf, sizeof(buf), "  [NONE] No session files found\n");
-            send_chunk(buf);
+    uint8_t batch[BLE_DATA_CHUNK_SIZE_BYTES];
+    size_t payload_bytes = get_data_chunk_payload_bytes();
+    uint32_t full_batch = Telemetry::frames_per_batch(payload_bytes);
+    for (int sent = 0; sent < BLE_TELEMETRY_MAX_BURST && can_queue_notification(); sent++) {
+        uint32_t pending = telemetry_stream->get_pending_count();
+        if (pending == 0 || (pending < full_batch && millis() - last_telemetry_notify_ms < BLE_TELEMETRY_MAX_LATENCY_MS)) {
+            return;
         }
-    } else {
-        snprintf(buf, sizeof(buf), "  [NONE] Sessions directory does not exist\n");
-        send_chunk(buf);
+        size_t size = telemetry_stream->read_batch(batch, payload_bytes);
+        data_telemetry_characteristic->setValue(batch, size);
+        trace.instant(TraceId::BLE_NOTIFY, (uint16_t)size);
+        data_telemetry_characteristic->notify();
+        last_telemetry_notify_ms = millis();
     }
+}
 
-    snprintf(buf, sizeof(buf), "\n");
-    send_chunk(buf);
+void BluetoothManager::send_trace_dump() {
+    trace.stop();
 
-    // Section 15: Autotune Results
-    snprintf(buf, sizeof(buf), "[AUTOTUNE RESULTS]\n");
-    send_chunk(buf);
+    // Complete lines per notification; the host joins them and stops at TRACE_END
+    char buf[512];
+    auto send_chunk = [this, &buf]() {
+        debug_tx_characteristic->setValue((uint8_t*)buf, strlen(buf));
+        debug_tx_characteristic->notify();
+        vTaskDelay(pdMS_TO_TICKS(SYS_TRACE_DUMP_CHUNK_DELAY_MS));
+    };
 
-    if (LittleFS.exists("/autotune.log")) {
-        File autotuneFile = LittleFS.open("/autotune.log", "r");
-        if (autotuneFile) {
-            // Stream file contents in chunks
-            while (autotuneFile.available()) {
-                size_t bytesToRead = autotuneFile.available();
-                if (bytesToRead > sizeof(buf) - 1) {
-                    bytesToRead = sizeof(buf) - 1;
-                }
-                size_t bytesRead = autotuneFile.readBytes(buf, bytesToRead);
-                buf[bytesRead] = '\0';
-                send_chunk(buf);
-            }
-            autotuneFile.close();
-
-            // Add newline after file contents
-            snprintf(buf, sizeof(buf), "\n");
-            send_chunk(buf);
-        } else {
-            snprintf(buf, sizeof(buf), "  [ERROR] Failed to open autotune.log\n\n");
-            send_chunk(buf);
+    uint32_t total_events = 0;
+    if (trace.format_header(buf, sizeof(buf)) > 0) {
+        send_chunk();
+    }
+    for (uint8_t core = 0; core < 2; core++) {
+        if (trace.format_core(core, buf, sizeof(buf)) > 0) {
+            send_chunk();
         }
-    } else {
-        snprintf(buf, sizeof(buf), "  [NOT RUN] Autotune has not been executed yet\n\n");
-        send_chunk(buf);
     }
-
-    // Final marker
-    LOG_BLE("DEBUG: Sending final marker\n");
-    snprintf(buf, sizeof(buf), "=== END OF REPORT ===\n");
-    send_chunk(buf);
-    LOG_BLE("=== DIAGNOSTICS: Report generation COMPLETED ===\n");
+    for (uint8_t core = 0; core < 2 && device_connected; core++) {
+        uint32_t first = 0;
+        uint32_t sent;
+        while (device_connected && (sent = trace.format_data(core, first, buf, sizeof(buf))) > 0) {
+            send_chunk();
+            first += sent;
+        }
+        total_events += first;
+    }
+    strncpy(buf, "TRACE_END\n", sizeof(buf));
+    send_chunk();
+    LOG_BLE("TRACE: dumped %lu events\n", (unsigned long)total_events);
 }
@@ -3,8 +3,15 @@
 #include <BLEDevice.h>
 #include <BLEServer.h>
 #include <BLEUtils.h>
-#include <BLE2902.h>
+#include <sdkconfig.h>
+// Host stack is chosen by sdkconfig (custom_sdkconfig in platformio.ini); the BLE* API is shared
+#if defined(CONFIG_BT_NIMBLE_ENABLED)
+#include <host/ble_gap.h>
+#else
+#include <esp_gap_ble_api.h>
+#endif
 #include <functional>
+#include <atomic>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include <Preferences.h>
@@ -12,9 +19,12 @@
 #include "../config/constants.h"
 #include "ota_handler.h"
 #include "data_stream.h"
+#include "diagnostic_report.h"
+#include "debug_log_batcher.h"
 
 // Forward declaration to avoid circular dependency
 class UIManager;
+class Telemetry;
 
 // Callback interface for UI status updates
 using UIStatusCallback = std::function<void(const char*)>;
@@ -24,10 +34,50 @@ struct UIStatusMessage {
     char text[64];
 };
 
+// Profile store operations (BLE_DEBUG_CMD_PROFILE_STORE)
+enum BLEProfileStoreOp : uint8_t {
+    BLE_PROFILE_STORE_LIST = 0x00,          // No arguments
+    BLE_PROFILE_STORE_SAVE = 0x01,          // [tab:1][stored id:1, 0xFF = by name or first free][name, optional]
+    BLE_PROFILE_STORE_RECALL = 0x02,        // [stored id:1][tab:1]
+    BLE_PROFILE_STORE_DELETE = 0x03         // [stored id:1]
+};
+
+// Grind order operations (BLE_DEBUG_CMD_GRIND_ORDER), all little-endian
+enum BLEGrindOrderOp : uint8_t {
+    BLE_GRIND_ORDER_STATUS = 0x00,          // No arguments
+    BLE_GRIND_ORDER_SUBMIT = 0x01,          // [order_id:4][count:1][tab:1, 0xFF = selected][stored id:1, 0xFF = none][weight:f32 optional]
+    BLE_GRIND_ORDER_CANCEL = 0x02           // [order_id:4 optional, 0 or none = all]
+};
+
+// Sysinfo payload encodings (BLE_DEBUG_CMD_SYSINFO_CONFIG)
+enum BLESysinfoFormat : uint8_t {
+    BLE_SYSINFO_FORMAT_BINARY = 0,          // [BLE_SYSINFO_BINARY_VERSION] + packed LE fields, see update_*_info()
+    BLE_SYSINFO_FORMAT_TEXT = 1             // JSON object, for reading by hand
+};
+
 // Debug command enums
 enum BLEDebugCommand {
     BLE_DEBUG_CMD_ENABLE = 0x01,
-    BLE_DEBUG_CMD_DISABLE = 0x02
+    BLE_DEBUG_CMD_DISABLE = 0x02,
+    BLE_DEBUG_CMD_TIMING_REPORT = 0x03,     // Print sampling timing histograms
+    BLE_DEBUG_CMD_TIMING_RESET = 0x04,      // Clear sampling timing histograms
+    BLE_DEBUG_CMD_ADC_CAPTURE_ON = 0x05,    // Record the raw ADC track in session files from the next grind
+    BLE_DEBUG_CMD_ADC_CAPTURE_OFF = 0x06,
+    BLE_DEBUG_CMD_TRACE_START = 0x07,       // Start a trace capture; optional uint16 LE duration in ms
+    BLE_DEBUG_CMD_TRACE_DUMP = 0x08,        // End the capture and stream it over debug TX
+    BLE_DEBUG_CMD_SYSINFO_CONFIG = 0x09,    // [format:1][interval_ms:2 optional]; BLESysinfoFormat, until disconnect
+    BLE_DEBUG_CMD_UI_BENCHMARK = 0x0A,      // Run the UI benchmark; the report is logged when it ends
+    BLE_DEBUG_CMD_NETWORK_CONFIG = 0x0B,    // [ssid]\0[password]\0[broker URI]; -mqtt builds reconnect with them
+    BLE_DEBUG_CMD_HOT_PATH_BENCHMARK = 0x0C, // Time the weight filter queries (HotPathBenchmark); the table is logged
+    BLE_DEBUG_CMD_GRIND_LOOP_PROFILE = 0x0D, // Log the grind loop's per-phase stage timing (GrindLoopProfiler)
+    BLE_DEBUG_CMD_NOISE_SPECTRUM = 0x0E,    // [capture:1 optional] 0 = idle now, 1 = next motor run; the spectrum is logged
+    BLE_DEBUG_CMD_LOAD_CELL_CHANNELS = 0x0F, // [channel 2 gain:f32 LE optional]; logs each summed channel's raw and gain
+    BLE_DEBUG_CMD_PROFILE_STORE = 0x10,     // [op:1][...]; BLEProfileStoreOp, the result and store contents are logged
+    BLE_DEBUG_CMD_LOG_LEVEL = 0x11,         // [category:1][level:1] optional; 0xFF category = all, 0xFF level = off, 0xFE = defaults; levels are logged
+    BLE_DEBUG_CMD_STORAGE_BENCHMARK = 0x12, // Time LittleFS mount, session writes, reads and directory scans (StorageBenchmark); the table is logged
+    BLE_DEBUG_CMD_GRIND_ORDER = 0x13,       // [op:1][...]; BLEGrindOrderOp, order events are logged as [ORDER] lines
+    BLE_DEBUG_CMD_ROLLUPS = 0x14,           // Log the hourly and daily session rollups (SessionRollups)
+    BLE_DEBUG_CMD_CRASH_SNAPSHOT = 0x15     // Log the previous run's crash snapshot, if it left one (CrashSnapshot)
 };
 
 // Data export enums
@@ -36,13 +86,26 @@ enum BLEDataCommand {
     BLE_DATA_CMD_GET_COUNT = 0x12,
     BLE_DATA_CMD_CLEAR_DATA = 0x13,
     BLE_DATA_CMD_GET_FILE_LIST = 0x14,
-    BLE_DATA_CMD_REQUEST_FILE = 0x15
+    BLE_DATA_CMD_REQUEST_FILE = 0x15,       // [session_id:4] paced export; [session_id:4][credits:2][flags:1 optional] bulk export
+    BLE_DATA_CMD_GRANT_CREDITS = 0x16,      // [credits:2] more chunks for the running bulk export
+    BLE_DATA_CMD_REQUEST_BATCH = 0x17,      // [start_session_id:4][resume_offset:4][credits:2][flags:1 optional] framed bulk export
+    BLE_DATA_CMD_TELEMETRY_START = 0x18,    // [rate_hz:2 optional, 0 = every sample] live frames on the telemetry characteristic
+    BLE_DATA_CMD_TELEMETRY_STOP = 0x19,
+    BLE_DATA_CMD_QUERY_SESSIONS = 0x1A,     // [SessionQuery:24][credits:2][resume_offset:4 optional][flags:1 optional] matching records or session files
+    BLE_DATA_CMD_GET_LOG_LAYOUT = 0x1B      // [credits:2 optional][flags:1 optional] session file struct layout (grind_log_layout.h)
+};
+
+// Export request flags; firmware without them ignores the byte and sends the stream raw
+enum BLEDataExportFlag {
+    BLE_DATA_EXPORT_COMPRESSED = 0x01       // heatshrink-compressed stream (DATA_STREAM_COMPRESSED_MAGIC header)
 };
 
+#define BLE_CONN_NONE 0xFFFF                // No central: no lock owner, or a notify to every subscriber
+
 enum BLEDataStatus {
     BLE_DATA_IDLE = 0x20,
     BLE_DATA_EXPORTING = 0x21,
-    BLE_DATA_COMPLETE = 0x22,
+    BLE_DATA_COMPLETE = 0x22,               // Bulk export appends [bytes_sent:4]
     BLE_DATA_ERROR = 0x23
 };
 
@@ -51,6 +114,16 @@ enum BLEDataStatus {
  * 
  * Handles BLE connection, characteristic management, and coordinates
  * between OTA updates and data export operations.
+ *
+ * Up to BLE_MAX_CONNECTIONS centrals stay connected at once (a dashboard and
+ * a maintenance client); advertising continues while a slot is free. The
+ * stack keeps each link's subscriptions, so telemetry, debug and sysinfo
+ * notifies fan out to whoever subscribed. The requests behind them are kept
+ * per central and combined: the debug stream runs while any central enabled
+ * it, telemetry at the fastest rate asked for, sysinfo at the shortest
+ * period. An export and an OTA each belong to the central that started it:
+ * their chunks, acks and status go to that link only, and the other centrals
+ * cannot steer, stop or start another one until it ends or its owner leaves.
  */
 class BluetoothManager : public BLEServerCallbacks, public BLECharacteristicCallbacks {
 private:
@@ -71,6 +144,7 @@ private:
     BLECharacteristic* data_control_characteristic;
     BLECharacteristic* data_transfer_characteristic;
     BLECharacteristic* data_status_characteristic;
+    BLECharacteristic* data_telemetry_characteristic;
     
     // Debug characteristics
     BLECharacteristic* debug_rx_characteristic;
@@ -83,10 +157,30 @@ private:
     BLECharacteristic* sysinfo_sessions_characteristic;
     BLECharacteristic* sysinfo_diagnostics_characteristic;
     
+    // Connected centrals; conn_id is the NimBLE connection handle or the Bluedroid conn id
+    struct Peer {
+        bool active;
+        uint16_t conn_id;
+#if !defined(CONFIG_BT_NIMBLE_ENABLED)
+        esp_bd_addr_t address;              // Bluedroid link requests go by address
+#endif
+        bool link_params_requested;         // Idle parameters sent for this link
+        bool debug_stream;                  // BLE_DEBUG_CMD_ENABLE from this central
+        bool telemetry;                     // BLE_DATA_CMD_TELEMETRY_START from this central
+        uint16_t telemetry_rate_hz;
+        uint16_t sysinfo_interval_ms;
+    };
+    Peer peers[BLE_MAX_CONNECTIONS];
+    uint8_t peer_count;
+    uint16_t writer_conn_id;                // Central whose write the host callback is handling
+    uint16_t export_owner;                  // Central that started the running export
+    uint16_t ota_owner;                     // Central that started or resumed the running OTA
+
     // Connection state
-    bool device_connected;
+    bool device_connected;                  // At least one central
     bool ble_enabled;
     bool debug_stream_active;
+    DebugLogBatcher debug_log;              // Stream lines, sent batched by update_debug_log()
     unsigned long enable_time;
     unsigned long timeout_ms;
     unsigned long last_disconnect_time;
@@ -94,44 +188,113 @@ private:
     // Component handlers
     OTAHandler ota_handler;
     DataStreamManager data_stream;
+
+    // Pipelined OTA: acks and END are sent and run from the BLE task
+    bool ota_ack_pending;                   // Open the first window right after START
+    bool ota_end_pending;                   // END received, finalize once the writer has drained
+    bool ota_over_ble;                      // The running OTA is ours, not a Wi-Fi download
+    uint32_t ota_acked_bytes;               // Flushed byte count in the last ack
+    bool ota_resume_pending;                // RESUME accepted, ack the offset once the writer has drained
     
     // Data export state
     bool data_export_in_progress;
     BLEDataStatus data_status;
     uint16_t current_chunk;
     unsigned long next_chunk_time;
+    uint32_t export_trickle_ms;             // Last chunk sent during a grind (RadioCoexistence)
     uint32_t current_file_session_id;  // For per-file streaming
+    bool bulk_transfer;                     // Host-granted credits instead of fixed pacing
+    bool batch_export;                      // Framed multi-session stream (DataStreamManager batch)
+    bool query_export;                      // Session query or log layout reply, streamed like a file
+    std::atomic<uint32_t> transfer_credits; // Chunks the host can still take; granted from the BLE callback
+    uint32_t transfer_bytes_sent;
+    unsigned long last_progress_time;
     
     // UI status callback
     UIStatusCallback ui_status_callback;
     
     // Queue to marshal UI status messages to UI task context
     QueueHandle_t ui_status_queue;
+    TaskHandle_t ui_status_consumer = nullptr;  // Woken on each queued message (UI render task)
 
     // Diagnostics report control flags
     bool diagnostic_report_pending;
-    bool diagnostic_report_in_progress;
+    DiagnosticReport diagnostic_report;         // Streamed by update_diagnostic_report()
+    bool trace_start_pending;
+    uint16_t trace_start_duration_ms;
+    bool trace_dump_pending;
+    bool telemetry_start_pending;
+    uint16_t telemetry_rate_hz;
+    bool telemetry_stop_pending;
+    unsigned long last_telemetry_notify_ms;
+    Telemetry* telemetry_stream;                // The selected grinder's, switched when the selection changes
+
+    // Sysinfo characteristics: binary by default, text as a debug view
+    BLESysinfoFormat sysinfo_format;
+    uint16_t sysinfo_interval_ms;
+    unsigned long last_sysinfo_update_ms;
+    bool sysinfo_refresh_pending;
+    std::atomic<bool> ui_benchmark_requested;   // Set by the debug command, taken by the UI task
+
+    // Transfer session: fast link parameters on the owner's link while an export or OTA runs (BLE task)
+    uint16_t transfer_conn_id;
+    bool transfer_session_active;
+    unsigned long last_transfer_activity_ms;
 
     // Private methods
     void update_ui_status(const char* status);
     void enqueue_ui_status(const char* status);
     void set_ota_status(BLEOTAStatus status);
+    void send_ota_ack(uint32_t flushed_bytes);   // [RECEIVING][flushed:4][window_end:4]
+    void update_ota_transfer();
+    void finish_ota();
     void set_data_status(BLEDataStatus status);
+    struct OtaStartRequest {
+        uint32_t patch_size;
+        bool is_full_update;
+        String expected_build;
+        String expected_firmware_version;
+        uint32_t patch_crc;                 // Patch id for RESUME, 0 = not resumable
+    };
+    static bool parse_ota_start(const String& data, OtaStartRequest* request);
     void handle_ota_control_command(BLECharacteristic* characteristic);
     void handle_ota_data_chunk(BLECharacteristic* characteristic);
     void handle_debug_command(BLECharacteristic* characteristic);
     void handle_data_control_command(BLECharacteristic* characteristic);
-    void send_next_data_chunk();
+    bool send_next_data_chunk();
+    Peer* find_peer(uint16_t conn_id);
+    void add_peer(uint16_t conn_id, const uint8_t* address);
+    void remove_peer(uint16_t conn_id);
+    void apply_peer_requests();             // Debug stream, telemetry and sysinfo period over every central
+    bool is_owner(uint16_t owner) const { return owner == BLE_CONN_NONE || owner == writer_conn_id; }
+    void notify_peer(BLECharacteristic* characteristic, uint16_t conn_id, const uint8_t* data, size_t size);
+    bool can_queue_notification(uint16_t conn_id = BLE_CONN_NONE);
+    size_t get_data_chunk_payload_bytes(uint16_t conn_id = BLE_CONN_NONE);
+    void send_data_progress();              // Rate-limited to BLE_DATA_PROGRESS_INTERVAL_MS
+    void finish_data_export();
     void send_measurement_count();
     void send_log_message(const char* message);
     void clear_measurement_data();
     void send_file_list();
-    void send_individual_file(uint32_t session_id);
+    void send_individual_file(uint32_t session_id, uint16_t credits, uint8_t flags);   // credits 0: paced export
+    void send_session_batch(uint32_t start_session_id, uint32_t resume_offset, uint16_t credits, uint8_t flags);
+    void send_session_query(const SessionQuery& query, uint16_t credits, uint32_t resume_offset, uint8_t flags);
+    void send_log_layout(uint16_t credits, uint8_t flags);
+    bool can_start_export();
+    void begin_export(uint16_t credits, uint8_t flags);
     void update_system_info();
     void update_performance_info();
     void update_hardware_info();
     void update_sessions_info();
-    void generate_diagnostic_report();
+    void notify_sysinfo(BLECharacteristic* characteristic, const uint8_t* payload, size_t size);
+    void update_diagnostic_report();
+    void update_debug_log();
+    void update_telemetry();
+    void send_trace_dump();
+    bool verify_stack_core_affinity();
+    void update_transfer_session();
+    void request_link_params(Peer& peer, bool transfer);
+    void init_stack();
     
 public:
     BluetoothManager();
@@ -154,10 +317,16 @@ public:
     void enable_during_bootup();
     
     /**
-     * Disable BLE and cleanup
+     * Put the radio idle: drop the link and stop advertising, keeping the stack
+     * and GATT database for a fast enable()
      */
     void disable();
     
+    /**
+     * Disable and deinitialize the BLE stack
+     */
+    void shutdown();
+    
     /**
      * Handle periodic updates (call from main loop)
      */
@@ -176,11 +345,18 @@ public:
     bool is_connected() const { return device_connected; }
     bool is_updating() const { return ota_handler.is_ota_active(); }
     bool is_debug_stream_active() const { return debug_stream_active; }
+    bool is_transfer_session_active() const { return transfer_session_active; }
     
     /**
      * OTA progress information
      */
     float get_ota_progress() const { return ota_handler.get_progress(); }
+
+    /**
+     * The one OTA handler; a Wi-Fi download (MqttManager) feeds it too, so the
+     * OTA screen and task suspension follow either path
+     */
+    OTAHandler& get_ota_handler() { return ota_handler; }
     unsigned long get_remaining_time_ms() const;
     
     /**
@@ -219,12 +395,22 @@ public:
      */
     String check_ota_failure_after_boot();
     
-    // BLE Callbacks
-    void onConnect(BLEServer* server) override;
-    void onDisconnect(BLEServer* server) override;
+    // BLE Callbacks: the variants with the connection; the stack calls them after the plain ones
+#if defined(CONFIG_BT_NIMBLE_ENABLED)
+    void onConnect(BLEServer* server, ble_gap_conn_desc* desc) override;
+    void onDisconnect(BLEServer* server, ble_gap_conn_desc* desc) override;
+    void onWrite(BLECharacteristic* characteristic, ble_gap_conn_desc* desc) override;
+#else
+    void onConnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) override;
+    void onDisconnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) override;
+    void onWrite(BLECharacteristic* characteristic, esp_ble_gatts_cb_param_t* param) override;
+#endif
     void onWrite(BLECharacteristic* characteristic) override;
     void onRead(BLECharacteristic* characteristic) override;
 
     // Drain a status message queued from BLE task; called by UI task
     bool dequeue_ui_status(char* out, size_t out_len);
+    void set_ui_status_consumer(TaskHandle_t task) { ui_status_consumer = task; }
+    // UI benchmark requested over BLE since the last call; called by UI task
+    bool take_ui_benchmark_request() { return ui_benchmark_requested.exchange(false, std::memory_order_relaxed); }
 };
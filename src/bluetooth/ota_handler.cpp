@@ -4,18 +4,41 @@
 #include "../hardware/touch_driver.h"
 #include "../hardware/hardware_manager.h"
 #include "../tasks/task_manager.h"
+#include "../system/statistics_manager.h"
+#include "../system/preference_cache.h"
+#include "../system/power_manager.h"
+#include "../system/state_machine.h"
 #include <Arduino.h>
 #include <BLEDevice.h>
+#include <esp_heap_caps.h>
+
+static_assert((BLE_OTA_RING_BYTES & (BLE_OTA_RING_BYTES - 1)) == 0, "OTA ring size must be a power of two");
 
 OTAHandler::OTAHandler() 
     : ota_in_progress(false)
     , patch_size(0)
     , received_size(0)
+    , flushed_size(0)
     , current_status(BLE_OTA_IDLE)
     , current_firmware_build_number("")
     , is_full_update(false)
     , power_state(NORMAL_POWER)
-    , normal_cpu_freq_mhz(BLE_NORMAL_CPU_FREQ_MHZ) {
+    , normal_cpu_freq_mhz(BLE_NORMAL_CPU_FREQ_MHZ)
+    , patch_stream(nullptr)
+    , patch_crc(0)
+    , parked_since_ms(0)
+    , patch_mirror()
+    , mirror_active(false)
+    , mirror_checkpoint(0)
+    , replay_end(0)
+    , ring(nullptr)
+    , flash_batch(nullptr)
+    , ring_head(0)
+    , ring_tail(0)
+    , flush_all(false)
+    , write_failed(false)
+    , writer_busy(false)
+    , writer_task(nullptr) {
 }
 
 OTAHandler::~OTAHandler() {
@@ -48,6 +71,8 @@ void OTAHandler::restore_normal_power_mode() {
 
 void OTAHandler::reduce_power_for_ble() {
     if (power_state == BLE_REDUCED_POWER) return;
+    // esp_pm owns the CPU clock; setCpuFrequencyMhz() would override its locks
+    if (power_manager.is_enabled()) return;
     
     // Store current CPU frequency
     normal_cpu_freq_mhz = getCpuFrequencyMhz();
@@ -97,7 +122,14 @@ void OTAHandler::restore_normal_power() {
     LOG_BLE("OTA Power: Normal power mode restored\n");
 }
 
-bool OTAHandler::start_ota(uint32_t size, const String& expected_build_number, bool is_full_update, const String& expected_firmware_version) {
+bool OTAHandler::start_ota(uint32_t size, const String& expected_build_number, bool is_full_update,
+                           const String& expected_firmware_version, uint32_t patch_crc) {
+    return begin_ota(size, expected_build_number, is_full_update, expected_firmware_version, patch_crc, 0);
+}
+
+// replay_bytes > 0: resume after a reboot, the writer first feeds that much of the mirror to the new stream
+bool OTAHandler::begin_ota(uint32_t size, const String& expected_build_number, bool is_full_update,
+                           const String& expected_firmware_version, uint32_t patch_crc, uint32_t replay_bytes) {
     LOG_OTA_DEBUG("start_ota() called - size=%lu, build=%s, full=%d\n", 
                   (unsigned long)size, expected_build_number.c_str(), is_full_update);
     
@@ -107,8 +139,24 @@ bool OTAHandler::start_ota(uint32_t size, const String& expected_build_number, b
         return false;
     }
     
+    if (!allocate_pipeline()) {
+        current_status = BLE_OTA_ERROR;
+        return false;
+    }
+
+    // A writer still finishing a batch of an aborted update must not see the reset ring
+    release_stream();
+
     patch_size = size;
-    received_size = 0;
+    received_size = replay_bytes;
+    flushed_size.store(0, std::memory_order_relaxed);
+    replay_end = replay_bytes;
+    this->patch_crc = patch_crc;
+    parked_since_ms = 0;
+    ring_head.store(0, std::memory_order_relaxed);
+    ring_tail.store(0, std::memory_order_relaxed);
+    flush_all.store(false, std::memory_order_relaxed);
+    write_failed.store(false, std::memory_order_relaxed);
     this->is_full_update = is_full_update;
     
     LOG_BLE("OTA: Starting %s update (%lu KB)\n", is_full_update ? "full" : "delta", (unsigned long)patch_size / 1024);
@@ -157,37 +205,279 @@ bool OTAHandler::start_ota(uint32_t size, const String& expected_build_number, b
         return false;
     }
     LOG_OTA_DEBUG("start_update() SUCCESS\n");
+    open_mirror(replay_bytes);
     
     ota_in_progress = true;
+    power_manager.set_hold(PowerHold::OTA, true);
     current_status = BLE_OTA_RECEIVING;
+    state_machine.post(UIState::OTA_UPDATE, StateEventSource::BLUETOOTH);
+    if (replay_end > 0) {
+        xTaskNotifyGive(writer_task);
+    }
     LOG_OTA_DEBUG("OTA started successfully - status=BLE_OTA_RECEIVING\n");
     return true;
 }
 
+bool OTAHandler::resume_ota(uint32_t size, uint32_t patch_crc, bool is_full_update,
+                            const String& expected_build_number, const String& expected_firmware_version) {
+    if (patch_crc == 0) {
+        return false;
+    }
+
+    if (ota_in_progress) {
+        if (patch_crc == this->patch_crc && size == patch_size && is_full_update == this->is_full_update &&
+            !write_failed.load(std::memory_order_relaxed)) {
+            // Whatever arrived before the link dropped is drained first; the host continues after it
+            if (!is_parked()) {
+                finish_writes();
+            }
+            parked_since_ms = 0;
+            current_status = BLE_OTA_RECEIVING;
+            LOG_BLE("OTA: Resuming at %lu KB / %lu KB\n", (unsigned long)received_size / 1024,
+                    (unsigned long)patch_size / 1024);
+            return true;
+        }
+        LOG_BLE("OTA: Resume is for another patch, dropping the running update\n");
+        abort_ota();
+        return false;
+    }
+
+    ResumeRecord record = {};
+    if (!preferences || !preferences->isKey("ota_resume") ||
+        preferences->getBytes("ota_resume", &record, sizeof(record)) != sizeof(record)) {
+        return false;
+    }
+    record.stored -= record.stored % PARTITION_PAGE_SIZE;
+    if (record.patch_crc != patch_crc || record.patch_size != size || record.full_update != (is_full_update ? 1 : 0) ||
+        record.stored == 0) {
+        return false;
+    }
+    LOG_BLE("OTA: Resuming from the patch partition at %lu KB / %lu KB\n", (unsigned long)record.stored / 1024,
+            (unsigned long)size / 1024);
+    return begin_ota(size, expected_build_number, is_full_update, expected_firmware_version, patch_crc, record.stored);
+}
+
+void OTAHandler::park_ota() {
+    if (!ota_in_progress || is_parked()) {
+        return;
+    }
+    finish_writes();
+    uint32_t now = millis();
+    parked_since_ms = now ? now : 1;
+    LOG_BLE("OTA: Link lost at %lu KB, holding the update %lus for a resume\n",
+            (unsigned long)received_size / 1024, (unsigned long)(BLE_OTA_RESUME_TIMEOUT_MS / 1000));
+}
+
+bool OTAHandler::has_park_expired() const {
+    return is_parked() && millis() - parked_since_ms >= BLE_OTA_RESUME_TIMEOUT_MS;
+}
+
+// Mirror of the received patch in the patch partition, for a resume after a reboot; without it
+// (no id, or a patch larger than the partition) the update still resumes within this boot
+void OTAHandler::open_mirror(uint32_t replay_bytes) {
+    close_mirror(true);
+    if (patch_crc == 0) {
+        return;
+    }
+
+    int result = replay_bytes > 0
+        ? delta_partition_resume(&patch_mirror, DEFAULT_PARTITION_LABEL_PATCH, patch_size, replay_bytes)
+        : delta_partition_init(&patch_mirror, DEFAULT_PARTITION_LABEL_PATCH, patch_size);
+    mirror_active = (result == ESP_OK);
+    if (mirror_active) {
+        save_resume_record(replay_bytes);
+    } else {
+        LOG_BLE("OTA: No patch partition mirror (%d), a reboot restarts the transfer\n", result);
+        close_mirror(false);
+    }
+}
+
+void OTAHandler::close_mirror(bool keep_record) {
+    if (mirror_active) {
+        delta_partition_finish(&patch_mirror);
+        mirror_active = false;
+    }
+    if (!keep_record && preferences && preferences->isKey("ota_resume")) {
+        preferences->remove("ota_resume");
+    }
+}
+
+// Writer task
+void OTAHandler::mirror_batch(const uint8_t* data, uint32_t size) {
+    if (!mirror_active) {
+        return;
+    }
+    if (delta_partition_write(&patch_mirror, (const char*)data, size) != ESP_OK) {
+        LOG_BLE("OTA: Patch mirror write failed, a reboot restarts the transfer\n");
+        close_mirror(false);
+        return;
+    }
+    if ((uint32_t)patch_mirror.offset - mirror_checkpoint >= BLE_OTA_CHECKPOINT_BYTES) {
+        save_resume_record(patch_mirror.offset);
+    }
+}
+
+void OTAHandler::save_resume_record(uint32_t stored) {
+    if (!preferences) {
+        return;
+    }
+    // delta_partition_resume() only continues at a sector boundary; the bytes past it are mirrored again
+    stored -= stored % PARTITION_PAGE_SIZE;
+    ResumeRecord record = {};
+    record.patch_size = patch_size;
+    record.patch_crc = patch_crc;
+    record.stored = stored;
+    record.full_update = is_full_update ? 1 : 0;
+    preferences->putBytes("ota_resume", &record, sizeof(record));
+    mirror_checkpoint = stored;
+}
+
+// Writer task: the mirrored prefix goes into the new stream before anything from the ring
+bool OTAHandler::replay_mirror() {
+    uint32_t offset = flushed_size.load(std::memory_order_relaxed);
+    while (offset < replay_end) {
+        if (!ota_in_progress || write_failed.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        uint32_t n = replay_end - offset < BLE_OTA_FLASH_BATCH_BYTES ? replay_end - offset : BLE_OTA_FLASH_BATCH_BYTES;
+        int result = delta_partition_read(&patch_mirror, offset, (char*)flash_batch, n);
+        if (result == 0) {
+            result = delta_stream_write(patch_stream, (const char*)flash_batch, n);
+        }
+        if (result != 0) {
+            LOG_BLE("OTA: Replay from the patch partition failed at %lu: %s\n", (unsigned long)offset,
+                    delta_error_as_string(result));
+            write_failed.store(true, std::memory_order_relaxed);
+            current_status = BLE_OTA_ERROR;
+            return false;
+        }
+        offset += n;
+        flushed_size.store(offset, std::memory_order_release);
+    }
+    LOG_BLE("OTA: Replayed %lu KB from the patch partition\n", (unsigned long)replay_end / 1024);
+    replay_end = 0;
+    return true;
+}
+
+// BLE callback: copy into the ring and wake the writer; no flash access here
 bool OTAHandler::process_data_chunk(const uint8_t* data, size_t size) {
-    if (!ota_in_progress) {
+    if (!ota_in_progress || is_parked() || write_failed.load(std::memory_order_relaxed)) {
         return false;
     }
-    
-    // Write patch data to patch partition
-    if (delta_partition_write(&patch_writer, (const char*)data, size) != ESP_OK) {
-        LOG_BLE("OTA: Patch write failed at offset %lu\n", (unsigned long)received_size);
+
+    uint32_t received = received_size.load(std::memory_order_relaxed);
+    if (received + size > patch_size) {
+        LOG_BLE("OTA: Chunk of %u bytes runs past the %lu byte patch\n", (unsigned)size, (unsigned long)patch_size);
         current_status = BLE_OTA_ERROR;
         return false;
     }
-    
-    received_size += size;
-    
-    // Progress logging every 16KB for better visibility, plus at start and end
-    if (received_size % 16384 == 0 || received_size == size || received_size == patch_size) {
-        LOG_BLE("OTA: Transfer %lu KB / %lu KB (%.1f%%)\n", 
-                     (unsigned long)received_size / 1024, (unsigned long)patch_size / 1024, 
-                     get_progress());
+
+    uint32_t head = ring_head.load(std::memory_order_relaxed);
+    uint32_t used = head - ring_tail.load(std::memory_order_acquire);
+    if (size > BLE_OTA_RING_BYTES - used) {
+        LOG_BLE("OTA: Receive ring full at %lu bytes (host ignored the ack window)\n", (unsigned long)received);
+        current_status = BLE_OTA_ERROR;
+        return false;
+    }
+
+    uint32_t pos = head & (BLE_OTA_RING_BYTES - 1);
+    size_t first = size < BLE_OTA_RING_BYTES - pos ? size : BLE_OTA_RING_BYTES - pos;
+    memcpy(ring + pos, data, first);
+    memcpy(ring, data + first, size - first);
+    ring_head.store(head + size, std::memory_order_release);
+    received_size.store(received + size, std::memory_order_relaxed);
+
+    xTaskNotifyGive(writer_task);
+    return true;
+}
+
+void OTAHandler::finish_writes() {
+    flush_all.store(true, std::memory_order_relaxed);
+    if (writer_task) {
+        xTaskNotifyGive(writer_task);
+    }
+}
+
+bool OTAHandler::is_write_drained() const {
+    if (write_failed.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    return flushed_size.load(std::memory_order_acquire) == received_size.load(std::memory_order_relaxed);
+}
+
+bool OTAHandler::allocate_pipeline() {
+    if (!ring) {
+        ring = (uint8_t*)heap_caps_malloc(BLE_OTA_RING_BYTES, MALLOC_CAP_SPIRAM);
+    }
+    if (!flash_batch) {
+        flash_batch = (uint8_t*)heap_caps_malloc(BLE_OTA_FLASH_BATCH_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (!ring || !flash_batch) {
+        LOG_BLE("OTA: No memory for the %u KB receive ring\n", (unsigned)(BLE_OTA_RING_BYTES / 1024));
+        return false;
+    }
+    if (!writer_task &&
+        xTaskCreatePinnedToCore(writer_task_wrapper, "OTAWriter", SYS_TASK_OTA_WRITER_STACK_SIZE, this,
+                                SYS_TASK_PRIORITY_OTA_WRITER, &writer_task, SYS_TASK_CORE_OTA_WRITER) != pdPASS) {
+        writer_task = nullptr;
+        LOG_BLE("OTA: Failed to create writer task\n");
+        return false;
     }
-    
     return true;
 }
 
+void OTAHandler::writer_task_wrapper(void* parameter) {
+    OTAHandler* handler = static_cast<OTAHandler*>(parameter);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        handler->writer_busy.store(true, std::memory_order_relaxed);
+        handler->flush_ring();
+        handler->writer_busy.store(false, std::memory_order_release);
+    }
+}
+
+// Writer task: whole sectors while receiving, the remainder once the patch is complete or END arrived
+void OTAHandler::flush_ring() {
+    if (replay_end > 0 && !replay_mirror()) {
+        return;
+    }
+    while (ota_in_progress && !write_failed.load(std::memory_order_relaxed)) {
+        uint32_t tail = ring_tail.load(std::memory_order_relaxed);
+        uint32_t pending = ring_head.load(std::memory_order_acquire) - tail;
+        bool final_batch = received_size.load(std::memory_order_relaxed) >= patch_size ||
+                           flush_all.load(std::memory_order_relaxed);
+        if (pending == 0 || (pending < BLE_OTA_FLASH_BATCH_BYTES && !final_batch)) {
+            return;
+        }
+
+        uint32_t batch = pending < BLE_OTA_FLASH_BATCH_BYTES ? pending : BLE_OTA_FLASH_BATCH_BYTES;
+        uint32_t pos = tail & (BLE_OTA_RING_BYTES - 1);
+        uint32_t first = batch < BLE_OTA_RING_BYTES - pos ? batch : BLE_OTA_RING_BYTES - pos;
+        memcpy(flash_batch, ring + pos, first);
+        memcpy(flash_batch + first, ring, batch - first);
+
+        uint32_t flushed = flushed_size.load(std::memory_order_relaxed);
+        int result = delta_stream_write(patch_stream, (const char*)flash_batch, batch);
+        if (result != 0) {
+            LOG_BLE("OTA: Patch apply failed at offset %lu: %s\n", (unsigned long)flushed, delta_error_as_string(result));
+            write_failed.store(true, std::memory_order_relaxed);
+            current_status = BLE_OTA_ERROR;
+            return;
+        }
+        mirror_batch(flash_batch, batch);
+        ring_tail.store(tail + batch, std::memory_order_release);
+        flushed_size.store(flushed + batch, std::memory_order_release);
+        flushed += batch;
+
+        // Progress logging every 16KB for better visibility, plus at start and end
+        if (flushed % 16384 == 0 || flushed == batch || flushed == patch_size) {
+            LOG_BLE("OTA: Transfer %lu KB / %lu KB (%.1f%%)\n",
+                         (unsigned long)flushed / 1024, (unsigned long)patch_size / 1024,
+                         100.0f * flushed / patch_size);
+        }
+    }
+}
+
 bool OTAHandler::complete_ota() {
     LOG_OTA_DEBUG("complete_ota() called\n");
     
@@ -218,12 +508,19 @@ bool OTAHandler::complete_ota() {
     
     LOG_OTA_DEBUG("Calling finalize_update()...\n");
     bool success = finalize_update();
+    close_mirror(false);        // Installed, or a patch that does not apply: nothing to resume either way
     if (success) {
         current_status = BLE_OTA_SUCCESS;
         LOG_OTA_DEBUG("finalize_update() SUCCESS\n");
         LOG_BLE("OTA: Update complete (%lu KB)\n", (unsigned long)received_size / 1024);
         LOG_BLE("OTA: Starting restart sequence...\n");
         
+        // Write back cached statistics and preferences before the restart drops them
+        for (uint8_t ch = 0; ch < HW_GRINDER_CHANNELS; ch++) {
+            channel_statistics(ch).flush();
+        }
+        preference_cache.flush();
+
         // Restart device
         LOG_OTA_DEBUG("Flushing Serial before restart...\n");
         Serial.flush();
@@ -258,14 +555,19 @@ bool OTAHandler::complete_ota() {
     }
     
     ota_in_progress = false;
+    power_manager.set_hold(PowerHold::OTA, false);
     LOG_OTA_DEBUG("complete_ota() returning %s\n", success ? "SUCCESS" : "FAILED");
     return success;
 }
 
-void OTAHandler::abort_ota() {
+void OTAHandler::abort_ota(bool keep_resume) {
     if (ota_in_progress) {
-        LOG_BLE("OTA: Aborting update\n");
+        LOG_BLE("OTA: Aborting update%s\n", keep_resume && mirror_active ? " (resumable from the patch partition)" : "");
         ota_in_progress = false;
+        parked_since_ms = 0;
+        power_manager.set_hold(PowerHold::OTA, false);
+        release_stream();
+        close_mirror(keep_resume);
         received_size = 0;
         patch_size = 0;
         current_status = BLE_OTA_ERROR;
@@ -282,69 +584,57 @@ float OTAHandler::get_progress() const {
 }
 
 bool OTAHandler::start_update() {
-    // Initialize patch partition for writing
-    if (delta_partition_init(&patch_writer, "patch", patch_size) != ESP_OK) {
-        LOG_BLE("OTA: Failed to initialize patch partition\n");
+    // The patch is applied to the next OTA partition as it arrives; nothing is staged
+    int result = delta_stream_begin(&patch_stream, patch_size, is_full_update ? 1 : 0);
+    if (result != 0) {
+        LOG_BLE("OTA: Failed to start streaming apply: %s\n", delta_error_as_string(result));
+        patch_stream = nullptr;
         return false;
     }
     return true;
 }
 
+// Waits out a writer in the middle of a batch; then nothing touches the stream but the caller
+void OTAHandler::release_stream() {
+    while (writer_busy.load(std::memory_order_acquire)) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    if (patch_stream) {
+        delta_stream_abort(patch_stream);
+        patch_stream = nullptr;
+    }
+}
+
 bool OTAHandler::finalize_update() {
     LOG_OTA_DEBUG("finalize_update() called\n");
     
     // Verify received size matches expected
-    LOG_OTA_DEBUG("Verifying received size: expected=%lu, got=%lu\n", 
-                  (unsigned long)patch_size, (unsigned long)received_size);
-    if (received_size != patch_size) {
-        LOG_BLE("OTA: Size mismatch - expected %lu, got %lu\n", 
-                     (unsigned long)patch_size, (unsigned long)received_size);
+    LOG_OTA_DEBUG("Verifying received size: expected=%lu, got=%lu, applied=%lu\n", 
+                  (unsigned long)patch_size, (unsigned long)received_size, (unsigned long)flushed_size);
+    if (received_size != patch_size || flushed_size != patch_size || write_failed || !patch_stream) {
+        LOG_BLE("OTA: Size mismatch - expected %lu, got %lu (%lu applied)\n", 
+                     (unsigned long)patch_size, (unsigned long)received_size, (unsigned long)flushed_size);
         LOG_OTA_DEBUG("Size verification FAILED\n");
+        release_stream();
         return false;
     }
     LOG_OTA_DEBUG("Size verification SUCCESS\n");
-    
-    // A/B Partition Update Logic
-    LOG_OTA_DEBUG("Getting running partition...\n");
-    const esp_partition_t* running_partition = esp_ota_get_running_partition();
-    if (!running_partition) {
-        LOG_BLE("❌ Could not get running partition!\n");
-        LOG_OTA_DEBUG("esp_ota_get_running_partition() FAILED\n");
-        return false;
-    }
-    LOG_OTA_DEBUG("Running partition: %s (addr=0x%lx, size=%lu)\n", 
-                  running_partition->label, (unsigned long)running_partition->address, 
-                  (unsigned long)running_partition->size);
 
-    LOG_OTA_DEBUG("Getting next update partition...\n");
+    const esp_partition_t* running_partition = esp_ota_get_running_partition();
     const esp_partition_t* update_partition = esp_ota_get_next_update_partition(NULL);
-    if (!update_partition) {
-        LOG_BLE("❌ Could not find a valid OTA update partition!\n");
-        LOG_OTA_DEBUG("esp_ota_get_next_update_partition() FAILED\n");
-        return false;
+    if (running_partition && update_partition) {
+        LOG_BLE("OTA Info: Running from '%s', updating to '%s'\n", 
+                      running_partition->label, update_partition->label);
     }
-    LOG_OTA_DEBUG("Update partition: %s (addr=0x%lx, size=%lu)\n", 
-                  update_partition->label, (unsigned long)update_partition->address, 
-                  (unsigned long)update_partition->size);
-    
-    LOG_BLE("OTA Info: Running from '%s', updating to '%s'\n", 
-                  running_partition->label, update_partition->label);
-
-    // Set up delta options for the A/B update
-    LOG_OTA_DEBUG("Setting up delta options...\n");
-    delta_opts_t opts;
-    opts.src = running_partition->label;
-    opts.dest = update_partition->label;
-    opts.patch = "patch";
-    opts.is_full_update = this->is_full_update ? 1 : 0;
-    LOG_OTA_DEBUG("Delta opts: src=%s, dest=%s, patch=%s, is_full=%d\n", 
-                  opts.src, opts.dest, opts.patch, opts.is_full_update);
-    
-    // Apply the delta patch
-    LOG_OTA_DEBUG("Calling delta_check_and_apply() with size=%lu...\n", (unsigned long)patch_size);
+
+    // The image is already written; finish the patch, validate the image and switch the boot partition
+    LOG_OTA_DEBUG("Calling delta_stream_finish() after %lu bytes...\n", (unsigned long)patch_size);
     Serial.flush();
-    int result = delta_check_and_apply(patch_size, &opts);
-    LOG_OTA_DEBUG("delta_check_and_apply() returned: %d\n", result);
+    delta_stream_stats_t stats = {};
+    int result = delta_stream_finish(patch_stream, &stats);
+    patch_stream = nullptr;
+    LOG_OTA_DEBUG("delta_stream_finish() returned: %d\n", result);
+    log_apply_stats(stats);
     if (result < 0) {
         LOG_BLE("Delta patch failed: %s\n", delta_error_as_string(result));
         LOG_OTA_DEBUG("Delta patch FAILED with error: %s\n", delta_error_as_string(result));
@@ -355,6 +645,19 @@ bool OTAHandler::finalize_update() {
     return true;
 }
 
+// Throughput per phase of the apply; the flash phases are bounded by the part, decoding by the CPU
+void OTAHandler::log_apply_stats(const delta_stream_stats_t& stats) {
+    auto kb_per_s = [](uint32_t bytes, uint32_t us) -> unsigned long {
+        return us > 0 ? (unsigned long)((uint64_t)bytes * 1000000ULL / us / 1024) : 0;
+    };
+    LOG_BLE("OTA: Applied %lu KB patch into %lu KB image: decode %lums (%lu KB/s), erase %lums, "
+            "write %lums (%lu KB/s), verify %lums\n",
+            (unsigned long)stats.patch_bytes / 1024, (unsigned long)stats.image_bytes / 1024,
+            (unsigned long)stats.apply_us / 1000, kb_per_s(stats.patch_bytes, stats.apply_us),
+            (unsigned long)stats.erase_us / 1000, (unsigned long)stats.write_us / 1000,
+            kb_per_s(stats.image_bytes, stats.write_us), (unsigned long)stats.verify_us / 1000);
+}
+
 String OTAHandler::check_ota_failure_after_boot() {
     if (!preferences) {
         return "";
@@ -2,6 +2,9 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <esp_ota_ops.h>
 #include <esp_system.h>
 #include <esp_task_wdt.h>
@@ -23,7 +26,8 @@ enum BLEOTACommand {
     BLE_OTA_CMD_START = 0x01,
     BLE_OTA_CMD_DATA = 0x02,
     BLE_OTA_CMD_END = 0x03,
-    BLE_OTA_CMD_ABORT = 0x04
+    BLE_OTA_CMD_ABORT = 0x04,
+    BLE_OTA_CMD_RESUME = 0x05       // START payload; continues a matching update where it stopped
 };
 
 enum BLEOTAStatus {
@@ -46,12 +50,30 @@ enum BLEPowerState {
  * 
  * Handles delta patching, power management, and firmware validation
  * for BLE-based firmware updates.
+ *
+ * Receiving and flashing are pipelined: process_data_chunk() only copies the
+ * chunk into a PSRAM ring (BLE callback), and the OTA writer task drains the
+ * ring 4 KB at a time into delta_stream_write(), which applies the detools
+ * patch straight to the next OTA partition. Full updates are heatshrink
+ * patches against an empty source, so both kinds stream the same way. The ring has one
+ * producer and one consumer, so head and tail are plain atomics. The host is
+ * kept within the ring by window acks built from get_flushed_size().
+ *
+ * Updates started with a patch id (CRC-32 of the patch) can be resumed. A
+ * disconnect parks the update instead of aborting it: the ring drains, the
+ * stream stays open for BLE_OTA_RESUME_TIMEOUT_MS, and a RESUME with the same
+ * id continues at the flushed offset. The received patch is also mirrored to
+ * the patch partition, with its length checkpointed in NVS every
+ * BLE_OTA_CHECKPOINT_BYTES. After a reboot or an expired park, a matching
+ * RESUME replays the mirror into a new stream at flash speed (the detools
+ * state is not persistent) and continues from there.
  */
 class OTAHandler {
 private:
-    bool ota_in_progress;
+    std::atomic<bool> ota_in_progress;
     uint32_t patch_size;
-    uint32_t received_size;
+    std::atomic<uint32_t> received_size;    // Queued into the ring (BLE callback)
+    std::atomic<uint32_t> flushed_size;     // Written to the patch partition (writer task)
     BLEOTAStatus current_status;
     String current_firmware_build_number;
     bool is_full_update;
@@ -63,13 +85,50 @@ private:
     BLEPowerState power_state;
     uint32_t normal_cpu_freq_mhz;
     
-    // Delta OTA components
-    delta_partition_writer_t patch_writer;
-    
+    // Delta OTA components (patch applied to the next OTA partition as it arrives)
+    delta_stream_t* patch_stream;
+
+    // Resume: patch id, the parked state after a disconnect, and the patch partition mirror
+    struct ResumeRecord {                   // NVS "ota_resume"
+        uint32_t patch_size;
+        uint32_t patch_crc;
+        uint32_t stored;                    // Patch bytes in the mirror
+        uint8_t full_update;
+        uint8_t reserved[3];
+    };
+    uint32_t patch_crc;                     // 0 = not resumable
+    uint32_t parked_since_ms;               // 0 = not parked
+    delta_partition_writer_t patch_mirror;
+    bool mirror_active;
+    uint32_t mirror_checkpoint;             // Mirror length in the NVS record
+    uint32_t replay_end;                    // Writer task: mirror bytes still to feed the new stream
+
+    // Receive ring (PSRAM) and the writer task that flushes it; both kept after the first OTA
+    uint8_t* ring;
+    uint8_t* flash_batch;                   // Internal RAM staging for one partition write
+    std::atomic<uint32_t> ring_head;        // Free-running byte counts, BLE_OTA_RING_BYTES is a power of two
+    std::atomic<uint32_t> ring_tail;
+    std::atomic<bool> flush_all;            // END received: flush a partial final batch
+    std::atomic<bool> write_failed;
+    std::atomic<bool> writer_busy;
+    TaskHandle_t writer_task;
+    
+    bool allocate_pipeline();
+    void flush_ring();
+    static void writer_task_wrapper(void* parameter);
     void reduce_power_for_ble();
     void restore_normal_power();
+    bool begin_ota(uint32_t size, const String& expected_build_number, bool is_full_update,
+                   const String& expected_firmware_version, uint32_t patch_crc, uint32_t replay_bytes);
     bool start_update();
+    void open_mirror(uint32_t replay_bytes);
+    void close_mirror(bool keep_record);
+    void mirror_batch(const uint8_t* data, uint32_t size);
+    bool replay_mirror();
+    void save_resume_record(uint32_t stored);
     bool finalize_update();
+    void log_apply_stats(const delta_stream_stats_t& stats);
+    void release_stream();
     
 public:
     OTAHandler();
@@ -88,15 +147,45 @@ public:
      * @param is_full_update True for full update, false for delta update
      * @return true if successfully started
      */
-    bool start_ota(uint32_t size, const String& expected_build_number = "", bool is_full_update = false, const String& expected_firmware_version = "");
+    bool start_ota(uint32_t size, const String& expected_build_number = "", bool is_full_update = false,
+                   const String& expected_firmware_version = "", uint32_t patch_crc = 0);
+
+    /**
+     * Continue the update with this patch id: the parked one, or one mirrored before a reboot
+     * @return false if there is nothing to continue (start_ota() instead); true once resumed,
+     * the host continues at get_flushed_size() after is_write_drained()
+     */
+    bool resume_ota(uint32_t size, uint32_t patch_crc, bool is_full_update,
+                    const String& expected_build_number = "", const String& expected_firmware_version = "");
+
+    /**
+     * Link lost: drain what was received and keep the stream for a RESUME
+     */
+    void park_ota();
+    bool is_parked() const { return parked_since_ms != 0; }
+    bool has_park_expired() const;
     
     /**
-     * Process received OTA data chunk
+     * Queue received OTA data chunk for the writer task
      * @param data Pointer to chunk data
      * @param size Size of chunk
-     * @return true if chunk processed successfully
+     * @return false if the chunk overruns the ring or the patch size, or a flash write failed
      */
     bool process_data_chunk(const uint8_t* data, size_t size);
+
+    /**
+     * Flush whatever is still queued, including a final partial sector (END command)
+     */
+    void finish_writes();
+
+    /**
+     * True once every queued byte is in the patch partition, or a flash write failed
+     */
+    bool is_write_drained() const;
+
+    bool has_write_failed() const { return write_failed.load(std::memory_order_relaxed); }
+    uint32_t get_received_size() const { return received_size.load(std::memory_order_relaxed); }
+    uint32_t get_flushed_size() const { return flushed_size.load(std::memory_order_acquire); }
     
     /**
      * Finalize OTA update and restart device
@@ -106,8 +195,9 @@ public:
     
     /**
      * Abort OTA update
+     * @param keep_resume Leave the patch mirror for a later RESUME (park expired)
      */
-    void abort_ota();
+    void abort_ota(bool keep_resume = false);
     
     /**
      * Get current OTA status
@@ -122,7 +212,7 @@ public:
     /**
      * Check if OTA is in progress
      */
-    bool is_ota_active() const { return ota_in_progress; }
+    bool is_ota_active() const { return ota_in_progress.load(std::memory_order_relaxed); }
     
     /**
      * Get current firmware build number
@@ -19,6 +19,14 @@
 // Device Settings
 #define BLE_DEVICE_NAME "GrindByWeight"                                       // Bluetooth device name (GATT + advertising)
 #define BLE_OTA_DEVICE_NAME BLE_DEVICE_NAME                                    // Bluetooth device name when in OTA mode
+#define BLE_MAX_CONNECTIONS 2                                                  // Concurrent centrals (dashboard + maintenance); CONFIG_BT_NIMBLE_MAX_CONNECTIONS matches
+
+// Pipelined OTA: writes land in a PSRAM ring, the OTA writer task flushes it to the patch partition
+#define BLE_OTA_RING_BYTES (64 * 1024)                                        // Receive ring in PSRAM (power of two)
+#define BLE_OTA_FLASH_BATCH_BYTES 4096                                         // One flash sector per patch partition write
+#define BLE_OTA_ACK_WINDOW_BYTES (16 * 1024)                                   // Flushed bytes between window acks
+#define BLE_OTA_RESUME_TIMEOUT_MS 120000                                       // A parked update (link lost) waits this long for RESUME
+#define BLE_OTA_CHECKPOINT_BYTES (64 * 1024)                                   // Mirrored patch bytes between NVS resume checkpoints
 
 //------------------------------------------------------------------------------
 // BLE DATA EXPORT SERVICE
@@ -27,7 +35,19 @@
 #define BLE_DATA_CONTROL_CHAR_UUID "33445566-7788-99aa-bbcc-ddeeffaabbcc"     // Control characteristic (start/stop data export)
 #define BLE_DATA_TRANSFER_CHAR_UUID "44556677-8899-aabb-ccdd-eeffaabbccdd"    // Data transfer characteristic
 #define BLE_DATA_STATUS_CHAR_UUID "55667788-99aa-bbcc-ddee-ffaabbccddee"      // Status notifications characteristic
-#define BLE_DATA_CHUNK_SIZE_BYTES 512                                          // Per-chunk payload size for data export
+#define BLE_DATA_TELEMETRY_CHAR_UUID "66778899-aabb-ccdd-eeff-aabbccddeeff"   // Live weight telemetry notifications
+#define BLE_DATA_CHUNK_SIZE_BYTES 512                                          // Per-chunk payload cap for data export (also capped at MTU - 3)
+#define BLE_DATA_LEGACY_CHUNK_INTERVAL_MS 25                                   // Paced export for hosts that grant no credits
+#define BLE_DATA_BULK_MAX_CREDITS 256                                          // Cap on outstanding chunk credits in a bulk transfer
+#define BLE_DATA_BULK_MAX_BURST 32                                             // Notifies per BluetoothManager::handle() pass in a bulk transfer
+#define BLE_DATA_PROGRESS_INTERVAL_MS 250                                      // Export progress notify period (not per chunk)
+#define BLE_DATA_COMPRESS_WINDOW_BITS 8                                        // Compressed export: heatshrink window 2^8 (the OTA patcher's decoder config)
+#define BLE_DATA_COMPRESS_LOOKAHEAD_BITS 7                                     // Compressed export: heatshrink lookahead 2^7
+#define BLE_DATA_COMPRESS_INPUT_BYTES 512                                      // Compressed export: raw bytes staged ahead of the window
+#define BLE_ATT_NOTIFY_HEADER_BYTES 3                                          // ATT opcode + handle in each notification
+#define BLE_NIMBLE_NOTIFY_RESERVE_MBUFS 4                                      // NimBLE: msys blocks left free by bursts (status notifies, ATT responses)
+#define BLE_TELEMETRY_MAX_LATENCY_MS 100                                       // Oldest frame age before a partial telemetry batch is sent
+#define BLE_TELEMETRY_MAX_BURST 4                                              // Telemetry notifies per BluetoothManager::handle() pass
 
 //------------------------------------------------------------------------------
 // BLE DEBUG SERVICE (Nordic UART Service)
@@ -35,6 +55,9 @@
 #define BLE_DEBUG_SERVICE_UUID "6E400001-B5A3-F393-E0A9-E50E24DCCA9E"         // Nordic UART Service UUID
 #define BLE_DEBUG_RX_CHAR_UUID "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"         // ESP32 RX (Client -> Device)
 #define BLE_DEBUG_TX_CHAR_UUID "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"         // ESP32 TX (Device -> Client)
+#define BLE_DEBUG_LOG_BUFFER_BYTES 2048                                        // Debug stream text awaiting the BLE task (internal RAM)
+#define BLE_DEBUG_LOG_FLUSH_MS 50                                              // Oldest line age before a partial debug notification is sent
+#define BLE_DEBUG_LOG_MAX_BURST 4                                              // Debug stream notifies per BluetoothManager::handle() pass
 
 //------------------------------------------------------------------------------
 // BLE SYSTEM INFO SERVICE
@@ -47,6 +70,10 @@
 #define BLE_SYSINFO_DIAGNOSTICS_CHAR_UUID "22334455-ff00-1111-2222-334455667788"  // Comprehensive diagnostic report trigger
 
 #define BLE_SYSINFO_MAX_PAYLOAD_BYTES 512                                       // Maximum payload size for system info
+#define BLE_SYSINFO_BINARY_VERSION 1                                            // First byte of binary payloads (text ones start with '{')
+#define BLE_SYSINFO_REFRESH_INTERVAL_MS 10000                                   // Notify period while connected, until a host asks otherwise
+#define BLE_SYSINFO_MIN_REFRESH_INTERVAL_MS 200                                 // Fastest period a host may request (5 Hz dashboards)
+#define BLE_DIAGNOSTIC_MAX_BURST 4                                              // Report slices per BluetoothManager::handle() pass
 
 //------------------------------------------------------------------------------
 // BLE TIMEOUT SETTINGS
@@ -58,13 +85,14 @@
 //------------------------------------------------------------------------------
 // BLE INITIALIZATION TIMING
 //------------------------------------------------------------------------------
-// Delays for stable BLE stack initialization
+// Delays for stable BLE stack initialization (Bluedroid only; NimBLE builds skip them)
 #define BLE_INIT_STACK_DELAY_MS 100                                            // Delay after BLE stack initialization
 #define BLE_INIT_SERVER_DELAY_MS 50                                            // Delay after server creation
 #define BLE_INIT_SERVICE_DELAY_MS 25                                           // Delay after service creation
 #define BLE_INIT_CHARACTERISTIC_DELAY_MS 25                                    // Delay after each characteristic setup
 #define BLE_INIT_START_DELAY_MS 50                                             // Delay after service start
 #define BLE_INIT_ADVERTISING_DELAY_MS 25                                       // Delay after advertising setup
+#define BLE_RECONNECT_ADVERTISING_DELAY_MS 500                                 // Delay before advertising again after a disconnect
 
 //------------------------------------------------------------------------------
 // BLE SHUTDOWN TIMING
@@ -75,5 +103,23 @@
 //------------------------------------------------------------------------------
 // BLE POWER MANAGEMENT
 //------------------------------------------------------------------------------
+// The CPU stays at full speed (Core 0 runs sampling and grind control); BLE power is
+// saved on the link instead, see the connection parameters below
 #define BLE_NORMAL_CPU_FREQ_MHZ 240                                            // Normal CPU frequency during BLE operations
-#define BLE_REDUCED_CPU_FREQ_MHZ 240                                           // Reduced CPU frequency for BLE mode
\ No newline at end of file
+#define BLE_REDUCED_CPU_FREQ_MHZ 240                                           // Reduced CPU frequency for BLE mode
+
+//------------------------------------------------------------------------------
+// BLE LINK PARAMETERS (transfer session vs idle)
+//------------------------------------------------------------------------------
+// Connection intervals in 1.25 ms units, supervision timeouts in 10 ms units.
+// The central has the final say; these are requests.
+#define BLE_TRANSFER_CONN_INTERVAL_MIN 6                                       // 7.5 ms while an export or OTA runs
+#define BLE_TRANSFER_CONN_INTERVAL_MAX 12                                      // 15 ms
+#define BLE_TRANSFER_CONN_LATENCY 0
+#define BLE_TRANSFER_SUPERVISION_TIMEOUT 400                                   // 4 s
+#define BLE_IDLE_CONN_INTERVAL_MIN 24                                          // 30 ms when connected but idle
+#define BLE_IDLE_CONN_INTERVAL_MAX 40                                          // 50 ms
+#define BLE_IDLE_CONN_LATENCY 4                                                // Peripheral may skip 4 events with nothing to send
+#define BLE_IDLE_SUPERVISION_TIMEOUT 500                                       // 5 s
+#define BLE_TRANSFER_DATA_LENGTH_BYTES 251                                     // Link-layer PDU payload (Data Length Extension)
+#define BLE_TRANSFER_SESSION_HOLD_MS 2000                                      // Keep the fast link between consecutive files of an export
\ No newline at end of file
@@ -11,6 +11,8 @@
 // INCLUDE ALL ORGANIZED CONFIG FILES
 //==============================================================================
 #include "bluetooth.h"
+#include "network.h"
+#include "features.h"
 #include "hardware.h"
 #include "theme.h"
 #include "debug.h"
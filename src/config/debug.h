@@ -14,11 +14,27 @@
     #define DEBUG_ENABLE_LOADCELL_MOCK 0                                              // Default: use physical HX711, override with build flag
 #endif
 
+// Session replay (mock builds only): the load cell plays back recorded sessions instead of the flow simulation
+#ifndef DEBUG_ENABLE_LOADCELL_REPLAY
+    #define DEBUG_ENABLE_LOADCELL_REPLAY 0                                            // Default: synthetic flow, override with build flag
+#endif
+
+// Hardware-in-the-loop (any build): the load cell plays recorded raw ADC tracks on the real firmware
+#ifndef DEBUG_ENABLE_LOADCELL_HIL
+    #define DEBUG_ENABLE_LOADCELL_HIL 0                                               // Default: physical ADC, override with build flag
+#endif
+
 // UI visual feedback
 #ifndef DEBUG_ENABLE_GRINDER_BACKGROUND_INDICATOR
     #define DEBUG_ENABLE_GRINDER_BACKGROUND_INDICATOR 0                             // Default: disabled, override with build flag
 #endif
 
+// Display render statistics: fps and invalidated vs flushed pixels per frame on the top layer
+#ifndef DEBUG_ENABLE_RENDER_STATS_OVERLAY
+    #define DEBUG_ENABLE_RENDER_STATS_OVERLAY 0                                     // Default: disabled, override with build flag
+#endif
+#define DEBUG_RENDER_STATS_WINDOW_MS 1000                                             // Averaging window of the render stats overlay
+
 // Core debug logging settings
 #define DEBUG_SERIAL_OUTPUT 1                                             // Enable serial debug output
 #define DEBUG_GRIND_CONTROLLER 0                                          // Enable detailed grind debugging
@@ -34,13 +50,51 @@
 //------------------------------------------------------------------------------
 // MOCK HARDWARE DETAILED CONFIGURATION
 //------------------------------------------------------------------------------
-#define DEBUG_MOCK_FLOW_RATE_GPS 1.9f                                             // Simulated continuous flow rate in grams per second
+#ifndef DEBUG_MOCK_FLOW_RATE_GPS
+    #define DEBUG_MOCK_FLOW_RATE_GPS 1.9f                                             // Simulated continuous flow rate in grams per second
+#endif
 #define DEBUG_MOCK_CAL_FACTOR -7050.0f                                            // Fixed calibration factor used during mocking
 #define DEBUG_MOCK_BASELINE_RAW 0x700000                                          // Baseline raw count around mid-scale for tare offset
 #define DEBUG_MOCK_IDLE_NOISE_RAW 60.0f                                           // Peak raw noise when idle (counts)
 #define DEBUG_MOCK_GRIND_NOISE_RAW 400.0f                                         // Peak raw noise when grinding (counts)
 #define DEBUG_MOCK_FLOW_RAMP_MS 350                                               // Ramp duration for simulated flow transitions
-#define DEBUG_MOCK_START_DELAY_MS 500                                             // Delay from motor start command to weight increase (continuous grind)
-#define DEBUG_MOCK_STOP_DELAY_MS 400                                              // Delay from motor stop command to weight stop
+#ifndef DEBUG_MOCK_START_DELAY_MS
+    #define DEBUG_MOCK_START_DELAY_MS 500                                             // Delay from motor start command to weight increase (continuous grind)
+#endif
+#ifndef DEBUG_MOCK_STOP_DELAY_MS
+    #define DEBUG_MOCK_STOP_DELAY_MS 400                                              // Delay from motor stop command to weight stop
+#endif
 #define DEBUG_MOCK_MOTOR_LATENCY_MS 42.0f                                         // Hidden minimum pulse duration to produce grounds (for auto-tune testing)
 
+// Grinder physics beyond the ramps (MockGrinderModel); 0 disables each, grinder.py fit-model estimates them
+#ifndef DEBUG_MOCK_COAST_MS
+    #define DEBUG_MOCK_COAST_MS 0                                                     // Full flow kept after a stop (grounds already in the burrs)
+#endif
+#ifndef DEBUG_MOCK_COAST_TAU_MS
+    #define DEBUG_MOCK_COAST_TAU_MS 0                                                 // Exponential coast tail after the hold; 0: linear ramp over DEBUG_MOCK_FLOW_RAMP_MS
+#endif
+#define DEBUG_MOCK_PULSE_NOISE_GAIN 3.0f                                          // Vibration noise multiplier while a pulse spins the motor up
+#define DEBUG_MOCK_VIBRATION_HZ 0.0f                                              // Motor vibration tone seen by the load cell (aliased by the sample rate)
+#define DEBUG_MOCK_VIBRATION_TONE_RAW 0.0f                                        // Tone amplitude at full load (counts)
+#ifndef DEBUG_MOCK_CLUMP_RATE_HZ
+    #define DEBUG_MOCK_CLUMP_RATE_HZ 0.0f                                             // Clumps per second of flow
+#endif
+#define DEBUG_MOCK_CLUMP_MASS_G 0.05f                                             // Mass of one clump
+#define DEBUG_MOCK_CLUMP_MS 60                                                    // A clump or retention release lands over this long
+#ifndef DEBUG_MOCK_RETENTION_FRACTION
+    #define DEBUG_MOCK_RETENTION_FRACTION 0.0f                                        // Share of the flow held back in the chute
+#endif
+#define DEBUG_MOCK_RETENTION_CAPACITY_G 0.3f                                      // Most the chute holds
+#define DEBUG_MOCK_RETENTION_RELEASE_HZ 0.5f                                      // Chance per second of motor vibration that the held grounds fall (also at each spin-up)
+
+// Session replay (DEBUG_ENABLE_LOADCELL_REPLAY)
+#define DEBUG_REPLAY_DIR "/replay"                                                // Session files to replay (session_*.bin); falls back to GRIND_SESSIONS_DIR
+#define DEBUG_REPLAY_SESSION_GAP_MS 3000                                          // Motor idle time after which the next start begins a new replayed session
+#define DEBUG_REPLAY_MOTOR_LATENCY_MS 50.0f                                       // Pulse ms that deliver nothing, used to rescale recorded pulses to new durations
+#define DEBUG_REPLAY_MAX_PULSES 16                                                // Recorded pulses indexed per session
+
+// ADC stream playback (DEBUG_ENABLE_LOADCELL_HIL)
+#define DEBUG_HIL_DIR "/hil"                                                      // Session files with an ADC capture track (session_*.bin); else the stored sessions
+#define DEBUG_HIL_MAX_SAMPLES 131072                                              // Samples of all tracks together, loaded to PSRAM at boot (1 MB)
+#define DEBUG_HIL_MAX_TRACKS 32                                                   // Session files loaded
+
@@ -0,0 +1,36 @@
+#pragma once
+
+//==============================================================================
+// FEATURE MODULES
+//==============================================================================
+// Optional parts of the firmware that a station can do without. Each module is
+// a build flag: its sources compile to nothing and its menu entries and BLE
+// commands are left out when it is 0. Image size sets the BLE OTA time, full
+// and delta alike, so the -station environment in platformio.ini builds with
+// only what a grinder on the counter uses. Networking is its own module in
+// network.h (NETWORK_MQTT_ENABLED, NETWORK_WEB_ENABLED).
+// tools/build-scripts/post_build.py reports the flash each module takes.
+
+//------------------------------------------------------------------------------
+// BUILD SWITCHES
+//------------------------------------------------------------------------------
+// Benchmarks (UI, hot path, storage) on the Diagnostics page and over BLE, and the grind log dumps
+#ifndef FEATURE_DEBUG_TOOLS
+    #define FEATURE_DEBUG_TOOLS 1                                              // Default: built in, override with build flag
+#endif
+// Pulse autotune screen ("Tune Pulses" in the menu)
+#ifndef FEATURE_AUTOTUNE_UI
+    #define FEATURE_AUTOTUNE_UI 1                                              // Default: built in, override with build flag
+#endif
+// Weight and flow chart layout of the grinding screen; the arc layout is always built
+#ifndef FEATURE_GRIND_CHART
+    #define FEATURE_GRIND_CHART 1                                              // Default: built in, override with build flag
+#endif
+
+// Struct dumps and session tables of GrindLogger on the debug stream (large; off unless asked for)
+#ifndef ENABLE_GRIND_DEBUG
+    #define ENABLE_GRIND_DEBUG 0
+#endif
+#if ENABLE_GRIND_DEBUG && !FEATURE_DEBUG_TOOLS
+    #error "ENABLE_GRIND_DEBUG needs FEATURE_DEBUG_TOOLS"
+#endif
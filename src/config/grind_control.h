@@ -19,24 +19,116 @@
 #define GRIND_FLOW_DETECTION_THRESHOLD_GPS 0.5f                           // Minimum coffee flow rate to establish first grinds reachinig the cup = latency
 
 // Undershoot strategy - determine when to stop grinding during the predictive phase
-#define GRIND_UNDERSHOOT_TARGET_G 1.0f                                    // Default conservative undershoot target
-#define GRIND_LATENCY_TO_COAST_RATIO 1.0f                                 // Ratio of expected coast time to measured latency (e.g., 0.8 = 80%)
+#ifndef GRIND_UNDERSHOOT_TARGET_G
+    #define GRIND_UNDERSHOOT_TARGET_G 1.0f                                    // Default conservative undershoot target
+#endif
+#ifndef GRIND_LATENCY_TO_COAST_RATIO
+    #define GRIND_LATENCY_TO_COAST_RATIO 1.0f                                 // Ratio of expected coast time to measured latency (e.g., 0.8 = 80%)
+#endif
+#define GRIND_SUBTICK_STOP_ENABLED 1                                      // Extrapolate the stop crossing inside the control tick and cut with a one-shot timer
+
+// Soft stop (HW_MOTOR_SPEED_CONTROL_ENABLED only) - ramp the motor down ahead of the stop weight
+#define GRIND_SOFT_STOP_RAMP_G 2.0f                                       // Grams before the stop weight where the ramp-down starts
+#define GRIND_SOFT_STOP_MIN_DUTY 0.4f                                     // Duty reached at the stop weight (>= HW_MOTOR_MIN_DUTY)
+
+// Model-predictive stop (PredictiveModelGrindStrategy) - projects the flow trajectory plus learned coast
+#define GRIND_PREDICTIVE_MODEL_ENABLED 1                                  // Weight mode stops at the predicted crossing instead of the fixed-ratio threshold
+#define GRIND_PREDICTIVE_MODEL_FLOW_SLOPE_SMOOTHING 0.2f                  // Per-tick weight of the flow slope (g/s^2) used for the trajectory
+
+// Learned coast per profile (CoastModel, RLS on coast vs flow at the stop, persisted in NVS)
+#define GRIND_COAST_MODEL_MIN_SESSIONS 3                                  // Sessions before the fit replaces the latency-ratio coast
+#define GRIND_COAST_MODEL_FORGETTING 0.9f                                 // RLS forgetting factor (~10 sessions of memory)
+#define GRIND_COAST_MODEL_MAX_COAST_G 3.0f                                // Coast observations beyond +/- this are discarded (cup bumped)
+#define GRIND_COAST_MODEL_OUTLIER_SIGMAS 4.0f                             // A trusted fit drops observations this many innovation sigmas off
+#define GRIND_COAST_MODEL_OUTLIER_RUN 3                                   // Consecutive outliers taken as a real change (folded in)
+
+// Passive motor latency identification (MotorLatencyEstimator) - dead time of everyday correction pulses
+#define GRIND_LATENCY_LEARN_ENABLED 1                                     // Keep motor_response_latency_ms current without an autotune session
+#define GRIND_LATENCY_LEARN_MIN_DELIVERED_G 0.03f                         // Pulses landing less only bound the latency from below; skipped
+#define GRIND_LATENCY_LEARN_MIN_SESSIONS 3                                // Accepted sessions (since boot or an autotune) before the stored latency follows
+#define GRIND_LATENCY_LEARN_GAIN 0.2f                                     // Weight of an accepted session median
+#define GRIND_LATENCY_LEARN_GATE_SIGMAS 3.0f                              // Session medians beyond this many running deviations are outliers
+#define GRIND_LATENCY_LEARN_MIN_GATE_MS 10.0f                             // Outlier gate floor
+#define GRIND_LATENCY_LEARN_INITIAL_DEVIATION_MS 15.0f                    // Running deviation before any session
+#define GRIND_LATENCY_LEARN_OUTLIER_RUN 3                                 // Consecutive outliers taken as a real change (restart from them)
+#define GRIND_LATENCY_LEARN_MIN_CHANGE_MS 2.0f                            // Smaller moves are not written to the settings
+
+// Learned pulse response per profile (PulseResponseTable, pulse ms -> delivered grams, persisted in NVS)
+#define GRIND_PULSE_TABLE_ENABLED 1                                       // Size pulses from the learned curve when it covers the error
+#define GRIND_PULSE_TABLE_KNOT_COUNT 12                                   // Knots at 0, 50, ... 550ms (covers max latency + max pulse)
+#define GRIND_PULSE_TABLE_KNOT_SPACING_MS 50                              // Pulse ms between knots
+#define GRIND_PULSE_TABLE_MIN_SESSIONS 2                                  // Sessions with pulses before the curve is used
+#define GRIND_PULSE_TABLE_MIN_KNOT_WEIGHT 1.0f                            // Decayed observations a knot needs to take part
+#define GRIND_PULSE_TABLE_FORGETTING 0.8f                                 // Per-session decay of knot weights
+#define GRIND_PULSE_TABLE_MAX_PULSE_G 2.0f                                // Larger single-pulse deltas are discarded (cup bumped)
+
+// Pipelined pulses - plan the next correction from a projected settle instead of a full precision settle
+#define GRIND_PULSE_PIPELINE_ENABLED 1                                    // Precision settling then only runs when the projection is near the target
+#define GRIND_PULSE_PIPELINE_MIN_SETTLE_MS 100                            // Time after motor latency before projecting
+#define GRIND_PULSE_PIPELINE_SETTLE_TAU_MS 80.0f                          // First-order settle time constant (landing = flow * tau)
+#define GRIND_PULSE_PIPELINE_MARGIN_G 0.05f                               // Added to the projection's upper bound
+
+// Micro-pulses - the last few hundred mg as a motor kick plus short bursts (Grinder::start_pulse_sequence)
+#define GRIND_MICRO_PULSE_ENABLED 0                                       // Off: bursts deliver other grams per on-ms than the pulse table learned
+#define GRIND_MICRO_PULSE_MAX_ERROR_G 0.3f                                // Corrections up to this use a sequence
+#define GRIND_MICRO_PULSE_BURST_MS 8.0f                                   // On-time per burst after the kick
+#define GRIND_MICRO_PULSE_GAP_MS 40.0f                                    // Relay off between bursts, burrs keep turning
 
 // Prime phase behavior
 #define GRIND_PRIME_TARGET_WEIGHT_G 1.0f                                   // Amount of coffee delivered during chute priming
 #define GRIND_PRIME_MAX_DURATION_MS 5000                                   // Safety timeout for chute priming run
 
+// Learned chute retention (RetentionModel, late fall vs idle time before the session, persisted in NVS)
+#define GRIND_RETENTION_MODEL_ENABLED 1                                   // Hold the expected late fall back from the stop target; replaces priming once trusted
+#define GRIND_RETENTION_IDLE_BUCKET_COUNT 5                               // Idle time classes: <1min, <5min, <30min, <2h, longer (or unknown since boot)
+#define GRIND_RETENTION_MIN_SESSIONS 3                                    // Observations an idle class needs before it is used
+#define GRIND_RETENTION_SMOOTHING 0.3f                                    // Weight of the newest observation in an idle class
+#define GRIND_RETENTION_OBSERVE_WINDOW_MS 5000                            // Time after completion over which late-falling grounds are counted
+#define GRIND_RETENTION_CUP_REMOVED_G 2.0f                                // Drop below the final weight that ends an observation early (discarded)
+#define GRIND_RETENTION_MAX_HOLDBACK_G 1.0f                               // Largest late fall held back from the stop target
+
+// Time-to-target prediction (GrindEtaPredictor) - countdown on the grinding screens, chart x axis, telemetry
+#define GRIND_ETA_TREND_SESSIONS 10                                       // Newest weight mode sessions the start-of-grind plan averages
+#define GRIND_ETA_MIN_TREND_SESSIONS 3                                    // Fewer sessions plan from the reference flow instead
+#define GRIND_ETA_REFERENCE_FLOW_GPS 1.6f                                 // Flow assumed before any session history
+#define GRIND_ETA_REFERENCE_OVERHEAD_MS 1000                              // Latency plus settling assumed before any session history
+#define GRIND_ETA_PULSE_SETTLE_FALLBACK_MS 600                            // Per-pulse time when the history has no pulse settle figure
+#define GRIND_ETA_PLAN_UNCERTAINTY 0.15f                                  // Relative band of a history-based plan (doubled for the reference plan)
+#define GRIND_ETA_TAIL_UNCERTAINTY 0.5f                                   // Relative band of the expected settle and pulse time after the stop
+#define GRIND_ETA_MIN_UNCERTAINTY 0.05f                                   // Band floor on the time left to the stop, relative
+#define GRIND_ETA_MAX_UNCERTAINTY 0.5f                                    // Band ceiling on the time left to the stop, relative
+#define GRIND_ETA_SMOOTHING 0.15f                                         // Per-tick weight of the newest finish time estimate
+
+// Predictive phase warm start - the profile's recent flow stands in until the live estimate converges
+#define GRIND_WARM_START_SESSIONS 5                                       // Newest weight mode sessions of the profile the seed averages
+#define GRIND_WARM_START_MIN_SESSIONS 2                                   // Fewer start from GRIND_UNDERSHOOT_TARGET_G as before
+
 //------------------------------------------------------------------------------
 // SCALE CALIBRATION AND SETTLING
 //------------------------------------------------------------------------------
 // Tare and settling behavior  
 #define GRIND_SCALE_SETTLING_TOLERANCE_G 0.010f                           // Maximum standard deviation for settled reading. Used to determine if scale is settled. Increase value if you have a noisy load cell.
 
+// High-rate sampling during active weight control (needs HW_LOADCELL_RATE_PIN wired)
+#define GRIND_HIGH_RATE_SAMPLING_ENABLED 1                                // Switch load cell to the ADC max rate from PREDICTIVE through FINAL_SETTLING
+
+// Per-sample Kalman weight/flow estimator (measurement noise comes from the tare-time std dev)
+#define GRIND_STATE_ESTIMATOR_FLOW_ACCEL_GPS2 3.0f                        // Expected flow change rate - process noise
+#define GRIND_STATE_ESTIMATOR_STEP_RESET_G 5.0f                           // Innovation that re-seeds the filter (cup placed/removed)
+#define GRIND_STATE_ESTIMATOR_GAP_RESET_MS 1000                           // Sample gap that re-seeds the filter
+#define GRIND_PREDICTIVE_USE_STATE_ESTIMATE 1                             // Predictive stop compares the latency-compensated estimate, not the 100ms mean
+
 //------------------------------------------------------------------------------
 // TIME MODE PULSE SETTINGS
 //------------------------------------------------------------------------------
 #define GRIND_TIME_PULSE_DURATION_MS 100                                        // Duration of additional pulses in time mode (milliseconds)
 
+// Time mode weight calibration - steer the profile time towards the profile's weight
+#define GRIND_TIME_CALIBRATION_ENABLED 1                                        // Adjust the profile time after each time grind
+#define GRIND_TIME_CALIBRATION_GAIN 0.5f                                        // Fraction of the missing time applied per session
+#define GRIND_TIME_CALIBRATION_MAX_STEP_S 1.0f                                  // Largest change per session
+#define GRIND_TIME_CALIBRATION_MIN_WEIGHT_G 1.0f                                // Paired weight and settled weight needed to calibrate
+
 
 
 //------------------------------------------------------------------------------
@@ -45,6 +137,14 @@
 #define GRIND_FLOW_RATE_MIN_SANE_GPS 1.0f                                         // Minimum reasonable flow rate
 #define GRIND_FLOW_RATE_MAX_SANE_GPS 3.0f                                         // Maximum reasonable flow rate
 #define GRIND_PULSE_FLOW_RATE_FALLBACK_GPS 1.5f                                   // Fallback pulse flow rate when measured rate is invalid or too low
+#define GRIND_FLOW_DETECTION_WINDOW_MS 500                                        // Flow window for confirming first grounds (latency measurement)
+#ifndef GRIND_FLOW_PREDICTION_WINDOW_MS
+    #define GRIND_FLOW_PREDICTION_WINDOW_MS 1500                                      // Flow window for the predictive coast estimate
+#endif
+#define GRIND_PULSE_FLOW_WINDOW_MS 2500                                           // Flow history the pulse sizing takes its 95th percentile over (the prediction window plus 1s)
+#define GRIND_FLOW_ESTIMATOR_ENDPOINT 0                                           // Newest minus oldest sample over the window
+#define GRIND_FLOW_ESTIMATOR_REGRESSION 1                                         // Least-squares slope over every sample in the window
+#define GRIND_FLOW_ESTIMATOR GRIND_FLOW_ESTIMATOR_ENDPOINT                         // Estimator behind the grind loop flow values
 
 //------------------------------------------------------------------------------
 // TIMING CONSTRAINTS (Hardware-dependent)
@@ -54,20 +154,117 @@
 #define GRIND_MOTOR_MAX_PULSE_DURATION_MS 250.0f                                  // Maximum pulse duration above latency (latency + GRIND_MOTOR_MAX_PULSE_DURATION_MS)
 
 // Motor timing
-#define GRIND_MOTOR_SETTLING_TIME_MS 200                                          // Motor vibration settling time
+#ifndef GRIND_MOTOR_SETTLING_TIME_MS
+    #define GRIND_MOTOR_SETTLING_TIME_MS 200                                          // Motor vibration settling time
+#endif
 
 // Mechanical instability detection
 #define GRIND_MECHANICAL_DROP_THRESHOLD_G 0.4f                                    // Weight drop considered mechanical instability
 #define GRIND_MECHANICAL_EVENT_COOLDOWN_MS 200                                    // Minimum time between detecting drops
 #define GRIND_MECHANICAL_EVENT_REQUIRED_COUNT 3                                   // Events required to flag diagnostic
 
+// Burr wear trend (ThroughputTrend) - completed weight grinds per profile, from the session summary table
+#define GRIND_WEAR_MIN_SESSIONS 30                                                // Sessions of a profile before its trend is judged
+#define GRIND_WEAR_BASELINE_SESSIONS 15                                           // Oldest sessions held (since the last reset) that set the baseline
+#define GRIND_WEAR_RECENT_SESSIONS 15                                             // Newest sessions averaged for the current flow and latency
+#define GRIND_WEAR_CUSUM_SLACK 0.5f                                               // CUSUM allowance per session, baseline std devs
+#define GRIND_WEAR_CUSUM_LIMIT 8.0f                                               // CUSUM sum that marks a change point, baseline std devs
+#define GRIND_WEAR_MIN_SIGMA_RATIO 0.03f                                          // Baseline std dev floor, fraction of the baseline mean
+#define GRIND_WEAR_FLOW_DROP_THRESHOLD 0.10f                                      // Flow this fraction below baseline, after a change point, raises the diagnostic
+#define GRIND_WEAR_PROJECTION_DOSES 100                                           // Doses ahead the time-per-dose increase is projected
+
+// Flow anomaly detection (PREDICTIVE) - end stalled or unstable grinds instead of waiting for GRIND_TIMEOUT_SEC
+#define GRIND_FLOW_ANOMALY_ENABLED 1                                              // Abort on a detected flow anomaly
+#define GRIND_FLOW_ANOMALY_NO_FLOW_MS 1500                                        // Motor on without confirmed flow (includes start latency)
+#define GRIND_FLOW_ANOMALY_COLLAPSE_RATIO 0.2f                                    // Smoothed flow below this fraction of its peak = collapsed
+#define GRIND_FLOW_ANOMALY_COLLAPSE_MS 600                                        // Collapse held this long = stalled (empty hopper, clog)
+#define GRIND_FLOW_ANOMALY_CV_LIMIT 0.5f                                          // Flow std dev / mean above this = unstable (popcorning)
+#define GRIND_FLOW_ANOMALY_UNSTABLE_MS 1000                                       // Instability held this long = abort
+#define GRIND_FLOW_ANOMALY_EWMA_ALPHA 0.1f                                        // Flow mean/variance smoothing per control tick (~200ms)
+
+// Completion projection (PREDICTIVE) - end grinds whose flow can no longer reach the target before the session timeout
+#define GRIND_PROJECTION_ENABLED 1                                                // Abort when completion projects past the timeout
+#define GRIND_PROJECTION_MIN_REMAINING_G 1.0f                                     // Not judged this close to the target; pulses finish it
+#define GRIND_PROJECTION_MIN_FLOW_GPS 0.05f                                       // Smoothed flow below this projects to never
+#define GRIND_PROJECTION_HOLD_MS 1500                                             // Projection past the timeout held this long = abort
+#define GRIND_PROJECTION_FLOW_TAU_MS 2000                                         // Flow smoothing time constant; alpha = 1 - exp(-dt/tau) per update
+
+// Motor current signals (MotorLoadTracker, needs HW_MOTOR_CURRENT_ENABLED) - levels are relative to the motor running empty
+#define GRIND_MOTOR_CURRENT_SPINUP_MIN_MS 150                                     // Inrush: a run is not spun up before this
+#define GRIND_MOTOR_CURRENT_SPINUP_MAX_MS 1000                                    // Spun up by now even if the level still moves
+#define GRIND_MOTOR_CURRENT_SPINUP_SETTLE_FRACTION 0.05f                          // Window-to-window change below this fraction = spun up
+#define GRIND_MOTOR_CURRENT_SMOOTHING_ALPHA 0.3f                                  // Level EMA per current window
+#define GRIND_MOTOR_CURRENT_LOAD_ONSET_FRACTION 0.15f                             // Two windows this far above the empty level = beans at the burrs
+#define GRIND_MOTOR_CURRENT_EMPTY_FRACTION 0.05f                                  // Smoothed level within this of the empty level = running empty
+#define GRIND_MOTOR_CURRENT_EMPTY_MS 200                                          // Running empty this long after the load onset = hopper ran out
+#define GRIND_MOTOR_CURRENT_NO_LOAD_LEVEL 0.0f                                    // Empty-running level (sensor units); 0 = learn it from runs that spin empty
+#define GRIND_MOTOR_CURRENT_NO_LOAD_LEARN_ALPHA 0.05f                             // A lower run floor replaces the empty level; a higher one from a run that emptied moves it this much
+#define GRIND_MOTOR_CURRENT_HOPPER_ABORT_ENABLED 1                                // End a PREDICTIVE run as soon as the motor unloads (hopper empty)
+
+// Bulk mode (BulkGrindStrategy) - weight targets for batch brew, hundreds of grams in one continuous run
+#define GRIND_BULK_ENABLED 1                                                      // Weight targets from GRIND_BULK_MIN_TARGET_G grind in bulk mode
+#define GRIND_BULK_MIN_TARGET_G 60.0f                                             // Smallest bulk target (espresso doses stay below)
+#define GRIND_BULK_TIMEOUT_SEC 600                                                // Session limit in bulk mode, instead of GRIND_TIMEOUT_SEC
+#define GRIND_BULK_TOLERANCE_G 0.5f                                               // Result tolerance in bulk mode, instead of GRIND_ACCURACY_TOLERANCE_G
+#define GRIND_BULK_MAX_PULSE_ATTEMPTS 5                                           // Correction pulses in bulk mode (<= GRIND_MAX_PULSE_ATTEMPTS)
+#define GRIND_BULK_APPROACH_G 15.0f                                               // Full speed without stop projection until this far from the stop target
+
 // Scale settling timing
-#define GRIND_SCALE_PRECISION_SETTLING_TIME_MS 500                                // High-precision settling time
+#ifndef GRIND_SCALE_PRECISION_SETTLING_TIME_MS
+    #define GRIND_SCALE_PRECISION_SETTLING_TIME_MS 500                                // High-precision settling time
+#endif
 #define GRIND_SCALE_SETTLING_TIMEOUT_MS 10000                                     // Maximum time to wait for settling
 
+// Sequential settling: settle as soon as a window of recent samples pins the mean down,
+// instead of waiting for the full GRIND_SCALE_PRECISION_SETTLING_TIME_MS window
+#define GRIND_SCALE_SEQUENTIAL_SETTLING_ENABLED 1                                 // 0 = fixed precision window only
+#ifndef GRIND_SCALE_SEQUENTIAL_SETTLING_MIN_WINDOW_MS
+    #define GRIND_SCALE_SEQUENTIAL_SETTLING_MIN_WINDOW_MS 150                         // Shortest window that may decide
+#endif
+#define GRIND_SCALE_SEQUENTIAL_SETTLING_MIN_SAMPLES 6                             // Fewest samples that may decide
+#ifndef GRIND_SCALE_SEQUENTIAL_SETTLING_TOLERANCE_G
+    #define GRIND_SCALE_SEQUENTIAL_SETTLING_TOLERANCE_G 0.005f                        // Confidence half-width and drift allowed on the mean
+#endif
+#define GRIND_SCALE_SEQUENTIAL_SETTLING_Z_SCORE 2.576f                            // Two-sided 99% confidence
+
 // Tare and calibration timing (hardware sample rate dependent)
 #define GRIND_TARE_SAMPLE_WINDOW_MS 500                                           // Time window for tare sampling
 #define GRIND_TARE_TIMEOUT_MS 3000                                                // Maximum tare completion time
+#define GRIND_FAST_TARE_ENABLED 1                                                 // Tare from the buffered history when it is already settled
+#define GRIND_FAST_TARE_WINDOW_MS 1000                                            // Buffered window the fast tare averages
+#define GRIND_FAST_TARE_MIN_SAMPLES 8                                             // Samples the window needs (fewer = fresh acquisition)
+#define GRIND_FAST_TARE_MAX_SAMPLE_AGE_MS 250                                     // Newest sample must be this recent
+#define GRIND_AUTO_ZERO_ENABLED 1                                                 // Track the zero while idle (creep, thermal drift)
+#define GRIND_AUTO_ZERO_INTERVAL_MS 1000                                          // One tracking update per window
+#define GRIND_AUTO_ZERO_MIN_SAMPLES 8                                             // Samples a window needs
+#define GRIND_AUTO_ZERO_BAND_G 0.03f                                              // |weight| treated as zero drift (a real load is outside)
+#define GRIND_AUTO_ZERO_MAX_TOTAL_G 0.5f                                          // Largest correction from the last explicit tare
+#define GRIND_AUTO_ZERO_GAIN 0.1f                                                 // Fraction of the zero error absorbed per update
+#define GRIND_AUTO_ZERO_DRIFT_ALPHA 0.02f                                         // Drift rate smoothing per tracking update (~50 s)
+#define GRIND_AUTO_ZERO_TEMP_MIN_SPAN_C 0.5f                                      // Temperature std dev before the zero/temperature fit is used
+#define GRIND_AUTO_ZERO_TEMP_FORGETTING 0.999f                                    // Fit memory per tracked update (~17 min at 1 s)
+#define GRIND_NOISE_FLOOR_ENABLED 1                                               // Derive settling, flow-start and noise thresholds from the measured idle noise
+#define GRIND_NOISE_FLOOR_WINDOW_MS 1000                                          // Idle window per robust noise estimate
+#define GRIND_NOISE_FLOOR_MIN_SAMPLES 8                                           // Sample differences a window needs
+#define GRIND_NOISE_FLOOR_HISTORY 8                                               // Window estimates whose median is the floor (a bump spoils one window)
+#define GRIND_NOISE_FLOOR_SETTLING_SIGMAS 3.0f                                    // Settled std dev limit in noise floors
+#define GRIND_NOISE_FLOOR_SETTLING_MIN_G 0.004f                                   // Settled std dev limit bounds at HW_LOADCELL_SAMPLE_RATE_SPS
+#define GRIND_NOISE_FLOOR_SETTLING_MAX_G 0.030f                                   // (above the upper one the scale is reported noisy)
+#define GRIND_NOISE_FLOOR_FLOW_SIGMAS 6.0f                                        // Flow-start threshold in flow-rate noise sigmas (motor vibration adds to idle noise)
+#define GRIND_NOISE_FLOOR_FLOW_MIN_GPS 0.3f                                       // Flow-start threshold bounds
+#define GRIND_NOISE_FLOOR_FLOW_MAX_GPS 1.0f                                       // (GRIND_FLOW_DETECTION_THRESHOLD_GPS until a floor is measured)
+
+// Adaptive flow windows - the shortest window whose flow noise meets a target, from the noise floor
+#define GRIND_ADAPTIVE_FLOW_WINDOWS_ENABLED 1                                     // Size the flow windows from the noise floor (fixed GRIND_FLOW_*_WINDOW_MS until one is measured)
+#define GRIND_ADAPTIVE_WINDOW_STEP_MS 20                                          // Window resolution, and the unit the session log stores them in
+#define GRIND_ADAPTIVE_DETECTION_MIN_MS 200                                       // Detection window bounds; its target noise keeps the flow-start threshold at GRIND_NOISE_FLOOR_FLOW_MIN_GPS
+#define GRIND_ADAPTIVE_DETECTION_MAX_MS 1000
+#define GRIND_ADAPTIVE_PREDICTION_SIGMA_GPS 0.02f                                 // Flow noise the prediction window aims for (coast error ~ this x coast time)
+#define GRIND_ADAPTIVE_PREDICTION_MIN_MS 600                                      // Prediction window bounds
+#define GRIND_ADAPTIVE_PREDICTION_MAX_MS 3000
+#define GRIND_ADAPTIVE_STABILITY_SMOOTHING 0.3f                                   // Weight of the newest grind's mean flow fit R^2 in the running stability
+#define GRIND_ADAPTIVE_INSTABILITY_GAIN 2.0f                                      // Prediction window stretch per unit of (1 - stability); uneven flow needs more averaging
+#define GRIND_FAST_START_ENABLED 1                                                // Run INITIALIZING..TARE_CONFIRM in one tick without waiting for the UI ack
 #define GRIND_CALIBRATION_SAMPLE_WINDOW_MS 800                                    // Time window for calibration sampling  
 #define GRIND_CALIBRATION_TIMEOUT_MS 2000                                         // Maximum calibration completion time
 
@@ -88,3 +285,11 @@
 #define GRIND_AUTOTUNE_COLLECTION_DELAY_MS 1500                                   // Minimum wait after pulse for grounds to drop
 #define GRIND_AUTOTUNE_SETTLING_TIMEOUT_MS 5000                                   // Max wait per pulse for scale settling
 #define GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G GRIND_SCALE_SETTLING_TOLERANCE_G        // 0.010g detection threshold
+#define GRIND_AUTOTUNE_BASELINE_WINDOW_MS 250                                     // Pre-pulse weight window ending at the pulse start edge
+#define GRIND_AUTOTUNE_MODEL_FIT_ENABLED 1                                        // Fit a designed pulse sweep instead of binary search
+#define GRIND_AUTOTUNE_FIT_PULSE_COUNT 6                                          // Designed pulses, evenly spaced from MIN to MAX
+#define GRIND_AUTOTUNE_FIT_MIN_PULSE_MS 120.0f                                    // Shortest designed pulse
+#define GRIND_AUTOTUNE_FIT_MAX_PULSE_MS 520.0f                                    // Longest designed pulse (inside the pulse table grid)
+#define GRIND_AUTOTUNE_FIT_MIN_POINTS 3                                           // Pulses with grounds the line fit needs
+#define GRIND_AUTOTUNE_FIT_CONFIDENCE_Z 2.0f                                      // Standard errors added to the fitted boundary
+#define GRIND_AUTOTUNE_FIT_MAX_STD_ERROR_MS 20.0f                                 // Wider fits fall back to binary search
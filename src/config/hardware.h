@@ -15,6 +15,7 @@
 #define HW_TOUCH_I2C_SDA_PIN 47                                                // I2C data pin for capacitive touch controller
 #define HW_TOUCH_I2C_SCL_PIN 48                                                // I2C clock pin for capacitive touch controller
 #define HW_TOUCH_I2C_ADDRESS 0x38                                              // I2C address of FT3168 touch controller
+#define HW_TOUCH_INT_PIN -1                                                    // FT3168 INT (active low) (-1 = not wired, touch is read every UI cycle)
 
 // Display Controller (QSPI)
 #define HW_DISPLAY_CS_PIN 9                                                    // SPI chip select for display controller
@@ -26,21 +27,100 @@
 #define HW_DISPLAY_RESET_PIN 21                                                // Display reset pin
 
 // Load Cell ADC Pins
-#define HW_LOADCELL_DOUT_PIN 3                                                 // HX711 data output pin
-#define HW_LOADCELL_SCK_PIN 2                                                  // HX711 serial clock pin
+#define HW_LOADCELL_DOUT_PIN 3                                                 // HX711/ADS1232 data output pin (NAU7802 SDA)
+#define HW_LOADCELL_SCK_PIN 2                                                  // HX711/ADS1232 serial clock pin (NAU7802 SCL)
+#define HW_LOADCELL_RATE_PIN -1                                                // HX711 RATE pin (-1 = not wired, RATE strapped low for 10 SPS)
+#define HW_LOADCELL_DOUT2_PIN 5                                                // Second HX711 DOUT with HW_LOADCELL_CHANNELS 2 (SCK and RATE shared)
 
 // Motor Control
 #define HW_MOTOR_RELAY_PIN 18                                                  // GPIO pin for grinder motor control relay
+#define HW_MOTOR_SPEED_CONTROL_ENABLED 0                                       // 1 = motor input takes a variable duty (PWM driver, burst-fire SSR), 0 = on/off relay
+#define HW_MOTOR_PWM_PERIOD_US 20000                                           // Duty period on the motor pin (20ms = one 50Hz mains cycle for burst-fire SSRs)
+#define HW_MOTOR_MIN_DUTY 0.3f                                                 // Lowest duty that still turns the burrs under load
+
+// Grinder channels (GrindChannels): further grinders with their own scale on the same board
+#define HW_GRINDER_CHANNELS 1                                                  // 2 = a second grinder and load cell, each with its own driver, controller and sessions
+#define HW_GRINDER2_LOADCELL_DOUT_PIN 6                                        // Second grinder's HX711 data output pin
+#define HW_GRINDER2_LOADCELL_SCK_PIN 7                                         // Second grinder's HX711 serial clock pin (RATE strapped like the first)
+#define HW_GRINDER2_MOTOR_RELAY_PIN 17                                         // Second grinder's motor relay pin
+
+// Motor current sensing (MotorCurrentSensor): current transformer or shunt amplifier into an ADC1 channel
+#define HW_MOTOR_CURRENT_ENABLED 0                                             // 1 = sample motor current (continuous-mode ADC, DMA) for spin-up, load and empty-hopper signals
+#define HW_MOTOR_CURRENT_ADC1_CHANNEL 3                                        // ADC1 channel (ESP32-S3: channel n is GPIO n+1, so 3 = GPIO4)
+#define HW_MOTOR_CURRENT_AC_COUPLED 1                                          // 1 = current transformer: RMS about the window mean; 0 = DC shunt: window mean
+#define HW_MOTOR_CURRENT_SAMPLE_RATE_HZ 10000                                  // ADC conversions per second
+#define HW_MOTOR_CURRENT_WINDOW_MS 20                                          // One level per window; a whole number of mains cycles (20 = 50 Hz, 50 = 50 and 60 Hz)
+#define HW_MOTOR_CURRENT_AMPS_PER_COUNT 0.0f                                   // Level scale for logs; 0 = report ADC counts
 
 //------------------------------------------------------------------------------
 // LOAD CELL ADC SPECIFICATIONS
 //------------------------------------------------------------------------------
 // Sample rate configuration
-#define HW_LOADCELL_SAMPLE_RATE_SPS 10                                         // Current sample rate setting
+#define HW_LOADCELL_SAMPLE_RATE_SPS 10                                         // Default/idle sample rate setting (RATE pin LOW)
 #define HW_LOADCELL_SAMPLE_INTERVAL_MS (1000 / HW_LOADCELL_SAMPLE_RATE_SPS)   // Calculated sample interval
+#define HW_LOADCELL_SAMPLE_RATE_HIGH_SPS 80                                    // High-rate setting (RATE pin HIGH, requires HW_LOADCELL_RATE_PIN)
+#define HW_LOADCELL_RATE_SWITCH_DISCARD_SAMPLES 4                              // Conversions dropped after a RATE change (HX711 settling = 4 conversions)
+
+// Long sample history (CompactSampleHistory): 32-sample delta-coded blocks of 144 bytes
+#define HW_LOADCELL_COMPACT_HISTORY_ENABLED 1                                  // 1 = keep a compact history beyond the main sample ring
+#define HW_LOADCELL_COMPACT_HISTORY_BLOCKS 64                                  // Power of two; 64 = 9 KB, 2048 samples (~25 s at 80 SPS, 200 s at 10 SPS)
+#define HW_LOADCELL_SIMD_KERNELS_ENABLED 1                                     // 1 = ESP32-S3 PIE vector loops for window sum/min/max (scalar elsewhere)
+
+// Decimation (SampleDecimator): between the ADC and the sample ring, after the vibration notch
+#define HW_LOADCELL_DECIMATION_ENABLED 0                                       // 1 = average fast ADC rates down to about the target before the sample ring
+#define HW_LOADCELL_DECIMATION_TARGET_SPS 40                                   // Ring rate to decimate to; ADC rates at or below it pass through (factor = ADC rate / target, rounded down)
+#define HW_LOADCELL_DECIMATION_ORDER 1                                         // 1 = boxcar average, 2-3 = CIC stages (sharper alias rejection, less noise reduction)
+#define HW_LOADCELL_DECIMATION_RAW_RETENTION 1                                 // 1 = keep every ADC sample in a parallel ring for session ADC capture and noise spectra
+#define HW_LOADCELL_DECIMATION_RAW_RING_SIZE 1024                              // Power of two; raw samples retained (3 s at 320 SPS, 8 KB)
+
+// Motor vibration notch (VibrationNotch): samples taken while the motor runs, before the sample ring
+#define HW_LOADCELL_VIBRATION_NOTCH_ENABLED 1                                  // 1 = notch the motor tone out of motor-on samples (once a tone is set or measured)
+#define HW_LOADCELL_VIBRATION_NOTCH_HZ 0.0f                                    // Motor/burr tone at the load cell; 0 = off until a motor noise spectrum stores one (or grinder.py fit-model's vibration_hz)
+#define HW_LOADCELL_VIBRATION_NOTCH_Q 2.0f                                     // Notch quality; lower is wider (tolerates speed drift) and rings longer
+#define HW_LOADCELL_VIBRATION_NOTCH_MIN_ALIAS_HZ 1.0f                          // Tone aliased closer to DC than this at the live rate: filter off (it would notch the flow)
+
+// Acquisition mode
+#define HW_LOADCELL_DRDY_INTERRUPT_ENABLED 1                                   // 1 = DOUT falling-edge ISR wakes sampling task, 0 = fixed-rate polling
+#define HW_LOADCELL_ISR_READOUT_ENABLED 1                                      // 1 = the DOUT ISR clocks the sample out itself (IRAM) into an internal-RAM ring: flash writes delay samples, never lose them
+#define HW_LOADCELL_ISR_RING_SIZE 16                                           // Power of two; samples staged while the sampling task is stalled (200ms at 80 SPS)
+#define HW_LOADCELL_USE_SPI_DRIVER 0                                           // 1 = clock HX711 with SPI peripheral (HX711SpiDriver), 0 = bit-banged HX711Driver
+#define HW_LOADCELL_SPI_HOST SPI3_HOST                                         // SPI host for HX711SpiDriver (SPI2 is used by the display QSPI bus)
+#define HW_LOADCELL_SPI_CLOCK_HZ 1000000                                       // HX711 SCK frequency via SPI (SCK high/low must stay 0.2-50µs)
+
+// ADC selection
+#define HW_LOADCELL_ADC_AUTO 0                                                 // Probe NAU7802 on the load cell header, otherwise use the 2-wire HX711 (NAU7802-wired boards only)
+#define HW_LOADCELL_ADC_HX711 1                                                // HX711 (bit-banged or SPI, see HW_LOADCELL_USE_SPI_DRIVER)
+#define HW_LOADCELL_ADC_ADS1232 2                                              // TI ADS1232 (same 2-wire interface as HX711, cannot be auto-detected)
+#define HW_LOADCELL_ADC_NAU7802 3                                              // Nuvoton NAU7802 (I2C)
+#define HW_LOADCELL_ADC_TYPE HW_LOADCELL_ADC_HX711                             // ADC backend created by WeightSensor::initialize_adc_hardware()
+#define HW_LOADCELL_CHANNELS 1                                                 // 2 = two HX711s clocked together, read in one pass and summed per conversion (bit-banged HX711 only)
+#define HW_LOADCELL_CHANNEL2_GAIN 1.0f                                         // Channel 2 counts to channel 1 counts (cell sensitivity ratio); the stored gain (ConfigStore) overrides
+
+// NAU7802 (I2C, 10/20/40/80/320 SPS)
+#define HW_NAU7802_I2C_PORT I2C_NUM_1                                          // Own I2C controller (I2C_NUM_0 belongs to the touch controller)
+#define HW_NAU7802_SDA_PIN HW_LOADCELL_DOUT_PIN                                // SDA shares the load cell header DOUT pin
+#define HW_NAU7802_SCL_PIN HW_LOADCELL_SCK_PIN                                 // SCL shares the load cell header SCK pin
+#define HW_NAU7802_DRDY_PIN -1                                                 // DRDY output (-1 = not wired, poll PU_CTRL.CR over I2C; needed for 320 SPS)
+#define HW_NAU7802_I2C_ADDRESS 0x2A                                            // Fixed 7-bit I2C address
+#define HW_NAU7802_I2C_FREQUENCY_HZ 400000                                     // I2C clock (fast mode)
+#define HW_NAU7802_SAMPLE_RATE_HIGH_SPS 320                                    // Rate used for high-rate grind phases
+#define HW_NAU7802_SAMPLE_RATE_POLLED_SPS 40                                   // High rate without DRDY: fastest rate the 50Hz WeightSamplingTask poll keeps up with
+
+// ADS1232 (2-wire, 10/80 SPS, internal temperature diode)
+#define HW_ADS1232_SPEED_PIN HW_LOADCELL_RATE_PIN                              // SPEED pin (-1 = strapped low for 10 SPS), shares the HX711 RATE wire
+#define HW_ADS1232_PDWN_PIN -1                                                 // PDWN pin (-1 = strapped high, standby via SCLK instead)
+#define HW_ADS1232_TEMP_PIN -1                                                 // TEMP pin (-1 = strapped low, no temperature channel)
+#define HW_ADS1232_A0_PIN -1                                                   // A0 input mux select (-1 = strapped, AIN1 used)
+#define HW_ADS1232_GAIN0_PIN -1                                                // GAIN0 pin (-1 = strapped, see HW_ADS1232_STRAPPED_GAIN)
+#define HW_ADS1232_GAIN1_PIN -1                                                // GAIN1 pin (-1 = strapped, see HW_ADS1232_STRAPPED_GAIN)
+#define HW_ADS1232_STRAPPED_GAIN 128                                           // PGA gain set by board straps when GAIN0/GAIN1 are not wired
+#define HW_ADS1232_VREF_MV 5000                                                // REFP-REFN voltage in mV (temperature conversion)
+#define HW_ADS1232_TEMP_INTERVAL_MS 30000                                      // Temperature channel refresh interval (idle rate only)
 
 // Calibration validation
 #define HW_LOADCELL_CAL_MIN_ADC_VALUE 1000                                    // Minimum ADC value to confirm weight placed on scale
+#define HW_LOADCELL_CAL_MAX_POINTS 4                                          // Calibration points per curve (piecewise linear from zero)
+#define HW_LOADCELL_SPAN_TEMPCO_PPM_PER_C 0.0f                                 // Load cell + ADC sensitivity drift (0 = no span compensation)
 
 //------------------------------------------------------------------------------
 // DISPLAY SPECIFICATIONS  
@@ -53,6 +133,14 @@
 #define HW_DISPLAY_IPS_INVERT_Y 24                                             // IPS Y-axis inversion setting
 #define HW_DISPLAY_COLOR_ORDER 20                                              // Color channel ordering
 #define HW_DISPLAY_MINIMAL_BRIGHTNESS_PERCENT 15                               // Minimum brightness percentage (to avoid too dim to see)
+#define HW_DISPLAY_DMA_FLUSH_ENABLED 1                                         // Queued QSPI DMA (esp_lcd) for LVGL flushes; 0: polled Arduino_GFX writes
+#define HW_DISPLAY_QSPI_CLOCK_HZ (40 * 1000 * 1000)                            // Same clock Arduino_ESP32QSPI brings the panel up with
+#define HW_DISPLAY_BUFFER_STRIPES 0                                            // Two HW_DISPLAY_DRAW_BUFFER_ROWS stripes in internal DMA RAM, partial rendering
+#define HW_DISPLAY_BUFFER_PSRAM_DIRECT 1                                       // One full frame in PSRAM, direct rendering (frees the stripes' SRAM)
+#define HW_DISPLAY_BUFFER_MODE HW_DISPLAY_BUFFER_STRIPES                       // LVGL draw buffer layout
+#define HW_DISPLAY_DRAW_BUFFER_ROWS 48                                         // Rows per LVGL draw stripe (26.9 KB each)
+#define HW_DISPLAY_DMA_QUEUE_DEPTH 10                                          // Queued QSPI transactions (a stripe may span several)
+#define HW_DISPLAY_FLUSH_TIMEOUT_MS 100                                        // Longest wait for a DMA flush before LVGL moves on
 
 //------------------------------------------------------------------------------
 // SERIAL COMMUNICATION
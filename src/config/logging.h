@@ -6,9 +6,58 @@ extern BluetoothManager g_bluetooth_manager;
 
 // Temporary fallback logging - use Serial instead of BLE to avoid circular dependencies
 #include <Arduino.h>
+#include "debug.h"
+#include "../logging/log_levels.h"
 
 #define LOG_BLE(format, ...) Serial.printf(format, ##__VA_ARGS__)
 
+//------------------------------------------------------------------------------
+// CATEGORY LOGGING
+//------------------------------------------------------------------------------
+// LOG_AT(category, level, ...) prints like LOG_BLE when the category's runtime
+// level (log_set_level(), BLE_DEBUG_CMD_LOG_LEVEL) reaches the level: one load,
+// AND and branch on log_level_mask. Levels above the category's compile level
+// are discarded by `if constexpr`, format string and arguments included, so a
+// release build carries nothing for them. LOG_RT_AT (deferred_log.h) is the
+// Core 0 form. LOG_BLE stays unconditional for lines that must always print.
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO                                     // Highest level built into any category (debug env: LOG_LEVEL_DEBUG)
+#endif
+
+#ifdef ENABLE_BLE_DEBUG_VERBOSE
+#define LOG_BLE_VERBOSE 1
+#else
+#define LOG_BLE_VERBOSE 0
+#endif
+
+// A category's DEBUG_* switch builds its debug level in and turns it on at boot
+constexpr bool log_debug_switch(uint8_t category) {
+    return (category == LOG_CAT_GRIND && DEBUG_GRIND_CONTROLLER) ||
+           (category == LOG_CAT_LOADCELL && DEBUG_LOAD_CELL) ||
+           (category == LOG_CAT_UI && DEBUG_UI_SYSTEM) ||
+           (category == LOG_CAT_CALIBRATION && DEBUG_CALIBRATION) ||
+           (category == LOG_CAT_SETTLING && DEBUG_WEIGHT_SETTLING) ||
+           (category == LOG_CAT_BLE && LOG_BLE_VERBOSE);
+}
+
+constexpr uint8_t log_compile_level(uint8_t category) {
+    return log_debug_switch(category) ? LOG_LEVEL_DEBUG : LOG_COMPILE_LEVEL;
+}
+
+// Runtime level at boot: INFO, or DEBUG for a category switched on above
+constexpr uint8_t log_default_level(uint8_t category) {
+    return log_debug_switch(category) ? LOG_LEVEL_DEBUG
+         : log_compile_level(category) < LOG_LEVEL_INFO ? log_compile_level(category) : LOG_LEVEL_INFO;
+}
+
+#define LOG_AT(category, level, format, ...) do {                                    \
+        if constexpr ((int)(level) <= (int)log_compile_level(category)) {            \
+            if (log_level_enabled(category, level)) {                                \
+                Serial.printf(format, ##__VA_ARGS__);                                \
+            }                                                                        \
+        }                                                                            \
+    } while (0)
+
 // Replace DEBUG macros to use Serial logging
 #if DEBUG_SERIAL_OUTPUT
 #define LOG_DEBUG_PRINTF(format, ...) Serial.printf(format, ##__VA_ARGS__)
@@ -21,40 +70,12 @@ extern BluetoothManager g_bluetooth_manager;
 #endif
 
 // Conditional debug macros for different subsystems
-#if DEBUG_GRIND_CONTROLLER
-#define LOG_GRIND_DEBUG(format, ...) Serial.printf(format, ##__VA_ARGS__)
-#else
-#define LOG_GRIND_DEBUG(format, ...)
-#endif
-
-#if DEBUG_LOAD_CELL
-#define LOG_LOADCELL_DEBUG(format, ...) Serial.printf(format, ##__VA_ARGS__)
-#else
-#define LOG_LOADCELL_DEBUG(format, ...)
-#endif
-
-#if DEBUG_UI_SYSTEM
-#define LOG_UI_DEBUG(format, ...) Serial.printf(format, ##__VA_ARGS__)
-#else
-#define LOG_UI_DEBUG(format, ...)
-#endif
-
-#if DEBUG_CALIBRATION
-#define LOG_CALIBRATION_DEBUG(format, ...) Serial.printf(format, ##__VA_ARGS__)
-#else
-#define LOG_CALIBRATION_DEBUG(format, ...)
-#endif
-
-#if DEBUG_WEIGHT_SETTLING
-#define LOG_SETTLING_DEBUG(format, ...) Serial.printf(format, ##__VA_ARGS__)
-#else
-#define LOG_SETTLING_DEBUG(format, ...)
-#endif
-
-#ifdef ENABLE_BLE_DEBUG_VERBOSE
-#define LOG_BLE_DEBUG(format, ...) Serial.printf(format, ##__VA_ARGS__)
-#else
-#define LOG_BLE_DEBUG(format, ...)
-#endif
+// Subsystem debug output: compiled in by the DEBUG_* switches in debug.h (or LOG_COMPILE_LEVEL)
+#define LOG_GRIND_DEBUG(format, ...) LOG_AT(LOG_CAT_GRIND, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_LOADCELL_DEBUG(format, ...) LOG_AT(LOG_CAT_LOADCELL, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_UI_DEBUG(format, ...) LOG_AT(LOG_CAT_UI, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_CALIBRATION_DEBUG(format, ...) LOG_AT(LOG_CAT_CALIBRATION, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_SETTLING_DEBUG(format, ...) LOG_AT(LOG_CAT_SETTLING, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_BLE_DEBUG(format, ...) LOG_AT(LOG_CAT_BLE, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
 
-#define LOG_OTA_DEBUG(format, ...) Serial.printf("[OTA_DEBUG] " format, ##__VA_ARGS__)
\ No newline at end of file
+#define LOG_OTA_DEBUG(format, ...) LOG_AT(LOG_CAT_BLE, LOG_LEVEL_INFO, "[OTA_DEBUG] " format, ##__VA_ARGS__)
\ No newline at end of file
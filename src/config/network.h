@@ -0,0 +1,91 @@
+#pragma once
+
+//==============================================================================
+// WI-FI AND MQTT CONFIGURATION
+//==============================================================================
+// This file contains the Wi-Fi station, MQTT client and web dashboard settings.
+// They are built only into the -mqtt environment; other builds keep the radio
+// to BLE.
+// Credentials and the broker URI are not compiled in: they are stored in NVS
+// (namespace "network") by BLE_DEBUG_CMD_NETWORK_CONFIG, next to the cursors of
+// the last session summary and session file bytes the broker acknowledged.
+
+//------------------------------------------------------------------------------
+// BUILD SWITCH
+//------------------------------------------------------------------------------
+#ifndef NETWORK_MQTT_ENABLED
+    #define NETWORK_MQTT_ENABLED 0                                             // Default: BLE only, override with build flag
+#endif
+#ifndef NETWORK_WEB_ENABLED
+    #define NETWORK_WEB_ENABLED 0                                              // Local dashboard; rides on the MQTT task's Wi-Fi link
+#endif
+#if NETWORK_WEB_ENABLED && !NETWORK_MQTT_ENABLED
+    #error "NETWORK_WEB_ENABLED needs NETWORK_MQTT_ENABLED (the MQTT task joins Wi-Fi)"
+#endif
+
+//------------------------------------------------------------------------------
+// STORED CONFIGURATION
+//------------------------------------------------------------------------------
+#define NET_PREFS_NAMESPACE "network"                                          // NVS namespace: ssid, password, broker, sess_cursor, up_session, up_offset
+#define NET_WIFI_SSID_MAX_LENGTH 33                                            // 32 characters + terminator (802.11)
+#define NET_WIFI_PASSWORD_MAX_LENGTH 65                                        // 64 characters + terminator (WPA2 PSK)
+#define NET_MQTT_BROKER_URI_MAX_LENGTH 128                                     // mqtt://host:port or mqtts://host:port
+
+//------------------------------------------------------------------------------
+// WI-FI STATION
+//------------------------------------------------------------------------------
+#define NET_WIFI_CONNECT_TIMEOUT_MS 15000                                      // Association and DHCP before a retry
+#define NET_WIFI_RETRY_MIN_MS 2000                                             // First reconnect delay, doubled per failure
+#define NET_WIFI_RETRY_MAX_MS 60000                                            // Reconnect delay cap
+
+//------------------------------------------------------------------------------
+// MQTT CLIENT
+//------------------------------------------------------------------------------
+#define NET_MQTT_TOPIC_ROOT "grinder"                                          // Topics are <root>/<device id>/<leaf>; device id is the MAC
+#define NET_MQTT_TOPIC_MAX_LENGTH 64
+#define NET_MQTT_KEEPALIVE_S 30
+#define NET_MQTT_TELEMETRY_INTERVAL_MS 1000                                    // One telemetry batch per second while a grind runs (cmd/telemetry overrides)
+#define NET_MQTT_TELEMETRY_TICK_DIVIDER 2                                      // Every 2nd control tick in the batch: 25 Hz samples (cmd/telemetry overrides)
+#define NET_MQTT_TELEMETRY_MAX_SAMPLES 64                                      // Samples per batch; a full batch goes out before the interval
+#define NET_MQTT_TELEMETRY_MIN_INTERVAL_MS 200                                 // Fastest batch interval a command may set
+#define NET_MQTT_DIAGNOSTICS_INTERVAL_MS 60000                                 // Task timing, memory and link quality
+#define NET_MQTT_POLL_INTERVAL_MS 50                                           // MQTT task wake period while connected
+#define NET_MQTT_PAYLOAD_MAX_BYTES 768                                         // Largest published message (diagnostics)
+#define NET_MQTT_COMMAND_QUEUE_LENGTH 4                                        // Received commands awaiting the UI task
+#define NET_MQTT_SESSION_ACK_TIMEOUT_MS 10000                                  // Unacknowledged session summary is sent again
+#define NET_MQTT_SESSION_CURSOR_SAVE_EVERY 16                                  // Acknowledged summaries between cursor writes to NVS while draining
+
+//------------------------------------------------------------------------------
+// SESSION FILE UPLOAD
+//------------------------------------------------------------------------------
+#define NET_MQTT_UPLOAD_CHUNK_BYTES 1024                                       // Largest upload message; partition chunks also end at a record
+#define NET_MQTT_UPLOAD_ACK_TIMEOUT_MS 10000                                   // Unacknowledged chunk is sent again
+#define NET_MQTT_UPLOAD_CURSOR_SAVE_EVERY 16                                   // Acknowledged chunks between cursor writes to NVS
+
+//------------------------------------------------------------------------------
+// HOME ASSISTANT
+//------------------------------------------------------------------------------
+#define NET_HA_DISCOVERY_PREFIX "homeassistant"                                // Home Assistant's MQTT discovery prefix (its default)
+#define NET_HA_STATE_MIN_INTERVAL_MS 2000                                      // Fewest milliseconds between two retained state messages
+#define NET_HA_WEIGHT_DEADBAND_G 0.2f                                          // Smaller weight changes alone publish nothing
+
+//------------------------------------------------------------------------------
+// WI-FI OTA
+//------------------------------------------------------------------------------
+#define NET_OTA_URL_MAX_LENGTH 256                                             // cmd/ota image URL, http:// or https:// (system CA bundle)
+#define NET_OTA_VERSION_MAX_LENGTH 24                                          // Expected firmware version string
+#define NET_OTA_HTTP_TIMEOUT_MS 10000                                          // Connect and per-read timeout
+#define NET_OTA_READ_BYTES 4096                                                // One HTTP read, queued whole into the OTA ring
+#define NET_OTA_MAX_RETRIES 5                                                  // Range requests in a row without progress before the update aborts
+#define NET_OTA_RETRY_DELAY_MS 3000                                            // Pause before resuming a dropped download
+
+//------------------------------------------------------------------------------
+// WEB DASHBOARD
+//------------------------------------------------------------------------------
+#define NET_WEB_PORT 80                                                        // Dashboard page at /, WebSocket at /ws
+#define NET_WEB_MAX_SOCKETS 4                                                  // Open HTTP and WebSocket connections; the oldest is purged
+#define NET_WEB_SAMPLE_INTERVAL_MS 10                                          // UI snapshot poll while a client listens (every 50 Hz tick, half of the 200 Hz ones)
+#define NET_WEB_PUSH_INTERVAL_MS 100                                           // One telemetry frame per interval, or sooner when full
+#define NET_WEB_FRAME_MAX_SAMPLES 32                                           // Samples per WebSocket frame (16 bytes each)
+#define NET_WEB_SESSION_BACKLOG 16                                             // Newest summaries sent to a client when it connects
+#define NET_WEB_SEND_TIMEOUT_S 2                                               // A client that takes no data for this long is dropped
@@ -25,18 +25,54 @@
 // Critical timing for FreeRTOS task architecture with 6 specialized tasks
 
 // Task Intervals (milliseconds)
-#define SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS 20                                // Weight sampling poll interval (50Hz poll; HX711 @10SPS) - Core 0
+#define SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS 20                                // Weight sampling poll interval (50Hz poll; HX711 @10SPS) - Core 0, polling mode only
 #define SYS_TASK_GRIND_CONTROL_INTERVAL_MS 20                                  // Grind controller update interval (50Hz) - Core 0
+#define SYS_TASK_GRIND_CONTROL_FAST_INTERVAL_MS 5                              // Interval in GRIND_PHASE_FLAG_HIGH_RATE phases (200Hz: stop and pulse decisions); SYS_TASK_GRIND_CONTROL_INTERVAL_MS turns it off
+#define SYS_GRIND_CONTROL_SAMPLE_DRIVEN 1                                      // GRIND_PHASE_FLAG_HIGH_RATE phases tick once per new load cell sample (WeightSamplingTask notifies); the interval is then the timeout only
+#define SYS_GRIND_REPORT_INTERVAL_MS 20                                        // Measurement log rows, UI progress events and telemetry ticks, whatever the control rate
+#define SYS_GRIND_CONTROL_DEADLINE_SAFE_OFF 1                                  // Stop the motor when the control loop keeps missing deadlines
+#define SYS_GRIND_CONTROL_MAX_MISSED_DEADLINES 5                               // Consecutive missed cycles at the 50Hz rate (100ms, scaled at faster rates) before the fail-safe stop
 #define SYS_TASK_UI_INTERVAL_MS 16                                             // UI rendering frequency (60Hz) - Core 1  
+#define SYS_UI_FRAME_PERIOD_CALM_MS 33                                         // Frame period on screens without motion (Ready, grind result, calibration, autotune, OTA: 30Hz)
+#define SYS_TASK_UI_IDLE_POLL_MS 50                                            // Longest UI sleep on an idle screen (bounds touch latency unless HW_TOUCH_INT_PIN is wired)
+#define SYS_TASK_UI_ACTIVE_HOLD_MS 1000                                        // Full frame rate kept after the last touch or redraw
+#define SYS_UI_WAKE_NOTIFY_BIT (1UL << 31)                                     // UI task notification bit: work queued by another task (PeriodicJob bits below it)
+#define SYS_UI_EVICT_RARE_SCREENS 1                                            // Delete calibration, autotune and OTA screens on leaving them (rebuilt on the next visit)
+#define SYS_UI_BENCHMARK_STAGE_MS 4000                                         // Each UI benchmark stage (Ready, grinding arc, grinding chart, menu scroll)
+#define SYS_UI_BENCHMARK_MAX_FRAMES 256                                        // Frame samples kept per stage for the p95 (later frames count in avg and max only)
+#define SYS_UI_BENCHMARK_SWIPE_MS 400                                          // Injected drag on the menu stage, each way; released for a quarter of it in between
+#define SYS_HOT_PATH_BENCHMARK_ITERATIONS 64                                   // Timed calls per query, window and sample rate (the median is reported)
+#define SYS_STORAGE_BENCHMARK_DIR "/bench"                                     // Scratch directory, removed when the storage benchmark ends
+#define SYS_STORAGE_BENCHMARK_SESSION_BYTES (36 * 1024)                        // One file-backed session's worth of writes
+#define SYS_STORAGE_BENCHMARK_APPEND_BYTES 1024                                // Bytes per write() while the session file grows
+#define SYS_STORAGE_BENCHMARK_READ_BYTES 4096                                  // Bytes per read() for the throughput figure
+#define SYS_STORAGE_BENCHMARK_MIN_FREE_BYTES (96 * 1024)                       // Directory levels are skipped below this much free space
+#define SYS_NOISE_SPECTRUM_POINTS 256                                          // FFT length (power of two); the newest samples in the capture window, zero-padded if fewer
+#define SYS_NOISE_SPECTRUM_MIN_SAMPLES 64                                      // Fewer samples in the window: no spectrum (motor run too short)
+#define SYS_NOISE_SPECTRUM_BANDS 4                                             // Equal bands from DC to Nyquist, each reported with its median amplitude as the floor
+#define SYS_NOISE_SPECTRUM_SPINUP_MS 1000                                      // Motor capture skips this much after the motor starts (spin-up and first grounds)
+#define SYS_NOISE_SPECTRUM_TONE_RATIO 4.0f                                     // A peak this many times its band floor is a tone (notch candidate or mains pickup)
 #define SYS_TASK_BLUETOOTH_INTERVAL_MS 20                                      // Bluetooth handling frequency (50Hz) - Core 1
 #define SYS_TASK_FILE_IO_INTERVAL_MS 100                                       // File I/O operations frequency (10Hz) - Core 1
+#define SYS_TASK_WEIGHT_SAMPLING_DRDY_TIMEOUT_MS 250                           // Max wait for HX711 data-ready interrupt before housekeeping pass
 
 // Task Stack Sizes (bytes) - Increased for BLE_LOG overhead and complex operations
 #define SYS_TASK_WEIGHT_SAMPLING_STACK_SIZE 4096                               // 4KB stack for weight sampling (was 2KB, increased for BLE_LOG)
-#define SYS_TASK_GRIND_CONTROL_STACK_SIZE 6144                                 // 6KB stack for grind control logic (was 4KB, increased for complex algorithms)
+#define SYS_TASK_GRIND_CONTROL_STACK_SIZE 10240                                // 10KB stack for grind control logic (was 6KB, window scratch buffers at 320 SPS)
 #define SYS_TASK_UI_STACK_SIZE 8192                                            // 8KB stack for LVGL rendering (unchanged)
 #define SYS_TASK_BLUETOOTH_STACK_SIZE 4096                                     // 4KB stack for BLE operations (unchanged)
 #define SYS_TASK_FILE_IO_STACK_SIZE 6144                                       // 6KB stack for LittleFS operations (was 4KB, increased for file operations)
+#define SYS_TASK_OTA_WRITER_STACK_SIZE 4096                                    // 4KB stack for the OTA writer: detools apply + flash writes (created by the first OTA)
+#define SYS_TASK_MQTT_STACK_SIZE 8192                                          // 8KB stack for Wi-Fi, MQTT publishing and the HTTPS OTA download (TLS handshake), created with -DNETWORK_MQTT_ENABLED=1
+#define SYS_TASK_WEB_STACK_SIZE 4096                                           // 4KB stack for the web dashboard push task (snapshot sampling, frame queueing), created with -DNETWORK_WEB_ENABLED=1
+#define SYS_TASK_BOOT_STACK_SIZE 6144                                          // 6KB stack for the one-shot boot job (LittleFS mount/format + HX711 bring-up)
+#define SYS_TASK_MEMORY_SAMPLE_INTERVAL_MS 10000                               // Stack high-water and heap sampling period (TaskManager)
+#define SYS_TASK_CPU_STATS_MAX_TASKS 40                                        // FreeRTOS tasks one CPU load sample can account (TaskStatus_t array in PSRAM)
+
+// Periodic jobs (FreeRTOS software timers owned by TaskManager, run on the UI task)
+#define SYS_JOB_DIAGNOSTICS_INTERVAL_MS 500                                    // Diagnostics tick; each check runs at its own cadence (DiagnosticsController)
+#define SYS_JOB_SCREEN_TIMEOUT_INTERVAL_MS 50                                  // Auto-dim and idle sampling power check (bounds touch-to-wake latency)
+#define SYS_JOB_UPTIME_INTERVAL_MINUTES 15                                     // Device uptime statistics credit
 
 // Task Priorities (higher number = higher priority)
 #define SYS_TASK_PRIORITY_WEIGHT_SAMPLING 4                                    // Highest priority (real-time sampling)
@@ -45,10 +81,62 @@
 // Raise BLE above UI to prevent starvation during transfers
 #define SYS_TASK_PRIORITY_BLUETOOTH 3                                          // Higher priority (BLE operations)
 #define SYS_TASK_PRIORITY_FILE_IO 1                                            // Low priority (file operations)
+#define SYS_TASK_PRIORITY_OTA_WRITER 2                                         // Below BLE so receiving never waits on flash
+#define SYS_TASK_PRIORITY_MQTT 1                                               // With file I/O: telemetry to a broker is best effort
+#define SYS_TASK_PRIORITY_WEB 1                                                // Web push task and HTTP server task: best effort like MQTT
+#define SYS_TASK_PRIORITY_BOOT 2                                               // Below the real-time tasks; WeightSampling waits for it anyway
+
+// Core Assignment - Core 0 is reserved for load cell sampling and grind control.
+// UI, BLE, file I/O and the Arduino loop stay on Core 1. The BLE controller and
+// host tasks are pinned by sdkconfig (custom_sdkconfig in platformio.ini), which
+// must match SYS_BLE_STACK_CORE; BluetoothManager verifies this after init.
+#define SYS_CORE_REALTIME 0                                                    // Weight sampling + grind control only
+#define SYS_CORE_APPLICATION 1                                                 // UI, BLE, file I/O, Arduino loop
+#define SYS_TASK_CORE_WEIGHT_SAMPLING SYS_CORE_REALTIME
+#define SYS_TASK_CORE_GRIND_CONTROL SYS_CORE_REALTIME
+#define SYS_TASK_CORE_UI SYS_CORE_APPLICATION
+#define SYS_TASK_CORE_BLUETOOTH SYS_CORE_APPLICATION
+#define SYS_TASK_CORE_FILE_IO SYS_CORE_APPLICATION
+#define SYS_TASK_CORE_OTA_WRITER SYS_CORE_REALTIME                             // Free while OTA suspends the real-time tasks
+#define SYS_TASK_CORE_MQTT SYS_CORE_APPLICATION
+#define SYS_TASK_CORE_WEB SYS_CORE_APPLICATION                                 // Push task and esp_http_server task
+#define SYS_TASK_CORE_BOOT SYS_CORE_REALTIME                                   // Idle during setup(), which runs on Core 1
+#define SYS_BLE_STACK_CORE SYS_CORE_APPLICATION                                // CONFIG_BT_*_PINNED_TO_CORE
+
+// Sampling wake jitter histogram (deviation of WeightSamplingTask wake interval
+// from the expected sample period; reported with the realtime heartbeat)
+#define SYS_SAMPLING_JITTER_GAP_FACTOR 3                                       // Intervals > N x period are missed samples, not jitter
+
+// Radio coexistence: bulk radio work waits while a grind runs (RadioCoexistence)
+#define SYS_COEX_TRICKLE_INTERVAL_MS 250                                       // One BLE export chunk per interval during a grind (the host gives up after 10s of silence)
+
+// Sampling power modes while the screen is dimmed (READY state only)
+#define SYS_SAMPLING_IDLE_POWER_ENABLED 1                                      // Power the ADC down / slow polling while the screen is dimmed
+#define SYS_SAMPLING_IDLE_WATCH_POLL_INTERVAL_MS 100                           // Polling period while Start-on-Cup watches for a cup (interrupt mode keeps the ADC rate)
+#define SYS_SAMPLING_IDLE_WAKE_DELTA_G 5.0f                                    // Coarse weight change that wakes the screen from watch mode
+#define SYS_SAMPLING_IDLE_OFF_CHECK_MS 1000                                    // Max sleep per wait while the ADC is powered down
+
+// Power management: DFS and automatic light sleep (PowerManager, needs CONFIG_PM_ENABLE and tickless idle)
+#define SYS_POWER_MANAGEMENT_ENABLED 1                                         // 1 = esp_pm scales the CPU clock; 0 = fixed board_build.f_cpu
+#define SYS_PM_MAX_CPU_FREQ_MHZ 240                                            // Held while grinding, transferring, tracing or drawing
+#define SYS_PM_MIN_CPU_FREQ_MHZ 80                                             // Idle clock; the lowest that keeps the APB at 80 MHz
+#define SYS_PM_LIGHT_SLEEP_ENABLED 1                                           // Light sleep between ticks while the Ready screen is dimmed and the radios are off
 
 // Inter-Task Communication Queue Sizes
 #define SYS_QUEUE_UI_TO_GRIND_SIZE 5                                           // UI events to grind controller
-#define SYS_QUEUE_FILE_IO_SIZE 20                                              // File I/O operation requests
+#define SYS_FILE_IO_SESSION_RING_BYTES 1024                                    // File I/O SESSION lane (flash operations, exports)
+#define SYS_FILE_IO_PREFERENCE_RING_BYTES 512                                  // File I/O PREFERENCE lane
+#define SYS_FILE_IO_LOG_RING_BYTES 2048                                        // File I/O LOG lane (variable-length lines)
+#define SYS_FILE_IO_LOG_BATCH_BYTES 512                                        // Log lines joined into one serial write
+#define SYS_FILE_ARENA_BYTES (32 * 1024)                                      // PSRAM scratch for file operations (memory_arena.h)
+#define SYS_SESSION_ARENA_BYTES (8 * 1024)                                     // Per-grind scratch, reset when a session starts
+#define SYS_TRACE_EVENTS_PER_CORE 16384                                        // Trace ring per core in PSRAM (8 bytes per event, trace.h)
+#define SYS_TRACE_DEFAULT_CAPTURE_MS 3000                                      // Trace capture length when the command gives none
+#define SYS_TRACE_MAX_CAPTURE_MS 10000                                         // Well below the 17.9 s CCOUNT wrap at 240 MHz
+#define SYS_TRACE_DUMP_CHUNK_DELAY_MS 15                                       // Pause between trace dump notifications
+#define SYS_CRASH_TRACE_EVENTS 32                                              // Trace tail per core kept in RTC memory for a crash (crash_snapshot.h)
+#define SYS_TELEMETRY_RING_FRAMES 256                                          // Live telemetry frames awaiting the BLE task (20 bytes each, telemetry.h)
+#define SYS_TELEMETRY_TICK_RING_ENTRIES 128                                    // Control ticks awaiting the MQTT publisher (12 bytes each, 2.5 s at 50 Hz)
 
 // Legacy task scheduler intervals (deprecated - kept for compatibility)
 #define SYS_TASK_LOADCELL_INTERVAL_MS 20                                       // Load cell polling frequency (50Hz)
@@ -87,7 +175,13 @@
 //------------------------------------------------------------------------------
 // LOGGING CONFIGURATION
 //------------------------------------------------------------------------------
-#define SYS_LOG_EVERY_N_GRIND_LOOPS 1                                          // Log frequency for grind control loop
+#define SYS_LOG_EVERY_N_GRIND_LOOPS 5                                          // Steady-phase measurement decimation (GRIND_PHASE_FLAG_DECIMATED_LOG), 1 keeps every row; loops here are log rows (SYS_GRIND_REPORT_INTERVAL_MS)
+#define SYS_LOG_PRE_TRIGGER_LOOPS 10                                           // Rows logged at full rate before a trigger (phase change, motor edge)
+#define SYS_LOG_TRIGGER_HOLD_LOOPS 25                                          // Rows logged at full rate after a trigger
+#define SYS_LOG_STAGING_RECORDS 32                                             // Records per internal-SRAM staging chunk Core 0 writes (FileIOTask copies full chunks into the PSRAM block)
+#define SYS_LOG_STAGING_CHUNKS 4                                               // Staging chunks in flight: 4 x 32 rows ride out a >2s file write at 50Hz
+#define SYS_LOG_ADC_CAPTURE_DEFAULT false                                      // Raw ADC capture track in session files until toggled over BLE (debug command)
+#define SYS_LOG_SUMMARY_TREND_SESSIONS 50                                      // Newest session summaries averaged for the Lifetime Stats and BLE sysinfo trends
 #define SYS_CONTINUOUS_LOGGING_ENABLED true                                    // Enable/disable continuous logging
 
 //------------------------------------------------------------------------------
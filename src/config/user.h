@@ -12,6 +12,9 @@
 //------------------------------------------------------------------------------
 #define USER_PROFILE_COUNT 3                                                   // Number of coffee profiles available
 #define USER_PROFILE_NAME_MAX_LENGTH 8                                         // Maximum characters in profile name
+#define USER_PROFILE_STORE_CAPACITY 64                                         // Stored profiles (beans, recipes) in /profiles.bin
+#define USER_PROFILE_STORE_NAME_LENGTH 16                                      // Stored profile name bytes, NUL included
+#define USER_PROFILE_STORE_CACHE_ENTRIES 4                                     // Stored profiles kept in RAM with their learned models (LRU)
 
 // Default target weights for each profile
 #define USER_SINGLE_ESPRESSO_WEIGHT_G 9.0f                                     // Single espresso default weight
@@ -55,6 +58,10 @@
 // AUTO ACTIONS
 //------------------------------------------------------------------------------
 #define USER_AUTO_GRIND_TRIGGER_DELTA_G 50.0f                                   // Weight change threshold used for auto actions (grams)
-#define USER_AUTO_GRIND_TRIGGER_WINDOW_MS 2000                                  // Time window for delta detection (milliseconds)
-#define USER_AUTO_GRIND_TRIGGER_SETTLING_MS 1000                                // Settling period after trigger detection before confirmation (milliseconds)
+#define USER_AUTO_GRIND_CUP_SETTLE_MS 100                                      // Quiet window after the step that confirms the cup (milliseconds)
+#define USER_AUTO_GRIND_CUP_MIN_SAMPLES 3                                      // Samples that window needs (sets the time at the 10 SPS idle rate)
+#define USER_AUTO_GRIND_CUP_TARE_MAX_AGE_MS 1000                               // A grind started this soon after the cup settled tares to the settled level
 #define USER_AUTO_GRIND_REARM_DELAY_MS 1500                                     // Minimum delay between auto actions (milliseconds)
+#define USER_BATCH_MAX_DOSES 12                                                 // Batch mode: most doses per batch (1 = batch off)
+#define USER_ORDER_QUEUE_LENGTH 8                                              // Remote grind orders (MQTT cmd/order, BLE) waiting for the grinder
+#define USER_ORDER_EVENT_BACKLOG 16                                            // Order status changes held for the MQTT order topic; oldest dropped
@@ -1,4 +1,5 @@
 #include "autotune_controller.h"
+#include <esp_timer.h>
 #include <Arduino.h>
 #include <cmath>
 #include <cstring>
@@ -8,6 +9,9 @@
 #include "../hardware/mock_hx711_driver.h"
 #endif
 
+static_assert(GRIND_AUTOTUNE_FIT_PULSE_COUNT >= GRIND_AUTOTUNE_FIT_MIN_POINTS && GRIND_AUTOTUNE_FIT_MIN_POINTS >= 3,
+              "Model fit needs at least three pulses with grounds for a residual error");
+
 AutoTuneController::AutoTuneController()
     : weight_sensor(nullptr)
     , grinder(nullptr)
@@ -24,6 +28,7 @@ AutoTuneController::AutoTuneController()
     , direction(DOWN)
     , found_lower_bound(false)
     , iteration(0)
+    , fit_pulse_index(0)
     , verification_round(0)
     , verification_pulse_count(0)
     , verification_success_count(0)
@@ -37,6 +42,8 @@ AutoTuneController::AutoTuneController()
     result.latency_ms = 0.0f;
     result.error_message = nullptr;
 
+    memset(fit_duration_ms, 0, sizeof(fit_duration_ms));
+    memset(fit_delta_g, 0, sizeof(fit_delta_g));
     memset(&progress, 0, sizeof(progress));
     progress.phase = AutoTunePhase::IDLE;
     progress.has_new_message = false;
@@ -78,6 +85,14 @@ bool AutoTuneController::start() {
     active_pulse_ms = 0.0f;
     last_executed_pulse_ms = 0.0f;
 
+    // Designed sweep: evenly spaced so the longest pulses clear the latency search range
+    fit_pulse_index = 0;
+    for (int i = 0; i < GRIND_AUTOTUNE_FIT_PULSE_COUNT; i++) {
+        fit_duration_ms[i] = GRIND_AUTOTUNE_FIT_MIN_PULSE_MS +
+                             i * (GRIND_AUTOTUNE_FIT_MAX_PULSE_MS - GRIND_AUTOTUNE_FIT_MIN_PULSE_MS) / (GRIND_AUTOTUNE_FIT_PULSE_COUNT - 1);
+        fit_delta_g[i] = 0.0f;
+    }
+
     // Initialize verification state
     verification_round = 0;
     verification_pulse_count = 0;
@@ -128,6 +143,10 @@ void AutoTuneController::update() {
             update_priming_phase();
             break;
 
+        case AutoTunePhase::MODEL_FIT:
+            update_model_fit_phase();
+            break;
+
         case AutoTunePhase::BINARY_SEARCH:
             update_binary_search_phase();
             break;
@@ -206,6 +225,160 @@ void AutoTuneController::update_priming_phase() {
     }
 }
 
+void AutoTuneController::update_model_fit_phase() {
+    switch (sub_phase) {
+        case AutoTuneSubPhase::IDLE: {
+            if (fit_pulse_index < GRIND_AUTOTUNE_FIT_PULSE_COUNT) {
+                if (fit_pulse_index == 0) {
+                    log_message("\nModel Fit:");
+                }
+                current_pulse_ms = fit_duration_ms[fit_pulse_index];
+                LOG_BLE("AutoTune Fit pulse %d/%d: %.1fms\n",
+                        fit_pulse_index + 1, GRIND_AUTOTUNE_FIT_PULSE_COUNT, current_pulse_ms);
+                log_message("Test %.0fms", current_pulse_ms);
+
+                pre_pulse_weight = weight_sensor->get_weight_high_latency();
+                start_pulse(current_pulse_ms);
+                break;
+            }
+
+            float boundary_ms = 0.0f;
+            float std_error_ms = 0.0f;
+            float flow_gps = 0.0f;
+            const char* reason = nullptr;
+            if (!fit_pulse_response(&boundary_ms, &std_error_ms, &flow_gps, &reason)) {
+                LOG_BLE("AutoTune: Model fit rejected (%s), falling back to binary search\n", reason);
+                log_message("\nFit failed: %s", reason);
+                switch_phase(AutoTunePhase::BINARY_SEARCH);
+                return;
+            }
+
+            progress.fit_boundary_ms = boundary_ms;
+            progress.fit_std_error_ms = std_error_ms;
+            progress.fit_flow_gps = flow_gps;
+            LOG_BLE("AutoTune: Fit boundary %.1fms +/- %.1fms, flow %.3fg/s\n", boundary_ms, std_error_ms, flow_gps);
+            log_message("\nFit %.0f +/- %.0fms", boundary_ms, std_error_ms);
+            log_message("Flow %.2fg/s", flow_gps);
+
+            // Upper confidence bound, never below a designed pulse that produced nothing
+            float bound_ms = boundary_ms + GRIND_AUTOTUNE_FIT_CONFIDENCE_Z * std_error_ms;
+            for (int i = 0; i < GRIND_AUTOTUNE_FIT_PULSE_COUNT; i++) {
+                if (fit_delta_g[i] <= GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G) {
+                    bound_ms = max(bound_ms, fit_duration_ms[i] + GRIND_AUTOTUNE_TARGET_ACCURACY_MS);
+                }
+            }
+            candidate_ms = constrain(ceil(bound_ms / 10.0f) * 10.0f,
+                                     GRIND_AUTOTUNE_LATENCY_MIN_MS, GRIND_AUTOTUNE_LATENCY_MAX_MS);
+            LOG_BLE("AutoTune: Candidate rounded to %.1fms\n", candidate_ms);
+            log_message("Found %.0fms", candidate_ms);
+
+            // The sweep doubles as a pulse response curve for the active profile
+            if (grind_controller->seed_pulse_table(fit_duration_ms, fit_delta_g, GRIND_AUTOTUNE_FIT_PULSE_COUNT)) {
+                log_message("Pulse curve saved");
+            }
+
+            switch_phase(AutoTunePhase::VERIFICATION);
+            break;
+        }
+
+        case AutoTuneSubPhase::PULSE_EXECUTE:
+            update_pulse_execute();
+            break;
+
+        case AutoTuneSubPhase::MOTOR_SETTLING:
+            update_motor_settling();
+            break;
+
+        case AutoTuneSubPhase::COLLECTION_DELAY:
+            update_collection_delay();
+            break;
+
+        case AutoTuneSubPhase::SCALE_SETTLING:
+            update_scale_settling();
+            break;
+
+        case AutoTuneSubPhase::MEASURE_COMPLETE: {
+            float weight_delta = last_settled_weight - pre_pulse_weight;
+            last_executed_pulse_ms = active_pulse_ms;
+
+            bool pulse_produced_grounds = (weight_delta > GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G);
+            progress.last_pulse_success = pulse_produced_grounds;
+            fit_delta_g[fit_pulse_index] = weight_delta;
+            log_message("  -> %.2fg %s", weight_delta, pulse_produced_grounds ? "[OK]" : "[X]");
+
+            fit_pulse_index++;
+            update_progress();
+            switch_sub_phase(AutoTuneSubPhase::IDLE);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+bool AutoTuneController::fit_pulse_response(float* boundary_ms_out, float* std_error_ms_out, float* flow_gps_out,
+                                            const char** reason_out) const {
+    // Least squares grams = a + b * ms over the pulses that produced grounds; pulses inside the
+    // latency dead zone deliver nothing and would flatten the line, so they are left out
+    int n = 0;
+    float mean_ms = 0.0f;
+    float mean_g = 0.0f;
+    for (int i = 0; i < GRIND_AUTOTUNE_FIT_PULSE_COUNT; i++) {
+        if (fit_delta_g[i] > GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G) {
+            mean_ms += fit_duration_ms[i];
+            mean_g += fit_delta_g[i];
+            n++;
+        }
+    }
+    if (n < GRIND_AUTOTUNE_FIT_MIN_POINTS) {
+        *reason_out = "too few grounds";
+        return false;
+    }
+    mean_ms /= n;
+    mean_g /= n;
+
+    float sxx = 0.0f;
+    float sxy = 0.0f;
+    for (int i = 0; i < GRIND_AUTOTUNE_FIT_PULSE_COUNT; i++) {
+        if (fit_delta_g[i] > GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G) {
+            float dx = fit_duration_ms[i] - mean_ms;
+            sxx += dx * dx;
+            sxy += dx * (fit_delta_g[i] - mean_g);
+        }
+    }
+    float slope = sxx > 0.0f ? sxy / sxx : 0.0f;     // g per ms
+    if (slope <= 0.0f) {
+        *reason_out = "no flow slope";
+        return false;
+    }
+    float intercept = mean_g - slope * mean_ms;
+
+    float ssr = 0.0f;
+    for (int i = 0; i < GRIND_AUTOTUNE_FIT_PULSE_COUNT; i++) {
+        if (fit_delta_g[i] > GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G) {
+            float residual = fit_delta_g[i] - (intercept + slope * fit_duration_ms[i]);
+            ssr += residual * residual;
+        }
+    }
+
+    // Shortest pulse reaching the detection threshold, and its delta-method standard error:
+    // var = sigma^2 / b^2 * (1/n + (mean - boundary)^2 / Sxx)
+    float boundary_ms = (GRIND_AUTOTUNE_WEIGHT_THRESHOLD_G - intercept) / slope;
+    float sigma2 = ssr / (n - 2);
+    float offset_ms = mean_ms - boundary_ms;
+    float std_error_ms = sqrtf(sigma2 / (slope * slope) * (1.0f / n + offset_ms * offset_ms / sxx));
+    if (!isfinite(boundary_ms) || !isfinite(std_error_ms) || std_error_ms > GRIND_AUTOTUNE_FIT_MAX_STD_ERROR_MS) {
+        *reason_out = "scatter too wide";
+        return false;
+    }
+
+    *boundary_ms_out = boundary_ms;
+    *std_error_ms_out = std_error_ms;
+    *flow_gps_out = slope * SYS_MS_PER_SECOND;
+    return true;
+}
+
 void AutoTuneController::update_binary_search_phase() {
     switch (sub_phase) {
         case AutoTuneSubPhase::IDLE:
@@ -502,6 +675,24 @@ void AutoTuneController::update_pulse_execute() {
 
     LOG_BLE("AutoTune: Pulse complete, motor settling\n");
     switch_sub_phase(AutoTuneSubPhase::MOTOR_SETTLING);
+
+    const MotorEdgeTimeline& timeline = grinder->get_edge_timeline();
+    uint32_t pulse_start_us = 0;
+    uint32_t pulse_end_us = 0;
+
+    // Baseline from the samples just before the relay closed, not whenever the
+    // phase happened to start the pulse
+    float baseline_weight = 0.0f;
+    if (timeline.get_latest(MotorEdgeType::PULSE_START, &pulse_start_us) &&
+        weight_sensor->get_weight_before_time_us(pulse_start_us, GRIND_AUTOTUNE_BASELINE_WINDOW_MS, &baseline_weight)) {
+        pre_pulse_weight = baseline_weight;
+    }
+
+    // Settling timers start at the pulse falling edge rather than at this poll
+    if (timeline.get_latest(MotorEdgeType::PULSE_END, &pulse_end_us)) {
+        uint32_t since_edge_ms = ((uint32_t)esp_timer_get_time() - pulse_end_us) / 1000;
+        settling_start_time -= since_edge_ms;
+    }
 }
 
 void AutoTuneController::update_motor_settling() {
@@ -562,10 +753,15 @@ void AutoTuneController::update_tare() {
         return;  // Still taring, return to main loop
     }
 
-    LOG_BLE("AutoTune: Tare complete, starting binary search\n");
     last_settled_weight = 0.0f;
     pre_pulse_weight = 0.0f;
+#if GRIND_AUTOTUNE_MODEL_FIT_ENABLED
+    LOG_BLE("AutoTune: Tare complete, starting model fit sweep\n");
+    switch_phase(AutoTunePhase::MODEL_FIT);
+#else
+    LOG_BLE("AutoTune: Tare complete, starting binary search\n");
     switch_phase(AutoTunePhase::BINARY_SEARCH);
+#endif
 }
 
 //==============================================================================
@@ -685,6 +881,7 @@ const char* AutoTuneController::get_phase_name(AutoTunePhase phase) const {
     switch (phase) {
         case AutoTunePhase::IDLE: return "IDLE";
         case AutoTunePhase::PRIMING: return "PRIMING";
+        case AutoTunePhase::MODEL_FIT: return "MODEL_FIT";
         case AutoTunePhase::BINARY_SEARCH: return "BINARY_SEARCH";
         case AutoTunePhase::VERIFICATION: return "VERIFICATION";
         case AutoTunePhase::COMPLETE_SUCCESS: return "SUCCESS";
@@ -10,6 +10,7 @@
 enum class AutoTunePhase {
     IDLE,                   // Not running
     PRIMING,                // Chute priming phase
+    MODEL_FIT,              // Designed pulse sweep and line fit
     BINARY_SEARCH,          // Binary search phase
     VERIFICATION,           // Statistical verification phase
     COMPLETE_SUCCESS,       // Successfully completed
@@ -47,6 +48,9 @@ struct AutoTuneProgress {
     int verification_success_count;
     float final_latency_ms;
     float previous_latency_ms;
+    float fit_boundary_ms;      // Fitted shortest pulse with grounds (MODEL_FIT)
+    float fit_std_error_ms;     // Its standard error
+    float fit_flow_gps;         // Fitted slope: grams per second of pulse beyond the boundary
 
     // Console message tracking
     char last_message[256];
@@ -75,6 +79,11 @@ private:
     bool found_lower_bound;
     int iteration;
 
+    // Model fit state: one settled delta per designed pulse
+    int fit_pulse_index;
+    float fit_duration_ms[GRIND_AUTOTUNE_FIT_PULSE_COUNT];
+    float fit_delta_g[GRIND_AUTOTUNE_FIT_PULSE_COUNT];
+
     // Verification state
     int verification_round;
     int verification_pulse_count;
@@ -116,6 +125,7 @@ public:
 private:
     // Phase state machines (non-blocking)
     void update_priming_phase();
+    void update_model_fit_phase();
     void update_binary_search_phase();
     void update_verification_phase();
 
@@ -126,6 +136,8 @@ private:
     void update_collection_delay();
     void update_scale_settling();
     void process_measurement_result(float weight_delta);
+    // Line fit over the sweep; false (with a reason) if it cannot be trusted
+    bool fit_pulse_response(float* boundary_ms_out, float* std_error_ms_out, float* flow_gps_out, const char** reason_out) const;
 
     // Tare handling
     void start_tare();
@@ -0,0 +1,36 @@
+#include "bulk_grind_strategy.h"
+
+#include "grind_controller.h"
+#include "../hardware/grinder.h"
+
+void BulkGrindStrategy::on_enter(const GrindSessionDescriptor& session,
+                                 GrindStrategyContext& context,
+                                 const GrindLoopData& loop_data) {
+    BulkApproachStrategy::on_enter(session, context, loop_data);
+    approach_logged = false;
+}
+
+bool BulkGrindStrategy::update(const GrindSessionDescriptor& session,
+                               GrindStrategyContext& context,
+                               const GrindLoopData& loop_data) {
+    auto* controller = context.controller;
+    if (!controller) {
+        return false;
+    }
+
+    if (controller->phase == GrindPhase::PREDICTIVE && controller->grinder && !controller->grinder->has_scheduled_stop()) {
+        float weight = loop_data.estimate_valid ? loop_data.estimated_weight : loop_data.current_weight;
+        float approach_weight = controller->get_stop_target_weight() - GRIND_BULK_APPROACH_G;
+        if (weight < approach_weight) {
+            // The bulk of the run: nothing to decide but the flow start (latency) until the approach
+            confirm_flow_start(*controller, loop_data);
+            return true;
+        }
+        if (!approach_logged) {
+            approach_logged = true;
+            controller->queue_log_message("--- BULK APPROACH at %.1fg (stop target %.1fg), flow %.2fg/s ---\n",
+                                          weight, controller->get_stop_target_weight(), loop_data.flow_rate);
+        }
+    }
+    return BulkApproachStrategy::update(session, context, loop_data);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "predictive_model_grind_strategy.h"
+#include "../config/constants.h"
+
+#if GRIND_PREDICTIVE_MODEL_ENABLED
+using BulkApproachStrategy = PredictiveModelGrindStrategy;
+#else
+using BulkApproachStrategy = WeightGrindStrategy;
+#endif
+
+// Bulk mode: weight targets from GRIND_BULK_MIN_TARGET_G (batch brew, hundreds
+// of grams). The motor runs at full speed without stop projection until the
+// final GRIND_BULK_APPROACH_G, where the weight mode's own predictive stop and
+// pulse phases take over. The session carries the bulk timeout, tolerance and
+// pulse limit (GrindSessionDescriptor); an empty hopper ends the run through the
+// controller's flow stall check, and its measurement rows stream to flash.
+class BulkGrindStrategy : public BulkApproachStrategy {
+public:
+    BulkGrindStrategy() = default;
+
+    void on_enter(const GrindSessionDescriptor& session,
+                  GrindStrategyContext& context,
+                  const GrindLoopData& loop_data) override;
+
+    bool update(const GrindSessionDescriptor& session,
+                GrindStrategyContext& context,
+                const GrindLoopData& loop_data) override;
+
+    const char* name() const override { return "Bulk"; }
+
+private:
+    bool approach_logged = false;
+};
@@ -0,0 +1,155 @@
+#include "coast_model.h"
+#include <math.h>
+
+namespace {
+// Prior: no offset, the fixed-ratio coast of the default motor latency
+constexpr float PRIOR_OFFSET_G = 0.0f;
+constexpr float PRIOR_SECONDS = GRIND_LATENCY_TO_COAST_RATIO * GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS / (float)SYS_MS_PER_SECOND;
+constexpr float PRIOR_OFFSET_VARIANCE = 0.25f;      // (0.5 g)^2
+constexpr float PRIOR_SECONDS_VARIANCE = 0.04f;     // (200 ms)^2
+constexpr float OBSERVATION_VARIANCE = 0.0025f;     // (50 mg)^2 session-to-session coast scatter
+}
+
+void CoastModel::initial_state(CoastModelState* state) {
+    memset(state, 0, sizeof(*state));
+    state->version = STATE_VERSION;
+    state->theta[0] = PRIOR_OFFSET_G;
+    state->theta[1] = PRIOR_SECONDS;
+    state->covariance[0] = PRIOR_OFFSET_VARIANCE;
+    state->covariance[1] = 0.0f;
+    state->covariance[2] = PRIOR_SECONDS_VARIANCE;
+}
+
+void CoastModel::make_key(uint8_t profile_id, char* key, size_t key_size) {
+    snprintf(key, key_size, "coast_m%u", (unsigned)profile_id);
+}
+
+void CoastModel::load(Preferences* preferences) {
+    for (uint8_t i = 0; i < USER_PROFILE_COUNT; i++) {
+        initial_state(&states[i]);
+        if (!preferences) {
+            continue;
+        }
+
+        char key[16];
+        make_key(i, key, sizeof(key));
+        CoastModelState stored;
+        if (preferences->getBytesLength(key) == sizeof(stored) &&
+            preferences->getBytes(key, &stored, sizeof(stored)) == sizeof(stored) &&
+            stored.version == STATE_VERSION && isfinite(stored.theta[0]) && isfinite(stored.theta[1])) {
+            states[i] = stored;
+            LOG_BLE("Coast model %u: %.2fg + %.0fms x flow (%u sessions)\n", (unsigned)i,
+                    stored.theta[0], stored.theta[1] * 1000.0f, (unsigned)stored.session_count);
+        }
+    }
+}
+
+bool CoastModel::predict(uint8_t profile_id, float flow_rate, float* coast_g_out) const {
+    float offset_g;
+    float seconds;
+    if (!get_coefficients(profile_id, &offset_g, &seconds)) {
+        return false;
+    }
+    *coast_g_out = max(0.0f, offset_g + seconds * flow_rate);
+    return true;
+}
+
+bool CoastModel::get_coefficients(uint8_t profile_id, float* offset_g_out, float* seconds_out) const {
+    if (profile_id >= USER_PROFILE_COUNT || !is_trusted(states[profile_id])) {
+        return false;
+    }
+    *offset_g_out = states[profile_id].theta[0];
+    *seconds_out = states[profile_id].theta[1];
+    return true;
+}
+
+bool CoastModel::observe(uint8_t profile_id, float flow_rate, float coast_g) {
+    if (profile_id >= USER_PROFILE_COUNT) {
+        return false;
+    }
+    if (flow_rate < GRIND_FLOW_DETECTION_THRESHOLD_GPS || flow_rate > 2.0f * GRIND_FLOW_RATE_MAX_SANE_GPS ||
+        coast_g < -GRIND_COAST_MODEL_MAX_COAST_G || coast_g > GRIND_COAST_MODEL_MAX_COAST_G) {
+        return false;
+    }
+
+    // RLS with forgetting on x = [1, flow], P in absolute units (R = observation variance):
+    // k = P x / (lambda R + x'P x), theta += k (y - x'theta), P = (P - k x'P) / lambda
+    CoastModelState& state = states[profile_id];
+    const float lambda = GRIND_COAST_MODEL_FORGETTING;
+    float p00 = state.covariance[0];
+    float p01 = state.covariance[1];
+    float p11 = state.covariance[2];
+
+    float px0 = p00 + p01 * flow_rate;
+    float px1 = p01 + p11 * flow_rate;
+    float denominator = lambda * OBSERVATION_VARIANCE + px0 + px1 * flow_rate;
+    if (denominator <= 0.0f) {
+        return false;
+    }
+    float k0 = px0 / denominator;
+    float k1 = px1 / denominator;
+
+    float error = coast_g - (state.theta[0] + state.theta[1] * flow_rate);
+    if (state.session_count >= GRIND_COAST_MODEL_MIN_SESSIONS) {
+        float innovation_variance = OBSERVATION_VARIANCE + px0 + px1 * flow_rate;
+        float gate = GRIND_COAST_MODEL_OUTLIER_SIGMAS * GRIND_COAST_MODEL_OUTLIER_SIGMAS * innovation_variance;
+        if (error * error > gate && ++state.outlier_run < GRIND_COAST_MODEL_OUTLIER_RUN) {
+            return false;
+        }
+    }
+    state.outlier_run = 0;
+    state.theta[0] += k0 * error;
+    state.theta[1] += k1 * error;
+
+    p00 = (p00 - k0 * px0) / lambda;
+    p01 = (p01 - k0 * px1) / lambda;
+    p11 = (p11 - k1 * px1) / lambda;
+
+    // Flow barely varies between sessions, so forgetting inflates P along the
+    // unexcited direction; scale it back once its trace exceeds the prior's
+    const float prior_trace = PRIOR_OFFSET_VARIANCE + PRIOR_SECONDS_VARIANCE;
+    float trace = p00 + p11;
+    if (trace > prior_trace) {
+        float scale = prior_trace / trace;
+        p00 *= scale;
+        p01 *= scale;
+        p11 *= scale;
+    }
+
+    state.covariance[0] = p00;
+    state.covariance[1] = p01;
+    state.covariance[2] = p11;
+    if (state.session_count < UINT16_MAX) {
+        state.session_count++;
+    }
+    return true;
+}
+
+bool CoastModel::get_state(uint8_t profile_id, CoastModelState* state_out) const {
+    if (profile_id >= USER_PROFILE_COUNT) {
+        return false;
+    }
+    *state_out = states[profile_id];
+    return true;
+}
+
+bool CoastModel::set_state(uint8_t profile_id, const CoastModelState& state) {
+    if (profile_id >= USER_PROFILE_COUNT) {
+        return false;
+    }
+    if (state.version != STATE_VERSION || !isfinite(state.theta[0]) || !isfinite(state.theta[1])) {
+        initial_state(&states[profile_id]);
+        return false;
+    }
+    states[profile_id] = state;
+    return true;
+}
+
+bool CoastModel::save_state(Preferences* preferences, uint8_t profile_id, const CoastModelState& state) {
+    if (!preferences || profile_id >= USER_PROFILE_COUNT) {
+        return false;
+    }
+    char key[16];
+    make_key(profile_id, key, sizeof(key));
+    return preferences->putBytes(key, &state, sizeof(state)) == sizeof(state);
+}
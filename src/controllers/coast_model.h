@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "../config/constants.h"
+
+#pragma pack(push, 1)
+// Persisted per profile (NVS blob "coast_m<profile>")
+struct CoastModelState {
+    uint8_t  version;
+    uint8_t  outlier_run;       // Consecutive observations the trusted fit dropped (was reserved, 0)
+    uint16_t session_count;     // Sessions folded into the fit
+    float    theta[2];          // coast_g = theta[0] + theta[1] * flow_gps
+    float    covariance[3];     // P00, P01, P11
+};
+#pragma pack(pop)
+
+static_assert(sizeof(CoastModelState) == 24, "Unexpected CoastModelState size");
+
+/**
+ * CoastModel - Learned motor-off-to-settle response per profile
+ *
+ * Coast is the weight that still lands after the predictive stop: settled
+ * weight at the first pulse decision minus predictive_end_weight (the weight
+ * the stop rule compared against the target). It is fitted per profile as an
+ * affine function of the flow at the stop, coast_g = offset + seconds * flow,
+ * by recursive least squares with forgetting, so bean and grind changes are
+ * tracked over a few sessions. The fit starts from the latency-ratio guess
+ * and is only used once GRIND_COAST_MODEL_MIN_SESSIONS have been observed.
+ * A trusted fit drops an observation more than GRIND_COAST_MODEL_OUTLIER_SIGMAS
+ * innovation sigmas off (a bumped cup, a clump); GRIND_COAST_MODEL_OUTLIER_RUN
+ * of them in a row are a real change and are folded in.
+ *
+ * Core 0 owns the model (predict/observe); persistence copies a state out and
+ * Core 1 writes it with save_state().
+ */
+class CoastModel {
+public:
+    void load(Preferences* preferences);
+
+    // Coast grams at this flow; false until the profile's fit is trusted
+    bool predict(uint8_t profile_id, float flow_rate, float* coast_g_out) const;
+    bool get_coefficients(uint8_t profile_id, float* offset_g_out, float* seconds_out) const;
+
+    // Fold one session in; false (model unchanged) for implausible observations
+    bool observe(uint8_t profile_id, float flow_rate, float coast_g);
+    bool get_state(uint8_t profile_id, CoastModelState* state_out) const;
+    // Replace a profile's fit (recalled from the profile store); false resets it to the prior
+    bool set_state(uint8_t profile_id, const CoastModelState& state);
+
+    static bool save_state(Preferences* preferences, uint8_t profile_id, const CoastModelState& state);
+
+private:
+    static const uint8_t STATE_VERSION = 1;
+
+    CoastModelState states[USER_PROFILE_COUNT];
+
+    static void initial_state(CoastModelState* state);
+    static bool is_trusted(const CoastModelState& state) {
+        return state.session_count >= GRIND_COAST_MODEL_MIN_SESSIONS;
+    }
+    static void make_key(uint8_t profile_id, char* key, size_t key_size);
+};
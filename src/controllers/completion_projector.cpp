@@ -0,0 +1,44 @@
+#include "completion_projector.h"
+#include <math.h>
+
+void CompletionProjector::reset() {
+    stats_valid = false;
+    late_since_ms = 0;
+    projected_ms = 0;
+    last_update_ms = 0;
+    mean_flow = 0.0f;
+}
+
+bool CompletionProjector::update(uint32_t now_ms, uint32_t elapsed_ms, uint32_t timeout_ms, float remaining_g,
+                                 float flow_rate) {
+    if (isfinite(flow_rate)) {
+        if (!stats_valid) {
+            mean_flow = max(flow_rate, 0.0f);
+            stats_valid = true;
+        } else {
+            float alpha = 1.0f - expf(-(float)(now_ms - last_update_ms) / GRIND_PROJECTION_FLOW_TAU_MS);
+            mean_flow += alpha * (max(flow_rate, 0.0f) - mean_flow);
+        }
+        last_update_ms = now_ms;
+    }
+    if (!stats_valid || !isfinite(remaining_g) || remaining_g <= GRIND_PROJECTION_MIN_REMAINING_G) {
+        late_since_ms = 0;
+        return false;
+    }
+
+    if (mean_flow < GRIND_PROJECTION_MIN_FLOW_GPS) {
+        projected_ms = UINT32_MAX;
+    } else {
+        float projected = (float)elapsed_ms + remaining_g / mean_flow * 1000.0f;
+        projected_ms = projected >= (float)UINT32_MAX ? UINT32_MAX : (uint32_t)projected;
+    }
+
+    if (projected_ms <= timeout_ms) {
+        late_since_ms = 0;
+        return false;
+    }
+    if (late_since_ms == 0) {
+        late_since_ms = now_ms ? now_ms : 1;
+    }
+    return now_ms - late_since_ms >= GRIND_PROJECTION_HOLD_MS;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/constants.h"
+
+/**
+ * CompletionProjector - Can the PREDICTIVE run still reach the target in time?
+ *
+ * Fed every control loop pass while the motor runs continuously and flow is
+ * confirmed. Passes come every 20 ms, 5 ms in high-rate phases or per sample in
+ * critical ones, so the flow rate is smoothed over time, not updates: each weighs in with
+ * 1 - exp(-dt / GRIND_PROJECTION_FLOW_TAU_MS). It projects
+ * the session time at which the remaining mass would be in the cup:
+ *
+ *   elapsed + remaining_g / flow
+ *
+ * The projection is optimistic on purpose (no coast, settling or pulse time),
+ * so it only fires when even a clean finish cannot fit. Flow below
+ * GRIND_PROJECTION_MIN_FLOW_GPS projects to never. A projection past the
+ * session timeout held for GRIND_PROJECTION_HOLD_MS reports the session as
+ * unfinishable - a grind trickling to a stop ends there instead of running
+ * into GRIND_TIMEOUT_SEC. Nothing is judged with GRIND_PROJECTION_MIN_REMAINING_G
+ * or less to go; the pulse phases take over from there.
+ */
+class CompletionProjector {
+public:
+    void reset();
+
+    // True once completion has projected past timeout_ms for the hold time
+    bool update(uint32_t now_ms, uint32_t elapsed_ms, uint32_t timeout_ms, float remaining_g, float flow_rate);
+
+    float get_flow_rate() const { return mean_flow; }
+    uint32_t get_projected_ms() const { return projected_ms; }     // UINT32_MAX = flow too low to finish
+
+private:
+    bool stats_valid = false;
+    uint32_t late_since_ms = 0;     // 0 = projection within the timeout (now_ms 0 is nudged to 1)
+    uint32_t projected_ms = 0;
+    uint32_t last_update_ms = 0;
+    float mean_flow = 0.0f;
+};
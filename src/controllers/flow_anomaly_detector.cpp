@@ -0,0 +1,72 @@
+#include "flow_anomaly_detector.h"
+#include <math.h>
+
+void FlowAnomalyDetector::reset() {
+    started = false;
+    stats_valid = false;
+    start_ms = 0;
+    collapse_since_ms = 0;
+    unstable_since_ms = 0;
+    mechanical_baseline = 0;
+    mean_flow = 0.0f;
+    variance_flow = 0.0f;
+    peak_flow = 0.0f;
+}
+
+bool FlowAnomalyDetector::held_for(bool condition, uint32_t now_ms, uint32_t* since_ms, uint32_t hold_ms) {
+    if (!condition) {
+        *since_ms = 0;
+        return false;
+    }
+    if (*since_ms == 0) {
+        *since_ms = now_ms ? now_ms : 1;
+    }
+    return now_ms - *since_ms >= hold_ms;
+}
+
+FlowAnomaly FlowAnomalyDetector::update(uint32_t now_ms, float flow_rate, bool flow_confirmed, float motor_duty,
+                                        int mechanical_anomaly_count) {
+    if (!started) {
+        started = true;
+        start_ms = now_ms;
+        mechanical_baseline = mechanical_anomaly_count;
+    }
+
+    if (mechanical_anomaly_count - mechanical_baseline >= GRIND_MECHANICAL_EVENT_REQUIRED_COUNT) {
+        return FlowAnomaly::UNSTABLE;
+    }
+
+    if (!flow_confirmed) {
+        return (now_ms - start_ms >= GRIND_FLOW_ANOMALY_NO_FLOW_MS) ? FlowAnomaly::STALLED : FlowAnomaly::NONE;
+    }
+    if (!isfinite(flow_rate)) {
+        return FlowAnomaly::NONE;
+    }
+
+    if (!stats_valid) {
+        mean_flow = flow_rate;
+        variance_flow = 0.0f;
+        stats_valid = true;
+    } else {
+        // EW mean/variance (West's incremental form)
+        const float alpha = GRIND_FLOW_ANOMALY_EWMA_ALPHA;
+        float diff = flow_rate - mean_flow;
+        mean_flow += alpha * diff;
+        variance_flow = (1.0f - alpha) * (variance_flow + alpha * diff * diff);
+    }
+    peak_flow = max(peak_flow, mean_flow);
+
+    // Soft stop lowers the flow on purpose; compare against the peak at the commanded duty
+    float expected_flow = peak_flow * constrain(motor_duty, 0.0f, 1.0f);
+    bool collapsed = peak_flow >= GRIND_FLOW_DETECTION_THRESHOLD_GPS &&
+                     mean_flow < GRIND_FLOW_ANOMALY_COLLAPSE_RATIO * expected_flow;
+    if (held_for(collapsed, now_ms, &collapse_since_ms, GRIND_FLOW_ANOMALY_COLLAPSE_MS)) {
+        return FlowAnomaly::STALLED;
+    }
+
+    float cv = sqrtf(variance_flow) / max(mean_flow, GRIND_FLOW_DETECTION_THRESHOLD_GPS);
+    if (held_for(cv > GRIND_FLOW_ANOMALY_CV_LIMIT, now_ms, &unstable_since_ms, GRIND_FLOW_ANOMALY_UNSTABLE_MS)) {
+        return FlowAnomaly::UNSTABLE;
+    }
+    return FlowAnomaly::NONE;
+}
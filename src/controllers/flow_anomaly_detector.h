@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/constants.h"
+
+enum class FlowAnomaly : uint8_t {
+    NONE,
+    STALLED,    // Motor on, flow never started or collapsed (empty hopper, clog)
+    UNSTABLE    // Sustained flow scatter (popcorning) or repeated weight drops (cup bumps)
+};
+
+/**
+ * FlowAnomalyDetector - Online flow checks for the PREDICTIVE phase
+ *
+ * Fed once per control tick while the motor runs continuously. Keeps an
+ * exponentially weighted mean and variance of the flow rate and its peak
+ * smoothed value, and reports an anomaly once a condition has held for its
+ * GRIND_FLOW_ANOMALY_* window, so a failed grind ends within about a second
+ * instead of running into GRIND_TIMEOUT_SEC:
+ * - no flow confirmed GRIND_FLOW_ANOMALY_NO_FLOW_MS after the start
+ * - smoothed flow below GRIND_FLOW_ANOMALY_COLLAPSE_RATIO of its peak (scaled
+ *   by the motor duty) for GRIND_FLOW_ANOMALY_COLLAPSE_MS
+ * - flow coefficient of variation above GRIND_FLOW_ANOMALY_CV_LIMIT for
+ *   GRIND_FLOW_ANOMALY_UNSTABLE_MS
+ * - GRIND_MECHANICAL_EVENT_REQUIRED_COUNT mechanical drop events (negative
+ *   flow) since the phase started
+ */
+class FlowAnomalyDetector {
+public:
+    void reset();
+
+    FlowAnomaly update(uint32_t now_ms, float flow_rate, bool flow_confirmed, float motor_duty,
+                       int mechanical_anomaly_count);
+
+    float get_mean_flow_rate() const { return mean_flow; }
+    float get_peak_flow_rate() const { return peak_flow; }
+
+private:
+    bool started = false;
+    bool stats_valid = false;
+    uint32_t start_ms = 0;
+    uint32_t collapse_since_ms = 0;
+    uint32_t unstable_since_ms = 0;
+    int mechanical_baseline = 0;
+    float mean_flow = 0.0f;
+    float variance_flow = 0.0f;
+    float peak_flow = 0.0f;
+
+    // Start of a condition's hold time; 0 = not holding (now_ms 0 is nudged to 1)
+    static bool held_for(bool condition, uint32_t now_ms, uint32_t* since_ms, uint32_t hold_ms);
+};
@@ -0,0 +1,72 @@
+#include "grind_channels.h"
+#include "grind_controller.h"
+#include "../config/logging.h"
+
+GrindChannels grind_channels;
+
+bool GrindChannels::add(GrindController* controller, WeightSensor* sensor, Grinder* grinder) {
+    if (channel_count >= HW_GRINDER_CHANNELS || !controller) {
+        return false;
+    }
+    channels[channel_count] = {controller, sensor, grinder};
+    channel_count++;
+    return true;
+}
+
+GrindController* GrindChannels::get_controller(uint8_t channel) const {
+    return channel < channel_count ? channels[channel].controller : nullptr;
+}
+
+WeightSensor* GrindChannels::get_weight_sensor(uint8_t channel) const {
+    return channel < channel_count ? channels[channel].sensor : nullptr;
+}
+
+Grinder* GrindChannels::get_grinder(uint8_t channel) const {
+    return channel < channel_count ? channels[channel].grinder : nullptr;
+}
+
+bool GrindChannels::select(uint8_t channel) {
+    if (channel >= channel_count) {
+        return false;
+    }
+    if (channel == selected.load()) {
+        return true;
+    }
+    selected.store(channel);
+    LOG_BLE("Grinder %u selected\n", (unsigned)channel + 1);
+    return true;
+}
+
+bool GrindChannels::any_active() const {
+    for (uint8_t i = 0; i < channel_count; i++) {
+        if (channels[i].controller->is_active()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t GrindChannels::get_control_interval_ms() const {
+    uint32_t interval_ms = SYS_TASK_GRIND_CONTROL_INTERVAL_MS;
+    for (uint8_t i = 0; i < channel_count; i++) {
+        interval_ms = min(interval_ms, channels[i].controller->get_control_interval_ms());
+    }
+    return interval_ms;
+}
+
+bool GrindChannels::is_sample_driven() const {
+    for (uint8_t i = 0; i < channel_count; i++) {
+        if (channels[i].controller->is_sample_driven()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GrindChannels::fail_safe_stop(const char* error_message) {
+    bool stopped = false;
+    for (uint8_t i = 0; i < channel_count; i++) {
+        stopped |= channels[i].controller->fail_safe_stop(error_message);
+    }
+    return stopped;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "../config/constants.h"
+
+class GrindController;
+class WeightSensor;
+class Grinder;
+
+/**
+ * GrindChannels - The grinders one board drives (HW_GRINDER_CHANNELS)
+ *
+ * Each channel is a grinder with a scale of its own: a WeightSensor (ADC
+ * driver and sample ring), a Grinder, and a GrindController whose learned
+ * models and calibration live in the channel's own preferences. Channel 0 is
+ * HardwareManager's original set; the others sit alongside it.
+ *
+ * WeightSamplingTask feeds every channel's sensor in one pass and
+ * GrindControlTask updates every controller each cycle, so the grinders run
+ * independently and at the same time. Each channel has its own GrindLogger
+ * recording, Telemetry, StatisticsManager and UI snapshot slot; sessions are
+ * tagged with their channel (GrindSession::grinder_channel). The screens
+ * follow the selected channel, which may change while any grinder runs;
+ * UIManager looks after the grinders that are not on screen.
+ *
+ * add() during setup only; get_selected() from any task.
+ */
+class GrindChannels {
+public:
+    bool add(GrindController* controller, WeightSensor* sensor, Grinder* grinder);
+    uint8_t count() const { return channel_count; }
+
+    GrindController* get_controller(uint8_t channel) const;
+    WeightSensor* get_weight_sensor(uint8_t channel) const;
+    Grinder* get_grinder(uint8_t channel) const;
+
+    uint8_t get_selected() const { return selected.load(); }
+    GrindController* get_selected_controller() const { return get_controller(get_selected()); }
+    bool select(uint8_t channel);               // UI task, false for a channel that does not exist
+
+    bool any_active() const;
+    uint32_t get_control_interval_ms() const;   // Shortest interval any channel asks for
+    bool is_sample_driven() const;              // Any channel waits on the next sample
+    bool fail_safe_stop(const char* error_message);   // Every running session; true if any stopped
+
+private:
+    struct Channel {
+        GrindController* controller;
+        WeightSensor* sensor;
+        Grinder* grinder;
+    };
+
+    Channel channels[HW_GRINDER_CHANNELS] = {};
+    uint8_t channel_count = 0;
+    std::atomic<uint8_t> selected{0};
+};
+
+extern GrindChannels grind_channels;
@@ -1,38 +1,84 @@
 #include "grind_controller.h"
+#include "grind_phase_table.h"
 #include "grind_events.h"
 #include "../hardware/circular_buffer_math/circular_buffer_math.h"
 #include "../config/constants.h"
 #include "../system/diagnostics_controller.h"
 #include "../system/statistics_manager.h"
+#include "../system/config_store.h"
+#include "../system/telemetry.h"
+#include "../system/grind_loop_profiler.h"
+#include "../system/ui_snapshot.h"
 #include <Arduino.h>
+#include <esp_timer.h>
 #include <cstdarg>
 #include <cstring>
 
 #if defined(DEBUG_ENABLE_LOADCELL_MOCK) && (DEBUG_ENABLE_LOADCELL_MOCK != 0)
 #include "../hardware/mock_hx711_driver.h"
 #endif
+#if DEBUG_ENABLE_LOADCELL_HIL
+#include "../hardware/adc_stream_load_cell_driver.h"
+#endif
 
-// UI event queue size
+// UI event queue size (discrete events only; progress goes through the mailbox)
 #define UI_EVENT_QUEUE_SIZE 10
 
+namespace {
+struct QueuedUIEvent {
+    uint32_t sequence;          // Orders the event against the progress mailbox
+    GrindEventData data;
+};
+
+const char* ui_event_name(UIGrindEvent event) {
+    switch (event) {
+        case UIGrindEvent::PHASE_CHANGED: return "PHASE_CHANGED";
+        case UIGrindEvent::PROGRESS_UPDATED: return "PROGRESS_UPDATED";
+        case UIGrindEvent::COMPLETED: return "COMPLETED";
+        case UIGrindEvent::TIMEOUT: return "TIMEOUT";
+        case UIGrindEvent::STOPPED: return "STOPPED";
+        case UIGrindEvent::BACKGROUND_CHANGE: return "BACKGROUND_CHANGE";
+        case UIGrindEvent::PULSE_AVAILABLE: return "PULSE_AVAILABLE";
+        case UIGrindEvent::PULSE_STARTED: return "PULSE_STARTED";
+        case UIGrindEvent::PULSE_COMPLETED: return "PULSE_COMPLETED";
+    }
+    return "UNKNOWN";
+}
+} // namespace
+
 // Flash operation queue size
 #define FLASH_OP_QUEUE_SIZE 5
 
 static constexpr float NO_WEIGHT_DELIVERED_THRESHOLD_G = 0.2f;
 
-void GrindController::init(WeightSensor* lc, Grinder* gr, Preferences* prefs) {
+void GrindController::init(WeightSensor* lc, Grinder* gr, Preferences* prefs, uint8_t channel, ConfigStore* store) {
     weight_sensor = lc;
     grinder = gr;
     preferences = prefs;
+    grinder_channel = channel;
+    config = store ? store : &config_store;
     phase = GrindPhase::IDLE;
+    channel_telemetry(grinder_channel).set_phase((uint8_t)phase);
     tolerance = GRIND_ACCURACY_TOLERANCE_G;
     current_profile_id = 0;
     force_measurement_log = false;
+    last_logged_motor_is_on = 0;
+    next_report_ms = 0;
     target_time_ms = 0;
     time_grind_start_ms = 0;
     mode = GrindMode::WEIGHT;
     prime_enabled_for_session = false;
+    batch_total = 0;
+    batch_completed = 0;
+    batch_start_ms = 0;
     last_error_message[0] = '\0';
+    display_weight = 0.0f;
+    tick_snapshot_valid = false;
+    warm_start_flow_gps = 0.0f;
+    warm_start_latency_ms = 0.0f;
+    flow_windows = {GRIND_FLOW_DETECTION_WINDOW_MS, GRIND_FLOW_PREDICTION_WINDOW_MS, GRIND_PULSE_FLOW_WINDOW_MS};
+    flow_fit_sum = 0.0f;
+    flow_fit_count = 0;
 
     mechanical_anomaly_count_ = 0;
     last_mechanical_event_ms_ = 0;
@@ -54,10 +100,14 @@ void GrindController::init(WeightSensor* lc, Grinder* gr, Preferences* prefs) {
 #endif
     }
     
-    // Initialize the grind logger
-    if (!grind_logger.init(preferences)) {
-        LOG_BLE("Warning: Grind logging disabled due to initialization failure\n");
+    // Initialize the grind logger; it is shared, so the first grinder brings up every channel's recording
+    if (grinder_channel == 0) {
+        if (!grind_logger.init(preferences)) {
+            LOG_BLE("Warning: Grind logging disabled due to initialization failure\n");
+        }
     }
+    grind_logger.set_adc_capture_sources(grinder_channel, lc ? lc->get_recording_source() : nullptr,
+                                         gr ? &gr->get_edge_timeline() : nullptr);
     
     // RealtimeController removed - functionality moved to FreeRTOS WeightSamplingTask and GrindControlTask
     
@@ -66,7 +116,8 @@ void GrindController::init(WeightSensor* lc, Grinder* gr, Preferences* prefs) {
     ui_ready_for_setup = false;
     
     // Initialize thread-safe UI event queue
-    ui_event_queue = xQueueCreate(UI_EVENT_QUEUE_SIZE, sizeof(GrindEventData));
+    ui_progress_lock = portMUX_INITIALIZER_UNLOCKED;
+    ui_event_queue = xQueueCreate(UI_EVENT_QUEUE_SIZE, sizeof(QueuedUIEvent));
     if (!ui_event_queue) {
         LOG_BLE("ERROR: Failed to create UI event queue\n");
     } else {
@@ -81,19 +132,14 @@ void GrindController::init(WeightSensor* lc, Grinder* gr, Preferences* prefs) {
         LOG_BLE("Flash operation queue created successfully\n");
     }
     
-    // Initialize thread-safe log message queue
-    log_queue = xQueueCreate(LOG_QUEUE_SIZE, sizeof(LogMessage));
-    if (!log_queue) {
-        LOG_BLE("ERROR: Failed to create log message queue\n");
-    } else {
-        LOG_BLE("Log message queue created successfully\n");
-    }
-
     strategy_context.controller = this;
     active_strategy = nullptr;
 
     // Load motor response latency from preferences
     load_motor_latency();
+    coast_model.load(preferences);
+    retention_model.load(preferences);
+    pulse_table.load(preferences);
 }
 
 void GrindController::start_grind(float target, uint32_t time_ms, GrindMode grind_mode) {
@@ -110,10 +156,22 @@ void GrindController::start_grind(float target, uint32_t time_ms, GrindMode grin
     target_time_ms = time_ms;
     mode = grind_mode;
     prime_enabled_for_session = false;
-    if (mode == GrindMode::WEIGHT && preferences) {
-        prime_enabled_for_session = preferences->getBool(PREF_KEY_PRIME_ENABLED, false);
+    // Later doses of a batch find the chute already primed by the first
+    if (mode == GrindMode::WEIGHT && batch_completed == 0) {
+        prime_enabled_for_session = config_store.get_flag(ConfigFlag::PRIME);
     }
+    begin_retention_session();
+    grind_loop_profiler.begin_session();
+    SessionTrend eta_trend;
+    bool has_eta_trend = mode == GrindMode::WEIGHT &&
+        grind_logger.get_session_summaries().get_trend(GRIND_ETA_TREND_SESSIONS, static_cast<int>(GrindMode::WEIGHT), &eta_trend,
+                                                       -1, grinder_channel);
+    eta_predictor.plan(mode, get_stop_target_weight(), target_time_ms, has_eta_trend ? &eta_trend : nullptr);
     start_time = millis();
+    session_start_us = (uint32_t)esp_timer_get_time();
+#if DEBUG_ENABLE_LOADCELL_HIL
+    AdcStreamLoadCellDriver::notify_session_start(session_start_us);
+#endif
     pulse_attempts = 0;
     timeout_phase = GrindPhase::IDLE; // Initialize timeout phase
     // Load cell now runs at constant high speed - no mode switching needed
@@ -121,12 +179,25 @@ void GrindController::start_grind(float target, uint32_t time_ms, GrindMode grin
     
     grind_latency_ms = 0;
     predictive_end_weight = 0;
+    predictive_stop_flow_rate = 0;
+    coast_observation_valid = false;
+    coast_observation_g = 0.0f;
     final_weight = 0;
     motor_stop_target_weight = GRIND_UNDERSHOOT_TARGET_G; // Start with a safe default
+    seed_warm_start();
 
     time_grind_start_ms = 0;
+    time_stop_flow_rate = 0.0f;
+    time_implied_weight = 0.0f;
+    time_calibrated_ms = 0;
 
     flow_start_confirmed = false;
+    flow_windows = weight_sensor->get_flow_windows();
+    flow_fit_sum = 0.0f;
+    flow_fit_count = 0;
+    LOG_BLE("[CONTROLLER] Flow windows: detection %lums, prediction %lums, pulse flow %lums (threshold %.2fg/s)\n",
+            (unsigned long)flow_windows.detection_ms, (unsigned long)flow_windows.prediction_ms,
+            (unsigned long)flow_windows.pulse_flow_ms, weight_sensor->get_flow_detection_threshold_gps());
 
     // Initialize dynamic pulse algorithm variables
     pulse_flow_rate = 0.0f;
@@ -138,6 +209,8 @@ void GrindController::start_grind(float target, uint32_t time_ms, GrindMode grin
     last_logged_weight = 0.0f;
     last_logged_time = millis();
     force_measurement_log = false;
+    last_logged_motor_is_on = 0;
+    next_report_ms = millis();
 
     // Reset UI acknowledgment flag for new grind
     ui_ready_for_setup = false;
@@ -146,12 +219,26 @@ void GrindController::start_grind(float target, uint32_t time_ms, GrindMode grin
     session_end_flash_queued = false;
 
     last_error_message[0] = '\0';
+    timeout_result = "TIMEOUT";
+    flow_anomaly_detector.reset();
+    completion_projector.reset();
+
+    // Bulk targets get their own limits; the learned models stay per profile
+    const bool bulk = GRIND_BULK_ENABLED && mode == GrindMode::WEIGHT && target_weight >= GRIND_BULK_MIN_TARGET_G;
+    tolerance = bulk ? GRIND_BULK_TOLERANCE_G : GRIND_ACCURACY_TOLERANCE_G;
 
     session_descriptor.mode = mode;
     session_descriptor.target_weight = target_weight;
     session_descriptor.target_time_ms = target_time_ms;
     session_descriptor.tolerance = tolerance;
     session_descriptor.profile_id = current_profile_id;
+    session_descriptor.start_us = session_start_us;
+    session_descriptor.bulk = bulk;
+    session_descriptor.timeout_ms = (bulk ? GRIND_BULK_TIMEOUT_SEC : GRIND_TIMEOUT_SEC) * 1000;
+    session_descriptor.max_pulse_attempts = bulk ? GRIND_BULK_MAX_PULSE_ATTEMPTS : GRIND_MAX_PULSE_ATTEMPTS;
+    session_descriptor.flow_detection_window_ms = flow_windows.detection_ms;
+    session_descriptor.flow_prediction_window_ms = flow_windows.prediction_ms;
+    session_descriptor.grinder_channel = grinder_channel;
 
     // Initialize pulse tracking
     additional_pulse_count = 0;
@@ -163,8 +250,14 @@ void GrindController::start_grind(float target, uint32_t time_ms, GrindMode grin
         diagnostics_controller_->reset_diagnostic(DiagnosticCode::MECHANICAL_INSTABILITY);
     }
 
-    if (mode == GrindMode::WEIGHT) {
+    if (bulk) {
+        active_strategy = static_cast<IGrindStrategy*>(&bulk_strategy);
+    } else if (mode == GrindMode::WEIGHT) {
+#if GRIND_PREDICTIVE_MODEL_ENABLED
+        active_strategy = static_cast<IGrindStrategy*>(&predictive_model_strategy);
+#else
         active_strategy = static_cast<IGrindStrategy*>(&weight_strategy);
+#endif
     } else if (mode == GrindMode::TIME) {
         active_strategy = static_cast<IGrindStrategy*>(&time_strategy);
     } else {
@@ -195,9 +288,18 @@ void GrindController::return_to_idle() {
     // and return the controller to the IDLE state.
     if (phase == GrindPhase::COMPLETED || phase == GrindPhase::TIMEOUT) {
         LOG_BLE("[%lums CONTROLLER] UI acknowledged completion/timeout, returning to IDLE.\n", millis());
+        if (is_batch_active()) {
+            if (phase == GrindPhase::COMPLETED && ++batch_completed < batch_total) {
+                LOG_BLE("[BATCH] Dose %u/%u done - waiting for the next cup\n",
+                        (unsigned)batch_completed, (unsigned)batch_total);
+            } else {
+                end_batch();
+            }
+        }
         time_grind_start_ms = 0;
         target_time_ms = 0;
         prime_enabled_for_session = false;
+        retention_observing = false;
         last_error_message[0] = '\0';
         if (active_strategy) {
             active_strategy->on_exit(session_descriptor, strategy_context);
@@ -214,10 +316,16 @@ void GrindController::stop_grind() {
     grinder->stop();
     
     // Cancelled grinds just discard PSRAM data and go to IDLE
-    grind_logger.discard_current_session();
+    if (is_recording()) {
+        grind_logger.discard_current_session(grinder_channel);
+    }
     
     LOG_BLE("--- GRIND STOPPED BY USER ---\n");
+    end_batch();
     
+    if (time_grind_start_ms != 0) {
+        last_grind_end_ms = millis();   // The chute holds this session's grounds now
+    }
     time_grind_start_ms = 0;
     target_time_ms = 0;
     prime_enabled_for_session = false;
@@ -229,230 +337,172 @@ void GrindController::stop_grind() {
     switch_phase(GrindPhase::IDLE);  // No loop_data needed for IDLE transition
 }
 
+bool GrindController::fail_safe_stop(const char* error_message) {
+    if (!grinder || !grind_phase_has_flag(phase, GRIND_PHASE_FLAG_SESSION_TIMER)) {
+        return false;
+    }
+    timeout_phase = phase;
+    grinder->stop();
+
+    GrindLoopData loop_data = {};
+    loop_data.now = millis();
+    loop_data.timestamp_ms = loop_data.now - start_time;
+    loop_data.current_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
+
+    queue_log_message("--- FAIL-SAFE STOP in phase %s: %s ---\n", get_phase_name(timeout_phase), error_message);
+    set_error_message(error_message);
+    switch_phase(GrindPhase::TIMEOUT, loop_data);
+    return true;
+}
+
+void GrindController::start_batch(uint8_t doses) {
+    batch_total = doses;
+    batch_completed = 0;
+    batch_start_ms = millis();
+    if (batch_total) {
+        LOG_BLE("[BATCH] Started: %u doses\n", (unsigned)batch_total);
+    }
+}
+
+void GrindController::end_batch() {
+    if (!is_batch_active()) {
+        return;
+    }
+    unsigned long elapsed_ms = millis() - batch_start_ms;
+    float doses_per_minute = elapsed_ms > 0 ? batch_completed * 60000.0f / elapsed_ms : 0.0f;
+    LOG_BLE("[BATCH] Ended: %u/%u doses in %.1fs (%.2f doses/min)\n", (unsigned)batch_completed,
+            (unsigned)batch_total, elapsed_ms / 1000.0f, doses_per_minute);
+    batch_total = 0;
+    batch_completed = 0;
+}
+
+void GrindController::publish_ui_snapshot() {
+    if (!weight_sensor) return;
+    
+    // A grinding tick already made one pass over the sample ring; idle ticks read the windows here
+    UISnapshot snapshot = {};
+    if (tick_snapshot_valid) {
+        snapshot.display_weight = tick_snapshot.display_weight;
+        snapshot.live_weight = tick_snapshot.low_latency_weight;
+        snapshot.flow_rate = tick_snapshot.flow_rate;
+        snapshot.sample_timestamp_us = tick_snapshot.sample_timestamp_us;
+        tick_snapshot_valid = false;
+    } else {
+        snapshot.display_weight = weight_sensor->get_display_weight();
+        snapshot.live_weight = weight_sensor->get_weight_low_latency();
+        snapshot.flow_rate = weight_sensor->get_flow_rate();
+        snapshot.sample_timestamp_us = weight_sensor->get_latest_sample_time_us();
+        display_weight = snapshot.display_weight;
+    }
+    snapshot.instant_raw = weight_sensor->get_raw_adc_instant();
+    snapshot.instant_weight = weight_sensor->get_instant_weight();
+    ui_snapshot.publish(grinder_channel, snapshot);
+}
+
 void GrindController::update() {
     if (!is_active()) return;
     
     // Increment loop counter for current phase performance tracking
     current_phase_loop_count = current_phase_loop_count + 1;
     
+    // Stage laps land in the phase the tick started in (GrindLoopProfiler)
+    const GrindPhase tick_phase = phase;
+    uint32_t lap_cycles = grind_loop_profiler.begin_tick();
     unsigned long now = millis();
     
+    // Log rows and telemetry ticks keep SYS_GRIND_REPORT_INTERVAL_MS however often the loop runs (a fixed
+    // rate or one tick per sample); half an interval of slack absorbs tick jitter, and a stall resyncs
+    const int32_t report_lag_ms = (int32_t)(now - next_report_ms);
+    const bool report_tick = report_lag_ms > -(int32_t)(SYS_GRIND_REPORT_INTERVAL_MS / 2);
+    if (report_tick) {
+        next_report_ms = report_lag_ms >= (int32_t)SYS_GRIND_REPORT_INTERVAL_MS
+            ? now + SYS_GRIND_REPORT_INTERVAL_MS : next_report_ms + SYS_GRIND_REPORT_INTERVAL_MS;
+    }
+    
     // Calculate all measurement values once at the start - pass to methods to avoid redundant calculations
     GrindLoopData loop_data = {};
     
-    // Always calculate these values
-    loop_data.display_weight = weight_sensor ? weight_sensor->get_display_weight() : 0.0f;
-    loop_data.current_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
+    // Always calculate these values (one pass over the sample ring)
+    WeightSnapshot snapshot = {};
+    if (weight_sensor) {
+        weight_sensor->get_snapshot(&snapshot);
+    }
+    lap_cycles = grind_loop_profiler.lap(tick_phase, GrindLoopProbe::WEIGHT_QUERY, lap_cycles);
+    tick_snapshot = snapshot;
+    tick_snapshot_valid = true;
+    display_weight = snapshot.display_weight;
+    loop_data.display_weight = snapshot.display_weight;
+    loop_data.current_weight = snapshot.low_latency_weight;
     loop_data.now = now;
     loop_data.timestamp_ms = now - start_time;  // Relative to session start
+    loop_data.sample_timestamp_us = weight_sensor ? snapshot.sample_timestamp_us - session_start_us : 0;
     loop_data.motor_is_on = grinder ? (grinder->is_grinding() ? 1 : 0) : 0;
     loop_data.phase_id = get_current_phase_id();
     loop_data.weight_delta = loop_data.current_weight - last_logged_weight;
-    loop_data.flow_rate = weight_sensor ? weight_sensor->get_flow_rate() : 0.0f;
+    loop_data.flow_rate = snapshot.flow_rate;
+    loop_data.flow_rate_detection = snapshot.flow_rate_detection;
+    loop_data.flow_rate_prediction = snapshot.flow_rate_prediction;
+    loop_data.motor_settled = snapshot.motor_settled;
+    loop_data.precision_settled = snapshot.precision_settled;
+    loop_data.precision_settled_weight = snapshot.precision_settled_weight;
+    loop_data.precision_settle_window_ms = snapshot.precision_settle_window_ms;
+    loop_data.estimate_valid = snapshot.estimate_valid;
+    loop_data.estimated_weight = snapshot.estimated_weight;
+    loop_data.estimated_flow_rate = snapshot.estimated_flow_rate;
 
     monitor_mechanical_instability(loop_data);
+    lap_cycles = grind_loop_profiler.lap(tick_phase, GrindLoopProbe::LOOP_DATA, lap_cycles);
     
-    switch (phase) {
-        case GrindPhase::INITIALIZING:
-            // Wait for UI to acknowledge the phase transition before proceeding
-            if (ui_ready_for_setup) {
-                LOG_UI_DEBUG("UI acknowledged INITIALIZING phase, proceeding to SETUP\n");
-                switch_phase(GrindPhase::SETUP, loop_data);
-            }
-            break;
-            
-        case GrindPhase::SETUP: {
-            // Snapshot pre-tare weight so we can log the initial Cup state
-            float pre_tare_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
-
-            // Start logging immediately (synchronous PSRAM setup only)
-            grind_logger.start_grind_session(session_descriptor, pre_tare_weight);
-
-            // Initialize logging event for upcoming TARING phase
-            memset(&event_in_progress, 0, sizeof(GrindEvent));
-            if (session_descriptor.mode == GrindMode::TIME) {
-                event_in_progress.event_flags |= GRIND_EVENT_FLAG_TIME_MODE;
-            }
-
-            switch_phase(GrindPhase::TARING, loop_data);
-            break;
-        }
-            
-        case GrindPhase::TARING:
-            if (weight_sensor->start_nonblocking_tare()) {
-                LOG_LOADCELL_DEBUG("Non-blocking tare started\n");
-                switch_phase(GrindPhase::TARE_CONFIRM, loop_data);
-            }
-            break;
-            
-        case GrindPhase::TARE_CONFIRM:
-            // Check if tare is complete
-            if (!weight_sensor->is_tare_in_progress()) {
-                // Double confirm weights are settled
-                if (weight_sensor->is_settled()) {
-                    if (!grinder->is_grinding()) {
-                        grinder->start();  // Ensure motor is running
-                    }
-                    time_grind_start_ms = loop_data.now;
-                    if (mode == GrindMode::TIME) {
-                        switch_phase(GrindPhase::TIME_GRINDING, loop_data);
-                    } else if (prime_enabled_for_session) {
-                        switch_phase(GrindPhase::PRIME, loop_data);
-                    } else {
-                        switch_phase(GrindPhase::PREDICTIVE, loop_data);
-                    }
-                }
-            }
-            break;
-
-        case GrindPhase::PRIME: {
-            if (!grinder->is_grinding()) {
-                grinder->start();
-            }
-
-            bool reached_weight = loop_data.current_weight >= GRIND_PRIME_TARGET_WEIGHT_G;
-            bool exceeded_duration = (loop_data.now - phase_start_time) >= GRIND_PRIME_MAX_DURATION_MS;
-            if (reached_weight || exceeded_duration) {
-                grinder->stop();
-                if (exceeded_duration && !reached_weight) {
-                    queue_log_message("[PRIME] Max duration reached (%.2fg delivered)\n", loop_data.current_weight);
-                }
-                switch_phase(GrindPhase::PRIME_SETTLING, loop_data);
-            }
-            break;
-        }
-
-        case GrindPhase::PRIME_SETTLING: {
-            if (!weight_sensor) {
-                break;
-            }
-
-            bool settled = weight_sensor->check_settling_complete(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
-            bool settling_timed_out = (loop_data.now - phase_start_time) >= GRIND_SCALE_SETTLING_TIMEOUT_MS;
-            if (settled || settling_timed_out) {
-                if (settling_timed_out && !settled) {
-                    queue_log_message("[PRIME] Settling timeout, resuming grind\n");
-                }
-                flow_start_confirmed = false;
-                grind_latency_ms = 0;
-                grinder->start();
-                time_grind_start_ms = loop_data.now;
-                switch_phase(GrindPhase::PREDICTIVE, loop_data);
-            }
-            break;
-        }
-
-        case GrindPhase::TIME_GRINDING:
-            if (mode == GrindMode::TIME && active_strategy) {
-                active_strategy->update(session_descriptor, strategy_context, loop_data);
-            }
-            break;
-
-        case GrindPhase::PREDICTIVE:
-            if (mode == GrindMode::WEIGHT && active_strategy) {
-                active_strategy->update(session_descriptor, strategy_context, loop_data);
-            }
-            break;
-            
-        case GrindPhase::PULSE_DECISION:
-            if (mode == GrindMode::WEIGHT && active_strategy) {
-                active_strategy->update(session_descriptor, strategy_context, loop_data);
-            }
-            break;
-
-        case GrindPhase::PULSE_EXECUTE:
-            if (mode == GrindMode::WEIGHT && active_strategy) {
-                active_strategy->update(session_descriptor, strategy_context, loop_data);
-            }
-            break;
-
-        case GrindPhase::PULSE_SETTLING:
-            if (mode == GrindMode::WEIGHT && active_strategy) {
-                active_strategy->update(session_descriptor, strategy_context, loop_data);
-            }
-            break;
-
-        case GrindPhase::FINAL_SETTLING:
-            // Wait for weight to settle with precision settling window
-            if (weight_sensor->check_settling_complete(GRIND_SCALE_PRECISION_SETTLING_TIME_MS)) {
-                final_measurement(loop_data);
-            }
-            break;
-            
-        case GrindPhase::TIME_ADDITIONAL_PULSE:
-            // Check for additional pulse completion
-            if (grinder && grinder->is_pulse_complete()) {
-                LOG_BLE("[%lums CONTROLLER] Additional pulse #%d completed, weight: %.2fg\n", 
-                        millis(), additional_pulse_count, weight_sensor ? weight_sensor->get_display_weight() : 0.0f);
-                
-                // Return to completed phase
-                switch_phase(GrindPhase::COMPLETED, loop_data);
-            }
-            break;
-            
-        case GrindPhase::COMPLETED:
-            if (grind_logger.is_logging_active() && !session_end_flash_queued) {
-                float error = final_weight - target_weight;
-                if (mode == GrindMode::TIME) {
-                    error = 0.0f;
-                }
+    // Phase the samples in loop_data were taken in; fast start can advance several phases this tick
+    const GrindPhase sampled_phase = phase;
     
-                // Determine result for logging and reporting
-                const char* result_string;
-                if (error > tolerance) { 
-                    result_string = "OVERSHOOT";
-                    LOG_BLE("--- RESULT: OVERSHOOT (Error: %+.2fg) ---\n", error);
-                } else if (pulse_attempts >= GRIND_MAX_PULSE_ATTEMPTS && abs(error) > tolerance) { // abs() is correct here
-                    result_string = "COMPLETE - MAX PULSES";
-                    LOG_BLE("--- RESULT: COMPLETE - MAX PULSES (Error: %+.2fg) ---\n", error);
-                } else {
-                    result_string = "COMPLETE";
-                    LOG_BLE("--- RESULT: COMPLETE (Error: %+.2fg) ---\n", error);
-                }
-
-                // Queue flash operation for Core 1 processing - no blocking on Core 0
-                FlashOpRequest request = {};
-                request.operation_type = FlashOpRequest::END_GRIND_SESSION;
-                strncpy(request.result_string, result_string, sizeof(request.result_string) - 1);
-                request.final_weight = final_weight;
-                request.pulse_count = pulse_attempts;
-                queue_flash_operation(request);
-                
-                // Mark flash operation as queued to prevent repeated calls
-                session_end_flash_queued = true;
-            }
-            break;
-            
-        case GrindPhase::TIMEOUT:
-            if (grind_logger.is_logging_active() && !session_end_flash_queued) {
-                // Queue flash operation for Core 1 processing - no blocking on Core 0
-                FlashOpRequest request = {};
-                request.operation_type = FlashOpRequest::END_GRIND_SESSION;
-                strncpy(request.result_string, "TIMEOUT", sizeof(request.result_string) - 1);
-                request.final_weight = final_weight;
-                request.pulse_count = pulse_attempts;
-                queue_flash_operation(request);
-                
-                // Mark flash operation as queued to prevent repeated calls
-                session_end_flash_queued = true;
-            }
-            break;
-            
-        default:
-            break;
-    }
+    // One indexed call per tick; handlers are listed in PHASE_HANDLERS (grind_phase_table.h order)
+    (this->*PHASE_HANDLERS[static_cast<size_t>(phase)].handler)(loop_data);
+    lap_cycles = grind_loop_profiler.lap(tick_phase, GrindLoopProbe::PHASE_HANDLER, lap_cycles);
     
-    // Unified continuous logging for ALL active phases at the control loop rate
-    if (should_log_measurements()) {
-        grind_logger.log_continuous_measurement(loop_data.timestamp_ms, loop_data.current_weight, loop_data.weight_delta, 
-                                               loop_data.flow_rate, loop_data.motor_is_on, loop_data.phase_id, motor_stop_target_weight);
+    // Unified continuous logging for ALL active phases at the report rate. Steady phases are
+    // decimated by the logger; phase changes and motor edges keep the rows around them and
+    // log on their own tick.
+    const bool motor_edge = loop_data.motor_is_on != last_logged_motor_is_on;
+    if (should_log_measurements() && (report_tick || force_measurement_log || motor_edge)) {
+        bool full_rate = force_measurement_log || motor_edge ||
+                         !grind_phase_has_flag(phase, GRIND_PHASE_FLAG_DECIMATED_LOG);
+        grind_logger.log_continuous_measurement(grinder_channel, loop_data.timestamp_ms, loop_data.sample_timestamp_us,
+                                               loop_data.current_weight, loop_data.weight_delta, 
+                                               loop_data.flow_rate, loop_data.motor_is_on, loop_data.phase_id, motor_stop_target_weight,
+                                               full_rate);
         
         // Update tracking variables for next measurement
         last_logged_weight = loop_data.current_weight;
         last_logged_time = loop_data.now;
+        last_logged_motor_is_on = loop_data.motor_is_on;
         force_measurement_log = false;
     }
+    lap_cycles = grind_loop_profiler.lap(tick_phase, GrindLoopProbe::LOGGING, lap_cycles);
     
+    // Flow steadiness over the main run once the prediction window holds only grinding
+    if (phase == GrindPhase::PREDICTIVE && flow_start_confirmed && loop_data.motor_is_on &&
+        now > phase_start_time + grind_latency_ms + flow_windows.prediction_ms) {
+        flow_fit_sum += snapshot.flow_fit_confidence;
+        flow_fit_count++;
+    }
+
+    // Time to target from the tick's flow estimate; the learned coast once the profile's fit is trusted
+    float eta_flow = loop_data.estimate_valid ? loop_data.estimated_flow_rate : loop_data.flow_rate_prediction;
+    float eta_coast_g;
+    if (!coast_model.predict(current_profile_id, eta_flow, &eta_coast_g)) {
+        eta_coast_g = eta_predictor.get_planned_coast_g();
+    }
+    eta_predictor.update(phase, now, loop_data.estimate_valid ? loop_data.estimated_weight : loop_data.current_weight,
+                         get_stop_target_weight(), eta_flow, snapshot.flow_fit_confidence, eta_coast_g);
+    GrindEta eta = eta_predictor.get();
+    Telemetry& grinder_telemetry = channel_telemetry(grinder_channel);
+    grinder_telemetry.set_eta(eta.remaining_ms, eta.band_ms, eta.known);
+    if (report_tick) {
+        grinder_telemetry.record_tick(loop_data.timestamp_ms, loop_data.current_weight, loop_data.flow_rate, loop_data.motor_is_on);
+    }
+    lap_cycles = grind_loop_profiler.lap(tick_phase, GrindLoopProbe::ETA, lap_cycles);
+
     // Emit progress update events every cycle for responsive UI
     GrindEventData progress_event = {};
     progress_event.event = UIGrindEvent::PROGRESS_UPDATED;
@@ -465,13 +515,12 @@ void GrindController::update() {
     progress_event.phase_display_text = get_phase_name();
     progress_event.show_taring_text = show_taring_text();
     progress_event.flow_rate = loop_data.flow_rate;
+    progress_event.eta = eta;
     emit_ui_event(progress_event);
 
     // Check for negative weight failsafe after TARE_CONFIRM phase during active grinding
-    if (phase != GrindPhase::COMPLETED && phase != GrindPhase::TIMEOUT && 
-        phase != GrindPhase::IDLE && phase != GrindPhase::INITIALIZING &&
-        phase != GrindPhase::SETUP && phase != GrindPhase::TARING && 
-        phase != GrindPhase::TARE_CONFIRM && loop_data.current_weight < -1.0f) {
+    if (grind_phase_has_flag(sampled_phase, GRIND_PHASE_FLAG_WEIGHT_GUARD) && grind_phase_has_flag(phase, GRIND_PHASE_FLAG_WEIGHT_GUARD) &&
+        loop_data.current_weight < -1.0f) {
         timeout_phase = phase;
         grinder->stop();
         
@@ -480,8 +529,14 @@ void GrindController::update() {
         set_error_message("Err: neg wt");
         switch_phase(GrindPhase::TIMEOUT, loop_data);
     }
+    else if (check_flow_anomaly(loop_data)) {
+        // Aborted; TIMEOUT records the anomaly's result string
+    }
+    else if (check_projected_timeout(loop_data)) {
+        // Aborted before the timeout it could not beat
+    }
     // Only check timeout during active grinding phases, not during completion states
-    else if (phase != GrindPhase::COMPLETED && phase != GrindPhase::TIMEOUT && check_timeout()) {
+    else if (grind_phase_has_flag(phase, GRIND_PHASE_FLAG_SESSION_TIMER) && check_timeout()) {
         timeout_phase = phase;
         grinder->stop();
         
@@ -499,10 +554,229 @@ void GrindController::update() {
         set_error_message(timeout_msg);
         switch_phase(GrindPhase::TIMEOUT, loop_data);
     }
+    grind_loop_profiler.lap(tick_phase, GrindLoopProbe::EVENTS, lap_cycles);
 }
 
 // OLD predictive_grind method removed - logic now inline in update()
 
+//==============================================================================
+// PHASE HANDLERS
+//==============================================================================
+
+// Indexed by GrindPhase, same order as grind_phase_table::TRAITS
+constexpr GrindController::PhaseHandlerEntry GrindController::PHASE_HANDLERS[] = {
+    { GrindPhase::IDLE,                  &GrindController::run_idle_phase },
+    { GrindPhase::INITIALIZING,          &GrindController::run_initializing_phase },
+    { GrindPhase::SETUP,                 &GrindController::run_setup_phase },
+    { GrindPhase::TARING,                &GrindController::run_taring_phase },
+    { GrindPhase::TARE_CONFIRM,          &GrindController::run_tare_confirm_phase },
+    { GrindPhase::PREDICTIVE,            &GrindController::run_strategy_phase },
+    { GrindPhase::PULSE_DECISION,        &GrindController::run_strategy_phase },
+    { GrindPhase::PULSE_EXECUTE,         &GrindController::run_strategy_phase },
+    { GrindPhase::PULSE_SETTLING,        &GrindController::run_strategy_phase },
+    { GrindPhase::FINAL_SETTLING,        &GrindController::run_final_settling_phase },
+    { GrindPhase::TIME_GRINDING,         &GrindController::run_strategy_phase },
+    { GrindPhase::TIME_ADDITIONAL_PULSE, &GrindController::run_time_additional_pulse_phase },
+    { GrindPhase::COMPLETED,             &GrindController::run_completed_phase },
+    { GrindPhase::TIMEOUT,               &GrindController::run_timeout_phase },
+    { GrindPhase::PRIME,                 &GrindController::run_prime_phase },
+    { GrindPhase::PRIME_SETTLING,        &GrindController::run_prime_settling_phase },
+};
+
+constexpr bool GrindController::phase_handlers_in_order() {
+    for (size_t i = 0; i < sizeof(PHASE_HANDLERS) / sizeof(PHASE_HANDLERS[0]); i++) {
+        if (static_cast<size_t>(PHASE_HANDLERS[i].phase) != i) {
+            return false;
+        }
+    }
+    return sizeof(PHASE_HANDLERS) / sizeof(PHASE_HANDLERS[0]) == GRIND_PHASE_COUNT;
+}
+void GrindController::run_idle_phase(const GrindLoopData&) {
+    static_assert(phase_handlers_in_order(), "PHASE_HANDLERS must list every GrindPhase in order");
+    // Not reached: update() returns early while IDLE
+}
+
+void GrindController::run_initializing_phase(const GrindLoopData& loop_data) {
+#if GRIND_FAST_START_ENABLED
+    // The UI's PHASE_CHANGED events are queued in order, so nothing here needs its ack;
+    // SETUP, TARING and TARE_CONFIRM follow on this tick while each can complete at once
+    switch_phase(GrindPhase::SETUP, loop_data);
+    run_setup_phase(loop_data);
+#else
+    // Wait for UI to acknowledge the phase transition before proceeding
+    if (ui_ready_for_setup) {
+        LOG_UI_DEBUG("UI acknowledged INITIALIZING phase, proceeding to SETUP\n");
+        switch_phase(GrindPhase::SETUP, loop_data);
+    }
+#endif
+}
+
+void GrindController::run_setup_phase(const GrindLoopData& loop_data) {
+    // Snapshot pre-tare weight so we can log the initial Cup state
+    float pre_tare_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
+
+    // Start logging immediately (synchronous PSRAM setup only)
+    grind_logger.start_grind_session(session_descriptor, pre_tare_weight);
+
+    // Initialize logging event for upcoming TARING phase
+    event_in_progress = GrindEvent{};
+    if (session_descriptor.mode == GrindMode::TIME) {
+        event_in_progress.event_flags |= GRIND_EVENT_FLAG_TIME_MODE;
+    }
+
+    switch_phase(GrindPhase::TARING, loop_data);
+#if GRIND_FAST_START_ENABLED
+    run_taring_phase(loop_data);
+#endif
+}
+
+void GrindController::run_taring_phase(const GrindLoopData& loop_data) {
+    if (weight_sensor->start_nonblocking_tare()) {
+        LOG_LOADCELL_DEBUG("Non-blocking tare started\n");
+        switch_phase(GrindPhase::TARE_CONFIRM, loop_data);
+#if GRIND_FAST_START_ENABLED
+        // A tare from buffered history is already done: start the motor on this tick
+        run_tare_confirm_phase(loop_data);
+#endif
+    }
+}
+
+void GrindController::run_tare_confirm_phase(const GrindLoopData& loop_data) {
+    // Check if tare is complete
+    if (!weight_sensor->is_tare_in_progress()) {
+        // Double confirm weights are settled
+        if (weight_sensor->is_settled()) {
+            if (!grinder->is_grinding()) {
+                grinder->start();  // Ensure motor is running
+            }
+            time_grind_start_ms = loop_data.now;
+            if (mode == GrindMode::TIME) {
+                switch_phase(GrindPhase::TIME_GRINDING, loop_data);
+            } else if (prime_enabled_for_session) {
+                switch_phase(GrindPhase::PRIME, loop_data);
+            } else {
+                switch_phase(GrindPhase::PREDICTIVE, loop_data);
+            }
+        }
+    }
+}
+
+void GrindController::run_prime_phase(const GrindLoopData& loop_data) {
+    if (!grinder->is_grinding()) {
+        grinder->start();
+    }
+
+    bool reached_weight = loop_data.current_weight >= GRIND_PRIME_TARGET_WEIGHT_G;
+    bool exceeded_duration = (loop_data.now - phase_start_time) >= GRIND_PRIME_MAX_DURATION_MS;
+    if (reached_weight || exceeded_duration) {
+        grinder->stop();
+        if (exceeded_duration && !reached_weight) {
+            queue_log_message("[PRIME] Max duration reached (%.2fg delivered)\n", loop_data.current_weight);
+        }
+        switch_phase(GrindPhase::PRIME_SETTLING, loop_data);
+    }
+}
+
+void GrindController::run_prime_settling_phase(const GrindLoopData& loop_data) {
+    if (!weight_sensor) {
+        return;
+    }
+
+    bool settled = loop_data.precision_settled;
+    bool settling_timed_out = (loop_data.now - phase_start_time) >= GRIND_SCALE_SETTLING_TIMEOUT_MS;
+    if (settled || settling_timed_out) {
+        if (settling_timed_out && !settled) {
+            queue_log_message("[PRIME] Settling timeout, resuming grind\n");
+        }
+        flow_start_confirmed = false;
+        grind_latency_ms = 0;
+        grinder->start();
+        time_grind_start_ms = loop_data.now;
+        switch_phase(GrindPhase::PREDICTIVE, loop_data);
+    }
+}
+
+void GrindController::run_strategy_phase(const GrindLoopData& loop_data) {
+    if (mode == get_grind_phase_traits(phase).strategy_mode && active_strategy) {
+        active_strategy->update(session_descriptor, strategy_context, loop_data);
+    }
+}
+
+void GrindController::run_final_settling_phase(const GrindLoopData& loop_data) {
+    // Wait for weight to settle with precision settling window
+    if (loop_data.precision_settled) {
+        LOG_RT("[FINAL_SETTLING] Settled after %lums (%lums window)\n",
+                loop_data.now - phase_start_time, (unsigned long)loop_data.precision_settle_window_ms);
+        final_measurement(loop_data);
+    }
+}
+
+void GrindController::run_time_additional_pulse_phase(const GrindLoopData& loop_data) {
+    // Check for additional pulse completion
+    if (grinder && grinder->is_pulse_complete()) {
+        LOG_RT("[%lums CONTROLLER] Additional pulse #%d completed, weight: %.2fg\n", 
+                millis(), additional_pulse_count, loop_data.display_weight);
+        
+        // Return to completed phase
+        switch_phase(GrindPhase::COMPLETED, loop_data);
+    }
+}
+
+void GrindController::run_completed_phase(const GrindLoopData& loop_data) {
+    if (retention_observing) {
+        observe_retention(loop_data);
+    }
+
+    if (is_recording() && !session_end_flash_queued) {
+        // Against what the cup is expected to hold once the held-back retention has landed
+        float error = final_weight + retention_holdback_g - target_weight;
+        if (mode == GrindMode::TIME) {
+            error = 0.0f;
+        }
+
+        // Determine result for logging and reporting
+        const char* result_string;
+        if (error > tolerance) { 
+            result_string = "OVERSHOOT";
+            LOG_RT("--- RESULT: OVERSHOOT (Error: %+.2fg) ---\n", error);
+        } else if (pulse_attempts >= session_descriptor.max_pulse_attempts && abs(error) > tolerance) { // abs() is correct here
+            result_string = "COMPLETE - MAX PULSES";
+            LOG_RT("--- RESULT: COMPLETE - MAX PULSES (Error: %+.2fg) ---\n", error);
+        } else {
+            result_string = "COMPLETE";
+            LOG_RT("--- RESULT: COMPLETE (Error: %+.2fg) ---\n", error);
+        }
+
+        // Queue flash operation for Core 1 processing - no blocking on Core 0
+        FlashOpRequest request = {};
+        request.operation_type = FlashOpRequest::END_GRIND_SESSION;
+        request.descriptor = session_descriptor;
+        strncpy(request.result_string, result_string, sizeof(request.result_string) - 1);
+        request.final_weight = final_weight;
+        request.pulse_count = pulse_attempts;
+        queue_flash_operation(request);
+        
+        // Mark flash operation as queued to prevent repeated calls
+        session_end_flash_queued = true;
+    }
+}
+
+void GrindController::run_timeout_phase(const GrindLoopData&) {
+    if (is_recording() && !session_end_flash_queued) {
+        // Queue flash operation for Core 1 processing - no blocking on Core 0
+        FlashOpRequest request = {};
+        request.operation_type = FlashOpRequest::END_GRIND_SESSION;
+        request.descriptor = session_descriptor;
+        strncpy(request.result_string, timeout_result, sizeof(request.result_string) - 1);
+        request.final_weight = final_weight;
+        request.pulse_count = pulse_attempts;
+        queue_flash_operation(request);
+        
+        // Mark flash operation as queued to prevent repeated calls
+        session_end_flash_queued = true;
+    }
+}
+
 void GrindController::reset_mechanical_anomaly_count() {
     mechanical_anomaly_count_ = 0;
     last_mechanical_event_ms_ = 0;
@@ -535,8 +809,97 @@ void GrindController::monitor_mechanical_instability(const GrindLoopData& loop_d
     last_mechanical_weight_ = loop_data.current_weight;
 }
 
+bool GrindController::check_flow_anomaly(const GrindLoopData& loop_data) {
+#if GRIND_FLOW_ANOMALY_ENABLED
+    // Continuous PREDICTIVE run only; an armed stop is already ending it
+    if (phase != GrindPhase::PREDICTIVE || !grinder || !grinder->is_grinding() || grinder->has_scheduled_stop()) {
+        flow_anomaly_detector.reset();
+        return false;
+    }
+
+    FlowAnomaly anomaly = flow_anomaly_detector.update(loop_data.now, loop_data.flow_rate, flow_start_confirmed,
+                                                       grinder->get_speed(), mechanical_anomaly_count_);
+    bool motor_unloaded = false;
+#if HW_MOTOR_CURRENT_ENABLED && GRIND_MOTOR_CURRENT_HOPPER_ABORT_ENABLED
+    // The motor unloads the moment the beans run out, well before the cup sees the flow collapse
+    motor_unloaded = grinder->has_motor_current() && grinder->get_motor_load().hopper_empty;
+    if (motor_unloaded) {
+        anomaly = FlowAnomaly::STALLED;
+    }
+#endif
+    if (anomaly == FlowAnomaly::NONE) {
+        return false;
+    }
+
+    bool stalled = (anomaly == FlowAnomaly::STALLED);
+    if (session_descriptor.bulk && !stalled) {
+        return false;   // A hopper running low scatters the flow; in bulk mode only the stall ends the run
+    }
+    // Flow that ran and collapsed in bulk mode is the hopper running empty, not a clog
+    bool hopper_empty = motor_unloaded || (session_descriptor.bulk && flow_start_confirmed);
+    timeout_phase = phase;
+    grinder->stop();
+    timeout_result = hopper_empty ? "ABORT - HOPPER EMPTY" : stalled ? "ABORT - FLOW STALLED" : "ABORT - FLOW UNSTABLE";
+
+    queue_log_message("--- FLOW ANOMALY (%s) after %lums: %.2fg, flow %.2fg/s (peak %.2fg/s), %d drops ---\n",
+                      hopper_empty ? "hopper empty" : stalled ? "stalled" : "unstable", loop_data.now - phase_start_time,
+                      loop_data.current_weight, flow_anomaly_detector.get_mean_flow_rate(),
+                      flow_anomaly_detector.get_peak_flow_rate(), mechanical_anomaly_count_);
+    set_error_message(hopper_empty ? "Hopper empty" : stalled ? "Err: no flow" : "Err: unstable");
+    switch_phase(GrindPhase::TIMEOUT, loop_data);
+    return true;
+#else
+    (void)loop_data;
+    return false;
+#endif
+}
+
+bool GrindController::check_projected_timeout(const GrindLoopData& loop_data) {
+#if GRIND_PROJECTION_ENABLED
+    // Judged on the continuous run once flow is confirmed; before that the flow anomaly checks own the start
+    if (phase != GrindPhase::PREDICTIVE || !flow_start_confirmed || !grinder || !grinder->is_grinding() ||
+        grinder->has_scheduled_stop()) {
+        completion_projector.reset();
+        return false;
+    }
+
+    float weight = loop_data.estimate_valid ? loop_data.estimated_weight : loop_data.current_weight;
+    float flow = loop_data.estimate_valid ? loop_data.estimated_flow_rate : loop_data.flow_rate_prediction;
+    float remaining_g = get_stop_target_weight() - weight;
+    if (!completion_projector.update(loop_data.now, loop_data.now - start_time, session_descriptor.timeout_ms,
+                                     remaining_g, flow)) {
+        return false;
+    }
+
+    timeout_phase = phase;
+    grinder->stop();
+    timeout_result = "ABORT - PROJECTED TIMEOUT";
+
+    uint32_t projected_ms = completion_projector.get_projected_ms();
+    char projected[16];
+    if (projected_ms == UINT32_MAX) {
+        snprintf(projected, sizeof(projected), "never");
+    } else {
+        snprintf(projected, sizeof(projected), "%lums", (unsigned long)projected_ms);
+    }
+    queue_log_message("--- PROJECTED TIMEOUT after %lums: %.2fg to go at %.2fg/s, done %s (limit %lums) ---\n",
+                      loop_data.now - start_time, remaining_g, completion_projector.get_flow_rate(), projected,
+                      (unsigned long)session_descriptor.timeout_ms);
+    set_error_message("Err: too slow");
+    switch_phase(GrindPhase::TIMEOUT, loop_data);
+    return true;
+#else
+    (void)loop_data;
+    return false;
+#endif
+}
+
 void GrindController::final_measurement(const GrindLoopData& loop_data) {
     final_weight = weight_sensor->get_weight_high_latency();
+    if (loop_data.precision_settle_window_ms < GRIND_SCALE_PRECISION_SETTLING_TIME_MS) {
+        // Settled sequentially: the high-latency window can still reach back into the disturbance
+        final_weight = loop_data.precision_settled_weight;
+    }
 
     if (mode == GrindMode::WEIGHT && target_weight >= 1.0f && final_weight < NO_WEIGHT_DELIVERED_THRESHOLD_G) {
         timeout_phase = GrindPhase::FINAL_SETTLING;
@@ -545,10 +908,292 @@ void GrindController::final_measurement(const GrindLoopData& loop_data) {
         return;
     }
 
+    if (mode == GrindMode::WEIGHT) {
+        if (flow_fit_count > 0) {
+            weight_sensor->observe_flow_stability(flow_fit_sum / flow_fit_count);
+        }
+        learn_coast_model();
+        learn_pulse_table();
+        learn_motor_latency();
+#if GRIND_RETENTION_MODEL_ENABLED
+        retention_observing = true;
+        retention_peak_g = final_weight;
+        retention_observe_start_ms = loop_data.now;
+#endif
+    } else if (mode == GrindMode::TIME) {
+        calibrate_time_target();
+    }
+    last_grind_end_ms = loop_data.now;
+
     // Switch to COMPLETED. The state machine will then transition to IDLE on the next tick.
     switch_phase(GrindPhase::COMPLETED, loop_data);
 }
 
+void GrindController::calibrate_time_target() {
+    LOG_RT("[TIME] Settled %.2fg (implied %.2fg at cut, paired target %.2fg)\n",
+            final_weight, time_implied_weight, target_weight);
+#if GRIND_TIME_CALIBRATION_ENABLED
+    if (target_time_ms == 0 || target_weight < GRIND_TIME_CALIBRATION_MIN_WEIGHT_G ||
+        final_weight < GRIND_TIME_CALIBRATION_MIN_WEIGHT_G || time_stop_flow_rate < GRIND_FLOW_DETECTION_THRESHOLD_GPS) {
+        return;
+    }
+    float error_g = target_weight - final_weight;
+    if (fabsf(error_g) <= tolerance) {
+        return;
+    }
+
+    // Missing grams at the flow measured at the cut, amortized over sessions
+    float step_s = constrain(GRIND_TIME_CALIBRATION_GAIN * error_g / time_stop_flow_rate,
+                             -GRIND_TIME_CALIBRATION_MAX_STEP_S, GRIND_TIME_CALIBRATION_MAX_STEP_S);
+    float seconds = constrain(target_time_ms / (float)SYS_MS_PER_SECOND + step_s, USER_MIN_TARGET_TIME_S, USER_MAX_TARGET_TIME_S);
+    uint32_t calibrated_ms = (uint32_t)(roundf(seconds * 10.0f) * 100.0f);    // Profile time resolution: 0.1s
+    if (calibrated_ms != target_time_ms) {
+        time_calibrated_ms = calibrated_ms;
+        LOG_RT("[TIME] Profile %u time %.1fs -> %.1fs (%+.2fg at %.2fg/s)\n", (unsigned)current_profile_id,
+                target_time_ms / (float)SYS_MS_PER_SECOND, calibrated_ms / (float)SYS_MS_PER_SECOND,
+                error_g, time_stop_flow_rate);
+    }
+#endif
+}
+
+void GrindController::learn_coast_model() {
+    if (!coast_observation_valid) {
+        return;
+    }
+    coast_observation_valid = false;
+
+    if (!coast_model.observe(current_profile_id, predictive_stop_flow_rate, coast_observation_g)) {
+        queue_log_message("[COAST] Observation %.2fg at %.2fg/s discarded\n", coast_observation_g, predictive_stop_flow_rate);
+        return;
+    }
+
+    // NVS write happens on Core 1 from a snapshot
+    FlashOpRequest request = {};
+    request.operation_type = FlashOpRequest::SAVE_COAST_MODEL;
+    request.coast_profile_id = current_profile_id;
+    if (coast_model.get_state(current_profile_id, &request.coast_model_state)) {
+        queue_log_message("[COAST] Profile %u: %.2fg at %.2fg/s -> %.2fg + %.0fms x flow (%u sessions)\n",
+                          (unsigned)current_profile_id, coast_observation_g, predictive_stop_flow_rate,
+                          request.coast_model_state.theta[0], request.coast_model_state.theta[1] * 1000.0f,
+                          (unsigned)request.coast_model_state.session_count);
+        queue_flash_operation(request);
+    }
+}
+
+void GrindController::seed_warm_start() {
+    warm_start_flow_gps = 0.0f;
+    warm_start_latency_ms = 0.0f;
+    SessionTrend trend;
+    if (mode != GrindMode::WEIGHT ||
+        !grind_logger.get_session_summaries().get_trend(GRIND_WARM_START_SESSIONS, static_cast<int>(GrindMode::WEIGHT),
+                                                        &trend, current_profile_id, grinder_channel) ||
+        trend.session_count < GRIND_WARM_START_MIN_SESSIONS || trend.mean_latency_ms <= 0.0f ||
+        trend.mean_flow_g_per_s < GRIND_FLOW_RATE_MIN_SANE_GPS || trend.mean_flow_g_per_s > GRIND_FLOW_RATE_MAX_SANE_GPS) {
+        return;
+    }
+    warm_start_flow_gps = trend.mean_flow_g_per_s;
+    warm_start_latency_ms = trend.mean_latency_ms;
+    // The profile's own offset from the first tick, rather than the fixed default until the window fills
+    motor_stop_target_weight = predict_stop_offset_g(warm_start_flow_gps, warm_start_latency_ms);
+    LOG_BLE("[PREDICTIVE] Warm start from %u sessions of profile %u: %.2fg/s, latency %.0fms, stop offset %.2fg\n",
+            (unsigned)trend.session_count, (unsigned)current_profile_id, warm_start_flow_gps, warm_start_latency_ms,
+            (float)motor_stop_target_weight);
+}
+
+float GrindController::predict_stop_offset_g(float flow_gps, float latency_ms) const {
+    float coast_g = 0.0f;
+    if (coast_model.predict(current_profile_id, flow_gps, &coast_g)) {
+        return coast_g;
+    }
+    return ((latency_ms * GRIND_LATENCY_TO_COAST_RATIO) / (float)SYS_MS_PER_SECOND) * flow_gps;
+}
+
+float GrindController::blend_warm_start_flow(float live_flow_gps, unsigned long now) const {
+    if (warm_start_flow_gps <= 0.0f || !flow_start_confirmed) {
+        return live_flow_gps;
+    }
+    // Confidence in the live estimate grows as the prediction window fills with grounds
+    float elapsed_ms = (float)(now - phase_start_time) - grind_latency_ms;
+    float live_weight = constrain(elapsed_ms / (float)flow_windows.prediction_ms, 0.0f, 1.0f);
+    return warm_start_flow_gps + (live_flow_gps - warm_start_flow_gps) * live_weight;
+}
+
+void GrindController::begin_retention_session() {
+    retention_observing = false;
+    retention_holdback_g = 0.0f;
+    // Idle is unknown until the first grind since boot
+    retention_bucket = last_grind_end_ms != 0
+        ? RetentionModel::bucket_for_idle_s((millis() - last_grind_end_ms) / SYS_MS_PER_SECOND)
+        : RetentionModel::UNKNOWN_IDLE_BUCKET;
+#if GRIND_RETENTION_MODEL_ENABLED
+    if (mode != GrindMode::WEIGHT || !retention_model.predict(retention_bucket, &retention_holdback_g)) {
+        return;
+    }
+    LOG_BLE("[RETENTION] Idle class %u: holding back %.2fg\n", (unsigned)retention_bucket, retention_holdback_g);
+    if (prime_enabled_for_session) {
+        prime_enabled_for_session = false;
+        LOG_BLE("[RETENTION] Learned retention replaces chute priming\n");
+    }
+#endif
+}
+
+void GrindController::observe_retention(const GrindLoopData& loop_data) {
+    if (loop_data.current_weight < final_weight - GRIND_RETENTION_CUP_REMOVED_G) {
+        retention_observing = false;    // Cup lifted before the window closed: incomplete
+        return;
+    }
+    if (loop_data.precision_settled) {
+        retention_peak_g = max(retention_peak_g, loop_data.precision_settled_weight);
+    }
+    if (loop_data.now - retention_observe_start_ms < GRIND_RETENTION_OBSERVE_WINDOW_MS) {
+        return;
+    }
+    retention_observing = false;
+
+    float late_fall_g = retention_peak_g - final_weight;
+    if (!retention_model.observe(retention_bucket, late_fall_g)) {
+        queue_log_message("[RETENTION] Observation %.2fg discarded\n", late_fall_g);
+        return;
+    }
+
+    FlashOpRequest request = {};
+    request.operation_type = FlashOpRequest::SAVE_RETENTION_MODEL;
+    retention_model.get_state(&request.retention_state);
+    queue_log_message("[RETENTION] Idle class %u: %.2fg late fall -> %.2fg (%u sessions)\n",
+                      (unsigned)retention_bucket, late_fall_g, request.retention_state.late_fall_g[retention_bucket],
+                      (unsigned)request.retention_state.session_count);
+    queue_flash_operation(request);
+}
+
+void GrindController::learn_pulse_table() {
+    // Every pulse has been followed by a PULSE_DECISION or a pipelined pulse that recorded its end weight
+    uint8_t observed = 0;
+    for (uint8_t i = 0; i < pulse_attempts && i < GRIND_MAX_PULSE_ATTEMPTS; i++) {
+        const PulseReport& report = pulse_history[i];
+        if (report.projected) {
+            continue;
+        }
+        if (pulse_table.observe(current_profile_id, report.duration_ms, report.end_weight - report.start_weight)) {
+            observed++;
+        }
+    }
+    if (observed == 0) {
+        return;
+    }
+    save_pulse_table(observed);
+}
+
+void GrindController::learn_motor_latency() {
+#if GRIND_LATENCY_LEARN_ENABLED
+    float duration_ms[GRIND_MAX_PULSE_ATTEMPTS];
+    float delivered_g[GRIND_MAX_PULSE_ATTEMPTS];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < pulse_attempts && i < GRIND_MAX_PULSE_ATTEMPTS; i++) {
+        if (pulse_history[i].projected) {
+            continue;
+        }
+        duration_ms[count] = pulse_history[i].duration_ms;
+        delivered_g[count] = pulse_history[i].end_weight - pulse_history[i].start_weight;
+        count++;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // The flow the pulses were sized with; a fallback flow says nothing about the dead time
+    if (!latency_estimator.observe_session(duration_ms, delivered_g, count, pulse_flow_rate)) {
+        if (latency_estimator.get_last_median_ms() > 0.0f) {
+            queue_log_message("[LATENCY] Pulse dead time %.1fms dropped (estimate %.1fms +/- %.1fms)\n",
+                              latency_estimator.get_last_median_ms(), latency_estimator.get_latency_ms(),
+                              latency_estimator.get_deviation_ms());
+        }
+        return;
+    }
+    float estimate_ms = latency_estimator.get_latency_ms();
+    queue_log_message("[LATENCY] Pulse dead time %.1fms -> %.1fms +/- %.1fms (%u sessions)\n",
+                      latency_estimator.get_last_median_ms(), estimate_ms, latency_estimator.get_deviation_ms(),
+                      (unsigned)latency_estimator.get_accepted_sessions());
+    if (!latency_estimator.is_ready() || fabsf(estimate_ms - motor_response_latency_ms) < GRIND_LATENCY_LEARN_MIN_CHANGE_MS) {
+        return;
+    }
+    queue_log_message("[LATENCY] Motor latency %.1fms -> %.1fms\n", (float)motor_response_latency_ms, estimate_ms);
+    motor_response_latency_ms = estimate_ms;
+    config->set_float(ConfigFloat::MOTOR_LATENCY_MS, estimate_ms);     // Committed by PreferenceCache once idle
+#endif
+}
+
+bool GrindController::seed_pulse_table(const float* duration_ms, const float* delivered_g, uint8_t count) {
+    uint8_t observed = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (pulse_table.observe(current_profile_id, duration_ms[i], delivered_g[i])) {
+            observed++;
+        }
+    }
+    if (observed == 0) {
+        return false;
+    }
+    save_pulse_table(observed);
+    return true;
+}
+
+bool GrindController::get_profile_models(uint8_t profile_id, CoastModelState* coast_out,
+                                         PulseResponseState* pulse_out) const {
+    return coast_model.get_state(profile_id, coast_out) && pulse_table.get_state(profile_id, pulse_out);
+}
+
+bool GrindController::adopt_profile_models(uint8_t profile_id, const CoastModelState& coast,
+                                           const PulseResponseState& pulse) {
+    // The models are only read and updated while a session runs, so an idle swap is safe from any task
+    if (profile_id >= USER_PROFILE_COUNT || is_active()) {
+        return false;
+    }
+    bool coast_valid = coast_model.set_state(profile_id, coast);
+    bool pulse_valid = pulse_table.set_state(profile_id, pulse);
+
+    FlashOpRequest request = {};
+    request.operation_type = FlashOpRequest::SAVE_COAST_MODEL;
+    request.coast_profile_id = profile_id;
+    coast_model.get_state(profile_id, &request.coast_model_state);
+    queue_flash_operation(request);
+    request.operation_type = FlashOpRequest::SAVE_PULSE_TABLE;
+    pulse_table.get_state(profile_id, &request.pulse_table_state);
+    queue_flash_operation(request);
+    return coast_valid && pulse_valid;
+}
+
+void GrindController::save_pulse_table(uint8_t observed) {
+    pulse_table.end_session(current_profile_id);
+
+    FlashOpRequest request = {};
+    request.operation_type = FlashOpRequest::SAVE_PULSE_TABLE;
+    request.coast_profile_id = current_profile_id;
+    if (pulse_table.get_state(current_profile_id, &request.pulse_table_state)) {
+        queue_log_message("[PULSE] Profile %u: %u pulses learned (%u sessions)\n", (unsigned)current_profile_id,
+                          (unsigned)observed, (unsigned)request.pulse_table_state.session_count);
+        queue_flash_operation(request);
+    }
+}
+
+
+void GrindController::apply_sample_rate_for_phase(GrindPhase new_phase) {
+#if GRIND_HIGH_RATE_SAMPLING_ENABLED
+    if (!weight_sensor) return;
+    
+    // High rate only while flow and pulse decisions depend on fresh samples;
+    // idle/tare run at the low rate for noise floor and power
+    // Between batch doses the ADC stays fast so the next dose starts on warm filters
+    bool high_rate = grind_phase_has_flag(new_phase, GRIND_PHASE_FLAG_HIGH_RATE) ||
+                     (new_phase == GrindPhase::IDLE && is_batch_active());
+    
+    // High rate is whatever the fitted ADC tops out at (80 SPS HX711/ADS1232, 320 SPS NAU7802)
+    uint32_t target_sps = high_rate ? weight_sensor->get_max_sample_rate() : HW_LOADCELL_SAMPLE_RATE_SPS;
+    if (weight_sensor->get_adc_sample_rate_sps() != target_sps) {
+        weight_sensor->set_sample_rate(target_sps);
+    }
+#else
+    (void)new_phase;
+#endif
+}
 
 void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& loop_data) {
     if (phase == new_phase) return;
@@ -565,44 +1210,51 @@ void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& lo
 #endif
     
     // Finalize and log the event for the phase that just ENDED (only when we have loop_data)
-    if (has_loop_data && grind_logger.is_logging_active() && phase != GrindPhase::IDLE) {
+    if (has_loop_data && is_recording() && phase != GrindPhase::IDLE) {
         event_in_progress.duration_ms = now - phase_start_time;
         event_in_progress.end_weight = loop_data.current_weight;  // Use pre-calculated weight
         
         // Populate context-specific data for the completed event
-        if (phase == GrindPhase::PREDICTIVE) {
-            event_in_progress.motor_stop_target_weight = motor_stop_target_weight;
-            event_in_progress.grind_latency_ms = grind_latency_ms;
-            event_in_progress.pulse_flow_rate = pulse_flow_rate;
-            event_in_progress.loop_count = current_phase_loop_count;
-        } else if (phase == GrindPhase::PULSE_EXECUTE) {
-            event_in_progress.pulse_duration_ms = current_pulse_duration_ms;
-            event_in_progress.pulse_attempt_number = pulse_attempts; // attempts is 1-based
-            event_in_progress.pulse_flow_rate = pulse_flow_rate;
-            event_in_progress.loop_count = current_phase_loop_count;
-        } else if (phase == GrindPhase::PULSE_DECISION) {
-            event_in_progress.pulse_flow_rate = pulse_flow_rate;
-            event_in_progress.loop_count = current_phase_loop_count;
-        } else if (phase == GrindPhase::PULSE_SETTLING || phase == GrindPhase::FINAL_SETTLING || phase == GrindPhase::PRIME_SETTLING) {
-            event_in_progress.settling_duration_ms = event_in_progress.duration_ms;
-            event_in_progress.pulse_flow_rate = pulse_flow_rate;
-            event_in_progress.loop_count = current_phase_loop_count;
-        }
-        
-        // For all other phases, just log the general loop count
-        if (phase != GrindPhase::PREDICTIVE && phase != GrindPhase::PULSE_EXECUTE && 
-            phase != GrindPhase::PULSE_DECISION && phase != GrindPhase::PULSE_SETTLING && 
-            phase != GrindPhase::FINAL_SETTLING && phase != GrindPhase::PRIME_SETTLING) {
-            event_in_progress.loop_count = current_phase_loop_count;
+        event_in_progress.loop_count = current_phase_loop_count;
+        switch (get_grind_phase_traits(phase).event_record) {
+            case GrindPhaseEventRecord::PREDICTIVE:
+                event_in_progress.motor_stop_target_weight = motor_stop_target_weight;
+                event_in_progress.grind_latency_ms = grind_latency_ms;
+                event_in_progress.pulse_flow_rate = pulse_flow_rate;
+                break;
+            case GrindPhaseEventRecord::PULSE_EXECUTE:
+                event_in_progress.pulse_duration_ms = current_pulse_duration_ms;
+                event_in_progress.pulse_attempt_number = pulse_attempts; // attempts is 1-based
+                event_in_progress.pulse_flow_rate = pulse_flow_rate;
+                break;
+            case GrindPhaseEventRecord::PULSE_DECISION:
+                event_in_progress.pulse_flow_rate = pulse_flow_rate;
+                break;
+            case GrindPhaseEventRecord::SETTLING:
+                event_in_progress.settling_duration_ms = event_in_progress.duration_ms;
+                event_in_progress.pulse_flow_rate = pulse_flow_rate;
+                break;
+            case GrindPhaseEventRecord::GENERAL:
+                break;
         }
 
-        grind_logger.log_event(event_in_progress);
+        grind_logger.log_event(grinder_channel, event_in_progress);
     }
     
     // Update phase state
     phase = new_phase;
+    channel_telemetry(grinder_channel).set_phase((uint8_t)new_phase);
+    if (new_phase == GrindPhase::IDLE) {
+        channel_telemetry(grinder_channel).set_eta(0, 0, false);     // update() stops running once the session is over
+    }
+    if (weight_sensor) {
+        // Zero tracking would absorb grounds settling on the cup; only an idle scale may drift-track
+        weight_sensor->set_zero_tracking_allowed(new_phase == GrindPhase::IDLE);
+    }
     phase_start_time = now;
     
+    apply_sample_rate_for_phase(new_phase);
+    
     // Reset loop counter for new phase
     current_phase_loop_count = 0;
 
@@ -611,7 +1263,7 @@ void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& lo
 
     // Start a new event for the NEW phase (only when we have loop_data and not going to IDLE)
     if (has_loop_data && new_phase != GrindPhase::IDLE) {
-        memset(&event_in_progress, 0, sizeof(GrindEvent));
+        event_in_progress = GrindEvent{};
         event_in_progress.phase_id = (uint8_t)new_phase;
         event_in_progress.timestamp_ms = loop_data.timestamp_ms;  // Use pre-calculated timestamp for perfect alignment
         event_in_progress.start_weight = loop_data.current_weight;  // Use pre-calculated weight
@@ -620,24 +1272,8 @@ void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& lo
             event_in_progress.event_flags |= GRIND_EVENT_FLAG_TIME_MODE;
         }
 
-        switch (new_phase) {
-            case GrindPhase::PRIME:
-            case GrindPhase::PREDICTIVE:
-            case GrindPhase::TIME_GRINDING:
-                event_in_progress.event_flags |= GRIND_EVENT_FLAG_MOTOR_ACTIVE;
-                break;
-            case GrindPhase::PULSE_EXECUTE:
-                event_in_progress.event_flags |= (GRIND_EVENT_FLAG_MOTOR_ACTIVE | GRIND_EVENT_FLAG_PULSE_PHASE);
-                break;
-            case GrindPhase::PULSE_SETTLING:
-                event_in_progress.event_flags |= GRIND_EVENT_FLAG_PULSE_PHASE;
-                break;
-            case GrindPhase::PULSE_DECISION:
-                // Motor state depends on strategy decision; leave flags unchanged
-                break;
-            default:
-                break;
-        }
+        // PULSE_DECISION: motor state depends on the strategy decision, no flags
+        event_in_progress.event_flags |= get_grind_phase_traits(new_phase).event_flags;
     }
     
     // pulse_start_time no longer needed for RMT-based pulses
@@ -647,7 +1283,7 @@ void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& lo
     event_data.event = UIGrindEvent::PHASE_CHANGED;
     event_data.phase = new_phase;
     event_data.mode = session_descriptor.mode;
-    event_data.current_weight = weight_sensor ? weight_sensor->get_display_weight() : 0.0f;
+    event_data.current_weight = display_weight;
     event_data.progress_percent = get_progress_percent();
     event_data.phase_display_text = get_phase_name(new_phase);
     event_data.show_taring_text = show_taring_text();
@@ -661,6 +1297,8 @@ void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& lo
         
         // For time mode, also indicate pulse availability
         if (mode == GrindMode::TIME) {
+            event_data.implied_weight = time_implied_weight;
+            event_data.calibrated_time_ms = time_calibrated_ms;
             event_data.can_pulse = true;
             event_data.pulse_count = additional_pulse_count;
             event_data.pulse_duration_ms = pulse_duration_ms;
@@ -683,7 +1321,7 @@ void GrindController::switch_phase(GrindPhase new_phase, const GrindLoopData& lo
 
 
 bool GrindController::check_timeout() const {
-    return (millis() - start_time) >= (GRIND_TIMEOUT_SEC * 1000);
+    return (millis() - start_time) >= session_descriptor.timeout_ms;
 }
 
 bool GrindController::is_active() const {
@@ -699,7 +1337,7 @@ int GrindController::get_progress_percent() const {
     
     float ground = (phase == GrindPhase::COMPLETED || phase == GrindPhase::TIMEOUT) 
                    ? final_weight 
-                   : (weight_sensor ? weight_sensor->get_display_weight() : 0.0f);
+                   : display_weight;
     if (ground < 0) ground = 0;
     int progress = (int)((ground / target_weight) * 100);
     return min(progress, 100);
@@ -714,29 +1352,32 @@ const char* GrindController::get_phase_name(GrindPhase p) const {
     // Use provided phase, or current phase if not specified
     GrindPhase phase_to_check = (p == static_cast<GrindPhase>(-1)) ? phase : p;
     
-    switch (phase_to_check) {
-        case GrindPhase::IDLE: return "IDLE";
-        case GrindPhase::INITIALIZING: return "INITIALIZING";
-        case GrindPhase::SETUP: return "SETUP";
-        case GrindPhase::TARING: return "TARING";
-        case GrindPhase::TARE_CONFIRM: return "TARE_CONFIRM";
-        case GrindPhase::PRIME: return "PRIME";
-        case GrindPhase::PRIME_SETTLING: return "PRIME_SETTLING";
-        case GrindPhase::PREDICTIVE: return "PREDICTIVE";
-        case GrindPhase::PULSE_DECISION: return "PULSE_DECISION";
-        case GrindPhase::PULSE_EXECUTE: return "PULSE_EXECUTE";
-        case GrindPhase::PULSE_SETTLING: return "PULSE_SETTLING";
-        case GrindPhase::FINAL_SETTLING: return "FINAL_SETTLING";
-        case GrindPhase::TIME_GRINDING: return "TIME";
-        case GrindPhase::TIME_ADDITIONAL_PULSE: return "PULSE";
-        case GrindPhase::COMPLETED: return "COMPLETED";
-        case GrindPhase::TIMEOUT: return "TIMEOUT";
-        default: return "UNKNOWN";
+    if (!is_valid_grind_phase(phase_to_check)) {
+        return "UNKNOWN";
     }
+    return get_grind_phase_traits(phase_to_check).name;
 }
 
 
 
+bool GrindController::is_sample_driven() const {
+    // Stop and pulse decisions act on each new sample; the other phases wait on the UI, the tare or the clock
+    return SYS_GRIND_CONTROL_SAMPLE_DRIVEN && is_active() && grind_phase_has_flag(phase, GRIND_PHASE_FLAG_HIGH_RATE);
+}
+
+uint32_t GrindController::get_control_interval_ms() const {
+    if (!is_active() || !grind_phase_has_flag(phase, GRIND_PHASE_FLAG_HIGH_RATE)) {
+        return SYS_TASK_GRIND_CONTROL_INTERVAL_MS;
+    }
+    if (is_sample_driven()) {
+        // The next tick is the next sample; rounded up so a sub-tick stop is never left for a later tick
+        uint32_t sps = weight_sensor ? weight_sensor->get_sample_rate_sps() : 0;
+        return sps > 0 ? min((uint32_t)SYS_TASK_GRIND_CONTROL_INTERVAL_MS, (1000 + sps - 1) / sps)
+                       : SYS_TASK_GRIND_CONTROL_INTERVAL_MS;
+    }
+    return SYS_TASK_GRIND_CONTROL_FAST_INTERVAL_MS;
+}
+
 uint8_t GrindController::get_current_phase_id() const {
     return (uint8_t)phase;
 }
@@ -762,34 +1403,41 @@ void GrindController::ui_acknowledge_phase_transition() {
 }
 
 void GrindController::emit_ui_event(const GrindEventData& data) {
+    // Continuous values are overwritten in place; the UI only ever needs the newest ones
+    if (data.event == UIGrindEvent::PROGRESS_UPDATED) {
+        portENTER_CRITICAL(&ui_progress_lock);
+        ui_progress.sequence = ++ui_event_sequence;
+        ui_progress.phase = data.phase;
+        ui_progress.mode = data.mode;
+        ui_progress.current_weight = data.current_weight;
+        ui_progress.progress_percent = data.progress_percent;
+        ui_progress.phase_display_text = data.phase_display_text;
+        ui_progress.show_taring_text = data.show_taring_text;
+        ui_progress.flow_rate = data.flow_rate;
+        ui_progress.eta = data.eta;
+        ui_progress_published++;
+        portEXIT_CRITICAL(&ui_progress_lock);
+        return;
+    }
+
     // Thread-safe Core 0 → Core 1 UI event emission using FreeRTOS queue
     if (ui_event_queue) {
-        BaseType_t result = xQueueSend(ui_event_queue, &data, 0); // 0 = no wait (non-blocking)
+        QueuedUIEvent queued;
+        portENTER_CRITICAL(&ui_progress_lock);
+        queued.sequence = ++ui_event_sequence;
+        portEXIT_CRITICAL(&ui_progress_lock);
+        queued.data = data;
+        BaseType_t result = xQueueSend(ui_event_queue, &queued, 0); // 0 = no wait (non-blocking)
         
         if (result != pdPASS) {
             // Queue full - drop event to prevent Core 0 blocking
-            // Only log dropped significant events, not progress updates
-            if (data.event != UIGrindEvent::PROGRESS_UPDATED) {
-                LOG_BLE("WARNING: UI event queue full, dropped event type %d\n", (int)data.event);
-            }
+            LOG_RT_AT(LOG_CAT_GRIND, LOG_LEVEL_WARN, "WARNING: UI event queue full, dropped event type %d\n", (int)data.event);
         } else {
-            // Only log significant queued events, not every progress update
-            if (data.event != UIGrindEvent::PROGRESS_UPDATED) {
-                const char* event_name = "UNKNOWN";
-                switch(data.event) {
-                    case UIGrindEvent::PHASE_CHANGED: event_name = "PHASE_CHANGED"; break;
-                    case UIGrindEvent::PROGRESS_UPDATED: event_name = "PROGRESS_UPDATED"; break;
-                    case UIGrindEvent::COMPLETED: event_name = "COMPLETED"; break;
-                    case UIGrindEvent::TIMEOUT: event_name = "TIMEOUT"; break;
-                    case UIGrindEvent::STOPPED: event_name = "STOPPED"; break;
-                    case UIGrindEvent::BACKGROUND_CHANGE: event_name = "BACKGROUND_CHANGE"; break;
-                    case UIGrindEvent::PULSE_AVAILABLE: event_name = "PULSE_AVAILABLE"; break;
-                    case UIGrindEvent::PULSE_STARTED: event_name = "PULSE_STARTED"; break;
-                    case UIGrindEvent::PULSE_COMPLETED: event_name = "PULSE_COMPLETED"; break;
-                }
-                LOG_BLE("[%lums UI_EVENT] QUEUED %s: phase=%s, weight=%.2fg, progress=%d%%\n", 
-                        millis(), event_name, data.phase_display_text, data.current_weight, data.progress_percent);
+            if (ui_event_consumer) {
+                xTaskNotify(ui_event_consumer, SYS_UI_WAKE_NOTIFY_BIT, eSetBits);  // An idle UI sleeps up to SYS_TASK_UI_IDLE_POLL_MS
             }
+            LOG_RT_AT(LOG_CAT_GRIND, LOG_LEVEL_DEBUG, "[%lums UI_EVENT] QUEUED %s: phase=%s, weight=%.2fg, progress=%d%%\n",
+                      millis(), ui_event_name(data.event), data.phase_display_text, data.current_weight, data.progress_percent);
         }
     }
 }
@@ -801,6 +1449,7 @@ void GrindController::emit_ui_event(const GrindEventData& data) {
 
 bool GrindController::should_log_measurements() const {
     return SYS_CONTINUOUS_LOGGING_ENABLED
+        && is_recording()
         && phase != GrindPhase::INITIALIZING 
         && phase != GrindPhase::SETUP
         && phase != GrindPhase::COMPLETED
@@ -808,28 +1457,62 @@ bool GrindController::should_log_measurements() const {
 }
 
 void GrindController::process_queued_ui_events() {
-    GrindEventData event;
+    QueuedUIEvent queued;
     
     // Process all queued events from Core 0
-    while (xQueueReceive(ui_event_queue, &event, 0) == pdPASS) {
+    while (xQueueReceive(ui_event_queue, &queued, 0) == pdPASS) {
+        ui_delivered_sequence = queued.sequence;
         if (ui_event_callback) {
-            ui_event_callback(event); // Safe - runs on Core 1
+            ui_event_callback(queued.data); // Safe - runs on Core 1
         }
     }
+
+    // Then one coherent progress snapshot, unless nothing newer than the last delivered event arrived
+    UIProgressSnapshot progress;
+    portENTER_CRITICAL(&ui_progress_lock);
+    progress = ui_progress;
+    portEXIT_CRITICAL(&ui_progress_lock);
+    if (progress.sequence == 0 || (int32_t)(progress.sequence - ui_delivered_sequence) <= 0) {
+        return;
+    }
+    ui_delivered_sequence = progress.sequence;
+    ui_progress_delivered++;
+
+    GrindEventData event = {};
+    event.event = UIGrindEvent::PROGRESS_UPDATED;
+    event.phase = progress.phase;
+    event.mode = progress.mode;
+    event.current_weight = progress.current_weight;
+    event.progress_percent = progress.progress_percent;
+    event.phase_display_text = progress.phase_display_text;
+    event.show_taring_text = progress.show_taring_text;
+    event.flow_rate = progress.flow_rate;
+    event.eta = progress.eta;
+    if (ui_event_callback) {
+        ui_event_callback(event);
+    }
 }
 
 void GrindController::queue_flash_operation(const FlashOpRequest& request) {
+    // The records still waiting for a trigger go out before Core 1 writes the last block
+    if (request.operation_type == FlashOpRequest::END_GRIND_SESSION && is_recording()) {
+        grind_logger.flush_measurement_history(grinder_channel);
+    }
+
     // Thread-safe Core 0 → Core 1 flash operation queuing
     if (flash_op_queue) {
         BaseType_t result = xQueueSend(flash_op_queue, &request, 0); // 0 = no wait (non-blocking)
         
         if (result != pdPASS) {
             // Queue full - this shouldn't happen with reasonable queue size
-            LOG_BLE("WARNING: Flash operation queue full, dropping request type %d\n", (int)request.operation_type);
+            LOG_RT_AT(LOG_CAT_STORAGE, LOG_LEVEL_WARN, "WARNING: Flash operation queue full, dropping request type %d\n",
+                      (int)request.operation_type);
         } else {
-            const char* op_name = (request.operation_type == FlashOpRequest::END_GRIND_SESSION)
-                                   ? "END_GRIND_SESSION" : "START_GRIND_SESSION";
-            LOG_BLE("[%lums FLASH_OP] QUEUED %s operation for Core 1 processing\n", millis(), op_name);
+            if (flash_op_consumer) {
+                xTaskNotifyGive(flash_op_consumer);     // Don't wait out the consumer's poll interval
+            }
+            LOG_RT_AT(LOG_CAT_STORAGE, LOG_LEVEL_DEBUG, "[%lums FLASH_OP] QUEUED %s operation for Core 1 processing\n", millis(),
+                      request.operation_type == FlashOpRequest::END_GRIND_SESSION ? "END_GRIND_SESSION" : "START_GRIND_SESSION");
         }
     }
 }
@@ -842,18 +1525,37 @@ void GrindController::process_queued_flash_operations() {
         switch (request.operation_type) {
             case FlashOpRequest::START_GRIND_SESSION:
                 // Perform the blocking flash operation on Core 1
-                LOG_BLE("[%lums FLASH_OP] Processing START_GRIND_SESSION on Core 1: mode=%s, profile=%d\n", 
-                        millis(),
-                        request.descriptor.mode == GrindMode::TIME ? "TIME" : "WEIGHT",
-                        request.descriptor.profile_id);
+                LOG_AT(LOG_CAT_STORAGE, LOG_LEVEL_DEBUG, "[%lums FLASH_OP] Processing START_GRIND_SESSION on Core 1: mode=%s, profile=%d\n",
+                       millis(),
+                       request.descriptor.mode == GrindMode::TIME ? "TIME" : "WEIGHT",
+                       request.descriptor.profile_id);
                 grind_logger.start_grind_session(request.descriptor, request.start_weight);
                 break;
                 
             case FlashOpRequest::END_GRIND_SESSION:
                 // Perform the blocking flash operation on Core 1
-                LOG_BLE("[%lums FLASH_OP] Processing END_GRIND_SESSION on Core 1: %s, %.2fg, %d pulses\n", 
-                        millis(), request.result_string, request.final_weight, request.pulse_count);
-                grind_logger.end_grind_session(request.result_string, request.final_weight, request.pulse_count);
+                LOG_AT(LOG_CAT_STORAGE, LOG_LEVEL_DEBUG, "[%lums FLASH_OP] Processing END_GRIND_SESSION on Core 1: %s, %.2fg, %d pulses\n",
+                       millis(), request.result_string, request.final_weight, request.pulse_count);
+                grind_logger.end_grind_session(grinder_channel, request.result_string, request.final_weight,
+                                               request.pulse_count);
+                break;
+
+            case FlashOpRequest::SAVE_COAST_MODEL:
+                if (!CoastModel::save_state(preferences, request.coast_profile_id, request.coast_model_state)) {
+                    LOG_BLE("WARNING: Failed to save coast model for profile %u\n", (unsigned)request.coast_profile_id);
+                }
+                break;
+
+            case FlashOpRequest::SAVE_PULSE_TABLE:
+                if (!PulseResponseTable::save_state(preferences, request.coast_profile_id, request.pulse_table_state)) {
+                    LOG_BLE("WARNING: Failed to save pulse table for profile %u\n", (unsigned)request.coast_profile_id);
+                }
+                break;
+
+            case FlashOpRequest::SAVE_RETENTION_MODEL:
+                if (!RetentionModel::save_state(preferences, request.retention_state)) {
+                    LOG_BLE("WARNING: Failed to save retention model\n");
+                }
                 break;
                 
             default:
@@ -863,39 +1565,6 @@ void GrindController::process_queued_flash_operations() {
     }
 }
 
-void GrindController::queue_log_message(const char* format, ...) {
-    // Thread-safe Core 0 → Core 1 log message queuing
-    if (log_queue) {
-        LogMessage log_msg;
-        
-        // Format the message using va_list
-        va_list args;
-        va_start(args, format);
-        vsnprintf(log_msg.message, sizeof(log_msg.message), format, args);
-        va_end(args);
-        
-        // Ensure null termination
-        log_msg.message[sizeof(log_msg.message) - 1] = '\0';
-        
-        BaseType_t result = xQueueSend(log_queue, &log_msg, 0); // 0 = no wait (non-blocking)
-        
-        if (result != pdPASS) {
-            // Queue full - silently drop the message to avoid blocking Core 0
-            // Don't log this error as it could cause recursion
-        }
-    }
-}
-
-void GrindController::process_queued_log_messages() {
-    LogMessage log_msg;
-    
-    // Process all queued log messages from Core 0
-    while (xQueueReceive(log_queue, &log_msg, 0) == pdPASS) {
-        // Output the message using LOG_BLE on Core 1
-        LOG_BLE("%s", log_msg.message);
-    }
-}
-
 void GrindController::set_error_message(const char* message) {
     if (!message || !message[0]) {
         last_error_message[0] = '\0';
@@ -911,19 +1580,19 @@ void GrindController::start_additional_pulse() {
     }
     
     if (!grinder) {
-        LOG_BLE("ERROR: Cannot pulse - grinder not available\n");
+        LOG_RT("ERROR: Cannot pulse - grinder not available\n");
         return;
     }
     
     additional_pulse_count++;
 
     // Update statistics for time mode pulse
-    statistics_manager.update_time_pulse();
+    channel_statistics(grinder_channel).update_time_pulse();
 
     // Reset timeout timer to prevent timeout during additional pulses
     start_time = millis();
 
-    LOG_BLE("[%lums CONTROLLER] Starting additional pulse #%d (%lums) - timeout timer reset\n",
+    LOG_RT("[%lums CONTROLLER] Starting additional pulse #%d (%lums) - timeout timer reset\n",
             millis(), additional_pulse_count, (unsigned long)pulse_duration_ms);
 
     // Transition to additional pulse phase (without loop_data since this is a manual action)
@@ -950,14 +1619,30 @@ bool GrindController::can_pulse() const {
 // Motor Response Latency Management
 //==============================================================================
 
-void GrindController::load_motor_latency() {
-    if (!preferences) {
-        motor_response_latency_ms = GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS;
-        LOG_BLE("Motor latency: Using default %.1fms (no preferences)\n", motor_response_latency_ms);
-        return;
+bool GrindController::get_weight_after_motor_stop(uint32_t delay_ms, float* weight_out) const {
+    uint32_t off_edge_us = 0;
+    if (!grinder || !weight_sensor || !grinder->get_edge_timeline().get_latest_off(&off_edge_us)) {
+        return false;
     }
+    return weight_sensor->get_weight_at_time_us(off_edge_us + delay_ms * 1000, weight_out);
+}
+
+bool GrindController::get_ms_since_motor_edge(bool motor_on, uint32_t* elapsed_ms_out) const {
+    uint32_t edge_us = 0;
+    if (!grinder || !elapsed_ms_out) {
+        return false;
+    }
+    const MotorEdgeTimeline& timeline = grinder->get_edge_timeline();
+    bool found = motor_on ? timeline.get_latest_on(&edge_us) : timeline.get_latest_off(&edge_us);
+    if (!found) {
+        return false;
+    }
+    *elapsed_ms_out = ((uint32_t)esp_timer_get_time() - edge_us) / 1000;
+    return true;
+}
 
-    motor_response_latency_ms = preferences->getFloat("motor_lat_ms", GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS);
+void GrindController::load_motor_latency() {
+    motor_response_latency_ms = config->get_float(ConfigFloat::MOTOR_LATENCY_MS);
 
     // Validate loaded value
     if (motor_response_latency_ms < GRIND_AUTOTUNE_LATENCY_MIN_MS ||
@@ -968,14 +1653,10 @@ void GrindController::load_motor_latency() {
     } else {
         LOG_BLE("Motor latency: Loaded %.1fms from preferences\n", motor_response_latency_ms);
     }
+    latency_estimator.reset(motor_response_latency_ms);
 }
 
 void GrindController::save_motor_latency(float value) {
-    if (!preferences) {
-        LOG_BLE("ERROR: Cannot save motor latency - no preferences available\n");
-        return;
-    }
-
     // Validate value
     if (value < GRIND_AUTOTUNE_LATENCY_MIN_MS || value > GRIND_AUTOTUNE_LATENCY_MAX_MS) {
         LOG_BLE("ERROR: Cannot save invalid motor latency %.1fms (range: %.1f-%.1fms)\n",
@@ -984,12 +1665,9 @@ void GrindController::save_motor_latency(float value) {
     }
 
     motor_response_latency_ms = value;
-    size_t written = preferences->putFloat("motor_lat_ms", value);
-    if (written == 0) {
-        LOG_BLE("ERROR: Failed to save motor latency to NVS\n");
-    } else {
-        LOG_BLE("Motor latency: Saved %.1fms to preferences\n", value);
-    }
+    latency_estimator.reset(value);
+    config->set_float(ConfigFloat::MOTOR_LATENCY_MS, value);
+    LOG_BLE("Motor latency: Saved %.1fms to preferences\n", value);
 }
 
 void GrindController::set_motor_response_latency(float value) {
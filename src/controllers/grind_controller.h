@@ -3,17 +3,30 @@
 #include "../hardware/WeightSensor.h"
 #include "../hardware/grinder.h"
 #include "../logging/grind_logging.h"
+#include "../logging/deferred_log.h"
 #include "grind_mode.h"
+#include "grind_phase.h"
 #include "grind_session.h"
 #include "grind_strategy.h"
 #include "weight_grind_strategy.h"
+#include "predictive_model_grind_strategy.h"
 #include "time_grind_strategy.h"
+#include "bulk_grind_strategy.h"
+#include "coast_model.h"
+#include "motor_latency_estimator.h"
+#include "pulse_response_table.h"
+#include "retention_model.h"
+#include "flow_anomaly_detector.h"
+#include "completion_projector.h"
+#include "grind_eta_predictor.h"
 #include <Preferences.h>
 #include <LittleFS.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
+#include <freertos/task.h>
 
 class DiagnosticsController;
+class ConfigStore;
 
 // Forward declaration to avoid circular dependency
 struct GrindEventData;
@@ -23,59 +36,54 @@ struct GrindEventData;
 struct FlashOpRequest {
     enum Type {
         START_GRIND_SESSION,
-        END_GRIND_SESSION
+        END_GRIND_SESSION,
+        SAVE_COAST_MODEL,
+        SAVE_PULSE_TABLE,
+        SAVE_RETENTION_MODEL
     };
     
     Type operation_type;
-    GrindSessionDescriptor descriptor; // For START_GRIND_SESSION
+    GrindSessionDescriptor descriptor; // For START_GRIND_SESSION (END_GRIND_SESSION: its grinder_channel)
     char result_string[32];  // "COMPLETE", "TIMEOUT", "OVERSHOOT", etc. (for END_GRIND_SESSION)
     float start_weight;      // For START_GRIND_SESSION (pre-tare snapshot)
     float final_weight;      // For END_GRIND_SESSION
     uint8_t pulse_count;     // For END_GRIND_SESSION
+    uint8_t coast_profile_id;            // For SAVE_COAST_MODEL and SAVE_PULSE_TABLE
+    CoastModelState coast_model_state;   // For SAVE_COAST_MODEL (snapshot taken on Core 0)
+    PulseResponseState pulse_table_state; // For SAVE_PULSE_TABLE (snapshot taken on Core 0)
+    RetentionModelState retention_state;  // For SAVE_RETENTION_MODEL (snapshot taken on Core 0)
 };
 
-// Log message structure for Core 0 → Core 1 communication
-struct LogMessage {
-    char message[128];  // Pre-formatted log message
-};
 
 // Calculated values for a single update cycle - passed to methods to avoid redundant calculations
 struct GrindLoopData {
     float current_weight;       // For control logic (low_latency)
     float display_weight;       // For UI display (always calculated)
     uint32_t timestamp_ms;
+    uint32_t sample_timestamp_us; // Capture time of the newest ADC sample, relative to session start
     float weight_delta;
     float flow_rate;
+    float flow_rate_detection;      // GRIND_FLOW_DETECTION_WINDOW_MS
+    float flow_rate_prediction;     // GRIND_FLOW_PREDICTION_WINDOW_MS
+    bool motor_settled;             // Settled over GRIND_MOTOR_SETTLING_TIME_MS
+    bool precision_settled;         // Settled over GRIND_SCALE_PRECISION_SETTLING_TIME_MS
+    float precision_settled_weight;
+    uint32_t precision_settle_window_ms; // Deciding window; shorter than GRIND_SCALE_PRECISION_SETTLING_TIME_MS when settled sequentially
+    bool estimate_valid;            // State estimator seeded (otherwise estimated_* mirror current_weight/flow_rate)
+    float estimated_weight;         // Latency-compensated Kalman weight
+    float estimated_flow_rate;      // Kalman flow (g/s)
     uint8_t motor_is_on;
     uint8_t phase_id;
     unsigned long now;
 };
 
-// Grind controller state machine phases
-enum class GrindPhase {
-    IDLE,               // Not grinding
-    INITIALIZING,       // Pre-initialization - emit UI event and prepare for grind
-    SETUP,              // Initialization - file system operations, logger setup
-    TARING,             // Performing tare operation
-    TARE_CONFIRM,       // Confirming tare completed
-    PREDICTIVE,         // Main grinding with flow prediction
-    PULSE_DECISION,     // Deciding if pulse correction needed
-    PULSE_EXECUTE,      // Executing precision pulse
-    PULSE_SETTLING,     // Waiting for weight to settle after pulse
-    FINAL_SETTLING,     // Waiting for weight to settle
-    TIME_GRINDING,      // Time-based grinding phase
-    TIME_ADDITIONAL_PULSE, // Additional pulse in time mode after completion
-    COMPLETED,          // Grind completed (success, overshoot, or max pulses)
-    TIMEOUT,            // Grind timed out
-    PRIME,              // Optional chute priming grind
-    PRIME_SETTLING      // Settling after priming grind
-};
 
 
 struct PulseReport {
     float start_weight;
     float end_weight;
     float duration_ms;
+    bool projected;         // A weight was extrapolated mid-settle (pipelined pulse), not settled
 };
 
 
@@ -84,21 +92,35 @@ struct PulseReport {
 class GrindController {
 private:
     friend class WeightGrindStrategy;
+    friend class PredictiveModelGrindStrategy;
     friend class TimeGrindStrategy;
+    friend class BulkGrindStrategy;
+    friend class GrindControlTask;      // Deadline accounting records the phase of a missed cycle
 
     WeightSensor* weight_sensor;
     Grinder* grinder;
-    Preferences* preferences;
+    Preferences* preferences;       // The grinder's own namespace: its models are learned per grinder
+    ConfigStore* config;            // Motor latency; the shared config_store on channel 0
+    uint8_t grinder_channel;        // GrindChannels index, tags the sessions this controller records
     float target_weight;
     uint32_t target_time_ms;
     GrindPhase phase;
     unsigned long start_time;
+    uint32_t session_start_us;      // esp_timer µs (32-bit) at grind start, base for sample timestamps
     unsigned long phase_start_time;
     unsigned long time_grind_start_ms;
+    float time_stop_flow_rate;      // Time mode: flow when the timer cut the motor
+    float time_implied_weight;      // Time mode: weight at the cut + predicted coast
+    uint32_t time_calibrated_ms;    // Time mode: profile time for the paired weight, 0 = none
     
     float tolerance;
     GrindMode mode;
     bool prime_enabled_for_session;
+
+    // Batch mode (UI core): doses counted when the UI acknowledges each completion
+    uint8_t batch_total;            // 0 = no batch
+    uint8_t batch_completed;
+    unsigned long batch_start_ms;
     
     // Timeout tracking
     GrindPhase timeout_phase;   // Phase when timeout occurred
@@ -110,13 +132,22 @@ private:
     
     
     float predictive_end_weight;
+    float predictive_stop_flow_rate;        // Flow the stop decision used
     volatile float grind_latency_ms;        // Thread-safe for Core 0 access
     PulseReport pulse_history[GRIND_MAX_PULSE_ATTEMPTS];
     volatile float motor_stop_target_weight; // Thread-safe for Core 0 access
+    float warm_start_flow_gps;          // Profile's recent flow seeding the predictive phase, 0 = no history
+    float warm_start_latency_ms;        // Profile's recent motor start to flow latency
     float final_weight; // Stores the final settled weight from final_measurement()
+    float display_weight;               // Display-filtered weight of the latest tick (Core 0)
+    WeightSnapshot tick_snapshot;       // update()'s weight pass, reused by publish_ui_snapshot()
+    bool tick_snapshot_valid;
 
     // Flow detection confirmation variables
     bool flow_start_confirmed;
+    FlowWindows flow_windows;           // Chosen by WeightSensor when the session starts
+    float flow_fit_sum;                 // Prediction-window fit R^2 over the filled part of the main run
+    uint16_t flow_fit_count;
     // Dynamic pulse algorithm variables
     volatile float pulse_flow_rate;    // Thread-safe for Core 0 access
     
@@ -130,18 +161,37 @@ private:
     // State tracking for measurement calculations (eliminates calculations in logger)
     float last_logged_weight;       // Previous weight for delta calculation
     unsigned long last_logged_time; // Previous timestamp for relative timing
-    bool force_measurement_log;     // Flag to force measurement logging on next update cycle
+    bool force_measurement_log;     // Next update cycle logs at full rate (phase change trigger)
+    uint8_t last_logged_motor_is_on; // Motor state of the previous update cycle, for motor edge triggers
+    unsigned long next_report_ms;   // millis() the next report tick is due (SYS_GRIND_REPORT_INTERVAL_MS)
 
-    // UI event system - thread-safe Core 0 → Core 1 communication
+    // UI event system - thread-safe Core 0 → Core 1 communication. Discrete events (phase
+    // changes, completion, pulses) are queued; PROGRESS_UPDATED only overwrites this mailbox,
+    // and the UI picks up the newest values once per frame.
     QueueHandle_t ui_event_queue;
+    struct UIProgressSnapshot {
+        uint32_t sequence;              // ui_event_sequence when published, 0 = nothing yet
+        GrindPhase phase;
+        GrindMode mode;
+        float current_weight;
+        int progress_percent;
+        const char* phase_display_text;
+        bool show_taring_text;
+        float flow_rate;
+        GrindEta eta;
+    };
+    UIProgressSnapshot ui_progress = {};
+    uint32_t ui_event_sequence = 0;         // Numbers every emitted event, under ui_progress_lock
+    uint32_t ui_delivered_sequence = 0;     // Core 1: newest event handed to the callback
+    uint32_t ui_progress_published = 0;
+    uint32_t ui_progress_delivered = 0;
+    portMUX_TYPE ui_progress_lock;
     
     // Flash operation queue - thread-safe Core 0 → Core 1 communication
     QueueHandle_t flash_op_queue;
     static const int FLASH_OP_QUEUE_SIZE = 5;
-    
-    // Log message queue - thread-safe Core 0 → Core 1 communication
-    QueueHandle_t log_queue;
-    static const int LOG_QUEUE_SIZE = 20;
+    TaskHandle_t flash_op_consumer = nullptr;  // Notified on each queued operation (FileIOTask)
+    TaskHandle_t ui_event_consumer = nullptr;  // Woken on each queued UI event (UI render task)
     
     // Time mode pulse tracking
     int additional_pulse_count;
@@ -153,12 +203,15 @@ private:
     // Flag to prevent repeated flash operations for terminal phases (COMPLETED/TIMEOUT)
     bool session_end_flash_queued = false;
     char last_error_message[32];
+    const char* timeout_result = "TIMEOUT";    // END_GRIND_SESSION result for the TIMEOUT phase
 
     GrindSessionDescriptor session_descriptor;
     GrindStrategyContext strategy_context;
     IGrindStrategy* active_strategy = nullptr;
     WeightGrindStrategy weight_strategy;
+    PredictiveModelGrindStrategy predictive_model_strategy;
     TimeGrindStrategy time_strategy;
+    BulkGrindStrategy bulk_strategy;
 
     // Mechanical instability tracking
     int mechanical_anomaly_count_ = 0;
@@ -166,18 +219,57 @@ private:
     float last_mechanical_weight_ = 0.0f;
     bool mechanical_monitor_initialized_ = false;
 
+    // Stall / popcorn / bump checks on the PREDICTIVE flow stream
+    FlowAnomalyDetector flow_anomaly_detector;
+    CompletionProjector completion_projector;
+
     DiagnosticsController* diagnostics_controller_ = nullptr;
 
     // Motor response latency - runtime configurable
     float motor_response_latency_ms;
+    // Follows the dead time of everyday correction pulses; restarts from each autotune result
+    MotorLatencyEstimator latency_estimator;
+
+    // Learned coast per profile; one observation per session (first settle after the predictive stop)
+    CoastModel coast_model;
+    bool coast_observation_valid = false;
+    float coast_observation_g = 0.0f;
+
+    // Learned pulse ms -> grams per profile; fed from pulse_history[] when a session completes
+    PulseResponseTable pulse_table;
+
+    // Learned late fall vs idle time; observed in COMPLETED, held back from the stop target
+    RetentionModel retention_model;
+    unsigned long last_grind_end_ms = 0;    // 0 = no grind since boot (idle unknown)
+    uint8_t retention_bucket = RetentionModel::UNKNOWN_IDLE_BUCKET;
+    float retention_holdback_g = 0.0f;
+    bool retention_observing = false;
+    float retention_peak_g = 0.0f;          // Highest settled weight since the final measurement
+    unsigned long retention_observe_start_ms = 0;
+
+    // Time to target: planned in start_grind() from the session history, refined per tick
+    GrindEtaPredictor eta_predictor;
 
 public:
-    void init(WeightSensor* lc, Grinder* gr, Preferences* prefs);
+    void init(WeightSensor* lc, Grinder* gr, Preferences* prefs, uint8_t channel = 0, ConfigStore* store = nullptr);
     void start_grind(float target_weight, uint32_t target_time_ms, GrindMode grind_mode);
     void user_tare_request();
     void return_to_idle(); // Called by UI to acknowledge completion/timeout
     void stop_grind();
-    void update(); // Core 0 main control method - runs at fixed RTOS interval
+    void update(); // Core 0 main control method - runs every get_control_interval_ms(), or per sample when is_sample_driven()
+    uint32_t get_control_interval_ms() const; // Core 0: time to the next tick, shorter in GRIND_PHASE_FLAG_HIGH_RATE phases
+    bool is_sample_driven() const; // Core 0: the next tick waits for a new sample (SYS_GRIND_CONTROL_SAMPLE_DRIVEN)
+    void publish_ui_snapshot(); // Core 0, after update(): the tick's weights for the UI (ui_snapshot)
+    bool fail_safe_stop(const char* error_message); // Core 0: motor off and TIMEOUT if a session is running
+    int get_pulse_attempts() const { return pulse_attempts; } // Weight mode correction pulses this session
+
+    // Batch mode: the next start_grind() calls are doses of one batch; a timeout or stop ends it.
+    // A batch of one still arms cup start and return (remote orders); 0 opens none
+    void start_batch(uint8_t doses);
+    void end_batch();
+    bool is_batch_active() const { return batch_total > 0; }
+    uint8_t get_batch_total() const { return batch_total; }
+    uint8_t get_batch_completed() const { return batch_completed; }
     
     // Time mode pulse functionality
     void start_additional_pulse(); // Start an additional 100ms pulse in time mode
@@ -187,23 +279,31 @@ public:
     // UI event system
     void set_ui_event_callback(void (*callback)(const GrindEventData&));
     void ui_acknowledge_phase_transition(); // Called by UI to confirm phase transition
-    void process_queued_ui_events(); // Core 1: Process events from Core 0 queue
+    void process_queued_ui_events(); // Core 1: Process events from Core 0 queue, then the newest progress
+    uint32_t get_ui_progress_published() const { return ui_progress_published; }
+    uint32_t get_ui_progress_delivered() const { return ui_progress_delivered; }
     QueueHandle_t get_ui_event_queue() const { return ui_event_queue; }
     
     // Flash operation system
     void process_queued_flash_operations(); // Core 1: Process flash ops from Core 0 queue
     void queue_flash_operation(const FlashOpRequest& request); // Core 0: Queue flash operation
+    void set_flash_op_consumer(TaskHandle_t task) { flash_op_consumer = task; }
+    void set_ui_event_consumer(TaskHandle_t task) { ui_event_consumer = task; }
     
     // Log message system
-    void process_queued_log_messages(); // Core 1: Process log messages from Core 0 queue
-    void queue_log_message(const char* format, ...); // Core 0: Queue formatted log message
+    template<typename... Args>
+    void queue_log_message(const char* format, const Args&... args) { deferred_log.write(format, args...); } // Core 0: deferred, formatted by FileIOTask
     
     bool is_active() const;
+    uint8_t get_grinder_channel() const { return grinder_channel; }
     float get_target_weight() const { return target_weight; }
+    // Weight the stop and pulse decisions aim for: the target less the retention expected to land later
+    float get_stop_target_weight() const { return target_weight - retention_holdback_g; }
     uint32_t get_target_time_ms() const { return target_time_ms; }
-    static constexpr const char* PREF_KEY_PRIME_ENABLED = "prime_enabled";
     GrindMode get_mode() const { return mode; }
     const GrindSessionDescriptor& get_session_descriptor() const { return session_descriptor; }
+    // Planned motor start to completion, late edge of the band (grinding chart time axis)
+    uint32_t get_planned_grind_ms() const { return eta_predictor.get_planned_ms() + eta_predictor.get_planned_band_ms(); }
     
     // Grind logging functions
     void set_grind_profile_id(uint8_t profile_id) { current_profile_id = profile_id; session_descriptor.profile_id = profile_id; }
@@ -213,7 +313,12 @@ public:
     float get_current_flow_rate() const;
     float get_motor_stop_target_weight() const { return motor_stop_target_weight; }
     float get_grind_latency_ms() const { return grind_latency_ms; }
+    
+    // Motor edge queries on the load cell sample clock
+    bool get_weight_after_motor_stop(uint32_t delay_ms, float* weight_out) const;  // First sample >= delay_ms after the last off edge
+    bool get_ms_since_motor_edge(bool motor_on, uint32_t* elapsed_ms_out) const;    // Time since the last on/off edge
     float get_last_logged_weight() const { return last_logged_weight; }
+    float get_final_weight() const { return final_weight; }      // Settled weight of the last finished grind
     void set_last_logged_weight(float weight) { last_logged_weight = weight; } // Thread-safe setter
 
     int get_mechanical_anomaly_count() const { return mechanical_anomaly_count_; }
@@ -228,14 +333,58 @@ public:
     float get_max_pulse_duration() const { return motor_response_latency_ms + GRIND_MOTOR_MAX_PULSE_DURATION_MS; }
     void load_motor_latency();
     void save_motor_latency(float value);
+    // Fold autotune's pulse sweep into the current profile's pulse table; false if nothing was plausible
+    bool seed_pulse_table(const float* duration_ms, const float* delivered_g, uint8_t count);
+    // A profile's learned models, for the profile store; adopt replaces and persists them (refused while grinding)
+    bool get_profile_models(uint8_t profile_id, CoastModelState* coast_out, PulseResponseState* pulse_out) const;
+    bool adopt_profile_models(uint8_t profile_id, const CoastModelState& coast, const PulseResponseState& pulse);
     
     // Removed - predictive logic now inline in update_realtime()
     
     
 private:
     void switch_phase(GrindPhase new_phase, const GrindLoopData& loop_data = {});
+    void apply_sample_rate_for_phase(GrindPhase new_phase);
     void final_measurement(const GrindLoopData& loop_data);
     void monitor_mechanical_instability(const GrindLoopData& loop_data);
+    // Stops the motor and switches to TIMEOUT on a flow anomaly; true if it did
+    bool check_flow_anomaly(const GrindLoopData& loop_data);
+    bool check_projected_timeout(const GrindLoopData& loop_data);
+    void learn_coast_model();
+    void learn_pulse_table();
+    void learn_motor_latency();
+    void save_pulse_table(uint8_t observed);
+    void begin_retention_session();
+    void observe_retention(const GrindLoopData& loop_data);
+    void seed_warm_start();
+    // Coast to stop ahead of the target at this flow: the profile's model once trusted, the latency ratio until then
+    float predict_stop_offset_g(float flow_gps, float latency_ms) const;
+    // Seed flow blended toward live_flow_gps over the prediction window after flow start
+    float blend_warm_start_flow(float live_flow_gps, unsigned long now) const;
+    void calibrate_time_target();
+
+    // Phase dispatch: update() makes one indexed call into PHASE_HANDLERS; per-phase
+    // flags, names and event metadata live in grind_phase_table.h
+    using PhaseHandler = void (GrindController::*)(const GrindLoopData& loop_data);
+    struct PhaseHandlerEntry {
+        GrindPhase phase;
+        PhaseHandler handler;
+    };
+    static const PhaseHandlerEntry PHASE_HANDLERS[];
+    static constexpr bool phase_handlers_in_order();
+
+    void run_idle_phase(const GrindLoopData& loop_data);
+    void run_initializing_phase(const GrindLoopData& loop_data);
+    void run_setup_phase(const GrindLoopData& loop_data);
+    void run_taring_phase(const GrindLoopData& loop_data);
+    void run_tare_confirm_phase(const GrindLoopData& loop_data);
+    void run_prime_phase(const GrindLoopData& loop_data);
+    void run_prime_settling_phase(const GrindLoopData& loop_data);
+    void run_strategy_phase(const GrindLoopData& loop_data);     // Active strategy, for the phase's strategy_mode
+    void run_final_settling_phase(const GrindLoopData& loop_data);
+    void run_time_additional_pulse_phase(const GrindLoopData& loop_data);
+    void run_completed_phase(const GrindLoopData& loop_data);
+    void run_timeout_phase(const GrindLoopData& loop_data);
 
     bool check_timeout() const;
     uint8_t get_current_phase_id() const;
@@ -245,6 +394,7 @@ private:
     
     // Core 0 control methods  
     bool should_log_measurements() const;
+    bool is_recording() const { return grind_logger.is_recording(grinder_channel); }   // This grinder's session is being recorded
     
     // Internal state methods (moved from public to prevent polling)
     bool show_taring_text() const { return phase == GrindPhase::INITIALIZING || phase == GrindPhase::SETUP || phase == GrindPhase::TARING || phase == GrindPhase::TARE_CONFIRM; }
@@ -0,0 +1,123 @@
+#include "grind_eta_predictor.h"
+#include "../logging/session_summary.h"
+#include <math.h>
+
+void GrindEtaPredictor::plan(GrindMode grind_mode, float target_weight, uint32_t time_ms, const SessionTrend* trend) {
+    mode = grind_mode;
+    target_time_ms = time_ms;
+    run_started = false;
+    run_start_ms = 0;
+    finish_valid = false;
+    finish_ms = 0.0f;
+    finish_band_ms = 0.0f;
+    eta = {};
+
+    if (mode == GrindMode::TIME) {
+        planned_ms = target_time_ms;
+        planned_band_ms = 0;
+        planned_latency_ms = 0;
+        planned_tail_ms = 0;
+        planned_pulse_ms = 0;
+        planned_coast_g = 0.0f;
+        return;
+    }
+
+    float run_ms;
+    float uncertainty;
+    if (trend && trend->session_count >= GRIND_ETA_MIN_TREND_SESSIONS && trend->mean_flow_g_per_s > 0.0f) {
+        planned_pulse_ms = trend->mean_pulse_settle_ms > 0.0f ? (uint32_t)trend->mean_pulse_settle_ms
+                                                              : GRIND_ETA_PULSE_SETTLE_FALLBACK_MS;
+        planned_latency_ms = (uint32_t)trend->mean_latency_ms;
+        planned_tail_ms = (uint32_t)(trend->mean_final_settle_ms + trend->mean_pulses * planned_pulse_ms);
+        planned_coast_g = trend->mean_coast_grams;
+        run_ms = fmaxf(target_weight - planned_coast_g, 0.0f) / trend->mean_flow_g_per_s * 1000.0f;
+        uncertainty = GRIND_ETA_PLAN_UNCERTAINTY;
+    } else {
+        planned_latency_ms = GRIND_ETA_REFERENCE_OVERHEAD_MS / 2;
+        planned_tail_ms = GRIND_ETA_REFERENCE_OVERHEAD_MS - planned_latency_ms;
+        planned_pulse_ms = GRIND_ETA_PULSE_SETTLE_FALLBACK_MS;
+        planned_coast_g = 0.0f;
+        run_ms = fmaxf(target_weight, 0.0f) / GRIND_ETA_REFERENCE_FLOW_GPS * 1000.0f;
+        uncertainty = 2.0f * GRIND_ETA_PLAN_UNCERTAINTY;
+    }
+    planned_ms = planned_latency_ms + (uint32_t)run_ms + planned_tail_ms;
+    planned_band_ms = (uint32_t)(planned_ms * uncertainty);
+}
+
+void GrindEtaPredictor::update(GrindPhase phase, uint32_t now_ms, float weight, float stop_target_weight,
+                               float flow_rate, float flow_confidence, float coast_g) {
+    switch (phase) {
+        case GrindPhase::IDLE:
+        case GrindPhase::COMPLETED:
+        case GrindPhase::TIMEOUT:
+        case GrindPhase::TIME_ADDITIONAL_PULSE:
+            eta = {};
+            return;
+        case GrindPhase::PREDICTIVE:
+        case GrindPhase::TIME_GRINDING:
+            if (!run_started) {
+                run_started = true;
+                run_start_ms = now_ms;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Taring and priming: the plan, not yet counting down
+    if (!run_started) {
+        eta.remaining_ms = planned_ms;
+        eta.band_ms = planned_band_ms;
+        eta.known = true;
+        return;
+    }
+
+    uint32_t elapsed_ms = now_ms - run_start_ms;
+    if (mode == GrindMode::TIME) {
+        set_remaining(elapsed_ms, (float)target_time_ms, 0.0f);
+        return;
+    }
+
+    if (phase == GrindPhase::PREDICTIVE) {
+        float candidate_ms;
+        float candidate_band_ms;
+        if (flow_rate < GRIND_FLOW_DETECTION_THRESHOLD_GPS) {
+            // Latency or a stall: no rate to extrapolate, hold the plan until grounds arrive
+            candidate_ms = fmaxf((float)planned_ms, (float)(elapsed_ms + planned_tail_ms));
+            candidate_band_ms = (float)planned_band_ms;
+        } else {
+            float to_stop_ms = fmaxf(stop_target_weight - weight - coast_g, 0.0f) / flow_rate * 1000.0f;
+            float uncertainty = fminf(fmaxf(1.0f - flow_confidence, GRIND_ETA_MIN_UNCERTAINTY), GRIND_ETA_MAX_UNCERTAINTY);
+            candidate_ms = elapsed_ms + to_stop_ms + planned_tail_ms;
+            candidate_band_ms = to_stop_ms * uncertainty + planned_tail_ms * GRIND_ETA_TAIL_UNCERTAINTY;
+        }
+        if (!finish_valid) {
+            finish_ms = candidate_ms;
+            finish_band_ms = candidate_band_ms;
+            finish_valid = true;
+        } else {
+            finish_ms += GRIND_ETA_SMOOTHING * (candidate_ms - finish_ms);
+            finish_band_ms += GRIND_ETA_SMOOTHING * (candidate_band_ms - finish_band_ms);
+        }
+        set_remaining(elapsed_ms, finish_ms, finish_band_ms);
+        return;
+    }
+
+    // Motor stopped (pulses and settling): count down the tail planned at the stop
+    if (!finish_valid) {
+        finish_ms = (float)(elapsed_ms + planned_tail_ms);
+        finish_valid = true;
+    }
+    // Past the planned tail: a pulse phase still needs at least one more pulse, settling finishes any moment
+    uint32_t floor_ms = phase == GrindPhase::FINAL_SETTLING ? 0 : planned_pulse_ms;
+    if (finish_ms < elapsed_ms + floor_ms) {
+        finish_ms = (float)(elapsed_ms + floor_ms);
+    }
+    set_remaining(elapsed_ms, finish_ms, (finish_ms - elapsed_ms) * GRIND_ETA_TAIL_UNCERTAINTY);
+}
+
+void GrindEtaPredictor::set_remaining(uint32_t elapsed_ms, float finish, float band) {
+    eta.remaining_ms = finish > elapsed_ms ? (uint32_t)(finish - elapsed_ms) : 0;
+    eta.band_ms = band > 0.0f ? (uint32_t)band : 0;
+    eta.known = true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/constants.h"
+#include "grind_mode.h"
+#include "grind_phase.h"
+
+struct SessionTrend;
+
+// Time left in the running session; known is false outside a session
+struct GrindEta {
+    uint32_t remaining_ms;
+    uint32_t band_ms;           // +/- around remaining_ms
+    bool known;
+};
+
+/**
+ * GrindEtaPredictor - Time-to-target estimate for the running session
+ *
+ * start_grind() plans the session from the newest weight mode summaries:
+ * latency, the target less the mean coast at the mean flow, the final settle
+ * and the mean pulses. The plan's late bound sizes the grinding chart's time
+ * axis once, before the first point. While the motor runs, update() replaces
+ * the plan with the grams still to go before the stop (learned coast
+ * included) over the live flow estimate, plus the expected settle and pulse
+ * tail. The finish time rather than the remaining time is smoothed, so the
+ * countdown ticks down steadily while the flow fluctuates. The band widens
+ * with a poor flow fit and with the share of the time left that is tail.
+ * Time mode counts down the profile time.
+ *
+ * plan() runs on Core 1 before the session starts; update() and get() run on
+ * Core 0 and the result reaches the UI through the progress event.
+ */
+class GrindEtaPredictor {
+public:
+    void plan(GrindMode mode, float target_weight, uint32_t target_time_ms, const SessionTrend* trend);
+    void update(GrindPhase phase, uint32_t now_ms, float weight, float stop_target_weight,
+                float flow_rate, float flow_confidence, float coast_g);
+
+    GrindEta get() const { return eta; }
+    uint32_t get_planned_ms() const { return planned_ms; }
+    uint32_t get_planned_band_ms() const { return planned_band_ms; }
+    float get_planned_coast_g() const { return planned_coast_g; }
+
+private:
+    GrindMode mode = GrindMode::WEIGHT;
+    uint32_t target_time_ms = 0;
+    uint32_t planned_ms = 0;            // Motor start to completion
+    uint32_t planned_band_ms = 0;
+    uint32_t planned_latency_ms = 0;
+    uint32_t planned_tail_ms = 0;       // Stop to completion: final settle and pulses
+    uint32_t planned_pulse_ms = 0;      // One correction pulse and its settle
+    float planned_coast_g = 0.0f;       // Mean coast from the history, for profiles without a trusted fit
+
+    bool run_started = false;
+    uint32_t run_start_ms = 0;
+    bool finish_valid = false;
+    float finish_ms = 0.0f;             // Smoothed completion time, relative to run_start_ms
+    float finish_band_ms = 0.0f;
+    GrindEta eta = {};
+
+    void set_remaining(uint32_t elapsed_ms, float finish, float band);
+};
@@ -24,9 +24,12 @@ struct GrindEventData {
     const char* phase_display_text;
     bool show_taring_text;
     float flow_rate;              // For PROGRESS_UPDATED event
+    GrindEta eta;                 // For PROGRESS_UPDATED event: time to target and its band
     
     // Additional data for specific events
     float final_weight;           // For COMPLETED event
+    float implied_weight;         // For COMPLETED event (time mode): stop weight + predicted coast
+    uint32_t calibrated_time_ms;  // For COMPLETED event (time mode): next profile time, 0 = unchanged
     const char* error_message;    // For TIMEOUT/ERROR event
     float error_weight;           // For TIMEOUT/ERROR event
     int error_progress;           // For TIMEOUT/ERROR event
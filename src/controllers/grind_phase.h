@@ -0,0 +1,21 @@
+#pragma once
+
+// Grind controller state machine phases
+enum class GrindPhase {
+    IDLE,               // Not grinding
+    INITIALIZING,       // Pre-initialization - emit UI event and prepare for grind
+    SETUP,              // Initialization - file system operations, logger setup
+    TARING,             // Performing tare operation
+    TARE_CONFIRM,       // Confirming tare completed
+    PREDICTIVE,         // Main grinding with flow prediction
+    PULSE_DECISION,     // Deciding if pulse correction needed
+    PULSE_EXECUTE,      // Executing precision pulse
+    PULSE_SETTLING,     // Waiting for weight to settle after pulse
+    FINAL_SETTLING,     // Waiting for weight to settle
+    TIME_GRINDING,      // Time-based grinding phase
+    TIME_ADDITIONAL_PULSE, // Additional pulse in time mode after completion
+    COMPLETED,          // Grind completed (success, overshoot, or max pulses)
+    TIMEOUT,            // Grind timed out
+    PRIME,              // Optional chute priming grind
+    PRIME_SETTLING      // Settling after priming grind
+};
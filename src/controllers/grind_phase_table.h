@@ -0,0 +1,90 @@
+#pragma once
+
+#include "grind_phase.h"
+#include "grind_mode.h"
+#include "../logging/grind_logging.h"
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr size_t GRIND_PHASE_COUNT = static_cast<size_t>(GrindPhase::PRIME_SETTLING) + 1;
+
+// Behaviour flags per phase
+enum GrindPhaseFlags : uint8_t {
+    GRIND_PHASE_FLAG_HIGH_RATE      = 1 << 0,  // ADC runs at its maximum rate
+    GRIND_PHASE_FLAG_STRATEGY       = 1 << 1,  // Ticks go to the active strategy for strategy_mode
+    GRIND_PHASE_FLAG_WEIGHT_GUARD   = 1 << 2,  // Negative weight failsafe is armed
+    GRIND_PHASE_FLAG_SESSION_TIMER  = 1 << 3,  // GRIND_TIMEOUT_SEC applies
+    GRIND_PHASE_FLAG_DECIMATED_LOG  = 1 << 4   // Steady flow: measurements every SYS_LOG_EVERY_N_GRIND_LOOPS outside triggers
+};
+
+// What switch_phase() records into the event of a phase when it ends (all record loop_count)
+enum class GrindPhaseEventRecord : uint8_t {
+    GENERAL,
+    PREDICTIVE,         // Stop target, latency, pulse flow
+    PULSE_EXECUTE,      // Pulse duration and attempt, pulse flow
+    PULSE_DECISION,     // Pulse flow
+    SETTLING            // settling_duration_ms, pulse flow
+};
+
+struct GrindPhaseTraits {
+    GrindPhase phase;
+    const char* name;                   // get_phase_name()
+    uint8_t flags;                      // GRIND_PHASE_FLAG_*
+    uint8_t event_flags;                // GRIND_EVENT_FLAG_* set on the phase's event when it starts
+    GrindPhaseEventRecord event_record;
+    GrindMode strategy_mode;            // Used with GRIND_PHASE_FLAG_STRATEGY
+};
+
+namespace grind_phase_table {
+constexpr uint8_t ACTIVE = GRIND_PHASE_FLAG_WEIGHT_GUARD | GRIND_PHASE_FLAG_SESSION_TIMER;
+constexpr uint8_t MOTOR = GRIND_EVENT_FLAG_MOTOR_ACTIVE;
+constexpr uint8_t PULSE = GRIND_EVENT_FLAG_PULSE_PHASE;
+
+// Indexed by GrindPhase
+constexpr GrindPhaseTraits TRAITS[] = {
+    { GrindPhase::IDLE,                  "IDLE",           0, 0, GrindPhaseEventRecord::GENERAL, GrindMode::WEIGHT },
+    { GrindPhase::INITIALIZING,          "INITIALIZING",   GRIND_PHASE_FLAG_SESSION_TIMER, 0, GrindPhaseEventRecord::GENERAL, GrindMode::WEIGHT },
+    { GrindPhase::SETUP,                 "SETUP",          GRIND_PHASE_FLAG_SESSION_TIMER, 0, GrindPhaseEventRecord::GENERAL, GrindMode::WEIGHT },
+    { GrindPhase::TARING,                "TARING",         GRIND_PHASE_FLAG_SESSION_TIMER, 0, GrindPhaseEventRecord::GENERAL, GrindMode::WEIGHT },
+    { GrindPhase::TARE_CONFIRM,          "TARE_CONFIRM",   GRIND_PHASE_FLAG_SESSION_TIMER, 0, GrindPhaseEventRecord::GENERAL, GrindMode::WEIGHT },
+    { GrindPhase::PREDICTIVE,            "PREDICTIVE",     ACTIVE | GRIND_PHASE_FLAG_HIGH_RATE | GRIND_PHASE_FLAG_STRATEGY | GRIND_PHASE_FLAG_DECIMATED_LOG, MOTOR,
+      GrindPhaseEventRecord::PREDICTIVE, GrindMode::WEIGHT },
+    { GrindPhase::PULSE_DECISION,        "PULSE_DECISION", ACTIVE | GRIND_PHASE_FLAG_HIGH_RATE | GRIND_PHASE_FLAG_STRATEGY, 0,
+      GrindPhaseEventRecord::PULSE_DECISION, GrindMode::WEIGHT },
+    { GrindPhase::PULSE_EXECUTE,         "PULSE_EXECUTE",  ACTIVE | GRIND_PHASE_FLAG_HIGH_RATE | GRIND_PHASE_FLAG_STRATEGY, MOTOR | PULSE,
+      GrindPhaseEventRecord::PULSE_EXECUTE, GrindMode::WEIGHT },
+    { GrindPhase::PULSE_SETTLING,        "PULSE_SETTLING", ACTIVE | GRIND_PHASE_FLAG_HIGH_RATE | GRIND_PHASE_FLAG_STRATEGY, PULSE,
+      GrindPhaseEventRecord::SETTLING, GrindMode::WEIGHT },
+    { GrindPhase::FINAL_SETTLING,        "FINAL_SETTLING", ACTIVE | GRIND_PHASE_FLAG_HIGH_RATE, 0, GrindPhaseEventRecord::SETTLING, GrindMode::WEIGHT },
+    { GrindPhase::TIME_GRINDING,         "TIME",           ACTIVE | GRIND_PHASE_FLAG_STRATEGY | GRIND_PHASE_FLAG_DECIMATED_LOG, MOTOR, GrindPhaseEventRecord::GENERAL, GrindMode::TIME },
+    { GrindPhase::TIME_ADDITIONAL_PULSE, "PULSE",          ACTIVE, 0, GrindPhaseEventRecord::GENERAL, GrindMode::TIME },
+    { GrindPhase::COMPLETED,             "COMPLETED",      0, 0, GrindPhaseEventRecord::GENERAL, GrindMode::WEIGHT },
+    { GrindPhase::TIMEOUT,               "TIMEOUT",        0, 0, GrindPhaseEventRecord::GENERAL, GrindMode::WEIGHT },
+    { GrindPhase::PRIME,                 "PRIME",          ACTIVE, MOTOR, GrindPhaseEventRecord::GENERAL, GrindMode::WEIGHT },
+    { GrindPhase::PRIME_SETTLING,        "PRIME_SETTLING", ACTIVE, 0, GrindPhaseEventRecord::SETTLING, GrindMode::WEIGHT },
+};
+
+constexpr bool is_in_phase_order() {
+    for (size_t i = 0; i < sizeof(TRAITS) / sizeof(TRAITS[0]); i++) {
+        if (static_cast<size_t>(TRAITS[i].phase) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(sizeof(TRAITS) / sizeof(TRAITS[0]) == GRIND_PHASE_COUNT, "One GrindPhaseTraits row per GrindPhase");
+static_assert(is_in_phase_order(), "GrindPhaseTraits rows must follow GrindPhase order");
+}
+
+constexpr bool is_valid_grind_phase(GrindPhase phase) {
+    return static_cast<size_t>(phase) < GRIND_PHASE_COUNT;
+}
+
+// Callers check is_valid_grind_phase() for values that did not come from the enum
+constexpr const GrindPhaseTraits& get_grind_phase_traits(GrindPhase phase) {
+    return grind_phase_table::TRAITS[static_cast<size_t>(phase)];
+}
+
+constexpr bool grind_phase_has_flag(GrindPhase phase, GrindPhaseFlags flag) {
+    return (get_grind_phase_traits(phase).flags & flag) != 0;
+}
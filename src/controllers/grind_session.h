@@ -9,4 +9,11 @@ struct GrindSessionDescriptor {
     uint32_t target_time_ms = 0;     // milliseconds
     float tolerance = 0.0f;          // grams
     uint8_t profile_id = 0;          // active profile index
+    uint32_t start_us = 0;           // esp_timer µs (low 32 bits) that measurement sample times are relative to
+    bool bulk = false;               // Weight mode at or above GRIND_BULK_MIN_TARGET_G (BulkGrindStrategy)
+    uint32_t timeout_ms = 0;         // Session limit (GRIND_TIMEOUT_SEC, GRIND_BULK_TIMEOUT_SEC in bulk mode)
+    uint8_t max_pulse_attempts = 0;  // Correction pulses before the result stands
+    uint32_t flow_detection_window_ms = 0;   // FlowWindows the session runs with
+    uint32_t flow_prediction_window_ms = 0;
+    uint8_t grinder_channel = 0;     // GrindChannels index of the grinder running the session
 };
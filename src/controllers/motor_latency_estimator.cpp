@@ -0,0 +1,59 @@
+#include "motor_latency_estimator.h"
+#include <algorithm>
+#include <math.h>
+
+void MotorLatencyEstimator::reset(float latency_ms_in) {
+    latency_ms = latency_ms_in;
+    deviation_ms = GRIND_LATENCY_LEARN_INITIAL_DEVIATION_MS;
+    last_median_ms = 0.0f;
+    accepted_sessions = 0;
+    outlier_run = 0;
+}
+
+bool MotorLatencyEstimator::observe_session(const float* duration_ms, const float* delivered_g, uint8_t count,
+                                            float flow_gps) {
+    last_median_ms = 0.0f;
+    if (!duration_ms || !delivered_g || flow_gps < GRIND_FLOW_RATE_MIN_SANE_GPS || flow_gps > GRIND_FLOW_RATE_MAX_SANE_GPS) {
+        return false;
+    }
+
+    float dead_ms[GRIND_MAX_PULSE_ATTEMPTS];
+    uint8_t used = 0;
+    for (uint8_t i = 0; i < count && used < GRIND_MAX_PULSE_ATTEMPTS; i++) {
+        if (!isfinite(delivered_g[i]) || delivered_g[i] < GRIND_LATENCY_LEARN_MIN_DELIVERED_G) {
+            continue;
+        }
+        float candidate = duration_ms[i] - delivered_g[i] / flow_gps * 1000.0f;
+        if (candidate >= GRIND_AUTOTUNE_LATENCY_MIN_MS && candidate <= GRIND_AUTOTUNE_LATENCY_MAX_MS) {
+            dead_ms[used++] = candidate;
+        }
+    }
+    if (used == 0) {
+        return false;
+    }
+
+    std::sort(dead_ms, dead_ms + used);
+    float median = (used & 1) ? dead_ms[used / 2] : 0.5f * (dead_ms[used / 2 - 1] + dead_ms[used / 2]);
+    last_median_ms = median;
+
+    // 1.25 x mean absolute deviation ~ one sigma for normal scatter
+    float residual = median - latency_ms;
+    float gate = std::max(GRIND_LATENCY_LEARN_GATE_SIGMAS * 1.25f * deviation_ms, GRIND_LATENCY_LEARN_MIN_GATE_MS);
+    if (fabsf(residual) > gate && ++outlier_run < GRIND_LATENCY_LEARN_OUTLIER_RUN) {
+        return false;
+    }
+
+    if (outlier_run >= GRIND_LATENCY_LEARN_OUTLIER_RUN) {
+        // A run of outliers: the motor, relay or beans changed, start over from here
+        latency_ms = median;
+        deviation_ms = GRIND_LATENCY_LEARN_INITIAL_DEVIATION_MS;
+    } else {
+        latency_ms += GRIND_LATENCY_LEARN_GAIN * residual;
+        deviation_ms += GRIND_LATENCY_LEARN_GAIN * (fabsf(residual) - deviation_ms);
+    }
+    outlier_run = 0;
+    if (accepted_sessions < UINT16_MAX) {
+        accepted_sessions++;
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/constants.h"
+
+/**
+ * MotorLatencyEstimator - Motor response latency from the pulses of everyday grinds
+ *
+ * A correction pulse of d ms that lands g grams at the pulse flow f implies
+ * d - 1000 g / f ms of dead time, the same model the pulse sizing inverts
+ * (latency + productive time). Each completed weight session gives the median
+ * of its pulses' dead times; pulses below GRIND_LATENCY_LEARN_MIN_DELIVERED_G
+ * only bound the latency from below and are skipped. A session median more
+ * than GRIND_LATENCY_LEARN_GATE_SIGMAS running deviations from the estimate is
+ * an outlier (a bumped cup, beans stuck in the throat) and is dropped, unless
+ * GRIND_LATENCY_LEARN_OUTLIER_RUN arrive in a row, which is taken as a real
+ * change (new motor, relay or beans) and accepted. Accepted medians are
+ * smoothed in; after GRIND_LATENCY_LEARN_MIN_SESSIONS the estimate is ready
+ * to replace the stored latency, so the interactive autotune is optional.
+ *
+ * RAM only: it restarts from the stored latency at boot. Core 0 (grind
+ * control task) only.
+ */
+class MotorLatencyEstimator {
+public:
+    void reset(float latency_ms);
+
+    // One session's pulses (commanded ms, settled grams, pulse flow); true when a median was accepted
+    bool observe_session(const float* duration_ms, const float* delivered_g, uint8_t count, float flow_gps);
+
+    bool is_ready() const { return accepted_sessions >= GRIND_LATENCY_LEARN_MIN_SESSIONS; }
+    float get_latency_ms() const { return latency_ms; }
+    float get_deviation_ms() const { return deviation_ms; }
+    uint16_t get_accepted_sessions() const { return accepted_sessions; }
+    float get_last_median_ms() const { return last_median_ms; }     // Of the last observe_session(), 0 = no usable pulses
+
+private:
+    float latency_ms = GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS;
+    float deviation_ms = GRIND_LATENCY_LEARN_INITIAL_DEVIATION_MS;   // Smoothed |median - estimate|
+    float last_median_ms = 0.0f;
+    uint16_t accepted_sessions = 0;
+    uint8_t outlier_run = 0;
+};
@@ -0,0 +1,159 @@
+#include "order_queue.h"
+#include "../logging/grind_logging.h"
+
+OrderQueue order_queue;
+
+const char* grind_order_status_name(GrindOrderStatus status) {
+    switch (status) {
+        case GrindOrderStatus::QUEUED:    return "queued";
+        case GrindOrderStatus::REJECTED:  return "rejected";
+        case GrindOrderStatus::STARTED:   return "started";
+        case GrindOrderStatus::DONE:      return "done";
+        case GrindOrderStatus::FAILED:    return "failed";
+        case GrindOrderStatus::CANCELLED: return "cancelled";
+    }
+    return "unknown";
+}
+
+OrderQueue::OrderQueue() {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+bool OrderQueue::submit(const GrindOrder& order) {
+    bool valid = order.order_id != 0 && order.count >= 1 && order.count <= USER_BATCH_MAX_DOSES &&
+                 order.profile < USER_PROFILE_COUNT && order.weight_g >= 0.0f;
+    bool accepted = false;
+    if (valid) {
+        portENTER_CRITICAL(&lock);
+        if (order_count < USER_ORDER_QUEUE_LENGTH) {
+            orders[(order_head + order_count) % USER_ORDER_QUEUE_LENGTH] = order;
+            order_count++;
+            accepted = true;
+        }
+        portEXIT_CRITICAL(&lock);
+    }
+    emit(order.order_id, accepted ? GrindOrderStatus::QUEUED : GrindOrderStatus::REJECTED, order.count, 0, 0.0f, 0.0f);
+    if (accepted && consumer) {
+        xTaskNotify(consumer, SYS_UI_WAKE_NOTIFY_BIT, eSetBits);
+    }
+    return accepted;
+}
+
+uint8_t OrderQueue::cancel(uint32_t order_id) {
+    GrindOrder dropped[USER_ORDER_QUEUE_LENGTH];
+    uint8_t dropped_count = 0;
+    portENTER_CRITICAL(&lock);
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < order_count; i++) {
+        const GrindOrder& order = orders[(order_head + i) % USER_ORDER_QUEUE_LENGTH];
+        if (order_id == 0 || order.order_id == order_id) {
+            dropped[dropped_count++] = order;
+        } else {
+            orders[(order_head + kept++) % USER_ORDER_QUEUE_LENGTH] = order;
+        }
+    }
+    order_count = kept;
+    portEXIT_CRITICAL(&lock);
+
+    for (uint8_t i = 0; i < dropped_count; i++) {
+        emit(dropped[i].order_id, GrindOrderStatus::CANCELLED, dropped[i].count, 0, 0.0f, 0.0f);
+    }
+    uint32_t active_order = active_id.load(std::memory_order_relaxed);
+    if (active_order != 0 && (order_id == 0 || order_id == active_order)) {
+        cancel_requested.store(true, std::memory_order_release);
+        dropped_count++;
+        if (consumer) {
+            xTaskNotify(consumer, SYS_UI_WAKE_NOTIFY_BIT, eSetBits);
+        }
+    }
+    return dropped_count;
+}
+
+uint8_t OrderQueue::get_pending_count() const {
+    portENTER_CRITICAL(&lock);
+    uint8_t count = order_count;
+    portEXIT_CRITICAL(&lock);
+    return count;
+}
+
+bool OrderQueue::take_event(GrindOrderEvent* out) {
+    portENTER_CRITICAL(&lock);
+    bool taken = event_count > 0;
+    if (taken) {
+        *out = events[event_head];
+        event_head = (event_head + 1) % USER_ORDER_EVENT_BACKLOG;
+        event_count--;
+    }
+    portEXIT_CRITICAL(&lock);
+    return taken;
+}
+
+bool OrderQueue::take_next(GrindOrder* out) {
+    if (has_active()) {
+        return false;
+    }
+    portENTER_CRITICAL(&lock);
+    bool taken = order_count > 0;
+    if (taken) {
+        active = orders[order_head];
+        order_head = (order_head + 1) % USER_ORDER_QUEUE_LENGTH;
+        order_count--;
+        // Published inside the lock, so a cancel finds the order either queued or active
+        active_id.store(active.order_id, std::memory_order_relaxed);
+    }
+    portEXIT_CRITICAL(&lock);
+    if (!taken) {
+        return false;
+    }
+    cancel_requested.store(false, std::memory_order_relaxed);
+    active_completed = 0;
+    active_target_g = 0.0f;
+    active_total_g = 0.0f;
+    *out = active;
+    return true;
+}
+
+void OrderQueue::start(float target_g) {
+    active_target_g = target_g;
+    emit(active.order_id, GrindOrderStatus::STARTED, active.count, 0, target_g, 0.0f);
+}
+
+void OrderQueue::add_dose(float final_weight_g) {
+    active_completed++;
+    active_total_g += final_weight_g;
+    LOG_BLE("[ORDER] %lu: dose %u/%u %.2fg\n", (unsigned long)active.order_id, (unsigned)active_completed,
+            (unsigned)active.count, final_weight_g);
+}
+
+void OrderQueue::finish(GrindOrderStatus status) {
+    if (!has_active()) {
+        return;
+    }
+    emit(active.order_id, status, active.count, active_completed, active_target_g, active_total_g);
+    active_id.store(0, std::memory_order_relaxed);
+    cancel_requested.store(false, std::memory_order_relaxed);
+}
+
+void OrderQueue::emit(uint32_t order_id, GrindOrderStatus status, uint8_t count, uint8_t completed,
+                      float target_g, float total_g) {
+    GrindOrderEvent event;
+    event.order_id = order_id;
+    event.status = status;
+    event.count = count;
+    event.completed = completed;
+    event.target_g = target_g;
+    event.total_g = total_g;
+
+    portENTER_CRITICAL(&lock);
+    event.pending = order_count;
+    if (event_count == USER_ORDER_EVENT_BACKLOG) {
+        event_head = (event_head + 1) % USER_ORDER_EVENT_BACKLOG;   // Oldest unpublished event goes
+        event_count--;
+    }
+    events[(event_head + event_count) % USER_ORDER_EVENT_BACKLOG] = event;
+    event_count++;
+    portEXIT_CRITICAL(&lock);
+
+    LOG_BLE("[ORDER] %lu: %s, %u/%u doses, %.2fg, %u waiting\n", (unsigned long)order_id,
+            grind_order_status_name(status), (unsigned)completed, (unsigned)count, total_g, (unsigned)event.pending);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "../config/constants.h"
+
+// A remote grind order: `count` doses of one profile, each started by placing a cup
+struct GrindOrder {
+    uint32_t order_id;              // Chosen by the sender (POS ticket number); 0 is not an id
+    int8_t profile;                 // Profile tab, -1: the one selected
+    int16_t stored_profile;         // Profile store id recalled into the tab first, -1: none
+    float weight_g;                 // Target for the tab, 0: the tab's own
+    uint8_t count;                  // Doses, 1..USER_BATCH_MAX_DOSES
+};
+
+enum class GrindOrderStatus : uint8_t {
+    QUEUED,                         // Accepted
+    REJECTED,                       // Queue full or malformed; nothing is ground for it
+    STARTED,                        // Profile applied, waiting for the first cup
+    DONE,                           // Every dose completed
+    FAILED,                         // A dose timed out; the remaining doses were not ground
+    CANCELLED                       // Stopped on the grinder, or cancelled remotely
+};
+
+// One step of an order, reported on the MQTT order topic and in the log
+struct GrindOrderEvent {
+    uint32_t order_id;
+    GrindOrderStatus status;
+    uint8_t count;
+    uint8_t completed;              // Doses completed so far
+    uint8_t pending;                // Orders queued and not yet taken, this one included while QUEUED
+    float target_g;                 // Dose target once STARTED, 0 for time mode
+    float total_g;                  // Sum of the completed doses' final weights
+};
+
+/**
+ * OrderQueue - Grind orders from a point of sale, worked off one cup at a time
+ *
+ * submit() and cancel() may be called from any task (the esp-mqtt task for
+ * cmd/order, the BLE host for BLE_DEBUG_CMD_GRIND_ORDER); the orders wait in a
+ * ring of USER_ORDER_QUEUE_LENGTH under a spinlock, and the UI task is woken.
+ * The UI task (UIManager::update_orders()) takes the next one whenever the
+ * Ready screen is idle, applies its profile like the matching MQTT command and
+ * opens a batch of `count` doses, so cup placement starts each dose and cup
+ * removal returns to Ready exactly as in batch mode, with no touch input. It
+ * reports each dose with add_dose() and closes the order with finish().
+ *
+ * Every status change becomes a GrindOrderEvent: logged (which reaches BLE
+ * debug clients) and held in a ring of USER_ORDER_EVENT_BACKLOG, oldest
+ * dropped, for the MQTT task to publish (take_event()).
+ */
+class OrderQueue {
+public:
+    OrderQueue();
+
+    // Any task
+    bool submit(const GrindOrder& order);       // false: rejected (full, bad count or id), event sent
+    uint8_t cancel(uint32_t order_id);          // 0: every order; queued ones are dropped, the active one
+                                                // ends after its running dose. Returns the orders hit
+    void set_consumer(TaskHandle_t task) { consumer = task; }
+    uint8_t get_pending_count() const;
+    bool take_event(GrindOrderEvent* out);      // MQTT task: oldest unpublished event
+
+    // UI task
+    bool take_next(GrindOrder* out);            // Pops the next order and makes it the active one
+    void start(float target_g);                 // The active order's profile is applied
+    void add_dose(float final_weight_g);        // A dose of the active order completed
+    void finish(GrindOrderStatus status);       // Ends the active order
+    bool has_active() const { return active_id.load(std::memory_order_relaxed) != 0; }
+    const GrindOrder& get_active() const { return active; }
+    uint8_t get_active_completed() const { return active_completed; }
+    bool is_cancel_requested() const { return cancel_requested.load(std::memory_order_acquire); }
+
+private:
+    mutable portMUX_TYPE lock;
+    TaskHandle_t consumer = nullptr;
+
+    // Under lock
+    GrindOrder orders[USER_ORDER_QUEUE_LENGTH];
+    uint8_t order_head = 0;
+    uint8_t order_count = 0;
+    GrindOrderEvent events[USER_ORDER_EVENT_BACKLOG];
+    uint8_t event_head = 0;
+    uint8_t event_count = 0;
+
+    // Active order: written by the UI task, active_id and cancel_requested read by any
+    GrindOrder active = {};
+    std::atomic<uint32_t> active_id{0};
+    std::atomic<bool> cancel_requested{false};
+    uint8_t active_completed = 0;
+    float active_target_g = 0.0f;
+    float active_total_g = 0.0f;
+
+    void emit(uint32_t order_id, GrindOrderStatus status, uint8_t count, uint8_t completed, float target_g, float total_g);
+};
+
+const char* grind_order_status_name(GrindOrderStatus status);
+
+extern OrderQueue order_queue;
@@ -0,0 +1,138 @@
+#include "predictive_model_grind_strategy.h"
+
+#include "grind_controller.h"
+#include "../hardware/WeightSensor.h"
+#include "../hardware/grinder.h"
+#include "../logging/grind_logging.h"
+#include "../config/constants.h"
+#include <Arduino.h>
+#include <math.h>
+
+void PredictiveModelGrindStrategy::on_enter(const GrindSessionDescriptor&, GrindStrategyContext&, const GrindLoopData&) {
+    flow_slope_gps2 = 0.0f;
+    last_flow_rate = 0.0f;
+    last_flow_sample_us = 0;
+    flow_history_valid = false;
+}
+
+bool PredictiveModelGrindStrategy::update(const GrindSessionDescriptor& session,
+                                          GrindStrategyContext& context,
+                                          const GrindLoopData& loop_data) {
+    auto* controller = context.controller;
+    if (!controller) {
+        return false;
+    }
+
+    if (controller->phase == GrindPhase::PREDICTIVE) {
+        run_model_predictive_phase(*controller, loop_data);
+        return true;
+    }
+    return WeightGrindStrategy::update(session, context, loop_data);
+}
+
+void PredictiveModelGrindStrategy::run_model_predictive_phase(GrindController& controller,
+                                                              const GrindLoopData& loop_data) {
+    if (!controller.weight_sensor || !controller.grinder) {
+        return;
+    }
+
+    // Armed stop: wait for the timer to cut the relay, then complete the stop here
+    if (controller.grinder->has_scheduled_stop()) {
+        if (is_scheduled_stop_complete(controller)) {
+            finish_predictive_stop(controller, loop_data, scheduled_stop_weight, scheduled_stop_flow_rate);
+        }
+        return;
+    }
+
+    confirm_flow_start(controller, loop_data);
+    update_flow_slope(loop_data);
+
+    float weight = loop_data.estimate_valid ? loop_data.estimated_weight : loop_data.current_weight;
+    float flow_rate = loop_data.estimate_valid ? loop_data.estimated_flow_rate : loop_data.flow_rate_prediction;
+    flow_rate = controller.blend_warm_start_flow(flow_rate, loop_data.now);   // Profile history until the estimate has a window behind it
+
+    if (!controller.flow_start_confirmed || !loop_data.estimate_valid || flow_rate < GRIND_FLOW_DETECTION_THRESHOLD_GPS) {
+        // No trajectory to project yet; the undershoot threshold still guards small targets
+        if (weight >= controller.get_stop_target_weight() - controller.motor_stop_target_weight) {
+            finish_predictive_stop(controller, loop_data, weight, flow_rate);
+        }
+        return;
+    }
+
+    float coast_offset_g = 0.0f;
+    float coast_s = 0.0f;
+    get_coast_response(controller, &coast_offset_g, &coast_s);
+    float flow_slope = constrain(flow_slope_gps2, -GRIND_STATE_ESTIMATOR_FLOW_ACCEL_GPS2, GRIND_STATE_ESTIMATOR_FLOW_ACCEL_GPS2);
+    controller.motor_stop_target_weight = coast_offset_g + flow_rate * coast_s;   // Logged with each measurement
+    apply_soft_stop(controller, weight, controller.get_stop_target_weight() - controller.motor_stop_target_weight);
+
+    float delay_s = 0.0f;
+    if (!predict_stop_delay_s(controller.get_stop_target_weight() - coast_offset_g - weight, flow_rate, flow_slope, coast_s, &delay_s)) {
+        return;
+    }
+
+    // Beyond this tick the next one re-predicts from fresher samples
+    if (delay_s >= controller.get_control_interval_ms() / 1000.0f) {
+        return;
+    }
+
+    if (schedule_stop_within_tick(controller, delay_s)) {
+        scheduled_stop_weight = weight + flow_rate * delay_s + 0.5f * flow_slope * delay_s * delay_s;
+        scheduled_stop_flow_rate = flow_rate + flow_slope * delay_s;
+        LOG_RT("[PREDICTIVE] Stop scheduled in %.1fms (%.2fg, %.2fg/s, coast %.0fms)\n",
+                delay_s * 1000.0f, weight, flow_rate, coast_s * 1000.0f);
+        return;
+    }
+
+    // Crossing is due now (or no timer): stop on this tick
+    finish_predictive_stop(controller, loop_data, weight, flow_rate);
+}
+
+void PredictiveModelGrindStrategy::update_flow_slope(const GrindLoopData& loop_data) {
+    if (!loop_data.estimate_valid) {
+        flow_history_valid = false;
+        return;
+    }
+
+    if (flow_history_valid) {
+        int32_t elapsed_us = (int32_t)(loop_data.sample_timestamp_us - last_flow_sample_us);
+        if (elapsed_us <= 0) {
+            return;     // No new sample since the last tick
+        }
+        float slope = (loop_data.estimated_flow_rate - last_flow_rate) * 1000000.0f / elapsed_us;
+        flow_slope_gps2 += GRIND_PREDICTIVE_MODEL_FLOW_SLOPE_SMOOTHING * (slope - flow_slope_gps2);
+    }
+    last_flow_rate = loop_data.estimated_flow_rate;
+    last_flow_sample_us = loop_data.sample_timestamp_us;
+    flow_history_valid = true;
+}
+
+void PredictiveModelGrindStrategy::get_coast_response(const GrindController& controller,
+                                                      float* offset_g_out, float* seconds_out) const {
+    if (controller.coast_model.get_coefficients(controller.current_profile_id, offset_g_out, seconds_out)) {
+        return;
+    }
+    // Until the profile's fit is trusted, the fixed-ratio guess of the weight strategy
+    *offset_g_out = 0.0f;
+    *seconds_out = (controller.grind_latency_ms * GRIND_LATENCY_TO_COAST_RATIO) / (float)SYS_MS_PER_SECOND;
+}
+
+bool PredictiveModelGrindStrategy::predict_stop_delay_s(float remaining_g, float flow_rate, float flow_slope,
+                                                        float coast_s, float* delay_s_out) {
+    // Settled weight when stopping after t: flow*t + slope*t^2/2 + (flow + slope*t)*coast.
+    // Solve for remaining_g; the form below is the smaller positive root and is exact for slope = 0.
+    float remaining_after_coast = remaining_g - flow_rate * coast_s;
+    if (remaining_after_coast <= 0.0f) {
+        *delay_s_out = 0.0f;
+        return true;
+    }
+
+    float rate_now = flow_rate + flow_slope * coast_s;
+    float discriminant = rate_now * rate_now + 2.0f * flow_slope * remaining_after_coast;
+    if (rate_now <= 0.0f || discriminant < 0.0f) {
+        return false;
+    }
+
+    *delay_s_out = 2.0f * remaining_after_coast / (rate_now + sqrtf(discriminant));
+    return true;
+}
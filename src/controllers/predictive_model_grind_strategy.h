@@ -0,0 +1,43 @@
+#pragma once
+
+#include "weight_grind_strategy.h"
+
+// Weight mode with a model-predictive stop: instead of comparing against
+// target - latency * ratio * flow each tick, project the settled weight
+// (weight + flow trajectory + the profile's learned CoastModel) and cut the
+// motor at the predicted crossing with a one-shot timer inside the tick.
+// Pulse phases are the WeightGrindStrategy ones.
+class PredictiveModelGrindStrategy : public WeightGrindStrategy {
+public:
+    PredictiveModelGrindStrategy() = default;
+
+    void on_enter(const GrindSessionDescriptor& session,
+                  GrindStrategyContext& context,
+                  const GrindLoopData& loop_data) override;
+
+    bool update(const GrindSessionDescriptor& session,
+                GrindStrategyContext& context,
+                const GrindLoopData& loop_data) override;
+
+    const char* name() const override { return "PredictiveModel"; }
+
+private:
+    void run_model_predictive_phase(GrindController& controller, const GrindLoopData& loop_data);
+    void update_flow_slope(const GrindLoopData& loop_data);
+    // coast_g = offset_g + seconds * flow at the stop
+    void get_coast_response(const GrindController& controller, float* offset_g_out, float* seconds_out) const;
+
+    // Seconds from now until stopping lands on remaining_g, false if the projected flow dies out first
+    static bool predict_stop_delay_s(float remaining_g, float flow_rate, float flow_slope,
+                                     float coast_s, float* delay_s_out);
+
+    // Flow trajectory (per session)
+    float flow_slope_gps2 = 0.0f;
+    float last_flow_rate = 0.0f;
+    uint32_t last_flow_sample_us = 0;
+    bool flow_history_valid = false;
+
+    // Projected state at an armed stop
+    float scheduled_stop_weight = 0.0f;
+    float scheduled_stop_flow_rate = 0.0f;
+};
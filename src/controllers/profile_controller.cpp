@@ -2,6 +2,20 @@
 #include <Arduino.h>
 #include <string.h>
 #include <Preferences.h>
+#include "../system/preference_cache.h"
+#include "../system/config_store.h"
+#include "grind_controller.h"
+#include "profile_store.h"
+
+namespace {
+ConfigFloat profile_weight_key(int index) {
+    return static_cast<ConfigFloat>(static_cast<int>(ConfigFloat::PROFILE_WEIGHT_0) + index);
+}
+
+ConfigFloat profile_time_key(int index) {
+    return static_cast<ConfigFloat>(static_cast<int>(ConfigFloat::PROFILE_TIME_0) + index);
+}
+}
 
 void ProfileController::init(Preferences* prefs) {
     preferences = prefs;
@@ -21,24 +35,39 @@ void ProfileController::init(Preferences* prefs) {
     
     // Initialize default grind mode
     current_grind_mode = GrindMode::WEIGHT;
+    batch_doses = 1;
+    for (int i = 0; i < USER_PROFILE_COUNT; i++) {
+        linked_profiles[i] = -1;
+    }
     
     load_profiles();
 }
 
 void ProfileController::load_profiles() {
-    current_profile = preferences->getInt("profile", 1);
-    
-    profiles[0].weight = preferences->getFloat("weight0", USER_SINGLE_ESPRESSO_WEIGHT_G);
-    profiles[1].weight = preferences->getFloat("weight1", USER_DOUBLE_ESPRESSO_WEIGHT_G);
-    profiles[2].weight = preferences->getFloat("weight2", USER_CUSTOM_PROFILE_WEIGHT_G);
-
-    profiles[0].time_seconds = preferences->getFloat("time0", USER_SINGLE_ESPRESSO_TIME_S);
-    profiles[1].time_seconds = preferences->getFloat("time1", USER_DOUBLE_ESPRESSO_TIME_S);
-    profiles[2].time_seconds = preferences->getFloat("time2", USER_CUSTOM_PROFILE_TIME_S);
-    
-    // Load grind mode (default to WEIGHT if not set)
-    int stored_mode = preferences->getInt("grind_mode", static_cast<int>(GrindMode::WEIGHT));
-    current_grind_mode = static_cast<GrindMode>(stored_mode);
+    // Targets, mode and batch size come from the configuration blob (ConfigStore), read once at boot
+    current_profile = config_store.get_byte(ConfigByte::PROFILE);
+    for (int i = 0; i < USER_PROFILE_COUNT; i++) {
+        profiles[i].weight = config_store.get_float(profile_weight_key(i));
+        profiles[i].time_seconds = config_store.get_float(profile_time_key(i));
+    }
+    current_grind_mode = static_cast<GrindMode>(config_store.get_byte(ConfigByte::GRIND_MODE));
+    batch_doses = constrain(config_store.get_byte(ConfigByte::BATCH_DOSES), 1, USER_BATCH_MAX_DOSES);
+
+    // Names and links of tabs recalled from the profile store; the name only exists with a link
+    for (int i = 0; i < USER_PROFILE_COUNT; i++) {
+        char key[16];
+        snprintf(key, sizeof(key), "plink%d", i);
+        int link = preferences->getInt(key, 0) - 1;
+        linked_profiles[i] = (link >= 0 && link < USER_PROFILE_STORE_CAPACITY) ? link : -1;
+        if (linked_profiles[i] < 0) {
+            continue;
+        }
+        snprintf(key, sizeof(key), "pname%d", i);
+        char name[USER_PROFILE_NAME_MAX_LENGTH];
+        if (preferences->getString(key, name, sizeof(name)) > 0 && name[0]) {
+            snprintf(profiles[i].name, sizeof(profiles[i].name), "%s", name);
+        }
+    }
     
     if (current_profile < 0 || current_profile >= USER_PROFILE_COUNT) {
         current_profile = 1;
@@ -46,17 +75,14 @@ void ProfileController::load_profiles() {
 }
 
 void ProfileController::save_profiles() {
-    preferences->putFloat("weight0", profiles[0].weight);
-    preferences->putFloat("weight1", profiles[1].weight);
-    preferences->putFloat("weight2", profiles[2].weight);
-
-    preferences->putFloat("time0", profiles[0].time_seconds);
-    preferences->putFloat("time1", profiles[1].time_seconds);
-    preferences->putFloat("time2", profiles[2].time_seconds);
+    for (int i = 0; i < USER_PROFILE_COUNT; i++) {
+        config_store.set_float(profile_weight_key(i), profiles[i].weight);
+        config_store.set_float(profile_time_key(i), profiles[i].time_seconds);
+    }
 }
 
 void ProfileController::save_current_profile() {
-    preferences->putInt("profile", current_profile);
+    config_store.set_byte(ConfigByte::PROFILE, (uint8_t)current_profile);
     save_profiles();
 }
 
@@ -140,5 +166,88 @@ void ProfileController::set_grind_mode(GrindMode mode) {
 }
 
 void ProfileController::save_grind_mode() {
-    preferences->putInt("grind_mode", static_cast<int>(current_grind_mode));
+    config_store.set_byte(ConfigByte::GRIND_MODE, static_cast<uint8_t>(current_grind_mode));
+}
+
+void ProfileController::set_batch_doses(int doses) {
+    batch_doses = constrain(doses, 1, USER_BATCH_MAX_DOSES);
+    config_store.set_byte(ConfigByte::BATCH_DOSES, (uint8_t)batch_doses);
+}
+
+int ProfileController::get_linked_profile(int index) const {
+    if (index >= 0 && index < USER_PROFILE_COUNT) {
+        return linked_profiles[index];
+    }
+    return -1;
+}
+
+void ProfileController::save_profile_link(int index) {
+    char key[16];
+    snprintf(key, sizeof(key), "pname%d", index);
+    preference_cache.put_string(key, profiles[index].name);
+    snprintf(key, sizeof(key), "plink%d", index);
+    preference_cache.put_int(key, linked_profiles[index] + 1);
+}
+
+int ProfileController::store_profile(int index, int stored_id, const char* name) {
+    if (index < 0 || index >= USER_PROFILE_COUNT || !grind_controller || grind_controller->is_active()) {
+        return -1;
+    }
+    if (!name || !name[0]) {
+        name = profiles[index].name;
+    }
+    if (stored_id < 0) {
+        stored_id = profile_store.find(name);
+    }
+    if (stored_id < 0) {
+        stored_id = profile_store.find_free();
+    }
+    if (stored_id < 0 || stored_id >= USER_PROFILE_STORE_CAPACITY) {
+        return -1;
+    }
+
+    StoredProfile stored = {};
+    stored.weight = profiles[index].weight;
+    stored.time_seconds = profiles[index].time_seconds;
+    if (!grind_controller->get_profile_models((uint8_t)index, &stored.coast, &stored.pulse) ||
+        !profile_store.save((uint16_t)stored_id, name, stored)) {
+        return -1;
+    }
+    linked_profiles[index] = stored_id;
+    save_profile_link(index);
+    return stored_id;
+}
+
+bool ProfileController::recall_profile(int index, int stored_id) {
+    if (index < 0 || index >= USER_PROFILE_COUNT || stored_id < 0 || stored_id >= USER_PROFILE_STORE_CAPACITY ||
+        !grind_controller || grind_controller->is_active()) {
+        return false;
+    }
+    StoredProfile stored;
+    char name[USER_PROFILE_STORE_NAME_LENGTH];
+    if (!profile_store.load((uint16_t)stored_id, &stored) || !profile_store.get_name((uint16_t)stored_id, name, sizeof(name))) {
+        return false;
+    }
+
+    // What the tab learned since it was recalled goes back to its own stored profile first
+    int previous = linked_profiles[index];
+    if (previous >= 0 && previous != stored_id) {
+        char previous_name[USER_PROFILE_STORE_NAME_LENGTH];
+        if (profile_store.get_name((uint16_t)previous, previous_name, sizeof(previous_name))) {
+            store_profile(index, previous, previous_name);
+        }
+    }
+
+    if (!grind_controller->adopt_profile_models((uint8_t)index, stored.coast, stored.pulse)) {
+        LOG_BLE("Stored profile %d: learned models reset (unreadable)\n", stored_id);
+    }
+    profiles[index].weight = clamp_weight(stored.weight);
+    profiles[index].time_seconds = clamp_time(stored.time_seconds);
+    // Tab names hold USER_PROFILE_NAME_MAX_LENGTH - 1 characters; a longer stored name keeps its prefix
+    snprintf(profiles[index].name, sizeof(profiles[index].name), "%.*s", (int)sizeof(profiles[index].name) - 1, name);
+    linked_profiles[index] = stored_id;
+    save_profiles();
+    save_profile_link(index);
+    change_count.fetch_add(1);
+    return true;
 }
@@ -1,8 +1,11 @@
 #pragma once
 #include <Preferences.h>
+#include <atomic>
 #include "../config/constants.h"
 #include "grind_mode.h"
 
+class GrindController;
+
 struct Profile {
     char name[USER_PROFILE_NAME_MAX_LENGTH];
     float weight;
@@ -14,7 +17,13 @@ private:
     Profile profiles[USER_PROFILE_COUNT];
     int current_profile;
     GrindMode current_grind_mode;
+    int batch_doses;            // Doses per batch, 1 = off
+    int linked_profiles[USER_PROFILE_COUNT];   // Stored id each tab was recalled from or stored to, -1: none
+    std::atomic<uint32_t> change_count{0};
     Preferences* preferences;
+    GrindController* grind_controller = nullptr;
+
+    void save_profile_link(int index);
 
 public:
     void init(Preferences* prefs);
@@ -48,4 +57,18 @@ public:
     void set_grind_mode(GrindMode mode);
     GrindMode get_grind_mode() const { return current_grind_mode; }
     void save_grind_mode();
+
+    // Batch mode: doses ground back to back from one start, cup swaps trigger the next
+    void set_batch_doses(int doses);
+    int get_batch_doses() const { return batch_doses; }
+
+    // Profile store (ProfileStore): a tab's targets and learned models saved as, or
+    // replaced by, a stored profile. stored_id -1 on store: the slot named name, else
+    // the first free one. Both refuse while grinding.
+    void set_grind_controller(GrindController* controller) { grind_controller = controller; }
+    int store_profile(int index, int stored_id, const char* name);    // Stored id, -1 on failure
+    bool recall_profile(int index, int stored_id);
+    int get_linked_profile(int index) const;
+    // Bumped when a tab changes behind the UI's back (recall), so screens refresh
+    uint32_t get_change_count() const { return change_count.load(); }
 };
@@ -0,0 +1,276 @@
+#include "profile_store.h"
+#include <LittleFS.h>
+#include <esp_rom_crc.h>
+#include <cstddef>
+#include <string.h>
+
+ProfileStore profile_store;
+
+namespace {
+
+class StoreLockGuard {
+public:
+    explicit StoreLockGuard(SemaphoreHandle_t mutex) : mutex_(mutex) {
+        if (mutex_) {
+            xSemaphoreTake(mutex_, portMAX_DELAY);
+        }
+    }
+
+    ~StoreLockGuard() {
+        if (mutex_) {
+            xSemaphoreGive(mutex_);
+        }
+    }
+
+private:
+    SemaphoreHandle_t mutex_;
+};
+
+bool header_matches(const ProfileStoreHeader& header) {
+    return header.magic == PROFILE_STORE_MAGIC && header.version == PROFILE_STORE_VERSION &&
+           header.capacity == USER_PROFILE_STORE_CAPACITY;
+}
+
+}
+
+uint32_t ProfileStore::record_crc(const StoredProfile& profile) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&profile, offsetof(StoredProfile, crc));
+}
+
+bool ProfileStore::begin() {
+    if (!mutex) {
+        mutex = xSemaphoreCreateMutexStatic(&mutex_buffer);
+    }
+    StoreLockGuard lock(mutex);
+    memset(index, 0, sizeof(index));
+    for (CacheEntry& entry : cache) {
+        entry.id = -1;
+    }
+    ready = true;
+
+    File file = LittleFS.open(PROFILE_STORE_FILE, "r");
+    if (!file) {
+        file_valid = false;
+        return false;
+    }
+    ProfileStoreHeader header;
+    file_valid = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header_matches(header) &&
+                 file.read((uint8_t*)index, sizeof(index)) == sizeof(index);
+    file.close();
+    if (!file_valid) {
+        memset(index, 0, sizeof(index));
+        LOG_BLE("Profile store unreadable, starting over\n");
+        return false;
+    }
+    for (ProfileIndexEntry& entry : index) {
+        entry.name[USER_PROFILE_STORE_NAME_LENGTH - 1] = '\0';
+    }
+    LOG_BLE("Profile store: %u of %u slots used\n", (unsigned)get_count(), (unsigned)USER_PROFILE_STORE_CAPACITY);
+    return true;
+}
+
+uint16_t ProfileStore::get_count() const {
+    StoreLockGuard lock(mutex);
+    uint16_t count = 0;
+    for (const ProfileIndexEntry& entry : index) {
+        if (entry.flags & FLAG_USED) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool ProfileStore::get_name(uint16_t id, char* name_out, size_t name_size) const {
+    if (id >= USER_PROFILE_STORE_CAPACITY || !name_out || name_size == 0) {
+        return false;
+    }
+    StoreLockGuard lock(mutex);
+    if (!(index[id].flags & FLAG_USED)) {
+        return false;
+    }
+    snprintf(name_out, name_size, "%s", index[id].name);
+    return true;
+}
+
+int ProfileStore::find(const char* name) const {
+    if (!name) {
+        return -1;
+    }
+    StoreLockGuard lock(mutex);
+    for (uint16_t id = 0; id < USER_PROFILE_STORE_CAPACITY; id++) {
+        if ((index[id].flags & FLAG_USED) && strncmp(index[id].name, name, USER_PROFILE_STORE_NAME_LENGTH) == 0) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+int ProfileStore::find_free() const {
+    StoreLockGuard lock(mutex);
+    for (uint16_t id = 0; id < USER_PROFILE_STORE_CAPACITY; id++) {
+        if (!(index[id].flags & FLAG_USED)) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+bool ProfileStore::load(uint16_t id, StoredProfile* profile_out) {
+    if (!ready || id >= USER_PROFILE_STORE_CAPACITY || !profile_out) {
+        return false;
+    }
+    StoreLockGuard lock(mutex);
+    if (!(index[id].flags & FLAG_USED)) {
+        return false;
+    }
+    CacheEntry* entry = cache_find(id);
+    if (entry) {
+        cache_hits++;
+        entry->last_use = ++use_clock;
+        *profile_out = entry->profile;
+        return true;
+    }
+    cache_misses++;
+    if (!read_record(id, profile_out)) {
+        LOG_BLE("WARNING: Stored profile %u damaged\n", (unsigned)id);
+        return false;
+    }
+    cache_put(id, *profile_out);
+    return true;
+}
+
+bool ProfileStore::save(uint16_t id, const char* name, const StoredProfile& profile) {
+    if (!ready || id >= USER_PROFILE_STORE_CAPACITY || !name || !name[0]) {
+        return false;
+    }
+    StoreLockGuard lock(mutex);
+    StoredProfile record = profile;
+    record.crc = record_crc(record);
+
+    const ProfileIndexEntry previous = index[id];
+    memset(&index[id], 0, sizeof(index[id]));
+    snprintf(index[id].name, sizeof(index[id].name), "%s", name);
+    index[id].flags = FLAG_USED;
+
+    bool written = file_valid ? write_slot(id, &record) : write_all(id, &record);
+    if (!written) {
+        index[id] = previous;
+        LOG_BLE("ERROR: Failed to write stored profile %u\n", (unsigned)id);
+        return false;
+    }
+    cache_put(id, record);
+    return true;
+}
+
+bool ProfileStore::remove(uint16_t id) {
+    if (!ready || id >= USER_PROFILE_STORE_CAPACITY) {
+        return false;
+    }
+    StoreLockGuard lock(mutex);
+    if (!(index[id].flags & FLAG_USED)) {
+        return true;
+    }
+    const ProfileIndexEntry previous = index[id];
+    memset(&index[id], 0, sizeof(index[id]));
+    // The record stays behind; an unused index entry is enough
+    if (!(file_valid ? write_slot(id, nullptr) : write_all(id, nullptr))) {
+        index[id] = previous;
+        return false;
+    }
+    cache_drop(id);
+    return true;
+}
+
+ProfileStore::CacheEntry* ProfileStore::cache_find(uint16_t id) {
+    for (CacheEntry& entry : cache) {
+        if (entry.id == (int16_t)id) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void ProfileStore::cache_put(uint16_t id, const StoredProfile& profile) {
+    CacheEntry* target = cache_find(id);
+    if (!target) {
+        // An empty entry, else the least recently used
+        target = &cache[0];
+        for (CacheEntry& entry : cache) {
+            if (entry.id < 0) {
+                target = &entry;
+                break;
+            }
+            if (entry.last_use < target->last_use) {
+                target = &entry;
+            }
+        }
+    }
+    target->id = (int16_t)id;
+    target->last_use = ++use_clock;
+    target->profile = profile;
+}
+
+void ProfileStore::cache_drop(uint16_t id) {
+    CacheEntry* entry = cache_find(id);
+    if (entry) {
+        entry->id = -1;
+    }
+}
+
+bool ProfileStore::read_record(uint16_t id, StoredProfile* profile_out) {
+    File file = LittleFS.open(PROFILE_STORE_FILE, "r");
+    if (!file) {
+        return false;
+    }
+    bool ok = file.seek(record_offset(id)) &&
+              file.read((uint8_t*)profile_out, sizeof(StoredProfile)) == sizeof(StoredProfile) &&
+              profile_out->crc == record_crc(*profile_out);
+    file.close();
+    return ok;
+}
+
+// One slot's index entry and, when given, its record; one update committed on close
+bool ProfileStore::write_slot(uint16_t id, const StoredProfile* profile) {
+    File file = LittleFS.open(PROFILE_STORE_FILE, "r+");
+    if (!file) {
+        return false;
+    }
+    ProfileStoreHeader header;
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header_matches(header) &&
+              file.seek(index_offset(id)) &&
+              file.write((const uint8_t*)&index[id], sizeof(ProfileIndexEntry)) == sizeof(ProfileIndexEntry);
+    if (ok && profile) {
+        ok = file.seek(record_offset(id)) &&
+             file.write((const uint8_t*)profile, sizeof(StoredProfile)) == sizeof(StoredProfile);
+    }
+    file.close();
+    return ok;
+}
+
+// A new store: the index, then empty records except the one being saved
+bool ProfileStore::write_all(uint16_t id, const StoredProfile* profile) {
+    File file = LittleFS.open(PROFILE_STORE_TEMP_FILE, "w");
+    if (!file) {
+        LOG_BLE("ERROR: Failed to open %s\n", PROFILE_STORE_TEMP_FILE);
+        return false;
+    }
+    ProfileStoreHeader header = {};
+    header.magic = PROFILE_STORE_MAGIC;
+    header.version = PROFILE_STORE_VERSION;
+    header.capacity = USER_PROFILE_STORE_CAPACITY;
+    bool written = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                   file.write((const uint8_t*)index, sizeof(index)) == sizeof(index);
+    StoredProfile empty = {};
+    for (uint16_t slot = 0; written && slot < USER_PROFILE_STORE_CAPACITY; slot++) {
+        const StoredProfile* record = (slot == id && profile) ? profile : &empty;
+        written = file.write((const uint8_t*)record, sizeof(StoredProfile)) == sizeof(StoredProfile);
+    }
+    file.close();
+
+    if (!written || !LittleFS.rename(PROFILE_STORE_TEMP_FILE, PROFILE_STORE_FILE)) {
+        LittleFS.remove(PROFILE_STORE_TEMP_FILE);
+        return false;
+    }
+    file_valid = true;
+    return true;
+}
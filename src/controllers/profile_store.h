@@ -0,0 +1,120 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "../config/constants.h"
+#include "../config/logging.h"
+#include "coast_model.h"
+#include "pulse_response_table.h"
+
+#define PROFILE_STORE_FILE "/profiles.bin"                 // Header, index, then one record per stored profile
+#define PROFILE_STORE_TEMP_FILE "/profiles.tmp"            // A new or damaged store is written whole here first
+
+constexpr uint32_t PROFILE_STORE_MAGIC = 0x46525050;        // "PPRF"
+constexpr uint16_t PROFILE_STORE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct ProfileStoreHeader {
+    uint32_t magic;                // PROFILE_STORE_MAGIC
+    uint16_t version;              // PROFILE_STORE_VERSION
+    uint16_t capacity;             // Index entries and records that follow
+    uint32_t reserved;
+};
+
+// Index entry per slot; the whole index is read at boot, the records only on demand
+struct ProfileIndexEntry {
+    char     name[USER_PROFILE_STORE_NAME_LENGTH];
+    uint8_t  flags;                // ProfileStore::FLAG_USED
+    uint8_t  reserved[3];
+};
+
+// Record per slot: targets plus the learned models the grinder had for it
+struct StoredProfile {
+    float    weight;
+    float    time_seconds;
+    CoastModelState coast;
+    PulseResponseState pulse;
+    uint32_t crc;                  // esp_rom_crc32_le over the fields before it
+};
+#pragma pack(pop)
+
+static_assert(sizeof(ProfileStoreHeader) == 12, "Unexpected ProfileStoreHeader size");
+static_assert(sizeof(ProfileIndexEntry) == USER_PROFILE_STORE_NAME_LENGTH + 4, "Unexpected ProfileIndexEntry size");
+
+/**
+ * ProfileStore - Library of named profiles with their learned models
+ *
+ * The three profile tabs stay the working set (ProfileController, the coast
+ * model and pulse table slots); the store keeps up to
+ * USER_PROFILE_STORE_CAPACITY more behind them, one per bean or recipe. A
+ * stored profile is loaded into a tab or saved from one (ProfileController::
+ * recall_profile() / store_profile()).
+ *
+ * One LittleFS file of fixed slots, so the slot number is the stored id and
+ * the file is its own index: header, then the index (name and flags per
+ * slot), then the records. begin() reads only the header and the index
+ * (20 bytes a slot); records, which carry the models, are read one at a
+ * time on first use and kept in a small LRU cache
+ * (USER_PROFILE_STORE_CACHE_ENTRIES), so recalling a recent profile touches
+ * no flash. save() and remove() rewrite only their slot's index entry and
+ * record in one LittleFS update, which commits on close. A missing or
+ * unreadable file is written whole through a temporary file first.
+ *
+ * Called from the UI and BLE tasks; a mutex serializes everything.
+ */
+class ProfileStore {
+public:
+    static const uint8_t FLAG_USED = 0x01;
+
+    bool begin();                           // Header and index only; false if it starts empty
+    bool is_ready() const { return ready; }
+    uint16_t get_capacity() const { return USER_PROFILE_STORE_CAPACITY; }
+    uint16_t get_count() const;
+
+    // Name of a used slot; false for an empty or out of range one
+    bool get_name(uint16_t id, char* name_out, size_t name_size) const;
+    int find(const char* name) const;       // Stored id, -1 if none
+    int find_free() const;                  // Lowest empty slot, -1 when full
+
+    // Cached record, else one read from flash; false for an empty or damaged slot
+    bool load(uint16_t id, StoredProfile* profile_out);
+    bool save(uint16_t id, const char* name, const StoredProfile& profile);
+    bool remove(uint16_t id);
+
+    uint32_t get_cache_hits() const { return cache_hits; }
+    uint32_t get_cache_misses() const { return cache_misses; }
+
+private:
+    struct CacheEntry {
+        int16_t id;                         // -1: empty
+        uint32_t last_use;
+        StoredProfile profile;
+    };
+
+    ProfileIndexEntry index[USER_PROFILE_STORE_CAPACITY] = {};
+    CacheEntry cache[USER_PROFILE_STORE_CACHE_ENTRIES] = {};
+    uint32_t use_clock = 0;
+    uint32_t cache_hits = 0;
+    uint32_t cache_misses = 0;
+    bool ready = false;
+    bool file_valid = false;                // The file matches index[]; false: the next write rewrites it whole
+    StaticSemaphore_t mutex_buffer;
+    SemaphoreHandle_t mutex = nullptr;
+
+    CacheEntry* cache_find(uint16_t id);
+    void cache_put(uint16_t id, const StoredProfile& profile);
+    void cache_drop(uint16_t id);
+    bool read_record(uint16_t id, StoredProfile* profile_out);
+    bool write_slot(uint16_t id, const StoredProfile* profile);
+    bool write_all(uint16_t id, const StoredProfile* profile);
+
+    static uint32_t record_crc(const StoredProfile& profile);
+    static size_t index_offset(uint16_t id) { return sizeof(ProfileStoreHeader) + id * sizeof(ProfileIndexEntry); }
+    static size_t record_offset(uint16_t id) {
+        return sizeof(ProfileStoreHeader) + USER_PROFILE_STORE_CAPACITY * sizeof(ProfileIndexEntry) +
+               id * sizeof(StoredProfile);
+    }
+};
+
+extern ProfileStore profile_store;
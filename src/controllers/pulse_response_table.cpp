@@ -0,0 +1,171 @@
+#include "pulse_response_table.h"
+#include <math.h>
+
+void PulseResponseTable::initial_state(PulseResponseState* state) {
+    memset(state, 0, sizeof(*state));
+    state->version = STATE_VERSION;
+}
+
+void PulseResponseTable::make_key(uint8_t profile_id, char* key, size_t key_size) {
+    snprintf(key, key_size, "pulse_t%u", (unsigned)profile_id);
+}
+
+void PulseResponseTable::load(Preferences* preferences) {
+    for (uint8_t i = 0; i < USER_PROFILE_COUNT; i++) {
+        initial_state(&states[i]);
+        if (!preferences) {
+            continue;
+        }
+
+        char key[16];
+        make_key(i, key, sizeof(key));
+        PulseResponseState stored;
+        if (preferences->getBytesLength(key) == sizeof(stored) &&
+            preferences->getBytes(key, &stored, sizeof(stored)) == sizeof(stored) &&
+            stored.version == STATE_VERSION) {
+            states[i] = stored;
+            LOG_BLE("Pulse table %u: %u sessions\n", (unsigned)i, (unsigned)stored.session_count);
+        }
+    }
+}
+
+bool PulseResponseTable::lookup_duration_ms(uint8_t profile_id, float grams, float* duration_ms_out) const {
+    if (profile_id >= USER_PROFILE_COUNT || grams <= 0.0f) {
+        return false;
+    }
+    const PulseResponseState& state = states[profile_id];
+    if (state.session_count < GRIND_PULSE_TABLE_MIN_SESSIONS) {
+        return false;
+    }
+
+    // Knots with enough support, pooled (weighted PAVA) into a non-decreasing curve
+    float knot_ms[GRIND_PULSE_TABLE_KNOT_COUNT];
+    float knot_g[GRIND_PULSE_TABLE_KNOT_COUNT];
+    float block_g[GRIND_PULSE_TABLE_KNOT_COUNT];
+    float block_weight[GRIND_PULSE_TABLE_KNOT_COUNT];
+    int block_end[GRIND_PULSE_TABLE_KNOT_COUNT];
+    int knots = 0;
+    int blocks = 0;
+    for (int k = 0; k < GRIND_PULSE_TABLE_KNOT_COUNT; k++) {
+        if (state.weight[k] < GRIND_PULSE_TABLE_MIN_KNOT_WEIGHT || !isfinite(state.grams[k])) {
+            continue;
+        }
+        knot_ms[knots] = (float)(k * GRIND_PULSE_TABLE_KNOT_SPACING_MS);
+        block_g[blocks] = state.grams[k];
+        block_weight[blocks] = state.weight[k];
+        block_end[blocks] = ++knots;
+        blocks++;
+        while (blocks > 1 && block_g[blocks - 2] > block_g[blocks - 1]) {
+            float merged_weight = block_weight[blocks - 2] + block_weight[blocks - 1];
+            block_g[blocks - 2] = (block_g[blocks - 2] * block_weight[blocks - 2] +
+                                   block_g[blocks - 1] * block_weight[blocks - 1]) / merged_weight;
+            block_weight[blocks - 2] = merged_weight;
+            block_end[blocks - 2] = block_end[blocks - 1];
+            blocks--;
+        }
+    }
+    if (knots < 2) {
+        return false;
+    }
+    for (int b = 0, k = 0; b < blocks; b++) {
+        for (; k < block_end[b]; k++) {
+            knot_g[k] = block_g[b];
+        }
+    }
+
+    if (grams < knot_g[0] || grams > knot_g[knots - 1]) {
+        return false;   // Outside what the profile has delivered so far
+    }
+    for (int k = 0; k + 1 < knots; k++) {
+        if (knot_g[k + 1] >= grams && knot_g[k + 1] > knot_g[k]) {
+            float fraction = max(0.0f, (grams - knot_g[k]) / (knot_g[k + 1] - knot_g[k]));
+            *duration_ms_out = knot_ms[k] + fraction * (knot_ms[k + 1] - knot_ms[k]);
+            return true;
+        }
+    }
+    *duration_ms_out = knot_ms[0];      // Flat curve at exactly grams
+    return true;
+}
+
+bool PulseResponseTable::observe(uint8_t profile_id, float duration_ms, float delivered_g) {
+    if (profile_id >= USER_PROFILE_COUNT) {
+        return false;
+    }
+    const float max_ms = (float)((GRIND_PULSE_TABLE_KNOT_COUNT - 1) * GRIND_PULSE_TABLE_KNOT_SPACING_MS);
+    if (!(duration_ms >= 0.0f && duration_ms <= max_ms) ||
+        delivered_g < -GRIND_ACCURACY_TOLERANCE_G || delivered_g > GRIND_PULSE_TABLE_MAX_PULSE_G) {
+        return false;
+    }
+    delivered_g = max(0.0f, delivered_g);
+
+    // Hat-function fit: the observation is shared between its two neighbouring knots and
+    // corrects the interpolated curve there, each knot by its share over its accumulated weight.
+    // A knot without history takes its value from the other one (or the observation).
+    float position = duration_ms / GRIND_PULSE_TABLE_KNOT_SPACING_MS;
+    int lower = min((int)position, GRIND_PULSE_TABLE_KNOT_COUNT - 2);
+    float upper_share = position - lower;
+    PulseResponseState& state = states[profile_id];
+    const int knot[2] = { lower, lower + 1 };
+    const float share[2] = { 1.0f - upper_share, upper_share };
+    for (int j = 0; j < 2; j++) {
+        if (state.weight[knot[j]] <= 0.0f) {
+            state.grams[knot[j]] = state.weight[knot[1 - j]] > 0.0f ? state.grams[knot[1 - j]] : delivered_g;
+        }
+    }
+    float error = delivered_g - (share[0] * state.grams[lower] + share[1] * state.grams[lower + 1]);
+    for (int j = 0; j < 2; j++) {
+        if (share[j] <= 0.0f) {
+            continue;
+        }
+        int k = knot[j];
+        state.weight[k] += share[j];
+        state.grams[k] += share[j] / state.weight[k] * error;
+    }
+    return true;
+}
+
+void PulseResponseTable::end_session(uint8_t profile_id) {
+    if (profile_id >= USER_PROFILE_COUNT) {
+        return;
+    }
+    PulseResponseState& state = states[profile_id];
+    for (int k = 0; k < GRIND_PULSE_TABLE_KNOT_COUNT; k++) {
+        state.weight[k] *= GRIND_PULSE_TABLE_FORGETTING;
+    }
+    if (state.session_count < UINT16_MAX) {
+        state.session_count++;
+    }
+}
+
+bool PulseResponseTable::get_state(uint8_t profile_id, PulseResponseState* state_out) const {
+    if (profile_id >= USER_PROFILE_COUNT) {
+        return false;
+    }
+    *state_out = states[profile_id];
+    return true;
+}
+
+bool PulseResponseTable::set_state(uint8_t profile_id, const PulseResponseState& state) {
+    if (profile_id >= USER_PROFILE_COUNT) {
+        return false;
+    }
+    bool valid = state.version == STATE_VERSION;
+    for (int k = 0; valid && k < GRIND_PULSE_TABLE_KNOT_COUNT; k++) {
+        valid = isfinite(state.grams[k]) && isfinite(state.weight[k]);
+    }
+    if (!valid) {
+        initial_state(&states[profile_id]);
+        return false;
+    }
+    states[profile_id] = state;
+    return true;
+}
+
+bool PulseResponseTable::save_state(Preferences* preferences, uint8_t profile_id, const PulseResponseState& state) {
+    if (!preferences || profile_id >= USER_PROFILE_COUNT) {
+        return false;
+    }
+    char key[16];
+    make_key(profile_id, key, sizeof(key));
+    return preferences->putBytes(key, &state, sizeof(state)) == sizeof(state);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "../config/constants.h"
+
+#pragma pack(push, 1)
+// Persisted per profile (NVS blob "pulse_t<profile>")
+struct PulseResponseState {
+    uint8_t  version;
+    uint8_t  reserved;
+    uint16_t session_count;                         // Sessions that contributed pulses
+    float    grams[GRIND_PULSE_TABLE_KNOT_COUNT];   // Delivered grams at knot k (k * GRIND_PULSE_TABLE_KNOT_SPACING_MS)
+    float    weight[GRIND_PULSE_TABLE_KNOT_COUNT];  // Decayed observation weight behind grams[k]
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PulseResponseState) == 4 + 8 * GRIND_PULSE_TABLE_KNOT_COUNT, "Unexpected PulseResponseState size");
+
+/**
+ * PulseResponseTable - Learned pulse length to delivered grams per profile
+ *
+ * Each completed session folds its PulseReport entries (commanded pulse ms,
+ * settled grams before and after) into a fixed grid of knots. An observation
+ * is split between its two neighbouring knots by linear interpolation weight,
+ * and knots forget old sessions with GRIND_PULSE_TABLE_FORGETTING. Lookups
+ * pool adjacent violators so the curve is non-decreasing, then invert it by
+ * linear interpolation: grams still missing -> pulse ms. Outside the learned
+ * range the caller keeps the flow-rate estimate.
+ *
+ * Core 0 owns the table (lookup/observe); persistence copies a state out and
+ * Core 1 writes it with save_state().
+ */
+class PulseResponseTable {
+public:
+    void load(Preferences* preferences);
+
+    // Pulse ms expected to deliver grams; false until the profile's curve covers it
+    bool lookup_duration_ms(uint8_t profile_id, float grams, float* duration_ms_out) const;
+
+    // Record one pulse; false (table unchanged) for implausible observations
+    bool observe(uint8_t profile_id, float duration_ms, float delivered_g);
+    // Count a session that contributed at least one pulse
+    void end_session(uint8_t profile_id);
+    bool get_state(uint8_t profile_id, PulseResponseState* state_out) const;
+    // Replace a profile's curve (recalled from the profile store); false resets it to empty
+    bool set_state(uint8_t profile_id, const PulseResponseState& state);
+
+    static bool save_state(Preferences* preferences, uint8_t profile_id, const PulseResponseState& state);
+
+private:
+    static const uint8_t STATE_VERSION = 1;
+
+    PulseResponseState states[USER_PROFILE_COUNT];
+
+    static void initial_state(PulseResponseState* state);
+    static void make_key(uint8_t profile_id, char* key, size_t key_size);
+};
@@ -0,0 +1,73 @@
+#include "retention_model.h"
+#include <math.h>
+
+namespace {
+// Upper idle bound of each class but the last
+constexpr uint32_t IDLE_BUCKET_LIMITS_S[] = { 60, 300, 1800, 7200 };
+static_assert(sizeof(IDLE_BUCKET_LIMITS_S) / sizeof(IDLE_BUCKET_LIMITS_S[0]) == GRIND_RETENTION_IDLE_BUCKET_COUNT - 1,
+              "One idle limit between each pair of retention classes");
+}
+
+void RetentionModel::initial_state(RetentionModelState* state) {
+    memset(state, 0, sizeof(*state));
+    state->version = STATE_VERSION;
+}
+
+void RetentionModel::load(Preferences* preferences) {
+    initial_state(&state);
+    if (!preferences) {
+        return;
+    }
+
+    RetentionModelState stored;
+    if (preferences->getBytesLength(PREF_KEY) == sizeof(stored) &&
+        preferences->getBytes(PREF_KEY, &stored, sizeof(stored)) == sizeof(stored) &&
+        stored.version == STATE_VERSION) {
+        state = stored;
+        LOG_BLE("Retention model: %u sessions\n", (unsigned)stored.session_count);
+    }
+}
+
+uint8_t RetentionModel::bucket_for_idle_s(uint32_t idle_s) {
+    uint8_t bucket = 0;
+    while (bucket < GRIND_RETENTION_IDLE_BUCKET_COUNT - 1 && idle_s >= IDLE_BUCKET_LIMITS_S[bucket]) {
+        bucket++;
+    }
+    return bucket;
+}
+
+bool RetentionModel::predict(uint8_t bucket, float* late_fall_g_out) const {
+    if (bucket >= GRIND_RETENTION_IDLE_BUCKET_COUNT || state.observations[bucket] < GRIND_RETENTION_MIN_SESSIONS) {
+        return false;
+    }
+    *late_fall_g_out = constrain(state.late_fall_g[bucket], 0.0f, GRIND_RETENTION_MAX_HOLDBACK_G);
+    return true;
+}
+
+bool RetentionModel::observe(uint8_t bucket, float late_fall_g) {
+    if (bucket >= GRIND_RETENTION_IDLE_BUCKET_COUNT || !isfinite(late_fall_g) ||
+        late_fall_g < -GRIND_ACCURACY_TOLERANCE_G || late_fall_g > 2.0f * GRIND_RETENTION_MAX_HOLDBACK_G) {
+        return false;
+    }
+
+    // The first observation of a class seeds it; later ones are smoothed in
+    if (state.observations[bucket] == 0) {
+        state.late_fall_g[bucket] = late_fall_g;
+    } else {
+        state.late_fall_g[bucket] += GRIND_RETENTION_SMOOTHING * (late_fall_g - state.late_fall_g[bucket]);
+    }
+    if (state.observations[bucket] < UINT16_MAX) {
+        state.observations[bucket]++;
+    }
+    if (state.session_count < UINT16_MAX) {
+        state.session_count++;
+    }
+    return true;
+}
+
+bool RetentionModel::save_state(Preferences* preferences, const RetentionModelState& state) {
+    if (!preferences) {
+        return false;
+    }
+    return preferences->putBytes(PREF_KEY, &state, sizeof(state)) == sizeof(state);
+}
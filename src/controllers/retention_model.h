@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "../config/constants.h"
+
+#pragma pack(push, 1)
+// Persisted for the grinder (NVS blob "retention"); the chute is shared by every profile
+struct RetentionModelState {
+    uint8_t  version;
+    uint8_t  reserved;
+    uint16_t session_count;                                     // Observations folded in
+    float    late_fall_g[GRIND_RETENTION_IDLE_BUCKET_COUNT];    // Smoothed grams landing after the final measurement
+    uint16_t observations[GRIND_RETENTION_IDLE_BUCKET_COUNT];   // Per idle class, saturating
+};
+#pragma pack(pop)
+
+static_assert(sizeof(RetentionModelState) == 4 + 6 * GRIND_RETENTION_IDLE_BUCKET_COUNT, "Unexpected RetentionModelState size");
+
+/**
+ * RetentionModel - Learned chute retention as a function of idle time
+ *
+ * Grounds held in the chute keep dropping after the final measurement, and
+ * how much depends on how long the chute sat since the previous grind (a
+ * chute that shed its retention while idle refills before it releases any).
+ * After each weight-mode completion the controller watches the settled weight
+ * for GRIND_RETENTION_OBSERVE_WINDOW_MS and folds the rise into the session's
+ * idle class. Once a class is trusted its late fall is held back from the
+ * stop target, so the cup reaches the target after the trickle instead of
+ * overshooting, and no prime run is needed to flush the chute first.
+ *
+ * Core 0 owns the model (predict/observe); persistence copies the state out
+ * and Core 1 writes it with save_state().
+ */
+class RetentionModel {
+public:
+    static const uint8_t UNKNOWN_IDLE_BUCKET = GRIND_RETENTION_IDLE_BUCKET_COUNT - 1;
+
+    void load(Preferences* preferences);
+
+    // Idle class for the seconds since the last grind
+    static uint8_t bucket_for_idle_s(uint32_t idle_s);
+
+    // Late fall to hold back (0..GRIND_RETENTION_MAX_HOLDBACK_G); false until the class is trusted
+    bool predict(uint8_t bucket, float* late_fall_g_out) const;
+
+    // Fold one observation in; false (model unchanged) for implausible values
+    bool observe(uint8_t bucket, float late_fall_g);
+    void get_state(RetentionModelState* state_out) const { *state_out = state; }
+
+    static bool save_state(Preferences* preferences, const RetentionModelState& state);
+
+private:
+    static const uint8_t STATE_VERSION = 1;
+    static constexpr const char* PREF_KEY = "retention";
+
+    RetentionModelState state;
+
+    static void initial_state(RetentionModelState* state);
+};
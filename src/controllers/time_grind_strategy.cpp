@@ -27,16 +27,9 @@ bool TimeGrindStrategy::update(const GrindSessionDescriptor& session,
                 controller->time_grind_start_ms = loop_data.now;
             }
 
-            if (controller->target_time_ms == 0) {
-                controller->grinder->stop();
-                controller->switch_phase(GrindPhase::FINAL_SETTLING, loop_data);
-                return true;
-            }
-
             unsigned long elapsed = loop_data.now - controller->time_grind_start_ms;
-            if (elapsed >= controller->target_time_ms) {
-                controller->grinder->stop();
-                controller->switch_phase(GrindPhase::FINAL_SETTLING, loop_data);
+            if (controller->target_time_ms == 0 || elapsed >= controller->target_time_ms) {
+                stop_at_time(*controller, loop_data);
             }
             return true;
         }
@@ -45,6 +38,23 @@ bool TimeGrindStrategy::update(const GrindSessionDescriptor& session,
     }
 }
 
+void TimeGrindStrategy::stop_at_time(GrindController& controller, const GrindLoopData& loop_data) const {
+    controller.grinder->stop();
+
+    float weight = loop_data.estimate_valid ? loop_data.estimated_weight : loop_data.current_weight;
+    float flow_rate = loop_data.estimate_valid ? loop_data.estimated_flow_rate : loop_data.flow_rate_prediction;
+    flow_rate = max(0.0f, flow_rate);
+    float coast_g = 0.0f;
+    if (!controller.coast_model.predict(controller.current_profile_id, flow_rate, &coast_g)) {
+        coast_g = (GRIND_LATENCY_TO_COAST_RATIO * GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS / (float)SYS_MS_PER_SECOND) * flow_rate;
+    }
+    controller.time_stop_flow_rate = flow_rate;
+    controller.time_implied_weight = weight + coast_g;
+    LOG_RT("[TIME] Cut at %.2fg, %.2fg/s: implied %.2fg\n", weight, flow_rate, controller.time_implied_weight);
+
+    controller.switch_phase(GrindPhase::FINAL_SETTLING, loop_data);
+}
+
 void TimeGrindStrategy::on_exit(const GrindSessionDescriptor&, GrindStrategyContext& context) {
     if (context.controller) {
         context.controller->time_grind_start_ms = 0;
@@ -21,4 +21,8 @@ public:
                          const GrindController& controller) const override;
 
     const char* name() const override { return "Time"; }
+
+private:
+    // Motor off at the timer; records the cut flow and the implied weight (cut weight + coast)
+    void stop_at_time(GrindController& controller, const GrindLoopData& loop_data) const;
 };
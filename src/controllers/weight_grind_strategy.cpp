@@ -6,6 +6,7 @@
 #include "../logging/grind_logging.h"
 #include "../config/constants.h"
 #include <Arduino.h>
+#include <esp_timer.h>
 
 void WeightGrindStrategy::on_enter(const GrindSessionDescriptor&, GrindStrategyContext&, const GrindLoopData&) {
     // No additional setup required; controller handled initialization.
@@ -63,12 +64,20 @@ float WeightGrindStrategy::calculate_pulse_duration_ms(const GrindController& co
                                                        float error_grams) const {
     float clamped_flow_rate = get_clamped_pulse_flow_rate(controller);
 
-    // Calculate the productive grinding time needed (excludes startup latency)
-    float productive_duration_ms = (error_grams / clamped_flow_rate) * 1000.0f;
-
     // Motor latency is the base time needed to start the system
     float motor_latency_ms = controller.get_motor_response_latency();
 
+#if GRIND_PULSE_TABLE_ENABLED
+    // The profile's learned response already includes latency and coast
+    float learned_duration_ms = 0.0f;
+    if (controller.pulse_table.lookup_duration_ms(controller.current_profile_id, error_grams, &learned_duration_ms)) {
+        return constrain(learned_duration_ms, controller.get_min_pulse_duration(), controller.get_max_pulse_duration());
+    }
+#endif
+
+    // Calculate the productive grinding time needed (excludes startup latency)
+    float productive_duration_ms = (error_grams / clamped_flow_rate) * 1000.0f;
+
     // Clamp productive duration to valid range (0 to max additional time)
     float clamped_productive_ms = max(0.0f, min(productive_duration_ms, GRIND_MOTOR_MAX_PULSE_DURATION_MS));
 
@@ -78,78 +87,287 @@ float WeightGrindStrategy::calculate_pulse_duration_ms(const GrindController& co
     return final_duration;
 }
 
+void WeightGrindStrategy::confirm_flow_start(GrindController& controller,
+                                             const GrindLoopData& loop_data) const {
+    if (!controller.flow_start_confirmed) {
+        float current_flow_rate = loop_data.flow_rate_detection;
+
+        // As low as the scale's noise allows (GRIND_NOISE_FLOOR_FLOW_*), so latency is measured early
+        if (current_flow_rate >= controller.weight_sensor->get_flow_detection_threshold_gps()) {
+            // Measure from the relay edge to the sample that confirmed flow, not
+            // between control ticks; fall back to loop time without an edge
+            uint32_t motor_on_us = 0;
+            if (controller.grinder &&
+                controller.grinder->get_edge_timeline().get_latest(MotorEdgeType::START, &motor_on_us)) {
+                uint32_t sample_us = controller.weight_sensor->get_latest_sample_time_us();
+                controller.grind_latency_ms = (float)(sample_us - motor_on_us) / 1000.0f;
+            } else {
+                controller.grind_latency_ms = loop_data.now - controller.phase_start_time;
+            }
+            controller.flow_start_confirmed = true;
+            LOG_RT("[PREDICTIVE] Flow start CONFIRMED! Latency: %.1fms, Flow: %.2fg/s\n",
+                    controller.grind_latency_ms, current_flow_rate);
+#if HW_MOTOR_CURRENT_ENABLED
+            // The motor's own response: spin-up, then the beans loading the burrs
+            if (motor_on_us != 0 && controller.grinder->get_motor_load().loaded) {
+                const MotorLoadState& load = controller.grinder->get_motor_load();
+                LOG_RT_AT(LOG_CAT_GRIND, LOG_LEVEL_DEBUG, "[PREDICTIVE] Motor spun up in %ums, burrs loaded at %.1fms (%.1fms before flow confirmed)\n",
+                          (unsigned)load.spin_up_ms, (float)(load.load_onset_us - motor_on_us) / 1000.0f,
+                          controller.grind_latency_ms - (float)(load.load_onset_us - motor_on_us) / 1000.0f);
+            }
+#endif
+        }
+    }
+}
+
 void WeightGrindStrategy::run_predictive_phase(GrindController& controller,
                                                const GrindLoopData& loop_data) const {
-    if (!controller.weight_sensor) {
+    if (!controller.weight_sensor || !controller.grinder) {
         return;
     }
 
-    if (!controller.flow_start_confirmed) {
-        const uint32_t flow_detection_window_ms = 500;
-        float current_flow_rate = controller.weight_sensor->get_flow_rate(flow_detection_window_ms);
-
-        if (current_flow_rate >= GRIND_FLOW_DETECTION_THRESHOLD_GPS) {
-            controller.grind_latency_ms = loop_data.now - controller.phase_start_time;
-            controller.flow_start_confirmed = true;
-            LOG_BLE("[PREDICTIVE] Flow start CONFIRMED! Latency: %.1fms, Flow: %.2fg/s\n",
-                    controller.grind_latency_ms, current_flow_rate);
+    // Stop armed on an earlier tick: finish once the timer has cut the relay
+    if (controller.grinder->has_scheduled_stop()) {
+        if (is_scheduled_stop_complete(controller)) {
+            finish_predictive_stop(controller, loop_data, controller.predictive_end_weight,
+                                   controller.predictive_stop_flow_rate);
         }
+        return;
     }
 
+    confirm_flow_start(controller, loop_data);
+
     if (controller.flow_start_confirmed) {
-        const uint32_t flow_rate_calc_window_ms = 1500;
-        if (loop_data.now > (controller.phase_start_time + controller.grind_latency_ms + flow_rate_calc_window_ms)) {
-            float current_flow_rate = controller.weight_sensor->get_flow_rate(flow_rate_calc_window_ms);
+        bool window_filled = loop_data.now > (controller.phase_start_time + controller.grind_latency_ms + controller.flow_windows.prediction_ms);
+        // With the profile's history, its flow blends into the early estimate instead of waiting for the window
+        if (window_filled || controller.warm_start_flow_gps > 0.0f) {
+            float current_flow_rate = window_filled ? loop_data.flow_rate_prediction :
+                controller.blend_warm_start_flow(loop_data.estimate_valid ? loop_data.estimated_flow_rate : loop_data.flow_rate_detection,
+                                                 loop_data.now);
+#if HW_MOTOR_SPEED_CONTROL_ENABLED
+            // The prediction window lags the ramp-down; the coast follows the flow at the cut
+            if (controller.grinder->get_speed() < 1.0f) {
+                current_flow_rate = loop_data.estimate_valid ? loop_data.estimated_flow_rate : loop_data.flow_rate;
+            }
+#endif
 
             if (current_flow_rate > GRIND_FLOW_DETECTION_THRESHOLD_GPS) {
-                controller.motor_stop_target_weight = ((controller.grind_latency_ms * GRIND_LATENCY_TO_COAST_RATIO) /
-                                                       (float)SYS_MS_PER_SECOND) * current_flow_rate;
+                controller.motor_stop_target_weight = controller.predict_stop_offset_g(current_flow_rate,
+                                                                                       controller.grind_latency_ms);
             }
         }
     }
 
-    if (loop_data.current_weight >= (controller.target_weight - controller.motor_stop_target_weight)) {
-        controller.grinder->stop();
-        controller.predictive_end_weight = loop_data.current_weight;
-        controller.pulse_flow_rate = controller.weight_sensor->get_flow_rate_95th_percentile(2500);
-        controller.switch_phase(GrindPhase::PULSE_SETTLING, loop_data);
+    // The estimator tracks the ramp without the 100ms mean's ~50ms lag, so the
+    // stop lands closer to the coast-corrected target
+#if GRIND_PREDICTIVE_USE_STATE_ESTIMATE
+    float control_weight = loop_data.estimate_valid ? loop_data.estimated_weight : loop_data.current_weight;
+    float control_flow_rate = loop_data.estimate_valid ? loop_data.estimated_flow_rate : loop_data.flow_rate;
+#else
+    float control_weight = loop_data.current_weight;
+    float control_flow_rate = loop_data.flow_rate;
+#endif
+    float stop_weight = controller.get_stop_target_weight() - controller.motor_stop_target_weight;
+    if (control_weight >= stop_weight) {
+        finish_predictive_stop(controller, loop_data, control_weight, control_flow_rate);
+        return;
+    }
+    apply_soft_stop(controller, control_weight, stop_weight);
+
+    // Crossing due before the next tick: extrapolate it and cut at that instant
+    // rather than up to a full tick late
+    if (controller.flow_start_confirmed && control_flow_rate >= GRIND_FLOW_DETECTION_THRESHOLD_GPS &&
+        schedule_stop_within_tick(controller, (stop_weight - control_weight) / control_flow_rate)) {
+        controller.predictive_end_weight = stop_weight;   // Expected at the cut
+        controller.predictive_stop_flow_rate = control_flow_rate;
+    }
+}
+
+void WeightGrindStrategy::apply_soft_stop(GrindController& controller, float weight, float stop_weight) const {
+#if HW_MOTOR_SPEED_CONTROL_ENABLED
+    if (!controller.grinder || !controller.flow_start_confirmed) {
+        return;
+    }
+    // Lower flow near the end shrinks the coast, so one run lands without a correction pulse
+    float ramp = constrain((stop_weight - weight) / GRIND_SOFT_STOP_RAMP_G, 0.0f, 1.0f);
+    controller.grinder->set_speed(GRIND_SOFT_STOP_MIN_DUTY + (1.0f - GRIND_SOFT_STOP_MIN_DUTY) * ramp);
+#else
+    (void)controller;
+    (void)weight;
+    (void)stop_weight;
+#endif
+}
+
+bool WeightGrindStrategy::schedule_stop_within_tick(GrindController& controller, float delay_s) const {
+#if GRIND_SUBTICK_STOP_ENABLED
+    if (!controller.grinder || delay_s <= 0.0f || delay_s >= controller.get_control_interval_ms() / 1000.0f) {
+        return false;
+    }
+    uint32_t delay_us = (uint32_t)(delay_s * 1000000.0f);
+    return delay_us > 0 && controller.grinder->schedule_stop(delay_us);
+#else
+    (void)controller;
+    (void)delay_s;
+    return false;
+#endif
+}
+
+bool WeightGrindStrategy::is_scheduled_stop_complete(const GrindController& controller) const {
+    if (controller.grinder->has_scheduled_stop_fired()) {
+        return true;
+    }
+    int32_t overdue_us = (int32_t)((uint32_t)esp_timer_get_time() - controller.grinder->get_scheduled_stop_due_us());
+    return overdue_us >= (int32_t)(controller.get_control_interval_ms() * 1000);
+}
+
+void WeightGrindStrategy::report_scheduled_stop(GrindController& controller) const {
+    uint32_t due_us = controller.grinder->get_scheduled_stop_due_us();
+    uint32_t realized_us = 0;
+    if (controller.grinder->has_scheduled_stop_fired() &&
+        controller.grinder->get_edge_timeline().get_latest(MotorEdgeType::STOP, &realized_us)) {
+        controller.event_in_progress.event_flags |= GRIND_EVENT_FLAG_SCHEDULED_STOP;
+        LOG_RT_AT(LOG_CAT_GRIND, LOG_LEVEL_DEBUG, "[PREDICTIVE] Scheduled stop realized at %.2fms (%+ldus from requested)\n",
+                  (float)(realized_us - controller.session_start_us) / 1000.0f, (long)(int32_t)(realized_us - due_us));
+    } else {
+        LOG_RT("[PREDICTIVE] Scheduled stop overdue by %ldus, stopping on the tick\n",
+                (long)(int32_t)((uint32_t)esp_timer_get_time() - due_us));
     }
 }
 
+void WeightGrindStrategy::finish_predictive_stop(GrindController& controller,
+                                                 const GrindLoopData& loop_data,
+                                                 float end_weight, float end_flow_rate) const {
+    if (controller.grinder->has_scheduled_stop()) {
+        report_scheduled_stop(controller);
+    }
+    controller.grinder->stop();
+    controller.predictive_end_weight = end_weight;
+    controller.predictive_stop_flow_rate = end_flow_rate;
+    controller.pulse_flow_rate = controller.weight_sensor->get_flow_rate_95th_percentile(controller.flow_windows.pulse_flow_ms);
+    controller.switch_phase(GrindPhase::PULSE_SETTLING, loop_data);
+}
+
 void WeightGrindStrategy::run_pulse_decision_phase(GrindController& controller,
                                                    const GrindLoopData& loop_data) const {
     if (!controller.weight_sensor) {
         return;
     }
 
-    float settled_weight;
-    if (!controller.weight_sensor->check_settling_complete(GRIND_SCALE_PRECISION_SETTLING_TIME_MS, &settled_weight)) {
+    if (!loop_data.precision_settled) {
         return;
     }
+    float settled_weight = loop_data.precision_settled_weight;
+    if (controller.pulse_attempts > 0) {
+        controller.pulse_history[controller.pulse_attempts - 1].end_weight = settled_weight;
+    }
+    LOG_RT("[PULSE_DECISION] Settled after %lums (%lums window)\n",
+            loop_data.now - controller.phase_start_time, (unsigned long)loop_data.precision_settle_window_ms);
 
-    float conservative_target = controller.target_weight - GRIND_ACCURACY_TOLERANCE_G;
+    float conservative_target = controller.get_stop_target_weight() - controller.tolerance;
     float error = conservative_target - settled_weight;
 
+    // Coast: grounds that landed after the predictive stop edge
+    float weight_at_stop = 0.0f;
+    if (controller.pulse_attempts == 0 && controller.get_weight_after_motor_stop(0, &weight_at_stop)) {
+        LOG_RT("[PULSE_DECISION] Coast after motor stop: %.2fg (%.2fg at stop edge)\n",
+                settled_weight - weight_at_stop, weight_at_stop);
+    }
+
+    // Coast the stop rule has to anticipate: settled weight vs the weight it stopped at.
+    // Folded into the profile's coast model once the session completes.
+    if (controller.pulse_attempts == 0 && !controller.coast_observation_valid) {
+        controller.coast_observation_g = settled_weight - controller.predictive_end_weight;
+        controller.coast_observation_valid = true;
+    }
+
     // coast_time_ms removed - was only used for logging pulse history
 
-    if (controller.target_weight - settled_weight < GRIND_ACCURACY_TOLERANCE_G ||
-        controller.pulse_attempts >= GRIND_MAX_PULSE_ATTEMPTS) {
+    if (controller.get_stop_target_weight() - settled_weight < controller.tolerance ||
+        controller.pulse_attempts >= controller.session_descriptor.max_pulse_attempts) {
         controller.switch_phase(GrindPhase::FINAL_SETTLING, loop_data);
         return;
     }
 
-    controller.pulse_history[controller.pulse_attempts].start_weight = settled_weight;
-    controller.pulse_history[controller.pulse_attempts].end_weight = settled_weight;
+    start_correction_pulse(controller, loop_data, settled_weight, error, false);
+}
 
-    controller.current_pulse_duration_ms = calculate_pulse_duration_ms(controller, error);
-    controller.pulse_history[controller.pulse_attempts].duration_ms = controller.current_pulse_duration_ms;
+void WeightGrindStrategy::start_correction_pulse(GrindController& controller, const GrindLoopData& loop_data,
+                                                 float start_weight, float error_grams, bool projected) const {
+    PulseReport& report = controller.pulse_history[controller.pulse_attempts];
+    report.start_weight = start_weight;
+    report.end_weight = start_weight;
+    report.projected = projected;
+    if (projected && controller.pulse_attempts > 0) {
+        // The previous pulse ends on the same extrapolated weight
+        controller.pulse_history[controller.pulse_attempts - 1].end_weight = start_weight;
+        controller.pulse_history[controller.pulse_attempts - 1].projected = true;
+    }
+
+    controller.current_pulse_duration_ms = calculate_pulse_duration_ms(controller, error_grams);
+    report.duration_ms = controller.current_pulse_duration_ms;
 
     controller.switch_phase(GrindPhase::PULSE_EXECUTE, loop_data);
-    controller.grinder->start_pulse_rmt(static_cast<uint32_t>(controller.current_pulse_duration_ms));
+    if (projected) {
+        controller.event_in_progress.event_flags |= GRIND_EVENT_FLAG_PIPELINED_PULSE;
+    }
+#if GRIND_MICRO_PULSE_ENABLED
+    if (error_grams <= GRIND_MICRO_PULSE_MAX_ERROR_G &&
+        start_micro_pulse(controller, controller.current_pulse_duration_ms)) {
+        controller.pulse_attempts++;
+        return;
+    }
+#endif
+    controller.grinder->start_pulse_us(static_cast<uint32_t>(controller.current_pulse_duration_ms * 1000.0f));
 
     controller.pulse_attempts++;
 }
 
+bool WeightGrindStrategy::start_micro_pulse(GrindController& controller, float duration_ms) const {
+    MotorPulseStep steps[MOTOR_PULSE_MAX_STEPS];
+    float kick_ms = min(controller.get_motor_response_latency(), duration_ms);
+    float remaining_ms = duration_ms - kick_ms;
+    const uint32_t gap_us = static_cast<uint32_t>(GRIND_MICRO_PULSE_GAP_MS * 1000.0f);
+    uint8_t count = 0;
+    steps[count++] = {static_cast<uint32_t>(kick_ms * 1000.0f), gap_us};
+    while (remaining_ms > 0.0f) {
+        // The last step takes whatever the burst budget leaves over
+        float burst_ms = (count + 1 == MOTOR_PULSE_MAX_STEPS) ? remaining_ms
+                                                               : min(remaining_ms, GRIND_MICRO_PULSE_BURST_MS);
+        steps[count++] = {static_cast<uint32_t>(burst_ms * 1000.0f), gap_us};
+        remaining_ms -= burst_ms;
+    }
+    return controller.grinder->start_pulse_sequence(steps, count);
+}
+
+bool WeightGrindStrategy::try_pipelined_pulse(GrindController& controller, const GrindLoopData& loop_data,
+                                              uint32_t since_stop_ms) const {
+    // Only between correction pulses: the first decision settles fully, it feeds the coast model
+    if (controller.pulse_attempts == 0 || controller.pulse_attempts >= controller.session_descriptor.max_pulse_attempts) {
+        return false;
+    }
+    if (since_stop_ms < controller.grind_latency_ms + GRIND_PULSE_PIPELINE_MIN_SETTLE_MS) {
+        return false;
+    }
+
+    // First-order settling: what is still landing is flow * tau. The projection is
+    // trusted no further than that extrapolation plus a fixed margin.
+    float landing_g = max(0.0f, loop_data.flow_rate) * GRIND_PULSE_PIPELINE_SETTLE_TAU_MS / (float)SYS_MS_PER_SECOND;
+    float projected_weight = loop_data.current_weight + landing_g;
+    float upper_weight = projected_weight + landing_g + GRIND_PULSE_PIPELINE_MARGIN_G;
+
+    // Near the target the precision settle decides (and may finish)
+    if (controller.get_stop_target_weight() - upper_weight < controller.tolerance) {
+        return false;
+    }
+
+    LOG_RT_AT(LOG_CAT_GRIND, LOG_LEVEL_DEBUG, "[PULSE_SETTLING] Pipelined pulse %d after %lums: projected %.2fg (<= %.2fg)\n",
+              controller.pulse_attempts + 1, (unsigned long)since_stop_ms, projected_weight, upper_weight);
+    // Sized from the upper bound so a low projection cannot turn into an overshoot
+    float error = (controller.get_stop_target_weight() - controller.tolerance) - upper_weight;
+    start_correction_pulse(controller, loop_data, projected_weight, error, true);
+    return true;
+}
+
 void WeightGrindStrategy::run_pulse_execute_phase(GrindController& controller,
                                                   const GrindLoopData& loop_data) const {
     if (controller.grinder && controller.grinder->is_pulse_complete()) {
@@ -163,8 +381,18 @@ void WeightGrindStrategy::run_pulse_settling_phase(GrindController& controller,
         return;
     }
 
-    if (loop_data.now - controller.phase_start_time >= controller.grind_latency_ms + GRIND_MOTOR_SETTLING_TIME_MS) {
-        if (controller.weight_sensor->check_settling_complete(GRIND_MOTOR_SETTLING_TIME_MS)) {
+    // Settle from the actual motor-off edge when known (pulse end is timed in hardware)
+    uint32_t since_stop_ms = loop_data.now - controller.phase_start_time;
+    controller.get_ms_since_motor_edge(false, &since_stop_ms);
+
+#if GRIND_PULSE_PIPELINE_ENABLED
+    if (try_pipelined_pulse(controller, loop_data, since_stop_ms)) {
+        return;
+    }
+#endif
+
+    if (since_stop_ms >= controller.grind_latency_ms + GRIND_MOTOR_SETTLING_TIME_MS) {
+        if (loop_data.motor_settled) {
             controller.switch_phase(GrindPhase::PULSE_DECISION, loop_data);
         }
     }
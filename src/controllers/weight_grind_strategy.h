@@ -22,11 +22,31 @@ public:
 
     const char* name() const override { return "Weight"; }
 
-private:
+protected:
+    // Measures grind latency from the motor start edge once flow is seen (PREDICTIVE)
+    void confirm_flow_start(GrindController& controller, const GrindLoopData& loop_data) const;
+    // Sub-tick stop: arm Grinder::schedule_stop() if the crossing is delay_s away, inside this tick
+    bool schedule_stop_within_tick(GrindController& controller, float delay_s) const;
+    // An armed stop has cut the relay (or its timer is a tick overdue)
+    bool is_scheduled_stop_complete(const GrindController& controller) const;
+    void report_scheduled_stop(GrindController& controller) const;
+    // Motor off, pulse flow captured, on to PULSE_SETTLING
+    void finish_predictive_stop(GrindController& controller, const GrindLoopData& loop_data,
+                                float end_weight, float end_flow_rate) const;
+    // Soft stop: ramp the motor duty down over the last GRIND_SOFT_STOP_RAMP_G before stop_weight
+    void apply_soft_stop(GrindController& controller, float weight, float stop_weight) const;
     float get_clamped_pulse_flow_rate(const GrindController& controller) const;
     float calculate_pulse_duration_ms(const GrindController& controller, float error_grams) const;
     void run_predictive_phase(GrindController& controller, const GrindLoopData& loop_data) const;
     void run_pulse_decision_phase(GrindController& controller, const GrindLoopData& loop_data) const;
     void run_pulse_execute_phase(GrindController& controller, const GrindLoopData& loop_data) const;
     void run_pulse_settling_phase(GrindController& controller, const GrindLoopData& loop_data) const;
+    // Records the pulse in pulse_history[] and fires it; projected = start weight is extrapolated
+    void start_correction_pulse(GrindController& controller, const GrindLoopData& loop_data,
+                                float start_weight, float error_grams, bool projected) const;
+    // Same on-time as a kick (motor latency) plus short bursts; false if the grinder refused it
+    bool start_micro_pulse(GrindController& controller, float duration_ms) const;
+    // Pipelined pulses: fire the next correction from the projected settle while still settling
+    bool try_pipelined_pulse(GrindController& controller, const GrindLoopData& loop_data,
+                             uint32_t since_stop_ms) const;
 };
@@ -1,10 +1,27 @@
 #include "WeightSensor.h"
 #include "../config/constants.h"
+#include "../logging/deferred_log.h"
 #include "hx711_driver.h"
+#include "motor_edge_timeline.h"
+#include "../system/config_store.h"
+#if DEBUG_ENABLE_LOADCELL_HIL
+#include "adc_stream_load_cell_driver.h"
+#endif
 #if DEBUG_ENABLE_LOADCELL_MOCK
 #include "mock_hx711_driver.h"
+#include "replay_load_cell_driver.h"
+#else
+#include "ads1232_driver.h"
+#include "nau7802_driver.h"
+#if HW_LOADCELL_CHANNELS > 1
+#include "dual_hx711_driver.h"
+#endif
+#if HW_LOADCELL_USE_SPI_DRIVER
+#include "hx711_spi_driver.h"
+#endif
 #endif
 #include <Arduino.h>
+#include <esp_timer.h>
 #include <math.h>
 
 /*
@@ -15,18 +32,68 @@
  * Maintains backward compatibility with existing HX711-based code.
  */
 
+namespace {
+// Flow noise of GRIND_FLOW_ESTIMATOR over a window, for a per-sample noise of sample_sigma_g
+float flow_noise_gps(float sample_sigma_g, float window_s, uint32_t rate) {
+#if GRIND_FLOW_ESTIMATOR == GRIND_FLOW_ESTIMATOR_REGRESSION
+    const float window_samples = std::max(2.0f, window_s * rate);
+    return sample_sigma_g * sqrtf(12.0f / window_samples) / window_s;
+#else
+    (void)rate;
+    return sample_sigma_g * 1.41421356f / window_s;   // Newest minus oldest sample
+#endif
+}
+
+#if GRIND_ADAPTIVE_FLOW_WINDOWS_ENABLED
+// Shortest window on the GRIND_ADAPTIVE_WINDOW_STEP_MS grid whose flow noise is within target_gps
+uint32_t window_for_flow_noise_ms(float sample_sigma_g, float target_gps, uint32_t rate,
+                                  uint32_t min_ms, uint32_t max_ms) {
+#if GRIND_FLOW_ESTIMATOR == GRIND_FLOW_ESTIMATOR_REGRESSION
+    // sigma = s * sqrt(12 / rate) * T^-1.5
+    float window_s = powf(sample_sigma_g * sqrtf(12.0f / std::max(rate, (uint32_t)1)) / target_gps, 2.0f / 3.0f);
+#else
+    (void)rate;
+    float window_s = sample_sigma_g * 1.41421356f / target_gps;
+#endif
+    uint32_t steps = (uint32_t)ceilf(window_s * 1000.0f / GRIND_ADAPTIVE_WINDOW_STEP_MS);
+    return constrain(steps * GRIND_ADAPTIVE_WINDOW_STEP_MS, min_ms, max_ms);
+}
+#endif
+} // namespace
+
 // General ADC timing constants
 #define SIGNAL_TIMEOUT 100             // Signal timeout in ms
 #define TARE_TIMEOUT_MS 2000           // Tare operation timeout
 
 WeightSensor::WeightSensor() {
+    grinder_channel = 0;
+    config = &config_store;
     // Initialize calibration parameters
 #if DEBUG_ENABLE_LOADCELL_MOCK
     cal_factor = DEBUG_MOCK_CAL_FACTOR;
 #else
     cal_factor = USER_DEFAULT_CALIBRATION_FACTOR;
 #endif
+    calibration_curves[0].set_single_factor(cal_factor);
+    active_curve_.store(0);
+    CalibrationCurve::initial_state(&calibration_points);
+    CalibrationCurve::initial_state(&capture_points);
+    span_scale = 1.0f;
+    span_temperature_c = NAN;
+    flow_stability_.store(1.0f);
+    refresh_raw_thresholds();
     tare_offset = 0;
+    zero_tracking_allowed_.store(true);
+    last_zero_track_us = 0;
+    motor_edges = nullptr;
+    vibration_notch_running = false;
+    vibration_tone_hz_.store(HW_LOADCELL_VIBRATION_NOTCH_HZ);
+    vibration_notch_bypass_.store(false);
+    cup_detection_armed_.store(false);
+    cup_detector_running = false;
+    cup_placement = {};
+    cup_placement_sequence_.store(0);
+    cup_tare_pending_.store(false);
     
     // Initialize current readings
     current_weight = 0.0;
@@ -37,6 +104,7 @@ WeightSensor::WeightSensor() {
     prefs = nullptr;
     hardware_fault_ = HardwareFault::NONE;
     detected_sample_rate_sps_ = HW_LOADCELL_SAMPLE_RATE_SPS;
+    noise_sigma_raw_base = 0.0f;
 
     // Initialize tare state
     doTare = false;
@@ -46,21 +114,16 @@ WeightSensor::WeightSensor() {
     tareTimeOut = 0;
     
     // Initialize stable reading diagnostic tracking
-    not_settled_start_time = 0;
-    currently_not_settled = false;
-    display_noisy_state = false;  // Start showing "Yes"
-
-    calibration_flag_cached_ = false;
-    calibration_flag_value_ = false;
-    calibration_namespace_initialized_ = false;
+    settling_noise_window = {};
+    unsettled_since_ms_ = 0;
+    settling_window_closed_ms_ = 0;
+    status_generation_ = 0;
 
     // RealtimeController integration removed - handled by WeightSamplingTask
 
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // Initialize SPS tracking
-    sps_buffer_index = 0;
-    sps_sample_count = 0;
-    memset(sps_timestamps, 0, sizeof(sps_timestamps));
+    sps_timestamps.wipe();
 #endif
 }
 
@@ -68,18 +131,15 @@ WeightSensor::~WeightSensor() {
     // WeightSensor cleanup
 }
 
-void WeightSensor::init(Preferences* preferences) {
+void WeightSensor::init(Preferences* preferences, uint8_t channel, ConfigStore* store) {
     prefs = preferences;
+    grinder_channel = channel;
+    config = store ? store : &config_store;
     
     LOG_BLE("Initializing WeightSensor configuration and filters...\n");
     
     // Create load cell driver instance based on configuration
-#if DEBUG_ENABLE_LOADCELL_MOCK
-    adc_driver = std::make_unique<MockHX711Driver>();
-#else
-    adc_driver = std::make_unique<HX711Driver>(HW_LOADCELL_SCK_PIN, HW_LOADCELL_DOUT_PIN);
-#endif
-    if (!adc_driver) {
+    if (!initialize_adc_hardware()) {
         LOG_BLE("ERROR: Failed to create ADC driver\n");
         return;
     }
@@ -100,10 +160,6 @@ void WeightSensor::init(Preferences* preferences) {
     tareStatus = false;
     hardware_fault_ = HardwareFault::NONE;
     detected_sample_rate_sps_ = HW_LOADCELL_SAMPLE_RATE_SPS;
-
-    calibration_flag_cached_ = false;
-    calibration_flag_value_ = false;
-    calibration_namespace_initialized_ = false;
     
     LOG_BLE("WeightSensor configuration initialized - hardware will be initialized by WeightSamplingTask\n");
 }
@@ -180,18 +236,18 @@ bool WeightSensor::validate_hardware() {
     }
     return valid;
 #else
-    detected_sample_rate_sps_ = HW_LOADCELL_SAMPLE_RATE_SPS;
-    HX711Driver* hx_driver = static_cast<HX711Driver*>(adc_driver.get());
-    detected_sample_rate_sps_ = hx_driver ? hx_driver->get_estimated_sample_rate_sps() : HW_LOADCELL_SAMPLE_RATE_SPS;
+    detected_sample_rate_sps_ = adc_driver->get_estimated_sample_rate_sps();
     
     if (!valid) {
         return false;
     }
     
-    constexpr float kSampleRateUpperThreshold = HW_LOADCELL_SAMPLE_RATE_SPS * 4.0f; // Expect 10 SPS; anything >40 SPS is invalid
-    if (detected_sample_rate_sps_ > kSampleRateUpperThreshold) {
-        LOG_BLE("ERROR: HX711 sample rate detected at %.1f SPS (expected ≈ %d SPS)\n",
-                detected_sample_rate_sps_, HW_LOADCELL_SAMPLE_RATE_SPS);
+    // Validation runs at the default rate; a rate pin strapped for 80 SPS shows up far above it
+    uint32_t expected_sps = adc_driver->get_sample_rate();
+    float sample_rate_upper_threshold = expected_sps * 4.0f; // Expect 10 SPS; anything >40 SPS is invalid
+    if (detected_sample_rate_sps_ > sample_rate_upper_threshold) {
+        LOG_BLE("ERROR: %s sample rate detected at %.1f SPS (expected ≈ %lu SPS)\n",
+                adc_driver->get_driver_name(), detected_sample_rate_sps_, (unsigned long)expected_sps);
         if (hardware_fault_ == HardwareFault::NONE) {
             hardware_fault_ = HardwareFault::INVALID_SAMPLE_RATE;
         }
@@ -212,6 +268,29 @@ const char* WeightSensor::get_adc_driver_name() const {
     return adc_driver ? adc_driver->get_driver_name() : "Unknown";
 }
 
+uint8_t WeightSensor::get_adc_channel_count() const {
+    return adc_driver ? adc_driver->get_channel_count() : 0;
+}
+
+int32_t WeightSensor::get_adc_channel_raw(uint8_t channel) const {
+    return adc_driver ? adc_driver->get_channel_raw_data(channel) : 0;
+}
+
+float WeightSensor::get_adc_channel_gain(uint8_t channel) const {
+    return adc_driver ? adc_driver->get_channel_gain(channel) : 1.0f;
+}
+
+bool WeightSensor::set_adc_channel_gain(uint8_t channel, float gain) {
+    if (!adc_driver || !adc_driver->set_channel_gain(channel, gain)) {
+        return false;
+    }
+    if (channel == 1) {
+        config->set_float(ConfigFloat::CHANNEL2_GAIN, gain);
+    }
+    LOG_BLE("Load cell channel %u gain set to %.4f\n", (unsigned)channel + 1, gain);
+    return true;
+}
+
 bool WeightSensor::supports_temperature_sensor() const {
     return adc_driver ? adc_driver->supports_temperature_sensor() : false;
 }
@@ -224,18 +303,202 @@ uint32_t WeightSensor::get_max_sample_rate() const {
     return adc_driver ? adc_driver->get_max_sample_rate() : 0;
 }
 
+bool WeightSensor::set_sample_rate(uint32_t sps) {
+    if (!adc_driver || !adc_driver->set_sample_rate(sps)) {
+        return false;
+    }
+    
+#if HW_LOADCELL_DECIMATION_ENABLED
+    // A rate switch drops the block in progress; its conversions belong to the old rate
+    raw_filter.set_sample_rate(decimator.configure(sps));
+#if HW_LOADCELL_DECIMATION_RAW_RETENTION
+    raw_stream.set_sample_rate(sps);
+#endif
+    LOG_LOADCELL_DEBUG("[WeightSensor] Sample rate set to %lu SPS (ring %lu SPS, decimation %u)\n", (unsigned long)sps,
+                       (unsigned long)raw_filter.get_sample_rate(), (unsigned)decimator.get_factor());
+#else
+    raw_filter.set_sample_rate(sps);
+    LOG_LOADCELL_DEBUG("[WeightSensor] Sample rate set to %lu SPS\n", (unsigned long)sps);
+#endif
+    refresh_raw_thresholds();
+    return true;
+}
+
+uint32_t WeightSensor::get_sample_rate_sps() const {
+    return raw_filter.get_sample_rate();
+}
+
+uint32_t WeightSensor::get_adc_sample_rate_sps() const {
+#if HW_LOADCELL_DECIMATION_ENABLED
+    return adc_driver ? adc_driver->get_sample_rate() : raw_filter.get_sample_rate() * decimator.get_factor();
+#else
+    return raw_filter.get_sample_rate();
+#endif
+}
+
+const SampleSequenceSource* WeightSensor::get_recording_source() const {
+#if HW_LOADCELL_DECIMATION_ENABLED && HW_LOADCELL_DECIMATION_RAW_RETENTION
+    return &raw_stream;
+#else
+    return &raw_filter;
+#endif
+}
+
+void WeightSensor::refresh_raw_thresholds() {
+    uint32_t rate = raw_filter.get_sample_rate();
+#if HW_LOADCELL_DECIMATION_ENABLED
+    // Noise of one conversion at the ADC rate, times what the decimator leaves of it
+    uint32_t adc_rate = rate * decimator.get_factor();
+    raw_thresholds.noise_scale = (adc_rate <= HW_LOADCELL_SAMPLE_RATE_SPS ? 1.0f : sqrtf((float)adc_rate / (float)HW_LOADCELL_SAMPLE_RATE_SPS)) *
+                                 decimator.get_noise_gain();
+#else
+    raw_thresholds.noise_scale = rate <= HW_LOADCELL_SAMPLE_RATE_SPS ? 1.0f : sqrtf((float)rate / (float)HW_LOADCELL_SAMPLE_RATE_SPS);
+#endif
+    raw_thresholds.grams_per_raw = fabsf(cal_factor) > 1e-6f ? 1.0f / cal_factor : 0.0f;
+    float settling_g = GRIND_SCALE_SETTLING_TOLERANCE_G;
+    raw_thresholds.flow_detection_gps = GRIND_FLOW_DETECTION_THRESHOLD_GPS;
+    FlowWindows windows = {GRIND_FLOW_DETECTION_WINDOW_MS, GRIND_FLOW_PREDICTION_WINDOW_MS, GRIND_PULSE_FLOW_WINDOW_MS};
+#if GRIND_NOISE_FLOOR_ENABLED
+    if (noise_floor.is_valid()) {
+        const float floor_g = noise_floor.get_floor_raw() * fabsf(raw_thresholds.grams_per_raw);
+        settling_g = constrain(GRIND_NOISE_FLOOR_SETTLING_SIGMAS * floor_g, GRIND_NOISE_FLOOR_SETTLING_MIN_G,
+                               GRIND_NOISE_FLOOR_SETTLING_MAX_G);
+        const float sample_sigma_g = floor_g * raw_thresholds.noise_scale;
+#if GRIND_ADAPTIVE_FLOW_WINDOWS_ENABLED
+        // Shortest windows that meet the target noise: a quiet scale confirms flow and predicts the
+        // coast sooner, a noisy one averages longer. Detection aims for the threshold floor below.
+        windows.detection_ms = window_for_flow_noise_ms(sample_sigma_g, GRIND_NOISE_FLOOR_FLOW_MIN_GPS / GRIND_NOISE_FLOOR_FLOW_SIGMAS,
+                                                        rate, GRIND_ADAPTIVE_DETECTION_MIN_MS, GRIND_ADAPTIVE_DETECTION_MAX_MS);
+        const float stretch = 1.0f + GRIND_ADAPTIVE_INSTABILITY_GAIN * (1.0f - constrain(flow_stability_.load(), 0.0f, 1.0f));
+        windows.prediction_ms = window_for_flow_noise_ms(sample_sigma_g, GRIND_ADAPTIVE_PREDICTION_SIGMA_GPS / stretch, rate,
+                                                         GRIND_ADAPTIVE_PREDICTION_MIN_MS, GRIND_ADAPTIVE_PREDICTION_MAX_MS);
+        windows.pulse_flow_ms = windows.prediction_ms + (GRIND_PULSE_FLOW_WINDOW_MS - GRIND_FLOW_PREDICTION_WINDOW_MS);
+#endif
+        // Noise of the flow the grind loop confirms first grounds with, at the live rate
+        const float flow_sigma_gps = flow_noise_gps(sample_sigma_g, windows.detection_ms / 1000.0f, rate);
+        raw_thresholds.flow_detection_gps = constrain(GRIND_NOISE_FLOOR_FLOW_SIGMAS * flow_sigma_gps,
+                                                      GRIND_NOISE_FLOOR_FLOW_MIN_GPS, GRIND_NOISE_FLOOR_FLOW_MAX_GPS);
+    }
+#endif
+    raw_thresholds.flow_windows = windows;
+    raw_thresholds.settling_raw = weight_to_raw_threshold(settling_g * raw_thresholds.noise_scale);
+    raw_thresholds.sequential_mean_raw = fabsf(GRIND_SCALE_SEQUENTIAL_SETTLING_TOLERANCE_G * cal_factor);
+    raw_thresholds.auto_zero_band_raw = (float)weight_to_raw_threshold(GRIND_AUTO_ZERO_BAND_G);
+    raw_thresholds.auto_zero_max_total_raw = (float)weight_to_raw_threshold(GRIND_AUTO_ZERO_MAX_TOTAL_G);
+}
+
+void WeightSensor::set_sequential_settle_request(CircularBufferMath::SequentialSettleMetrics* settle,
+                                                 uint32_t max_window_ms) const {
+#if GRIND_SCALE_SEQUENTIAL_SETTLING_ENABLED
+    settle->min_window_ms = GRIND_SCALE_SEQUENTIAL_SETTLING_MIN_WINDOW_MS;
+    settle->max_window_ms = max_window_ms;
+    settle->min_samples = GRIND_SCALE_SEQUENTIAL_SETTLING_MIN_SAMPLES;
+    settle->std_dev_limit_raw = (float)raw_thresholds.settling_raw;
+    settle->mean_tolerance_raw = raw_thresholds.sequential_mean_raw;
+    settle->z_score = GRIND_SCALE_SEQUENTIAL_SETTLING_Z_SCORE;
+#else
+    (void)max_window_ms;
+    settle->max_window_ms = 0;
+#endif
+}
+
 // Hardware abstraction helper methods
+bool WeightSensor::initialize_adc_hardware() {
+    adc_driver.reset();
+    
+#if DEBUG_ENABLE_LOADCELL_HIL
+    adc_driver = std::make_unique<AdcStreamLoadCellDriver>();
+#elif DEBUG_ENABLE_LOADCELL_MOCK
+#if DEBUG_ENABLE_LOADCELL_REPLAY
+    adc_driver = std::make_unique<ReplayLoadCellDriver>();
+#else
+    adc_driver = std::make_unique<MockHX711Driver>();
+#endif
+#else
+#if HW_GRINDER_CHANNELS > 1
+    static_assert(HW_GRINDER_CHANNELS == 2, "HW_GRINDER_CHANNELS: one or two grinders");
+    if (grinder_channel > 0) {
+        // Further grinders are a plain HX711 each; the board's other ADC options stay with the first
+        adc_driver = std::make_unique<HX711Driver>(HW_GRINDER2_LOADCELL_SCK_PIN, HW_GRINDER2_LOADCELL_DOUT_PIN);
+        return true;
+    }
+#endif
+#if HW_LOADCELL_CHANNELS > 1
+    static_assert(HW_LOADCELL_CHANNELS == 2, "HW_LOADCELL_CHANNELS: one or two HX711s");
+    static_assert(HW_LOADCELL_ADC_TYPE == HW_LOADCELL_ADC_AUTO || HW_LOADCELL_ADC_TYPE == HW_LOADCELL_ADC_HX711,
+                  "HW_LOADCELL_CHANNELS 2 is a pair of HX711s");
+    adc_driver = std::make_unique<DualHX711Driver>(HW_LOADCELL_SCK_PIN, HW_LOADCELL_DOUT_PIN, HW_LOADCELL_DOUT2_PIN);
+#else
+    uint8_t adc_type = HW_LOADCELL_ADC_TYPE;
+    if (adc_type == HW_LOADCELL_ADC_AUTO) {
+        // NAU7802 answers on I2C; HX711 and ADS1232 share a 2-wire protocol that
+        // cannot be told apart, so anything else is treated as HX711
+        adc_type = NAU7802Driver::probe() ? HW_LOADCELL_ADC_NAU7802 : HW_LOADCELL_ADC_HX711;
+        LOG_BLE("ADC auto-detect: %s\n", adc_type == HW_LOADCELL_ADC_NAU7802 ? "NAU7802 found on I2C" : "no NAU7802, using HX711");
+    }
+    
+    switch (adc_type) {
+        case HW_LOADCELL_ADC_NAU7802:
+            adc_driver = std::make_unique<NAU7802Driver>(HW_NAU7802_DRDY_PIN);
+            break;
+        case HW_LOADCELL_ADC_ADS1232:
+            adc_driver = std::make_unique<ADS1232Driver>(HW_LOADCELL_SCK_PIN, HW_LOADCELL_DOUT_PIN, HW_ADS1232_SPEED_PIN);
+            break;
+        case HW_LOADCELL_ADC_HX711:
+        default:
+#if HW_LOADCELL_USE_SPI_DRIVER
+            adc_driver = std::make_unique<HX711SpiDriver>(HW_LOADCELL_SCK_PIN, HW_LOADCELL_DOUT_PIN);
+#else
+            adc_driver = std::make_unique<HX711Driver>(HW_LOADCELL_SCK_PIN, HW_LOADCELL_DOUT_PIN);
+#endif
+            break;
+    }
+#endif
+#endif
+    
+    return adc_driver != nullptr;
+}
+
 void WeightSensor::update_temperature_if_available() {
     if (adc_driver && adc_driver->supports_temperature_sensor()) {
         current_temperature = adc_driver->get_temperature();
+        update_span_compensation();
     }
 }
 
+void WeightSensor::update_span_compensation() {
+    if (HW_LOADCELL_SPAN_TEMPCO_PPM_PER_C == 0.0f || !isfinite(current_temperature) ||
+        !isfinite(calibration_points.temperature_c)) {
+        span_scale = 1.0f;
+        return;
+    }
+    // Temperature moves slowly; only re-derive the factor when it has
+    if (fabsf(current_temperature - span_temperature_c) < 0.05f) {
+        return;
+    }
+    span_temperature_c = current_temperature;
+    float sensitivity = 1.0f + HW_LOADCELL_SPAN_TEMPCO_PPM_PER_C * 1e-6f * (current_temperature - calibration_points.temperature_c);
+    span_scale = 1.0f / sensitivity;
+}
+
+void WeightSensor::apply_calibration_curve(const CalibrationCurve& curve) {
+    uint8_t inactive = active_curve_.load() ^ 1;
+    calibration_curves[inactive] = curve;
+    active_curve_.store(inactive, std::memory_order_release);
+    cal_factor = curve.get_nominal_factor();
+    refresh_raw_thresholds();
+    span_temperature_c = NAN;   // Re-derive span_scale against this curve's capture temperature
+}
+
 void WeightSensor::tare() {
     LOG_LOADCELL_DEBUG("[DEBUG %lums] BLOCKING_TARE_START: Beginning blocking tare operation using HX711_ADC exact implementation\n", millis());
 
     // Use exact HX711_ADC non-blocking implementation
     tareNoDelay();
+    if (xPortGetCoreID() == 0) {
+        LOG_RT("ERROR: Blocking tare called on Core 0 - left running non-blocking\n");
+        return;
+    }
 
     // Wait for tare completion with timeout
     unsigned long start_time = millis();
@@ -266,20 +529,35 @@ void WeightSensor::tare() {
 }
 
 void WeightSensor::calibrate(float known_weight) {
+    begin_calibration();
+    add_calibration_point(known_weight);
+}
+
+void WeightSensor::begin_calibration() {
+    CalibrationCurve::initial_state(&capture_points);
+    capture_points.temperature_c = current_temperature;
+}
+
+bool WeightSensor::add_calibration_point(float known_weight) {
 #if DEBUG_ENABLE_LOADCELL_MOCK
     LOG_BLE("Mock load cell: calibration skipped (fixed factor %.2f)\n", cal_factor);
-    return;
+    return false;
 #endif
     if (known_weight <= 0) {
         LOG_BLE("ERROR: Invalid calibration weight\n");
-        return;
+        return false;
     }
     if (has_hardware_fault()) {
         LOG_BLE("ERROR: Cannot calibrate - HX711 hardware fault active\n");
-        return;
+        return false;
+    }
+    if (capture_points.count >= CalibrationCurve::MAX_POINTS) {
+        LOG_BLE("ERROR: Calibration already has %u points\n", (unsigned)capture_points.count);
+        return false;
     }
     
-    LOG_BLE("Starting calibration with %.3fg weight...\n", known_weight);
+    LOG_BLE("Starting calibration point %u with %.3fg weight...\n",
+            (unsigned)capture_points.count + 1, known_weight);
     
     // First, wait for weight to settle (user just placed calibration weight)
     LOG_CALIBRATION_DEBUG("Waiting for calibration weight to settle...\n");
@@ -297,19 +575,40 @@ void WeightSensor::calibrate(float known_weight) {
     // Calibration using raw ADC data - more precise than calibrated data
     int32_t raw_reading = raw_filter.get_raw_high_latency(); // Use high-latency for precision
     
-    // Calculate new calibration factor: raw_change / weight_change
-    // We know the weight change is known_weight (from 0 after taring)
-    float new_cal_factor = (float)(raw_reading - tare_offset) / known_weight;
-    cal_factor = new_cal_factor;
-    
-    save_calibration();
-    save_calibration_weight(known_weight);
+    // Point = raw change from the tare zero for known_weight; points are kept
+    // sorted by grams and the curve must rise through all of them
+    CalibrationPointsState points = capture_points;
+    uint8_t index = points.count;
+    while (index > 0 && points.grams[index - 1] > known_weight) {
+        points.grams[index] = points.grams[index - 1];
+        points.raw_delta[index] = points.raw_delta[index - 1];
+        index--;
+    }
+    points.grams[index] = known_weight;
+    points.raw_delta[index] = raw_reading - tare_offset;
+    points.count++;
+
+    CalibrationCurve curve;
+    bool accepted = curve.set_points(points);
+    if (accepted) {
+        capture_points = points;
+        calibration_points = points;
+        apply_calibration_curve(curve);
+        save_calibration();
+        save_calibration_weight(known_weight);
+    }
     
     // Clear buffer after calibration operation for clean measurements
     raw_filter.clear_all_samples();
     raw_filter.reset_display_filter();
     
-    LOG_BLE("Calibration completed. New factor: %.2f\n", cal_factor);
+    if (!accepted) {
+        LOG_BLE("ERROR: Calibration point %.3fg (%ld raw) does not extend the curve - rejected\n",
+                known_weight, (long)(raw_reading - tare_offset));
+        return false;
+    }
+    LOG_BLE("Calibration completed. %u point(s), nominal factor: %.2f\n", (unsigned)calibration_points.count, cal_factor);
+    return true;
 }
 
 void WeightSensor::set_calibration_factor(float factor) {
@@ -319,10 +618,134 @@ void WeightSensor::set_calibration_factor(float factor) {
 #else
     cal_factor = factor;
 #endif
+    CalibrationCurve curve;
+    curve.set_single_factor(cal_factor);
+    apply_calibration_curve(curve);
 }
 
 void WeightSensor::set_zero_offset(int32_t offset) {
     tare_offset = offset;
+    zero_tracker.reset(offset, current_temperature);
+}
+
+void WeightSensor::track_zero(uint32_t timestamp_us) {
+#if GRIND_AUTO_ZERO_ENABLED
+    if (!zero_tracking_allowed_.load() || (int32_t)(timestamp_us - last_zero_track_us) < GRIND_AUTO_ZERO_INTERVAL_MS * 1000) {
+        return;
+    }
+    last_zero_track_us = timestamp_us;
+
+    CircularBufferMath::RawSnapshot raw = {};
+    raw.window_count = 1;
+    raw.windows[0].window_ms = GRIND_AUTO_ZERO_INTERVAL_MS;
+    if (!raw_filter.fill_snapshot(&raw)) {
+        return;
+    }
+
+    ZeroTracker::Observation observation;
+    observation.time_us = timestamp_us;
+    observation.sample_count = raw.windows[0].sample_count;
+    observation.mean_raw = raw.windows[0].smoothed_raw;
+    observation.std_dev_raw = raw.windows[0].std_dev_raw;
+    observation.temperature_c = current_temperature;
+
+    ZeroTracker::Limits limits;
+    limits.band_raw = raw_thresholds.auto_zero_band_raw;
+    limits.max_total_raw = raw_thresholds.auto_zero_max_total_raw;
+    limits.std_dev_limit_raw = (float)raw_thresholds.settling_raw;
+    limits.min_samples = GRIND_AUTO_ZERO_MIN_SAMPLES;
+
+    int32_t new_offset = tare_offset;
+    if (zero_tracker.update(observation, limits, tare_offset, &new_offset)) {
+        LOG_LOADCELL_DEBUG("[DEBUG %lums] AUTO_ZERO: offset %ld -> %ld (drift %.5fg/s)\n", millis(),
+                           (long)tare_offset, (long)new_offset, get_zero_drift_rate_gps());
+        tare_offset = new_offset;
+    }
+#else
+    (void)timestamp_us;
+#endif
+}
+
+void WeightSensor::track_noise_floor(int32_t raw_adc, uint32_t timestamp_us) {
+    // Idle: the controller is IDLE, no tare is running and the motor stopped a while ago
+    bool idle = zero_tracking_allowed_.load() && !doTare;
+    MotorEdgeTimeline::Edge edge;
+    if (idle && motor_edges && motor_edges->get_edge(0, &edge)) {
+        idle = !MotorEdgeTimeline::is_on_edge(edge.type) &&
+               (int32_t)(timestamp_us - edge.timestamp_us) >= GRIND_MOTOR_SETTLING_TIME_MS * 1000L;
+    }
+    if (noise_floor.add_sample(raw_adc, timestamp_us, idle, raw_thresholds.noise_scale)) {
+        refresh_raw_thresholds();
+    }
+}
+
+void WeightSensor::observe_flow_stability(float mean_fit_r2) {
+    // Applied with the next idle noise floor update, before the next grind
+    float stability = flow_stability_.load();
+    flow_stability_.store(stability + GRIND_ADAPTIVE_STABILITY_SMOOTHING * (constrain(mean_fit_r2, 0.0f, 1.0f) - stability));
+}
+
+void WeightSensor::track_cup(int32_t raw_adc, uint32_t timestamp_us) {
+    if (!cup_detection_armed_.load(std::memory_order_relaxed) || doTare) {
+        if (cup_detector_running) {
+            cup_detector.reset();
+            cup_detector_running = false;
+        }
+        return;
+    }
+    cup_detector_running = true;
+
+    CupDetector::Limits limits;
+    limits.grams_per_raw = raw_thresholds.grams_per_raw;
+    limits.step_g = USER_AUTO_GRIND_TRIGGER_DELTA_G;
+    limits.std_dev_limit_raw = (float)raw_thresholds.settling_raw;
+    limits.settle_us = USER_AUTO_GRIND_CUP_SETTLE_MS * 1000UL;
+    limits.min_samples = USER_AUTO_GRIND_CUP_MIN_SAMPLES;
+
+    CupDetector::Placement placement;
+    if (!cup_detector.add_sample(raw_adc, timestamp_us, limits, &placement)) {
+        return;
+    }
+    cup_placement_sequence_.fetch_add(1, std::memory_order_acq_rel);
+    cup_placement = placement;
+    cup_placement_sequence_.fetch_add(1, std::memory_order_release);
+    cup_tare_pending_.store(true);
+}
+
+bool WeightSensor::get_cup_placement(CupDetector::Placement* placement_out) const {
+    uint32_t sequence = cup_placement_sequence_.load(std::memory_order_acquire);
+    if (!placement_out || sequence == 0 || (sequence & 1u)) {
+        return false;
+    }
+    *placement_out = cup_placement;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return cup_placement_sequence_.load(std::memory_order_relaxed) == sequence;
+}
+
+int32_t WeightSensor::filter_motor_vibration(int32_t raw_adc, uint32_t timestamp_us) {
+    MotorEdgeTimeline::Edge edge;
+    bool motor_on = motor_edges && motor_edges->get_edge(0, &edge) && MotorEdgeTimeline::is_on_edge(edge.type) &&
+                    (int32_t)(timestamp_us - edge.timestamp_us) >= 0;
+    if (!motor_on || vibration_notch_bypass_.load(std::memory_order_relaxed)) {
+        vibration_notch_running = false;
+        return raw_adc;
+    }
+
+    // Coefficients follow the live rate and tone; a change restarts the filter on the new ones
+    uint32_t sample_rate_sps = adc_driver->get_sample_rate();
+    float tone_hz = vibration_tone_hz_.load(std::memory_order_relaxed);
+    if (sample_rate_sps != vibration_notch.get_design_rate_sps() || tone_hz != vibration_notch.get_design_tone_hz()) {
+        vibration_notch.design(tone_hz, HW_LOADCELL_VIBRATION_NOTCH_Q, sample_rate_sps);
+        vibration_notch_running = false;
+    }
+    if (!vibration_notch.is_designed()) {
+        return raw_adc;
+    }
+    if (!vibration_notch_running) {
+        vibration_notch.start(raw_adc);
+        vibration_notch_running = true;
+    }
+    return vibration_notch.process(raw_adc);
 }
 
 void WeightSensor::update() {
@@ -339,7 +762,7 @@ void WeightSensor::update() {
 
 bool WeightSensor::is_settled(uint32_t window_ms) {
     // Convert grams threshold to raw threshold and use CircularBufferMath
-    int32_t raw_threshold = weight_to_raw_threshold(GRIND_SCALE_SETTLING_TOLERANCE_G);
+    int32_t raw_threshold = raw_thresholds.settling_raw;
     
     // Debug output for threshold conversion every 5s to avoid spam
     static uint32_t last_threshold_debug = 0;
@@ -352,11 +775,6 @@ bool WeightSensor::is_settled(uint32_t window_ms) {
     return raw_filter.is_settled(window_ms, raw_threshold);
 }
 
-// WARNING: This method blocks execution until weight settles or times out!
-float WeightSensor::get_motor_settled_weight(float* settle_time_out) {
-    return get_settled_weight(GRIND_MOTOR_SETTLING_TIME_MS, settle_time_out);
-}
-
 // WARNING: This method blocks execution until weight settles or times out!
 float WeightSensor::get_precision_settled_weight(float* settle_time_out) {
     return get_settled_weight(GRIND_SCALE_PRECISION_SETTLING_TIME_MS, settle_time_out);
@@ -368,6 +786,14 @@ float WeightSensor::get_settled_weight(uint32_t window_ms, float* settle_time_ou
     
     unsigned long start_time = millis();
     float settled_weight = 0.0f;
+
+    if (xPortGetCoreID() == 0) {
+        LOG_RT("ERROR: Blocking settle called on Core 0 - returning unsettled weight\n");
+        if (settle_time_out) {
+            *settle_time_out = 0.0f;
+        }
+        return raw_to_weight(raw_filter.get_smoothed_raw(window_ms));
+    }
     
     // Blocking loop - keep updating and checking until settled or timeout
     while (millis() - start_time < GRIND_SCALE_SETTLING_TIMEOUT_MS) {
@@ -395,6 +821,25 @@ float WeightSensor::get_settled_weight(uint32_t window_ms, float* settle_time_ou
     return raw_to_weight(raw_filter.get_smoothed_raw(window_ms));
 }
 
+bool WeightSensor::get_weight_at_time_us(uint32_t timestamp_us, float* weight_out,
+                                         uint32_t* sample_time_us_out) const {
+    int32_t raw = 0;
+    if (!weight_out || !raw_filter.get_raw_at_time_us(timestamp_us, &raw, sample_time_us_out)) {
+        return false;
+    }
+    *weight_out = raw_to_weight(raw);
+    return true;
+}
+
+bool WeightSensor::get_weight_before_time_us(uint32_t end_us, uint32_t window_ms, float* weight_out) const {
+    int32_t raw = 0;
+    if (!weight_out || !raw_filter.get_smoothed_raw_before_us(end_us, window_ms, &raw)) {
+        return false;
+    }
+    *weight_out = raw_to_weight(raw);
+    return true;
+}
+
 // Raw ADC data access methods
 int32_t WeightSensor::get_raw_adc_instant() const {
     return raw_filter.get_instant_raw();
@@ -426,6 +871,84 @@ float WeightSensor::get_weight_high_latency() const {
     return raw_to_weight(raw_filter.get_raw_high_latency());
 }
 
+bool WeightSensor::get_snapshot(WeightSnapshot* snapshot_out) {
+    if (!snapshot_out) {
+        return false;
+    }
+    
+    // Duplicate lengths cost nothing: every window comes out of the same pass
+    enum { WINDOW_LOW_LATENCY, WINDOW_FLOW, WINDOW_DISPLAY, WINDOW_MOTOR_SETTLING, WINDOW_PRECISION_SETTLING,
+           WINDOW_FLOW_DETECTION, WINDOW_FLOW_PREDICTION, WINDOW_COUNT };
+    static_assert(WINDOW_COUNT <= CircularBufferMath::SNAPSHOT_MAX_WINDOWS, "snapshot window table too small");
+    CircularBufferMath::RawSnapshot raw = {};
+    raw.window_count = WINDOW_COUNT;
+    raw.windows[WINDOW_LOW_LATENCY].window_ms = 100;       // get_raw_low_latency()
+    raw.windows[WINDOW_FLOW].window_ms = 200;              // get_flow_rate() default
+    raw.windows[WINDOW_DISPLAY].window_ms = 300;           // get_display_raw()
+    raw.windows[WINDOW_MOTOR_SETTLING].window_ms = GRIND_MOTOR_SETTLING_TIME_MS;
+    raw.windows[WINDOW_PRECISION_SETTLING].window_ms = GRIND_SCALE_PRECISION_SETTLING_TIME_MS;
+    raw.windows[WINDOW_FLOW_DETECTION].window_ms = raw_thresholds.flow_windows.detection_ms;
+    raw.windows[WINDOW_FLOW_PREDICTION].window_ms = raw_thresholds.flow_windows.prediction_ms;
+    set_sequential_settle_request(&raw.settle, GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
+    
+    if (!raw_filter.fill_snapshot(&raw)) {
+        // Empty ring (e.g. right after a clear): same answers as the individual queries
+        snapshot_out->low_latency_weight = get_weight_low_latency();
+        snapshot_out->display_weight = get_display_weight();
+        snapshot_out->flow_rate = 0.0f;
+        snapshot_out->flow_rate_detection = 0.0f;
+        snapshot_out->flow_rate_prediction = 0.0f;
+        snapshot_out->flow_fit_confidence = 0.0f;
+        snapshot_out->motor_settled = is_settled(GRIND_MOTOR_SETTLING_TIME_MS);
+        snapshot_out->precision_settled = is_settled(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
+        snapshot_out->precision_settled_weight = raw_to_weight(raw_filter.get_smoothed_raw(GRIND_SCALE_PRECISION_SETTLING_TIME_MS));
+        snapshot_out->precision_settle_window_ms = snapshot_out->precision_settled ? GRIND_SCALE_PRECISION_SETTLING_TIME_MS : 0;
+        snapshot_out->sample_timestamp_us = get_latest_sample_time_us();
+        snapshot_out->estimate_valid = false;
+        snapshot_out->estimated_weight = snapshot_out->low_latency_weight;
+        snapshot_out->estimated_flow_rate = snapshot_out->flow_rate;
+        return false;
+    }
+    
+    float display_weight = raw_to_weight(raw_filter.apply_display_filter(raw.windows[WINDOW_DISPLAY].smoothed_raw));
+    if (display_weight > -0.05f && display_weight < 0.05f) {
+        display_weight = 0.0f;
+    }
+    float settle_threshold = (float)raw_thresholds.settling_raw;
+    const float grams_per_raw = raw_thresholds.grams_per_raw;
+    
+    snapshot_out->low_latency_weight = raw_to_weight(raw.windows[WINDOW_LOW_LATENCY].smoothed_raw);
+    snapshot_out->display_weight = display_weight;
+#if GRIND_FLOW_ESTIMATOR == GRIND_FLOW_ESTIMATOR_REGRESSION
+    snapshot_out->flow_rate = raw.windows[WINDOW_FLOW].flow_fit_raw * grams_per_raw;
+    snapshot_out->flow_rate_detection = raw.windows[WINDOW_FLOW_DETECTION].flow_fit_raw * grams_per_raw;
+    snapshot_out->flow_rate_prediction = raw.windows[WINDOW_FLOW_PREDICTION].flow_fit_raw * grams_per_raw;
+#else
+    snapshot_out->flow_rate = raw.windows[WINDOW_FLOW].flow_rate_raw * grams_per_raw;
+    snapshot_out->flow_rate_detection = raw.windows[WINDOW_FLOW_DETECTION].flow_rate_raw * grams_per_raw;
+    snapshot_out->flow_rate_prediction = raw.windows[WINDOW_FLOW_PREDICTION].flow_rate_raw * grams_per_raw;
+#endif
+    snapshot_out->flow_fit_confidence = raw.windows[WINDOW_FLOW_PREDICTION].flow_fit_confidence;
+    snapshot_out->motor_settled = raw.windows[WINDOW_MOTOR_SETTLING].std_dev_raw <= settle_threshold;
+    snapshot_out->precision_settled = raw.windows[WINDOW_PRECISION_SETTLING].std_dev_raw <= settle_threshold;
+    snapshot_out->precision_settled_weight = raw_to_weight(raw.windows[WINDOW_PRECISION_SETTLING].smoothed_raw);
+    snapshot_out->precision_settle_window_ms = snapshot_out->precision_settled ? GRIND_SCALE_PRECISION_SETTLING_TIME_MS : 0;
+    if (!snapshot_out->precision_settled && raw.settle.settled) {
+        // The full window still holds the disturbance, but the newest samples already pin the mean down
+        snapshot_out->precision_settled = true;
+        snapshot_out->precision_settled_weight = raw_to_weight(raw.settle.mean_raw);
+        snapshot_out->precision_settle_window_ms = raw.settle.window_ms;
+    }
+    snapshot_out->sample_timestamp_us = raw.latest_timestamp_us;
+    snapshot_out->estimate_valid = get_estimated_weight(&snapshot_out->estimated_weight,
+                                                        &snapshot_out->estimated_flow_rate);
+    if (!snapshot_out->estimate_valid) {
+        snapshot_out->estimated_weight = snapshot_out->low_latency_weight;
+        snapshot_out->estimated_flow_rate = snapshot_out->flow_rate;
+    }
+    return true;
+}
+
 bool WeightSensor::get_weight_delta(uint32_t window_ms, float* delta_out,
                                     int* sample_count_out, uint32_t* span_ms_out) const {
     if (!delta_out) {
@@ -460,7 +983,7 @@ bool WeightSensor::get_weight_delta(uint32_t window_ms, float* delta_out,
         return false;
     }
 
-    *delta_out = raw_delta / cal_factor;
+    *delta_out = raw_delta * raw_thresholds.grams_per_raw;
     return true;
 }
 
@@ -492,12 +1015,51 @@ bool WeightSensor::weight_range_exceeds(uint32_t window_ms, float threshold_g) c
 // Flow rate analysis using CircularBufferMath - convert raw flow to weight flow
 float WeightSensor::get_flow_rate(uint32_t window_ms) const {
     float raw_flow = raw_filter.get_raw_flow_rate(window_ms);
-    return raw_flow / cal_factor;  // Convert raw units per second to grams per second
+    return raw_flow * raw_thresholds.grams_per_raw;  // Convert raw units per second to grams per second
+}
+
+float WeightSensor::get_flow_rate_regression(uint32_t window_ms, float* confidence_out) const {
+    float raw_flow = 0.0f;
+    raw_filter.get_raw_flow_regression(window_ms, &raw_flow, confidence_out);
+    return raw_flow * raw_thresholds.grams_per_raw;  // Convert raw units per second to grams per second
+}
+
+WeightStateEstimator::Tuning WeightSensor::estimator_tuning() const {
+    float raw_per_g = fabsf(cal_factor) > 1e-6f ? fabsf(cal_factor) : 1.0f;
+    // The idle noise floor once measured, else the tare's, else assume it sits at the settling tolerance
+    float base_sigma = noise_floor.is_valid() ? noise_floor.get_floor_raw()
+                     : noise_sigma_raw_base > 0.0f ? noise_sigma_raw_base : GRIND_SCALE_SETTLING_TOLERANCE_G * raw_per_g;
+    
+    WeightStateEstimator::Tuning tuning;
+    tuning.measurement_sigma_raw = std::max(1.0f, base_sigma * sample_rate_noise_scale());
+    tuning.accel_sigma_raw_per_s2 = GRIND_STATE_ESTIMATOR_FLOW_ACCEL_GPS2 * raw_per_g;
+    tuning.step_reset_raw = GRIND_STATE_ESTIMATOR_STEP_RESET_G * raw_per_g;
+    tuning.gap_reset_us = GRIND_STATE_ESTIMATOR_GAP_RESET_MS * 1000UL;
+    return tuning;
+}
+
+bool WeightSensor::get_estimated_weight(float* weight_out, float* flow_out) const {
+    if (!weight_out || fabsf(cal_factor) < 1e-6f) {
+        return false;
+    }
+    // A sample describes the load about half a conversion before it is read out
+    uint32_t sps = raw_filter.get_sample_rate();
+    uint32_t lead_us = sps > 0 ? 500000UL / sps : 0;
+    float offset_raw = 0.0f;
+    float rate_raw = 0.0f;
+    if (!state_estimator.predict_raw((uint32_t)esp_timer_get_time(), lead_us, tare_offset, &offset_raw, &rate_raw)) {
+        return false;
+    }
+    *weight_out = offset_raw * raw_thresholds.grams_per_raw;
+    if (flow_out) {
+        *flow_out = rate_raw * raw_thresholds.grams_per_raw;
+    }
+    return true;
 }
 
 float WeightSensor::get_flow_rate_95th_percentile(uint32_t window_ms) const {
     float raw_flow = raw_filter.get_raw_flow_rate_95th_percentile(window_ms);
-    return raw_flow / cal_factor;  // Convert raw units per second to grams per second
+    return raw_flow * raw_thresholds.grams_per_raw;  // Convert raw units per second to grams per second
 }
 
 bool WeightSensor::is_flow_rate_stable(uint32_t window_ms) const {
@@ -531,8 +1093,10 @@ void WeightSensor::save_calibration() {
     LOG_BLE("Mock load cell: calibration save skipped (fixed factor).\n");
     return;
 #endif
+    config->set_float(ConfigFloat::CALIBRATION_FACTOR, cal_factor);
+    config->flush();
     if (prefs) {
-        prefs->putFloat("hx_cal", cal_factor);
+        prefs->putBytes("hx_cal_pts", &calibration_points, sizeof(calibration_points));
     }
 }
 
@@ -541,46 +1105,66 @@ void WeightSensor::save_calibration_weight(float weight) {
     LOG_BLE("Mock load cell: calibration weight save skipped.\n");
     return;
 #endif
-    if (prefs) {
-        prefs->putFloat("hx_wt", weight);
-    }
+    config->set_float(ConfigFloat::CALIBRATION_WEIGHT, weight);
 }
 
 float WeightSensor::get_saved_calibration_weight() {
 #if DEBUG_ENABLE_LOADCELL_MOCK
     return USER_CALIBRATION_REFERENCE_WEIGHT_G;
 #endif
-    if (prefs) {
-        return prefs->getFloat("hx_wt", USER_CALIBRATION_REFERENCE_WEIGHT_G);
-    }
-    return USER_CALIBRATION_REFERENCE_WEIGHT_G;
+    return config->get_float(ConfigFloat::CALIBRATION_WEIGHT);
 }
 
 void WeightSensor::load_calibration() {
 #if DEBUG_ENABLE_LOADCELL_MOCK
-    cal_factor = DEBUG_MOCK_CAL_FACTOR;
+    set_calibration_factor(DEBUG_MOCK_CAL_FACTOR);
     LOG_BLE("Mock load cell: using fixed calibration factor: %.2f\n", cal_factor);
-    return;
+#else
+    float saved_factor = config->get_float(ConfigFloat::CALIBRATION_FACTOR);
+
+    // Check for corrupted/invalid calibration data
+    if (isnan(saved_factor) || !isfinite(saved_factor) || saved_factor == 0.0) {
+        LOG_BLE("WARNING: Invalid calibration factor detected, using default\n");
+        saved_factor = USER_DEFAULT_CALIBRATION_FACTOR;
+        config->set_float(ConfigFloat::CALIBRATION_FACTOR, saved_factor);
+    }
+
+    set_calibration_factor(saved_factor);
+    LOG_BLE("Loaded calibration factor: %.2f\n", saved_factor);
+    load_calibration_points();
 #endif
-    if (prefs) {
-        float saved_factor = prefs->getFloat("hx_cal", USER_DEFAULT_CALIBRATION_FACTOR);
-        
-        // Check for corrupted/invalid calibration data
-        if (isnan(saved_factor) || !isfinite(saved_factor) || saved_factor == 0.0) {
-            LOG_BLE("WARNING: Invalid calibration factor detected, using default\n");
-            saved_factor = USER_DEFAULT_CALIBRATION_FACTOR;
-            // Clear corrupted data and save default
-            prefs->putFloat("hx_cal", saved_factor);
+
+    // Written by a motor noise spectrum (NoiseSpectrum), as the alias at the rate it was measured at
+    float tone_hz = config->get_float(ConfigFloat::VIBRATION_NOTCH_HZ);
+    if (isfinite(tone_hz) && tone_hz >= 0.0f) {
+        set_vibration_tone_hz(tone_hz);
+    }
+
+    if (adc_driver && adc_driver->get_channel_count() > 1) {
+        float channel2_gain = config->get_float(ConfigFloat::CHANNEL2_GAIN);
+        if (!adc_driver->set_channel_gain(1, channel2_gain)) {
+            LOG_BLE("WARNING: Invalid load cell channel 2 gain %.4f, keeping %.4f\n", channel2_gain,
+                    adc_driver->get_channel_gain(1));
         }
-        
-        cal_factor = saved_factor;
-        LOG_BLE("Loaded calibration factor: %.2f\n", saved_factor);
-    } else {
-        cal_factor = USER_DEFAULT_CALIBRATION_FACTOR;
-        LOG_BLE("Using default calibration factor: %.2f\n", USER_DEFAULT_CALIBRATION_FACTOR);
     }
 }
 
+bool WeightSensor::load_calibration_points() {
+#if DEBUG_ENABLE_LOADCELL_MOCK
+    return false;
+#endif
+    CalibrationPointsState stored;
+    CalibrationCurve curve;
+    if (!prefs || prefs->getBytesLength("hx_cal_pts") != sizeof(stored) ||
+        prefs->getBytes("hx_cal_pts", &stored, sizeof(stored)) != sizeof(stored) || !curve.set_points(stored)) {
+        return false;   // Single stored factor (calibrated before points were stored)
+    }
+    calibration_points = stored;
+    apply_calibration_curve(curve);
+    LOG_BLE("Loaded %u-point calibration curve (nominal factor %.2f)\n", (unsigned)stored.count, cal_factor);
+    return true;
+}
+
 void WeightSensor::clear_calibration_data() {
 #if DEBUG_ENABLE_LOADCELL_MOCK
     cal_factor = DEBUG_MOCK_CAL_FACTOR;
@@ -589,55 +1173,25 @@ void WeightSensor::clear_calibration_data() {
 #endif
     if (prefs) {
         LOG_BLE("Clearing corrupted calibration data...\n");
-        prefs->remove("hx_cal");
-        prefs->remove("hx_wt");
-        cal_factor = USER_DEFAULT_CALIBRATION_FACTOR;
+        config->set_float(ConfigFloat::CALIBRATION_FACTOR, USER_DEFAULT_CALIBRATION_FACTOR);
+        config->set_float(ConfigFloat::CALIBRATION_WEIGHT, USER_CALIBRATION_REFERENCE_WEIGHT_G);
+        prefs->remove("hx_cal_pts");
+        CalibrationCurve::initial_state(&calibration_points);
+        CalibrationCurve::initial_state(&capture_points);
+        set_calibration_factor(USER_DEFAULT_CALIBRATION_FACTOR);
         LOG_BLE("Calibration data cleared, using defaults\n");
     }
 }
 
 bool WeightSensor::is_calibrated() const {
-    if (!calibration_flag_cached_) {
-        Preferences load_cell_prefs;
-        bool prefs_opened = false;
-
-        if (calibration_namespace_initialized_) {
-            prefs_opened = load_cell_prefs.begin("load_cell", true);
-        } else {
-            prefs_opened = load_cell_prefs.begin("load_cell", false);
-            if (prefs_opened) {
-                calibration_namespace_initialized_ = true;
-            }
-        }
-
-        if (prefs_opened) {
-            calibration_flag_value_ = load_cell_prefs.getBool("calibrated", false);
-            load_cell_prefs.end();
-        } else {
-            calibration_flag_value_ = false;
-        }
-
-        calibration_flag_cached_ = true;
-    }
-
-    return calibration_flag_value_;
+    return config->get_flag(ConfigFlag::CALIBRATED);
 }
 
 void WeightSensor::set_calibrated(bool calibrated) {
-    Preferences load_cell_prefs;
-    if (load_cell_prefs.begin("load_cell", false)) {
-        load_cell_prefs.putBool("calibrated", calibrated);
-        load_cell_prefs.end();
-
-        calibration_namespace_initialized_ = true;
-        calibration_flag_value_ = calibrated;
-        calibration_flag_cached_ = true;
-
-        LOG_BLE("Load cell calibration flag set to: %s\n", calibrated ? "true" : "false");
-    } else {
-        calibration_flag_cached_ = false; // retry next time if write failed
-        LOG_BLE("ERROR: Failed to open load_cell preferences for calibration flag update\n");
-    }
+    config->set_flag(ConfigFlag::CALIBRATED, calibrated);
+    config->flush();
+    status_generation_.fetch_add(1);
+    LOG_BLE("Load cell calibration flag set to: %s\n", calibrated ? "true" : "false");
 }
 
 // Non-blocking settling check with window_ms parameter
@@ -653,6 +1207,21 @@ bool WeightSensor::check_settling_complete(uint32_t window_ms, float* settled_we
         return true;
     }
     
+    // Sequential test: the newest samples may already pin the mean down
+    CircularBufferMath::RawSnapshot raw = {};
+    raw.window_count = 1;
+    raw.windows[0].window_ms = window_ms;
+    set_sequential_settle_request(&raw.settle, window_ms);
+    if (raw.settle.max_window_ms > 0 && raw_filter.fill_snapshot(&raw) && raw.settle.settled) {
+        if (settled_weight_out) {
+            *settled_weight_out = raw_to_weight(raw.settle.mean_raw);
+        }
+        LOG_SETTLING_DEBUG("[DEBUG %lums] SETTLING_COMPLETE: Sequential settle (%.3fg +/- %.4fg, %u samples over %lums)\n",
+                      millis(), raw_to_weight(raw.settle.mean_raw), raw.settle.half_width_raw / fabsf(cal_factor),
+                      (unsigned)raw.settle.sample_count, (unsigned long)raw.settle.window_ms);
+        return true;
+    }
+    
     return false; // Still settling
 }
 
@@ -666,36 +1235,48 @@ void WeightSensor::cancel_settling() {
 //==============================================================================
 
 bool WeightSensor::noise_level_diagnostic() const {
-    // Check noise level using same threshold and window as grind control settling
-    float std_dev_g = get_standard_deviation_g(GRIND_SCALE_PRECISION_SETTLING_TIME_MS);
-    bool currently_settled = std_dev_g < GRIND_SCALE_SETTLING_TOLERANCE_G;
-    
-    unsigned long now = millis();
-    
-    if (!currently_settled) {
-        // Reading is not settled
-        if (!currently_not_settled) {
-            // Just started being not settled - begin timing
-            not_settled_start_time = now;
-            currently_not_settled = true;
-        }
-        
-        // Show "Noisy" only after 2000ms of sustained instability
-        if (now - not_settled_start_time >= 2000) {
-            display_noisy_state = true;  // Show "Noisy"
-        }
-        // else: keep showing previous state during 3s grace period
-        
-    } else {
-        // Reading is settled - immediate recovery
-        currently_not_settled = false;
-        display_noisy_state = false;  // Show "Yes"
+    uint32_t now = millis();
+    // No window closed lately (sampling powered down): nothing says it is noisy
+    if (now - settling_window_closed_ms_.load() > 2 * GRIND_SCALE_PRECISION_SETTLING_TIME_MS) {
+        return true;
     }
-    
-    // Return noise level assessment (true = "OK", false = "Too High")
-    return !display_noisy_state;
+    uint32_t unsettled_since = unsettled_since_ms_.load();
+    return unsettled_since == 0 || now - unsettled_since < 2000;
 }
 
+void WeightSensor::track_settling_noise(int32_t raw_adc, uint32_t timestamp_us) {
+    SettlingNoiseWindow& window = settling_noise_window;
+    if (window.count == 0) {
+        window.start_us = timestamp_us;
+        window.pivot = raw_adc;
+        window.sum = 0;
+        window.sum_squares = 0;
+    }
+    int64_t offset = (int64_t)raw_adc - window.pivot;
+    window.sum += offset;
+    window.sum_squares += offset * offset;
+    window.count++;
+    if (timestamp_us - window.start_us < GRIND_SCALE_PRECISION_SETTLING_TIME_MS * 1000UL) {
+        return;
+    }
+
+    // Sample standard deviation, as CircularBufferMath computes it over the same window
+    bool settled = true;
+    if (window.count > 1) {
+        double n = window.count;
+        double variance = ((double)window.sum_squares - (double)window.sum * (double)window.sum / n) / (n - 1);
+        settled = variance <= 0.0 || sqrt(variance) < raw_thresholds.settling_raw;
+    }
+    window.count = 0;
+
+    uint32_t now = millis();
+    settling_window_closed_ms_.store(now);
+    if (settled) {
+        unsettled_since_ms_.store(0);
+    } else if (unsettled_since_ms_.load() == 0) {
+        unsettled_since_ms_.store(now ? now : 1);
+    }
+}
 //==============================================================================
 // WEIGHT SAMPLING TASK INTEGRATION
 //==============================================================================
@@ -710,14 +1291,34 @@ bool WeightSensor::sample_and_feed_filter() {
     
     // Non-blocking check for available ADC data
     if (data_waiting_async()) {
-        update_async();
+        if (!update_async()) {
+            return false; // Conversion read but discarded (e.g. settling after a rate switch)
+        }
         int32_t raw_adc = get_raw_adc_data();  // Get raw ADC data from driver
-        uint32_t timestamp = millis();
         
-        // Raw ADC validation (24-bit range - valid for all supported ADCs)
-        if (raw_adc >= 0 && raw_adc <= 0xFFFFFF) {  // Valid 24-bit range
+        // Prefer the driver's capture time (DOUT edge in interrupt mode) over the
+        // time we got around to reading it; the filter keeps esp_timer µs
+        int64_t sample_time_us = adc_driver->get_last_sample_time_us();
+        uint32_t timestamp_us = (uint32_t)(sample_time_us > 0 ? sample_time_us : esp_timer_get_time());
+        
+        // Raw ADC validation (24-bit offset binary, widened by summed channels)
+        if (raw_adc >= 0 && raw_adc <= adc_driver->get_raw_max()) {
+#if HW_LOADCELL_VIBRATION_NOTCH_ENABLED
+            raw_adc = filter_motor_vibration(raw_adc, timestamp_us);
+#endif
+#if HW_LOADCELL_DECIMATION_ENABLED
+#if HW_LOADCELL_DECIMATION_RAW_RETENTION
+            raw_stream.add_sample(raw_adc, timestamp_us);
+#endif
+            // Only block outputs reach the ring, estimator and tare; the rest is not a new sample
+            if (!decimator.add_sample(raw_adc, timestamp_us, &raw_adc, &timestamp_us)) {
+                return false;
+            }
+#endif
+            
             // Thread-safe sample feeding (CircularBufferMath is single-producer safe)
-            raw_filter.add_sample(raw_adc, timestamp);
+            raw_filter.add_sample(raw_adc, timestamp_us);
+            state_estimator.update(raw_adc, timestamp_us, estimator_tuning());
             
             // Tare logic (hardware-independent)
             if (doTare) {
@@ -725,13 +1326,19 @@ bool WeightSensor::sample_and_feed_filter() {
                     tareTimes++;
                 } else {
                     // Use CircularBufferMath smoothed data instead of original smoothedData()
-                    int32_t smoothed_raw = raw_filter.get_smoothed_raw(250); // 250ms window for stability
-                    tare_offset = smoothed_raw;  // Set tare offset to smoothed raw ADC value
+                    complete_tare(raw_filter.get_smoothed_raw(250), // 250ms window for stability
+                                  (float)get_standard_deviation_adc(GRIND_SCALE_PRECISION_SETTLING_TIME_MS));
                     tareTimes = 0;
                     doTare = 0;
-                    tareStatus = 1;
                 }
+            } else {
+                track_zero(timestamp_us);
             }
+#if GRIND_NOISE_FLOOR_ENABLED
+            track_noise_floor(raw_adc, timestamp_us);
+#endif
+            track_settling_noise(raw_adc, timestamp_us);
+            track_cup(raw_adc, timestamp_us);
             
             // Update instance variables atomically (ESP32 guarantees atomic 32-bit writes)
             current_raw_adc = raw_adc;
@@ -746,10 +1353,11 @@ bool WeightSensor::sample_and_feed_filter() {
         } else {
             // Debug invalid readings
             static uint32_t last_invalid_debug = 0;
-            if (timestamp - last_invalid_debug > 5000) {
-                LOG_BLE("WeightSensor: Invalid raw ADC reading detected - raw=%ld (expected range: 0x000000 to 0xFFFFFF)\n", 
-                       (long)raw_adc);
-                last_invalid_debug = timestamp;
+            uint32_t now_ms = millis();
+            if (now_ms - last_invalid_debug > 5000) {
+                LOG_BLE("WeightSensor: Invalid raw ADC reading detected - raw=%ld (expected range: 0x000000 to 0x%lX)\n",
+                       (long)raw_adc, (unsigned long)adc_driver->get_raw_max());
+                last_invalid_debug = now_ms;
             }
         }
     }
@@ -757,52 +1365,52 @@ bool WeightSensor::sample_and_feed_filter() {
     return false; // No new data available
 }
 
+bool WeightSensor::enable_data_ready_interrupt(TaskHandle_t task) {
+    return adc_driver ? adc_driver->enable_data_ready_interrupt(task) : false;
+}
+
+void WeightSensor::disable_data_ready_interrupt() {
+    if (adc_driver) {
+        adc_driver->disable_data_ready_interrupt();
+    }
+}
+
+bool WeightSensor::is_data_ready_interrupt_enabled() const {
+    return adc_driver ? adc_driver->is_data_ready_interrupt_enabled() : false;
+}
+
 float WeightSensor::get_saved_calibration_factor() {
-    // Return saved calibration factor from preferences, or default if none
-    if (prefs && prefs->isKey("hx_cal")) {
-        float saved_factor = prefs->getFloat("hx_cal", USER_DEFAULT_CALIBRATION_FACTOR);
-        
-        // Validate saved factor
-        if (isnan(saved_factor) || !isfinite(saved_factor) || saved_factor == 0.0) {
-            return USER_DEFAULT_CALIBRATION_FACTOR;
-        }
-        return saved_factor;
+    // Saved calibration factor (the default until one is saved)
+    float saved_factor = config->get_float(ConfigFloat::CALIBRATION_FACTOR);
+    if (isnan(saved_factor) || !isfinite(saved_factor) || saved_factor == 0.0) {
+        return USER_DEFAULT_CALIBRATION_FACTOR;
     }
-    return USER_DEFAULT_CALIBRATION_FACTOR;
+    return saved_factor;
 }
 
 #if SYS_ENABLE_REALTIME_HEARTBEAT
 void WeightSensor::record_sample_timestamp() {
-    uint32_t now = millis();
-    
-    // Store timestamp in circular buffer
-    sps_timestamps[sps_buffer_index] = now;
-    sps_buffer_index = (sps_buffer_index + 1) % SPS_TRACKING_BUFFER_SIZE;
-    
-    // Track how many samples we have (up to buffer size)
-    if (sps_sample_count < SPS_TRACKING_BUFFER_SIZE) {
-        sps_sample_count++;
-    }
+    sps_timestamps.push(millis());
 }
 
 float WeightSensor::get_current_sps() const {
-    if (sps_sample_count < 2) {
+    if (sps_timestamps.size() < 2) {
         return 0.0f; // Need at least 2 samples to calculate rate
     }
     
     uint32_t now = millis();
-    int samples_in_window = 0;
-    uint32_t window_start = now - 2000; // 2 second window
+    const uint32_t window_ms = 2000;
+    uint32_t samples_in_window = sps_timestamps.count_newest_while(
+        [&](uint32_t timestamp) { return now - timestamp <= window_ms; });
     
-    // Count samples in the last 2 seconds
-    for (int i = 0; i < sps_sample_count; i++) {
-        if (sps_timestamps[i] >= window_start) {
-            samples_in_window++;
-        }
+    // Above ~128 SPS the ring holds less than the window: rate over the span it does cover
+    if (samples_in_window == sps_timestamps.CAPACITY) {
+        uint32_t span_ms = sps_timestamps.newest() - sps_timestamps.newest(samples_in_window - 1);
+        return span_ms > 0 ? (samples_in_window - 1) * 1000.0f / span_ms : 0.0f;
     }
     
     // Convert to samples per second
-    return samples_in_window / 2.0f;
+    return samples_in_window / (window_ms / 1000.0f);
 }
 #endif
 
@@ -817,7 +1425,7 @@ float WeightSensor::get_current_sps() const {
 float WeightSensor::get_standard_deviation_g(uint32_t window_ms) const {
     // Get raw standard deviation and convert to grams
     float raw_std_dev = raw_filter.get_standard_deviation_raw(window_ms);
-    return raw_std_dev / abs(cal_factor);  // Convert from raw ADC units to grams (use abs since noise magnitude is always positive)
+    return raw_std_dev * fabsf(raw_thresholds.grams_per_raw);  // Raw ADC units to grams (abs: noise magnitude is always positive)
 }
 
 int32_t WeightSensor::get_standard_deviation_adc(uint32_t window_ms) const {
@@ -828,9 +1436,74 @@ int32_t WeightSensor::get_standard_deviation_adc(uint32_t window_ms) const {
 
 // HX711_ADC exact tare methods
 void WeightSensor::tareNoDelay() {
-    doTare = 1;
     tareTimes = 0;
     tareStatus = 0;
+    if (try_tare_from_cup() || try_tare_from_history()) {
+        return;     // Done without arming the sampling path
+    }
+    doTare = 1;
+}
+
+void WeightSensor::complete_tare(int32_t offset_raw, float std_dev_raw) {
+    tare_offset = offset_raw;  // Set tare offset to smoothed raw ADC value
+    zero_tracker.reset(offset_raw, current_temperature);
+    
+    // The scale is quiet while taring: that std dev is the estimator's noise floor
+    noise_sigma_raw_base = std::max(1.0f, std_dev_raw / sample_rate_noise_scale());
+    tareStatus = 1;
+}
+
+bool WeightSensor::try_tare_from_history() {
+#if GRIND_FAST_TARE_ENABLED
+    // The ring already holds the last seconds; if they are quiet, DATA_SET fresh
+    // samples would only measure the same offset again
+    CircularBufferMath::RawSnapshot raw = {};
+    raw.window_count = 1;
+    raw.windows[0].window_ms = GRIND_FAST_TARE_WINDOW_MS;
+    if (!raw_filter.fill_snapshot(&raw)) {
+        return false;
+    }
+    const CircularBufferMath::WindowMetrics& window = raw.windows[0];
+    int32_t age_us = (int32_t)((uint32_t)esp_timer_get_time() - raw.latest_timestamp_us);
+    int32_t raw_threshold = raw_thresholds.settling_raw;
+    if (window.sample_count < GRIND_FAST_TARE_MIN_SAMPLES || age_us > GRIND_FAST_TARE_MAX_SAMPLE_AGE_MS * 1000 ||
+        window.std_dev_raw > raw_threshold) {
+        return false;
+    }
+    
+    complete_tare(window.smoothed_raw, (float)get_standard_deviation_adc(GRIND_SCALE_PRECISION_SETTLING_TIME_MS));
+    LOG_LOADCELL_DEBUG("[DEBUG %lums] FAST_TARE: offset %ld from %u buffered samples (std dev %.1f raw)\n",
+                       millis(), (long)window.smoothed_raw, (unsigned)window.sample_count, window.std_dev_raw);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool WeightSensor::try_tare_from_cup() {
+    // Once per placement: the window that confirmed the cup is the tare, the history behind it holds the step
+    CupDetector::Placement placement;
+    if (!cup_tare_pending_.exchange(false) || !get_cup_placement(&placement)) {
+        return false;
+    }
+    int32_t age_us = (int32_t)((uint32_t)esp_timer_get_time() - placement.settled_us);
+    if (age_us > (int32_t)(USER_AUTO_GRIND_CUP_TARE_MAX_AGE_MS * 1000UL)) {
+        return false;
+    }
+    // Cup moved, lifted or filled since: measure again
+    int32_t drift_raw = raw_filter.get_instant_raw() - placement.settled_raw;
+    if (abs(drift_raw) > 4 * raw_thresholds.settling_raw) {
+        return false;
+    }
+
+    // A few samples say little about the noise; the measured idle floor says more
+    float std_dev_raw = noise_floor.is_valid() ? noise_floor.get_floor_raw() * sample_rate_noise_scale()
+                                               : placement.std_dev_raw;
+    complete_tare(placement.settled_raw, std_dev_raw);
+    LOG_LOADCELL_DEBUG("[DEBUG %lums] CUP_TARE: offset %ld from the %.1fg step settled %lums after it\n",
+                       millis(), (long)placement.settled_raw, placement.step_g,
+                       (unsigned long)((placement.settled_us - placement.step_us) / 1000));
+    return true;
 }
 
 bool WeightSensor::getTareStatus() {
@@ -1,16 +1,52 @@
 #pragma once
 
 #include "circular_buffer_math/circular_buffer_math.h"
+#include "weight_state_estimator.h"
+#include "zero_tracker.h"
+#include "noise_floor_estimator.h"
+#include "cup_detector.h"
+#include "vibration_notch.h"
+#include "sample_decimator.h"
+#include "raw_sample_stream.h"
+#include "calibration_curve.h"
+#include "ring.h"
 #include "load_cell_driver.h"
 #include "hx711_driver.h"
 #include "../config/constants.h"
 #include <Preferences.h>
 #include <freertos/FreeRTOS.h>
+
+class MotorEdgeTimeline;
+class ConfigStore;
 #include <freertos/task.h>
 #include <Arduino.h>
 #include <memory>
 #include <atomic>
 
+// Flow estimator windows; fixed GRIND_FLOW_*_WINDOW_MS, or sized from the noise floor (GRIND_ADAPTIVE_*)
+struct FlowWindows {
+    uint32_t detection_ms;           // First grounds (latency measurement), WeightSnapshot::flow_rate_detection
+    uint32_t prediction_ms;          // Predictive coast estimate, WeightSnapshot::flow_rate_prediction
+    uint32_t pulse_flow_ms;          // History the pulse sizing's 95th percentile flow reaches over
+};
+
+// Per-tick grind loop measurements, filled from one read of the sample ring
+struct WeightSnapshot {
+    float low_latency_weight;        // get_weight_low_latency()
+    float display_weight;            // get_display_weight() (advances the display filter)
+    float flow_rate;                 // 200ms window (estimator per GRIND_FLOW_ESTIMATOR)
+    float flow_rate_detection;       // FlowWindows::detection_ms
+    float flow_rate_prediction;      // FlowWindows::prediction_ms
+    float flow_fit_confidence;       // R^2 of the least-squares fit over the prediction window
+    bool estimate_valid;             // State estimator has been seeded
+    float estimated_weight;          // Latency-compensated estimator weight at snapshot time
+    float estimated_flow_rate;       // Estimator flow (g/s)
+    bool motor_settled;              // is_settled(GRIND_MOTOR_SETTLING_TIME_MS)
+    bool precision_settled;          // is_settled(GRIND_SCALE_PRECISION_SETTLING_TIME_MS)
+    float precision_settled_weight;  // Smoothed weight over the precision settling window
+    uint32_t precision_settle_window_ms; // Window that decided precision_settled (shorter when settled sequentially)
+    uint32_t sample_timestamp_us;    // Newest sample, esp_timer µs (32-bit)
+};
 
 /*
  * WeightSensor - Hardware-Abstracted Weight Processing System
@@ -45,16 +81,86 @@ private:
     // CircularBufferMath for advanced filtering and analysis
     CircularBufferMath raw_filter;
     
-    // Calibration parameters
+    // Per-sample weight/flow state estimator (fed alongside raw_filter)
+    WeightStateEstimator state_estimator;
+    float noise_sigma_raw_base;     // Quiet-scale noise at HW_LOADCELL_SAMPLE_RATE_SPS (0 = not measured yet)
+    WeightStateEstimator::Tuning estimator_tuning() const;
+    
+    // Calibration parameters: cal_factor is the curve's nominal raw per gram
     float cal_factor;
     int32_t tare_offset;
     
+    // Piecewise-linear curve, double buffered so Core 0 conversions never see a half-built one
+    CalibrationCurve calibration_curves[2];
+    std::atomic<uint8_t> active_curve_;
+    CalibrationPointsState calibration_points;    // Points behind the active curve (persisted)
+    CalibrationPointsState capture_points;        // Points captured since begin_calibration()
+    float span_scale;                             // Span temperature compensation (HW_LOADCELL_SPAN_TEMPCO_PPM_PER_C)
+    float span_temperature_c;                     // Temperature span_scale was computed for
+    void apply_calibration_curve(const CalibrationCurve& curve);
+    void update_span_compensation();
+    
+    // Gram thresholds and scale factors in raw counts, derived once per calibration or sample
+    // rate change so per-tick queries compare raw values and multiply instead of dividing
+    struct RawThresholds {
+        float grams_per_raw;            // 1 / cal_factor (signed)
+        float noise_scale;              // sample_rate_noise_scale()
+        int32_t settling_raw;           // Noise floor (GRIND_NOISE_FLOOR_SETTLING_*) or GRIND_SCALE_SETTLING_TOLERANCE_G, at the live rate
+        float flow_detection_gps;       // Noise floor (GRIND_NOISE_FLOOR_FLOW_*) or GRIND_FLOW_DETECTION_THRESHOLD_GPS, at the live rate
+        FlowWindows flow_windows;       // Noise floor and flow stability (GRIND_ADAPTIVE_*) or the fixed windows
+        float sequential_mean_raw;      // GRIND_SCALE_SEQUENTIAL_SETTLING_TOLERANCE_G
+        float auto_zero_band_raw;       // GRIND_AUTO_ZERO_BAND_G
+        float auto_zero_max_total_raw;  // GRIND_AUTO_ZERO_MAX_TOTAL_G
+    };
+    RawThresholds raw_thresholds;
+    void refresh_raw_thresholds();
+    
+    // Idle auto-zero (GRIND_AUTO_ZERO_*), run from sample_and_feed_filter()
+    ZeroTracker zero_tracker;
+    std::atomic<bool> zero_tracking_allowed_;
+    uint32_t last_zero_track_us;
+    void track_zero(uint32_t timestamp_us);
+    
+    // Idle noise floor (GRIND_NOISE_FLOOR_*), run from sample_and_feed_filter(); refreshes raw_thresholds
+    NoiseFloorEstimator noise_floor;
+    void track_noise_floor(int32_t raw_adc, uint32_t timestamp_us);
+    std::atomic<float> flow_stability_;             // Running mean flow fit R^2 of recent grinds, 1 = none seen
+
+    // Start-on-Cup step detection (USER_AUTO_GRIND_CUP_*), run from sample_and_feed_filter() while armed;
+    // the latest placement is published under a sequence count (odd while it is being written)
+    CupDetector cup_detector;
+    std::atomic<bool> cup_detection_armed_;
+    bool cup_detector_running;
+    CupDetector::Placement cup_placement;
+    std::atomic<uint32_t> cup_placement_sequence_;
+    std::atomic<bool> cup_tare_pending_;            // The latest placement may still become the tare
+    void track_cup(int32_t raw_adc, uint32_t timestamp_us);
+    
+    // Motor vibration notch (HW_LOADCELL_VIBRATION_NOTCH_*), run from sample_and_feed_filter()
+    // on samples taken after the latest motor-on edge
+    const MotorEdgeTimeline* motor_edges;
+    VibrationNotch vibration_notch;
+    bool vibration_notch_running;
+    std::atomic<float> vibration_tone_hz_;          // Set by the UI task (NoiseSpectrum), read per sample
+    std::atomic<bool> vibration_notch_bypass_;
+    int32_t filter_motor_vibration(int32_t raw_adc, uint32_t timestamp_us);
+    
+#if HW_LOADCELL_DECIMATION_ENABLED
+    // Decimation (HW_LOADCELL_DECIMATION_*) between the notch and raw_filter; raw_filter runs at its output rate
+    SampleDecimator decimator;
+#if HW_LOADCELL_DECIMATION_RAW_RETENTION
+    RawSampleStream raw_stream;     // Every ADC sample, for the recorders
+#endif
+#endif
+    
     // Current readings (cached)
     float current_weight;
     float current_temperature;  // For ADCs with temperature sensors
     int32_t current_raw_adc;
     unsigned long last_update;
     Preferences* prefs;
+    uint8_t grinder_channel;        // GrindChannels index, selects the ADC pins
+    ConfigStore* config;            // Calibration values; the shared config_store on channel 0
     
     bool data_available;
     std::atomic<HardwareFault> hardware_fault_;
@@ -68,28 +174,53 @@ private:
     bool tareTimeoutFlag;
     unsigned long tareTimeOut;
     
-    // Stable reading diagnostic tracking (sustained settling check for UI)
-    mutable unsigned long not_settled_start_time;
-    mutable bool currently_not_settled;
-    mutable bool display_noisy_state;  // True = show "Noisy", False = show "Yes"
+    // Settling noise for noise_level_diagnostic(), run from sample_and_feed_filter(): the standard
+    // deviation of back-to-back GRIND_SCALE_PRECISION_SETTLING_TIME_MS windows against the settling
+    // tolerance, published so readers on any task never scan the ring
+    struct SettlingNoiseWindow {
+        uint32_t start_us;
+        uint16_t count;
+        int32_t pivot;              // First sample; sums are of the offsets from it
+        int64_t sum;
+        int64_t sum_squares;
+    };
+    SettlingNoiseWindow settling_noise_window;
+    std::atomic<uint32_t> unsettled_since_ms_;      // First window of the current unsettled run (millis), 0 = settled
+    std::atomic<uint32_t> settling_window_closed_ms_;
+    void track_settling_noise(int32_t raw_adc, uint32_t timestamp_us);
     
-    // WeightSamplingTask integration (RealtimeController removed)
+    // Bumped when the calibration flag or the hardware fault changes (DiagnosticsController)
+    std::atomic<uint32_t> status_generation_;
     
-    // Cached calibration flag state to avoid repeated NVS lookups
-    mutable bool calibration_flag_cached_;
-   mutable bool calibration_flag_value_;
-   mutable bool calibration_namespace_initialized_;
+    // WeightSamplingTask integration (RealtimeController removed)
 
     // Single calibration conversion point
+    friend class HotPathBenchmark;
     float raw_to_weight(int32_t raw_adc_value) const {
-        return (float)(raw_adc_value - tare_offset) / cal_factor;
+        return calibration_curves[active_curve_.load(std::memory_order_acquire)].to_grams(raw_adc_value - tare_offset) * span_scale;
     }
     
     // Raw settling threshold calculation - use absolute value since StdDev is always positive
+    // (configuration time only; per-tick paths read raw_thresholds)
     int32_t weight_to_raw_threshold(float weight_threshold) const {
         return (int32_t)(abs(weight_threshold * cal_factor));
     }
     
+    // Per-sample noise grows with ADC bandwidth (~sqrt of rate); settling thresholds are
+    // tuned at HW_LOADCELL_SAMPLE_RATE_SPS and scaled to the live rate
+    float sample_rate_noise_scale() const { return raw_thresholds.noise_scale; }
+    
+    // Sequential settling request up to max_window_ms (disabled by GRIND_SCALE_SEQUENTIAL_SETTLING_ENABLED 0)
+    void set_sequential_settle_request(CircularBufferMath::SequentialSettleMetrics* settle, uint32_t max_window_ms) const;
+    
+    // Tare bookkeeping shared by the fresh-acquisition, buffered and cup paths; std_dev_raw is the
+    // quiet-scale noise behind the offset
+    void complete_tare(int32_t offset_raw, float std_dev_raw);
+    // Fast tare: offset from the buffered window if it is recent and settled
+    bool try_tare_from_history();
+    // Cup tare: the settled level of a cup placed moments ago, if the scale still reads it
+    bool try_tare_from_cup();
+    
     
     // Hardware abstraction helpers
     bool initialize_adc_hardware();
@@ -97,10 +228,8 @@ private:
     
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // SPS tracking for performance monitoring
-    static const int SPS_TRACKING_BUFFER_SIZE = 160;  // ~2 seconds at 80 SPS (ample headroom at lower SPS)
-    uint32_t sps_timestamps[SPS_TRACKING_BUFFER_SIZE];
-    int sps_buffer_index;
-    int sps_sample_count;
+    static const uint32_t SPS_TRACKING_BUFFER_SIZE = 256;  // ~3 seconds at 80 SPS; faster rates use the span
+    Ring<uint32_t, SPS_TRACKING_BUFFER_SIZE> sps_timestamps;  // millis() per sample
 #endif
     
 public:
@@ -108,7 +237,7 @@ public:
     ~WeightSensor();
     
     // Initialization and configuration
-    void init(Preferences* preferences);
+    void init(Preferences* preferences, uint8_t channel = 0, ConfigStore* store = nullptr);   // nullptr = config_store
     bool begin();
     bool begin(uint8_t gain_value);
     void set_gain(uint8_t gain_value = 128);
@@ -118,8 +247,8 @@ public:
     void power_down();
     
     // Tare operations
-    void tare();                          // Blocking tare
-    void tareNoDelay();                   // Exact HX711_ADC method
+    void tare();                          // Blocking tare (Core 1 only; on Core 0 it starts a non-blocking tare)
+    void tareNoDelay();                   // HX711_ADC method; completes at once from a fresh cup placement or settled buffered history (GRIND_FAST_TARE_ENABLED)
     bool getTareStatus();                 // Exact HX711_ADC method
     
     // Legacy wrapper methods for compatibility
@@ -127,7 +256,10 @@ public:
     bool is_tare_in_progress() const { return doTare; }
     
     // Calibration
-    void calibrate(float known_weight);
+    void calibrate(float known_weight);                  // Single point: begin_calibration() + add_calibration_point()
+    void begin_calibration();                            // Forget captured points (call once tared empty)
+    bool add_calibration_point(float known_weight);      // Blocking; false if the point does not extend the curve
+    uint8_t get_calibration_point_count() const { return capture_points.count; }
     void set_calibration_factor(float factor);
     void set_zero_offset(int32_t offset);
     
@@ -145,8 +277,9 @@ public:
     
     // Load cell noise level diagnostic for UI display
     // Returns true if noise level is acceptable (shows "OK"), false if excessive (shows "Too High")
-    // Uses sustained 3-second check to filter out brief motor/electrical interference
-    // Same settling parameters as grind control (500ms window, 0.010g threshold)
+    // Noisy once the sampling task's settling windows stayed unsettled for 2 seconds (brief
+    // motor/electrical interference is ignored). Same window and tolerance as grind control
+    // settling; reads the published result, so it is cheap from any task
     bool noise_level_diagnostic() const;
     
     // Raw ADC data access (for advanced filtering and diagnostics)
@@ -157,8 +290,9 @@ public:
     // Primary weight readings using CircularBufferMath with single conversion point
     float get_instant_weight() const;                        // Latest single sample converted to weight
     float get_weight_low_latency() const;                    // 50ms window - for real-time control
-    float get_display_weight();                              // 250ms + asymmetric filter - for UI
+    float get_display_weight();                              // 300ms + asymmetric filter; advances it, so only GrindController calls this (UI reads ui_snapshot)
     float get_weight_high_latency() const;                   // 250ms window - for final measurements
+    bool get_snapshot(WeightSnapshot* snapshot_out);         // All per-tick grind values in one pass
     bool get_weight_delta(uint32_t window_ms, float* delta_out,
                           int* sample_count_out = nullptr,
                           uint32_t* span_ms_out = nullptr) const;
@@ -168,11 +302,13 @@ public:
     // Flow rate analysis using CircularBufferMath
     float get_flow_rate(uint32_t window_ms = 200) const;     // Flow rate calculation (default 200ms window)
     float get_flow_rate_95th_percentile(uint32_t window_ms = 200) const; // 95th percentile flow rate for dynamic pulse algorithm
+    float get_flow_rate_regression(uint32_t window_ms = 200, float* confidence_out = nullptr) const; // Least-squares flow, R^2 confidence
+    bool get_estimated_weight(float* weight_out, float* flow_out = nullptr) const; // Kalman weight projected to now (g, g/s)
     bool is_flow_rate_stable(uint32_t window_ms = 100) const; // Check if flow rate has stabilized
     
-    // Settling methods - WARNING: These methods block execution!
-    float get_motor_settled_weight(float* settle_time_out = nullptr);     // Motor settling (300ms window) - for after motor vibrations
-    float get_precision_settled_weight(float* settle_time_out = nullptr); // Precision settling (500ms window) - for tare/calibration/final measurements
+    // Settling methods - WARNING: These methods block execution! Core 1 only: on Core 0 they
+    // return the smoothed weight at once so the 20 ms grind control deadline holds
+    float get_precision_settled_weight(float* settle_time_out = nullptr); // Precision settling (500ms window) - for calibration
     
     // Legacy method for custom settling
     float get_settled_weight(uint32_t window_ms, float* settle_time_out = nullptr);
@@ -181,6 +317,31 @@ public:
     int get_sample_count() const;                            // Returns filter sample count
     float get_calibration_factor();                          
     int32_t get_zero_offset() const { return tare_offset; }
+    // Auto-zero runs only while allowed (GrindController: IDLE) and settled within GRIND_AUTO_ZERO_BAND_G
+    void set_zero_tracking_allowed(bool allowed) { zero_tracking_allowed_.store(allowed); }
+    // Motor edges on the sample clock for the vibration notch (Grinder's timeline); set before sampling starts
+    void set_motor_edge_timeline(const MotorEdgeTimeline* edges) { motor_edges = edges; }
+    // Notch tone (ConfigFloat::VIBRATION_NOTCH_HZ, default HW_LOADCELL_VIBRATION_NOTCH_HZ); 0 = off. Takes effect at the next sample
+    void set_vibration_tone_hz(float tone_hz) { vibration_tone_hz_.store(tone_hz); }
+    float get_vibration_tone_hz() const { return vibration_tone_hz_.load(); }
+    // Unfiltered motor-on samples while a motor noise spectrum is armed
+    void set_vibration_notch_bypass(bool bypass) { vibration_notch_bypass_.store(bypass); }
+    // Start-on-Cup: detection runs only while armed (UIManager, each tick); disarming forgets the baseline
+    void set_cup_detection_armed(bool armed) { cup_detection_armed_.store(armed); }
+    // Changes (by 2) with each placement; false until the first or while one is being published
+    uint32_t get_cup_placement_sequence() const { return cup_placement_sequence_.load(std::memory_order_acquire); }
+    bool get_cup_placement(CupDetector::Placement* placement_out) const;
+    float get_zero_drift_rate_gps() const { return zero_tracker.get_drift_rate_raw_per_s() * raw_thresholds.grams_per_raw; }
+    // Measured idle noise (sigma at HW_LOADCELL_SAMPLE_RATE_SPS), 0 until the first idle windows
+    float get_noise_floor_g() const { return noise_floor.get_floor_raw() * fabsf(raw_thresholds.grams_per_raw); }
+    // Flow rate that confirms the first grounds, from the noise floor at the live rate
+    float get_flow_detection_threshold_gps() const { return raw_thresholds.flow_detection_gps; }
+    // Flow windows for the next session (noise floors are measured idle, so they hold through a grind)
+    FlowWindows get_flow_windows() const { return raw_thresholds.flow_windows; }
+    // A finished grind's mean prediction-window fit R^2; uneven flow lengthens the prediction window
+    void observe_flow_stability(float mean_fit_r2);
+    // Settled std dev limit at the live rate
+    float get_settling_tolerance_g() const { return raw_thresholds.settling_raw * fabsf(raw_thresholds.grams_per_raw); }
     bool is_initialized();                                   
     bool data_ready();
     bool is_data_ready() const;
@@ -190,6 +351,7 @@ public:
     void save_calibration_weight(float weight);
     float get_saved_calibration_weight();
     void load_calibration();
+    bool load_calibration_points();                      // Multi-point curve from preferences over the loaded factor
     void clear_calibration_data();
 
     // Calibration flag (for diagnostics)
@@ -198,22 +360,46 @@ public:
     
     // Hardware fault reporting for diagnostics
     HardwareFault get_hardware_fault() const { return hardware_fault_.load(); }
-    void set_hardware_fault(HardwareFault fault) { hardware_fault_.store(fault); }
+    void set_hardware_fault(HardwareFault fault) {
+        if (hardware_fault_.exchange(fault) != fault) {
+            status_generation_.fetch_add(1);
+        }
+    }
+    // Changes whenever is_calibrated() or get_hardware_fault() may have
+    uint32_t get_status_generation() const { return status_generation_.load(); }
     bool has_hardware_fault() const { return get_hardware_fault() != HardwareFault::NONE; }
 
     // Hardware validation and information
     bool validate_hardware();
     const char* get_adc_driver_name() const;
+    // Summed load cell channels (HW_LOADCELL_CHANNELS); gains scale each to channel 0 counts
+    uint8_t get_adc_channel_count() const;
+    int32_t get_adc_channel_raw(uint8_t channel) const;
+    float get_adc_channel_gain(uint8_t channel) const;
+    // Persists channel 2 as ConfigFloat::CHANNEL2_GAIN; the calibration curve was taken at the old balance
+    bool set_adc_channel_gain(uint8_t channel, float gain);
     bool supports_temperature_sensor() const;
     float get_temperature() const;  // Returns NaN if not supported
     uint32_t get_max_sample_rate() const;
+    bool set_sample_rate(uint32_t sps);                              // Switch ADC output rate (false if unsupported)
+    uint32_t get_sample_rate_sps() const;                            // Sample ring rate (decimated)
+    uint32_t get_adc_sample_rate_sps() const;                        // ADC conversion rate
     float get_detected_sample_rate_sps() const { return detected_sample_rate_sps_; }
+    uint32_t get_latest_sample_time_us() const { return raw_filter.get_latest_sample_time_us(); } // esp_timer µs (32-bit) of newest sample
+    bool get_weight_at_time_us(uint32_t timestamp_us, float* weight_out, uint32_t* sample_time_us_out = nullptr) const; // First sample at/after an event
+    bool get_weight_before_time_us(uint32_t end_us, uint32_t window_ms, float* weight_out) const; // Smoothed weight just before an event
     
     // WeightSamplingTask integration interface
     bool sample_and_feed_filter();                                   // Core 0 sampling method for WeightSamplingTask
     
+    // Data-ready interrupt (DOUT falling edge notifies the sampling task)
+    bool enable_data_ready_interrupt(TaskHandle_t task);
+    void disable_data_ready_interrupt();
+    bool is_data_ready_interrupt_enabled() const;
+    
     // Hardware access for WeightSamplingTask Core 0
     CircularBufferMath* get_raw_filter() { return &raw_filter; }     // Direct access to raw data math helper
+    const SampleSequenceSource* get_recording_source() const;       // Full-rate samples when retained, else the ring
     float get_saved_calibration_factor();                            // Get calibration factor from preferences
     void set_hardware_initialized() { data_available = true; }       // Mark hardware as ready
     
@@ -0,0 +1,245 @@
+#include "adc_stream_load_cell_driver.h"
+#include "../logging/grind_logging.h"
+#include "../logging/measurement_codec.h"
+#include "../logging/session_reader.h"
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+AdcStreamLoadCellDriver* AdcStreamLoadCellDriver::instance = nullptr;
+
+namespace {
+bool is_session_file_name(const String& name) {
+    return (name.startsWith("session_") || name.indexOf("/session_") != -1) && name.endsWith(".bin");
+}
+}
+
+AdcStreamLoadCellDriver::AdcStreamLoadCellDriver()
+    : hold_value(static_cast<int32_t>(DEBUG_MOCK_BASELINE_RAW)), sample_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS),
+      sample_interval_us(1000000 / HW_LOADCELL_SAMPLE_RATE_SPS), last_raw_data(static_cast<int32_t>(DEBUG_MOCK_BASELINE_RAW)) {
+    instance = this;
+}
+
+AdcStreamLoadCellDriver::~AdcStreamLoadCellDriver() {
+    if (instance == this) {
+        instance = nullptr;
+    }
+    release_tracks();
+}
+
+bool AdcStreamLoadCellDriver::begin() {
+    return begin(128);
+}
+
+bool AdcStreamLoadCellDriver::begin(uint8_t gain_value) {
+    (void)gain_value;
+    next_hold_due_us = esp_timer_get_time() + sample_interval_us;
+    return true;
+}
+
+bool AdcStreamLoadCellDriver::set_sample_rate(uint32_t sps) {
+    if (sps != HW_LOADCELL_SAMPLE_RATE_SPS && sps != HW_LOADCELL_SAMPLE_RATE_HIGH_SPS) {
+        return false;
+    }
+    // Paces the hold between tracks; tracks play at their recorded rate
+    sample_rate_sps = sps;
+    sample_interval_us = 1000000 / sps;
+    next_hold_due_us = esp_timer_get_time() + sample_interval_us;
+    return true;
+}
+
+void AdcStreamLoadCellDriver::load_tracks(const GrindLogger& logger) {
+    if (instance && !instance->tracks_loaded.load(std::memory_order_acquire)) {
+        instance->load_all(logger);
+    }
+}
+
+void AdcStreamLoadCellDriver::notify_session_start(uint32_t start_us) {
+    if (instance) {
+        instance->start_request_us.store(start_us, std::memory_order_relaxed);
+        instance->start_requested.store(true, std::memory_order_release);
+    }
+}
+
+bool AdcStreamLoadCellDriver::data_waiting_async() {
+    if (start_requested.load(std::memory_order_acquire)) {
+        return true;
+    }
+    int64_t now_us = esp_timer_get_time();
+    if (playing) {
+        return now_us >= session_start_us + sample_time_us[playing->first + cursor];
+    }
+    return now_us >= next_hold_due_us;
+}
+
+bool AdcStreamLoadCellDriver::update_async() {
+    if (start_requested.exchange(false, std::memory_order_acquire) && tracks_loaded.load(std::memory_order_acquire)) {
+        start_track(start_request_us.load(std::memory_order_relaxed));
+    }
+    int64_t now_us = esp_timer_get_time();
+
+    if (playing) {
+        uint32_t index = playing->first + cursor;
+        int64_t due_us = session_start_us + sample_time_us[index];
+        if (now_us < due_us) {
+            return false;
+        }
+        uint32_t late_us = (uint32_t)(now_us - due_us);
+        late_sum_us += late_us;
+        late_max_us = max(late_max_us, late_us);
+        if (cursor + 1 < playing->count && now_us >= session_start_us + sample_time_us[index + 1]) {
+            overrun_count++;
+        }
+        last_raw_data = sample_value[index];
+        last_sample_time_us = due_us;
+        if (++cursor == playing->count) {
+            finish_track();
+        }
+        return true;
+    }
+
+    if (now_us < next_hold_due_us) {
+        return false;
+    }
+    next_hold_due_us = now_us + sample_interval_us;
+    if (!hold_from_tracks && tracks_loaded.load(std::memory_order_acquire)) {
+        hold_from_tracks = true;
+        hold_value = track_count > 0 ? sample_value[tracks[0].first] : hold_value;
+    }
+    last_raw_data = hold_value;
+    last_sample_time_us = now_us;
+    return true;
+}
+
+//==============================================================================
+// PLAYBACK
+//==============================================================================
+
+void AdcStreamLoadCellDriver::start_track(uint32_t start_us) {
+    if (playing) {
+        LOG_BLE("AdcStreamLoadCellDriver: new session after %lu of %lu samples\n",
+                (unsigned long)cursor, (unsigned long)playing->count);
+        finish_track();
+    }
+    if (track_count == 0) {
+        return;
+    }
+    // The 32-bit session start, widened against the current esp_timer time
+    int64_t now_us = esp_timer_get_time();
+    session_start_us = now_us - (int64_t)(uint32_t)((uint32_t)now_us - start_us);
+    playing = &tracks[next_track];
+    next_track = (next_track + 1) % track_count;
+    cursor = 0;
+    late_sum_us = 0;
+    late_max_us = 0;
+    overrun_count = 0;
+    LOG_BLE("AdcStreamLoadCellDriver: playing session %lu (%lu samples)\n",
+            (unsigned long)playing->session_id, (unsigned long)playing->count);
+}
+
+void AdcStreamLoadCellDriver::finish_track() {
+    uint32_t played = cursor > 0 ? cursor : 1;
+    LOG_BLE("AdcStreamLoadCellDriver: session %lu played, pickup late by %lu us mean, %lu us max, %lu overruns\n",
+            (unsigned long)playing->session_id, (unsigned long)(late_sum_us / played),
+            (unsigned long)late_max_us, (unsigned long)overrun_count);
+    hold_value = cursor > 0 ? sample_value[playing->first + cursor - 1] : hold_value;
+    playing = nullptr;
+    next_hold_due_us = esp_timer_get_time() + sample_interval_us;
+}
+
+//==============================================================================
+// LOADING
+//==============================================================================
+
+void AdcStreamLoadCellDriver::load_all(const GrindLogger& logger) {
+    sample_time_us = (int32_t*)heap_caps_malloc(DEBUG_HIL_MAX_SAMPLES * sizeof(int32_t), MALLOC_CAP_SPIRAM);
+    sample_value = (int32_t*)heap_caps_malloc(DEBUG_HIL_MAX_SAMPLES * sizeof(int32_t), MALLOC_CAP_SPIRAM);
+    if (!sample_time_us || !sample_value) {
+        LOG_BLE("AdcStreamLoadCellDriver: out of memory for %u samples\n", (unsigned)DEBUG_HIL_MAX_SAMPLES);
+        release_tracks();
+        tracks_loaded.store(true, std::memory_order_release);
+        return;
+    }
+
+    SessionReader reader;
+    File dir = LittleFS.open(DEBUG_HIL_DIR);
+    const bool from_dir = dir && dir.isDirectory();
+    if (from_dir) {
+        File file = dir.openNextFile();
+        while (file && track_count < DEBUG_HIL_MAX_TRACKS && sample_total < DEBUG_HIL_MAX_SAMPLES) {
+            String name = file.name();
+            file.close();
+            if (is_session_file_name(name)) {
+                String path = name.startsWith("/") ? name : (String(DEBUG_HIL_DIR) + "/" + name);
+                if (reader.open(path.c_str())) {
+                    load_track(reader);
+                }
+            }
+            file = dir.openNextFile();
+        }
+        dir.close();
+    } else {
+        uint32_t* session_ids = (uint32_t*)heap_caps_malloc(GRIND_LOG_PARTITION_MAX_SESSIONS * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+        uint32_t session_count = session_ids ? logger.get_session_ids(session_ids, GRIND_LOG_PARTITION_MAX_SESSIONS) : 0;
+        for (uint32_t i = 0; i < session_count && track_count < DEBUG_HIL_MAX_TRACKS && sample_total < DEBUG_HIL_MAX_SAMPLES; i++) {
+            if (logger.open_session(session_ids[i], &reader)) {
+                load_track(reader);
+            }
+        }
+        heap_caps_free(session_ids);
+    }
+    LOG_BLE("AdcStreamLoadCellDriver: %u tracks, %lu samples from %s\n", (unsigned)track_count,
+            (unsigned long)sample_total, from_dir ? DEBUG_HIL_DIR : "the stored sessions");
+    tracks_loaded.store(true, std::memory_order_release);
+}
+
+bool AdcStreamLoadCellDriver::load_track(SessionReader& reader) {
+    if (reader.header().flags & SESSION_FILE_FLAG_OPEN) {
+        return false;
+    }
+    AdcCaptureEntry* entries = (AdcCaptureEntry*)heap_caps_malloc(GRIND_LOG_ADC_ENTRIES_PER_BLOCK * sizeof(AdcCaptureEntry), MALLOC_CAP_8BIT);
+    if (!entries) {
+        return false;
+    }
+
+    Track& track = tracks[track_count];
+    track.session_id = reader.header().session_id;
+    track.first = sample_total;
+    track.count = 0;
+    uint32_t offset = 0;
+    uint8_t count = 0;
+    while (sample_total < DEBUG_HIL_MAX_SAMPLES && reader.read_adc_block(&offset, entries, &count)) {
+        for (uint8_t i = 0; i < count && sample_total < DEBUG_HIL_MAX_SAMPLES; i++) {
+            if (entries[i].type != ADC_CAPTURE_SAMPLE) {
+                continue;   // The motor edges are the firmware's own now
+            }
+            sample_time_us[sample_total] = (int32_t)entries[i].timestamp_us;
+            sample_value[sample_total] = entries[i].value;
+            sample_total++;
+            track.count++;
+        }
+    }
+    heap_caps_free(entries);
+
+    if (track.count < 2) {
+        sample_total = track.first;
+        return false;
+    }
+    float duration_s = (float)(sample_time_us[sample_total - 1] - sample_time_us[track.first]) / 1000000.0f;
+    LOG_BLE("AdcStreamLoadCellDriver: session %lu (%lu samples, %.1fs at %.1f SPS)\n",
+            (unsigned long)track.session_id, (unsigned long)track.count, duration_s,
+            duration_s > 0.0f ? (track.count - 1) / duration_s : 0.0f);
+    track_count++;
+    return true;
+}
+
+void AdcStreamLoadCellDriver::release_tracks() {
+    heap_caps_free(sample_time_us);
+    heap_caps_free(sample_value);
+    sample_time_us = nullptr;
+    sample_value = nullptr;
+    sample_total = 0;
+    track_count = 0;
+    next_track = 0;
+    playing = nullptr;
+}
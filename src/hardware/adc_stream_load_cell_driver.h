@@ -0,0 +1,112 @@
+#pragma once
+
+#include "load_cell_driver.h"
+#include "../config/constants.h"
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * AdcStreamLoadCellDriver feeds WeightSamplingTask recorded raw ADC tracks
+ * instead of the ADC, for hardware-in-the-loop runs of the full firmware:
+ * UI, BLE, logging and the motor output run on the device as usual while the
+ * control path sees reproducible input. Selected with DEBUG_ENABLE_LOADCELL_HIL
+ * in any build (the -hil environment is the release build with it).
+ *
+ * Once the grind logger is up, setup() calls load_tracks(), which loads the
+ * ADC capture tracks of the session files in DEBUG_HIL_DIR into PSRAM, or
+ * without that directory those of the stored sessions, oldest first (record
+ * them with ADC capture on; sessions recorded during HIL runs join them, so
+ * keep a fixed set in DEBUG_HIL_DIR for comparisons). Playback does no flash
+ * I/O. Each grind session plays the next track from the session start
+ * (notify_session_start()), every sample due at its recorded offset and
+ * timestamped with that due time, so the filter sees the original timing
+ * whenever the task picks it up. The stream does not react to the motor.
+ * Between tracks the scale holds the upcoming track's first sample (the
+ * recording's pre-tare load) at the configured rate, and after a track ends
+ * its last sample.
+ *
+ * Per track a log line reports how late the sampling task picked the samples
+ * up (mean and max after their due time) and how many it took only after the
+ * next one was already due, for comparing builds on the same recordings.
+ */
+class GrindLogger;
+class SessionReader;
+
+class AdcStreamLoadCellDriver : public LoadCellDriver {
+public:
+    AdcStreamLoadCellDriver();
+    ~AdcStreamLoadCellDriver() override;
+
+    bool begin() override;
+    bool begin(uint8_t gain_value) override;
+    void set_gain(uint8_t gain_value) override { (void)gain_value; }
+
+    void power_up() override {}
+    void power_down() override {}
+
+    bool is_ready() override { return data_waiting_async(); }
+    bool data_waiting_async() override;
+    bool update_async() override;
+    int32_t get_raw_data() const override { return last_raw_data; }
+
+    bool validate_hardware() override { return true; }
+
+    bool supports_temperature_sensor() const override { return false; }
+    float get_temperature() const override { return NAN; }
+    uint32_t get_max_sample_rate() const override { return HW_LOADCELL_SAMPLE_RATE_HIGH_SPS; }
+    bool set_sample_rate(uint32_t sps) override;
+    uint32_t get_sample_rate() const override { return sample_rate_sps; }
+    int64_t get_last_sample_time_us() const override { return last_sample_time_us; }
+
+    const char* get_driver_name() const override { return "ADC_STREAM"; }
+
+    // setup(), Core 1, after the grind logger is initialized
+    static void load_tracks(const GrindLogger& logger);
+    // GrindController: a session started at start_us (esp_timer) plays the next track
+    static void notify_session_start(uint32_t start_us);
+
+private:
+    struct Track {
+        uint32_t session_id;
+        uint32_t first;                 // Index into the sample arrays
+        uint32_t count;
+    };
+
+    static AdcStreamLoadCellDriver* instance;
+
+    // Loaded tracks (PSRAM), times relative to the recorded session start; read-only once tracks_loaded
+    std::atomic<bool> tracks_loaded{false};
+    int32_t* sample_time_us = nullptr;
+    int32_t* sample_value = nullptr;
+    uint32_t sample_total = 0;
+    Track tracks[DEBUG_HIL_MAX_TRACKS];
+    uint8_t track_count = 0;
+
+    // Playback, owned by the sampling task once begin() returned
+    std::atomic<uint32_t> start_request_us{0};
+    std::atomic<bool> start_requested{false};
+    const Track* playing = nullptr;     // nullptr: holding a sample between tracks
+    uint8_t next_track = 0;
+    int64_t session_start_us = 0;       // esp_timer µs
+    uint32_t cursor = 0;                // Next sample of the playing track
+    int32_t hold_value;
+    bool hold_from_tracks = false;      // hold_value taken from the first track
+
+    // Lateness of the playing track
+    uint64_t late_sum_us = 0;
+    uint32_t late_max_us = 0;
+    uint32_t overrun_count = 0;         // Taken after the next sample was due
+
+    // Sampling
+    uint32_t sample_rate_sps;
+    uint32_t sample_interval_us;
+    int64_t next_hold_due_us = 0;
+    int32_t last_raw_data;
+    int64_t last_sample_time_us = 0;
+
+    void load_all(const GrindLogger& logger);
+    bool load_track(SessionReader& reader);
+    void start_track(uint32_t start_us);
+    void finish_track();
+    void release_tracks();
+};
@@ -0,0 +1,213 @@
+#include "ads1232_driver.h"
+#include "../config/constants.h"
+#include <Arduino.h>
+
+/**
+ * ADS1232 Driver Implementation
+ *
+ * Timing and temperature diode constants per the TI ADS1232 datasheet
+ * (SBAS350). Readout and data-ready handling come from HX711Driver.
+ */
+
+namespace {
+constexpr float kTempDiodeMvAt25C = 111.7f;     // Diode voltage at 25°C
+constexpr float kTempDiodeMvPerC = 0.379f;      // Diode temperature coefficient
+constexpr uint32_t kOffsetCalibrationTimeoutMs = 1000;  // 801ms at 10 SPS
+}
+
+ADS1232Driver::ADS1232Driver(uint8_t sck_pin, uint8_t dout_pin, int8_t speed_pin)
+    : HX711Driver(sck_pin, dout_pin, speed_pin),
+      pdwn_pin(HW_ADS1232_PDWN_PIN), temp_pin(HW_ADS1232_TEMP_PIN), a0_pin(HW_ADS1232_A0_PIN),
+      gain0_pin(HW_ADS1232_GAIN0_PIN), gain1_pin(HW_ADS1232_GAIN1_PIN),
+      pga_gain(HW_ADS1232_STRAPPED_GAIN), temp_phase(TempPhase::IDLE), load_cell_raw_backup(0),
+      last_temperature_ms(0), temperature_c(NAN) {
+}
+
+bool ADS1232Driver::begin(uint8_t gain_value) {
+    temp_phase = TempPhase::IDLE;
+    temperature_c = NAN;
+    last_temperature_ms = 0;
+
+    if (!HX711Driver::begin(gain_value)) {
+        return false;
+    }
+
+    if (!run_offset_calibration()) {
+        LOG_BLE("ADS1232Driver: Offset self-calibration did not complete\n");
+        return false;
+    }
+
+    LOG_BLE("ADS1232Driver: Ready (PGA gain %u, %lu SPS, temperature %s)\n",
+            pga_gain, (unsigned long)current_rate_sps,
+            supports_temperature_sensor() ? "available" : "not wired");
+    return true;
+}
+
+bool ADS1232Driver::configure_pins() {
+    HX711Driver::configure_pins();
+
+    if (pdwn_pin >= 0) {
+        pinMode(pdwn_pin, OUTPUT);
+        digitalWrite(pdwn_pin, HIGH);
+    }
+    if (temp_pin >= 0) {
+        pinMode(temp_pin, OUTPUT);
+        digitalWrite(temp_pin, LOW);
+    }
+    if (a0_pin >= 0) {
+        pinMode(a0_pin, OUTPUT);
+        digitalWrite(a0_pin, LOW);  // AIN1
+    }
+    if (gain_pins_wired()) {
+        pinMode(gain0_pin, OUTPUT);
+        pinMode(gain1_pin, OUTPUT);
+        apply_pga_gain(pga_gain);
+    }
+    return true;
+}
+
+void ADS1232Driver::set_gain(uint8_t gain_value) {
+    // Gain is pin-selected; 25 SCLK pulses per readout (a 26th starts offset calibration)
+    gain = 1;
+
+    if (!gain_pins_wired()) {
+        pga_gain = HW_ADS1232_STRAPPED_GAIN;
+        return;
+    }
+
+    if (gain_value >= 128) {
+        pga_gain = 128;
+    } else if (gain_value >= 64) {
+        pga_gain = 64;
+    } else if (gain_value >= 2) {
+        pga_gain = 2;
+    } else {
+        pga_gain = 1;
+    }
+    apply_pga_gain(pga_gain);
+}
+
+void ADS1232Driver::apply_pga_gain(uint8_t gain_value) {
+    if (!gain_pins_wired()) {
+        return;
+    }
+    // GAIN1:GAIN0 = 00 -> 1, 01 -> 2, 10 -> 64, 11 -> 128
+    bool g0 = (gain_value == 2 || gain_value == 128);
+    bool g1 = (gain_value >= 64);
+    digitalWrite(gain0_pin, g0 ? HIGH : LOW);
+    digitalWrite(gain1_pin, g1 ? HIGH : LOW);
+}
+
+bool ADS1232Driver::run_offset_calibration() {
+    uint32_t sample_interval_ms = 1000 / current_rate_sps;
+    unsigned long start_time = millis();
+    while (!is_ready() && millis() - start_time < sample_interval_ms * 2 + 200) {
+        delay(sample_interval_ms / 4);
+    }
+    if (!is_ready()) {
+        return false;
+    }
+
+    // 26th SCLK pulse after the data word starts the calibration
+    gain = 2;
+    conversion_24bit();
+    gain = 1;
+
+    // DRDY falls again once calibration finishes; that conversion is valid
+    start_time = millis();
+    while (!is_ready() && millis() - start_time < kOffsetCalibrationTimeoutMs) {
+        delay(sample_interval_ms / 4);
+    }
+    if (!is_ready()) {
+        return false;
+    }
+    conversion_24bit();
+    return true;
+}
+
+void ADS1232Driver::power_up_sequence() {
+    HX711Driver::power_up_sequence();
+    if (pdwn_pin >= 0) {
+        pinMode(pdwn_pin, OUTPUT);
+        digitalWrite(pdwn_pin, HIGH);
+        // First conversions after wake-up include digital filter settling
+        rate_switch_discard_remaining = HW_LOADCELL_RATE_SWITCH_DISCARD_SAMPLES;
+    }
+}
+
+void ADS1232Driver::power_down_sequence() {
+    if (pdwn_pin < 0) {
+        // Standby: SCLK held high after DRDY, same sequence as HX711 power-down
+        HX711Driver::power_down_sequence();
+        return;
+    }
+
+    disable_data_ready_interrupt();
+    digitalWrite(pdwn_pin, LOW);
+}
+
+bool ADS1232Driver::supports_temperature_sensor() const {
+    // The diode only fits the input range at PGA gain 1 or 2
+    return temp_pin >= 0 && (gain_pins_wired() || pga_gain <= 2);
+}
+
+bool ADS1232Driver::temperature_due() const {
+    if (!supports_temperature_sensor() || current_rate_sps != HW_LOADCELL_SAMPLE_RATE_SPS) {
+        return false;   // Only at the idle rate - grind phases keep every load cell sample
+    }
+    return last_temperature_ms == 0 || millis() - last_temperature_ms >= HW_ADS1232_TEMP_INTERVAL_MS;
+}
+
+void ADS1232Driver::start_temperature_measurement() {
+    load_cell_raw_backup = last_raw_data;
+    digitalWrite(temp_pin, HIGH);
+    apply_pga_gain(1);
+    temp_phase = TempPhase::MEASURING;
+    rate_switch_discard_remaining = HW_LOADCELL_RATE_SWITCH_DISCARD_SAMPLES;
+}
+
+void ADS1232Driver::finish_temperature_measurement() {
+    int32_t code = last_raw_data - 0x800000;  // Offset binary -> signed
+    uint8_t measure_gain = gain_pins_wired() ? 1 : pga_gain;
+
+    if (code >= 0x7FFFFF || code <= -0x800000) {
+        temperature_c = NAN;  // Saturated - gain too high for the diode
+    } else {
+        float diode_mv = (float)code * (0.5f * HW_ADS1232_VREF_MV / measure_gain) / 8388608.0f;
+        temperature_c = 25.0f + (diode_mv - kTempDiodeMvAt25C) / kTempDiodeMvPerC;
+    }
+
+    // Back to the load cell; the weight stream never sees the diode code
+    last_raw_data = load_cell_raw_backup;
+    digitalWrite(temp_pin, LOW);
+    apply_pga_gain(pga_gain);
+    temp_phase = TempPhase::IDLE;
+    rate_switch_discard_remaining = HW_LOADCELL_RATE_SWITCH_DISCARD_SAMPLES;
+    last_temperature_ms = millis();
+
+    LOG_LOADCELL_DEBUG("ADS1232Driver: Die temperature %.1f°C\n", temperature_c);
+}
+
+bool ADS1232Driver::update_async() {
+    if (!is_ready()) {
+        return false;
+    }
+
+    conversion_24bit();
+
+    if (rate_switch_discard_remaining > 0) {
+        rate_switch_discard_remaining--;
+        return false;
+    }
+
+    if (temp_phase == TempPhase::MEASURING) {
+        finish_temperature_measurement();
+        return false;
+    }
+
+    if (temperature_due()) {
+        // This sample is still a load cell conversion; the next ones settle on the diode
+        start_temperature_measurement();
+    }
+    return true;
+}
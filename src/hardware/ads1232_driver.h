@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../config/constants.h"
+#include "hx711_driver.h"
+#include <Arduino.h>
+#include <math.h>
+
+/**
+ * ADS1232 ADC Driver
+ *
+ * TI ADS1232 24-bit bridge ADC. The serial interface is the HX711's
+ * (DRDY/DOUT falls when a conversion is ready, 24 MSB-first bits on SCLK,
+ * 25th pulse forces DOUT high), so the readout, data-ready interrupt and
+ * SPEED switching (10/80 SPS, same settling behaviour as HX711 RATE) are
+ * inherited from HX711Driver.
+ *
+ * ADS1232 specifics:
+ * - PGA gain comes from the GAIN0/GAIN1 pins, not from extra SCLK pulses.
+ *   Always 25 pulses per readout; 26 pulses start an offset self-calibration,
+ *   which begin() issues once after power-up.
+ * - Optional PDWN pin for real power-down (standby via SCLK otherwise).
+ * - Temperature: with TEMP wired, the input is periodically switched to the
+ *   internal diode (at the idle rate only, so grind phases never lose
+ *   samples). Needs PGA gain 1 or 2 while measuring, i.e. wired GAIN pins
+ *   or a low strapped gain.
+ */
+class ADS1232Driver : public HX711Driver {
+private:
+    enum class TempPhase : uint8_t {
+        IDLE,           // Load cell input selected
+        MEASURING,      // Diode selected, discarding settling conversions
+    };
+
+    int8_t pdwn_pin;
+    int8_t temp_pin;
+    int8_t a0_pin;
+    int8_t gain0_pin;
+    int8_t gain1_pin;
+    uint8_t pga_gain;
+
+    TempPhase temp_phase;
+    int32_t load_cell_raw_backup;   // Weight sample kept while the diode is selected
+    unsigned long last_temperature_ms;
+    float temperature_c;
+
+    bool gain_pins_wired() const { return gain0_pin >= 0 && gain1_pin >= 0; }
+    void apply_pga_gain(uint8_t gain_value);
+    bool run_offset_calibration();
+    bool temperature_due() const;
+    void start_temperature_measurement();
+    void finish_temperature_measurement();
+
+protected:
+    bool configure_pins() override;
+    void power_up_sequence() override;
+    void power_down_sequence() override;
+    // update_async() clocks offset calibration and temperature switches around reads
+    bool supports_isr_readout() const override { return false; }
+
+public:
+    ADS1232Driver(uint8_t sck_pin = HW_LOADCELL_SCK_PIN, uint8_t dout_pin = HW_LOADCELL_DOUT_PIN,
+                  int8_t speed_pin = HW_ADS1232_SPEED_PIN);
+    ~ADS1232Driver() override = default;
+
+    bool begin(uint8_t gain_value) override;
+    using HX711Driver::begin;
+    void set_gain(uint8_t gain_value) override;
+    bool update_async() override;
+
+    bool supports_temperature_sensor() const override;
+    float get_temperature() const override { return temperature_c; }
+
+    const char* get_driver_name() const override { return "ADS1232"; }
+};
@@ -0,0 +1,62 @@
+#include "calibration_curve.h"
+#include <math.h>
+
+void CalibrationCurve::initial_state(CalibrationPointsState* state) {
+    memset(state, 0, sizeof(*state));
+    state->version = STATE_VERSION;
+    state->temperature_c = NAN;
+}
+
+void CalibrationCurve::set_single_factor(float raw_per_gram) {
+    direction = raw_per_gram < 0.0f ? -1 : 1;
+    for (int k = 0; k < MAX_POINTS - 1; k++) {
+        knee_raw[k] = INT32_MAX;
+    }
+    for (int s = 0; s < MAX_POINTS; s++) {
+        gain_g[s] = 1.0f / fabsf(raw_per_gram);
+        offset_g[s] = 0.0f;
+    }
+    nominal_factor = raw_per_gram;
+    point_count = 1;
+}
+
+bool CalibrationCurve::set_points(const CalibrationPointsState& state) {
+    if (state.version != STATE_VERSION || state.count == 0 || state.count > MAX_POINTS) {
+        return false;
+    }
+    const int32_t sign = state.raw_delta[0] < 0 ? -1 : 1;
+    int32_t previous_raw = 0;
+    float previous_g = 0.0f;
+    for (uint8_t i = 0; i < state.count; i++) {
+        int32_t oriented = state.raw_delta[i] * sign;
+        if (!isfinite(state.grams[i]) || state.grams[i] <= previous_g ||
+            oriented - previous_raw < HW_LOADCELL_CAL_MIN_ADC_VALUE) {
+            return false;
+        }
+        previous_raw = oriented;
+        previous_g = state.grams[i];
+    }
+
+    // Segment s runs from point s-1 (the zero for s = 0) to point s
+    direction = sign;
+    previous_raw = 0;
+    previous_g = 0.0f;
+    for (int s = 0; s < MAX_POINTS; s++) {
+        if (s < state.count) {
+            int32_t oriented = state.raw_delta[s] * sign;
+            gain_g[s] = (state.grams[s] - previous_g) / (float)(oriented - previous_raw);
+            offset_g[s] = previous_g - gain_g[s] * (float)previous_raw;
+            previous_raw = oriented;
+            previous_g = state.grams[s];
+        } else {
+            gain_g[s] = gain_g[s - 1];
+            offset_g[s] = offset_g[s - 1];
+        }
+        if (s < MAX_POINTS - 1) {
+            knee_raw[s] = s + 1 < state.count ? state.raw_delta[s] * sign : INT32_MAX;
+        }
+    }
+    nominal_factor = (float)state.raw_delta[state.count - 1] / state.grams[state.count - 1];
+    point_count = state.count;
+    return true;
+}
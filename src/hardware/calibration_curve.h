@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/constants.h"
+
+#pragma pack(push, 1)
+// Persisted calibration points (NVS blob "hx_cal_pts"), sorted by grams
+struct CalibrationPointsState {
+    uint8_t  version;
+    uint8_t  count;                                     // Captured points (0 = the single stored calibration factor)
+    uint16_t reserved;
+    float    temperature_c;                             // ADC temperature at capture (NaN without a sensor)
+    int32_t  raw_delta[HW_LOADCELL_CAL_MAX_POINTS];     // Raw counts above the tare offset
+    float    grams[HW_LOADCELL_CAL_MAX_POINTS];         // Known weight of each point
+};
+#pragma pack(pop)
+
+static_assert(sizeof(CalibrationPointsState) == 8 + 8 * HW_LOADCELL_CAL_MAX_POINTS, "Unexpected CalibrationPointsState size");
+
+/**
+ * CalibrationCurve - Piecewise-linear raw counts to grams
+ *
+ * Built once from the captured points (plus the tare zero) and evaluated per
+ * sample. Segment breakpoints are raw counts, so the segment is picked by
+ * integer compares summed over a fixed-size knee table (no data-dependent
+ * branches), then grams = offset + delta * gain with both precomputed; the
+ * conversion never divides. One point is the classic single cal_factor line.
+ * Below zero the first segment extends, above the last point the last one.
+ *
+ * direction is the sign of raw per gram, so load cells wired either way keep
+ * increasing knees.
+ */
+class CalibrationCurve {
+public:
+    static const uint8_t STATE_VERSION = 1;
+    static const uint8_t MAX_POINTS = HW_LOADCELL_CAL_MAX_POINTS;
+
+    static void initial_state(CalibrationPointsState* state);
+
+    // One segment through zero with raw_per_gram
+    void set_single_factor(float raw_per_gram);
+    // Rebuild from points; false (curve unchanged) unless grams and raw both rise point to point
+    bool set_points(const CalibrationPointsState& state);
+
+    // Raw per gram from zero to the heaviest point (settling thresholds, noise conversions)
+    float get_nominal_factor() const { return nominal_factor; }
+    uint8_t get_point_count() const { return point_count; }
+
+    float to_grams(int32_t raw_delta) const {
+        int32_t oriented = raw_delta * direction;
+        int segment = 0;
+        for (int k = 0; k < MAX_POINTS - 1; k++) {
+            segment += oriented > knee_raw[k];
+        }
+        return offset_g[segment] + (float)oriented * gain_g[segment];
+    }
+
+private:
+    int32_t direction = 1;
+    int32_t knee_raw[MAX_POINTS - 1] = {};  // Oriented raw of points 0..n-2; INT32_MAX when unused
+    float gain_g[MAX_POINTS] = {};          // Grams per oriented count of each segment
+    float offset_g[MAX_POINTS] = {};
+    float nominal_factor = 1.0f;
+    uint8_t point_count = 0;
+};
@@ -1,67 +1,468 @@
 #include "circular_buffer_math.h"
+#include "window_kernels.h"
 #include "../../config/constants.h"
 #include <math.h>
 #include <algorithm>
+#include <esp_timer.h>
 
-CircularBufferMath::CircularBufferMath() {
-    write_index = 0;
-    samples_count = 0;
+CircularBufferMath::CircularBufferMath() : publish_seq(0), clear_floor_seq(0) {
     display_filtered_raw = 0;
     display_filter_initialized = false;
     flow_stable_since_ms = 0;
     flow_stability_initialized = false;
+    sample_rate_sps = HW_LOADCELL_SAMPLE_RATE_SPS;
+    window_rate_sps = HW_LOADCELL_SAMPLE_RATE_SPS;
     
     // Initialize buffer
-    for (uint16_t i = 0; i < MAX_BUFFER_SIZE; i++) {
-        circular_buffer[i].raw_value = 0;
-        circular_buffer[i].timestamp_ms = 0;
+    raw_ring.wipe();
+    timestamp_ring.wipe();
+    for (uint8_t i = 0; i < QUERY_CACHE_SLOTS; i++) {
+        query_cache[i].version.store(0, std::memory_order_relaxed);
+        query_cache[i].end_seq = 0;
+        query_cache[i].floor_seq = 0;
+        query_cache[i].window_ms = 0;   // No query uses a 0 ms window, so nothing matches yet
+        query_cache[i].value_bits = 0;
+        query_cache[i].query = CachedQuery::SMOOTHED_RAW;
+    }
+    
+    // Carve the min/max deques for each aggregate window out of one pool
+    uint32_t* pool = aggregate_seq_pool;
+    for (uint8_t i = 0; i < circular_buffer_aggregates::WINDOW_COUNT; i++) {
+        WindowAggregate& aggregate = aggregates[i];
+        uint16_t capacity = circular_buffer_aggregates::capacity_for(circular_buffer_aggregates::WINDOWS_MS[i]);
+        aggregate.window_us = (uint32_t)circular_buffer_aggregates::WINDOWS_MS[i] * 1000;
+        aggregate.capacity = capacity;
+        aggregate.working = WindowStats{};
+        aggregate.published = WindowStats{};
+        aggregate.version.store(0, std::memory_order_relaxed);
+        
+        MonotonicDeque* deques[] = { &aggregate.min_deque, &aggregate.max_deque };
+        for (MonotonicDeque* deque : deques) {
+            deque->seqs = pool;
+            deque->mask = capacity - 1;
+            deque->head = 0;
+            deque->size = 0;
+            pool += capacity;
+        }
     }
 }
 
-void CircularBufferMath::add_sample(int32_t raw_adc_value, uint32_t timestamp_ms) {
+uint32_t CircularBufferMath::now_us() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+void CircularBufferMath::add_sample(int32_t raw_adc_value, uint32_t timestamp_us) {
     // Raw ADC values should be valid 24-bit signed integers
     // We don't validate range here as different ADCs have different ranges
     
+    // Only the producer stores publish_seq, so a relaxed load is its own latest value
+    uint32_t seq = publish_seq.load(std::memory_order_relaxed);
+    
     // Add raw value directly to circular buffer (no IIR filtering)
-    circular_buffer[write_index].raw_value = raw_adc_value;
-    circular_buffer[write_index].timestamp_ms = timestamp_ms;
+    raw_ring.slot(seq) = raw_adc_value;
+    timestamp_ring.slot(seq) = timestamp_us;
     
-    // Advance write index (circular)
-    write_index = (write_index + 1) % MAX_BUFFER_SIZE;
+    // Release: the slot contents are visible before readers can see the new count
+    publish_seq.store(seq + 1, std::memory_order_release);
     
-    // Track sample count (up to buffer size)
-    if (samples_count < MAX_BUFFER_SIZE) {
-        samples_count++;
+#if HW_LOADCELL_COMPACT_HISTORY_ENABLED
+    history.add_sample(raw_adc_value, timestamp_us, seq);
+#endif
+    
+    uint32_t floor_seq = clear_floor_seq.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < circular_buffer_aggregates::WINDOW_COUNT; i++) {
+        update_aggregate(aggregates[i], seq, floor_seq);
     }
 }
 
-int32_t CircularBufferMath::get_instant_raw() const {
-    if (samples_count == 0) return 0;
+namespace {
+// Keep the deque monotonic: drop queued samples the new one dominates, then append it
+template <typename Deque, typename Dominates>
+void deque_push(Deque& deque, uint32_t seq, Dominates dominates) {
+    while (deque.size > 0 && dominates(deque.seqs[(deque.head + deque.size - 1) & deque.mask])) {
+        deque.size--;
+    }
+    deque.seqs[(deque.head + deque.size) & deque.mask] = seq;
+    deque.size++;
+}
+
+// Least-squares line through (t, y) from exact integer sums; y is centered, t in µs
+struct RegressionSums {
+    int n;
+    int64_t sum_t;
+    int64_t sum_tt;
+    int64_t sum_y;
+    int64_t sum_yy;
+    int64_t sum_ty;
+};
+
+bool solve_regression(const RegressionSums& sums, float* rate_out, float* confidence_out) {
+    if (sums.n < 2) return false;
+    double n = sums.n;
+    double s_tt = (double)sums.sum_tt - (double)sums.sum_t * sums.sum_t / n;
+    if (s_tt <= 0.0) return false;
+    double s_ty = (double)sums.sum_ty - (double)sums.sum_t * sums.sum_y / n;
+    double s_yy = (double)sums.sum_yy - (double)sums.sum_y * sums.sum_y / n;
+    
+    *rate_out = (float)(s_ty / s_tt * 1000000.0);
+    if (confidence_out) {
+        // R^2: share of the window's variance the line explains (1 - residual/total)
+        double r_squared = s_yy > 0.0 ? (s_ty * s_ty) / (s_tt * s_yy) : 0.0;
+        *confidence_out = (float)std::max(0.0, std::min(1.0, r_squared));
+    }
+    return true;
+}
+}
+
+void CircularBufferMath::evict_oldest(WindowAggregate& aggregate) {
+    WindowStats& stats = aggregate.working;
+    int32_t value = raw_ring.slot(stats.oldest_seq);
+    int64_t centered = (int64_t)value - stats.center;
+    int64_t t = (int32_t)(timestamp_ring.slot(stats.oldest_seq) - stats.time_origin_us);
+    stats.sum -= value;
+    stats.sum_sq -= centered * centered;
+    stats.sum_t -= t;
+    stats.sum_tt -= t * t;
+    stats.sum_ty -= t * centered;
+    stats.count--;
+    
+    MonotonicDeque* deques[] = { &aggregate.min_deque, &aggregate.max_deque };
+    for (MonotonicDeque* deque : deques) {
+        if (deque->size > 0 && deque->seqs[deque->head] == stats.oldest_seq) {
+            deque->head = (deque->head + 1) & deque->mask;
+            deque->size--;
+        }
+    }
+    stats.oldest_seq++;
+}
+
+void CircularBufferMath::update_aggregate(WindowAggregate& aggregate, uint32_t seq, uint32_t floor_seq) {
+    // Producer only. Evicted values are re-read from the ring: every window holds
+    // fewer than READABLE_CAPACITY samples, so their slots are still intact.
+    WindowStats& stats = aggregate.working;
+    const int32_t value = raw_ring.slot(seq);
+    const uint32_t timestamp_us = timestamp_ring.slot(seq);
+    
+    if (stats.count == aggregate.capacity) {
+        evict_oldest(aggregate);
+        stats.truncated = true;
+    }
+    if (stats.count == 0) {
+        stats = WindowStats{};
+        stats.center = value;
+        stats.oldest_seq = seq;
+        stats.time_origin_us = timestamp_us;
+    }
+    
+    int64_t centered = (int64_t)value - stats.center;
+    int64_t t = (int32_t)(timestamp_us - stats.time_origin_us);
+    stats.sum += value;
+    stats.sum_sq += centered * centered;
+    stats.sum_t += t;
+    stats.sum_tt += t * t;
+    stats.sum_ty += t * centered;
+    stats.count++;
+    
+    deque_push(aggregate.min_deque, seq,
+               [&](uint32_t queued) { return raw_ring.slot(queued) >= value; });
+    deque_push(aggregate.max_deque, seq,
+               [&](uint32_t queued) { return raw_ring.slot(queued) <= value; });
+    
+    // Age out samples older than the window or hidden by a clear; the new sample always stays
+    uint32_t window_start = timestamp_us - aggregate.window_us;
+    while (stats.count > 1) {
+        bool below_floor = (int32_t)(stats.oldest_seq - floor_seq) < 0;
+        if (!below_floor && is_at_or_after(timestamp_ring.slot(stats.oldest_seq), window_start)) {
+            break;
+        }
+        evict_oldest(aggregate);
+        stats.truncated = false;   // Everything before oldest_seq is now genuinely out of the window
+    }
+    if (stats.count == 1) {
+        // Re-center on the lone sample so sum_sq stays small across level changes
+        stats.center = value;
+        stats.sum_sq = 0;
+        stats.time_origin_us = timestamp_us;
+        stats.sum_t = 0;
+        stats.sum_tt = 0;
+        stats.sum_ty = 0;
+    } else {
+        // Slide the time origin up to the oldest sample once it trails by a window,
+        // so t stays below two windows and the int64 sums can't overflow:
+        // t' = t - d gives exact updates Σt' = Σt - nd, Σt'² = Σt² - 2dΣt + nd², Σt'y = Σty - dΣy
+        int64_t d = (int32_t)(timestamp_ring.slot(stats.oldest_seq) - stats.time_origin_us);
+        if (d > (int64_t)aggregate.window_us) {
+            int64_t n = stats.count;
+            int64_t centered_sum = stats.sum - (int64_t)stats.center * n;
+            stats.sum_tt += -2 * d * stats.sum_t + n * d * d;
+            stats.sum_t -= n * d;
+            stats.sum_ty -= d * centered_sum;
+            stats.time_origin_us += (uint32_t)d;
+        }
+    }
+    
+    stats.min_raw = raw_ring.slot(aggregate.min_deque.seqs[aggregate.min_deque.head]);
+    stats.max_raw = raw_ring.slot(aggregate.max_deque.seqs[aggregate.max_deque.head]);
+    stats.newest_timestamp_us = timestamp_us;
+    
+    // Seqlock publish: odd version while the copy is being written
+    uint32_t version = aggregate.version.load(std::memory_order_relaxed);
+    aggregate.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    aggregate.published = stats;
+    aggregate.version.store(version + 2, std::memory_order_release);
+}
+
+bool CircularBufferMath::read_window_stats(uint32_t window_ms, WindowStats* stats_out) const {
+    const WindowAggregate* aggregate = nullptr;
+    for (uint8_t i = 0; i < circular_buffer_aggregates::WINDOW_COUNT; i++) {
+        if (circular_buffer_aggregates::WINDOWS_MS[i] == window_ms) {
+            aggregate = &aggregates[i];
+            break;
+        }
+    }
+    if (!aggregate) return false;   // Unregistered window - caller scans
+    
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        uint32_t version = aggregate->version.load(std::memory_order_acquire);
+        if (version & 1) continue;
+        WindowStats stats = aggregate->published;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (aggregate->version.load(std::memory_order_relaxed) != version) continue;
+        
+        // Only answer when the aggregate matches what a scan would collect: nothing
+        // cleared since the last sample, no capacity truncation, and the newest sample
+        // recent enough that "ends at the newest sample" ~ "ends now" (ADC running)
+        if (stats.count == 0 || stats.truncated) return false;
+        if ((int32_t)(stats.oldest_seq - clear_floor_seq.load(std::memory_order_acquire)) < 0) return false;
+        uint32_t slack_us = 2000000 / sample_rate_sps;
+        if (!is_at_or_after(stats.newest_timestamp_us, now_us() - slack_us)) return false;
+        
+        *stats_out = stats;
+        return true;
+    }
+    return false;
+}
+
+uint8_t CircularBufferMath::query_cache_slot(CachedQuery query, uint32_t window_ms) {
+    // Fibonacci hash: common windows (multiples of 50 ms) spread over the slots
+    uint32_t key = window_ms * 8 + (uint32_t)query;
+    return (uint8_t)((key * 2654435761u) >> 27) & (QUERY_CACHE_SLOTS - 1);
+}
+
+bool CircularBufferMath::query_cache_lookup(CachedQuery query, uint32_t window_ms, uint32_t end_seq,
+                                            uint32_t floor_seq, uint32_t now, uint32_t* value_bits_out) const {
+    const QueryCacheEntry& entry = query_cache[query_cache_slot(query, window_ms)];
+    uint32_t version = entry.version.load(std::memory_order_acquire);
+    if (version & 1) {
+        return false;
+    }
+    bool hit = entry.query == query && entry.window_ms == window_ms &&
+               entry.end_seq == end_seq && entry.floor_seq == floor_seq &&
+               now - entry.computed_us < QUERY_CACHE_MAX_AGE_US;
+    uint32_t value_bits = entry.value_bits;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!hit || entry.version.load(std::memory_order_relaxed) != version) {
+        return false;
+    }
+    *value_bits_out = value_bits;
+    return true;
+}
+
+void CircularBufferMath::query_cache_store(CachedQuery query, uint32_t window_ms, uint32_t end_seq,
+                                           uint32_t floor_seq, uint32_t computed_us, uint32_t value_bits) const {
+    QueryCacheEntry& entry = query_cache[query_cache_slot(query, window_ms)];
+    // Another task filling this slot wins; the result simply isn't cached this time
+    uint32_t version = entry.version.load(std::memory_order_relaxed);
+    if ((version & 1) || !entry.version.compare_exchange_strong(version, version + 1, std::memory_order_acquire)) {
+        return;
+    }
+    entry.query = query;
+    entry.window_ms = window_ms;
+    entry.end_seq = end_seq;
+    entry.floor_seq = floor_seq;
+    entry.computed_us = computed_us;
+    entry.value_bits = value_bits;
+    entry.version.store(version + 2, std::memory_order_release);
+}
+
+CircularBufferMath::ReadSnapshot CircularBufferMath::begin_read() const {
+    // Floor first: it only ever trails publish_seq, so end - floor never underflows
+    uint32_t floor_seq = clear_floor_seq.load(std::memory_order_acquire);
+    uint32_t end_seq = publish_seq.load(std::memory_order_acquire);
+    
+    uint32_t available = end_seq - floor_seq;
+    ReadSnapshot snapshot;
+    snapshot.end_seq = end_seq;
+    snapshot.count = (uint16_t)std::min<uint32_t>(available, READABLE_CAPACITY);
+    return snapshot;
+}
+
+CircularBufferMath::ReadSnapshot CircularBufferMath::begin_read_unfloored() const {
+    ReadSnapshot snapshot;
+    snapshot.end_seq = publish_seq.load(std::memory_order_acquire);
+    snapshot.count = (uint16_t)std::min<uint32_t>(snapshot.end_seq, READABLE_CAPACITY);
+    return snapshot;
+}
+
+int CircularBufferMath::count_at_or_after(const ReadSnapshot& snapshot, uint32_t timestamp_us) const {
+    // Timestamps are monotonic newest-to-oldest, so this is a partition point:
+    // O(log n) instead of walking the ring. A lapped read yields a wrong count,
+    // which the caller's read_is_valid() check rejects like any other torn scan.
+    int low = 0;
+    int high = snapshot.count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (is_at_or_after(timestamp_at(snapshot, mid), timestamp_us)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+int CircularBufferMath::raw_runs(const ReadSnapshot& snapshot, int first, int last,
+                                 const int32_t* runs[2], int lengths[2]) const {
+    int count = last - first;
+    if (count <= 0) return 0;
+    const int32_t* base = &raw_ring.slot(0);
+    uint32_t start = (snapshot.end_seq - last) & (MAX_BUFFER_SIZE - 1);
+    int head = std::min<int>(count, MAX_BUFFER_SIZE - start);
+    runs[0] = base + start;
+    lengths[0] = head;
+    if (head == count) return 1;
+    runs[1] = base;
+    lengths[1] = count - head;
+    return 2;
+}
+
+bool CircularBufferMath::read_is_valid(const ReadSnapshot& snapshot) const {
+    // Slot reads above must complete before re-checking the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t advanced = publish_seq.load(std::memory_order_relaxed) - snapshot.end_seq;
+    return advanced < READER_GUARD_SLOTS;
+}
+
+void CircularBufferMath::set_sample_rate(uint32_t sps) {
+    if (sps == 0) return;
     
+    sample_rate_sps = sps;
+    if (sps > window_rate_sps) {
+        window_rate_sps = sps;
+    }
+}
+
+int32_t CircularBufferMath::get_instant_raw() const {
     // Return most recent sample
     return get_latest_sample();
 }
 
 int32_t CircularBufferMath::get_latest_sample() const {
-    if (samples_count == 0) return 0;
+    // The newest slot is never rewritten until READER_GUARD_SLOTS more samples arrive
+    ReadSnapshot snapshot = begin_read();
+    if (snapshot.count == 0) return 0;
+    return raw_at(snapshot, 0);
+}
+
+uint32_t CircularBufferMath::get_latest_sample_time_us() const {
+    ReadSnapshot snapshot = begin_read();
+    if (snapshot.count == 0) return 0;
+    return timestamp_at(snapshot, 0);
+}
+
+bool CircularBufferMath::get_raw_at_time_us(uint32_t timestamp_us, int32_t* raw_out,
+                                            uint32_t* sample_time_us_out) const {
+    if (!raw_out) return false;
+    
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadSnapshot snapshot = begin_read();
+        if (snapshot.count == 0 || !is_at_or_after(timestamp_at(snapshot, 0), timestamp_us)) {
+            return false;   // No sample after the event yet
+        }
+        
+        // The oldest sample at/after the event is the answer, provided an older one brackets it
+        int after = count_at_or_after(snapshot, timestamp_us);
+        if (after == 0) continue;   // Torn by a lapping write; retry
+        bool bracketed = after < snapshot.count;
+        int32_t raw = raw_at(snapshot, after - 1);
+        uint32_t sample_time = timestamp_at(snapshot, after - 1);
+        
+        if (read_is_valid(snapshot)) {
+            if (!bracketed) {
+                return false;   // Event predates the buffer; the first sample after it is gone
+            }
+            *raw_out = raw;
+            if (sample_time_us_out) {
+                *sample_time_us_out = sample_time;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CircularBufferMath::get_smoothed_raw_before_us(uint32_t end_us, uint32_t window_ms, int32_t* raw_out) const {
+    if (!raw_out) return false;
+    
+    int max_samples = calculate_max_samples_for_window(window_ms);
+    if (max_samples == 0) return false;
+    int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
+    
+    uint32_t window_start = end_us - window_ms * 1000;
+    int collected = 0;
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadSnapshot snapshot = begin_read();
+        collected = 0;
+        
+        // Offsets [first, last) lie in [window_start, end_us); the trimmed mean ignores order
+        int first = count_at_or_after(snapshot, end_us);
+        int last = std::min(count_at_or_after(snapshot, window_start), first + max_samples);
+        const int32_t* runs[2];
+        int lengths[2];
+        int run_count = raw_runs(snapshot, first, last, runs, lengths);
+        for (int r = 0; r < run_count; r++) {
+            memcpy(samples + collected, runs[r], lengths[r] * sizeof(int32_t));
+            collected += lengths[r];
+        }
+        
+        if (read_is_valid(snapshot)) {
+            break;
+        }
+    }
     
-    // Most recent sample is at (write_index - 1) % MAX_BUFFER_SIZE
-    uint16_t latest_index = (write_index - 1 + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
-    return circular_buffer[latest_index].raw_value;
+    if (collected == 0) {
+        return false;
+    }
+    *raw_out = apply_outlier_rejection(samples, collected);
+    return true;
 }
 
 // Unified smoothing method with outlier rejection on raw data
 int32_t CircularBufferMath::get_smoothed_raw(uint32_t window_ms) const {
-    if (samples_count == 0) return 0;
+    return memoize<int32_t>(CachedQuery::SMOOTHED_RAW, window_ms, [&] { return compute_smoothed_raw(window_ms); });
+}
+
+int32_t CircularBufferMath::compute_smoothed_raw(uint32_t window_ms) const {
+    // Registered windows trimming one sample per side (< 32 samples) come straight
+    // from the running sum and min/max; wider trims need the sorted window
+    WindowStats stats;
+    if (read_window_stats(window_ms, &stats) && stats.count < 32) {
+        if (stats.count <= 2) {
+            return static_cast<int32_t>(stats.sum / stats.count);
+        }
+        return static_cast<int32_t>((stats.sum - stats.min_raw - stats.max_raw) / (stats.count - 2));
+    }
     
     // Calculate max samples needed for this window
     int max_samples = calculate_max_samples_for_window(window_ms);
+    if (max_samples == 0) return 0;
     
     // Allocate temporary array on stack (reasonable size expected)
     int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
     
-    // Get samples within time window
-    int actual_samples = get_samples_in_window(window_ms, samples);
+    // Get samples within time window (order does not matter to the trimmed mean)
+    int actual_samples = copy_window_values(window_ms, samples, max_samples);
     
     if (actual_samples == 0) {
         return get_latest_sample(); // Fallback to latest sample
@@ -71,70 +472,138 @@ int32_t CircularBufferMath::get_smoothed_raw(uint32_t window_ms) const {
     return apply_outlier_rejection(samples, actual_samples);
 }
 
-int CircularBufferMath::get_samples_in_window(uint32_t window_ms, int32_t* samples_out) const {
-    if (samples_count == 0) return 0;
+int CircularBufferMath::get_samples_in_window(uint32_t window_ms, int32_t* samples_out, int max_samples,
+                                              uint32_t* timestamps_out) const {
+    if (max_samples <= 0) return 0;
     
-    uint32_t current_time = millis();
-    uint32_t window_start = current_time - window_ms;
+    uint32_t window_start = now_us() - window_ms * 1000;
     int collected_samples = 0;
     
-    // Walk backwards from most recent sample
-    for (int i = 0; i < samples_count; i++) {
-        uint16_t index = (write_index - 1 - i + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
+    // Retry if the producer lapped the guard while we were copying
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadSnapshot snapshot = begin_read();
+        collected_samples = 0;
         
-        // Check if sample is within time window
-        if (circular_buffer[index].timestamp_ms >= window_start) {
-            samples_out[collected_samples] = circular_buffer[index].raw_value;
-            collected_samples++;
-        } else {
-            break; // Samples are time-ordered, so we can stop here
+        // Locate the window edge, then copy newest first (bounded by the caller's buffer)
+        int in_window = std::min(count_at_or_after(snapshot, window_start), max_samples);
+        for (int i = 0; i < in_window; i++) {
+            samples_out[i] = raw_at(snapshot, i);
+            if (timestamps_out) {
+                timestamps_out[i] = timestamp_at(snapshot, i);
+            }
+        }
+        collected_samples = in_window;
+        
+        if (read_is_valid(snapshot)) {
+            break;
         }
     }
     
     return collected_samples;
 }
 
-int32_t CircularBufferMath::apply_outlier_rejection(const int32_t* samples, int count) const {
+int CircularBufferMath::copy_window_values(uint32_t window_ms, int32_t* values_out, int max_samples) const {
+    if (max_samples <= 0) return 0;
+    
+    uint32_t window_start = now_us() - window_ms * 1000;
+    int collected = 0;
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadSnapshot snapshot = begin_read();
+        const int32_t* runs[2];
+        int lengths[2];
+        int run_count = raw_runs(snapshot, 0, std::min(count_at_or_after(snapshot, window_start), max_samples), runs, lengths);
+        collected = 0;
+        for (int r = 0; r < run_count; r++) {
+            memcpy(values_out + collected, runs[r], lengths[r] * sizeof(int32_t));
+            collected += lengths[r];
+        }
+        if (read_is_valid(snapshot)) {
+            break;
+        }
+    }
+    return collected;
+}
+
+bool CircularBufferMath::scan_window_values(uint32_t window_ms, bool with_squares, ValueScan* scan_out) const {
+    ValueScan& scan = *scan_out;
+    scan = ValueScan{};
+    int max_samples = calculate_max_samples_for_window(window_ms);
+    if (max_samples == 0) return false;
+    
+    uint32_t window_start = now_us() - window_ms * 1000;
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadSnapshot snapshot = begin_read();
+        const int32_t* runs[2];
+        int lengths[2];
+        int run_count = raw_runs(snapshot, 0, std::min(count_at_or_after(snapshot, window_start), max_samples), runs, lengths);
+        scan = ValueScan{};
+        if (run_count > 0) {
+            // Centered on the newest sample so the int64 squares stay exact
+            scan.center = raw_at(snapshot, 0);
+            scan.reduction = { 0, scan.center, scan.center };
+        }
+        for (int r = 0; r < run_count; r++) {
+            window_kernels::Reduction run = window_kernels::reduce(runs[r], lengths[r]);
+            scan.reduction.sum += run.sum;
+            scan.reduction.min = std::min(scan.reduction.min, run.min);
+            scan.reduction.max = std::max(scan.reduction.max, run.max);
+            if (with_squares) {
+                int64_t sum;
+                int64_t sum_sq;
+                window_kernels::centered_sums(runs[r], lengths[r], scan.center, &sum, &sum_sq);
+                scan.centered_sum += sum;
+                scan.centered_sum_sq += sum_sq;
+            }
+            scan.count += lengths[r];
+        }
+        if (read_is_valid(snapshot)) {
+            break;
+        }
+    }
+    return scan.count > 0;
+}
+
+int32_t CircularBufferMath::apply_outlier_rejection(int32_t* samples, int count) const {
     if (count == 0) return 0;
     if (count == 1) return samples[0];
     if (count == 2) return (samples[0] + samples[1]) / 2;
 
-    // Decide how many to reject from each side
-    int reject_each_side = 1; // (HW_LOADCELL_SAMPLE_RATE_SPS == 80) ? 8 : 1;
+    // Decide how many to reject from each side - scales with window population so
+    // 80 SPS windows trim proportionally (10 SPS windows keep trimming one per side)
+    int reject_each_side = std::max(1, count / 16);
 
     // Not enough samples left -> fallback to median
     if (count <= 2 * reject_each_side) {
-        int32_t* sorted_samples = (int32_t*)alloca(count * sizeof(int32_t));
-        memcpy(sorted_samples, samples, count * sizeof(int32_t));
-        std::sort(sorted_samples, sorted_samples + count);
-        return sorted_samples[count / 2];
+        std::nth_element(samples, samples + count / 2, samples + count);
+        return samples[count / 2];
     }
 
-    // Copy and sort
-    int32_t* sorted_samples = (int32_t*)alloca(count * sizeof(int32_t));
-    memcpy(sorted_samples, samples, count * sizeof(int32_t));
-    std::sort(sorted_samples, sorted_samples + count);
-
-    // Average trimmed values
     int samples_to_average = count - 2 * reject_each_side;
     int64_t sum = 0;
-    for (int i = reject_each_side; i < count - reject_each_side; i++) {
-        sum += sorted_samples[i];
+    if (reject_each_side == 1) {
+        // Under 32 samples: drop the single min and max in one pass
+        window_kernels::Reduction reduction = window_kernels::reduce(samples, count);
+        sum = reduction.sum - ((int64_t)reduction.min + reduction.max);
+    } else {
+        // Partition the extremes out in place (O(n) selection, no full sort):
+        // lowest reject_each_side to the front, then highest to the back
+        int32_t* end = samples + count;
+        std::nth_element(samples, samples + reject_each_side, end);
+        std::nth_element(samples + reject_each_side, end - reject_each_side, end);
+        sum = window_kernels::reduce(samples + reject_each_side, samples_to_average).sum;
     }
 
     return static_cast<int32_t>(sum / samples_to_average);
 }
 
 int CircularBufferMath::calculate_max_samples_for_window(uint32_t window_ms) const {
-    // Estimate max samples
-    int estimated_samples = (window_ms * HW_LOADCELL_SAMPLE_RATE_SPS) / 1000 + 10; // +10 for safety margin
+    // Estimate max samples at the highest rate present in the buffer
+    int estimated_samples = (window_ms * window_rate_sps) / 1000 + 10; // +10 for safety margin
     
-    // Cap at reasonable limits
-    if (estimated_samples > (int)samples_count) {
-        estimated_samples = samples_count;
-    }
-    if (estimated_samples > MAX_BUFFER_SIZE) {
-        estimated_samples = MAX_BUFFER_SIZE;
+    // Cap at reasonable limits (a sample published after this is simply not collected)
+    int available = begin_read().count;
+    if (estimated_samples > available) {
+        estimated_samples = available;
     }
     
     return estimated_samples;
@@ -146,8 +615,10 @@ int32_t CircularBufferMath::get_raw_low_latency() const {
 
 int32_t CircularBufferMath::get_display_raw() {
     // Asymmetric display filter on raw values (fast up, slow down)
-    int32_t current_raw = get_smoothed_raw(300); // 300ms base window
-    
+    return apply_display_filter(get_smoothed_raw(300)); // 300ms base window
+}
+
+int32_t CircularBufferMath::apply_display_filter(int32_t current_raw) {
     if (!display_filter_initialized) {
         display_filtered_raw = current_raw;
         display_filter_initialized = true;
@@ -179,18 +650,83 @@ int32_t CircularBufferMath::get_raw_high_latency() const {
 }
 
 uint32_t CircularBufferMath::get_buffer_time_span_ms() const {
-    if (samples_count < 2) return 0;
-    
-    // Time span from oldest to newest sample
-    uint16_t oldest_index = (samples_count < MAX_BUFFER_SIZE) ? 0 : write_index;
-    uint16_t newest_index = (write_index - 1 + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
+    uint32_t span_us = 0;
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadSnapshot snapshot = begin_read();
+        if (snapshot.count < 2) return 0;
+        
+        // Time span from oldest to newest readable sample
+        span_us = timestamp_at(snapshot, 0) - timestamp_at(snapshot, snapshot.count - 1);
+        if (read_is_valid(snapshot)) {
+            break;
+        }
+    }
+    return span_us / 1000;
+}
+
+uint32_t CircularBufferMath::get_sample_sequence_at(uint32_t timestamp_us) const {
+    ReadSnapshot snapshot = {};
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        snapshot = begin_read_unfloored();
+        int after = count_at_or_after(snapshot, timestamp_us);
+        if (read_is_valid(snapshot)) {
+            return snapshot.end_seq - after;
+        }
+    }
+    return snapshot.end_seq - snapshot.count;   // Still lapping: everything readable is recent
+}
+
+int CircularBufferMath::read_samples_from(uint32_t* next_seq, int32_t* raw_out, uint32_t* timestamps_out,
+                                          int max_samples, uint32_t* lost_out) const {
+    if (!next_seq || !raw_out || !timestamps_out || max_samples <= 0) return 0;
     
-    return circular_buffer[newest_index].timestamp_ms - circular_buffer[oldest_index].timestamp_ms;
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadSnapshot snapshot = begin_read_unfloored();
+        uint32_t oldest_seq = snapshot.end_seq - snapshot.count;
+        uint32_t seq = *next_seq;
+        uint32_t lost = 0;
+        if ((int32_t)(seq - oldest_seq) < 0) {
+            lost = oldest_seq - seq;
+            seq = oldest_seq;
+        }
+        int32_t pending = (int32_t)(snapshot.end_seq - seq);
+        int count = pending > 0 ? std::min<int>(pending, max_samples) : 0;
+        for (int i = 0; i < count; i++) {
+            raw_out[i] = raw_ring.slot(seq + i);
+            timestamps_out[i] = timestamp_ring.slot(seq + i);
+        }
+        if (read_is_valid(snapshot)) {
+            *next_seq = seq + count;
+            if (lost_out) {
+                *lost_out += lost;
+            }
+            return count;
+        }
+    }
+    return 0;
+}
+
+int CircularBufferMath::get_history_samples(uint32_t from_us, uint32_t to_us,
+                                            CompactSampleHistory::Sample* samples_out, int max_samples) const {
+#if HW_LOADCELL_COMPACT_HISTORY_ENABLED
+    return history.read_range(from_us, to_us, clear_floor_seq.load(std::memory_order_acquire), samples_out, max_samples);
+#else
+    return 0;
+#endif
+}
+
+uint32_t CircularBufferMath::get_history_time_span_ms() const {
+#if HW_LOADCELL_COMPACT_HISTORY_ENABLED
+    return history.get_time_span_ms(clear_floor_seq.load(std::memory_order_acquire));
+#else
+    return 0;
+#endif
 }
 
 bool CircularBufferMath::get_window_delta(uint32_t window_ms, int32_t* delta_out,
-                                          uint32_t* span_ms_out, int* samples_out) const {
-    if (!delta_out || samples_count < 2) {
+                                          uint32_t* span_ms_out, int* samples_out,
+                                          uint32_t* span_us_out) const {
+    if (!delta_out || get_sample_count() < 2) {
         if (delta_out) {
             *delta_out = 0;
         }
@@ -200,11 +736,13 @@ bool CircularBufferMath::get_window_delta(uint32_t window_ms, int32_t* delta_out
         if (samples_out) {
             *samples_out = 0;
         }
+        if (span_us_out) {
+            *span_us_out = 0;
+        }
         return false;
     }
 
-    uint32_t current_time = millis();
-    uint32_t window_start = current_time - window_ms;
+    uint32_t window_start = now_us() - window_ms * 1000;
 
     int collected = 0;
     int32_t newest_raw = 0;
@@ -212,22 +750,22 @@ bool CircularBufferMath::get_window_delta(uint32_t window_ms, int32_t* delta_out
     uint32_t newest_ts = 0;
     uint32_t oldest_ts = 0;
 
-    for (int i = 0; i < samples_count; ++i) {
-        uint16_t index = (write_index - 1 - i + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
-        const AdcSample& sample = circular_buffer[index];
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; ++attempt) {
+        ReadSnapshot snapshot = begin_read();
+        collected = 0;
 
-        if (sample.timestamp_ms < window_start) {
-            break;
+        // Only the two window ends matter
+        collected = count_at_or_after(snapshot, window_start);
+        if (collected > 0) {
+            newest_raw = raw_at(snapshot, 0);
+            newest_ts = timestamp_at(snapshot, 0);
+            oldest_raw = raw_at(snapshot, collected - 1);
+            oldest_ts = timestamp_at(snapshot, collected - 1);
         }
 
-        if (collected == 0) {
-            newest_raw = sample.raw_value;
-            newest_ts = sample.timestamp_ms;
+        if (read_is_valid(snapshot)) {
+            break;
         }
-
-        oldest_raw = sample.raw_value;
-        oldest_ts = sample.timestamp_ms;
-        ++collected;
     }
 
     if (samples_out) {
@@ -239,22 +777,198 @@ bool CircularBufferMath::get_window_delta(uint32_t window_ms, int32_t* delta_out
         if (span_ms_out) {
             *span_ms_out = 0;
         }
+        if (span_us_out) {
+            *span_us_out = 0;
+        }
         return false;
     }
 
     *delta_out = newest_raw - oldest_raw;
 
+    // Unsigned subtraction handles the µs clock wrap
+    uint32_t span_us = newest_ts - oldest_ts;
     if (span_ms_out) {
-        if (newest_ts >= oldest_ts) {
-            *span_ms_out = newest_ts - oldest_ts;
-        } else {
-            *span_ms_out = (UINT32_MAX - oldest_ts) + newest_ts + 1;
-        }
+        *span_ms_out = span_us / 1000;
+    }
+    if (span_us_out) {
+        *span_us_out = span_us;
     }
 
     return true;
 }
 
+bool CircularBufferMath::fill_snapshot(RawSnapshot* snapshot) const {
+    if (!snapshot || snapshot->window_count == 0 || snapshot->window_count > SNAPSHOT_MAX_WINDOWS) {
+        return false;
+    }
+    const uint8_t window_count = snapshot->window_count;
+    
+    // Same caps as the individual queries' scratch copies
+    int limits[SNAPSHOT_MAX_WINDOWS];
+    int max_limit = 0;
+    for (uint8_t k = 0; k < window_count; k++) {
+        limits[k] = calculate_max_samples_for_window(snapshot->windows[k].window_ms);
+        max_limit = std::max(max_limit, limits[k]);
+    }
+    SequentialSettleMetrics& settle = snapshot->settle;
+    const int settle_limit = settle.max_window_ms > 0 ? calculate_max_samples_for_window(settle.max_window_ms) : 0;
+    max_limit = std::max(max_limit, settle_limit);
+    if (max_limit == 0) return false;
+    int32_t* values = (int32_t*)alloca(max_limit * sizeof(int32_t));
+    
+    uint32_t now = now_us();
+    uint32_t floor_seq = clear_floor_seq.load(std::memory_order_acquire);
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadSnapshot read = begin_read();
+        if (read.count == 0) return false;
+        
+        int counts[SNAPSHOT_MAX_WINDOWS];
+        int longest = 0;
+        for (uint8_t k = 0; k < window_count; k++) {
+            counts[k] = std::min(count_at_or_after(read, now - snapshot->windows[k].window_ms * 1000), limits[k]);
+            longest = std::max(longest, counts[k]);
+        }
+        const int settle_count = settle_limit > 0
+            ? std::min(count_at_or_after(read, now - settle.max_window_ms * 1000), settle_limit) : 0;
+        longest = std::max(longest, settle_count);
+        
+        const int32_t newest_raw = raw_at(read, 0);
+        const uint32_t newest_us = timestamp_at(read, 0);
+        snapshot->latest_raw = newest_raw;
+        snapshot->latest_timestamp_us = newest_us;
+        for (uint8_t k = 0; k < window_count; k++) {
+            WindowMetrics& metrics = snapshot->windows[k];
+            metrics.sample_count = 0;
+            metrics.smoothed_raw = newest_raw;   // get_smoothed_raw() falls back to the latest sample
+            metrics.std_dev_raw = 0.0f;
+            metrics.flow_rate_raw = 0.0f;
+            metrics.flow_fit_raw = 0.0f;
+            metrics.flow_fit_confidence = 0.0f;
+        }
+        settle.settled = false;
+        settle.window_ms = 0;
+        settle.sample_count = 0;
+        settle.mean_raw = newest_raw;
+        settle.half_width_raw = 0.0f;
+        
+        // One pass newest to oldest; each window is finished as the pass crosses its edge.
+        // Sums are centered on the newest sample so the int64 squares stay exact.
+        const int32_t center = newest_raw;
+        int64_t centered_sum = 0;
+        int64_t centered_sum_sq = 0;
+        int64_t sum_t = 0;              // t in µs relative to the newest sample (<= 0)
+        int64_t sum_tt = 0;
+        int64_t sum_ty = 0;
+        int32_t min_val = newest_raw;
+        int32_t max_val = newest_raw;
+        bool settle_open = settle_count > 0;
+        for (int i = 0; i < longest; i++) {
+            const int32_t raw = raw_at(read, i);
+            const uint32_t sample_us = timestamp_at(read, i);
+            int64_t centered = (int64_t)raw - center;
+            values[i] = raw;
+            int64_t t = (int32_t)(sample_us - newest_us);
+            centered_sum += centered;
+            centered_sum_sq += centered * centered;
+            sum_t += t;
+            sum_tt += t * t;
+            sum_ty += t * centered;
+            min_val = std::min(min_val, raw);
+            max_val = std::max(max_val, raw);
+            
+            const int n = i + 1;
+            for (uint8_t k = 0; k < window_count; k++) {
+                if (counts[k] != n) continue;
+                WindowMetrics& metrics = snapshot->windows[k];
+                metrics.sample_count = n;
+                
+                int64_t sum = centered_sum + (int64_t)center * n;
+                if (n <= 2) {
+                    metrics.smoothed_raw = static_cast<int32_t>(sum / n);
+                } else if (n < 32) {
+                    metrics.smoothed_raw = static_cast<int32_t>((sum - min_val - max_val) / (n - 2));
+                }   // Wider trims are selected after the pass
+                
+                if (n > 1) {
+                    double variance = ((double)centered_sum_sq - (double)centered_sum * centered_sum / n) / (n - 1);
+                    metrics.std_dev_raw = variance > 0.0 ? (float)sqrt(variance) : 0.0f;
+                    
+                    uint32_t time_change_us = newest_us - sample_us;
+                    if (time_change_us > 0) {
+                        metrics.flow_rate_raw = (float)(newest_raw - raw) * 1000000.0f / time_change_us;
+                    }
+                    
+                    RegressionSums sums = { n, sum_t, sum_tt, centered_sum, centered_sum_sq, sum_ty };
+                    solve_regression(sums, &metrics.flow_fit_raw, &metrics.flow_fit_confidence);
+                }
+            }
+            
+            // Sequential settling: while the window stays quiet, every length whose mean is known to
+            // within tolerance (confidence half-width plus the drift left across it) qualifies; the
+            // longest one gives the settled mean
+            if (settle_open && n <= settle_count && n >= std::max<int>(settle.min_samples, 2)) {
+                uint32_t span_us = newest_us - sample_us;
+                if (span_us >= settle.min_window_ms * 1000) {
+                    double variance = ((double)centered_sum_sq - (double)centered_sum * centered_sum / n) / (n - 1);
+                    float std_dev = variance > 0.0 ? (float)sqrt(variance) : 0.0f;
+                    if (std_dev > settle.std_dev_limit_raw) {
+                        settle_open = false;    // Reached the disturbance
+                    } else {
+                        float half_width = settle.z_score * std_dev / sqrtf((float)n);
+                        float slope = 0.0f;
+                        RegressionSums sums = { n, sum_t, sum_tt, centered_sum, centered_sum_sq, sum_ty };
+                        solve_regression(sums, &slope, nullptr);
+                        float drift = fabsf(slope) * span_us / 1000000.0f;
+                        if (half_width + drift <= settle.mean_tolerance_raw) {
+                            settle.settled = true;
+                            settle.window_ms = span_us / 1000;
+                            settle.sample_count = n;
+                            settle.mean_raw = static_cast<int32_t>(center + centered_sum / n);
+                            settle.half_width_raw = half_width;
+                        }
+                    }
+                }
+            }
+        }
+        
+        if (!read_is_valid(read)) {
+            continue;
+        }
+        
+        // Trimmed means needing selection, shortest window first: reordering a prefix
+        // keeps the same values in it, so each longer prefix still holds its window
+        uint8_t order[SNAPSHOT_MAX_WINDOWS];
+        for (uint8_t k = 0; k < window_count; k++) {
+            uint8_t j = k;
+            while (j > 0 && counts[order[j - 1]] > counts[k]) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = k;
+        }
+        for (uint8_t j = 0; j < window_count; j++) {
+            uint8_t k = order[j];
+            if (counts[k] >= 32) {
+                snapshot->windows[k].smoothed_raw = apply_outlier_rejection(values, counts[k]);
+            }
+        }
+        
+        // The same results answer individual queries until the next sample or QUERY_CACHE_MAX_AGE_US
+        for (uint8_t k = 0; k < window_count; k++) {
+            const WindowMetrics& metrics = snapshot->windows[k];
+            uint32_t bits;
+            memcpy(&bits, &metrics.smoothed_raw, sizeof(bits));
+            query_cache_store(CachedQuery::SMOOTHED_RAW, metrics.window_ms, read.end_seq, floor_seq, now, bits);
+            memcpy(&bits, &metrics.std_dev_raw, sizeof(bits));
+            query_cache_store(CachedQuery::STD_DEV_RAW, metrics.window_ms, read.end_seq, floor_seq, now, bits);
+            memcpy(&bits, &metrics.flow_rate_raw, sizeof(bits));
+            query_cache_store(CachedQuery::FLOW_RATE_RAW, metrics.window_ms, read.end_seq, floor_seq, now, bits);
+        }
+        return true;
+    }
+    return false;
+}
+
 bool CircularBufferMath::is_settled(uint32_t window_ms, int32_t threshold_raw_units) const {
     float std_dev = get_standard_deviation_raw(window_ms);
     bool settled = std_dev <= threshold_raw_units;
@@ -266,7 +980,7 @@ bool CircularBufferMath::is_settled(uint32_t window_ms, int32_t threshold_raw_un
         int max_samples = calculate_max_samples_for_window(window_ms);
         if (max_samples > 0) {
             int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
-            int actual_samples = get_samples_in_window(window_ms, samples);
+            int actual_samples = get_samples_in_window(window_ms, samples, max_samples);
             
             // Format raw samples on one line (limit to first 10 samples to avoid spam)
             char sample_str[256] = {0};
@@ -303,41 +1017,33 @@ float CircularBufferMath::get_settling_confidence(uint32_t window_ms) const {
 }
 
 float CircularBufferMath::get_standard_deviation_raw(uint32_t window_ms) const {
-    // Calculate max samples needed
-    int max_samples = calculate_max_samples_for_window(window_ms);
-    if (max_samples == 0) return 0.0f;
-    
-    // Allocate temporary array
-    int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
-    
-    // Get samples within time window
-    int actual_samples = get_samples_in_window(window_ms, samples);
-    
-    return calculate_standard_deviation(samples, actual_samples);
+    return memoize<float>(CachedQuery::STD_DEV_RAW, window_ms, [&] { return compute_standard_deviation_raw(window_ms); });
 }
 
-float CircularBufferMath::calculate_standard_deviation(const int32_t* samples, int count) const {
-    if (count <= 1) return 0.0f;
-    
-    // Calculate mean
-    int64_t sum = 0;
-    for (int i = 0; i < count; i++) {
-        sum += samples[i];
+float CircularBufferMath::compute_standard_deviation_raw(uint32_t window_ms) const {
+    WindowStats stats;
+    if (read_window_stats(window_ms, &stats)) {
+        if (stats.count <= 1) return 0.0f;
+        double n = stats.count;
+        double centered_sum = (double)(stats.sum - (int64_t)stats.center * stats.count);
+        double variance = ((double)stats.sum_sq - centered_sum * centered_sum / n) / (n - 1);
+        return variance > 0.0 ? (float)sqrt(variance) : 0.0f;
     }
-    float mean = (float)sum / count;
     
-    // Calculate variance
-    float variance_sum = 0.0f;
-    for (int i = 0; i < count; i++) {
-        float diff = samples[i] - mean;
-        variance_sum += diff * diff;
-    }
-    
-    float variance = variance_sum / (count - 1);
-    return sqrt(variance);
+    // Exact integer sums centered on the newest sample, so the variance doesn't
+    // lose the small spread of a settled window to float rounding
+    ValueScan scan;
+    if (!scan_window_values(window_ms, true, &scan) || scan.count <= 1) return 0.0f;
+    double variance = ((double)scan.centered_sum_sq - (double)scan.centered_sum * scan.centered_sum / scan.count) /
+                      (scan.count - 1);
+    return variance > 0.0 ? (float)sqrt(variance) : 0.0f;
 }
 
 float CircularBufferMath::get_raw_flow_rate(uint32_t window_ms) const {
+    return memoize<float>(CachedQuery::FLOW_RATE_RAW, window_ms, [&] { return compute_raw_flow_rate(window_ms); });
+}
+
+float CircularBufferMath::compute_raw_flow_rate(uint32_t window_ms) const {
     // Calculate max samples needed
     int max_samples = calculate_max_samples_for_window(window_ms);
     if (max_samples < 2) return 0.0f;
@@ -347,35 +1053,65 @@ float CircularBufferMath::get_raw_flow_rate(uint32_t window_ms) const {
     uint32_t* timestamps = (uint32_t*)alloca(max_samples * sizeof(uint32_t));
     
     // Get samples and timestamps within window
-    int collected = 0;
-    uint32_t current_time = millis();
-    uint32_t window_start = current_time - window_ms;
-    
-    for (int i = 0; i < (int)samples_count && collected < max_samples; i++) {
-        uint16_t index = (write_index - 1 - i + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
-        
-        if (circular_buffer[index].timestamp_ms >= window_start) {
-            samples[collected] = circular_buffer[index].raw_value;
-            timestamps[collected] = circular_buffer[index].timestamp_ms;
-            collected++;
-        } else {
-            break;
-        }
-    }
+    int collected = get_samples_in_window(window_ms, samples, max_samples, timestamps);
     
     if (collected < 2) return 0.0f;
     
     // Simple linear regression for flow rate
     int32_t raw_change = samples[0] - samples[collected - 1]; // Most recent - oldest
-    uint32_t time_change = timestamps[0] - timestamps[collected - 1];
+    uint32_t time_change_us = timestamps[0] - timestamps[collected - 1];
     
-    if (time_change == 0) return 0.0f;
+    if (time_change_us == 0) return 0.0f;
     
     // Return raw units per second
-    return (float)raw_change * 1000.0f / time_change;
+    return (float)raw_change * 1000000.0f / time_change_us;
+}
+
+bool CircularBufferMath::get_raw_flow_regression(uint32_t window_ms, float* rate_out, float* confidence_out) const {
+    if (!rate_out) return false;
+    *rate_out = 0.0f;
+    if (confidence_out) {
+        *confidence_out = 0.0f;
+    }
+    
+    RegressionSums sums = {};
+    WindowStats stats;
+    if (read_window_stats(window_ms, &stats)) {
+        sums.n = stats.count;
+        sums.sum_t = stats.sum_t;
+        sums.sum_tt = stats.sum_tt;
+        sums.sum_y = stats.sum - (int64_t)stats.center * stats.count;
+        sums.sum_yy = stats.sum_sq;
+        sums.sum_ty = stats.sum_ty;
+    } else {
+        int max_samples = calculate_max_samples_for_window(window_ms);
+        if (max_samples < 2) return false;
+        int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
+        uint32_t* timestamps = (uint32_t*)alloca(max_samples * sizeof(uint32_t));
+        int collected = get_samples_in_window(window_ms, samples, max_samples, timestamps);
+        if (collected < 2) return false;
+        
+        // Same integer sums the aggregates keep: t from the oldest sample, y about the newest
+        sums.n = collected;
+        for (int i = 0; i < collected; i++) {
+            int64_t t = (int32_t)(timestamps[i] - timestamps[collected - 1]);
+            int64_t y = (int64_t)samples[i] - samples[0];
+            sums.sum_t += t;
+            sums.sum_tt += t * t;
+            sums.sum_y += y;
+            sums.sum_yy += y * y;
+            sums.sum_ty += t * y;
+        }
+    }
+    return solve_regression(sums, rate_out, confidence_out);
 }
 
 float CircularBufferMath::get_raw_flow_rate_95th_percentile(uint32_t window_ms) const {
+    return memoize<float>(CachedQuery::FLOW_PERCENTILE_RAW, window_ms,
+                          [&] { return compute_raw_flow_rate_95th_percentile(window_ms); });
+}
+
+float CircularBufferMath::compute_raw_flow_rate_95th_percentile(uint32_t window_ms) const {
     // Define parameters for the sub-window analysis
     const uint32_t MIN_SAMPLES_FOR_PERCENTILE = 10;
     const uint32_t SUB_WINDOW_MS = 300;
@@ -384,80 +1120,99 @@ float CircularBufferMath::get_raw_flow_rate_95th_percentile(uint32_t window_ms)
     const int MAX_SUB_WINDOWS = 32;
     const int MIN_SAMPLES_PER_SUB_WINDOW = 3;
 
-    if (samples_count < MIN_SAMPLES_FOR_PERCENTILE) {
+    if (get_sample_count() < MIN_SAMPLES_FOR_PERCENTILE) {
         return get_raw_flow_rate(window_ms); // Fallback for insufficient data
     }
 
     // Ensure the window is large enough to contain a minimum number of samples
-    uint32_t min_window_for_samples = (MIN_SAMPLES_FOR_PERCENTILE * 1000) / HW_LOADCELL_SAMPLE_RATE_SPS;
+    uint32_t min_window_for_samples = (MIN_SAMPLES_FOR_PERCENTILE * 1000) / sample_rate_sps;
     uint32_t effective_window_ms = std::max(window_ms, min_window_for_samples);
 
-    // 1. Collect all relevant samples and timestamps in one go.
+    // 1. Bound the window the way a scratch copy of it would be.
     int max_samples = calculate_max_samples_for_window(effective_window_ms);
     if (max_samples < MIN_SAMPLES_FOR_PERCENTILE) {
         return get_raw_flow_rate(effective_window_ms);
     }
 
-    int32_t* sample_values = (int32_t*)alloca(max_samples * sizeof(int32_t));
-    uint32_t* sample_times = (uint32_t*)alloca(max_samples * sizeof(uint32_t));
-    int collected_samples = 0;
-    uint32_t current_time = millis();
-    uint32_t window_start_time = current_time - effective_window_ms;
-
-    for (int i = 0; i < (int)samples_count && collected_samples < max_samples; ++i) {
-        uint16_t index = (write_index - 1 - i + MAX_BUFFER_SIZE) % MAX_BUFFER_SIZE;
-        if (circular_buffer[index].timestamp_ms >= window_start_time) {
-            // Samples are collected from newest to oldest
-            sample_values[collected_samples] = circular_buffer[index].raw_value;
-            sample_times[collected_samples] = circular_buffer[index].timestamp_ms;
-            collected_samples++;
-        } else {
-            break; // Samples are time-ordered
-        }
-    }
-
-    if (collected_samples < MIN_SAMPLES_FOR_PERCENTILE) {
-        return get_raw_flow_rate(effective_window_ms);
-    }
+    uint32_t current_time = now_us();
+    uint32_t window_start = current_time - effective_window_ms * 1000;
 
-    // 2. Calculate the number of sub-windows and allocate space for their flow rates.
+    // 2. Calculate the number of sub-windows (fixed storage, no stack allocation).
     int num_sub_windows = (effective_window_ms > SUB_WINDOW_MS) ? 1 + (effective_window_ms - SUB_WINDOW_MS) / STEP_MS : 1;
     num_sub_windows = std::max(MIN_SUB_WINDOWS, std::min(MAX_SUB_WINDOWS, num_sub_windows));
-    float* flow_rates = (float*)alloca(num_sub_windows * sizeof(float));
+    float flow_rates[MAX_SUB_WINDOWS];
     int valid_flow_rates_count = 0;
+    int collected_samples = 0;
+    uint32_t floor_seq = clear_floor_seq.load(std::memory_order_acquire);
+    bool window_exceeds_ring = false;
+
+    // 3. Each sub-window's flow rate only needs its two end samples, found by binary
+    // search in the ring (newest first), clipped to the effective window.
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadSnapshot snapshot = begin_read();
+        collected_samples = std::min(count_at_or_after(snapshot, window_start), max_samples);
+        valid_flow_rates_count = 0;
+        // Every readable sample is in the window, yet older visible ones were published
+        window_exceeds_ring = collected_samples == snapshot.count && snapshot.end_seq - floor_seq > snapshot.count;
+
+        for (int i = 0; i < num_sub_windows && collected_samples >= (int)MIN_SAMPLES_FOR_PERCENTILE; ++i) {
+            uint32_t sub_window_end_time = current_time - (i * STEP_MS * 1000);
+            uint32_t sub_window_start_time = sub_window_end_time - SUB_WINDOW_MS * 1000;
 
-    // 3. Iterate through sub-windows and calculate flow rate for each.
-    for (int i = 0; i < num_sub_windows; ++i) {
-        uint32_t sub_window_end_time = current_time - (i * STEP_MS);
-        uint32_t sub_window_start_time = sub_window_end_time - SUB_WINDOW_MS;
-
-        // Find the newest and oldest samples within this sub-window from our collected arrays
-        int newest_idx = -1, oldest_idx = -1;
-        for (int j = 0; j < collected_samples; ++j) {
-            if (sample_times[j] <= sub_window_end_time) {
-                if (newest_idx == -1) newest_idx = j;
-                if (sample_times[j] >= sub_window_start_time) {
-                    oldest_idx = j;
-                } else {
-                    break; // Past the start of the sub-window
+            int newest_idx = count_at_or_after(snapshot, sub_window_end_time + 1);
+            int oldest_idx = std::min(count_at_or_after(snapshot, sub_window_start_time), collected_samples) - 1;
+
+            if (newest_idx < collected_samples && (oldest_idx - newest_idx + 1) >= MIN_SAMPLES_PER_SUB_WINDOW) {
+                uint32_t time_delta_us = timestamp_at(snapshot, newest_idx) - timestamp_at(snapshot, oldest_idx);
+                if (time_delta_us > 0) {
+                    int32_t raw_delta = raw_at(snapshot, newest_idx) - raw_at(snapshot, oldest_idx);
+                    flow_rates[valid_flow_rates_count++] = (float)raw_delta * 1000000.0f / time_delta_us;
                 }
             }
         }
 
-        if (newest_idx != -1 && oldest_idx != -1 && (oldest_idx - newest_idx + 1) >= MIN_SAMPLES_PER_SUB_WINDOW) {
-            uint32_t time_delta = sample_times[newest_idx] - sample_times[oldest_idx];
-            if (time_delta > 0) {
-                int32_t raw_delta = sample_values[newest_idx] - sample_values[oldest_idx];
-                flow_rates[valid_flow_rates_count++] = (float)raw_delta * 1000.0f / time_delta;
+        if (read_is_valid(snapshot)) {
+            break;
+        }
+    }
+
+#if HW_LOADCELL_COMPACT_HISTORY_ENABLED
+    // 3b. A window reaching past the ring takes its end samples from the compact history
+    if (window_exceeds_ring) {
+        valid_flow_rates_count = 0;
+        for (int i = 0; i < num_sub_windows; ++i) {
+            uint32_t sub_window_end_time = current_time - (i * STEP_MS * 1000);
+            uint32_t sub_window_start_time = sub_window_end_time - SUB_WINDOW_MS * 1000;
+            if (!is_at_or_after(sub_window_start_time, window_start)) {
+                sub_window_start_time = window_start;
+            }
+
+            CompactSampleHistory::Sample newest;
+            CompactSampleHistory::Sample oldest;
+            if (history.find_at_or_before(sub_window_end_time, floor_seq, &newest) &&
+                history.find_at_or_after(sub_window_start_time, floor_seq, &oldest) &&
+                (int32_t)(newest.seq - oldest.seq) + 1 >= MIN_SAMPLES_PER_SUB_WINDOW) {
+                uint32_t time_delta_us = newest.timestamp_us - oldest.timestamp_us;
+                if (time_delta_us > 0) {
+                    int32_t raw_delta = newest.raw_value - oldest.raw_value;
+                    flow_rates[valid_flow_rates_count++] = (float)raw_delta * 1000000.0f / time_delta_us;
+                }
             }
         }
     }
+#else
+    (void)window_exceeds_ring;
+#endif
+
+    if (collected_samples < (int)MIN_SAMPLES_FOR_PERCENTILE) {
+        return get_raw_flow_rate(effective_window_ms);
+    }
 
     // 4. Calculate the 95th percentile from the collected flow rates.
     if (valid_flow_rates_count >= MIN_SAMPLES_PER_SUB_WINDOW) {
-        std::sort(flow_rates, flow_rates + valid_flow_rates_count);
         int percentile_95_index = static_cast<int>(valid_flow_rates_count * 0.95f);
         percentile_95_index = std::min(percentile_95_index, valid_flow_rates_count - 1);
+        std::nth_element(flow_rates, flow_rates + percentile_95_index, flow_rates + valid_flow_rates_count);
         return flow_rates[percentile_95_index];
     }
 
@@ -476,39 +1231,31 @@ bool CircularBufferMath::raw_flowrate_is_stable(uint32_t window_ms) const {
 }
 
 int32_t CircularBufferMath::get_min_raw(uint32_t window_ms) const {
-    int max_samples = calculate_max_samples_for_window(window_ms);
-    if (max_samples == 0) return 0;
-    
-    int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
-    int actual_samples = get_samples_in_window(window_ms, samples);
-    
-    if (actual_samples == 0) return 0;
-    
-    int32_t min_val = samples[0];
-    for (int i = 1; i < actual_samples; i++) {
-        if (samples[i] < min_val) {
-            min_val = samples[i];
-        }
+    return memoize<int32_t>(CachedQuery::MIN_RAW, window_ms, [&] { return compute_min_raw(window_ms); });
+}
+
+int32_t CircularBufferMath::compute_min_raw(uint32_t window_ms) const {
+    WindowStats stats;
+    if (read_window_stats(window_ms, &stats)) {
+        return stats.min_raw;
     }
-    return min_val;
+    
+    ValueScan scan;
+    return scan_window_values(window_ms, false, &scan) ? scan.reduction.min : 0;
 }
 
 int32_t CircularBufferMath::get_max_raw(uint32_t window_ms) const {
-    int max_samples = calculate_max_samples_for_window(window_ms);
-    if (max_samples == 0) return 0;
-    
-    int32_t* samples = (int32_t*)alloca(max_samples * sizeof(int32_t));
-    int actual_samples = get_samples_in_window(window_ms, samples);
-    
-    if (actual_samples == 0) return 0;
-    
-    int32_t max_val = samples[0];
-    for (int i = 1; i < actual_samples; i++) {
-        if (samples[i] > max_val) {
-            max_val = samples[i];
-        }
+    return memoize<int32_t>(CachedQuery::MAX_RAW, window_ms, [&] { return compute_max_raw(window_ms); });
+}
+
+int32_t CircularBufferMath::compute_max_raw(uint32_t window_ms) const {
+    WindowStats stats;
+    if (read_window_stats(window_ms, &stats)) {
+        return stats.max_raw;
     }
-    return max_val;
+    
+    ValueScan scan;
+    return scan_window_values(window_ms, false, &scan) ? scan.reduction.max : 0;
 }
 
 void CircularBufferMath::reset_display_filter() {
@@ -517,14 +1264,10 @@ void CircularBufferMath::reset_display_filter() {
 }
 
 void CircularBufferMath::clear_all_samples() {
-    write_index = 0;
-    samples_count = 0;
+    // Hide everything published so far; the producer's write position is untouched,
+    // so tare/calibration on other tasks can clear without racing add_sample()
+    clear_floor_seq.store(publish_seq.load(std::memory_order_acquire), std::memory_order_release);
     display_filter_initialized = false;
     flow_stability_initialized = false;
-    
-    // Clear buffer
-    for (uint16_t i = 0; i < MAX_BUFFER_SIZE; i++) {
-        circular_buffer[i].raw_value = 0;
-        circular_buffer[i].timestamp_ms = 0;
-    }
+    window_rate_sps = sample_rate_sps;
 }
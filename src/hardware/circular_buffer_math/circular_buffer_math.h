@@ -2,7 +2,42 @@
 
 #include <Arduino.h>
 #include <algorithm>
+#include <atomic>
+#include <string.h>
 #include "../../config/constants.h"
+#include "../ring.h"
+#include "../sample_sequence_source.h"
+#include "compact_sample_history.h"
+#include "window_kernels.h"
+
+// Windows with incrementally maintained aggregates (see CircularBufferMath::add_sample)
+namespace circular_buffer_aggregates {
+constexpr uint16_t WINDOWS_MS[] = { 50, 100, 200, 250, 300, 500, 1500 };  // Ascending
+constexpr uint8_t WINDOW_COUNT = sizeof(WINDOWS_MS) / sizeof(WINDOWS_MS[0]);
+constexpr uint32_t MAX_ADC_RATE_SPS = HW_NAU7802_SAMPLE_RATE_HIGH_SPS > HW_LOADCELL_SAMPLE_RATE_HIGH_SPS ?
+                                      HW_NAU7802_SAMPLE_RATE_HIGH_SPS : HW_LOADCELL_SAMPLE_RATE_HIGH_SPS;
+#if HW_LOADCELL_DECIMATION_ENABLED
+// A decimated ring runs below twice the target (SampleDecimator rounds the factor down)
+constexpr uint32_t MAX_RATE_SPS = MAX_ADC_RATE_SPS < 2 * HW_LOADCELL_DECIMATION_TARGET_SPS ?
+                                  MAX_ADC_RATE_SPS : 2 * HW_LOADCELL_DECIMATION_TARGET_SPS;
+#else
+constexpr uint32_t MAX_RATE_SPS = MAX_ADC_RATE_SPS;
+#endif
+
+// Deque capacity: window population at the fastest ADC rate, rounded up to a power of two
+constexpr uint16_t capacity_for(uint16_t window_ms) {
+    uint32_t needed = (uint32_t)window_ms * MAX_RATE_SPS / 1000 + 8;
+    uint16_t capacity = 16;
+    while (capacity < needed) capacity <<= 1;
+    return capacity;
+}
+
+constexpr uint16_t pool_size() {
+    uint16_t total = 0;
+    for (uint8_t i = 0; i < WINDOW_COUNT; i++) total += capacity_for(WINDOWS_MS[i]);
+    return total;
+}
+}
 
 /**
  * CircularBufferMath - Generic time-based mathematical operations on raw ADC data
@@ -22,8 +57,10 @@
  * - Outlier rejection using min/max removal
  * - Statistical analysis capabilities
  * - Ready for 10 SPS to 80+ SPS operation without code changes
+ * - Single-producer / multi-reader safe without locks: WeightSamplingTask is the
+ *   only writer, grind control and UI read concurrently from the other tasks
  */
-class CircularBufferMath {
+class CircularBufferMath : public SampleSequenceSource {
 public:
     
     struct RawDataReading {
@@ -33,19 +70,206 @@ public:
         bool timeout_occurred;   // True if settled due to timeout
     };
     
-private:
-    struct AdcSample {
-        int32_t raw_value;       // Raw signed ADC reading (e.g., 24-bit HX711)
-        uint32_t timestamp_ms;   // Sample timestamp
+    // Per-window results of fill_snapshot(); each matches the individual query
+    static const uint8_t SNAPSHOT_MAX_WINDOWS = 8;
+    struct WindowMetrics {
+        uint32_t window_ms;      // In: window length
+        uint16_t sample_count;
+        int32_t smoothed_raw;    // get_smoothed_raw()
+        float std_dev_raw;       // get_standard_deviation_raw()
+        float flow_rate_raw;     // get_raw_flow_rate(), raw units per second
+        float flow_fit_raw;      // get_raw_flow_regression() slope, raw units per second
+        float flow_fit_confidence;
+    };
+    // Sequential settling over the newest samples, evaluated in the same pass:
+    // the shortest window (>= min_window_ms) whose spread is below std_dev_limit_raw,
+    // whose drift stays inside mean_tolerance_raw and whose mean is known to within
+    // mean_tolerance_raw at z_score (z * s / sqrt(n)). Disabled when max_window_ms == 0.
+    struct SequentialSettleMetrics {
+        uint32_t min_window_ms;    // In
+        uint32_t max_window_ms;    // In: longest window tried
+        uint16_t min_samples;      // In
+        float std_dev_limit_raw;   // In
+        float mean_tolerance_raw;  // In
+        float z_score;             // In
+        bool settled;
+        uint32_t window_ms;        // Span of the deciding window
+        uint16_t sample_count;
+        int32_t mean_raw;
+        float half_width_raw;      // Confidence half-width of mean_raw
+    };
+    struct RawSnapshot {
+        uint8_t window_count;                          // In: entries used in windows[]
+        WindowMetrics windows[SNAPSHOT_MAX_WINDOWS];
+        SequentialSettleMetrics settle;                // In/out, see above
+        int32_t latest_raw;
+        uint32_t latest_timestamp_us;
     };
     
+private:
     // Large fixed buffer - sized for 10+ seconds at 80 SPS = 800+ samples
     // Using 1024 for power-of-2 efficiency and future headroom
     static const uint16_t MAX_BUFFER_SIZE = 1024;
     
-    AdcSample circular_buffer[MAX_BUFFER_SIZE];
-    uint16_t write_index;
-    uint16_t samples_count;
+    // Readers never see the oldest READER_GUARD_SLOTS slots, so a scan stays valid
+    // until the writer has published that many samples behind its back
+    static const uint16_t READER_GUARD_SLOTS = 32;
+    static const uint16_t READABLE_CAPACITY = MAX_BUFFER_SIZE - READER_GUARD_SLOTS;
+    static const int MAX_READ_RETRIES = 4;
+    
+    // Structure of arrays, both indexed by publish sequence (slot()); the rings' own
+    // counts are unused. Window edges are found on the timestamps alone, and
+    // value-only reductions (sum, min/max, variance) run over dense int32 runs
+    // that the window kernels load four lanes at a time.
+    Ring<int32_t, MAX_BUFFER_SIZE> raw_ring;         // Raw signed ADC reading (e.g., 24-bit HX711)
+    Ring<uint32_t, MAX_BUFFER_SIZE> timestamp_ring;  // Capture time, low 32 bits of esp_timer (wraps every ~71 min)
+    
+    // Seqlock-style publication: publish_seq counts samples ever written and is
+    // only stored by the producer, after the slot is filled. Write position and
+    // fill level both derive from this one atomic, so they can't tear.
+    std::atomic<uint32_t> publish_seq;
+    std::atomic<uint32_t> clear_floor_seq;   // publish_seq at the last clear; older samples are hidden
+    
+    struct ReadSnapshot {
+        uint32_t end_seq;       // One past the newest published sample
+        uint16_t count;         // Readable samples, newest first
+    };
+    ReadSnapshot begin_read() const;
+    ReadSnapshot begin_read_unfloored() const;   // Ignores clear_floor_seq (recording)
+    bool read_is_valid(const ReadSnapshot& snapshot) const;
+    // Number of newest-first samples at/after timestamp_us (binary search)
+    int count_at_or_after(const ReadSnapshot& snapshot, uint32_t timestamp_us) const;
+    int32_t raw_at(const ReadSnapshot& snapshot, int newest_offset) const {
+        return raw_ring.slot(snapshot.end_seq - 1 - newest_offset);
+    }
+    uint32_t timestamp_at(const ReadSnapshot& snapshot, int newest_offset) const {
+        return timestamp_ring.slot(snapshot.end_seq - 1 - newest_offset);
+    }
+    // Raw values at newest-first offsets [first, last) as contiguous runs, oldest
+    // first: one, or two where the ring wraps. Returns the run count (0 if empty).
+    int raw_runs(const ReadSnapshot& snapshot, int first, int last, const int32_t* runs[2], int lengths[2]) const;
+    
+    // Incrementally maintained aggregates for the windows the control loop and UI
+    // query every tick. add_sample() updates them in amortized O(1): running sum,
+    // sum of squares (about a per-window center, exact in int64), least-squares
+    // time sums (µs from a moving origin) and monotonic min/max deques of buffer
+    // sequence numbers. Windows end at the newest sample.
+    static_assert(circular_buffer_aggregates::capacity_for(
+                      circular_buffer_aggregates::WINDOWS_MS[circular_buffer_aggregates::WINDOW_COUNT - 1]) < READABLE_CAPACITY,
+                  "aggregate windows must fit the readable ring");
+    
+    struct WindowStats {
+        uint16_t count;
+        bool truncated;          // Deque capacity dropped in-window samples (ADC faster than planned)
+        int32_t center;          // Reference value for sum_sq
+        int64_t sum;             // Sum of raw values
+        int64_t sum_sq;          // Sum of (raw - center)^2
+        int32_t min_raw;
+        int32_t max_raw;
+        uint32_t oldest_seq;
+        uint32_t newest_timestamp_us;
+        uint32_t time_origin_us; // t = timestamp - origin, rebased as the window slides
+        int64_t sum_t;
+        int64_t sum_tt;
+        int64_t sum_ty;          // Sum of t * (raw - center)
+    };
+    
+    struct MonotonicDeque {
+        uint32_t* seqs;          // Slice of aggregate_seq_pool
+        uint16_t mask;
+        uint16_t head;
+        uint16_t size;
+    };
+    
+    struct WindowAggregate {
+        uint32_t window_us;
+        // Producer-only working state
+        WindowStats working;
+        MonotonicDeque min_deque;
+        MonotonicDeque max_deque;
+        uint16_t capacity;
+        // Seqlock-published copy of working: odd version = update in progress
+        std::atomic<uint32_t> version;
+        WindowStats published;
+    };
+    
+#if HW_LOADCELL_COMPACT_HISTORY_ENABLED
+    // Same stream at ~4.5 bytes/sample for queries reaching past the ring
+    CompactSampleHistory history;
+#endif
+    
+    WindowAggregate aggregates[circular_buffer_aggregates::WINDOW_COUNT];
+    uint32_t aggregate_seq_pool[2 * circular_buffer_aggregates::pool_size()];
+    
+    void update_aggregate(WindowAggregate& aggregate, uint32_t seq, uint32_t floor_seq);
+    void evict_oldest(WindowAggregate& aggregate);
+    bool read_window_stats(uint32_t window_ms, WindowStats* stats_out) const;
+    
+    // Memoized query results per (query, window), valid while publish_seq and the
+    // clear floor are unchanged - repeat calls between two samples (UI, diagnostics
+    // and control asking for the same window) become a lookup. Windows end at now_us(),
+    // so an entry also expires after QUERY_CACHE_MAX_AGE_US: during an ADC stall the
+    // samples it covered age out of the window like they do uncached. Direct-mapped
+    // slots; any task may fill one, a per-slot seqlock taken by CAS keeps entries whole.
+    enum class CachedQuery : uint8_t {
+        SMOOTHED_RAW,
+        STD_DEV_RAW,
+        FLOW_RATE_RAW,
+        FLOW_PERCENTILE_RAW,
+        MIN_RAW,
+        MAX_RAW,
+    };
+    struct QueryCacheEntry {
+        std::atomic<uint32_t> version;   // Odd while a task is writing the entry
+        uint32_t end_seq;
+        uint32_t floor_seq;
+        uint32_t window_ms;
+        uint32_t computed_us;            // now_us() the window was anchored at
+        uint32_t value_bits;             // int32_t or float result
+        CachedQuery query;
+    };
+    static const uint8_t QUERY_CACHE_SLOTS = 32;
+    static const uint32_t QUERY_CACHE_MAX_AGE_US = 2000;   // Under one sample period at every ADC rate (320 SPS: 3.1 ms)
+    mutable QueryCacheEntry query_cache[QUERY_CACHE_SLOTS];
+    
+    static uint8_t query_cache_slot(CachedQuery query, uint32_t window_ms);
+    bool query_cache_lookup(CachedQuery query, uint32_t window_ms, uint32_t end_seq, uint32_t floor_seq,
+                            uint32_t now, uint32_t* value_bits_out) const;
+    void query_cache_store(CachedQuery query, uint32_t window_ms, uint32_t end_seq, uint32_t floor_seq,
+                           uint32_t computed_us, uint32_t value_bits) const;
+    
+    template <typename T, typename Compute>
+    T memoize(CachedQuery query, uint32_t window_ms, Compute compute) const {
+        static_assert(sizeof(T) == sizeof(uint32_t), "cached results are 32-bit");
+        // Key before computing: a sample or clear landing meanwhile only makes the entry stale-keyed
+        uint32_t floor_seq = clear_floor_seq.load(std::memory_order_acquire);
+        uint32_t end_seq = publish_seq.load(std::memory_order_acquire);
+        uint32_t now = now_us();
+        uint32_t bits;
+        T value;
+        if (query_cache_lookup(query, window_ms, end_seq, floor_seq, now, &bits)) {
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        value = compute();
+        memcpy(&bits, &value, sizeof(bits));
+        query_cache_store(query, window_ms, end_seq, floor_seq, now, bits);
+        return value;
+    }
+    
+    // Uncached query bodies behind the memoized public getters (HotPathBenchmark times both)
+    friend class HotPathBenchmark;
+    int32_t compute_smoothed_raw(uint32_t window_ms) const;
+    float compute_standard_deviation_raw(uint32_t window_ms) const;
+    float compute_raw_flow_rate(uint32_t window_ms) const;
+    float compute_raw_flow_rate_95th_percentile(uint32_t window_ms) const;
+    int32_t compute_min_raw(uint32_t window_ms) const;
+    int32_t compute_max_raw(uint32_t window_ms) const;
+    
+    // Live ADC sample rate, plus the highest rate used since the last clear
+    // (window sizing must cover samples taken before a switch down)
+    uint32_t sample_rate_sps;
+    uint32_t window_rate_sps;
     
     // For asymmetric display filtering (fast up, slow down) on raw values
     int32_t display_filtered_raw;
@@ -55,18 +279,36 @@ private:
     mutable uint32_t flow_stable_since_ms;  // When flow rate first became stable
     mutable bool flow_stability_initialized;
     
+    // Value-only pass over a window straight from raw_ring (no copy)
+    struct ValueScan {
+        int count;
+        window_kernels::Reduction reduction;   // Sum, min and max
+        int32_t center;                        // Newest value
+        int64_t centered_sum;                  // Of (value - center), with_squares only
+        int64_t centered_sum_sq;
+    };
+    bool scan_window_values(uint32_t window_ms, bool with_squares, ValueScan* scan_out) const;
+    
     // Helper methods - using dynamic arrays based on window size
-    int get_samples_in_window(uint32_t window_ms, int32_t* samples_out) const;
-    int32_t apply_outlier_rejection(const int32_t* samples, int count) const;
-    float calculate_standard_deviation(const int32_t* samples, int count) const;
+    int get_samples_in_window(uint32_t window_ms, int32_t* samples_out, int max_samples,
+                              uint32_t* timestamps_out = nullptr) const;
+    int copy_window_values(uint32_t window_ms, int32_t* values_out, int max_samples) const;  // Oldest first, bulk copies
+    int32_t apply_outlier_rejection(int32_t* samples, int count) const;   // Trimmed mean; reorders samples
     int32_t get_latest_sample() const;
     int calculate_max_samples_for_window(uint32_t window_ms) const;
     
+    // Window membership on the wrapping µs clock (valid for windows < ~35 min)
+    static uint32_t now_us();
+    static bool is_at_or_after(uint32_t timestamp_us, uint32_t reference_us) {
+        return (int32_t)(timestamp_us - reference_us) >= 0;
+    }
+    
 public:
     CircularBufferMath();
     
-    // Core data input - called from LoadCell::sample_and_feed_filter()
-    void add_sample(int32_t raw_adc_value, uint32_t timestamp_ms);
+    // Core data input - called from LoadCell::sample_and_feed_filter() (single producer)
+    // timestamp_us is the esp_timer capture time (truncated to 32 bits)
+    void add_sample(int32_t raw_adc_value, uint32_t timestamp_us);
     
     // Unified smoothing method on raw data
     int32_t get_smoothed_raw(uint32_t window_ms) const;
@@ -75,13 +317,44 @@ public:
     int32_t get_instant_raw() const;           // Latest single sample
     int32_t get_raw_low_latency() const;       // 50ms window - for real-time control  
     int32_t get_display_raw();                 // 250ms window + asymmetric filter - for UI
+    int32_t apply_display_filter(int32_t smoothed_raw); // Display filter step on a 300ms smoothed value
     int32_t get_raw_high_latency() const;      // 250ms window - for final measurements
     bool get_window_delta(uint32_t window_ms, int32_t* delta_out,
-                          uint32_t* span_ms_out = nullptr, int* samples_out = nullptr) const;
+                          uint32_t* span_ms_out = nullptr, int* samples_out = nullptr,
+                          uint32_t* span_us_out = nullptr) const;
+    
+    // Sample rate tracking - set by WeightSensor when the ADC rate changes
+    void set_sample_rate(uint32_t sps);
+    uint32_t get_sample_rate() const override { return sample_rate_sps; }
     
     // Raw access for diagnostics
-    uint16_t get_sample_count() const { return samples_count; }
+    uint16_t get_sample_count() const { return begin_read().count; }
     uint32_t get_buffer_time_span_ms() const;
+    uint32_t get_latest_sample_time_us() const override;
+    
+    // Timeline queries against external event timestamps (same esp_timer µs clock,
+    // e.g. motor edges): first sample at/after an event, and the mean before one
+    bool get_raw_at_time_us(uint32_t timestamp_us, int32_t* raw_out, uint32_t* sample_time_us_out = nullptr) const;
+    bool get_smoothed_raw_before_us(uint32_t end_us, uint32_t window_ms, int32_t* raw_out) const;
+    
+    // Long-range history beyond the ring (post-grind analysis), oldest first; samples
+    // hidden by clear_all_samples() are skipped. 0 if HW_LOADCELL_COMPACT_HISTORY_ENABLED is off.
+    int get_history_samples(uint32_t from_us, uint32_t to_us, CompactSampleHistory::Sample* samples_out,
+                            int max_samples) const;
+    uint32_t get_history_time_span_ms() const;
+    
+    // In-order access to every published sample for recording (session ADC capture).
+    // Sequences count samples ever added; clear_all_samples() does not hide samples
+    // here, raw values do not depend on tare. read_samples_from() copies oldest first
+    // from *next_seq and advances it; samples the ring overwrote before they were read
+    // are skipped and added to *lost_out.
+    uint32_t get_sample_sequence_at(uint32_t timestamp_us) const override;   // First readable sample at/after timestamp_us
+    int read_samples_from(uint32_t* next_seq, int32_t* raw_out, uint32_t* timestamps_out, int max_samples,
+                          uint32_t* lost_out) const override;
+    
+    // All metrics for several windows from one consistent read of the ring in a
+    // single newest-first pass (the grind loop's per-tick set). False if empty.
+    bool fill_snapshot(RawSnapshot* snapshot) const;
     
     // Settling analysis - window_ms based with raw value threshold
     bool is_settled(uint32_t window_ms, int32_t threshold_raw_units) const;
@@ -89,15 +362,18 @@ public:
     
     // Flow rate calculation in raw units per second with configurable time window
     float get_raw_flow_rate(uint32_t window_ms = 200) const;      // Default 200ms window
-    float get_raw_flow_rate_95th_percentile(uint32_t window_ms = 200) const; // 95th percentile
+    float get_raw_flow_rate_95th_percentile(uint32_t window_ms = 200) const; // 95th percentile (reaches into the history)
+    // Least-squares slope over the window (raw units/s) with R^2 as fit confidence
+    // (0-1, residual-based); O(1) for circular_buffer_aggregates::WINDOWS_MS
+    bool get_raw_flow_regression(uint32_t window_ms, float* rate_out, float* confidence_out = nullptr) const;
     bool raw_flowrate_is_stable(uint32_t window_ms = 100) const;  // Check if flow rate stable
     
-    // Statistical operations on raw data
+    // Statistical operations on raw data (O(1) for circular_buffer_aggregates::WINDOWS_MS)
     float get_standard_deviation_raw(uint32_t window_ms) const;
     int32_t get_min_raw(uint32_t window_ms) const;
     int32_t get_max_raw(uint32_t window_ms) const;
     
-    // Reset functions
+    // Reset functions - clear_all_samples() only moves the read floor, so any task may call it
     void reset_display_filter();
     void clear_all_samples();
 };
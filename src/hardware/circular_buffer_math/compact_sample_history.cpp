@@ -0,0 +1,204 @@
+#include "compact_sample_history.h"
+
+CompactSampleHistory::CompactSampleHistory()
+    : publish_state(0), write_block_seq(0), write_entries(0), write_last_timestamp_us(0) {
+    blocks.wipe();
+}
+
+void CompactSampleHistory::add_sample(int32_t raw_value, uint32_t timestamp_us, uint32_t seq) {
+    // Append to the open block while the step and offset fit their 16 bits
+    if (write_entries > 0 && write_entries < SAMPLES_PER_BLOCK) {
+        Block& block = blocks.slot(write_block_seq);
+        uint32_t step_us = timestamp_us - write_last_timestamp_us;
+        uint32_t step_units = (step_us + (1u << (TIME_UNIT_SHIFT - 1))) >> TIME_UNIT_SHIFT;
+        int32_t offset = raw_value - block.base_raw;
+        if (seq == block.first_seq + write_entries && (int32_t)step_us >= 0 && step_units <= UINT16_MAX &&
+            offset >= INT16_MIN && offset <= INT16_MAX) {
+            block.step_units[write_entries] = (uint16_t)step_units;
+            block.offset_raw[write_entries] = (int16_t)offset;
+            write_entries++;
+            block.count = write_entries;
+            // Track the decoded time so rounding never accumulates
+            write_last_timestamp_us += step_units << TIME_UNIT_SHIFT;
+            publish_state.store((write_block_seq << ENTRY_BITS) | write_entries, std::memory_order_release);
+            return;
+        }
+    }
+
+    // Start a new block based on this sample (its slot is never readable, see blocks_intact())
+    if (write_entries > 0) {
+        write_block_seq = (write_block_seq + 1) & BLOCK_SEQ_MASK;
+    }
+    Block& block = blocks.slot(write_block_seq);
+    block.base_timestamp_us = timestamp_us;
+    block.base_raw = raw_value;
+    block.first_seq = seq;
+    block.count = 1;
+    block.step_units[0] = 0;
+    block.offset_raw[0] = 0;
+    write_entries = 1;
+    write_last_timestamp_us = timestamp_us;
+    publish_state.store((write_block_seq << ENTRY_BITS) | write_entries, std::memory_order_release);
+}
+
+bool CompactSampleHistory::begin_read(ReadView* view) const {
+    uint32_t state = publish_state.load(std::memory_order_acquire);
+    if (state == 0) {
+        return false;
+    }
+    view->newest_block = state >> ENTRY_BITS;
+    view->newest_entries = (uint8_t)(state & ((1u << ENTRY_BITS) - 1));
+    // The slot after the newest block is the one the producer overwrites next, and
+    // READER_GUARD_BLOCKS more give a read time to finish. Right after the block
+    // counter wraps (months of uptime) only the blocks since the wrap are visible.
+    const uint32_t readable = blocks.CAPACITY - 1 - READER_GUARD_BLOCKS;
+    uint32_t started = view->newest_block + 1;
+    view->block_count = started < readable ? started : readable;
+    return true;
+}
+
+bool CompactSampleHistory::blocks_intact(const ReadView& view) const {
+    // Block reads above must complete before re-checking the producer position
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t newest_now = publish_state.load(std::memory_order_relaxed) >> ENTRY_BITS;
+    uint32_t advanced = (newest_now - view.newest_block) & BLOCK_SEQ_MASK;
+    return advanced <= READER_GUARD_BLOCKS;
+}
+
+uint8_t CompactSampleHistory::entries_in(const ReadView& view, uint32_t block_age) const {
+    return block_age == 0 ? view.newest_entries : block_at(view, block_age).count;
+}
+
+uint32_t CompactSampleHistory::block_containing(const ReadView& view, uint32_t timestamp_us) const {
+    // Block bases get older with age: first age whose base is at/before timestamp_us
+    uint32_t low = 0;
+    uint32_t high = view.block_count;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        if (is_at_or_after(timestamp_us, block_at(view, mid).base_timestamp_us)) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;   // block_count if timestamp_us predates every block
+}
+
+bool CompactSampleHistory::find_at_or_before(uint32_t timestamp_us, uint32_t floor_seq, Sample* sample_out) const {
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadView view;
+        if (!begin_read(&view)) {
+            return false;
+        }
+
+        bool found = false;
+        uint32_t age = block_containing(view, timestamp_us);
+        if (age < view.block_count) {
+            const Block& block = block_at(view, age);
+            uint8_t entries = entries_in(view, age);
+            uint32_t t = block.base_timestamp_us;
+            uint8_t last = 0;
+            for (uint8_t i = 1; i < entries; i++) {
+                uint32_t next_t = t + ((uint32_t)block.step_units[i] << TIME_UNIT_SHIFT);
+                if (!is_at_or_after(timestamp_us, next_t)) {
+                    break;
+                }
+                t = next_t;
+                last = i;
+            }
+            uint32_t seq = block.first_seq + last;
+            // Anything older is hidden as well
+            found = is_visible(seq, floor_seq);
+            if (found && sample_out) {
+                sample_out->raw_value = block.base_raw + block.offset_raw[last];
+                sample_out->timestamp_us = t;
+                sample_out->seq = seq;
+            }
+        }
+
+        if (blocks_intact(view)) {
+            return found;
+        }
+    }
+    return false;
+}
+
+bool CompactSampleHistory::find_at_or_after(uint32_t timestamp_us, uint32_t floor_seq, Sample* sample_out) const {
+    return read_range(timestamp_us, timestamp_us + INT32_MAX, floor_seq, sample_out, 1) == 1;
+}
+
+int CompactSampleHistory::read_range(uint32_t from_us, uint32_t to_us, uint32_t floor_seq,
+                                     Sample* samples_out, int max_samples) const {
+    if (max_samples <= 0) {
+        return 0;
+    }
+
+    int collected = 0;
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadView view;
+        if (!begin_read(&view)) {
+            return 0;
+        }
+        collected = 0;
+
+        // Start in the block holding from_us (or the oldest block), then decode forward
+        uint32_t start_age = block_containing(view, from_us);
+        if (start_age >= view.block_count) {
+            start_age = view.block_count - 1;
+        }
+        bool done = false;
+        for (uint32_t age = start_age + 1; age-- > 0 && !done;) {
+            const Block& block = block_at(view, age);
+            uint8_t entries = entries_in(view, age);
+            uint32_t t = block.base_timestamp_us;
+            for (uint8_t i = 0; i < entries; i++) {
+                t += (uint32_t)block.step_units[i] << TIME_UNIT_SHIFT;
+                if (!is_at_or_after(t, from_us) || !is_visible(block.first_seq + i, floor_seq)) {
+                    continue;
+                }
+                if (!is_at_or_after(to_us, t)) {
+                    done = true;
+                    break;
+                }
+                Sample& sample = samples_out[collected++];
+                sample.raw_value = block.base_raw + block.offset_raw[i];
+                sample.timestamp_us = t;
+                sample.seq = block.first_seq + i;
+                if (collected == max_samples) {
+                    done = true;
+                    break;
+                }
+            }
+        }
+
+        if (blocks_intact(view)) {
+            return collected;
+        }
+    }
+    return 0;
+}
+
+uint32_t CompactSampleHistory::get_time_span_ms(uint32_t floor_seq) const {
+    uint32_t newest_us = 0;
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        ReadView view;
+        if (!begin_read(&view)) {
+            return 0;
+        }
+        const Block& block = block_at(view, 0);
+        newest_us = block.base_timestamp_us;
+        for (uint8_t i = 1; i < view.newest_entries; i++) {
+            newest_us += (uint32_t)block.step_units[i] << TIME_UNIT_SHIFT;
+        }
+        if (blocks_intact(view)) {
+            break;
+        }
+    }
+
+    // Oldest visible sample: anything at/after the oldest span the clock can express
+    Sample oldest;
+    if (!find_at_or_after(newest_us - INT32_MAX, floor_seq, &oldest)) {
+        return 0;
+    }
+    return (newest_us - oldest.timestamp_us) / 1000;
+}
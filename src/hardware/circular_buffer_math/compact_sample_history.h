@@ -0,0 +1,94 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "../../config/constants.h"
+#include "../ring.h"
+
+/**
+ * CompactSampleHistory - Long, delta-coded sample history behind CircularBufferMath
+ *
+ * The main ring keeps full 8-byte samples for the short windows the control
+ * loop scans. This ring keeps the same stream at ~4.5 bytes per sample for
+ * long-range queries (95th percentile flow beyond the main ring, post-grind
+ * analysis): blocks of up to 32 samples share a base timestamp, base value and
+ * first sequence number; each entry is a 16-bit time step from the previous
+ * entry (4 µs units) and a 16-bit value offset from the block base. A sample
+ * whose step or offset doesn't fit (cup placed, long gap) starts a new block.
+ *
+ * Single producer (CircularBufferMath::add_sample) and lock-free readers, like
+ * the main ring: one atomic holds the newest block and its entry count, readers
+ * never see the oldest blocks, and a read is valid if the producer started at
+ * most READER_GUARD_BLOCKS new blocks meanwhile. Samples older than a
+ * caller-supplied floor sequence (CircularBufferMath's clear floor) are skipped.
+ */
+class CompactSampleHistory {
+public:
+    struct Sample {
+        int32_t raw_value;
+        uint32_t timestamp_us;   // Within 4 µs of the capture time
+        uint32_t seq;            // CircularBufferMath publish sequence
+    };
+
+    static const uint8_t SAMPLES_PER_BLOCK = 32;
+    static const uint8_t TIME_UNIT_SHIFT = 2;   // 4 µs steps, up to ~262 ms between samples
+
+    CompactSampleHistory();
+
+    // Producer only; seq numbers must be consecutive within the history
+    void add_sample(int32_t raw_value, uint32_t timestamp_us, uint32_t seq);
+
+    // Readers (any task). False if no visible sample qualifies.
+    bool find_at_or_after(uint32_t timestamp_us, uint32_t floor_seq, Sample* sample_out) const;
+    bool find_at_or_before(uint32_t timestamp_us, uint32_t floor_seq, Sample* sample_out) const;
+    // Samples with from_us <= timestamp <= to_us, oldest first, at most max_samples
+    int read_range(uint32_t from_us, uint32_t to_us, uint32_t floor_seq, Sample* samples_out, int max_samples) const;
+    uint32_t get_time_span_ms(uint32_t floor_seq) const;
+
+    static constexpr uint32_t sample_capacity() { return (uint32_t)HW_LOADCELL_COMPACT_HISTORY_BLOCKS * SAMPLES_PER_BLOCK; }
+
+private:
+    struct Block {
+        uint32_t base_timestamp_us;
+        int32_t base_raw;
+        uint32_t first_seq;
+        uint8_t count;                              // Final once the next block is published
+        uint8_t reserved[3];
+        uint16_t step_units[SAMPLES_PER_BLOCK];     // Entry 0 is always 0
+        int16_t offset_raw[SAMPLES_PER_BLOCK];
+    };
+
+    // publish_state = (block_seq << ENTRY_BITS) | entries in the newest block; 0 = empty
+    static const uint8_t ENTRY_BITS = 6;
+    static const uint32_t BLOCK_SEQ_MASK = (1u << (32 - ENTRY_BITS)) - 1;
+    static const uint32_t READER_GUARD_BLOCKS = 2;
+    static const int MAX_READ_RETRIES = 4;
+
+    static_assert(HW_LOADCELL_COMPACT_HISTORY_BLOCKS >= 8, "history needs blocks beyond the reader guard");
+    Ring<Block, HW_LOADCELL_COMPACT_HISTORY_BLOCKS> blocks;
+    std::atomic<uint32_t> publish_state;
+
+    // Producer-only
+    uint32_t write_block_seq;
+    uint8_t write_entries;
+    uint32_t write_last_timestamp_us;   // Decoded timestamp of the newest entry
+
+    struct ReadView {
+        uint32_t newest_block;
+        uint8_t newest_entries;
+        uint32_t block_count;           // Readable blocks, newest back (>= 1)
+    };
+    bool begin_read(ReadView* view) const;
+    bool blocks_intact(const ReadView& view) const;
+    uint8_t entries_in(const ReadView& view, uint32_t block_age) const;
+    const Block& block_at(const ReadView& view, uint32_t block_age) const {
+        return blocks.slot(view.newest_block - block_age);
+    }
+    // Age (0 = newest) of the newest readable block starting at/before timestamp_us
+    uint32_t block_containing(const ReadView& view, uint32_t timestamp_us) const;
+
+    static bool is_at_or_after(uint32_t timestamp_us, uint32_t reference_us) {
+        return (int32_t)(timestamp_us - reference_us) >= 0;
+    }
+    static bool is_visible(uint32_t seq, uint32_t floor_seq) { return (int32_t)(seq - floor_seq) >= 0; }
+};
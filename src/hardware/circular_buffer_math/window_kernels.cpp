@@ -0,0 +1,111 @@
+#include "window_kernels.h"
+#include <algorithm>
+
+namespace window_kernels {
+
+namespace {
+Reduction reduce_scalar(const int32_t* values, int count) {
+    Reduction result = { 0, values[0], values[0] };
+    for (int i = 0; i < count; i++) {
+        result.sum += values[i];
+        result.min = std::min(result.min, values[i]);
+        result.max = std::max(result.max, values[i]);
+    }
+    return result;
+}
+
+#if WINDOW_KERNELS_USE_PIE
+constexpr int32_t kPieValueLimit = 1 << 23;      // Lane sums stay exact for 24-bit values...
+constexpr int kPieVectorsPerBlock = 128;         // ...over 128 vectors: 128 * 2^23 = 2^30
+
+Reduction reduce_pie(const int32_t* values, int count) {
+    Reduction result = { 0, values[0], values[0] };
+    int i = 0;
+
+    // Scalar head up to the 16-byte alignment EE.VLD.128 needs
+    while (i < count && ((uintptr_t)(values + i) & 15) != 0) {
+        result.sum += values[i];
+        result.min = std::min(result.min, values[i]);
+        result.max = std::max(result.max, values[i]);
+        i++;
+    }
+
+    int vectors = (count - i) / 4;
+    if (vectors > 0) {
+        alignas(16) int32_t lanes[8];
+        const int32_t* p = values + i;
+        i += vectors * 4;
+
+        // q0 = lane minimums, q1 = lane maximums, seeded from the first vector
+        asm volatile("ee.vld.128.ip q0, %0, 0\n\t"
+                     "ee.orq q1, q0, q0\n\t" :: "r"(p) : "memory");
+        while (vectors > 0) {
+            int block = std::min(vectors, kPieVectorsPerBlock);
+            vectors -= block;
+            asm volatile("ee.zero.q q2");            // q2 = lane sums for this block
+            for (int k = 0; k < block; k++) {
+                asm volatile("ee.vld.128.ip q3, %0, 16\n\t"
+                             "ee.vmin.s32 q0, q0, q3\n\t"
+                             "ee.vmax.s32 q1, q1, q3\n\t"
+                             "ee.vadds.s32 q2, q2, q3\n\t"
+                             : "+r"(p) :: "memory");
+            }
+            int32_t* out = lanes;
+            asm volatile("ee.vst.128.ip q2, %0, 0" :: "r"(out) : "memory");
+            result.sum += (int64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+        int32_t* out = lanes;
+        asm volatile("ee.vst.128.ip q0, %0, 16\n\t"
+                     "ee.vst.128.ip q1, %0, 16\n\t"
+                     : "+r"(out) :: "memory");
+        for (int lane = 0; lane < 4; lane++) {
+            result.min = std::min(result.min, lanes[lane]);
+            result.max = std::max(result.max, lanes[4 + lane]);
+        }
+    }
+
+    for (; i < count; i++) {
+        result.sum += values[i];
+        result.min = std::min(result.min, values[i]);
+        result.max = std::max(result.max, values[i]);
+    }
+
+    // Saturated lane sums are only possible outside the 24-bit range
+    if (result.min < -kPieValueLimit || result.max >= kPieValueLimit) {
+        return reduce_scalar(values, count);
+    }
+    return result;
+}
+#endif
+}
+
+Reduction reduce(const int32_t* values, int count) {
+#if WINDOW_KERNELS_USE_PIE
+    return reduce_pie(values, count);
+#else
+    return reduce_scalar(values, count);
+#endif
+}
+
+void centered_sums(const int32_t* values, int count, int32_t center, int64_t* sum_out, int64_t* sum_sq_out) {
+    // Four independent accumulator pairs keep the 64-bit multiply-adds pipelined
+    int64_t sum[4] = {};
+    int64_t sum_sq[4] = {};
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int lane = 0; lane < 4; lane++) {
+            int64_t centered = (int64_t)values[i + lane] - center;
+            sum[lane] += centered;
+            sum_sq[lane] += centered * centered;
+        }
+    }
+    for (; i < count; i++) {
+        int64_t centered = (int64_t)values[i] - center;
+        sum[0] += centered;
+        sum_sq[0] += centered * centered;
+    }
+    *sum_out = sum[0] + sum[1] + sum[2] + sum[3];
+    *sum_sq_out = sum_sq[0] + sum_sq[1] + sum_sq[2] + sum_sq[3];
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../../config/constants.h"
+
+// ESP32-S3 PIE vector path; everything else (mock/native builds, other targets) runs the scalar loops
+#if HW_LOADCELL_SIMD_KERNELS_ENABLED && defined(__XTENSA__) && defined(CONFIG_IDF_TARGET_ESP32S3)
+#define WINDOW_KERNELS_USE_PIE 1
+#else
+#define WINDOW_KERNELS_USE_PIE 0
+#endif
+
+/**
+ * window_kernels - Reductions over contiguous int32 sample runs
+ *
+ * The innermost loops of the windowed queries. CircularBufferMath keeps raw
+ * values in their own array, so these reduce a window in place (one run, or
+ * two where the ring wraps) or a copy of it.
+ * On the ESP32-S3 reduce() runs four 32-bit lanes per PIE instruction
+ * (EE.VMIN/VMAX/VADDS.S32 on 128-bit loads), widening the lane sums to int64
+ * every 128 vectors; that is exact for 24-bit ADC values, and runs outside
+ * that range fall back to the scalar loop. Sums of squares need 64-bit
+ * products, which PIE lacks for 32-bit lanes, so centered_sums() stays scalar.
+ */
+namespace window_kernels {
+
+struct Reduction {
+    int64_t sum;
+    int32_t min;
+    int32_t max;
+};
+
+// count >= 1
+Reduction reduce(const int32_t* values, int count);
+
+// Exact sum and sum of squares of (value - center)
+void centered_sums(const int32_t* values, int count, int32_t center, int64_t* sum_out, int64_t* sum_sq_out);
+
+}
@@ -0,0 +1,100 @@
+#include "cup_detector.h"
+#include <math.h>
+
+namespace {
+const float kBaselineGain = 1.0f / 16.0f;       // Baseline follow per empty sample (creep, not steps)
+const float kWindowRestartSigmas = 4.0f;        // A sample this far from the window mean restarts it
+const uint32_t kHoldReseedUs = 1000000;         // Part of a step for this long: a light object, re-learn
+} // namespace
+
+void CupDetector::reset() {
+    state = State::SEEDING;
+    hold_since_us = 0;
+    window_count = 0;
+}
+
+void CupDetector::restart_window(int32_t raw, uint32_t timestamp_us) {
+    window_start_us = timestamp_us;
+    window_count = 1;
+    window_mean = (float)raw;
+    window_m2 = 0.0f;
+}
+
+float CupDetector::window_std_dev() const {
+    return window_count > 1 ? sqrtf(window_m2 / (float)(window_count - 1)) : 0.0f;
+}
+
+// true once the window is quiet, long and full enough
+bool CupDetector::add_to_window(int32_t raw, uint32_t timestamp_us, const Limits& limits) {
+    if (window_count == 0 || fabsf((float)raw - window_mean) > kWindowRestartSigmas * limits.std_dev_limit_raw) {
+        restart_window(raw, timestamp_us);
+        return false;
+    }
+    window_count++;
+    float delta = (float)raw - window_mean;
+    window_mean += delta / (float)window_count;
+    window_m2 += delta * ((float)raw - window_mean);
+
+    return window_count >= limits.min_samples &&
+           (uint32_t)(timestamp_us - window_start_us) >= limits.settle_us &&
+           window_std_dev() <= limits.std_dev_limit_raw;
+}
+
+bool CupDetector::add_sample(int32_t raw, uint32_t timestamp_us, const Limits& limits, Placement* placement_out) {
+    const float rise_g = ((float)raw - baseline_raw) * limits.grams_per_raw;
+    const float half_step_g = 0.5f * limits.step_g;
+
+    switch (state) {
+        case State::SEEDING:
+            if (add_to_window(raw, timestamp_us, limits)) {
+                baseline_raw = window_mean;
+                hold_since_us = 0;
+                state = State::EMPTY;
+            }
+            return false;
+
+        case State::EMPTY:
+            if (rise_g >= limits.step_g) {
+                step_us = timestamp_us;
+                restart_window(raw, timestamp_us);
+                state = State::SETTLING;
+            } else if (rise_g <= -half_step_g) {
+                reset();    // Seeded with something on the scale, now lifted off
+            } else if (rise_g < half_step_g) {
+                baseline_raw += ((float)raw - baseline_raw) * kBaselineGain;
+                hold_since_us = 0;
+            } else if (hold_since_us == 0) {
+                hold_since_us = timestamp_us;
+            } else if ((uint32_t)(timestamp_us - hold_since_us) >= kHoldReseedUs) {
+                reset();
+            }
+            return false;
+
+        case State::SETTLING:
+            if (rise_g < half_step_g) {
+                state = State::EMPTY;   // Tap or bump: back before it settled
+                hold_since_us = 0;
+                return false;
+            }
+            if (!add_to_window(raw, timestamp_us, limits)) {
+                return false;
+            }
+            state = State::LOADED;
+            if (placement_out) {
+                placement_out->settled_raw = (int32_t)lroundf(window_mean);
+                placement_out->std_dev_raw = window_std_dev();
+                placement_out->step_g = (window_mean - baseline_raw) * limits.grams_per_raw;
+                placement_out->step_us = step_us;
+                placement_out->settled_us = timestamp_us;
+            }
+            return true;
+
+        case State::LOADED:
+            if (rise_g < half_step_g) {
+                state = State::EMPTY;   // Cup lifted off: armed for the next one
+                hold_since_us = 0;
+            }
+            return false;
+    }
+    return false;
+}
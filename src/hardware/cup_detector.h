@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * CupDetector - "Cup placed and stable" from the raw sample stream
+ *
+ * Fed every sample while Start-on-Cup is armed. An empty-scale baseline is
+ * learned from a quiet window, then followed while the weight stays within
+ * half a step of it. A rise of step_g or more opens a settling window; the
+ * window restarts whenever a sample leaves it (the cup still rocking), and
+ * once it spans settle_us with min_samples and a spread within
+ * std_dev_limit_raw the placement is reported with the window mean, which
+ * is the tare for the grind that follows. Hysteresis keeps it from firing
+ * twice: a placed cup has to come back below half a step (lifted off)
+ * before the next one counts, and a rise that falls back below half a step
+ * before it settles (a tap on the tray) is dropped. A light object that
+ * never reaches the step re-seeds the baseline after a while.
+ *
+ * Producer-only state (WeightSamplingTask).
+ */
+class CupDetector {
+public:
+    struct Limits {
+        float grams_per_raw;        // Signed; a cup raises the weight, not necessarily the raw value
+        float step_g;               // Rise that counts as a cup (USER_AUTO_GRIND_TRIGGER_DELTA_G)
+        float std_dev_limit_raw;    // Spread of a settled window
+        uint32_t settle_us;         // Shortest settled window
+        uint16_t min_samples;
+    };
+
+    struct Placement {
+        int32_t settled_raw;        // Window mean with the cup on
+        float std_dev_raw;
+        float step_g;               // Rise over the empty baseline
+        uint32_t step_us;           // First sample past the step
+        uint32_t settled_us;        // Sample that confirmed it
+    };
+
+    // true with *placement_out filled when a cup has just settled
+    bool add_sample(int32_t raw, uint32_t timestamp_us, const Limits& limits, Placement* placement_out);
+    void reset();
+
+private:
+    enum class State : uint8_t { SEEDING, EMPTY, SETTLING, LOADED };
+
+    State state = State::SEEDING;
+    float baseline_raw = 0.0f;
+    uint32_t hold_since_us = 0;     // EMPTY: first sample between half a step and a step, 0 = none
+    uint32_t step_us = 0;
+
+    // Quiet window (Welford) for the baseline and the settled cup
+    uint32_t window_start_us = 0;
+    uint16_t window_count = 0;
+    float window_mean = 0.0f;
+    float window_m2 = 0.0f;
+
+    void restart_window(int32_t raw, uint32_t timestamp_us);
+    bool add_to_window(int32_t raw, uint32_t timestamp_us, const Limits& limits);
+    float window_std_dev() const;
+};
@@ -1,6 +1,26 @@
 #include "display_manager.h"
+#include "../system/trace.h"
+#include "../system/perf_counters.h"
 #include "../config/constants.h"
+#include "../config/logging.h"
 #include <Arduino.h>
+#include <driver/spi_master.h>
+
+// CO5300 QSPI framing: 32-bit [opcode][command][0x00] header, then parameters or pixels.
+// 0x02 sends everything on one line, 0x32 sends the pixels on four.
+static const uint32_t PANEL_OPCODE_WRITE_COMMAND = 0x02;
+static const uint32_t PANEL_OPCODE_WRITE_COLOR = 0x32;
+static const uint8_t PANEL_CMD_COLUMN_ADDRESS = 0x2A;
+static const uint8_t PANEL_CMD_ROW_ADDRESS = 0x2B;
+static const uint8_t PANEL_CMD_MEMORY_WRITE = 0x2C;
+static const uint8_t PANEL_CMD_BRIGHTNESS = 0x51;
+// Panel RAM offsets at rotation 0, as passed to Arduino_CO5300 (col_offset1, row_offset1)
+static const uint16_t PANEL_COLUMN_OFFSET = HW_DISPLAY_COLOR_ORDER;
+static const uint16_t PANEL_ROW_OFFSET = HW_DISPLAY_OFFSET_X_PX;
+
+static int panel_header(uint32_t opcode, uint8_t command) {
+    return (int)((opcode << 24) | ((uint32_t)command << 8));
+}
 
 
 DisplayManager* g_display_manager = nullptr;
@@ -31,23 +51,64 @@ void DisplayManager::init() {
     screen_width = gfx_device->width();
     screen_height = gfx_device->height();
 
-    // Full screen buffer, but only partial updates used
     // RGB565 format (16bit per pixel)
-    buffer_size = screen_width * screen_height * sizeof(u_int16_t);  
+    lv_display_render_mode_t render_mode = LV_DISPLAY_RENDER_MODE_PARTIAL;
+#if HW_DISPLAY_BUFFER_MODE == HW_DISPLAY_BUFFER_PSRAM_DIRECT
+    // One retained frame in PSRAM: LVGL redraws only dirty areas in place
+    buffer_size = screen_width * screen_height * sizeof(uint16_t);
+    draw_buffers[0] = (lv_color_t*)heap_caps_aligned_alloc(
+        LV_DRAW_BUF_ALIGN, buffer_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (draw_buffers[0]) {
+        render_mode = LV_DISPLAY_RENDER_MODE_DIRECT;
+    } else {
+        LOG_BLE("WARNING: No PSRAM for the display frame - using draw stripes\n");
+    }
+#endif
 
-    draw_buffer = (lv_color_t*)heap_caps_aligned_alloc(
-        LV_DRAW_BUF_ALIGN, buffer_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-    if (!draw_buffer) {
-        draw_buffer = (lv_color_t*)heap_caps_aligned_alloc(
-        LV_DRAW_BUF_ALIGN, buffer_size, MALLOC_CAP_8BIT);
+    if (render_mode == LV_DISPLAY_RENDER_MODE_PARTIAL) {
+        // Two row stripes in internal DMA RAM: with the DMA flush LVGL renders the next
+        // stripe while the previous one is on the bus.
+        buffer_size = screen_width * HW_DISPLAY_DRAW_BUFFER_ROWS * sizeof(uint16_t);
+        for (lv_color_t*& buffer : draw_buffers) {
+            buffer = (lv_color_t*)heap_caps_aligned_alloc(
+                LV_DRAW_BUF_ALIGN, buffer_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        }
+        if (!draw_buffers[0]) {
+            draw_buffers[0] = (lv_color_t*)heap_caps_aligned_alloc(
+            LV_DRAW_BUF_ALIGN, buffer_size, MALLOC_CAP_8BIT);
+        }
+    }
+    direct_mode = render_mode == LV_DISPLAY_RENDER_MODE_DIRECT;
+
+#if HW_DISPLAY_DMA_FLUSH_ENABLED
+    if ((direct_mode || draw_buffers[1]) && !init_dma_flush()) {
+        LOG_BLE("WARNING: Display DMA flush unavailable - using polled panel writes\n");
+    }
+#endif
+
+    if (!panel_io && draw_buffers[1]) {
+        heap_caps_free(draw_buffers[1]);
+        draw_buffers[1] = nullptr;
     }
 
     lvgl_display = lv_display_create(screen_width, screen_height);
     lv_display_set_flush_cb(lvgl_display, display_flush_cb);
-    lv_display_set_buffers(lvgl_display, draw_buffer, NULL,
-                          buffer_size , LV_DISPLAY_RENDER_MODE_PARTIAL);
+    if (panel_io) {
+        lv_display_set_flush_wait_cb(lvgl_display, display_flush_wait_cb);
+    }
+    lv_display_set_buffers(lvgl_display, draw_buffers[0], draw_buffers[1], buffer_size, render_mode);
+    frame_period_ms = LV_DEF_REFR_PERIOD;
+    LOG_BLE("Display: %s, %lu B %s buffer%s, %s flush\n",
+            direct_mode ? "direct" : "partial", (unsigned long)buffer_size,
+            direct_mode ? "PSRAM" : "internal", draw_buffers[1] ? " x2" : "",
+            panel_io ? "DMA" : "polled");
 
     lv_display_add_event_cb(lvgl_display, display_rounder_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(lvgl_display, display_refresh_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(lvgl_display, display_refresh_cb, LV_EVENT_REFR_READY, NULL);
+    // lv_display_create() shows the sysmon monitors; they stay off until the Diagnostics toggle
+    perf_monitor_visible = true;
+    set_perf_monitor_visible(false);
     
     // Initialize touch
     touch_driver.init();
@@ -58,20 +119,202 @@ void DisplayManager::init() {
     initialized = true;
 }
 
-void DisplayManager::update() {
-    if (!initialized) return;
+// Arduino_GFX has brought the panel up; pixels and brightness now go through an esp_lcd
+// panel IO on the same QSPI bus, whose color transfers are queued to DMA and complete
+// in on_flush_transfer_done(). Adding the device reroutes the CS pin to it, so
+// Arduino_GFX must not write to the panel after this.
+bool DisplayManager::init_dma_flush() {
+    flush_done = xSemaphoreCreateBinary();
+    if (!flush_done) {
+        return false;
+    }
+
+    esp_lcd_panel_io_spi_config_t io_config = {};
+    io_config.cs_gpio_num = HW_DISPLAY_CS_PIN;
+    io_config.dc_gpio_num = -1;
+    io_config.spi_mode = 0;
+    io_config.pclk_hz = HW_DISPLAY_QSPI_CLOCK_HZ;
+    io_config.trans_queue_depth = HW_DISPLAY_DMA_QUEUE_DEPTH;
+    io_config.on_color_trans_done = on_flush_transfer_done;
+    io_config.user_ctx = this;
+    io_config.lcd_cmd_bits = 32;
+    io_config.lcd_param_bits = 8;
+    io_config.flags.quad_mode = true;
+    // Arduino_ESP32QSPI initializes the bus on SPI2
+    esp_err_t err = esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)SPI2_HOST, &io_config, &panel_io);
+    if (err != ESP_OK) {
+        LOG_BLE("Display: esp_lcd panel IO failed (%d)\n", err);
+        panel_io = nullptr;
+        vSemaphoreDelete(flush_done);
+        flush_done = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void DisplayManager::write_panel_param(uint8_t command, const uint8_t* data, size_t size) {
+    esp_lcd_panel_io_tx_param(panel_io, panel_header(PANEL_OPCODE_WRITE_COMMAND, command), data, size);
+}
+
+uint32_t DisplayManager::update() {
+    if (!initialized) return LV_NO_TIMER_READY;
     
     touch_driver.update();
-    lv_timer_handler();
+    if (touch_driver.is_pressed()) {
+        last_activity_ms = millis();
+        set_render_idle(false);
+    }
+#if DEBUG_ENABLE_RENDER_STATS_OVERLAY
+    update_render_stats_overlay();
+#endif
+    return lv_timer_handler();
 }
 
-// Update the refresh area to be full width
-// This avoids weird artifacts when partial row updates are used
+void DisplayManager::render_now() {
+    if (!initialized) return;
+    lv_refr_now(lvgl_display);
+}
+
+void DisplayManager::set_frame_period(uint32_t period_ms) {
+    if (period_ms == frame_period_ms || !lvgl_display) return;
+    
+    frame_period_ms = period_ms;
+    lv_timer_set_period(lv_display_get_refr_timer(lvgl_display), period_ms);
+}
+
+void DisplayManager::set_render_idle(bool idle) {
+    if (idle == render_idle || !lvgl_display) return;
+    
+    render_idle = idle;
+    lv_timer_t* refresh_timer = lv_display_get_refr_timer(lvgl_display);
+    lv_timer_t* input_timer = lv_indev_get_read_timer(lvgl_input);
+    if (idle) {
+        lv_timer_pause(refresh_timer);
+        lv_timer_pause(input_timer);
+    } else {
+        lv_timer_resume(refresh_timer);
+        lv_timer_resume(input_timer);
+    }
+}
+
+void DisplayManager::set_perf_monitor_visible(bool visible) {
+    if (visible == perf_monitor_visible || !lvgl_display) return;
+
+    perf_monitor_visible = visible;
+    if (visible) {
+        lv_sysmon_show_performance(lvgl_display);
+        lv_sysmon_show_memory(lvgl_display);
+    } else {
+        lv_sysmon_hide_performance(lvgl_display);
+        lv_sysmon_hide_memory(lvgl_display);
+    }
+}
+
+void DisplayManager::set_frame_callback(DisplayFrameCallback callback, void* context) {
+    frame_callback = callback;
+    frame_callback_context = context;
+    frame_sample = {};
+}
+
+void DisplayManager::inject_touch(bool pressed, uint16_t x, uint16_t y) {
+    if (!touch_injected || pressed != injected_touch.pressed ||
+        (pressed && (x != injected_touch.x || y != injected_touch.y))) {
+        // Latency runs from the first change LVGL has not drawn yet
+        if (injected_change_us == 0) {
+            injected_change_us = micros() | 1;
+        }
+    }
+    touch_injected = true;
+    injected_touch = { x, y, pressed };
+    last_activity_ms = millis();
+    set_render_idle(false);
+}
+
+void DisplayManager::clear_injected_touch() {
+    touch_injected = false;
+    injected_touch = {};
+    injected_change_us = 0;
+    injected_change_read = false;
+}
+
+bool DisplayManager::is_render_active() const {
+    return millis() - last_activity_ms < SYS_TASK_UI_ACTIVE_HOLD_MS || lv_anim_count_running() > 0;
+}
+
+// Pixels LVGL was asked to redraw vs pixels sent to the panel after rounding, per frame
+// over the last window. The label's own redraw is included in both.
+void DisplayManager::update_render_stats_overlay() {
+    uint32_t now = millis();
+    if (!stats_label) {
+        stats_label = lv_label_create(lv_layer_top());
+        lv_obj_set_style_text_font(stats_label, &lv_font_montserrat_14, 0);
+        lv_obj_set_style_text_color(stats_label, lv_color_hex(THEME_COLOR_TEXT_SECONDARY), 0);
+        lv_obj_set_style_bg_color(stats_label, lv_color_hex(0x000000), 0);
+        lv_obj_set_style_bg_opa(stats_label, LV_OPA_70, 0);
+        lv_obj_align(stats_label, LV_ALIGN_BOTTOM_MID, 0, -4);
+        stats_window_start_ms = now;
+    }
+    uint32_t elapsed_ms = now - stats_window_start_ms;
+    if (elapsed_ms < DEBUG_RENDER_STATS_WINDOW_MS) {
+        return;
+    }
+
+    uint32_t frames = stats_frames > 0 ? stats_frames : 1;
+    lv_label_set_text_fmt(stats_label, "%lu fps  inv %lu  flush %lu px/f",
+                          (unsigned long)(stats_frames * 1000 / elapsed_ms),
+                          (unsigned long)(stats_invalidated_px / frames),
+                          (unsigned long)(stats_flushed_px / frames));
+    stats_invalidated_px = 0;
+    stats_flushed_px = 0;
+    stats_frames = 0;
+    stats_window_start_ms = now;
+}
+
+// The CO5300 column/row address windows must start on an even pixel and span an
+// even count; odd windows show up as smeared edges. A retained direct-mode frame is
+// sent as whole rows so each area is contiguous in memory.
 void DisplayManager::display_rounder_cb(lv_event_t* e) {
     lv_area_t* area = (lv_area_t*)lv_event_get_param(e);
+    g_display_manager->stats_invalidated_px += lv_area_get_size(area);
+    g_display_manager->frame_sample.invalidated_px += lv_area_get_size(area);
+    g_display_manager->last_activity_ms = millis();
+    g_display_manager->set_render_idle(false);
     
-    area->x1 = 0;
-    area->x2 = g_display_manager->screen_width - 1;
+    area->x1 &= ~1;
+    area->y1 &= ~1;
+    area->x2 |= 1;
+    area->y2 |= 1;
+    if (g_display_manager->direct_mode) {
+        area->x1 = 0;
+        area->x2 = g_display_manager->screen_width - 1;
+    }
+}
+
+// Frame timing for the frame callback: the refresh timer's start and ready events bracket
+// layout, rendering and flushing of one frame
+void DisplayManager::display_refresh_cb(lv_event_t* e) {
+    DisplayManager* self = g_display_manager;
+    if (!self->frame_callback) return;
+
+    uint32_t now_us = micros();
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        self->frame_start_us = now_us;
+        self->frame_sample.flush_us = 0;
+        self->frame_sample.flushed_px = 0;
+        return;
+    }
+    if (self->frame_sample.flushed_px == 0) {
+        return;
+    }
+    self->frame_sample.frame_us = now_us - self->frame_start_us;
+    self->frame_sample.input_latency_us = 0;
+    if (self->injected_change_read) {
+        self->frame_sample.input_latency_us = now_us - self->injected_change_us;
+        self->injected_change_us = 0;
+        self->injected_change_read = false;
+    }
+    self->frame_callback(self->frame_sample, self->frame_callback_context);
+    self->frame_sample = {};
 }
 
 void DisplayManager::display_flush_cb(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map) {
@@ -79,20 +322,85 @@ void DisplayManager::display_flush_cb(lv_display_t* disp, const lv_area_t* area,
     
     uint32_t w = lv_area_get_width(area);
     uint32_t h = lv_area_get_height(area);
+    trace.span_begin(TraceId::LVGL_FLUSH, (uint16_t)h);
+    g_display_manager->flush_start_us = micros();
+    g_display_manager->frame_sample.flushed_px += w * h;
+    g_display_manager->stats_flushed_px += w * h;
+    if (lv_display_flush_is_last(disp)) {
+        perf_counters.increment(PerfCount::DISPLAY_FRAMES);
+        g_display_manager->stats_frames++;
+    }
+    if (g_display_manager->direct_mode) {
+        // px_map is the whole frame; rounded areas span full rows, so the area is contiguous
+        px_map += (area->y1 * g_display_manager->screen_width + area->x1) * sizeof(uint16_t);
+    }
+    
+    if (g_display_manager->panel_io) {
+        // The panel takes big-endian RGB565; swap in place (Arduino_GFX swaps while copying)
+        lv_draw_sw_rgb565_swap(px_map, w * h);
+        g_display_manager->flush_pixels = px_map;
+        g_display_manager->flush_pixel_count = w * h;
+        uint16_t x1 = area->x1 + PANEL_COLUMN_OFFSET;
+        uint16_t x2 = area->x2 + PANEL_COLUMN_OFFSET;
+        uint16_t y1 = area->y1 + PANEL_ROW_OFFSET;
+        uint16_t y2 = area->y2 + PANEL_ROW_OFFSET;
+        uint8_t columns[4] = { (uint8_t)(x1 >> 8), (uint8_t)x1, (uint8_t)(x2 >> 8), (uint8_t)x2 };
+        uint8_t rows[4] = { (uint8_t)(y1 >> 8), (uint8_t)y1, (uint8_t)(y2 >> 8), (uint8_t)y2 };
+        g_display_manager->write_panel_param(PANEL_CMD_COLUMN_ADDRESS, columns, sizeof(columns));
+        g_display_manager->write_panel_param(PANEL_CMD_ROW_ADDRESS, rows, sizeof(rows));
+        g_display_manager->flush_rows = (uint16_t)h;
+        esp_lcd_panel_io_tx_color(g_display_manager->panel_io,
+                                  panel_header(PANEL_OPCODE_WRITE_COLOR, PANEL_CMD_MEMORY_WRITE),
+                                  px_map, w * h * sizeof(uint16_t));
+        g_display_manager->frame_sample.flush_us += micros() - g_display_manager->flush_start_us;
+        // LVGL renders the next stripe into the other buffer and then waits in display_flush_wait_cb()
+        return;
+    }
     
     if (LV_COLOR_16_SWAP){
         g_display_manager->gfx_device->draw16bitBeRGBBitmap(area->x1, area->y1, (uint16_t*)px_map, w, h);
     } else {
         g_display_manager->gfx_device->draw16bitRGBBitmap(area->x1, area->y1, (uint16_t*)px_map, w, h);
     }
+    trace.span_end(TraceId::LVGL_FLUSH, (uint16_t)h);
+    g_display_manager->frame_sample.flush_us += micros() - g_display_manager->flush_start_us;
     
     lv_display_flush_ready(disp);
 }
 
+// Called by LVGL before it reuses a buffer still on the bus: blocks the UI task rather than
+// spinning on Core 1. LVGL marks the flush finished when this returns.
+void DisplayManager::display_flush_wait_cb(lv_display_t* disp) {
+    uint32_t wait_start_us = micros();
+    if (xSemaphoreTake(g_display_manager->flush_done, pdMS_TO_TICKS(HW_DISPLAY_FLUSH_TIMEOUT_MS)) != pdTRUE) {
+        LOG_BLE("WARNING: Display DMA flush timed out\n");
+    }
+    if (g_display_manager->direct_mode) {
+        // The frame is retained and LVGL only redraws dirty areas: restore native order
+        lv_draw_sw_rgb565_swap(g_display_manager->flush_pixels, g_display_manager->flush_pixel_count);
+    }
+    trace.span_end(TraceId::LVGL_FLUSH, g_display_manager->flush_rows);
+    g_display_manager->frame_sample.flush_us += micros() - wait_start_us;
+}
+
+// SPI ISR context, possibly with the flash cache disabled: IRAM only, nothing from LVGL
+bool IRAM_ATTR DisplayManager::on_flush_transfer_done(esp_lcd_panel_io_handle_t io,
+                                                     esp_lcd_panel_io_event_data_t* event, void* user_ctx) {
+    BaseType_t higher_priority_woken = pdFALSE;
+    xSemaphoreGiveFromISR(static_cast<DisplayManager*>(user_ctx)->flush_done, &higher_priority_woken);
+    return higher_priority_woken == pdTRUE;
+}
+
 void DisplayManager::touchpad_read_cb(lv_indev_t* indev, lv_indev_data_t* data) {
     if (!g_display_manager) return;
     
-    TouchData touch = g_display_manager->touch_driver.get_touch_data();
+    TouchData touch;
+    if (g_display_manager->touch_injected) {
+        touch = g_display_manager->injected_touch;
+        g_display_manager->injected_change_read = g_display_manager->injected_change_us != 0;
+    } else {
+        touch = g_display_manager->touch_driver.get_touch_data();
+    }
     
     if (touch.pressed) {
         data->state = LV_INDEV_STATE_PRESSED;
@@ -114,8 +422,14 @@ void DisplayManager::set_brightness(float brightness) {
     if (brightness < 0.0f) brightness = 0.0f;
     if (brightness > 1.0f) brightness = 1.0f;
     
+    uint8_t brightness_value = (uint8_t)(brightness * 255.0f);
+    if (panel_io) {
+        // Arduino_GFX lost the CS pin to the DMA path; same command as CO5300::setBrightness
+        write_panel_param(PANEL_CMD_BRIGHTNESS, &brightness_value, 1);
+        return;
+    }
+    
     // Cast to CO5300 and call setBrightness with 8-bit value
     Arduino_CO5300* display = static_cast<Arduino_CO5300*>(gfx_device);
-    uint8_t brightness_value = (uint8_t)(brightness * 255.0f);
     display->setBrightness(brightness_value);
 }
@@ -1,16 +1,53 @@
 #pragma once
 #include <Arduino_GFX_Library.h>
 #include <lvgl.h>
+#include <esp_lcd_panel_io.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "touch_driver.h"
 #include "../config/constants.h"
 
+// One refreshed frame, reported to the frame callback (UI benchmark)
+struct DisplayFrameSample {
+    uint32_t frame_us;                      // Refresh timer start to ready: layout, render and flush
+    uint32_t flush_us;                      // Part of frame_us spent sending pixels or waiting for the DMA
+    uint32_t invalidated_px;                // Requested since the previous frame, before rounding
+    uint32_t flushed_px;
+    uint32_t input_latency_us;              // Injected touch change to the end of the first frame after LVGL read it; 0: none
+};
+typedef void (*DisplayFrameCallback)(const DisplayFrameSample& sample, void* context);
+
 class DisplayManager {
 private:
     Arduino_DataBus* bus;
     Arduino_GFX* gfx_device;
     lv_display_t* lvgl_display;
     lv_indev_t* lvgl_input;
-    lv_color_t* draw_buffer;
+    lv_color_t* draw_buffers[2];            // Row stripes (LVGL renders one while DMA sends the other) or one PSRAM frame
+    bool direct_mode;                       // draw_buffers[0] is a retained full frame
+    esp_lcd_panel_io_handle_t panel_io = nullptr;   // DMA pixel path; nullptr: polled Arduino_GFX writes
+    SemaphoreHandle_t flush_done = nullptr; // Given by the DMA transfer-done ISR
+    uint16_t flush_rows;
+    uint8_t* flush_pixels;                  // Area in flight, swapped back after DMA in direct mode
+    uint32_t flush_pixel_count;
+    uint32_t stats_invalidated_px;          // Render stats since stats_window_start_ms (UI task only)
+    uint32_t stats_flushed_px;
+    uint32_t stats_frames;
+    uint32_t stats_window_start_ms;
+    lv_obj_t* stats_label = nullptr;
+    uint32_t last_activity_ms;              // Last touch or invalidation
+    uint32_t frame_period_ms;               // LVGL refresh timer and UI task period
+    bool render_idle;                       // LVGL refresh and input timers paused
+    bool perf_monitor_visible;
+    DisplayFrameCallback frame_callback = nullptr;  // Frames that flushed pixels, while set
+    void* frame_callback_context = nullptr;
+    DisplayFrameSample frame_sample = {};   // Frame being refreshed (UI task only)
+    uint32_t frame_start_us = 0;
+    uint32_t flush_start_us = 0;
+    bool touch_injected = false;            // Synthetic pointer replaces the touch panel
+    TouchData injected_touch = {};
+    uint32_t injected_change_us = 0;        // Injected change not on the panel yet; 0: none
+    bool injected_change_read = false;      // LVGL has read it: the next frame answers it
     TouchDriver touch_driver;
     
     uint32_t screen_width;
@@ -20,8 +57,26 @@ private:
 
 public:
     void init();
-    void update();
+    // Runs LVGL; returns ms until its next timer is due (LV_NO_TIMER_READY: none)
+    uint32_t update();
+    // Pause LVGL's refresh and input timers while nothing changes; invalidation and
+    // touch resume them on their own
+    void set_render_idle(bool idle);
+    bool is_render_active() const;
+    // Draw and flush invalidated areas immediately (boot, before the UI task runs LVGL)
+    void render_now();
+    // Frame period for the current screen; the UI task paces its active cycles to it
+    void set_frame_period(uint32_t period_ms);
+    uint32_t get_frame_period_ms() const { return frame_period_ms; }
     void set_brightness(float brightness);
+    // LVGL sysmon overlays (fps/CPU and LVGL heap use/fragmentation); keep frames running while shown
+    void set_perf_monitor_visible(bool visible);
+    bool is_perf_monitor_visible() const { return perf_monitor_visible; }
+    // Per-frame render, flush and invalidation samples; nullptr stops them
+    void set_frame_callback(DisplayFrameCallback callback, void* context);
+    // Synthetic pointer read by LVGL instead of the touch panel until clear_injected_touch()
+    void inject_touch(bool pressed, uint16_t x, uint16_t y);
+    void clear_injected_touch();
     
     uint32_t get_width() const { return screen_width; }
     uint32_t get_height() const { return screen_height; }
@@ -29,8 +84,14 @@ public:
     TouchDriver* get_touch_driver() { return &touch_driver; }
     
 private:
+    bool init_dma_flush();
+    void update_render_stats_overlay();
+    void write_panel_param(uint8_t command, const uint8_t* data, size_t size);
     static void display_flush_cb(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map);
+    static void display_flush_wait_cb(lv_display_t* disp);
+    static bool on_flush_transfer_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t* event, void* user_ctx);
     static void display_rounder_cb(lv_event_t* e);
+    static void display_refresh_cb(lv_event_t* e);
     static void touchpad_read_cb(lv_indev_t* indev, lv_indev_data_t* data);
     static uint32_t millis_cb();
 };
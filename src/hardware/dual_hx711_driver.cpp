@@ -0,0 +1,112 @@
+#include "dual_hx711_driver.h"
+#include "../config/constants.h"
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <math.h>
+
+DualHX711Driver::DualHX711Driver(uint8_t sck_pin, uint8_t dout_pin, uint8_t dout2_pin, int8_t rate_pin)
+    : HX711Driver(sck_pin, dout_pin, rate_pin), dout2_pin(dout2_pin), channel2_gain(HW_LOADCELL_CHANNEL2_GAIN),
+      channel_raw{0, 0}, channel2_shifted(0) {
+}
+
+bool DualHX711Driver::begin(uint8_t gain_value) {
+    if (!HX711Driver::begin(gain_value)) {
+        return false;
+    }
+
+    // The base checked the first chip; a missing second one leaves its DOUT pulled low
+    unsigned long start_time = millis();
+    while (!is_ready() && millis() - start_time < HW_LOADCELL_SAMPLE_INTERVAL_MS * 2 + 200) {
+        delay(HW_LOADCELL_SAMPLE_INTERVAL_MS / 4);
+    }
+    if (!update_async()) {
+        LOG_BLE("DualHX711Driver: Timeout waiting for a sample from both channels\n");
+        return false;
+    }
+    delayMicroseconds(10);
+    if (digitalRead(dout2_pin) == LOW) {
+        LOG_BLE("DualHX711Driver: DOUT2 (GPIO %d) stuck LOW after read - second HX711 not connected?\n", dout2_pin);
+        return false;
+    }
+    LOG_BLE("DualHX711Driver: Both channels read, channel 2 gain %.4f\n", channel2_gain);
+    return true;
+}
+
+bool DualHX711Driver::configure_pins() {
+    if (!HX711Driver::configure_pins()) {
+        return false;
+    }
+    gpio_reset_pin((gpio_num_t)dout2_pin);
+    pinMode(dout2_pin, INPUT_PULLDOWN);
+    return true;
+}
+
+bool DualHX711Driver::is_ready() {
+    return digitalRead(dout_pin) == LOW && digitalRead(dout2_pin) == LOW;
+}
+
+bool DualHX711Driver::shift_in_raw_bits(uint32_t* raw_out) {
+    uint32_t raw_data = 0;
+    uint32_t raw_data2 = 0;
+
+    // Same clocking as HX711Driver; both chips shift on the shared SCK
+    noInterrupts();
+    for (uint8_t i = 0; i < (24 + gain); i++) {
+        digitalWrite(sck_pin, HIGH);
+        if (SCK_DELAY) delayMicroseconds(1);
+        digitalWrite(sck_pin, LOW);
+
+        if (i < 24) {
+            raw_data = (raw_data << 1) | digitalRead(dout_pin);
+            raw_data2 = (raw_data2 << 1) | digitalRead(dout2_pin);
+        }
+    }
+    interrupts();
+
+    *raw_out = raw_data;
+    channel2_shifted = raw_data2;
+    return true;
+}
+
+bool DualHX711Driver::update_async() {
+    if (!HX711Driver::update_async()) {
+        return false;
+    }
+    // The base normalized channel 1 into last_raw_data; channel 2 the same way, then sum
+    channel_raw[0] = last_raw_data;
+    channel_raw[1] = (int32_t)(channel2_shifted ^ 0x800000);
+    last_raw_data = channel_raw[0] + (int32_t)lroundf(channel2_gain * (float)channel_raw[1]);
+    return true;
+}
+
+bool DualHX711Driver::enable_data_ready_interrupt(TaskHandle_t task) {
+    if (!HX711Driver::enable_data_ready_interrupt(task)) {
+        return false;
+    }
+    // Either chip may finish last; the later edge stamps the sample
+    attachInterruptArg(digitalPinToInterrupt(dout2_pin), dout_falling_isr, this, FALLING);
+    return true;
+}
+
+void DualHX711Driver::disable_data_ready_interrupt() {
+    if (drdy_interrupt_enabled) {
+        detachInterrupt(digitalPinToInterrupt(dout2_pin));
+    }
+    HX711Driver::disable_data_ready_interrupt();
+}
+
+bool DualHX711Driver::set_channel_gain(uint8_t channel, float gain_value) {
+    if (channel == 0) {
+        return gain_value == 1.0f;
+    }
+    // Cells of one platform differ by percents, not by factors
+    if (channel != 1 || !isfinite(gain_value) || gain_value < 0.5f || gain_value > 2.0f) {
+        return false;
+    }
+    channel2_gain = gain_value;
+    return true;
+}
+
+int32_t DualHX711Driver::get_raw_max() const {
+    return 0xFFFFFF + (int32_t)lroundf(channel2_gain * (float)0xFFFFFF);
+}
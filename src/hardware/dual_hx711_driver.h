@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../config/constants.h"
+#include "hx711_driver.h"
+#include <Arduino.h>
+
+/**
+ * Dual HX711 Driver
+ *
+ * Two HX711s on one scale platform (one per load cell), clocked together:
+ * SCK and RATE are shared, each chip has its own DOUT (HW_LOADCELL_DOUT_PIN,
+ * HW_LOADCELL_DOUT2_PIN). A conversion is ready once both DOUTs are low; one
+ * pass of 24 data bits + gain pulses shifts both results out, each bit read
+ * from both lines on the same clock. The data-ready interrupt watches both
+ * lines, so the sample is stamped at the later edge.
+ *
+ * get_raw_data() is the sum of the two channels in channel 1 counts, with
+ * channel 2 scaled by its gain (the cells' sensitivity ratio,
+ * HW_LOADCELL_CHANNEL2_GAIN or the stored ConfigFloat::CHANNEL2_GAIN). Summing before
+ * the sample ring gives WeightSensor one platform signal with twice the load
+ * capacity and averaged-down independent noise; calibration, tare and the
+ * control path see a single channel as before.
+ *
+ * Bit-banged readout only: the ISR readout and the SPI variant clock a single DOUT.
+ */
+class DualHX711Driver : public HX711Driver {
+private:
+    uint8_t dout2_pin;
+    float channel2_gain;
+    int32_t channel_raw[2];             // Offset binary, like last_raw_data
+    uint32_t channel2_shifted;          // Channel 2 bits of the latest readout
+
+protected:
+    bool configure_pins() override;
+    bool shift_in_raw_bits(uint32_t* raw_out) override;
+    bool supports_isr_readout() const override { return false; }
+
+public:
+    DualHX711Driver(uint8_t sck_pin = HW_LOADCELL_SCK_PIN, uint8_t dout_pin = HW_LOADCELL_DOUT_PIN,
+                    uint8_t dout2_pin = HW_LOADCELL_DOUT2_PIN, int8_t rate_pin = HW_LOADCELL_RATE_PIN);
+
+    using HX711Driver::begin;
+    bool begin(uint8_t gain_value) override;
+
+    bool is_ready() override;
+    bool update_async() override;
+
+    bool enable_data_ready_interrupt(TaskHandle_t task) override;
+    void disable_data_ready_interrupt() override;
+
+    uint8_t get_channel_count() const override { return 2; }
+    int32_t get_channel_raw_data(uint8_t channel) const override { return channel < 2 ? channel_raw[channel] : 0; }
+    bool set_channel_gain(uint8_t channel, float gain) override;
+    float get_channel_gain(uint8_t channel) const override { return channel == 1 ? channel2_gain : 1.0f; }
+    int32_t get_raw_max() const override;
+
+    const char* get_driver_name() const override { return "HX711 x2"; }
+};
@@ -1,20 +1,114 @@
 #include "grinder.h"
 #include "../controllers/grind_events.h"
 #include "../config/constants.h"
+#include <esp_timer.h>
+#if HW_MOTOR_CURRENT_ENABLED
+#include "../system/preference_cache.h"
+#endif
 #if DEBUG_ENABLE_LOADCELL_MOCK
+#if DEBUG_ENABLE_LOADCELL_REPLAY
+#include "replay_load_cell_driver.h"
+using SimulatedLoadCell = ReplayLoadCellDriver;     // Motor commands drive the session replay
+#else
 #include "mock_hx711_driver.h"
+using SimulatedLoadCell = MockHX711Driver;
+#endif
 #endif
 
+uint32_t Grinder::edge_time_now_us() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+bool IRAM_ATTR Grinder::on_rmt_transmit_done(rmt_channel_handle_t /*channel*/,
+                                            const rmt_tx_done_event_data_t* /*event_data*/,
+                                            void* user_ctx) {
+    // Only finite pulses complete; the continuous loop is ended by stop()
+    Grinder* self = static_cast<Grinder*>(user_ctx);
+    if (self && self->pulse_active && !self->pulse_end_recorded) {
+        uint32_t done_us = (uint32_t)esp_timer_get_time();
+        if (self->sequence_edge_count == 0) {
+            self->edge_timeline.record_from_isr(MotorEdgeType::PULSE_END, done_us);
+        } else {
+            // The RMT timed every edge to the tick; place them back from the end
+            uint32_t first_on_us = done_us - self->sequence_total_us;
+            for (uint8_t i = 0; i < self->sequence_edge_count; i++) {
+                MotorEdgeType type = (i % 2 == 0) ? MotorEdgeType::PULSE_END : MotorEdgeType::PULSE_START;
+                self->edge_timeline.record_from_isr(type, first_on_us + self->sequence_edge_offset_us[i]);
+            }
+        }
+        self->pulse_end_recorded = true;
+    }
+    return false;
+}
+
+void Grinder::on_stop_timer(void* arg) {
+    Grinder* self = static_cast<Grinder*>(arg);
+    uint8_t expected = SCHEDULED_STOP_ARMED;
+    if (!self->scheduled_stop_state.compare_exchange_strong(expected, SCHEDULED_STOP_CUTTING)) {
+        return;     // Cancelled by stop() meanwhile
+    }
+#if DEBUG_ENABLE_LOADCELL_MOCK
+    SimulatedLoadCell::notify_grinder_stop();
+#else
+    rmt_disable(self->rmt_channel);
+#endif
+    self->edge_timeline.record(MotorEdgeType::STOP, edge_time_now_us());
+    self->scheduled_stop_state.store(SCHEDULED_STOP_FIRED);
+}
+
+bool Grinder::schedule_stop(uint32_t delay_us) {
+    if (!initialized || !stop_timer || !grinding || pulse_active) return false;
+    take_scheduled_stop();
+    scheduled_stop_due_us = edge_time_now_us() + delay_us;
+    scheduled_stop_state.store(SCHEDULED_STOP_ARMED);
+    if (esp_timer_start_once(stop_timer, delay_us) != ESP_OK) {
+        scheduled_stop_state.store(SCHEDULED_STOP_NONE);
+        return false;
+    }
+    return true;
+}
+
+bool Grinder::take_scheduled_stop() {
+    if (stop_timer) {
+        esp_timer_stop(stop_timer);    // Not running is fine
+    }
+    uint8_t state = scheduled_stop_state.load();
+    while (state == SCHEDULED_STOP_CUTTING) {
+        state = scheduled_stop_state.load();  // Callback on the other core, a few µs
+    }
+    scheduled_stop_state.store(SCHEDULED_STOP_NONE);
+    return state == SCHEDULED_STOP_FIRED;
+}
+
 void Grinder::init(int pin) {
     motor_pin = pin;
     grinding = false;
     pulse_active = false;
+    pulse_end_recorded = false;
+    pulse_symbol_halves = 0;
+    sequence_edge_count = 0;
+    sequence_total_us = 0;
     rmt_initialized = false;
     current_encoder = nullptr;
+    motor_duty = 1.0f;
+    scheduled_stop_state.store(SCHEDULED_STOP_NONE);
+    scheduled_stop_due_us = 0;
+    
+    esp_timer_create_args_t stop_timer_args = {};
+    stop_timer_args.callback = on_stop_timer;
+    stop_timer_args.arg = this;
+    stop_timer_args.dispatch_method = ESP_TIMER_TASK;
+    stop_timer_args.name = "motor_stop";
+    if (esp_timer_create(&stop_timer_args, &stop_timer) != ESP_OK) {
+        stop_timer = nullptr;
+    }
     
     // Initialize background indicator
     background_active = false;
     ui_event_callback = nullptr;
+#if HW_MOTOR_CURRENT_ENABLED
+    next_current_window = 0;
+#endif
 
 #if DEBUG_ENABLE_LOADCELL_MOCK
     initialized = true;
@@ -31,16 +125,77 @@ void Grinder::init(int pin) {
     };
     
     if (rmt_new_tx_channel(&tx_chan_config, &rmt_channel) == ESP_OK) {
+        // Timestamp the pulse falling edge in the transmit-done interrupt
+        rmt_tx_event_callbacks_t callbacks = {};
+        callbacks.on_trans_done = on_rmt_transmit_done;
+        rmt_tx_register_event_callbacks(rmt_channel, &callbacks, this);
         rmt_enable(rmt_channel);
         rmt_initialized = true;
         initialized = true;
     }
+    
+#if HW_MOTOR_CURRENT_ENABLED
+    // Optional: without the sensor the grind runs on weight alone
+    current_sensor.begin();
+#endif
+}
+
+#if HW_MOTOR_CURRENT_ENABLED
+bool Grinder::classify_current_window(uint32_t end_us, MotorLoadTracker::WindowMotor* motor_out,
+                                      uint32_t* run_start_us_out) const {
+    const uint32_t start_us = end_us - HW_MOTOR_CURRENT_WINDOW_MS * 1000UL;
+    MotorEdgeTimeline::Edge edge;
+    for (uint8_t offset = 0; edge_timeline.get_edge(offset, &edge); offset++) {
+        if ((int32_t)(edge.timestamp_us - end_us) > 0) {
+            continue;               // After the window (drained late)
+        }
+        if ((int32_t)(edge.timestamp_us - start_us) > 0) {
+            return false;           // Inside it: part on, part off
+        }
+        if (edge.type == MotorEdgeType::START) {
+            *motor_out = MotorLoadTracker::WindowMotor::RUN;
+            *run_start_us_out = edge.timestamp_us;
+            return true;
+        }
+        if (edge.type == MotorEdgeType::PULSE_START) {
+            return false;           // Pulses never get past the inrush
+        }
+        *motor_out = MotorLoadTracker::WindowMotor::OFF;
+        return true;
+    }
+    // No edge before the window: off if the motor never ran, unknown if the edges were overwritten
+    *motor_out = MotorLoadTracker::WindowMotor::OFF;
+    return edge_timeline.get_edge_count() == 0;
+}
+
+void Grinder::service_motor_current() {
+    MotorCurrentSensor::Window window;
+    while (current_sensor.read_window(&next_current_window, &window)) {
+        MotorLoadTracker::WindowMotor motor;
+        uint32_t run_start_us = 0;
+        if (!classify_current_window(window.end_us, &motor, &run_start_us)) {
+            continue;
+        }
+        if (motor == MotorLoadTracker::WindowMotor::RUN && motor_duty < 1.0f) {
+            continue;               // Reduced speed draws less; the levels are for full speed
+        }
+        load_tracker.add_window(window.end_us, window.level, motor, run_start_us);
+    }
+    
+    if (load_tracker.take_no_load_update()) {
+        preference_cache.put_float("mc_noload", load_tracker.get_no_load_level());
+        LOG_BLE("Motor current: empty-running level %.1f counts (%.2f A)\n", load_tracker.get_no_load_level(),
+                load_tracker.get_no_load_level() * HW_MOTOR_CURRENT_AMPS_PER_COUNT);
+    }
 }
+#endif
 
 void Grinder::start() {
 #if DEBUG_ENABLE_LOADCELL_MOCK
     if (!initialized) return;
-    MockHX711Driver::notify_grinder_start();
+    SimulatedLoadCell::notify_grinder_start();
+    edge_timeline.record(MotorEdgeType::START, edge_time_now_us());
+    motor_duty = 1.0f;
     pulse_active = false;
     grinding = true;
     emit_background_change(true);
@@ -64,26 +219,70 @@ void Grinder::start() {
         return;
     }
     
+    motor_duty = 1.0f;
+    transmit_continuous(motor_duty);
+    edge_timeline.record(MotorEdgeType::START, edge_time_now_us());
+    grinding = true;
+    emit_background_change(true);
+}
+
+void Grinder::transmit_continuous(float duty) {
     // Use RMT infinite loop for continuous grinding
     rmt_symbol_word_t continuous_data[1];
-    continuous_data[0].duration0 = 32767; // Maximum 15-bit duration per symbol (~32ms at 1MHz)
-    continuous_data[0].level0 = 1; // HIGH
-    continuous_data[0].duration1 = 0;
-    continuous_data[0].level1 = 0;
+    if (duty >= 1.0f) {
+        continuous_data[0].duration0 = 32767; // Maximum 15-bit duration per symbol (~32ms at 1MHz)
+        continuous_data[0].level0 = 1; // HIGH
+        continuous_data[0].duration1 = 0;
+        continuous_data[0].level1 = 0;
+    } else {
+        // One duty period per symbol, looped
+        uint32_t high_us = (uint32_t)(duty * HW_MOTOR_PWM_PERIOD_US);
+        high_us = constrain(high_us, 1u, (uint32_t)HW_MOTOR_PWM_PERIOD_US - 1);
+        continuous_data[0].duration0 = high_us;
+        continuous_data[0].level0 = 1;
+        continuous_data[0].duration1 = HW_MOTOR_PWM_PERIOD_US - high_us;
+        continuous_data[0].level1 = 0;
+    }
     
     rmt_transmit_config_t tx_config = {
         .loop_count = -1, // Infinite loop
     };
     
     rmt_transmit(rmt_channel, current_encoder, continuous_data, sizeof(continuous_data), &tx_config);
-    grinding = true;
-    emit_background_change(true);
+}
+
+void Grinder::set_speed(float duty) {
+#if HW_MOTOR_SPEED_CONTROL_ENABLED
+    duty = constrain(duty, HW_MOTOR_MIN_DUTY, 1.0f);
+    // Only a continuous run changes speed; an armed stop is about to cut it anyway
+    if (!grinding || pulse_active || has_scheduled_stop() || fabsf(duty - motor_duty) < 0.01f) {
+        return;
+    }
+    motor_duty = duty;
+#if DEBUG_ENABLE_LOADCELL_MOCK
+    SimulatedLoadCell::notify_grinder_speed(duty);
+    return;
+#endif
+    if (!initialized || !rmt_initialized) return;
+    
+    // Restarting the loop with the new symbol; the output idles low for microseconds
+    rmt_disable(rmt_channel);
+    rmt_enable(rmt_channel);
+    transmit_continuous(duty);
+#else
+    (void)duty;
+#endif
 }
 
 void Grinder::stop() {
 #if DEBUG_ENABLE_LOADCELL_MOCK
     if (!initialized) return;
-    MockHX711Driver::notify_grinder_stop();
+    if (!take_scheduled_stop()) {
+        SimulatedLoadCell::notify_grinder_stop();
+        if (grinding) {
+            edge_timeline.record(MotorEdgeType::STOP, edge_time_now_us());
+        }
+    }
     grinding = false;
     pulse_active = false;
     emit_background_change(false);
@@ -91,8 +290,15 @@ void Grinder::stop() {
 #endif
     if (!initialized || !rmt_initialized) return;
     
-    // Stop RMT transmission (works for both infinite loop and finite pulses)
-    rmt_disable(rmt_channel);
+    // Stop RMT transmission (works for both infinite loop and finite pulses);
+    // a scheduled stop that already fired has disabled it and recorded the edge
+    if (!take_scheduled_stop()) {
+        bool was_driving = grinding && !(pulse_active && pulse_end_recorded);
+        rmt_disable(rmt_channel);
+        if (was_driving) {
+            edge_timeline.record(MotorEdgeType::STOP, edge_time_now_us());
+        }
+    }
     rmt_enable(rmt_channel); // Re-enable for next operation
     
     // Clean up current encoder
@@ -106,10 +312,13 @@ void Grinder::stop() {
     emit_background_change(false);
 }
 
-void Grinder::start_pulse_rmt(uint32_t duration_ms) {
+void Grinder::start_pulse_us(uint32_t duration_us) {
 #if DEBUG_ENABLE_LOADCELL_MOCK
     if (!initialized) return;
-    MockHX711Driver::notify_pulse(duration_ms);
+    SimulatedLoadCell::notify_pulse(duration_us / 1000);
+    edge_timeline.record(MotorEdgeType::PULSE_START, edge_time_now_us());
+    sequence_edge_count = 0;
+    pulse_end_recorded = false;
     pulse_active = true;
     grinding = true;
     emit_background_change(true);
@@ -131,8 +340,8 @@ void Grinder::start_pulse_rmt(uint32_t duration_ms) {
     }
     
     // Create RMT symbols for HIGH pulse + LOW end
-    rmt_symbol_word_t pulse_symbols[2];
-    uint32_t duration_us = duration_ms * 1000;
+    sequence_edge_count = 0;
+    duration_us = max(duration_us, 1u);
     
     // Handle long durations by using maximum duration and remainder
     if (duration_us <= 32767) {
@@ -143,10 +352,12 @@ void Grinder::start_pulse_rmt(uint32_t duration_ms) {
         pulse_symbols[0].duration1 = 1; // Minimal LOW to end pulse
         
         rmt_transmit_config_t tx_config = {.loop_count = 0};
+        pulse_end_recorded = false;
         pulse_active = true;
         grinding = true;
         
         rmt_transmit(rmt_channel, current_encoder, pulse_symbols, sizeof(rmt_symbol_word_t), &tx_config);
+        edge_timeline.record(MotorEdgeType::PULSE_START, edge_time_now_us());
         emit_background_change(true);
     } else {
         // For longer durations, use loop_count to repeat
@@ -165,18 +376,102 @@ void Grinder::start_pulse_rmt(uint32_t duration_ms) {
         pulse_symbols[1].duration1 = 0;
         
         rmt_transmit_config_t tx_config = {.loop_count = (int)loop_count};
+        pulse_end_recorded = false;
         pulse_active = true;
         grinding = true;
         
-        rmt_transmit(rmt_channel, current_encoder, pulse_symbols, sizeof(pulse_symbols), &tx_config);
+        rmt_transmit(rmt_channel, current_encoder, pulse_symbols, 2 * sizeof(rmt_symbol_word_t), &tx_config);
+        edge_timeline.record(MotorEdgeType::PULSE_START, edge_time_now_us());
         emit_background_change(true);
     }
 }
 
+bool Grinder::append_pulse_level(uint32_t level, uint32_t duration_us) {
+    // 15-bit durations: longer levels take several halves of the same level
+    while (duration_us > 0) {
+        if (pulse_symbol_halves >= 2 * PULSE_SYMBOL_CAPACITY) {
+            return false;
+        }
+        uint32_t chunk_us = min(duration_us, 32767u);
+        rmt_symbol_word_t& symbol = pulse_symbols[pulse_symbol_halves / 2];
+        if (pulse_symbol_halves % 2 == 0) {
+            symbol.level0 = level;
+            symbol.duration0 = chunk_us;
+        } else {
+            symbol.level1 = level;
+            symbol.duration1 = chunk_us;
+        }
+        pulse_symbol_halves++;
+        duration_us -= chunk_us;
+    }
+    return true;
+}
+
+bool Grinder::start_pulse_sequence(const MotorPulseStep* steps, uint8_t count) {
+    if (!steps || count == 0 || count > MOTOR_PULSE_MAX_STEPS) return false;
+    
+    uint32_t total_on_us = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        total_on_us += steps[i].on_us;
+    }
+#if DEBUG_ENABLE_LOADCELL_MOCK
+    // The simulation has no bursts: it grinds for the total on-time and reports one start and end
+    start_pulse_us(total_on_us);
+    return initialized;
+#endif
+    if (!initialized || !rmt_initialized || total_on_us == 0) return false;
+    
+    // Symbols and edge offsets first, so nothing is torn down for a sequence that does not fit
+    pulse_symbol_halves = 0;
+    uint32_t offset_us = 0;
+    uint8_t edge_count = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        bool last = (i + 1 == count);
+        uint32_t off_us = last ? 1 : max(steps[i].off_us, 1u);    // Minimal LOW to end, or to split bursts
+        if (steps[i].on_us == 0 || !append_pulse_level(1, steps[i].on_us) || !append_pulse_level(0, off_us)) {
+            return false;
+        }
+        if (i > 0) {
+            sequence_edge_offset_us[edge_count++] = offset_us;              // PULSE_START
+        }
+        offset_us += steps[i].on_us;
+        sequence_edge_offset_us[edge_count++] = offset_us;                  // PULSE_END
+        offset_us += off_us;
+    }
+    if (pulse_symbol_halves % 2 != 0) {
+        pulse_symbols[pulse_symbol_halves / 2].level1 = 0;
+        pulse_symbols[pulse_symbol_halves / 2].duration1 = 0;              // End marker
+        pulse_symbol_halves++;
+    }
+    
+    if (current_encoder) {
+        rmt_del_encoder(current_encoder);
+        current_encoder = nullptr;
+    }
+    rmt_copy_encoder_config_t encoder_config = {};
+    if (rmt_new_copy_encoder(&encoder_config, &current_encoder) != ESP_OK) {
+        return false;
+    }
+    
+    sequence_edge_count = edge_count;
+    sequence_total_us = offset_us;
+    pulse_end_recorded = false;
+    pulse_active = true;
+    grinding = true;
+    
+    rmt_transmit_config_t tx_config = {.loop_count = 0};
+    rmt_transmit(rmt_channel, current_encoder, pulse_symbols, (pulse_symbol_halves / 2) * sizeof(rmt_symbol_word_t),
+                 &tx_config);
+    edge_timeline.record(MotorEdgeType::PULSE_START, edge_time_now_us());
+    emit_background_change(true);
+    return true;
+}
+
 bool Grinder::is_pulse_complete() {
 #if DEBUG_ENABLE_LOADCELL_MOCK
     if (!pulse_active) return true;
-    if (!MockHX711Driver::is_pulse_active()) {
+    if (!SimulatedLoadCell::is_pulse_active()) {
+        edge_timeline.record(MotorEdgeType::PULSE_END, edge_time_now_us());
         pulse_active = false;
         grinding = false;
         emit_background_change(false);
@@ -186,11 +481,16 @@ bool Grinder::is_pulse_complete() {
 #endif
     if (!pulse_active) return true;
     
-    // For simplicity, we'll use a transmission done callback approach
-    // Since RMT handles the pulse timing in hardware, we can check the GPIO state
-    // as a simple completion indicator
-    if (digitalRead(motor_pin) == LOW) {
+    // Since RMT handles the pulse timing in hardware, the GPIO going low ends a
+    // single pulse; a sequence is low between bursts, so it waits for the ISR
+    bool done = sequence_edge_count > 0 ? pulse_end_recorded : (digitalRead(motor_pin) == LOW);
+    if (done) {
         pulse_active = false;
+        if (!pulse_end_recorded) {
+            // Transmit-done interrupt not seen yet; the GPIO already went low
+            edge_timeline.record(MotorEdgeType::PULSE_END, edge_time_now_us());
+            pulse_end_recorded = true;
+        }
         grinding = false;
         emit_background_change(false);
         return true;
@@ -2,13 +2,27 @@
 #include <Arduino.h>
 #include <driver/rmt_tx.h>
 #include <driver/rmt_encoder.h>
+#include <esp_timer.h>
+#include <atomic>
 #include <functional>
 #include "../config/constants.h"
+#include "motor_edge_timeline.h"
+#if HW_MOTOR_CURRENT_ENABLED
+#include "motor_current_sensor.h"
+#include "motor_load_tracker.h"
+#endif
 
 // Forward declarations
 struct GrindEventData;
 enum class UIGrindEvent;
 
+// One burst of a pulse sequence: relay on for on_us, then off for off_us
+struct MotorPulseStep {
+    uint32_t on_us;
+    uint32_t off_us;
+};
+static constexpr uint8_t MOTOR_PULSE_MAX_STEPS = 6;     // 2 * steps edges fit the edge timeline
+
 class Grinder {
 private:
     int motor_pin;
@@ -18,24 +32,100 @@ private:
     // RMT pulse control
     rmt_channel_handle_t rmt_channel;
     rmt_encoder_handle_t current_encoder;
-    bool pulse_active;
+    volatile bool pulse_active;
     bool rmt_initialized;
+    float motor_duty;                   // Continuous-run duty, 1.0 = full speed
+    void transmit_continuous(float duty);
+    
+    // Relay edges with µs timestamps on the load cell sample clock
+    MotorEdgeTimeline edge_timeline;
+    volatile bool pulse_end_recorded;    // Set by the transmit-done ISR
+    
+    // Finite pulse symbols; the copy encoder reads them while the pulse runs, so they
+    // live here and not on the caller's stack. Edge offsets let the ISR place the
+    // interior edges of a sequence (only the end of a transmission raises an interrupt)
+    static const uint8_t PULSE_SYMBOL_CAPACITY = 48;
+    rmt_symbol_word_t pulse_symbols[PULSE_SYMBOL_CAPACITY];
+    uint16_t pulse_symbol_halves;
+    uint8_t sequence_edge_count;                    // Edges after the first PULSE_START, 0 = single pulse
+    uint32_t sequence_edge_offset_us[2 * MOTOR_PULSE_MAX_STEPS - 1];   // From the first rising edge
+    uint32_t sequence_total_us;                     // First rising edge to transmit done
+    bool append_pulse_level(uint32_t level, uint32_t duration_us);
+    bool transmit_pulse_symbols();
+    
+    static bool IRAM_ATTR on_rmt_transmit_done(rmt_channel_handle_t channel,
+                                              const rmt_tx_done_event_data_t* event_data,
+                                              void* user_ctx);
+    static uint32_t edge_time_now_us();
+    
+    // One-shot stop between control ticks: the timer callback only cuts the relay
+    // and records the edge, the next stop() call finishes the bookkeeping
+    enum ScheduledStopState : uint8_t {
+        SCHEDULED_STOP_NONE,
+        SCHEDULED_STOP_ARMED,
+        SCHEDULED_STOP_CUTTING,     // Callback is cutting the relay
+        SCHEDULED_STOP_FIRED,       // Relay is off, stop() not called yet
+    };
+    esp_timer_handle_t stop_timer;
+    std::atomic<uint8_t> scheduled_stop_state;
+    uint32_t scheduled_stop_due_us;    // Requested cut time, same clock as the edge timeline
+    static void on_stop_timer(void* arg);
+    bool take_scheduled_stop();     // Disarms; true if the timer already cut the relay
     
     // Background indicator state (always compiled in)
     bool background_active;
     std::function<void(const GrindEventData&)> ui_event_callback;
     
     void emit_background_change(bool active);
+    
+#if HW_MOTOR_CURRENT_ENABLED
+    // Motor current (HW_MOTOR_CURRENT_*): windows classified against edge_timeline
+    MotorCurrentSensor current_sensor;
+    MotorLoadTracker load_tracker;
+    uint32_t next_current_window;
+    bool classify_current_window(uint32_t end_us, MotorLoadTracker::WindowMotor* motor_out, uint32_t* run_start_us_out) const;
+#endif
 
 public:
     void init(int pin);
     void start();
     void stop();
     
-    // RMT-based precise pulse control
-    void start_pulse_rmt(uint32_t duration_ms);
+    // RMT-based precise pulse control, µs resolution
+    void start_pulse_rmt(uint32_t duration_ms) { start_pulse_us(duration_ms * 1000UL); }
+    void start_pulse_us(uint32_t duration_us);
+    // On/off bursts in one transmission (e.g. a kick then short bursts); every edge is
+    // recorded in the edge timeline once the sequence ends. false if it does not fit
+    // (MOTOR_PULSE_MAX_STEPS, PULSE_SYMBOL_CAPACITY)
+    bool start_pulse_sequence(const MotorPulseStep* steps, uint8_t count);
     bool is_pulse_complete();
     
+    // Cut a continuous run delay_us from now without waiting for the next control
+    // tick; stop() still has to be called afterwards (it cancels a pending stop)
+    bool schedule_stop(uint32_t delay_us);
+    void cancel_scheduled_stop() { take_scheduled_stop(); }
+    bool has_scheduled_stop() const { return scheduled_stop_state.load() != SCHEDULED_STOP_NONE; }
+    bool is_stop_scheduled() const { return scheduled_stop_state.load() == SCHEDULED_STOP_ARMED; }
+    bool has_scheduled_stop_fired() const { return scheduled_stop_state.load() == SCHEDULED_STOP_FIRED; }
+    uint32_t get_scheduled_stop_due_us() const { return scheduled_stop_due_us; }
+    
+    // Variable speed for continuous runs (HW_MOTOR_SPEED_CONTROL_ENABLED): duty in
+    // [HW_MOTOR_MIN_DUTY, 1], start() always begins at full speed, pulses run at full speed
+    static constexpr bool supports_speed_control() { return HW_MOTOR_SPEED_CONTROL_ENABLED != 0; }
+    void set_speed(float duty);
+    float get_speed() const { return motor_duty; }
+    
+    const MotorEdgeTimeline& get_edge_timeline() const { return edge_timeline; }
+    
+#if HW_MOTOR_CURRENT_ENABLED
+    // Grind control task, every cycle: feeds new current windows to the load tracker
+    void service_motor_current();
+    bool has_motor_current() const { return current_sensor.is_running(); }
+    const MotorLoadState& get_motor_load() const { return load_tracker.get_state(); }   // Grind control task
+    void set_motor_no_load_level(float level) { load_tracker.set_no_load_level(level); }
+    float get_motor_no_load_level() const { return load_tracker.get_no_load_level(); }
+#endif
+    
     bool is_grinding() const { return grinding; }
     bool is_initialized() const { return initialized; }
     
@@ -2,12 +2,36 @@
 #include "../controllers/grind_controller.h"
 #include <Arduino.h>
 #include "../config/constants.h"
+#include "../system/config_store.h"
 
 void HardwareManager::init() {
     preferences.begin("grinder", false);
+    config_store.init(&preferences);
     display_manager.init();
     weight_sensor.init(&preferences);
     grinder.init(HW_MOTOR_RELAY_PIN);
+    weight_sensor.set_motor_edge_timeline(&grinder.get_edge_timeline());
+#if HW_MOTOR_CURRENT_ENABLED
+    // Learned empty-running current (MotorLoadTracker); the config value seeds a new device
+    grinder.set_motor_no_load_level(preferences.getFloat("mc_noload", GRIND_MOTOR_CURRENT_NO_LOAD_LEVEL));
+#endif
+
+#if HW_GRINDER_CHANNELS > 1
+    static_assert(!HW_MOTOR_CURRENT_ENABLED, "HW_MOTOR_CURRENT_ENABLED senses one motor; HW_GRINDER_CHANNELS must be 1");
+    // Per further grinder: relay, preferences namespace and ConfigStore blob key
+    static const uint8_t relay_pins[HW_GRINDER_CHANNELS - 1] = {HW_GRINDER2_MOTOR_RELAY_PIN};
+    static const char* const name_spaces[HW_GRINDER_CHANNELS - 1] = {"grinder2"};
+    static const char* const config_keys[HW_GRINDER_CHANNELS - 1] = {"config_ch2"};
+    for (uint8_t i = 0; i < HW_GRINDER_CHANNELS - 1; i++) {
+        ExtraChannel& channel = extra_channels[i];
+        channel.preferences.begin(name_spaces[i], false);
+        // The blob is written through preference_cache, so it sits in the "grinder" namespace
+        channel.config.init(&preferences, config_keys[i]);
+        channel.weight_sensor.init(&channel.preferences, i + 1, &channel.config);
+        channel.grinder.init(relay_pins[i]);
+        channel.weight_sensor.set_motor_edge_timeline(&channel.grinder.get_edge_timeline());
+    }
+#endif
 
     grind_controller = nullptr; // Will be set later
 
@@ -17,9 +41,9 @@ void HardwareManager::init() {
 void HardwareManager::update() {
     if (!initialized) return;
     
-    // All hardware components now updated independently by TaskScheduler:
-    // - weight_sensor.update() in "weight_sensor" task (10ms)  
-    // - display_manager.update() in "ui_display" task (16ms)
+    // All hardware components are updated by their own FreeRTOS tasks (TaskManager):
+    // - weight sensor in the WeightSampling task
+    // - display in the UI render task
     // No need for grinding mode switching - load cell runs at constant high speed
 }
 
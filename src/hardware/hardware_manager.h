@@ -4,6 +4,8 @@
 #include "WeightSensor.h"
 #include "grinder.h"
 #include "../controllers/autotune_controller.h"
+#include "../system/config_store.h"
+#include "../controllers/grind_channels.h"
 
 class GrindController; // Forward declaration
 
@@ -16,20 +18,45 @@ private:
     AutoTuneController autotune_controller;
     bool initialized;
     GrindController* grind_controller; // Reference to get grinding state
+
+#if HW_GRINDER_CHANNELS > 1
+    // Grinders after the first (GrindChannels): own scale, relay, preferences namespace
+    // (learned models, calibration curve) and ConfigStore blob (calibration, motor latency)
+    struct ExtraChannel {
+        WeightSensor weight_sensor;
+        Grinder grinder;
+        Preferences preferences;
+        ConfigStore config;
+    };
+    ExtraChannel extra_channels[HW_GRINDER_CHANNELS - 1];
+#endif
     
 public:
     void init();
     void update();
+    // The selected grinder's controller (GrindChannels); autotune runs on that grinder
     void set_grind_controller(GrindController* gc) {
         grind_controller = gc;
         // Initialize autotune controller with grind controller reference
-        autotune_controller.init(&weight_sensor, &grinder, gc);
+        autotune_controller.init(get_weight_sensor(), get_grinder(), gc);
     }
     
     DisplayManager* get_display() { return &display_manager; }
-    WeightSensor* get_weight_sensor() { return &weight_sensor; }
-    WeightSensor* get_load_cell() { return &weight_sensor; } // Legacy compatibility
-    Grinder* get_grinder() { return &grinder; }
+    // The selected grinder's scale and motor; the UI, calibration and diagnostics follow the selection
+    WeightSensor* get_weight_sensor() { return get_weight_sensor(grind_channels.get_selected()); }
+    WeightSensor* get_load_cell() { return get_weight_sensor(); } // Legacy compatibility
+    Grinder* get_grinder() { return get_grinder(grind_channels.get_selected()); }
+#if HW_GRINDER_CHANNELS > 1
+    WeightSensor* get_weight_sensor(uint8_t channel) { return channel > 0 && channel < HW_GRINDER_CHANNELS ? &extra_channels[channel - 1].weight_sensor : &weight_sensor; }
+    Grinder* get_grinder(uint8_t channel) { return channel > 0 && channel < HW_GRINDER_CHANNELS ? &extra_channels[channel - 1].grinder : &grinder; }
+    Preferences* get_channel_preferences(uint8_t channel) { return channel > 0 && channel < HW_GRINDER_CHANNELS ? &extra_channels[channel - 1].preferences : &preferences; }
+    ConfigStore* get_channel_config(uint8_t channel) { return channel > 0 && channel < HW_GRINDER_CHANNELS ? &extra_channels[channel - 1].config : &config_store; }
+#else
+    WeightSensor* get_weight_sensor(uint8_t) { return &weight_sensor; }
+    Grinder* get_grinder(uint8_t) { return &grinder; }
+    Preferences* get_channel_preferences(uint8_t) { return &preferences; }    // Channel 0 is get_preferences()
+    ConfigStore* get_channel_config(uint8_t) { return &config_store; }        // Channel 0 is config_store
+#endif
     Preferences* get_preferences() { return &preferences; }
     AutoTuneController* get_autotune_controller() { return &autotune_controller; }
     
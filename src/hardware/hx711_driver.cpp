@@ -1,7 +1,12 @@
 #include "hx711_driver.h"
 #include "../config/constants.h"
+#include "../logging/deferred_log.h"
 #include <Arduino.h>
 #include <driver/gpio.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_sys.h>
+#include <esp_timer.h>
+#include <soc/gpio_reg.h>
 
 /**
  * HX711 Driver Implementation
@@ -18,10 +23,13 @@
  * adapted from the original implementation for ESP32-S3 integration.
  */
 
-HX711Driver::HX711Driver(uint8_t sck_pin, uint8_t dout_pin) 
-    : sck_pin(sck_pin), dout_pin(dout_pin), gain(1), last_raw_data(0), 
+HX711Driver::HX711Driver(uint8_t sck_pin, uint8_t dout_pin, int8_t rate_pin) 
+    : sck_pin(sck_pin), dout_pin(dout_pin), rate_pin(rate_pin), gain(1),
+      current_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS), rate_switch_discard_remaining(0), last_raw_data(0), 
       data_ready_flag(false), conversion_start_time(0), conversion_time(0),
-      estimated_sample_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS) {
+      estimated_sample_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS),
+      drdy_notify_task(nullptr), drdy_interrupt_enabled(false), conversion_in_progress(false),
+      drdy_edge_time_us(0), last_sample_time_us(0), isr_readout(nullptr), isr_readout_active(false), isr_dropped_reported(0) {
 }
 
 bool HX711Driver::begin() {
@@ -29,13 +37,13 @@ bool HX711Driver::begin() {
 }
 
 bool HX711Driver::begin(uint8_t gain_value) {
-    // Ensure GPIO pins are properly configured for ESP32-S3
-    // GPIO 2 is a strapping pin that needs explicit configuration
-    gpio_reset_pin((gpio_num_t)sck_pin);
-    gpio_reset_pin((gpio_num_t)dout_pin);
+    // Pin reset below would orphan an attached DOUT interrupt
+    disable_data_ready_interrupt();
     
-    pinMode(sck_pin, OUTPUT);
-    pinMode(dout_pin, INPUT_PULLDOWN);
+    if (!configure_pins()) {
+        LOG_BLE("HX711Driver: Failed to configure SCK/DOUT pins\n");
+        return false;
+    }
     set_gain(gain_value);
     power_up();
     
@@ -75,6 +83,43 @@ bool HX711Driver::begin(uint8_t gain_value) {
     return false;
 }
 
+bool HX711Driver::configure_pins() {
+    // Ensure GPIO pins are properly configured for ESP32-S3
+    // GPIO 2 is a strapping pin that needs explicit configuration
+    gpio_reset_pin((gpio_num_t)sck_pin);
+    gpio_reset_pin((gpio_num_t)dout_pin);
+    
+    pinMode(sck_pin, OUTPUT);
+    pinMode(dout_pin, INPUT_PULLDOWN);
+    
+    if (rate_pin >= 0) {
+        pinMode(rate_pin, OUTPUT);
+        digitalWrite(rate_pin, current_rate_sps == HW_LOADCELL_SAMPLE_RATE_HIGH_SPS ? HIGH : LOW);
+    }
+    return true;
+}
+
+bool HX711Driver::set_sample_rate(uint32_t sps) {
+    if (sps != HW_LOADCELL_SAMPLE_RATE_SPS && sps != HW_LOADCELL_SAMPLE_RATE_HIGH_SPS) {
+        return false;
+    }
+    if (rate_pin < 0) {
+        // RATE strapped on the board - only the default rate is available
+        return sps == HW_LOADCELL_SAMPLE_RATE_SPS;
+    }
+    if (sps == current_rate_sps) {
+        return true;
+    }
+    
+    pinMode(rate_pin, OUTPUT);
+    digitalWrite(rate_pin, sps == HW_LOADCELL_SAMPLE_RATE_HIGH_SPS ? HIGH : LOW);
+    current_rate_sps = sps;
+    
+    // Conversions straddling the switch are not settled at the new rate
+    rate_switch_discard_remaining = HW_LOADCELL_RATE_SWITCH_DISCARD_SAMPLES;
+    return true;
+}
+
 void HX711Driver::set_gain(uint8_t gain_value) {
     if (gain_value <= 32) {
         gain = 2;      // 32 gain, channel B
@@ -83,6 +128,9 @@ void HX711Driver::set_gain(uint8_t gain_value) {
     } else {
         gain = 1;      // 128 gain, channel A
     }
+    if (isr_readout) {
+        isr_readout->pulses = 24 + gain;
+    }
 }
 
 void HX711Driver::power_up() {
@@ -101,6 +149,9 @@ void HX711Driver::power_up_sequence() {
 }
 
 void HX711Driver::power_down_sequence() {
+    // SCK high also pulls DOUT high; stop waking the sampling task while powered down
+    disable_data_ready_interrupt();
+    
     // Ensure SCK is configured as GPIO output before toggling (may be called before begin())
     pinMode(sck_pin, OUTPUT);
     digitalWrite(sck_pin, LOW);
@@ -113,19 +164,184 @@ bool HX711Driver::is_ready() {
 }
 
 bool HX711Driver::data_waiting_async() {
+    if (isr_readout_active && isr_readout->head != isr_readout->tail) {
+        return true;
+    }
     return is_ready();
 }
 
 bool HX711Driver::update_async() {
-    if (!is_ready()) {
+    if (isr_readout_active) {
+        // A low DOUT and an empty ring means a missed edge (or a conversion that completed
+        // before the ISR was armed): read it here, or DOUT would never fall again. The DOUT
+        // interrupt is masked from the second ring check to the end of the shift, so the ISR
+        // cannot clock the sample out first and leave this readout clocking an idle HX711
+        if (!pop_isr_sample()) {
+            gpio_intr_disable((gpio_num_t)dout_pin);
+            bool sampled = pop_isr_sample();
+            if (!sampled && is_ready()) {
+                conversion_24bit();
+                sampled = true;
+            }
+            gpio_intr_enable((gpio_num_t)dout_pin);
+            if (!sampled) {
+                return false;
+            }
+        }
+    } else {
+        if (!is_ready()) {
+            return false;
+        }
+        conversion_24bit();
+    }
+    
+    // Data must still be clocked out to release DOUT, but the caller gets no sample
+    if (rate_switch_discard_remaining > 0) {
+        rate_switch_discard_remaining--;
         return false;
     }
+    return true;
+}
+
+void IRAM_ATTR HX711Driver::dout_falling_isr(void* arg) {
+    HX711Driver* self = static_cast<HX711Driver*>(arg);
+    
+    // DOUT also toggles while data bits are shifted out - only a falling edge
+    // outside a conversion is a genuine data-ready signal
+    if (self->conversion_in_progress || !self->drdy_notify_task) {
+        return;
+    }
     
-    conversion_24bit();
+    self->drdy_edge_time_us = esp_timer_get_time();
+    
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->drdy_notify_task, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+void IRAM_ATTR HX711Driver::dout_readout_isr(void* arg) {
+    IsrReadout* readout = static_cast<IsrReadout*>(arg);
+    
+    // The readout's own clocking toggles DOUT; once the bits are out it stays high until the
+    // next conversion, so only a low line is a genuine data-ready edge
+    if (*readout->dout_in_reg & readout->dout_mask) {
+        return;
+    }
+    int64_t edge_time_us = esp_timer_get_time();
+    
+    // Same sequence as shift_in_raw_bits(), from IRAM and ROM only
+    uint32_t raw_data = 0;
+    const uint8_t pulses = readout->pulses;
+    for (uint8_t i = 0; i < pulses; i++) {
+        *readout->sck_set_reg = readout->sck_mask;
+        esp_rom_delay_us(SCK_DELAY);
+        *readout->sck_clear_reg = readout->sck_mask;
+        if (i < 24) {
+            raw_data = (raw_data << 1) | ((*readout->dout_in_reg & readout->dout_mask) ? 1 : 0);
+        }
+    }
+    
+    uint32_t head = readout->head;
+    if (head - readout->tail >= HW_LOADCELL_ISR_RING_SIZE) {
+        readout->dropped = readout->dropped + 1;
+    } else {
+        readout->raw[head & (HW_LOADCELL_ISR_RING_SIZE - 1)] = (int32_t)(raw_data ^ 0x800000);
+        readout->edge_time_us[head & (HW_LOADCELL_ISR_RING_SIZE - 1)] = edge_time_us;
+        readout->head = head + 1;
+    }
+    
+    if (readout->notify_task) {
+        BaseType_t higher_priority_task_woken = pdFALSE;
+        vTaskNotifyGiveFromISR(readout->notify_task, &higher_priority_task_woken);
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+}
+
+bool HX711Driver::start_isr_readout(TaskHandle_t task) {
+    if (!isr_readout) {
+        isr_readout = (IsrReadout*)heap_caps_calloc(1, sizeof(IsrReadout), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!isr_readout) {
+            return false;
+        }
+    }
+    const bool sck_high_bank = sck_pin >= 32;
+    const bool dout_high_bank = dout_pin >= 32;
+    isr_readout->sck_set_reg = (volatile uint32_t*)(sck_high_bank ? GPIO_OUT1_W1TS_REG : GPIO_OUT_W1TS_REG);
+    isr_readout->sck_clear_reg = (volatile uint32_t*)(sck_high_bank ? GPIO_OUT1_W1TC_REG : GPIO_OUT_W1TC_REG);
+    isr_readout->dout_in_reg = (volatile const uint32_t*)(dout_high_bank ? GPIO_IN1_REG : GPIO_IN_REG);
+    isr_readout->sck_mask = 1u << (sck_pin & 31);
+    isr_readout->dout_mask = 1u << (dout_pin & 31);
+    isr_readout->pulses = 24 + gain;
+    isr_readout->notify_task = task;
+    isr_readout->tail = isr_readout->head;
+    
+    isr_readout_active = true;
+    attachInterruptArg(digitalPinToInterrupt(dout_pin), dout_readout_isr, isr_readout, FALLING);
+    return true;
+}
+
+bool HX711Driver::pop_isr_sample() {
+    uint32_t tail = isr_readout->tail;
+    if (tail == isr_readout->head) {
+        return false;
+    }
+    last_raw_data = isr_readout->raw[tail & (HW_LOADCELL_ISR_RING_SIZE - 1)];
+    last_sample_time_us = isr_readout->edge_time_us[tail & (HW_LOADCELL_ISR_RING_SIZE - 1)];
+    isr_readout->tail = tail + 1;
+    data_ready_flag = true;
+    
+    uint32_t dropped = isr_readout->dropped;
+    if (dropped != isr_dropped_reported) {
+        LOG_RT_AT(LOG_CAT_LOADCELL, LOG_LEVEL_WARN, "HX711Driver: ISR readout ring full, %lu samples dropped so far\n",
+                  (unsigned long)dropped);
+        isr_dropped_reported = dropped;
+    }
     return true;
 }
 
+bool HX711Driver::enable_data_ready_interrupt(TaskHandle_t task) {
+    if (!task) {
+        return false;
+    }
+    
+    disable_data_ready_interrupt();
+    
+#if HW_LOADCELL_ISR_READOUT_ENABLED
+    if (supports_isr_readout() && start_isr_readout(task)) {
+        drdy_interrupt_enabled = true;
+        LOG_BLE("HX711Driver: DOUT interrupt readout (IRAM, %d sample ring) enabled on GPIO %d\n",
+                HW_LOADCELL_ISR_RING_SIZE, dout_pin);
+        return true;
+    }
+#endif
+    
+    drdy_notify_task = task;
+    drdy_edge_time_us = 0;
+    attachInterruptArg(digitalPinToInterrupt(dout_pin), dout_falling_isr, this, FALLING);
+    drdy_interrupt_enabled = true;
+    
+    LOG_BLE("HX711Driver: DOUT data-ready interrupt enabled on GPIO %d\n", dout_pin);
+    return true;
+}
+
+void HX711Driver::disable_data_ready_interrupt() {
+    if (!drdy_interrupt_enabled) {
+        return;
+    }
+    
+    detachInterrupt(digitalPinToInterrupt(dout_pin));
+    drdy_interrupt_enabled = false;
+    isr_readout_active = false;
+    drdy_notify_task = nullptr;
+    drdy_edge_time_us = 0;
+}
+
 void HX711Driver::conversion_24bit() {
+    // Interrupt mode stamps the sample at the DOUT edge; polling mode stamps it at readout
+    int64_t edge_time_us = drdy_edge_time_us;
+    last_sample_time_us = (drdy_interrupt_enabled && edge_time_us != 0) ? edge_time_us : esp_timer_get_time();
+    drdy_edge_time_us = 0;
+    
     // Record conversion timing
     unsigned long now = micros();
     if (conversion_start_time == 0) {
@@ -136,6 +352,32 @@ void HX711Driver::conversion_24bit() {
     conversion_start_time = now;
     
     uint32_t raw_data = 0;  // Use explicit 32-bit unsigned for ESP32 consistency
+    conversion_in_progress = true;
+    bool shifted = shift_in_raw_bits(&raw_data);
+    conversion_in_progress = false;
+    
+    if (!shifted) {
+        return; // Readout failed - keep previous sample
+    }
+    
+    // HX711_ADC exact data processing: normalize HX711's offset binary output
+    // HX711 natural range: 0x800000 to 0x7FFFFF
+    // XOR converts to:     0x000000 to 0xFFFFFF
+    raw_data = raw_data ^ 0x800000;
+    
+    // HX711_ADC data validation
+    if (raw_data > 0xFFFFFF) {
+        // Data out of range - this shouldn't happen with proper 24-bit data
+        LOG_RT_AT(LOG_CAT_LOADCELL, LOG_LEVEL_WARN, "HX711Driver: Data out of range - raw=0x%08lx\n", raw_data);
+        return; // Skip this invalid reading
+    }
+    
+    last_raw_data = (int32_t)raw_data;  // Explicit cast to int32_t for consistency
+    data_ready_flag = true;
+}
+
+bool HX711Driver::shift_in_raw_bits(uint32_t* raw_out) {
+    uint32_t raw_data = 0;
     
     // HX711_ADC interrupt protection: Disable interrupts during critical bit-bang conversion
     // This prevents BLE and other interrupts from disrupting the precise HX711 timing
@@ -155,20 +397,8 @@ void HX711Driver::conversion_24bit() {
     // Re-enable interrupts immediately after conversion
     interrupts();
     
-    // HX711_ADC exact data processing: normalize HX711's offset binary output
-    // HX711 natural range: 0x800000 to 0x7FFFFF
-    // XOR converts to:     0x000000 to 0xFFFFFF
-    raw_data = raw_data ^ 0x800000;
-    
-    // HX711_ADC data validation
-    if (raw_data > 0xFFFFFF) {
-        // Data out of range - this shouldn't happen with proper 24-bit data
-        LOG_BLE("HX711Driver: Data out of range - raw=0x%08lx\n", raw_data);
-        return; // Skip this invalid reading
-    }
-    
-    last_raw_data = (int32_t)raw_data;  // Explicit cast to int32_t for consistency
-    data_ready_flag = true;
+    *raw_out = raw_data;
+    return true;
 }
 
 int32_t HX711Driver::get_raw_data() const {
@@ -20,12 +20,17 @@
  * Licensed under MIT License
  */
 class HX711Driver : public LoadCellDriver {
-private:
+protected:
     // HX711 Hardware pins and configuration
     uint8_t sck_pin;
     uint8_t dout_pin;
+    int8_t rate_pin;              // -1 when RATE is strapped and the rate is fixed
     uint8_t gain;
     
+    // Output data rate state
+    volatile uint32_t current_rate_sps;
+    volatile uint8_t rate_switch_discard_remaining;
+    
     // HX711 hardware state
     int32_t last_raw_data;
     bool data_ready_flag;
@@ -33,17 +38,57 @@ private:
     unsigned long conversion_time;
     float estimated_sample_rate_sps;
     
+    // Data-ready interrupt state (DOUT falling edge wakes the sampling task)
+    TaskHandle_t drdy_notify_task;
+    volatile bool drdy_interrupt_enabled;
+    volatile bool conversion_in_progress;
+    volatile int64_t drdy_edge_time_us;
+    int64_t last_sample_time_us;
+    
     // HX711-specific timing constants
     static const uint8_t SCK_DELAY = 1;           // Microsecond delay after SCK toggle
     static const uint16_t SIGNAL_TIMEOUT = 100;  // Signal timeout in ms
     
     // HX711 hardware methods
     void conversion_24bit();
-    void power_up_sequence();
-    void power_down_sequence();
+    virtual bool configure_pins();          // Claim SCK/DOUT for the readout method
+    virtual bool shift_in_raw_bits(uint32_t* raw_out);  // Clock out 24 data bits + gain pulses
+    virtual void power_up_sequence();
+    virtual void power_down_sequence();
+    
+    static void IRAM_ATTR dout_falling_isr(void* arg);
+    
+    // ISR readout (HW_LOADCELL_ISR_READOUT_ENABLED): the DOUT ISR clocks the bits out through
+    // the GPIO registers and stages them here, so a sample that arrives while a flash write has
+    // the cache disabled (session files, NVS commits, OTA) waits in the ring instead of being
+    // overwritten by the next conversion. Everything the ISR touches lives in internal RAM.
+    struct IsrReadout {
+        volatile uint32_t* sck_set_reg;
+        volatile uint32_t* sck_clear_reg;
+        volatile const uint32_t* dout_in_reg;
+        uint32_t sck_mask;
+        uint32_t dout_mask;
+        volatile uint8_t pulses;            // 24 data bits + gain pulses
+        TaskHandle_t notify_task;
+        int32_t raw[HW_LOADCELL_ISR_RING_SIZE];       // Offset-corrected, like last_raw_data
+        int64_t edge_time_us[HW_LOADCELL_ISR_RING_SIZE];
+        volatile uint32_t head;             // Written by the ISR only
+        volatile uint32_t tail;             // Written by the sampling task only
+        volatile uint32_t dropped;          // Ring full: the task stalled for longer than the ring holds
+    };
+    IsrReadout* isr_readout;
+    bool isr_readout_active;
+    uint32_t isr_dropped_reported;
+    
+    // Subclasses with their own readout (SPI peripheral, ADS1232 calibration clocks) keep the task readout
+    virtual bool supports_isr_readout() const { return true; }
+    bool start_isr_readout(TaskHandle_t task);
+    bool pop_isr_sample();
+    static void IRAM_ATTR dout_readout_isr(void* arg);
     
 public:
-    HX711Driver(uint8_t sck_pin = HW_LOADCELL_SCK_PIN, uint8_t dout_pin = HW_LOADCELL_DOUT_PIN);
+    HX711Driver(uint8_t sck_pin = HW_LOADCELL_SCK_PIN, uint8_t dout_pin = HW_LOADCELL_DOUT_PIN,
+                int8_t rate_pin = HW_LOADCELL_RATE_PIN);
     virtual ~HX711Driver() = default;
     
     // Initialization and configuration
@@ -64,8 +109,17 @@ public:
     // HX711-specific capabilities
     bool supports_temperature_sensor() const override { return false; }
     float get_temperature() const override { return NAN; }
-    uint32_t get_max_sample_rate() const override { return HW_LOADCELL_SAMPLE_RATE_SPS; }
-    float get_estimated_sample_rate_sps() const { return estimated_sample_rate_sps; }
+    uint32_t get_max_sample_rate() const override {
+        return rate_pin >= 0 ? HW_LOADCELL_SAMPLE_RATE_HIGH_SPS : HW_LOADCELL_SAMPLE_RATE_SPS;
+    }
+    bool set_sample_rate(uint32_t sps) override;
+    uint32_t get_sample_rate() const override { return current_rate_sps; }
+    float get_estimated_sample_rate_sps() const override { return estimated_sample_rate_sps; }
+
+    bool enable_data_ready_interrupt(TaskHandle_t task) override;
+    void disable_data_ready_interrupt() override;
+    bool is_data_ready_interrupt_enabled() const override { return drdy_interrupt_enabled; }
+    int64_t get_last_sample_time_us() const override { return last_sample_time_us; }
 
     uint8_t get_current_gain() const;
     const char* get_driver_name() const override { return "HX711"; }
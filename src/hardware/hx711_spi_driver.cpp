@@ -0,0 +1,115 @@
+#include "hx711_spi_driver.h"
+#include "../config/constants.h"
+#include "../logging/deferred_log.h"
+#include <Arduino.h>
+#include <driver/gpio.h>
+
+HX711SpiDriver::HX711SpiDriver(uint8_t sck_pin, uint8_t dout_pin)
+    : HX711Driver(sck_pin, dout_pin, HW_LOADCELL_RATE_PIN), spi_device(nullptr), spi_attached(false) {
+}
+
+HX711SpiDriver::~HX711SpiDriver() {
+    detach_spi();
+}
+
+bool HX711SpiDriver::attach_spi() {
+    if (spi_attached) {
+        return true;
+    }
+
+    spi_bus_config_t bus_config = {};
+    bus_config.mosi_io_num = -1;
+    bus_config.miso_io_num = dout_pin;
+    bus_config.sclk_io_num = sck_pin;
+    bus_config.quadwp_io_num = -1;
+    bus_config.quadhd_io_num = -1;
+    bus_config.max_transfer_sz = 4;
+
+    esp_err_t err = spi_bus_initialize(HW_LOADCELL_SPI_HOST, &bus_config, SPI_DMA_CH_AUTO);
+    if (err != ESP_OK) {
+        LOG_BLE("HX711SpiDriver: spi_bus_initialize failed (%s)\n", esp_err_to_name(err));
+        return false;
+    }
+
+    // Mode 1: HX711 shifts DOUT on SCK rising edge, sample on the falling edge.
+    // Receive-only half duplex so no MOSI phase is clocked.
+    spi_device_interface_config_t dev_config = {};
+    dev_config.mode = 1;
+    dev_config.clock_speed_hz = HW_LOADCELL_SPI_CLOCK_HZ;
+    dev_config.spics_io_num = -1;
+    dev_config.queue_size = 1;
+    dev_config.flags = SPI_DEVICE_HALFDUPLEX;
+
+    err = spi_bus_add_device(HW_LOADCELL_SPI_HOST, &dev_config, &spi_device);
+    if (err != ESP_OK) {
+        LOG_BLE("HX711SpiDriver: spi_bus_add_device failed (%s)\n", esp_err_to_name(err));
+        spi_bus_free(HW_LOADCELL_SPI_HOST);
+        spi_device = nullptr;
+        return false;
+    }
+
+    spi_attached = true;
+    return true;
+}
+
+void HX711SpiDriver::detach_spi() {
+    if (!spi_attached) {
+        return;
+    }
+
+    spi_bus_remove_device(spi_device);
+    spi_bus_free(HW_LOADCELL_SPI_HOST);
+    spi_device = nullptr;
+    spi_attached = false;
+}
+
+bool HX711SpiDriver::configure_pins() {
+    // Start from plain GPIO (SCK low keeps the HX711 awake), then hand both pins to SPI
+    detach_spi();
+    HX711Driver::configure_pins();
+    digitalWrite(sck_pin, LOW);
+
+    if (!attach_spi()) {
+        return false;
+    }
+
+    LOG_BLE("HX711SpiDriver: SCK=%d DOUT=%d on SPI host %d @ %luHz\n",
+            sck_pin, dout_pin, (int)HW_LOADCELL_SPI_HOST, (unsigned long)HW_LOADCELL_SPI_CLOCK_HZ);
+    return true;
+}
+
+bool HX711SpiDriver::shift_in_raw_bits(uint32_t* raw_out) {
+    if (!spi_attached) {
+        // Pins belong to GPIO (e.g. read right after power_up() failed to re-attach)
+        return HX711Driver::shift_in_raw_bits(raw_out);
+    }
+
+    // 24 data bits followed by 1-3 gain select pulses, all in one transfer;
+    // the bits clocked after the data word are discarded
+    spi_transaction_t transaction = {};
+    transaction.flags = SPI_TRANS_USE_RXDATA;
+    transaction.length = 0;
+    transaction.rxlength = 24 + gain;
+
+    esp_err_t err = spi_device_transmit(spi_device, &transaction);
+    if (err != ESP_OK) {
+        LOG_RT_AT(LOG_CAT_LOADCELL, LOG_LEVEL_WARN, "HX711SpiDriver: SPI readout failed (%s)\n", esp_err_to_name(err));
+        return false;
+    }
+
+    *raw_out = ((uint32_t)transaction.rx_data[0] << 16) |
+               ((uint32_t)transaction.rx_data[1] << 8) |
+               (uint32_t)transaction.rx_data[2];
+    return true;
+}
+
+void HX711SpiDriver::power_up_sequence() {
+    HX711Driver::power_up_sequence();
+    attach_spi();
+}
+
+void HX711SpiDriver::power_down_sequence() {
+    // SCK must be held high by GPIO; the SPI clock idles low
+    detach_spi();
+    HX711Driver::power_down_sequence();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../config/constants.h"
+#include "hx711_driver.h"
+#include <driver/spi_master.h>
+
+/**
+ * HX711 SPI Driver
+ *
+ * Variant of HX711Driver that clocks the 24 data bits + gain pulses with the
+ * ESP32-S3 SPI peripheral instead of bit-banging SCK under noInterrupts().
+ * SCK is driven as the SPI clock and DOUT is sampled as MISO (mode 1: HX711
+ * shifts on the rising edge, the peripheral samples on the falling edge), so
+ * the readout has no interrupt-off window and the sampling task sleeps while
+ * the transfer runs.
+ *
+ * Uses its own SPI host (the display owns SPI2). For power-down the pins are
+ * handed back to GPIO so SCK can be held high for >60µs.
+ */
+class HX711SpiDriver : public HX711Driver {
+private:
+    spi_device_handle_t spi_device;
+    bool spi_attached;
+
+    bool attach_spi();
+    void detach_spi();
+
+protected:
+    bool configure_pins() override;
+    bool shift_in_raw_bits(uint32_t* raw_out) override;
+    void power_up_sequence() override;
+    void power_down_sequence() override;
+    // The bits come through the SPI peripheral, which the ISR cannot drive
+    bool supports_isr_readout() const override { return false; }
+
+public:
+    HX711SpiDriver(uint8_t sck_pin = HW_LOADCELL_SCK_PIN, uint8_t dout_pin = HW_LOADCELL_DOUT_PIN);
+    ~HX711SpiDriver() override;
+
+    const char* get_driver_name() const override { return "HX711 (SPI)"; }
+};
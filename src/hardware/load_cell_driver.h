@@ -1,12 +1,15 @@
 #pragma once
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 /**
  * Abstract interface for load cell ADC drivers.
  *
- * Enables runtime selection between the physical HX711 driver and compile-time
- * configurable mock implementations used for simulation and testing.
+ * Enables runtime selection between the physical ADC backends (HX711, ADS1232,
+ * NAU7802) and compile-time configurable mock implementations used for
+ * simulation and testing.
  */
 class LoadCellDriver {
 public:
@@ -30,5 +33,28 @@ public:
     virtual float get_temperature() const = 0;
     virtual uint32_t get_max_sample_rate() const = 0;
 
+    // Runtime output data rate. Drivers without a switchable rate accept only their fixed rate.
+    virtual bool set_sample_rate(uint32_t sps) { return sps == get_max_sample_rate(); }
+    virtual uint32_t get_sample_rate() const { return get_max_sample_rate(); }
+    // Rate measured during validate_hardware() (catches mis-strapped rate pins)
+    virtual float get_estimated_sample_rate_sps() const { return (float)get_sample_rate(); }
+
     virtual const char* get_driver_name() const = 0;
+
+    // Optional data-ready interrupt. Drivers that can signal a finished conversion
+    // on an edge notify `task` from the ISR; the default falls back to polling.
+    virtual bool enable_data_ready_interrupt(TaskHandle_t task) { (void)task; return false; }
+    virtual void disable_data_ready_interrupt() {}
+    virtual bool is_data_ready_interrupt_enabled() const { return false; }
+
+    // Capture time of the latest sample (esp_timer µs, 0 if the driver doesn't track it)
+    virtual int64_t get_last_sample_time_us() const { return 0; }
+
+    // Multi-channel drivers sum their channels into get_raw_data(), each scaled to channel 0
+    // counts by its gain, so the range grows with the channel count
+    virtual uint8_t get_channel_count() const { return 1; }
+    virtual int32_t get_channel_raw_data(uint8_t channel) const { return channel == 0 ? get_raw_data() : 0; }
+    virtual bool set_channel_gain(uint8_t channel, float gain) { (void)gain; return channel == 0; }
+    virtual float get_channel_gain(uint8_t channel) const { (void)channel; return 1.0f; }
+    virtual int32_t get_raw_max() const { return 0xFFFFFF; }
 };
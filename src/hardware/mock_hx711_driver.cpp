@@ -1,15 +1,21 @@
 #include "mock_hx711_driver.h"
 #include "../config/constants.h"
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #ifdef ESP_PLATFORM
 #include <esp_system.h>
 #endif
 
 MockHX711Driver* MockHX711Driver::instance = nullptr;
+MockGrinderModel MockHX711Driver::model;
 
-MockHX711Driver::MockHX711Driver() {
-    instance = this;
+MockHX711Driver::MockHX711Driver()
+    : sample_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS), sample_interval_ms(HW_LOADCELL_SAMPLE_INTERVAL_MS) {
+    // The grinder notifications drive the first grinder's scale; a second channel's mock stays an empty cup
+    if (!instance) {
+        instance = this;
+    }
     reset_state();
 }
 
@@ -25,6 +31,10 @@ void MockHX711Driver::reset_state() {
     next_sample_due_ms = 0;
     simulated_mass_g = 0.0f;
     pending_pulse_mass_g = 0.0f;
+    retained_mass_g = 0.0f;
+    burst_mass_g = 0.0f;
+    vibration_phase = 0.0f;
+    motor_spinning = false;
     data_ready_flag = false;
 
     continuous_commanded = false;
@@ -33,6 +43,7 @@ void MockHX711Driver::reset_state() {
     continuous_start_ms = 0;
     continuous_stop_ms = 0;
     continuous_ramp_start_ms = 0;
+    continuous_duty = 1.0f;
 
     pulse_command_active = false;
     pulse_started = false;
@@ -53,11 +64,22 @@ bool MockHX711Driver::begin(uint8_t gain_value) {
     reset_state();
     unsigned long now = millis();
     last_sample_time_ms = now;
-    next_sample_due_ms = now + HW_LOADCELL_SAMPLE_INTERVAL_MS;
+    next_sample_due_ms = now + sample_interval_ms;
     last_raw_data = static_cast<int32_t>(DEBUG_MOCK_BASELINE_RAW);
     data_ready_flag = false;
     LOG_BLE("MockHX711Driver: initialized (flow=%.2fg/s, cal=%.1f)\n",
-            DEBUG_MOCK_FLOW_RATE_GPS, DEBUG_MOCK_CAL_FACTOR);
+            model.flow_rate_gps, DEBUG_MOCK_CAL_FACTOR);
+    return true;
+}
+
+bool MockHX711Driver::set_sample_rate(uint32_t sps) {
+    if (sps != HW_LOADCELL_SAMPLE_RATE_SPS && sps != HW_LOADCELL_SAMPLE_RATE_HIGH_SPS) {
+        return false;
+    }
+    // Simulates a wired RATE pin so high-rate control paths can be exercised without hardware
+    sample_rate_sps = sps;
+    sample_interval_ms = 1000 / sps;
+    next_sample_due_ms = millis() + sample_interval_ms;
     return true;
 }
 
@@ -93,13 +115,19 @@ bool MockHX711Driver::update_async() {
 
     unsigned long now = millis();
     last_sample_time_ms = now;
-    next_sample_due_ms = now + HW_LOADCELL_SAMPLE_INTERVAL_MS;
+    next_sample_due_ms = now + sample_interval_ms;
 
     float mass_increment = 0.0f;
     bool continuous_flow = false;
     bool pulse_flow = false;
     process_motor_state(now, mass_increment, continuous_flow, pulse_flow);
 
+    // Motor load: this sample's flow against full speed
+    float load = std::min(1.0f, mass_increment / grams_per_sample());
+    bool spinning = continuous_flow || pulse_flow;
+    update_chute(mass_increment, load, spinning && !motor_spinning);
+    motor_spinning = spinning;
+
     if (mass_increment > 0.0f) {
         simulated_mass_g += mass_increment;
     }
@@ -113,13 +141,14 @@ bool MockHX711Driver::update_async() {
     float raw_value = static_cast<float>(DEBUG_MOCK_BASELINE_RAW);
     raw_value += simulated_mass_g * DEBUG_MOCK_CAL_FACTOR;
 
-    float noise_peak = DEBUG_MOCK_IDLE_NOISE_RAW;
-    if (pulse_flow) {
-        noise_peak = DEBUG_MOCK_GRIND_NOISE_RAW * 3.0f;
-    } else if (continuous_flow) {
-        noise_peak = DEBUG_MOCK_GRIND_NOISE_RAW;
+    // Vibration grows with the load; a pulse spinning up shakes harder
+    float vibration = model.vibration_noise_raw * load * (pulse_flow ? DEBUG_MOCK_PULSE_NOISE_GAIN : 1.0f);
+    raw_value += random_noise(std::max(model.idle_noise_raw, vibration) * model.noise_scale);
+    if (model.vibration_tone_raw > 0.0f && model.vibration_hz > 0.0f) {
+        const float two_pi = 6.2831853f;
+        vibration_phase = fmodf(vibration_phase + two_pi * model.vibration_hz / sample_rate_sps, two_pi);
+        raw_value += sinf(vibration_phase) * model.vibration_tone_raw * load * model.noise_scale;
     }
-    raw_value += random_noise(noise_peak);
 
     raw_value = std::max(0.0f, std::min(raw_value, 16777215.0f)); // Clamp to 24-bit range
     last_raw_data = static_cast<int32_t>(raw_value);
@@ -156,7 +185,7 @@ float MockHX711Driver::process_continuous_state(unsigned long now_ms, bool& cont
 
     if (continuous_commanded) {
         if (!continuous_started) {
-            if (now_ms - continuous_start_ms >= DEBUG_MOCK_START_DELAY_MS) {
+            if (now_ms - continuous_start_ms >= model.start_delay_ms) {
                 continuous_started = true;
                 continuous_ramp_start_ms = now_ms;
             }
@@ -164,27 +193,24 @@ float MockHX711Driver::process_continuous_state(unsigned long now_ms, bool& cont
 
         if (continuous_started) {
             continuous_flow = true;
-            if (DEBUG_MOCK_FLOW_RAMP_MS <= 0) {
+            if (model.ramp_ms == 0) {
                 flow_factor = 1.0f;
             } else {
                 unsigned long elapsed = now_ms - continuous_ramp_start_ms;
-                flow_factor = std::min(1.0f, static_cast<float>(elapsed) / static_cast<float>(DEBUG_MOCK_FLOW_RAMP_MS));
+                flow_factor = std::min(1.0f, static_cast<float>(elapsed) / static_cast<float>(model.ramp_ms));
             }
+            flow_factor *= continuous_duty;
         }
     } else if (continuous_stop_pending) {
         unsigned long elapsed = now_ms - continuous_stop_ms;
-        float ramp_factor = 0.0f;
-        if (DEBUG_MOCK_FLOW_RAMP_MS > 0) {
-            ramp_factor = std::max(0.0f, 1.0f - static_cast<float>(elapsed) / static_cast<float>(DEBUG_MOCK_FLOW_RAMP_MS));
-        }
+        float ramp_factor = ramp_down_factor(elapsed);
 
         if (ramp_factor > 0.0f) {
             continuous_flow = true;
-            flow_factor = ramp_factor;
+            flow_factor = ramp_factor * continuous_duty;
         }
 
-        uint32_t stop_threshold = std::max<uint32_t>(DEBUG_MOCK_STOP_DELAY_MS, DEBUG_MOCK_FLOW_RAMP_MS);
-        if (elapsed >= stop_threshold) {
+        if (elapsed >= spin_down_ms()) {
             continuous_stop_pending = false;
             continuous_started = false;
         }
@@ -204,7 +230,7 @@ float MockHX711Driver::process_pulse_state(unsigned long now_ms, bool& pulse_flo
     float flow_factor = 0.0f;
 
     if (pulse_command_active && !pulse_started) {
-        if (now_ms - pulse_start_ms >= DEBUG_MOCK_START_DELAY_MS) {
+        if (now_ms - pulse_start_ms >= model.start_delay_ms) {
             pulse_started = true;
             pulse_ramp_start_ms = now_ms;
         }
@@ -216,29 +242,24 @@ float MockHX711Driver::process_pulse_state(unsigned long now_ms, bool& pulse_flo
     }
 
     if (pulse_started && pulse_command_active && !pulse_stop_pending) {
-        if (DEBUG_MOCK_FLOW_RAMP_MS <= 0) {
+        if (model.ramp_ms == 0) {
             flow_factor = 1.0f;
         } else {
             unsigned long elapsed = now_ms - pulse_ramp_start_ms;
-            flow_factor = std::min(1.0f, static_cast<float>(elapsed) / static_cast<float>(DEBUG_MOCK_FLOW_RAMP_MS));
+            flow_factor = std::min(1.0f, static_cast<float>(elapsed) / static_cast<float>(model.ramp_ms));
         }
         if (flow_factor > 0.0f && pending_pulse_mass_g > 0.0f) {
             pulse_flow = true;
         }
     } else if (pulse_started && pulse_stop_pending) {
         unsigned long elapsed = now_ms - pulse_stop_ms;
-        if (DEBUG_MOCK_FLOW_RAMP_MS > 0) {
-            flow_factor = std::max(0.0f, 1.0f - static_cast<float>(elapsed) / static_cast<float>(DEBUG_MOCK_FLOW_RAMP_MS));
-        } else {
-            flow_factor = 0.0f;
-        }
+        flow_factor = ramp_down_factor(elapsed);
 
         if (flow_factor > 0.0f && pending_pulse_mass_g > 0.0f) {
             pulse_flow = true;
         }
 
-        uint32_t stop_threshold = std::max<uint32_t>(DEBUG_MOCK_STOP_DELAY_MS, DEBUG_MOCK_FLOW_RAMP_MS);
-        if (elapsed >= stop_threshold) {
+        if (elapsed >= spin_down_ms()) {
             pulse_stop_pending = false;
             pulse_command_active = false;
             pulse_started = false;
@@ -261,21 +282,75 @@ float MockHX711Driver::process_pulse_state(unsigned long now_ms, bool& pulse_flo
     return addition;
 }
 
+// Flow left elapsed_ms after a stop: full for the coast hold, then the exponential
+// tail (coast_tau_ms) or the linear ramp down
+float MockHX711Driver::ramp_down_factor(unsigned long elapsed_ms) {
+    if (elapsed_ms < model.coast_ms) {
+        return 1.0f;
+    }
+    float tail_ms = static_cast<float>(elapsed_ms - model.coast_ms);
+    if (model.coast_tau_ms > 0) {
+        float factor = expf(-tail_ms / static_cast<float>(model.coast_tau_ms));
+        return factor < 0.01f ? 0.0f : factor;
+    }
+    if (model.ramp_ms == 0) {
+        return 0.0f;
+    }
+    return std::max(0.0f, 1.0f - tail_ms / static_cast<float>(model.ramp_ms));
+}
+
+// Time from a stop until the motor state is idle again
+uint32_t MockHX711Driver::spin_down_ms() {
+    uint32_t tail_ms = model.coast_tau_ms > 0 ? model.coast_tau_ms * 5 : model.ramp_ms;   // e^-5 < 1%
+    return std::max<uint32_t>(model.stop_delay_ms, model.coast_ms + tail_ms);
+}
+
+// Chute retention and clumping: part of the flow is held back and falls later in a
+// burst, at a spin-up or shaken loose; clumps land as bursts on top of the flow
+void MockHX711Driver::update_chute(float& mass_add, float load, bool spin_up) {
+    const float sample_s = 1.0f / static_cast<float>(sample_rate_sps);
+    if (model.retention_fraction > 0.0f && mass_add > 0.0f) {
+        float held = std::min(mass_add * model.retention_fraction, model.retention_capacity_g - retained_mass_g);
+        if (held > 0.0f) {
+            retained_mass_g += held;
+            mass_add -= held;
+        }
+    }
+    if (load > 0.0f && retained_mass_g > 0.0f &&
+        (spin_up || random_unit() < model.retention_release_hz * sample_s)) {
+        burst_mass_g += retained_mass_g;
+        retained_mass_g = 0.0f;
+    }
+    if (load > 0.0f && model.clump_rate_hz > 0.0f && random_unit() < model.clump_rate_hz * load * sample_s) {
+        burst_mass_g += model.clump_mass_g;
+    }
+    if (burst_mass_g > 0.0f) {
+        // Lands mostly within clump_ms (first-order)
+        float share = model.clump_ms > 0 ? std::min(1.0f, sample_s * 1000.0f / model.clump_ms) : 1.0f;
+        float landing = burst_mass_g < 0.001f ? burst_mass_g : burst_mass_g * share;
+        burst_mass_g -= landing;
+        mass_add += landing;
+    }
+}
+
 float MockHX711Driver::grams_per_sample() const {
-    return DEBUG_MOCK_FLOW_RATE_GPS / static_cast<float>(HW_LOADCELL_SAMPLE_RATE_SPS);
+    return model.flow_rate_gps / static_cast<float>(sample_rate_sps);
 }
 
 float MockHX711Driver::random_noise(float peak) const {
     if (peak <= 0.0f) {
         return 0.0f;
     }
+    return (random_unit() * 2.0f - 1.0f) * peak;
+}
+
+float MockHX711Driver::random_unit() const {
 #ifdef ESP_PLATFORM
     uint32_t value = esp_random();
 #else
     uint32_t value = static_cast<uint32_t>(random());
 #endif
-    const float normalized = static_cast<float>(value) / static_cast<float>(UINT32_MAX);
-    return (normalized * 2.0f - 1.0f) * peak;
+    return static_cast<float>(value) / static_cast<float>(UINT32_MAX);
 }
 
 void MockHX711Driver::handle_grinder_start_request(unsigned long now_ms) {
@@ -284,6 +359,7 @@ void MockHX711Driver::handle_grinder_start_request(unsigned long now_ms) {
     continuous_stop_pending = false;
     continuous_start_ms = now_ms;
     continuous_ramp_start_ms = now_ms;
+    continuous_duty = 1.0f;
 }
 
 void MockHX711Driver::handle_grinder_stop_request(unsigned long now_ms) {
@@ -309,7 +385,7 @@ void MockHX711Driver::handle_pulse_request(unsigned long now_ms, uint32_t durati
     // Only add mass if pulse duration exceeds motor latency threshold
     // This simulates the real motor behavior where short pulses don't produce grounds
     if (static_cast<float>(duration_ms) >= DEBUG_MOCK_MOTOR_LATENCY_MS) {
-        pending_pulse_mass_g += DEBUG_MOCK_FLOW_RATE_GPS * (static_cast<float>(duration_ms - DEBUG_MOCK_MOTOR_LATENCY_MS) / 1000.0f);
+        pending_pulse_mass_g += model.flow_rate_gps * (static_cast<float>(duration_ms - DEBUG_MOCK_MOTOR_LATENCY_MS) / 1000.0f);
     } else {
         // Pulse too short - no grounds will be produced
         pending_pulse_mass_g = 0.0f;
@@ -328,6 +404,12 @@ void MockHX711Driver::notify_grinder_stop() {
     }
 }
 
+void MockHX711Driver::notify_grinder_speed(float duty) {
+    if (instance) {
+        instance->continuous_duty = duty;
+    }
+}
+
 void MockHX711Driver::notify_pulse(uint32_t duration_ms) {
     if (instance) {
         instance->handle_pulse_request(millis(), duration_ms);
@@ -4,6 +4,29 @@
 #include "../config/constants.h"
 #include <Arduino.h>
 
+// Grinder behaviour behind the mock readings; the defaults come from config/debug.h.
+// The host simulation takes one from --model (grinder.py fit-model fits it to recorded
+// sessions) and with --seed draws a variation of it per dose.
+struct MockGrinderModel {
+    float flow_rate_gps = DEBUG_MOCK_FLOW_RATE_GPS;     // Full-speed flow (bean and grind setting variance)
+    uint32_t start_delay_ms = DEBUG_MOCK_START_DELAY_MS;
+    uint32_t stop_delay_ms = DEBUG_MOCK_STOP_DELAY_MS;
+    uint32_t ramp_ms = DEBUG_MOCK_FLOW_RAMP_MS;         // Spin-up, and the linear spin-down without a coast tail
+    uint32_t coast_ms = DEBUG_MOCK_COAST_MS;            // Full flow kept after a stop before the tail
+    uint32_t coast_tau_ms = DEBUG_MOCK_COAST_TAU_MS;    // Exponential tail time constant; 0: linear ramp down
+    float noise_scale = 1.0f;                           // Multiplies every noise term
+    float idle_noise_raw = DEBUG_MOCK_IDLE_NOISE_RAW;   // Peak noise with the motor still
+    float vibration_noise_raw = DEBUG_MOCK_GRIND_NOISE_RAW;  // Peak noise at full load; scales with the flow
+    float vibration_hz = DEBUG_MOCK_VIBRATION_HZ;
+    float vibration_tone_raw = DEBUG_MOCK_VIBRATION_TONE_RAW;
+    float clump_rate_hz = DEBUG_MOCK_CLUMP_RATE_HZ;     // Clumps per second of flow, each adding clump_mass_g
+    float clump_mass_g = DEBUG_MOCK_CLUMP_MASS_G;
+    uint32_t clump_ms = DEBUG_MOCK_CLUMP_MS;
+    float retention_fraction = DEBUG_MOCK_RETENTION_FRACTION;  // Flow share held in the chute up to capacity
+    float retention_capacity_g = DEBUG_MOCK_RETENTION_CAPACITY_G;
+    float retention_release_hz = DEBUG_MOCK_RETENTION_RELEASE_HZ;  // Held grounds fall at each spin-up, or at this rate
+};
+
 /**
  * MockHX711Driver provides a compile-time selectable simulated implementation of
  * the HX711 ADC. It generates synthetic raw ADC readings with configurable flow
@@ -31,38 +54,54 @@ public:
 
     bool supports_temperature_sensor() const override { return false; }
     float get_temperature() const override { return NAN; }
-    uint32_t get_max_sample_rate() const override { return HW_LOADCELL_SAMPLE_RATE_SPS; }
+    uint32_t get_max_sample_rate() const override { return HW_LOADCELL_SAMPLE_RATE_HIGH_SPS; }
+    bool set_sample_rate(uint32_t sps) override;
+    uint32_t get_sample_rate() const override { return sample_rate_sps; }
 
     const char* get_driver_name() const override { return "HX711_MOCK"; }
 
     // Grinder interaction helpers
     static void notify_grinder_start();
     static void notify_grinder_stop();
+    static void notify_grinder_speed(float duty);
     static void notify_pulse(uint32_t duration_ms);
     static bool is_pulse_active();
+    static void set_model(const MockGrinderModel& grinder_model) { model = grinder_model; }
+    static const MockGrinderModel& get_model() { return model; }
 
 private:
     static MockHX711Driver* instance;
+    static MockGrinderModel model;
 
     // Internal helpers
     void reset_state();
     void process_motor_state(unsigned long now_ms, float& total_mass_add, bool& continuous_flow, bool& pulse_flow);
     float process_continuous_state(unsigned long now_ms, bool& continuous_flow);
     float process_pulse_state(unsigned long now_ms, bool& pulse_flow);
+    static float ramp_down_factor(unsigned long elapsed_ms);
+    static uint32_t spin_down_ms();
+    void update_chute(float& mass_add, float load, bool spin_up);
     float grams_per_sample() const;
     float random_noise(float peak) const;
+    float random_unit() const;
 
     void handle_grinder_start_request(unsigned long now_ms);
     void handle_grinder_stop_request(unsigned long now_ms);
     void handle_pulse_request(unsigned long now_ms, uint32_t duration_ms);
 
     // Sample generation
+    uint32_t sample_rate_sps;
+    uint32_t sample_interval_ms;
     int32_t last_raw_data;
     unsigned long last_sample_time_ms;
     unsigned long next_sample_due_ms;
 
     float simulated_mass_g;
     float pending_pulse_mass_g;
+    float retained_mass_g;              // Held in the chute
+    float burst_mass_g;                 // Clumps and released retention still landing
+    float vibration_phase;              // Radians of the vibration tone
+    bool motor_spinning;                // Flow last sample (spin-up edge detection)
 
     bool data_ready_flag;
 
@@ -73,6 +112,7 @@ private:
     unsigned long continuous_start_ms;
     unsigned long continuous_stop_ms;
     unsigned long continuous_ramp_start_ms;
+    float continuous_duty;              // Flow scales with the commanded motor duty
 
     // Pulse command state
     bool pulse_command_active;
@@ -0,0 +1,115 @@
+#include "motor_current_sensor.h"
+#include <esp_timer.h>
+#include <math.h>
+
+bool MotorCurrentSensor::begin() {
+    if (handle) {
+        return true;
+    }
+
+    adc_continuous_handle_cfg_t handle_config = {};
+    handle_config.conv_frame_size = FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES;
+    handle_config.max_store_buf_size = handle_config.conv_frame_size * 2;
+    handle_config.flags.flush_pool = 1;
+    if (adc_continuous_new_handle(&handle_config, &handle) != ESP_OK) {
+        LOG_BLE("MotorCurrentSensor: no continuous ADC handle\n");
+        handle = nullptr;
+        return false;
+    }
+
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = ADC_ATTEN_DB_12;
+    pattern.channel = HW_MOTOR_CURRENT_ADC1_CHANNEL;
+    pattern.unit = ADC_UNIT_1;
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+    adc_continuous_config_t config = {};
+    config.pattern_num = 1;
+    config.adc_pattern = &pattern;
+    config.sample_freq_hz = HW_MOTOR_CURRENT_SAMPLE_RATE_HZ;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+
+    adc_continuous_evt_cbs_t callbacks = {};
+    callbacks.on_conv_done = on_conversion_done;
+
+    if (adc_continuous_config(handle, &config) != ESP_OK ||
+        adc_continuous_register_event_callbacks(handle, &callbacks, this) != ESP_OK ||
+        adc_continuous_start(handle) != ESP_OK) {
+        LOG_BLE("MotorCurrentSensor: ADC1 channel %d failed to start\n", HW_MOTOR_CURRENT_ADC1_CHANNEL);
+        adc_continuous_deinit(handle);
+        handle = nullptr;
+        return false;
+    }
+
+    LOG_BLE("MotorCurrentSensor: ADC1 channel %d at %d Hz, %dms windows (%s)\n", HW_MOTOR_CURRENT_ADC1_CHANNEL,
+            HW_MOTOR_CURRENT_SAMPLE_RATE_HZ, HW_MOTOR_CURRENT_WINDOW_MS,
+            HW_MOTOR_CURRENT_AC_COUPLED ? "AC RMS" : "DC mean");
+    return true;
+}
+
+bool IRAM_ATTR MotorCurrentSensor::on_conversion_done(adc_continuous_handle_t, const adc_continuous_evt_data_t* event,
+                                                      void* user_data) {
+    MotorCurrentSensor* sensor = static_cast<MotorCurrentSensor*>(user_data);
+
+    // Integers only: the FPU is not saved for interrupts
+    uint32_t count = 0;
+    uint32_t sum = 0;
+    uint64_t sum_squares = 0;
+    for (uint32_t offset = 0; offset + SOC_ADC_DIGI_RESULT_BYTES <= event->size; offset += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t* result = (const adc_digi_output_data_t*)&event->conv_frame_buffer[offset];
+        if (result->type2.channel != HW_MOTOR_CURRENT_ADC1_CHANNEL) {
+            continue;
+        }
+        const uint32_t value = result->type2.data;
+        count++;
+        sum += value;
+        sum_squares += value * value;
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    const uint32_t seq = sensor->publish_seq.load(std::memory_order_relaxed);
+    Frame& frame = sensor->frames.slot(seq);
+    frame.end_us = (uint32_t)esp_timer_get_time();
+    frame.count = count;
+    frame.sum = sum;
+    frame.sum_squares = sum_squares;
+    sensor->publish_seq.store(seq + 1, std::memory_order_release);
+    return false;
+}
+
+bool MotorCurrentSensor::read_window(uint32_t* next_seq, Window* window_out) {
+    const uint32_t end_seq = publish_seq.load(std::memory_order_acquire);
+    uint32_t seq = *next_seq;
+    if (seq == end_seq) {
+        return false;
+    }
+    // Never read the slots the ISR may be about to overwrite
+    const uint32_t readable = RING_SIZE - READER_GUARD_SLOTS;
+    if (end_seq - seq > readable) {
+        overflow_count.fetch_add(end_seq - readable - seq, std::memory_order_relaxed);
+        seq = end_seq - readable;
+    }
+
+    const Frame frame = frames.slot(seq);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (publish_seq.load(std::memory_order_relaxed) - seq >= RING_SIZE) {
+        // Lapped while copying: skip ahead on the next call
+        *next_seq = seq + 1;
+        overflow_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    *next_seq = seq + 1;
+
+#if HW_MOTOR_CURRENT_AC_COUPLED
+    // Variance times count^2, exact in 64 bits (a float mean square cancels badly at mid-scale)
+    const int64_t scaled_variance = (int64_t)frame.count * (int64_t)frame.sum_squares - (int64_t)frame.sum * frame.sum;
+    window_out->level = sqrtf((float)(scaled_variance > 0 ? scaled_variance : 0)) / (float)frame.count;
+#else
+    window_out->level = (float)frame.sum / (float)frame.count;
+#endif
+    window_out->end_us = frame.end_us;
+    return true;
+}
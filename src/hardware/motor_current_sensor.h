@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_adc/adc_continuous.h>
+#include "../config/constants.h"
+#include "ring.h"
+
+/**
+ * MotorCurrentSensor - Motor current level per window from a continuous-mode ADC
+ *
+ * A current transformer (burden resistor, biased to mid-supply) or a shunt
+ * amplifier drives HW_MOTOR_CURRENT_ADC1_CHANNEL. The ADC runs continuously at
+ * HW_MOTOR_CURRENT_SAMPLE_RATE_HZ into DMA frames of exactly one
+ * HW_MOTOR_CURRENT_WINDOW_MS window. The conversion-done ISR reduces each frame
+ * straight from the DMA buffer to a count, sum and sum of squares (integer
+ * only, IRAM) and publishes it with its completion time in a small lock-free
+ * ring; the driver's frame pool is never read (flush_pool drops its oldest).
+ *
+ * read_window() turns a published window into a level in ADC counts: the RMS
+ * about the window mean for an AC-coupled transformer (a whole number of mains
+ * cycles per window), the mean for a DC shunt. The consumer (Grinder on the
+ * grind control task) drains windows in order; the ring holds 320ms at 20ms
+ * windows, and a slower consumer skips the overwritten ones.
+ */
+class MotorCurrentSensor {
+public:
+    struct Window {
+        uint32_t end_us;            // Frame completion, esp_timer µs (low 32 bits)
+        float level;                // ADC counts
+    };
+
+    bool begin();
+    bool is_running() const { return handle != nullptr; }
+
+    // Oldest unread window from *next_seq; false when caught up
+    bool read_window(uint32_t* next_seq, Window* window_out);
+    uint32_t get_window_count() const { return publish_seq.load(std::memory_order_acquire); }
+    uint32_t get_overflow_count() const { return overflow_count.load(std::memory_order_relaxed); }
+
+private:
+    struct Frame {
+        uint32_t end_us;
+        uint32_t count;
+        uint32_t sum;
+        uint64_t sum_squares;
+    };
+
+    static constexpr uint32_t FRAME_SAMPLES = HW_MOTOR_CURRENT_SAMPLE_RATE_HZ * HW_MOTOR_CURRENT_WINDOW_MS / 1000;
+    static constexpr uint32_t RING_SIZE = 16;
+    static constexpr uint32_t READER_GUARD_SLOTS = 4;
+    static_assert(FRAME_SAMPLES >= 16, "HW_MOTOR_CURRENT_WINDOW_MS too short for HW_MOTOR_CURRENT_SAMPLE_RATE_HZ");
+
+    adc_continuous_handle_t handle = nullptr;
+    Ring<Frame, RING_SIZE> frames;          // Indexed by publish sequence
+    std::atomic<uint32_t> publish_seq{0};
+    std::atomic<uint32_t> overflow_count{0};    // Windows the consumer missed (read_window)
+
+    static bool IRAM_ATTR on_conversion_done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t* event,
+                                             void* user_data);
+};
@@ -0,0 +1,104 @@
+#include "motor_edge_timeline.h"
+#include "../system/trace.h"
+
+namespace {
+bool same_type(MotorEdgeType candidate, MotorEdgeType wanted) {
+    return candidate == wanted;
+}
+
+bool same_direction(MotorEdgeType candidate, MotorEdgeType wanted) {
+    return MotorEdgeTimeline::is_on_edge(candidate) == MotorEdgeTimeline::is_on_edge(wanted);
+}
+}
+
+MotorEdgeTimeline::MotorEdgeTimeline() : edge_count(0) {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    for (uint8_t i = 0; i < CAPACITY; i++) {
+        edges[i].timestamp_us = 0;
+        edges[i].type = MotorEdgeType::STOP;
+    }
+}
+
+void MotorEdgeTimeline::record(MotorEdgeType type, uint32_t timestamp_us) {
+    portENTER_CRITICAL(&lock);
+    Edge& edge = edges[edge_count & INDEX_MASK];
+    edge.timestamp_us = timestamp_us;
+    edge.type = type;
+    edge_count++;
+    portEXIT_CRITICAL(&lock);
+    trace.instant(TraceId::MOTOR_EDGE, (uint16_t)type);
+}
+
+void IRAM_ATTR MotorEdgeTimeline::record_from_isr(MotorEdgeType type, uint32_t timestamp_us) {
+    portENTER_CRITICAL_ISR(&lock);
+    Edge& edge = edges[edge_count & INDEX_MASK];
+    edge.timestamp_us = timestamp_us;
+    edge.type = type;
+    edge_count++;
+    portEXIT_CRITICAL_ISR(&lock);
+}
+
+bool MotorEdgeTimeline::find_latest(bool (*matches)(MotorEdgeType, MotorEdgeType), MotorEdgeType type,
+                                    uint32_t* timestamp_us_out) const {
+    bool found = false;
+    portENTER_CRITICAL(&lock);
+    uint32_t available = edge_count < CAPACITY ? edge_count : CAPACITY;
+    for (uint32_t i = 0; i < available; i++) {
+        const Edge& edge = edges[(edge_count - 1 - i) & INDEX_MASK];
+        if (matches(edge.type, type)) {
+            if (timestamp_us_out) {
+                *timestamp_us_out = edge.timestamp_us;
+            }
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+bool MotorEdgeTimeline::get_latest(MotorEdgeType type, uint32_t* timestamp_us_out) const {
+    return find_latest(same_type, type, timestamp_us_out);
+}
+
+bool MotorEdgeTimeline::get_latest_on(uint32_t* timestamp_us_out) const {
+    return find_latest(same_direction, MotorEdgeType::START, timestamp_us_out);
+}
+
+bool MotorEdgeTimeline::get_latest_off(uint32_t* timestamp_us_out) const {
+    return find_latest(same_direction, MotorEdgeType::STOP, timestamp_us_out);
+}
+
+bool MotorEdgeTimeline::get_edge(uint8_t newest_offset, Edge* edge_out) const {
+    bool found = false;
+    portENTER_CRITICAL(&lock);
+    uint32_t available = edge_count < CAPACITY ? edge_count : CAPACITY;
+    if (newest_offset < available) {
+        if (edge_out) {
+            *edge_out = edges[(edge_count - 1 - newest_offset) & INDEX_MASK];
+        }
+        found = true;
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+bool MotorEdgeTimeline::get_edge_at_index(uint32_t index, Edge* edge_out) const {
+    bool found = false;
+    portENTER_CRITICAL(&lock);
+    if (index < edge_count && edge_count - index <= CAPACITY) {
+        if (edge_out) {
+            *edge_out = edges[index & INDEX_MASK];
+        }
+        found = true;
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+uint32_t MotorEdgeTimeline::get_edge_count() const {
+    portENTER_CRITICAL(&lock);
+    uint32_t count = edge_count;
+    portEXIT_CRITICAL(&lock);
+    return count;
+}
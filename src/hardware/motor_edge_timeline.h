@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+enum class MotorEdgeType : uint8_t {
+    START,          // Continuous run started
+    STOP,           // Continuous run (or pulse) stopped by software
+    PULSE_START,    // RMT pulse transmission started
+    PULSE_END,      // RMT pulse finished (transmit-done interrupt)
+};
+
+/**
+ * MotorEdgeTimeline - Motor relay edges on the load cell sample clock
+ *
+ * Keeps the most recent motor on/off edges with esp_timer µs timestamps
+ * (low 32 bits, same clock as CircularBufferMath samples), so control code
+ * can ask for "the weight N ms after the motor stopped" instead of relying
+ * on control-loop timestamps. Edges are recorded from any task or from the
+ * RMT transmit-done ISR; a short critical section keeps each edge whole.
+ */
+class MotorEdgeTimeline {
+public:
+    struct Edge {
+        uint32_t timestamp_us;
+        MotorEdgeType type;
+    };
+
+    MotorEdgeTimeline();
+
+    void record(MotorEdgeType type, uint32_t timestamp_us);
+    void IRAM_ATTR record_from_isr(MotorEdgeType type, uint32_t timestamp_us);
+
+    // Most recent edge of the given type; false if none recorded yet
+    bool get_latest(MotorEdgeType type, uint32_t* timestamp_us_out) const;
+    // Most recent motor-on (START/PULSE_START) or motor-off (STOP/PULSE_END) edge
+    bool get_latest_on(uint32_t* timestamp_us_out) const;
+    bool get_latest_off(uint32_t* timestamp_us_out) const;
+    // newest_offset 0 = most recent edge
+    bool get_edge(uint8_t newest_offset, Edge* edge_out) const;
+    uint32_t get_edge_count() const;
+    // index counts edges ever recorded (0 = first); false if not recorded yet or already overwritten
+    bool get_edge_at_index(uint32_t index, Edge* edge_out) const;
+
+    static bool is_on_edge(MotorEdgeType type) {
+        return type == MotorEdgeType::START || type == MotorEdgeType::PULSE_START;
+    }
+
+private:
+    static const uint8_t CAPACITY = 16;
+    static const uint8_t INDEX_MASK = CAPACITY - 1;
+
+    Edge edges[CAPACITY];
+    uint32_t edge_count;                // Edges ever recorded
+    mutable portMUX_TYPE lock;
+
+    bool find_latest(bool (*matches)(MotorEdgeType, MotorEdgeType), MotorEdgeType type,
+                     uint32_t* timestamp_us_out) const;
+};
@@ -0,0 +1,119 @@
+#include "motor_load_tracker.h"
+#include <algorithm>
+#include <math.h>
+
+namespace {
+// Motor-off windows move the zero slowly; it only drifts with temperature
+const float kZeroAlpha = 0.05f;
+} // namespace
+
+void MotorLoadTracker::add_window(uint32_t end_us, float level, WindowMotor motor, uint32_t start_us) {
+    if (motor == WindowMotor::OFF) {
+        if (state.run_active) {
+            end_run();
+        }
+        zero_level = zero_valid ? zero_level + kZeroAlpha * (level - zero_level) : level;
+        zero_valid = true;
+        return;
+    }
+
+    if (!state.run_active || start_us != run_start_us) {
+        if (state.run_active) {
+            end_run();
+        }
+        start_run(start_us);
+    }
+    update_run(end_us, std::max(0.0f, level - zero_level));
+}
+
+bool MotorLoadTracker::take_no_load_update() {
+    bool updated = no_load_updated;
+    no_load_updated = false;
+    return updated;
+}
+
+void MotorLoadTracker::start_run(uint32_t start_us) {
+    state = {};
+    state.run_active = true;
+    run_start_us = start_us;
+    previous_level = 0.0f;
+    run_floor = 0.0f;
+    onset_windows = 0;
+    onset_first_us = 0;
+    empty_since_us = 0;
+}
+
+void MotorLoadTracker::end_run() {
+    state.run_active = false;
+    if (!state.spun_up || run_floor <= 0.0f) {
+        return;
+    }
+    // A lower floor is the motor running emptier than ever seen; only a run that
+    // emptied vouches for a higher one, and then just nudges
+    float learned = no_load_level;
+    if (!has_no_load_level() || run_floor < no_load_level) {
+        learned = run_floor;
+    } else if (state.hopper_empty) {
+        learned += GRIND_MOTOR_CURRENT_NO_LOAD_LEARN_ALPHA * (run_floor - no_load_level);
+    }
+    if (learned != no_load_level) {
+        no_load_level = learned;
+        no_load_updated = true;
+    }
+}
+
+void MotorLoadTracker::update_run(uint32_t end_us, float net_level) {
+    const uint32_t run_ms = (end_us - run_start_us) / 1000;
+
+    if (!state.spun_up) {
+        const bool settled = previous_level > 0.0f &&
+                             fabsf(net_level - previous_level) <= GRIND_MOTOR_CURRENT_SPINUP_SETTLE_FRACTION * previous_level;
+        previous_level = net_level;
+        if (run_ms < GRIND_MOTOR_CURRENT_SPINUP_MIN_MS || (!settled && run_ms < GRIND_MOTOR_CURRENT_SPINUP_MAX_MS)) {
+            return;
+        }
+        state.spun_up = true;
+        state.spin_up_ms = (uint16_t)std::min<uint32_t>(run_ms, UINT16_MAX);
+        state.level = net_level;
+        run_floor = net_level;
+    } else {
+        state.level += GRIND_MOTOR_CURRENT_SMOOTHING_ALPHA * (net_level - state.level);
+        run_floor = std::min(run_floor, state.level);
+    }
+    previous_level = net_level;
+
+    if (!has_no_load_level()) {
+        return;
+    }
+    state.load_fraction = (state.level - no_load_level) / no_load_level;
+
+    // Onset on the unsmoothed level, confirmed by the next window
+    if (!state.loaded) {
+        if ((net_level - no_load_level) >= GRIND_MOTOR_CURRENT_LOAD_ONSET_FRACTION * no_load_level) {
+            if (onset_windows++ == 0) {
+                onset_first_us = end_us;
+            }
+            if (onset_windows >= 2) {
+                state.loaded = true;
+                state.load_onset_us = onset_first_us;
+            }
+        } else {
+            onset_windows = 0;
+        }
+    }
+
+    if (!state.loaded || state.hopper_empty) {
+        return;
+    }
+    if (state.load_fraction > GRIND_MOTOR_CURRENT_EMPTY_FRACTION) {
+        empty_since_us = 0;
+        return;
+    }
+    if (empty_since_us == 0) {
+        empty_since_us = end_us ? end_us : 1;
+    }
+    if (end_us - empty_since_us >= GRIND_MOTOR_CURRENT_EMPTY_MS * 1000UL) {
+        state.hopper_empty = true;
+        state.hopper_empty_us = empty_since_us;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/constants.h"
+
+// Signals of the current or most recent continuous run
+struct MotorLoadState {
+    bool run_active;                // Windows of a continuous run are arriving
+    bool spun_up;                   // Inrush over, level settled
+    uint16_t spin_up_ms;            // START edge to settled level
+    float level;                    // Smoothed net level (above motor off), sensor units
+    float load_fraction;            // (level - empty) / empty; 0 until the empty level is known
+    bool loaded;                    // Beans reached the burrs
+    uint32_t load_onset_us;         // Window that first showed the load (esp_timer µs, low 32 bits)
+    bool hopper_empty;              // Running empty again after the load onset
+    uint32_t hopper_empty_us;
+};
+
+/**
+ * MotorLoadTracker - Spin-up, load and empty-hopper signals from motor current
+ *
+ * Fed one level per current window (MotorCurrentSensor), classified by the
+ * caller against the motor edges: windows inside a continuous run, windows
+ * with the motor off, and straddling windows not at all. Motor-off windows
+ * track the sensor's zero, which every level is measured from.
+ *
+ * In a run, the inrush ends once the level changes less than
+ * GRIND_MOTOR_CURRENT_SPINUP_SETTLE_FRACTION between windows (or at
+ * GRIND_MOTOR_CURRENT_SPINUP_MAX_MS). After that the level is compared with the
+ * empty-running level: two windows GRIND_MOTOR_CURRENT_LOAD_ONSET_FRACTION
+ * above it mean beans reached the burrs, which is the motor's own response,
+ * ahead of the grounds reaching the cup and the flow window seeing them. A
+ * smoothed level back within GRIND_MOTOR_CURRENT_EMPTY_FRACTION for
+ * GRIND_MOTOR_CURRENT_EMPTY_MS after the onset is an empty hopper.
+ *
+ * The empty level is a property of the motor and burrs. It comes from
+ * GRIND_MOTOR_CURRENT_NO_LOAD_LEVEL, the stored preference, or is learned
+ * from each run's lowest smoothed level after spin-up: a lower floor replaces
+ * it (the motor ran emptier than ever seen), and the floor of a run that
+ * emptied pulls it up by GRIND_MOTOR_CURRENT_NO_LOAD_LEARN_ALPHA. A level
+ * learned too high (a first run loaded throughout) only hides the signals
+ * until an emptier run lowers it: both need an onset above it first. Until
+ * it is known there is no load or empty signal.
+ *
+ * Single task (the grind control task through Grinder::service_motor_current()).
+ */
+class MotorLoadTracker {
+public:
+    enum class WindowMotor : uint8_t { OFF, RUN };
+
+    void add_window(uint32_t end_us, float level, WindowMotor motor, uint32_t run_start_us);
+
+    const MotorLoadState& get_state() const { return state; }
+    bool has_no_load_level() const { return no_load_level > 0.0f; }
+    float get_no_load_level() const { return no_load_level; }
+    void set_no_load_level(float level) { no_load_level = level > 0.0f ? level : 0.0f; }
+    float get_zero_level() const { return zero_level; }
+
+    // True once after a run taught a new empty level (the owner persists it)
+    bool take_no_load_update();
+
+private:
+    MotorLoadState state = {};
+    uint32_t run_start_us = 0;
+    float previous_level = 0.0f;    // Last raw net level of the run
+    float run_floor = 0.0f;         // Lowest smoothed level since spin-up
+    uint8_t onset_windows = 0;
+    uint32_t onset_first_us = 0;
+    uint32_t empty_since_us = 0;
+
+    float zero_level = 0.0f;
+    bool zero_valid = false;
+    float no_load_level = GRIND_MOTOR_CURRENT_NO_LOAD_LEVEL;
+    bool no_load_updated = false;
+
+    void start_run(uint32_t start_us);
+    void end_run();
+    void update_run(uint32_t end_us, float net_level);
+};
@@ -0,0 +1,467 @@
+#include "nau7802_driver.h"
+#include "../config/constants.h"
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <esp_timer.h>
+
+/**
+ * NAU7802 Driver Implementation
+ *
+ * Register map and power-up/calibration sequence per the Nuvoton NAU7802
+ * datasheet (rev 1.7).
+ */
+
+namespace {
+// Registers
+constexpr uint8_t kRegPuCtrl = 0x00;
+constexpr uint8_t kRegCtrl1 = 0x01;
+constexpr uint8_t kRegCtrl2 = 0x02;
+constexpr uint8_t kRegAdcoB2 = 0x12;
+constexpr uint8_t kRegAdc = 0x15;
+constexpr uint8_t kRegPwrCtrl = 0x1C;
+constexpr uint8_t kRegRevisionId = 0x1F;
+
+// PU_CTRL bits
+constexpr uint8_t kPuCtrlRR = 0x01;      // Register reset
+constexpr uint8_t kPuCtrlPUD = 0x02;     // Digital power up
+constexpr uint8_t kPuCtrlPUA = 0x04;     // Analog power up
+constexpr uint8_t kPuCtrlPUR = 0x08;     // Power up ready
+constexpr uint8_t kPuCtrlCS = 0x10;      // Cycle start
+constexpr uint8_t kPuCtrlCR = 0x20;      // Cycle ready (conversion available)
+constexpr uint8_t kPuCtrlAVDDS = 0x80;   // AVDD from internal LDO
+
+// CTRL1 fields
+constexpr uint8_t kCtrl1GainMask = 0x07;
+constexpr uint8_t kCtrl1LdoMask = 0x38;
+constexpr uint8_t kCtrl1Ldo3v3 = 0x20;
+
+// CTRL2 fields
+constexpr uint8_t kCtrl2CalModMask = 0x03;
+constexpr uint8_t kCtrl2CALS = 0x04;
+constexpr uint8_t kCtrl2CalError = 0x08;
+constexpr uint8_t kCtrl2CrsMask = 0x70;
+constexpr uint8_t kCtrl2CrsShift = 4;
+
+constexpr uint8_t kAdcChopperOff = 0x30;   // ADC.REG_CHPS = 11 (clock chopper off)
+constexpr uint8_t kPwrCtrlPgaCapEn = 0x80; // Channel 2 decoupling cap
+
+constexpr uint8_t kRevisionIdMask = 0x0F;
+constexpr uint8_t kRevisionIdExpected = 0x0F;
+
+constexpr uint32_t kPowerUpTimeoutMs = 10;
+
+i2c_master_bus_config_t make_bus_config() {
+    i2c_master_bus_config_t bus_config = {};
+    bus_config.i2c_port = HW_NAU7802_I2C_PORT;
+    bus_config.sda_io_num = static_cast<gpio_num_t>(HW_NAU7802_SDA_PIN);
+    bus_config.scl_io_num = static_cast<gpio_num_t>(HW_NAU7802_SCL_PIN);
+    bus_config.clk_source = I2C_CLK_SRC_DEFAULT;
+    bus_config.glitch_ignore_cnt = 7;
+    bus_config.intr_priority = 0;
+    bus_config.trans_queue_depth = 0;
+    bus_config.flags.enable_internal_pullup = 1;
+    bus_config.flags.allow_pd = 0;
+    return bus_config;
+}
+
+i2c_device_config_t make_device_config() {
+    i2c_device_config_t device_config = {};
+    device_config.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+    device_config.device_address = HW_NAU7802_I2C_ADDRESS;
+    device_config.scl_speed_hz = HW_NAU7802_I2C_FREQUENCY_HZ;
+    device_config.scl_wait_us = 0;
+    device_config.flags.disable_ack_check = 0;
+    return device_config;
+}
+}
+
+NAU7802Driver::NAU7802Driver(int8_t drdy_pin)
+    : bus_handle(nullptr), device_handle(nullptr), drdy_pin(drdy_pin), gain_bits(7),
+      current_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS), rate_switch_discard_remaining(0),
+      last_raw_data(0), conversion_start_time(0), conversion_time(0),
+      estimated_sample_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS),
+      drdy_notify_task(nullptr), drdy_interrupt_enabled(false), drdy_edge_time_us(0),
+      last_sample_time_us(0) {
+}
+
+NAU7802Driver::~NAU7802Driver() {
+    disable_data_ready_interrupt();
+    detach_bus();
+}
+
+bool NAU7802Driver::probe() {
+    i2c_master_bus_config_t bus_config = make_bus_config();
+    i2c_master_bus_handle_t probe_bus = nullptr;
+    if (i2c_new_master_bus(&bus_config, &probe_bus) != ESP_OK) {
+        return false;
+    }
+
+    bool detected = false;
+    if (i2c_master_probe(probe_bus, HW_NAU7802_I2C_ADDRESS, 10) == ESP_OK) {
+        // An ACK alone could be any device at 0x2A - confirm the revision ID
+        i2c_device_config_t device_config = make_device_config();
+        i2c_master_dev_handle_t probe_device = nullptr;
+        if (i2c_master_bus_add_device(probe_bus, &device_config, &probe_device) == ESP_OK) {
+            uint8_t reg = kRegRevisionId;
+            uint8_t revision = 0;
+            if (i2c_master_transmit_receive(probe_device, &reg, 1, &revision, 1, I2C_TIMEOUT_MS) == ESP_OK) {
+                detected = (revision & kRevisionIdMask) == kRevisionIdExpected;
+            }
+            i2c_master_bus_rm_device(probe_device);
+        }
+    }
+
+    // Hand the header pins back as plain GPIO for a 2-wire ADC
+    i2c_del_master_bus(probe_bus);
+    gpio_reset_pin(static_cast<gpio_num_t>(HW_NAU7802_SDA_PIN));
+    gpio_reset_pin(static_cast<gpio_num_t>(HW_NAU7802_SCL_PIN));
+    return detected;
+}
+
+bool NAU7802Driver::attach_bus() {
+    if (device_handle) {
+        return true;
+    }
+
+    if (!bus_handle) {
+        i2c_master_bus_config_t bus_config = make_bus_config();
+        esp_err_t err = i2c_new_master_bus(&bus_config, &bus_handle);
+        if (err != ESP_OK) {
+            LOG_BLE("NAU7802Driver: i2c_new_master_bus failed (%s)\n", esp_err_to_name(err));
+            bus_handle = nullptr;
+            return false;
+        }
+    }
+
+    i2c_device_config_t device_config = make_device_config();
+    esp_err_t err = i2c_master_bus_add_device(bus_handle, &device_config, &device_handle);
+    if (err != ESP_OK) {
+        LOG_BLE("NAU7802Driver: i2c_master_bus_add_device failed (%s)\n", esp_err_to_name(err));
+        device_handle = nullptr;
+        detach_bus();
+        return false;
+    }
+    return true;
+}
+
+void NAU7802Driver::detach_bus() {
+    if (device_handle) {
+        i2c_master_bus_rm_device(device_handle);
+        device_handle = nullptr;
+    }
+    if (bus_handle) {
+        i2c_del_master_bus(bus_handle);
+        bus_handle = nullptr;
+    }
+}
+
+bool NAU7802Driver::read_registers(uint8_t reg, uint8_t* buf, size_t len) {
+    if (!device_handle) {
+        return false;
+    }
+    return i2c_master_transmit_receive(device_handle, &reg, 1, buf, len, I2C_TIMEOUT_MS) == ESP_OK;
+}
+
+bool NAU7802Driver::read_register(uint8_t reg, uint8_t* value) {
+    return read_registers(reg, value, 1);
+}
+
+bool NAU7802Driver::write_register(uint8_t reg, uint8_t value) {
+    if (!device_handle) {
+        return false;
+    }
+    uint8_t buf[2] = {reg, value};
+    return i2c_master_transmit(device_handle, buf, sizeof(buf), I2C_TIMEOUT_MS) == ESP_OK;
+}
+
+bool NAU7802Driver::update_register(uint8_t reg, uint8_t mask, uint8_t value) {
+    uint8_t current = 0;
+    if (!read_register(reg, &current)) {
+        return false;
+    }
+    return write_register(reg, (current & ~mask) | (value & mask));
+}
+
+bool NAU7802Driver::wait_for_register(uint8_t reg, uint8_t mask, uint8_t expected, uint32_t timeout_ms) {
+    unsigned long start_time = millis();
+    do {
+        uint8_t value = 0;
+        if (read_register(reg, &value) && (value & mask) == expected) {
+            return true;
+        }
+        delay(1);
+    } while (millis() - start_time < timeout_ms);
+    return false;
+}
+
+uint8_t NAU7802Driver::rate_bits_for(uint32_t sps) {
+    switch (sps) {
+        case 10:  return 0;
+        case 20:  return 1;
+        case 40:  return 2;
+        case 80:  return 3;
+        case 320: return 7;
+        default:  return 0xFF;
+    }
+}
+
+bool NAU7802Driver::begin() {
+    return begin(128);  // Default gain
+}
+
+bool NAU7802Driver::begin(uint8_t gain_value) {
+    disable_data_ready_interrupt();
+
+    if (!attach_bus()) {
+        LOG_BLE("NAU7802Driver: Failed to attach I2C bus (SDA=%d SCL=%d)\n",
+                HW_NAU7802_SDA_PIN, HW_NAU7802_SCL_PIN);
+        return false;
+    }
+
+    if (drdy_pin >= 0) {
+        pinMode(drdy_pin, INPUT);
+    }
+
+    // Register reset, then digital power-up
+    if (!write_register(kRegPuCtrl, kPuCtrlRR) || !write_register(kRegPuCtrl, kPuCtrlPUD)) {
+        LOG_BLE("NAU7802Driver: No response at I2C address 0x%02X\n", HW_NAU7802_I2C_ADDRESS);
+        return false;
+    }
+    if (!wait_for_register(kRegPuCtrl, kPuCtrlPUR, kPuCtrlPUR, kPowerUpTimeoutMs)) {
+        LOG_BLE("NAU7802Driver: Timeout waiting for power-up ready\n");
+        return false;
+    }
+
+    set_gain(gain_value);
+    if (!configure_afe() || !power_up_analog()) {
+        LOG_BLE("NAU7802Driver: Failed to configure analog front end\n");
+        return false;
+    }
+
+    // Wait for the first post-calibration conversion
+    uint32_t sample_interval_ms = 1000 / current_rate_sps;
+    uint32_t comm_timeout = sample_interval_ms * 2 + 200;
+    LOG_BLE("NAU7802Driver: Waiting for first sample (timeout: %lums)\n", comm_timeout);
+
+    unsigned long start_time = millis();
+    while (!data_waiting_async() && millis() - start_time < comm_timeout) {
+        delay(sample_interval_ms / 4 + 1);
+    }
+
+    if (data_waiting_async() && update_async()) {
+        LOG_BLE("NAU7802Driver: First sample acquired successfully (%lu SPS, gain %u)\n",
+                (unsigned long)current_rate_sps, 1u << gain_bits);
+        return true;
+    }
+
+    LOG_BLE("NAU7802Driver: Timeout waiting for first sample\n");
+    return false;
+}
+
+bool NAU7802Driver::configure_afe() {
+    bool ok = true;
+    ok &= update_register(kRegCtrl1, kCtrl1LdoMask | kCtrl1GainMask, kCtrl1Ldo3v3 | gain_bits);
+    ok &= update_register(kRegCtrl2, kCtrl2CrsMask, rate_bits_for(current_rate_sps) << kCtrl2CrsShift);
+    ok &= update_register(kRegAdc, kAdcChopperOff, kAdcChopperOff);
+    ok &= update_register(kRegPwrCtrl, kPwrCtrlPgaCapEn, kPwrCtrlPgaCapEn);
+    return ok;
+}
+
+bool NAU7802Driver::calibrate_afe() {
+    // Internal offset calibration (CALMOD = 00); CALS self-clears when done
+    if (!update_register(kRegCtrl2, kCtrl2CalModMask | kCtrl2CALS, kCtrl2CALS)) {
+        return false;
+    }
+    if (!wait_for_register(kRegCtrl2, kCtrl2CALS, 0, CALIBRATION_TIMEOUT_MS)) {
+        LOG_BLE("NAU7802Driver: Offset calibration timed out\n");
+        return false;
+    }
+
+    uint8_t ctrl2 = 0;
+    if (!read_register(kRegCtrl2, &ctrl2) || (ctrl2 & kCtrl2CalError)) {
+        LOG_BLE("NAU7802Driver: Offset calibration failed\n");
+        return false;
+    }
+    return true;
+}
+
+bool NAU7802Driver::power_up_analog() {
+    uint8_t pu_ctrl = kPuCtrlPUD | kPuCtrlPUA | kPuCtrlAVDDS;
+    if (!write_register(kRegPuCtrl, pu_ctrl)) {
+        return false;
+    }
+    if (!wait_for_register(kRegPuCtrl, kPuCtrlPUR, kPuCtrlPUR, kPowerUpTimeoutMs)) {
+        return false;
+    }
+
+    // LDO and PGA need ~600ms after PUA before an accurate calibration
+    delay(600);
+    if (!calibrate_afe()) {
+        return false;
+    }
+    return write_register(kRegPuCtrl, pu_ctrl | kPuCtrlCS);
+}
+
+void NAU7802Driver::set_gain(uint8_t gain_value) {
+    // PGA gain is 1..128 in powers of two; round down to the nearest step
+    uint8_t bits = 0;
+    while (bits < 7 && (1u << (bits + 1)) <= gain_value) {
+        bits++;
+    }
+    gain_bits = bits;
+
+    if (device_handle) {
+        update_register(kRegCtrl1, kCtrl1GainMask, gain_bits);
+    }
+}
+
+bool NAU7802Driver::set_sample_rate(uint32_t sps) {
+    uint8_t rate_bits = rate_bits_for(sps);
+    if (rate_bits == 0xFF || sps > HW_NAU7802_SAMPLE_RATE_HIGH_SPS) {
+        return false;
+    }
+    if (sps == current_rate_sps) {
+        return true;
+    }
+    if (!update_register(kRegCtrl2, kCtrl2CrsMask, rate_bits << kCtrl2CrsShift)) {
+        LOG_BLE("NAU7802Driver: Failed to set sample rate %lu SPS\n", (unsigned long)sps);
+        return false;
+    }
+    current_rate_sps = sps;
+
+    // Conversions straddling the switch are not settled at the new rate
+    rate_switch_discard_remaining = HW_LOADCELL_RATE_SWITCH_DISCARD_SAMPLES;
+    return true;
+}
+
+void NAU7802Driver::power_up() {
+    if (!attach_bus()) {
+        return;
+    }
+    power_up_analog();
+}
+
+void NAU7802Driver::power_down() {
+    // DRDY stays low while powered down; stop waking the sampling task
+    disable_data_ready_interrupt();
+    update_register(kRegPuCtrl, kPuCtrlPUD | kPuCtrlPUA, 0);
+}
+
+bool NAU7802Driver::is_ready() {
+    if (drdy_pin >= 0) {
+        return digitalRead(drdy_pin) == HIGH;
+    }
+    uint8_t pu_ctrl = 0;
+    return read_register(kRegPuCtrl, &pu_ctrl) && (pu_ctrl & kPuCtrlCR);
+}
+
+bool NAU7802Driver::data_waiting_async() {
+    return is_ready();
+}
+
+bool NAU7802Driver::update_async() {
+    if (!is_ready()) {
+        return false;
+    }
+
+    // Interrupt mode stamps the sample at the DRDY edge; polling mode stamps it at readout
+    int64_t edge_time_us = drdy_edge_time_us;
+    last_sample_time_us = (drdy_interrupt_enabled && edge_time_us != 0) ? edge_time_us : esp_timer_get_time();
+    drdy_edge_time_us = 0;
+
+    unsigned long now = micros();
+    conversion_time = conversion_start_time == 0 ? 0 : now - conversion_start_time;
+    conversion_start_time = now;
+
+    // Reading ADCO clears CR and releases DRDY
+    uint8_t adco[3] = {0};
+    if (!read_registers(kRegAdcoB2, adco, sizeof(adco))) {
+        return false;
+    }
+
+    // Two's complement -> offset binary, matching the HX711 driver's raw range
+    uint32_t raw_data = ((uint32_t)adco[0] << 16) | ((uint32_t)adco[1] << 8) | (uint32_t)adco[2];
+    last_raw_data = (int32_t)(raw_data ^ 0x800000);
+
+    if (rate_switch_discard_remaining > 0) {
+        rate_switch_discard_remaining--;
+        return false;
+    }
+    return true;
+}
+
+bool NAU7802Driver::validate_hardware() {
+    uint32_t sample_interval_ms = 1000 / current_rate_sps;
+    uint32_t validation_timeout = (sample_interval_ms * 4) + 500;
+
+    LOG_BLE("NAU7802Driver: Hardware validation timeout = %lums (sample rate: %lu SPS)\n",
+            validation_timeout, (unsigned long)current_rate_sps);
+
+    unsigned long start_time = millis();
+    uint64_t conversion_time_sum = 0;
+    int conversion_time_samples = 0;
+    int successful_reads = 0;
+
+    while (millis() - start_time < validation_timeout && successful_reads < 3) {
+        if (data_waiting_async() && update_async()) {
+            if (conversion_time > 0) {
+                conversion_time_sum += conversion_time;
+                conversion_time_samples++;
+            }
+            successful_reads++;
+            LOG_BLE("NAU7802Driver: Validation read %d/3 successful\n", successful_reads);
+        }
+        delay(sample_interval_ms / 4 + 1);
+    }
+
+    if (conversion_time_samples > 0 && conversion_time_sum > 0) {
+        estimated_sample_rate_sps = static_cast<float>(1'000'000.0 * conversion_time_samples / conversion_time_sum);
+    } else {
+        estimated_sample_rate_sps = current_rate_sps;
+    }
+
+    LOG_BLE("NAU7802Driver: Hardware validation completed - %d/3 successful reads in %lums (rate ≈ %.1f SPS)\n",
+            successful_reads, millis() - start_time, estimated_sample_rate_sps);
+
+    return successful_reads >= 3;
+}
+
+void IRAM_ATTR NAU7802Driver::drdy_rising_isr(void* arg) {
+    NAU7802Driver* self = static_cast<NAU7802Driver*>(arg);
+    if (!self->drdy_notify_task) {
+        return;
+    }
+
+    self->drdy_edge_time_us = esp_timer_get_time();
+
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->drdy_notify_task, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+bool NAU7802Driver::enable_data_ready_interrupt(TaskHandle_t task) {
+    if (!task || drdy_pin < 0) {
+        return false;  // DRDY not wired - caller polls PU_CTRL.CR
+    }
+
+    disable_data_ready_interrupt();
+
+    drdy_notify_task = task;
+    drdy_edge_time_us = 0;
+    attachInterruptArg(digitalPinToInterrupt(drdy_pin), drdy_rising_isr, this, RISING);
+    drdy_interrupt_enabled = true;
+
+    LOG_BLE("NAU7802Driver: DRDY data-ready interrupt enabled on GPIO %d\n", drdy_pin);
+    return true;
+}
+
+void NAU7802Driver::disable_data_ready_interrupt() {
+    if (!drdy_interrupt_enabled) {
+        return;
+    }
+
+    detachInterrupt(digitalPinToInterrupt(drdy_pin));
+    drdy_interrupt_enabled = false;
+    drdy_notify_task = nullptr;
+    drdy_edge_time_us = 0;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "../config/constants.h"
+#include "load_cell_driver.h"
+#include <Arduino.h>
+#include <driver/i2c_master.h>
+#include <math.h>
+
+/**
+ * NAU7802 ADC Driver
+ *
+ * Nuvoton NAU7802 24-bit bridge ADC on its own I2C controller. Runs the
+ * internal LDO at 3.3V, PGA chopper off and the channel 2 decoupling cap
+ * enabled (the usual load cell configuration), with an internal offset
+ * calibration after every power-up.
+ *
+ * Output data rate is switchable at runtime (10/20/40/80/320 SPS). Data-ready
+ * is read from PU_CTRL.CR over I2C, or from the DRDY pin when it is wired
+ * (HW_NAU7802_DRDY_PIN); only the DRDY pin supports the data-ready interrupt.
+ *
+ * Raw samples are reported as offset binary (0x000000-0xFFFFFF) like the
+ * HX711 driver, so calibration and filtering are backend-agnostic.
+ */
+class NAU7802Driver : public LoadCellDriver {
+private:
+    i2c_master_bus_handle_t bus_handle;
+    i2c_master_dev_handle_t device_handle;
+    int8_t drdy_pin;
+    uint8_t gain_bits;            // CTRL1.GAINS (gain = 1 << gain_bits)
+
+    // Output data rate state
+    volatile uint32_t current_rate_sps;
+    uint8_t rate_switch_discard_remaining;
+
+    // Sample state
+    int32_t last_raw_data;
+    unsigned long conversion_start_time;
+    unsigned long conversion_time;
+    float estimated_sample_rate_sps;
+
+    // Data-ready interrupt state (DRDY rising edge wakes the sampling task)
+    TaskHandle_t drdy_notify_task;
+    volatile bool drdy_interrupt_enabled;
+    volatile int64_t drdy_edge_time_us;
+    int64_t last_sample_time_us;
+
+    static const int I2C_TIMEOUT_MS = 5;
+    static const uint32_t CALIBRATION_TIMEOUT_MS = 1000;
+
+    bool attach_bus();
+    void detach_bus();
+    bool read_registers(uint8_t reg, uint8_t* buf, size_t len);
+    bool read_register(uint8_t reg, uint8_t* value);
+    bool write_register(uint8_t reg, uint8_t value);
+    bool update_register(uint8_t reg, uint8_t mask, uint8_t value);
+    bool wait_for_register(uint8_t reg, uint8_t mask, uint8_t expected, uint32_t timeout_ms);
+    bool configure_afe();
+    bool calibrate_afe();
+    bool power_up_analog();
+    static uint8_t rate_bits_for(uint32_t sps);
+
+    static void IRAM_ATTR drdy_rising_isr(void* arg);
+
+public:
+    explicit NAU7802Driver(int8_t drdy_pin = HW_NAU7802_DRDY_PIN);
+    ~NAU7802Driver() override;
+
+    // Checks for a NAU7802 on the load cell header (ACK + revision ID) and
+    // releases the pins again; used for ADC auto-detection before begin()
+    static bool probe();
+
+    bool begin() override;
+    bool begin(uint8_t gain_value) override;
+    void set_gain(uint8_t gain_value) override;
+
+    void power_up() override;
+    void power_down() override;
+
+    bool is_ready() override;
+    bool data_waiting_async() override;
+    bool update_async() override;
+    int32_t get_raw_data() const override { return last_raw_data; }
+
+    bool validate_hardware() override;
+
+    bool supports_temperature_sensor() const override { return false; }
+    float get_temperature() const override { return NAN; }
+    // Without DRDY the sampling task polls at SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS; faster conversions would go unread
+    uint32_t get_max_sample_rate() const override {
+        return drdy_pin >= 0 ? HW_NAU7802_SAMPLE_RATE_HIGH_SPS : HW_NAU7802_SAMPLE_RATE_POLLED_SPS;
+    }
+    bool set_sample_rate(uint32_t sps) override;
+    uint32_t get_sample_rate() const override { return current_rate_sps; }
+    float get_estimated_sample_rate_sps() const override { return estimated_sample_rate_sps; }
+
+    bool enable_data_ready_interrupt(TaskHandle_t task) override;
+    void disable_data_ready_interrupt() override;
+    bool is_data_ready_interrupt_enabled() const override { return drdy_interrupt_enabled; }
+    int64_t get_last_sample_time_us() const override { return last_sample_time_us; }
+
+    const char* get_driver_name() const override { return "NAU7802"; }
+};
@@ -0,0 +1,77 @@
+#include "noise_floor_estimator.h"
+#include <algorithm>
+#include <math.h>
+
+namespace {
+// MAD of a normal sample is 0.6745 sigma; a difference of two samples has sqrt(2) sigma
+const float kMadToSigma = 1.4826f / 1.41421356f;
+} // namespace
+
+bool NoiseFloorEstimator::add_sample(int32_t raw, uint32_t timestamp_us, bool idle, float noise_scale) {
+    if (!idle) {
+        restart_window();
+        return false;
+    }
+    if (!has_last) {
+        has_last = true;
+        last_raw = raw;
+        window_start_us = timestamp_us;
+        return false;
+    }
+
+    differences[difference_count++] = raw - last_raw;
+    last_raw = raw;
+    const bool window_done = (int32_t)(timestamp_us - window_start_us) >= GRIND_NOISE_FLOOR_WINDOW_MS * 1000L ||
+                             difference_count >= MAX_WINDOW_SAMPLES;
+    if (!window_done) {
+        return false;
+    }
+    bool changed = close_window(noise_scale);
+    // The closing sample starts the next window
+    difference_count = 0;
+    window_start_us = timestamp_us;
+    return changed;
+}
+
+void NoiseFloorEstimator::reset() {
+    restart_window();
+    history_count = 0;
+    history_next = 0;
+    floor_raw = 0.0f;
+}
+
+void NoiseFloorEstimator::restart_window() {
+    has_last = false;
+    difference_count = 0;
+}
+
+bool NoiseFloorEstimator::close_window(float noise_scale) {
+    if (difference_count < GRIND_NOISE_FLOOR_MIN_SAMPLES) {
+        return false;
+    }
+
+    int32_t* end = differences + difference_count;
+    int32_t* middle = differences + difference_count / 2;
+    std::nth_element(differences, middle, end);
+    const int32_t median = *middle;
+    for (int32_t* d = differences; d < end; d++) {
+        *d = abs(*d - median);
+    }
+    std::nth_element(differences, middle, end);
+    // A quantized quiet ADC can have MAD 0; half a count keeps the floor above zero
+    const float sigma = std::max(0.5f, (float)*middle) * kMadToSigma / std::max(noise_scale, 1.0f);
+
+    history[history_next] = sigma;
+    history_next = (uint8_t)((history_next + 1) % GRIND_NOISE_FLOOR_HISTORY);
+    if (history_count < GRIND_NOISE_FLOOR_HISTORY) {
+        history_count++;
+    }
+
+    float sorted[GRIND_NOISE_FLOOR_HISTORY];
+    std::copy(history, history + history_count, sorted);
+    std::nth_element(sorted, sorted + history_count / 2, sorted + history_count);
+    const float new_floor = sorted[history_count / 2];
+    const bool changed = new_floor != floor_raw;
+    floor_raw = new_floor;
+    return changed;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/constants.h"
+
+/**
+ * NoiseFloorEstimator - Robust idle noise of the raw stream
+ *
+ * Fed every sample with whether the scale is idle (grinder IDLE, motor off,
+ * no tare running). Each GRIND_NOISE_FLOOR_WINDOW_MS idle window estimates
+ * the per-sample sigma from the median absolute deviation of successive
+ * differences: sigma = 1.4826 * MAD / sqrt(2). Differences ignore the zero
+ * and slow drift, and the median ignores a single step (a cup placed, a tap),
+ * so a loaded or drifting scale still measures its noise. The floor is the
+ * median of the last GRIND_NOISE_FLOOR_HISTORY windows, so one spoiled window
+ * does not move it. Window sigmas are divided by the caller's sample-rate
+ * noise scale, so the floor is at HW_LOADCELL_SAMPLE_RATE_SPS whatever rate
+ * the idle windows ran at.
+ *
+ * Producer-only state (WeightSamplingTask); the floor is a plain float.
+ */
+class NoiseFloorEstimator {
+public:
+    // true when a window closed and the floor changed
+    bool add_sample(int32_t raw, uint32_t timestamp_us, bool idle, float noise_scale);
+    void reset();
+
+    bool is_valid() const { return floor_raw > 0.0f; }
+    float get_floor_raw() const { return floor_raw; }          // Base-rate sigma in raw counts, 0 until measured
+
+private:
+    static constexpr uint16_t MAX_WINDOW_SAMPLES = 128;     // A window closes early when full (320 SPS)
+
+    int32_t differences[MAX_WINDOW_SAMPLES];
+    uint16_t difference_count = 0;
+    bool has_last = false;
+    int32_t last_raw = 0;
+    uint32_t window_start_us = 0;
+
+    float history[GRIND_NOISE_FLOOR_HISTORY] = {};
+    uint8_t history_count = 0;
+    uint8_t history_next = 0;
+    float floor_raw = 0.0f;
+
+    void restart_window();
+    bool close_window(float noise_scale);
+};
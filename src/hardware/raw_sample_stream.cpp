@@ -0,0 +1,84 @@
+#include "raw_sample_stream.h"
+#include <algorithm>
+
+void RawSampleStream::add_sample(int32_t raw_adc_value, uint32_t timestamp_us) {
+    uint32_t seq = publish_seq.load(std::memory_order_relaxed);
+    RawSample& slot = sample_ring.slot(seq);
+    slot.raw_value = raw_adc_value;
+    slot.timestamp_us = timestamp_us;
+    publish_seq.store(seq + 1, std::memory_order_release);
+}
+
+bool RawSampleStream::read_is_valid(uint32_t end_seq) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return publish_seq.load(std::memory_order_relaxed) - end_seq < READER_GUARD_SLOTS;
+}
+
+uint32_t RawSampleStream::get_sample_sequence_at(uint32_t timestamp_us) const {
+    uint32_t end_seq = 0;
+    uint32_t count = 0;
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        end_seq = publish_seq.load(std::memory_order_acquire);
+        count = std::min<uint32_t>(end_seq, READABLE_CAPACITY);
+        // Oldest-first partition point: the first sample at/after timestamp_us
+        uint32_t low = end_seq - count;
+        uint32_t high = end_seq;
+        while (low < high) {
+            uint32_t mid = low + (high - low) / 2;
+            if ((int32_t)(sample_ring.slot(mid).timestamp_us - timestamp_us) < 0) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (read_is_valid(end_seq)) {
+            return low;
+        }
+    }
+    return end_seq - count;     // Still lapping: everything readable is recent
+}
+
+int RawSampleStream::read_samples_from(uint32_t* next_seq, int32_t* raw_out, uint32_t* timestamps_out,
+                                       int max_samples, uint32_t* lost_out) const {
+    if (!next_seq || !raw_out || !timestamps_out || max_samples <= 0) return 0;
+
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        uint32_t end_seq = publish_seq.load(std::memory_order_acquire);
+        uint32_t oldest_seq = end_seq - std::min<uint32_t>(end_seq, READABLE_CAPACITY);
+        uint32_t seq = *next_seq;
+        uint32_t lost = 0;
+        if ((int32_t)(seq - oldest_seq) < 0) {
+            lost = oldest_seq - seq;
+            seq = oldest_seq;
+        }
+        int32_t pending = (int32_t)(end_seq - seq);
+        int count = pending > 0 ? std::min<int>(pending, max_samples) : 0;
+        for (int i = 0; i < count; i++) {
+            const RawSample& sample = sample_ring.slot(seq + i);
+            raw_out[i] = sample.raw_value;
+            timestamps_out[i] = sample.timestamp_us;
+        }
+        if (read_is_valid(end_seq)) {
+            *next_seq = seq + count;
+            if (lost_out) {
+                *lost_out += lost;
+            }
+            return count;
+        }
+    }
+    return 0;
+}
+
+uint32_t RawSampleStream::get_latest_sample_time_us() const {
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        uint32_t end_seq = publish_seq.load(std::memory_order_acquire);
+        if (end_seq == 0) {
+            return 0;
+        }
+        uint32_t timestamp_us = sample_ring.slot(end_seq - 1).timestamp_us;
+        if (read_is_valid(end_seq)) {
+            return timestamp_us;
+        }
+    }
+    return 0;
+}
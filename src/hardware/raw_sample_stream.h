@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "../config/constants.h"
+#include "ring.h"
+#include "sample_sequence_source.h"
+
+/**
+ * RawSampleStream - Every ADC sample, beside a decimated sample ring
+ *
+ * With HW_LOADCELL_DECIMATION_ENABLED the CircularBufferMath ring holds one
+ * sample per decimation block; this ring keeps the full-rate stream (after the
+ * vibration notch) for the recorders that want it: session ADC capture and
+ * noise spectra. It is a plain seqlock ring with no aggregates, so it costs the
+ * producer one slot write per sample. Published the same way as the sample
+ * ring: readers never see the oldest READER_GUARD_SLOTS slots and retry a read
+ * the producer lapped.
+ */
+class RawSampleStream : public SampleSequenceSource {
+public:
+    void add_sample(int32_t raw_adc_value, uint32_t timestamp_us);
+    void set_sample_rate(uint32_t sps) { sample_rate_sps = sps; }
+
+    uint32_t get_sample_sequence_at(uint32_t timestamp_us) const override;
+    int read_samples_from(uint32_t* next_seq, int32_t* raw_out, uint32_t* timestamps_out, int max_samples,
+                          uint32_t* lost_out) const override;
+    uint32_t get_latest_sample_time_us() const override;
+    uint32_t get_sample_rate() const override { return sample_rate_sps; }
+
+private:
+    struct RawSample {
+        int32_t raw_value;
+        uint32_t timestamp_us;
+    };
+
+    static constexpr uint32_t CAPACITY = HW_LOADCELL_DECIMATION_RAW_RING_SIZE;
+    static constexpr uint32_t READER_GUARD_SLOTS = 32;
+    static constexpr uint32_t READABLE_CAPACITY = CAPACITY - READER_GUARD_SLOTS;
+    static const int MAX_READ_RETRIES = 4;
+
+    Ring<RawSample, CAPACITY> sample_ring;      // Indexed by publish sequence
+    std::atomic<uint32_t> publish_seq{0};
+    uint32_t sample_rate_sps = HW_LOADCELL_SAMPLE_RATE_SPS;
+
+    bool read_is_valid(uint32_t end_seq) const;
+};
@@ -0,0 +1,391 @@
+#include "replay_load_cell_driver.h"
+#include "../logging/grind_logging.h"
+#include "../logging/session_reader.h"
+#include "../controllers/grind_phase.h"
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+#include <algorithm>
+
+ReplayLoadCellDriver* ReplayLoadCellDriver::instance = nullptr;
+
+namespace {
+constexpr uint32_t FLOW_WINDOW_MS = 200;        // Recorded flow = weight slope over this window
+
+bool is_session_file_name(const String& name) {
+    return (name.startsWith("session_") || name.indexOf("/session_") != -1) && name.endsWith(".bin");
+}
+}
+
+ReplayLoadCellDriver::ReplayLoadCellDriver()
+    : sample_rate_sps(HW_LOADCELL_SAMPLE_RATE_SPS), sample_interval_ms(HW_LOADCELL_SAMPLE_INTERVAL_MS),
+      last_raw_data(static_cast<int32_t>(DEBUG_MOCK_BASELINE_RAW)) {
+    instance = this;
+}
+
+ReplayLoadCellDriver::~ReplayLoadCellDriver() {
+    if (instance == this) {
+        instance = nullptr;
+    }
+    release_recording();
+}
+
+bool ReplayLoadCellDriver::begin() {
+    return begin(128);
+}
+
+bool ReplayLoadCellDriver::begin(uint8_t gain_value) {
+    (void)gain_value;
+    next_sample_due_ms = millis() + sample_interval_ms;
+    file_index = 0;
+    if (!load_next_session()) {
+        LOG_BLE("ReplayLoadCellDriver: no session files in %s or %s, replaying an idle scale\n",
+                DEBUG_REPLAY_DIR, GRIND_SESSIONS_DIR);
+    }
+    return true;
+}
+
+bool ReplayLoadCellDriver::set_sample_rate(uint32_t sps) {
+    if (sps != HW_LOADCELL_SAMPLE_RATE_SPS && sps != HW_LOADCELL_SAMPLE_RATE_HIGH_SPS) {
+        return false;
+    }
+    sample_rate_sps = sps;
+    sample_interval_ms = 1000 / sps;
+    next_sample_due_ms = millis() + sample_interval_ms;
+    return true;
+}
+
+bool ReplayLoadCellDriver::data_waiting_async() {
+    return millis() >= next_sample_due_ms;
+}
+
+bool ReplayLoadCellDriver::update_async() {
+    if (!data_waiting_async()) {
+        return false;
+    }
+    unsigned long now = millis();
+    next_sample_due_ms = now + sample_interval_ms;
+
+    // Recorded segments carry their own grinding noise; idle and finished segments get the mock's idle noise
+    float mass_g = mass_at(now);
+    if (segment != Segment::RUN && segment != Segment::PULSE) {
+        mass_g += idle_noise_g();
+    }
+    float raw_value = static_cast<float>(DEBUG_MOCK_BASELINE_RAW) + mass_g * DEBUG_MOCK_CAL_FACTOR;
+    raw_value = std::max(0.0f, std::min(raw_value, 16777215.0f));    // Clamp to 24-bit range
+    last_raw_data = static_cast<int32_t>(raw_value);
+    return true;
+}
+
+//==============================================================================
+// RECORDING
+//==============================================================================
+
+bool ReplayLoadCellDriver::load_next_session() {
+    const char* dir_path = LittleFS.exists(DEBUG_REPLAY_DIR) ? DEBUG_REPLAY_DIR : GRIND_SESSIONS_DIR;
+    File dir = LittleFS.open(dir_path);
+    if (!dir || !dir.isDirectory()) {
+        return false;
+    }
+
+    // The file_index-th session file in directory order, wrapping at the end
+    for (int pass = 0; pass < 2; pass++) {
+        uint16_t index = 0;
+        File file = dir.openNextFile();
+        while (file) {
+            String name = file.name();
+            file.close();
+            if (is_session_file_name(name)) {
+                if (index == file_index) {
+                    String path = name.startsWith("/") ? name : (String(dir_path) + "/" + name);
+                    file_index++;
+                    dir.close();
+                    return load_session_file(path.c_str());
+                }
+                index++;
+            }
+            file = dir.openNextFile();
+        }
+        if (index == 0) {
+            break;
+        }
+        file_index = 0;
+        dir.rewindDirectory();
+    }
+    dir.close();
+    return false;
+}
+
+bool ReplayLoadCellDriver::load_session_file(const char* path) {
+    SessionReader reader;
+    if (!reader.open(path) || reader.header().measurement_count < 2) {
+        LOG_BLE("ReplayLoadCellDriver: %s unreadable or empty\n", path);
+        return false;
+    }
+
+    const TimeSeriesSessionHeader& header = reader.header();
+    const GrindSession& session = reader.session();
+    uint16_t event_count = std::min<uint16_t>(header.event_count, GRIND_LOG_MAX_EVENTS);
+    GrindEvent* events = (GrindEvent*)heap_caps_malloc(event_count * sizeof(GrindEvent) + 1, MALLOC_CAP_8BIT);
+    uint16_t measurement_count = header.measurement_count;
+    release_recording();
+    rec_time_ms = (uint32_t*)heap_caps_malloc(measurement_count * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+    rec_weight_g = (float*)heap_caps_malloc(measurement_count * sizeof(float), MALLOC_CAP_SPIRAM);
+    if (!events || !rec_time_ms || !rec_weight_g) {
+        heap_caps_free(events);
+        release_recording();
+        LOG_BLE("ReplayLoadCellDriver: out of memory for %u measurements\n", (unsigned)measurement_count);
+        return false;
+    }
+
+    bool ok = true;
+    for (uint16_t i = 0; ok && i < event_count; i++) {
+        ok = reader.read_event(i, &events[i]);
+    }
+
+    // Raw records of any schema or encoded blocks (v4)
+    GrindMeasurement measurement;
+    uint8_t* motor_flags = (uint8_t*)heap_caps_malloc(measurement_count, MALLOC_CAP_8BIT);
+    ok = ok && motor_flags;
+    for (uint16_t i = 0; ok && i < measurement_count; i++) {
+        ok = reader.read_measurement(i, &measurement);
+        rec_time_ms[i] = measurement.timestamp_ms;
+        rec_weight_g[i] = measurement.weight_grams;
+        motor_flags[i] = measurement.motor_is_on;
+    }
+
+    if (ok) {
+        rec_count = measurement_count;
+        rec_session_id = header.session_id;
+        rec_final_weight_g = session.final_weight;
+        rec_motor_on_ms = session.total_motor_on_time_ms;
+
+        // Main run: first motor-on stretch; pulses: every later motor-on stretch
+        uint16_t i = 0;
+        while (i < rec_count && !motor_flags[i]) i++;
+        run_start_ms = i < rec_count ? rec_time_ms[i] : rec_time_ms[0];
+        while (i < rec_count && motor_flags[i]) i++;
+        run_stop_ms = i < rec_count ? rec_time_ms[i] : rec_time_ms[rec_count - 1];
+        pulse_count = 0;
+        while (i < rec_count) {
+            while (i < rec_count && !motor_flags[i]) i++;
+            if (i >= rec_count) break;
+            if (pulse_count < DEBUG_REPLAY_MAX_PULSES) {
+                pulses[pulse_count].start_ms = rec_time_ms[i];
+            }
+            uint16_t start = i;
+            while (i < rec_count && motor_flags[i]) i++;
+            if (pulse_count < DEBUG_REPLAY_MAX_PULSES) {
+                // Loop-rate flags quantize the width; PULSE_EXECUTE events refine it below
+                pulses[pulse_count].duration_ms = (float)(rec_time_ms[std::min<uint16_t>(i, rec_count - 1)] - rec_time_ms[start]);
+                pulse_count++;
+            }
+        }
+        for (uint8_t p = 0; p < pulse_count; p++) {
+            pulses[p].end_ms = p + 1 < pulse_count ? pulses[p + 1].start_ms : rec_time_ms[rec_count - 1];
+        }
+        coast_end_ms = pulse_count > 0 ? pulses[0].start_ms : rec_time_ms[rec_count - 1];
+        run_end_flow_gps = recorded_flow_at(run_stop_ms);
+        index_recording(events, event_count);
+
+        LOG_BLE("ReplayLoadCellDriver: session %lu from %s (%u samples, run %lums at %.2fg/s, %u pulses, final %.2fg)\n",
+                (unsigned long)rec_session_id, path, (unsigned)rec_count, (unsigned long)(run_stop_ms - run_start_ms),
+                run_end_flow_gps, (unsigned)pulse_count, rec_final_weight_g);
+    } else {
+        release_recording();
+        LOG_BLE("ReplayLoadCellDriver: %s truncated\n", path);
+    }
+    heap_caps_free(motor_flags);
+    heap_caps_free(events);
+    return ok;
+}
+
+void ReplayLoadCellDriver::index_recording(const GrindEvent* events, uint16_t event_count) {
+    uint8_t pulse = 0;
+    for (uint16_t e = 0; e < event_count && pulse < pulse_count; e++) {
+        if (events[e].phase_id == static_cast<uint8_t>(GrindPhase::PULSE_EXECUTE) && events[e].pulse_duration_ms > 0.0f) {
+            pulses[pulse++].duration_ms = events[e].pulse_duration_ms;
+        }
+    }
+}
+
+void ReplayLoadCellDriver::release_recording() {
+    heap_caps_free(rec_time_ms);
+    heap_caps_free(rec_weight_g);
+    rec_time_ms = nullptr;
+    rec_weight_g = nullptr;
+    rec_count = 0;
+    pulse_count = 0;
+}
+
+float ReplayLoadCellDriver::recorded_weight_at(uint32_t t_ms) const {
+    if (rec_count == 0) {
+        return 0.0f;
+    }
+    if (t_ms <= rec_time_ms[0]) {
+        return rec_weight_g[0];
+    }
+    if (t_ms >= rec_time_ms[rec_count - 1]) {
+        return rec_weight_g[rec_count - 1];
+    }
+    const uint32_t* upper = std::upper_bound(rec_time_ms, rec_time_ms + rec_count, t_ms);
+    size_t i = upper - rec_time_ms;
+    uint32_t span = rec_time_ms[i] - rec_time_ms[i - 1];
+    float fraction = span > 0 ? (float)(t_ms - rec_time_ms[i - 1]) / span : 0.0f;
+    return rec_weight_g[i - 1] + fraction * (rec_weight_g[i] - rec_weight_g[i - 1]);
+}
+
+float ReplayLoadCellDriver::recorded_flow_at(uint32_t t_ms) const {
+    uint32_t from_ms = t_ms > run_start_ms + FLOW_WINDOW_MS ? t_ms - FLOW_WINDOW_MS : run_start_ms;
+    if (t_ms <= from_ms) {
+        return 0.0f;
+    }
+    return std::max(0.0f, (recorded_weight_at(t_ms) - recorded_weight_at(from_ms)) * 1000.0f / (t_ms - from_ms));
+}
+
+//==============================================================================
+// REPLAY
+//==============================================================================
+
+float ReplayLoadCellDriver::mass_at(unsigned long now_ms) const {
+    uint32_t elapsed_ms = (uint32_t)(now_ms - segment_start_ms);
+    switch (segment) {
+        case Segment::RUN: {
+            uint32_t t_ms = run_cursor_ms + elapsed_ms;
+            if (t_ms <= run_stop_ms) {
+                return base_mass_g + recorded_weight_at(t_ms) - recorded_weight_at(run_cursor_ms);
+            }
+            // Past the recorded stop: hold its end flow
+            float recorded_g = run_cursor_ms < run_stop_ms ? recorded_weight_at(run_stop_ms) - recorded_weight_at(run_cursor_ms) : 0.0f;
+            uint32_t beyond_ms = t_ms - std::max(run_cursor_ms, run_stop_ms);
+            return base_mass_g + recorded_g + run_end_flow_gps * beyond_ms / 1000.0f;
+        }
+        case Segment::COAST: {
+            uint32_t t_ms = std::min(run_stop_ms + elapsed_ms, coast_end_ms);
+            return base_mass_g + segment_scale * (recorded_weight_at(t_ms) - recorded_weight_at(run_stop_ms));
+        }
+        case Segment::PULSE: {
+            if (active_pulse) {
+                uint32_t t_ms = std::min(active_pulse->start_ms + elapsed_ms, active_pulse->end_ms);
+                return base_mass_g + segment_scale * std::max(0.0f, recorded_weight_at(t_ms) - recorded_weight_at(active_pulse->start_ms));
+            }
+            // No recorded pulse left: the end flow over the effective duration, spread over the pulse
+            float effective_ms = std::max(0.0f, pulse_duration_ms - DEBUG_REPLAY_MOTOR_LATENCY_MS);
+            float spread_ms = pulse_duration_ms + DEBUG_REPLAY_MOTOR_LATENCY_MS;
+            float fraction = std::min(1.0f, elapsed_ms / spread_ms);
+            return base_mass_g + fraction * run_end_flow_gps * effective_ms / 1000.0f;
+        }
+        case Segment::IDLE:
+        default:
+            return base_mass_g;
+    }
+}
+
+void ReplayLoadCellDriver::begin_segment(Segment next, unsigned long now_ms) {
+    base_mass_g = mass_at(now_ms);      // Continuous across command edges
+    segment = next;
+    segment_start_ms = now_ms;
+    segment_scale = 1.0f;
+}
+
+float ReplayLoadCellDriver::idle_noise_g() {
+    // Deterministic LCG so a replay reproduces exactly
+    noise_state = noise_state * 1664525u + 1013904223u;
+    float normalized = (noise_state >> 8) / (float)(1u << 24);
+    return (normalized * 2.0f - 1.0f) * DEBUG_MOCK_IDLE_NOISE_RAW / fabsf(DEBUG_MOCK_CAL_FACTOR);
+}
+
+void ReplayLoadCellDriver::handle_start(unsigned long now_ms) {
+    bool new_session = !session_open || (now_ms - last_edge_ms) >= DEBUG_REPLAY_SESSION_GAP_MS;
+    if (new_session) {
+        if (session_open) {
+            log_session_summary(now_ms);
+            load_next_session();
+        }
+        session_open = true;
+        session_start_mass_g = mass_at(now_ms);
+        run_cursor_ms = run_start_ms;
+        next_pulse = 0;
+        replay_motor_on_ms = 0;
+        noise_state = rec_session_id + 1;
+    }
+    begin_segment(Segment::RUN, now_ms);
+    motor_on_since_ms = now_ms;
+    last_edge_ms = now_ms;
+}
+
+void ReplayLoadCellDriver::handle_stop(unsigned long now_ms) {
+    if (segment != Segment::RUN) {
+        return;
+    }
+    uint32_t on_ms = (uint32_t)(now_ms - motor_on_since_ms);
+    replay_motor_on_ms += on_ms;
+
+    // Coast scales with the flow at this stop against the flow the recording stopped at
+    uint32_t t_ms = run_cursor_ms + on_ms;
+    float stop_flow = t_ms < run_stop_ms ? recorded_flow_at(t_ms) : run_end_flow_gps;
+    float scale = run_end_flow_gps > GRIND_FLOW_DETECTION_THRESHOLD_GPS ? constrain(stop_flow / run_end_flow_gps, 0.0f, 2.0f) : 0.0f;
+    begin_segment(Segment::COAST, now_ms);
+    segment_scale = scale;
+    run_cursor_ms = std::min(t_ms, run_stop_ms);     // A restart (after priming) resumes here
+    last_edge_ms = now_ms;
+
+    LOG_BLE("[REPLAY] Stop after %lums on (recorded %lums): %.2fg so far, recorded final %.2fg\n",
+            (unsigned long)replay_motor_on_ms, (unsigned long)rec_motor_on_ms, base_mass_g - session_start_mass_g,
+            rec_final_weight_g);
+}
+
+void ReplayLoadCellDriver::handle_pulse(unsigned long now_ms, uint32_t duration_ms) {
+    if (!session_open) {
+        session_open = true;    // Pulses without a run (autotune) still replay recorded pulses
+        session_start_mass_g = mass_at(now_ms);
+        next_pulse = 0;
+    }
+    begin_segment(Segment::PULSE, now_ms);
+    pulse_duration_ms = duration_ms;
+    pulse_until_ms = now_ms + duration_ms;
+    active_pulse = next_pulse < pulse_count ? &pulses[next_pulse++] : nullptr;
+    if (active_pulse) {
+        float recorded_effective = std::max(1.0f, active_pulse->duration_ms - DEBUG_REPLAY_MOTOR_LATENCY_MS);
+        segment_scale = std::max(0.0f, duration_ms - DEBUG_REPLAY_MOTOR_LATENCY_MS) / recorded_effective;
+    }
+    replay_motor_on_ms += duration_ms;
+    last_edge_ms = pulse_until_ms;
+}
+
+void ReplayLoadCellDriver::log_session_summary(unsigned long now_ms) const {
+    float delivered_g = mass_at(now_ms) - session_start_mass_g;
+    LOG_BLE("[REPLAY] Session %lu: %.2fg delivered with %lums motor on (recorded %.2fg, %lums; delta %+.2fg, %+ldms)\n",
+            (unsigned long)rec_session_id, delivered_g, (unsigned long)replay_motor_on_ms, rec_final_weight_g,
+            (unsigned long)rec_motor_on_ms, delivered_g - rec_final_weight_g,
+            (long)replay_motor_on_ms - (long)rec_motor_on_ms);
+}
+
+//==============================================================================
+// GRINDER INTERACTION
+//==============================================================================
+
+void ReplayLoadCellDriver::notify_grinder_start() {
+    if (instance) {
+        instance->handle_start(millis());
+    }
+}
+
+void ReplayLoadCellDriver::notify_grinder_stop() {
+    if (instance) {
+        instance->handle_stop(millis());
+    }
+}
+
+void ReplayLoadCellDriver::notify_grinder_speed(float duty) {
+    (void)duty;     // The recorded flow already reflects the speed it was ground at
+}
+
+void ReplayLoadCellDriver::notify_pulse(uint32_t duration_ms) {
+    if (instance) {
+        instance->handle_pulse(millis(), duration_ms);
+    }
+}
+
+bool ReplayLoadCellDriver::is_pulse_active() {
+    return instance && instance->segment == Segment::PULSE && millis() < instance->pulse_until_ms;
+}
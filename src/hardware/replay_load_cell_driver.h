@@ -0,0 +1,127 @@
+#pragma once
+
+#include "load_cell_driver.h"
+#include "../config/constants.h"
+#include <Arduino.h>
+
+struct GrindEvent;
+
+/**
+ * ReplayLoadCellDriver plays recorded grind sessions back through WeightSensor
+ * so GrindController (and any new strategy) runs against real grounds flow.
+ * Selected in mock builds with DEBUG_ENABLE_LOADCELL_REPLAY; the grinder then
+ * reports its motor commands here instead of driving the relay.
+ *
+ * The weight stream reacts to the replayed controller rather than repeating
+ * the original one: a start plays the recorded main run from its first motor
+ * on sample, a stop plays the recorded coast scaled to the flow at the new
+ * stop, running past the recorded stop extrapolates its end flow, and the n-th
+ * pulse plays the n-th recorded pulse rescaled to the commanded duration. The
+ * same commands always produce the same stream, so strategies can be compared
+ * over the stored sessions; each replayed session advances to the next file.
+ * Replay runs in real time, the firmware clocks are not virtualized.
+ */
+class ReplayLoadCellDriver : public LoadCellDriver {
+public:
+    ReplayLoadCellDriver();
+    ~ReplayLoadCellDriver() override;
+
+    bool begin() override;
+    bool begin(uint8_t gain_value) override;
+    void set_gain(uint8_t gain_value) override { (void)gain_value; }
+
+    void power_up() override {}
+    void power_down() override {}
+
+    bool is_ready() override { return data_waiting_async(); }
+    bool data_waiting_async() override;
+    bool update_async() override;
+    int32_t get_raw_data() const override { return last_raw_data; }
+
+    bool validate_hardware() override { return true; }
+
+    bool supports_temperature_sensor() const override { return false; }
+    float get_temperature() const override { return NAN; }
+    uint32_t get_max_sample_rate() const override { return HW_LOADCELL_SAMPLE_RATE_HIGH_SPS; }
+    bool set_sample_rate(uint32_t sps) override;
+    uint32_t get_sample_rate() const override { return sample_rate_sps; }
+
+    const char* get_driver_name() const override { return "HX711_REPLAY"; }
+
+    // Grinder interaction, same surface as MockHX711Driver
+    static void notify_grinder_start();
+    static void notify_grinder_stop();
+    static void notify_grinder_speed(float duty);
+    static void notify_pulse(uint32_t duration_ms);
+    static bool is_pulse_active();
+
+private:
+    enum class Segment : uint8_t {
+        IDLE,
+        RUN,        // Recorded main run from run_cursor_ms
+        COAST,      // Recorded coast after the main run, scaled
+        PULSE       // Recorded pulse, rescaled to the commanded duration
+    };
+
+    struct RecordedPulse {
+        uint32_t start_ms;
+        uint32_t end_ms;        // Next motor start or end of the recording
+        float duration_ms;
+    };
+
+    static ReplayLoadCellDriver* instance;
+
+    // Recording (measurement times relative to the recorded session start)
+    uint32_t* rec_time_ms = nullptr;
+    float* rec_weight_g = nullptr;
+    uint16_t rec_count = 0;
+    uint32_t rec_session_id = 0;
+    float rec_final_weight_g = 0.0f;
+    uint32_t rec_motor_on_ms = 0;
+    uint32_t run_start_ms = 0;
+    uint32_t run_stop_ms = 0;
+    uint32_t coast_end_ms = 0;
+    float run_end_flow_gps = 0.0f;
+    RecordedPulse pulses[DEBUG_REPLAY_MAX_PULSES];
+    uint8_t pulse_count = 0;
+    uint16_t file_index = 0;            // Position in the replay directory
+
+    // Replay state
+    Segment segment = Segment::IDLE;
+    unsigned long segment_start_ms = 0;
+    float base_mass_g = 0.0f;           // Mass when the current segment started
+    float session_start_mass_g = 0.0f;  // Grounds stay on the scale across sessions; deltas are per session
+    float segment_scale = 1.0f;
+    uint32_t run_cursor_ms = 0;         // Recorded time a resumed run continues from
+    const RecordedPulse* active_pulse = nullptr;
+    uint32_t pulse_duration_ms = 0;
+    unsigned long pulse_until_ms = 0;
+    uint8_t next_pulse = 0;
+    bool session_open = false;
+    unsigned long last_edge_ms = 0;
+    unsigned long motor_on_since_ms = 0;
+    uint32_t replay_motor_on_ms = 0;
+    uint32_t noise_state = 1;
+
+    // Sampling
+    uint32_t sample_rate_sps;
+    uint32_t sample_interval_ms;
+    unsigned long next_sample_due_ms = 0;
+    int32_t last_raw_data;
+
+    bool load_next_session();
+    bool load_session_file(const char* path);
+    void index_recording(const GrindEvent* events, uint16_t event_count);
+    void release_recording();
+
+    float recorded_weight_at(uint32_t t_ms) const;
+    float recorded_flow_at(uint32_t t_ms) const;
+    float mass_at(unsigned long now_ms) const;
+    void begin_segment(Segment next, unsigned long now_ms);
+    float idle_noise_g();
+
+    void handle_start(unsigned long now_ms);
+    void handle_stop(unsigned long now_ms);
+    void handle_pulse(unsigned long now_ms, uint32_t duration_ms);
+    void log_session_summary(unsigned long now_ms) const;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+#include <type_traits>
+
+enum class RingPlacement : uint8_t {
+    INTERNAL,       // Slots live inside the object (internal SRAM for globals/members)
+    PSRAM,          // Slots are heap_caps_malloc'd in PSRAM by allocate()
+};
+
+// Smallest power-of-two ring capacity holding at least `entries`
+constexpr uint32_t ring_capacity_for(uint32_t entries) {
+    uint32_t capacity = 1;
+    while (capacity < entries) capacity <<= 1;
+    return capacity;
+}
+
+namespace ring_detail {
+template <typename T, uint32_t N, RingPlacement Placement>
+struct Storage;
+
+template <typename T, uint32_t N>
+struct Storage<T, N, RingPlacement::INTERNAL> {
+    T slots[N];
+
+    bool allocate() { return true; }
+    void release() {}
+    bool is_allocated() const { return true; }
+};
+
+template <typename T, uint32_t N>
+struct Storage<T, N, RingPlacement::PSRAM> {
+    T* slots = nullptr;
+
+    bool allocate() {
+        if (!slots) {
+            slots = (T*)heap_caps_malloc(sizeof(T) * N, MALLOC_CAP_SPIRAM);
+        }
+        return slots != nullptr;
+    }
+    void release() {
+        if (slots) {
+            heap_caps_free(slots);
+            slots = nullptr;
+        }
+    }
+    bool is_allocated() const { return slots != nullptr; }
+};
+}
+
+/**
+ * Ring - Fixed-capacity ring buffer with power-of-two mask indexing
+ *
+ * Two ways to drive it:
+ * - Owned count: push() overwrites the oldest entry once full, try_push()
+ *   refuses instead. size()/newest() and the newest-first range read it back.
+ *   Not synchronized - one task owns it, as with any plain member.
+ * - External sequence: slot(seq) maps any running counter onto the ring, for
+ *   callers that publish their own (atomic) write counter, like the lock-free
+ *   CircularBufferMath sample ring. The owned count is unused then.
+ *
+ * Time windows are newest-first prefixes: count_newest_while() finds how many
+ * of the newest entries satisfy a predicate (e.g. timestamp inside the
+ * window), newest_first(count) iterates them. PSRAM placement needs
+ * allocate() before use; INTERNAL storage is always ready.
+ */
+template <typename T, uint32_t N, RingPlacement Placement = RingPlacement::INTERNAL>
+class Ring {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Ring capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "Ring entries are copied and wiped as raw memory");
+
+public:
+    static constexpr uint32_t CAPACITY = N;
+    static constexpr uint32_t INDEX_MASK = N - 1;
+
+    class NewestFirstIterator {
+    public:
+        NewestFirstIterator(const Ring* ring, uint32_t offset) : ring(ring), offset(offset) {}
+        const T& operator*() const { return ring->newest(offset); }
+        NewestFirstIterator& operator++() {
+            offset++;
+            return *this;
+        }
+        bool operator!=(const NewestFirstIterator& other) const { return offset != other.offset; }
+
+    private:
+        const Ring* ring;
+        uint32_t offset;
+    };
+
+    struct NewestFirstRange {
+        NewestFirstIterator first;
+        NewestFirstIterator last;
+        NewestFirstIterator begin() const { return first; }
+        NewestFirstIterator end() const { return last; }
+    };
+
+    Ring() : pushed_count(0) {}
+
+    bool allocate() { return storage.allocate(); }
+    void release() {
+        storage.release();
+        pushed_count = 0;
+    }
+    bool is_allocated() const { return storage.is_allocated(); }
+
+    // External sequence access
+    T& slot(uint32_t seq) { return storage.slots[seq & INDEX_MASK]; }
+    const T& slot(uint32_t seq) const { return storage.slots[seq & INDEX_MASK]; }
+
+    // Owned count
+    void push(const T& value) {
+        storage.slots[pushed_count & INDEX_MASK] = value;
+        pushed_count++;
+    }
+    bool try_push(const T& value) {
+        if (full()) {
+            return false;
+        }
+        push(value);
+        return true;
+    }
+    void clear() { pushed_count = 0; }
+    void wipe() {
+        clear();
+        if (storage.is_allocated()) {
+            memset((void*)storage.slots, 0, sizeof(T) * N);
+        }
+    }
+
+    uint32_t size() const { return pushed_count < N ? pushed_count : N; }
+    uint32_t pushed() const { return pushed_count; }
+    bool empty() const { return pushed_count == 0; }
+    bool full() const { return pushed_count >= N; }
+
+    // newest_offset 0 = most recent entry; offsets must be < size()
+    const T& newest(uint32_t newest_offset = 0) const {
+        return storage.slots[(pushed_count - 1 - newest_offset) & INDEX_MASK];
+    }
+
+    // Entries in insertion order while the ring has never wrapped (filled only
+    // through try_push() since clear()), so they can be written out in one go
+    const T* linear_data() const { return pushed_count <= N ? storage.slots : nullptr; }
+
+    template <typename Predicate>
+    uint32_t count_newest_while(Predicate predicate) const {
+        uint32_t available = size();
+        uint32_t count = 0;
+        while (count < available && predicate(newest(count))) {
+            count++;
+        }
+        return count;
+    }
+
+    NewestFirstRange newest_first(uint32_t count) const {
+        uint32_t available = size();
+        return { NewestFirstIterator(this, 0), NewestFirstIterator(this, count < available ? count : available) };
+    }
+    NewestFirstRange newest_first() const { return newest_first(size()); }
+
+private:
+    ring_detail::Storage<T, N, Placement> storage;
+    uint32_t pushed_count;      // Entries ever pushed since clear()
+};
@@ -0,0 +1,77 @@
+#include "sample_decimator.h"
+#include <algorithm>
+#include <math.h>
+
+uint32_t SampleDecimator::configure(uint32_t input_rate_sps) {
+    factor = (uint8_t)std::min<uint32_t>(std::max<uint32_t>(input_rate_sps / HW_LOADCELL_DECIMATION_TARGET_SPS, 1),
+                                         MAX_FACTOR);
+    phase = 0;
+    started = false;
+
+    gain = 1;
+    for (uint8_t stage = 0; stage < ORDER; stage++) {
+        gain *= factor;
+    }
+
+    // Impulse response: ORDER boxcars of length R convolved; noise gain is its normalized L2 norm
+    static constexpr int kMaxTaps = ORDER * (MAX_FACTOR - 1) + 1;
+    uint32_t taps[kMaxTaps] = { 1 };
+    int length = 1;
+    for (uint8_t stage = 0; stage < ORDER; stage++) {
+        // In place from the end: each tap only reads taps at or below its index
+        length += factor - 1;
+        for (int j = length - 1; j >= 0; j--) {
+            uint32_t sum = 0;
+            for (int k = 0; k < factor && k <= j; k++) {
+                sum += taps[j - k];
+            }
+            taps[j] = sum;
+        }
+    }
+    float sum_squares = 0.0f;
+    for (int i = 0; i < length; i++) {
+        sum_squares += (float)taps[i] * (float)taps[i];
+    }
+    noise_gain = sqrtf(sum_squares) / (float)gain;
+
+    return input_rate_sps / factor;
+}
+
+bool SampleDecimator::add_sample(int32_t raw, uint32_t timestamp_us, int32_t* raw_out, uint32_t* timestamp_us_out) {
+    if (factor <= 1) {
+        *raw_out = raw;
+        *timestamp_us_out = timestamp_us;
+        return true;
+    }
+    if (!started) {
+        started = true;
+        base_raw = raw;
+        std::fill(integrators, integrators + ORDER, 0);
+        std::fill(comb_delays, comb_delays + ORDER, 0);
+    }
+    if (phase == 0) {
+        block_start_us = timestamp_us;
+    }
+
+    uint64_t value = (uint64_t)(int64_t)(raw - base_raw);
+    for (uint8_t stage = 0; stage < ORDER; stage++) {
+        integrators[stage] += value;
+        value = integrators[stage];
+    }
+    if (++phase < factor) {
+        return false;
+    }
+    phase = 0;
+
+    for (uint8_t stage = 0; stage < ORDER; stage++) {
+        const uint64_t delayed = comb_delays[stage];
+        comb_delays[stage] = value;
+        value -= delayed;
+    }
+    const int64_t sum = (int64_t)value;
+    const int64_t rounded = (sum >= 0 ? sum + gain / 2 : sum - gain / 2) / gain;
+    *raw_out = base_raw + (int32_t)rounded;
+    // The CIC delay is ORDER * (R - 1) / 2 input periods; the block spans R - 1
+    *timestamp_us_out = timestamp_us - (uint32_t)((uint64_t)(timestamp_us - block_start_us) * ORDER / 2);
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/constants.h"
+
+/**
+ * SampleDecimator - CIC/boxcar decimation of the ADC stream before the sample ring
+ *
+ * At ADC rates above HW_LOADCELL_DECIMATION_TARGET_SPS, every R input samples
+ * (R = rate / target, rounded down) become one output sample, so the ring and
+ * every window query over it run at about the target rate while each sample
+ * carries the noise of R conversions averaged. HW_LOADCELL_DECIMATION_ORDER
+ * stages of integrators at the input rate and combs at the output rate form a
+ * CIC filter; one stage is a plain boxcar average. More stages reject the
+ * aliases around multiples of the output rate (motor tones above its Nyquist)
+ * harder but weight the middle of a longer span, so they reduce white noise
+ * less: get_noise_gain() is the exact per-sample noise ratio.
+ *
+ * Accumulators are unsigned and wrap: a CIC output is exact modulo 2^64 as long
+ * as the true result fits. Filtering starts on the deviation from the first
+ * sample with zero state, which is the steady state for a constant input (as in
+ * VibrationNotch). The output timestamp is the centre of the filter's span,
+ * which is when the averaged load was on the scale.
+ *
+ * At a factor of 1 samples pass through untouched. Producer-only state
+ * (WeightSamplingTask); configure() restarts it on every ADC rate change.
+ */
+class SampleDecimator {
+public:
+    static constexpr uint8_t ORDER = HW_LOADCELL_DECIMATION_ORDER;
+    static constexpr uint8_t MAX_FACTOR = 32;
+    static_assert(ORDER >= 1 && ORDER <= 3, "HW_LOADCELL_DECIMATION_ORDER must be 1-3");
+
+    // Returns the output rate for an ADC rate
+    uint32_t configure(uint32_t input_rate_sps);
+
+    // true when an output sample is ready in *raw_out / *timestamp_us_out
+    bool add_sample(int32_t raw, uint32_t timestamp_us, int32_t* raw_out, uint32_t* timestamp_us_out);
+
+    uint8_t get_factor() const { return factor; }
+    float get_noise_gain() const { return noise_gain; }     // Output over input white-noise sigma (1 at factor 1)
+
+private:
+    uint8_t factor = 1;
+    uint8_t phase = 0;                  // Input samples into the current output block
+    bool started = false;
+    int32_t base_raw = 0;
+    uint64_t integrators[ORDER] = {};
+    uint64_t comb_delays[ORDER] = {};
+    uint32_t block_start_us = 0;
+    int64_t gain = 1;                   // R^ORDER
+    float noise_gain = 1.0f;
+};
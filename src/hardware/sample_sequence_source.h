@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * SampleSequenceSource - In-order read access to a published sample stream
+ *
+ * Implemented by the CircularBufferMath sample ring and by the raw ADC ring
+ * kept beside it when decimation is on (RawSampleStream). Recorders (session
+ * ADC capture, noise spectra) read whichever WeightSensor::get_recording_source()
+ * returns, so they see every ADC sample whether or not the ring is decimated.
+ *
+ * Sequences count samples ever published. get_sample_sequence_at() finds the
+ * first readable sample at/after a timestamp; read_samples_from() copies oldest
+ * first from *next_seq and advances it, adding samples the ring overwrote
+ * before they were read to *lost_out. Safe from any task against the single
+ * producer (WeightSamplingTask).
+ */
+class SampleSequenceSource {
+public:
+    virtual uint32_t get_sample_sequence_at(uint32_t timestamp_us) const = 0;
+    virtual int read_samples_from(uint32_t* next_seq, int32_t* raw_out, uint32_t* timestamps_out, int max_samples,
+                                  uint32_t* lost_out) const = 0;
+    virtual uint32_t get_latest_sample_time_us() const = 0;
+    virtual uint32_t get_sample_rate() const = 0;       // Nominal rate of the published samples
+
+protected:
+    ~SampleSequenceSource() = default;
+};
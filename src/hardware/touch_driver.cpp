@@ -76,11 +76,43 @@ void TouchDriver::init() {
     last_touch_time = millis();
 }
 
+void IRAM_ATTR TouchDriver::int_falling_isr(void* arg) {
+    TouchDriver* self = static_cast<TouchDriver*>(arg);
+    self->int_pending.store(true, std::memory_order_relaxed);
+    
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    xTaskNotifyFromISR(self->int_notify_task, SYS_UI_WAKE_NOTIFY_BIT, eSetBits, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+bool TouchDriver::enable_interrupt(TaskHandle_t task) {
+#if HW_TOUCH_INT_PIN >= 0
+    if (!initialized || !task || int_notify_task) {
+        return false;
+    }
+    
+    int_notify_task = task;
+    int_pending.store(true, std::memory_order_relaxed);   // Read once in case a finger is already down
+    pinMode(HW_TOUCH_INT_PIN, INPUT_PULLUP);
+    attachInterruptArg(digitalPinToInterrupt(HW_TOUCH_INT_PIN), int_falling_isr, this, FALLING);
+    return true;
+#else
+    (void)task;
+    return false;
+#endif
+}
+
 void TouchDriver::update() {
     if (!initialized || disabled || device_handle == nullptr) {
         return;
     }
     
+    // Interrupt mode: no I2C transaction until the controller signals a touch;
+    // keep reading while pressed so drags and the release are seen
+    if (int_notify_task && !last_touch.pressed && !int_pending.exchange(false, std::memory_order_relaxed)) {
+        return;
+    }
+    
     uint8_t buf[5] = {0};
     uint8_t reg = 0x02; // FT3168_REG_NUM_TOUCHES
     esp_err_t err = i2c_master_transmit_receive(device_handle, &reg, sizeof(reg), buf, sizeof(buf), kTouchI2CTimeoutMs);
@@ -1,5 +1,8 @@
 #pragma once
+#include <atomic>
 #include <driver/i2c_master.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "../config/constants.h"
 
 struct TouchData {
@@ -22,6 +25,11 @@ public:
     void update();
     void disable();
     void enable();
+    
+    // With HW_TOUCH_INT_PIN wired, update() reads the controller only after an INT
+    // edge and while a finger stays down; the edge wakes task with SYS_UI_WAKE_NOTIFY_BIT
+    bool enable_interrupt(TaskHandle_t task);
+    bool is_interrupt_enabled() const { return int_notify_task != nullptr; }
     TouchData get_touch_data() const { return last_touch; }
     bool is_pressed() const { return last_touch.pressed; }
     
@@ -29,6 +37,10 @@ public:
     uint32_t get_ms_since_last_touch() const;
 
 private:
+    static void int_falling_isr(void* arg);
+    
     i2c_master_bus_handle_t bus_handle = nullptr;
     i2c_master_dev_handle_t device_handle = nullptr;
+    TaskHandle_t int_notify_task = nullptr;
+    std::atomic<bool> int_pending{false};
 };
@@ -0,0 +1,49 @@
+#include "vibration_notch.h"
+#include "../config/constants.h"
+#include <math.h>
+
+bool VibrationNotch::design(float tone_hz, float q, uint32_t sample_rate_sps) {
+    design_rate_sps = sample_rate_sps;
+    design_tone_hz = tone_hz;
+    designed = false;
+    if (sample_rate_sps == 0 || tone_hz <= 0.0f || q <= 0.0f) {
+        return false;
+    }
+
+    // Fold the tone into the first Nyquist zone, where the samples see it
+    const float rate = (float)sample_rate_sps;
+    alias_hz = fmodf(tone_hz, rate);
+    if (alias_hz > rate * 0.5f) {
+        alias_hz = rate - alias_hz;
+    }
+    if (alias_hz < HW_LOADCELL_VIBRATION_NOTCH_MIN_ALIAS_HZ) {
+        return false;
+    }
+
+    const float w0 = 2.0f * (float)M_PI * alias_hz / rate;
+    const float cos_w0 = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * q);
+    const float a0 = 1.0f + alpha;
+    b0 = 1.0f / a0;
+    b1 = -2.0f * cos_w0 / a0;
+    b2 = b0;
+    a1 = b1;
+    a2 = (1.0f - alpha) / a0;
+    designed = true;
+    return true;
+}
+
+void VibrationNotch::start(int32_t raw) {
+    // Filtering the deviation from here with zero state is the steady state for a constant input
+    base_raw = raw;
+    z1 = 0.0f;
+    z2 = 0.0f;
+}
+
+int32_t VibrationNotch::process(int32_t raw) {
+    const float x = (float)(raw - base_raw);
+    const float y = b0 * x + z1;
+    z1 = b1 * x - a1 * y + z2;
+    z2 = b2 * x - a2 * y;
+    return base_raw + (int32_t)lroundf(y);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * VibrationNotch - Biquad notch for the motor's vibration tone in the raw stream
+ *
+ * The motor and burrs shake the load cell at a fixed frequency, which the
+ * ADC sees aliased by its sample rate. design() places an RBJ notch at that
+ * alias for the given rate (the measured or configured tone, _Q); an alias
+ * closer to DC than HW_LOADCELL_VIBRATION_NOTCH_MIN_ALIAS_HZ leaves the
+ * filter off, since a notch there would eat the flow ramp itself.
+ *
+ * process() filters the deviation from the first sample after start(), in
+ * direct form II transposed primed to that sample, so a motor start neither
+ * rings nor loses float precision on 24-bit counts. DC gain is exactly 1.
+ *
+ * Producer-only state (WeightSamplingTask).
+ */
+class VibrationNotch {
+public:
+    // false when the tone aliases too close to DC at this rate (filter off)
+    bool design(float tone_hz, float q, uint32_t sample_rate_sps);
+    bool is_designed() const { return designed; }
+    uint32_t get_design_rate_sps() const { return design_rate_sps; }
+    float get_design_tone_hz() const { return design_tone_hz; }
+    float get_alias_hz() const { return alias_hz; }
+
+    void start(int32_t raw);            // Motor on: prime the state to this sample
+    int32_t process(int32_t raw);
+
+private:
+    bool designed = false;
+    uint32_t design_rate_sps = 0;
+    float design_tone_hz = 0.0f;
+    float alias_hz = 0.0f;
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f;
+    float a1 = 0.0f, a2 = 0.0f;
+
+    int32_t base_raw = 0;
+    float z1 = 0.0f, z2 = 0.0f;
+};
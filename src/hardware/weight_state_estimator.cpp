@@ -0,0 +1,113 @@
+#include "weight_state_estimator.h"
+#include <math.h>
+
+WeightStateEstimator::WeightStateEstimator()
+    : initialized(false), origin_raw(0), level(0.0f), rate(0.0f),
+      p00(0.0f), p01(0.0f), p11(0.0f), last_timestamp_us(0),
+      reset_requested(false), version(0) {
+    published = Estimate{};
+}
+
+void WeightStateEstimator::seed(int32_t raw_value, uint32_t timestamp_us, const Tuning& tuning) {
+    // Start at the measurement with no flow; a one-second flow change is the rate uncertainty
+    origin_raw = raw_value;
+    level = 0.0f;
+    rate = 0.0f;
+    p00 = tuning.measurement_sigma_raw * tuning.measurement_sigma_raw;
+    p01 = 0.0f;
+    p11 = tuning.accel_sigma_raw_per_s2 * tuning.accel_sigma_raw_per_s2;
+    last_timestamp_us = timestamp_us;
+    initialized = true;
+}
+
+void WeightStateEstimator::update(int32_t raw_value, uint32_t timestamp_us, const Tuning& tuning) {
+    if (reset_requested.load(std::memory_order_relaxed)) {
+        reset_requested.store(false, std::memory_order_relaxed);
+        initialized = false;
+    }
+
+    int32_t elapsed_us = (int32_t)(timestamp_us - last_timestamp_us);
+    if (!initialized || elapsed_us <= 0 || (uint32_t)elapsed_us > tuning.gap_reset_us) {
+        seed(raw_value, timestamp_us, tuning);
+        publish(timestamp_us);
+        return;
+    }
+
+    // Predict: x = F x, P = F P F' + Q for white acceleration q over dt
+    const float dt = elapsed_us * 1e-6f;
+    const float q = tuning.accel_sigma_raw_per_s2 * tuning.accel_sigma_raw_per_s2;
+    level += rate * dt;
+    p00 += dt * (2.0f * p01 + dt * p11) + q * dt * dt * dt / 3.0f;
+    p01 += dt * p11 + q * dt * dt / 2.0f;
+    p11 += q * dt;
+
+    // Update with the new sample
+    const float r = tuning.measurement_sigma_raw * tuning.measurement_sigma_raw;
+    const float innovation = (float)(raw_value - origin_raw) - level;
+    if (fabsf(innovation) > tuning.step_reset_raw) {
+        seed(raw_value, timestamp_us, tuning);   // Step change, not flow
+        publish(timestamp_us);
+        return;
+    }
+    const float s = p00 + r;
+    const float k0 = p00 / s;
+    const float k1 = p01 / s;
+    level += k0 * innovation;
+    rate += k1 * innovation;
+    p11 -= k1 * p01;
+    p01 -= k0 * p01;
+    p00 -= k0 * p00;
+    last_timestamp_us = timestamp_us;
+
+    // Move whole counts into the integer origin before float resolution suffers
+    if (fabsf(level) > ORIGIN_REBASE_RAW) {
+        int32_t shift = (int32_t)level;
+        origin_raw += shift;
+        level -= (float)shift;
+    }
+
+    publish(timestamp_us);
+}
+
+void WeightStateEstimator::publish(uint32_t timestamp_us) {
+    Estimate estimate;
+    estimate.valid = true;
+    estimate.origin_raw = origin_raw;
+    estimate.level_offset_raw = level;
+    estimate.rate_raw_per_s = rate;
+    estimate.level_sigma_raw = sqrtf(p00 > 0.0f ? p00 : 0.0f);
+    estimate.sample_timestamp_us = timestamp_us;
+
+    uint32_t v = version.load(std::memory_order_relaxed);
+    version.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published = estimate;
+    version.store(v + 2, std::memory_order_release);
+}
+
+bool WeightStateEstimator::get_estimate(Estimate* estimate_out) const {
+    if (!estimate_out) return false;
+    for (int attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+        uint32_t v = version.load(std::memory_order_acquire);
+        if (v & 1) continue;
+        Estimate estimate = published;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version.load(std::memory_order_relaxed) != v) continue;
+        *estimate_out = estimate;
+        return estimate.valid;
+    }
+    return false;
+}
+
+bool WeightStateEstimator::predict_raw(uint32_t at_us, uint32_t lead_us, int32_t reference_raw,
+                                       float* offset_raw_out, float* rate_out) const {
+    Estimate estimate;
+    if (!offset_raw_out || !get_estimate(&estimate)) return false;
+    float ahead_s = ((int32_t)(at_us - estimate.sample_timestamp_us) + (int32_t)lead_us) * 1e-6f;
+    *offset_raw_out = (float)(estimate.origin_raw - reference_raw) + estimate.level_offset_raw +
+                      estimate.rate_raw_per_s * ahead_s;
+    if (rate_out) {
+        *rate_out = estimate.rate_raw_per_s;
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * WeightStateEstimator - Per-sample Kalman filter for weight and flow
+ *
+ * Constant-velocity model on raw ADC units: state is [level, rate], driven by
+ * white flow acceleration (process noise) and observed through the load cell
+ * with the measured noise floor (measurement noise). Updated once per sample
+ * by WeightSamplingTask right after CircularBufferMath::add_sample(), so it
+ * tracks a ramp without the half-window lag of a trimmed mean.
+ *
+ * Level is kept as a float offset from an integer origin (rebased as it
+ * grows) so single-precision math keeps sub-count resolution at 24-bit raw
+ * values. A large innovation (cup placed/removed) or a sample gap re-seeds
+ * the filter. Results are published with a seqlock: one writer, lock-free
+ * readers on any task.
+ */
+class WeightStateEstimator {
+public:
+    struct Tuning {
+        float measurement_sigma_raw;     // ADC noise floor at the current sample rate
+        float accel_sigma_raw_per_s2;    // Expected flow change (process noise)
+        float step_reset_raw;            // |innovation| that re-seeds the filter
+        uint32_t gap_reset_us;           // Sample gap that re-seeds the filter
+    };
+
+    struct Estimate {
+        bool valid;
+        int32_t origin_raw;
+        float level_offset_raw;          // Level at sample time = origin_raw + level_offset_raw
+        float rate_raw_per_s;
+        float level_sigma_raw;
+        uint32_t sample_timestamp_us;
+    };
+
+    WeightStateEstimator();
+
+    // Producer side (WeightSamplingTask only)
+    void update(int32_t raw_value, uint32_t timestamp_us, const Tuning& tuning);
+    void request_reset() { reset_requested.store(true, std::memory_order_relaxed); }
+
+    // Reader side (any task)
+    bool get_estimate(Estimate* estimate_out) const;
+    // Level extrapolated to at_us plus lead_us (the ADC's own conversion delay),
+    // relative to reference_raw (e.g. the tare offset) to keep float precision
+    bool predict_raw(uint32_t at_us, uint32_t lead_us, int32_t reference_raw,
+                     float* offset_raw_out, float* rate_out = nullptr) const;
+
+private:
+    static const int MAX_READ_RETRIES = 4;
+    static constexpr float ORIGIN_REBASE_RAW = 65536.0f;
+
+    // Producer-only filter state
+    bool initialized;
+    int32_t origin_raw;
+    float level;                // Relative to origin_raw
+    float rate;                 // Raw units per second
+    float p00, p01, p11;        // Covariance
+    uint32_t last_timestamp_us;
+    std::atomic<bool> reset_requested;
+
+    // Seqlock-published copy: odd version = update in progress
+    std::atomic<uint32_t> version;
+    Estimate published;
+
+    void seed(int32_t raw_value, uint32_t timestamp_us, const Tuning& tuning);
+    void publish(uint32_t timestamp_us);
+};
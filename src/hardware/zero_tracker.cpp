@@ -0,0 +1,94 @@
+#include "zero_tracker.h"
+#include "../config/constants.h"
+#include <math.h>
+
+void ZeroTracker::reset(int32_t tare_offset, float temperature_c) {
+    // Zero shifts in the fit are relative to the reference; move them with it
+    if (has_reference && fit_weight > 0.0f) {
+        float delta = (float)(tare_offset - reference_offset);
+        fit_to -= delta * fit_t;
+        fit_o -= delta * fit_weight;
+    }
+    has_reference = true;
+    reference_offset = tare_offset;
+    has_anchor = isfinite(temperature_c);
+    anchor_offset = (float)tare_offset;
+    anchor_temperature = temperature_c;
+    has_last_target = false;
+}
+
+bool ZeroTracker::get_temperature_coefficient(float* raw_per_c_out) const {
+    if (fit_weight <= 0.0f) {
+        return false;
+    }
+    float mean_t = fit_t / fit_weight;
+    float var_t = fit_tt / fit_weight - mean_t * mean_t;
+    const float min_span = GRIND_AUTO_ZERO_TEMP_MIN_SPAN_C;
+    if (var_t < min_span * min_span) {
+        return false;
+    }
+    float cov = fit_to / fit_weight - mean_t * (fit_o / fit_weight);
+    *raw_per_c_out = cov / var_t;
+    return true;
+}
+
+void ZeroTracker::fold_temperature(float temperature_c, float zero_shift_raw) {
+    const float forget = GRIND_AUTO_ZERO_TEMP_FORGETTING;
+    fit_weight = forget * fit_weight + 1.0f;
+    fit_t = forget * fit_t + temperature_c;
+    fit_o = forget * fit_o + zero_shift_raw;
+    fit_tt = forget * fit_tt + temperature_c * temperature_c;
+    fit_to = forget * fit_to + temperature_c * zero_shift_raw;
+}
+
+bool ZeroTracker::update(const Observation& observation, const Limits& limits, int32_t current_offset,
+                         int32_t* offset_out) {
+    if (!has_reference) {
+        reset(current_offset, observation.temperature_c);
+    }
+    bool has_temperature = isfinite(observation.temperature_c);
+
+    float target;
+    bool quiet = observation.sample_count >= limits.min_samples && observation.std_dev_raw <= limits.std_dev_limit_raw;
+    float error = (float)(observation.mean_raw - current_offset);
+    if (quiet && fabsf(error) <= limits.band_raw) {
+        // Unloaded and settled: follow the zero slowly
+        target = (float)current_offset + GRIND_AUTO_ZERO_GAIN * error;
+        if (has_temperature) {
+            fold_temperature(observation.temperature_c, target - (float)reference_offset);
+        }
+        has_anchor = has_temperature;
+        anchor_offset = target;
+        anchor_temperature = observation.temperature_c;
+    } else {
+        // Loaded or moving: only the temperature fit can say where zero went
+        float coefficient = 0.0f;
+        if (!has_temperature || !has_anchor || !get_temperature_coefficient(&coefficient)) {
+            return false;
+        }
+        target = anchor_offset + coefficient * (observation.temperature_c - anchor_temperature);
+    }
+
+    float lower = (float)reference_offset - limits.max_total_raw;
+    float upper = (float)reference_offset + limits.max_total_raw;
+    target = constrain(target, lower, upper);
+
+    // Drift from the unrounded estimates, so one-count offset steps do not alias into it
+    if (has_last_target) {
+        int32_t elapsed_us = (int32_t)(observation.time_us - last_target_us);
+        if (elapsed_us > 0) {
+            float rate = (target - last_target) * 1000000.0f / (float)elapsed_us;
+            drift_rate_raw_per_s += GRIND_AUTO_ZERO_DRIFT_ALPHA * (rate - drift_rate_raw_per_s);
+        }
+    }
+    has_last_target = true;
+    last_target = target;
+    last_target_us = observation.time_us;
+
+    int32_t new_offset = (int32_t)lroundf(target);
+    if (new_offset == current_offset) {
+        return false;
+    }
+    *offset_out = new_offset;
+    return true;
+}
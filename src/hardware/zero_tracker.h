@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * ZeroTracker - Idle auto-zero with drift and temperature tracking
+ *
+ * Fed one quiet-window summary at a time (mean, spread, sample count) while
+ * the scale is idle. When the window is settled within band_raw of the
+ * current offset, the offset follows it by GRIND_AUTO_ZERO_GAIN per update,
+ * so creep and thermal drift are absorbed without an explicit tare while a
+ * real load (outside the band) is never zeroed. Total correction is bounded
+ * to max_total_raw around the last explicit tare.
+ *
+ * Each tracked zero is also folded into an exponentially weighted fit of
+ * zero shift against ADC temperature (when the driver reports one). Once the
+ * fit has seen GRIND_AUTO_ZERO_TEMP_MIN_SPAN_C of spread, idle windows that
+ * are loaded or moving move the zero by the fitted coefficient from the last
+ * tracked point instead.
+ *
+ * Producer-only state (WeightSamplingTask); the drift rate is a plain float.
+ */
+class ZeroTracker {
+public:
+    struct Observation {
+        uint32_t time_us;
+        uint16_t sample_count;
+        int32_t mean_raw;
+        float std_dev_raw;
+        float temperature_c;       // NaN without a temperature sensor
+    };
+
+    struct Limits {
+        float band_raw;            // |mean - offset| tracked as zero drift
+        float max_total_raw;       // Largest correction from the explicit tare
+        float std_dev_limit_raw;   // Spread of a settled window
+        uint16_t min_samples;
+    };
+
+    // Explicit tare: new reference, forget the temperature anchor (the fit is kept)
+    void reset(int32_t tare_offset, float temperature_c);
+
+    // New offset in *offset_out and true when the zero moved
+    bool update(const Observation& observation, const Limits& limits, int32_t current_offset, int32_t* offset_out);
+
+    float get_drift_rate_raw_per_s() const { return drift_rate_raw_per_s; }
+    // Offset shift per °C; false until the fit has enough temperature spread
+    bool get_temperature_coefficient(float* raw_per_c_out) const;
+
+private:
+    bool has_reference = false;
+    int32_t reference_offset = 0;
+    bool has_anchor = false;
+    float anchor_offset = 0.0f;
+    float anchor_temperature = NAN;
+    bool has_last_target = false;   // Zero estimate of the previous update (drift rate)
+    float last_target = 0.0f;
+    uint32_t last_target_us = 0;
+    float drift_rate_raw_per_s = 0.0f;
+
+    // EW sums for zero shift (relative to reference) against temperature
+    float fit_weight = 0.0f;
+    float fit_t = 0.0f;
+    float fit_o = 0.0f;
+    float fit_tt = 0.0f;
+    float fit_to = 0.0f;
+
+    void fold_temperature(float temperature_c, float zero_shift_raw);
+};
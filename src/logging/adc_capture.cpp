@@ -0,0 +1,137 @@
+#include "adc_capture.h"
+#include "measurement_codec.h"
+#include "session_stream_writer.h"
+#include "../hardware/sample_sequence_source.h"
+#include <esp_heap_caps.h>
+
+namespace {
+
+bool is_before(uint32_t timestamp_us, uint32_t reference_us) {
+    return (int32_t)(timestamp_us - reference_us) < 0;
+}
+
+}
+
+bool AdcCapture::allocate() {
+    entries = (AdcCaptureEntry*)heap_caps_malloc(GRIND_LOG_ADC_ENTRIES_PER_BLOCK * sizeof(AdcCaptureEntry), MALLOC_CAP_SPIRAM);
+    return entries != nullptr;
+}
+
+void AdcCapture::release() {
+    if (entries) {
+        heap_caps_free(entries);
+        entries = nullptr;
+    }
+    active = false;
+}
+
+void AdcCapture::set_sources(const SampleSequenceSource* sample_source, const MotorEdgeTimeline* edge_source) {
+    samples = sample_source;
+    edges = edge_source;
+}
+
+bool AdcCapture::begin(uint32_t session_start_us) {
+    active = false;
+    if (!entries || !samples) {
+        return false;
+    }
+    start_us = session_start_us;
+    entry_count = 0;
+    pending_edge_count = 0;
+    sample_total = 0;
+    edge_total = 0;
+    lost_samples = 0;
+    lost_edges = 0;
+
+    // The stream opens up to one FileIOTask cycle into the session; the ring still holds its start
+    next_sample_seq = samples->get_sample_sequence_at(start_us);
+    next_edge_index = 0;
+    if (edges) {
+        uint32_t edge_count = edges->get_edge_count();
+        next_edge_index = edge_count > MAX_PENDING_EDGES ? edge_count - MAX_PENDING_EDGES : 0;
+    }
+    active = true;
+    return true;
+}
+
+void AdcCapture::service(SessionStreamWriter* stream) {
+    if (active) {
+        drain(stream, false);
+    }
+}
+
+void AdcCapture::finish(SessionStreamWriter* stream) {
+    if (!active) {
+        return;
+    }
+    drain(stream, true);
+    if (entry_count > 0) {
+        stream->append_adc_capture(entries, entry_count);
+        entry_count = 0;
+    }
+    active = false;
+    LOG_BLE("ADC capture: %lu samples, %lu motor edges (%lu samples, %lu edges lost)\n",
+            (unsigned long)sample_total, (unsigned long)edge_total,
+            (unsigned long)lost_samples, (unsigned long)lost_edges);
+}
+
+void AdcCapture::collect_edges() {
+    if (!edges) {
+        return;
+    }
+    uint32_t edge_count = edges->get_edge_count();
+    MotorEdgeTimeline::Edge edge;
+    for (; next_edge_index < edge_count; next_edge_index++) {
+        if (!edges->get_edge_at_index(next_edge_index, &edge)) {
+            lost_edges++;
+            continue;
+        }
+        if (is_before(edge.timestamp_us, start_us)) {
+            continue;   // Previous session
+        }
+        if (pending_edge_count == MAX_PENDING_EDGES) {
+            lost_edges++;
+            continue;
+        }
+        pending_edges[pending_edge_count++] = edge;
+    }
+}
+
+void AdcCapture::drain(SessionStreamWriter* stream, bool final) {
+    collect_edges();
+
+    uint8_t merged = 0;
+    int count;
+    do {
+        count = samples->read_samples_from(&next_sample_seq, raw_chunk, time_chunk, SAMPLE_CHUNK, &lost_samples);
+        for (int i = 0; i < count; i++) {
+            while (merged < pending_edge_count && is_before(pending_edges[merged].timestamp_us, time_chunk[i])) {
+                add(pending_edges[merged].timestamp_us, (int32_t)pending_edges[merged].type, ADC_CAPTURE_MOTOR_EDGE, stream);
+                merged++;
+            }
+            add(time_chunk[i], raw_chunk[i], ADC_CAPTURE_SAMPLE, stream);
+        }
+        sample_total += count;
+    } while (count == SAMPLE_CHUNK);
+
+    // Edges newer than every sample wait for the next drain, unless the session is over
+    if (final) {
+        for (; merged < pending_edge_count; merged++) {
+            add(pending_edges[merged].timestamp_us, (int32_t)pending_edges[merged].type, ADC_CAPTURE_MOTOR_EDGE, stream);
+        }
+    }
+    edge_total += merged;
+    pending_edge_count -= merged;
+    memmove(pending_edges, pending_edges + merged, pending_edge_count * sizeof(pending_edges[0]));
+}
+
+void AdcCapture::add(uint32_t timestamp_us, int32_t value, uint8_t type, SessionStreamWriter* stream) {
+    AdcCaptureEntry& entry = entries[entry_count++];
+    entry.timestamp_us = timestamp_us - start_us;
+    entry.value = value;
+    entry.type = type;
+    if (entry_count == GRIND_LOG_ADC_ENTRIES_PER_BLOCK) {
+        stream->append_adc_capture(entries, entry_count);
+        entry_count = 0;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../hardware/motor_edge_timeline.h"
+
+struct AdcCaptureEntry;
+class SampleSequenceSource;
+class SessionStreamWriter;
+
+/**
+ * AdcCapture - Raw ADC track of a session for offline filter work
+ *
+ * While enabled, every sample of WeightSensor::get_recording_source() during
+ * the session (full ADC rate, capture timestamps; the raw ring beside a
+ * decimated sample ring) and every motor edge go into the session
+ * file as MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE blocks between the measurement
+ * blocks. FileIOTask drains the sample ring by publish sequence each cycle, so
+ * Core 0 does no extra work; the ring holds about three seconds at 320 SPS.
+ * Samples the ring overwrote before a drain (a long flash stall) leave a gap
+ * and are counted in the session summary log line.
+ *
+ * Edges are merged in front of the first sample captured after them. An edge
+ * recorded after a drain read past it lands in the next block slightly out of
+ * order; entries carry their own timestamps, so readers sort if they need to.
+ */
+class AdcCapture {
+public:
+    bool allocate();                        // Block staging buffer (PSRAM)
+    void release();
+    void set_sources(const SampleSequenceSource* sample_source, const MotorEdgeTimeline* edge_source);
+
+    // FileIOTask
+    bool begin(uint32_t session_start_us);  // Start at the first sample of the session
+    void service(SessionStreamWriter* stream);   // Drain new samples and edges, append full blocks
+    void finish(SessionStreamWriter* stream);    // Drain and append the rest, before the events are written
+    void cancel() { active = false; }
+    bool is_active() const { return active; }
+
+private:
+    static const int SAMPLE_CHUNK = 64;
+    static const uint8_t MAX_PENDING_EDGES = 16;     // MotorEdgeTimeline capacity
+
+    const SampleSequenceSource* samples = nullptr;
+    const MotorEdgeTimeline* edges = nullptr;
+    AdcCaptureEntry* entries = nullptr;     // Block being assembled
+    uint8_t entry_count = 0;
+    bool active = false;
+    uint32_t start_us = 0;
+    uint32_t next_sample_seq = 0;
+    uint32_t next_edge_index = 0;
+    uint32_t sample_total = 0;
+    uint32_t edge_total = 0;
+    uint32_t lost_samples = 0;
+    uint32_t lost_edges = 0;
+
+    MotorEdgeTimeline::Edge pending_edges[MAX_PENDING_EDGES];   // Not yet merged, oldest first
+    uint8_t pending_edge_count = 0;
+    int32_t raw_chunk[SAMPLE_CHUNK];
+    uint32_t time_chunk[SAMPLE_CHUNK];
+
+    void collect_edges();
+    void drain(SessionStreamWriter* stream, bool final);
+    void add(uint32_t timestamp_us, int32_t value, uint8_t type, SessionStreamWriter* stream);
+};
@@ -0,0 +1,185 @@
+#include "deferred_log.h"
+#include "../config/logging.h"
+#include <stdio.h>
+
+DeferredLog deferred_log;
+
+bool DeferredLog::begin() {
+    if (!ring) {
+        ring = xRingbufferCreate(DEFERRED_LOG_RING_BYTES, RINGBUF_TYPE_NOSPLIT);
+    }
+    return ring != nullptr;
+}
+
+void DeferredLog::store(uint8_t* record, uint8_t*& slot, size_t& string_offset, const char* value, size_t size) {
+    uint64_t bits = string_offset;
+    memcpy(slot, &bits, sizeof(bits));
+    slot += sizeof(bits);
+
+    if (size > 1) {
+        memcpy(record + string_offset, value, size - 1);
+    }
+    record[string_offset + size - 1] = '\0';
+    string_offset += size;
+}
+
+bool DeferredLog::next_line(char* out, size_t out_size) {
+    if (!ring) {
+        return false;
+    }
+
+    size_t record_size;
+    void* item = xRingbufferReceive(ring, &record_size, 0);
+    if (item) {
+        format_record((const uint8_t*)item, record_size, out, out_size);
+        vRingbufferReturnItem(ring, item);
+        return true;
+    }
+
+    uint32_t dropped_now = dropped.load();
+    if (dropped_now != reported_dropped) {
+        snprintf(out, out_size, "[LOG] %lu real-time log records dropped (ring full)\n",
+                 (unsigned long)(dropped_now - reported_dropped));
+        reported_dropped = dropped_now;
+        return true;
+    }
+    return false;
+}
+
+void DeferredLog::drain() {
+    char line[DEFERRED_LOG_MAX_LINE];
+    while (next_line(line, sizeof(line))) {
+        LOG_BLE("%s", line);
+    }
+}
+
+size_t DeferredLog::format_record(const uint8_t* record, size_t record_size, char* out, size_t out_size) const {
+    DeferredLogRecord header;
+    if (record_size < sizeof(header)) {
+        return (size_t)snprintf(out, out_size, "[LOG] damaged record\n");
+    }
+    memcpy(&header, record, sizeof(header));
+    const uint8_t* slots = record + sizeof(header);
+    if (header.arg_count > DEFERRED_LOG_MAX_ARGS ||
+        sizeof(header) + header.arg_count * sizeof(uint64_t) > record_size) {
+        return (size_t)snprintf(out, out_size, "[LOG] damaged record\n");
+    }
+
+    size_t length = 0;
+    uint8_t arg_index = 0;
+    const char* p = header.format;
+    auto append = [&](const char* text, size_t count) {
+        if (length + 1 >= out_size) {
+            return;
+        }
+        size_t room = out_size - 1 - length;
+        count = count < room ? count : room;
+        memcpy(out + length, text, count);
+        length += count;
+    };
+
+    while (*p) {
+        if (*p != '%') {
+            const char* literal = p;
+            while (*p && *p != '%') {
+                p++;
+            }
+            append(literal, p - literal);
+            continue;
+        }
+        if (p[1] == '%') {
+            append("%", 1);
+            p += 2;
+            continue;
+        }
+
+        // Rebuild the conversion without its length modifier; the stored type decides the width
+        char spec[24];
+        size_t spec_length = 0;
+        spec[spec_length++] = *p++;
+        while (*p && strchr("-+ #0123456789.", *p) && spec_length < sizeof(spec) - 4) {
+            spec[spec_length++] = *p++;
+        }
+        while (*p && strchr("hlLqjzt", *p)) {
+            p++;
+        }
+        char conversion = *p;
+        if (!conversion) {
+            break;
+        }
+        p++;
+        if (arg_index >= header.arg_count) {
+            append("<?>", 3);
+            continue;
+        }
+
+        DeferredLogArg type = header.arg_types[arg_index];
+        uint64_t bits;
+        memcpy(&bits, slots + arg_index * sizeof(uint64_t), sizeof(bits));
+        arg_index++;
+
+        char piece[DEFERRED_LOG_MAX_LINE];
+        int written_length = 0;
+        switch (conversion) {
+            case 'd': case 'i': {
+                spec[spec_length++] = 'l';
+                spec[spec_length++] = 'l';
+                spec[spec_length++] = 'd';
+                spec[spec_length] = '\0';
+                long long value = type == DeferredLogArg::INT32 ? (long long)(int32_t)bits
+                                : type == DeferredLogArg::DOUBLE ? 0 : (long long)bits;
+                written_length = snprintf(piece, sizeof(piece), spec, value);
+                break;
+            }
+            case 'u': case 'x': case 'X': case 'o': {
+                spec[spec_length++] = 'l';
+                spec[spec_length++] = 'l';
+                spec[spec_length++] = conversion;
+                spec[spec_length] = '\0';
+                unsigned long long value = type == DeferredLogArg::INT32 ? (unsigned long long)(uint32_t)bits
+                                         : type == DeferredLogArg::DOUBLE ? 0 : (unsigned long long)bits;
+                written_length = snprintf(piece, sizeof(piece), spec, value);
+                break;
+            }
+            case 'c':
+                spec[spec_length++] = 'c';
+                spec[spec_length] = '\0';
+                written_length = snprintf(piece, sizeof(piece), spec, (int)(int32_t)bits);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                spec[spec_length++] = conversion;
+                spec[spec_length] = '\0';
+                double value;
+                if (type == DeferredLogArg::DOUBLE) {
+                    memcpy(&value, &bits, sizeof(value));
+                } else {
+                    value = (double)(int64_t)bits;
+                }
+                written_length = snprintf(piece, sizeof(piece), spec, value);
+                break;
+            }
+            case 's': {
+                spec[spec_length++] = 's';
+                spec[spec_length] = '\0';
+                const char* value = "<?>";
+                if (type == DeferredLogArg::STRING && bits < record_size && record[record_size - 1] == '\0') {
+                    value = (const char*)record + bits;
+                }
+                written_length = snprintf(piece, sizeof(piece), spec, value);
+                break;
+            }
+            case 'p':
+                written_length = snprintf(piece, sizeof(piece), "%p", (void*)(uintptr_t)bits);
+                break;
+            default:
+                piece[0] = '\0';    // %n and unknown conversions print nothing
+                break;
+        }
+        if (written_length > 0) {
+            append(piece, (size_t)written_length < sizeof(piece) ? (size_t)written_length : sizeof(piece) - 1);
+        }
+    }
+
+    out[length] = '\0';
+    return length;
+}
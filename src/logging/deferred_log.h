@@ -0,0 +1,180 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/ringbuf.h>
+#include <atomic>
+#include <initializer_list>
+#include <string.h>
+#include <type_traits>
+#include "../config/logging.h"
+
+#define DEFERRED_LOG_RING_BYTES 4096       // Records from Core 0 waiting for FileIOTask
+#define DEFERRED_LOG_MAX_ARGS 16
+#define DEFERRED_LOG_MAX_STRING 32         // String arguments are copied, cut at this length
+#define DEFERRED_LOG_MAX_LINE 256          // Formatted line on Core 1
+
+// How a record stores each argument in its 8-byte slot
+enum class DeferredLogArg : uint8_t {
+    INT32,          // Integers up to 32 bits, widened per the conversion when formatted
+    INT64,
+    DOUBLE,         // float and double (printf promotes float anyway)
+    STRING,         // Slot holds the offset of the copy within the record
+    POINTER
+};
+
+// Ring item: this header, arg_count slots, then the copied strings
+struct DeferredLogRecord {
+    const char* format;                             // Must outlive the record: a literal
+    uint8_t arg_count;
+    DeferredLogArg arg_types[DEFERRED_LOG_MAX_ARGS];
+};
+
+/**
+ * DeferredLog - Binary logging for the real-time core
+ *
+ * Core 0 code logs with LOG_RT(format, ...) instead of LOG_BLE. write() captures the
+ * format pointer and the raw arguments (types known at compile time, strings copied)
+ * into a record acquired in place from a no-split ring buffer; nothing is formatted and
+ * nothing waits for the UART. A full ring drops the record and counts it. On Core 1,
+ * next_line() formats the oldest record with printf semantics (FileIOTask batches the
+ * lines), and drain() prints them one by one through LOG_BLE. Drops are reported as
+ * a line of their own.
+ *
+ * Formats may use any printf conversion except '*' widths and %n.
+ */
+class DeferredLog {
+public:
+    bool begin();
+
+    template<typename... Args>
+    void write(const char* format, const Args&... args);
+
+    bool next_line(char* out, size_t out_size);     // Core 1: format the oldest record; false when empty
+    void drain();                                   // Core 1: format and print everything queued
+
+    uint32_t get_dropped_count() const { return dropped.load(); }
+    uint32_t get_written_count() const { return written.load(); }
+
+private:
+    RingbufHandle_t ring = nullptr;
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> written{0};
+    uint32_t reported_dropped = 0;
+
+    template<typename T>
+    static DeferredLogArg type_of(T) {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                      "LOG_RT arguments must be numbers, enums, strings or pointers");
+        return std::is_floating_point<T>::value ? DeferredLogArg::DOUBLE
+             : std::is_pointer<T>::value ? DeferredLogArg::POINTER
+             : sizeof(T) > 4 ? DeferredLogArg::INT64 : DeferredLogArg::INT32;
+    }
+    static DeferredLogArg type_of(const char*) { return DeferredLogArg::STRING; }
+    static DeferredLogArg type_of(char*) { return DeferredLogArg::STRING; }
+
+    // Scans up to the terminator rather than strnlen()ing a fixed bound: a decayed literal
+    // shorter than DEFERRED_LOG_MAX_STRING must not be read past its end
+    static size_t string_size(const char* value, size_t capacity = DEFERRED_LOG_MAX_STRING) {
+        size_t limit = capacity < DEFERRED_LOG_MAX_STRING ? capacity : DEFERRED_LOG_MAX_STRING;
+        size_t length = 0;
+        while (value && length < limit && value[length] != '\0') {
+            length++;
+        }
+        return length + 1;
+    }
+    template<typename T>
+    static constexpr bool is_string = std::is_same<typename std::decay<T>::type, const char*>::value ||
+                                      std::is_same<typename std::decay<T>::type, char*>::value;
+
+    // Char arrays (literals, fixed buffers) are never read past their own extent
+    template<typename T>
+    static size_t string_size(const T& value) {
+        if constexpr (is_string<T> && std::is_array<T>::value) {
+            return string_size(value, std::extent<T>::value);
+        } else if constexpr (is_string<T>) {
+            return string_size((const char*)value);
+        } else {
+            return 0;
+        }
+    }
+
+    template<typename T>
+    static void store(uint8_t*, uint8_t*& slot, size_t&, T value) {
+        uint64_t bits = 0;
+        if constexpr (std::is_floating_point<T>::value) {
+            double promoted = (double)value;
+            memcpy(&bits, &promoted, sizeof(bits));
+        } else {
+            bits = (uint64_t)(int64_t)value;    // Sign-extends; the conversion picks the width back
+        }
+        memcpy(slot, &bits, sizeof(bits));
+        slot += sizeof(bits);
+    }
+    template<typename T>
+    static void store(uint8_t*, uint8_t*& slot, size_t&, T* value) {
+        uint64_t bits = (uint64_t)(uintptr_t)value;
+        memcpy(slot, &bits, sizeof(bits));
+        slot += sizeof(bits);
+    }
+    static void store(uint8_t* record, uint8_t*& slot, size_t& string_offset, const char* value, size_t size);
+    template<typename T>
+    static void store_arg(uint8_t* record, uint8_t*& slot, size_t& string_offset, const T& value) {
+        if constexpr (is_string<T>) {
+            store(record, slot, string_offset, (const char*)value, string_size(value));
+        } else {
+            store(record, slot, string_offset, value);
+        }
+    }
+
+    size_t format_record(const uint8_t* record, size_t record_size, char* out, size_t out_size) const;
+};
+
+extern DeferredLog deferred_log;
+
+#define LOG_RT(format, ...) deferred_log.write(format, ##__VA_ARGS__)
+
+// LOG_AT for Core 0: the same compile-time cut and runtime mask check, then a deferred record
+#define LOG_RT_AT(category, level, format, ...) do {                                 \
+        if constexpr ((int)(level) <= (int)log_compile_level(category)) {            \
+            if (log_level_enabled(category, level)) {                                \
+                deferred_log.write(format, ##__VA_ARGS__);                           \
+            }                                                                        \
+        }                                                                            \
+    } while (0)
+
+template<typename... Args>
+void DeferredLog::write(const char* format, const Args&... args) {
+    static_assert(sizeof...(Args) <= DEFERRED_LOG_MAX_ARGS, "Too many LOG_RT arguments");
+    if (!ring) {
+        dropped++;
+        return;
+    }
+
+    const size_t header_size = sizeof(DeferredLogRecord);
+    const size_t slots_size = sizeof...(Args) * sizeof(uint64_t);
+    size_t strings_size = 0;
+    (void)std::initializer_list<int>{ (strings_size += string_size(args), 0)... };
+
+    void* item = nullptr;
+    if (xRingbufferSendAcquire(ring, &item, header_size + slots_size + strings_size, 0) != pdTRUE) {
+        dropped++;
+        return;
+    }
+
+    uint8_t* record = (uint8_t*)item;
+    DeferredLogRecord* header = (DeferredLogRecord*)record;
+    header->format = format;
+    header->arg_count = sizeof...(Args);
+    if constexpr (sizeof...(Args) > 0) {
+        uint8_t type_index = 0;
+        (void)std::initializer_list<int>{ (header->arg_types[type_index++] = type_of(args), 0)... };
+
+        uint8_t* slot = record + header_size;
+        size_t string_offset = header_size + slots_size;
+        (void)std::initializer_list<int>{ (store_arg(record, slot, string_offset, args), 0)... };
+    }
+
+    xRingbufferSendComplete(ring, item);
+    written++;
+}
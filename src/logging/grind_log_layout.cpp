@@ -0,0 +1,164 @@
+#include "grind_log_layout.h"
+#include "grind_logging.h"
+#include <string.h>
+
+namespace {
+const LogFieldLayout HEADER_FIELDS[] = {
+    LOG_FIELD(TimeSeriesSessionHeader, session_id),
+    LOG_FIELD(TimeSeriesSessionHeader, session_timestamp),
+    LOG_FIELD(TimeSeriesSessionHeader, session_size),
+    LOG_FIELD(TimeSeriesSessionHeader, checksum),
+    LOG_FIELD(TimeSeriesSessionHeader, event_count),
+    LOG_FIELD(TimeSeriesSessionHeader, measurement_count),
+    LOG_FIELD(TimeSeriesSessionHeader, schema_version),
+    LOG_FIELD(TimeSeriesSessionHeader, flags),
+};
+
+const LogFieldLayout SESSION_FIELDS[] = {
+    LOG_FIELD(GrindSession, session_id),
+    LOG_FIELD(GrindSession, session_timestamp),
+    LOG_FIELD(GrindSession, target_time_ms),
+    LOG_FIELD(GrindSession, total_time_ms),
+    LOG_FIELD(GrindSession, total_motor_on_time_ms),
+    LOG_FIELD(GrindSession, time_error_ms),
+    LOG_FIELD(GrindSession, target_weight),
+    LOG_FIELD(GrindSession, tolerance),
+    LOG_FIELD(GrindSession, final_weight),
+    LOG_FIELD(GrindSession, error_grams),
+    LOG_FIELD(GrindSession, start_weight),
+    LOG_FIELD(GrindSession, initial_motor_stop_offset),
+    LOG_FIELD(GrindSession, latency_to_coast_ratio),
+    LOG_FIELD(GrindSession, flow_rate_threshold),
+    LOG_FIELD(GrindSession, profile_id),
+    LOG_FIELD(GrindSession, grind_mode),
+    LOG_FIELD(GrindSession, max_pulse_attempts),
+    LOG_FIELD(GrindSession, pulse_count),
+    LOG_FIELD(GrindSession, termination_reason),
+    LOG_FIELD(GrindSession, flow_detection_window_steps),
+    LOG_FIELD(GrindSession, flow_prediction_window_steps),
+    LOG_FIELD(GrindSession, grinder_channel),     // Was reserved, always 0, before schema 8
+    LOG_FIELD(GrindSession, result_status),       // 16 chars, up to the end, before schema 7
+    LOG_FIELD_SINCE(GrindSession, events_dropped, GRIND_LOG_SCHEMA_OVERFLOW_COUNTS),
+    LOG_FIELD_SINCE(GrindSession, measurements_dropped, GRIND_LOG_SCHEMA_OVERFLOW_COUNTS),
+};
+
+const LogFieldLayout EVENT_FIELDS[] = {
+    LOG_FIELD(GrindEvent, timestamp_ms),
+    LOG_FIELD(GrindEvent, duration_ms),
+    LOG_FIELD(GrindEvent, grind_latency_ms),
+    LOG_FIELD(GrindEvent, settling_duration_ms),
+    LOG_FIELD(GrindEvent, start_weight),
+    LOG_FIELD(GrindEvent, end_weight),
+    LOG_FIELD(GrindEvent, motor_stop_target_weight),
+    LOG_FIELD(GrindEvent, pulse_duration_ms),
+    LOG_FIELD(GrindEvent, pulse_flow_rate),
+    LOG_FIELD(GrindEvent, event_sequence_id),
+    LOG_FIELD(GrindEvent, loop_count),
+    LOG_FIELD(GrindEvent, phase_id),
+    LOG_FIELD(GrindEvent, pulse_attempt_number),
+    LOG_FIELD(GrindEvent, event_flags),
+    LOG_FIELD(GrindEvent, reserved),
+};
+
+const LogFieldLayout MEASUREMENT_FIELDS[] = {
+    LOG_FIELD(GrindMeasurement, timestamp_ms),
+    LOG_FIELD(GrindMeasurement, weight_grams),
+    LOG_FIELD(GrindMeasurement, weight_delta),
+    LOG_FIELD(GrindMeasurement, flow_rate_g_per_s),
+    LOG_FIELD(GrindMeasurement, motor_stop_target_weight),
+    LOG_FIELD(GrindMeasurement, sequence_id),
+    LOG_FIELD(GrindMeasurement, motor_is_on),
+    LOG_FIELD(GrindMeasurement, phase_id),
+    LOG_FIELD_SINCE(GrindMeasurement, sample_timestamp_us, GRIND_LOG_SCHEMA_SAMPLE_TIME_US),
+};
+
+#define LOG_STRUCT(type, fields) { #type, (uint16_t)sizeof(type), fields, (uint8_t)(sizeof(fields) / sizeof(fields[0])) }
+
+size_t field_entry_size(const LogFieldLayout& field) {
+    return 1 + strlen(field.name) + 2 + 1 + 1 + 1;
+}
+
+size_t log_field_size(LogFieldType type) {
+    switch (type) {
+        case LogFieldType::U16: return 2;
+        case LogFieldType::U32:
+        case LogFieldType::I32:
+        case LogFieldType::F32: return 4;
+        default: return 1;
+    }
+}
+
+uint8_t* put_name(uint8_t* p, const char* name) {
+    size_t length = strlen(name);
+    *p++ = (uint8_t)length;
+    memcpy(p, name, length);
+    return p + length;
+}
+
+uint8_t* put_u16(uint8_t* p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+    return p + 2;
+}
+} // namespace
+
+const LogStructLayout GRIND_LOG_STRUCTS[] = {
+    LOG_STRUCT(TimeSeriesSessionHeader, HEADER_FIELDS),
+    LOG_STRUCT(GrindSession, SESSION_FIELDS),
+    LOG_STRUCT(GrindEvent, EVENT_FIELDS),
+    LOG_STRUCT(GrindMeasurement, MEASUREMENT_FIELDS),
+};
+const uint8_t GRIND_LOG_STRUCT_COUNT = sizeof(GRIND_LOG_STRUCTS) / sizeof(GRIND_LOG_STRUCTS[0]);
+
+size_t grind_log_layout_size() {
+    size_t size = 8;
+    for (uint8_t s = 0; s < GRIND_LOG_STRUCT_COUNT; s++) {
+        const LogStructLayout& layout = GRIND_LOG_STRUCTS[s];
+        size += 1 + strlen(layout.name) + 2 + 1;
+        for (uint8_t f = 0; f < layout.field_count; f++) {
+            size += field_entry_size(layout.fields[f]);
+        }
+    }
+    return size;
+}
+
+size_t write_grind_log_layout(uint8_t* out, size_t out_size) {
+    size_t size = grind_log_layout_size();
+    if (!out || out_size < size) {
+        return 0;
+    }
+
+    uint8_t* p = out;
+    memcpy(p, &GRIND_LOG_LAYOUT_MAGIC, 4);
+    p += 4;
+    *p++ = GRIND_LOG_LAYOUT_VERSION;
+    *p++ = GRIND_LOG_STRUCT_COUNT;
+    p = put_u16(p, GRIND_LOG_SCHEMA_VERSION);
+    for (uint8_t s = 0; s < GRIND_LOG_STRUCT_COUNT; s++) {
+        const LogStructLayout& layout = GRIND_LOG_STRUCTS[s];
+        p = put_name(p, layout.name);
+        p = put_u16(p, layout.size);
+        *p++ = layout.field_count;
+        for (uint8_t f = 0; f < layout.field_count; f++) {
+            const LogFieldLayout& field = layout.fields[f];
+            p = put_name(p, field.name);
+            p = put_u16(p, field.offset);
+            *p++ = (uint8_t)field.type;
+            *p++ = field.count;
+            *p++ = field.since_schema;
+        }
+    }
+    return p - out;
+}
+
+bool grind_log_layout_is_complete(const LogStructLayout& layout) {
+    size_t end = 0;
+    for (uint8_t f = 0; f < layout.field_count; f++) {
+        const LogFieldLayout& field = layout.fields[f];
+        if (field.offset != end) {
+            return false;
+        }
+        end += log_field_size(field.type) * field.count;
+    }
+    return end == layout.size;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <type_traits>
+
+constexpr uint32_t GRIND_LOG_LAYOUT_MAGIC = 0x59414C47;     // "GLAY"
+constexpr uint8_t GRIND_LOG_LAYOUT_VERSION = 1;
+
+// Field types, as Python struct format characters so host tools can use them as they are
+enum class LogFieldType : uint8_t {
+    U8 = 'B',
+    U16 = 'H',
+    U32 = 'I',
+    I32 = 'i',
+    F32 = 'f',
+    CHAR = 's'                      // Byte string of LogFieldLayout::count chars, NUL padded
+};
+
+struct LogFieldLayout {
+    const char* name;
+    uint16_t offset;
+    LogFieldType type;
+    uint8_t count;                  // Array length, 1 for scalars
+    uint8_t since_schema;           // First GRIND_LOG_SCHEMA_VERSION whose files hold the field
+};
+
+struct LogStructLayout {
+    const char* name;
+    uint16_t size;
+    const LogFieldLayout* fields;
+    uint8_t field_count;
+};
+
+template <typename T> constexpr LogFieldType log_field_type();
+template <> constexpr LogFieldType log_field_type<uint8_t>() { return LogFieldType::U8; }
+template <> constexpr LogFieldType log_field_type<uint16_t>() { return LogFieldType::U16; }
+template <> constexpr LogFieldType log_field_type<uint32_t>() { return LogFieldType::U32; }
+template <> constexpr LogFieldType log_field_type<int32_t>() { return LogFieldType::I32; }
+template <> constexpr LogFieldType log_field_type<float>() { return LogFieldType::F32; }
+template <> constexpr LogFieldType log_field_type<char>() { return LogFieldType::CHAR; }
+
+// One table row per member, typed and sized from the declaration itself
+#define LOG_FIELD_SINCE(record, member, since)                                                                    \
+    { #member, (uint16_t)offsetof(record, member),                                                                \
+      log_field_type<std::remove_all_extents<decltype(record::member)>::type>(),                                  \
+      (uint8_t)(std::extent<decltype(record::member)>::value ? std::extent<decltype(record::member)>::value : 1), \
+      (uint8_t)(since) }
+#define LOG_FIELD(record, member) LOG_FIELD_SINCE(record, member, 1)
+
+/**
+ * Grind log layout - the session file structs, described by the firmware
+ *
+ * TimeSeriesSessionHeader, GrindSession, GrindEvent and GrindMeasurement are
+ * packed little-endian records that the host tools decode. Each struct is listed
+ * here field by field, with offsets and types taken from the declarations
+ * (offsetof / decltype), so the table cannot drift from the code that writes
+ * the files. write_grind_log_layout() serializes it for the current
+ * GRIND_LOG_SCHEMA_VERSION, all little-endian:
+ *
+ *   [magic:4 "GLAY"][layout_version:1][struct_count:1][schema_version:2]
+ *   per struct: [name_length:1][name][size:2][field_count:1]
+ *   per field:  [name_length:1][name][offset:2][type:1][count:1][since_schema:1]
+ *
+ * BLE_DATA_CMD_GET_LOG_LAYOUT streams it like a query reply; grinder-ble.py
+ * builds its decoders from it (tools/ble/log_layout.py). Fields added to these
+ * structs need a row here, with since_schema set to the schema that added them.
+ * Measurement blocks (schema >= 4) decode to GrindMeasurement records; their
+ * column encoding is described in measurement_codec.h.
+ */
+extern const LogStructLayout GRIND_LOG_STRUCTS[];
+extern const uint8_t GRIND_LOG_STRUCT_COUNT;
+
+size_t grind_log_layout_size();
+size_t write_grind_log_layout(uint8_t* out, size_t out_size);     // Bytes written, 0 if out_size is short
+bool grind_log_layout_is_complete(const LogStructLayout& layout);  // Fields tile the struct without gaps
@@ -1,11 +1,22 @@
 #include "grind_logging.h"
+#include "grind_log_layout.h"
+#include "measurement_codec.h"
+#include "session_reader.h"
+#include "session_rollups.h"
 #include <LittleFS.h>
 #include <esp_heap_caps.h>
 #include <esp_log.h>
+#include <algorithm>
 #include "../hardware/WeightSensor.h"
 #include "../hardware/grinder.h"
 #include "../config/constants.h"
 #include "../system/statistics_manager.h"
+#include "../system/config_store.h"
+#include "../system/memory_arena.h"
+
+static_assert(GRIND_ADAPTIVE_PREDICTION_MAX_MS / GRIND_ADAPTIVE_WINDOW_STEP_MS <= UINT8_MAX &&
+              GRIND_FLOW_PREDICTION_WINDOW_MS / GRIND_ADAPTIVE_WINDOW_STEP_MS <= UINT8_MAX,
+              "Flow windows must fit the session's window step bytes");
 
 namespace {
 
@@ -23,6 +34,15 @@ GrindTerminationReason classify_termination_reason(const char* final_result) {
     if (strcmp(final_result, "COMPLETE - MAX PULSES") == 0) {
         return GrindTerminationReason::MAX_PULSES;
     }
+    if (strcmp(final_result, "ABORT - FLOW STALLED") == 0) {
+        return GrindTerminationReason::FLOW_STALLED;
+    }
+    if (strcmp(final_result, "ABORT - FLOW UNSTABLE") == 0) {
+        return GrindTerminationReason::FLOW_UNSTABLE;
+    }
+    if (strcmp(final_result, "ABORT - PROJECTED TIMEOUT") == 0) {
+        return GrindTerminationReason::PROJECTED_TIMEOUT;
+    }
     if (strcmp(final_result, "COMPLETE") == 0) {
         return GrindTerminationReason::COMPLETED;
     }
@@ -30,66 +50,99 @@ GrindTerminationReason classify_termination_reason(const char* final_result) {
     return GrindTerminationReason::UNKNOWN;
 }
 
+
 }
 
 GrindLogger grind_logger;
 
 bool GrindLogger::init(Preferences* prefs) {
     _preferences = prefs;
-    current_session = (GrindSession*)heap_caps_malloc(sizeof(GrindSession), MALLOC_CAP_SPIRAM);
-    if (!current_session) {
-        LOG_BLE("ERROR: Failed to allocate PSRAM for grind session\n");
-        return false;
+    for (Recording& recording : recordings) {
+        recording.session = (GrindSession*)heap_caps_malloc(sizeof(GrindSession), MALLOC_CAP_SPIRAM);
+        if (!recording.session) {
+            LOG_BLE("ERROR: Failed to allocate PSRAM for grind session\n");
+            cleanup();
+            return false;
+        }
+        
+        if (!recording.event_buffer.allocate()) {
+            LOG_BLE("ERROR: Failed to allocate PSRAM for grind events\n");
+            cleanup();
+            return false;
+        }
+        
+        if (!recording.measurement_stream.allocate()) {
+            LOG_BLE("ERROR: Failed to allocate PSRAM for grind measurements\n");
+            cleanup();
+            return false;
+        }
+        
+        if (!recording.adc_capture.allocate()) {
+            LOG_BLE("Warning: Failed to allocate PSRAM for ADC capture, capture unavailable\n");
+        }
+        
+        recording.logging_active = false;
+        recording.streamed_session_id = 0;
     }
     
-    event_buffer = (GrindEvent*)heap_caps_malloc(sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
-    if (!event_buffer) {
-        LOG_BLE("ERROR: Failed to allocate PSRAM for grind events\n");
-        heap_caps_free(current_session);
-        return false;
+    // Load the next session ID from preferences; a session interrupted by a reset already used its ID
+    _next_session_id = _preferences->getUInt("next_session_id", 1);
+    if (log_partition.begin()) {
+        for (Recording& recording : recordings) {
+            recording.measurement_stream.use_partition(&log_partition);
+        }
+    } else {
+        recover_interrupted_session_files();
+        session_index.verify();  // Also picks up files recovered above
     }
-    
-    measurement_buffer = (GrindMeasurement*)heap_caps_malloc(sizeof(GrindMeasurement) * MEASUREMENT_TEMP_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
-    if (!measurement_buffer) {
-        LOG_BLE("ERROR: Failed to allocate PSRAM for grind measurements\n");
-        heap_caps_free(current_session);
-        heap_caps_free(event_buffer);
-        return false;
+    if (!session_summaries.begin() && session_summaries.is_ready()) {
+        seed_session_summaries();
+    }
+    for (Recording& recording : recordings) {
+        prepare_next_session(recording);
     }
     
-    event_count = 0;
-    measurement_count = 0;
-    event_sequence_counter = 0;
-    logging_active = false;
-    
-    // Load the next session ID from preferences
-    _next_session_id = _preferences->getUInt("next_session_id", 1);
-    
-    LOG_BLE("Time-series Logger initialized:\n");
-    LOG_BLE("  - Event Buffer: %lu KB (%d events)\n", (unsigned long)((sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE) / 1024), (int)EVENT_TEMP_BUFFER_SIZE);
-    LOG_BLE("  - Measurement Buffer: %lu KB (%d measurements)\n", (unsigned long)((sizeof(GrindMeasurement) * MEASUREMENT_TEMP_BUFFER_SIZE) / 1024), (int)MEASUREMENT_TEMP_BUFFER_SIZE);
+    LOG_BLE("Time-series Logger initialized (%d recordings):\n", HW_GRINDER_CHANNELS);
+    LOG_BLE("  - Event Buffer: %d events (%lu B), grows by %d up to %d\n", GRIND_LOG_EVENT_CHUNK,
+            (unsigned long)(sizeof(GrindEvent) * GRIND_LOG_EVENT_CHUNK), GRIND_LOG_EVENT_CHUNK, GRIND_LOG_MAX_EVENTS);
+    LOG_BLE("  - Measurement Stream: %d x %d staged (%lu B SRAM), %d-measurement block (%lu KB PSRAM)\n",
+            SYS_LOG_STAGING_CHUNKS, SYS_LOG_STAGING_RECORDS,
+            (unsigned long)(SYS_LOG_STAGING_CHUNKS * SYS_LOG_STAGING_RECORDS * sizeof(GrindMeasurement)),
+            GRIND_LOG_MEASUREMENTS_PER_BLOCK,
+            (unsigned long)((sizeof(GrindMeasurement) * GRIND_LOG_MEASUREMENTS_PER_BLOCK) / 1024));
     LOG_BLE("  - Next session ID: %lu\n", _next_session_id);
     
     return true;
 }
 
 void GrindLogger::cleanup() {
-    if (current_session) heap_caps_free(current_session);
-    if (event_buffer) heap_caps_free(event_buffer);
-    if (measurement_buffer) heap_caps_free(measurement_buffer);
+    for (Recording& recording : recordings) {
+        if (recording.session) heap_caps_free(recording.session);
+        recording.session = nullptr;
+        recording.event_buffer.release();
+        recording.measurement_stream.release();
+        recording.adc_capture.release();
+    }
+    log_partition.end();
+    session_summaries.end();
 }
 
 void GrindLogger::start_grind_session(const GrindSessionDescriptor& descriptor, float start_weight) {
-    if (!current_session || !event_buffer || !measurement_buffer) {
+    Recording& recording = recording_for(descriptor.grinder_channel);
+    GrindSession* current_session = recording.session;
+    if (!current_session || !recording.event_buffer.is_allocated()) {
         return;
     }
 
-    clear_buffers();
+    // Normally prepared when the previous session ended; the id is persisted then too
+    if (!recording.session_prepared) {
+        clear_buffers(recording);
+    }
+    recording.session_prepared = false;
     memset(current_session, 0, sizeof(GrindSession));
 
     current_session->session_id = _next_session_id;
     _next_session_id++;
-    _preferences->putUInt("next_session_id", _next_session_id);
 
     current_session->session_timestamp = millis() / 1000;
     current_session->profile_id = descriptor.profile_id;
@@ -98,32 +151,38 @@ void GrindLogger::start_grind_session(const GrindSessionDescriptor& descriptor,
     current_session->grind_mode = static_cast<uint8_t>(descriptor.mode);
     current_session->target_time_ms = descriptor.target_time_ms;
     current_session->start_weight = start_weight;
-    current_session->max_pulse_attempts = GRIND_MAX_PULSE_ATTEMPTS;
     current_session->time_error_ms = 0;
     current_session->total_time_ms = 0;
     current_session->total_motor_on_time_ms = 0;
     current_session->termination_reason = static_cast<uint8_t>(GrindTerminationReason::UNKNOWN);
 
-    initialize_session_config();
+    initialize_session_config(recording);
+    current_session->max_pulse_attempts = descriptor.max_pulse_attempts;
+    current_session->flow_detection_window_steps = (uint8_t)(descriptor.flow_detection_window_ms / GRIND_ADAPTIVE_WINDOW_STEP_MS);
+    current_session->flow_prediction_window_steps = (uint8_t)(descriptor.flow_prediction_window_ms / GRIND_ADAPTIVE_WINDOW_STEP_MS);
+    current_session->grinder_channel = descriptor.grinder_channel;
 
-    logging_active = true;
-    session_start_time = millis();
+    recording.logging_active = true;
+    recording.session_start_time = millis();
+    recording.session_start_us = descriptor.start_us;
 
     // Initialize motor time tracking
-    last_motor_state = false;
-    motor_start_time = 0;
-    total_motor_time_ms = 0;
+    recording.last_motor_state = false;
+    recording.motor_start_time = 0;
+    recording.total_motor_time_ms = 0;
 
     const char* mode_name = (descriptor.mode == GrindMode::TIME) ? "TIME" : "WEIGHT";
     if (descriptor.mode == GrindMode::TIME) {
-        LOG_BLE("Started time-series session %lu: mode=%s, target_time=%lums, profile=%d\n",
+        LOG_BLE("Started time-series session %lu: grinder %u, mode=%s, target_time=%lums, profile=%d\n",
                 current_session->session_id,
+                (unsigned)descriptor.grinder_channel + 1,
                 mode_name,
                 static_cast<unsigned long>(descriptor.target_time_ms),
                 descriptor.profile_id);
     } else {
-        LOG_BLE("Started time-series session %lu: mode=%s, target=%.1fg, profile=%d\n",
+        LOG_BLE("Started time-series session %lu: grinder %u, mode=%s, target=%.1fg, profile=%d\n",
                 current_session->session_id,
+                (unsigned)descriptor.grinder_channel + 1,
                 mode_name,
                 descriptor.target_weight,
                 descriptor.profile_id);
@@ -131,23 +190,33 @@ void GrindLogger::start_grind_session(const GrindSessionDescriptor& descriptor,
 }
 
 
-void GrindLogger::end_grind_session(const char* final_result, float final_weight, uint8_t pulse_count) {
-    if (!current_session || !logging_active) {
+void GrindLogger::end_grind_session(uint8_t grinder_channel, const char* final_result, float final_weight, uint8_t pulse_count) {
+    Recording& recording = recording_for(grinder_channel);
+    GrindSession* current_session = recording.session;
+    if (!current_session || !recording.logging_active) {
         return;
     }
+    // Stop Core 0 from filling the stream before its partial block is written out
+    recording.logging_active = false;
 
     current_session->final_weight = final_weight;
     current_session->error_grams = current_session->target_weight - final_weight;
-    current_session->total_time_ms = millis() - session_start_time;
+    current_session->total_time_ms = millis() - recording.session_start_time;
     current_session->pulse_count = pulse_count;
     strncpy(current_session->result_status, final_result, sizeof(current_session->result_status) - 1);
+    current_session->events_dropped = recording.event_buffer.dropped();
+    current_session->measurements_dropped = recording.measurements_dropped;
+    if (recording.event_buffer.dropped() > 0 || recording.measurements_dropped > 0) {
+        LOG_BLE("WARNING: Session %lu dropped %u events and %u measurements\n", (unsigned long)current_session->session_id,
+                (unsigned)recording.event_buffer.dropped(), (unsigned)recording.measurements_dropped);
+    }
 
     // Finalize motor time tracking - if motor is still on, count the final period
     uint32_t now = millis();
-    if (last_motor_state && motor_start_time > 0) {
-        total_motor_time_ms += (now - motor_start_time);
+    if (recording.last_motor_state && recording.motor_start_time > 0) {
+        recording.total_motor_time_ms += (now - recording.motor_start_time);
     }
-    current_session->total_motor_on_time_ms = total_motor_time_ms;
+    current_session->total_motor_on_time_ms = recording.total_motor_time_ms;
 
     GrindMode mode = static_cast<GrindMode>(current_session->grind_mode);
     if (mode == GrindMode::TIME) {
@@ -172,25 +241,23 @@ void GrindLogger::end_grind_session(const char* final_result, float final_weight
 
     if (is_successful_grind) {
         bool is_weight_mode = (mode == GrindMode::WEIGHT);
-        statistics_manager.update_grind_session(
+        channel_statistics(grinder_channel).update_grind_session(
             final_weight,
             current_session->error_grams,
             pulse_count,
             is_weight_mode,
-            current_session->total_motor_on_time_ms
+            current_session->total_motor_on_time_ms,
+            current_session->profile_id
         );
     }
 
     // Check if logging is enabled before saving to flash
-    Preferences logging_prefs;
-    logging_prefs.begin("logging", true); // read-only
-    bool logging_enabled = logging_prefs.getBool("enabled", false);
-    logging_prefs.end();
+    bool logging_enabled = config_store.get_flag(ConfigFlag::LOGGING);
 
     const char* mode_name = (mode == GrindMode::TIME) ? "TIME" : "WEIGHT";
 
     if (!is_cancelled && logging_enabled) {
-        flush_session_to_flash();
+        flush_session_to_flash(recording);
         if (mode == GrindMode::TIME) {
             LOG_BLE("Ended session %lu: mode=%s, final=%.1fg, time_error=%+ldms, %s (saved)\n",
                     current_session->session_id,
@@ -207,6 +274,7 @@ void GrindLogger::end_grind_session(const char* final_result, float final_weight
                     final_result);
         }
     } else if (!is_cancelled && !logging_enabled) {
+        recording.measurement_stream.abort();
         if (mode == GrindMode::TIME) {
             LOG_BLE("Ended session %lu: mode=%s, final=%.1fg, time_error=%+ldms, %s (not saved - logging disabled)\n",
                     current_session->session_id,
@@ -223,6 +291,7 @@ void GrindLogger::end_grind_session(const char* final_result, float final_weight
                     final_result);
         }
     } else {
+        recording.measurement_stream.abort();
         if (mode == GrindMode::TIME) {
             LOG_BLE("Ended session %lu: mode=%s, final=%.1fg, time_error=%+ldms, %s (not saved - cancelled)\n",
                     current_session->session_id,
@@ -241,85 +310,193 @@ void GrindLogger::end_grind_session(const char* final_result, float final_weight
     }
 
     // Clear buffers to ensure clean state for next session
-    clear_buffers();
-
-    logging_active = false;
+    prepare_next_session(recording);
 }
 
-void GrindLogger::discard_current_session() {
-    if (!current_session || !logging_active) return;
+void GrindLogger::discard_current_session(uint8_t grinder_channel) {
+    Recording& recording = recording_for(grinder_channel);
+    if (!recording.session || !recording.logging_active) return;
     
     LOG_BLE("Discarded session %lu: target=%.1fg (not saved - cancelled)\n",
-                  current_session->session_id, current_session->target_weight);
-    
-    // Clear buffers to ensure clean state for next session
-    clear_buffers();
+                  recording.session->session_id, recording.session->target_weight);
     
-    logging_active = false;
+    // Clear buffers to ensure clean state for next session; FileIOTask deletes the partial file
+    recording.logging_active = false;
+    prepare_next_session(recording);
 }
 
-void GrindLogger::log_event(GrindEvent& event) {
-    if (!logging_active || event_count >= EVENT_TEMP_BUFFER_SIZE) {
+void GrindLogger::log_event(uint8_t grinder_channel, GrindEvent& event) {
+    Recording& recording = recording_for(grinder_channel);
+    if (!recording.logging_active) {
         return;
     }
-    // **FIX**: Assign a unique, sequential ID to the event before logging
-    if (current_session) {
-        GrindMode mode = static_cast<GrindMode>(current_session->grind_mode);
+    // Assign a unique, sequential ID to the event before logging
+    if (recording.session) {
+        GrindMode mode = static_cast<GrindMode>(recording.session->grind_mode);
         if (mode == GrindMode::TIME) {
             event.event_flags |= GRIND_EVENT_FLAG_TIME_MODE;
         }
     }
-    event.event_sequence_id = event_sequence_counter++;
-    event_buffer[event_count++] = event;
+    event.event_sequence_id = recording.event_sequence_counter++;
+    recording.event_buffer.push(event);     // A dropped event is counted in events_dropped
 }
 
-void GrindLogger::log_continuous_measurement(uint32_t timestamp_ms, float weight_grams, float weight_delta, 
-                                            float flow_rate_g_per_s, uint8_t motor_is_on, uint8_t phase_id, 
-                                            float motor_stop_target_weight) {
-    if (!logging_active || measurement_count >= MEASUREMENT_TEMP_BUFFER_SIZE) {
+void GrindLogger::log_continuous_measurement(uint8_t grinder_channel, uint32_t timestamp_ms, uint32_t sample_timestamp_us,
+                                            float weight_grams, float weight_delta, float flow_rate_g_per_s,
+                                            uint8_t motor_is_on, uint8_t phase_id, float motor_stop_target_weight,
+                                            bool full_rate) {
+    Recording& recording = recording_for(grinder_channel);
+    if (!recording.logging_active) {
         return;
     }
     
     // Pure data recording - no calculations (all values pre-calculated by GrindController)
     GrindMeasurement measurement;
     measurement.timestamp_ms = timestamp_ms;
+    measurement.sample_timestamp_us = sample_timestamp_us;
     measurement.weight_grams = weight_grams;
     measurement.weight_delta = weight_delta;
     measurement.flow_rate_g_per_s = flow_rate_g_per_s;
     measurement.motor_stop_target_weight = motor_stop_target_weight;
-    measurement.sequence_id = measurement_sequence_counter++;
     measurement.motor_is_on = motor_is_on;
     measurement.phase_id = phase_id;
     
     // Track motor time changes for session summary
     bool current_motor_state = (motor_is_on == 1);
-    if (current_motor_state && !last_motor_state) {
+    if (current_motor_state && !recording.last_motor_state) {
         // Motor just turned ON
-        motor_start_time = millis();
-    } else if (!current_motor_state && last_motor_state && motor_start_time > 0) {
+        recording.motor_start_time = millis();
+    } else if (!current_motor_state && recording.last_motor_state && recording.motor_start_time > 0) {
         // Motor just turned OFF, accumulate the time
-        total_motor_time_ms += (millis() - motor_start_time);
+        recording.total_motor_time_ms += (millis() - recording.motor_start_time);
     }
-    last_motor_state = current_motor_state;
+    recording.last_motor_state = current_motor_state;
     
-    measurement_buffer[measurement_count++] = measurement;
+    // A full-rate loop keeps the SYS_LOG_PRE_TRIGGER_LOOPS records still in the delay line
+    // and the SYS_LOG_TRIGGER_HOLD_LOOPS after it; the oldest record leaves once the line is full
+    if (full_rate) {
+        recording.last_trigger_loop = recording.measurement_history.pushed();
+        recording.trigger_seen = true;
+    }
+    recording.measurement_history.push(measurement);
+    if (recording.measurement_history.size() > SYS_LOG_PRE_TRIGGER_LOOPS) {
+        release_measurement(recording, SYS_LOG_PRE_TRIGGER_LOOPS, false);
+    }
 }
 
-bool GrindLogger::flush_session_to_flash() {
-    if (!current_session || !event_buffer || !measurement_buffer) {
-        return false;
+void GrindLogger::flush_measurement_history(uint8_t grinder_channel) {
+    Recording& recording = recording_for(grinder_channel);
+    uint32_t waiting = min(recording.measurement_history.size(), (uint32_t)SYS_LOG_PRE_TRIGGER_LOOPS);
+    for (uint32_t offset = waiting; offset > 0; offset--) {
+        release_measurement(recording, offset - 1, offset == 1);
     }
-    
-    // Use new individual session file approach
-    if (!ensure_sessions_directory_exists()) {
+    recording.measurement_history.clear();
+}
+
+void GrindLogger::release_measurement(Recording& recording, uint32_t newest_offset, bool session_end) {
+    const GrindMeasurement& record = recording.measurement_history.newest(newest_offset);
+    const uint32_t loop = recording.measurement_history.pushed() - 1 - newest_offset;
+    recording.pending_weight_delta += record.weight_delta;
+
+    // Only the newest trigger matters: an older one's hold window ends before this one's
+    bool keep = loop == 0 || session_end ||
+                loop - recording.last_kept_loop >= SYS_LOG_EVERY_N_GRIND_LOOPS ||
+                (recording.trigger_seen && loop <= recording.last_trigger_loop + SYS_LOG_TRIGGER_HOLD_LOOPS);
+    if (!keep) {
+        return;
+    }
+    if (recording.measurement_sequence_counter >= GRIND_LOG_MAX_MEASUREMENTS) {
+        if (recording.measurements_dropped < UINT16_MAX) {
+            recording.measurements_dropped++;
+        }
+        return;
+    }
+
+    GrindMeasurement measurement = record;
+    measurement.weight_delta = recording.pending_weight_delta;
+    measurement.sequence_id = recording.measurement_sequence_counter;
+    // Sequence ids stay gapless: a record dropped while every staging chunk waits for the file task does not use one
+    if (recording.measurement_stream.push(measurement)) {
+        recording.session_preview.add(measurement.timestamp_ms, measurement.weight_grams);
+        recording.measurement_sequence_counter++;
+        recording.last_kept_loop = loop;
+        recording.pending_weight_delta = 0.0f;
+    } else if (recording.measurements_dropped < UINT16_MAX) {
+        recording.measurements_dropped++;
+    }
+}
+
+void GrindLogger::service_session_stream() {
+    for (Recording& recording : recordings) {
+        if (recording.logging_active && recording.session &&
+            recording.streamed_session_id != recording.session->session_id) {
+            open_session_stream(recording);
+        } else if (!recording.logging_active && recording.measurement_stream.is_open()) {
+            // Discarded while streaming (ended sessions are closed by end_grind_session)
+            recording.measurement_stream.abort();
+            recording.adc_capture.cancel();
+        }
+        recording.measurement_stream.append_ready_blocks();
+        recording.adc_capture.service(&recording.measurement_stream);
+    }
+}
+
+bool GrindLogger::open_session_stream(Recording& recording) {
+    const GrindSession* current_session = recording.session;
+    recording.streamed_session_id = current_session->session_id; // One attempt per session
+
+    if (!config_store.get_flag(ConfigFlag::LOGGING)) {
+        return false; // Full blocks are released unwritten
+    }
+
+    if (!log_partition.is_active() && !ensure_sessions_directory_exists()) {
         LOG_BLE("ERROR: Failed to create sessions directory\n");
         return false;
     }
+    if (!recording.measurement_stream.open(*current_session)) {
+        return false;
+    }
+    if (is_adc_capture_enabled() && recording.adc_capture.begin(recording.session_start_us)) {
+        LOG_BLE("ADC capture enabled for session %lu\n", current_session->session_id);
+    }
+    return true;
+}
+
+void GrindLogger::set_adc_capture_sources(uint8_t grinder_channel, const SampleSequenceSource* samples,
+                                          const MotorEdgeTimeline* edges) {
+    recording_for(grinder_channel).adc_capture.set_sources(samples, edges);
+}
+
+void GrindLogger::set_adc_capture_enabled(bool enabled) {
+    config_store.set_flag(ConfigFlag::ADC_CAPTURE, enabled);
+    LOG_BLE("ADC capture %s (from the next session)\n", enabled ? "enabled" : "disabled");
+}
+
+bool GrindLogger::is_adc_capture_enabled() const {
+    return config_store.get_flag(ConfigFlag::ADC_CAPTURE);
+}
+
+bool GrindLogger::flush_session_to_flash(Recording& recording) {
+    const GrindSession* current_session = recording.session;
+    const SessionEventBuffer& event_buffer = recording.event_buffer;
+    if (!current_session || !event_buffer.is_allocated()) {
+        return false;
+    }
     
-    // Write individual session file
-    bool success = write_individual_session_file(current_session->session_id, *current_session, event_buffer, measurement_buffer);
+    // A session shorter than one FileIOTask cycle ends before service_session_stream() opened it
+    if (recording.streamed_session_id != current_session->session_id) {
+        open_session_stream(recording);
+    }
     
-    if (success) {
+    // Append the last blocks and the events, then finalize the header
+    recording.adc_capture.finish(&recording.measurement_stream);
+    bool success = recording.measurement_stream.finish(*current_session, event_buffer.data(), event_buffer.size());
+    
+    if (success && log_partition.is_active()) {
+        LOG_BLE("Session %lu flushed to session log\n", current_session->session_id);
+    } else if (success) {
+        session_index.add_session_file(current_session->session_id);
+
         // Clean up old session files to maintain the limit
         cleanup_old_session_files();
         
@@ -328,130 +505,121 @@ bool GrindLogger::flush_session_to_flash() {
         LOG_BLE("ERROR: Failed to flush session %lu to file\n", current_session->session_id);
     }
     
+    if (success) {
+        SessionSummary summary;
+        SessionSummaryTable::summarize(*current_session, event_buffer.data(), event_buffer.size(), &summary);
+        recording.session_preview.finish(&summary);
+        session_summaries.append(summary);
+        session_rollups.add_session(summary, current_session->final_weight);
+    }
+    
     return success;
 }
 
 uint32_t GrindLogger::count_sessions_in_flash() const {
-    uint32_t count = 0;
-    
-    // Count individual session files (new approach)
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File file = dir.openNextFile();
-            
-            while (file) {
-                String filename = file.name();
-                // Handle both base names and full paths
-                bool is_session_file = (filename.startsWith("session_") || filename.indexOf("/session_") != -1)
-                                       && filename.endsWith(".bin");
-                if (is_session_file) {
-                    count++;
-                }
-                file = dir.openNextFile();
-            }
-            
-            dir.close();
-        }
-    }
-    
-    return count;
+    return log_partition.is_active() ? log_partition.get_session_count() : session_index.get_session_count();
 }
 
 uint32_t GrindLogger::count_total_events_in_flash() const {
-    uint32_t total_events = 0;
-    
-    // Count events from individual session files
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File file = dir.openNextFile();
-            
-            while (file) {
-                String filename = file.name();
-                bool is_session_file = (filename.startsWith("session_") || filename.indexOf("/session_") != -1)
-                                       && filename.endsWith(".bin");
-                if (is_session_file) {
-                    String full_path = filename.startsWith("/") ? filename : (String(GRIND_SESSIONS_DIR) + "/" + filename);
-                    File sessionFile = LittleFS.open(full_path.c_str(), "r");
-                    if (sessionFile) {
-                        TimeSeriesSessionHeader header;
-                        if (sessionFile.read((uint8_t*)&header, sizeof(header)) == sizeof(header)) {
-                            total_events += header.event_count;
-                        }
-                        sessionFile.close();
-                    }
-                }
-                file = dir.openNextFile();
-            }
-            
-            dir.close();
-        }
+    uint32_t total_events, total_measurements;
+    if (log_partition.is_active()) {
+        log_partition.get_totals(&total_events, &total_measurements);
+    } else {
+        session_index.get_totals(&total_events, &total_measurements);
     }
-    
     return total_events;
 }
 
 uint32_t GrindLogger::count_total_measurements_in_flash() const {
-    uint32_t total_measurements = 0;
-    
-    // Count measurements from individual session files
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File file = dir.openNextFile();
-            
-            while (file) {
-                String filename = file.name();
-                bool is_session_file = (filename.startsWith("session_") || filename.indexOf("/session_") != -1)
-                                       && filename.endsWith(".bin");
-                if (is_session_file) {
-                    String full_path = filename.startsWith("/") ? filename : (String(GRIND_SESSIONS_DIR) + "/" + filename);
-                    File sessionFile = LittleFS.open(full_path.c_str(), "r");
-                    if (sessionFile) {
-                        TimeSeriesSessionHeader header;
-                        if (sessionFile.read((uint8_t*)&header, sizeof(header)) == sizeof(header)) {
-                            total_measurements += header.measurement_count;
-                        }
-                        sessionFile.close();
-                    }
-                }
-                file = dir.openNextFile();
-            }
-            
-            dir.close();
-        }
+    uint32_t total_events, total_measurements;
+    if (log_partition.is_active()) {
+        log_partition.get_totals(&total_events, &total_measurements);
+    } else {
+        session_index.get_totals(&total_events, &total_measurements);
     }
-    
     return total_measurements;
 }
 
+uint32_t GrindLogger::get_session_ids(uint32_t* session_ids, uint32_t max_sessions) const {
+    if (log_partition.is_active()) {
+        return log_partition.get_session_ids(session_ids, max_sessions);
+    }
+    return session_index.get_session_ids(session_ids, max_sessions);
+}
+
+uint32_t GrindLogger::get_session_entries(SessionIndexEntry* entries, uint32_t max_entries) const {
+    if (log_partition.is_active()) {
+        return log_partition.get_entries(entries, max_entries);
+    }
+    return session_index.get_entries(entries, max_entries);
+}
+
+bool GrindLogger::open_session(uint32_t session_id, SessionReader* reader) const {
+    if (log_partition.is_active()) {
+        return reader->open(&log_partition, session_id);
+    }
+    char filename[64];
+    snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, (unsigned long)session_id);
+    return reader->open(filename);
+}
+
 void GrindLogger::send_current_session_via_serial() {
-    if (!current_session || !logging_active) {
+    if (!is_logging_active()) {
         LOG_BLE("No active session to display\n");
         return;
     }
     
-    LOG_BLE("\n=== Current Grind Session %lu ===\n", current_session->session_id);
-    LOG_BLE("Target: %.1fg, Profile: %d\n", current_session->target_weight, current_session->profile_id);
-    LOG_BLE("Events: %u/%d, Measurements: %u/%d\n", event_count, (int)EVENT_TEMP_BUFFER_SIZE, measurement_count, (int)MEASUREMENT_TEMP_BUFFER_SIZE);
-    LOG_BLE("=====================================\n");
+    for (const Recording& recording : recordings) {
+        const GrindSession* current_session = recording.session;
+        if (!current_session || !recording.logging_active) {
+            continue;
+        }
+        LOG_BLE("\n=== Current Grind Session %lu (grinder %u) ===\n", current_session->session_id,
+                (unsigned)current_session->grinder_channel + 1);
+        LOG_BLE("Target: %.1fg, Profile: %d\n", current_session->target_weight, current_session->profile_id);
+        LOG_BLE("Events: %u (capacity %u, %u dropped), Measurements: %u (%u on flash, %u dropped)\n",
+                (unsigned)recording.event_buffer.size(), (unsigned)recording.event_buffer.capacity(),
+                (unsigned)recording.event_buffer.dropped(), (unsigned)recording.measurement_sequence_counter,
+                (unsigned)recording.measurement_stream.get_measurement_count(), (unsigned)recording.measurements_dropped);
+        LOG_BLE("=====================================\n");
+    }
+}
+
+bool GrindLogger::is_logging_active() const {
+    for (const Recording& recording : recordings) {
+        if (recording.logging_active) {
+            return true;
+        }
+    }
+    return false;
 }
 
 uint32_t GrindLogger::get_total_flash_sessions() const {
     return count_sessions_in_flash();
 }
 
-void GrindLogger::clear_buffers() {
-    event_count = 0;
-    measurement_count = 0;
-    event_sequence_counter = 0;
-    measurement_sequence_counter = 0;
-    if (event_buffer) memset(event_buffer, 0, sizeof(GrindEvent) * EVENT_TEMP_BUFFER_SIZE);
-    if (measurement_buffer) memset(measurement_buffer, 0, sizeof(GrindMeasurement) * MEASUREMENT_TEMP_BUFFER_SIZE);
+void GrindLogger::clear_buffers(Recording& recording) {
+    recording.event_sequence_counter = 0;
+    recording.measurement_sequence_counter = 0;
+    recording.measurements_dropped = 0;
+    recording.event_buffer.reset();
+    recording.measurement_stream.reset();
+    recording.measurement_history.clear();
+    recording.session_preview.reset();
+    recording.last_trigger_loop = 0;
+    recording.trigger_seen = false;
+    recording.last_kept_loop = 0;
+    recording.pending_weight_delta = 0.0f;
 }
 
-void GrindLogger::initialize_session_config() {
+void GrindLogger::prepare_next_session(Recording& recording) {
+    clear_buffers(recording);
+    _preferences->putUInt("next_session_id", _next_session_id);
+    recording.session_prepared = true;
+}
+
+void GrindLogger::initialize_session_config(Recording& recording) {
+    GrindSession* current_session = recording.session;
     if (!current_session) return;
     current_session->initial_motor_stop_offset = GRIND_UNDERSHOOT_TARGET_G;
     current_session->max_pulse_attempts = GRIND_MAX_PULSE_ATTEMPTS;
@@ -461,7 +629,8 @@ void GrindLogger::initialize_session_config() {
 }
 
 
-bool GrindLogger::write_time_series_session_to_flash(const GrindSession& session, const GrindEvent* events, const GrindMeasurement* measurements) {
+bool GrindLogger::write_time_series_session_to_flash(const GrindSession& session, const GrindEvent* events, uint16_t event_count,
+                                                     const GrindMeasurement* measurements, uint16_t measurement_count) {
     File file = LittleFS.open(GRIND_LOG_FILE, "a");
     if (!file) {
         LOG_BLE("Failed to open log file for writing\n");
@@ -472,11 +641,13 @@ bool GrindLogger::write_time_series_session_to_flash(const GrindSession& session
     header.session_id = session.session_id;
     header.session_timestamp = session.session_timestamp;
     header.session_size = sizeof(GrindSession) + (sizeof(GrindEvent) * event_count) + (sizeof(GrindMeasurement) * measurement_count);
-    header.checksum = calculate_checksum((const uint8_t*)&session, header.session_size);
+    header.checksum = session_checksum_update(0, events, sizeof(GrindEvent) * event_count);
+    header.checksum = session_checksum_update(header.checksum, measurements, sizeof(GrindMeasurement) * measurement_count);
+    header.checksum = session_checksum_update(header.checksum, &session, sizeof(GrindSession));
     header.event_count = event_count;
     header.measurement_count = measurement_count;
-    header.schema_version = GRIND_LOG_SCHEMA_VERSION;
-    header.reserved = 0;
+    header.schema_version = GRIND_LOG_SCHEMA_SAMPLE_TIME_US;   // Raw records, not encoded blocks
+    header.flags = SESSION_FILE_FLAG_CHECKSUM;
 
     size_t written = 0;
     written += file.write((uint8_t*)&header, sizeof(TimeSeriesSessionHeader));
@@ -513,193 +684,163 @@ static void write_uint16_le(uint8_t*& buffer, uint16_t value) {
 }
 
 
+// Export position: everything export_sessions_binary_chunk() needs to resume with the next chunk
+struct GrindLogger::ExportCursor {
+    uint32_t* session_list = nullptr;       // Session ids, oldest first
+    uint32_t session_count = 0;
+    uint32_t session_idx = 0;
+    SessionReader reader;                   // Session being sent, opened lazily
+    uint16_t event_count = 0;               // Sent for this session (0 when its checksum failed)
+    uint16_t measurement_count = 0;
+    uint16_t event_idx = 0;
+    uint16_t measurement_idx = 0;
+    bool session_header_sent = false;
+
+    ~ExportCursor() {
+        if (session_list) {
+            heap_caps_free(session_list);
+        }
+    }
+};
+
+void GrindLogger::end_export() {
+    if (export_cursor) {
+        delete export_cursor;
+        export_cursor = nullptr;
+        LOG_DEBUG_PRINTLN("Export cursor released");
+    }
+}
+
 void GrindLogger::export_sessions_binary_chunk(uint8_t* buffer, size_t buffer_size,  
                                                uint32_t start_pos, uint32_t* next_pos, size_t* actual_size) {
-    static File export_file;
-    static uint32_t total_sessions = 0;
-    static uint32_t session_idx = 0;
-    static uint32_t current_session_id = 0;
-    static uint32_t* session_list = nullptr;
-    static bool initialized = false;
-    static uint32_t event_idx = 0;
-    static uint32_t measurement_idx = 0;
-    static TimeSeriesSessionHeader current_header;
-    static GrindSession current_session_data;
-    static bool session_header_sent = false;
-
     // Handle explicit cleanup call (buffer == nullptr or buffer_size == 0)
     if (buffer == nullptr || buffer_size == 0) {
-        if (export_file) {
-            export_file.close();
-            LOG_DEBUG_PRINTLN("Forced closure of export file handle");
-        }
-        if (session_list) {
-            heap_caps_free(session_list);
-            session_list = nullptr;
-        }
-        initialized = false;
+        end_export();
         *actual_size = 0;
         *next_pos = 0;
         return;
     }
 
-    // Initialize session list on first call
-    if (start_pos == 0 || !initialized) {
-        if (export_file) export_file.close();
-        if (session_list) {
-            heap_caps_free(session_list);
-            session_list = nullptr;
-        }
-        
-        total_sessions = count_sessions_in_flash();
-        session_idx = 0;
-        current_session_id = 0;
-        event_idx = 0;
-        measurement_idx = 0;
-        session_header_sent = false;
-        initialized = false;
+    // Start over on the first chunk
+    if (start_pos == 0 || !export_cursor) {
+        end_export();
+        export_cursor = new ExportCursor();
+        ExportCursor& cursor = *export_cursor;
         
+        uint32_t total_sessions = count_sessions_in_flash();
         if (total_sessions > 0) {
             // Create list of available session IDs
-            session_list = (uint32_t*)heap_caps_malloc(total_sessions * sizeof(uint32_t), MALLOC_CAP_8BIT);
-            if (!session_list) {
+            cursor.session_list = (uint32_t*)heap_caps_malloc(total_sessions * sizeof(uint32_t), MALLOC_CAP_8BIT);
+            if (!cursor.session_list) {
                 LOG_BLE("ERROR: Failed to allocate session list memory\n");
+                end_export();
                 *actual_size = 0;
                 *next_pos = 0;
                 return;
             }
             
-            // Collect valid session IDs from directory
-            uint32_t list_count = 0;
-            
-            // Try individual session files first (new approach)
-            if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-                File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-                if (dir && dir.isDirectory()) {
-                    File file = dir.openNextFile();
-                    while (file && list_count < total_sessions) {
-                        String filename = file.name();
-                        if (filename.startsWith("session_") && filename.endsWith(".bin")) {
-                            // Extract session ID from filename
-                            int start_pos = filename.indexOf('_') + 1;
-                            int end_pos = filename.lastIndexOf('.');
-                            if (start_pos > 0 && end_pos > start_pos) {
-                                uint32_t session_id = filename.substring(start_pos, end_pos).toInt();
-                                if (session_id > 0 && validate_session_file(session_id)) {
-                                    session_list[list_count++] = session_id;
-                                }
-                            }
-                        }
-                        file = dir.openNextFile();
-                    }
-                    dir.close();
-                }
-            }
-            
-            // Sort session IDs for consistent order
-            for (uint32_t i = 0; i < list_count - 1; i++) {
-                for (uint32_t j = i + 1; j < list_count; j++) {
-                    if (session_list[i] > session_list[j]) {
-                        uint32_t temp = session_list[i];
-                        session_list[i] = session_list[j];
-                        session_list[j] = temp;
-                    }
-                }
-            }
-            
-            total_sessions = list_count;
-            LOG_BLE("Export: Found %lu valid session files\n", total_sessions);
+            // Indexed sessions are finalized and already sorted oldest first
+            cursor.session_count = get_session_ids(cursor.session_list, total_sessions);
+            LOG_BLE("Export: Found %lu valid session files\n", cursor.session_count);
         }
         
-        initialized = true;
         print_session_data_table();
         LOG_GRIND_DEBUG("Starting export for Python data analysis\n");
         print_struct_layout_debug();  // Print struct layout at start of export
     }
+    ExportCursor& cursor = *export_cursor;
 
-    if (session_idx >= total_sessions) {
-        if(export_file) export_file.close();
+    if (cursor.session_idx >= cursor.session_count) {
+        end_export();
         *actual_size = 0;
         *next_pos = 0; // Signal completion
         return;
     }
     
-    // Open current session file if not already open
-    if (!export_file && session_idx < total_sessions) {
-        current_session_id = session_list[session_idx];
-        char filename[64];
-        snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, current_session_id);
-        export_file = LittleFS.open(filename, "r");
-        if (!export_file) {
-            LOG_BLE("ERROR: Failed to open session file: %s\n", filename);
-            session_idx++; // Skip this session
-            *actual_size = 0;
-            *next_pos = start_pos + 1;
-            return;
-        }
-        LOG_BLE("Export: Opened session file %lu\n", current_session_id);
-    }
-    
     uint8_t* p = buffer;
     size_t remaining_size = buffer_size;
     
     if (start_pos == 0) {
-        write_uint32_le(p, total_sessions);
+        write_uint32_le(p, cursor.session_count);
         remaining_size -= 4;
     }
     
-    while (remaining_size > 0 && session_idx < total_sessions) {
-        if (!session_header_sent) {
-            if (export_file.read((uint8_t*)&current_header, sizeof(current_header)) != sizeof(current_header) ||
-                export_file.read((uint8_t*)&current_session_data, sizeof(current_session_data)) != sizeof(current_session_data)) {
-                break; // Error reading file
+    while (remaining_size > 0 && cursor.session_idx < cursor.session_count) {
+        SessionReader& reader = cursor.reader;
+        if (!reader.is_open()) {
+            uint32_t session_id = cursor.session_list[cursor.session_idx];
+            if (!open_session(session_id, &reader)) {
+                LOG_BLE("ERROR: Failed to open session %lu\n", session_id);
+                cursor.session_idx++; // Skip this session
+                continue;
+            }
+            LOG_BLE("Export: Opened session file %lu\n", session_id);
+        }
+
+        if (!cursor.session_header_sent) {
+            GrindSession session_data = reader.session();
+            cursor.event_count = reader.header().event_count;
+            cursor.measurement_count = reader.header().measurement_count;
+            cursor.event_idx = 0;
+            cursor.measurement_idx = 0;
+
+            // A damaged session goes out as its summary only, marked so the tools can tell
+            if (!reader.verify_checksum()) {
+                LOG_BLE("ERROR: Session %lu failed its checksum, exporting without events or measurements\n",
+                        (unsigned long)reader.header().session_id);
+                cursor.event_count = 0;
+                cursor.measurement_count = 0;
+                strncpy(session_data.result_status, "CORRUPT", sizeof(session_data.result_status) - 1);
             }
-            event_idx = 0;
-            measurement_idx = 0;
 
             // Send full GrindSession struct + event/measurement counts from header
             const size_t session_data_size = sizeof(GrindSession) + 4; // +4 for event/measurement counts
             if (remaining_size < session_data_size) break;
 
             // First send the full GrindSession struct
-            memcpy(p, &current_session_data, sizeof(GrindSession));
+            memcpy(p, &session_data, sizeof(GrindSession));
             p += sizeof(GrindSession);
             
             // Then append event_count and measurement_count from header
-            write_uint16_le(p, current_header.event_count);
-            write_uint16_le(p, current_header.measurement_count);
+            write_uint16_le(p, cursor.event_count);
+            write_uint16_le(p, cursor.measurement_count);
             
             remaining_size -= session_data_size;
-            session_header_sent = true;
+            cursor.session_header_sent = true;
         }
 
         // Write events
-        while(event_idx < current_header.event_count && remaining_size >= sizeof(GrindEvent)) {
-            export_file.read(p, sizeof(GrindEvent));
+        while (cursor.event_idx < cursor.event_count && remaining_size >= sizeof(GrindEvent)) {
+            GrindEvent event;
+            if (!reader.read_event(cursor.event_idx, &event)) {
+                event = GrindEvent(); // Keep the announced count; the tools see an empty event
+            }
+            memcpy(p, &event, sizeof(GrindEvent));
             p += sizeof(GrindEvent);
             remaining_size -= sizeof(GrindEvent);
-            event_idx++;
+            cursor.event_idx++;
         }
 
-        // Write measurements
-        while(measurement_idx < current_header.measurement_count && remaining_size >= sizeof(GrindMeasurement)) {
-            export_file.read(p, sizeof(GrindMeasurement));
+        // Write measurements once the events are out - decoded (v4) or zero-extended (older schemas) to the current layout
+        while (cursor.event_idx >= cursor.event_count && cursor.measurement_idx < cursor.measurement_count &&
+               remaining_size >= sizeof(GrindMeasurement)) {
+            GrindMeasurement measurement;
+            if (!reader.read_measurement(cursor.measurement_idx, &measurement)) {
+                cursor.measurement_idx = cursor.measurement_count; // Damaged block: drop the rest of this session
+                break;
+            }
+            memcpy(p, &measurement, sizeof(GrindMeasurement));
             p += sizeof(GrindMeasurement);
             remaining_size -= sizeof(GrindMeasurement);
-            measurement_idx++;
+            cursor.measurement_idx++;
         }
 
         // If session is fully sent, move to the next one
-        if (event_idx >= current_header.event_count && measurement_idx >= current_header.measurement_count) {
-            session_idx++;
-            session_header_sent = false;
-            event_idx = 0;
-            measurement_idx = 0;
-            // Close current session file
-            if (export_file) {
-                export_file.close();
-                LOG_BLE("Export: Completed session %lu\n", current_session_id);
-            }
+        if (cursor.event_idx >= cursor.event_count && cursor.measurement_idx >= cursor.measurement_count) {
+            LOG_BLE("Export: Completed session %lu\n", (unsigned long)reader.header().session_id);
+            reader.close();
+            cursor.session_idx++;
+            cursor.session_header_sent = false;
         } else {
             // Buffer is full, break to send chunk
             break;
@@ -707,81 +848,63 @@ void GrindLogger::export_sessions_binary_chunk(uint8_t* buffer, size_t buffer_si
     }
 
     *actual_size = p - buffer;
-    *next_pos = (session_idx >= total_sessions) ? 0 : start_pos + 1;
+    if (cursor.session_idx >= cursor.session_count) {
+        end_export();
+        *next_pos = 0;
+    } else {
+        *next_pos = start_pos + 1;
+    }
 }
 
 
 #if ENABLE_GRIND_DEBUG
 void GrindLogger::print_session_data_table() {
-    // Check individual session files first (new approach)
     uint32_t session_count = count_sessions_in_flash();
     if (session_count == 0) {
         LOG_BLE("No session data to display\n");
         return;
     }
     
+    const uint32_t MAX_DISPLAY = 10; // Limit display for readability
+    ArenaScope scope(file_arena);
+    SessionIndexEntry* entries = scope.allocate_array<SessionIndexEntry>(session_count);
+    if (!entries) {
+        LOG_BLE("ERROR: Failed to allocate session table memory\n");
+        return;
+    }
+    session_count = get_session_entries(entries, session_count);
+    
     LOG_BLE("\n=== SESSION DATA TABLE ===\n");
     LOG_BLE("ID | Target  | Final   | Error  | Time | Events | Measurements\n");
     LOG_BLE("---|---------|---------|--------|------|--------|--------------\n");
     
-    // Display data from individual session files
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File file = dir.openNextFile();
-            int displayed = 0;
-            const int MAX_DISPLAY = 10; // Limit display for readability
-            
-            while (file && displayed < MAX_DISPLAY) {
-                String filename = file.name();
-                if (filename.startsWith("session_") && filename.endsWith(".bin")) {
-                    // Check if filename has proper format
-                    int start_pos = filename.indexOf('_') + 1;
-                    int end_pos = filename.lastIndexOf('.');
-                    if (start_pos > 0 && end_pos > start_pos) {
-                        
-                        // Read session file
-                        String full_path = String(GRIND_SESSIONS_DIR) + "/" + filename;
-                        File sessionFile = LittleFS.open(full_path.c_str(), "r");
-                        if (sessionFile) {
-                            TimeSeriesSessionHeader header;
-                            GrindSession session_data;
-                            
-                            if (sessionFile.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
-                                sessionFile.read((uint8_t*)&session_data, sizeof(session_data)) == sizeof(session_data)) {
-                                
-                                LOG_BLE("%2lu | %6.1fg | %6.1fg | %5.1fg | %4lus | %6u | %12u\n",
-                                    session_data.session_id,
-                                    session_data.target_weight,
-                                    session_data.final_weight,
-                                    session_data.error_grams,
-                                    session_data.total_time_ms / 1000,
-                                    header.event_count,
-                                    header.measurement_count);
-                                displayed++;
-                            }
-                            sessionFile.close();
-                        }
-                    }
-                }
-                file = dir.openNextFile();
-            }
-            dir.close();
-            
-            if (displayed >= MAX_DISPLAY && session_count > MAX_DISPLAY) {
-                LOG_BLE("... (showing %d of %lu sessions)\n", MAX_DISPLAY, session_count);
-            }
-            return;
-        }
+    // Newest sessions are the most useful when debugging
+    uint32_t first = session_count > MAX_DISPLAY ? session_count - MAX_DISPLAY : 0;
+    for (uint32_t i = first; i < session_count; i++) {
+        const SessionIndexEntry& entry = entries[i];
+        LOG_BLE("%2lu | %6.1fg | %6.1fg | %5.1fg | %4lus | %6u | %12u\n",
+            entry.session_id,
+            entry.target_weight,
+            entry.final_weight,
+            entry.error_grams,
+            entry.total_time_ms / 1000,
+            entry.event_count,
+            entry.measurement_count);
     }
     
-    LOG_BLE("No individual session files found\n");
+    if (first > 0) {
+        LOG_BLE("... (showing %lu of %lu sessions)\n", MAX_DISPLAY, session_count);
+    }
 }
 #endif // ENABLE_GRIND_DEBUG
 
 // Dummy implementations for functions not part of this refactor
 bool GrindLogger::rotate_flash_log_if_needed() { return true; }
 bool GrindLogger::clear_all_sessions_from_flash() {
+    session_summaries.clear();
+    if (log_partition.is_active()) {
+        return log_partition.clear();
+    }
     LOG_BLE("Attempting to purge grind history from directory: %s\n", GRIND_SESSIONS_DIR);
  
     File dir = LittleFS.open(GRIND_SESSIONS_DIR);
@@ -826,6 +949,9 @@ bool GrindLogger::clear_all_sessions_from_flash() {
     }
  
     dir.close();
+    if (!session_index.clear()) {
+        overall_result = false;
+    }
  
     LOG_DEBUG_PRINTF("Purge complete. Removed: %d, Failed: %d.\n", files_removed, files_failed);
  
@@ -839,108 +965,27 @@ bool GrindLogger::clear_all_sessions_from_flash() {
 }
 
 bool GrindLogger::remove_oldest_sessions(uint32_t sessions_to_remove) { return true; }
-uint32_t GrindLogger::calculate_checksum(const uint8_t* data, size_t length) { return 0; }
-
-void GrindLogger::reset_export_static_variables() {
-    // This function forces reset of static variables in export_sessions_binary_chunk
-    // by calling it with dummy parameters to trigger the reset logic
-    uint8_t dummy_buffer[1];
-    uint32_t dummy_next_pos;
-    size_t dummy_size;
-    export_sessions_binary_chunk(dummy_buffer, 0, 0, &dummy_next_pos, &dummy_size);
-    
-    // Also explicitly force close any static file handles by calling with 0 buffer size
-    // This ensures the file is closed in the static variable cleanup
-    export_sessions_binary_chunk(nullptr, 0, 0, &dummy_next_pos, &dummy_size);
-}
 
 #if ENABLE_GRIND_DEBUG
 void GrindLogger::print_struct_layout_debug() {
     LOG_GRIND_DEBUG("\n=== GRIND LOGGER STRUCT LAYOUT DEBUG ===\n");
-    
-    // Struct sizes
-    LOG_BLE("TimeSeriesSessionHeader size: %u bytes\n", sizeof(TimeSeriesSessionHeader));
-    LOG_BLE("GrindSession size: %u bytes\n", sizeof(GrindSession));
-    LOG_BLE("GrindEvent size: %u bytes\n", sizeof(GrindEvent));
-    LOG_BLE("GrindMeasurement size: %u bytes\n", sizeof(GrindMeasurement));
-    
-    // Yield to allow BLE transmission
-    vTaskDelay(pdMS_TO_TICKS(10));
-    
-    LOG_BLE("\n--- TimeSeriesSessionHeader offsets ---\n");
-    TimeSeriesSessionHeader* hdr = nullptr;
-    LOG_BLE("session_id offset: %zu\n", (size_t)&hdr->session_id);
-    LOG_BLE("session_timestamp offset: %zu\n", (size_t)&hdr->session_timestamp);
-    LOG_BLE("session_size offset: %zu\n", (size_t)&hdr->session_size);
-    LOG_BLE("checksum offset: %zu\n", (size_t)&hdr->checksum);
-    LOG_BLE("event_count offset: %zu\n", (size_t)&hdr->event_count);
-    LOG_BLE("measurement_count offset: %zu\n", (size_t)&hdr->measurement_count);
-    LOG_BLE("schema_version offset: %zu\n", (size_t)&hdr->schema_version);
-    LOG_BLE("reserved offset: %zu\n", (size_t)&hdr->reserved);
-    
-    // Yield to allow BLE transmission
-    vTaskDelay(pdMS_TO_TICKS(10));
-    
-    LOG_BLE("\n--- GrindSession offsets ---\n");
-    GrindSession* sess = nullptr;
-    LOG_BLE("session_id offset: %zu\n", (size_t)&sess->session_id);
-    LOG_BLE("session_timestamp offset: %zu\n", (size_t)&sess->session_timestamp);
-    LOG_BLE("target_time_ms offset: %zu\n", (size_t)&sess->target_time_ms);
-    LOG_BLE("total_time_ms offset: %zu\n", (size_t)&sess->total_time_ms);
-    LOG_BLE("total_motor_on_time_ms offset: %zu\n", (size_t)&sess->total_motor_on_time_ms);
-    LOG_BLE("time_error_ms offset: %zu\n", (size_t)&sess->time_error_ms);
-    LOG_BLE("target_weight offset: %zu\n", (size_t)&sess->target_weight);
-    LOG_BLE("tolerance offset: %zu\n", (size_t)&sess->tolerance);
-    LOG_BLE("final_weight offset: %zu\n", (size_t)&sess->final_weight);
-    LOG_BLE("error_grams offset: %zu\n", (size_t)&sess->error_grams);
-    LOG_BLE("start_weight offset: %zu\n", (size_t)&sess->start_weight);
-    LOG_BLE("initial_motor_stop_offset offset: %zu\n", (size_t)&sess->initial_motor_stop_offset);
-    LOG_BLE("latency_to_coast_ratio offset: %zu\n", (size_t)&sess->latency_to_coast_ratio);
-    LOG_BLE("flow_rate_threshold offset: %zu\n", (size_t)&sess->flow_rate_threshold);
-    // pulse_safety_factor_near_target field removed
-    LOG_BLE("profile_id offset: %zu\n", (size_t)&sess->profile_id);
-    LOG_BLE("grind_mode offset: %zu\n", (size_t)&sess->grind_mode);
-    LOG_BLE("max_pulse_attempts offset: %zu\n", (size_t)&sess->max_pulse_attempts);
-    LOG_BLE("pulse_count offset: %zu\n", (size_t)&sess->pulse_count);
-    LOG_BLE("termination_reason offset: %zu\n", (size_t)&sess->termination_reason);
-    LOG_BLE("result_status offset: %zu\n", (size_t)&sess->result_status);
-    
-    // Yield to allow BLE transmission
-    vTaskDelay(pdMS_TO_TICKS(10));
-    
-    LOG_BLE("\n--- GrindEvent offsets ---\n");
-    GrindEvent* evt = nullptr;
-    LOG_BLE("timestamp_ms offset: %zu\n", (size_t)&evt->timestamp_ms);
-    LOG_BLE("duration_ms offset: %zu\n", (size_t)&evt->duration_ms);
-    LOG_BLE("grind_latency_ms offset: %zu\n", (size_t)&evt->grind_latency_ms);
-    LOG_BLE("settling_duration_ms offset: %zu\n", (size_t)&evt->settling_duration_ms);
-    LOG_BLE("start_weight offset: %zu\n", (size_t)&evt->start_weight);
-    LOG_BLE("end_weight offset: %zu\n", (size_t)&evt->end_weight);
-    LOG_BLE("motor_stop_target_weight offset: %zu\n", (size_t)&evt->motor_stop_target_weight);
-    LOG_BLE("pulse_duration_ms offset: %zu\n", (size_t)&evt->pulse_duration_ms);
-    LOG_BLE("pulse_flow_rate offset: %zu\n", (size_t)&evt->pulse_flow_rate);
-    LOG_BLE("event_sequence_id offset: %zu\n", (size_t)&evt->event_sequence_id);
-    LOG_BLE("loop_count offset: %zu\n", (size_t)&evt->loop_count);
-    LOG_BLE("phase_id offset: %zu\n", (size_t)&evt->phase_id);
-    LOG_BLE("pulse_attempt_number offset: %zu\n", (size_t)&evt->pulse_attempt_number);
-    LOG_BLE("event_flags offset: %zu\n", (size_t)&evt->event_flags);
-    
-    // Yield to allow BLE transmission
-    vTaskDelay(pdMS_TO_TICKS(10));
-    
-    LOG_BLE("\n--- GrindMeasurement offsets ---\n");  
-    GrindMeasurement* meas = nullptr;
-    LOG_BLE("timestamp_ms offset: %zu\n", (size_t)&meas->timestamp_ms);
-    LOG_BLE("weight_grams offset: %zu\n", (size_t)&meas->weight_grams);
-    LOG_BLE("weight_delta offset: %zu\n", (size_t)&meas->weight_delta);
-    LOG_BLE("flow_rate_g_per_s offset: %zu\n", (size_t)&meas->flow_rate_g_per_s);
-    LOG_BLE("motor_stop_target_weight offset: %zu\n", (size_t)&meas->motor_stop_target_weight);
-    LOG_BLE("sequence_id offset: %zu\n", (size_t)&meas->sequence_id);
-    LOG_BLE("motor_is_on offset: %zu\n", (size_t)&meas->motor_is_on);
-    LOG_BLE("phase_id offset: %zu\n", (size_t)&meas->phase_id);
-    
-    // Yield to allow BLE transmission
-    vTaskDelay(pdMS_TO_TICKS(10));
+    LOG_BLE("Schema %u, layout %u bytes (BLE_DATA_CMD_GET_LOG_LAYOUT)\n", GRIND_LOG_SCHEMA_VERSION,
+            (unsigned)grind_log_layout_size());
+    
+    // The same table grinder-ble.py decodes with, so the two cannot disagree
+    for (uint8_t s = 0; s < GRIND_LOG_STRUCT_COUNT; s++) {
+        const LogStructLayout& layout = GRIND_LOG_STRUCTS[s];
+        LOG_BLE("\n--- %s: %u bytes%s ---\n", layout.name, layout.size,
+                grind_log_layout_is_complete(layout) ? "" : " (FIELDS DO NOT COVER THE STRUCT)");
+        for (uint8_t f = 0; f < layout.field_count; f++) {
+            const LogFieldLayout& field = layout.fields[f];
+            LOG_BLE("%s offset: %u (%c x%u, schema >= %u)\n", field.name, field.offset, (char)field.type,
+                    field.count, field.since_schema);
+        }
+        
+        // Yield to allow BLE transmission
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
     
     LOG_BLE("\n=== END STRUCT LAYOUT DEBUG ===\n");
 }
@@ -1024,35 +1069,25 @@ void GrindLogger::print_comprehensive_debug() {
     // Now read actual flash data from individual session files
     LOG_BLE("\n--- READING ACTUAL FLASH DATA ---\n");
     
-    // Try individual session files first
-    if (LittleFS.exists(GRIND_SESSIONS_DIR)) {
-        File dir = LittleFS.open(GRIND_SESSIONS_DIR);
-        if (dir && dir.isDirectory()) {
-            File dirFile = dir.openNextFile();
-            bool found_session = false;
-            
-            while (dirFile && !found_session) {
-                String filename = dirFile.name();
-                if (filename.startsWith("session_") && filename.endsWith(".bin")) {
-                    String full_path = String(GRIND_SESSIONS_DIR) + "/" + filename;
-                    File file = LittleFS.open(full_path.c_str(), "r");
-                    if (file) {
-                        LOG_BLE("Reading from: %s\n", filename.c_str());
-                        found_session = true;
-                        // Continue with existing logic but using this file
-                        
-                        TimeSeriesSessionHeader header;
-                        GrindSession session;
-                        int session_count = 0;
-                        const int MAX_SESSIONS_TO_DUMP = 2;
-                        const int MAX_EVENTS_PER_SESSION = 10;
-                        const int MAX_MEASUREMENTS_PER_SESSION = 10;
-                        
-                        while (file.available() >= sizeof(TimeSeriesSessionHeader) && session_count < MAX_SESSIONS_TO_DUMP) {
-                            // Read session header
-                            if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) break;
-                            
-                            LOG_BLE("\n=== FLASH SESSION %d ===\n", session_count + 1);
+    const int MAX_SESSIONS_TO_DUMP = 2;
+    const int MAX_EVENTS_PER_SESSION = 10;
+    const int MAX_MEASUREMENTS_PER_SESSION = 10;
+    
+    // Newest sessions first, from session files or the log partition
+    uint32_t stored_sessions = count_sessions_in_flash();
+    ArenaScope scope(file_arena);
+    uint32_t* session_ids = stored_sessions > 0 ? scope.allocate_array<uint32_t>(stored_sessions) : nullptr;
+    uint32_t listed = session_ids ? get_session_ids(session_ids, stored_sessions) : 0;
+    int session_count = 0;
+    SessionReader reader;
+    for (uint32_t n = listed; n > 0 && session_count < MAX_SESSIONS_TO_DUMP; n--) {
+        if (!open_session(session_ids[n - 1], &reader)) {
+            continue;
+        }
+        const TimeSeriesSessionHeader& header = reader.header();
+        const GrindSession& session = reader.session();
+        
+        LOG_BLE("\n=== FLASH SESSION %d ===\n", session_count + 1);
         LOG_BLE("TimeSeriesSessionHeader:\n");
         LOG_BLE("  session_id: %lu\n", header.session_id);
         LOG_BLE("  event_count: %u\n", header.event_count);
@@ -1061,9 +1096,6 @@ void GrindLogger::print_comprehensive_debug() {
         LOG_BLE("  session_size: %lu\n", header.session_size);
         LOG_BLE("  checksum: %lu\n", header.checksum);
         
-        // Read session data
-        if (file.read((uint8_t*)&session, sizeof(session)) != sizeof(session)) break;
-        
         LOG_BLE("GrindSession:\n");
         LOG_BLE("  session_id: %lu\n", session.session_id);
         LOG_BLE("  session_timestamp: %lu\n", session.session_timestamp);
@@ -1074,12 +1106,12 @@ void GrindLogger::print_comprehensive_debug() {
         LOG_BLE("  error_grams: %.3f\n", session.error_grams);
         LOG_BLE("  total_time_ms: %lu\n", session.total_time_ms);
         LOG_BLE("  pulse_count: %u\n", session.pulse_count);
-        LOG_BLE("  result_status: '%.16s'\n", session.result_status);
+        LOG_BLE("  result_status: '%.12s'\n", session.result_status);
         LOG_BLE("  total_motor_on_time_ms: %lu\n", session.total_motor_on_time_ms);
         
         // Raw memory dump of actual session
         LOG_BLE("GrindSession raw memory (%d bytes):\n  ", sizeof(session));
-        uint8_t* session_bytes = (uint8_t*)&session;
+        const uint8_t* session_bytes = (const uint8_t*)&session;
         for (int i = 0; i < sizeof(session); i++) {
             LOG_BLE("%02X ", session_bytes[i]);
             if ((i + 1) % 16 == 0) LOG_BLE("\n  ");
@@ -1090,7 +1122,7 @@ void GrindLogger::print_comprehensive_debug() {
         LOG_BLE("Events (showing first %d of %d):\n", min(MAX_EVENTS_PER_SESSION, (int)header.event_count), header.event_count);
         for (int i = 0; i < min(MAX_EVENTS_PER_SESSION, (int)header.event_count); i++) {
             GrindEvent event;
-            if (file.read((uint8_t*)&event, sizeof(event)) != sizeof(event)) break;
+            if (!reader.read_event(i, &event)) break;
             
             LOG_BLE("  Event %d:\n", i);
             LOG_BLE("    timestamp_ms: %lu, phase_id: %u, pulse_attempt: %u\n", 
@@ -1109,19 +1141,15 @@ void GrindLogger::print_comprehensive_debug() {
             LOG_BLE("\n");
         }
         
-        // Skip remaining events
-        int remaining_events = header.event_count - min(MAX_EVENTS_PER_SESSION, (int)header.event_count);
-        file.seek(file.position() + remaining_events * sizeof(GrindEvent));
-        
         // Read and dump measurements with raw data
         LOG_BLE("Measurements (showing first %d of %d):\n", min(MAX_MEASUREMENTS_PER_SESSION, (int)header.measurement_count), header.measurement_count);
         for (int i = 0; i < min(MAX_MEASUREMENTS_PER_SESSION, (int)header.measurement_count); i++) {
             GrindMeasurement meas;
-            if (file.read((uint8_t*)&meas, sizeof(meas)) != sizeof(meas)) break;
+            if (!reader.read_measurement(i, &meas)) break;
             
             LOG_BLE("  Measurement %d:\n", i);
-            LOG_BLE("    timestamp_ms: %lu, weight: %.3f, delta: %.3f\n", 
-                         meas.timestamp_ms, meas.weight_grams, meas.weight_delta);
+            LOG_BLE("    timestamp_ms: %lu, sample_timestamp_us: %lu, weight: %.3f, delta: %.3f\n", 
+                         meas.timestamp_ms, meas.sample_timestamp_us, meas.weight_grams, meas.weight_delta);
             LOG_BLE("    flow_rate: %.3f, motor_on: %u, phase_id: %u\n", 
                          meas.flow_rate_g_per_s, meas.motor_is_on, meas.phase_id);
             
@@ -1134,26 +1162,12 @@ void GrindLogger::print_comprehensive_debug() {
             LOG_BLE("\n");
         }
         
-        // Skip remaining measurements
-        int remaining_measurements = header.measurement_count - min(MAX_MEASUREMENTS_PER_SESSION, (int)header.measurement_count);
-        file.seek(file.position() + remaining_measurements * sizeof(GrindMeasurement));
-        
-                            session_count++;
-                        }
-                        file.close();
-                        break; // Found and processed one session file
-                    }
-                }
-                dirFile = dir.openNextFile();
-            }
-            dir.close();
-            
-            if (!found_session) {
-                LOG_BLE("No valid session files found in directory\n");
-            }
-        }
-    } else {
-        LOG_BLE("No individual session files directory found\n");
+        session_count++;
+    }
+    reader.close();
+    
+    if (session_count == 0) {
+        LOG_BLE("No stored sessions found\n");
     }
     
     LOG_BLE("\n=== END COMPREHENSIVE DEBUG ===\n");
@@ -1175,79 +1189,6 @@ bool GrindLogger::ensure_sessions_directory_exists() {
     return true;
 }
 
-bool GrindLogger::write_individual_session_file(uint32_t session_id, const GrindSession& session, const GrindEvent* events, const GrindMeasurement* measurements) {
-    char filename[64];
-    snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_id);
-    
-    File file = LittleFS.open(filename, "w");
-    if (!file) {
-        LOG_BLE("ERROR: Failed to open session file for writing: %s\n", filename);
-        return false;
-    }
-    
-    // Calculate sizes
-    size_t events_size = event_count * sizeof(GrindEvent);
-    size_t measurements_size = measurement_count * sizeof(GrindMeasurement);
-    size_t total_data_size = sizeof(GrindSession) + events_size + measurements_size;
-    
-    // Create and write session header (for compatibility with existing parsing)
-    TimeSeriesSessionHeader header;
-    header.session_id = session_id;
-    header.session_timestamp = session.session_timestamp;
-    header.session_size = total_data_size;
-    header.checksum = calculate_checksum((const uint8_t*)&session, total_data_size);
-    header.event_count = event_count;
-    header.measurement_count = measurement_count;
-    header.schema_version = GRIND_LOG_SCHEMA_VERSION;
-    header.reserved = 0;
-    
-    // Write header, session, events, and measurements
-    if (file.write((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
-        file.write((uint8_t*)&session, sizeof(session)) != sizeof(session) ||
-        (events_size > 0 && file.write((uint8_t*)events, events_size) != events_size) ||
-        (measurements_size > 0 && file.write((uint8_t*)measurements, measurements_size) != measurements_size)) {
-        
-        file.close();
-        LittleFS.remove(filename); // Clean up partial file
-        LOG_BLE("ERROR: Failed to write session data to file: %s\n", filename);
-        return false;
-    }
-    
-    file.close();
-    LOG_BLE("Successfully wrote session %lu to file (%zu bytes)\n", session_id, total_data_size + sizeof(header));
-    return true;
-}
-
-bool GrindLogger::validate_session_file(uint32_t session_id) {
-    char filename[64];
-    snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_id);
-    
-    if (!LittleFS.exists(filename)) {
-        return false;
-    }
-    
-    File file = LittleFS.open(filename, "r");
-    if (!file) {
-        return false;
-    }
-    
-    // Check basic file structure
-    TimeSeriesSessionHeader header;
-    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) {
-        file.close();
-        return false;
-    }
-    
-    // Basic validation: session_id should match filename and file size should be reasonable
-    if (header.session_id != session_id || header.session_size == 0 || header.session_size > 100000) {
-        file.close();
-        return false;
-    }
-    
-    file.close();
-    return true;
-}
-
 bool GrindLogger::remove_session_file(uint32_t session_id) {
     char filename[64];
     snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, session_id);
@@ -1264,58 +1205,103 @@ bool GrindLogger::remove_session_file(uint32_t session_id) {
     return true; // File doesn't exist, so "removal" succeeded
 }
 
-void GrindLogger::cleanup_old_session_files() {
+void GrindLogger::recover_interrupted_session_files() {
     File dir = LittleFS.open(GRIND_SESSIONS_DIR);
     if (!dir || !dir.isDirectory()) {
-        LOG_BLE("WARNING: Cannot open sessions directory for cleanup.\n");
         return;
     }
 
-    // Step 1: Count files and collect session IDs
-    uint32_t session_count = 0;
     File file = dir.openNextFile();
     while (file) {
-        session_count++;
+        String filename = file.name();
+        TimeSeriesSessionHeader header;
+        bool interrupted = filename.endsWith(".bin") &&
+                           file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                           header.schema_version >= GRIND_LOG_SCHEMA_STREAMED &&
+                           (header.flags & SESSION_FILE_FLAG_OPEN);
+        file.close();
+
+        if (interrupted) {
+            String full_path = filename.startsWith("/") ? filename : (String(GRIND_SESSIONS_DIR) + "/" + filename);
+            SessionStreamWriter::recover(full_path.c_str());
+            // The reset came before the ID could be persisted as used
+            if (header.session_id >= _next_session_id) {
+                _next_session_id = header.session_id + 1;
+            }
+        }
         file = dir.openNextFile();
     }
-    dir.close(); // Close after counting
+    dir.close();
+}
+
+void GrindLogger::seed_session_summaries() {
+    uint32_t session_count = count_sessions_in_flash();
+    if (session_count == 0) {
+        session_summaries.save();
+        return;
+    }
+    ArenaScope scope(file_arena);
+    uint32_t* session_ids = scope.allocate_array<uint32_t>(session_count);
+    GrindEvent* events = scope.allocate_array<GrindEvent>(GRIND_LOG_MAX_EVENTS);
+    if (!session_ids || !events) {
+        LOG_BLE("ERROR: Failed to allocate memory to seed session summaries\n");
+        return;
+    }
+    session_count = get_session_ids(session_ids, session_count);
+
+    // Oldest first, so the newest sessions end up newest in the table
+    SessionReader reader;
+    SessionPreviewBuilder preview;
+    GrindMeasurement measurement;
+    uint32_t seeded = 0;
+    for (uint32_t i = 0; i < session_count; i++) {
+        if (!open_session(session_ids[i], &reader) || !reader.verify_checksum()) {
+            continue;
+        }
+        uint16_t event_count = std::min<uint16_t>(reader.header().event_count, GRIND_LOG_MAX_EVENTS);
+        uint16_t read = 0;
+        while (read < event_count && reader.read_event(read, &events[read])) {
+            read++;
+        }
+        SessionSummary summary;
+        SessionSummaryTable::summarize(reader.session(), events, read, &summary);
+        preview.reset();
+        for (uint16_t m = 0; reader.read_measurement(m, &measurement); m++) {
+            preview.add(measurement.timestamp_ms, measurement.weight_grams);
+        }
+        preview.finish(&summary);
+        session_summaries.add(summary);
+        seeded++;
+    }
+    reader.close();
+
+    session_summaries.save();
+    LOG_BLE("Session summaries seeded from %lu stored sessions\n", (unsigned long)seeded);
+}
 
+void GrindLogger::cleanup_old_session_files() {
+    uint32_t session_count = session_index.get_session_count();
     if (session_count <= MAX_STORED_SESSIONS_FLASH) {
         return; // No cleanup needed
     }
 
     LOG_BLE("Session count (%lu) exceeds limit (%d). Cleaning up old files...\n", session_count, MAX_STORED_SESSIONS_FLASH);
 
-    // Step 2: Create a list of session IDs
-    uint32_t* session_ids = (uint32_t*)malloc(session_count * sizeof(uint32_t));
+    // The index lists session IDs in ascending order, so the oldest come first.
+    // Runs on the session flush path; another grinder's session may be starting meanwhile, so the list is scoped
+    ArenaScope scope(session_arena);
+    uint32_t* session_ids = scope.allocate_array<uint32_t>(session_count);
     if (!session_ids) {
         LOG_BLE("ERROR: Failed to allocate memory for session ID list during cleanup.\n");
         return;
     }
+    session_count = session_index.get_session_ids(session_ids, session_count);
 
-    dir = LittleFS.open(GRIND_SESSIONS_DIR);
-    uint32_t list_idx = 0;
-    file = dir.openNextFile();
-    while (file && list_idx < session_count) {
-        String filename = file.name();
-        int start_pos = filename.indexOf('_') + 1;
-        int end_pos = filename.lastIndexOf('.');
-        if (start_pos > 0 && end_pos > start_pos) {
-            session_ids[list_idx++] = filename.substring(start_pos, end_pos).toInt();
-        }
-        file = dir.openNextFile();
-    }
-    dir.close();
-
-    // Step 3: Sort the session IDs in ascending order
-    std::sort(session_ids, session_ids + session_count);
-
-    // Step 4: Remove the oldest files
-    uint32_t files_to_remove = session_count - MAX_STORED_SESSIONS_FLASH;
+    uint32_t files_to_remove = session_count > MAX_STORED_SESSIONS_FLASH ? session_count - MAX_STORED_SESSIONS_FLASH : 0;
     for (uint32_t i = 0; i < files_to_remove; i++) {
         remove_session_file(session_ids[i]);
     }
+    session_index.remove_sessions(session_ids, files_to_remove);
 
-    free(session_ids);
     LOG_BLE("Cleanup complete. Removed %lu old session(s).\n", files_to_remove);
 }
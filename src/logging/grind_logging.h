@@ -1,53 +1,71 @@
 #pragma once
 #include <Arduino.h>
 #include <Preferences.h>
+#include <esp_rom_crc.h>
 #include "../config/constants.h"
 #include "../controllers/grind_session.h"
+#include "../hardware/ring.h"
+#include "session_stream_writer.h"
+#include "session_event_buffer.h"
+#include "adc_capture.h"
+#include "session_index.h"
+#include "session_summary.h"
+#include "session_log_partition.h"
+#include "session_file.h"
 
 // Forward declarations
 class WeightSensor;
 class Grinder;
+class SampleSequenceSource;
+class MotorEdgeTimeline;
+class SessionReader;
 
-// Buffer settings (PSRAM staging area) - Dynamic calculation based on actual timing
-#define MAX_EVENTS_PER_GRIND 50                             // Max discrete events per session (phases, pulses, etc.)
-
-// Core 0 synchronized logging frequency matches the control loop interval
-// Example: 30s * 50Hz = 1500 measurements when control interval is 20ms
-// Memory impact scales with frequency; keep aligned with SYS_TASK_GRIND_CONTROL_INTERVAL_MS
-#define CORE0_CONTROL_FREQUENCY_HZ (1000 / SYS_TASK_GRIND_CONTROL_INTERVAL_MS)
-#define CALCULATE_MAX_MEASUREMENTS_PER_GRIND() \
-    (GRIND_TIMEOUT_SEC * CORE0_CONTROL_FREQUENCY_HZ / SYS_LOG_EVERY_N_GRIND_LOOPS)
-
-#define MAX_MEASUREMENTS_PER_GRIND CALCULATE_MAX_MEASUREMENTS_PER_GRIND()
-#define EVENT_TEMP_BUFFER_SIZE MAX_EVENTS_PER_GRIND  
-#define MEASUREMENT_TEMP_BUFFER_SIZE MAX_MEASUREMENTS_PER_GRIND
+// Measurement rows follow the report interval, not the control rate, and stream to the
+// session file as they are kept, so no RAM is sized for them: only the header's 16-bit
+// count bounds a session (rows past it count in GrindSession::measurements_dropped)
+#define GRIND_LOG_MAX_MEASUREMENTS UINT16_MAX
+#define MEASUREMENT_HISTORY_SIZE ring_capacity_for(SYS_LOG_PRE_TRIGGER_LOOPS + 1)    // Pre-trigger delay line and the newest loop
 
 // Flash storage settings
 #define GRIND_SESSIONS_DIR "/sessions"                      // Directory for individual session files
 #define SESSION_FILE_FORMAT "/sessions/session_%lu.bin"    // Individual session file naming format
 #define GRIND_LOG_FILE "/grind_sessions.bin"                // Legacy single-file storage (deprecated)
-#define MAX_STORED_SESSIONS_FLASH 10                        // Maximum sessions to keep in flash (configurable)
+#define MAX_STORED_SESSIONS_FLASH 100                       // Maximum sessions to keep in flash (~10 KB each with encoded measurements)
 
 #pragma pack(push, 1)
 
-constexpr uint16_t GRIND_LOG_SCHEMA_VERSION = 2;
+constexpr uint16_t GRIND_LOG_SCHEMA_VERSION = 8;         // v8: grinder channel in GrindSession
+constexpr uint16_t GRIND_LOG_SCHEMA_SAMPLE_TIME_US = 3;  // First schema with µs sample timestamps
+constexpr uint16_t GRIND_LOG_SCHEMA_MEASUREMENT_BLOCKS = 4; // First schema with encoded measurement blocks
+constexpr uint16_t GRIND_LOG_SCHEMA_STREAMED = 5;        // First schema with events stored after the measurement blocks
+constexpr uint16_t GRIND_LOG_SCHEMA_ADC_CAPTURE = 6;     // First schema that may hold MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE blocks
+constexpr uint16_t GRIND_LOG_SCHEMA_OVERFLOW_COUNTS = 7; // First schema with GrindSession::events_dropped/measurements_dropped
+constexpr uint16_t GRIND_LOG_SCHEMA_GRINDER_CHANNEL = 8; // First schema with GrindSession::grinder_channel (reserved, 0, before)
+constexpr size_t GRIND_MEASUREMENT_V2_SIZE = 24;         // GrindMeasurement size in schema <= 2 files
 
 // Time-series session header for flash file
 struct TimeSeriesSessionHeader {
     uint32_t session_id;           // Session identifier
     uint32_t session_timestamp;    // Unix timestamp when session started
     uint32_t session_size;         // Total size of session, events, and measurements in bytes
-    uint32_t checksum;             // Checksum of all data
+    uint32_t checksum;             // session_checksum_update() CRC-32 with SESSION_FILE_FLAG_CHECKSUM, else 0
     uint16_t event_count;          // Number of discrete events in this session
     uint16_t measurement_count;    // Number of continuous measurements in this session
     uint16_t schema_version;       // Schema/version so Python tools can adapt
-    uint16_t reserved;             // Reserved for future use (alignment + versioned flags)
+    uint16_t flags;                // SessionFileFlags (always 0 in files from older firmware)
+};
+
+enum SessionFileFlags : uint16_t {
+    SESSION_FILE_FLAG_OPEN = 1 << 0,      // Still being streamed; left set by a reset mid-grind until recovered at boot
+    SESSION_FILE_FLAG_CHECKSUM = 1 << 1   // checksum holds the session's CRC-32
 };
 
 enum GrindEventFlags : uint8_t {
     GRIND_EVENT_FLAG_TIME_MODE   = 1 << 0,  // Event recorded while grinding by time
     GRIND_EVENT_FLAG_MOTOR_ACTIVE = 1 << 1, // Phase kept the motor running
-    GRIND_EVENT_FLAG_PULSE_PHASE = 1 << 2   // Phase represents a pulse or settling after a pulse
+    GRIND_EVENT_FLAG_PULSE_PHASE = 1 << 2,  // Phase represents a pulse or settling after a pulse
+    GRIND_EVENT_FLAG_SCHEDULED_STOP = 1 << 3, // Predictive stop was cut inside the control tick by the one-shot timer
+    GRIND_EVENT_FLAG_PIPELINED_PULSE = 1 << 4 // Pulse planned from a projected settle before precision settling
 };
 
 // Discrete, low-frequency events summarizing a phase.
@@ -83,17 +101,26 @@ struct GrindMeasurement {
     uint16_t sequence_id;             // Sequence for data integrity checks
     uint8_t  motor_is_on;             // Motor state at time of measurement
     uint8_t  phase_id;                // Current grinding phase ID
+    uint32_t sample_timestamp_us;     // Capture time of newest ADC sample, µs relative to session start (schema >= 3)
 
     GrindMeasurement() {
         memset(this, 0, sizeof(GrindMeasurement));
     }
 };
 
+// Measurement record size for a session file's schema version (v4 blocks decode to full records)
+inline size_t grind_measurement_record_size(uint16_t schema_version) {
+    return schema_version >= GRIND_LOG_SCHEMA_SAMPLE_TIME_US ? sizeof(GrindMeasurement) : GRIND_MEASUREMENT_V2_SIZE;
+}
+
 enum class GrindTerminationReason : uint8_t {
     COMPLETED = 0,
     TIMEOUT = 1,
     OVERSHOOT = 2,
     MAX_PULSES = 3,
+    FLOW_STALLED = 4,       // Flow anomaly abort: no flow or flow collapsed
+    FLOW_UNSTABLE = 5,      // Flow anomaly abort: popcorning or repeated weight drops
+    PROJECTED_TIMEOUT = 6,  // Flow too slow to reach the target before the session timeout
     UNKNOWN = 255
 };
 
@@ -125,8 +152,12 @@ struct GrindSession {
     uint8_t  max_pulse_attempts;      // Configured max pulse attempts
     uint8_t  pulse_count;             // Pulses executed
     uint8_t  termination_reason;      // See GrindTerminationReason
-    uint8_t  reserved[3];             // Alignment + future expansion
-    char     result_status[16];       // Null-terminated status string
+    uint8_t  flow_detection_window_steps;  // FlowWindows the session ran with, GRIND_ADAPTIVE_WINDOW_STEP_MS units
+    uint8_t  flow_prediction_window_steps; // (0 in sessions logged before they were recorded)
+    uint8_t  grinder_channel;         // GrindChannels index the session ran on (0 before schema 8)
+    char     result_status[12];       // Null-terminated status string (16 chars before schema 7)
+    uint16_t events_dropped;          // Events the session could not keep (schema >= 7)
+    uint16_t measurements_dropped;    // Kept rows that did not reach the file: stream backlog or the 16-bit cap (schema >= 7)
 
     GrindSession() {
         memset(this, 0, sizeof(GrindSession));
@@ -137,67 +168,129 @@ struct GrindSession {
 
 static_assert(sizeof(TimeSeriesSessionHeader) == 24, "Unexpected TimeSeriesSessionHeader size");
 static_assert(sizeof(GrindEvent) == 44, "Unexpected GrindEvent size");
-static_assert(sizeof(GrindMeasurement) == 24, "Unexpected GrindMeasurement size");
+static_assert(sizeof(GrindMeasurement) == 28, "Unexpected GrindMeasurement size");
 static_assert(sizeof(GrindSession) == 80, "Unexpected GrindSession size");
 
+// Byte offsets of the event and measurement sections in a session file. Up to v4 the
+// events follow the session; from v5 they are appended after the streamed measurement blocks.
+inline uint32_t session_file_events_offset(const TimeSeriesSessionHeader& header) {
+    if (header.schema_version >= GRIND_LOG_SCHEMA_STREAMED) {
+        return sizeof(TimeSeriesSessionHeader) + header.session_size - header.event_count * sizeof(GrindEvent);
+    }
+    return sizeof(TimeSeriesSessionHeader) + sizeof(GrindSession);
+}
+
+inline uint32_t session_file_measurements_offset(const TimeSeriesSessionHeader& header) {
+    if (header.schema_version >= GRIND_LOG_SCHEMA_STREAMED) {
+        return sizeof(TimeSeriesSessionHeader) + sizeof(GrindSession);
+    }
+    return sizeof(TimeSeriesSessionHeader) + sizeof(GrindSession) + header.event_count * sizeof(GrindEvent);
+}
+
+// Session checksum: CRC-32 (ROM esp_rom_crc32_le) of the session_size bytes after the GrindSession
+// in file order, continued over the final GrindSession. Writers fold in each section as they write
+// it and the session, which is rewritten last, at the end, so nothing is read back to checksum it.
+inline uint32_t session_checksum_update(uint32_t crc, const void* data, size_t length) {
+    return esp_rom_crc32_le(crc, (const uint8_t*)data, length);
+}
+
 // Time-series grind logging manager
+//
+// Each grinder channel (GrindChannels) records its sessions in a Recording of its own,
+// so grinders that run at once each get their session file; the stored sessions, their
+// index, summaries and ids are shared. Session calls name the channel they record for.
 class GrindLogger {
 private:
-    // Time-series system
-    GrindSession* current_session;           // Current session metadata (PSRAM)
-    GrindEvent* event_buffer;                // PSRAM temp buffer for events
-    GrindMeasurement* measurement_buffer;    // PSRAM temp buffer for measurements
-    uint16_t event_count;                    // Current number of events in buffer
-    uint16_t measurement_count;              // Current number of measurements in buffer
-    uint16_t event_sequence_counter;         // **NEW**: Counter for unique event IDs
-    uint16_t measurement_sequence_counter;   // Sequence counter for continuous measurements
-    
-    char current_phase_name[16];             // Current grinding phase name
-    bool logging_active;                     // Whether a grind session is active
-    
-    // Motor time tracking
-    bool last_motor_state;                   // Previous motor state for change detection
-    uint32_t motor_start_time;               // When motor last turned on
-    uint32_t total_motor_time_ms;            // Accumulated motor on time for session
-    
-    // Current session data
-    uint32_t session_start_time;
+    // One channel's session being recorded
+    struct Recording {
+        GrindSession* session = nullptr;     // Session metadata (PSRAM)
+        // The session's events, grown in PSRAM chunks and flushed as a plain array
+        SessionEventBuffer event_buffer;
+        // Measurements go to the session file block by block while the grind runs
+        SessionStreamWriter measurement_stream;
+        // Raw ADC samples and motor edges, appended to the same stream when capture is enabled
+        AdcCapture adc_capture;
+        // Core 0 delay line: each loop's record waits SYS_LOG_PRE_TRIGGER_LOOPS loops before it is
+        // kept or decimated away, so a trigger can still keep the loops that led up to it
+        Ring<GrindMeasurement, MEASUREMENT_HISTORY_SIZE> measurement_history;
+        uint32_t last_trigger_loop = 0;      // measurement_history index of the newest full-rate loop
+        bool trigger_seen = false;
+        uint32_t last_kept_loop = 0;         // measurement_history index of the newest record written
+        float pending_weight_delta = 0.0f;   // Deltas of records decimated away since then
+        uint32_t streamed_session_id = 0;    // Session the stream was opened for (0 = none yet)
+        SessionPreviewBuilder session_preview;   // Weight curve of the session, fed as records are kept
+        uint16_t event_sequence_counter = 0; // Counter for unique event IDs
+        uint16_t measurement_sequence_counter = 0;   // Sequence counter for continuous measurements
+        uint16_t measurements_dropped = 0;   // Rows kept but not streamed (GrindSession::measurements_dropped)
+        bool logging_active = false;         // Whether a grind session is active
+
+        // Motor time tracking
+        bool last_motor_state = false;       // Previous motor state for change detection
+        uint32_t motor_start_time = 0;       // When motor last turned on
+        uint32_t total_motor_time_ms = 0;    // Accumulated motor on time for session
+
+        uint32_t session_start_time = 0;
+        uint32_t session_start_us = 0;       // esp_timer origin of measurement sample times
+        bool session_prepared = false;       // Buffers wiped and session id persisted for the next start
+    };
+
+    Recording recordings[HW_GRINDER_CHANNELS];
+    SessionIndex session_index;              // Counts and listings without walking GRIND_SESSIONS_DIR
+    SessionLogPartition log_partition;       // Replaces session files and index when partitions.csv has it
+    SessionSummaryTable session_summaries;   // Per-session outcomes for trends, appended as sessions are flushed
     
     // Session ID management
     Preferences* _preferences;
     uint32_t _next_session_id;
     
+    // Binary export position between chunks (heap, only while an export runs)
+    struct ExportCursor;
+    ExportCursor* export_cursor = nullptr;
+    
 public:
     bool init(Preferences* prefs);           // Initialize PSRAM buffer
     void cleanup();                          // Free PSRAM buffer
     
-    // Session management
+    // Session management (descriptor.grinder_channel names the recording)
     void start_grind_session(const GrindSessionDescriptor& descriptor, float start_weight);
-    void end_grind_session(const char* final_result, float final_weight, uint8_t pulse_count);
-    void discard_current_session();         // Discard current session without saving
+    void end_grind_session(uint8_t grinder_channel, const char* final_result, float final_weight, uint8_t pulse_count);
+    void discard_current_session(uint8_t grinder_channel);  // Discard the channel's session without saving
+    
+    // Raw ADC capture (persisted in the "logging" namespace, read when a session stream opens)
+    void set_adc_capture_sources(uint8_t grinder_channel, const SampleSequenceSource* samples, const MotorEdgeTimeline* edges);
+    void set_adc_capture_enabled(bool enabled);
+    bool is_adc_capture_enabled() const;
     
     // Logging methods
-    void log_event(GrindEvent& event);       // **MODIFIED**: Takes non-const reference to set sequence ID
-    void log_continuous_measurement(uint32_t timestamp_ms, float weight_grams, float weight_delta, 
-                                  float flow_rate_g_per_s, uint8_t motor_is_on, uint8_t phase_id, 
-                                  float motor_stop_target_weight);
+    void log_event(uint8_t grinder_channel, GrindEvent& event);   // Takes non-const reference to set sequence ID
+    void log_continuous_measurement(uint8_t grinder_channel, uint32_t timestamp_ms, uint32_t sample_timestamp_us,
+                                  float weight_grams, float weight_delta, float flow_rate_g_per_s, uint8_t motor_is_on,
+                                  uint8_t phase_id, float motor_stop_target_weight, bool full_rate);
+    void flush_measurement_history(uint8_t grinder_channel);  // Core 0, before END_GRIND_SESSION: release the delay line
     
     // Flash storage management
-    bool flush_session_to_flash();          // Flush current session to flash
+    void service_session_stream();          // FileIOTask: open each active session's file, append full blocks
     bool rotate_flash_log_if_needed();      // Remove old sessions if limit exceeded
     bool clear_all_sessions_from_flash();   // Purge all stored sessions (for developer purge)
     uint32_t count_sessions_in_flash() const; // Count total sessions in flash file
     uint32_t count_total_events_in_flash() const; // Count total events across all sessions
     uint32_t count_total_measurements_in_flash() const; // Count total measurements across all sessions
+    uint32_t get_session_ids(uint32_t* session_ids, uint32_t max_sessions) const; // Stored sessions, oldest first
+    uint32_t get_session_entries(SessionIndexEntry* entries, uint32_t max_entries) const; // The same, with their index entries
+    const SessionSummaryTable& get_session_summaries() const { return session_summaries; }
+    bool open_session(uint32_t session_id, SessionReader* reader) const; // From the log partition or LittleFS
     
-    // Fixed-length binary export method
+    // Fixed-length binary export method (buffer == nullptr ends an export early)
     void export_sessions_binary_chunk(uint8_t* buffer, size_t buffer_size,
                                      uint32_t start_pos, uint32_t* next_pos, size_t* actual_size);
-    void send_current_session_via_serial();  // Debug output for current session
+    void send_current_session_via_serial();  // Debug output for every session being recorded
     
     // Data access
     uint32_t get_total_flash_sessions() const;
-    bool is_logging_active() const { return logging_active; }
+    bool is_logging_active() const;          // Any channel
+    bool is_recording(uint8_t grinder_channel) const {
+        return grinder_channel < HW_GRINDER_CHANNELS && recordings[grinder_channel].logging_active;
+    }
     
     // Debug output helpers - conditionally compiled based on debug flags (moved to public for BLE access)
 #if ENABLE_GRIND_DEBUG
@@ -213,19 +306,28 @@ public:
     
 private:
     // Time-series system helpers
-    void clear_buffers();
-    void initialize_session_config();       // Snapshot current config into session
-    void reset_export_static_variables();   // Reset static variables used in export function
+    Recording& recording_for(uint8_t grinder_channel) {
+        return recordings[grinder_channel < HW_GRINDER_CHANNELS ? grinder_channel : 0];
+    }
+    void clear_buffers(Recording& recording);
+    // Core 1 work done between sessions so start_grind_session() is RAM-only on Core 0
+    void prepare_next_session(Recording& recording);
+    void initialize_session_config(Recording& recording);   // Snapshot current config into session
+    void end_export();                      // Free the export cursor and close its session
+    // Keep or drop a record leaving the delay line
+    void release_measurement(Recording& recording, uint32_t newest_offset, bool session_end);
+    bool flush_session_to_flash(Recording& recording);      // Finalize the streamed session file
     
     // Flash storage helpers
-    uint32_t calculate_checksum(const uint8_t* data, size_t length); // Simple checksum calculation
-    bool write_time_series_session_to_flash(const GrindSession& session, const GrindEvent* events, const GrindMeasurement* measurements);
+    bool write_time_series_session_to_flash(const GrindSession& session, const GrindEvent* events, uint16_t event_count,
+                                            const GrindMeasurement* measurements, uint16_t measurement_count);
     bool remove_oldest_sessions(uint32_t sessions_to_remove); // Remove oldest sessions from flash file (legacy)
     
     // Individual session file management
     bool ensure_sessions_directory_exists();    // Create sessions directory if needed
-    bool write_individual_session_file(uint32_t session_id, const GrindSession& session, const GrindEvent* events, const GrindMeasurement* measurements);
-    bool validate_session_file(uint32_t session_id); // Check if session file is valid/readable
+    bool open_session_stream(Recording& recording);   // Start the session's file (Core 1)
+    void recover_interrupted_session_files();   // Repair files a reset left SESSION_FILE_FLAG_OPEN
+    void seed_session_summaries();              // Summarize the stored sessions into an empty summary table
     bool remove_session_file(uint32_t session_id);   // Delete specific session file
     void cleanup_old_session_files(); // Remove old session files to maintain MAX_STORED_SESSIONS_FLASH limit
     
@@ -0,0 +1,57 @@
+#include "log_levels.h"
+#include "../config/logging.h"
+
+static constexpr uint32_t category_mask(uint8_t category, uint8_t level) {
+    return level >= LOG_LEVEL_COUNT ? 0
+         : ((log_level_bit(category, level) << 1) - 1) & ~(log_level_bit(category, 0) - 1);
+}
+
+static constexpr uint32_t default_mask() {
+    uint32_t mask = 0;
+    for (uint8_t category = 0; category < LOG_CAT_COUNT; category++) {
+        mask |= category_mask(category, log_default_level(category));
+    }
+    return mask;
+}
+
+std::atomic<uint32_t> log_level_mask{default_mask()};
+
+static const char* const kCategoryNames[LOG_CAT_COUNT] = {
+    "grind", "loadcell", "ui", "calibration", "settling", "ble", "storage", "system"
+};
+static const char* const kLevelNames[LOG_LEVEL_COUNT] = { "error", "warn", "info", "debug" };
+
+void log_set_level(LogCategory category, uint8_t level) {
+    if (category >= LOG_CAT_COUNT) {
+        return;
+    }
+    uint32_t all_levels = category_mask(category, LOG_LEVEL_COUNT - 1);
+    uint32_t mask = log_level_mask.load(std::memory_order_relaxed);
+    while (!log_level_mask.compare_exchange_weak(mask, (mask & ~all_levels) | category_mask(category, level),
+                                                 std::memory_order_relaxed)) {
+    }
+}
+
+uint8_t log_get_level(LogCategory category) {
+    if (category >= LOG_CAT_COUNT) {
+        return LOG_LEVEL_OFF;
+    }
+    for (int level = LOG_LEVEL_COUNT - 1; level >= 0; level--) {
+        if (log_level_enabled(category, (uint8_t)level)) {
+            return (uint8_t)level;
+        }
+    }
+    return LOG_LEVEL_OFF;
+}
+
+void log_reset_levels() {
+    log_level_mask.store(default_mask(), std::memory_order_relaxed);
+}
+
+const char* log_category_name(LogCategory category) {
+    return category < LOG_CAT_COUNT ? kCategoryNames[category] : "?";
+}
+
+const char* log_level_name(uint8_t level) {
+    return level < LOG_LEVEL_COUNT ? kLevelNames[level] : "off";
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// Levels: a category logs everything at or below its level
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+#define LOG_LEVEL_COUNT 4
+#define LOG_LEVEL_OFF 0xFF                  // Runtime only: nothing from the category
+
+enum LogCategory : uint8_t {
+    LOG_CAT_GRIND,                          // Grind controller and strategies
+    LOG_CAT_LOADCELL,                       // ADC drivers, weight sampling
+    LOG_CAT_UI,
+    LOG_CAT_CALIBRATION,
+    LOG_CAT_SETTLING,
+    LOG_CAT_BLE,
+    LOG_CAT_STORAGE,                        // Session logging, flash queue, NVS
+    LOG_CAT_SYSTEM,
+    LOG_CAT_COUNT
+};
+
+static_assert(LOG_CAT_COUNT * LOG_LEVEL_COUNT <= 32, "Log levels of every category share one 32-bit mask");
+
+// Runtime levels, one bit per (category, level) so a check is one load, AND and branch
+extern std::atomic<uint32_t> log_level_mask;
+
+constexpr uint32_t log_level_bit(uint8_t category, uint8_t level) {
+    return 1u << (category * LOG_LEVEL_COUNT + level);
+}
+
+inline bool log_level_enabled(uint8_t category, uint8_t level) {
+    return (log_level_mask.load(std::memory_order_relaxed) & log_level_bit(category, level)) != 0;
+}
+
+void log_set_level(LogCategory category, uint8_t level);     // LOG_LEVEL_OFF silences it
+uint8_t log_get_level(LogCategory category);                 // LOG_LEVEL_OFF when silenced
+void log_reset_levels();                                     // Back to the compiled-in defaults
+const char* log_category_name(LogCategory category);
+const char* log_level_name(uint8_t level);
@@ -0,0 +1,241 @@
+#include "measurement_codec.h"
+#include <math.h>
+#include <algorithm>
+
+namespace {
+
+constexpr int64_t NON_FINITE_VALUE = INT32_MIN;         // Quantized NAN/inf; real values are clamped inside int32
+constexpr int64_t MAX_QUANTIZED_GRAMS = INT32_MAX;
+
+int64_t quantize_grams(float grams) {
+    if (!isfinite(grams)) {
+        return NON_FINITE_VALUE;
+    }
+    double lsb = (double)grams / GRIND_LOG_GRAMS_PER_LSB;
+    return (int64_t)llround(std::max(-(double)MAX_QUANTIZED_GRAMS, std::min(lsb, (double)MAX_QUANTIZED_GRAMS)));
+}
+
+float dequantize_grams(int64_t value) {
+    return value == NON_FINITE_VALUE ? NAN : (float)((double)value * GRIND_LOG_GRAMS_PER_LSB);
+}
+
+struct MeasurementColumn {
+    uint8_t order;                                      // 0 = value, 1 = difference, 2 = second difference
+    int64_t (*get)(const GrindMeasurement& m);
+    void (*set)(GrindMeasurement& m, int64_t value);
+};
+
+// On-flash column order; changing it changes the format (Python decoder mirrors it)
+const MeasurementColumn COLUMNS[] = {
+    { 2, [](const GrindMeasurement& m) -> int64_t { return m.timestamp_ms; },
+         [](GrindMeasurement& m, int64_t v) { m.timestamp_ms = (uint32_t)v; } },
+    { 2, [](const GrindMeasurement& m) -> int64_t { return m.sample_timestamp_us; },
+         [](GrindMeasurement& m, int64_t v) { m.sample_timestamp_us = (uint32_t)v; } },
+    { 2, [](const GrindMeasurement& m) -> int64_t { return m.sequence_id; },
+         [](GrindMeasurement& m, int64_t v) { m.sequence_id = (uint16_t)v; } },
+    { 1, [](const GrindMeasurement& m) { return quantize_grams(m.weight_grams); },
+         [](GrindMeasurement& m, int64_t v) { m.weight_grams = dequantize_grams(v); } },
+    { 0, [](const GrindMeasurement& m) { return quantize_grams(m.weight_delta); },
+         [](GrindMeasurement& m, int64_t v) { m.weight_delta = dequantize_grams(v); } },
+    { 1, [](const GrindMeasurement& m) { return quantize_grams(m.flow_rate_g_per_s); },
+         [](GrindMeasurement& m, int64_t v) { m.flow_rate_g_per_s = dequantize_grams(v); } },
+    { 1, [](const GrindMeasurement& m) { return quantize_grams(m.motor_stop_target_weight); },
+         [](GrindMeasurement& m, int64_t v) { m.motor_stop_target_weight = dequantize_grams(v); } },
+    { 1, [](const GrindMeasurement& m) -> int64_t { return m.motor_is_on; },
+         [](GrindMeasurement& m, int64_t v) { m.motor_is_on = (uint8_t)v; } },
+    { 1, [](const GrindMeasurement& m) -> int64_t { return m.phase_id; },
+         [](GrindMeasurement& m, int64_t v) { m.phase_id = (uint8_t)v; } },
+};
+
+// Residual of value against the column's predictor; advances the predictor state
+struct ColumnPredictor {
+    int64_t previous = 0;
+    int64_t previous_delta = 0;
+
+    int64_t residual(uint8_t order, int64_t value) {
+        int64_t delta = value - previous;
+        int64_t result = order == 0 ? value : (order == 1 ? delta : delta - previous_delta);
+        previous = value;
+        previous_delta = delta;
+        return result;
+    }
+
+    int64_t value(uint8_t order, int64_t residual) {
+        int64_t delta = order == 0 ? residual - previous : (order == 1 ? residual : previous_delta + residual);
+        previous += delta;
+        previous_delta = delta;
+        return previous;
+    }
+};
+
+bool write_varint(uint8_t*& out, const uint8_t* end, int64_t value) {
+    uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    do {
+        if (out >= end) {
+            return false;
+        }
+        uint8_t byte = zigzag & 0x7F;
+        zigzag >>= 7;
+        *out++ = zigzag ? (byte | 0x80) : byte;
+    } while (zigzag);
+    return true;
+}
+
+bool read_varint(const uint8_t*& in, const uint8_t* end, int64_t* value) {
+    uint64_t zigzag = 0;
+    for (uint8_t shift = 0; shift < 64; shift += 7) {
+        if (in >= end) {
+            return false;
+        }
+        uint8_t byte = *in++;
+        zigzag |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+size_t encode_measurement_block(const GrindMeasurement* measurements, uint8_t count, uint8_t* out, size_t capacity) {
+    if (!measurements || !out || count == 0 || count > GRIND_LOG_MEASUREMENTS_PER_BLOCK ||
+        capacity < MEASUREMENT_BLOCK_MAX_SIZE) {
+        return 0;
+    }
+
+    MeasurementBlockHeader header;
+    header.measurement_count = count;
+    header.flags = 0;
+
+    // Encoded payload must beat the raw records, otherwise the block is stored raw
+    const size_t raw_size = count * sizeof(GrindMeasurement);
+    uint8_t* payload = out + sizeof(header);
+    uint8_t* cursor = payload;
+    const uint8_t* end = payload + raw_size;
+    bool encoded = true;
+    for (const MeasurementColumn& column : COLUMNS) {
+        ColumnPredictor predictor;
+        for (uint8_t i = 0; encoded && i < count; i++) {
+            encoded = write_varint(cursor, end, predictor.residual(column.order, column.get(measurements[i])));
+        }
+    }
+
+    if (encoded && cursor < end) {
+        header.payload_size = (uint16_t)(cursor - payload);
+    } else {
+        header.flags |= MEASUREMENT_BLOCK_FLAG_RAW;
+        header.payload_size = (uint16_t)raw_size;
+        memcpy(payload, measurements, raw_size);
+    }
+    memcpy(out, &header, sizeof(header));
+    return sizeof(header) + header.payload_size;
+}
+
+bool decode_measurement_block(const MeasurementBlockHeader& header, const uint8_t* payload, GrindMeasurement* out) {
+    const uint8_t count = header.measurement_count;
+    if (!payload || !out || count == 0 || count > GRIND_LOG_MEASUREMENTS_PER_BLOCK) {
+        return false;
+    }
+    if (header.flags & MEASUREMENT_BLOCK_FLAG_RAW) {
+        if (header.payload_size != count * sizeof(GrindMeasurement)) {
+            return false;
+        }
+        memcpy(out, payload, header.payload_size);
+        return true;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        out[i] = GrindMeasurement();
+    }
+    const uint8_t* cursor = payload;
+    const uint8_t* end = payload + header.payload_size;
+    for (const MeasurementColumn& column : COLUMNS) {
+        ColumnPredictor predictor;
+        for (uint8_t i = 0; i < count; i++) {
+            int64_t residual;
+            if (!read_varint(cursor, end, &residual)) {
+                return false;
+            }
+            column.set(out[i], predictor.value(column.order, residual));
+        }
+    }
+    return cursor == end;
+}
+
+//==============================================================================
+// ADC CAPTURE BLOCKS
+//==============================================================================
+
+// Worst case per entry: two five-byte varints (33-bit differences)
+static_assert(sizeof(MeasurementBlockHeader) + GRIND_LOG_ADC_ENTRIES_PER_BLOCK * 10 <= MEASUREMENT_BLOCK_MAX_SIZE,
+              "ADC capture block must fit the measurement block buffers");
+
+size_t encode_adc_capture_block(const AdcCaptureEntry* entries, uint8_t count, uint8_t* out, size_t capacity) {
+    if (!entries || !out || count == 0 || capacity < MEASUREMENT_BLOCK_MAX_SIZE) {
+        return 0;
+    }
+
+    MeasurementBlockHeader header;
+    header.measurement_count = count;
+    header.flags = MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE;
+
+    uint8_t* payload = out + sizeof(header);
+    uint8_t* cursor = payload;
+    const uint8_t* end = out + capacity;
+    uint32_t previous_time = 0;
+    int32_t previous_sample = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const AdcCaptureEntry& entry = entries[i];
+        int64_t time_delta = (int32_t)(entry.timestamp_us - previous_time);
+        int64_t value = entry.type == ADC_CAPTURE_SAMPLE ? (int64_t)entry.value - previous_sample : entry.value;
+        if (!write_varint(cursor, end, time_delta * 2 + (entry.type & 1)) || !write_varint(cursor, end, value)) {
+            return 0;
+        }
+        previous_time = entry.timestamp_us;
+        if (entry.type == ADC_CAPTURE_SAMPLE) {
+            previous_sample = entry.value;
+        }
+    }
+
+    header.payload_size = (uint16_t)(cursor - payload);
+    memcpy(out, &header, sizeof(header));
+    return sizeof(header) + header.payload_size;
+}
+
+bool decode_adc_capture_block(const MeasurementBlockHeader& header, const uint8_t* payload, AdcCaptureEntry* out) {
+    if (!payload || header.measurement_count == 0 || header.flags != MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE) {
+        return false;
+    }
+
+    const uint8_t* cursor = payload;
+    const uint8_t* end = payload + header.payload_size;
+    uint32_t previous_time = 0;
+    int32_t previous_sample = 0;
+    for (uint8_t i = 0; i < header.measurement_count; i++) {
+        int64_t tagged_time;
+        int64_t value;
+        if (!read_varint(cursor, end, &tagged_time) || !read_varint(cursor, end, &value)) {
+            return false;
+        }
+        uint8_t type = (uint8_t)(tagged_time & 1);
+        previous_time += (uint32_t)(tagged_time >> 1);
+        if (type == ADC_CAPTURE_SAMPLE) {
+            previous_sample = (int32_t)(previous_sample + value);
+        }
+        if (out) {
+            out[i].timestamp_us = previous_time;
+            out[i].value = type == ADC_CAPTURE_SAMPLE ? previous_sample : (int32_t)value;
+            out[i].type = type;
+        }
+    }
+    return cursor == end;
+}
+
+bool is_valid_session_block(const MeasurementBlockHeader& header, const uint8_t* payload, GrindMeasurement* scratch) {
+    if (header.flags & MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE) {
+        return decode_adc_capture_block(header, payload, nullptr);
+    }
+    return decode_measurement_block(header, payload, scratch);
+}
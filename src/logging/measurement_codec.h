@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Arduino.h>
+#include "grind_logging.h"
+
+// Measurements per encoded block; each block restarts the predictors so it decodes on its own
+#define GRIND_LOG_MEASUREMENTS_PER_BLOCK 128
+#define GRIND_LOG_GRAMS_PER_LSB 0.0001f             // Quantization of weights, flow and stop target in encoded blocks
+
+#pragma pack(push, 1)
+// Precedes every measurement block in a schema >= GRIND_LOG_SCHEMA_MEASUREMENT_BLOCKS session file
+struct MeasurementBlockHeader {
+    uint8_t  measurement_count;    // Records in this block (1..GRIND_LOG_MEASUREMENTS_PER_BLOCK)
+    uint8_t  flags;                // MEASUREMENT_BLOCK_FLAG_*
+    uint16_t payload_size;         // Bytes following this header
+};
+#pragma pack(pop)
+
+static_assert(sizeof(MeasurementBlockHeader) == 4, "Unexpected MeasurementBlockHeader size");
+
+enum MeasurementBlockFlags : uint8_t {
+    MEASUREMENT_BLOCK_FLAG_RAW = 1 << 0,        // Payload is plain GrindMeasurement records (encoding did not pay off)
+    MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE = 1 << 1 // Not measurements: AdcCaptureEntry records (schema v6), count is entries
+};
+
+// Largest block on flash: header plus a full block stored raw
+constexpr size_t MEASUREMENT_BLOCK_MAX_SIZE = sizeof(MeasurementBlockHeader) +
+                                              GRIND_LOG_MEASUREMENTS_PER_BLOCK * sizeof(GrindMeasurement);
+
+/**
+ * Measurement block codec (session schema v4)
+ *
+ * A block stores its records column by column: timestamps, sample times and
+ * sequence ids as second differences, weights, flow and stop target as first
+ * differences, weight_delta as is, motor and phase as first differences. Every
+ * value is a zig-zag varint, so the smooth 50 Hz series mostly take one or two
+ * bytes per field instead of four. Gram quantities are quantized to
+ * GRIND_LOG_GRAMS_PER_LSB (0.1 mg, far below the load cell noise); non-finite
+ * values survive as NAN. A block that would not shrink is stored raw.
+ *
+ * encode_measurement_block() needs MEASUREMENT_BLOCK_MAX_SIZE bytes of output
+ * and returns the block size including its header.
+ */
+size_t encode_measurement_block(const GrindMeasurement* measurements, uint8_t count, uint8_t* out, size_t capacity);
+bool decode_measurement_block(const MeasurementBlockHeader& header, const uint8_t* payload, GrindMeasurement* out);
+
+// Raw ADC capture track (schema v6): ADC samples and motor edges in capture order
+#define GRIND_LOG_ADC_ENTRIES_PER_BLOCK 255         // Count field is a uint8_t
+
+enum AdcCaptureEntryType : uint8_t {
+    ADC_CAPTURE_SAMPLE = 0,        // value: raw ADC reading as CircularBufferMath received it
+    ADC_CAPTURE_MOTOR_EDGE = 1     // value: MotorEdgeType
+};
+
+struct AdcCaptureEntry {
+    uint32_t timestamp_us;         // µs relative to session start, same clock as GrindMeasurement::sample_timestamp_us
+    int32_t  value;
+    uint8_t  type;                 // AdcCaptureEntryType
+};
+
+/**
+ * ADC capture block codec
+ *
+ * Each entry is one zig-zag varint of (timestamp difference << 1 | type),
+ * followed by a varint of the raw value's difference to the previous sample
+ * (samples) or of the edge type (motor edges). A 320 SPS stream takes three
+ * to four bytes per sample. Blocks restart the predictors like measurement
+ * blocks and are never stored raw.
+ *
+ * decode_adc_capture_block() only validates the payload when out is null.
+ */
+size_t encode_adc_capture_block(const AdcCaptureEntry* entries, uint8_t count, uint8_t* out, size_t capacity);
+bool decode_adc_capture_block(const MeasurementBlockHeader& header, const uint8_t* payload, AdcCaptureEntry* out);
+
+// Validates any block of a schema >= GRIND_LOG_SCHEMA_MEASUREMENT_BLOCKS file (recovery scans)
+bool is_valid_session_block(const MeasurementBlockHeader& header, const uint8_t* payload, GrindMeasurement* scratch);
@@ -0,0 +1,58 @@
+#include "session_event_buffer.h"
+#include "grind_logging.h"
+#include <esp_heap_caps.h>
+
+bool SessionEventBuffer::allocate() {
+    if (!events) {
+        events = (GrindEvent*)heap_caps_malloc(GRIND_LOG_EVENT_CHUNK * sizeof(GrindEvent), MALLOC_CAP_SPIRAM);
+        allocated = events ? GRIND_LOG_EVENT_CHUNK : 0;
+    }
+    count = 0;
+    dropped_count = 0;
+    return events != nullptr;
+}
+
+void SessionEventBuffer::release() {
+    if (events) {
+        heap_caps_free(events);
+        events = nullptr;
+    }
+    count = 0;
+    allocated = 0;
+    dropped_count = 0;
+}
+
+bool SessionEventBuffer::push(const GrindEvent& event) {
+    if (!events) {
+        return false;
+    }
+    if (count == allocated) {
+        uint16_t grown = allocated + GRIND_LOG_EVENT_CHUNK;
+        GrindEvent* moved = grown <= GRIND_LOG_MAX_EVENTS
+            ? (GrindEvent*)heap_caps_realloc(events, grown * sizeof(GrindEvent), MALLOC_CAP_SPIRAM)
+            : nullptr;
+        if (!moved) {
+            if (dropped_count < UINT16_MAX) {
+                dropped_count++;
+            }
+            return false;
+        }
+        events = moved;
+        allocated = grown;
+    }
+    events[count++] = event;
+    return true;
+}
+
+void SessionEventBuffer::reset() {
+    if (events && allocated > GRIND_LOG_EVENT_CHUNK) {
+        // Shrinking in place does not fail; keep the old block if it somehow does
+        GrindEvent* shrunk = (GrindEvent*)heap_caps_realloc(events, GRIND_LOG_EVENT_CHUNK * sizeof(GrindEvent), MALLOC_CAP_SPIRAM);
+        if (shrunk) {
+            events = shrunk;
+            allocated = GRIND_LOG_EVENT_CHUNK;
+        }
+    }
+    count = 0;
+    dropped_count = 0;
+}
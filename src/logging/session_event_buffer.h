@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+struct GrindEvent;
+
+#define GRIND_LOG_EVENT_CHUNK 32                            // Events per PSRAM growth step (the buffer starts at one)
+#define GRIND_LOG_MAX_EVENTS 256                            // Hard cap per session; events past it are counted, not kept
+
+/**
+ * SessionEventBuffer - The active session's events, grown in PSRAM as they arrive
+ *
+ * Starts at GRIND_LOG_EVENT_CHUNK events and grows by that many (one
+ * heap_caps_realloc in PSRAM) when a push finds it full, so a short grind
+ * holds one chunk and a long multi-pulse or bulk session keeps every event up
+ * to GRIND_LOG_MAX_EVENTS. Events it cannot keep (cap reached, PSRAM
+ * exhausted) are counted in dropped() for GrindSession::events_dropped. The
+ * events stay one array, so the flush writes and summarizes them in one go.
+ *
+ * push() runs on Core 0 while the session logs; reset() and the readers run
+ * in FileIOTask while it does not.
+ */
+class SessionEventBuffer {
+public:
+    bool allocate();                        // First chunk
+    void release();
+    bool is_allocated() const { return events != nullptr; }
+
+    bool push(const GrindEvent& event);     // false = dropped (counted)
+    void reset();                           // Empty, shrunk back to one chunk
+
+    const GrindEvent* data() const { return events; }
+    uint16_t size() const { return count; }
+    uint16_t capacity() const { return allocated; }
+    uint16_t dropped() const { return dropped_count; }
+
+private:
+    GrindEvent* events = nullptr;
+    uint16_t count = 0;
+    uint16_t allocated = 0;
+    uint16_t dropped_count = 0;
+};
@@ -0,0 +1,74 @@
+#include "session_file.h"
+#include "session_log_partition.h"
+
+bool SessionFile::open(const char* path) {
+    close();
+    file = LittleFS.open(path, "r");
+    return (bool)file;
+}
+
+bool SessionFile::open(const SessionLogPartition* log_partition, uint32_t id) {
+    close();
+    if (!log_partition || !log_partition->get_session_size(id, &length)) {
+        return false;
+    }
+    partition = log_partition;
+    session_id = id;
+    return true;
+}
+
+void SessionFile::close() {
+    if (file) {
+        file.close();
+    }
+    partition = nullptr;
+    session_id = 0;
+    offset = 0;
+    length = 0;
+}
+
+size_t SessionFile::read(uint8_t* buffer, size_t count) {
+    if (!partition) {
+        return file ? file.read(buffer, count) : 0;
+    }
+    // A session spans records, so copy one record's run at a time
+    size_t copied = 0;
+    while (copied < count) {
+        uint32_t contiguous;
+        const uint8_t* data = partition->map_session(session_id, offset, &contiguous);
+        if (!data) {
+            break;
+        }
+        size_t chunk = min((size_t)contiguous, count - copied);
+        memcpy(buffer + copied, data, chunk);
+        copied += chunk;
+        offset += chunk;
+    }
+    return copied;
+}
+
+const uint8_t* SessionFile::map(uint32_t position, uint32_t* contiguous) const {
+    if (!partition || position >= length) {
+        return nullptr;
+    }
+    return partition->map_session(session_id, position, contiguous);
+}
+
+bool SessionFile::seek(uint32_t position) {
+    if (!partition) {
+        return file && file.seek(position);
+    }
+    if (position > length) {
+        return false;
+    }
+    offset = position;
+    return true;
+}
+
+size_t SessionFile::position() const {
+    return partition ? offset : (file ? file.position() : 0);
+}
+
+size_t SessionFile::size() const {
+    return partition ? length : (file ? file.size() : 0);
+}
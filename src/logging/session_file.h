@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+class SessionLogPartition;
+
+/**
+ * SessionFile - Sequential read access to one stored session file
+ *
+ * Wraps a LittleFS file, or a committed session in the session log partition,
+ * whose file image is copied straight out of the mapped flash. SessionReader
+ * reads both stores through it; map() hands out the partition bytes in place.
+ */
+class SessionFile {
+public:
+    bool open(const char* path);            // LittleFS
+    bool open(const SessionLogPartition* log_partition, uint32_t session_id);
+    void close();
+    explicit operator bool() const { return partition ? true : (bool)file; }
+
+    size_t read(uint8_t* buffer, size_t length);
+    const uint8_t* map(uint32_t position, uint32_t* contiguous) const; // Log partition only; nullptr for LittleFS
+    bool seek(uint32_t offset);
+    size_t position() const;
+    size_t size() const;
+
+private:
+    File file;
+    const SessionLogPartition* partition = nullptr;
+    uint32_t session_id = 0;
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
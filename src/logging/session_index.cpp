@@ -0,0 +1,285 @@
+#include "session_index.h"
+#include "grind_logging.h"
+#include "../system/memory_arena.h"
+#include <LittleFS.h>
+#include <algorithm>
+
+namespace {
+
+bool parse_session_file_name(const String& filename, uint32_t* session_id) {
+    String name = filename.substring(filename.lastIndexOf('/') + 1);
+    if (!name.startsWith("session_") || !name.endsWith(".bin")) {
+        return false;
+    }
+    *session_id = name.substring(8, name.length() - 4).toInt();
+    return *session_id > 0;
+}
+
+bool entry_less(const SessionIndexEntry& a, const SessionIndexEntry& b) {
+    return a.session_id < b.session_id;
+}
+
+}
+
+bool SessionIndex::read_session_file(uint32_t session_id, SessionIndexEntry* entry) {
+    char filename[64];
+    snprintf(filename, sizeof(filename), SESSION_FILE_FORMAT, (unsigned long)session_id);
+    File file = LittleFS.open(filename, "r");
+    if (!file) {
+        return false;
+    }
+
+    TimeSeriesSessionHeader header;
+    GrindSession session;
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.read((uint8_t*)&session, sizeof(session)) == sizeof(session);
+    uint32_t file_size = file.size();
+    file.close();
+
+    // Same sanity limits the export used to apply per file; files still being streamed are not indexed
+    if (!ok || header.session_id != session_id || header.session_size == 0 || header.session_size > 100000 ||
+        (header.schema_version >= GRIND_LOG_SCHEMA_STREAMED && (header.flags & SESSION_FILE_FLAG_OPEN))) {
+        return false;
+    }
+
+    fill_entry(header, session, file_size, entry);
+    return true;
+}
+
+void SessionIndex::fill_entry(const TimeSeriesSessionHeader& header, const GrindSession& session, uint32_t file_size,
+                              SessionIndexEntry* entry) {
+    memset(entry, 0, sizeof(*entry));
+    entry->session_id = header.session_id;
+    entry->session_timestamp = header.session_timestamp;
+    entry->file_size = file_size;
+    entry->total_time_ms = session.total_time_ms;
+    entry->event_count = header.event_count;
+    entry->measurement_count = header.measurement_count;
+    entry->target_weight = session.target_weight;
+    entry->final_weight = session.final_weight;
+    entry->error_grams = session.error_grams;
+    entry->profile_id = session.profile_id;
+    entry->grind_mode = session.grind_mode;
+    entry->termination_reason = session.termination_reason;
+    entry->pulse_count = session.pulse_count;
+}
+
+bool SessionIndex::load(ArenaScope& scope, SessionIndexEntry** entries, uint16_t* count, uint16_t spare) const {
+    *entries = nullptr;
+    *count = 0;
+
+    SessionIndexHeader header = {};
+    File file = LittleFS.open(GRIND_SESSION_INDEX_FILE, "r");
+    if (file && (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+                 header.magic != SESSION_INDEX_MAGIC || header.version != SESSION_INDEX_VERSION)) {
+        file.close();
+        return false;
+    }
+
+    uint16_t stored = file ? header.entry_count : 0;   // No index file yet: empty
+    SessionIndexEntry* list = scope.allocate_array<SessionIndexEntry>(stored + spare + 1);
+    bool ok = list != nullptr;
+    if (ok && stored > 0) {
+        size_t size = stored * sizeof(SessionIndexEntry);
+        ok = file.read((uint8_t*)list, size) == size;
+    }
+    if (file) {
+        file.close();
+    }
+    if (!ok) {
+        return false;
+    }
+    *entries = list;
+    *count = stored;
+    return true;
+}
+
+bool SessionIndex::save(const SessionIndexEntry* entries, uint16_t count) {
+    File file = LittleFS.open(GRIND_SESSION_INDEX_TEMP_FILE, "w");
+    if (!file) {
+        LOG_BLE("ERROR: Failed to open %s\n", GRIND_SESSION_INDEX_TEMP_FILE);
+        return false;
+    }
+
+    SessionIndexHeader header;
+    header.magic = SESSION_INDEX_MAGIC;
+    header.version = SESSION_INDEX_VERSION;
+    header.entry_count = count;
+    size_t size = count * sizeof(SessionIndexEntry);
+    bool written = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                   (size == 0 || file.write((const uint8_t*)entries, size) == size);
+    file.close();
+
+    // The rename replaces the old index in one step
+    if (!written || !LittleFS.rename(GRIND_SESSION_INDEX_TEMP_FILE, GRIND_SESSION_INDEX_FILE)) {
+        LittleFS.remove(GRIND_SESSION_INDEX_TEMP_FILE);
+        LOG_BLE("ERROR: Failed to write session index\n");
+        return false;
+    }
+    return true;
+}
+
+bool SessionIndex::verify() {
+    uint32_t file_count = 0;
+    File dir = LittleFS.open(GRIND_SESSIONS_DIR);
+    if (dir && dir.isDirectory()) {
+        File file = dir.openNextFile();
+        uint32_t session_id;
+        while (file) {
+            if (parse_session_file_name(file.name(), &session_id)) {
+                file_count++;
+            }
+            file = dir.openNextFile();
+        }
+        dir.close();
+    }
+
+    ArenaScope scope(file_arena);
+    SessionIndexEntry* entries;
+    uint16_t count;
+    if (load(scope, &entries, &count, 0)) {
+        if (count == file_count) {
+            return true;
+        }
+    }
+    LOG_BLE("Session index missing or stale (%lu files), rebuilding\n", (unsigned long)file_count);
+    return rebuild();
+}
+
+bool SessionIndex::rebuild() {
+    uint32_t capacity = 0;
+    File dir = LittleFS.open(GRIND_SESSIONS_DIR);
+    if (dir && dir.isDirectory()) {
+        File file = dir.openNextFile();
+        while (file) {
+            capacity++;
+            file = dir.openNextFile();
+        }
+        dir.rewindDirectory();
+    }
+    capacity = std::min<uint32_t>(capacity, UINT16_MAX);
+
+    ArenaScope scope(file_arena);
+    SessionIndexEntry* entries = scope.allocate_array<SessionIndexEntry>(capacity + 1);
+    if (!entries) {
+        if (dir) dir.close();
+        LOG_BLE("ERROR: Failed to allocate session index rebuild buffer\n");
+        return false;
+    }
+
+    uint16_t count = 0;
+    if (dir && dir.isDirectory()) {
+        File file = dir.openNextFile();
+        uint32_t session_id;
+        while (file && count < capacity) {
+            String filename = file.name();
+            file.close();
+            if (parse_session_file_name(filename, &session_id) && read_session_file(session_id, &entries[count])) {
+                count++;
+            }
+            file = dir.openNextFile();
+        }
+    }
+    if (dir) dir.close();
+
+    std::sort(entries, entries + count, entry_less);
+    bool saved = save(entries, count);
+    LOG_BLE("Session index rebuilt: %u sessions\n", (unsigned)count);
+    return saved;
+}
+
+bool SessionIndex::add_session_file(uint32_t session_id) {
+    SessionIndexEntry entry;
+    if (!read_session_file(session_id, &entry)) {
+        return false;
+    }
+
+    ArenaScope scope(file_arena);
+    SessionIndexEntry* entries;
+    uint16_t count;
+    if (!load(scope, &entries, &count, 1)) {
+        return rebuild();
+    }
+    SessionIndexEntry* slot = std::lower_bound(entries, entries + count, entry, entry_less);
+    if (slot == entries + count || slot->session_id != session_id) {
+        memmove(slot + 1, slot, (entries + count - slot) * sizeof(SessionIndexEntry));
+        count++;
+    }
+    *slot = entry;
+    bool saved = save(entries, count);
+    return saved;
+}
+
+bool SessionIndex::remove_sessions(const uint32_t* session_ids, uint32_t remove_count) {
+    ArenaScope scope(file_arena);
+    SessionIndexEntry* entries;
+    uint16_t count;
+    if (!load(scope, &entries, &count, 0)) {
+        return rebuild();
+    }
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (std::find(session_ids, session_ids + remove_count, entries[i].session_id) == session_ids + remove_count) {
+            entries[kept++] = entries[i];
+        }
+    }
+    bool saved = kept == count || save(entries, kept);
+    return saved;
+}
+
+bool SessionIndex::clear() {
+    return save(nullptr, 0);
+}
+
+uint32_t SessionIndex::get_session_count() const {
+    SessionIndexHeader header;
+    File file = LittleFS.open(GRIND_SESSION_INDEX_FILE, "r");
+    if (!file) {
+        return 0;
+    }
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == SESSION_INDEX_MAGIC && header.version == SESSION_INDEX_VERSION;
+    file.close();
+    return ok ? header.entry_count : 0;
+}
+
+void SessionIndex::get_totals(uint32_t* event_count, uint32_t* measurement_count) const {
+    *event_count = 0;
+    *measurement_count = 0;
+    ArenaScope scope(file_arena);
+    SessionIndexEntry* entries;
+    uint16_t count;
+    if (!load(scope, &entries, &count, 0)) {
+        return;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        *event_count += entries[i].event_count;
+        *measurement_count += entries[i].measurement_count;
+    }
+}
+
+uint32_t SessionIndex::get_session_ids(uint32_t* session_ids, uint32_t max_sessions) const {
+    ArenaScope scope(file_arena);
+    SessionIndexEntry* entries;
+    uint16_t count;
+    if (!session_ids || !load(scope, &entries, &count, 0)) {
+        return 0;
+    }
+    uint32_t copy_count = std::min<uint32_t>(count, max_sessions);
+    for (uint32_t i = 0; i < copy_count; i++) {
+        session_ids[i] = entries[i].session_id;
+    }
+    return copy_count;
+}
+
+uint32_t SessionIndex::get_entries(SessionIndexEntry* out, uint32_t max_entries) const {
+    ArenaScope scope(file_arena);
+    SessionIndexEntry* entries;
+    uint16_t count;
+    if (!out || !load(scope, &entries, &count, 0)) {
+        return 0;
+    }
+    uint32_t copy_count = std::min<uint32_t>(count, max_entries);
+    memcpy(out, entries, copy_count * sizeof(SessionIndexEntry));
+    return copy_count;
+}
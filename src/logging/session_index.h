@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+
+struct TimeSeriesSessionHeader;
+struct GrindSession;
+class ArenaScope;
+
+#define GRIND_SESSION_INDEX_FILE "/session_index.bin"       // Summary of every finalized session file
+#define GRIND_SESSION_INDEX_TEMP_FILE "/session_index.tmp"  // Written first, then renamed over the index
+
+constexpr uint32_t SESSION_INDEX_MAGIC = 0x58444953;        // "SIDX"
+constexpr uint16_t SESSION_INDEX_VERSION = 1;
+
+#pragma pack(push, 1)
+struct SessionIndexHeader {
+    uint32_t magic;                // SESSION_INDEX_MAGIC
+    uint16_t version;              // SESSION_INDEX_VERSION
+    uint16_t entry_count;          // SessionIndexEntry records that follow
+};
+
+// One finalized session: enough for counts, listings and rotation without opening its file
+struct SessionIndexEntry {
+    uint32_t session_id;
+    uint32_t session_timestamp;
+    uint32_t file_size;            // Session file size in bytes, header included
+    uint32_t total_time_ms;
+    uint16_t event_count;
+    uint16_t measurement_count;
+    float    target_weight;
+    float    final_weight;
+    float    error_grams;
+    uint8_t  profile_id;
+    uint8_t  grind_mode;
+    uint8_t  termination_reason;   // GrindTerminationReason
+    uint8_t  pulse_count;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SessionIndexHeader) == 8, "Unexpected SessionIndexHeader size");
+static_assert(sizeof(SessionIndexEntry) == 36, "Unexpected SessionIndexEntry size");
+
+/**
+ * SessionIndex - Compact index of the session files in GRIND_SESSIONS_DIR
+ *
+ * Counts, the export and BLE file lists, the debug table and rotation read
+ * this one small file instead of walking the directory and opening every
+ * session. Entries are sorted by session id. Each change writes the temp file
+ * and renames it over the index, so a reset leaves the old or the new index,
+ * never a torn one. verify() runs at boot and rebuilds the index from the
+ * session files when it is missing, damaged or lists a different number of
+ * files than the directory holds (a reset between a session write and its
+ * index update).
+ */
+class SessionIndex {
+public:
+    bool verify();
+    bool rebuild();
+
+    bool add_session_file(uint32_t session_id);                // Index a finalized file, replacing its old entry
+    bool remove_sessions(const uint32_t* session_ids, uint32_t count);
+    bool clear();
+
+    uint32_t get_session_count() const;
+    void get_totals(uint32_t* event_count, uint32_t* measurement_count) const;
+    uint32_t get_session_ids(uint32_t* session_ids, uint32_t max_sessions) const;     // Oldest first
+    uint32_t get_entries(SessionIndexEntry* entries, uint32_t max_entries) const;     // Oldest first
+
+    static void fill_entry(const TimeSeriesSessionHeader& header, const GrindSession& session, uint32_t file_size,
+                           SessionIndexEntry* entry);
+
+private:
+    // The stored entries plus `spare` free slots, valid until the caller's scope ends
+    bool load(ArenaScope& scope, SessionIndexEntry** entries, uint16_t* count, uint16_t spare) const;
+    bool save(const SessionIndexEntry* entries, uint16_t count);
+    static bool read_session_file(uint32_t session_id, SessionIndexEntry* entry);
+};
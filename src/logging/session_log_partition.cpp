@@ -0,0 +1,527 @@
+#include "session_log_partition.h"
+#include "grind_logging.h"
+#include "measurement_codec.h"
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+
+namespace {
+
+constexpr uint32_t SESSION_LOG_HEAD_SIZE = sizeof(TimeSeriesSessionHeader) + sizeof(GrindSession);
+static_assert(SESSION_LOG_HEAD_SIZE + sizeof(uint32_t) <= SESSION_LOG_RECORD_PAYLOAD, "COMMIT record does not fit");
+
+uint32_t record_crc(const SessionLogRecordHeader* header, const uint8_t* payload) {
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)header, offsetof(SessionLogRecordHeader, crc));
+    return esp_rom_crc32_le(crc, payload, header->length);
+}
+
+const uint8_t* record_payload(const SessionLogRecordHeader* header) {
+    return (const uint8_t*)(header + 1);
+}
+
+}
+
+bool SessionLogPartition::begin() {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)GRIND_LOG_PARTITION_SUBTYPE,
+                                         GRIND_LOG_PARTITION_LABEL);
+    if (!partition) {
+        return false;
+    }
+    slot_count = (partition->size / SESSION_LOG_SECTOR_SIZE) * SESSION_LOG_RECORDS_PER_SECTOR;
+
+    directory = (DirectoryEntry*)heap_caps_malloc(GRIND_LOG_PARTITION_MAX_SESSIONS * sizeof(DirectoryEntry), MALLOC_CAP_SPIRAM);
+    record = (uint8_t*)heap_caps_malloc(SESSION_LOG_RECORD_SIZE, MALLOC_CAP_8BIT);
+    pending = (uint8_t*)heap_caps_malloc(SESSION_LOG_MAX_OPEN_SESSIONS * SESSION_LOG_RECORD_PAYLOAD, MALLOC_CAP_8BIT);
+    const void* map_ptr = nullptr;
+    if (slot_count < 2 * SESSION_LOG_RECORDS_PER_SECTOR || !directory || !record || !pending ||
+        esp_partition_mmap(partition, 0, slot_count * SESSION_LOG_RECORD_SIZE, ESP_PARTITION_MMAP_DATA,
+                           &map_ptr, &mmap_handle) != ESP_OK) {
+        LOG_BLE("ERROR: Session log partition unusable, falling back to session files\n");
+        end();
+        return false;
+    }
+    mapped = (const uint8_t*)map_ptr;
+    for (uint8_t i = 0; i < SESSION_LOG_MAX_OPEN_SESSIONS; i++) {
+        open_sessions[i] = OpenSession{};
+        open_sessions[i].pending = pending + i * SESSION_LOG_RECORD_PAYLOAD;
+    }
+
+    scan();
+    LOG_BLE("Session log partition: %lu KB, %lu sessions, next record %lu\n",
+            (unsigned long)(partition->size / 1024), (unsigned long)directory_count, (unsigned long)head_sequence);
+    return true;
+}
+
+void SessionLogPartition::end() {
+    if (mapped) {
+        esp_partition_munmap(mmap_handle);
+        mapped = nullptr;
+    }
+    heap_caps_free(directory);
+    heap_caps_free(record);
+    heap_caps_free(pending);
+    directory = nullptr;
+    record = nullptr;
+    pending = nullptr;
+    directory_count = 0;
+    partition = nullptr;
+    for (uint8_t i = 0; i < SESSION_LOG_MAX_OPEN_SESSIONS; i++) {
+        open_sessions[i] = OpenSession{};
+    }
+}
+
+SessionLogPartition::OpenSession* SessionLogPartition::find_open(uint32_t session_id) {
+    for (uint8_t i = 0; i < SESSION_LOG_MAX_OPEN_SESSIONS; i++) {
+        if (open_sessions[i].sequence != NO_SEQUENCE && open_sessions[i].session_id == session_id) {
+            return &open_sessions[i];
+        }
+    }
+    return nullptr;
+}
+
+const SessionLogPartition::OpenSession* SessionLogPartition::find_open(uint32_t session_id) const {
+    return const_cast<SessionLogPartition*>(this)->find_open(session_id);
+}
+
+void SessionLogPartition::close_open(OpenSession* open) {
+    open->sequence = NO_SEQUENCE;
+    open->pending_length = 0;
+}
+
+const SessionLogRecordHeader* SessionLogPartition::record_at(uint32_t sequence) const {
+    return (const SessionLogRecordHeader*)(mapped + (sequence % slot_count) * SESSION_LOG_RECORD_SIZE);
+}
+
+bool SessionLogPartition::is_valid(uint32_t sequence) const {
+    const SessionLogRecordHeader* header = record_at(sequence);
+    return header->sequence == sequence && header->length <= SESSION_LOG_RECORD_PAYLOAD &&
+           header->crc == record_crc(header, record_payload(header));
+}
+
+bool SessionLogPartition::is_blank(uint32_t sequence) const {
+    const uint8_t* slot = (const uint8_t*)record_at(sequence);
+    for (uint32_t i = 0; i < SESSION_LOG_RECORD_SIZE; i++) {
+        if (slot[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SessionLogPartition::scan() {
+    // Bounds from the record headers alone; only a write cut by a reset can be torn, and only at the head
+    uint32_t newest = NO_SEQUENCE;
+    uint32_t oldest = NO_SEQUENCE;
+    for (uint32_t slot = 0; slot < slot_count; slot++) {
+        const SessionLogRecordHeader* header = (const SessionLogRecordHeader*)(mapped + slot * SESSION_LOG_RECORD_SIZE);
+        if (header->sequence == NO_SEQUENCE || header->sequence % slot_count != slot ||
+            header->length > SESSION_LOG_RECORD_PAYLOAD) {
+            continue;
+        }
+        if (newest == NO_SEQUENCE || header->sequence > newest) newest = header->sequence;
+        if (oldest == NO_SEQUENCE || header->sequence < oldest) oldest = header->sequence;
+    }
+    head_sequence = newest == NO_SEQUENCE ? 0 : newest + 1;
+    oldest_sequence = oldest == NO_SEQUENCE ? 0 : oldest;
+    if (newest != NO_SEQUENCE && !is_valid(newest)) {
+        head_sequence = newest;
+    }
+    // A torn slot cannot be programmed again before its sector is erased: continue in the next sector
+    if (head_sequence % SESSION_LOG_RECORDS_PER_SECTOR != 0 && !is_blank(head_sequence)) {
+        head_sequence += SESSION_LOG_RECORDS_PER_SECTOR - head_sequence % SESSION_LOG_RECORDS_PER_SECTOR;
+    }
+
+    // OPEN records not yet followed by their session's COMMIT or ABORT, oldest first
+    directory_count = 0;
+    uint32_t unclosed[SESSION_LOG_MAX_OPEN_SESSIONS] = {};
+    uint8_t unclosed_count = 0;
+    for (uint32_t sequence = oldest_sequence; sequence < head_sequence; sequence++) {
+        const SessionLogRecordHeader* header = record_at(sequence);
+        if (header->sequence != sequence || header->type == SESSION_LOG_RECORD_DATA || !is_valid(sequence)) {
+            continue;
+        }
+        if (header->type == SESSION_LOG_RECORD_CLEAR) {
+            directory_count = 0;
+            unclosed_count = 0;
+            continue;
+        }
+        if (header->type == SESSION_LOG_RECORD_COMMIT) {
+            add_directory_entry(sequence);
+        }
+        for (uint8_t i = 0; i < unclosed_count; i++) {
+            if (record_at(unclosed[i])->session_id == header->session_id) {
+                memmove(unclosed + i, unclosed + i + 1, (unclosed_count - i - 1) * sizeof(uint32_t));
+                unclosed_count--;
+                break;
+            }
+        }
+        if (header->type == SESSION_LOG_RECORD_OPEN) {
+            if (unclosed_count == SESSION_LOG_MAX_OPEN_SESSIONS) {
+                memmove(unclosed, unclosed + 1, (unclosed_count - 1) * sizeof(uint32_t));
+                unclosed_count--;
+            }
+            unclosed[unclosed_count++] = sequence;
+        }
+    }
+    for (uint8_t i = 0; i < unclosed_count; i++) {
+        recover_session(unclosed[i]);
+    }
+}
+
+bool SessionLogPartition::write_record(uint8_t type, uint32_t session_id, const uint8_t* payload, uint16_t length) {
+    if (!mapped || write_failed) {
+        return false;
+    }
+    const uint32_t slot = head_sequence % slot_count;
+    if (slot % SESSION_LOG_RECORDS_PER_SECTOR == 0) {
+        if (esp_partition_erase_range(partition, slot * SESSION_LOG_RECORD_SIZE, SESSION_LOG_SECTOR_SIZE) != ESP_OK) {
+            LOG_BLE("ERROR: Session log sector erase failed at record %lu\n", (unsigned long)head_sequence);
+            write_failed = true;
+            return false;
+        }
+        // The erased sector held the oldest records; sessions that started there are gone
+        if (head_sequence + SESSION_LOG_RECORDS_PER_SECTOR > slot_count) {
+            oldest_sequence = max(oldest_sequence, head_sequence + SESSION_LOG_RECORDS_PER_SECTOR - slot_count);
+        }
+        uint32_t dropped = 0;
+        while (dropped < directory_count && directory[dropped].first_sequence < oldest_sequence) {
+            dropped++;
+        }
+        if (dropped > 0) {
+            directory_count -= dropped;
+            memmove(directory, directory + dropped, directory_count * sizeof(DirectoryEntry));
+        }
+        for (uint8_t i = 0; i < SESSION_LOG_MAX_OPEN_SESSIONS; i++) {
+            if (open_sessions[i].sequence != NO_SEQUENCE && open_sessions[i].sequence < oldest_sequence) {
+                LOG_BLE("ERROR: Session %lu is larger than the session log\n", (unsigned long)open_sessions[i].session_id);
+                write_failed = true;
+                return false;
+            }
+        }
+    }
+
+    SessionLogRecordHeader* header = (SessionLogRecordHeader*)record;
+    memset(record, 0xFF, SESSION_LOG_RECORD_SIZE);
+    header->sequence = head_sequence;
+    header->session_id = session_id;
+    header->type = type;
+    header->reserved = 0;
+    header->length = length;
+    if (length > 0) {
+        memcpy(record + sizeof(SessionLogRecordHeader), payload, length);
+    }
+    header->crc = record_crc(header, record + sizeof(SessionLogRecordHeader));
+
+    if (esp_partition_write(partition, slot * SESSION_LOG_RECORD_SIZE, record, SESSION_LOG_RECORD_SIZE) != ESP_OK) {
+        LOG_BLE("ERROR: Session log write failed at record %lu\n", (unsigned long)head_sequence);
+        write_failed = true;
+        return false;
+    }
+    head_sequence++;
+    return true;
+}
+
+bool SessionLogPartition::open_session(const TimeSeriesSessionHeader& header, const GrindSession& session) {
+    abort_session(header.session_id);
+    OpenSession* open = nullptr;
+    for (uint8_t i = 0; i < SESSION_LOG_MAX_OPEN_SESSIONS && !open; i++) {
+        if (open_sessions[i].sequence == NO_SEQUENCE) {
+            open = &open_sessions[i];
+        }
+    }
+    if (!open) {
+        LOG_BLE("ERROR: Session %lu not opened: %d sessions are being written\n", (unsigned long)header.session_id,
+                SESSION_LOG_MAX_OPEN_SESSIONS);
+        return false;
+    }
+    write_failed = false;
+
+    uint8_t head[SESSION_LOG_HEAD_SIZE];
+    memcpy(head, &header, sizeof(header));
+    memcpy(head + sizeof(header), &session, sizeof(session));
+    uint32_t sequence = head_sequence;
+    if (!write_record(SESSION_LOG_RECORD_OPEN, header.session_id, head, sizeof(head))) {
+        return false;
+    }
+    open->sequence = sequence;
+    open->session_id = header.session_id;
+    open->pending_length = 0;
+    return true;
+}
+
+bool SessionLogPartition::append(uint32_t session_id, const uint8_t* data, size_t length) {
+    OpenSession* open = find_open(session_id);
+    if (!open || write_failed) {
+        return false;
+    }
+    // Only full DATA records until commit(), so a file offset maps to its record by counting
+    while (length > 0) {
+        size_t copy = min((size_t)(SESSION_LOG_RECORD_PAYLOAD - open->pending_length), length);
+        memcpy(open->pending + open->pending_length, data, copy);
+        open->pending_length += copy;
+        data += copy;
+        length -= copy;
+        if (open->pending_length == SESSION_LOG_RECORD_PAYLOAD && !flush_pending(open)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SessionLogPartition::flush_pending(OpenSession* open) {
+    if (open->pending_length == 0) {
+        return true;
+    }
+    bool written = write_record(SESSION_LOG_RECORD_DATA, open->session_id, open->pending, open->pending_length);
+    open->pending_length = 0;
+    return written;
+}
+
+bool SessionLogPartition::commit(const TimeSeriesSessionHeader& header, const GrindSession& session) {
+    OpenSession* open = find_open(header.session_id);
+    if (!open) {
+        return false;
+    }
+    uint8_t payload[SESSION_LOG_HEAD_SIZE + sizeof(uint32_t)];
+    memcpy(payload, &header, sizeof(header));
+    memcpy(payload + sizeof(header), &session, sizeof(session));
+    memcpy(payload + SESSION_LOG_HEAD_SIZE, &open->sequence, sizeof(open->sequence));
+
+    bool written = flush_pending(open);
+    uint32_t sequence = head_sequence;
+    written = written && write_record(SESSION_LOG_RECORD_COMMIT, open->session_id, payload, sizeof(payload));
+    if (written) {
+        add_directory_entry(sequence);
+    }
+    close_open(open);
+    return written;
+}
+
+void SessionLogPartition::abort_session(uint32_t session_id) {
+    OpenSession* open = find_open(session_id);
+    if (!open) {
+        return;
+    }
+    write_failed = false;
+    write_record(SESSION_LOG_RECORD_ABORT, open->session_id, nullptr, 0);
+    close_open(open);
+}
+
+bool SessionLogPartition::clear() {
+    if (!mapped) {
+        return false;
+    }
+    for (uint8_t i = 0; i < SESSION_LOG_MAX_OPEN_SESSIONS; i++) {
+        if (open_sessions[i].sequence != NO_SEQUENCE) {
+            abort_session(open_sessions[i].session_id);
+        }
+    }
+    write_failed = false;
+    // One record instead of erasing the partition; the ring overwrites the rest in time
+    bool written = write_record(SESSION_LOG_RECORD_CLEAR, 0, nullptr, 0);
+    if (written) {
+        directory_count = 0;
+    }
+    return written;
+}
+
+void SessionLogPartition::add_directory_entry(uint32_t commit_sequence) {
+    const SessionLogRecordHeader* commit_record = record_at(commit_sequence);
+    const uint8_t* payload = record_payload(commit_record);
+    TimeSeriesSessionHeader header;
+    GrindSession session;
+    uint32_t first_sequence;
+    memcpy(&header, payload, sizeof(header));
+    memcpy(&session, payload + sizeof(header), sizeof(session));
+    memcpy(&first_sequence, payload + SESSION_LOG_HEAD_SIZE, sizeof(first_sequence));
+
+    // The OPEN record and every DATA record the file image needs must still be in the ring
+    const uint32_t data_size = header.session_size > sizeof(GrindSession) ? header.session_size - sizeof(GrindSession) : 0;
+    const uint32_t data_records = (data_size + SESSION_LOG_RECORD_PAYLOAD - 1) / SESSION_LOG_RECORD_PAYLOAD;
+    if (commit_record->length < sizeof(header) + sizeof(session) + sizeof(first_sequence) ||
+        first_sequence < oldest_sequence || first_sequence + data_records >= commit_sequence ||
+        !is_valid(first_sequence) || record_at(first_sequence)->type != SESSION_LOG_RECORD_OPEN ||
+        record_at(first_sequence)->session_id != commit_record->session_id) {
+        return;
+    }
+
+    if (directory_count == GRIND_LOG_PARTITION_MAX_SESSIONS) {
+        directory_count--;
+        memmove(directory, directory + 1, directory_count * sizeof(DirectoryEntry));
+    }
+    DirectoryEntry& entry = directory[directory_count++];
+    SessionIndex::fill_entry(header, session, sizeof(header) + header.session_size, &entry.summary);
+    entry.first_sequence = first_sequence;
+    entry.commit_sequence = commit_sequence;
+}
+
+void SessionLogPartition::recover_session(uint32_t first_sequence) {
+    const SessionLogRecordHeader* open_record = record_at(first_sequence);
+    TimeSeriesSessionHeader header;
+    GrindSession session;
+    memcpy(&header, record_payload(open_record), sizeof(header));
+    memcpy(&session, record_payload(open_record) + sizeof(header), sizeof(session));
+
+    // DATA records that made it, in order; another grinder's session may have been written in between
+    uint32_t data_records = 0;
+    uint32_t last_data = first_sequence;
+    for (uint32_t sequence = first_sequence + 1; sequence < head_sequence; sequence++) {
+        const SessionLogRecordHeader* data = record_at(sequence);
+        if (!is_valid(sequence)) {
+            break;
+        }
+        if (data->session_id != open_record->session_id) {
+            continue;
+        }
+        if (data->type != SESSION_LOG_RECORD_DATA) {
+            break;
+        }
+        data_records++;
+        last_data = sequence;
+    }
+
+    // Keep every measurement block that decodes; the events were only to be written at the end
+    uint32_t data_size = data_records * SESSION_LOG_RECORD_PAYLOAD;
+    uint8_t* data = (uint8_t*)heap_caps_malloc(max(data_size, (uint32_t)1), MALLOC_CAP_SPIRAM);
+    GrindMeasurement* block = (GrindMeasurement*)heap_caps_malloc(GRIND_LOG_MEASUREMENTS_PER_BLOCK * sizeof(GrindMeasurement), MALLOC_CAP_8BIT);
+    uint16_t count = 0;
+    uint32_t size = 0;
+    uint32_t checksum = 0;
+    if (data && block) {
+        uint32_t copied = 0;
+        for (uint32_t sequence = first_sequence + 1; sequence <= last_data; sequence++) {
+            if (record_at(sequence)->session_id == open_record->session_id) {
+                memcpy(data + copied++ * SESSION_LOG_RECORD_PAYLOAD, record_payload(record_at(sequence)), SESSION_LOG_RECORD_PAYLOAD);
+            }
+        }
+        MeasurementBlockHeader block_header;
+        while (size + sizeof(block_header) <= data_size) {
+            memcpy(&block_header, data + size, sizeof(block_header));
+            if (block_header.payload_size > data_size - size - sizeof(block_header) ||
+                block_header.payload_size > MEASUREMENT_BLOCK_MAX_SIZE - sizeof(block_header) ||
+                block_header.measurement_count > UINT16_MAX - count ||
+                !is_valid_session_block(block_header, data + size + sizeof(block_header), block)) {
+                break;
+            }
+            if (!(block_header.flags & MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE)) {
+                count += block_header.measurement_count;
+            }
+            size += sizeof(block_header) + block_header.payload_size;
+        }
+        checksum = session_checksum_update(0, data, size);
+    }
+    heap_caps_free(data);
+    heap_caps_free(block);
+
+    OpenSession* open = &open_sessions[0];     // Recovery runs from begin(), before any session opens
+    open->sequence = first_sequence;
+    open->session_id = open_record->session_id;
+    open->pending_length = 0;
+    write_failed = false;
+    if (count == 0) {
+        abort_session(open->session_id);
+        LOG_BLE("Dropped interrupted session %lu (no usable measurements)\n", (unsigned long)header.session_id);
+        return;
+    }
+
+    header.session_size = sizeof(GrindSession) + size;
+    header.event_count = 0;
+    header.measurement_count = count;
+    header.flags = (header.flags & ~SESSION_FILE_FLAG_OPEN) | SESSION_FILE_FLAG_CHECKSUM;
+    snprintf(session.result_status, sizeof(session.result_status), "%s", "INTERRUPTED");
+    session.termination_reason = static_cast<uint8_t>(GrindTerminationReason::UNKNOWN);
+    header.checksum = session_checksum_update(checksum, &session, sizeof(session));
+    if (commit(header, session)) {
+        LOG_BLE("Recovered interrupted session %lu: %u measurements\n", (unsigned long)header.session_id, (unsigned)count);
+    }
+}
+
+const SessionLogPartition::DirectoryEntry* SessionLogPartition::find_session(uint32_t session_id) const {
+    // Newest first: an id reused after an NVS reset names the latest session
+    for (uint32_t i = directory_count; i > 0; i--) {
+        if (directory[i - 1].summary.session_id == session_id) {
+            return &directory[i - 1];
+        }
+    }
+    return nullptr;
+}
+
+void SessionLogPartition::get_totals(uint32_t* event_count, uint32_t* measurement_count) const {
+    *event_count = 0;
+    *measurement_count = 0;
+    for (uint32_t i = 0; i < directory_count; i++) {
+        *event_count += directory[i].summary.event_count;
+        *measurement_count += directory[i].summary.measurement_count;
+    }
+}
+
+uint32_t SessionLogPartition::get_session_ids(uint32_t* session_ids, uint32_t max_sessions) const {
+    if (!session_ids) {
+        return 0;
+    }
+    uint32_t copy_count = min(directory_count, max_sessions);
+    for (uint32_t i = 0; i < copy_count; i++) {
+        session_ids[i] = directory[i].summary.session_id;
+    }
+    return copy_count;
+}
+
+uint32_t SessionLogPartition::get_entries(SessionIndexEntry* entries, uint32_t max_entries) const {
+    if (!entries) {
+        return 0;
+    }
+    uint32_t copy_count = min(directory_count, max_entries);
+    for (uint32_t i = 0; i < copy_count; i++) {
+        entries[i] = directory[i].summary;
+    }
+    return copy_count;
+}
+
+bool SessionLogPartition::get_session_size(uint32_t session_id, uint32_t* size) const {
+    const DirectoryEntry* entry = find_session(session_id);
+    if (!entry) {
+        return false;
+    }
+    *size = entry->summary.file_size;
+    return true;
+}
+
+const uint8_t* SessionLogPartition::map_session(uint32_t session_id, uint32_t offset, uint32_t* contiguous) const {
+    const DirectoryEntry* entry = find_session(session_id);
+    if (!entry || offset >= entry->summary.file_size) {
+        return nullptr;
+    }
+
+    const uint8_t* data;
+    uint32_t available;
+    if (offset < SESSION_LOG_HEAD_SIZE) {
+        data = record_payload(record_at(entry->commit_sequence)) + offset;
+        available = SESSION_LOG_HEAD_SIZE - offset;
+    } else {
+        uint32_t data_offset = offset - SESSION_LOG_HEAD_SIZE;
+        uint32_t within = data_offset % SESSION_LOG_RECORD_PAYLOAD;
+        const SessionLogRecordHeader* data_record = find_data_record(*entry, data_offset / SESSION_LOG_RECORD_PAYLOAD);
+        if (!data_record || within >= data_record->length) {
+            return nullptr;
+        }
+        data = record_payload(data_record) + within;
+        available = data_record->length - within;
+    }
+    *contiguous = min(available, entry->summary.file_size - offset);
+    return data;
+}
+
+const SessionLogRecordHeader* SessionLogPartition::find_data_record(const DirectoryEntry& entry, uint32_t index) const {
+    const uint32_t data_size = entry.summary.file_size - SESSION_LOG_HEAD_SIZE;
+    const uint32_t data_records = (data_size + SESSION_LOG_RECORD_PAYLOAD - 1) / SESSION_LOG_RECORD_PAYLOAD;
+    if (entry.commit_sequence - entry.first_sequence - 1 == data_records) {
+        return record_at(entry.first_sequence + 1 + index);
+    }
+    // Written alongside another grinder's session: count this session's DATA records
+    for (uint32_t sequence = entry.first_sequence + 1; sequence < entry.commit_sequence; sequence++) {
+        const SessionLogRecordHeader* header = record_at(sequence);
+        if (header->type == SESSION_LOG_RECORD_DATA && header->session_id == entry.summary.session_id && index-- == 0) {
+            return header;
+        }
+    }
+    return nullptr;
+}
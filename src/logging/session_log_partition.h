@@ -0,0 +1,140 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../config/constants.h"
+#include "session_index.h"
+
+struct TimeSeriesSessionHeader;
+struct GrindSession;
+
+#define GRIND_LOG_PARTITION_LABEL "grindlog"                // Data partition in partitions.csv; LittleFS files without it
+#define GRIND_LOG_PARTITION_SUBTYPE 0x40                    // Custom data subtype, keeps the partition away from LittleFS/SPIFFS tooling
+
+#ifndef GRIND_LOG_PARTITION_MAX_SESSIONS
+#define GRIND_LOG_PARTITION_MAX_SESSIONS 2048               // Directory capacity (PSRAM, 44 bytes per session)
+#endif
+
+#define SESSION_LOG_MAX_OPEN_SESSIONS HW_GRINDER_CHANNELS   // Sessions written at once: one per grinder channel
+
+constexpr uint32_t SESSION_LOG_SECTOR_SIZE = 4096;          // Flash erase unit
+constexpr uint32_t SESSION_LOG_RECORD_SIZE = 256;           // Flash program page
+constexpr uint32_t SESSION_LOG_RECORDS_PER_SECTOR = SESSION_LOG_SECTOR_SIZE / SESSION_LOG_RECORD_SIZE;
+
+#pragma pack(push, 1)
+struct SessionLogRecordHeader {
+    uint32_t sequence;             // Records written since the last clear; the slot is sequence % slot count
+    uint32_t session_id;
+    uint8_t  type;                 // SessionLogRecordType
+    uint8_t  reserved;
+    uint16_t length;               // Payload bytes used
+    uint32_t crc;                  // CRC-32 of the fields above and the payload
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SessionLogRecordHeader) == 16, "Unexpected SessionLogRecordHeader size");
+
+constexpr uint32_t SESSION_LOG_RECORD_PAYLOAD = SESSION_LOG_RECORD_SIZE - sizeof(SessionLogRecordHeader);
+
+enum SessionLogRecordType : uint8_t {
+    SESSION_LOG_RECORD_OPEN = 1,   // Header and session as the grind started
+    SESSION_LOG_RECORD_DATA = 2,   // Next SESSION_LOG_RECORD_PAYLOAD bytes of the session file after header and session
+    SESSION_LOG_RECORD_COMMIT = 3, // Final header and session, then the sequence of the OPEN record
+    SESSION_LOG_RECORD_ABORT = 4,  // Ends a session that is not kept, so recovery leaves it alone
+    SESSION_LOG_RECORD_CLEAR = 5   // Every session before it is forgotten
+};
+
+/**
+ * SessionLogPartition - Session files as a ring of records on a raw data partition
+ *
+ * An alternative to one LittleFS file per session, used when partitions.csv has
+ * the GRIND_LOG_PARTITION_LABEL partition. Each session is an OPEN record, the
+ * bytes of its session file past header and session in full DATA records (only
+ * the last one partial), and a COMMIT record with the final header and session.
+ * Up to SESSION_LOG_MAX_OPEN_SESSIONS sessions (one per grinder) are written at
+ * once, each with its own partial DATA payload; their records interleave in the
+ * ring and are told apart by session id.
+ * Records are written with esp_partition_write() in sequence; entering a sector
+ * erases it, which drops the oldest sessions, so there is no count limit and no
+ * rotation pass. A record's CRC and its sequence matching its slot make it valid.
+ *
+ * begin() maps the whole partition and rebuilds the directory of committed
+ * sessions from their COMMIT records; a session a reset left without one is
+ * committed there with the measurement blocks that decode (result INTERRUPTED).
+ * Sessions are read in place through the mapping: a committed session's file
+ * image is the COMMIT head followed by its DATA payloads, so any offset maps to
+ * one record: directly when nothing was written between its OPEN and COMMIT but
+ * its own records, by counting its DATA records from the OPEN otherwise. ESP-IDF flushes the cache over written ranges, so the mapping
+ * stays current.
+ *
+ * Writes run in FileIOTask; export and BLE streaming read on Core 1 between
+ * grinds, as they do with session files.
+ */
+class SessionLogPartition {
+public:
+    bool begin();                           // Map the partition and rebuild the directory; false without one
+    void end();
+    bool is_active() const { return mapped != nullptr; }
+
+    bool open_session(const TimeSeriesSessionHeader& header, const GrindSession& session);
+    bool append(uint32_t session_id, const uint8_t* data, size_t length);
+    bool commit(const TimeSeriesSessionHeader& header, const GrindSession& session);
+    void abort_session(uint32_t session_id);   // Written records stay behind as garbage without a COMMIT
+    bool is_session_open(uint32_t session_id) const { return find_open(session_id) != nullptr; }
+    bool clear();
+
+    // Same queries as SessionIndex, oldest session first
+    uint32_t get_session_count() const { return directory_count; }
+    void get_totals(uint32_t* event_count, uint32_t* measurement_count) const;
+    uint32_t get_session_ids(uint32_t* session_ids, uint32_t max_sessions) const;
+    uint32_t get_entries(SessionIndexEntry* entries, uint32_t max_entries) const;
+
+    // Committed session's file image: size, and zero-copy access to the bytes at offset
+    bool get_session_size(uint32_t session_id, uint32_t* size) const;
+    const uint8_t* map_session(uint32_t session_id, uint32_t offset, uint32_t* contiguous) const;
+
+private:
+    static constexpr uint32_t NO_SEQUENCE = 0xFFFFFFFF;
+
+    struct DirectoryEntry {
+        SessionIndexEntry summary;
+        uint32_t first_sequence;            // OPEN record
+        uint32_t commit_sequence;           // COMMIT record
+    };
+
+    const esp_partition_t* partition = nullptr;
+    esp_partition_mmap_handle_t mmap_handle = 0;
+    const uint8_t* mapped = nullptr;
+    uint32_t slot_count = 0;
+    uint32_t head_sequence = 0;             // Next record to write
+    uint32_t oldest_sequence = 0;           // Oldest record not yet erased
+
+    struct OpenSession {
+        uint32_t sequence = NO_SEQUENCE;    // OPEN record, NO_SEQUENCE while the slot is free
+        uint32_t session_id = 0;
+        uint8_t* pending = nullptr;         // Partial DATA payload
+        uint16_t pending_length = 0;
+    };
+
+    DirectoryEntry* directory = nullptr;    // Committed sessions in log order (PSRAM)
+    uint32_t directory_count = 0;
+
+    uint8_t* record = nullptr;              // Record being assembled for esp_partition_write()
+    uint8_t* pending = nullptr;             // SESSION_LOG_MAX_OPEN_SESSIONS partial DATA payloads
+    OpenSession open_sessions[SESSION_LOG_MAX_OPEN_SESSIONS];
+    bool write_failed = false;
+
+    OpenSession* find_open(uint32_t session_id);
+    const OpenSession* find_open(uint32_t session_id) const;
+    void close_open(OpenSession* open);
+    const SessionLogRecordHeader* record_at(uint32_t sequence) const;
+    bool is_valid(uint32_t sequence) const;
+    bool is_blank(uint32_t sequence) const;
+    bool write_record(uint8_t type, uint32_t session_id, const uint8_t* payload, uint16_t length);
+    bool flush_pending(OpenSession* open);
+    const SessionLogRecordHeader* find_data_record(const DirectoryEntry& entry, uint32_t index) const;
+    void add_directory_entry(uint32_t commit_sequence);
+    const DirectoryEntry* find_session(uint32_t session_id) const;
+    void scan();
+    void recover_session(uint32_t first_sequence);
+};
@@ -0,0 +1,141 @@
+#include "session_query.h"
+#include "grind_logging.h"
+#include <esp_heap_caps.h>
+#include <math.h>
+
+extern GrindLogger grind_logger;
+
+uint32_t session_query_limit(const SessionQuery& query) {
+    if (query.max_results == 0 || query.max_results > SESSION_QUERY_MAX_RESULTS) {
+        return SESSION_QUERY_MAX_RESULTS;
+    }
+    return query.max_results;
+}
+
+bool session_query_matches(const SessionQuery& query, const SessionQueryRecord& record) {
+    if (query.first_session_id != 0 && record.session_id < query.first_session_id) {
+        return false;
+    }
+    if (query.last_session_id != 0 && record.session_id > query.last_session_id) {
+        return false;
+    }
+    if (query.profile_id != SESSION_QUERY_ANY && record.profile_id != query.profile_id) {
+        return false;
+    }
+    if (query.grind_mode != SESSION_QUERY_ANY && record.grind_mode != query.grind_mode) {
+        return false;
+    }
+    if (query.result_mask != 0) {
+        uint8_t bit = record.termination_reason < 7 ? (uint8_t)(1u << record.termination_reason) : 0x80;
+        if ((query.result_mask & bit) == 0) {
+            return false;
+        }
+    }
+    // NaN bounds are open; a NaN error fails any bound that is set
+    if (!isnan(query.min_error_grams) && !(record.error_grams >= query.min_error_grams)) {
+        return false;
+    }
+    if (!isnan(query.max_error_grams) && !(record.error_grams <= query.max_error_grams)) {
+        return false;
+    }
+    if ((query.flags & SESSION_QUERY_FLAG_STORED) && !(record.flags & SESSION_QUERY_RECORD_STORED)) {
+        return false;
+    }
+    return true;
+}
+
+void fill_session_query_record(const SessionIndexEntry* entry, const SessionSummary* summary, SessionQueryRecord* out) {
+    memset(out, 0, sizeof(*out));
+    out->mean_flow_g_per_s = NAN;
+    out->coast_grams = NAN;
+    if (summary) {
+        out->session_id = summary->session_id;
+        out->session_timestamp = summary->session_timestamp;
+        out->target_weight = summary->target_weight;
+        out->error_grams = summary->error_grams;
+        out->mean_flow_g_per_s = summary->mean_flow_g_per_s;
+        out->coast_grams = summary->coast_grams;
+        out->latency_ms = summary->latency_ms;
+        out->final_settle_ms = summary->final_settle_ms;
+        out->total_time_ds = summary->total_time_ds;
+        out->pulse_count = summary->pulse_count;
+        out->termination_reason = summary->termination_reason;
+        out->profile_id = summary->profile_id;
+        out->grind_mode = summary->grind_mode;
+        out->flags |= SESSION_QUERY_RECORD_SUMMARY;
+    }
+    if (entry) {
+        if (!summary) {
+            out->session_id = entry->session_id;
+            out->session_timestamp = entry->session_timestamp;
+            out->target_weight = entry->target_weight;
+            out->error_grams = entry->error_grams;
+            uint32_t time_ds = entry->total_time_ms / 100;
+            out->total_time_ds = time_ds > UINT16_MAX ? UINT16_MAX : (uint16_t)time_ds;
+            out->pulse_count = entry->pulse_count;
+            out->termination_reason = entry->termination_reason;
+            out->profile_id = entry->profile_id;
+            out->grind_mode = entry->grind_mode;
+        }
+        out->file_size = entry->file_size;
+        out->flags |= SESSION_QUERY_RECORD_STORED;
+    }
+}
+
+uint32_t run_session_query(const SessionQuery& query, SessionQueryRecord* records, uint32_t max_records,
+                           uint32_t* matched) {
+    *matched = 0;
+    if (!records) {
+        return 0;
+    }
+
+    // The partition can list more sessions than the file arena holds, so the index copy goes to PSRAM
+    uint32_t capacity = grind_logger.get_total_flash_sessions();
+    SessionIndexEntry* entries = nullptr;
+    uint32_t entry_count = 0;
+    if (capacity > 0) {
+        entries = (SessionIndexEntry*)heap_caps_malloc(capacity * sizeof(SessionIndexEntry), MALLOC_CAP_SPIRAM);
+        if (!entries) {
+            LOG_BLE("ERROR: Session query could not allocate the index (%lu sessions)\n", (unsigned long)capacity);
+            return 0;
+        }
+        entry_count = grind_logger.get_session_entries(entries, capacity);
+    }
+
+    // Both sources are in session id order: merge them from the newest end
+    const SessionSummaryTable& table = grind_logger.get_session_summaries();
+    uint32_t summary_count = table.is_ready() ? table.get_count() : 0;
+    uint32_t age = 0;
+    SessionSummary summary;
+    bool have_summary = age < summary_count && table.get_latest(age, &summary);
+    uint32_t next_entry = entry_count;
+    uint32_t count = 0;
+
+    while (have_summary || next_entry > 0) {
+        const SessionIndexEntry* entry = next_entry > 0 ? &entries[next_entry - 1] : nullptr;
+        bool use_summary = have_summary && (!entry || summary.session_id >= entry->session_id);
+        bool use_entry = entry && (!have_summary || entry->session_id >= summary.session_id);
+
+        SessionQueryRecord record;
+        fill_session_query_record(use_entry ? entry : nullptr, use_summary ? &summary : nullptr, &record);
+        if (use_entry) {
+            next_entry--;
+        }
+        if (use_summary) {
+            have_summary = ++age < summary_count && table.get_latest(age, &summary);
+        }
+
+        if (query.first_session_id != 0 && record.session_id < query.first_session_id) {
+            break;                              // Everything further on is older still
+        }
+        if (session_query_matches(query, record)) {
+            if (count < max_records) {
+                records[count++] = record;
+            }
+            (*matched)++;
+        }
+    }
+
+    heap_caps_free(entries);
+    return count;
+}
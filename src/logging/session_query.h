@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Arduino.h>
+
+struct SessionIndexEntry;
+struct SessionSummary;
+
+#define SESSION_QUERY_MAX_RESULTS 256                       // Records or sessions per query reply, newest matches kept
+#define SESSION_QUERY_ANY 0xFF                              // profile_id / grind_mode wildcard
+
+// SessionQuery::flags
+#define SESSION_QUERY_FLAG_SESSIONS 0x01                    // Reply with the matching session files (batch framing)
+#define SESSION_QUERY_FLAG_STORED 0x02                      // Only sessions whose file is still stored
+
+// SessionQueryRecord::flags
+#define SESSION_QUERY_RECORD_STORED 0x01                    // The session file can still be exported
+#define SESSION_QUERY_RECORD_SUMMARY 0x02                   // Flow, coast, latency and settle come from the summary table
+
+constexpr uint32_t SESSION_QUERY_MAGIC = 0x59525147;        // "GQRY"
+constexpr uint8_t SESSION_QUERY_VERSION = 1;
+
+#pragma pack(push, 1)
+// Filter sent by the host, little-endian; every condition set must hold
+struct SessionQuery {
+    uint8_t  flags;                // SESSION_QUERY_FLAG_*
+    uint8_t  profile_id;           // SESSION_QUERY_ANY or GrindSession::profile_id
+    uint8_t  grind_mode;           // SESSION_QUERY_ANY or GrindMode
+    uint8_t  result_mask;          // Bit n: GrindTerminationReason n, bit 7: UNKNOWN; 0 = any result
+    uint32_t first_session_id;     // Inclusive; 0 = from the oldest
+    uint32_t last_session_id;      // Inclusive; 0 = up to the newest
+    float    min_error_grams;      // NAN = no bound; sessions without an error never match a bound
+    float    max_error_grams;
+    uint16_t max_results;          // 0 = SESSION_QUERY_MAX_RESULTS; the newest matches are kept
+    uint16_t reserved;
+};
+
+// Reply to a record query: this header, then `count` records, newest first
+struct SessionQueryReplyHeader {
+    uint32_t magic;                // SESSION_QUERY_MAGIC
+    uint8_t  version;              // SESSION_QUERY_VERSION
+    uint8_t  record_size;          // sizeof(SessionQueryRecord)
+    uint16_t count;
+    uint32_t matched;              // Matching sessions, more than count when max_results cut the reply
+};
+
+// One session as the session index and the summary table know it
+struct SessionQueryRecord {
+    uint32_t session_id;
+    uint32_t session_timestamp;
+    float    target_weight;
+    float    error_grams;
+    float    mean_flow_g_per_s;    // NAN without a summary
+    float    coast_grams;          // NAN without a summary
+    uint32_t file_size;            // 0 when the file was rotated out
+    uint16_t latency_ms;
+    uint16_t final_settle_ms;
+    uint16_t total_time_ds;        // Session runtime, 0.1 s
+    uint8_t  pulse_count;
+    uint8_t  termination_reason;   // GrindTerminationReason
+    uint8_t  profile_id;
+    uint8_t  grind_mode;
+    uint8_t  flags;                // SESSION_QUERY_RECORD_*
+    uint8_t  reserved;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SessionQuery) == 24, "Unexpected SessionQuery size");
+static_assert(sizeof(SessionQueryReplyHeader) == 12, "Unexpected SessionQueryReplyHeader size");
+static_assert(sizeof(SessionQueryRecord) == 40, "Unexpected SessionQueryRecord size");
+
+/**
+ * Session queries - "which sessions" answered on the device
+ *
+ * Analysis usually wants a slice of the history (one profile's overshoots, the
+ * sessions since a given id, a summary table without the measurements), so
+ * the host sends a SessionQuery instead of pulling every session file and
+ * filtering afterwards. run_session_query() walks the session index (stored
+ * files) and the SessionSummaryTable (outcomes, kept after rotation) together,
+ * newest first, merging the two by session id, and keeps the newest
+ * max_results matches. Session ids increase with every grind and survive
+ * reboots, so they are the time axis: session_timestamp is seconds since boot.
+ *
+ * BLE_DATA_CMD_QUERY_SESSIONS sends the reply header and records, or with
+ * SESSION_QUERY_FLAG_SESSIONS streams the matching stored files in the batch
+ * framing (oldest first). MQTT cmd/query publishes the records on query.
+ */
+uint32_t run_session_query(const SessionQuery& query, SessionQueryRecord* records, uint32_t max_records,
+                           uint32_t* matched);
+uint32_t session_query_limit(const SessionQuery& query);     // max_results, defaulted and capped
+bool session_query_matches(const SessionQuery& query, const SessionQueryRecord& record);
+void fill_session_query_record(const SessionIndexEntry* entry, const SessionSummary* summary, SessionQueryRecord* out);
@@ -0,0 +1,197 @@
+#include "session_reader.h"
+#include "measurement_codec.h"
+#include <esp_heap_caps.h>
+
+bool SessionReader::open(const char* path) {
+    close();
+    return file.open(path) && load();
+}
+
+bool SessionReader::open(const SessionLogPartition* log_partition, uint32_t session_id) {
+    close();
+    return file.open(log_partition, session_id) && load();
+}
+
+bool SessionReader::load() {
+    if (file.read((uint8_t*)&file_header, sizeof(file_header)) != sizeof(file_header) ||
+        file.read((uint8_t*)&file_session, sizeof(file_session)) != sizeof(file_session)) {
+        close();
+        return false;
+    }
+    opened = true;
+    return true;
+}
+
+void SessionReader::close() {
+    if (block) {
+        heap_caps_free(block);
+        block = nullptr;
+    }
+    if (payload) {
+        heap_caps_free(payload);
+        payload = nullptr;
+    }
+    file.close();
+    opened = false;
+    block_count = 0;
+    next_block_first = 0;
+    next_block_offset = 0;
+}
+
+bool SessionReader::seek_to(uint32_t offset) {
+    // In-order reads are already there; skip the seek
+    return file.position() == offset || file.seek(offset);
+}
+
+bool SessionReader::verify_checksum() {
+    if (!opened) {
+        return false;
+    }
+    if (!(file_header.flags & SESSION_FILE_FLAG_CHECKSUM)) {
+        return true;
+    }
+    uint8_t chunk[256];
+    uint32_t remaining = file_header.session_size - sizeof(GrindSession);
+    uint32_t checksum = 0;
+    if (!seek_to(sizeof(TimeSeriesSessionHeader) + sizeof(GrindSession))) {
+        return false;
+    }
+    while (remaining > 0) {
+        size_t length = min(remaining, (uint32_t)sizeof(chunk));
+        if (file.read(chunk, length) != length) {
+            return false;
+        }
+        checksum = session_checksum_update(checksum, chunk, length);
+        remaining -= length;
+    }
+    return session_checksum_update(checksum, &file_session, sizeof(file_session)) == file_header.checksum;
+}
+
+bool SessionReader::read_event(uint16_t index, GrindEvent* out) {
+    if (!opened || !out || index >= file_header.event_count) {
+        return false;
+    }
+    return seek_to(session_file_events_offset(file_header) + index * sizeof(GrindEvent)) &&
+           file.read((uint8_t*)out, sizeof(GrindEvent)) == sizeof(GrindEvent);
+}
+
+bool SessionReader::read_measurement(uint16_t index, GrindMeasurement* out) {
+    if (!opened || !out || index >= file_header.measurement_count) {
+        return false;
+    }
+
+    if (file_header.schema_version < GRIND_LOG_SCHEMA_MEASUREMENT_BLOCKS) {
+        // Older schemas store a shorter record; zero-extend to the current layout
+        const size_t record_size = grind_measurement_record_size(file_header.schema_version);
+        *out = GrindMeasurement();
+        return seek_to(session_file_measurements_offset(file_header) + index * record_size) &&
+               file.read((uint8_t*)out, record_size) == record_size;
+    }
+
+    if (block_count == 0 || index < block_first || index >= block_first + block_count) {
+        if (!load_block(index)) {
+            next_block_offset = 0;  // Rescan from the first block next time
+            LOG_BLE("ERROR: Damaged measurement block in session %lu (record %u of %u)\n",
+                    (unsigned long)file_header.session_id, (unsigned)index, (unsigned)file_header.measurement_count);
+            return false;
+        }
+    }
+    *out = block[index - block_first];
+    return true;
+}
+
+bool SessionReader::load_block(uint16_t index) {
+    if (!block) {
+        block = (GrindMeasurement*)heap_caps_malloc(GRIND_LOG_MEASUREMENTS_PER_BLOCK * sizeof(GrindMeasurement), MALLOC_CAP_8BIT);
+        payload = (uint8_t*)heap_caps_malloc(MEASUREMENT_BLOCK_MAX_SIZE, MALLOC_CAP_8BIT);
+        if (!block || !payload) {
+            LOG_BLE("ERROR: Failed to allocate measurement block buffers\n");
+            return false;
+        }
+    }
+
+    // Blocks only chain forward; an earlier record means starting over
+    if (next_block_offset == 0 || index < next_block_first) {
+        next_block_offset = session_file_measurements_offset(file_header);
+        next_block_first = 0;
+    }
+    block_count = 0;
+
+    MeasurementBlockHeader header;
+    while (true) {
+        if (!seek_to(next_block_offset) ||
+            file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+            header.payload_size > MEASUREMENT_BLOCK_MAX_SIZE - sizeof(header)) {
+            return false;
+        }
+        uint32_t payload_offset = next_block_offset + sizeof(header);
+        next_block_offset = payload_offset + header.payload_size;
+        if (header.flags & MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE) {
+            continue;   // Capture track, not measurements
+        }
+        if (header.measurement_count == 0 ||
+            next_block_first + header.measurement_count > file_header.measurement_count) {
+            return false;
+        }
+        uint16_t first = next_block_first;
+        next_block_first += header.measurement_count;
+        if (index >= next_block_first) {
+            continue;   // Only the header is read for blocks before the target
+        }
+        if (file.read(payload, header.payload_size) != header.payload_size ||
+            !decode_measurement_block(header, payload, block)) {
+            return false;
+        }
+        block_first = first;
+        block_count = header.measurement_count;
+        return true;
+    }
+}
+
+bool SessionReader::read_adc_block(uint32_t* offset, AdcCaptureEntry* out, uint8_t* count) {
+    if (!opened || !offset || !out || !count || file_header.schema_version < GRIND_LOG_SCHEMA_ADC_CAPTURE) {
+        return false;
+    }
+    if (!payload) {
+        payload = (uint8_t*)heap_caps_malloc(MEASUREMENT_BLOCK_MAX_SIZE, MALLOC_CAP_8BIT);
+        if (!payload) {
+            LOG_BLE("ERROR: Failed to allocate measurement block buffers\n");
+            return false;
+        }
+    }
+    if (*offset == 0) {
+        *offset = session_file_measurements_offset(file_header);
+    }
+
+    const uint32_t blocks_end = session_file_events_offset(file_header);
+    MeasurementBlockHeader header;
+    while (*offset + sizeof(header) <= blocks_end) {
+        if (!seek_to(*offset) ||
+            file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+            header.payload_size > MEASUREMENT_BLOCK_MAX_SIZE - sizeof(header)) {
+            return false;
+        }
+        *offset += sizeof(header) + header.payload_size;
+        if (!(header.flags & MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE)) {
+            continue;
+        }
+        if (file.read(payload, header.payload_size) != header.payload_size ||
+            !decode_adc_capture_block(header, payload, out)) {
+            return false;
+        }
+        *count = header.measurement_count;
+        return true;
+    }
+    return false;
+}
+
+size_t SessionReader::read_bytes(uint32_t offset, uint8_t* buffer, size_t length) {
+    if (!opened || !buffer || !seek_to(offset)) {
+        return 0;
+    }
+    return file.read(buffer, length);
+}
+
+const uint8_t* SessionReader::map_bytes(uint32_t offset, uint32_t* length) const {
+    return opened ? file.map(offset, length) : nullptr;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include "grind_logging.h"
+#include "session_file.h"
+
+/**
+ * SessionReader - Lazy access to one stored session, for any schema
+ *
+ * open() reads only the header and session summary. Events and measurements
+ * are read on demand by record index, straight from the SessionFile (LittleFS
+ * file or mapped log partition), so a session is never loaded whole. Events and
+ * raw measurement records (v2 zero-extended, v3) are fixed size and found by
+ * offset. Encoded blocks (v4+) are decoded one at a time into a heap buffer:
+ * reading forward walks the block headers from the current block, reading
+ * backwards restarts at the first block, so in-order reads cost one decode per
+ * block. ADC capture blocks (v6) are skipped there; read_adc_block() walks
+ * them in file order instead.
+ *
+ * Because every read names its position, a caller can stop anywhere and
+ * resume later from its indices (BLE export) or file offset (BLE file
+ * streaming). Open sessions through GrindLogger::open_session().
+ */
+class SessionReader {
+public:
+    ~SessionReader() { close(); }
+
+    bool open(const char* path);            // LittleFS
+    bool open(const SessionLogPartition* log_partition, uint32_t session_id);
+    void close();
+    bool is_open() const { return opened; }
+
+    const TimeSeriesSessionHeader& header() const { return file_header; }
+    const GrindSession& session() const { return file_session; }
+    uint32_t size() const { return file.size(); }   // Whole file image, header included
+
+    bool verify_checksum();                 // Recompute a SESSION_FILE_FLAG_CHECKSUM CRC; true without the flag
+    bool read_event(uint16_t index, GrindEvent* out);
+    bool read_measurement(uint16_t index, GrindMeasurement* out);   // False past the end or on a damaged block
+    // Next ADC capture block at or after *offset (0: the first), which moves past it. out holds
+    // GRIND_LOG_ADC_ENTRIES_PER_BLOCK entries; false at the end, on a damaged block or before schema v6
+    bool read_adc_block(uint32_t* offset, AdcCaptureEntry* out, uint8_t* count);
+    size_t read_bytes(uint32_t offset, uint8_t* buffer, size_t length);  // File image as stored
+    const uint8_t* map_bytes(uint32_t offset, uint32_t* length) const;  // The same in place (log partition), else nullptr
+
+private:
+    SessionFile file;
+    TimeSeriesSessionHeader file_header;
+    GrindSession file_session;
+    bool opened = false;
+
+    // Block cursor (v4+)
+    GrindMeasurement* block = nullptr;      // Decoded block
+    uint8_t* payload = nullptr;             // Encoded block as read from the file
+    uint16_t block_first = 0;               // Index of block[0]
+    uint8_t block_count = 0;                // 0 = nothing decoded
+    uint16_t next_block_first = 0;          // Index of the first record after the cursor
+    uint32_t next_block_offset = 0;         // File offset of the next block header
+
+    bool load();
+    bool seek_to(uint32_t offset);
+    bool load_block(uint16_t index);        // Decode the block holding measurement index
+};
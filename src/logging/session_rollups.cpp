@@ -0,0 +1,186 @@
+#include "session_rollups.h"
+#include "session_summary.h"
+#include "grind_logging.h"
+#include "../controllers/grind_mode.h"
+#include <esp_timer.h>
+#include <math.h>
+#include <string.h>
+
+SessionRollups session_rollups;
+
+SessionRollups::SessionRollups() {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+uint32_t SessionRollups::uptime_s() {
+    return (uint32_t)(esp_timer_get_time() / 1000000);     // millis() would wrap after 49 days
+}
+
+uint32_t SessionRollups::period_seconds(SessionRollupPeriod period) {
+    return period == SessionRollupPeriod::DAY ? 86400 : 3600;
+}
+
+void SessionRollups::add_session(const SessionSummary& summary, float final_weight_g) {
+    // Counted in the period it ends in: the open one, once ended periods are closed
+    uint32_t now_s = uptime_s();
+    bool weight_mode = summary.grind_mode == (uint8_t)GrindMode::WEIGHT;
+    GrindTerminationReason reason = (GrindTerminationReason)summary.termination_reason;
+
+    portENTER_CRITICAL(&lock);
+    update_locked(now_s);
+    for (Accumulator& accumulator : open) {
+        if (accumulator.grinds < UINT16_MAX) {
+            accumulator.grinds++;
+        }
+        accumulator.ground_g += final_weight_g > 0.0f ? final_weight_g : 0.0f;
+        accumulator.time_sum_s += summary.total_time_ds / 10.0f;
+        uint32_t pulses = (uint32_t)accumulator.pulses + summary.pulse_count;
+        accumulator.pulses = pulses > UINT16_MAX ? UINT16_MAX : (uint16_t)pulses;
+        if (weight_mode && !isnan(summary.error_grams) && accumulator.weight_grinds < UINT16_MAX) {
+            accumulator.weight_grinds++;
+            accumulator.error_sum_g += summary.error_grams;
+            accumulator.abs_error.add(fabsf(summary.error_grams));
+        }
+        if (reason == GrindTerminationReason::TIMEOUT || reason == GrindTerminationReason::PROJECTED_TIMEOUT) {
+            accumulator.timeouts = add_saturated(accumulator.timeouts);
+        } else if (reason == GrindTerminationReason::OVERSHOOT) {
+            accumulator.overshoots = add_saturated(accumulator.overshoots);
+        } else if (reason == GrindTerminationReason::FLOW_STALLED || reason == GrindTerminationReason::FLOW_UNSTABLE) {
+            accumulator.flow_faults = add_saturated(accumulator.flow_faults);
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void SessionRollups::add_diagnostic() {
+    uint32_t now_s = uptime_s();
+    portENTER_CRITICAL(&lock);
+    update_locked(now_s);
+    for (Accumulator& accumulator : open) {
+        accumulator.diagnostics = add_saturated(accumulator.diagnostics);
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void SessionRollups::update() {
+    uint32_t now_s = uptime_s();
+    portENTER_CRITICAL(&lock);
+    update_locked(now_s);
+    portEXIT_CRITICAL(&lock);
+}
+
+void SessionRollups::update_locked(uint32_t now_s) {
+    for (uint8_t p = 0; p < (uint8_t)SessionRollupPeriod::COUNT; p++) {
+        SessionRollupPeriod period = (SessionRollupPeriod)p;
+        uint32_t length = period_seconds(period);
+        uint32_t capacity;
+        ring(period, &capacity);
+        uint32_t ended = (now_s - open[p].start_s) / length;
+        if (ended == 0) {
+            continue;
+        }
+        // Empty periods close too, so a publisher sees every hour; past the ring they are skipped
+        close_locked(period);
+        uint32_t empty = ended - 1;
+        if (empty > capacity) {
+            open[p].start_s += (empty - capacity) * length;
+            empty = capacity;
+        }
+        while (empty-- > 0) {
+            close_locked(period);
+        }
+    }
+}
+
+void SessionRollups::close_locked(SessionRollupPeriod period) {
+    uint32_t capacity;
+    SessionRollup* records = ring(period, &capacity);
+    Accumulator& accumulator = open[(size_t)period];
+    to_record(accumulator, period, true, &records[closed_total[(size_t)period] % capacity]);
+    closed_total[(size_t)period]++;
+
+    uint32_t next_start = accumulator.start_s + period_seconds(period);
+    memset(&accumulator, 0, sizeof(accumulator));
+    accumulator.start_s = next_start;
+}
+
+SessionRollup* SessionRollups::ring(SessionRollupPeriod period, uint32_t* capacity) {
+    *capacity = period == SessionRollupPeriod::DAY ? GRIND_ROLLUP_DAYS_KEPT : GRIND_ROLLUP_HOURS_KEPT;
+    return period == SessionRollupPeriod::DAY ? days : hours;
+}
+
+const SessionRollup* SessionRollups::ring(SessionRollupPeriod period, uint32_t* capacity) const {
+    *capacity = period == SessionRollupPeriod::DAY ? GRIND_ROLLUP_DAYS_KEPT : GRIND_ROLLUP_HOURS_KEPT;
+    return period == SessionRollupPeriod::DAY ? days : hours;
+}
+
+void SessionRollups::to_record(const Accumulator& accumulator, SessionRollupPeriod period, bool closed,
+                               SessionRollup* out) {
+    memset(out, 0, sizeof(*out));
+    out->start_s = accumulator.start_s;
+    out->period_s = period_seconds(period);
+    out->grinds = accumulator.grinds;
+    out->weight_grinds = accumulator.weight_grinds;
+    out->ground_g = accumulator.ground_g;
+    out->mean_error_g = accumulator.weight_grinds ? accumulator.error_sum_g / accumulator.weight_grinds : NAN;
+    out->p95_abs_error_g = accumulator.abs_error.empty() ? NAN : accumulator.abs_error.p95();
+    out->mean_time_s = accumulator.grinds ? accumulator.time_sum_s / accumulator.grinds : NAN;
+    out->pulses = accumulator.pulses;
+    out->timeouts = accumulator.timeouts;
+    out->overshoots = accumulator.overshoots;
+    out->flow_faults = accumulator.flow_faults;
+    out->diagnostics = accumulator.diagnostics;
+    out->closed = closed ? 1 : 0;
+}
+
+uint32_t SessionRollups::get_closed_total(SessionRollupPeriod period) const {
+    portENTER_CRITICAL(&lock);
+    uint32_t total = closed_total[(size_t)period];
+    portEXIT_CRITICAL(&lock);
+    return total;
+}
+
+bool SessionRollups::get_closed(SessionRollupPeriod period, uint32_t age, SessionRollup* out) const {
+    uint32_t capacity;
+    const SessionRollup* records = ring(period, &capacity);
+    portENTER_CRITICAL(&lock);
+    uint32_t total = closed_total[(size_t)period];
+    bool found = age < total && age < capacity;
+    if (found) {
+        *out = records[(total - 1 - age) % capacity];
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+void SessionRollups::get_open(SessionRollupPeriod period, SessionRollup* out) const {
+    portENTER_CRITICAL(&lock);
+    to_record(open[(size_t)period], period, false, out);
+    portEXIT_CRITICAL(&lock);
+}
+
+void SessionRollups::print_report() {
+    uint32_t now_s = uptime_s();
+    update();
+    LOG_BLE("=== Session rollups: uptime %luh%02lum ===\n", (unsigned long)(now_s / 3600),
+            (unsigned long)(now_s / 60 % 60));
+    LOG_BLE("  period  start h  grinds      kg  err g  p95 g  time s  pulses  TO  OS  FF  diag\n");
+    static const char* const kNames[] = { "hour", "day" };
+    for (uint8_t p = 0; p < (uint8_t)SessionRollupPeriod::COUNT; p++) {
+        SessionRollupPeriod period = (SessionRollupPeriod)p;
+        SessionRollup record;
+        get_open(period, &record);
+        for (uint32_t age = 0; ; age++) {
+            LOG_BLE("  %-4s%s %8.1f %7u %7.3f %6.2f %6.2f %7.1f %7u %3u %3u %3u %5u\n",
+                    kNames[p], record.closed ? "  " : " *", record.start_s / 3600.0f, (unsigned)record.grinds,
+                    record.ground_g / 1000.0f, record.mean_error_g, record.p95_abs_error_g, record.mean_time_s,
+                    (unsigned)record.pulses, (unsigned)record.timeouts, (unsigned)record.overshoots,
+                    (unsigned)record.flow_faults, (unsigned)record.diagnostics);
+            if (!get_closed(period, age, &record)) {
+                break;
+            }
+        }
+    }
+    LOG_BLE("  * open period\n");
+    LOG_BLE("==================================================================================\n");
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "../system/streaming_quantiles.h"
+
+struct SessionSummary;
+
+#define GRIND_ROLLUP_HOURS_KEPT 24                                 // Closed hourly rollups kept in RAM
+#define GRIND_ROLLUP_DAYS_KEPT 7                                   // Closed daily rollups kept in RAM
+
+enum class SessionRollupPeriod : uint8_t {
+    HOUR,
+    DAY,
+    COUNT
+};
+
+#pragma pack(push, 1)
+// Aggregates of the sessions that ended in one period of uptime
+struct SessionRollup {
+    uint32_t start_s;              // Uptime at the period start (this boot), s
+    uint32_t period_s;             // 3600 or 86400
+    uint16_t grinds;
+    uint16_t weight_grinds;        // Weight-mode grinds; the error figures cover only these
+    float    ground_g;             // Final weights summed
+    float    mean_error_g;         // Target minus final, NAN without weight grinds
+    float    p95_abs_error_g;      // Streaming estimate, NAN without weight grinds
+    float    mean_time_s;          // NAN without grinds
+    uint16_t pulses;
+    uint8_t  timeouts;             // Sessions that ended TIMEOUT or PROJECTED_TIMEOUT
+    uint8_t  overshoots;
+    uint8_t  flow_faults;          // FLOW_STALLED or FLOW_UNSTABLE
+    uint8_t  diagnostics;          // Diagnostic warnings raised
+    uint8_t  closed;               // 1 once the period has ended
+    uint8_t  reserved;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SessionRollup) == 36, "Unexpected SessionRollup size");
+
+/**
+ * SessionRollups - Hourly and daily aggregates for fleet dashboards
+ *
+ * Dashboards that plot trends need a few numbers per hour, not every session.
+ * Each session summary is folded into an open hour and an open day when
+ * FileIOTask appends it (add_session()): counts and sums, plus a
+ * StreamingQuantiles for the p95 absolute error, so nothing per session is
+ * kept. DiagnosticsController counts each warning it raises (add_diagnostic()).
+ * update() closes periods that have ended, empty ones included, into rings of
+ * GRIND_ROLLUP_HOURS_KEPT hours and GRIND_ROLLUP_DAYS_KEPT days; a gap longer
+ * than the ring is skipped.
+ *
+ * Periods run on the uptime clock (the device has no wall time) and start at
+ * boot, so the rollups are RAM only and begin again with each boot; the
+ * receiver stamps them. get_closed_total() counts periods closed since boot,
+ * a cursor for publishers. Other tasks copy records under a spinlock.
+ */
+class SessionRollups {
+public:
+    SessionRollups();
+
+    void add_session(const SessionSummary& summary, float final_weight_g);  // FileIOTask
+    void add_diagnostic();                                                  // UI task
+    void update();                                                          // Closes ended periods
+
+    uint32_t get_closed_total(SessionRollupPeriod period) const;
+    bool get_closed(SessionRollupPeriod period, uint32_t age, SessionRollup* out) const;    // age 0 = newest
+    void get_open(SessionRollupPeriod period, SessionRollup* out) const;
+
+    void print_report();                        // Open and closed periods, logged as a table
+
+    static uint32_t uptime_s();                 // The periods' clock: esp_timer, which does not wrap
+    static uint32_t period_seconds(SessionRollupPeriod period);
+
+private:
+    struct Accumulator {
+        uint32_t start_s;
+        uint16_t grinds;
+        uint16_t weight_grinds;
+        float ground_g;
+        float error_sum_g;
+        float time_sum_s;
+        uint16_t pulses;
+        uint8_t timeouts;
+        uint8_t overshoots;
+        uint8_t flow_faults;
+        uint8_t diagnostics;
+        StreamingQuantiles abs_error;
+    };
+
+    mutable portMUX_TYPE lock;
+    Accumulator open[(size_t)SessionRollupPeriod::COUNT] = {};
+    SessionRollup hours[GRIND_ROLLUP_HOURS_KEPT];
+    SessionRollup days[GRIND_ROLLUP_DAYS_KEPT];
+    uint32_t closed_total[(size_t)SessionRollupPeriod::COUNT] = {};
+
+    void update_locked(uint32_t now_s);
+    void close_locked(SessionRollupPeriod period);
+    SessionRollup* ring(SessionRollupPeriod period, uint32_t* capacity);
+    const SessionRollup* ring(SessionRollupPeriod period, uint32_t* capacity) const;
+    static void to_record(const Accumulator& accumulator, SessionRollupPeriod period, bool closed, SessionRollup* out);
+    static uint8_t add_saturated(uint8_t value) { return value < UINT8_MAX ? value + 1 : value; }
+};
+
+extern SessionRollups session_rollups;
@@ -0,0 +1,289 @@
+#include "session_stream_writer.h"
+#include "grind_logging.h"
+#include "measurement_codec.h"
+#include "session_log_partition.h"
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+
+// Whole chunks fill the block exactly, so a copy never straddles two blocks
+static_assert(GRIND_LOG_MEASUREMENTS_PER_BLOCK % SYS_LOG_STAGING_RECORDS == 0,
+              "SYS_LOG_STAGING_RECORDS must divide GRIND_LOG_MEASUREMENTS_PER_BLOCK");
+
+bool SessionStreamWriter::allocate() {
+    staging = (GrindMeasurement*)heap_caps_malloc(SYS_LOG_STAGING_CHUNKS * SYS_LOG_STAGING_RECORDS * sizeof(GrindMeasurement),
+                                                  MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    block = (GrindMeasurement*)heap_caps_malloc(GRIND_LOG_MEASUREMENTS_PER_BLOCK * sizeof(GrindMeasurement), MALLOC_CAP_SPIRAM);
+    encoded = (uint8_t*)heap_caps_malloc(MEASUREMENT_BLOCK_MAX_SIZE, MALLOC_CAP_SPIRAM);
+    if (!staging || !block || !encoded) {
+        release();
+        return false;
+    }
+    return true;
+}
+
+void SessionStreamWriter::release() {
+    if (staging) {
+        heap_caps_free(staging);
+        staging = nullptr;
+    }
+    if (block) {
+        heap_caps_free(block);
+        block = nullptr;
+    }
+    if (encoded) {
+        heap_caps_free(encoded);
+        encoded = nullptr;
+    }
+}
+
+bool SessionStreamWriter::push(const GrindMeasurement& measurement) {
+    if (!block) {
+        return false;
+    }
+    // Starting a chunk the file task has not copied yet would overwrite it
+    if (fill_count == 0 && ready_count[fill_index].load(std::memory_order_acquire) != 0) {
+        return false;
+    }
+    staging[fill_index * SYS_LOG_STAGING_RECORDS + fill_count++] = measurement;
+    if (fill_count == SYS_LOG_STAGING_RECORDS) {
+        ready_count[fill_index].store(fill_count, std::memory_order_release);
+        fill_index = (fill_index + 1) % SYS_LOG_STAGING_CHUNKS;
+        fill_count = 0;
+    }
+    return true;
+}
+
+bool SessionStreamWriter::open(const GrindSession& session) {
+    if (is_open()) {
+        abort();
+    }
+    session_id = session.session_id;
+    session_timestamp = session.session_timestamp;
+    measurement_count = 0;
+    block_count = 0;
+    blocks_size = 0;
+    checksum = 0;
+    write_failed = false;
+    snprintf(path, sizeof(path), SESSION_FILE_FORMAT, (unsigned long)session_id);
+
+    // Provisional header: counts stay 0 until finish() or recovery fills them in
+    TimeSeriesSessionHeader header;
+    memset(&header, 0, sizeof(header));
+    header.session_id = session_id;
+    header.session_timestamp = session_timestamp;
+    header.session_size = sizeof(GrindSession);
+    header.schema_version = GRIND_LOG_SCHEMA_VERSION;
+    header.flags = SESSION_FILE_FLAG_OPEN;
+
+    if (partition) {
+        if (!partition->open_session(header, session)) {
+            LOG_BLE("ERROR: Failed to open session %lu in the session log\n", (unsigned long)session_id);
+            return false;
+        }
+        return true;
+    }
+
+    file = LittleFS.open(path, "w");
+    if (!file) {
+        LOG_BLE("ERROR: Failed to open session file for streaming: %s\n", path);
+        return false;
+    }
+    if (file.write((const uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        file.write((const uint8_t*)&session, sizeof(session)) != sizeof(session)) {
+        LOG_BLE("ERROR: Failed to write session file header: %s\n", path);
+        abort();
+        return false;
+    }
+    file.flush();
+    return true;
+}
+
+bool SessionStreamWriter::is_open() const {
+    return partition ? partition->is_session_open(session_id) : (bool)file;
+}
+
+bool SessionStreamWriter::write(const uint8_t* data, size_t length) {
+    checksum = session_checksum_update(checksum, data, length);
+    if (partition) {
+        return partition->append(session_id, data, length);
+    }
+    return file.write(data, length) == length;
+}
+
+bool SessionStreamWriter::append_block(const GrindMeasurement* measurements, uint8_t count) {
+    size_t block_size = encode_measurement_block(measurements, count, encoded, MEASUREMENT_BLOCK_MAX_SIZE);
+    if (block_size == 0 || !write(encoded, block_size)) {
+        LOG_BLE("ERROR: Failed to append measurement block to %s\n", path);
+        write_failed = true;
+        return false;
+    }
+    // Commit each block so a reset mid-grind loses at most the blocks still in RAM
+    if (!partition) {
+        file.flush();
+    }
+    measurement_count += count;
+    blocks_size += block_size;
+    return true;
+}
+
+bool SessionStreamWriter::append_adc_capture(const AdcCaptureEntry* entries, uint8_t count) {
+    if (!is_open() || write_failed) {
+        return false;
+    }
+    size_t block_size = encode_adc_capture_block(entries, count, encoded, MEASUREMENT_BLOCK_MAX_SIZE);
+    if (block_size == 0 || !write(encoded, block_size)) {
+        LOG_BLE("ERROR: Failed to append ADC capture block to %s\n", path);
+        write_failed = true;
+        return false;
+    }
+    if (!partition) {
+        file.flush();
+    }
+    blocks_size += block_size;
+    return true;
+}
+
+void SessionStreamWriter::append_ready_blocks() {
+    for (uint8_t i = 0; i < SYS_LOG_STAGING_CHUNKS; i++) {
+        uint8_t count = ready_count[drain_index].load(std::memory_order_acquire);
+        if (count == 0) {
+            return;
+        }
+        // Without an open file (logging disabled, open failed) the chunk is just released
+        bool keep = is_open() && !write_failed;
+        if (keep) {
+            memcpy(block + block_count, staging + drain_index * SYS_LOG_STAGING_RECORDS, count * sizeof(GrindMeasurement));
+            block_count += count;
+        }
+        // Hand the chunk back before the slow encode and write
+        ready_count[drain_index].store(0, std::memory_order_release);
+        drain_index = (drain_index + 1) % SYS_LOG_STAGING_CHUNKS;
+        if (keep && block_count == GRIND_LOG_MEASUREMENTS_PER_BLOCK) {
+            append_block(block, block_count);
+            block_count = 0;
+        }
+    }
+}
+
+bool SessionStreamWriter::finish(const GrindSession& session, const GrindEvent* events, uint16_t event_count) {
+    if (!is_open()) {
+        return false;
+    }
+
+    // Core 0 stopped logging before END_GRIND_SESSION, so its partial chunk is stable
+    append_ready_blocks();
+    if (fill_count > 0) {
+        memcpy(block + block_count, staging + fill_index * SYS_LOG_STAGING_RECORDS, fill_count * sizeof(GrindMeasurement));
+        block_count += fill_count;
+    }
+    if (block_count > 0 && !write_failed) {
+        append_block(block, block_count);
+    }
+    block_count = 0;
+    fill_count = 0;
+
+    const size_t events_size = event_count * sizeof(GrindEvent);
+    bool written = !write_failed && (events_size == 0 || write((const uint8_t*)events, events_size));
+
+    TimeSeriesSessionHeader header;
+    memset(&header, 0, sizeof(header));
+    header.session_id = session_id;
+    header.session_timestamp = session_timestamp;
+    header.session_size = sizeof(GrindSession) + blocks_size + events_size;
+    header.checksum = session_checksum_update(checksum, &session, sizeof(session));
+    header.event_count = event_count;
+    header.measurement_count = measurement_count;
+    header.schema_version = GRIND_LOG_SCHEMA_VERSION;
+    header.flags = SESSION_FILE_FLAG_CHECKSUM;
+    if (partition) {
+        written = written && partition->commit(header, session);
+    } else {
+        written = written && file.seek(0) &&
+                  file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                  file.write((const uint8_t*)&session, sizeof(session)) == sizeof(session);
+    }
+    if (!written) {
+        LOG_BLE("ERROR: Failed to finalize session file: %s\n", path);
+        abort();
+        return false;
+    }
+
+    if (!partition) {
+        file.close();
+    }
+    LOG_BLE("Successfully wrote session %lu to file (%lu bytes, %u measurements in %lu bytes)\n",
+            (unsigned long)session_id, (unsigned long)(sizeof(header) + header.session_size),
+            (unsigned)measurement_count, (unsigned long)blocks_size);
+    return true;
+}
+
+void SessionStreamWriter::abort() {
+    if (partition) {
+        partition->abort_session(session_id);
+    } else if (file) {
+        file.close();
+        LittleFS.remove(path);
+    }
+}
+
+void SessionStreamWriter::reset() {
+    // Indices are left alone: full chunks are always drained in order, so both cores stay in step
+    fill_count = 0;
+}
+
+bool SessionStreamWriter::recover(const char* path) {
+    File file = LittleFS.open(path, "r+");
+    TimeSeriesSessionHeader header;
+    GrindSession session;
+    uint8_t* payload = (uint8_t*)heap_caps_malloc(MEASUREMENT_BLOCK_MAX_SIZE, MALLOC_CAP_8BIT);
+    GrindMeasurement* block = (GrindMeasurement*)heap_caps_malloc(GRIND_LOG_MEASUREMENTS_PER_BLOCK * sizeof(GrindMeasurement), MALLOC_CAP_8BIT);
+    bool ok = file && payload && block &&
+              file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.read((uint8_t*)&session, sizeof(session)) == sizeof(session);
+
+    // Keep every block that decodes; the scan stops at the first torn or missing one
+    uint16_t count = 0;
+    uint32_t size = 0;
+    uint32_t checksum = 0;
+    MeasurementBlockHeader block_header;
+    while (ok && file.read((uint8_t*)&block_header, sizeof(block_header)) == sizeof(block_header) &&
+           block_header.payload_size <= MEASUREMENT_BLOCK_MAX_SIZE - sizeof(block_header) &&
+           block_header.measurement_count <= UINT16_MAX - count &&
+           file.read(payload, block_header.payload_size) == block_header.payload_size &&
+           is_valid_session_block(block_header, payload, block)) {
+        if (!(block_header.flags & MEASUREMENT_BLOCK_FLAG_ADC_CAPTURE)) {
+            count += block_header.measurement_count;
+        }
+        size += sizeof(block_header) + block_header.payload_size;
+        checksum = session_checksum_update(checksum, &block_header, sizeof(block_header));
+        checksum = session_checksum_update(checksum, payload, block_header.payload_size);
+    }
+    heap_caps_free(payload);
+    heap_caps_free(block);
+
+    if (ok && count > 0) {
+        header.session_size = sizeof(GrindSession) + size;
+        header.event_count = 0;              // Events are only written by finish()
+        header.measurement_count = count;
+        header.flags = (header.flags & ~SESSION_FILE_FLAG_OPEN) | SESSION_FILE_FLAG_CHECKSUM;
+        snprintf(session.result_status, sizeof(session.result_status), "%s", "INTERRUPTED");
+        session.termination_reason = static_cast<uint8_t>(GrindTerminationReason::UNKNOWN);
+        header.checksum = session_checksum_update(checksum, &session, sizeof(session));
+        ok = file.seek(0) &&
+             file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+             file.write((const uint8_t*)&session, sizeof(session)) == sizeof(session);
+    } else {
+        ok = false;
+    }
+    if (file) {
+        file.close();
+    }
+
+    if (!ok) {
+        LittleFS.remove(path);
+        LOG_BLE("Removed interrupted session file %s (no usable measurements)\n", path);
+        return false;
+    }
+    LOG_BLE("Recovered interrupted session %lu: %u measurements\n", (unsigned long)header.session_id, (unsigned)count);
+    return true;
+}
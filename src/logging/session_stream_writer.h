@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <atomic>
+#include "../config/system.h"
+
+struct GrindSession;
+struct GrindEvent;
+struct GrindMeasurement;
+struct AdcCaptureEntry;
+class SessionLogPartition;
+
+/**
+ * SessionStreamWriter - Appends a session's measurements to its file during the grind
+ *
+ * Core 0 writes records into SYS_LOG_STAGING_CHUNKS chunks of
+ * SYS_LOG_STAGING_RECORDS in internal SRAM, so the 50 Hz control loop never
+ * stores to PSRAM. FileIOTask copies each full chunk in one memcpy into the
+ * GRIND_LOG_MEASUREMENTS_PER_BLOCK block in PSRAM and encodes and appends that
+ * block once it is full, so neither side waits on the other and only one
+ * block is staged instead of the whole session. open() writes the
+ * header flagged SESSION_FILE_FLAG_OPEN; finish() appends the last partial
+ * block and the events, then rewrites header and session in place. The CRC-32
+ * checksum is folded in as each block is written, so finish() never reads the
+ * file back. A file a
+ * reset left open keeps every block flushed before it and is repaired at boot
+ * by recover(). With use_partition() the same byte stream goes to the session
+ * log partition instead, which does its own recovery.
+ *
+ * push() runs on Core 0 only, reset() while Core 0 is not logging, everything
+ * else in FileIOTask. A full chunk is handed over through ready_count; Core 0
+ * drops records (push() returns false) while every chunk waits for the file task.
+ */
+class SessionStreamWriter {
+public:
+    bool allocate();                         // Staging chunks (internal SRAM), block and encoder scratch (PSRAM)
+    void release();
+    void use_partition(SessionLogPartition* log_partition) { partition = log_partition; }
+
+    // Core 0
+    bool push(const GrindMeasurement& measurement);
+
+    // Core 1
+    bool open(const GrindSession& session);
+    void append_ready_blocks();
+    bool append_adc_capture(const AdcCaptureEntry* entries, uint8_t count);  // One ADC capture block between measurement blocks
+    bool finish(const GrindSession& session, const GrindEvent* events, uint16_t event_count);
+    void abort();                            // Close and delete a session file that will not be kept
+    void reset();                            // Drop Core 0's partial chunk before the next session
+    bool is_open() const;
+    uint16_t get_measurement_count() const { return measurement_count; }
+
+    // Repairs a file left SESSION_FILE_FLAG_OPEN; false if it held nothing usable and was removed
+    static bool recover(const char* path);
+
+private:
+    GrindMeasurement* staging = nullptr;     // Internal SRAM, SYS_LOG_STAGING_CHUNKS x SYS_LOG_STAGING_RECORDS
+    std::atomic<uint8_t> ready_count[SYS_LOG_STAGING_CHUNKS] = {};  // Records in a handed-over chunk, 0 while Core 0 owns it
+    uint8_t fill_index = 0;                  // Chunk Core 0 is filling
+    uint8_t fill_count = 0;
+    uint8_t drain_index = 0;                 // Next chunk Core 1 copies, keeps file order
+
+    GrindMeasurement* block = nullptr;       // PSRAM, GRIND_LOG_MEASUREMENTS_PER_BLOCK records being assembled
+    uint8_t block_count = 0;
+    uint8_t* encoded = nullptr;              // Encoder output, MEASUREMENT_BLOCK_MAX_SIZE bytes
+
+    File file;
+    SessionLogPartition* partition = nullptr;  // Session log partition, or null for LittleFS files
+    char path[64] = {0};
+    uint32_t session_id = 0;
+    uint32_t session_timestamp = 0;
+    uint16_t measurement_count = 0;          // Records appended to the file
+    uint32_t blocks_size = 0;                // Encoded bytes appended to the file, ADC capture blocks included
+    uint32_t checksum = 0;                   // session_checksum_update() over everything appended so far
+    bool write_failed = false;
+
+    void collect(const GrindMeasurement* measurements, uint8_t count);
+    bool append_block(const GrindMeasurement* measurements, uint8_t count);
+    bool write(const uint8_t* data, size_t length);
+};
@@ -0,0 +1,337 @@
+#include "session_summary.h"
+#include "grind_logging.h"
+#include "../controllers/grind_phase.h"
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+#include <math.h>
+
+namespace {
+
+bool is_phase(const GrindEvent& event, GrindPhase phase) {
+    return event.phase_id == static_cast<uint8_t>(phase);
+}
+
+uint16_t clamp_u16(float value) {
+    if (!(value > 0.0f)) {
+        return 0;
+    }
+    return value >= 65535.0f ? 65535 : (uint16_t)lroundf(value);
+}
+
+const uint32_t kPreviewFirstIntervalMs = 100;
+const float kPreviewMinFullScaleG = 1.0f;      // A purge or an aborted start still draws as a flat line
+
+}
+
+void SessionPreviewBuilder::reset() {
+    for (float& point : points) {
+        point = NAN;
+    }
+    interval_ms = kPreviewFirstIntervalMs;
+    count = 0;
+}
+
+void SessionPreviewBuilder::add(uint32_t timestamp_ms, float weight_grams) {
+    if (interval_ms == 0) {
+        reset();
+    }
+    uint32_t index = timestamp_ms / interval_ms;
+    while (index >= GRIND_SESSION_PREVIEW_POINTS) {
+        // Twice the interval: each pair keeps its newer weight
+        for (uint8_t i = 0; i < GRIND_SESSION_PREVIEW_POINTS / 2; i++) {
+            float newer = points[2 * i + 1];
+            points[i] = isnan(newer) ? points[2 * i] : newer;
+        }
+        for (uint8_t i = GRIND_SESSION_PREVIEW_POINTS / 2; i < GRIND_SESSION_PREVIEW_POINTS; i++) {
+            points[i] = NAN;
+        }
+        interval_ms *= 2;
+        count = (uint8_t)((count + 1) / 2);
+        index = timestamp_ms / interval_ms;
+    }
+    points[index] = weight_grams;
+    if (index + 1 > count) {
+        count = (uint8_t)(index + 1);
+    }
+}
+
+void SessionPreviewBuilder::finish(SessionSummary* summary) const {
+    summary->preview_count = 0;
+    summary->preview_span_ds = 0;
+    summary->preview_full_scale_g = 0.0f;
+    memset(summary->preview, 0, sizeof(summary->preview));
+    if (interval_ms == 0 || count == 0) {
+        return;
+    }
+
+    // Intervals without a measurement (a flash stall, a slow report rate) hold the weight before them
+    float filled[GRIND_SESSION_PREVIEW_POINTS];
+    float last = 0.0f;
+    float full_scale = kPreviewMinFullScaleG;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!isnan(points[i])) {
+            last = points[i];
+        }
+        filled[i] = last;
+        if (last > full_scale) {
+            full_scale = last;
+        }
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        float scaled = filled[i] > 0.0f ? filled[i] / full_scale * 255.0f : 0.0f;
+        summary->preview[i] = (uint8_t)lroundf(scaled > 255.0f ? 255.0f : scaled);
+    }
+    summary->preview_count = count;
+    summary->preview_span_ds = clamp_u16((float)count * interval_ms / 100.0f);
+    summary->preview_full_scale_g = full_scale;
+}
+
+SessionSummaryTable::SessionSummaryTable() {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void SessionSummaryTable::summarize(const GrindSession& session, const GrindEvent* events, uint16_t event_count,
+                                    SessionSummary* out) {
+    memset(out, 0, sizeof(*out));
+    out->session_id = session.session_id;
+    out->session_timestamp = session.session_timestamp;
+    out->target_weight = session.target_weight;
+    out->error_grams = session.error_grams;
+    out->total_time_ds = clamp_u16(session.total_time_ms / 100.0f);
+    out->pulse_count = session.pulse_count;
+    out->termination_reason = session.termination_reason;
+    out->profile_id = session.profile_id;
+    out->grind_mode = session.grind_mode;
+    out->grinder_channel = session.grinder_channel;
+
+    const GrindEvent* main_run = nullptr;
+    bool coast_pending = false;
+    uint32_t pulse_settle_sum = 0;
+    uint16_t pulse_settles = 0;
+    for (uint16_t i = 0; i < event_count; i++) {
+        const GrindEvent& event = events[i];
+        if (!main_run && (is_phase(event, GrindPhase::PREDICTIVE) || is_phase(event, GrindPhase::TIME_GRINDING))) {
+            main_run = &event;
+            // The run starts from the tare, so its end weight is its yield (start_weight predates the
+            // tare). Flow only runs after the latency; time mode records none.
+            float flowing_ms = (float)event.duration_ms - (float)event.grind_latency_ms;
+            if (flowing_ms > 0.0f) {
+                out->mean_flow_g_per_s = event.end_weight * 1000.0f / flowing_ms;
+            }
+            out->latency_ms = clamp_u16((float)event.grind_latency_ms);
+            coast_pending = is_phase(event, GrindPhase::PREDICTIVE);
+        } else if (is_phase(event, GrindPhase::PULSE_SETTLING) || is_phase(event, GrindPhase::FINAL_SETTLING)) {
+            if (coast_pending) {
+                out->coast_grams = event.end_weight - main_run->end_weight;
+                coast_pending = false;
+            }
+            if (is_phase(event, GrindPhase::FINAL_SETTLING)) {
+                out->final_settle_ms = clamp_u16((float)event.settling_duration_ms);
+            } else {
+                pulse_settle_sum += event.settling_duration_ms;
+                pulse_settles++;
+            }
+        }
+    }
+    if (pulse_settles > 0) {
+        out->pulse_settle_ms = clamp_u16((float)pulse_settle_sum / pulse_settles);
+    }
+}
+
+bool SessionSummaryTable::begin() {
+    if (!entries) {
+        entries = (SessionSummary*)heap_caps_calloc(GRIND_SESSION_SUMMARY_CAPACITY, sizeof(SessionSummary), MALLOC_CAP_SPIRAM);
+        if (!entries) {
+            LOG_BLE("ERROR: Failed to allocate PSRAM for session summaries\n");
+            return false;
+        }
+    }
+    total = 0;
+
+    File file = LittleFS.open(GRIND_SESSION_SUMMARY_FILE, "r");
+    if (!file) {
+        return false;
+    }
+    SessionSummaryHeader header;
+    const size_t size = GRIND_SESSION_SUMMARY_CAPACITY * sizeof(SessionSummary);
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == SESSION_SUMMARY_MAGIC && header.version == SESSION_SUMMARY_VERSION &&
+              header.capacity == GRIND_SESSION_SUMMARY_CAPACITY &&
+              file.read((uint8_t*)entries, size) == size;
+    file.close();
+    if (!ok) {
+        memset(entries, 0, size);
+        LOG_BLE("Session summary table unreadable, starting over\n");
+        return false;
+    }
+    total = header.total;
+    return true;
+}
+
+void SessionSummaryTable::end() {
+    if (entries) {
+        heap_caps_free(entries);
+        entries = nullptr;
+    }
+    total = 0;
+}
+
+void SessionSummaryTable::add(const SessionSummary& summary) {
+    if (!entries) {
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    entries[total % GRIND_SESSION_SUMMARY_CAPACITY] = summary;
+    total++;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool SessionSummaryTable::append(const SessionSummary& summary) {
+    if (!entries) {
+        return false;
+    }
+    add(summary);
+    // A table that is not on flash yet (first session, or damaged) is written whole
+    return write_slot((total - 1) % GRIND_SESSION_SUMMARY_CAPACITY) || save();
+}
+
+bool SessionSummaryTable::write_slot(uint32_t slot) {
+    File file = LittleFS.open(GRIND_SESSION_SUMMARY_FILE, "r+");
+    if (!file) {
+        return false;
+    }
+    SessionSummaryHeader header;
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == SESSION_SUMMARY_MAGIC && header.version == SESSION_SUMMARY_VERSION &&
+              header.capacity == GRIND_SESSION_SUMMARY_CAPACITY;
+    if (ok) {
+        header.total = total;
+        ok = file.seek(sizeof(header) + slot * sizeof(SessionSummary)) &&
+             file.write((const uint8_t*)&entries[slot], sizeof(SessionSummary)) == sizeof(SessionSummary) &&
+             file.seek(0) &&
+             file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+    }
+    file.close();
+    return ok;
+}
+
+bool SessionSummaryTable::save() {
+    if (!entries) {
+        return false;
+    }
+    File file = LittleFS.open(GRIND_SESSION_SUMMARY_TEMP_FILE, "w");
+    if (!file) {
+        LOG_BLE("ERROR: Failed to open %s\n", GRIND_SESSION_SUMMARY_TEMP_FILE);
+        return false;
+    }
+    SessionSummaryHeader header;
+    header.magic = SESSION_SUMMARY_MAGIC;
+    header.version = SESSION_SUMMARY_VERSION;
+    header.capacity = GRIND_SESSION_SUMMARY_CAPACITY;
+    header.total = total;
+    const size_t size = GRIND_SESSION_SUMMARY_CAPACITY * sizeof(SessionSummary);
+    bool written = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                   file.write((const uint8_t*)entries, size) == size;
+    file.close();
+
+    if (!written || !LittleFS.rename(GRIND_SESSION_SUMMARY_TEMP_FILE, GRIND_SESSION_SUMMARY_FILE)) {
+        LittleFS.remove(GRIND_SESSION_SUMMARY_TEMP_FILE);
+        LOG_BLE("ERROR: Failed to write session summary table\n");
+        return false;
+    }
+    return true;
+}
+
+bool SessionSummaryTable::clear() {
+    if (entries) {
+        portENTER_CRITICAL(&lock);
+        memset(entries, 0, GRIND_SESSION_SUMMARY_CAPACITY * sizeof(SessionSummary));
+        total = 0;
+        portEXIT_CRITICAL(&lock);
+    }
+    return !LittleFS.exists(GRIND_SESSION_SUMMARY_FILE) || LittleFS.remove(GRIND_SESSION_SUMMARY_FILE);
+}
+
+uint32_t SessionSummaryTable::get_count() const {
+    return total < GRIND_SESSION_SUMMARY_CAPACITY ? total : GRIND_SESSION_SUMMARY_CAPACITY;
+}
+
+bool SessionSummaryTable::get_latest(uint32_t age, SessionSummary* out) const {
+    if (!entries || !out) {
+        return false;
+    }
+    portENTER_CRITICAL(&lock);
+    bool found = age < get_count();
+    if (found) {
+        *out = entries[(total - 1 - age) % GRIND_SESSION_SUMMARY_CAPACITY];
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+bool SessionSummaryTable::find(uint32_t session_id, SessionSummary* out) const {
+    if (!entries || !out) {
+        return false;
+    }
+    bool found = false;
+    portENTER_CRITICAL(&lock);
+    uint32_t available = get_count();
+    for (uint32_t age = 0; age < available && !found; age++) {
+        const SessionSummary& entry = entries[(total - 1 - age) % GRIND_SESSION_SUMMARY_CAPACITY];
+        if (entry.session_id == session_id) {
+            *out = entry;
+            found = true;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+bool SessionSummaryTable::get_trend(uint32_t max_sessions, int grind_mode, SessionTrend* out, int profile_id,
+                                    int grinder_channel) const {
+    memset(out, 0, sizeof(*out));
+    if (!entries) {
+        return false;
+    }
+    float error_sum = 0.0f, abs_error_sum = 0.0f;
+    float flow_sum = 0.0f, coast_sum = 0.0f, latency_sum = 0.0f, settle_sum = 0.0f, pulse_settle_sum = 0.0f;
+    uint32_t pulse_sum = 0;
+    uint16_t flow_count = 0, coast_count = 0, latency_count = 0, settle_count = 0, pulse_settle_count = 0;
+
+    portENTER_CRITICAL(&lock);
+    uint32_t available = get_count();
+    for (uint32_t age = 0; age < available && out->session_count < max_sessions; age++) {
+        const SessionSummary& entry = entries[(total - 1 - age) % GRIND_SESSION_SUMMARY_CAPACITY];
+        if ((grind_mode >= 0 && entry.grind_mode != grind_mode) ||
+            (profile_id >= 0 && entry.profile_id != profile_id) ||
+            (grinder_channel >= 0 && entry.grinder_channel != grinder_channel)) {
+            continue;
+        }
+        out->session_count++;
+        if (entry.termination_reason == static_cast<uint8_t>(GrindTerminationReason::COMPLETED)) {
+            out->completed_count++;
+        }
+        error_sum += entry.error_grams;
+        abs_error_sum += fabsf(entry.error_grams);
+        pulse_sum += entry.pulse_count;
+        if (entry.mean_flow_g_per_s > 0.0f) { flow_sum += entry.mean_flow_g_per_s; flow_count++; }
+        if (entry.latency_ms > 0) { latency_sum += entry.latency_ms; latency_count++; }
+        if (entry.coast_grams != 0.0f) { coast_sum += entry.coast_grams; coast_count++; }
+        if (entry.final_settle_ms > 0) { settle_sum += entry.final_settle_ms; settle_count++; }
+        if (entry.pulse_settle_ms > 0) { pulse_settle_sum += entry.pulse_settle_ms; pulse_settle_count++; }
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (out->session_count == 0) {
+        return false;
+    }
+    out->mean_error_grams = error_sum / out->session_count;
+    out->mean_abs_error_grams = abs_error_sum / out->session_count;
+    out->mean_pulses = (float)pulse_sum / out->session_count;
+    out->mean_flow_g_per_s = flow_count ? flow_sum / flow_count : 0.0f;
+    out->mean_coast_grams = coast_count ? coast_sum / coast_count : 0.0f;
+    out->mean_latency_ms = latency_count ? latency_sum / latency_count : 0.0f;
+    out->mean_final_settle_ms = settle_count ? settle_sum / settle_count : 0.0f;
+    out->mean_pulse_settle_ms = pulse_settle_count ? pulse_settle_sum / pulse_settle_count : 0.0f;
+    return true;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+struct GrindSession;
+struct GrindEvent;
+
+#define GRIND_SESSION_SUMMARY_FILE "/session_summaries.bin"        // Rolling summary table, outlives rotated sessions
+#define GRIND_SESSION_SUMMARY_TEMP_FILE "/session_summaries.tmp"   // Full rewrites go here first, then rename
+#define GRIND_SESSION_SUMMARY_CAPACITY 512                         // Newest sessions kept (PSRAM, 108 bytes each)
+#define GRIND_SESSION_PREVIEW_POINTS 64                            // Weight curve points kept with each summary
+
+constexpr uint32_t SESSION_SUMMARY_MAGIC = 0x4D555353;              // "SSUM"
+constexpr uint16_t SESSION_SUMMARY_VERSION = 2;                     // v2: weight preview
+
+#pragma pack(push, 1)
+struct SessionSummaryHeader {
+    uint32_t magic;                // SESSION_SUMMARY_MAGIC
+    uint16_t version;              // SESSION_SUMMARY_VERSION
+    uint16_t capacity;             // Slots that follow
+    uint32_t total;                // Summaries ever appended; the newest is in slot (total - 1) % capacity
+};
+
+// Outcome of one session, computed from its GrindSession and events when it ends
+struct SessionSummary {
+    uint32_t session_id;
+    uint32_t session_timestamp;
+    float    target_weight;
+    float    error_grams;          // GrindSession::error_grams
+    float    mean_flow_g_per_s;    // Main run (predictive or time grind) yield over its time after the latency
+    float    coast_grams;          // Weight gained from the predictive motor stop to the end of the first settle
+    uint16_t latency_ms;           // Motor start to flow detection
+    uint16_t final_settle_ms;
+    uint16_t pulse_settle_ms;      // Mean settle time after a pulse (0 without pulses)
+    uint16_t total_time_ds;        // Session runtime, 0.1 s
+    uint8_t  pulse_count;
+    uint8_t  termination_reason;   // GrindTerminationReason
+    uint8_t  profile_id;
+    uint8_t  grind_mode;
+    float    preview_full_scale_g; // Weight of a preview point of 255
+    uint16_t preview_span_ds;      // Session time the used points cover, 0.1 s
+    uint8_t  preview_count;        // Points used, evenly spaced from the session start; 0 = no preview
+    uint8_t  grinder_channel;      // GrindSession::grinder_channel (was reserved, 0 in older tables)
+    uint8_t  preview[GRIND_SESSION_PREVIEW_POINTS];    // Weight at the end of each interval
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SessionSummaryHeader) == 12, "Unexpected SessionSummaryHeader size");
+static_assert(sizeof(SessionSummary) == 108, "Unexpected SessionSummary size");
+
+// Means over the newest sessions of a table; averages skip sessions without the value
+struct SessionTrend {
+    uint16_t session_count;
+    uint16_t completed_count;      // Sessions that ended COMPLETED
+    float    mean_error_grams;
+    float    mean_abs_error_grams;
+    float    mean_flow_g_per_s;
+    float    mean_coast_grams;
+    float    mean_latency_ms;
+    float    mean_pulses;
+    float    mean_final_settle_ms;
+    float    mean_pulse_settle_ms;     // Over sessions with pulses
+};
+
+/**
+ * SessionPreviewBuilder - Downsampled weight curve of a session, built as it is written
+ *
+ * The measurements go to flash block by block, so the curve is reduced on the
+ * way: GRIND_SESSION_PREVIEW_POINTS intervals that keep the newest weight in
+ * each, starting at 100 ms and doubling (neighbouring pairs merged) whenever
+ * the session outlasts them. Any session length fits without knowing it up
+ * front, and the session browser draws the stored curve without opening the
+ * session file.
+ */
+class SessionPreviewBuilder {
+public:
+    void reset();
+    void add(uint32_t timestamp_ms, float weight_grams);
+    void finish(SessionSummary* summary) const;       // Preview fields only; after summarize()
+
+private:
+    float points[GRIND_SESSION_PREVIEW_POINTS];       // NAN = no measurement in that interval
+    uint32_t interval_ms = 0;
+    uint8_t count = 0;                                // Intervals up to the newest measurement
+};
+
+/**
+ * SessionSummaryTable - Rolling per-session outcomes for trends
+ *
+ * The Lifetime Stats page, BLE sysinfo and the grind strategies read trends
+ * over the last few hundred sessions from this PSRAM table instead of opening
+ * session files. FileIOTask appends one summary when a session is flushed;
+ * the append rewrites that slot and the header in a single LittleFS update,
+ * which commits on close, so a reset keeps the old or the new table. Older
+ * sessions are overwritten in place once the table is full, independent of
+ * session file rotation. A missing table is seeded from the stored sessions
+ * at boot (GrindLogger::init()).
+ *
+ * Readers on other tasks copy entries under a spinlock.
+ */
+class SessionSummaryTable {
+public:
+    SessionSummaryTable();
+
+    bool begin();                           // Load the table into PSRAM; false if it had to start empty
+    void end();
+    bool is_ready() const { return entries != nullptr; }
+
+    bool append(const SessionSummary& summary);     // Add and persist
+    void add(const SessionSummary& summary);        // Add in RAM only (seeding), then save()
+    bool save();
+    bool clear();
+
+    uint32_t get_count() const;
+    uint32_t get_total() const { return total; }   // Summaries ever appended; grows by one per session
+    bool get_latest(uint32_t age, SessionSummary* out) const;      // age 0 = newest
+    bool find(uint32_t session_id, SessionSummary* out) const;
+    bool get_trend(uint32_t max_sessions, int grind_mode, SessionTrend* out,
+                   int profile_id = -1, int grinder_channel = -1) const;   // grind_mode / profile_id / grinder_channel -1 = all
+
+    static void summarize(const GrindSession& session, const GrindEvent* events, uint16_t event_count,
+                          SessionSummary* out);
+
+private:
+    SessionSummary* entries = nullptr;
+    uint32_t total = 0;
+    mutable portMUX_TYPE lock;
+
+    bool write_slot(uint32_t slot);
+};
@@ -0,0 +1,220 @@
+#include "throughput_trend.h"
+#include "grind_logging.h"
+#include "session_summary.h"
+#include "../controllers/grind_mode.h"
+#include <Preferences.h>
+#include <math.h>
+#include <string.h>
+
+ThroughputTrend throughput_trend;
+
+namespace {
+// One profile's sessions as update() replays them, oldest first
+struct ProfileReplay {
+    uint16_t count;
+    float baseline_flow_sum;
+    float baseline_flow_sq;
+    float baseline_latency_sum;
+    float baseline_latency_sq;
+    float baseline_flow;
+    float baseline_latency;
+    float flow_sigma;
+    float latency_sigma;
+    float flow_cusum;
+    float latency_cusum;
+    int16_t flow_rise;              // Session where each CUSUM last left zero
+    int16_t latency_rise;
+    int16_t flow_change;            // Change point once the CUSUM passed the limit, -1 before
+    int16_t latency_change;
+    double slope_x, slope_y, slope_xx, slope_xy;     // Flow over session index, after the baseline
+    uint16_t slope_count;
+    float recent_flow[GRIND_WEAR_RECENT_SESSIONS];
+    float recent_latency[GRIND_WEAR_RECENT_SESSIONS];
+    float recent_dose[GRIND_WEAR_RECENT_SESSIONS];
+};
+
+float spread(float sq, uint16_t count, float mean, float floor) {
+    float variance = sq / count - mean * mean;
+    float sigma = variance > 0.0f ? sqrtf(variance) : 0.0f;
+    return sigma > floor ? sigma : floor;
+}
+
+float dose_time_s(float dose_g, float flow_g_per_s, float latency_ms) {
+    return latency_ms / 1000.0f + dose_g / flow_g_per_s;
+}
+
+// Advances a one-sided CUSUM by `excess` (std devs in the watched direction)
+void step_cusum(float excess, int16_t index, float* cusum, int16_t* rise, int16_t* change) {
+    if (*cusum <= 0.0f) {
+        *rise = index;
+    }
+    *cusum = fmaxf(0.0f, *cusum + excess - GRIND_WEAR_CUSUM_SLACK);
+    if (*change < 0 && *cusum > GRIND_WEAR_CUSUM_LIMIT) {
+        *change = *rise;
+    }
+}
+
+void finish(const ProfileReplay& replay, ThroughputTrendResult* out) {
+    memset(out, 0, sizeof(*out));
+    out->sessions = replay.count;
+    out->flow_change_age = -1;
+    out->latency_change_age = -1;
+    if (replay.count < GRIND_WEAR_MIN_SESSIONS) {
+        return;
+    }
+
+    uint16_t recent = replay.count < GRIND_WEAR_RECENT_SESSIONS ? replay.count : GRIND_WEAR_RECENT_SESSIONS;
+    for (uint16_t i = 0; i < recent; i++) {
+        out->recent_flow_g_per_s += replay.recent_flow[i] / recent;
+        out->recent_latency_ms += replay.recent_latency[i] / recent;
+        out->dose_g += replay.recent_dose[i] / recent;
+    }
+    out->baseline_flow_g_per_s = replay.baseline_flow;
+    out->baseline_latency_ms = replay.baseline_latency;
+    out->flow_drop = 1.0f - out->recent_flow_g_per_s / replay.baseline_flow;
+
+    float baseline_time = dose_time_s(out->dose_g, replay.baseline_flow, replay.baseline_latency);
+    out->time_increase_s = dose_time_s(out->dose_g, out->recent_flow_g_per_s, out->recent_latency_ms) - baseline_time;
+
+    // Only a falling slope is carried forward; the floor keeps a steep one finite
+    float slope = 0.0f;
+    double denominator = replay.slope_count * replay.slope_xx - replay.slope_x * replay.slope_x;
+    if (replay.slope_count >= 2 && denominator > 0.0) {
+        slope = (float)((replay.slope_count * replay.slope_xy - replay.slope_x * replay.slope_y) / denominator);
+    }
+    float projected_flow = out->recent_flow_g_per_s + fminf(slope, 0.0f) * GRIND_WEAR_PROJECTION_DOSES;
+    projected_flow = fmaxf(projected_flow, 0.25f * replay.baseline_flow);
+    out->projected_increase_s = dose_time_s(out->dose_g, projected_flow, out->recent_latency_ms) - baseline_time;
+
+    if (replay.flow_change >= 0) {
+        out->flow_change_age = (int16_t)(replay.count - replay.flow_change);
+    }
+    if (replay.latency_change >= 0) {
+        out->latency_change_age = (int16_t)(replay.count - replay.latency_change);
+    }
+    out->degraded = replay.flow_change >= 0 && out->flow_drop >= GRIND_WEAR_FLOW_DROP_THRESHOLD;
+}
+}
+
+ThroughputTrend::ThroughputTrend() {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void ThroughputTrend::begin() {
+    Preferences prefs;
+    prefs.begin("wear", true);
+    reset_session_id = prefs.getUInt("reset_id", 0);
+    prefs.end();
+}
+
+bool ThroughputTrend::update() {
+    const SessionSummaryTable& table = grind_logger.get_session_summaries();
+    ProfileReplay replays[USER_PROFILE_COUNT];
+    memset(replays, 0, sizeof(replays));
+    for (ProfileReplay& replay : replays) {
+        replay.flow_change = -1;
+        replay.latency_change = -1;
+    }
+
+    uint32_t count = table.get_count();
+    for (uint32_t age = count; age-- > 0; ) {
+        SessionSummary summary;
+        if (!table.get_latest(age, &summary) || summary.session_id <= reset_session_id ||
+            summary.termination_reason != (uint8_t)GrindTerminationReason::COMPLETED ||
+            summary.grind_mode != (uint8_t)GrindMode::WEIGHT || summary.profile_id >= USER_PROFILE_COUNT ||
+            !(summary.mean_flow_g_per_s > 0.0f) || summary.latency_ms == 0) {
+            continue;
+        }
+        ProfileReplay& replay = replays[summary.profile_id];
+        int16_t index = (int16_t)replay.count++;
+        float flow = summary.mean_flow_g_per_s;
+        float latency = summary.latency_ms;
+
+        uint16_t slot = index % GRIND_WEAR_RECENT_SESSIONS;
+        replay.recent_flow[slot] = flow;
+        replay.recent_latency[slot] = latency;
+        replay.recent_dose[slot] = summary.target_weight;
+
+        if (index < GRIND_WEAR_BASELINE_SESSIONS) {
+            replay.baseline_flow_sum += flow;
+            replay.baseline_flow_sq += flow * flow;
+            replay.baseline_latency_sum += latency;
+            replay.baseline_latency_sq += latency * latency;
+            if (index == GRIND_WEAR_BASELINE_SESSIONS - 1) {
+                replay.baseline_flow = replay.baseline_flow_sum / GRIND_WEAR_BASELINE_SESSIONS;
+                replay.baseline_latency = replay.baseline_latency_sum / GRIND_WEAR_BASELINE_SESSIONS;
+                replay.flow_sigma = spread(replay.baseline_flow_sq, GRIND_WEAR_BASELINE_SESSIONS, replay.baseline_flow,
+                                           GRIND_WEAR_MIN_SIGMA_RATIO * replay.baseline_flow);
+                replay.latency_sigma = spread(replay.baseline_latency_sq, GRIND_WEAR_BASELINE_SESSIONS,
+                                              replay.baseline_latency, GRIND_WEAR_MIN_SIGMA_RATIO * replay.baseline_latency);
+            }
+            continue;
+        }
+
+        step_cusum((replay.baseline_flow - flow) / replay.flow_sigma, index, &replay.flow_cusum, &replay.flow_rise,
+                   &replay.flow_change);
+        step_cusum((latency - replay.baseline_latency) / replay.latency_sigma, index, &replay.latency_cusum,
+                   &replay.latency_rise, &replay.latency_change);
+        replay.slope_x += index;
+        replay.slope_y += flow;
+        replay.slope_xx += (double)index * index;
+        replay.slope_xy += (double)index * flow;
+        replay.slope_count++;
+    }
+
+    bool any_degraded = false;
+    for (uint8_t profile = 0; profile < USER_PROFILE_COUNT; profile++) {
+        ThroughputTrendResult result;
+        finish(replays[profile], &result);
+        portENTER_CRITICAL(&lock);
+        bool was_degraded = results[profile].degraded;
+        results[profile] = result;
+        portEXIT_CRITICAL(&lock);
+
+        if (result.degraded != was_degraded) {
+            LOG_BLE("[WEAR] Profile %u %s: flow %.2f -> %.2f g/s (-%.0f%%, change %d sessions ago), latency %.0f -> %.0f ms, "
+                    "%+.1f s per %.1fg dose, %+.1f s in %d doses\n",
+                    (unsigned)profile + 1, result.degraded ? "degraded" : "recovered", result.baseline_flow_g_per_s,
+                    result.recent_flow_g_per_s, result.flow_drop * 100.0f, result.flow_change_age,
+                    result.baseline_latency_ms, result.recent_latency_ms, result.time_increase_s, result.dose_g,
+                    result.projected_increase_s, GRIND_WEAR_PROJECTION_DOSES);
+        }
+        any_degraded |= result.degraded;
+    }
+    return any_degraded;
+}
+
+void ThroughputTrend::reset() {
+    SessionSummary newest;
+    if (grind_logger.get_session_summaries().get_latest(0, &newest)) {
+        reset_session_id = newest.session_id;
+        Preferences prefs;
+        prefs.begin("wear", false);
+        prefs.putUInt("reset_id", reset_session_id);
+        prefs.end();
+        LOG_BLE("[WEAR] Baseline reset after session %lu\n", (unsigned long)reset_session_id);
+    }
+    update();
+}
+
+bool ThroughputTrend::get_result(uint8_t profile, ThroughputTrendResult* out) const {
+    if (profile >= USER_PROFILE_COUNT) {
+        return false;
+    }
+    portENTER_CRITICAL(&lock);
+    *out = results[profile];
+    portEXIT_CRITICAL(&lock);
+    return true;
+}
+
+int ThroughputTrend::get_worst_profile() const {
+    int worst = -1;
+    portENTER_CRITICAL(&lock);
+    for (uint8_t profile = 0; profile < USER_PROFILE_COUNT; profile++) {
+        if (results[profile].degraded && (worst < 0 || results[profile].flow_drop > results[worst].flow_drop)) {
+            worst = profile;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return worst;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "../config/user.h"
+#include "../config/grind_control.h"
+
+// Flow and latency trend of one profile's completed weight grinds
+struct ThroughputTrendResult {
+    uint16_t sessions;                 // Sessions judged; below GRIND_WEAR_MIN_SESSIONS the rest is not set
+    float baseline_flow_g_per_s;       // Mean of the oldest GRIND_WEAR_BASELINE_SESSIONS
+    float recent_flow_g_per_s;         // Mean of the newest GRIND_WEAR_RECENT_SESSIONS
+    float baseline_latency_ms;
+    float recent_latency_ms;
+    float flow_drop;                   // 1 - recent / baseline flow
+    float dose_g;                      // Mean target of the recent sessions
+    float time_increase_s;             // Time per dose now over the baseline's, latency plus dose / flow
+    float projected_increase_s;        // The same GRIND_WEAR_PROJECTION_DOSES doses from now, on the flow slope
+    int16_t flow_change_age;           // Sessions since the flow change point, -1: none
+    int16_t latency_change_age;        // Sessions since the latency change point, -1: none
+    bool degraded;                     // Flow change point and flow_drop >= GRIND_WEAR_FLOW_DROP_THRESHOLD
+};
+
+/**
+ * ThroughputTrend - Burr wear seen as slowing flow in the session summaries
+ *
+ * Worn burrs cut less per revolution: mean flow falls and grind time per dose
+ * creeps up over weeks, too slowly for anyone to notice at the grinder. update()
+ * replays the session summary table oldest first (DiagnosticsController, when a
+ * session is appended) and keeps, per profile, only completed weight grinds
+ * newer than the reset point. The oldest GRIND_WEAR_BASELINE_SESSIONS set a
+ * baseline mean and spread of flow and motor-to-flow latency; after them a
+ * one-sided CUSUM per signal (flow down, latency up, in baseline std devs)
+ * marks the session where a lasting shift began, and a least-squares slope of
+ * flow per session extrapolates it. A profile is degraded once its flow has a
+ * change point and the newest sessions flow GRIND_WEAR_FLOW_DROP_THRESHOLD
+ * below the baseline; time per dose is latency plus dose / flow, now and
+ * GRIND_WEAR_PROJECTION_DOSES doses on.
+ *
+ * A finer grind setting slows flow just the same, so the message names both
+ * causes. reset() (diagnostics reset in the menu, after a burr change or a new
+ * setting) moves the baseline past the sessions held; the reset point is the
+ * newest session id, kept in NVS. Results are copied out under a spinlock.
+ */
+class ThroughputTrend {
+public:
+    ThroughputTrend();
+
+    void begin();                               // Load the reset point
+    bool update();                              // Replay the table; true if any profile is degraded
+    void reset();                               // Judge only sessions from now on
+
+    bool get_result(uint8_t profile, ThroughputTrendResult* out) const;
+    int get_worst_profile() const;              // Degraded profile with the largest drop, -1: none
+
+private:
+    mutable portMUX_TYPE lock;
+    ThroughputTrendResult results[USER_PROFILE_COUNT] = {};
+    uint32_t reset_session_id = 0;
+};
+
+extern ThroughputTrend throughput_trend;
@@ -4,8 +4,11 @@
 #include "hardware/hardware_manager.h"
 #include "system/state_machine.h"
 #include "system/statistics_manager.h"
+#include "system/preference_cache.h"
 #include "controllers/profile_controller.h"
 #include "controllers/grind_controller.h"
+#include "controllers/grind_channels.h"
+#include "controllers/profile_store.h"
 #include "ui/ui_manager.h"
 #include "config/constants.h"
 #include "bluetooth/manager.h"
@@ -13,24 +16,61 @@
 #include "tasks/weight_sampling_task.h"
 #include "tasks/grind_control_task.h"
 #include "tasks/file_io_task.h"
+#include "logging/deferred_log.h"
+#include "system/memory_arena.h"
+#include "system/perf_counters.h"
+#include "system/telemetry.h"
+#include "system/boot_sequence.h"
+#include "system/power_manager.h"
+#include "system/storage_benchmark.h"
+#include "system/crash_snapshot.h"
+#include "network/mqtt_manager.h"
+#include "network/web_dashboard.h"
+#if DEBUG_ENABLE_LOADCELL_HIL
+#include "hardware/adc_stream_load_cell_driver.h"
+#endif
+#include <esp_timer.h>
 
 HardwareManager hardware_manager;
 StateMachine state_machine;
 ProfileController profile_controller;
 GrindController grind_controller;
+#if HW_GRINDER_CHANNELS > 1
+GrindController extra_grind_controllers[HW_GRINDER_CHANNELS - 1];   // GrindChannels 1..N-1
+#endif
 UIManager ui_manager;
 BluetoothManager g_bluetooth_manager;
 BluetoothManager& bluetooth_manager = g_bluetooth_manager;
 
 #if SYS_ENABLE_REALTIME_HEARTBEAT
-// Core 1 timing metrics (global scope for main loop access)
-static uint32_t core1_cycle_count_10s = 0;
-static uint32_t core1_cycle_time_sum_ms = 0;
-static uint32_t core1_cycle_time_min_ms = UINT32_MAX;
-static uint32_t core1_cycle_time_max_ms = 0;
+// Core 1 main loop heartbeat; the cycle timing itself lives in perf_counters
 static uint32_t core1_last_heartbeat_time = 0;
 #endif
 
+// One-shot Core 0 job: mounts LittleFS while Core 1 brings up the display, then
+// runs the HX711 power cycle and stabilization (~3.5 s) while Core 1 finishes setup
+static void boot_core0_job(void*) {
+    int64_t mount_start_us = esp_timer_get_time();
+    bool mounted = LittleFS.begin(true);
+#if FEATURE_DEBUG_TOOLS
+    storage_benchmark.set_mount_time_us((uint32_t)(esp_timer_get_time() - mount_start_us));
+#endif
+    if (!mounted) {
+        LOG_BLE("ERROR: LittleFS mount failed - continuing without filesystem\n");
+    } else {
+        LOG_BLE("✅ LittleFS mounted successfully\n");
+    }
+    boot_sequence.mark(BootStage::FILESYSTEM);
+    
+    // Sensor config and calibration prefs come from HardwareManager::init() on Core 1
+    boot_sequence.wait(BootStage::HARDWARE);
+    if (!weight_sampling_task.initialize_hx711_hardware()) {
+        LOG_BLE("ERROR: Failed to initialize HX711 hardware on Core 0\n");
+    }
+    boot_sequence.mark(BootStage::LOAD_CELL);
+    vTaskDelete(nullptr);
+}
+
 void setup() {
     Serial.begin(HW_SERIAL_BAUD_RATE);
 #ifdef UI_DEBUG_SERIAL_DELAY_MS
@@ -54,27 +94,69 @@ void setup() {
         default: break;
     }
     LOG_BLE("[STARTUP] Reset reason: %s (%d)\n", rr_str, rr);
+    // The previous run's crash record, if it left one, before anything can overwrite it
+    crash_snapshot.begin();
+    boot_sequence.begin();
+
+    // Core 0 tasks log through the deferred ring; FileIOTask prints it
+    if (!deferred_log.begin()) {
+        LOG_BLE("ERROR: Failed to create real-time log ring\n");
+    }
+
+    // Reserve the scratch arenas before anything allocates per-session buffers
+    file_arena.begin();
+    session_arena.begin();
     
     
     // Early startup heartbeat - helps capture initialization sequence
     LOG_BLE("[STARTUP] Initializing ESP32-S3 Coffee Scale - Build %d - Core1 active\n", BUILD_NUMBER);
     
-    // Initialize LittleFS once - format if necessary
-    if (!LittleFS.begin(true)) {
-        LOG_BLE("ERROR: LittleFS mount failed - continuing without filesystem\n");
-    } else {
-        LOG_BLE("✅ LittleFS mounted successfully\n");
+    // LittleFS (formatted if necessary) and the HX711 come up on Core 0 meanwhile
+    if (xTaskCreatePinnedToCore(boot_core0_job, "Boot", SYS_TASK_BOOT_STACK_SIZE, nullptr,
+                                SYS_TASK_PRIORITY_BOOT, nullptr, SYS_TASK_CORE_BOOT) != pdPASS) {
+        LOG_BLE("ERROR: Failed to start Core 0 boot job - system cannot start\n");
+        while (true) {
+            delay(1000);
+        }
     }
     
     hardware_manager.init();
+    weight_sampling_task.init(hardware_manager.get_weight_sensor(0), &grind_logger);
+    // Further grinders' scales come up in the same Core 0 boot job
+    for (uint8_t ch = 1; ch < HW_GRINDER_CHANNELS; ch++) {
+        weight_sampling_task.set_channel_sensor(ch, hardware_manager.get_weight_sensor(ch));
+    }
+    boot_sequence.mark(BootStage::HARDWARE);
+    
+    preference_cache.init(hardware_manager.get_preferences());
     profile_controller.init(hardware_manager.get_preferences());
-    statistics_manager.init(hardware_manager.get_preferences());
-    grind_controller.init(hardware_manager.get_load_cell(), hardware_manager.get_grinder(), hardware_manager.get_preferences());
+    // Statistics journal, profile store and grind logger need the filesystem
+    boot_sequence.wait(BootStage::FILESYSTEM);
+    for (uint8_t ch = 0; ch < HW_GRINDER_CHANNELS; ch++) {
+        channel_statistics(ch).init(hardware_manager.get_preferences(), ch);
+    }
+    profile_store.begin();
+    grind_controller.init(hardware_manager.get_weight_sensor(0), hardware_manager.get_grinder(0), hardware_manager.get_preferences());
+    grind_channels.add(&grind_controller, hardware_manager.get_weight_sensor(0), hardware_manager.get_grinder(0));
+#if HW_GRINDER_CHANNELS > 1
+    for (uint8_t ch = 1; ch < HW_GRINDER_CHANNELS; ch++) {
+        GrindController& extra = extra_grind_controllers[ch - 1];
+        extra.init(hardware_manager.get_weight_sensor(ch), hardware_manager.get_grinder(ch),
+                   hardware_manager.get_channel_preferences(ch), ch, hardware_manager.get_channel_config(ch));
+        grind_channels.add(&extra, hardware_manager.get_weight_sensor(ch), hardware_manager.get_grinder(ch));
+    }
+#endif
+#if DEBUG_ENABLE_LOADCELL_HIL
+    AdcStreamLoadCellDriver::load_tracks(grind_logger);     // Initialized by GrindController::init()
+#endif
     
     // Set up the reference so HardwareManager can query GrindController state
     hardware_manager.set_grind_controller(&grind_controller);
+    profile_controller.set_grind_controller(&grind_controller);
     
     bluetooth_manager.init(hardware_manager.get_preferences());
+    boot_sequence.mark(BootStage::CONTROLLERS);
+    print_memory_report();
     
     // Check for OTA failure to determine initial state
     String failed_ota_build = bluetooth_manager.check_ota_failure_after_boot();
@@ -94,6 +176,9 @@ void setup() {
     }
     
     ui_manager.init(&hardware_manager, &state_machine, &profile_controller, &grind_controller, &bluetooth_manager);
+    // Put the initial screen on the panel now rather than on the UI task's first cycle
+    hardware_manager.get_display()->render_now();
+    boot_sequence.mark(BootStage::FIRST_FRAME);
     
     // Store OTA failure info in ui_manager if needed
     if (ota_failed) {
@@ -109,16 +194,16 @@ void setup() {
         }
     });
     
-    // Enable BLE by default during bootup with 2-minute timeout
-    // (Previously disabled by default for security, now enabled for user convenience)
-    bluetooth_manager.enable_during_bootup();
-    
     // Initialize individual task modules BEFORE TaskManager creates FreeRTOS tasks
     // This ensures all task dependencies are ready before tasks start running
     LOG_BLE("[STARTUP] Initializing task module dependencies...\n");
-    weight_sampling_task.init(hardware_manager.get_load_cell(), &grind_logger);
-    grind_control_task.init(&grind_controller, hardware_manager.get_load_cell(), 
-                           hardware_manager.get_grinder(), &grind_logger);
+    grind_control_task.init(&grind_controller, hardware_manager.get_weight_sensor(0), 
+                           hardware_manager.get_grinder(0), &grind_logger);
+    for (uint8_t ch = 0; ch < HW_GRINDER_CHANNELS; ch++) {
+        channel_telemetry(ch).init(&hardware_manager.get_grinder(ch)->get_edge_timeline());
+    }
+    // DFS from here on; boot ran at the full clock
+    power_manager.init();
     
     LOG_BLE("✅ Task module dependencies initialized\n");
     
@@ -134,10 +219,20 @@ void setup() {
         }
     }
     
+    boot_sequence.mark(BootStage::TASKS);
     LOG_BLE("✅ TaskManager initialized successfully\n");
     
     // Initialize remaining task modules that depend on TaskManager queues
-    file_io_task.init(task_manager.get_file_io_queue());
+    file_io_task.init(task_manager.get_file_io_session_ring(), task_manager.get_file_io_preference_ring(),
+                      task_manager.get_file_io_log_ring());
+
+#if NETWORK_MQTT_ENABLED
+    // Wi-Fi and the broker connect in the background; the grinder works without them
+    mqtt_manager.begin();
+#endif
+#if NETWORK_WEB_ENABLED
+    web_dashboard.begin();                  // Serves once the MQTT task has joined Wi-Fi
+#endif
     
     LOG_BLE("✅ All task modules initialized\n");
 }
@@ -147,45 +242,13 @@ void loop() {
 
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // Core 1 main loop timing (monitor main loop health)
+    int64_t cycle_start_us = esp_timer_get_time();
     uint32_t cycle_start_time = millis();
-    core1_cycle_count_10s++;
     if (core1_last_heartbeat_time == 0) core1_last_heartbeat_time = cycle_start_time;
 #endif
 
-    // Update device uptime statistics every 15 minutes, reporting back in hours
-    static uint32_t last_uptime_update = 0;
-    static uint32_t pending_uptime_minutes = 0;
-    uint32_t current_time = millis();
-    if (last_uptime_update == 0) {
-        last_uptime_update = current_time;
-    }
-    constexpr uint32_t kUptimeIntervalMs = 900000; // 15 minutes
-    constexpr uint32_t kUptimeIntervalMinutes = 15;
-    uint32_t elapsed_ms = current_time - last_uptime_update;
-    if (elapsed_ms >= kUptimeIntervalMs) {
-        uint32_t intervals = elapsed_ms / kUptimeIntervalMs;
-        pending_uptime_minutes += intervals * kUptimeIntervalMinutes;
-        last_uptime_update += intervals * kUptimeIntervalMs;
-
-        if (pending_uptime_minutes > 0) {
-            statistics_manager.update_uptime(pending_uptime_minutes);
-            pending_uptime_minutes = 0;
-        }
-    }
-    
-    // Check OTA state and suspend hardware tasks if needed
-    static bool hardware_suspended = false;
-    bool ota_active = bluetooth_manager.is_updating();
-    
-    if (ota_active && !hardware_suspended) {
-        task_manager.suspend_hardware_tasks();
-        hardware_suspended = true;
-        LOG_BLE("[MAIN] Hardware tasks suspended for OTA\n");
-    } else if (!ota_active && hardware_suspended) {
-        task_manager.resume_hardware_tasks();
-        hardware_suspended = false;
-        LOG_BLE("[MAIN] Hardware tasks resumed after OTA\n");
-    }
+    // Periodic jobs (diagnostics, screen timeout, uptime) run from TaskManager's software timers;
+    // OTA task suspension is handled on the Bluetooth task.
     
     // UI events are now processed inside the UI render FreeRTOS task
     // to serialize all LVGL updates on a single thread.
@@ -193,32 +256,26 @@ void loop() {
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // Calculate Core 1 main loop timing
     uint32_t cycle_end_time = millis();
-    uint32_t cycle_duration = cycle_end_time - cycle_start_time;
-    core1_cycle_time_sum_ms += cycle_duration;
-    if (cycle_duration < core1_cycle_time_min_ms) core1_cycle_time_min_ms = cycle_duration;
-    if (cycle_duration > core1_cycle_time_max_ms) core1_cycle_time_max_ms = cycle_duration;
+    perf_counters.record(PerfTimer::MAIN_LOOP_CYCLE, (uint32_t)(esp_timer_get_time() - cycle_start_us));
     
     // Core 1 Main Loop Heartbeat - Monitor main loop health (every 10 seconds)
     if (cycle_end_time - core1_last_heartbeat_time >= SYS_REALTIME_HEARTBEAT_INTERVAL_MS) {
-        uint32_t avg_cycle_time = core1_cycle_count_10s > 0 ? core1_cycle_time_sum_ms / core1_cycle_count_10s : 0;
+        PerfTimerWindow cycles = perf_counters.get_window(PerfTimer::MAIN_LOOP_CYCLE);
         
         // Get system states
-        bool is_grinding = grind_controller.is_active();
+        bool is_grinding = grind_channels.any_active();
         const char* ble_state = bluetooth_manager.is_enabled() ? 
                                (bluetooth_manager.is_connected() ? "CONN" : "ADV") : "OFF";
         const char* grinder_state = is_grinding ? "ACTIVE" : "IDLE";
         const char* tasks_status = task_manager.are_tasks_healthy() ? "HEALTHY" : "ERROR";
         size_t free_heap_kb = ESP.getFreeHeap() / 1024;
         
-        LOG_BLE("[%lums MAIN_LOOP_HEARTBEAT] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | Tasks: %s | BLE: %s | Grinder: %s | Mem: %zuKB | Build: #%d\n",
-               millis(), core1_cycle_count_10s, avg_cycle_time, core1_cycle_time_min_ms, core1_cycle_time_max_ms,
+        LOG_BLE("[%lums MAIN_LOOP_HEARTBEAT] Cycles: %lu/10s | Avg: %luus (%lu-%luus) | Tasks: %s | BLE: %s | Grinder: %s | Mem: %zuKB | Build: #%d\n",
+               millis(), cycles.count, cycles.avg_us, cycles.min_us, cycles.max_us,
                tasks_status, ble_state, grinder_state, free_heap_kb, BUILD_NUMBER);
         
         // Reset Core 1 metrics for next interval
-        core1_cycle_count_10s = 0;
-        core1_cycle_time_sum_ms = 0;
-        core1_cycle_time_min_ms = UINT32_MAX;
-        core1_cycle_time_max_ms = 0;
+        perf_counters.reset_window(PerfTimer::MAIN_LOOP_CYCLE);
         core1_last_heartbeat_time = cycle_end_time;
     }
 #endif
@@ -0,0 +1,154 @@
+#pragma once
+
+// Host build (env:native) stand-in for the Arduino-ESP32 core: the subset the
+// control core uses, timed by the virtual clock in native_sim.h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include "native_sim.h"
+
+using std::min;
+using std::max;
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define ARDUINO_ISR_ATTR
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define FALLING 0x02
+#define RISING 0x01
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+inline uint32_t getCpuFrequencyMhz() { return 240; }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterruptArg(uint8_t, void (*)(void*), void*, int) {}
+inline void detachInterrupt(uint8_t) {}
+
+long random(long max_value);
+long random(long min_value, long max_value);
+
+template<typename T, typename L, typename H>
+T constrain(T value, L low, H high) {
+    return value < low ? (T)low : (value > high ? (T)high : value);
+}
+
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text ? text : "") {}
+    String(const std::string& text) : value(text) {}
+    String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+    String(float number, unsigned int decimals = 2) : value(format_float(number, decimals)) {}
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return (unsigned int)value.size(); }
+    bool isEmpty() const { return value.empty(); }
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const {
+        return value.size() >= suffix.value.size() &&
+               value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+    }
+    int indexOf(const String& text, unsigned int from = 0) const { return to_index(value.find(text.value, from)); }
+    int indexOf(char c, unsigned int from = 0) const { return to_index(value.find(c, from)); }
+    int lastIndexOf(char c) const { return to_index(value.rfind(c)); }
+    String substring(unsigned int from) const { return from < value.size() ? String(value.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < value.size() && to > from ? String(value.substr(from, to - from)) : String();
+    }
+    long toInt() const { return strtol(value.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(value.c_str(), nullptr); }
+    void trim() {
+        size_t begin = value.find_first_not_of(" \t\r\n");
+        size_t end = value.find_last_not_of(" \t\r\n");
+        value = begin == std::string::npos ? std::string() : value.substr(begin, end - begin + 1);
+    }
+
+    String& operator+=(const String& other) { value += other.value; return *this; }
+    String& operator+=(const char* other) { value += other ? other : ""; return *this; }
+    String& operator+=(char c) { value += c; return *this; }
+    friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+    friend String operator+(const String& a, const char* b) { return String(a.value + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.value); }
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator==(const char* other) const { return value == (other ? other : ""); }
+    bool operator!=(const String& other) const { return value != other.value; }
+    bool operator<(const String& other) const { return value < other.value; }
+
+private:
+    std::string value;
+
+    static int to_index(size_t position) { return position == std::string::npos ? -1 : (int)position; }
+    static std::string format_float(float number, unsigned int decimals) {
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, number);
+        return buffer;
+    }
+};
+
+// Serial prints to stdout; input is never available
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* text) { return native_sim::is_serial_output_enabled() && fputs(text, stdout) >= 0 ? strlen(text) : 0; }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t print(int number) { return native_sim::is_serial_output_enabled() ? (size_t)::printf("%d", number) : 0; }
+    size_t print(unsigned int number) { return native_sim::is_serial_output_enabled() ? (size_t)::printf("%u", number) : 0; }
+    size_t print(long number) { return native_sim::is_serial_output_enabled() ? (size_t)::printf("%ld", number) : 0; }
+    size_t print(unsigned long number) { return native_sim::is_serial_output_enabled() ? (size_t)::printf("%lu", number) : 0; }
+    size_t print(double number, int decimals = 2) { return native_sim::is_serial_output_enabled() ? (size_t)::printf("%.*f", decimals, number) : 0; }
+    template<typename T> size_t println(const T& value) { size_t n = print(value); return n + print("\n"); }
+    size_t println() { return print("\n"); }
+    size_t write(uint8_t c) { return native_sim::is_serial_output_enabled() && fputc(c, stdout) != EOF ? 1 : 0; }
+    size_t write(const uint8_t* data, size_t length) { return native_sim::is_serial_output_enabled() ? fwrite(data, 1, length, stdout) : 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() { fflush(stdout); }
+    operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 256 * 1024; }
+    uint32_t getMinFreeHeap() { return 256 * 1024; }
+    uint32_t getMaxAllocHeap() { return 128 * 1024; }
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint32_t getFreePsram() { return 8 * 1024 * 1024; }
+    uint32_t getPsramSize() { return 8 * 1024 * 1024; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    void restart() { exit(0); }
+};
+extern EspClass ESP;
@@ -0,0 +1,6 @@
+#pragma once
+
+// Host build: opaque display driver types (see lvgl.h)
+
+class Arduino_DataBus;
+class Arduino_GFX;
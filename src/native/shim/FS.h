@@ -0,0 +1,77 @@
+#pragma once
+
+// Host build file system: paths map below native_sim::get_fs_root()
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <memory>
+#include "Arduino.h"
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class FileImpl;
+
+class File {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+    operator bool() const;
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t length);
+    size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t println(const char* text = "") { return print(text) + print("\n"); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    int available();
+    int read();
+    size_t read(uint8_t* buffer, size_t length);
+    size_t readBytes(char* buffer, size_t length) { return read((uint8_t*)buffer, length); }
+    bool seek(uint32_t position, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void flush();
+    void close();
+    const char* path() const;
+    const char* name() const;
+    bool isDirectory() const;
+    File openNextFile(const char* mode = FILE_READ);
+    void rewindDirectory();
+
+private:
+    std::shared_ptr<FileImpl> impl;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+};
+
+}
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
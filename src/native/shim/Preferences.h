@@ -0,0 +1,61 @@
+#pragma once
+
+// Host build NVS: namespaces live in process memory (native_sim::clear_preferences() forgets them)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "Arduino.h"
+
+class Preferences {
+public:
+    bool begin(const char* name, bool read_only = false, const char* partition_label = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+    size_t freeEntries() { return 512; }
+
+    size_t putBool(const char* key, bool value) { return put_value(key, value); }
+    size_t putUChar(const char* key, uint8_t value) { return put_value(key, value); }
+    size_t putUShort(const char* key, uint16_t value) { return put_value(key, value); }
+    size_t putInt(const char* key, int32_t value) { return put_value(key, value); }
+    size_t putUInt(const char* key, uint32_t value) { return put_value(key, value); }
+    size_t putLong(const char* key, int32_t value) { return put_value(key, value); }
+    size_t putULong(const char* key, uint32_t value) { return put_value(key, value); }
+    size_t putLong64(const char* key, int64_t value) { return put_value(key, value); }
+    size_t putULong64(const char* key, uint64_t value) { return put_value(key, value); }
+    size_t putFloat(const char* key, float value) { return put_value(key, value); }
+    size_t putDouble(const char* key, double value) { return put_value(key, value); }
+    size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value) + 1); }
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t length);
+
+    bool getBool(const char* key, bool default_value = false) { return get_value(key, default_value); }
+    uint8_t getUChar(const char* key, uint8_t default_value = 0) { return get_value(key, default_value); }
+    uint16_t getUShort(const char* key, uint16_t default_value = 0) { return get_value(key, default_value); }
+    int32_t getInt(const char* key, int32_t default_value = 0) { return get_value(key, default_value); }
+    uint32_t getUInt(const char* key, uint32_t default_value = 0) { return get_value(key, default_value); }
+    int32_t getLong(const char* key, int32_t default_value = 0) { return get_value(key, default_value); }
+    uint32_t getULong(const char* key, uint32_t default_value = 0) { return get_value(key, default_value); }
+    int64_t getLong64(const char* key, int64_t default_value = 0) { return get_value(key, default_value); }
+    uint64_t getULong64(const char* key, uint64_t default_value = 0) { return get_value(key, default_value); }
+    float getFloat(const char* key, float default_value = NAN) { return get_value(key, default_value); }
+    double getDouble(const char* key, double default_value = NAN) { return get_value(key, default_value); }
+    size_t getString(const char* key, char* value, size_t max_length);
+    String getString(const char* key, const String& default_value = String());
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buffer, size_t max_length);
+
+private:
+    std::string name_space;
+    bool opened = false;
+    bool read_only = false;
+
+    template<typename T> size_t put_value(const char* key, T value) { return putBytes(key, &value, sizeof(value)); }
+    template<typename T> T get_value(const char* key, T default_value) {
+        T value;
+        return getBytesLength(key) == sizeof(T) && getBytes(key, &value, sizeof(T)) == sizeof(T) ? value : default_value;
+    }
+};
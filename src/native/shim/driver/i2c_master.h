@@ -0,0 +1,6 @@
+#pragma once
+
+// Host build: opaque I2C handles so driver headers parse
+
+typedef struct native_i2c_bus* i2c_master_bus_handle_t;
+typedef struct native_i2c_device* i2c_master_dev_handle_t;
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "rmt_types.h"
+
+typedef struct {
+    int reserved;
+} rmt_copy_encoder_config_t;
+
+inline esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t*, rmt_encoder_handle_t* out_encoder) {
+    *out_encoder = nullptr;
+    return ESP_ERR_NOT_FOUND;
+}
+inline esp_err_t rmt_del_encoder(rmt_encoder_handle_t) { return ESP_OK; }
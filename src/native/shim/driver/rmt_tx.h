@@ -0,0 +1,25 @@
+#pragma once
+
+#include "rmt_types.h"
+
+typedef struct {
+    gpio_num_t gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    size_t trans_queue_depth;
+} rmt_tx_channel_config_t;
+
+typedef struct {
+    int loop_count;
+} rmt_transmit_config_t;
+
+typedef struct {
+    rmt_tx_done_callback_t on_trans_done;
+} rmt_tx_event_callbacks_t;
+
+inline esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t*, rmt_channel_handle_t*) { return ESP_ERR_NOT_FOUND; }
+inline esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t, const rmt_tx_event_callbacks_t*, void*) { return ESP_OK; }
+inline esp_err_t rmt_enable(rmt_channel_handle_t) { return ESP_OK; }
+inline esp_err_t rmt_disable(rmt_channel_handle_t) { return ESP_OK; }
+inline esp_err_t rmt_transmit(rmt_channel_handle_t, rmt_encoder_handle_t, const void*, size_t, const rmt_transmit_config_t*) { return ESP_OK; }
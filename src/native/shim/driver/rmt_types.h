@@ -0,0 +1,31 @@
+#pragma once
+
+// Host build RMT: the mock paths never transmit; these let the real paths compile
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../esp_err.h"
+#include "gpio.h"
+
+typedef struct native_rmt_channel* rmt_channel_handle_t;
+typedef struct native_rmt_encoder* rmt_encoder_handle_t;
+
+typedef enum {
+    RMT_CLK_SRC_DEFAULT = 0
+} rmt_clock_source_t;
+
+typedef union {
+    struct {
+        uint16_t duration0 : 15;
+        uint16_t level0 : 1;
+        uint16_t duration1 : 15;
+        uint16_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef struct {
+    size_t num_symbols;
+} rmt_tx_done_event_data_t;
+
+typedef bool (*rmt_tx_done_callback_t)(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t* event_data, void* user_ctx);
@@ -0,0 +1,9 @@
+#pragma once
+
+// Host build CPU cycle counter: the virtual clock (native_sim.h) at 240 MHz, or the
+// host's steady clock after native_sim::set_wall_cycle_count(true)
+
+#include <stdint.h>
+#include "native_sim.h"
+
+inline uint32_t esp_cpu_get_cycle_count() { return native_sim::cycle_count(); }
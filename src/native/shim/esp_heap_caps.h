@@ -0,0 +1,21 @@
+#pragma once
+
+// Host build heap: every capability maps to the host allocator
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT      (1 << 2)
+#define MALLOC_CAP_DMA       (1 << 3)
+#define MALLOC_CAP_INTERNAL  (1 << 11)
+#define MALLOC_CAP_SPIRAM    (1 << 10)
+#define MALLOC_CAP_DEFAULT   (1 << 12)
+
+inline void* heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
+inline void* heap_caps_calloc(size_t count, size_t size, uint32_t) { return calloc(count, size); }
+inline void* heap_caps_realloc(void* ptr, size_t size, uint32_t) { return realloc(ptr, size); }
+inline void heap_caps_free(void* ptr) { free(ptr); }
+inline size_t heap_caps_get_free_size(uint32_t) { return 8 * 1024 * 1024; }
+inline size_t heap_caps_get_minimum_free_size(uint32_t) { return 8 * 1024 * 1024; }
+inline size_t heap_caps_get_largest_free_block(uint32_t) { return 4 * 1024 * 1024; }
@@ -0,0 +1,6 @@
+#pragma once
+
+// Host build: opaque panel IO types so display_manager.h parses; no display code is built
+
+typedef struct esp_lcd_panel_io_t* esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_panel_io_event_data_t esp_lcd_panel_io_event_data_t;
@@ -0,0 +1,31 @@
+#pragma once
+
+// Host build power management: nothing to scale, so configuration is refused
+// and PowerManager only tracks its holds
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ESP_ERR_NOT_SUPPORTED   0x106
+
+typedef enum {
+    ESP_PM_CPU_FREQ_MAX,
+    ESP_PM_APB_FREQ_MAX,
+    ESP_PM_NO_LIGHT_SLEEP,
+} esp_pm_lock_type_t;
+
+typedef struct {
+    int max_freq_mhz;
+    int min_freq_mhz;
+    bool light_sleep_enable;
+} esp_pm_config_t;
+
+typedef struct esp_pm_lock* esp_pm_lock_handle_t;
+
+inline esp_err_t esp_pm_configure(const void*) { return ESP_ERR_NOT_SUPPORTED; }
+inline esp_err_t esp_pm_lock_create(esp_pm_lock_type_t, int, const char*, esp_pm_lock_handle_t* out_handle) {
+    *out_handle = nullptr;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+inline esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t) { return ESP_ERR_NOT_SUPPORTED; }
+inline esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t) { return ESP_ERR_NOT_SUPPORTED; }
@@ -0,0 +1,37 @@
+#pragma once
+
+// Host build FreeRTOS: one thread runs every task, the tick is the virtual millisecond
+
+#include <stdint.h>
+#include <stddef.h>
+#include "native_sim.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE  ((BaseType_t)0)
+#define pdTRUE   ((BaseType_t)1)
+#define pdPASS   pdTRUE
+#define pdFAIL   pdFALSE
+#define errQUEUE_FULL ((BaseType_t)0)
+
+#define portMAX_DELAY       ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS  ((TickType_t)1)
+#define configTICK_RATE_HZ  1000
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+typedef struct {
+    int owner;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+
+#define portENTER_CRITICAL(mux)      ((void)(mux))
+#define portEXIT_CRITICAL(mux)       ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux)  ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)   ((void)(mux))
+#define taskENTER_CRITICAL(mux)      ((void)(mux))
+#define taskEXIT_CRITICAL(mux)       ((void)(mux))
+#define portYIELD_FROM_ISR(...)      ((void)0)
+
+BaseType_t xPortGetCoreID();
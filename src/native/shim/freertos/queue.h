@@ -0,0 +1,17 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Fixed-size copy queue; sends never block (a full queue fails at once whatever the timeout)
+typedef struct native_queue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higher_priority_task_woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item_out, TickType_t ticks_to_wait);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item_out, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+BaseType_t xQueueReset(QueueHandle_t queue);
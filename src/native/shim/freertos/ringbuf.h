@@ -0,0 +1,20 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// No-split byte ring: variable-length items, each costing an 8-byte header plus its size rounded
+// up to 4 bytes like ESP-IDF's. Sends never block; one received item is held until returned.
+typedef struct native_ringbuf* RingbufHandle_t;
+
+typedef enum {
+    RINGBUF_TYPE_NOSPLIT = 0,
+} RingbufferType_t;
+
+RingbufHandle_t xRingbufferCreate(size_t buffer_size, RingbufferType_t type);
+void vRingbufferDelete(RingbufHandle_t ringbuf);
+BaseType_t xRingbufferSend(RingbufHandle_t ringbuf, const void* item, size_t item_size, TickType_t ticks_to_wait);
+BaseType_t xRingbufferSendAcquire(RingbufHandle_t ringbuf, void** item, size_t item_size, TickType_t ticks_to_wait);
+BaseType_t xRingbufferSendComplete(RingbufHandle_t ringbuf, void* item);
+void* xRingbufferReceive(RingbufHandle_t ringbuf, size_t* item_size, TickType_t ticks_to_wait);
+void vRingbufferReturnItem(RingbufHandle_t ringbuf, void* item);
+size_t xRingbufferGetCurFreeSize(RingbufHandle_t ringbuf);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Single-threaded host: mutexes always succeed
+typedef struct {
+    int reserved;
+} StaticSemaphore_t;
+typedef StaticSemaphore_t* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buffer) { return buffer; }
+SemaphoreHandle_t xSemaphoreCreateMutex();
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return xSemaphoreCreateMutex(); }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t) { return semaphore ? pdTRUE : pdFALSE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) { return semaphore ? pdTRUE : pdFALSE; }
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks) { return xSemaphoreTake(semaphore, ticks); }
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) { return xSemaphoreGive(semaphore); }
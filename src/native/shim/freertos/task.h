@@ -0,0 +1,38 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef struct native_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+TickType_t xTaskGetTickCount();
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previous_wake_time, TickType_t increment);
+inline BaseType_t xTaskDelayUntil(TickType_t* previous_wake_time, TickType_t increment) {
+    vTaskDelayUntil(previous_wake_time, increment);
+    return pdTRUE;
+}
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+// Notifications are counted per handle; nothing blocks on the host
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+// Notification values are not kept: no host task waits on bits
+inline BaseType_t xTaskNotify(TaskHandle_t, uint32_t, eNotifyAction) { return pdPASS; }
@@ -0,0 +1,22 @@
+#pragma once
+
+// Host build: opaque LVGL types so headers that mention the display parse; no UI code is built
+
+#include <stdint.h>
+
+typedef struct _lv_display_t lv_display_t;
+typedef struct _lv_indev_t lv_indev_t;
+typedef struct _lv_event_t lv_event_t;
+typedef struct _lv_obj_t lv_obj_t;
+typedef struct _lv_indev_data_t lv_indev_data_t;
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} lv_area_t;
+typedef struct {
+    uint8_t blue;
+    uint8_t green;
+    uint8_t red;
+} lv_color_t;
@@ -0,0 +1,843 @@
+#include "native_sim.h"
+#include "Arduino.h"
+#include "Preferences.h"
+#include "LittleFS.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <chrono>
+#include <dirent.h>
+#include <deque>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// VIRTUAL CLOCK AND ESP_TIMER
+//==============================================================================
+struct native_esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    bool active;
+    int64_t due_us;
+};
+
+namespace {
+int64_t clock_us = 0;
+native_sim::DelayHook delay_hook = nullptr;
+std::vector<native_esp_timer*> timers;
+std::string fs_root = "native_fs";
+int core_id = 0;
+bool serial_output = true;
+bool wall_cycle_count = false;
+uint32_t random_state = 0x2545F491u;
+
+// Earliest active timer due at or before time_us
+native_esp_timer* next_due_timer(int64_t time_us) {
+    native_esp_timer* next = nullptr;
+    for (native_esp_timer* timer : timers) {
+        if (timer->active && timer->due_us <= time_us && (!next || timer->due_us < next->due_us)) {
+            next = timer;
+        }
+    }
+    return next;
+}
+}
+
+namespace native_sim {
+
+int64_t now_us() {
+    return clock_us;
+}
+
+void advance_to_us(int64_t time_us) {
+    while (native_esp_timer* timer = next_due_timer(time_us)) {
+        clock_us = max(clock_us, timer->due_us);
+        timer->active = false;
+        timer->callback(timer->arg);
+    }
+    clock_us = max(clock_us, time_us);
+}
+
+void set_delay_hook(DelayHook hook) {
+    delay_hook = hook;
+}
+
+void set_fs_root(const char* path) {
+    fs_root = path;
+}
+
+const char* get_fs_root() {
+    return fs_root.c_str();
+}
+
+void set_serial_output(bool enabled) {
+    serial_output = enabled;
+}
+
+bool is_serial_output_enabled() {
+    return serial_output;
+}
+
+void set_core_id(int id) {
+    core_id = id;
+}
+
+void set_wall_cycle_count(bool enabled) {
+    wall_cycle_count = enabled;
+}
+
+uint32_t cycle_count() {
+    if (!wall_cycle_count) {
+        return (uint32_t)(clock_us * 240);
+    }
+    auto elapsed = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint32_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() * 240 / 1000);
+}
+
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle) {
+    if (!create_args || !create_args->callback || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    native_esp_timer* timer = new native_esp_timer{ create_args->callback, create_args->arg, false, 0 };
+    timers.push_back(timer);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->due_us = clock_us + (int64_t)timeout_us;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer || !timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    for (size_t i = 0; i < timers.size(); i++) {
+        if (timers[i] == timer) {
+            timers.erase(timers.begin() + i);
+            delete timer;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer && timer->active;
+}
+
+//==============================================================================
+// ARDUINO CORE
+//==============================================================================
+HardwareSerial Serial;
+EspClass ESP;
+
+int HardwareSerial::printf(const char* format, ...) {
+    if (!native_sim::is_serial_output_enabled()) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vprintf(format, args);
+    va_end(args);
+    return written;
+}
+
+uint32_t millis() {
+    return (uint32_t)(clock_us / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t)clock_us;
+}
+
+void delay(uint32_t ms) {
+    if (delay_hook) {
+        delay_hook(ms);
+    } else {
+        native_sim::advance_us((int64_t)ms * 1000);
+    }
+}
+
+void delayMicroseconds(uint32_t us) {
+    native_sim::advance_us(us);
+}
+
+void yield() {}
+
+uint32_t esp_random() {
+    // xorshift32: deterministic across runs
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+long random(long max_value) {
+    return max_value > 0 ? (long)(esp_random() % (uint32_t)max_value) : 0;
+}
+
+long random(long min_value, long max_value) {
+    return max_value > min_value ? min_value + random(max_value - min_value) : min_value;
+}
+
+//==============================================================================
+// FREERTOS
+//==============================================================================
+struct native_queue {
+    std::vector<uint8_t> storage;
+    UBaseType_t item_size;
+    UBaseType_t length;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+struct native_ringbuf {
+    std::deque<std::vector<uint8_t>> items;     // Sent, oldest first
+    std::vector<std::vector<uint8_t>*> acquired; // Reserved by xRingbufferSendAcquire(), not yet complete
+    size_t capacity;
+    size_t used;
+    bool item_out;                              // Front item handed out by xRingbufferReceive()
+};
+
+struct native_task {
+    uint32_t notify_count;
+};
+
+namespace {
+native_task current_task = { 0 };
+}
+
+BaseType_t xPortGetCoreID() {
+    return core_id;
+}
+
+TickType_t xTaskGetTickCount() {
+    return millis();
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks);
+}
+
+void vTaskDelayUntil(TickType_t* previous_wake_time, TickType_t increment) {
+    TickType_t wake_time = *previous_wake_time + increment;
+    int32_t remaining = (int32_t)(wake_time - xTaskGetTickCount());
+    if (remaining > 0) {
+        delay((uint32_t)remaining);
+    }
+    *previous_wake_time = wake_time;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return &current_task;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken) {
+    if (task) {
+        task->notify_count++;
+    }
+    if (higher_priority_task_woken) {
+        *higher_priority_task_woken = pdFALSE;
+    }
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    vTaskNotifyGiveFromISR(task, nullptr);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t) {
+    uint32_t count = current_task.notify_count;
+    if (count > 0) {
+        current_task.notify_count = clear_on_exit ? 0 : count - 1;
+    }
+    return count;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    if (length == 0 || item_size == 0) {
+        return nullptr;
+    }
+    native_queue* queue = new native_queue;
+    queue->storage.resize((size_t)length * item_size);
+    queue->item_size = item_size;
+    queue->length = length;
+    queue->head = 0;
+    queue->count = 0;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t) {
+    if (!queue || queue->count == queue->length) {
+        return errQUEUE_FULL;
+    }
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(&queue->storage[(size_t)tail * queue->item_size], item, queue->item_size);
+    queue->count++;
+    return pdPASS;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    return xQueueSend(queue, item, ticks_to_wait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higher_priority_task_woken) {
+    if (higher_priority_task_woken) {
+        *higher_priority_task_woken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item_out, TickType_t) {
+    if (!queue || queue->count == 0) {
+        return pdFALSE;
+    }
+    memcpy(item_out, &queue->storage[(size_t)queue->head * queue->item_size], queue->item_size);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item_out, TickType_t ticks_to_wait) {
+    if (xQueuePeek(queue, item_out, ticks_to_wait) != pdPASS) {
+        return pdFALSE;
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue ? queue->count : 0;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    return queue ? queue->length - queue->count : 0;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    if (queue) {
+        queue->head = 0;
+        queue->count = 0;
+    }
+    return pdPASS;
+}
+
+namespace {
+size_t ringbuf_item_cost(size_t item_size) {
+    return 8 + ((item_size + 3) & ~(size_t)3);
+}
+}
+
+RingbufHandle_t xRingbufferCreate(size_t buffer_size, RingbufferType_t) {
+    if (buffer_size == 0) {
+        return nullptr;
+    }
+    native_ringbuf* ringbuf = new native_ringbuf;
+    ringbuf->capacity = buffer_size;
+    ringbuf->used = 0;
+    ringbuf->item_out = false;
+    return ringbuf;
+}
+
+void vRingbufferDelete(RingbufHandle_t ringbuf) {
+    if (ringbuf) {
+        for (std::vector<uint8_t>* item : ringbuf->acquired) {
+            delete item;
+        }
+        delete ringbuf;
+    }
+}
+
+BaseType_t xRingbufferSendAcquire(RingbufHandle_t ringbuf, void** item, size_t item_size, TickType_t) {
+    if (!ringbuf || !item || ringbuf->used + ringbuf_item_cost(item_size) > ringbuf->capacity) {
+        return pdFALSE;
+    }
+    std::vector<uint8_t>* storage = new std::vector<uint8_t>(item_size);
+    ringbuf->used += ringbuf_item_cost(item_size);
+    ringbuf->acquired.push_back(storage);
+    *item = storage->data();
+    return pdTRUE;
+}
+
+BaseType_t xRingbufferSendComplete(RingbufHandle_t ringbuf, void* item) {
+    if (!ringbuf) {
+        return pdFALSE;
+    }
+    for (size_t i = 0; i < ringbuf->acquired.size(); i++) {
+        std::vector<uint8_t>* storage = ringbuf->acquired[i];
+        if (storage->data() == item) {
+            ringbuf->items.push_back(std::move(*storage));
+            delete storage;
+            ringbuf->acquired.erase(ringbuf->acquired.begin() + i);
+            return pdTRUE;
+        }
+    }
+    return pdFALSE;
+}
+
+BaseType_t xRingbufferSend(RingbufHandle_t ringbuf, const void* item, size_t item_size, TickType_t ticks_to_wait) {
+    void* storage = nullptr;
+    if (xRingbufferSendAcquire(ringbuf, &storage, item_size, ticks_to_wait) != pdTRUE) {
+        return pdFALSE;
+    }
+    memcpy(storage, item, item_size);
+    return xRingbufferSendComplete(ringbuf, storage);
+}
+
+void* xRingbufferReceive(RingbufHandle_t ringbuf, size_t* item_size, TickType_t) {
+    if (!ringbuf || ringbuf->items.empty() || ringbuf->item_out) {
+        return nullptr;
+    }
+    ringbuf->item_out = true;
+    if (item_size) {
+        *item_size = ringbuf->items.front().size();
+    }
+    return ringbuf->items.front().data();
+}
+
+void vRingbufferReturnItem(RingbufHandle_t ringbuf, void* item) {
+    if (!ringbuf || !ringbuf->item_out || ringbuf->items.front().data() != item) {
+        return;
+    }
+    ringbuf->used -= ringbuf_item_cost(ringbuf->items.front().size());
+    ringbuf->items.pop_front();
+    ringbuf->item_out = false;
+}
+
+size_t xRingbufferGetCurFreeSize(RingbufHandle_t ringbuf) {
+    return ringbuf ? ringbuf->capacity - ringbuf->used : 0;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new StaticSemaphore_t{ 0 };
+}
+
+//==============================================================================
+// PREFERENCES
+//==============================================================================
+namespace {
+typedef std::map<std::string, std::vector<uint8_t>> PreferenceNamespace;
+std::map<std::string, PreferenceNamespace> preference_store;
+}
+
+namespace native_sim {
+
+void clear_preferences() {
+    preference_store.clear();
+}
+
+}
+
+bool Preferences::begin(const char* name, bool read_only_mode, const char*) {
+    if (!name || !name[0]) {
+        return false;
+    }
+    name_space = name;
+    read_only = read_only_mode;
+    opened = true;
+    if (!read_only) {
+        preference_store[name_space];
+    }
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+}
+
+bool Preferences::clear() {
+    if (!opened || read_only) {
+        return false;
+    }
+    preference_store[name_space].clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || read_only) {
+        return false;
+    }
+    return preference_store[name_space].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return getBytesLength(key) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!opened || read_only || !key || !value) {
+        return 0;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    preference_store[name_space][key].assign(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!opened || !key) {
+        return 0;
+    }
+    auto name_space_entry = preference_store.find(name_space);
+    if (name_space_entry == preference_store.end()) {
+        return 0;
+    }
+    auto entry = name_space_entry->second.find(key);
+    return entry == name_space_entry->second.end() ? 0 : entry->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t max_length) {
+    size_t length = getBytesLength(key);
+    if (length == 0 || length > max_length) {
+        return 0;
+    }
+    memcpy(buffer, preference_store[name_space][key].data(), length);
+    return length;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t max_length) {
+    return getBytes(key, value, max_length);
+}
+
+String Preferences::getString(const char* key, const String& default_value) {
+    size_t length = getBytesLength(key);
+    if (length == 0) {
+        return default_value;
+    }
+    std::vector<char> text(length + 1, 0);
+    getBytes(key, text.data(), length);
+    return String(text.data());
+}
+
+//==============================================================================
+// FILE SYSTEM
+//==============================================================================
+namespace fs {
+
+class FileImpl {
+public:
+    std::string path;       // As the firmware sees it ("/sessions/x.bin")
+    std::string name;       // Last path component
+    FILE* file = nullptr;
+    DIR* dir = nullptr;
+
+    ~FileImpl() { close(); }
+
+    void close() {
+        if (file) {
+            fclose(file);
+            file = nullptr;
+        }
+        if (dir) {
+            closedir(dir);
+            dir = nullptr;
+        }
+    }
+};
+
+namespace {
+std::string host_path(const char* path) {
+    std::string result = native_sim::get_fs_root();
+    if (!path || path[0] != '/') {
+        result += "/";
+    }
+    return result + (path ? path : "");
+}
+
+std::string base_name(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool is_host_directory(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+std::shared_ptr<FileImpl> open_impl(const std::string& path, const char* mode) {
+    std::string host = host_path(path.c_str());
+    auto impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    impl->name = base_name(path);
+    if (is_host_directory(host)) {
+        impl->dir = opendir(host.c_str());
+        return impl->dir ? impl : nullptr;
+    }
+    std::string host_mode = mode && mode[0] ? mode : "r";
+    if (host_mode.find('b') == std::string::npos) {
+        host_mode += "b";
+    }
+    impl->file = fopen(host.c_str(), host_mode.c_str());
+    return impl->file ? impl : nullptr;
+}
+}
+
+File::operator bool() const {
+    return impl && (impl->file || impl->dir);
+}
+
+size_t File::write(const uint8_t* data, size_t length) {
+    return impl && impl->file ? fwrite(data, 1, length, impl->file) : 0;
+}
+
+size_t File::printf(const char* format, ...) {
+    if (!impl || !impl->file) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vfprintf(impl->file, format, args);
+    va_end(args);
+    return written > 0 ? (size_t)written : 0;
+}
+
+int File::available() {
+    if (!impl || !impl->file) {
+        return 0;
+    }
+    long remaining = (long)size() - (long)position();
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* buffer, size_t length) {
+    return impl && impl->file ? fread(buffer, 1, length, impl->file) : 0;
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+    static const int whence[] = { SEEK_SET, SEEK_CUR, SEEK_END };
+    return impl && impl->file && fseek(impl->file, (long)position, whence[mode]) == 0;
+}
+
+size_t File::position() const {
+    return impl && impl->file ? (size_t)ftell(impl->file) : 0;
+}
+
+size_t File::size() const {
+    if (!impl || !impl->file) {
+        return 0;
+    }
+    long current = ftell(impl->file);
+    fseek(impl->file, 0, SEEK_END);
+    long end = ftell(impl->file);
+    fseek(impl->file, current, SEEK_SET);
+    return end > 0 ? (size_t)end : 0;
+}
+
+void File::flush() {
+    if (impl && impl->file) {
+        fflush(impl->file);
+    }
+}
+
+void File::close() {
+    if (impl) {
+        impl->close();
+    }
+}
+
+const char* File::path() const {
+    return impl ? impl->path.c_str() : "";
+}
+
+const char* File::name() const {
+    return impl ? impl->name.c_str() : "";
+}
+
+bool File::isDirectory() const {
+    return impl && impl->dir;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl || !impl->dir) {
+        return File();
+    }
+    while (struct dirent* entry = readdir(impl->dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        std::string child = impl->path == "/" ? "/" + std::string(entry->d_name) : impl->path + "/" + entry->d_name;
+        return File(open_impl(child, mode));
+    }
+    return File();
+}
+
+void File::rewindDirectory() {
+    if (impl && impl->dir) {
+        rewinddir(impl->dir);
+    }
+}
+
+File FS::open(const char* path, const char* mode, bool) {
+    return path ? File(open_impl(path, mode)) : File();
+}
+
+bool FS::exists(const char* path) {
+    struct stat info;
+    return path && stat(host_path(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return path && ::unlink(host_path(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return from && to && ::rename(host_path(from).c_str(), host_path(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return path && (::mkdir(host_path(path).c_str(), 0755) == 0 || is_host_directory(host_path(path)));
+}
+
+bool FS::rmdir(const char* path) {
+    return path && ::rmdir(host_path(path).c_str()) == 0;
+}
+
+}
+
+LittleFSFS LittleFS;
+
+bool LittleFSFS::begin(bool, const char*, uint8_t, const char*) {
+    const char* root = native_sim::get_fs_root();
+    return ::mkdir(root, 0755) == 0 || fs::is_host_directory(root);
+}
+
+bool LittleFSFS::format() {
+    return false;
+}
+
+size_t LittleFSFS::usedBytes() {
+    return 0;
+}
+
+//==============================================================================
+// ESP_PARTITION
+//==============================================================================
+namespace {
+uint32_t log_partition_size = 0;
+esp_partition_t log_partition = {};
+std::vector<uint8_t> log_partition_image;      // Also the memory esp_partition_mmap() hands out
+std::string log_partition_path;
+
+// Writes a changed range of the image back to its host file
+bool store_partition_range(size_t offset, size_t size) {
+    FILE* file = fopen(log_partition_path.c_str(), "r+b");
+    if (!file) {
+        file = fopen(log_partition_path.c_str(), "w+b");
+        offset = 0;
+        size = log_partition_image.size();
+    }
+    bool ok = file && fseek(file, (long)offset, SEEK_SET) == 0 &&
+              fwrite(log_partition_image.data() + offset, 1, size, file) == size;
+    if (file) {
+        fclose(file);
+    }
+    return ok;
+}
+
+bool partition_range_ok(const esp_partition_t* partition, size_t offset, size_t size) {
+    return partition == &log_partition && offset + size <= log_partition.size;
+}
+}
+
+void native_sim::set_log_partition_size(uint32_t bytes) {
+    log_partition_size = bytes;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label) {
+    if (log_partition_size == 0 || type != ESP_PARTITION_TYPE_DATA || subtype != 0x40 ||
+        (label && strcmp(label, "grindlog") != 0)) {
+        return nullptr;
+    }
+    if (log_partition_image.empty()) {
+        log_partition.type = ESP_PARTITION_TYPE_DATA;
+        log_partition.subtype = subtype;
+        log_partition.size = log_partition_size;
+        log_partition.erase_size = 4096;
+        strncpy(log_partition.label, "grindlog", sizeof(log_partition.label) - 1);
+        log_partition_path = std::string(native_sim::get_fs_root()) + "_grindlog.bin";
+
+        // Erased flash unless the host file holds an earlier run's log of the same size
+        log_partition_image.assign(log_partition_size, 0xFF);
+        FILE* file = fopen(log_partition_path.c_str(), "rb");
+        if (file) {
+            if (fread(log_partition_image.data(), 1, log_partition_size, file) != log_partition_size) {
+                log_partition_image.assign(log_partition_size, 0xFF);
+            }
+            fclose(file);
+        }
+    }
+    return &log_partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size) {
+    if (!partition_range_ok(partition, src_offset, size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(dst, log_partition_image.data() + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size) {
+    if (!partition_range_ok(partition, dst_offset, size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // NOR flash: programming only clears bits
+    const uint8_t* bytes = (const uint8_t*)src;
+    for (size_t i = 0; i < size; i++) {
+        log_partition_image[dst_offset + i] &= bytes[i];
+    }
+    return store_partition_range(dst_offset, size) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    if (!partition_range_ok(partition, offset, size) || offset % log_partition.erase_size != 0 ||
+        size % log_partition.erase_size != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(log_partition_image.data() + offset, 0xFF, size);
+    return store_partition_range(offset, size) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size,
+                             esp_partition_mmap_memory_t, const void** out_ptr, esp_partition_mmap_handle_t* out_handle) {
+    if (!partition_range_ok(partition, offset, size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_ptr = log_partition_image.data() + offset;
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+void esp_partition_munmap(esp_partition_mmap_handle_t) {}
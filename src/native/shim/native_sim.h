@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * native_sim - Virtual clock behind the host build's Arduino/ESP-IDF shims
+ *
+ * millis(), micros(), esp_timer_get_time() and the FreeRTOS tick all read one
+ * simulated µs counter that only moves when the simulation advances it, so the
+ * control loop runs as fast as the host can execute it. Advancing fires any
+ * esp_timer one-shots that fall due on the way, in due order.
+ *
+ * delay() and vTaskDelay() call the delay hook when one is set (the simulation
+ * keeps sampling while blocking firmware code waits), otherwise they just
+ * advance the clock.
+ */
+namespace native_sim {
+
+int64_t now_us();
+void advance_to_us(int64_t time_us);
+inline void advance_us(int64_t delta_us) { advance_to_us(now_us() + delta_us); }
+
+using DelayHook = void (*)(uint32_t ms);
+void set_delay_hook(DelayHook hook);
+
+// Host directory that backs LittleFS (default "native_fs" in the working directory)
+void set_fs_root(const char* path);
+const char* get_fs_root();
+
+// Size of the session log partition (0, the default, leaves it out of the partition table).
+// Its contents persist in "<fs root>_grindlog.bin".
+void set_log_partition_size(uint32_t bytes);
+
+// Forget every Preferences namespace (fresh NVS between runs)
+void clear_preferences();
+
+// Serial (LOG_BLE) output on stdout; the simulation turns it off for quiet sweeps
+void set_serial_output(bool enabled);
+bool is_serial_output_enabled();
+
+// Per-core id reported by xPortGetCoreID() (the simulation runs every task on one thread)
+void set_core_id(int core_id);
+
+// esp_cpu_get_cycle_count() follows the virtual clock, or with wall cycles the host's
+// steady clock at the same 240 MHz (benchmarks time host code, not simulated waits)
+void set_wall_cycle_count(bool enabled);
+uint32_t cycle_count();
+
+}
@@ -0,0 +1,602 @@
+#include "../controllers/grind_controller.h"
+#include "../controllers/grind_events.h"
+#include "../hardware/WeightSensor.h"
+#include "../hardware/grinder.h"
+#include "../hardware/mock_hx711_driver.h"
+#include "../logging/grind_logging.h"
+#include "../system/statistics_manager.h"
+#include "../system/config_store.h"
+#include "../system/preference_cache.h"
+#include "../system/memory_arena.h"
+#include "../system/hot_path_benchmark.h"
+#include "../system/storage_benchmark.h"
+#include "../system/noise_spectrum.h"
+#include "../system/grind_loop_profiler.h"
+#include "../config/constants.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <LittleFS.h>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include <string>
+#include <string.h>
+#include <vector>
+
+/*
+ * Host simulation (env:native) - the control core without the UI or RTOS
+ *
+ * One thread steps the virtual clock a millisecond at a time and runs, in
+ * firmware order, what the tasks would: WeightSamplingTask (sample and feed
+ * the filter), GrindControlTask every get_control_interval_ms() or, while
+ * is_sample_driven(), on each new sample with the base interval as timeout, and
+ * the Core 1 queue consumers (flash operations, log messages, UI events). The
+ * load cell is the mock flow model, or recorded sessions with
+ * DEBUG_ENABLE_LOADCELL_REPLAY. Preferences stay in memory, so the learned
+ * models carry over from dose to dose within a run; LittleFS maps to a host
+ * directory, so the session files written with --log can be fed back in as
+ * replays.
+ *
+ * Each dose prints one CSV row; a summary with the wall-clock speedup follows.
+ * --bench instead prints the HotPathBenchmark table for the host CPU,
+ * --storage-bench the StorageBenchmark table for the --fs directory, and
+ * --loop-profile adds the GrindLoopProfiler table of the last dose, timed in
+ * host cycles (the cycle counter follows the wall clock then).
+ *
+ * As a regression gate: --seed draws a new mock grinder per dose (flow rate
+ * for bean variance, start delay, coast after the stop, noise) from a seeded
+ * generator, --all-profiles runs the doses for every profile at its default
+ * weight, and --max-error / --max-p95-error fail the run (exit 1) when a
+ * profile's mean or p95 absolute error exceeds them. Timeouts always fail it.
+ * --model sets the grinder the draws vary around (and the one used without
+ * --seed) as key=value pairs, e.g. the output of tools/grinder.py fit-model
+ * for a recorded grinder; see parse_model() for the keys.
+ * Tuning macros guarded by #ifndef (GRIND_LATENCY_TO_COAST_RATIO, the settling
+ * windows, the mock flow) can be swept with build flags.
+ */
+
+namespace {
+
+struct SimOptions {
+    int doses = 10;
+    float target_g = USER_DOUBLE_ESPRESSO_WEIGHT_G;
+    uint32_t target_time_ms = 0;        // > 0 selects time mode
+    uint8_t profile_id = 0;
+    uint32_t dwell_ms = 3000;           // COMPLETED shown before return_to_idle()
+    uint32_t idle_ms = 5000;            // Between doses
+    const char* fs_root = "native_fs";
+    bool log_sessions = false;          // Menu "Logging" toggle: write session files under fs_root
+    bool adc_capture = false;           // BLE debug ADC capture toggle: raw sample track in the session files
+    uint32_t log_partition_kb = 0;      // > 0 adds the session log partition (fs_root + "_grindlog.bin")
+    bool verbose = false;
+    bool bench = false;                 // HotPathBenchmark table instead of doses
+    bool storage_bench = false;         // StorageBenchmark table instead of doses
+    bool loop_profile = false;          // GrindLoopProfiler table after the summary
+    bool spectrum = false;              // NoiseSpectrum of the idle ring, then of the first dose's motor run
+    uint32_t seed = 0;                  // > 0 randomizes the mock grinder per dose
+    bool all_profiles = false;          // Every profile at its default weight, doses each
+    float max_mean_error_g = 0.0f;      // > 0: gate on each profile's mean |error|
+    float max_p95_error_g = 0.0f;       // > 0: gate on each profile's p95 |error|
+    MockGrinderModel model;             // --model; the debug.h defaults otherwise
+};
+
+// Per-dose mock grinder draws with --seed
+const float kFlowScaleSigma = 0.12f;    // Bean and grind setting variance of the flow rate
+const float kFlowScaleMin = 0.6f;
+const float kFlowScaleMax = 1.5f;
+const uint32_t kStartDelaySpreadMs = 150;
+const uint32_t kCoastMaxMs = 150;
+const float kNoiseScaleMin = 0.5f;
+const float kNoiseScaleMax = 2.0f;
+
+const float kProfileWeightsG[USER_PROFILE_COUNT] = {
+    USER_SINGLE_ESPRESSO_WEIGHT_G, USER_DOUBLE_ESPRESSO_WEIGHT_G, USER_CUSTOM_PROFILE_WEIGHT_G
+};
+
+struct DoseResult {
+    uint8_t profile_id;
+    float target;                       // g, or s in time mode
+    bool finished;
+    bool timed_out;
+    float final_weight_g;
+    int pulse_count;
+    float grind_time_s;
+    float error_g;                      // Set by set_errors()
+};
+
+Preferences preferences;
+WeightSensor weight_sensor;
+Grinder grinder;
+GrindController grind_controller;
+
+DoseResult current_dose;
+uint32_t dose_start_ms = 0;
+uint32_t next_control_ms = 0;
+bool controller_running = false;
+
+// Stands in for UIManager: acknowledges INITIALIZING like the grinding screen does, records the outcome
+void on_ui_event(const GrindEventData& event) {
+    if (event.event == UIGrindEvent::PHASE_CHANGED && event.phase == GrindPhase::INITIALIZING) {
+        grind_controller.ui_acknowledge_phase_transition();
+    } else if (event.event == UIGrindEvent::COMPLETED) {
+        current_dose.finished = true;
+        current_dose.final_weight_g = event.final_weight;
+        current_dose.pulse_count = grind_controller.get_pulse_attempts();
+        current_dose.grind_time_s = (millis() - dose_start_ms) / (float)SYS_MS_PER_SECOND;
+    } else if (!current_dose.finished &&
+               (event.event == UIGrindEvent::TIMEOUT || event.event == UIGrindEvent::STOPPED)) {
+        // return_to_idle() also emits STOPPED; only count it while the dose is still running
+        current_dose.finished = true;
+        current_dose.timed_out = true;
+        current_dose.final_weight_g = event.error_weight;
+        current_dose.grind_time_s = (millis() - dose_start_ms) / (float)SYS_MS_PER_SECOND;
+    }
+}
+
+// WeightSamplingTask: one poll per simulated millisecond
+bool sample_step() {
+    bool sample_taken = weight_sensor.sample_and_feed_filter();
+    weight_sensor.update();
+    return sample_taken;
+}
+
+// Firmware code that blocks (tare, settling waits) keeps the sampling task running
+void on_delay(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        native_sim::advance_us(1000);
+        sample_step();
+    }
+}
+
+void step_ms() {
+    native_sim::advance_us(1000);
+    bool sample_taken = sample_step();
+    if (!controller_running) {
+        return;
+    }
+    const bool sample_driven = grind_controller.is_sample_driven();
+    if (!(sample_driven && sample_taken) && (int32_t)(millis() - next_control_ms) < 0) {
+        return;
+    }
+    grind_controller.update();
+    next_control_ms = (sample_driven ? millis() : next_control_ms) +
+        (grind_controller.is_sample_driven() ? SYS_TASK_GRIND_CONTROL_INTERVAL_MS : grind_controller.get_control_interval_ms());
+    grind_controller.publish_ui_snapshot();
+
+    // Core 1 consumers
+    grind_controller.process_queued_flash_operations();
+    deferred_log.drain();
+    grind_controller.process_queued_ui_events();
+    grind_logger.service_session_stream();
+    statistics_manager.service(millis(), !grind_controller.is_active());
+}
+
+void run_for_ms(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        step_ms();
+    }
+}
+
+// Mirrors HardwareManager::init() and WeightSamplingTask::initialize_hx711_hardware()
+bool init_hardware(const SimOptions& options) {
+    deferred_log.begin();
+    file_arena.begin();
+    session_arena.begin();
+    preferences.begin("grinder", false);
+    preference_cache.init(&preferences);
+    config_store.init(&preferences);
+    if (options.log_sessions) {
+        config_store.set_flag(ConfigFlag::LOGGING, true);
+        config_store.set_flag(ConfigFlag::ADC_CAPTURE, options.adc_capture);
+    }
+    weight_sensor.init(&preferences);
+    grinder.init(HW_MOTOR_RELAY_PIN);
+    weight_sensor.set_motor_edge_timeline(&grinder.get_edge_timeline());
+    statistics_manager.init(&preferences);
+    grind_controller.init(&weight_sensor, &grinder, &preferences);
+    grind_controller.set_ui_event_callback(on_ui_event);
+
+    weight_sensor.power_up();
+    if (!weight_sensor.begin()) {
+        fprintf(stderr, "Load cell begin() failed\n");
+        return false;
+    }
+    weight_sensor.load_calibration();
+    on_delay(2000);
+    if (!weight_sensor.validate_hardware()) {
+        fprintf(stderr, "Load cell validation failed\n");
+        return false;
+    }
+    weight_sensor.set_hardware_initialized();
+    return true;
+}
+
+// UIManager::update() for NoiseSpectrum; its reports are printed like --verbose output
+void service_noise_spectrum(const SimOptions& options) {
+    native_sim::set_serial_output(true);
+    noise_spectrum.service(&weight_sensor, &grinder.get_edge_timeline(), grind_controller.is_active());
+    native_sim::set_serial_output(options.verbose);
+}
+
+DoseResult run_dose(const SimOptions& options, uint8_t profile_id, float target_g) {
+    memset(&current_dose, 0, sizeof(current_dose));
+    GrindMode mode = options.target_time_ms > 0 ? GrindMode::TIME : GrindMode::WEIGHT;
+    grind_controller.set_grind_profile_id(profile_id);
+    dose_start_ms = millis();
+    grind_controller.start_grind(target_g, options.target_time_ms, mode);
+
+    // The session limit plus settling; the controller times out well before this
+    const uint32_t timeout_sec = target_g >= GRIND_BULK_MIN_TARGET_G ? GRIND_BULK_TIMEOUT_SEC : GRIND_TIMEOUT_SEC;
+    const uint32_t limit_ms = (timeout_sec + 30) * SYS_MS_PER_SECOND;
+    uint32_t start_ms = millis();
+    while (!current_dose.finished && millis() - start_ms < limit_ms) {
+        step_ms();
+        // The UI task analyses a motor run as soon as it stops, before the ring laps it
+        if (options.spectrum && noise_spectrum.is_armed(NoiseCapture::MOTOR)) {
+            service_noise_spectrum(options);
+        }
+    }
+    if (!current_dose.finished) {
+        grind_controller.stop_grind();
+        current_dose.timed_out = true;
+    }
+
+    run_for_ms(options.dwell_ms);
+    grind_controller.return_to_idle();
+    run_for_ms(options.idle_ms);
+    current_dose.profile_id = profile_id;
+    current_dose.target = mode == GrindMode::TIME ? options.target_time_ms / (float)SYS_MS_PER_SECOND : target_g;
+    return current_dose;
+}
+
+// A grinder around base: the flow, start delay, coast hold and noise vary per dose
+MockGrinderModel draw_grinder_model(std::mt19937& generator, const MockGrinderModel& base) {
+    std::normal_distribution<float> flow_scale(1.0f, kFlowScaleSigma);
+    uint32_t start_delay_min = base.start_delay_ms > kStartDelaySpreadMs ? base.start_delay_ms - kStartDelaySpreadMs : 0;
+    std::uniform_int_distribution<uint32_t> start_delay(start_delay_min, base.start_delay_ms + kStartDelaySpreadMs);
+    std::uniform_int_distribution<uint32_t> coast(0, kCoastMaxMs);
+    std::uniform_real_distribution<float> noise_scale(kNoiseScaleMin, kNoiseScaleMax);
+    MockGrinderModel model = base;
+    model.flow_rate_gps *= constrain(flow_scale(generator), kFlowScaleMin, kFlowScaleMax);
+    model.start_delay_ms = start_delay(generator);
+    model.coast_ms += coast(generator);
+    model.noise_scale *= noise_scale(generator);
+    return model;
+}
+
+float percentile(std::vector<float> values, float fraction) {
+    if (values.empty()) {
+        return 0.0f;
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)ceilf(fraction * values.size());
+    return values[rank > 0 ? rank - 1 : 0];
+}
+
+// Weight mode: error against the target. Time mode has no weight target, so the
+// error is the spread around the profile's mean dose, which this returns
+double set_errors(std::vector<DoseResult>& results, bool time_mode) {
+    double reference_g = 0.0;
+    if (time_mode) {
+        double weight_sum = 0.0;
+        int finished = 0;
+        for (const DoseResult& result : results) {
+            weight_sum += result.timed_out ? 0.0 : result.final_weight_g;
+            finished += result.timed_out ? 0 : 1;
+        }
+        reference_g = finished > 0 ? weight_sum / finished : 0.0;
+    }
+    for (DoseResult& result : results) {
+        result.error_g = result.final_weight_g - (float)(time_mode ? reference_g : result.target);
+    }
+    return reference_g;
+}
+
+// Summary lines for one profile's doses; false if it fails the gate
+bool print_summary(const std::vector<DoseResult>& results, double time_reference_g, const SimOptions& options) {
+    const bool time_mode = options.target_time_ms > 0;
+    int completed = 0;
+    double error_sum = 0.0;
+    double error_square_sum = 0.0;
+    double time_sum = 0.0;
+    int pulse_sum = 0;
+    std::vector<float> abs_errors;
+    std::vector<float> grind_times;
+    for (const DoseResult& result : results) {
+        if (result.timed_out) {
+            continue;
+        }
+        float error_g = result.error_g;
+        completed++;
+        error_sum += error_g;
+        error_square_sum += (double)error_g * error_g;
+        time_sum += result.grind_time_s;
+        pulse_sum += result.pulse_count;
+        abs_errors.push_back(fabsf(error_g));
+        grind_times.push_back(result.grind_time_s);
+    }
+    if (completed == 0) {
+        printf("# 0/%d completed\n", (int)results.size());
+        return false;
+    }
+
+    double mean = error_sum / completed;
+    double rms = sqrt(error_square_sum / completed);
+    if (time_mode) {
+        printf("# %d/%d completed, mean dose %.3fg, spread rms %.3fg, mean grind %.2fs\n",
+               completed, (int)results.size(), time_reference_g, rms, time_sum / completed);
+    } else {
+        printf("# %d/%d completed, mean error %+.3fg, rms %.3fg, mean grind %.2fs\n",
+               completed, (int)results.size(), mean, rms, time_sum / completed);
+    }
+    double mean_abs = 0.0;
+    for (float error : abs_errors) {
+        mean_abs += error;
+    }
+    mean_abs /= completed;
+    float p95_abs = percentile(abs_errors, 0.95f);
+    printf("# |error| mean %.3fg, p95 %.3fg; %.2f pulses per grind, p95 grind %.2fs, %d timeouts\n",
+           mean_abs, p95_abs, pulse_sum / (double)completed, percentile(grind_times, 0.95f),
+           (int)results.size() - completed);
+
+    bool passed = completed == (int)results.size();
+    if (options.max_mean_error_g > 0.0f && mean_abs > options.max_mean_error_g) {
+        printf("# GATE FAILED: mean |error| %.3fg above %.3fg\n", mean_abs, options.max_mean_error_g);
+        passed = false;
+    }
+    if (options.max_p95_error_g > 0.0f && p95_abs > options.max_p95_error_g) {
+        printf("# GATE FAILED: p95 |error| %.3fg above %.3fg\n", p95_abs, options.max_p95_error_g);
+        passed = false;
+    }
+    return passed;
+}
+
+// --model flow=1.8,start_delay=480,coast_tau=120,...: unknown keys or values fail the parse
+bool parse_model(const char* text, MockGrinderModel* model) {
+    struct FloatKey { const char* key; float MockGrinderModel::* field; };
+    struct MsKey { const char* key; uint32_t MockGrinderModel::* field; };
+    static const FloatKey float_keys[] = {
+        { "flow", &MockGrinderModel::flow_rate_gps },
+        { "noise_scale", &MockGrinderModel::noise_scale },
+        { "idle_noise", &MockGrinderModel::idle_noise_raw },
+        { "vibration_noise", &MockGrinderModel::vibration_noise_raw },
+        { "vibration_hz", &MockGrinderModel::vibration_hz },
+        { "vibration_tone", &MockGrinderModel::vibration_tone_raw },
+        { "clump_rate", &MockGrinderModel::clump_rate_hz },
+        { "clump_mass", &MockGrinderModel::clump_mass_g },
+        { "retention", &MockGrinderModel::retention_fraction },
+        { "retention_capacity", &MockGrinderModel::retention_capacity_g },
+        { "retention_release", &MockGrinderModel::retention_release_hz },
+    };
+    static const MsKey ms_keys[] = {
+        { "start_delay", &MockGrinderModel::start_delay_ms },
+        { "stop_delay", &MockGrinderModel::stop_delay_ms },
+        { "ramp", &MockGrinderModel::ramp_ms },
+        { "coast", &MockGrinderModel::coast_ms },
+        { "coast_tau", &MockGrinderModel::coast_tau_ms },
+        { "clump_ms", &MockGrinderModel::clump_ms },
+    };
+    std::string pairs(text);
+    size_t start = 0;
+    while (start < pairs.size()) {
+        size_t end = pairs.find(',', start);
+        if (end == std::string::npos) {
+            end = pairs.size();
+        }
+        std::string pair = pairs.substr(start, end - start);
+        start = end + 1;
+        size_t equals = pair.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+        std::string key = pair.substr(0, equals);
+        const char* value = pair.c_str() + equals + 1;
+        char* value_end = nullptr;
+        float number = strtof(value, &value_end);
+        if (value_end == value || *value_end != '\0' || number < 0.0f) {
+            return false;
+        }
+        bool known = false;
+        for (const FloatKey& entry : float_keys) {
+            if (key == entry.key) {
+                model->*entry.field = number;
+                known = true;
+            }
+        }
+        for (const MsKey& entry : ms_keys) {
+            if (key == entry.key) {
+                model->*entry.field = (uint32_t)lroundf(number);
+                known = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void print_usage(const char* program) {
+    printf("Usage: %s [--doses N] [--target G | --time S] [--profile N] [--dwell-ms MS]\n"
+           "          [--idle-ms MS] [--fs DIR] [--log] [--log-partition KB]\n"
+           "          [--adc-capture] [--verbose] [--bench] [--storage-bench]\n"
+           "          [--loop-profile] [--spectrum] [--seed N]\n"
+           "          [--all-profiles] [--max-error G] [--max-p95-error G] [--model KEY=VALUE,...]\n", program);
+}
+
+bool parse_options(int argc, char** argv, SimOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--verbose") == 0) {
+            options->verbose = true;
+            continue;
+        }
+        if (strcmp(arg, "--log") == 0) {
+            options->log_sessions = true;
+            continue;
+        }
+        if (strcmp(arg, "--adc-capture") == 0) {
+            options->adc_capture = true;
+            continue;
+        }
+        if (strcmp(arg, "--bench") == 0) {
+            options->bench = true;
+            continue;
+        }
+        if (strcmp(arg, "--storage-bench") == 0) {
+            options->storage_bench = true;
+            continue;
+        }
+        if (strcmp(arg, "--loop-profile") == 0) {
+            options->loop_profile = true;
+            continue;
+        }
+        if (strcmp(arg, "--spectrum") == 0) {
+            options->spectrum = true;
+            continue;
+        }
+        if (strcmp(arg, "--all-profiles") == 0) {
+            options->all_profiles = true;
+            continue;
+        }
+        if (!value) {
+            return false;
+        }
+        if (strcmp(arg, "--doses") == 0) {
+            options->doses = max(1, atoi(value));
+        } else if (strcmp(arg, "--target") == 0) {
+            options->target_g = strtof(value, nullptr);
+        } else if (strcmp(arg, "--time") == 0) {
+            options->target_time_ms = (uint32_t)(strtof(value, nullptr) * SYS_MS_PER_SECOND);
+        } else if (strcmp(arg, "--profile") == 0) {
+            options->profile_id = (uint8_t)constrain(atoi(value), 0, USER_PROFILE_COUNT - 1);
+        } else if (strcmp(arg, "--dwell-ms") == 0) {
+            options->dwell_ms = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--idle-ms") == 0) {
+            options->idle_ms = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--fs") == 0) {
+            options->fs_root = value;
+        } else if (strcmp(arg, "--log-partition") == 0) {
+            options->log_partition_kb = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--seed") == 0) {
+            options->seed = (uint32_t)strtoul(value, nullptr, 10);
+        } else if (strcmp(arg, "--max-error") == 0) {
+            options->max_mean_error_g = strtof(value, nullptr);
+        } else if (strcmp(arg, "--max-p95-error") == 0) {
+            options->max_p95_error_g = strtof(value, nullptr);
+        } else if (strcmp(arg, "--model") == 0) {
+            if (!parse_model(value, &options->model)) {
+                fprintf(stderr, "Bad --model: %s\n", value);
+                return false;
+            }
+        } else {
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    SimOptions options;
+    if (!parse_options(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    native_sim::set_serial_output(options.verbose);
+    native_sim::set_fs_root(options.fs_root);
+    native_sim::set_log_partition_size(options.log_partition_kb * 1024);
+    native_sim::set_delay_hook(on_delay);
+    LittleFS.begin(true);
+
+    auto wall_start = std::chrono::steady_clock::now();
+    if (!init_hardware(options)) {
+        return 1;
+    }
+    if (options.bench) {
+        native_sim::set_serial_output(true);
+        native_sim::set_wall_cycle_count(true);
+        return hot_path_benchmark.run(&weight_sensor) ? 0 : 1;
+    }
+    if (options.storage_bench) {
+        native_sim::set_serial_output(true);
+        native_sim::set_wall_cycle_count(true);
+        return storage_benchmark.run(nullptr) ? 0 : 1;
+    }
+    if (options.loop_profile || options.spectrum) {
+        native_sim::set_wall_cycle_count(true);
+    }
+    next_control_ms = millis();
+    controller_running = true;
+    run_for_ms(options.idle_ms);
+    if (options.spectrum) {
+        noise_spectrum.request(NoiseCapture::IDLE);
+        noise_spectrum.request(NoiseCapture::MOTOR);
+        service_noise_spectrum(options);
+    }
+
+    // One seeded generator for the whole run: the same seed draws the same grinders
+    std::mt19937 generator(options.seed);
+    if (options.seed > 0) {
+        srandom(options.seed);          // Mock load cell noise
+    }
+    MockHX711Driver::set_model(options.model);
+    const uint8_t first_profile = options.all_profiles ? 0 : options.profile_id;
+    const uint8_t last_profile = options.all_profiles ? USER_PROFILE_COUNT - 1 : options.profile_id;
+
+    std::vector<std::vector<DoseResult>> profile_results;
+    for (uint8_t profile = first_profile; profile <= last_profile; profile++) {
+        float target_g = options.all_profiles ? kProfileWeightsG[profile] : options.target_g;
+        profile_results.emplace_back();
+        for (int dose = 1; dose <= options.doses; dose++) {
+            if (options.seed > 0) {
+                MockHX711Driver::set_model(draw_grinder_model(generator, options.model));
+            }
+            profile_results.back().push_back(run_dose(options, profile, target_g));
+        }
+    }
+    print_memory_report();
+
+    const bool time_mode = options.target_time_ms > 0;
+    std::vector<double> time_references_g;
+    for (std::vector<DoseResult>& results : profile_results) {
+        time_references_g.push_back(set_errors(results, time_mode));
+    }
+    printf("dose,profile,target,final_g,error_g,grind_s,pulses,result\n");
+    int row = 0;
+    for (const std::vector<DoseResult>& results : profile_results) {
+        for (const DoseResult& result : results) {
+            printf("%d,%d,%.2f%s,%.3f,%+.3f,%.2f,%d,%s\n", ++row, result.profile_id, result.target,
+                   time_mode ? "s" : "g", result.final_weight_g, result.error_g, result.grind_time_s,
+                   result.pulse_count, result.timed_out ? "TIMEOUT" : "COMPLETE");
+        }
+    }
+
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    double simulated_s = native_sim::now_us() / 1e6;
+    bool passed = true;
+    for (size_t i = 0; i < profile_results.size(); i++) {
+        const std::vector<DoseResult>& results = profile_results[i];
+        if (options.all_profiles) {
+            printf("# profile %d, %.2f%s:\n", results.front().profile_id, results.front().target, time_mode ? "s" : "g");
+        }
+        passed = print_summary(results, time_references_g[i], options) && passed;
+    }
+    statistics_manager.flush();     // As before a restart; the journal outlives the run with --fs
+    printf("# lifetime statistics: %lu grinds, %.3fkg\n", (unsigned long)statistics_manager.get_total_grinds(),
+           statistics_manager.get_total_weight_kg());
+    printf("# simulated %.1fs in %.2fs wall (%.0fx real time)\n", simulated_s, wall_s,
+           wall_s > 0.0 ? simulated_s / wall_s : 0.0);
+    if (options.loop_profile) {
+        fflush(stdout);
+        native_sim::set_serial_output(true);
+        grind_loop_profiler.print_report();
+    }
+    return passed ? 0 : 1;
+}
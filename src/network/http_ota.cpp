@@ -0,0 +1,165 @@
+#include "http_ota.h"
+
+#if NETWORK_MQTT_ENABLED
+
+#include <WiFi.h>
+#include <esp_crt_bundle.h>
+#include <esp_heap_caps.h>
+#include <esp_http_client.h>
+#include <stdarg.h>
+#include "../bluetooth/ota_handler.h"
+
+bool HttpOtaDownloader::run(const HttpOtaRequest& request, OTAHandler& ota) {
+    error[0] = '\0';
+    total_size = 0;
+    started = false;
+    uint8_t* buffer = (uint8_t*)heap_caps_malloc(NET_OTA_READ_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!buffer) {
+        return fail("no memory for the read buffer");
+    }
+
+    bool downloaded = false;
+    bool fatal = false;
+    uint32_t failures = 0;
+    while (!fatal) {
+        uint32_t before = started ? ota.get_received_size() : 0;
+        if (fetch(request, ota, buffer, &fatal)) {
+            downloaded = true;
+            break;
+        }
+        if (fatal) {
+            break;
+        }
+        uint32_t after = started ? ota.get_received_size() : 0;
+        failures = after > before ? 1 : failures + 1;
+        if (failures > NET_OTA_MAX_RETRIES) {
+            LOG_BLE("Wi-Fi OTA: %s, giving up after %d attempts\n", error, NET_OTA_MAX_RETRIES);
+            break;
+        }
+        LOG_BLE("Wi-Fi OTA: %s at %lu of %lu bytes, resuming in %dms\n", error,
+                (unsigned long)after, (unsigned long)total_size, NET_OTA_RETRY_DELAY_MS);
+        vTaskDelay(pdMS_TO_TICKS(NET_OTA_RETRY_DELAY_MS));
+        if (WiFi.status() != WL_CONNECTED) {
+            WiFi.reconnect();
+            vTaskDelay(pdMS_TO_TICKS(NET_OTA_RETRY_DELAY_MS));
+        }
+    }
+    heap_caps_free(buffer);
+
+    if (!downloaded) {
+        if (started) {
+            ota.abort_ota();
+        }
+        return false;
+    }
+
+    // Same end as a BLE END command: drain the ring, then validate and switch partitions
+    ota.finish_writes();
+    while (!ota.is_write_drained()) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (ota.has_write_failed()) {
+        ota.abort_ota();
+        return fail("patch apply failed");
+    }
+    LOG_BLE("Wi-Fi OTA: %lu bytes applied, finalizing\n", (unsigned long)total_size);
+    ota.complete_ota();                         // Restarts on success
+    return fail("finalization failed");
+}
+
+// One HTTP request from the first byte not yet queued; true once the whole patch is queued
+bool HttpOtaDownloader::fetch(const HttpOtaRequest& request, OTAHandler& ota, uint8_t* buffer, bool* fatal) {
+    error[0] = '\0';
+    uint32_t offset = started ? ota.get_received_size() : 0;
+
+    esp_http_client_config_t config = {};
+    config.url = request.url;
+    config.timeout_ms = NET_OTA_HTTP_TIMEOUT_MS;
+    config.crt_bundle_attach = esp_crt_bundle_attach;
+    esp_http_client_handle_t http = esp_http_client_init(&config);
+    if (!http) {
+        *fatal = true;
+        return fail("HTTP client init failed (URL?)");
+    }
+    char range[24];
+    snprintf(range, sizeof(range), "bytes=%lu-", (unsigned long)offset);
+    esp_http_client_set_header(http, "Range", range);
+
+    bool complete = false;
+    esp_err_t result = esp_http_client_open(http, 0);
+    if (result != ESP_OK) {
+        fail("connect failed: %s", esp_err_to_name(result));
+    } else {
+        int64_t length = esp_http_client_fetch_headers(http);
+        int status = esp_http_client_get_status_code(http);
+        // 206 starts at offset; a server that ignores Range sends everything with 200
+        uint32_t position = status == 206 ? offset : 0;
+        if (status != 200 && status != 206) {
+            *fatal = status >= 400 && status < 500;
+            fail("HTTP status %d", status);
+        } else if (length <= 0) {
+            *fatal = true;
+            fail("no Content-Length");
+        } else if (!started) {
+            total_size = position + (uint32_t)length;
+            String build = request.build > 0 ? String(request.build) : String("");
+            LOG_BLE("Wi-Fi OTA: %s update, %lu KB from %s\n", request.full ? "full" : "delta",
+                    (unsigned long)total_size / 1024, request.url);
+            if (!ota.start_ota(total_size, build, request.full, String(request.version))) {
+                *fatal = true;
+                fail("OTA start failed");
+            } else {
+                started = true;
+            }
+        } else if (position + (uint32_t)length != total_size) {
+            *fatal = true;
+            fail("image changed on the server");
+        }
+
+        while (started && !*fatal && error[0] == '\0' && position < total_size) {
+            uint32_t want = total_size - position < NET_OTA_READ_BYTES ? total_size - position : NET_OTA_READ_BYTES;
+            if (!wait_for_ring(ota, want)) {
+                *fatal = true;
+                fail("patch apply failed");
+                break;
+            }
+            int got = esp_http_client_read(http, (char*)buffer, want);
+            if (got <= 0) {
+                fail("connection dropped");
+                break;
+            }
+            uint32_t skip = position < offset ? (offset - position < (uint32_t)got ? offset - position : got) : 0;
+            position += got;
+            if ((uint32_t)got > skip && !ota.process_data_chunk(buffer + skip, got - skip)) {
+                *fatal = true;
+                fail("patch queue rejected %d bytes", got - (int)skip);
+                break;
+            }
+        }
+        complete = started && error[0] == '\0' && position == total_size;
+    }
+    esp_http_client_close(http);
+    esp_http_client_cleanup(http);
+    return complete;
+}
+
+// The writer drains whole sectors; a read is queued only when it fits the ring
+bool HttpOtaDownloader::wait_for_ring(OTAHandler& ota, uint32_t length) {
+    while (ota.get_received_size() - ota.get_flushed_size() + length > BLE_OTA_RING_BYTES) {
+        if (ota.has_write_failed() || !ota.is_ota_active()) {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    return !ota.has_write_failed();
+}
+
+bool HttpOtaDownloader::fail(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(error, sizeof(error), format, args);
+    va_end(args);
+    return false;
+}
+
+#endif // NETWORK_MQTT_ENABLED
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/constants.h"
+
+class OTAHandler;
+
+// One cmd/ota request
+struct HttpOtaRequest {
+    char url[NET_OTA_URL_MAX_LENGTH];
+    char version[NET_OTA_VERSION_MAX_LENGTH];  // Expected BUILD_FIRMWARE_VERSION after the update, "" to skip
+    int32_t build;                          // Expected BUILD_NUMBER after the update, 0 to skip
+    int32_t from_build;                     // Delta only: the build it patches, 0 for any
+    bool full;                              // Full image (heatshrink patch against nothing), else delta
+};
+
+/**
+ * HttpOtaDownloader - Firmware update over Wi-Fi, through the BLE OTA path
+ *
+ * Downloads the same delta or full patch file a BLE OTA sends and feeds it to
+ * the OTAHandler: start_ota() with the expected build and version (checked
+ * after the reboot, like a BLE update), process_data_chunk() for every read,
+ * held back while the ring is full, then complete_ota(), which restarts. The
+ * patch is applied to the next OTA partition as it arrives.
+ *
+ * Every request asks for "Range: bytes=<received>-". A dropped connection or
+ * Wi-Fi link resumes where it stopped, up to NET_OTA_MAX_RETRIES attempts in a
+ * row without progress; a server that answers 200 instead of 206 is read from
+ * the start and the bytes already applied are skipped. The patch stream lives
+ * in RAM, so a reboot starts the download over.
+ *
+ * run() blocks the calling task (the MQTT task) for the whole download.
+ */
+class HttpOtaDownloader {
+public:
+    bool run(const HttpOtaRequest& request, OTAHandler& ota);  // Returns only on failure; get_error() says why
+    const char* get_error() const { return error; }
+
+private:
+    char error[64] = "";
+    uint32_t total_size = 0;
+    bool started = false;
+
+    bool fetch(const HttpOtaRequest& request, OTAHandler& ota, uint8_t* buffer, bool* fatal);
+    bool wait_for_ring(OTAHandler& ota, uint32_t length);
+    bool fail(const char* format, ...);         // Sets error, returns false
+};
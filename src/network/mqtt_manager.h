@@ -0,0 +1,266 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "../config/constants.h"
+#include "../logging/session_query.h"
+#include "../logging/session_reader.h"
+#include "http_ota.h"
+
+struct TelemetryTick;
+class Telemetry;
+
+// Commands received on <root>/<device>/cmd/<leaf>, applied by the UI task
+enum class MqttCommandType : uint8_t {
+    SELECT_PROFILE,                 // cmd/profile {"profile":N} plus optional "weight" (g) or "time" (s)
+    START,                          // cmd/start, optional {"profile":N}
+    STOP                            // cmd/stop
+};
+
+struct MqttCommand {
+    MqttCommandType type;
+    int8_t profile;                 // -1: keep the current profile
+    float weight_g;                 // 0: unchanged
+    float time_s;                   // 0: unchanged
+    int16_t stored_profile;         // Profile store id recalled into the profile first, -1: none
+};
+
+enum class MqttLinkState : uint8_t {
+    UNCONFIGURED,                   // No SSID or broker stored
+    WIFI_CONNECTING,
+    BROKER_CONNECTING,
+    CONNECTED
+};
+
+/**
+ * MqttManager - Wi-Fi station and MQTT client for fleet telemetry
+ *
+ * Built with -DNETWORK_MQTT_ENABLED=1 (the -mqtt environment). begin() loads
+ * the SSID, password and broker URI from NVS and starts the MQTT task on
+ * Core 1, which joins Wi-Fi with a doubling reconnect delay, starts the
+ * esp-mqtt client (its own task, pinned to Core 1 by sdkconfig) and then
+ * publishes under <root>/<device id>/:
+ *   status       "online", or "offline" as the retained last will
+ *   state        retained Home Assistant state JSON, on change (below)
+ *   session      each session summary, QoS 1, oldest first
+ *   telemetry    binary batches of control ticks while a grind runs (below)
+ *   upload/<session id>/<offset>  stored session files, in chunks (below)
+ *   diagnostics  perf counters, task memory and RSSI every NET_MQTT_DIAGNOSTICS_INTERVAL_MS
+ *   crash        the previous run's CrashSnapshot, once per boot, QoS 1
+ * Publishing pauses during a BLE OTA.
+ *
+ * Session summaries are buffered by the SessionSummaryTable file itself: a
+ * cursor in NVS counts the summaries the broker has acknowledged (PUBACK), so
+ * sessions ground while the broker was unreachable, or before a reboot, go
+ * out one at a time on the next connection. At least once: a summary whose
+ * PUBACK was lost is sent again; session_id identifies it.
+ *
+ * Telemetry takes every divider-th control tick from the selected grinder's
+ * Telemetry tick lane and publishes a batch every interval, or sooner once it holds
+ * NET_MQTT_TELEMETRY_MAX_SAMPLES. cmd/telemetry {"interval_ms":N,"divider":N}
+ * changes both at runtime; divider 0 stops telemetry. Little-endian:
+ *   header  [version u8][count u8][dropped u16][t0_ms u32][w0 i32 0.01 g]
+ *           [eta u16 0.1 s, 0xFFFF unknown][eta band u16 0.1 s]
+ *   sample  [dt_ms u16][dw i16 0.01 g][flow i16 0.01 g/s][phase u8][flags u8]
+ * t0_ms and w0 are the first sample's session time and weight (its dt and dw
+ * are 0); each later sample adds its deltas to the one before. dropped counts
+ * ticks lost to a full lane since the previous batch. Commands under cmd/ are parsed on the
+ * esp-mqtt task and queued for the UI task, which applies them like the
+ * matching touch input (take_command()); nothing here touches the grinder.
+ *
+ * Home Assistant: each connection publishes retained discovery configs under
+ * NET_HA_DISCOVERY_PREFIX for weight, last shot weight and error, grind
+ * count, motor runtime, the diagnostic warning (problem sensor and message)
+ * and a start button (cmd/start). Their values share the state topic, which
+ * is written only when something changed: the weight by NET_HA_WEIGHT_DEADBAND_G,
+ * anything else at all, and never twice within NET_HA_STATE_MIN_INTERVAL_MS,
+ * so an idle grinder sends nothing. The weight comes from the UI snapshot,
+ * the last shot from the session summaries, the counters from
+ * StatisticsManager, and the warning from the UI task (set_diagnostic()).
+ *
+ * Session files are uploaded as stored (the BLE file stream's image, header
+ * included), oldest first, one QoS 1 chunk of up to NET_MQTT_UPLOAD_CHUNK_BYTES
+ * in flight. Chunks from the session log partition are published straight out
+ * of the mapped flash; LittleFS files go through one chunk buffer. The topic
+ * carries the session id and byte offset, so a resent chunk is idempotent, and
+ * upload/<session id>/done {"size":N,"checksum":N} (the header's CRC, 0
+ * without one) closes each file. A cursor in NVS (session id, acknowledged
+ * offset) resumes an upload cut short by the link or a reboot; cmd/upload
+ * {"session_id":N,"offset":N} moves it, e.g. to fetch sessions stored before
+ * MQTT was set up.
+ *
+ * cmd/query {"profile":N,"mode":"weight"|"time","results":"overshoot,timeout",
+ * "from_id":N,"to_id":N,"min_error":G,"max_error":G,"limit":N,"stored":1}
+ * runs a SessionQuery (every key optional) and publishes its reply on query:
+ * the SessionQueryReplyHeader and records, newest first. The matching files
+ * themselves come through the upload topics (cmd/upload).
+ *
+ * Grind orders for a point of sale: cmd/order {"order_id":N,"count":N,
+ * "profile":N,"weight":G,"stored":N} (count 1, the selected profile and its own
+ * weight by default) goes straight into the OrderQueue, and cmd/cancel
+ * {"order_id":N} drops one (no id: all). Each order's steps come back on order
+ * {"order_id","status","count","completed","pending","target_g","total_g",
+ * "mean_g"}, QoS 1, status queued, rejected, started, done, failed or cancelled.
+ *
+ * Trends without the sessions: every hour and day that closes (SessionRollups)
+ * goes out once on rollup/hour or rollup/day, QoS 1, oldest first: grinds, kg
+ * ground, mean and p95 absolute error, mean grind time, pulses, timeouts,
+ * overshoots, flow faults and diagnostics raised. Periods run on uptime;
+ * age_s (seconds since the period ended) places them on the receiver's clock.
+ *
+ * While a grind runs, uploads, summaries, query replies, Home Assistant state,
+ * rollups and diagnostics wait (RadioCoexistence); telemetry batches, order events and
+ * commands do not.
+ *
+ * Wi-Fi OTA: cmd/ota {"url":"https://...","build":N,"version":"x.y.z",
+ * "full":0|1,"from_build":N} downloads a BLE OTA patch file with
+ * HttpOtaDownloader once the grinder is idle, reporting on ota. A request for
+ * the running build, or a delta made for another build, is skipped, so the
+ * same command can go to a whole fleet.
+ *
+ * set_config() (BLE task) stores new credentials and wakes the MQTT task to
+ * reconnect with them. With NETWORK_WEB_ENABLED the broker URI may be empty:
+ * the task then only keeps Wi-Fi up for the WebDashboard, which it tells
+ * whenever the link comes or goes.
+ */
+class MqttManager {
+public:
+    void begin();
+    void set_config(const char* ssid, const char* password, const char* broker_uri);
+
+    // UI task: woken when a command is queued
+    void set_command_consumer(TaskHandle_t task) { command_consumer = task; }
+    bool take_command(MqttCommand* out);
+    // UI task: the DiagnosticsController's highest priority warning and its message (static)
+    void set_diagnostic(uint8_t code, const char* message);
+
+    MqttLinkState get_state() const { return state.load(std::memory_order_relaxed); }
+    bool is_connected() const { return get_state() == MqttLinkState::CONNECTED; }
+
+private:
+    TaskHandle_t task = nullptr;
+    TaskHandle_t command_consumer = nullptr;
+    QueueHandle_t command_queue = nullptr;
+    void* client = nullptr;                     // esp_mqtt_client_handle_t, kept out of this header
+    std::atomic<MqttLinkState> state{MqttLinkState::UNCONFIGURED};
+    std::atomic<bool> config_changed{false};
+    std::atomic<bool> broker_connected{false};
+    std::atomic<bool> discovery_pending{false};
+    std::atomic<uint8_t> diagnostic_code{0};
+    std::atomic<const char*> diagnostic_message{""};
+
+    // Owned by the MQTT task
+    char ssid[NET_WIFI_SSID_MAX_LENGTH] = "";
+    char password[NET_WIFI_PASSWORD_MAX_LENGTH] = "";
+    char broker_uri[NET_MQTT_BROKER_URI_MAX_LENGTH] = "";
+    char device_id[13] = "";                    // Station MAC, 12 hex digits
+    char topic_prefix[NET_MQTT_TOPIC_MAX_LENGTH] = "";
+    char will_topic[NET_MQTT_TOPIC_MAX_LENGTH] = "";
+    char payload[NET_MQTT_PAYLOAD_MAX_BYTES];
+    bool wifi_up = false;
+    bool wifi_connecting = false;
+    bool wifi_retry_pending = false;            // Last attempt failed: wait wifi_retry_ms from wifi_attempt_ms
+    uint32_t wifi_attempt_ms = 0;
+    uint32_t wifi_retry_ms = NET_WIFI_RETRY_MIN_MS;
+    uint32_t last_diagnostics_ms = 0;
+    bool crash_published = false;
+    uint32_t rollup_cursor[2] = {};             // SessionRollups closed totals published, per period
+
+    // Runtime settings from commands (esp-mqtt task) and the newest PUBACKs
+    static const size_t ACKED_MSG_IDS = 4;      // Summaries and upload chunks may be acknowledged between passes
+    std::atomic<uint32_t> telemetry_interval_ms{NET_MQTT_TELEMETRY_INTERVAL_MS};
+    std::atomic<uint8_t> telemetry_divider{NET_MQTT_TELEMETRY_TICK_DIVIDER};
+    std::atomic<uint32_t> upload_request_session{0};
+    std::atomic<uint32_t> upload_request_offset{0};
+    std::atomic<bool> upload_requested{false};
+    std::atomic<bool> ota_requested{false};     // ota_request is written while false, read while true
+    HttpOtaRequest ota_request;
+    std::atomic<bool> query_requested{false};   // query_request likewise
+    SessionQuery query_request;
+    std::atomic<int> acked_msg_ids[ACKED_MSG_IDS] = {{-1}, {-1}, {-1}, {-1}};
+    uint8_t acked_next = 0;                     // esp-mqtt task only
+
+    // Session summaries
+    bool session_cursor_loaded = false;
+    uint32_t session_cursor = 0;                // SessionSummaryTable total the broker has acknowledged
+    uint32_t session_cursor_unsaved = 0;
+    int session_msg_id = -1;                    // Summary awaiting its PUBACK, -1: none
+    uint32_t session_sent_ms = 0;
+
+    // Home Assistant state as last published
+    struct HomeAssistantState {
+        float weight_g;
+        uint32_t last_session_id;
+        uint32_t grind_count;
+        uint32_t motor_runtime_s;
+        uint8_t diagnostic;
+    };
+    HomeAssistantState ha_state = {};
+    bool ha_state_valid = false;                // false: publish on the next pass
+    uint32_t ha_checked_ms = 0;
+
+    // Session file upload
+    SessionReader upload_reader;
+    bool upload_cursor_loaded = false;
+    uint32_t upload_session = 0;                // Session being uploaded, or the lowest id to look for
+    uint32_t upload_offset = 0;                 // Bytes of it the broker has acknowledged
+    uint32_t upload_cursor_unsaved = 0;
+    uint32_t upload_idle_total = UINT32_MAX;    // Summary total when nothing was left to upload
+    int upload_msg_id = -1;                     // Chunk awaiting its PUBACK, -1: none
+    uint32_t upload_sent_length = 0;            // 0: the done message
+    uint32_t upload_sent_ms = 0;
+    uint8_t upload_chunk[NET_MQTT_UPLOAD_CHUNK_BYTES];  // LittleFS sessions only
+
+    HttpOtaDownloader ota_downloader;
+    bool ota_deferred_logged = false;
+
+    // Telemetry batch being filled
+    static const size_t BATCH_HEADER_BYTES = 16;
+    static const size_t BATCH_SAMPLE_BYTES = 8;
+    uint8_t batch[BATCH_HEADER_BYTES + NET_MQTT_TELEMETRY_MAX_SAMPLES * BATCH_SAMPLE_BYTES];
+    uint8_t lane_divider = 0;                   // Divider the tick lane runs with; 0: off
+    Telemetry* tick_lane = nullptr;             // The selected grinder's lane, set by update_tick_lane()
+    uint32_t batch_count = 0;
+    uint32_t batch_started_ms = 0;
+    uint32_t batch_first_ms = 0;
+    int32_t batch_first_cg = 0;
+    uint32_t batch_last_ms = 0;                 // Session time of the previous sample
+    int32_t batch_last_cg = 0;                  // Reconstructed weight of the previous sample, 0.01 g
+    uint8_t batch_last_phase = 0;
+
+    static void task_wrapper(void* parameter);
+    void task_impl();
+    void load_config();
+    void update_wifi(uint32_t now);
+    void start_client();
+    void stop_client();
+    void publish_discovery();
+    void publish_state(uint32_t now);
+    void publish_sessions(uint32_t now);
+    void save_session_cursor();
+    void publish_uploads(uint32_t now);
+    void publish_query_reply();
+    void publish_orders();
+    void publish_rollups();
+    bool open_upload_session();
+    void finish_upload_session();
+    void save_upload_cursor();
+    bool is_acked(int msg_id) const;
+    void update_tick_lane(bool publishing);
+    void publish_telemetry(uint32_t now);
+    void add_batch_sample(const TelemetryTick& tick, uint32_t now);
+    void flush_batch(uint32_t now);
+    void publish_diagnostics(uint32_t now);
+    void publish_crash();
+    void run_ota();
+    void publish_ota_status(const char* status, const char* detail);
+    int publish(const char* leaf, const void* message, size_t length, int qos, bool retain);   // msg_id, -1 on failure; length 0: text
+    int publish_topic(const char* topic, const void* message, size_t length, int qos, bool retain);
+    void handle_message(const char* topic, int topic_len, const char* data, int data_len);
+    static void on_event(void* handler_args, const char* base, int32_t event_id, void* event_data);
+};
+
+extern MqttManager mqtt_manager;
@@ -0,0 +1,290 @@
+#include "web_dashboard.h"
+
+#if NETWORK_WEB_ENABLED
+
+#include <WiFi.h>
+#include <esp_http_server.h>
+#include "../bluetooth/manager.h"
+#include "../controllers/grind_channels.h"
+#include "../logging/grind_logging.h"
+#include "../system/radio_coexistence.h"
+#include "../system/telemetry.h"
+#include "../system/ui_snapshot.h"
+#include "web_dashboard_page.h"
+#include <math.h>
+
+WebDashboard web_dashboard;
+
+static esp_err_t handle_page(httpd_req_t* request) {
+    if (!radio_coexistence.allow(RadioWork::WEB_PAGE)) {
+        httpd_resp_set_status(request, "503 Service Unavailable");
+        httpd_resp_set_hdr(request, "Retry-After", "5");
+        return httpd_resp_sendstr(request, "Grinding - reload in a few seconds");
+    }
+    httpd_resp_set_type(request, "text/html");
+    return httpd_resp_send(request, WEB_DASHBOARD_PAGE, sizeof(WEB_DASHBOARD_PAGE) - 1);
+}
+
+static esp_err_t handle_socket(httpd_req_t* request) {
+    if (request->method == HTTP_GET) {
+        static_cast<WebDashboard*>(request->user_ctx)->on_client_connected();
+        return ESP_OK;
+    }
+    // The page sends nothing; anything that arrives is read and dropped
+    httpd_ws_frame_t frame = {};
+    esp_err_t err = httpd_ws_recv_frame(request, &frame, 0);
+    if (err != ESP_OK || frame.len == 0) {
+        return err;
+    }
+    uint8_t discard[32];
+    if (frame.len > sizeof(discard)) {
+        return ESP_FAIL;                        // Closes the socket
+    }
+    frame.payload = discard;
+    return httpd_ws_recv_frame(request, &frame, frame.len);
+}
+
+void WebDashboard::begin() {
+    for (Frame& frame : frames) {
+        frame.owner = this;
+    }
+    if (xTaskCreatePinnedToCore(task_wrapper, "Web", SYS_TASK_WEB_STACK_SIZE, this,
+                                SYS_TASK_PRIORITY_WEB, &task, SYS_TASK_CORE_WEB) != pdPASS) {
+        task = nullptr;
+        LOG_BLE("ERROR: Failed to create web dashboard task\n");
+    }
+}
+
+void WebDashboard::set_network_up(bool up) {
+    if (network_up.exchange(up, std::memory_order_acq_rel) != up && task) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void WebDashboard::on_client_connected() {
+    client_count.fetch_add(1, std::memory_order_relaxed);  // Corrected by the next send
+    backlog_pending.store(true, std::memory_order_release);
+    if (task) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void WebDashboard::task_wrapper(void* parameter) {
+    static_cast<WebDashboard*>(parameter)->task_impl();
+}
+
+void WebDashboard::task_impl() {
+    LOG_BLE("Web Task started on Core %d\n", xPortGetCoreID());
+
+    while (true) {
+        // Nobody listening: sleep until Wi-Fi changes or a client connects
+        bool listening = server && client_count.load(std::memory_order_relaxed) > 0;
+        ulTaskNotifyTake(pdTRUE, listening ? pdMS_TO_TICKS(NET_WEB_SAMPLE_INTERVAL_MS) : portMAX_DELAY);
+
+        bool up = network_up.load(std::memory_order_acquire);
+        if (up && !server) {
+            start_server();
+        } else if (!up && server) {
+            stop_server();
+        }
+        if (!server || client_count.load(std::memory_order_relaxed) == 0) {
+            sample_count = 0;
+            sequence_valid = false;
+            continue;
+        }
+
+        // Leave the radio to a BLE OTA transfer
+        if (g_bluetooth_manager.is_updating()) {
+            continue;
+        }
+        uint32_t now = millis();
+        sample_snapshot(now);
+        push_sessions();
+    }
+}
+
+bool WebDashboard::start_server() {
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = NET_WEB_PORT;
+    config.max_open_sockets = NET_WEB_MAX_SOCKETS;
+    config.lru_purge_enable = true;
+    config.core_id = SYS_TASK_CORE_WEB;
+    config.task_priority = SYS_TASK_PRIORITY_WEB;
+    config.send_wait_timeout = NET_WEB_SEND_TIMEOUT_S;
+
+    httpd_handle_t handle = nullptr;
+    esp_err_t err = httpd_start(&handle, &config);
+    if (err != ESP_OK) {
+        LOG_BLE("ERROR: Web dashboard server start failed (%d)\n", err);
+        return false;
+    }
+    httpd_uri_t page = {};
+    page.uri = "/";
+    page.method = HTTP_GET;
+    page.handler = handle_page;
+    page.user_ctx = this;
+    httpd_register_uri_handler(handle, &page);
+
+    httpd_uri_t socket = {};
+    socket.uri = "/ws";
+    socket.method = HTTP_GET;
+    socket.handler = handle_socket;
+    socket.user_ctx = this;
+    socket.is_websocket = true;
+    httpd_register_uri_handler(handle, &socket);
+
+    server = handle;
+    LOG_BLE("WEB: Dashboard at http://%s:%u/\n", WiFi.localIP().toString().c_str(), (unsigned)NET_WEB_PORT);
+    return true;
+}
+
+void WebDashboard::stop_server() {
+    httpd_stop(static_cast<httpd_handle_t>(server));
+    server = nullptr;
+    // The server task is gone, and with it any send still queued
+    for (Frame& frame : frames) {
+        frame.sending.store(false, std::memory_order_release);
+    }
+    client_count.store(0, std::memory_order_relaxed);
+    sample_count = 0;
+    sequence_valid = false;
+    LOG_BLE("WEB: Dashboard stopped (Wi-Fi down)\n");
+}
+
+WebDashboard::Frame* WebDashboard::take_frame() {
+    Frame* frame = &frames[fill];
+    return frame->sending.load(std::memory_order_acquire) ? nullptr : frame;
+}
+
+void WebDashboard::sample_snapshot(uint32_t now) {
+    UISnapshot snapshot = ui_snapshot.read();
+    if (!sequence_valid || snapshot.sequence != last_sequence) {
+        // Another grinder's slot after a selection change counts on from its own sequence
+        if (sequence_valid && snapshot.sequence > last_sequence) {
+            skipped += snapshot.sequence - last_sequence - 1;
+        }
+        last_sequence = snapshot.sequence;
+        sequence_valid = true;
+
+        Frame* frame = take_frame();
+        if (!frame) {
+            skipped++;                          // Both frames still on their way out
+        } else {
+            if (sample_count == 0) {
+                batch_started_ms = now;
+            }
+            // Written in place: the frame buffer is what goes on the wire
+            WebTelemetrySample* sample = reinterpret_cast<WebTelemetrySample*>(
+                frame->bytes + sizeof(WebDashboardFrameHeader)) + sample_count;
+            float flow_cgps = roundf(snapshot.flow_rate * 100.0f);
+            sample->timestamp_us = snapshot.sample_timestamp_us;
+            sample->live_weight_g = snapshot.live_weight;
+            sample->display_weight_g = snapshot.display_weight;
+            sample->flow_cgps = (int16_t)(flow_cgps > INT16_MAX ? INT16_MAX : (flow_cgps < INT16_MIN ? INT16_MIN : flow_cgps));
+            sample->phase = channel_telemetry(grind_channels.get_selected()).get_phase();
+            sample->reserved = 0;
+            sample_count++;
+        }
+    }
+    if (sample_count > 0 && (sample_count == NET_WEB_FRAME_MAX_SAMPLES || now - batch_started_ms >= NET_WEB_PUSH_INTERVAL_MS)) {
+        flush_telemetry();
+    }
+}
+
+void WebDashboard::flush_telemetry() {
+    queue_frame(&frames[fill], WEB_FRAME_TELEMETRY, sample_count, sample_count * sizeof(WebTelemetrySample));
+    sample_count = 0;
+    skipped = 0;
+}
+
+void WebDashboard::push_sessions() {
+    const SessionSummaryTable& table = grind_logger.get_session_summaries();
+    if (!table.is_ready()) {
+        return;
+    }
+    uint32_t total = table.get_total();
+    if (backlog_pending.exchange(false, std::memory_order_acquire)) {
+        // Every client gets the backlog again; the page keys sessions by id
+        session_total = total > NET_WEB_SESSION_BACKLOG ? total - NET_WEB_SESSION_BACKLOG : 0;
+        session_total_valid = true;
+    }
+    if (!session_total_valid || session_total > total) {
+        session_total = total;                  // Nothing old on the first pass; the table was cleared
+        session_total_valid = true;
+    }
+    uint32_t oldest = total - table.get_count();
+    if (session_total < oldest) {
+        session_total = oldest;
+    }
+    if (session_total == total || !radio_coexistence.allow(RadioWork::WEB_SESSIONS)) {
+        return;
+    }
+
+    // Summaries go out at a frame boundary: send the samples so far, then use the next frame
+    if (sample_count > 0) {
+        flush_telemetry();
+    }
+    Frame* frame = take_frame();
+    if (!frame) {
+        return;                                 // Next pass
+    }
+    SessionSummary* records = reinterpret_cast<SessionSummary*>(frame->bytes + sizeof(WebDashboardFrameHeader));
+    uint16_t count = 0;
+    while (count < FRAME_SESSIONS && session_total < total &&
+           table.get_latest(total - 1 - session_total, &records[count])) {
+        count++;
+        session_total++;
+    }
+    if (count > 0) {
+        queue_frame(frame, WEB_FRAME_SESSIONS, count, count * sizeof(SessionSummary));
+    }
+}
+
+void WebDashboard::queue_frame(Frame* frame, uint8_t type, uint16_t count, size_t record_bytes) {
+    WebDashboardFrameHeader header;
+    header.type = type;
+    header.version = WEB_FRAME_VERSION;
+    header.count = count;
+    header.skipped = type == WEB_FRAME_TELEMETRY ? (uint16_t)(skipped > UINT16_MAX ? UINT16_MAX : skipped) : 0;
+    header.eta_ds = type == WEB_FRAME_TELEMETRY ? channel_telemetry(grind_channels.get_selected()).get_eta_ds()
+                                                : TELEMETRY_ETA_UNKNOWN;
+    memcpy(frame->bytes, &header, sizeof(header));
+    frame->length = sizeof(header) + record_bytes;
+
+    frame->sending.store(true, std::memory_order_release);
+    if (httpd_queue_work(static_cast<httpd_handle_t>(server), send_frame, frame) != ESP_OK) {
+        frame->sending.store(false, std::memory_order_release);
+        return;                                 // Dropped; the buffer is filled again
+    }
+    fill ^= 1;
+}
+
+// Runs on the server task, which owns the sockets; a client that cannot take the frame is closed
+void WebDashboard::send_frame(void* arg) {
+    Frame* frame = static_cast<Frame*>(arg);
+    httpd_handle_t handle = static_cast<httpd_handle_t>(frame->owner->server);
+    size_t fd_count = NET_WEB_MAX_SOCKETS;
+    int fds[NET_WEB_MAX_SOCKETS];
+    uint8_t clients = 0;
+    if (handle && httpd_get_client_list(handle, &fd_count, fds) == ESP_OK) {
+        httpd_ws_frame_t message = {};
+        message.final = true;
+        message.type = HTTPD_WS_TYPE_BINARY;
+        message.payload = frame->bytes;
+        message.len = frame->length;
+        for (size_t i = 0; i < fd_count; i++) {
+            if (httpd_ws_get_fd_info(handle, fds[i]) != HTTPD_WS_CLIENT_WEBSOCKET) {
+                continue;
+            }
+            if (httpd_ws_send_frame_async(handle, fds[i], &message) == ESP_OK) {
+                clients++;
+            } else {
+                httpd_sess_trigger_close(handle, fds[i]);
+            }
+        }
+    }
+    frame->owner->client_count.store(clients, std::memory_order_relaxed);
+    frame->sending.store(false, std::memory_order_release);
+}
+
+#endif // NETWORK_WEB_ENABLED
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "../config/constants.h"
+#include "../logging/session_summary.h"
+
+// WebDashboardFrameHeader::type
+enum WebDashboardFrameType : uint8_t {
+    WEB_FRAME_TELEMETRY = 1,        // WebTelemetrySample records, oldest first
+    WEB_FRAME_SESSIONS = 2          // SessionSummary records, oldest first
+};
+
+constexpr uint8_t WEB_FRAME_VERSION = 1;
+
+#pragma pack(push, 1)
+// Every WebSocket message: this header, then `count` records of the type's size, little-endian
+struct WebDashboardFrameHeader {
+    uint8_t  type;                 // WebDashboardFrameType
+    uint8_t  version;              // WEB_FRAME_VERSION
+    uint16_t count;
+    uint16_t skipped;              // Telemetry: UI snapshots not sampled since the previous frame
+    uint16_t eta_ds;               // Telemetry: time to target, 0.1 s, TELEMETRY_ETA_UNKNOWN outside a session
+};
+
+// One UI snapshot: the weights the screen showed at that control tick
+struct WebTelemetrySample {
+    uint32_t timestamp_us;         // esp_timer µs (32-bit) of the newest load cell sample
+    float    live_weight_g;        // Low-latency weight
+    float    display_weight_g;     // Filtered weight, as on the screen
+    int16_t  flow_cgps;            // Flow, 0.01 g/s
+    uint8_t  phase;                // GrindPhase
+    uint8_t  reserved;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(WebDashboardFrameHeader) == 8, "Unexpected WebDashboardFrameHeader size");
+static_assert(sizeof(WebTelemetrySample) == 16, "Unexpected WebTelemetrySample size");
+
+/**
+ * WebDashboard - Local dashboard over Wi-Fi for stations without a broker
+ *
+ * Built with -DNETWORK_WEB_ENABLED=1 next to the MQTT client, whose task owns
+ * the Wi-Fi link and reports it with set_network_up(); a stored SSID is enough,
+ * the broker URI may be empty. While Wi-Fi is up, esp_http_server (its own
+ * task, Core 1, MQTT's priority) serves on NET_WEB_PORT:
+ *   /     the dashboard page, one static string sent straight out of flash
+ *   /ws   a WebSocket of binary frames (WebDashboardFrameHeader + records)
+ *
+ * The Web task samples the UISnapshotBuffer every NET_WEB_SAMPLE_INTERVAL_MS
+ * while a WebSocket client is connected (otherwise it sleeps until one is) and
+ * writes each new snapshot as a WebTelemetrySample directly into the frame
+ * being filled; every NET_WEB_PUSH_INTERVAL_MS, or at NET_WEB_FRAME_MAX_SAMPLES,
+ * that buffer is handed whole to the server task (httpd_queue_work), which
+ * sends it to every client, and the other of the two buffers is filled next.
+ * The records are the wire format, so nothing is serialized twice; a snapshot
+ * that finds both buffers still sending is counted in `skipped`.
+ *
+ * New session summaries go out as WEB_FRAME_SESSIONS frames of the table's
+ * records, and a client that connects first gets the newest
+ * NET_WEB_SESSION_BACKLOG. Summaries and page loads wait out a grind
+ * (RadioCoexistence, the page answers 503); telemetry frames do not. Pushes
+ * pause during a BLE OTA like MQTT publishing.
+ */
+class WebDashboard {
+public:
+    void begin();
+    void set_network_up(bool up);               // MQTT task: Wi-Fi joined or lost
+    void on_client_connected();                 // Server task: a WebSocket handshake completed
+
+    uint8_t get_client_count() const { return client_count.load(std::memory_order_relaxed); }
+
+private:
+    static const size_t FRAME_BYTES = sizeof(WebDashboardFrameHeader) +
+                                      NET_WEB_FRAME_MAX_SAMPLES * sizeof(WebTelemetrySample);
+    static const size_t FRAME_SESSIONS = (FRAME_BYTES - sizeof(WebDashboardFrameHeader)) / sizeof(SessionSummary);
+    static_assert(FRAME_SESSIONS > 0, "A dashboard frame must hold a session summary");
+
+    // A frame is filled by the Web task, then owned by the server task until sent
+    struct Frame {
+        uint8_t bytes[FRAME_BYTES];
+        size_t length;
+        std::atomic<bool> sending;
+        WebDashboard* owner;
+    };
+
+    TaskHandle_t task = nullptr;
+    void* server = nullptr;                     // httpd_handle_t, kept out of this header; set by the Web task around start/stop
+    std::atomic<bool> network_up{false};
+    std::atomic<bool> backlog_pending{false};   // A client connected: send it the recent summaries
+    std::atomic<uint8_t> client_count{0};       // WebSocket clients at the last send
+
+    // Owned by the Web task
+    Frame frames[2];
+    uint8_t fill = 0;                           // Frame the samples go into
+    uint16_t sample_count = 0;
+    uint32_t batch_started_ms = 0;
+    uint32_t last_sequence = 0;
+    bool sequence_valid = false;
+    uint32_t skipped = 0;
+    uint32_t session_total = 0;                 // SessionSummaryTable total already pushed
+    bool session_total_valid = false;
+
+    static void task_wrapper(void* parameter);
+    void task_impl();
+    bool start_server();
+    void stop_server();
+    void sample_snapshot(uint32_t now);
+    void push_sessions();
+    Frame* take_frame();                        // The fill frame if it is free, else nullptr
+    void flush_telemetry();
+    void queue_frame(Frame* frame, uint8_t type, uint16_t count, size_t record_bytes);
+
+    static void send_frame(void* arg);          // Server task (httpd_queue_work)
+};
+
+extern WebDashboard web_dashboard;
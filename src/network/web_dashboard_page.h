@@ -0,0 +1,46 @@
+#pragma once
+
+// Dashboard page served at / (WebDashboard). Parses the binary WebSocket frames:
+// WebDashboardFrameHeader (8 bytes), then WebTelemetrySample (16) or SessionSummary (108) records.
+static const char WEB_DASHBOARD_PAGE[] = R"HTML(<!DOCTYPE html>
+<html><head><meta charset="utf-8"><meta name="viewport" content="width=device-width,initial-scale=1">
+<title>Grinder</title>
+<style>
+body{font-family:sans-serif;background:#111;color:#eee;margin:1em}
+#now{display:flex;gap:2em;font-size:1.4em}#now b{font-size:1.8em;display:block}
+canvas{width:100%;height:240px;background:#1b1b1b;margin:1em 0}
+table{border-collapse:collapse;width:100%}td,th{padding:.3em .6em;text-align:right;border-bottom:1px solid #333}
+#link{color:#888}
+</style></head><body>
+<div id="now"><div>Weight<b id="w">-</b></div><div>Flow<b id="f">-</b></div><div>Phase<b id="p">-</b></div><div>ETA<b id="e">-</b></div></div>
+<canvas id="c" width="900" height="240"></canvas>
+<div id="link">connecting</div>
+<table><thead><tr><th>Session</th><th>Profile</th><th>Target g</th><th>Error g</th><th>Flow g/s</th><th>Pulses</th><th>Time s</th><th>Result</th></tr></thead><tbody id="s"></tbody></table>
+<script>
+const PHASES=['Idle','Init','Setup','Taring','Tare','Grinding','Pulse?','Pulse','Pulse settle','Settling','Time grind','Time pulse','Done','Timeout','Prime','Prime settle'];
+const RESULTS=['Completed','Timeout','Overshoot','Max pulses','Stalled','Unstable'];
+const WINDOW_US=30e6;let points=[],sessions=new Map();
+function draw(){const c=document.getElementById('c'),g=c.getContext('2d');g.clearRect(0,0,c.width,c.height);
+if(points.length<2)return;const t1=points[points.length-1].t,max=Math.max(1,...points.map(p=>p.w))*1.1;
+g.strokeStyle='#4af';g.beginPath();points.forEach((p,i)=>{const x=c.width*(1-((t1-p.t)>>>0)/WINDOW_US),y=c.height*(1-p.w/max);i?g.lineTo(x,y):g.moveTo(x,y)});g.stroke();
+g.fillStyle='#888';g.fillText(max.toFixed(1)+' g',4,12)}
+function telemetry(v,n,eta){for(let i=0;i<n;i++){const o=8+i*16;
+points.push({t:v.getUint32(o,true),w:v.getFloat32(o+8,true)});
+if(i==n-1){document.getElementById('w').textContent=v.getFloat32(o+8,true).toFixed(1)+' g';
+document.getElementById('f').textContent=(v.getInt16(o+12,true)/100).toFixed(2)+' g/s';
+document.getElementById('p').textContent=PHASES[v.getUint8(o+14)]||'?'}}
+const t1=points.length?points[points.length-1].t:0;while(points.length&&((t1-points[0].t)>>>0)>WINDOW_US)points.shift();
+document.getElementById('e').textContent=eta==0xFFFF?'-':(eta/10).toFixed(1)+' s';draw()}
+function summaries(v,n){for(let i=0;i<n;i++){const o=8+i*108;
+sessions.set(v.getUint32(o,true),{id:v.getUint32(o,true),target:v.getFloat32(o+8,true),error:v.getFloat32(o+12,true),
+flow:v.getFloat32(o+16,true),time:v.getUint16(o+30,true)/10,pulses:v.getUint8(o+32),result:v.getUint8(o+33),profile:v.getUint8(o+34)})}
+const rows=[...sessions.values()].sort((a,b)=>b.id-a.id).slice(0,50);
+document.getElementById('s').innerHTML=rows.map(s=>`<tr><td>${s.id}</td><td>${s.profile}</td><td>${s.target.toFixed(1)}</td><td>${isNaN(s.error)?'-':s.error.toFixed(2)}</td><td>${isNaN(s.flow)?'-':s.flow.toFixed(2)}</td><td>${s.pulses}</td><td>${s.time.toFixed(1)}</td><td>${RESULTS[s.result]||s.result}</td></tr>`).join('')}
+function connect(){const ws=new WebSocket('ws://'+location.host+'/ws');ws.binaryType='arraybuffer';
+ws.onopen=()=>document.getElementById('link').textContent='live';
+ws.onclose=()=>{document.getElementById('link').textContent='reconnecting';setTimeout(connect,2000)};
+ws.onmessage=m=>{const v=new DataView(m.data);if(v.getUint8(1)!=1)return;const type=v.getUint8(0),n=v.getUint16(2,true);
+if(type==1)telemetry(v,n,v.getUint16(6,true));else if(type==2)summaries(v,n)}}
+connect();
+</script></body></html>
+)HTML";
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Appends little-endian fields (the ESP32 byte order) to a caller buffer for compact BLE
+// payloads. Once a field does not fit the writer stays overflowed and size() reports 0,
+// like the snprintf-based formatters, so a truncated payload is never sent.
+class BinaryWriter {
+public:
+    BinaryWriter(uint8_t* buffer, size_t capacity) : buffer(buffer), capacity(capacity) {}
+
+    void u8(uint8_t value) { bytes(&value, sizeof(value)); }
+    void u16(uint16_t value) { bytes(&value, sizeof(value)); }
+    void u32(uint32_t value) { bytes(&value, sizeof(value)); }
+    void f32(float value) { bytes(&value, sizeof(value)); }
+    void u16_clamped(uint32_t value) { u16(value > UINT16_MAX ? UINT16_MAX : (uint16_t)value); }
+
+    // Length-prefixed string, cut at 255 bytes
+    void str8(const char* text) {
+        size_t length = strlen(text);
+        if (length > UINT8_MAX) {
+            length = UINT8_MAX;
+        }
+        u8((uint8_t)length);
+        bytes(text, length);
+    }
+
+    void bytes(const void* data, size_t size) {
+        if (overflow || size > capacity - used) {
+            overflow = true;
+            return;
+        }
+        memcpy(buffer + used, data, size);
+        used += size;
+    }
+
+    size_t size() const { return overflow ? 0 : used; }
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t used = 0;
+    bool overflow = false;
+};
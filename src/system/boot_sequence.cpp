@@ -0,0 +1,70 @@
+#include "boot_sequence.h"
+#include <esp_timer.h>
+#include "../config/constants.h"
+
+BootSequence boot_sequence;
+
+namespace {
+const char* const kStageNames[(size_t)BootStage::COUNT] = {
+    "fs", "hw", "controllers", "first_frame", "tasks", "ble", "load_cell"
+};
+} // namespace
+
+void BootSequence::begin() {
+    if (!events) {
+        events = xEventGroupCreate();
+    }
+}
+
+void BootSequence::mark(BootStage stage) {
+    // esp_timer starts before app_main, so a stamp of 0 never means "reached"
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    uint32_t expected = 0;
+    stamps_ms[(size_t)stage].compare_exchange_strong(expected, now_ms > 0 ? now_ms : 1, std::memory_order_release);
+    if (events) {
+        xEventGroupSetBits(events, 1u << (size_t)stage);
+    }
+}
+
+bool BootSequence::wait(BootStage stage, TickType_t timeout) const {
+    if (!events) {
+        return is_done(stage);
+    }
+    EventBits_t bit = 1u << (size_t)stage;
+    return (xEventGroupWaitBits(events, bit, pdFALSE, pdTRUE, timeout) & bit) != 0;
+}
+
+bool BootSequence::is_complete() const {
+    for (size_t i = 0; i < (size_t)BootStage::COUNT; i++) {
+        if (!is_done((BootStage)i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* BootSequence::get_name(BootStage stage) {
+    return stage < BootStage::COUNT ? kStageNames[(size_t)stage] : "?";
+}
+
+size_t BootSequence::format(char* buffer, size_t buffer_size) const {
+    size_t used = 0;
+    for (size_t i = 0; i < (size_t)BootStage::COUNT && used < buffer_size; i++) {
+        uint32_t ms = get_ms((BootStage)i);
+        int written = ms ? snprintf(buffer + used, buffer_size - used, "%s%s=%lu", i == 0 ? "" : " ",
+                                    kStageNames[i], (unsigned long)ms)
+                         : snprintf(buffer + used, buffer_size - used, "%s%s=-", i == 0 ? "" : " ", kStageNames[i]);
+        used = (written < 0 || (size_t)written >= buffer_size - used) ? buffer_size : used + written;
+    }
+    if (used >= buffer_size) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return used;
+}
+
+void BootSequence::print() const {
+    char line[128];
+    format(line, sizeof(line));
+    LOG_BLE("[BOOT] Timeline (ms since power-on): %s\n", line);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+// Ids are fixed at compile time: add an entry before COUNT and its name in boot_sequence.cpp.
+enum class BootStage : uint8_t {
+    FILESYSTEM,                     // LittleFS mounted (Core 0 boot job)
+    HARDWARE,                       // NVS, display, LVGL, sensor config and relay (setup, Core 1)
+    CONTROLLERS,                    // Preferences, profiles, statistics, grind controller, BLE stack
+    FIRST_FRAME,                    // Initial screen flushed to the panel
+    TASKS,                          // FreeRTOS tasks created
+    BLUETOOTH,                      // Boot advertising decision applied (Bluetooth task)
+    LOAD_CELL,                      // HX711 bring-up finished, pass or fail (Core 0 boot job)
+    COUNT
+};
+
+/**
+ * BootSequence - Readiness flags and timeline for the parallel boot
+ *
+ * setup() runs the display, LVGL and controller init on Core 1 while a
+ * one-shot Core 0 job mounts LittleFS and brings up the HX711. Each side
+ * marks the stages it finishes; a step that needs another stage waits on
+ * its event group bit instead of running after it in one long sequence.
+ * Stamps are ms since power-on (esp_timer), written once by the marking
+ * task and read from anywhere.
+ */
+class BootSequence {
+public:
+    void begin();                   // First thing in setup(), before any mark()
+    void mark(BootStage stage);
+    bool wait(BootStage stage, TickType_t timeout = portMAX_DELAY) const;
+    bool is_done(BootStage stage) const { return get_ms(stage) != 0; }
+    bool is_complete() const;
+    uint32_t get_ms(BootStage stage) const { return stamps_ms[(size_t)stage].load(std::memory_order_acquire); }
+
+    static const char* get_name(BootStage stage);
+
+    // "fs=412 hw=655 ..." in stage order, "-" for stages not reached yet
+    size_t format(char* buffer, size_t buffer_size) const;
+    void print() const;
+
+private:
+    EventGroupHandle_t events = nullptr;
+    std::atomic<uint32_t> stamps_ms[(size_t)BootStage::COUNT] = {};
+};
+
+extern BootSequence boot_sequence;
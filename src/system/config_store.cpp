@@ -0,0 +1,203 @@
+#include "config_store.h"
+#include "preference_cache.h"
+#include "../config/constants.h"
+#include "../config/logging.h"
+
+#include <Arduino.h>
+#include <cstring>
+
+ConfigStore config_store;
+
+namespace {
+constexpr const char* kBlobKey = "config";
+
+static_assert(sizeof(ConfigBlob) <= PreferenceCache::kMaxValueLength, "ConfigBlob must fit a PreferenceCache entry");
+
+// Where each value lived before the blob; namespace nullptr = "grinder" (HardwareManager's handle)
+struct LegacyKey {
+    const char* name_space;
+    const char* key;
+};
+
+const LegacyKey kLegacyFloats[(size_t)ConfigFloat::COUNT] = {
+    {nullptr, "weight0"},
+    {nullptr, "weight1"},
+    {nullptr, "weight2"},
+    {nullptr, "time0"},
+    {nullptr, "time1"},
+    {nullptr, "time2"},
+    {nullptr, "hx_cal"},
+    {nullptr, "hx_wt"},
+    {nullptr, "motor_lat_ms"},
+    {"brightness", "normal"},
+    {"brightness", "screensaver"},
+    {nullptr, "vib_hz"},
+    {nullptr, "lc_ch2_gain"},
+};
+
+const LegacyKey kLegacyBytes[(size_t)ConfigByte::COUNT] = {
+    {nullptr, "profile"},
+    {nullptr, "grind_mode"},
+    {nullptr, "batch_doses"},
+    {nullptr, "grind_layout"},
+};
+
+const LegacyKey kLegacyFlags[(size_t)ConfigFlag::COUNT] = {
+    {"load_cell", "calibrated"},
+    {nullptr, "prime_enabled"},
+    {"swipe", "enabled"},
+    {"bluetooth", "startup"},
+    {"logging", "enabled"},
+    {"logging", "adc_capture"},
+    {"autogrind", "auto_start"},
+    {"autogrind", "auto_return"},
+};
+
+class ConfigLockGuard {
+public:
+    explicit ConfigLockGuard(SemaphoreHandle_t mutex) : mutex_(mutex) {
+        if (mutex_) {
+            xSemaphoreTake(mutex_, portMAX_DELAY);
+        }
+    }
+
+    ~ConfigLockGuard() {
+        if (mutex_) {
+            xSemaphoreGive(mutex_);
+        }
+    }
+
+private:
+    SemaphoreHandle_t mutex_;
+};
+} // namespace
+
+void ConfigStore::set_defaults(ConfigBlob* defaults) {
+    memset(defaults, 0, sizeof(*defaults));
+    defaults->version = kVersion;
+
+    float* floats = defaults->floats;
+    floats[(size_t)ConfigFloat::PROFILE_WEIGHT_0] = USER_SINGLE_ESPRESSO_WEIGHT_G;
+    floats[(size_t)ConfigFloat::PROFILE_WEIGHT_1] = USER_DOUBLE_ESPRESSO_WEIGHT_G;
+    floats[(size_t)ConfigFloat::PROFILE_WEIGHT_2] = USER_CUSTOM_PROFILE_WEIGHT_G;
+    floats[(size_t)ConfigFloat::PROFILE_TIME_0] = USER_SINGLE_ESPRESSO_TIME_S;
+    floats[(size_t)ConfigFloat::PROFILE_TIME_1] = USER_DOUBLE_ESPRESSO_TIME_S;
+    floats[(size_t)ConfigFloat::PROFILE_TIME_2] = USER_CUSTOM_PROFILE_TIME_S;
+    floats[(size_t)ConfigFloat::CALIBRATION_FACTOR] = USER_DEFAULT_CALIBRATION_FACTOR;
+    floats[(size_t)ConfigFloat::CALIBRATION_WEIGHT] = USER_CALIBRATION_REFERENCE_WEIGHT_G;
+    floats[(size_t)ConfigFloat::MOTOR_LATENCY_MS] = GRIND_MOTOR_RESPONSE_LATENCY_DEFAULT_MS;
+    floats[(size_t)ConfigFloat::BRIGHTNESS_NORMAL] = USER_SCREEN_BRIGHTNESS_NORMAL;
+    floats[(size_t)ConfigFloat::BRIGHTNESS_SCREENSAVER] = USER_SCREEN_BRIGHTNESS_DIMMED;
+    floats[(size_t)ConfigFloat::VIBRATION_NOTCH_HZ] = HW_LOADCELL_VIBRATION_NOTCH_HZ;
+    floats[(size_t)ConfigFloat::CHANNEL2_GAIN] = HW_LOADCELL_CHANNEL2_GAIN;
+
+    defaults->bytes[(size_t)ConfigByte::PROFILE] = 1;
+    defaults->bytes[(size_t)ConfigByte::GRIND_MODE] = 0;        // GrindMode::WEIGHT
+    defaults->bytes[(size_t)ConfigByte::BATCH_DOSES] = 1;
+    defaults->bytes[(size_t)ConfigByte::GRIND_LAYOUT] = 0;      // GrindScreenLayout::MINIMAL_ARC
+
+    defaults->flags = (1u << (uint8_t)ConfigFlag::BLE_STARTUP) |
+                      (SYS_LOG_ADC_CAPTURE_DEFAULT ? (1u << (uint8_t)ConfigFlag::ADC_CAPTURE) : 0u);
+}
+
+void ConfigStore::init(Preferences* prefs, const char* key) {
+    preferences = prefs;
+    blob_key = key;
+    if (!mutex) {
+        mutex = xSemaphoreCreateMutexStatic(&mutex_buffer);
+    }
+
+    ConfigBlob stored;
+    if (preferences && preferences->getBytesLength(blob_key) == sizeof(stored) &&
+        preferences->getBytes(blob_key, &stored, sizeof(stored)) == sizeof(stored) && stored.version == kVersion) {
+        blob = stored;
+        return;
+    }
+
+    set_defaults(&blob);
+    if (preferences) {
+        // The pre-blob keys belong to the first grinder
+        if (strcmp(blob_key, kBlobKey) == 0) {
+            migrate_legacy_keys();
+        }
+        ConfigLockGuard lock(mutex);
+        publish_locked();
+        LOG_BLE("Configuration blob built from the individual preferences\n");
+    }
+}
+
+// One pass over the pre-blob keys, each namespace opened once
+void ConfigStore::migrate_legacy_keys() {
+    const char* name_spaces[] = {nullptr, "brightness", "load_cell", "swipe", "bluetooth", "logging", "autogrind"};
+    for (const char* name_space : name_spaces) {
+        Preferences other;
+        Preferences* source = preferences;
+        if (name_space) {
+            if (!other.begin(name_space, true)) {
+                continue;   // Never written: defaults stand
+            }
+            source = &other;
+        }
+
+        auto matches = [name_space](const LegacyKey& legacy) {
+            return legacy.name_space == name_space ||
+                   (legacy.name_space && name_space && strcmp(legacy.name_space, name_space) == 0);
+        };
+        for (size_t i = 0; i < (size_t)ConfigFloat::COUNT; i++) {
+            if (matches(kLegacyFloats[i]) && source->isKey(kLegacyFloats[i].key)) {
+                blob.floats[i] = source->getFloat(kLegacyFloats[i].key, blob.floats[i]);
+            }
+        }
+        for (size_t i = 0; i < (size_t)ConfigByte::COUNT; i++) {
+            if (matches(kLegacyBytes[i]) && source->isKey(kLegacyBytes[i].key)) {
+                blob.bytes[i] = (uint8_t)source->getInt(kLegacyBytes[i].key, blob.bytes[i]);
+            }
+        }
+        for (size_t i = 0; i < (size_t)ConfigFlag::COUNT; i++) {
+            if (matches(kLegacyFlags[i]) && source->isKey(kLegacyFlags[i].key)) {
+                bool value = source->getBool(kLegacyFlags[i].key, false);
+                blob.flags = value ? (blob.flags | (1u << i)) : (blob.flags & ~(1u << i));
+            }
+        }
+
+        if (name_space) {
+            other.end();
+        }
+    }
+}
+
+void ConfigStore::set_float(ConfigFloat key, float value) {
+    ConfigLockGuard lock(mutex);
+    if (blob.floats[(size_t)key] == value) {
+        return;
+    }
+    blob.floats[(size_t)key] = value;
+    publish_locked();
+}
+
+void ConfigStore::set_byte(ConfigByte key, uint8_t value) {
+    ConfigLockGuard lock(mutex);
+    if (blob.bytes[(size_t)key] == value) {
+        return;
+    }
+    blob.bytes[(size_t)key] = value;
+    publish_locked();
+}
+
+void ConfigStore::set_flag(ConfigFlag key, bool value) {
+    ConfigLockGuard lock(mutex);
+    uint8_t flags = value ? (blob.flags | (1u << (uint8_t)key)) : (blob.flags & ~(1u << (uint8_t)key));
+    if (flags == blob.flags) {
+        return;
+    }
+    blob.flags = flags;
+    publish_locked();
+}
+
+void ConfigStore::flush() {
+    preference_cache.flush();
+}
+
+void ConfigStore::publish_locked() {
+    preference_cache.put_bytes(blob_key, &blob, sizeof(blob));
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <Preferences.h>
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Settings held in the configuration blob. Appending a value needs a ConfigStore::kVersion bump,
+// with init() carrying the previous version's values over, and a default in config_store.cpp.
+enum class ConfigFloat : uint8_t {
+    PROFILE_WEIGHT_0,           // "weight0".."weight2"
+    PROFILE_WEIGHT_1,
+    PROFILE_WEIGHT_2,
+    PROFILE_TIME_0,             // "time0".."time2"
+    PROFILE_TIME_1,
+    PROFILE_TIME_2,
+    CALIBRATION_FACTOR,         // "hx_cal"
+    CALIBRATION_WEIGHT,         // "hx_wt"
+    MOTOR_LATENCY_MS,           // "motor_lat_ms"
+    BRIGHTNESS_NORMAL,          // brightness/"normal"
+    BRIGHTNESS_SCREENSAVER,     // brightness/"screensaver"
+    VIBRATION_NOTCH_HZ,         // "vib_hz"
+    CHANNEL2_GAIN,              // "lc_ch2_gain"
+    COUNT
+};
+
+enum class ConfigByte : uint8_t {
+    PROFILE,                    // "profile"
+    GRIND_MODE,                 // "grind_mode"
+    BATCH_DOSES,                // "batch_doses"
+    GRIND_LAYOUT,               // "grind_layout"
+    COUNT
+};
+
+enum class ConfigFlag : uint8_t {
+    CALIBRATED,                 // load_cell/"calibrated"
+    PRIME,                      // "prime_enabled"
+    SWIPE,                      // swipe/"enabled"
+    BLE_STARTUP,                // bluetooth/"startup"
+    LOGGING,                    // logging/"enabled"
+    ADC_CAPTURE,                // logging/"adc_capture"
+    AUTO_START,                 // autogrind/"auto_start"
+    AUTO_RETURN,                // autogrind/"auto_return"
+    COUNT
+};
+
+// NVS blob "config" in the "grinder" namespace ("config_chN" for further grinder channels)
+struct ConfigBlob {
+    uint8_t version;
+    uint8_t flags;                                      // Bit per ConfigFlag
+    uint8_t bytes[(size_t)ConfigByte::COUNT];
+    uint16_t reserved;
+    float floats[(size_t)ConfigFloat::COUNT];
+};
+
+static_assert((size_t)ConfigFlag::COUNT <= 8, "ConfigBlob::flags is one byte");
+static_assert(sizeof(ConfigBlob) == 60, "Unexpected ConfigBlob size");
+
+/**
+ * ConfigStore - The settings read at boot and by getters, in one NVS blob
+ *
+ * init() reads the "config" blob once into RAM; every get_*() after that is
+ * a plain load from the RAM copy, so boot does one NVS lookup instead of one
+ * per key across six namespaces, and getters that used to open a namespace
+ * per call (brightness, swipe, logging, auto actions) cost nothing. A blob
+ * that is missing or of another version is rebuilt from the legacy keys,
+ * read once; the legacy keys are left in place for a firmware rollback.
+ *
+ * set_*() updates the RAM copy and hands the whole blob to PreferenceCache,
+ * which coalesces writes and commits them once the grinder is idle; flush()
+ * commits now (calibration, which must survive a power cut right after).
+ *
+ * Getters are lock free (aligned words); setters are serialized by a mutex
+ * so the blob copies reach the cache in order. Task context only.
+ *
+ * A second grinder (GrindChannels) keeps its calibration and motor latency in
+ * a store of its own under another blob key; it has no legacy keys and starts
+ * from the defaults.
+ */
+class ConfigStore {
+public:
+    static constexpr uint8_t kVersion = 1;
+
+    void init(Preferences* prefs, const char* key = "config");
+
+    float get_float(ConfigFloat key) const { return blob.floats[(size_t)key]; }
+    uint8_t get_byte(ConfigByte key) const { return blob.bytes[(size_t)key]; }
+    bool get_flag(ConfigFlag key) const { return (blob.flags >> (uint8_t)key) & 1u; }
+
+    void set_float(ConfigFloat key, float value);
+    void set_byte(ConfigByte key, uint8_t value);
+    void set_flag(ConfigFlag key, bool value);
+
+    void flush();
+
+private:
+    ConfigBlob blob = {};
+    Preferences* preferences = nullptr;
+    const char* blob_key = "config";
+    StaticSemaphore_t mutex_buffer;
+    SemaphoreHandle_t mutex = nullptr;
+
+    static void set_defaults(ConfigBlob* defaults);
+    void migrate_legacy_keys();
+    void publish_locked();
+};
+
+extern ConfigStore config_store;
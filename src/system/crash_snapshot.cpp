@@ -0,0 +1,269 @@
+#include "crash_snapshot.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "telemetry.h"
+#include "../config/system.h"
+#include "../config/build_info.h"
+#include "../controllers/grind_phase_table.h"
+#include "../tasks/task_manager.h"
+#include "../tasks/grind_control_task.h"
+#include <esp_attr.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <stddef.h>
+#include <string.h>
+
+CrashSnapshot crash_snapshot;
+
+namespace {
+constexpr uint32_t kCrashMagic = 0x48535243;            // "CRSH"
+constexpr uint16_t kCrashVersion = 1;
+
+struct CrashRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t kind;                                       // CrashKind, NONE while armed
+    uint8_t grind_phase;
+    uint32_t build_number;
+    uint32_t captures;                                  // Hooks run since boot (the task watchdog fires repeatedly)
+    uint64_t uptime_us;
+
+    // refresh()
+    uint32_t refreshed_ms;                              // millis() of the last refresh, 0: none
+    uint32_t stack_size_bytes[TASK_MANAGER_TASK_COUNT];
+    uint32_t stack_min_free_bytes[TASK_MANAGER_TASK_COUNT];
+    uint32_t internal_free_bytes;
+    uint32_t internal_min_free_bytes;
+    uint32_t psram_free_bytes;
+    ControlLoopDeadlineStats deadlines;
+
+    // capture()
+    uint32_t captured_ms;
+    uint32_t timer_count[(size_t)PerfTimer::COUNT];
+    uint32_t timer_avg_us[(size_t)PerfTimer::COUNT];
+    uint32_t timer_max_us[(size_t)PerfTimer::COUNT];
+    uint32_t counts[(size_t)PerfCount::COUNT];
+    uint32_t cpu_mhz;
+    uint32_t trace_count[2];
+    TraceEvent trace[2][SYS_CRASH_TRACE_EVENTS];
+
+    uint32_t crc;                                       // Over everything above
+};
+
+RTC_NOINIT_ATTR CrashRecord rtc_record;
+CrashRecord last_crash;                                 // The previous run's record, when begin() found one
+volatile bool capturing = false;
+
+const char* const kTaskNames[TASK_MANAGER_TASK_COUNT] = {
+    "WeightSampling", "GrindControl", "UIRender", "Bluetooth", "FileIO"
+};
+
+uint32_t record_crc(const CrashRecord& record) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&record, offsetof(CrashRecord, crc));
+}
+
+const char* reset_reason_name(int reason) {
+    switch ((esp_reset_reason_t)reason) {
+        case ESP_RST_POWERON:   return "POWERON";
+        case ESP_RST_EXT:       return "EXT";
+        case ESP_RST_SW:        return "SW";
+        case ESP_RST_PANIC:     return "PANIC";
+        case ESP_RST_INT_WDT:   return "INT_WDT";
+        case ESP_RST_TASK_WDT:  return "TASK_WDT";
+        case ESP_RST_WDT:       return "WDT";
+        case ESP_RST_BROWNOUT:  return "BROWNOUT";
+        default:                return "OTHER";
+    }
+}
+
+const char* phase_name(uint8_t phase) {
+    return is_valid_grind_phase((GrindPhase)phase) ? get_grind_phase_traits((GrindPhase)phase).name : "?";
+}
+}
+
+// Task watchdog timeout, from its ISR; runs on every timeout, before a panic if one is configured
+extern "C" void esp_task_wdt_isr_user_handler(void) {
+    crash_snapshot.capture(CrashKind::TASK_WDT);
+}
+
+// Linked in place of esp_panic_handler by -Wl,--wrap=esp_panic_handler
+extern "C" void __real_esp_panic_handler(void* info);
+extern "C" void __wrap_esp_panic_handler(void* info) {
+    crash_snapshot.capture(CrashKind::PANIC);
+    __real_esp_panic_handler(info);
+}
+
+void CrashSnapshot::begin() {
+    reset_reason = (int)esp_reset_reason();
+    report_valid = rtc_record.magic == kCrashMagic && rtc_record.version == kCrashVersion &&
+                   rtc_record.kind != (uint8_t)CrashKind::NONE && rtc_record.crc == record_crc(rtc_record);
+    if (report_valid) {
+        last_crash = rtc_record;
+        LOG_BLE("[CRASH] Last run ended in %s at %lus uptime (reset %s); grinder-ble.py crash for the snapshot\n",
+                get_kind_name((CrashKind)last_crash.kind), (unsigned long)(last_crash.uptime_us / 1000000),
+                reset_reason_name(reset_reason));
+        print_report();
+    }
+
+    memset(&rtc_record, 0, sizeof(rtc_record));
+    rtc_record.magic = kCrashMagic;
+    rtc_record.version = kCrashVersion;
+    rtc_record.build_number = BUILD_NUMBER;
+}
+
+void CrashSnapshot::refresh(const TaskMemoryStats& memory, const ControlLoopDeadlineStats& deadlines) {
+    for (int i = 0; i < TASK_MANAGER_TASK_COUNT; i++) {
+        rtc_record.stack_size_bytes[i] = memory.stack_size_bytes[i];
+        rtc_record.stack_min_free_bytes[i] = memory.stack_min_free_bytes[i];
+    }
+    rtc_record.internal_free_bytes = memory.internal_free_bytes;
+    rtc_record.internal_min_free_bytes = memory.internal_min_free_bytes;
+    rtc_record.psram_free_bytes = memory.psram_free_bytes;
+    rtc_record.deadlines = deadlines;
+    rtc_record.refreshed_ms = memory.sampled_ms;
+}
+
+void CrashSnapshot::capture(CrashKind kind) {
+    // A panic inside the watchdog hook must not recurse; the first capture stands
+    if (capturing) {
+        return;
+    }
+    capturing = true;
+
+    CrashRecord& record = rtc_record;
+    record.kind = (uint8_t)kind;
+    record.captures++;
+    record.uptime_us = (uint64_t)esp_timer_get_time();
+    record.captured_ms = millis();
+    // The first grinder that is not idle; every grinder idle records IDLE
+    record.grind_phase = telemetry.get_phase();
+    for (uint8_t ch = 1; ch < HW_GRINDER_CHANNELS && record.grind_phase == (uint8_t)GrindPhase::IDLE; ch++) {
+        record.grind_phase = channel_telemetry(ch).get_phase();
+    }
+    for (size_t i = 0; i < (size_t)PerfTimer::COUNT; i++) {
+        PerfTimerWindow window = perf_counters.get_window((PerfTimer)i);
+        record.timer_count[i] = window.count;
+        record.timer_avg_us[i] = window.avg_us;
+        record.timer_max_us[i] = window.max_us;
+    }
+    for (size_t i = 0; i < (size_t)PerfCount::COUNT; i++) {
+        record.counts[i] = perf_counters.get_count((PerfCount)i);
+    }
+    record.cpu_mhz = trace.get_cpu_mhz();
+    for (uint8_t core = 0; core < 2; core++) {
+        record.trace_count[core] = trace.copy_tail(core, record.trace[core], SYS_CRASH_TRACE_EVENTS);
+    }
+    record.crc = record_crc(record);
+
+    capturing = false;
+}
+
+const char* CrashSnapshot::get_kind_name(CrashKind kind) {
+    switch (kind) {
+        case CrashKind::TASK_WDT: return "task_wdt";
+        case CrashKind::PANIC:    return "panic";
+        default:                  return "none";
+    }
+}
+
+void CrashSnapshot::print_report() const {
+    if (!report_valid) {
+        LOG_BLE("=== Crash snapshot: none (last reset %s) ===\n", reset_reason_name(reset_reason));
+        LOG_BLE("====================================================\n");
+        return;
+    }
+    const CrashRecord& record = last_crash;
+    uint32_t uptime_s = (uint32_t)(record.uptime_us / 1000000);
+    LOG_BLE("=== Crash snapshot: %s at %luh%02lum%02lus uptime, build %lu, reset %s, %lu hook runs ===\n",
+            get_kind_name((CrashKind)record.kind), (unsigned long)(uptime_s / 3600),
+            (unsigned long)(uptime_s / 60 % 60), (unsigned long)(uptime_s % 60), (unsigned long)record.build_number,
+            reset_reason_name(reset_reason), (unsigned long)record.captures);
+    LOG_BLE("  Grind phase: %s\n", phase_name(record.grind_phase));
+
+    if (record.refreshed_ms == 0) {
+        LOG_BLE("  Stacks, heap, deadlines: not sampled before the crash\n");
+    } else {
+        LOG_BLE("  Stacks, heap, deadlines as of %lu ms before the crash:\n",
+                (unsigned long)(record.captured_ms - record.refreshed_ms));
+        for (int i = 0; i < TASK_MANAGER_TASK_COUNT; i++) {
+            LOG_BLE("    %-15s %6lu / %6lu B stack free\n", kTaskNames[i], (unsigned long)record.stack_min_free_bytes[i],
+                    (unsigned long)record.stack_size_bytes[i]);
+        }
+        LOG_BLE("    Heap: internal %lu B free (min %lu), PSRAM %lu B free\n", (unsigned long)record.internal_free_bytes,
+                (unsigned long)record.internal_min_free_bytes, (unsigned long)record.psram_free_bytes);
+        const ControlLoopDeadlineStats& deadlines = record.deadlines;
+        LOG_BLE("    Control loop: %lu missed (%lu in a row), overrun max %lu us, last %lu us (%s in %s), %lu fail-safe stops\n",
+                (unsigned long)deadlines.missed_count, (unsigned long)deadlines.consecutive_missed,
+                (unsigned long)deadlines.max_overrun_us, (unsigned long)deadlines.last_overrun_us,
+                GrindControlTask::get_cause_name(deadlines.last_cause),
+                deadlines.missed_count > 0 ? phase_name(deadlines.last_phase_id) : "-",
+                (unsigned long)deadlines.safe_off_count);
+    }
+
+    LOG_BLE("  Task cycles in the last heartbeat window (count, mean/max us):\n");
+    for (size_t i = 0; i < (size_t)PerfTimer::COUNT; i++) {
+        LOG_BLE("    %-22s %6lu %7lu %7lu\n", PerfCounters::get_name((PerfTimer)i), (unsigned long)record.timer_count[i],
+                (unsigned long)record.timer_avg_us[i], (unsigned long)record.timer_max_us[i]);
+    }
+    LOG_BLE("  Counters:\n");
+    for (size_t i = 0; i < (size_t)PerfCount::COUNT; i++) {
+        LOG_BLE("    %-29s %lu\n", PerfCounters::get_name((PerfCount)i), (unsigned long)record.counts[i]);
+    }
+
+    // Relative to each core's newest event; CCOUNT is per core
+    for (uint8_t core = 0; core < 2; core++) {
+        uint32_t count = record.trace_count[core];
+        LOG_BLE("  Trace tail, core %u: %lu events%s\n", (unsigned)core, (unsigned long)count,
+                count == 0 ? " (no capture this run)" : "");
+        if (count == 0 || record.cpu_mhz == 0) {
+            continue;
+        }
+        uint32_t newest = record.trace[core][count - 1].cycles;
+        for (uint32_t i = 0; i < count; i++) {
+            const TraceEvent& event = record.trace[core][i];
+            static const char* const kPhases[] = { "begin", "end", "instant" };
+            LOG_BLE("    %9lu us ago  %-22s %-7s %u\n", (unsigned long)((newest - event.cycles) / record.cpu_mhz),
+                    Trace::get_name((TraceId)event.id), event.phase < 3 ? kPhases[event.phase] : "?",
+                    (unsigned)event.arg);
+        }
+    }
+    LOG_BLE("====================================================\n");
+}
+
+size_t CrashSnapshot::format_json(char* buffer, size_t buffer_size) const {
+    // {"kind","reset","uptime_s","build","phase","stack_free":[per task],"heap_min_b","missed","max_overrun_us",
+    //  "cycle_us":[[n,avg,max] per timer],"counts":[per counter]}
+    if (!report_valid || buffer_size == 0) {
+        return 0;
+    }
+    const CrashRecord& record = last_crash;
+    size_t used = 0;
+    auto append = [&](const char* format, auto... args) {
+        if (used >= buffer_size) {
+            return;
+        }
+        int written = snprintf(buffer + used, buffer_size - used, format, args...);
+        used = (written < 0 || (size_t)written >= buffer_size - used) ? buffer_size : used + written;
+    };
+    append("{\"kind\":\"%s\",\"reset\":\"%s\",\"uptime_s\":%lu,\"build\":%lu,\"phase\":\"%s\",\"stack_free\":[",
+           get_kind_name((CrashKind)record.kind), reset_reason_name(reset_reason),
+           (unsigned long)(record.uptime_us / 1000000), (unsigned long)record.build_number,
+           phase_name(record.grind_phase));
+    for (int i = 0; i < TASK_MANAGER_TASK_COUNT; i++) {
+        append("%s%lu", i ? "," : "", (unsigned long)record.stack_min_free_bytes[i]);
+    }
+    append("],\"heap_min_b\":%lu,\"missed\":%lu,\"max_overrun_us\":%lu,\"cycle_us\":[",
+           (unsigned long)record.internal_min_free_bytes, (unsigned long)record.deadlines.missed_count,
+           (unsigned long)record.deadlines.max_overrun_us);
+    for (size_t i = 0; i < (size_t)PerfTimer::COUNT; i++) {
+        append("%s[%lu,%lu,%lu]", i ? "," : "", (unsigned long)record.timer_count[i],
+               (unsigned long)record.timer_avg_us[i], (unsigned long)record.timer_max_us[i]);
+    }
+    append("],\"counts\":[");
+    for (size_t i = 0; i < (size_t)PerfCount::COUNT; i++) {
+        append("%s%lu", i ? "," : "", (unsigned long)record.counts[i]);
+    }
+    append("]}");
+    return used < buffer_size ? used : 0;
+}
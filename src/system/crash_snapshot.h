@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+
+struct TaskMemoryStats;
+struct ControlLoopDeadlineStats;
+
+enum class CrashKind : uint8_t {
+    NONE,
+    TASK_WDT,                       // esp_task_wdt timeout (esp_task_wdt_isr_user_handler)
+    PANIC                           // Exception, assert, abort or interrupt watchdog (esp_panic_handler)
+};
+
+/**
+ * CrashSnapshot - What the tasks were doing when the last run died
+ *
+ * A watchdog reset or panic leaves only the reset reason behind. One record in
+ * RTC slow memory (RTC_NOINIT_ATTR, kept across software, panic and watchdog
+ * resets) is filled in two steps:
+ *
+ * - refresh(), with every TaskManager memory sample: stack high-water marks,
+ *   heap headroom and the control loop's deadline stats. These need locks or
+ *   task handles, so they are at most SYS_TASK_MEMORY_SAMPLE_INTERVAL_MS old.
+ * - capture(), from the task watchdog's user ISR hook and a wrapped
+ *   esp_panic_handler (-Wl,--wrap in platformio.ini): the crash kind, uptime,
+ *   grind phase, the perf_counters timer windows and counts, and the newest
+ *   SYS_CRASH_TRACE_EVENTS trace events per core (if a capture ran). Only lock
+ *   free reads, then a CRC over the record.
+ *
+ * begin() runs first thing in setup(). It keeps a record with a valid CRC
+ * and a crash kind as the report for this boot, then re-arms an empty one. The
+ * report is logged at boot, sent on request over BLE (BLE_DEBUG_CMD_CRASH_SNAPSHOT)
+ * and published once on MQTT (crash). A power cycle clears RTC memory, so the
+ * record fails its check and nothing is reported.
+ */
+class CrashSnapshot {
+public:
+    void begin();                               // setup(), before the tasks start
+    void refresh(const TaskMemoryStats& memory, const ControlLoopDeadlineStats& deadlines);
+    void capture(CrashKind kind);               // Crash hooks only
+
+    bool has_report() const { return report_valid; }
+    void print_report() const;
+    size_t format_json(char* buffer, size_t buffer_size) const;
+
+    static const char* get_kind_name(CrashKind kind);
+
+private:
+    bool report_valid = false;
+    int reset_reason = 0;                       // esp_reset_reason() of this boot
+};
+
+extern CrashSnapshot crash_snapshot;
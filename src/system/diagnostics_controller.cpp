@@ -1,7 +1,11 @@
 #include "diagnostics_controller.h"
+#include "noise_spectrum.h"
 #include "../hardware/hardware_manager.h"
 #include "../hardware/WeightSensor.h"
 #include "../controllers/grind_controller.h"
+#include "../logging/session_rollups.h"
+#include "../logging/throughput_trend.h"
+#include "../logging/grind_logging.h"
 #include "../config/constants.h"
 
 DiagnosticsController::DiagnosticsController()
@@ -10,7 +14,12 @@ DiagnosticsController::DiagnosticsController()
 
 void DiagnosticsController::init(HardwareManager* hw_mgr) {
     hardware_manager_ = hw_mgr;
-    active_diagnostics_.clear();
+    active_count_ = 0;
+    status_checked_ = false;
+    next_noise_check_ms_ = 0;
+    checked_anomaly_count_ = 0;
+    summaries_checked_ = false;
+    throughput_trend.begin();
 }
 
 void DiagnosticsController::update(HardwareManager* hw_mgr, GrindController* grind_ctrl, uint32_t uptime_ms) {
@@ -19,15 +28,34 @@ void DiagnosticsController::update(HardwareManager* hw_mgr, GrindController* gri
     WeightSensor* sensor = hw_mgr->get_weight_sensor();
     if (!sensor) return;
 
-    // Phase 1: Calibration flag and boot diagnostics
-    check_load_cell_calibration(sensor);
-    check_load_cell_boot_fault(sensor);
+    // Phase 1: Calibration flag and boot diagnostics, on change
+    uint32_t status_generation = sensor->get_status_generation();
+    if (!status_checked_ || status_generation != checked_status_generation_) {
+        status_checked_ = true;
+        checked_status_generation_ = status_generation;
+        check_load_cell_calibration(sensor);
+        check_load_cell_boot_fault(sensor);
+    }
+
+    // Phase 5: Noise monitoring at 1 Hz; its thresholds are a minute long
+    if ((int32_t)(uptime_ms - next_noise_check_ms_) >= 0) {
+        next_noise_check_ms_ = uptime_ms + kNoiseCheckIntervalMs;
+        check_load_cell_noise(sensor, uptime_ms);
+    }
 
-    // Phase 5: Add noise monitoring
-    check_load_cell_noise(sensor, uptime_ms);
+    // Phase 6: Mechanical instability, when the grind counts an anomaly
+    if (grind_ctrl && grind_ctrl->get_mechanical_anomaly_count() != checked_anomaly_count_) {
+        checked_anomaly_count_ = grind_ctrl->get_mechanical_anomaly_count();
+        check_mechanical_stability(grind_ctrl);
+    }
 
-    // Phase 6: Add mechanical instability
-    check_mechanical_stability(grind_ctrl);
+    // Phase 7: Throughput trend, when a session summary is appended
+    uint32_t summary_total = grind_logger.get_session_summaries().get_total();
+    if (!summaries_checked_ || summary_total != checked_summary_total_) {
+        summaries_checked_ = true;
+        checked_summary_total_ = summary_total;
+        check_throughput_trend();
+    }
 }
 
 void DiagnosticsController::check_load_cell_calibration(WeightSensor* sensor) {
@@ -95,6 +123,8 @@ void DiagnosticsController::check_load_cell_noise(WeightSensor* sensor, uint32_t
                 active_noise_diag->last_seen_ms = millis();
             } else {
                 set_diagnostic_active(DiagnosticCode::LOAD_CELL_NOISY_SUSTAINED);
+                // Name the noise in the message: a tone is mains pickup or a nearby motor
+                noise_spectrum.request(NoiseCapture::IDLE);
             }
         }
     } else {
@@ -128,6 +158,19 @@ void DiagnosticsController::check_mechanical_stability(GrindController* grind_ct
     }
 }
 
+void DiagnosticsController::check_throughput_trend() {
+    if (throughput_trend.update()) {
+        set_diagnostic_active(DiagnosticCode::THROUGHPUT_DEGRADED);
+    } else {
+        clear_diagnostic(DiagnosticCode::THROUGHPUT_DEGRADED);
+    }
+}
+
+void DiagnosticsController::reset_throughput_trend() {
+    throughput_trend.reset();
+    clear_diagnostic(DiagnosticCode::THROUGHPUT_DEGRADED);
+}
+
 DiagnosticCode DiagnosticsController::get_highest_priority_warning() const {
     // Priority order (highest to lowest):
     // 1. HX711_NOT_CONNECTED - load cell hardware missing
@@ -135,6 +178,7 @@ DiagnosticCode DiagnosticsController::get_highest_priority_warning() const {
     // 3. MECHANICAL_INSTABILITY - immediate safety concern
     // 4. LOAD_CELL_NOISY_SUSTAINED - affects grind quality
     // 5. LOAD_CELL_NOT_CALIBRATED - initial setup issue
+    // 6. THROUGHPUT_DEGRADED - maintenance due
 
     if (find_diagnostic(DiagnosticCode::HX711_NOT_CONNECTED)) {
         return DiagnosticCode::HX711_NOT_CONNECTED;
@@ -151,16 +195,23 @@ DiagnosticCode DiagnosticsController::get_highest_priority_warning() const {
     if (find_diagnostic(DiagnosticCode::LOAD_CELL_NOT_CALIBRATED)) {
         return DiagnosticCode::LOAD_CELL_NOT_CALIBRATED;
     }
+    if (find_diagnostic(DiagnosticCode::THROUGHPUT_DEGRADED)) {
+        return DiagnosticCode::THROUGHPUT_DEGRADED;
+    }
 
     return DiagnosticCode::NONE;
 }
 
-std::vector<DiagnosticState> DiagnosticsController::get_active_diagnostics() const {
-    return active_diagnostics_;
+size_t DiagnosticsController::get_active_diagnostics(DiagnosticState* out, size_t max_count) const {
+    size_t count = active_count_ < max_count ? active_count_ : max_count;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = active_diagnostics_[i];
+    }
+    return count;
 }
 
 bool DiagnosticsController::has_active_diagnostics() const {
-    return !active_diagnostics_.empty();
+    return active_count_ > 0;
 }
 
 void DiagnosticsController::acknowledge_diagnostic(DiagnosticCode code) {
@@ -176,12 +227,12 @@ void DiagnosticsController::reset_diagnostic(DiagnosticCode code) {
 
 void DiagnosticsController::reset_all_transient_diagnostics() {
     // Clear all diagnostics that have been acknowledged
-    auto it = active_diagnostics_.begin();
-    while (it != active_diagnostics_.end()) {
-        if (it->user_acknowledged) {
-            it = active_diagnostics_.erase(it);
+    size_t i = 0;
+    while (i < active_count_) {
+        if (active_diagnostics_[i].user_acknowledged) {
+            remove_diagnostic_at(i);
         } else {
-            ++it;
+            i++;
         }
     }
 }
@@ -194,10 +245,32 @@ const char* DiagnosticsController::get_diagnostic_message(DiagnosticCode code) c
             return "HX711 sample rate invalid. Ensure RATE pin is wired for 10 SPS.";
         case DiagnosticCode::LOAD_CELL_NOT_CALIBRATED:
             return "Load cell not calibrated. Go to Tools → Calibrate";
-        case DiagnosticCode::LOAD_CELL_NOISY_SUSTAINED:
+        case DiagnosticCode::LOAD_CELL_NOISY_SUSTAINED: {
+            const NoiseSpectrumResult* spectrum = noise_spectrum.get_result(NoiseCapture::IDLE);
+            if (spectrum && spectrum->mains_index >= 0) {
+                return "Mains hum on the sensor signal. Check grounding and the load cell cable.";
+            }
+            if (spectrum && spectrum->tone_index >= 0) {
+                snprintf(noise_message_, sizeof(noise_message_),
+                         "Sensor vibration at %.0f Hz. Check for nearby machines and the mounting.",
+                         spectrum->peaks[spectrum->tone_index].hz);
+                return noise_message_;
+            }
             return "Sustained sensor noise detected. Check connections and environment.";
+        }
         case DiagnosticCode::MECHANICAL_INSTABILITY:
             return "Mechanical instability detected. Check grinder mounting and connections.";
+        case DiagnosticCode::THROUGHPUT_DEGRADED: {
+            ThroughputTrendResult trend;
+            int profile = throughput_trend.get_worst_profile();
+            if (profile >= 0 && throughput_trend.get_result((uint8_t)profile, &trend)) {
+                snprintf(throughput_message_, sizeof(throughput_message_),
+                         "Grind flow down %.0f%% on profile %d (%+.1f s per dose). Check burr wear or grind setting.",
+                         trend.flow_drop * 100.0f, profile + 1, trend.time_increase_s);
+                return throughput_message_;
+            }
+            return "Grind flow has dropped. Check burr wear or grind setting.";
+        }
         case DiagnosticCode::NONE:
         default:
             return "";
@@ -212,7 +285,7 @@ void DiagnosticsController::set_diagnostic_active(DiagnosticCode code) {
         // Update existing diagnostic
         existing->last_seen_ms = millis();
         existing->occurrence_count++;
-    } else {
+    } else if (active_count_ < kMaxActiveDiagnostics) {
         // Add new diagnostic
         DiagnosticState new_diag;
         new_diag.code = code;
@@ -220,21 +293,30 @@ void DiagnosticsController::set_diagnostic_active(DiagnosticCode code) {
         new_diag.last_seen_ms = millis();
         new_diag.user_acknowledged = false;
         new_diag.occurrence_count = 1;
-        active_diagnostics_.push_back(new_diag);
+        active_diagnostics_[active_count_++] = new_diag;
+        session_rollups.add_diagnostic();
     }
 }
 
 void DiagnosticsController::clear_diagnostic(DiagnosticCode code) {
-    auto it = active_diagnostics_.begin();
-    while (it != active_diagnostics_.end()) {
-        if (it->code == code) {
-            it = active_diagnostics_.erase(it);
+    size_t i = 0;
+    while (i < active_count_) {
+        if (active_diagnostics_[i].code == code) {
+            remove_diagnostic_at(i);
         } else {
-            ++it;
+            i++;
         }
     }
 }
 
+void DiagnosticsController::remove_diagnostic_at(size_t index) {
+    // Keeps detection order, like the erase it replaces
+    for (size_t i = index + 1; i < active_count_; i++) {
+        active_diagnostics_[i - 1] = active_diagnostics_[i];
+    }
+    active_count_--;
+}
+
 void DiagnosticsController::reset_noise_tracking() {
     noise_high_timer_running_ = false;
     noise_recovery_timer_running_ = false;
@@ -243,18 +325,18 @@ void DiagnosticsController::reset_noise_tracking() {
 }
 
 DiagnosticState* DiagnosticsController::find_diagnostic(DiagnosticCode code) {
-    for (auto& diag : active_diagnostics_) {
-        if (diag.code == code) {
-            return &diag;
+    for (size_t i = 0; i < active_count_; i++) {
+        if (active_diagnostics_[i].code == code) {
+            return &active_diagnostics_[i];
         }
     }
     return nullptr;
 }
 
 const DiagnosticState* DiagnosticsController::find_diagnostic(DiagnosticCode code) const {
-    for (const auto& diag : active_diagnostics_) {
-        if (diag.code == code) {
-            return &diag;
+    for (size_t i = 0; i < active_count_; i++) {
+        if (active_diagnostics_[i].code == code) {
+            return &active_diagnostics_[i];
         }
     }
     return nullptr;
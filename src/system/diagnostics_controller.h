@@ -1,6 +1,5 @@
 #pragma once
 
-#include <vector>
 #include <Arduino.h>
 
 // Forward declarations
@@ -15,7 +14,9 @@ enum class DiagnosticCode {
     HX711_SAMPLE_RATE_INVALID,      // HX711 wired for incorrect sample rate (80 SPS)
     LOAD_CELL_NOT_CALIBRATED,       // Load cell hasn't been calibrated yet
     LOAD_CELL_NOISY_SUSTAINED,      // Sustained excessive noise (60s+) - Phase 5
-    MECHANICAL_INSTABILITY          // Mechanical issues during grinding - Phase 6
+    MECHANICAL_INSTABILITY,         // Mechanical issues during grinding - Phase 6
+    THROUGHPUT_DEGRADED,            // Grind flow trending down (burr wear or a finer setting) - Phase 7
+    COUNT
 };
 
 // State for a single diagnostic condition
@@ -28,7 +29,13 @@ struct DiagnosticState {
 };
 
 // Central diagnostic state manager for the system
-// Monitors multiple diagnostic conditions and provides unified interface for UI
+// Monitors multiple diagnostic conditions and provides unified interface for UI.
+// Each check runs at its own cadence and reads state its producer already keeps:
+// calibration flag and boot fault when WeightSensor's status generation changes,
+// sustained noise at 1 Hz from the sampling task's settling windows, mechanical
+// instability when the grind's anomaly count changes, throughput trend when a
+// session summary is appended. A tick with nothing due
+// is a few compares.
 class DiagnosticsController {
 public:
     DiagnosticsController();
@@ -36,12 +43,12 @@ public:
     // Initialize diagnostic controller
     void init(HardwareManager* hw_mgr);
 
-    // Update all diagnostic checks (called from UIManager main loop)
+    // Run the checks that are due (UIManager::run_diagnostics(), SYS_JOB_DIAGNOSTICS_INTERVAL_MS)
     void update(HardwareManager* hw_mgr, GrindController* grind_ctrl, uint32_t uptime_ms);
 
     // Query diagnostic state
     DiagnosticCode get_highest_priority_warning() const;
-    std::vector<DiagnosticState> get_active_diagnostics() const;
+    size_t get_active_diagnostics(DiagnosticState* out, size_t max_count) const;   // Copies, returns the count
     bool has_active_diagnostics() const;
 
     // User interactions
@@ -54,6 +61,7 @@ public:
 
     // Helpers for other systems
     void reset_noise_tracking();
+    void reset_throughput_trend();                 // New baseline from the next session (burrs changed, setting moved)
 
 private:
     // Individual diagnostic checkers
@@ -61,6 +69,7 @@ private:
     void check_load_cell_boot_fault(WeightSensor* sensor);
     void check_load_cell_noise(WeightSensor* sensor, uint32_t uptime_ms);
     void check_mechanical_stability(GrindController* grind_ctrl);
+    void check_throughput_trend();
 
     // State management helpers
     void set_diagnostic_active(DiagnosticCode code);
@@ -68,15 +77,30 @@ private:
     DiagnosticState* find_diagnostic(DiagnosticCode code);
     const DiagnosticState* find_diagnostic(DiagnosticCode code) const;
 
-    // Active diagnostics
-    std::vector<DiagnosticState> active_diagnostics_;
+    // Active diagnostics: at most one per code, so a fixed table never touches the heap
+    static constexpr size_t kMaxActiveDiagnostics = (size_t)DiagnosticCode::COUNT - 1;
+    DiagnosticState active_diagnostics_[kMaxActiveDiagnostics];
+    size_t active_count_ = 0;
+
+    void remove_diagnostic_at(size_t index);
 
     // Hardware manager reference
     HardwareManager* hardware_manager_;
 
+    // Check cadence
+    static constexpr uint32_t kNoiseCheckIntervalMs = 1000;
+    bool status_checked_ = false;
+    uint32_t checked_status_generation_ = 0;
+    uint32_t next_noise_check_ms_ = 0;
+    int checked_anomaly_count_ = 0;
+    uint32_t checked_summary_total_ = 0;
+    bool summaries_checked_ = false;
+
     // Phase 5 sustained noise tracking
     uint32_t noise_high_start_ms_ = 0;
     uint32_t noise_recovery_start_ms_ = 0;
     bool noise_high_timer_running_ = false;
     bool noise_recovery_timer_running_ = false;
+    mutable char noise_message_[96] = {};          // get_diagnostic_message() with the idle spectrum's tone
+    mutable char throughput_message_[112] = {};    // get_diagnostic_message() with the worst profile's trend
 };
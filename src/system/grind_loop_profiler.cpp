@@ -0,0 +1,79 @@
+#include "grind_loop_profiler.h"
+#include "../config/constants.h"
+
+GrindLoopProfiler grind_loop_profiler;
+
+namespace {
+const char* const kProbeNames[(size_t)GrindLoopProbe::COUNT] = {
+    "weight", "loop_data", "handler", "logging", "eta", "events"
+};
+} // namespace
+
+void GrindLoopProfiler::record(GrindPhase phase, GrindLoopProbe probe, uint32_t cycles) {
+    if (!is_valid_grind_phase(phase)) {
+        return;
+    }
+    Cell& cell = cells[(size_t)phase][(size_t)probe];
+    cell.count.store(cell.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    cell.sum_cycles.store(cell.sum_cycles.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+    if (cycles > cell.max_cycles.load(std::memory_order_relaxed)) {
+        cell.max_cycles.store(cycles, std::memory_order_relaxed);
+    }
+}
+
+void GrindLoopProfiler::reset() {
+    for (auto& row : cells) {
+        for (Cell& cell : row) {
+            cell.count.store(0, std::memory_order_relaxed);
+            cell.sum_cycles.store(0, std::memory_order_relaxed);
+            cell.max_cycles.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+GrindLoopProbeStats GrindLoopProfiler::get_stats(GrindPhase phase, GrindLoopProbe probe) const {
+    GrindLoopProbeStats stats = {};
+    if (!is_valid_grind_phase(phase)) {
+        return stats;
+    }
+    const Cell& cell = cells[(size_t)phase][(size_t)probe];
+    const uint32_t cpu_mhz = getCpuFrequencyMhz();
+    stats.count = cell.count.load(std::memory_order_relaxed);
+    stats.mean_us = stats.count > 0 ? cell.sum_cycles.load(std::memory_order_relaxed) / stats.count / cpu_mhz : 0;
+    stats.max_us = cell.max_cycles.load(std::memory_order_relaxed) / cpu_mhz;
+    return stats;
+}
+
+const char* GrindLoopProfiler::get_name(GrindLoopProbe probe) {
+    return (size_t)probe < (size_t)GrindLoopProbe::COUNT ? kProbeNames[(size_t)probe] : "?";
+}
+
+void GrindLoopProfiler::print_report() const {
+    LOG_BLE("=== Grind loop profile: us per tick (mean/max) by phase, current or last session, %d ms budget ===\n",
+            SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
+    char header[128];
+    int used = snprintf(header, sizeof(header), "  %-15s %6s", "phase", "ticks");
+    for (size_t p = 0; p < (size_t)GrindLoopProbe::COUNT && used < (int)sizeof(header); p++) {
+        used += snprintf(header + used, sizeof(header) - used, " %11s", kProbeNames[p]);
+    }
+    LOG_BLE("%s\n", header);
+
+    for (size_t i = 0; i < GRIND_PHASE_COUNT; i++) {
+        const GrindPhase phase = static_cast<GrindPhase>(i);
+        // Every tick passes the first probe, so its count is the phase's tick count
+        const uint32_t ticks = get_stats(phase, GrindLoopProbe::WEIGHT_QUERY).count;
+        if (ticks == 0) {
+            continue;
+        }
+        char row[160];
+        int row_used = snprintf(row, sizeof(row), "  %-15s %6lu", get_grind_phase_traits(phase).name, (unsigned long)ticks);
+        for (size_t p = 0; p < (size_t)GrindLoopProbe::COUNT && row_used < (int)sizeof(row); p++) {
+            GrindLoopProbeStats stats = get_stats(phase, (GrindLoopProbe)p);
+            char cell[24];
+            snprintf(cell, sizeof(cell), "%lu/%lu", (unsigned long)stats.mean_us, (unsigned long)stats.max_us);
+            row_used += snprintf(row + row_used, sizeof(row) - row_used, " %11s", cell);
+        }
+        LOG_BLE("%s\n", row);
+    }
+    LOG_BLE("==================================================================================\n");
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <esp_cpu.h>
+#include "../controllers/grind_phase_table.h"
+
+// Stages of one GrindController::update() tick, in the order they run.
+// Ids are fixed at compile time: add an entry before COUNT and its name in grind_loop_profiler.cpp.
+enum class GrindLoopProbe : uint8_t {
+    WEIGHT_QUERY,                   // WeightSensor::get_snapshot(): one pass over the sample ring
+    LOOP_DATA,                      // GrindLoopData build and the mechanical instability monitor
+    PHASE_HANDLER,                  // The phase's handler: strategy update, phase switches and their events
+    LOGGING,                        // GrindLogger::log_continuous_measurement()
+    ETA,                            // ETA prediction and the telemetry tick
+    EVENTS,                         // Progress event to the UI queue and the failsafe checks
+    COUNT
+};
+
+// One phase's figures for one probe
+struct GrindLoopProbeStats {
+    uint32_t count;
+    uint32_t mean_us;
+    uint32_t max_us;
+};
+
+/**
+ * GrindLoopProfiler - Where the control loop's time goes, per grind phase and stage
+ *
+ * GrindController::update() laps esp_cpu_get_cycle_count() between its stages
+ * and every lap lands in the cell of the phase the tick started in. The cells
+ * cover the current or last grind session: begin_session() asks for a reset,
+ * which the control task applies on its next tick, so the task stays the only
+ * writer and nothing locks. Cycle sums are 32 bits, which holds 17 s of one
+ * stage in one phase at 240 MHz, far more than a session spends there.
+ *
+ * print_report() logs the table (BLE_DEBUG_CMD_GRIND_LOOP_PROFILE, or the host
+ * program's --loop-profile) with the mean and max µs per stage, so a phase that
+ * eats into the SYS_TASK_GRIND_CONTROL_INTERVAL_MS budget shows what it spent
+ * it on. Task cycle timing as a whole stays in perf_counters.
+ */
+class GrindLoopProfiler {
+public:
+    // Control task: the first call of each tick, then one lap after each stage
+    uint32_t begin_tick() {
+        if (reset_requested.exchange(false, std::memory_order_relaxed)) {
+            reset();
+        }
+        return esp_cpu_get_cycle_count();
+    }
+    uint32_t lap(GrindPhase phase, GrindLoopProbe probe, uint32_t since_cycles) {
+        uint32_t now = esp_cpu_get_cycle_count();
+        record(phase, probe, now - since_cycles);
+        return now;
+    }
+
+    // Any task
+    void begin_session() { reset_requested.store(true, std::memory_order_relaxed); }
+    GrindLoopProbeStats get_stats(GrindPhase phase, GrindLoopProbe probe) const;
+    static const char* get_name(GrindLoopProbe probe);
+    void print_report() const;
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint32_t> sum_cycles{0};
+        std::atomic<uint32_t> max_cycles{0};
+    };
+
+    Cell cells[GRIND_PHASE_COUNT][(size_t)GrindLoopProbe::COUNT];
+    std::atomic<bool> reset_requested{false};
+
+    void record(GrindPhase phase, GrindLoopProbe probe, uint32_t cycles);
+    void reset();
+};
+
+extern GrindLoopProfiler grind_loop_profiler;
@@ -0,0 +1,122 @@
+#include "hot_path_benchmark.h"
+
+#include <algorithm>
+#include <esp_cpu.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <new>
+#include "../config/constants.h"
+#include "../hardware/WeightSensor.h"
+#include "../hardware/circular_buffer_math/circular_buffer_math.h"
+
+#if FEATURE_DEBUG_TOOLS
+
+HotPathBenchmark hot_path_benchmark;
+
+namespace {
+const uint32_t kRatesSps[] = { 10, 80, 320 };
+// The aggregated windows the control loop uses, plus 1000 ms, which takes the scan path
+const uint32_t kWindowsMs[] = { 50, 200, 500, 1000, 1500 };
+const uint16_t kFillSamples = 960;              // Below the ring's readable capacity
+const int32_t kRampRawPerSecond = 4000;
+const int32_t kNoiseRaw = 150;
+const int32_t kSettleThresholdRaw = 500;
+
+volatile float result_sink;                     // Keeps the timed calls from being optimized away
+
+template <typename Query>
+uint32_t median_cycles(Query query) {
+    uint32_t cycles[SYS_HOT_PATH_BENCHMARK_ITERATIONS];
+    for (uint32_t& sample : cycles) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        result_sink = (float)query();
+        sample = esp_cpu_get_cycle_count() - start;
+    }
+    uint32_t* middle = cycles + SYS_HOT_PATH_BENCHMARK_ITERATIONS / 2;
+    std::nth_element(cycles, middle, cycles + SYS_HOT_PATH_BENCHMARK_ITERATIONS);
+    return *middle;
+}
+} // namespace
+
+bool HotPathBenchmark::run(const WeightSensor* sensor) {
+    // Internal RAM like the live ring, built fresh for every fill
+    void* memory = heap_caps_malloc(sizeof(CircularBufferMath), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!memory) {
+        LOG_BLE("[HOT_PATH_BENCHMARK] Not started: no memory for a %u byte ring\n", (unsigned)sizeof(CircularBufferMath));
+        return false;
+    }
+    CircularBufferMath* math = new (memory) CircularBufferMath();
+
+    LOG_BLE("=== Hot path benchmark: cycles, median of %d calls, miss/hit of the query cache ===\n",
+            SYS_HOT_PATH_BENCHMARK_ITERATIONS);
+    for (uint32_t sps : kRatesSps) {
+        run_rate(math, sps);
+    }
+    if (sensor) {
+        LOG_BLE("  raw_to_weight: %lu\n", (unsigned long)time_raw_to_weight(sensor));
+    }
+    LOG_BLE("==================================================================================\n");
+
+    math->~CircularBufferMath();
+    heap_caps_free(memory);
+    return true;
+}
+
+void HotPathBenchmark::run_rate(CircularBufferMath* math, uint32_t sps) {
+    LOG_BLE("  %3lu SPS  window       smoothed           flow       flow_p95        std_dev   settled\n",
+            (unsigned long)sps);
+    for (uint32_t window_ms : kWindowsMs) {
+        char cells[4][24];
+        struct MemoizedQuery {
+            float (*miss)(const CircularBufferMath*, uint32_t);
+            float (*hit)(const CircularBufferMath*, uint32_t);
+        };
+        const MemoizedQuery queries[4] = {
+            { [](const CircularBufferMath* m, uint32_t w) { return (float)m->compute_smoothed_raw(w); },
+              [](const CircularBufferMath* m, uint32_t w) { return (float)m->get_smoothed_raw(w); } },
+            { [](const CircularBufferMath* m, uint32_t w) { return m->compute_raw_flow_rate(w); },
+              [](const CircularBufferMath* m, uint32_t w) { return m->get_raw_flow_rate(w); } },
+            { [](const CircularBufferMath* m, uint32_t w) { return m->compute_raw_flow_rate_95th_percentile(w); },
+              [](const CircularBufferMath* m, uint32_t w) { return m->get_raw_flow_rate_95th_percentile(w); } },
+            { [](const CircularBufferMath* m, uint32_t w) { return m->compute_standard_deviation_raw(w); },
+              [](const CircularBufferMath* m, uint32_t w) { return m->get_standard_deviation_raw(w); } },
+        };
+        // Refilled per query: the window ends at the fill time, and the clock keeps moving
+        for (int i = 0; i < 4; i++) {
+            fill(math, sps);
+            uint32_t miss = median_cycles([&] { return queries[i].miss(math, window_ms); });
+            queries[i].hit(math, window_ms);
+            uint32_t hit = median_cycles([&] { return queries[i].hit(math, window_ms); });
+            snprintf(cells[i], sizeof(cells[i]), "%lu/%lu", (unsigned long)miss, (unsigned long)hit);
+        }
+        // is_settled() is not memoized itself; its standard deviation is the cached lookup
+        fill(math, sps);
+        uint32_t settled = median_cycles([&] { return math->is_settled(window_ms, kSettleThresholdRaw); });
+        LOG_BLE("        %6lums %14s %14s %14s %14s %9lu\n", (unsigned long)window_ms,
+                cells[0], cells[1], cells[2], cells[3], (unsigned long)settled);
+    }
+}
+
+// Noisy ramp (deterministic LCG noise) whose newest sample is timestamped now
+void HotPathBenchmark::fill(CircularBufferMath* math, uint32_t sps) {
+    math->~CircularBufferMath();
+    new (math) CircularBufferMath();
+    math->set_sample_rate(sps);
+
+    const uint32_t period_us = 1000000 / sps;
+    const uint32_t end_us = (uint32_t)esp_timer_get_time();
+    uint32_t noise_state = 12345;
+    for (uint16_t i = 0; i < kFillSamples; i++) {
+        noise_state = noise_state * 1664525u + 1013904223u;
+        int32_t noise = (int32_t)(noise_state >> 16) % (2 * kNoiseRaw + 1) - kNoiseRaw;
+        int32_t ramp = (int32_t)((int64_t)i * kRampRawPerSecond / sps);
+        math->add_sample(100000 + ramp + noise, end_us - (uint32_t)(kFillSamples - 1 - i) * period_us);
+    }
+}
+
+uint32_t HotPathBenchmark::time_raw_to_weight(const WeightSensor* sensor) {
+    int32_t raw = sensor->tare_offset;
+    return median_cycles([&] { return sensor->raw_to_weight(raw += 97); });
+}
+
+#endif // FEATURE_DEBUG_TOOLS
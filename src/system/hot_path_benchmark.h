@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+class CircularBufferMath;
+class WeightSensor;
+
+/**
+ * HotPathBenchmark - Cycle counts of the weight queries the control loop runs every tick
+ *
+ * Fills a private CircularBufferMath with a noisy ramp at 10, 80 and 320 SPS
+ * (the samples end at the current esp_timer time, as live ones do) and times
+ * get_smoothed_raw, get_raw_flow_rate, get_raw_flow_rate_95th_percentile,
+ * get_standard_deviation_raw and is_settled for each window in the table, then
+ * raw_to_weight on the live WeightSensor. Memoized queries get two numbers:
+ * miss is the uncached body, what the first caller after a new sample pays;
+ * hit is a query cache lookup. Each cell is the median cycle count of
+ * SYS_HOT_PATH_BENCHMARK_ITERATIONS calls. The table is logged when it ends.
+ *
+ * On the device it runs on the UI task with the grinder idle, started from the
+ * Diagnostics page or BLE_DEBUG_CMD_HOT_PATH_BENCHMARK (request()). The host
+ * build runs it with --bench, counting the host's wall clock at 240 MHz.
+ */
+class HotPathBenchmark {
+public:
+    void request() { requested.store(true, std::memory_order_relaxed); }
+    bool take_request() { return requested.exchange(false, std::memory_order_relaxed); }
+
+    // Blocks for a few hundred ms; false if the ring could not be allocated. nullptr skips raw_to_weight
+    bool run(const WeightSensor* sensor);
+
+private:
+    std::atomic<bool> requested{false};
+
+    void fill(CircularBufferMath* math, uint32_t sps);
+    void run_rate(CircularBufferMath* math, uint32_t sps);
+    uint32_t time_raw_to_weight(const WeightSensor* sensor);
+};
+
+extern HotPathBenchmark hot_path_benchmark;
@@ -0,0 +1,123 @@
+#include "memory_arena.h"
+#include "../config/logging.h"
+#include "../config/system.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+MemoryArena file_arena("file", SYS_FILE_ARENA_BYTES, MALLOC_CAP_SPIRAM);
+MemoryArena session_arena("session", SYS_SESSION_ARENA_BYTES, MALLOC_CAP_SPIRAM);
+
+namespace {
+constexpr size_t kArenaAlignment = 8;
+} // namespace
+
+MemoryArena::MemoryArena(const char* name, size_t capacity, uint32_t caps)
+    : name(name), capacity(capacity), caps(caps) {
+}
+
+bool MemoryArena::begin() {
+    if (!mutex) {
+        mutex = xSemaphoreCreateRecursiveMutex();
+    }
+    if (!block) {
+        block = (uint8_t*)heap_caps_malloc(capacity, caps);
+    }
+    if (!mutex || !block) {
+        LOG_BLE("WARNING: %s arena (%u bytes) unavailable, its buffers come from the heap\n",
+                name, (unsigned)capacity);
+        return false;
+    }
+    return true;
+}
+
+void MemoryArena::reset() {
+    lock();
+    used = 0;
+    reset_count++;
+    unlock();
+}
+
+void MemoryArena::lock() {
+    if (mutex) {
+        xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    }
+}
+
+void MemoryArena::unlock() {
+    if (mutex) {
+        xSemaphoreGiveRecursive(mutex);
+    }
+}
+
+void* MemoryArena::allocate(size_t size) {
+    lock();
+    void* result = allocate_locked(size > 0 ? size : 1);
+    unlock();
+    return result;
+}
+
+void* MemoryArena::allocate_locked(size_t size) {
+    size_t aligned = (size + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+    if (!block || aligned > capacity - used) {
+        fallback_count++;
+        return nullptr;
+    }
+    void* result = block + used;
+    used += aligned;
+    if (used > high_water) {
+        high_water = used;
+    }
+    return result;
+}
+
+void MemoryArena::release(size_t mark) {
+    if (mark < used) {
+        used = mark;
+    }
+}
+
+ArenaScope::ArenaScope(MemoryArena& arena) : arena(arena) {
+    arena.lock();
+    mark = arena.used;
+}
+
+ArenaScope::~ArenaScope() {
+    for (uint8_t i = 0; i < fallback_count; i++) {
+        heap_caps_free(fallbacks[i]);
+    }
+    arena.release(mark);
+    arena.unlock();
+}
+
+void* ArenaScope::allocate(size_t size) {
+    void* result = arena.allocate_locked(size > 0 ? size : 1);
+    if (result || fallback_count >= kMaxFallbacks) {
+        return result;
+    }
+    result = heap_caps_malloc(size > 0 ? size : 1, MALLOC_CAP_8BIT);
+    if (result) {
+        fallbacks[fallback_count++] = result;
+    }
+    return result;
+}
+
+void print_memory_report() {
+    LOG_BLE("=== Memory ===\n");
+    LOG_BLE("Internal: %u free, %u min free, %u largest block\n",
+            (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+            (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+            (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    LOG_BLE("PSRAM: %u free, %u min free, %u largest block\n",
+            (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+            (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM),
+            (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+    const MemoryArena* arenas[] = { &file_arena, &session_arena };
+    for (const MemoryArena* arena : arenas) {
+        LOG_BLE("Arena %s: %u/%u bytes, high water %u, heap fallbacks %lu, resets %lu\n",
+                arena->get_name(), (unsigned)arena->get_used(), (unsigned)arena->get_capacity(),
+                (unsigned)arena->get_high_water(), (unsigned long)arena->get_fallback_count(),
+                (unsigned long)arena->get_reset_count());
+    }
+    LOG_BLE("==============\n");
+}
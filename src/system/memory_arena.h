@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Bump allocator over one block reserved at boot, so short-lived buffers (session id lists,
+// index copies, event scratch) stop carving holes into the heap over weeks of uptime.
+//
+// Allocate through an ArenaScope: it takes the arena for the calling task (recursive mutex,
+// nested scopes are fine) and gives back everything allocated in it when it ends. A scoped
+// request that does not fit, or any request before begin(), falls back to the heap and is
+// counted; the report shows which arenas are too small. allocate() without a scope keeps the
+// memory until reset().
+class MemoryArena {
+public:
+    MemoryArena(const char* name, size_t capacity, uint32_t caps);
+
+    bool begin();                       // Reserve the block; false leaves every scoped request on the heap
+    void* allocate(size_t size);        // Until reset(); nullptr when it does not fit
+    void reset();                       // Drop everything (only with no scope open)
+
+    const char* get_name() const { return name; }
+    size_t get_capacity() const { return block ? capacity : 0; }
+    size_t get_used() const { return used; }
+    size_t get_high_water() const { return high_water; }
+    uint32_t get_fallback_count() const { return fallback_count; }
+    uint32_t get_reset_count() const { return reset_count; }
+
+private:
+    friend class ArenaScope;
+
+    const char* name;
+    size_t capacity;
+    uint32_t caps;
+    uint8_t* block = nullptr;
+    size_t used = 0;
+    size_t high_water = 0;
+    uint32_t fallback_count = 0;
+    uint32_t reset_count = 0;
+    SemaphoreHandle_t mutex = nullptr;
+
+    void lock();
+    void unlock();
+    void* allocate_locked(size_t size);
+    void release(size_t mark);
+};
+
+class ArenaScope {
+public:
+    explicit ArenaScope(MemoryArena& arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    void* allocate(size_t size);        // 8-byte aligned, valid until the scope ends; nullptr only if the heap is out too
+
+    template<typename T>
+    T* allocate_array(size_t count) { return (T*)allocate(count * sizeof(T)); }
+
+private:
+    static constexpr uint8_t kMaxFallbacks = 4;
+
+    MemoryArena& arena;
+    size_t mark;
+    void* fallbacks[kMaxFallbacks] = {};
+    uint8_t fallback_count = 0;
+};
+
+// Scratch for file operations on any Core 1 task: session index copies and rebuilds,
+// session id lists, BLE file lists
+extern MemoryArena file_arena;
+// Scratch of the session flush path (FileIOTask), scoped per flush so grinders can overlap
+extern MemoryArena session_arena;
+
+// Heap (internal and PSRAM: free, minimum free, largest block) and arena usage
+void print_memory_report();
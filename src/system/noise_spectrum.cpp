@@ -0,0 +1,404 @@
+#include "noise_spectrum.h"
+
+#include <algorithm>
+#include <esp_cpu.h>
+#include <esp_heap_caps.h>
+#include <math.h>
+#include "config_store.h"
+#include "../hardware/WeightSensor.h"
+#include "../hardware/motor_edge_timeline.h"
+#include "../hardware/sample_sequence_source.h"
+
+NoiseSpectrum noise_spectrum;
+
+namespace {
+static_assert((SYS_NOISE_SPECTRUM_POINTS & (SYS_NOISE_SPECTRUM_POINTS - 1)) == 0,
+              "SYS_NOISE_SPECTRUM_POINTS must be a power of two");
+static_assert(SYS_NOISE_SPECTRUM_MIN_SAMPLES >= 8 && SYS_NOISE_SPECTRUM_MIN_SAMPLES <= SYS_NOISE_SPECTRUM_POINTS,
+              "SYS_NOISE_SPECTRUM_MIN_SAMPLES must fit the FFT");
+
+const uint16_t kPoints = SYS_NOISE_SPECTRUM_POINTS;
+const uint16_t kBins = kPoints / 2;             // Bins 0..kBins, DC to Nyquist
+const int kReadChunk = 32;
+const float kMainsHz[] = { 50.0f, 60.0f };
+const char* const kCaptureNames[(size_t)NoiseCapture::COUNT] = { "idle", "motor run" };
+
+// One allocation per capture; 4 KB that only exists while a spectrum is computed
+struct Workspace {
+    float re[kPoints];
+    float im[kPoints];
+    int32_t raw[kPoints];
+    uint32_t timestamps_us[kPoints];
+};
+
+uint8_t capture_bit(NoiseCapture capture) {
+    return (uint8_t)(1U << (uint8_t)capture);
+}
+
+// In-place iterative radix-2 DIT FFT
+void fft_radix2(float* re, float* im, uint16_t n) {
+    for (uint16_t i = 1, j = 0; i < n; i++) {
+        uint16_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    for (uint16_t len = 2; len <= n; len <<= 1) {
+        const uint16_t half = len / 2;
+        const float angle = -2.0f * (float)M_PI / len;
+        const float step_re = cosf(angle);
+        const float step_im = sinf(angle);
+        for (uint16_t i = 0; i < n; i += len) {
+            float w_re = 1.0f;
+            float w_im = 0.0f;
+            for (uint16_t k = 0; k < half; k++) {
+                float* a_re = &re[i + k];
+                float* a_im = &im[i + k];
+                float* b_re = &re[i + k + half];
+                float* b_im = &im[i + k + half];
+                const float t_re = *b_re * w_re - *b_im * w_im;
+                const float t_im = *b_re * w_im + *b_im * w_re;
+                *b_re = *a_re - t_re;
+                *b_im = *a_im - t_im;
+                *a_re += t_re;
+                *a_im += t_im;
+                const float next_re = w_re * step_re - w_im * step_im;
+                w_im = w_re * step_im + w_im * step_re;
+                w_re = next_re;
+            }
+        }
+    }
+}
+
+float alias_hz(float tone_hz, float rate) {
+    float alias = fmodf(tone_hz, rate);
+    return alias > rate * 0.5f ? rate - alias : alias;
+}
+
+uint8_t band_of_bin(uint16_t bin) {
+    return (uint8_t)std::min<uint32_t>((uint32_t)bin * SYS_NOISE_SPECTRUM_BANDS / (kBins + 1), SYS_NOISE_SPECTRUM_BANDS - 1);
+}
+
+// samples in ws->raw/timestamps_us (oldest first) to result; ws->re ends as the amplitude spectrum
+void analyse(Workspace* ws, uint16_t n, NoiseSpectrumResult* result) {
+    result->sample_count = n;
+    const uint32_t span_us = ws->timestamps_us[n - 1] - ws->timestamps_us[0];
+    result->sample_rate_sps = span_us > 0 ? (n - 1) * 1e6f / span_us : 0.0f;
+
+    // Detrend: least-squares line through the samples, relative to the first so floats keep the counts
+    const float mean_i = (n - 1) * 0.5f;
+    float mean_x = 0.0f;
+    for (uint16_t i = 0; i < n; i++) {
+        mean_x += (float)(ws->raw[i] - ws->raw[0]);
+    }
+    mean_x /= n;
+    float sxy = 0.0f;
+    float sxx = 0.0f;
+    for (uint16_t i = 0; i < n; i++) {
+        const float di = i - mean_i;
+        sxy += di * ((float)(ws->raw[i] - ws->raw[0]) - mean_x);
+        sxx += di * di;
+    }
+    const float slope = sxx > 0.0f ? sxy / sxx : 0.0f;
+
+    // Hann window; amplitude is 2|X|/sum(w) for a sinusoid
+    float sum_squares = 0.0f;
+    float window_sum = 0.0f;
+    for (uint16_t i = 0; i < kPoints; i++) {
+        float value = 0.0f;
+        if (i < n) {
+            const float residual = (float)(ws->raw[i] - ws->raw[0]) - mean_x - slope * (i - mean_i);
+            sum_squares += residual * residual;
+            const float w = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / (n - 1));
+            window_sum += w;
+            value = residual * w;
+        }
+        ws->re[i] = value;
+        ws->im[i] = 0.0f;
+    }
+    result->rms_raw = sqrtf(sum_squares / n);
+
+    fft_radix2(ws->re, ws->im, kPoints);
+    const float scale = window_sum > 0.0f ? 2.0f / window_sum : 0.0f;
+    for (uint16_t k = 0; k <= kBins; k++) {
+        ws->re[k] = sqrtf(ws->re[k] * ws->re[k] + ws->im[k] * ws->im[k]) * scale;
+    }
+
+    // Band floors: median bin (DC excluded), sorted in the now unused imaginary half
+    for (uint8_t band = 0; band < SYS_NOISE_SPECTRUM_BANDS; band++) {
+        uint16_t count = 0;
+        for (uint16_t k = 1; k <= kBins; k++) {
+            if (band_of_bin(k) == band) {
+                ws->im[count++] = ws->re[k];
+            }
+        }
+        float floor_raw = 0.0f;
+        if (count > 0) {
+            std::nth_element(ws->im, ws->im + count / 2, ws->im + count);
+            floor_raw = ws->im[count / 2];
+        }
+        result->band_floor_raw[band] = floor_raw;
+    }
+
+    // Strongest local maxima above the Hann main lobe of DC, refined by parabolic interpolation
+    const float bin_hz = result->sample_rate_sps / kPoints;
+    const uint8_t max_peaks = sizeof(result->peaks) / sizeof(result->peaks[0]);
+    uint16_t peak_bins[max_peaks] = {};
+    result->peak_count = 0;
+    for (uint16_t k = 2; k < kBins; k++) {
+        const float amplitude = ws->re[k];
+        if (amplitude <= ws->re[k - 1] || amplitude < ws->re[k + 1]) {
+            continue;
+        }
+        uint8_t slot = result->peak_count;
+        while (slot > 0 && ws->re[peak_bins[slot - 1]] < amplitude) {
+            slot--;
+        }
+        if (slot >= max_peaks) {
+            continue;
+        }
+        const uint8_t last = std::min<uint8_t>(result->peak_count, max_peaks - 1);
+        for (uint8_t i = last; i > slot; i--) {
+            peak_bins[i] = peak_bins[i - 1];
+        }
+        peak_bins[slot] = k;
+        result->peak_count = std::min<uint8_t>(result->peak_count + 1, max_peaks);
+    }
+
+    result->tone_index = -1;
+    result->mains_index = -1;
+    for (uint8_t i = 0; i < result->peak_count; i++) {
+        const uint16_t k = peak_bins[i];
+        const float a = ws->re[k - 1];
+        const float b = ws->re[k];
+        const float c = ws->re[k + 1];
+        const float curvature = a - 2.0f * b + c;
+        const float delta = curvature != 0.0f ? 0.5f * (a - c) / curvature : 0.0f;
+
+        NoiseSpectrumPeak& peak = result->peaks[i];
+        peak.hz = (k + delta) * bin_hz;
+        peak.amplitude_raw = b - 0.25f * (a - c) * delta;
+        peak.tone = peak.amplitude_raw >= SYS_NOISE_SPECTRUM_TONE_RATIO * result->band_floor_raw[band_of_bin(k)];
+        peak.mains = false;
+        for (float mains_hz : kMainsHz) {
+            const float mains_alias = alias_hz(mains_hz, result->sample_rate_sps);
+            if (mains_alias >= HW_LOADCELL_VIBRATION_NOTCH_MIN_ALIAS_HZ && fabsf(peak.hz - mains_alias) <= 1.5f * bin_hz) {
+                peak.mains = true;
+            }
+        }
+        if (peak.tone && peak.mains && result->mains_index < 0) {
+            result->mains_index = i;
+        } else if (peak.tone && !peak.mains && result->tone_index < 0) {
+            result->tone_index = i;
+        }
+    }
+}
+} // namespace
+
+void NoiseSpectrum::request(NoiseCapture capture) {
+    if (capture < NoiseCapture::COUNT) {
+        requested.fetch_or(capture_bit(capture), std::memory_order_relaxed);
+    }
+}
+
+bool NoiseSpectrum::is_armed(NoiseCapture capture) const {
+    const bool pending = (requested.load(std::memory_order_relaxed) & capture_bit(capture)) != 0;
+    return pending || (capture == NoiseCapture::MOTOR && motor_armed);
+}
+
+const NoiseSpectrumResult* NoiseSpectrum::get_result(NoiseCapture capture) const {
+    if (capture >= NoiseCapture::COUNT || !results[(size_t)capture].valid) {
+        return nullptr;
+    }
+    return &results[(size_t)capture];
+}
+
+void NoiseSpectrum::service(WeightSensor* sensor, const MotorEdgeTimeline* edges, bool grinder_active) {
+    const uint8_t bits = requested.load(std::memory_order_relaxed);
+    if ((bits == 0 && !motor_armed) || !sensor) {
+        return;
+    }
+
+    if (bits & capture_bit(NoiseCapture::MOTOR)) {
+        requested.fetch_and((uint8_t)~capture_bit(NoiseCapture::MOTOR), std::memory_order_relaxed);
+        arm_motor(sensor, edges);
+    }
+
+    // Idle spectrum waits for the grinder, so it never sees the motor
+    if ((bits & capture_bit(NoiseCapture::IDLE)) && !grinder_active) {
+        requested.fetch_and((uint8_t)~capture_bit(NoiseCapture::IDLE), std::memory_order_relaxed);
+        const SampleSequenceSource* source = sensor->get_recording_source();
+        const uint32_t sps = std::max<uint32_t>(source->get_sample_rate(), 1);
+        const uint32_t to_us = source->get_latest_sample_time_us() + 1;
+        // A quarter extra for rate jitter; capture() keeps the newest points
+        const uint32_t span_us = (uint32_t)((uint64_t)kPoints * 1250000ULL / sps);
+        capture(sensor, NoiseCapture::IDLE, to_us - span_us, to_us);
+    }
+
+    if (motor_armed) {
+        service_motor(sensor, edges);
+    }
+}
+
+void NoiseSpectrum::arm_motor(WeightSensor* sensor, const MotorEdgeTimeline* edges) {
+    if (!edges) {
+        LOG_BLE("[%lums NOISE_SPECTRUM] Not armed: no motor edge timeline\n", millis());
+        return;
+    }
+    motor_armed = true;
+    motor_armed_edge_count = edges->get_edge_count();
+    sensor->set_vibration_notch_bypass(true);
+    LOG_BLE("[%lums NOISE_SPECTRUM] Armed: the next motor run is captured (notch bypassed until then)\n", millis());
+}
+
+void NoiseSpectrum::disarm_motor(WeightSensor* sensor) {
+    motor_armed = false;
+    sensor->set_vibration_notch_bypass(false);
+}
+
+void NoiseSpectrum::service_motor(WeightSensor* sensor, const MotorEdgeTimeline* edges) {
+    const uint32_t edge_count = edges->get_edge_count();
+    for (uint32_t index = motor_armed_edge_count; index < edge_count; index++) {
+        MotorEdgeTimeline::Edge start;
+        if (!edges->get_edge_at_index(index, &start) || start.type != MotorEdgeType::START) {
+            motor_armed_edge_count = index + 1;     // Pulses, stops, or overwritten
+            continue;
+        }
+        MotorEdgeTimeline::Edge stop;
+        if (!edges->get_edge_at_index(index + 1, &stop)) {
+            motor_armed_edge_count = index;         // Still running
+            return;
+        }
+        motor_armed_edge_count = index + 1;
+
+        const uint32_t from_us = start.timestamp_us + SYS_NOISE_SPECTRUM_SPINUP_MS * 1000UL;
+        if ((int32_t)(stop.timestamp_us - from_us) <= 0) {
+            LOG_BLE("[%lums NOISE_SPECTRUM] Motor run shorter than the %dms spin-up, waiting for the next\n",
+                    millis(), SYS_NOISE_SPECTRUM_SPINUP_MS);
+            continue;
+        }
+        if (capture(sensor, NoiseCapture::MOTOR, from_us, stop.timestamp_us)) {
+            disarm_motor(sensor);
+            store_tone(sensor, results[(size_t)NoiseCapture::MOTOR]);
+            return;
+        }
+    }
+}
+
+bool NoiseSpectrum::capture(WeightSensor* sensor, NoiseCapture capture, uint32_t from_us, uint32_t to_us) {
+    Workspace* ws = (Workspace*)heap_caps_malloc(sizeof(Workspace), MALLOC_CAP_8BIT);
+    if (!ws) {
+        LOG_BLE("[%lums NOISE_SPECTRUM] No memory for a %u byte workspace\n", millis(), (unsigned)sizeof(Workspace));
+        return false;
+    }
+
+    // The newest kPoints samples in [from_us, to_us), kept in ws as a ring
+    const SampleSequenceSource* source = sensor->get_recording_source();
+    uint32_t next_seq = source->get_sample_sequence_at(from_us);
+    uint32_t lost = 0;
+    uint32_t kept = 0;
+    int32_t chunk_raw[kReadChunk];
+    uint32_t chunk_us[kReadChunk];
+    bool window_done = false;
+    while (!window_done) {
+        const int count = source->read_samples_from(&next_seq, chunk_raw, chunk_us, kReadChunk, &lost);
+        if (count <= 0) {
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            if ((int32_t)(chunk_us[i] - to_us) >= 0) {
+                window_done = true;
+                break;
+            }
+            ws->raw[kept % kPoints] = chunk_raw[i];
+            ws->timestamps_us[kept % kPoints] = chunk_us[i];
+            kept++;
+        }
+    }
+    const uint16_t n = (uint16_t)std::min<uint32_t>(kept, kPoints);
+    if (n < SYS_NOISE_SPECTRUM_MIN_SAMPLES) {
+        LOG_BLE("[%lums NOISE_SPECTRUM] %s: %u samples in the window, %d needed\n", millis(),
+                kCaptureNames[(size_t)capture], (unsigned)n, SYS_NOISE_SPECTRUM_MIN_SAMPLES);
+        heap_caps_free(ws);
+        return false;
+    }
+    if (kept > kPoints) {
+        std::rotate(ws->raw, ws->raw + kept % kPoints, ws->raw + kPoints);
+        std::rotate(ws->timestamps_us, ws->timestamps_us + kept % kPoints, ws->timestamps_us + kPoints);
+    }
+
+    NoiseSpectrumResult result = {};
+    result.nominal_rate_sps = source->get_sample_rate();
+    const uint32_t start_cycles = esp_cpu_get_cycle_count();
+    analyse(ws, n, &result);
+    result.analysis_us = (esp_cpu_get_cycle_count() - start_cycles) / getCpuFrequencyMhz();
+    result.captured_ms = millis();
+    result.valid = true;
+    heap_caps_free(ws);
+
+    results[(size_t)capture] = result;
+    print_report(sensor, capture, result);
+    return true;
+}
+
+void NoiseSpectrum::store_tone(WeightSensor* sensor, const NoiseSpectrumResult& result) {
+    if (result.tone_index < 0) {
+        LOG_BLE("[%lums NOISE_SPECTRUM] No vibration tone; notch left at %.2f Hz\n", millis(),
+                sensor->get_vibration_tone_hz());
+        return;
+    }
+    if (result.nominal_rate_sps != sensor->get_adc_sample_rate_sps()) {
+        // The notch runs on conversions; a decimated ring's tone is a different alias
+        LOG_BLE("[%lums NOISE_SPECTRUM] Spectrum of the decimated ring (%lu SPS); tone not stored "
+                "(HW_LOADCELL_DECIMATION_RAW_RETENTION keeps the conversions)\n", millis(),
+                (unsigned long)result.nominal_rate_sps);
+        return;
+    }
+    // Same cycles per sample at the nominal rate the notch is designed for
+    const float tone_hz = result.peaks[result.tone_index].hz * result.nominal_rate_sps / result.sample_rate_sps;
+    if (tone_hz < HW_LOADCELL_VIBRATION_NOTCH_MIN_ALIAS_HZ) {
+        LOG_BLE("[%lums NOISE_SPECTRUM] Tone at %.2f Hz is too close to DC to notch\n", millis(), tone_hz);
+        return;
+    }
+    config_store.set_float(ConfigFloat::VIBRATION_NOTCH_HZ, tone_hz);
+    sensor->set_vibration_tone_hz(tone_hz);
+    LOG_BLE("[%lums NOISE_SPECTRUM] Vibration notch set to %.2f Hz at the nominal %lu SPS%s\n", millis(), tone_hz,
+            (unsigned long)result.nominal_rate_sps,
+            HW_LOADCELL_VIBRATION_NOTCH_ENABLED ? "" : " (HW_LOADCELL_VIBRATION_NOTCH_ENABLED is off)");
+}
+
+void NoiseSpectrum::print_report(WeightSensor* sensor, NoiseCapture capture, const NoiseSpectrumResult& result) const {
+    const float factor = fabsf(sensor->get_calibration_factor());
+    const float grams_per_raw = factor > 0.0f ? 1.0f / factor : 0.0f;
+    const float nyquist_hz = result.sample_rate_sps * 0.5f;
+
+    LOG_BLE("=== Noise spectrum (%s): %u samples at %.1f SPS, %.2f Hz bins, rms %.0f raw (%.3f g) ===\n",
+            kCaptureNames[(size_t)capture], (unsigned)result.sample_count, result.sample_rate_sps,
+            result.sample_rate_sps / kPoints, result.rms_raw, result.rms_raw * grams_per_raw);
+    for (uint8_t band = 0; band < SYS_NOISE_SPECTRUM_BANDS; band++) {
+        LOG_BLE("  band %5.1f-%5.1f Hz: floor %.1f raw (%.4f g)\n", nyquist_hz * band / SYS_NOISE_SPECTRUM_BANDS,
+                nyquist_hz * (band + 1) / SYS_NOISE_SPECTRUM_BANDS, result.band_floor_raw[band],
+                result.band_floor_raw[band] * grams_per_raw);
+    }
+    for (uint8_t i = 0; i < result.peak_count; i++) {
+        const NoiseSpectrumPeak& peak = result.peaks[i];
+        LOG_BLE("  peak %5.2f Hz: %.1f raw (%.4f g)%s%s\n", peak.hz, peak.amplitude_raw,
+                peak.amplitude_raw * grams_per_raw, peak.tone ? ", tone" : "", peak.mains ? ", mains alias" : "");
+    }
+    if (result.mains_index >= 0) {
+        LOG_BLE("  mains pickup at %.2f Hz: check grounding and the load cell cable\n", result.peaks[result.mains_index].hz);
+    }
+    if (result.tone_index >= 0) {
+        LOG_BLE("  %s tone at %.2f Hz\n", capture == NoiseCapture::MOTOR ? "vibration" : "interference",
+                result.peaks[result.tone_index].hz);
+    } else if (result.mains_index < 0) {
+        LOG_BLE("  no tone above %.1fx the band floor\n", SYS_NOISE_SPECTRUM_TONE_RATIO);
+    }
+    LOG_BLE("  analysis %lu us\n", (unsigned long)result.analysis_us);
+    LOG_BLE("==================================================================================\n");
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "../config/constants.h"
+
+class WeightSensor;
+class MotorEdgeTimeline;
+
+enum class NoiseCapture : uint8_t {
+    IDLE,                           // The newest samples, grinder idle: pickup and floor
+    MOTOR,                          // The next continuous motor run, after spin-up: vibration tone
+    COUNT
+};
+
+struct NoiseSpectrumPeak {
+    float hz;
+    float amplitude_raw;            // Sinusoid amplitude, raw counts
+    bool tone;                      // At least SYS_NOISE_SPECTRUM_TONE_RATIO above its band floor
+    bool mains;                     // On the alias of 50 or 60 Hz
+};
+
+struct NoiseSpectrumResult {
+    bool valid;
+    uint32_t captured_ms;
+    uint16_t sample_count;
+    float sample_rate_sps;          // Measured from the sample timestamps
+    uint32_t nominal_rate_sps;      // The ADC's configured rate, which the notch is designed for
+    float rms_raw;                  // After removing the trend
+    float band_floor_raw[SYS_NOISE_SPECTRUM_BANDS];
+    NoiseSpectrumPeak peaks[3];     // Strongest first
+    uint8_t peak_count;
+    int8_t tone_index;              // Strongest non-mains tone in peaks[], -1 if none
+    int8_t mains_index;             // Strongest mains tone in peaks[], -1 if none
+    uint32_t analysis_us;
+};
+
+/**
+ * NoiseSpectrum - FFT of the raw sample ring: dominant frequencies and noise floor
+ *
+ * An IDLE capture takes the newest SYS_NOISE_SPECTRUM_POINTS samples at once
+ * (deferred while the grinder runs). A MOTOR capture arms on request(): the
+ * vibration notch is bypassed so the ring holds the unfiltered tone, and the
+ * next START edge's run, from SYS_NOISE_SPECTRUM_SPINUP_MS after it to its
+ * STOP edge, is analysed once the STOP is on the timeline (the newest points
+ * of the run; the ring keeps 12 s at 80 SPS). Samples come from
+ * WeightSensor::get_recording_source(): the conversions themselves when the
+ * ring is decimated and they are retained.
+ *
+ * Analysis removes the linear trend (the flow ramp), applies a Hann window,
+ * zero-pads to the FFT length and runs an in-place radix-2 FFT; amplitudes are
+ * sinusoid amplitudes in raw counts. Each of SYS_NOISE_SPECTRUM_BANDS equal
+ * bands reports its median bin as the floor; the three strongest local maxima
+ * are refined by parabolic interpolation and flagged as tones and mains. The
+ * report is logged in raw counts and grams.
+ *
+ * A motor run with a non-mains tone stores its frequency (ConfigStore) and sets
+ * it on the WeightSensor, which notches it from then on. The notch works in
+ * cycles per sample at the nominal rate, so the stored value is the alias
+ * rescaled from the measured rate to the nominal one (an "80 SPS" HX711 runs
+ * a few percent off); it folds to the same alias at any rate dividing the
+ * capture rate (10 SPS after an 80 SPS capture).
+ *
+ * Started from BLE_DEBUG_CMD_NOISE_SPECTRUM or by DiagnosticsController when
+ * sustained noise appears (request(), any task); service() runs on the UI task,
+ * which owns the results. The host build runs both captures with --spectrum.
+ */
+class NoiseSpectrum {
+public:
+    void request(NoiseCapture capture);
+    bool is_armed(NoiseCapture capture) const;
+
+    // UI task, every cycle; cheap unless a capture is due
+    void service(WeightSensor* sensor, const MotorEdgeTimeline* edges, bool grinder_active);
+
+    // UI task. nullptr if the capture has not produced a spectrum yet
+    const NoiseSpectrumResult* get_result(NoiseCapture capture) const;
+
+private:
+    std::atomic<uint8_t> requested{0};     // Bit per NoiseCapture
+    bool motor_armed = false;
+    uint32_t motor_armed_edge_count = 0;
+    NoiseSpectrumResult results[(size_t)NoiseCapture::COUNT] = {};
+
+    void arm_motor(WeightSensor* sensor, const MotorEdgeTimeline* edges);
+    void service_motor(WeightSensor* sensor, const MotorEdgeTimeline* edges);
+    void disarm_motor(WeightSensor* sensor);
+    bool capture(WeightSensor* sensor, NoiseCapture capture, uint32_t from_us, uint32_t to_us);
+    void store_tone(WeightSensor* sensor, const NoiseSpectrumResult& result);
+    void print_report(WeightSensor* sensor, NoiseCapture capture, const NoiseSpectrumResult& result) const;
+};
+
+extern NoiseSpectrum noise_spectrum;
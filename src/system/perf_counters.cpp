@@ -0,0 +1,175 @@
+#include "perf_counters.h"
+#include "binary_writer.h"
+#include "../config/constants.h"
+
+PerfCounters perf_counters;
+
+namespace {
+const char* const kTimerNames[(size_t)PerfTimer::COUNT] = {
+    "weight_sampling", "grind_control", "ui_render", "bluetooth", "file_io", "main_loop"
+};
+const char* const kCountNames[(size_t)PerfCount::COUNT] = {
+    "file_io_session_dropped", "file_io_preference_dropped", "file_io_log_dropped", "file_io_urgent_wakes",
+    "grind_control_deadline_missed", "display_frames", "weight_sampling_jitter_gaps"
+};
+
+// Single writer: plain load + store, no atomic RMW needed
+void bump(std::atomic<uint32_t>& value, uint32_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+} // namespace
+
+PerfCounters::PerfCounters()
+    : histograms{TimingHistogram("interval"), TimingHistogram("latency"), TimingHistogram("grind_loop"),
+                 TimingHistogram("wake_jitter"), TimingHistogram("transfer_jitter")} {
+    for (auto& counter : counts) {
+        for (auto& slot : counter) {
+            slot.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void PerfCounters::record(PerfTimer timer, uint32_t duration_us) {
+    TimerSlot& slot = timers[(size_t)timer];
+    if (slot.reset_requested.load(std::memory_order_relaxed)) {
+        slot.count.store(0, std::memory_order_relaxed);
+        slot.sum_us.store(0, std::memory_order_relaxed);
+        slot.min_us.store(UINT32_MAX, std::memory_order_relaxed);
+        slot.max_us.store(0, std::memory_order_relaxed);
+        slot.reset_requested.store(false, std::memory_order_relaxed);
+    }
+
+    bump(slot.count, 1);
+    bump(slot.total_count, 1);
+    bump(slot.sum_us, duration_us);
+    if (duration_us < slot.min_us.load(std::memory_order_relaxed)) {
+        slot.min_us.store(duration_us, std::memory_order_relaxed);
+    }
+    if (duration_us > slot.max_us.load(std::memory_order_relaxed)) {
+        slot.max_us.store(duration_us, std::memory_order_relaxed);
+    }
+}
+
+PerfTimerWindow PerfCounters::get_window(PerfTimer timer) const {
+    const TimerSlot& slot = timers[(size_t)timer];
+    PerfTimerWindow window;
+    window.total_count = slot.total_count.load(std::memory_order_relaxed);
+    if (slot.reset_requested.load(std::memory_order_relaxed)) {
+        window.count = window.avg_us = window.min_us = window.max_us = 0;
+        return window;
+    }
+    // Fields may be one record apart when read during a write; good enough for reporting
+    window.count = slot.count.load(std::memory_order_relaxed);
+    uint32_t sum_us = slot.sum_us.load(std::memory_order_relaxed);
+    window.avg_us = window.count > 0 ? sum_us / window.count : 0;
+    window.min_us = window.count > 0 ? slot.min_us.load(std::memory_order_relaxed) : 0;
+    window.max_us = slot.max_us.load(std::memory_order_relaxed);
+    return window;
+}
+
+uint32_t PerfCounters::get_count(PerfCount counter) const {
+    const auto& slots = counts[(size_t)counter];
+    return slots[0].load(std::memory_order_relaxed) + slots[1].load(std::memory_order_relaxed);
+}
+
+void PerfCounters::reset_histograms() {
+    for (TimingHistogram& histogram : histograms) {
+        histogram.request_reset();
+    }
+}
+
+const char* PerfCounters::get_name(PerfTimer timer) {
+    return timer < PerfTimer::COUNT ? kTimerNames[(size_t)timer] : "?";
+}
+
+const char* PerfCounters::get_name(PerfCount counter) {
+    return counter < PerfCount::COUNT ? kCountNames[(size_t)counter] : "?";
+}
+
+size_t PerfCounters::format_json(char* buffer, size_t buffer_size) const {
+    size_t used = 0;
+    auto append = [&](const char* format, auto... args) {
+        if (used >= buffer_size) {
+            return;
+        }
+        int written = snprintf(buffer + used, buffer_size - used, format, args...);
+        used = (written < 0 || (size_t)written >= buffer_size - used) ? buffer_size : used + written;
+    };
+
+    // Histograms: "name_us":[count,p50,p90,p99,max]
+    append("\"timing\":{");
+    for (size_t i = 0; i < (size_t)PerfHistogram::COUNT; i++) {
+        TimingHistogram::Summary s = histograms[i].summarize();
+        append("%s\"%s_us\":[%lu,%lu,%lu,%lu,%lu]", i == 0 ? "" : ",", histograms[i].get_name(),
+               (unsigned long)s.count, (unsigned long)s.p50_us, (unsigned long)s.p90_us,
+               (unsigned long)s.p99_us, (unsigned long)s.max_us);
+    }
+    // Timers in PerfTimer order: [cycles in window,avg,max]
+    append("},\"cycle_us\":[");
+    for (size_t i = 0; i < (size_t)PerfTimer::COUNT; i++) {
+        PerfTimerWindow window = get_window((PerfTimer)i);
+        append("%s[%lu,%lu,%lu]", i == 0 ? "" : ",", (unsigned long)window.count,
+               (unsigned long)window.avg_us, (unsigned long)window.max_us);
+    }
+    append("],\"counts\":[");
+    for (size_t i = 0; i < (size_t)PerfCount::COUNT; i++) {
+        append("%s%lu", i == 0 ? "" : ",", (unsigned long)get_count((PerfCount)i));
+    }
+    append("]");
+
+    if (used >= buffer_size) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return used;
+}
+
+void PerfCounters::format_binary(BinaryWriter& writer) const {
+    writer.u8((uint8_t)PerfHistogram::COUNT);
+    for (const TimingHistogram& histogram : histograms) {
+        TimingHistogram::Summary s = histogram.summarize();
+        writer.u32(s.count);
+        writer.u32(s.p50_us);
+        writer.u32(s.p90_us);
+        writer.u32(s.p99_us);
+        writer.u32(s.max_us);
+    }
+    writer.u8((uint8_t)PerfTimer::COUNT);
+    for (size_t i = 0; i < (size_t)PerfTimer::COUNT; i++) {
+        PerfTimerWindow window = get_window((PerfTimer)i);
+        writer.u32(window.count);
+        writer.u32(window.avg_us);
+        writer.u32(window.max_us);
+    }
+    writer.u8((uint8_t)PerfCount::COUNT);
+    for (size_t i = 0; i < (size_t)PerfCount::COUNT; i++) {
+        writer.u32(get_count((PerfCount)i));
+    }
+}
+
+void PerfCounters::print_histogram_summary() const {
+    for (const TimingHistogram& histogram : histograms) {
+        TimingHistogram::Summary s = histogram.summarize();
+        LOG_BLE("[%lums TIMING %s] n=%lu p50=%luus p90=%luus p99=%luus max=%luus\n",
+                millis(), histogram.get_name(), (unsigned long)s.count, (unsigned long)s.p50_us,
+                (unsigned long)s.p90_us, (unsigned long)s.p99_us, (unsigned long)s.max_us);
+    }
+}
+
+void PerfCounters::print_report() const {
+    LOG_BLE("=== Performance Counters ===\n");
+    for (size_t i = 0; i < (size_t)PerfTimer::COUNT; i++) {
+        PerfTimerWindow window = get_window((PerfTimer)i);
+        LOG_BLE("  %s: %lu cycles (%lu total) avg %luus (%lu-%luus)\n", kTimerNames[i],
+                (unsigned long)window.count, (unsigned long)window.total_count, (unsigned long)window.avg_us,
+                (unsigned long)window.min_us, (unsigned long)window.max_us);
+    }
+    for (size_t i = 0; i < (size_t)PerfCount::COUNT; i++) {
+        LOG_BLE("  %s: %lu\n", kCountNames[i], (unsigned long)get_count((PerfCount)i));
+    }
+    print_histogram_summary();
+    for (const TimingHistogram& histogram : histograms) {
+        histogram.print_buckets();
+    }
+    LOG_BLE("============================\n");
+}
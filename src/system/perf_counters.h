@@ -0,0 +1,109 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include "timing_histograms.h"
+
+class BinaryWriter;
+
+// Ids are fixed at compile time: add an entry before COUNT and its name in perf_counters.cpp.
+
+// Busy time per task cycle (µs); each timer has exactly one writer, its task
+enum class PerfTimer : uint8_t {
+    WEIGHT_SAMPLING_CYCLE,
+    GRIND_CONTROL_CYCLE,
+    UI_RENDER_CYCLE,
+    BLUETOOTH_CYCLE,
+    FILE_IO_CYCLE,
+    MAIN_LOOP_CYCLE,                // Arduino loop() on Core 1
+    COUNT
+};
+
+// Event counts since boot; any task on either core may bump them
+enum class PerfCount : uint8_t {
+    FILE_IO_SESSION_DROPPED,        // Requests refused by a full FileIO lane, in FileIOLane order
+    FILE_IO_PREFERENCE_DROPPED,
+    FILE_IO_LOG_DROPPED,
+    FILE_IO_URGENT_WAKES,           // FileIOTask cycles started early by session work
+    GRIND_CONTROL_DEADLINE_MISSED,  // GrindControlTask cycles ending past their deadline
+    DISPLAY_FRAMES,                 // LVGL refreshes flushed to the panel (UI task)
+    WEIGHT_SAMPLING_JITTER_GAPS,    // WeightSamplingTask wake intervals too long to be jitter (missed edge, rate switch)
+    COUNT
+};
+
+// Log-linear timing histograms (TimingHistogram), one writer task each
+enum class PerfHistogram : uint8_t {
+    SAMPLE_INTERVAL,                // Between consecutive load cell sample timestamps (WeightSamplingTask)
+    DRDY_LATENCY,                   // Data-ready capture to sample fed into the filter (WeightSamplingTask)
+    GRIND_LOOP_PERIOD,              // GrindControlTask wake to wake
+    WAKE_JITTER,                    // |WeightSamplingTask wake interval - expected sample period|, gaps excluded
+    TRANSFER_WAKE_JITTER,           // WAKE_JITTER of the cycles with a radio transfer open (RadioCoexistence)
+    COUNT
+};
+
+// Timer figures since the last reset_window()
+struct PerfTimerWindow {
+    uint32_t count;
+    uint32_t avg_us;
+    uint32_t min_us;                // 0 when count is 0
+    uint32_t max_us;
+    uint32_t total_count;           // Cycles since boot
+};
+
+/**
+ * PerfCounters - Registry for every task's timing and event metrics
+ *
+ * Hot paths index arrays by enum id; nothing is looked up by name and nothing
+ * locks. Timers and histograms follow TimingHistogram's rule of one writer
+ * with relaxed loads and stores; a reset requested by a reader is applied by
+ * the writer on its next record(). Counters keep one slot per core so the
+ * two cores never contend for a cache line; readers sum the slots.
+ *
+ * Everything leaves through format_binary() (BLE sysinfo), format_json() (its
+ * text view, later MQTT) and print_report() (serial); heartbeats read single
+ * timers with get_window().
+ */
+class PerfCounters {
+public:
+    PerfCounters();
+
+    // Writer side
+    void record(PerfTimer timer, uint32_t duration_us);
+    void record(PerfHistogram histogram, uint32_t value_us) { histograms[(size_t)histogram].record(value_us); }
+    void increment(PerfCount counter) {
+        counts[(size_t)counter][xPortGetCoreID() & 1].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Reader side (any task)
+    PerfTimerWindow get_window(PerfTimer timer) const;
+    void reset_window(PerfTimer timer) { timers[(size_t)timer].reset_requested.store(true, std::memory_order_relaxed); }
+    uint32_t get_count(PerfCount counter) const;
+    const TimingHistogram& get_histogram(PerfHistogram histogram) const { return histograms[(size_t)histogram]; }
+    void reset_histograms();
+
+    static const char* get_name(PerfTimer timer);
+    static const char* get_name(PerfCount counter);
+
+    // "timing":{histograms},"cycle_us":[[n,avg,max] per timer],"counts":[per counter]
+    size_t format_json(char* buffer, size_t buffer_size) const;
+    // Same figures, u32 LE: [n]{count,p50,p90,p99,max} [n]{count,avg,max} [n]{count}
+    void format_binary(BinaryWriter& writer) const;
+    void print_histogram_summary() const;
+    void print_report() const;              // Timers, counters, histogram summaries and buckets
+
+private:
+    struct TimerSlot {
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint32_t> sum_us{0};
+        std::atomic<uint32_t> min_us{UINT32_MAX};
+        std::atomic<uint32_t> max_us{0};
+        std::atomic<uint32_t> total_count{0};
+        std::atomic<bool> reset_requested{false};
+    };
+
+    TimerSlot timers[(size_t)PerfTimer::COUNT];
+    std::atomic<uint32_t> counts[(size_t)PerfCount::COUNT][2];
+    TimingHistogram histograms[(size_t)PerfHistogram::COUNT];
+};
+
+extern PerfCounters perf_counters;
@@ -0,0 +1,73 @@
+#include "power_manager.h"
+#include "../config/constants.h"
+#include <esp_pm.h>
+
+PowerManager power_manager;
+
+namespace {
+const char* const kHoldNames[(size_t)PowerHold::COUNT] = {
+    "grind", "transfer", "ota", "trace", "ui_active", "awake"
+};
+} // namespace
+
+void PowerManager::init() {
+#if SYS_POWER_MANAGEMENT_ENABLED
+    esp_pm_config_t config = {};
+    config.max_freq_mhz = SYS_PM_MAX_CPU_FREQ_MHZ;
+    config.min_freq_mhz = SYS_PM_MIN_CPU_FREQ_MHZ;
+    config.light_sleep_enable = SYS_PM_LIGHT_SLEEP_ENABLED;
+    esp_err_t err = esp_pm_configure(&config);
+    if (err != ESP_OK) {
+        LOG_BLE("PowerManager: esp_pm_configure failed (%s), CPU stays at %luMHz\n",
+                esp_err_to_name(err), (unsigned long)getCpuFrequencyMhz());
+        return;
+    }
+
+    for (size_t i = 0; i < (size_t)PowerHold::COUNT; i++) {
+        esp_pm_lock_type_t type = (PowerHold)i == PowerHold::AWAKE ? ESP_PM_NO_LIGHT_SLEEP : ESP_PM_CPU_FREQ_MAX;
+        esp_pm_lock_handle_t lock = nullptr;
+        if (esp_pm_lock_create(type, 0, kHoldNames[i], &lock) != ESP_OK) {
+            LOG_BLE("PowerManager: no lock for %s\n", kHoldNames[i]);
+        }
+        locks[i] = lock;
+    }
+
+    // Holds set before init() take their locks now; the screen starts awake
+    uint32_t bits = hold_bits.fetch_or(1UL << (uint32_t)PowerHold::AWAKE, std::memory_order_relaxed) |
+                    (1UL << (uint32_t)PowerHold::AWAKE);
+    for (size_t i = 0; i < (size_t)PowerHold::COUNT; i++) {
+        if ((bits & (1UL << i)) && locks[i]) {
+            esp_pm_lock_acquire((esp_pm_lock_handle_t)locks[i]);
+        }
+    }
+    enabled = true;
+    LOG_BLE("PowerManager: DFS %d-%dMHz, light sleep %s\n", SYS_PM_MIN_CPU_FREQ_MHZ, SYS_PM_MAX_CPU_FREQ_MHZ,
+            SYS_PM_LIGHT_SLEEP_ENABLED ? "when idle" : "off");
+#endif
+}
+
+void PowerManager::set_hold(PowerHold hold, bool active) {
+    if (hold >= PowerHold::COUNT) {
+        return;
+    }
+    uint32_t bit = 1UL << (uint32_t)hold;
+    uint32_t previous = active ? hold_bits.fetch_or(bit, std::memory_order_relaxed)
+                               : hold_bits.fetch_and(~bit, std::memory_order_relaxed);
+    if (((previous & bit) != 0) == active || !enabled) {
+        return;
+    }
+#if SYS_POWER_MANAGEMENT_ENABLED
+    esp_pm_lock_handle_t lock = (esp_pm_lock_handle_t)locks[(size_t)hold];
+    if (lock) {
+        if (active) {
+            esp_pm_lock_acquire(lock);
+        } else {
+            esp_pm_lock_release(lock);
+        }
+    }
+#endif
+}
+
+bool PowerManager::is_held(PowerHold hold) const {
+    return hold < PowerHold::COUNT && (hold_bits.load(std::memory_order_relaxed) & (1UL << (uint32_t)hold)) != 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// Reasons to keep the CPU at full clock, or awake
+enum class PowerHold : uint8_t {
+    GRIND,                          // GrindControlTask: a session is running
+    TRANSFER,                       // RadioCoexistence: BLE export or MQTT upload open
+    OTA,                            // OTAHandler: patch being received and written
+    TRACE,                          // Trace capture: cycle stamps need one clock
+    UI_ACTIVE,                      // UI task: touch or animation on screen
+    AWAKE,                          // ScreenTimeoutController: anything but a dimmed, radio-off Ready screen
+    COUNT
+};
+
+/**
+ * PowerManager - Dynamic frequency scaling and automatic light sleep
+ *
+ * init() hands the CPU clock to esp_pm: between SYS_PM_MIN_CPU_FREQ_MHZ and
+ * SYS_PM_MAX_CPU_FREQ_MHZ, and with SYS_PM_LIGHT_SLEEP_ENABLED light sleep
+ * whenever both cores idle past the next timer. Each PowerHold owns one esp_pm
+ * lock: AWAKE only forbids light sleep, the others also pin the maximum clock.
+ * set_hold() is idempotent per hold and may be called every cycle from the
+ * task that owns the hold; only a change touches the lock.
+ *
+ * Light sleep stops the DOUT interrupt and USB serial, so only the dimmed
+ * Ready screen with BLE off (and no Wi-Fi build) releases AWAKE. The sampling
+ * task then polls on its interrupt timeout or sleeps with the ADC powered down.
+ * Without SYS_POWER_MANAGEMENT_ENABLED, or when esp_pm refuses the
+ * configuration (CONFIG_PM_ENABLE off), holds are tracked but change nothing.
+ */
+class PowerManager {
+public:
+    void init();                                            // setup(), before the tasks start
+    void set_hold(PowerHold hold, bool active);
+    bool is_held(PowerHold hold) const;
+    bool is_enabled() const { return enabled; }
+
+private:
+    void* locks[(size_t)PowerHold::COUNT] = {};             // esp_pm_lock_handle_t
+    std::atomic<uint32_t> hold_bits{0};
+    bool enabled = false;
+};
+
+extern PowerManager power_manager;
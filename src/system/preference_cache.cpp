@@ -0,0 +1,164 @@
+#include "preference_cache.h"
+#include "../config/logging.h"
+
+#include <Arduino.h>
+#include <cstring>
+
+PreferenceCache preference_cache;
+
+namespace {
+constexpr uint32_t kQuietFlushDelayMs = 3000;   // Slider drags and button repeats settle first
+} // namespace
+
+PreferenceCache::PreferenceCache() {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void PreferenceCache::init(Preferences* prefs) {
+    preferences = prefs;
+}
+
+void PreferenceCache::put_int(const char* key, int32_t value) {
+    Entry entry = {};
+    strncpy(entry.key, key, sizeof(entry.key) - 1);
+    entry.type = EntryType::INT;
+    entry.int_value = value;
+    put(entry);
+}
+
+void PreferenceCache::put_float(const char* key, float value) {
+    Entry entry = {};
+    strncpy(entry.key, key, sizeof(entry.key) - 1);
+    entry.type = EntryType::FLOAT;
+    entry.float_value = value;
+    put(entry);
+}
+
+void PreferenceCache::put_string(const char* key, const char* value) {
+    Entry entry = {};
+    strncpy(entry.key, key, sizeof(entry.key) - 1);
+    entry.type = EntryType::STRING;
+    strncpy(entry.string_value, value, sizeof(entry.string_value) - 1);
+    put(entry);
+}
+
+void PreferenceCache::put_bytes(const char* key, const void* value, size_t length) {
+    if (length > kMaxValueLength) {
+        LOG_BLE("WARNING: Preference %s too long for the cache (%u bytes)\n", key, (unsigned)length);
+        return;
+    }
+    Entry entry = {};
+    strncpy(entry.key, key, sizeof(entry.key) - 1);
+    entry.type = EntryType::BYTES;
+    entry.length = (uint8_t)length;
+    memcpy(entry.string_value, value, length);
+    put(entry);
+}
+
+void PreferenceCache::put(const Entry& value) {
+    uint32_t now = millis();
+    bool write_through = false;
+
+    portENTER_CRITICAL(&lock);
+    Entry* entry = nullptr;
+    for (uint8_t i = 0; i < entry_count; i++) {
+        if (strcmp(entries[i].key, value.key) == 0) {
+            entry = &entries[i];
+            break;
+        }
+    }
+    if (entry && entry->type == value.type &&
+        entry->int_value == value.int_value && entry->float_value == value.float_value &&
+        entry->length == value.length && memcmp(entry->string_value, value.string_value, kMaxValueLength) == 0) {
+        coalesced_count++;  // Already pending or stored
+    } else if (entry) {
+        if (entry->dirty) {
+            coalesced_count++;
+        }
+        *entry = value;
+        entry->dirty = true;
+        entry->changed_ms = now;
+    } else if (entry_count < kMaxEntries) {
+        entry = &entries[entry_count++];
+        *entry = value;
+        entry->dirty = true;
+        entry->changed_ms = now;
+    } else {
+        write_through = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (write_through) {
+        write_entry(value);
+    }
+}
+
+void PreferenceCache::service(uint32_t now_ms, bool idle) {
+    if (idle) {
+        write_dirty(now_ms, kQuietFlushDelayMs);
+    }
+}
+
+void PreferenceCache::flush() {
+    write_dirty(millis(), 0);
+}
+
+void PreferenceCache::write_dirty(uint32_t now_ms, uint32_t quiet_ms) {
+    for (uint8_t i = 0; i < kMaxEntries; i++) {
+        // Copy under the lock so the NVS write does not hold it; a put during the write re-dirties the entry
+        Entry pending;
+        bool due = false;
+        portENTER_CRITICAL(&lock);
+        if (i < entry_count && entries[i].dirty && now_ms - entries[i].changed_ms >= quiet_ms) {
+            pending = entries[i];
+            entries[i].dirty = false;
+            due = true;
+        }
+        portEXIT_CRITICAL(&lock);
+
+        if (due) {
+            write_entry(pending);
+        }
+    }
+}
+
+bool PreferenceCache::write_entry(const Entry& entry) {
+    if (!preferences) {
+        return false;
+    }
+
+    size_t written = 0;
+    switch (entry.type) {
+        case EntryType::INT:
+            written = preferences->putInt(entry.key, entry.int_value);
+            break;
+        case EntryType::FLOAT:
+            written = preferences->putFloat(entry.key, entry.float_value);
+            break;
+        case EntryType::STRING:
+            written = preferences->putString(entry.key, entry.string_value);
+            break;
+        case EntryType::BYTES:
+            written = preferences->putBytes(entry.key, entry.string_value, entry.length);
+            break;
+    }
+    write_count++;
+
+    if (written == 0) {
+        LOG_BLE("WARNING: Failed to write preference %s\n", entry.key);
+        return false;
+    }
+    return true;
+}
+
+uint8_t PreferenceCache::get_dirty_count() const {
+    uint8_t dirty = 0;
+    portENTER_CRITICAL(&lock);
+    for (uint8_t i = 0; i < entry_count; i++) {
+        if (entries[i].dirty) {
+            dirty++;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return dirty;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <Preferences.h>
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+
+// Write-back cache for the "grinder" NVS namespace (HardwareManager's open Preferences).
+// put_*() only records the value: a put that matches the value already pending or stored is
+// dropped, and repeated puts to a key coalesce into one write. FileIOTask calls service() every
+// cycle, which writes the dirty keys once the grinder is idle and they have been quiet for a few
+// seconds. flush() writes everything now (before a restart).
+//
+// Keys written through the cache must not be read back from NVS before the flush; owners keep
+// their own copy (ProfileController, ConfigStore's blob). A full table falls back to writing through.
+class PreferenceCache {
+public:
+    PreferenceCache();
+
+    void init(Preferences* prefs);
+
+    void put_int(const char* key, int32_t value);
+    void put_float(const char* key, float value);
+    void put_string(const char* key, const char* value);
+    void put_bytes(const char* key, const void* value, size_t length);   // At most kMaxValueLength bytes
+
+    void service(uint32_t now_ms, bool idle);
+    void flush();
+
+    uint8_t get_dirty_count() const;
+    uint32_t get_write_count() const { return write_count; }        // NVS writes issued
+    uint32_t get_coalesced_count() const { return coalesced_count; } // Puts that needed no write of their own
+
+    static constexpr uint8_t kMaxValueLength = 64;      // Strings (NUL included) and blobs; FileIOPreferencePayload::value
+
+private:
+    static constexpr uint8_t kMaxEntries = 16;
+    static constexpr uint8_t kMaxKeyLength = 16;        // NVS keys are at most 15 characters
+
+    enum class EntryType : uint8_t { INT, FLOAT, STRING, BYTES };
+
+    struct Entry {
+        char key[kMaxKeyLength];
+        EntryType type;
+        bool dirty;
+        uint32_t changed_ms;
+        int32_t int_value;
+        float float_value;
+        uint8_t length;                                 // BYTES
+        char string_value[kMaxValueLength];             // STRING, or the BYTES value
+    };
+
+    Entry entries[kMaxEntries];
+    uint8_t entry_count = 0;
+    Preferences* preferences = nullptr;
+    uint32_t write_count = 0;
+    uint32_t coalesced_count = 0;
+    mutable portMUX_TYPE lock;
+
+    void put(const Entry& value);
+    bool write_entry(const Entry& entry);
+    void write_dirty(uint32_t now_ms, uint32_t quiet_ms);
+};
+
+// Global instance
+extern PreferenceCache preference_cache;
@@ -0,0 +1,52 @@
+#include "radio_coexistence.h"
+#include "../config/constants.h"
+#include "../controllers/grind_phase.h"
+#include "power_manager.h"
+#include "telemetry.h"
+
+RadioCoexistence radio_coexistence;
+
+bool RadioCoexistence::is_grind_active() const {
+    for (uint8_t ch = 0; ch < HW_GRINDER_CHANNELS; ch++) {
+        GrindPhase phase = static_cast<GrindPhase>(channel_telemetry(ch).get_phase());
+        if (phase != GrindPhase::IDLE && phase != GrindPhase::COMPLETED && phase != GrindPhase::TIMEOUT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RadioCoexistence::allow(RadioWork work) {
+    if (!is_grind_active()) {
+        return true;
+    }
+    deferred[(size_t)work].fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool RadioCoexistence::allow_trickle(RadioWork work, uint32_t now_ms, uint32_t* last_ms) {
+    if (!is_grind_active()) {
+        return true;
+    }
+    if (now_ms - *last_ms < SYS_COEX_TRICKLE_INTERVAL_MS) {
+        deferred[(size_t)work].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    *last_ms = now_ms;
+    return true;
+}
+
+void RadioCoexistence::set_transfer(RadioWork work, bool active) {
+    uint32_t bit = 1UL << (uint32_t)work;
+    uint32_t bits;
+    if (active) {
+        bits = transfer_bits.fetch_or(bit, std::memory_order_relaxed) | bit;
+    } else {
+        bits = transfer_bits.fetch_and(~bit, std::memory_order_relaxed) & ~bit;
+    }
+    power_manager.set_hold(PowerHold::TRANSFER, bits != 0);
+}
+
+uint32_t RadioCoexistence::get_deferred_count(RadioWork work) const {
+    return work < RadioWork::COUNT ? deferred[(size_t)work].load(std::memory_order_relaxed) : 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// Radio work that can wait for a grind to end
+enum class RadioWork : uint8_t {
+    BLE_EXPORT,                     // Session export / file stream chunks
+    MQTT_SESSIONS,                  // Session summaries
+    MQTT_UPLOAD,                    // Session file chunks
+    MQTT_STATE,                     // Home Assistant state
+    MQTT_DIAGNOSTICS,
+    MQTT_ROLLUPS,                   // Hourly and daily session rollups
+    WEB_PAGE,                       // Dashboard page loads
+    WEB_SESSIONS,                   // Session summaries to dashboard clients
+    COUNT
+};
+
+/**
+ * RadioCoexistence - What Wi-Fi and BLE may do while a grind runs
+ *
+ * Both stacks share one radio and run on Core 1 (sdkconfig pins the BLE host
+ * and controller, the Wi-Fi, lwIP and esp-mqtt tasks), but their interrupts,
+ * flash reads for exports and cache misses still reach Core 0. While any
+ * grinder's GrindController phase (from its Telemetry) is anything but idle
+ * or finished, bulk work is held back: allow() refuses it, and
+ * allow_trickle() lets one unit through per SYS_COEX_TRICKLE_INTERVAL_MS for
+ * links whose host gives up when nothing arrives (BLE export). Live streams (BLE telemetry, MQTT
+ * telemetry batches, dashboard WebSocket frames) and commands are never
+ * deferred. Work resumes on its next pass after the grind.
+ *
+ * Transfers report themselves with set_transfer(); WeightSamplingTask keeps a
+ * second wake jitter histogram for cycles with a transfer open, so the
+ * heartbeat shows what a transfer does to sampling.
+ */
+class RadioCoexistence {
+public:
+    bool is_grind_active() const;
+    bool allow(RadioWork work);                             // Counts a deferral when refused
+    bool allow_trickle(RadioWork work, uint32_t now_ms, uint32_t* last_ms);
+
+    void set_transfer(RadioWork work, bool active);
+    bool is_transfer_active() const { return transfer_bits.load(std::memory_order_relaxed) != 0; }
+
+    uint32_t get_deferred_count(RadioWork work) const;     // Refused passes since boot
+
+private:
+    std::atomic<uint32_t> transfer_bits{0};
+    std::atomic<uint32_t> deferred[(size_t)RadioWork::COUNT] = {};
+};
+
+extern RadioCoexistence radio_coexistence;
@@ -1,16 +1,86 @@
 #include "state_machine.h"
 #include <Arduino.h>
+#include "../config/constants.h"
+#include "../config/logging.h"
+
+namespace {
+const char* source_name(StateEventSource source) {
+    switch (source) {
+        case StateEventSource::UI: return "ui";
+        case StateEventSource::GRIND: return "grind";
+        case StateEventSource::BLUETOOTH: return "ble";
+        case StateEventSource::REMOTE: return "remote";
+    }
+    return "?";
+}
+} // namespace
 
 void StateMachine::init(UIState initial_state) {
     current_state = initial_state;
     previous_state = initial_state;
+    if (!event_queue) {
+        event_queue = xQueueCreate(kEventQueueLength, sizeof(StateEvent));
+    }
 }
 
-void StateMachine::transition_to(UIState new_state) {
+bool StateMachine::add_observer(StateObserver* observer) {
+    if (!observer || observer_count >= kMaxObservers) {
+        return false;
+    }
+    observers[observer_count++] = observer;
+    return true;
+}
+
+void StateMachine::transition_to(UIState new_state, StateEventSource source) {
     if (current_state == new_state) return;
-    
-    previous_state = current_state;
+    if (in_transition) {
+        // An entry handler that moves on again: run it as its own transition once this one is done
+        post(new_state, source);
+        return;
+    }
+
+    in_transition = true;
+    UIState old_state = current_state;
+    for (int i = observer_count - 1; i >= 0; i--) {
+        observers[i]->on_state_exit(old_state, new_state);
+    }
+    previous_state = old_state;
     current_state = new_state;
+    transition_count++;
+    LOG_UI_DEBUG("[%lums UI_STATE] %s -> %s (%s)\n", millis(), get_state_name(old_state), get_state_name(new_state),
+                 source_name(source));
+    for (uint8_t i = 0; i < observer_count; i++) {
+        observers[i]->on_state_enter(new_state, old_state);
+    }
+    in_transition = false;
+}
+
+void StateMachine::reenter() {
+    for (uint8_t i = 0; i < observer_count; i++) {
+        observers[i]->on_state_enter(current_state, current_state);
+    }
+}
+
+bool StateMachine::post(UIState target, StateEventSource source) {
+    StateEvent event = {target, source, millis()};
+    if (!event_queue || xQueueSend(event_queue, &event, 0) != pdPASS) {
+        dropped_event_count++;
+        return false;
+    }
+    if (event_consumer) {
+        xTaskNotify(event_consumer, SYS_UI_WAKE_NOTIFY_BIT, eSetBits);
+    }
+    return true;
+}
+
+uint8_t StateMachine::dispatch_events() {
+    uint8_t count = 0;
+    StateEvent event;
+    while (event_queue && xQueueReceive(event_queue, &event, 0) == pdPASS) {
+        transition_to(event.target, event.source);
+        count++;
+    }
+    return count;
 }
 
 const char* StateMachine::get_state_name(UIState state) const {
@@ -1,4 +1,8 @@
 #pragma once
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 
 enum class UIState {
     READY,
@@ -14,17 +18,79 @@ enum class UIState {
     OTA_UPDATE_FAILED
 };
 
+// Who asked for a transition (logged with it)
+enum class StateEventSource : uint8_t {
+    UI,             // Touch, LVGL timers and the UI task's own controllers
+    GRIND,          // GrindController events
+    BLUETOOTH,      // OTA and data export
+    REMOTE          // MQTT commands
+};
+
+struct StateEvent {
+    UIState target;
+    StateEventSource source;
+    uint32_t posted_ms;
+};
+
+// Notified on the UI task as a transition happens: exits in reverse registration order, then entries in order
+class StateObserver {
+public:
+    virtual ~StateObserver() = default;
+    virtual void on_state_exit(UIState state, UIState next) { (void)state; (void)next; }
+    virtual void on_state_enter(UIState state, UIState previous) = 0;
+};
+
+/**
+ * StateMachine - The UI state, changed by events
+ *
+ * transition_to() runs on the UI task (touch handlers, LVGL timers, the
+ * grind event drain): it calls the observers' exit handlers, switches the
+ * state and calls their entry handlers once, so screens and controllers act
+ * on the transition itself rather than spotting a new state on a later
+ * frame. Entering the state already current does nothing; reenter() runs
+ * the entry handlers again for it (the first screen, a screen to re-show).
+ *
+ * Other tasks post() an event instead. The queue wakes the UI task
+ * (set_event_consumer()), which runs the queued transitions in order from
+ * dispatch_events() at the start of its next cycle, so an event from BLE
+ * takes effect within a notification rather than the idle poll. A full
+ * queue drops the event and counts it.
+ */
 class StateMachine {
 private:
+    static constexpr uint8_t kMaxObservers = 4;
+    static constexpr uint8_t kEventQueueLength = 8;
+
     UIState current_state;
     UIState previous_state;
+    StateObserver* observers[kMaxObservers] = {};
+    uint8_t observer_count = 0;
+    bool in_transition = false;
+
+    QueueHandle_t event_queue = nullptr;
+    TaskHandle_t event_consumer = nullptr;
+    uint32_t transition_count = 0;
+    uint32_t dropped_event_count = 0;
 
 public:
     void init(UIState initial_state = UIState::READY);
-    void transition_to(UIState new_state);
-    
+    bool add_observer(StateObserver* observer);
+
+    // UI task only
+    void transition_to(UIState new_state, StateEventSource source = StateEventSource::UI);
+    void reenter();                                     // Entry handlers for the current state, no transition
+    uint8_t dispatch_events();                          // Queued transitions, in order; returns how many ran
+
+    // Any task
+    bool post(UIState target, StateEventSource source);
+    void set_event_consumer(TaskHandle_t task) { event_consumer = task; }
+
     UIState get_current_state() const { return current_state; }
     UIState get_previous_state() const { return previous_state; }
     bool is_state(UIState state) const { return current_state == state; }
     const char* get_state_name(UIState state) const;
+    uint32_t get_transition_count() const { return transition_count; }
+    uint32_t get_dropped_event_count() const { return dropped_event_count; }
 };
+
+extern StateMachine state_machine;
@@ -1,16 +1,36 @@
 #include "statistics_manager.h"
+#include "../config/logging.h"
 
 #include <Arduino.h>
+#include <LittleFS.h>
+#include <esp_rom_crc.h>
 #include <cmath>
+#include <cstddef>
 #include <cstring>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 
 StatisticsManager statistics_manager;
+#if HW_GRINDER_CHANNELS > 1
+static StatisticsManager extra_channel_statistics[HW_GRINDER_CHANNELS - 1];   // GrindChannels 1..N-1
+#endif
+
+StatisticsManager& channel_statistics(uint8_t grinder_channel) {
+#if HW_GRINDER_CHANNELS > 1
+    if (grinder_channel > 0 && grinder_channel < HW_GRINDER_CHANNELS) {
+        return extra_channel_statistics[grinder_channel - 1];
+    }
+#else
+    (void)grinder_channel;
+#endif
+    return statistics_manager;
+}
 
 namespace {
 StaticSemaphore_t g_stats_mutex_buffer;
-SemaphoreHandle_t g_stats_mutex = nullptr;
+SemaphoreHandle_t g_stats_mutex = nullptr;         // Working snapshot and dirty state
+StaticSemaphore_t g_persist_mutex_buffer;
+SemaphoreHandle_t g_persist_mutex = nullptr;       // Flash writers and the journal record count
 
 struct StatisticsSnapshotV1 {
     uint32_t version;
@@ -34,6 +54,56 @@ struct StatisticsSnapshotV1 {
     uint32_t reserved1;
 };
 
+struct StatisticsSnapshotV2 {
+    uint32_t version;
+    uint32_t total_grinds;
+    uint32_t single_shots;
+    uint32_t double_shots;
+    uint32_t custom_shots;
+    uint32_t motor_runtime_sec;
+    uint32_t motor_runtime_ms_remainder;
+    uint32_t device_uptime_hrs;
+    uint32_t device_uptime_min_remainder;
+    float total_weight_kg;
+    uint32_t weight_mode_grinds;
+    uint32_t time_mode_grinds;
+    uint32_t time_pulses;
+    uint32_t total_pulses;
+    uint32_t accuracy_sample_count;
+    float accuracy_sum;
+    uint32_t pulse_sample_count;
+    float pulse_sum;
+    uint32_t sequence;
+    uint32_t reserved1;
+};
+
+static_assert(offsetof(StatisticsSnapshot, quantiles) == sizeof(StatisticsSnapshotV2),
+              "StatisticsSnapshot v3 must keep the v2 layout as its prefix");
+
+// v2 fields carry over; the percentiles start empty
+void upgrade_snapshot_v2(const StatisticsSnapshotV2& legacy, StatisticsSnapshot* snapshot) {
+    *snapshot = StatisticsSnapshot{};
+    snapshot->total_grinds = legacy.total_grinds;
+    snapshot->single_shots = legacy.single_shots;
+    snapshot->double_shots = legacy.double_shots;
+    snapshot->custom_shots = legacy.custom_shots;
+    snapshot->motor_runtime_sec = legacy.motor_runtime_sec;
+    snapshot->motor_runtime_ms_remainder = legacy.motor_runtime_ms_remainder;
+    snapshot->device_uptime_hrs = legacy.device_uptime_hrs;
+    snapshot->device_uptime_min_remainder = legacy.device_uptime_min_remainder;
+    snapshot->total_weight_kg = legacy.total_weight_kg;
+    snapshot->weight_mode_grinds = legacy.weight_mode_grinds;
+    snapshot->time_mode_grinds = legacy.time_mode_grinds;
+    snapshot->time_pulses = legacy.time_pulses;
+    snapshot->total_pulses = legacy.total_pulses;
+    snapshot->accuracy_sample_count = legacy.accuracy_sample_count;
+    snapshot->accuracy_sum = legacy.accuracy_sum;
+    snapshot->pulse_sample_count = legacy.pulse_sample_count;
+    snapshot->pulse_sum = legacy.pulse_sum;
+    snapshot->sequence = legacy.sequence;
+    snapshot->reserved1 = legacy.reserved1;
+}
+
 class StatsLockGuard {
 public:
     explicit StatsLockGuard(SemaphoreHandle_t mutex) : mutex_(mutex) {
@@ -52,30 +122,87 @@ private:
     SemaphoreHandle_t mutex_;
 };
 
-constexpr uint32_t kPulseFlushThreshold = 50;        // Flush every ~5 seconds of pulses
+constexpr uint32_t kJournalMagicV2 = 0x4A545353;    // "SSTJ", StatisticsSnapshotV2 records
+constexpr uint32_t kJournalMagic = 0x4B545353;      // "SSTK"
+
+template <typename Snapshot>
+struct JournalRecord {
+    uint32_t magic;
+    Snapshot snapshot;
+    uint32_t crc;                                    // esp_rom_crc32_le over magic and snapshot
+};
+using StatisticsJournalRecord = JournalRecord<StatisticsSnapshot>;
+using StatisticsJournalRecordV2 = JournalRecord<StatisticsSnapshotV2>;
+
+template <typename Snapshot>
+uint32_t journal_record_crc(const JournalRecord<Snapshot>& record) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&record, offsetof(JournalRecord<Snapshot>, crc));
+}
+
+// Rest of a record whose magic has been read; false when torn or damaged
+template <typename Snapshot>
+bool read_journal_record(File& journal, uint32_t magic, JournalRecord<Snapshot>* record) {
+    record->magic = magic;
+    const size_t rest = sizeof(*record) - sizeof(magic);
+    return journal.read((uint8_t*)record + sizeof(magic), rest) == rest && record->crc == journal_record_crc(*record);
+}
+
+// 808 bytes, kept off the caller's stack (flush() runs on the BLE task); boot and the persist lock serialize it
+StatisticsJournalRecord g_journal_record;
+
 constexpr uint32_t kPulseDurationMs = 100;           // Each time-mode pulse is 100ms
-constexpr uint32_t kMaxFlushIntervalMs = 10000;      // Failsafe flush window
-constexpr uint32_t kMinFlushIntervalMs = 1000;       // Minimum spacing between auto-flush commits
+constexpr uint32_t kIdleFlushDelayMs = 5000;         // Quiet time after the last update before a flush
+constexpr uint32_t kMaxDirtyMs = 60000;              // Flush at the next idle cycle once data is this old
+constexpr uint32_t kJournalMaxRecords = 32;          // Checkpoint to NVS and restart the journal after this many
 } // namespace
 
-void StatisticsManager::init(Preferences* prefs) {
+void StatisticsManager::init(Preferences* prefs, uint8_t grinder_channel) {
     (void)prefs;
 
+    grinder_channel_ = grinder_channel;
+    if (grinder_channel_ > 0) {
+        snprintf(snapshot_key_, sizeof(snapshot_key_), "snapshot_ch%u", (unsigned)grinder_channel_ + 1);
+        snprintf(journal_path_, sizeof(journal_path_), "/stats_journal_ch%u.bin", (unsigned)grinder_channel_ + 1);
+    }
+
     if (!g_stats_mutex) {
         g_stats_mutex = xSemaphoreCreateMutexStatic(&g_stats_mutex_buffer);
+        g_persist_mutex = xSemaphoreCreateMutexStatic(&g_persist_mutex_buffer);
     }
 
+    bool checkpoint_due;
     {
         StatsLockGuard lock(g_stats_mutex);
         load_from_storage();
-        last_flush_ms_ = millis();
+        checkpoint_due = load_journal();
+        publish_locked();
     }
 
     initialized_ = true;
+    if (checkpoint_due) {
+        persist(true);
+    }
+}
+
+void StatisticsManager::service(uint32_t now_ms, bool idle) {
+    if (!initialized_ || !idle) return;
+
+    {
+        StatsLockGuard lock(g_stats_mutex);
+        if (!dirty_ || (now_ms - last_update_ms_ < kIdleFlushDelayMs && now_ms - dirty_since_ms_ < kMaxDirtyMs)) {
+            return;
+        }
+    }
+    persist(false);
+}
+
+void StatisticsManager::flush() {
+    if (!initialized_) return;
+    persist(false);
 }
 
 void StatisticsManager::update_grind_session(float final_weight, float error_grams, uint8_t pulse_count,
-                                             bool is_weight_mode, uint32_t motor_time_ms) {
+                                             bool is_weight_mode, uint32_t motor_time_ms, uint8_t profile_id) {
     if (!initialized_) return;
 
     StatsLockGuard lock(g_stats_mutex);
@@ -106,8 +233,18 @@ void StatisticsManager::update_grind_session(float final_weight, float error_gra
     snapshot_.pulse_sample_count++;
     snapshot_.pulse_sum += pulse_count;
 
-    mark_dirty_locked();
-    persist_locked(true); // Session-level updates should persist immediately
+    const uint8_t sets[] = {profile_id < USER_PROFILE_COUNT ? profile_id : kStatisticsAllProfiles,
+                            kStatisticsAllProfiles};
+    for (uint8_t i = 0; i < (sets[0] == sets[1] ? 1 : 2); i++) {
+        StreamingQuantiles* quantiles = snapshot_.quantiles[sets[i]];
+        if (is_weight_mode) {
+            quantiles[static_cast<uint8_t>(StatisticsMetric::ABS_ERROR_G)].add(std::fabs(error_grams));
+        }
+        quantiles[static_cast<uint8_t>(StatisticsMetric::GRIND_TIME_S)].add(motor_time_ms / 1000.0f);
+        quantiles[static_cast<uint8_t>(StatisticsMetric::PULSES)].add(pulse_count);
+    }
+
+    publish_update_locked();
 }
 
 void StatisticsManager::update_motor_test(uint32_t duration_ms) {
@@ -115,8 +252,7 @@ void StatisticsManager::update_motor_test(uint32_t duration_ms) {
 
     StatsLockGuard lock(g_stats_mutex);
     add_motor_runtime_ms_locked(duration_ms);
-    mark_dirty_locked();
-    persist_locked(true);
+    publish_update_locked();
 }
 
 void StatisticsManager::update_time_pulse() {
@@ -126,28 +262,7 @@ void StatisticsManager::update_time_pulse() {
 
     snapshot_.time_pulses++;
     add_motor_runtime_ms_locked(kPulseDurationMs);
-    mark_dirty_locked();
-    pending_pulse_flush_counter_++;
-
-    uint32_t now = millis();
-    bool flush_due = pending_pulse_flush_counter_ >= kPulseFlushThreshold;
-    if (!flush_due && dirty_) {
-        uint32_t elapsed = now - last_flush_ms_;
-        flush_due = elapsed >= kMaxFlushIntervalMs;
-    }
-
-    bool flushed = persist_locked(flush_due);
-    if (flushed || (dirty_ && (now - last_flush_ms_) >= kMinFlushIntervalMs)) {
-        // Avoid holding onto dirty data for too long even if we skipped flushing
-        if (!flushed) {
-            persist_locked(true);
-            flushed = true;
-        }
-    }
-
-    if (flushed) {
-        pending_pulse_flush_counter_ = 0;
-    }
+    publish_update_locked();
 }
 
 void StatisticsManager::update_uptime(uint32_t minutes_to_add) {
@@ -155,113 +270,126 @@ void StatisticsManager::update_uptime(uint32_t minutes_to_add) {
 
     StatsLockGuard lock(g_stats_mutex);
     add_uptime_minutes_locked(minutes_to_add);
-    mark_dirty_locked();
-    persist_locked(true);
+    publish_update_locked();
+}
+
+template <typename Reader>
+void StatisticsManager::read_published(Reader reader) const {
+    // The writer fills the other buffer while the sequence is odd and only comes back to this one
+    // two publishes later, so the copy is whole unless the sequence has passed that point
+    uint32_t before;
+    uint32_t after;
+    do {
+        before = publish_seq_.load(std::memory_order_acquire);
+        reader(published_[(before >> 1) & 1]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = publish_seq_.load(std::memory_order_relaxed);
+    } while (after - (before & ~1u) > 2);
+}
+
+template <typename T>
+T StatisticsManager::read_field(T StatisticsSnapshot::*field) const {
+    T value{};
+    read_published([&](const StatisticsSnapshot& snapshot) { value = snapshot.*field; });
+    return value;
+}
+
+void StatisticsManager::get_snapshot(StatisticsSnapshot* out) const {
+    read_published([out](const StatisticsSnapshot& snapshot) { *out = snapshot; });
 }
 
 uint32_t StatisticsManager::get_total_grinds() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.total_grinds;
+    return read_field(&StatisticsSnapshot::total_grinds);
 }
 
 uint32_t StatisticsManager::get_single_shots() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.single_shots;
+    return read_field(&StatisticsSnapshot::single_shots);
 }
 
 uint32_t StatisticsManager::get_double_shots() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.double_shots;
+    return read_field(&StatisticsSnapshot::double_shots);
 }
 
 uint32_t StatisticsManager::get_custom_shots() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.custom_shots;
+    return read_field(&StatisticsSnapshot::custom_shots);
 }
 
 uint32_t StatisticsManager::get_motor_runtime_sec() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.motor_runtime_sec;
+    return read_field(&StatisticsSnapshot::motor_runtime_sec);
 }
 
 uint64_t StatisticsManager::get_motor_runtime_ms() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return (static_cast<uint64_t>(snapshot_.motor_runtime_sec) * 1000ULL) +
-           static_cast<uint64_t>(snapshot_.motor_runtime_ms_remainder);
+    uint64_t runtime_ms = 0;
+    read_published([&](const StatisticsSnapshot& snapshot) { runtime_ms = snapshot.motor_runtime_ms(); });
+    return runtime_ms;
 }
 
 uint32_t StatisticsManager::get_device_uptime_hrs() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.device_uptime_hrs;
+    return read_field(&StatisticsSnapshot::device_uptime_hrs);
 }
 
 uint32_t StatisticsManager::get_device_uptime_min_remainder() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.device_uptime_min_remainder;
+    return read_field(&StatisticsSnapshot::device_uptime_min_remainder);
 }
 
 float StatisticsManager::get_total_weight_kg() const {
-    if (!initialized_) return 0.0f;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.total_weight_kg;
+    return read_field(&StatisticsSnapshot::total_weight_kg);
 }
 
 uint32_t StatisticsManager::get_weight_mode_grinds() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.weight_mode_grinds;
+    return read_field(&StatisticsSnapshot::weight_mode_grinds);
 }
 
 uint32_t StatisticsManager::get_time_mode_grinds() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.time_mode_grinds;
+    return read_field(&StatisticsSnapshot::time_mode_grinds);
 }
 
 uint32_t StatisticsManager::get_time_pulses() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.time_pulses;
+    return read_field(&StatisticsSnapshot::time_pulses);
 }
 
 float StatisticsManager::get_avg_accuracy_g() const {
-    if (!initialized_) return 0.0f;
-    StatsLockGuard lock(g_stats_mutex);
-    if (snapshot_.accuracy_sample_count == 0) return 0.0f;
-    return snapshot_.accuracy_sum / static_cast<float>(snapshot_.accuracy_sample_count);
+    float average = 0.0f;
+    read_published([&](const StatisticsSnapshot& snapshot) { average = snapshot.avg_accuracy_g(); });
+    return average;
 }
 
 uint32_t StatisticsManager::get_total_pulses() const {
-    if (!initialized_) return 0;
-    StatsLockGuard lock(g_stats_mutex);
-    return snapshot_.total_pulses;
+    return read_field(&StatisticsSnapshot::total_pulses);
 }
 
 float StatisticsManager::get_avg_pulses() const {
-    if (!initialized_) return 0.0f;
-    StatsLockGuard lock(g_stats_mutex);
-    if (snapshot_.pulse_sample_count == 0) return 0.0f;
-    return snapshot_.pulse_sum / static_cast<float>(snapshot_.pulse_sample_count);
+    float average = 0.0f;
+    read_published([&](const StatisticsSnapshot& snapshot) { average = snapshot.avg_pulses(); });
+    return average;
+}
+
+bool StatisticsManager::get_percentiles(uint8_t profile_set, StatisticsMetric metric, float* p50, float* p95) const {
+    if (profile_set >= kStatisticsQuantileSets || metric >= StatisticsMetric::COUNT) return false;
+    StreamingQuantiles quantiles;
+    read_published([&](const StatisticsSnapshot& snapshot) { quantiles = snapshot.percentiles(profile_set, metric); });
+    if (quantiles.empty()) return false;
+    if (p50) *p50 = quantiles.p50();
+    if (p95) *p95 = quantiles.p95();
+    return true;
+}
+
+uint32_t StatisticsManager::get_percentile_samples(uint8_t profile_set, StatisticsMetric metric) const {
+    if (profile_set >= kStatisticsQuantileSets || metric >= StatisticsMetric::COUNT) return 0;
+    uint32_t count = 0;
+    read_published([&](const StatisticsSnapshot& snapshot) { count = snapshot.percentiles(profile_set, metric).count; });
+    return count;
 }
 
 void StatisticsManager::reset_all() {
     if (!initialized_) return;
 
-    StatsLockGuard lock(g_stats_mutex);
-    std::memset(&snapshot_, 0, sizeof(snapshot_));
-    snapshot_.version = StatisticsSnapshot::kVersion;
-    dirty_ = true;
-    pending_pulse_flush_counter_ = 0;
-    persist_locked(true);
-    last_flush_ms_ = millis();
+    {
+        StatsLockGuard lock(g_stats_mutex);
+        snapshot_ = StatisticsSnapshot{};
+        publish_update_locked();
+    }
+    persist(true);
 }
 
 void StatisticsManager::reset_statistics_only() {
@@ -269,18 +397,22 @@ void StatisticsManager::reset_statistics_only() {
 }
 
 void StatisticsManager::load_from_storage() {
-    std::memset(&snapshot_, 0, sizeof(snapshot_));
-    snapshot_.version = StatisticsSnapshot::kVersion;
+    snapshot_ = StatisticsSnapshot{};
 
     Preferences stats_prefs;
     stats_prefs.begin("stats", false);
 
-    size_t stored_size = stats_prefs.getBytesLength("snapshot");
+    size_t stored_size = stats_prefs.getBytesLength(snapshot_key_);
     if (stored_size == sizeof(StatisticsSnapshot)) {
-        stats_prefs.getBytes("snapshot", &snapshot_, sizeof(StatisticsSnapshot));
+        stats_prefs.getBytes(snapshot_key_, &snapshot_, sizeof(StatisticsSnapshot));
+    } else if (stored_size == sizeof(StatisticsSnapshotV2)) {
+        StatisticsSnapshotV2 legacy_snapshot = {};
+        stats_prefs.getBytes(snapshot_key_, &legacy_snapshot, sizeof(StatisticsSnapshotV2));
+        upgrade_snapshot_v2(legacy_snapshot, &snapshot_);
+        stats_prefs.putBytes(snapshot_key_, &snapshot_, sizeof(StatisticsSnapshot));
     } else if (stored_size == sizeof(StatisticsSnapshotV1)) {
         StatisticsSnapshotV1 legacy_snapshot = {};
-        stats_prefs.getBytes("snapshot", &legacy_snapshot, sizeof(StatisticsSnapshotV1));
+        stats_prefs.getBytes(snapshot_key_, &legacy_snapshot, sizeof(StatisticsSnapshotV1));
 
         snapshot_.version = StatisticsSnapshot::kVersion;
         snapshot_.total_grinds = legacy_snapshot.total_grinds;
@@ -302,15 +434,64 @@ void StatisticsManager::load_from_storage() {
         snapshot_.pulse_sum = legacy_snapshot.pulse_sum;
 
         dirty_ = true;
-        stats_prefs.putBytes("snapshot", &snapshot_, sizeof(StatisticsSnapshot));
+        stats_prefs.putBytes(snapshot_key_, &snapshot_, sizeof(StatisticsSnapshot));
     } else {
-        migrate_from_legacy(stats_prefs);
-        stats_prefs.putBytes("snapshot", &snapshot_, sizeof(StatisticsSnapshot));
+        // The key-per-stat layout predates grinder channels; it is grinder 1's
+        if (grinder_channel_ == 0) {
+            migrate_from_legacy(stats_prefs);
+        }
+        stats_prefs.putBytes(snapshot_key_, &snapshot_, sizeof(StatisticsSnapshot));
     }
 
     stats_prefs.end();
     dirty_ = false;
-    pending_pulse_flush_counter_ = 0;
+}
+
+// Applies journal records newer than the NVS checkpoint; true when the journal needs a checkpoint
+bool StatisticsManager::load_journal() {
+    journal_records_ = 0;
+    File journal = LittleFS.open(journal_path_, "r");
+    if (!journal) {
+        return false;
+    }
+
+    // Records are appended in sequence order; a torn or damaged record ends the journal.
+    // A journal written before v3 holds v2 records; they upgrade like the NVS blob.
+    StatisticsJournalRecord& record = g_journal_record;
+    StatisticsJournalRecordV2 legacy_record;
+    bool damaged = false;
+    uint32_t applied = 0;
+    uint32_t legacy_records = 0;
+    while (journal.available() > 0) {
+        uint32_t magic = 0;
+        if (journal.read((uint8_t*)&magic, sizeof(magic)) != sizeof(magic)) {
+            damaged = true;
+            break;
+        }
+        if (magic == kJournalMagicV2 && read_journal_record(journal, magic, &legacy_record)) {
+            upgrade_snapshot_v2(legacy_record.snapshot, &record.snapshot);
+            legacy_records++;
+        } else if (magic != kJournalMagic || !read_journal_record(journal, magic, &record)) {
+            damaged = true;
+            break;
+        }
+        journal_records_++;
+        if (record.snapshot.sequence > snapshot_.sequence) {
+            snapshot_ = record.snapshot;
+            applied++;
+        }
+    }
+    journal.close();
+
+    if (applied > 0) {
+        LOG_BLE("Statistics: applied %lu journal records after the NVS checkpoint\n", (unsigned long)applied);
+    }
+    // Later appends would land behind the damage and be unreachable, v2 records must not mix with
+    // v3 appends, and a full journal is due anyway
+    if (damaged) {
+        LOG_BLE("WARNING: Statistics journal damaged after %lu records, checkpointing\n", (unsigned long)journal_records_);
+    }
+    return damaged || legacy_records > 0 || journal_records_ >= kJournalMaxRecords;
 }
 
 void StatisticsManager::migrate_from_legacy(Preferences& stats_prefs) {
@@ -369,29 +550,87 @@ void StatisticsManager::add_uptime_minutes_locked(uint32_t minutes_to_add) {
     }
 }
 
-bool StatisticsManager::persist_locked(bool force) {
-    if (!dirty_) {
-        return false;
+void StatisticsManager::persist(bool force_checkpoint) {
+    StatsLockGuard persist_lock(g_persist_mutex);
+    {
+        StatsLockGuard lock(g_stats_mutex);
+        if (!dirty_ && !force_checkpoint) {
+            return;
+        }
+        persist_buffer_ = snapshot_;
+        dirty_ = false;
     }
 
-    uint32_t now = millis();
-    if (!force) {
-        uint32_t elapsed = now - last_flush_ms_;
-        if (elapsed < kMinFlushIntervalMs) {
-            return false;
-        }
+    // Flash writes run on the copy; updates meanwhile mark the snapshot dirty again
+    persist_buffer_.sequence++;
+    bool written = false;
+    if (!force_checkpoint && journal_records_ + 1 < kJournalMaxRecords) {
+        written = append_journal(persist_buffer_);
+    }
+    // A full journal is due for a checkpoint; without the filesystem the NVS checkpoint still holds the totals
+    if (!written) {
+        written = write_checkpoint(persist_buffer_);
     }
 
+    StatsLockGuard lock(g_stats_mutex);
+    if (written) {
+        snapshot_.sequence = persist_buffer_.sequence;
+    } else if (!dirty_) {
+        dirty_ = true;
+        dirty_since_ms_ = millis();
+    }
+}
+
+bool StatisticsManager::append_journal(const StatisticsSnapshot& snapshot) {
+    StatisticsJournalRecord& record = g_journal_record;
+    record.magic = kJournalMagic;
+    record.snapshot = snapshot;
+    record.crc = journal_record_crc(record);
+
+    File journal = LittleFS.open(journal_path_, "a");
+    bool written = journal && journal.write((const uint8_t*)&record, sizeof(record)) == sizeof(record);
+    if (journal) {
+        journal.close();
+    }
+    if (written) {
+        journal_records_++;
+    }
+    return written;
+}
+
+bool StatisticsManager::write_checkpoint(const StatisticsSnapshot& snapshot) {
     Preferences stats_prefs;
     stats_prefs.begin("stats", false);
-    stats_prefs.putBytes("snapshot", &snapshot_, sizeof(StatisticsSnapshot));
+    bool written = stats_prefs.putBytes(snapshot_key_, &snapshot, sizeof(StatisticsSnapshot)) == sizeof(StatisticsSnapshot);
     stats_prefs.end();
+    if (!written) {
+        LOG_BLE("ERROR: Failed to checkpoint statistics to NVS\n");
+        return false;
+    }
 
-    dirty_ = false;
-    last_flush_ms_ = now;
+    // Every journal record is now at or below the checkpoint sequence
+    if (LittleFS.exists(journal_path_)) {
+        LittleFS.remove(journal_path_);
+    }
+    journal_records_ = 0;
     return true;
 }
 
-void StatisticsManager::mark_dirty_locked() {
+// Every update ends here: readers see it at once, flash once the grinder is idle
+void StatisticsManager::publish_update_locked() {
+    publish_locked();
+    uint32_t now = millis();
+    if (!dirty_) {
+        dirty_since_ms_ = now;
+    }
     dirty_ = true;
+    last_update_ms_ = now;
+}
+
+void StatisticsManager::publish_locked() {
+    uint32_t seq = publish_seq_.load(std::memory_order_relaxed);
+    publish_seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published_[((seq >> 1) + 1) & 1] = snapshot_;
+    publish_seq_.store(seq + 2, std::memory_order_release);
 }
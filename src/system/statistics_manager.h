@@ -1,10 +1,26 @@
 #pragma once
 #include <Preferences.h>
+#include <atomic>
 #include <cstdint>
+#include "../config/constants.h"
+#include "../config/user.h"
+#include "streaming_quantiles.h"
+
+// Per-session metrics with streaming p50/p95 in the snapshot
+enum class StatisticsMetric : uint8_t {
+    ABS_ERROR_G = 0,    // Weight-mode grinds only
+    GRIND_TIME_S,
+    PULSES,
+    COUNT
+};
+
+// Quantile sets: one per profile, then one over all profiles
+constexpr uint8_t kStatisticsAllProfiles = USER_PROFILE_COUNT;
+constexpr uint8_t kStatisticsQuantileSets = USER_PROFILE_COUNT + 1;
 
 // Represents the persistent snapshot of lifetime statistics.
 struct StatisticsSnapshot {
-    static constexpr uint32_t kVersion = 2;
+    static constexpr uint32_t kVersion = 3;
 
     uint32_t version = kVersion;
     uint32_t total_grinds = 0;
@@ -24,24 +40,61 @@ struct StatisticsSnapshot {
     float accuracy_sum = 0.0f;
     uint32_t pulse_sample_count = 0;
     float pulse_sum = 0.0f;
-    uint32_t reserved0 = 0; // Reserved for future expansion / alignment
+    uint32_t sequence = 0;  // Journal record number of this snapshot (was reserved0, 0 before journaling)
     uint32_t reserved1 = 0;
+    // v3: appended, so a v2 snapshot is a prefix of this one
+    StreamingQuantiles quantiles[kStatisticsQuantileSets][static_cast<uint8_t>(StatisticsMetric::COUNT)] = {};
+
+    uint64_t motor_runtime_ms() const {
+        return static_cast<uint64_t>(motor_runtime_sec) * 1000ULL + motor_runtime_ms_remainder;
+    }
+    float avg_accuracy_g() const {
+        return accuracy_sample_count ? accuracy_sum / static_cast<float>(accuracy_sample_count) : 0.0f;
+    }
+    float avg_pulses() const {
+        return pulse_sample_count ? pulse_sum / static_cast<float>(pulse_sample_count) : 0.0f;
+    }
+    const StreamingQuantiles& percentiles(uint8_t profile_set, StatisticsMetric metric) const {
+        return quantiles[profile_set][static_cast<uint8_t>(metric)];
+    }
 };
 
-// Manages lifetime statistics stored in NVS (Preferences namespace: "stats")
-// Tracks usage, mode-specific, and quality/performance metrics across reboots.
+#define STATISTICS_JOURNAL_FILE "/stats_journal.bin"
+
+// Manages lifetime statistics across reboots: usage, mode-specific, and quality/performance metrics.
+// Quality metrics keep means (sums and counts) plus streaming p50/p95 per profile, so percentiles
+// never need the session logs.
+// Updates only change the RAM snapshot. FileIOTask calls service() every cycle, which appends the
+// snapshot to a LittleFS journal once the grinder has been idle for a few seconds, so no flash write
+// sits on the end-of-grind path. Each record carries a sequence number and CRC; every
+// kJournalMaxRecords records the snapshot is checkpointed to NVS (namespace "stats", blob "snapshot")
+// and the journal restarts. Boot takes the NVS checkpoint, then the newest valid journal record
+// after it. flush() writes pending updates immediately (before a restart).
+//
+// Each grinder channel keeps its own totals: statistics_manager is grinder 1 (and the device
+// uptime), channel_statistics() returns the others, whose checkpoint key and journal carry the
+// channel ("snapshot_ch2", "/stats_journal_ch2.bin").
+//
+// Readers never take the update lock: every update publishes a copy of the snapshot into one of two
+// buffers under a sequence counter (odd while a buffer is being written). get_snapshot() and the
+// getters copy from the stable buffer and retry only if the writer came back around to it, so they
+// never wait for an update or a flash write. Persistence copies the snapshot under the update lock
+// and writes the copy after releasing it; a separate lock orders the flash writers.
 class StatisticsManager {
 public:
-    void init(Preferences* prefs);
+    void init(Preferences* prefs, uint8_t grinder_channel = 0);
+    void service(uint32_t now_ms, bool idle);
+    void flush();
 
     // Update methods - called by various system components
     void update_grind_session(float final_weight, float error_grams, uint8_t pulse_count,
-                              bool is_weight_mode, uint32_t motor_time_ms);
+                              bool is_weight_mode, uint32_t motor_time_ms, uint8_t profile_id);
     void update_motor_test(uint32_t duration_ms);
     void update_time_pulse();
     void update_uptime(uint32_t minutes_to_add);
 
-    // Retrieval methods
+    // Retrieval methods, lock-free. Read several values from one get_snapshot() so they agree.
+    void get_snapshot(StatisticsSnapshot* out) const;
     uint32_t get_total_grinds() const;
     uint32_t get_single_shots() const;
     uint32_t get_double_shots() const;
@@ -57,6 +110,9 @@ public:
     float get_avg_accuracy_g() const;
     uint32_t get_total_pulses() const;
     float get_avg_pulses() const;
+    // Streaming p50/p95 for a profile, or kStatisticsAllProfiles; false before the first sample
+    bool get_percentiles(uint8_t profile_set, StatisticsMetric metric, float* p50, float* p95) const;
+    uint32_t get_percentile_samples(uint8_t profile_set, StatisticsMetric metric) const;
 
     // Reset operations
     void reset_all();             // Clear all statistics (factory reset)
@@ -67,15 +123,35 @@ private:
     void migrate_from_legacy(Preferences& stats_prefs);
     void add_motor_runtime_ms_locked(uint32_t additional_ms);
     void add_uptime_minutes_locked(uint32_t minutes_to_add);
-    bool persist_locked(bool force);
-    void mark_dirty_locked();
+    bool load_journal();
+    void persist(bool force_checkpoint);
+    bool append_journal(const StatisticsSnapshot& snapshot);
+    bool write_checkpoint(const StatisticsSnapshot& snapshot);
+    void publish_update_locked();
+    void publish_locked();
+    template <typename Reader> void read_published(Reader reader) const;
+    template <typename T> T read_field(T StatisticsSnapshot::*field) const;
 
     bool initialized_ = false;
-    mutable StatisticsSnapshot snapshot_{};
+    uint8_t grinder_channel_ = 0;
+    char snapshot_key_[16] = "snapshot";        // NVS checkpoint blob in namespace "stats"
+    char journal_path_[32] = STATISTICS_JOURNAL_FILE;
+    StatisticsSnapshot snapshot_{};             // Working copy, under the update lock
     bool dirty_ = false;
-    uint32_t last_flush_ms_ = 0;
-    uint32_t pending_pulse_flush_counter_ = 0;
+    uint32_t dirty_since_ms_ = 0;
+    uint32_t last_update_ms_ = 0;
+
+    // Reader side: published_[(publish_seq_ >> 1) & 1] is stable
+    StatisticsSnapshot published_[2] = {};
+    std::atomic<uint32_t> publish_seq_{0};
+
+    // Flash writers, under the persist lock
+    StatisticsSnapshot persist_buffer_{};
+    uint32_t journal_records_ = 0;
 };
 
-// Global instance
+// Global instance: grinder channel 0
 extern StatisticsManager statistics_manager;
+
+// A grinder channel's statistics (statistics_manager for channel 0 and out-of-range channels)
+StatisticsManager& channel_statistics(uint8_t grinder_channel);
@@ -0,0 +1,208 @@
+#include "storage_benchmark.h"
+
+#include <LittleFS.h>
+#include <esp_cpu.h>
+#include <esp_heap_caps.h>
+#include "../config/constants.h"
+
+#if FEATURE_DEBUG_TOOLS
+
+StorageBenchmark storage_benchmark;
+
+namespace {
+const uint16_t kDirectoryLevels[] = { 10, 100, 1000 };
+const char* const kSessionFile = SYS_STORAGE_BENCHMARK_DIR "/session.bin";
+const char* const kFilesDir = SYS_STORAGE_BENCHMARK_DIR "/files";
+
+// LittleFS.mkdir fails on a directory a reset left behind
+bool make_directory(const char* path) {
+    return LittleFS.mkdir(path) || LittleFS.exists(path);
+}
+
+// Cycle counts, which the host build runs on the wall clock; each call times one file
+// operation, so the 32-bit counter cannot wrap within it
+float elapsed_ms(uint32_t start_cycles) {
+    return (float)(esp_cpu_get_cycle_count() - start_cycles) / (float)getCpuFrequencyMhz() / 1000.0f;
+}
+
+float kb_per_s(size_t bytes, float ms) {
+    return ms > 0.0f ? (float)bytes / 1024.0f / (ms / 1000.0f) : 0.0f;
+}
+
+void file_path(char* out, size_t out_size, uint16_t index) {
+    snprintf(out, out_size, "%s/f%04u", kFilesDir, (unsigned)index);
+}
+} // namespace
+
+bool StorageBenchmark::run(bool (*should_stop)()) {
+    uint8_t* buffer = (uint8_t*)heap_caps_malloc(SYS_STORAGE_BENCHMARK_READ_BYTES, MALLOC_CAP_SPIRAM);
+    if (!buffer) {
+        LOG_BLE("[STORAGE_BENCHMARK] Not started: no memory for a %u byte buffer\n", (unsigned)SYS_STORAGE_BENCHMARK_READ_BYTES);
+        return false;
+    }
+    if (!make_directory(SYS_STORAGE_BENCHMARK_DIR) || !make_directory(kFilesDir)) {
+        LOG_BLE("[STORAGE_BENCHMARK] Not started: cannot create %s\n", kFilesDir);
+        heap_caps_free(buffer);
+        return false;
+    }
+
+    LOG_BLE("=== Storage benchmark: LittleFS, %lu of %lu KB used ===\n",
+            (unsigned long)(LittleFS.usedBytes() / 1024), (unsigned long)(LittleFS.totalBytes() / 1024));
+    if (mount_time_us > 0) {
+        LOG_BLE("  mount at boot: %.1f ms\n", (float)mount_time_us / 1000.0f);
+    }
+
+    bool stopped = false;
+    if (run_session_write(buffer)) {
+        run_read(buffer);
+    }
+    LittleFS.remove(kSessionFile);
+
+    uint16_t files = 0;
+    for (uint16_t level : kDirectoryLevels) {
+        if (should_stop && should_stop()) {
+            stopped = true;
+            break;
+        }
+        size_t free_bytes = LittleFS.totalBytes() - LittleFS.usedBytes();
+        if (free_bytes < SYS_STORAGE_BENCHMARK_MIN_FREE_BYTES) {
+            LOG_BLE("  directory of %u files: skipped, %lu KB free\n", (unsigned)level, (unsigned long)(free_bytes / 1024));
+            break;
+        }
+        uint16_t created = run_directory(files, level, should_stop);
+        files = created;
+        if (created < level) {
+            stopped = should_stop && should_stop();
+            break;
+        }
+    }
+    remove_files(files);
+    LittleFS.rmdir(kFilesDir);
+    LittleFS.rmdir(SYS_STORAGE_BENCHMARK_DIR);
+
+    if (stopped) {
+        LOG_BLE("  stopped: a grind started\n");
+    }
+    LOG_BLE("==========================================================\n");
+    heap_caps_free(buffer);
+    return !stopped;
+}
+
+bool StorageBenchmark::run_session_write(uint8_t* buffer) {
+    for (size_t i = 0; i < SYS_STORAGE_BENCHMARK_APPEND_BYTES; i++) {
+        buffer[i] = (uint8_t)(i * 31u + 7u);
+    }
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    File file = LittleFS.open(kSessionFile, "w");
+    float open_ms = elapsed_ms(start);
+    if (!file) {
+        LOG_BLE("  session write: cannot create %s\n", kSessionFile);
+        return false;
+    }
+
+    float write_ms = 0.0f;
+    float worst_append_ms = 0.0f;
+    size_t written = 0;
+    while (written < SYS_STORAGE_BENCHMARK_SESSION_BYTES) {
+        start = esp_cpu_get_cycle_count();
+        size_t size = file.write(buffer, SYS_STORAGE_BENCHMARK_APPEND_BYTES);
+        float append_ms = elapsed_ms(start);
+        if (size != SYS_STORAGE_BENCHMARK_APPEND_BYTES) {
+            break;
+        }
+        write_ms += append_ms;
+        worst_append_ms = append_ms > worst_append_ms ? append_ms : worst_append_ms;
+        written += size;
+    }
+    start = esp_cpu_get_cycle_count();
+    file.close();
+    float close_ms = elapsed_ms(start);
+
+    if (written < SYS_STORAGE_BENCHMARK_SESSION_BYTES) {
+        LOG_BLE("  session write: stopped after %lu bytes (partition full?)\n", (unsigned long)written);
+        return false;
+    }
+    LOG_BLE("  session write %lu KB in %u B appends: open %.1f ms, writes %.1f ms (%.0f KB/s, worst %.1f ms), close %.1f ms\n",
+            (unsigned long)(written / 1024), (unsigned)SYS_STORAGE_BENCHMARK_APPEND_BYTES, open_ms, write_ms,
+            kb_per_s(written, write_ms + close_ms), worst_append_ms, close_ms);
+    return true;
+}
+
+bool StorageBenchmark::run_read(uint8_t* buffer) {
+    uint32_t start = esp_cpu_get_cycle_count();
+    File file = LittleFS.open(kSessionFile, "r");
+    float read_ms = elapsed_ms(start);
+    if (!file) {
+        LOG_BLE("  read: cannot open %s\n", kSessionFile);
+        return false;
+    }
+    size_t total = 0;
+    while (true) {
+        start = esp_cpu_get_cycle_count();
+        size_t size = file.read(buffer, SYS_STORAGE_BENCHMARK_READ_BYTES);
+        read_ms += elapsed_ms(start);
+        if (size == 0) {
+            break;
+        }
+        total += size;
+    }
+    start = esp_cpu_get_cycle_count();
+    file.close();
+    read_ms += elapsed_ms(start);
+    LOG_BLE("  read %lu KB in %u B reads: %.1f ms (%.0f KB/s)\n", (unsigned long)(total / 1024),
+            (unsigned)SYS_STORAGE_BENCHMARK_READ_BYTES, read_ms, kb_per_s(total, read_ms));
+    return total > 0;
+}
+
+uint16_t StorageBenchmark::run_directory(uint16_t existing, uint16_t files, bool (*should_stop)()) {
+    char path[48];
+    float create_ms = 0.0f;
+    uint16_t created = existing;
+    while (created < files) {
+        if ((created % 50) == 0 && should_stop && should_stop()) {
+            return created;
+        }
+        file_path(path, sizeof(path), created);
+        uint32_t start = esp_cpu_get_cycle_count();
+        File file = LittleFS.open(path, "w");
+        if (!file) {
+            LOG_BLE("  directory of %u files: cannot create file %u\n", (unsigned)files, (unsigned)created);
+            return created;
+        }
+        file.close();
+        create_ms += elapsed_ms(start);
+        created++;
+    }
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    float scan_ms = 0.0f;
+    uint16_t listed = 0;
+    File dir = LittleFS.open(kFilesDir);
+    if (dir && dir.isDirectory()) {
+        File entry = dir.openNextFile();
+        while (entry) {
+            listed++;
+            entry.close();
+            scan_ms += elapsed_ms(start);
+            start = esp_cpu_get_cycle_count();
+            entry = dir.openNextFile();
+        }
+        dir.close();
+    }
+    scan_ms += elapsed_ms(start);
+
+    LOG_BLE("  directory of %4u files: scan %.1f ms (%u listed), create %.2f ms/file\n", (unsigned)files, scan_ms,
+            (unsigned)listed, create_ms / (float)(files - existing));
+    return created;
+}
+
+void StorageBenchmark::remove_files(uint16_t count) {
+    char path[48];
+    for (uint16_t i = 0; i < count; i++) {
+        file_path(path, sizeof(path), i);
+        LittleFS.remove(path);
+    }
+}
+
+#endif // FEATURE_DEBUG_TOOLS
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * StorageBenchmark - LittleFS timings behind session logging and the small stores
+ *
+ * Reports the boot mount time (taken by boot_core0_job, set_mount_time_us()),
+ * then works in SYS_STORAGE_BENCHMARK_DIR: a SYS_STORAGE_BENCHMARK_SESSION_BYTES
+ * file appended in SYS_STORAGE_BENCHMARK_APPEND_BYTES writes as a file-backed
+ * session is (open, total, worst append, close), read back for throughput, and
+ * a directory of 10, 100 and 1000 empty files listed with openNextFile() as the
+ * session index rebuild does. A level is skipped when the partition has less
+ * than SYS_STORAGE_BENCHMARK_MIN_FREE_BYTES free. Everything it creates is
+ * removed again, and the table is logged when it ends. File operations are
+ * timed one at a time in CPU cycles, which the host build counts on the wall
+ * clock (native_sim::set_wall_cycle_count).
+ *
+ * On the device it runs in FileIOTask with the grinder idle (no other file
+ * work interleaves), started by BLE_DEBUG_CMD_STORAGE_BENCHMARK; a grind that
+ * starts meanwhile stops it at the next step. The host build runs it with
+ * --storage-bench against the fs root.
+ */
+class StorageBenchmark {
+public:
+    void request() { requested.store(true, std::memory_order_relaxed); }
+    bool take_request() { return requested.exchange(false, std::memory_order_relaxed); }
+
+    void set_mount_time_us(uint32_t us) { mount_time_us = us; }
+    uint32_t get_mount_time_us() const { return mount_time_us; }
+
+    // Blocks for seconds; should_stop (may be nullptr) is polled between steps
+    bool run(bool (*should_stop)());
+
+private:
+    std::atomic<bool> requested{false};
+    uint32_t mount_time_us = 0;
+
+    bool run_session_write(uint8_t* buffer);
+    bool run_read(uint8_t* buffer);
+    uint16_t run_directory(uint16_t existing, uint16_t files, bool (*should_stop)());
+    void remove_files(uint16_t count);
+};
+
+extern StorageBenchmark storage_benchmark;
@@ -0,0 +1,95 @@
+#include "streaming_quantiles.h"
+
+namespace {
+// Marker fractions: both targets, the midpoints around them, and the extremes
+const float kMarkerFractions[StreamingQuantiles::kMarkers] = {0.0f, 0.25f, 0.5f, 0.725f, 0.95f, 0.975f, 1.0f};
+const uint8_t kP50Marker = 2;
+const uint8_t kP95Marker = 4;
+} // namespace
+
+void StreamingQuantiles::add(float value) {
+    if (count < kMarkers) {
+        // Insertion into the exact sorted prefix
+        uint8_t i = (uint8_t)count;
+        while (i > 0 && heights[i - 1] > value) {
+            heights[i] = heights[i - 1];
+            i--;
+        }
+        heights[i] = value;
+        count++;
+        positions[count - 1] = count;
+        return;
+    }
+
+    // Cell of the new value; the extremes absorb values beyond them
+    uint8_t cell;
+    if (value < heights[0]) {
+        heights[0] = value;
+        cell = 0;
+    } else if (value >= heights[kMarkers - 1]) {
+        heights[kMarkers - 1] = value;
+        cell = kMarkers - 2;
+    } else {
+        cell = 0;
+        while (cell < kMarkers - 2 && value >= heights[cell + 1]) {
+            cell++;
+        }
+    }
+    for (uint8_t i = cell + 1; i < kMarkers; i++) {
+        positions[i]++;
+    }
+    count++;
+
+    for (uint8_t i = 1; i < kMarkers - 1; i++) {
+        const float desired = 1.0f + (float)(count - 1) * kMarkerFractions[i];
+        const float offset = desired - (float)positions[i];
+        const int32_t gap_up = (int32_t)(positions[i + 1] - positions[i]);
+        const int32_t gap_down = (int32_t)(positions[i] - positions[i - 1]);
+        if ((offset >= 1.0f && gap_up > 1) || (offset <= -1.0f && gap_down > 1)) {
+            const int32_t step = offset > 0.0f ? 1 : -1;
+            float height = parabolic(i, step);
+            if (!(heights[i - 1] < height && height < heights[i + 1])) {
+                height = linear(i, step);
+            }
+            heights[i] = height;
+            positions[i] += step;
+        }
+    }
+}
+
+float StreamingQuantiles::p50() const {
+    return count <= kMarkers ? exact_quantile(kMarkerFractions[kP50Marker]) : heights[kP50Marker];
+}
+
+float StreamingQuantiles::p95() const {
+    return count <= kMarkers ? exact_quantile(kMarkerFractions[kP95Marker]) : heights[kP95Marker];
+}
+
+float StreamingQuantiles::exact_quantile(float fraction) const {
+    if (count == 0) {
+        return 0.0f;
+    }
+    const float rank = fraction * (float)(count - 1);
+    const uint32_t below = (uint32_t)rank;
+    if (below + 1 >= count) {
+        return heights[count - 1];
+    }
+    return heights[below] + (rank - (float)below) * (heights[below + 1] - heights[below]);
+}
+
+float StreamingQuantiles::parabolic(uint8_t marker, int32_t step) const {
+    const float n_prev = (float)positions[marker - 1];
+    const float n = (float)positions[marker];
+    const float n_next = (float)positions[marker + 1];
+    const float s = (float)step;
+    return heights[marker] +
+           s / (n_next - n_prev) *
+               ((n - n_prev + s) * (heights[marker + 1] - heights[marker]) / (n_next - n) +
+                (n_next - n - s) * (heights[marker] - heights[marker - 1]) / (n - n_prev));
+}
+
+float StreamingQuantiles::linear(uint8_t marker, int32_t step) const {
+    const uint8_t neighbour = (uint8_t)(marker + step);
+    return heights[marker] + (float)step * (heights[neighbour] - heights[marker]) /
+                                 ((float)positions[neighbour] - (float)positions[marker]);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * StreamingQuantiles - Median and 95th percentile of a stream in constant memory
+ *
+ * Extended P² (Jain & Chlamtac, generalized by Raatikainen): seven markers
+ * track the minimum, p25, p50, p72.5, p95, p97.5 and the maximum. Each
+ * add() moves the marker positions one step toward their desired ranks and
+ * adjusts the heights along a piecewise-parabolic fit, so the estimate
+ * needs no stored samples and costs a few dozen flops per value. The first
+ * seven values are kept exactly (sorted in heights[]); quantiles up to then
+ * interpolate between them.
+ *
+ * Plain data with an all-zero empty state, so it persists by memcpy inside
+ * StatisticsSnapshot and resets by value-initialisation. Not thread safe; the owner
+ * serializes access.
+ */
+struct StreamingQuantiles {
+    static constexpr uint8_t kMarkers = 7;
+
+    uint32_t count;                     // Values added
+    uint32_t positions[kMarkers];       // Marker ranks, 1-based
+    float heights[kMarkers];            // Marker values
+
+    void add(float value);
+    bool empty() const { return count == 0; }
+    float p50() const;
+    float p95() const;
+
+private:
+    float exact_quantile(float fraction) const;
+    float parabolic(uint8_t marker, int32_t step) const;
+    float linear(uint8_t marker, int32_t step) const;
+};
@@ -0,0 +1,164 @@
+#include "telemetry.h"
+#include "../config/logging.h"
+#include "../hardware/motor_edge_timeline.h"
+
+#include <esp_timer.h>
+
+Telemetry telemetry;
+#if HW_GRINDER_CHANNELS > 1
+static Telemetry extra_channel_telemetry[HW_GRINDER_CHANNELS - 1];    // GrindChannels 1..N-1
+#endif
+
+Telemetry& channel_telemetry(uint8_t grinder_channel) {
+#if HW_GRINDER_CHANNELS > 1
+    if (grinder_channel > 0 && grinder_channel < HW_GRINDER_CHANNELS) {
+        return extra_channel_telemetry[grinder_channel - 1];
+    }
+#else
+    (void)grinder_channel;
+#endif
+    return telemetry;
+}
+
+void Telemetry::start(uint16_t rate_hz) {
+    period_us = rate_hz > 0 ? 1000000UL / rate_hz : 0;
+    next_due_us.store((uint32_t)esp_timer_get_time(), std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    // Frames left over from an earlier stream are skipped, not sent
+    read_seq.store(write_seq.load(std::memory_order_acquire), std::memory_order_release);
+    streaming.store(true, std::memory_order_release);
+    if (rate_hz > 0) {
+        LOG_BLE("TELEMETRY: streaming at %u Hz\n", (unsigned)rate_hz);
+    } else {
+        LOG_BLE("TELEMETRY: streaming every sample\n");
+    }
+}
+
+void Telemetry::stop() {
+    if (!streaming.exchange(false)) {
+        return;
+    }
+    LOG_BLE("TELEMETRY: stopped (%lu frames dropped)\n", (unsigned long)dropped.load(std::memory_order_relaxed));
+}
+
+void Telemetry::set_eta(uint32_t remaining_ms, uint32_t band_ms, bool known) {
+    uint32_t eta_ds = TELEMETRY_ETA_UNKNOWN;
+    uint32_t band_ds = 0;
+    if (known) {
+        eta_ds = remaining_ms / 100 < TELEMETRY_ETA_UNKNOWN ? remaining_ms / 100 : TELEMETRY_ETA_UNKNOWN - 1;
+        band_ds = band_ms / 100 < UINT16_MAX ? band_ms / 100 : UINT16_MAX;
+    }
+    eta.store(band_ds << 16 | eta_ds, std::memory_order_relaxed);
+}
+
+void Telemetry::record(uint32_t timestamp_us, int32_t raw, float weight_g, float flow_gps, bool flow_valid) {
+    // Hold the host rate on average; resync after a gap longer than a period (rate or power mode switch)
+    uint32_t due = next_due_us.load(std::memory_order_relaxed) + period_us;
+    if ((int32_t)(timestamp_us - due) >= 0) {
+        due = timestamp_us + period_us;
+    }
+    next_due_us.store(due, std::memory_order_relaxed);
+
+    uint32_t write = write_seq.load(std::memory_order_relaxed);
+    if (write - read_seq.load(std::memory_order_acquire) >= SYS_TELEMETRY_RING_FRAMES) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    float flow_cgps = flow_gps * 100.0f;
+    flow_cgps = flow_cgps > INT16_MAX ? INT16_MAX : (flow_cgps < INT16_MIN ? INT16_MIN : flow_cgps);
+    MotorEdgeTimeline::Edge edge;
+    bool motor_on = edge_timeline && edge_timeline->get_edge(0, &edge) && MotorEdgeTimeline::is_on_edge(edge.type);
+
+    TelemetryFrame& frame = frames.slot(write);
+    frame.timestamp_us = timestamp_us;
+    frame.raw = raw;
+    frame.weight_g = weight_g;
+    frame.flow_cgps = (int16_t)flow_cgps;
+    frame.phase = phase.load(std::memory_order_relaxed);
+    frame.flags = (motor_on ? TELEMETRY_FLAG_MOTOR_ON : 0) | (flow_valid ? TELEMETRY_FLAG_FLOW_VALID : 0);
+    uint32_t eta_fields = eta.load(std::memory_order_relaxed);
+    frame.eta_ds = (uint16_t)eta_fields;
+    frame.eta_band_ds = (uint16_t)(eta_fields >> 16);
+    write_seq.store(write + 1, std::memory_order_release);
+}
+
+uint32_t Telemetry::get_pending_count() const {
+    return write_seq.load(std::memory_order_acquire) - read_seq.load(std::memory_order_relaxed);
+}
+
+uint32_t Telemetry::frames_per_batch(size_t buffer_size) {
+    if (buffer_size <= HEADER_BYTES) {
+        return 0;
+    }
+    size_t count = (buffer_size - HEADER_BYTES) / sizeof(TelemetryFrame);
+    return count > UINT8_MAX ? UINT8_MAX : (uint32_t)count;
+}
+
+size_t Telemetry::read_batch(uint8_t* buffer, size_t buffer_size) {
+    uint32_t read = read_seq.load(std::memory_order_relaxed);
+    uint32_t count = write_seq.load(std::memory_order_acquire) - read;
+    uint32_t capacity = frames_per_batch(buffer_size);
+    if (count > capacity) {
+        count = capacity;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    uint32_t dropped_frames = dropped.load(std::memory_order_relaxed);
+    uint16_t dropped_field = dropped_frames > UINT16_MAX ? UINT16_MAX : (uint16_t)dropped_frames;
+    buffer[0] = VERSION;
+    buffer[1] = (uint8_t)count;
+    memcpy(buffer + 2, &dropped_field, sizeof(dropped_field));
+    for (uint32_t i = 0; i < count; i++) {
+        memcpy(buffer + HEADER_BYTES + i * sizeof(TelemetryFrame), &frames.slot(read + i), sizeof(TelemetryFrame));
+    }
+    // Hands the slots back to the writer
+    read_seq.store(read + count, std::memory_order_release);
+    return HEADER_BYTES + count * sizeof(TelemetryFrame);
+}
+
+void Telemetry::set_tick_divider(uint8_t divider) {
+    // Ticks from before the lane (re)started are stale
+    tick_read_seq.store(tick_write_seq.load(std::memory_order_acquire), std::memory_order_release);
+    tick_divider.store(divider, std::memory_order_release);
+}
+
+bool Telemetry::read_tick(TelemetryTick* out) {
+    uint32_t read = tick_read_seq.load(std::memory_order_relaxed);
+    if (tick_write_seq.load(std::memory_order_acquire) == read) {
+        return false;
+    }
+    *out = ticks.slot(read);
+    tick_read_seq.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+void Telemetry::record_tick(uint32_t timestamp_ms, float weight_g, float flow_gps, bool motor_on) {
+    uint8_t divider = tick_divider.load(std::memory_order_acquire);
+    if (divider == 0) {
+        return;
+    }
+    if (tick_countdown > 0) {
+        tick_countdown--;
+        return;
+    }
+    tick_countdown = divider - 1;
+
+    uint32_t write = tick_write_seq.load(std::memory_order_relaxed);
+    if (write - tick_read_seq.load(std::memory_order_acquire) >= SYS_TELEMETRY_TICK_RING_ENTRIES) {
+        tick_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    float flow_cgps = flow_gps * 100.0f;
+    flow_cgps = flow_cgps > INT16_MAX ? INT16_MAX : (flow_cgps < INT16_MIN ? INT16_MIN : flow_cgps);
+
+    TelemetryTick& tick = ticks.slot(write);
+    tick.timestamp_ms = timestamp_ms;
+    tick.weight_g = weight_g;
+    tick.flow_cgps = (int16_t)flow_cgps;
+    tick.phase = phase.load(std::memory_order_relaxed);
+    tick.flags = motor_on ? TELEMETRY_FLAG_MOTOR_ON : 0;
+    tick_write_seq.store(write + 1, std::memory_order_release);
+}
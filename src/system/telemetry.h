@@ -0,0 +1,123 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "../config/hardware.h"
+#include "../config/system.h"
+#include "../hardware/ring.h"
+
+class MotorEdgeTimeline;
+
+enum TelemetryFrameFlags : uint8_t {
+    TELEMETRY_FLAG_MOTOR_ON         = 1 << 0,  // Newest motor edge at the sample was a start
+    TELEMETRY_FLAG_FLOW_VALID       = 1 << 1   // Flow came from a converged state estimate
+};
+
+static const uint16_t TELEMETRY_ETA_UNKNOWN = 0xFFFF;
+
+// 20 bytes, little-endian on the wire as in memory
+struct TelemetryFrame {
+    uint32_t timestamp_us;          // esp_timer µs (32-bit) of the load cell sample
+    int32_t raw;                    // Raw ADC counts
+    float weight_g;                 // Latest sample converted to weight
+    int16_t flow_cgps;              // Estimated flow, 0.01 g/s
+    uint8_t phase;                  // GrindPhase
+    uint8_t flags;                  // TelemetryFrameFlags
+    uint16_t eta_ds;                // Predicted time to target, 0.1 s; TELEMETRY_ETA_UNKNOWN outside a session
+    uint16_t eta_band_ds;           // +/- band around eta_ds, 0.1 s
+};
+static_assert(sizeof(TelemetryFrame) == 20, "Telemetry frames are sent as raw 20-byte records");
+
+// One control tick of a running session, for the MQTT publisher
+struct TelemetryTick {
+    uint32_t timestamp_ms;          // Relative to session start, as GrindMeasurement::timestamp_ms
+    float weight_g;                 // Low-latency weight the controller acted on
+    int16_t flow_cgps;              // Flow, 0.01 g/s
+    uint8_t phase;                  // GrindPhase
+    uint8_t flags;                  // TelemetryFrameFlags (TELEMETRY_FLAG_MOTOR_ON)
+};
+
+/**
+ * Telemetry - Live weight samples for a BLE host, batched several per notify
+ *
+ * WeightSamplingTask records a frame per load cell sample (or one per host
+ * period when a rate is set) into a single-producer single-consumer ring; the
+ * BLE task drains it into notifies of [version][count][dropped:2] + frames.
+ * Sequences are published with release/acquire so neither side locks. A full
+ * ring refuses the frame and counts it as dropped rather than overwriting
+ * frames the reader may be copying.
+ *
+ * With no stream running the sampling hook costs one atomic load. The grind
+ * phase and time to target are published by GrindController; motor state is
+ * read from the grinder's edge timeline at record time.
+ *
+ * A second lane of the same kind carries control ticks instead of load cell
+ * samples: GrindController records every tick of a session, the MQTT task
+ * keeps every tick_divider-th one and drains them into batched messages.
+ * A divider of 0 (no broker connection) turns the lane off.
+ *
+ * Each grinder channel has its own: telemetry is grinder 1's and
+ * channel_telemetry() returns the others. Readers that show one grinder
+ * (BLE stream, MQTT ticks, dashboard) follow the selected channel.
+ */
+class Telemetry {
+public:
+    static const uint8_t VERSION = 2;
+    static const size_t HEADER_BYTES = 4;
+
+    void init(const MotorEdgeTimeline* motor_edges) { edge_timeline = motor_edges; }
+
+    // Controller side (BLE task)
+    void start(uint16_t rate_hz);           // 0: every sample
+    void stop();
+    bool is_streaming() const { return streaming.load(std::memory_order_relaxed); }
+    uint32_t get_pending_count() const;
+    // Header plus as many pending frames as fit; 0 when nothing is pending
+    size_t read_batch(uint8_t* buffer, size_t buffer_size);
+    static uint32_t frames_per_batch(size_t buffer_size);
+
+    // Writer side
+    void set_phase(uint8_t grind_phase) { phase.store(grind_phase, std::memory_order_relaxed); }
+    void set_eta(uint32_t remaining_ms, uint32_t band_ms, bool known);
+    bool is_due(uint32_t timestamp_us) const {
+        return streaming.load(std::memory_order_acquire) &&
+               (int32_t)(timestamp_us - next_due_us.load(std::memory_order_relaxed)) >= 0;
+    }
+    void record(uint32_t timestamp_us, int32_t raw, float weight_g, float flow_gps, bool flow_valid);
+
+    // Latest published values, for readers other than the stream (MQTT)
+    uint8_t get_phase() const { return phase.load(std::memory_order_relaxed); }
+    uint16_t get_eta_ds() const { return (uint16_t)eta.load(std::memory_order_relaxed); }    // TELEMETRY_ETA_UNKNOWN outside a session
+    uint16_t get_eta_band_ds() const { return (uint16_t)(eta.load(std::memory_order_relaxed) >> 16); }
+
+    // Tick lane: consumer side (MQTT task)
+    void set_tick_divider(uint8_t divider);         // Keep every Nth control tick; 0 stops the lane
+    bool read_tick(TelemetryTick* out);
+    uint32_t take_tick_dropped() { return tick_dropped.exchange(0, std::memory_order_relaxed); }
+
+    // Tick lane: writer side (GrindControlTask)
+    void record_tick(uint32_t timestamp_ms, float weight_g, float flow_gps, bool motor_on);
+
+private:
+    Ring<TelemetryFrame, SYS_TELEMETRY_RING_FRAMES> frames;
+    std::atomic<uint32_t> write_seq{0};     // Frames published by the writer
+    std::atomic<uint32_t> read_seq{0};      // Frames consumed by the BLE task
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<bool> streaming{false};
+    std::atomic<uint8_t> phase{0};
+    std::atomic<uint32_t> eta{TELEMETRY_ETA_UNKNOWN};  // eta_band_ds << 16 | eta_ds, one store keeps the pair coherent
+    uint32_t period_us = 0;                 // Written by start() before streaming is set
+    std::atomic<uint32_t> next_due_us{0};   // Seeded by start(), then advanced by the writer
+    const MotorEdgeTimeline* edge_timeline = nullptr;
+
+    Ring<TelemetryTick, SYS_TELEMETRY_TICK_RING_ENTRIES> ticks;
+    std::atomic<uint32_t> tick_write_seq{0};
+    std::atomic<uint32_t> tick_read_seq{0};
+    std::atomic<uint32_t> tick_dropped{0};
+    std::atomic<uint8_t> tick_divider{0};
+    uint8_t tick_countdown = 0;             // Writer only: ticks to skip before the next kept one
+};
+
+extern Telemetry telemetry;     // Grinder channel 0
+
+// A grinder channel's telemetry (telemetry for channel 0 and out-of-range channels)
+Telemetry& channel_telemetry(uint8_t grinder_channel);
@@ -0,0 +1,123 @@
+#include "timing_histograms.h"
+#include "../config/constants.h"
+
+namespace {
+constexpr uint8_t kLinearBuckets = 4;       // 0-3µs, one bucket each
+constexpr uint8_t kSubBucketBits = 2;       // 4 buckets per power of two
+}
+
+TimingHistogram::TimingHistogram(const char* histogram_name)
+    : name(histogram_name), max_us(0), reset_requested(false) {
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+uint8_t TimingHistogram::bucket_for(uint32_t value_us) {
+    if (value_us < kLinearBuckets) {
+        return (uint8_t)value_us;
+    }
+    uint32_t msb = 31 - __builtin_clz(value_us);
+    uint32_t sub = (value_us >> (msb - kSubBucketBits)) & ((1u << kSubBucketBits) - 1);
+    uint32_t index = (msb - 1) * (1u << kSubBucketBits) + sub;
+    return index < BUCKET_COUNT ? (uint8_t)index : (uint8_t)(BUCKET_COUNT - 1);
+}
+
+uint32_t TimingHistogram::bucket_lower_bound_us(uint8_t index) {
+    if (index < kLinearBuckets) {
+        return index;
+    }
+    uint32_t msb = index / (1u << kSubBucketBits) + 1;
+    uint32_t sub = index % (1u << kSubBucketBits);
+    return ((1u << kSubBucketBits) + sub) << (msb - kSubBucketBits);
+}
+
+uint32_t TimingHistogram::bucket_upper_bound_us(uint8_t index) {
+    return index + 1 < BUCKET_COUNT ? bucket_lower_bound_us(index + 1) : UINT32_MAX;
+}
+
+void TimingHistogram::apply_reset() {
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    max_us.store(0, std::memory_order_relaxed);
+    reset_requested.store(false, std::memory_order_relaxed);
+}
+
+void TimingHistogram::record(uint32_t value_us) {
+    if (reset_requested.load(std::memory_order_relaxed)) {
+        apply_reset();
+    }
+
+    // Single writer: plain load + store, no atomic RMW needed
+    std::atomic<uint32_t>& bucket = buckets[bucket_for(value_us)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (value_us > max_us.load(std::memory_order_relaxed)) {
+        max_us.store(value_us, std::memory_order_relaxed);
+    }
+}
+
+uint32_t TimingHistogram::get_bucket(uint8_t index) const {
+    return index < BUCKET_COUNT ? buckets[index].load(std::memory_order_relaxed) : 0;
+}
+
+TimingHistogram::Summary TimingHistogram::summarize() const {
+    // Copy first so the percentiles come from one consistent set of counts
+    uint32_t counts[BUCKET_COUNT];
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Summary summary = {};
+    summary.count = total;
+    summary.max_us = max_us.load(std::memory_order_relaxed);
+    if (total == 0) {
+        return summary;
+    }
+
+    // Percentiles report the bucket's upper bound (never below the true value)
+    const uint32_t p50_rank = (total + 1) / 2;
+    const uint32_t p90_rank = total - total / 10;
+    const uint32_t p99_rank = total - total / 100;
+    uint32_t cumulative = 0;
+    bool have_p50 = false;
+    bool have_p90 = false;
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        cumulative += counts[i];
+        uint32_t bound = min(bucket_upper_bound_us(i), summary.max_us);
+        if (!have_p50 && cumulative >= p50_rank) {
+            summary.p50_us = bound;
+            have_p50 = true;
+        }
+        if (!have_p90 && cumulative >= p90_rank) {
+            summary.p90_us = bound;
+            have_p90 = true;
+        }
+        if (cumulative >= p99_rank) {
+            summary.p99_us = bound;
+            break;
+        }
+    }
+    return summary;
+}
+
+void TimingHistogram::print_buckets() const {
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+        uint32_t count = get_bucket(i);
+        if (count == 0) {
+            continue;
+        }
+        if (i + 1 < BUCKET_COUNT) {
+            LOG_BLE("  %s [%lu-%luus): %lu\n", name, (unsigned long)bucket_lower_bound_us(i),
+                    (unsigned long)bucket_upper_bound_us(i), (unsigned long)count);
+        } else {
+            LOG_BLE("  %s [>=%luus): %lu\n", name, (unsigned long)bucket_lower_bound_us(i),
+                    (unsigned long)count);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * TimingHistogram - Fixed-bucket, lock-free timing histogram (µs)
+ *
+ * Log-linear buckets: exact below 4µs, then 4 buckets per power of two
+ * (at most 25% wide), clamped at ~2.1s. A single writer task calls record()
+ * on the hot path using relaxed loads/stores only - no locks, no
+ * read-modify-write. Any task may read or request a reset; the writer
+ * applies a pending reset on its next record(), so counters only ever have
+ * one writer. The instances live in PerfCounters (PerfHistogram ids).
+ */
+class TimingHistogram {
+public:
+    static const uint8_t BUCKET_COUNT = 80;
+
+    struct Summary {
+        uint32_t count;
+        uint32_t p50_us;
+        uint32_t p90_us;
+        uint32_t p99_us;
+        uint32_t max_us;
+    };
+
+    explicit TimingHistogram(const char* name);
+
+    // Writer side (one task only)
+    void record(uint32_t value_us);
+
+    // Reader side (any task)
+    Summary summarize() const;
+    uint32_t get_bucket(uint8_t index) const;
+    void request_reset() { reset_requested.store(true, std::memory_order_relaxed); }
+    const char* get_name() const { return name; }
+    void print_buckets() const;
+
+    static uint8_t bucket_for(uint32_t value_us);
+    static uint32_t bucket_lower_bound_us(uint8_t index);
+    static uint32_t bucket_upper_bound_us(uint8_t index);   // Exclusive; UINT32_MAX for the last bucket
+
+private:
+    const char* name;
+    std::atomic<uint32_t> buckets[BUCKET_COUNT];
+    std::atomic<uint32_t> max_us;
+    std::atomic<bool> reset_requested;
+
+    void apply_reset();
+};
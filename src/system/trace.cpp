@@ -0,0 +1,184 @@
+#include "trace.h"
+#include "../config/logging.h"
+#include "../config/system.h"
+#include "power_manager.h"
+
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <stdarg.h>
+#include <string.h>
+
+Trace trace;
+
+namespace {
+const char* const kTraceNames[(size_t)TraceId::COUNT] = {
+    "weight_sampling", "grind_control", "ui_render", "bluetooth", "file_io",
+    "sample", "motor_edge", "lvgl_flush", "ble_notify"
+};
+
+// snprintf into buffer + used; false once the buffer is full
+bool append(char* buffer, size_t buffer_size, size_t& used, const char* format, ...) {
+    if (used >= buffer_size) {
+        return false;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + used, buffer_size - used, format, args);
+    va_end(args);
+    if (written < 0 || (size_t)written >= buffer_size - used) {
+        buffer[used] = '\0';
+        used = buffer_size;
+        return false;
+    }
+    used += written;
+    return true;
+}
+} // namespace
+
+bool Trace::start(uint32_t duration_ms) {
+    stop();
+    for (Ring& ring : rings) {
+        if (!ring.events) {
+            ring.events = (TraceEvent*)heap_caps_malloc(SYS_TRACE_EVENTS_PER_CORE * sizeof(TraceEvent), MALLOC_CAP_SPIRAM);
+        }
+        if (!ring.events) {
+            LOG_BLE("TRACE: no PSRAM for %u events per core\n", (unsigned)SYS_TRACE_EVENTS_PER_CORE);
+            return false;
+        }
+        ring.head.store(0, std::memory_order_relaxed);
+        ring.base_cycles = 0;
+        ring.base_us = 0;
+    }
+
+    if (duration_ms == 0) {
+        duration_ms = SYS_TRACE_DEFAULT_CAPTURE_MS;
+    }
+    capture_duration_ms = duration_ms < SYS_TRACE_MAX_CAPTURE_MS ? duration_ms : SYS_TRACE_MAX_CAPTURE_MS;
+    // One clock for the whole capture, or the cycle stamps could not be converted
+    power_manager.set_hold(PowerHold::TRACE, true);
+    cpu_mhz = getCpuFrequencyMhz();
+    capture_start_us = esp_timer_get_time();
+    capturing.store(true, std::memory_order_release);
+    LOG_BLE("TRACE: capturing for %lums (%u events per core)\n",
+            (unsigned long)capture_duration_ms, (unsigned)SYS_TRACE_EVENTS_PER_CORE);
+    return true;
+}
+
+void Trace::stop() {
+    if (!capturing.exchange(false)) {
+        return;
+    }
+    // A writer that saw the flag just before it dropped may still be filling its slot
+    vTaskDelay(pdMS_TO_TICKS(2));
+    power_manager.set_hold(PowerHold::TRACE, false);
+    LOG_BLE("TRACE: capture ended, %lu + %lu events (%lu + %lu dropped)\n",
+            (unsigned long)get_event_count(0), (unsigned long)get_event_count(1),
+            (unsigned long)get_dropped_count(0), (unsigned long)get_dropped_count(1));
+}
+
+void Trace::service() {
+    if (!is_capturing()) {
+        return;
+    }
+    bool timed_out = esp_timer_get_time() - capture_start_us >= (int64_t)capture_duration_ms * 1000;
+    bool full = rings[0].head.load(std::memory_order_relaxed) >= SYS_TRACE_EVENTS_PER_CORE &&
+                rings[1].head.load(std::memory_order_relaxed) >= SYS_TRACE_EVENTS_PER_CORE;
+    if (timed_out || full) {
+        stop();
+    }
+}
+
+void Trace::record(TracePhase phase, TraceId id, uint16_t arg) {
+    Ring& ring = rings[xPortGetCoreID() & 1];
+    uint32_t index = ring.head.fetch_add(1, std::memory_order_relaxed);
+    // Stamp after claiming the slot so a preempting writer cannot make slots run backwards by much
+    uint32_t cycles = esp_cpu_get_cycle_count();
+    if (index >= SYS_TRACE_EVENTS_PER_CORE) {
+        return;
+    }
+    if (index == 0) {
+        ring.base_cycles = cycles;
+        ring.base_us = esp_timer_get_time();
+    }
+    TraceEvent& event = ring.events[index];
+    event.cycles = cycles;
+    event.phase = (uint8_t)phase;
+    event.id = (uint8_t)id;
+    event.arg = arg;
+}
+
+uint32_t Trace::get_event_count(uint8_t core) const {
+    if (core >= 2 || !rings[core].events) {
+        return 0;
+    }
+    uint32_t head = rings[core].head.load(std::memory_order_acquire);
+    return head < SYS_TRACE_EVENTS_PER_CORE ? head : SYS_TRACE_EVENTS_PER_CORE;
+}
+
+uint32_t Trace::get_dropped_count(uint8_t core) const {
+    if (core >= 2) {
+        return 0;
+    }
+    uint32_t head = rings[core].head.load(std::memory_order_relaxed);
+    return head > SYS_TRACE_EVENTS_PER_CORE ? head - SYS_TRACE_EVENTS_PER_CORE : 0;
+}
+
+uint32_t Trace::copy_tail(uint8_t core, TraceEvent* out, uint32_t max_events) const {
+    uint32_t available = get_event_count(core);
+    uint32_t count = available < max_events ? available : max_events;
+    if (count > 0) {
+        memcpy(out, rings[core].events + available - count, count * sizeof(TraceEvent));
+    }
+    return count;
+}
+
+const char* Trace::get_name(TraceId id) {
+    return id < TraceId::COUNT ? kTraceNames[(size_t)id] : "?";
+}
+
+size_t Trace::format_header(char* buffer, size_t buffer_size) const {
+    size_t used = 0;
+    append(buffer, buffer_size, used, "TRACE_BEGIN mhz=%lu names=", (unsigned long)cpu_mhz);
+    for (size_t i = 0; i < (size_t)TraceId::COUNT; i++) {
+        append(buffer, buffer_size, used, "%s%s", i == 0 ? "" : ",", kTraceNames[i]);
+    }
+    append(buffer, buffer_size, used, "\n");
+    return used < buffer_size ? used : 0;
+}
+
+size_t Trace::format_core(uint8_t core, char* buffer, size_t buffer_size) const {
+    size_t used = 0;
+    const Ring& ring = rings[core & 1];
+    append(buffer, buffer_size, used, "TRACE_CORE %u events=%lu dropped=%lu base_cycles=%lu base_us=%lld\n",
+           (unsigned)core, (unsigned long)get_event_count(core), (unsigned long)get_dropped_count(core),
+           (unsigned long)ring.base_cycles, (long long)ring.base_us);
+    return used < buffer_size ? used : 0;
+}
+
+uint32_t Trace::format_data(uint8_t core, uint32_t first, char* buffer, size_t buffer_size) const {
+    uint32_t available = get_event_count(core);
+    if (first >= available) {
+        return 0;
+    }
+    size_t used = 0;
+    if (!append(buffer, buffer_size, used, "TRACE_DATA %u ", (unsigned)core)) {
+        return 0;
+    }
+
+    // 16 hex digits per event plus the newline must fit
+    uint32_t count = 0;
+    const uint8_t* bytes = (const uint8_t*)(rings[core].events + first);
+    while (first + count < available && used + 2 * sizeof(TraceEvent) + 2 <= buffer_size) {
+        for (size_t i = 0; i < sizeof(TraceEvent); i++) {
+            static const char kHex[] = "0123456789abcdef";
+            buffer[used++] = kHex[bytes[i] >> 4];
+            buffer[used++] = kHex[bytes[i] & 0x0F];
+        }
+        bytes += sizeof(TraceEvent);
+        count++;
+    }
+    buffer[used++] = '\n';
+    buffer[used] = '\0';
+    return count;
+}
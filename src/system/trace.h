@@ -0,0 +1,101 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <esp_cpu.h>
+
+// Ids are fixed at compile time: add an entry before COUNT and its name in trace.cpp.
+// tools/grinder.py reads the names from the dump header, so the host needs no change.
+enum class TraceId : uint8_t {
+    WEIGHT_SAMPLING_CYCLE,          // Spans: one task cycle each
+    GRIND_CONTROL_CYCLE,
+    UI_RENDER_CYCLE,
+    BLUETOOTH_CYCLE,
+    FILE_IO_CYCLE,
+    SAMPLE_ARRIVAL,                 // Instant: load cell sample fed into the filter
+    MOTOR_EDGE,                     // Instant: arg = MotorEdgeType (task-context edges only)
+    LVGL_FLUSH,                     // Span: panel write of one flushed area, arg = rows
+    BLE_NOTIFY,                     // Instant: arg = payload bytes
+    COUNT
+};
+
+enum class TracePhase : uint8_t {
+    BEGIN,
+    END,
+    INSTANT
+};
+
+// 8 bytes; dumped as raw little-endian hex
+struct TraceEvent {
+    uint32_t cycles;                // CCOUNT of the recording core
+    uint8_t phase;                  // TracePhase
+    uint8_t id;                     // TraceId
+    uint16_t arg;
+};
+
+/**
+ * Trace - Cycle-stamped event capture for timeline analysis (Perfetto / Chrome trace)
+ *
+ * One ring per core in PSRAM, allocated on the first capture. A writer stamps
+ * esp_cpu_get_cycle_count() and claims its slot with one atomic add on its
+ * core's head, so tasks that preempt each other on a core never lock and the
+ * cores never share a head. Rings do not wrap: a capture fills them once and
+ * later events are counted as dropped, which keeps the start of the window
+ * intact and lets the reader walk the rings once the capture has ended.
+ *
+ * With no capture running each hook costs one relaxed load. CCOUNT is per core
+ * and wraps every ~17.9 s at 240 MHz, so captures are capped below that and
+ * each ring keeps its own (CCOUNT, esp_timer) base from its first event.
+ *
+ * Task switches are approximated by the per-task cycle spans; FreeRTOS trace
+ * hooks would need a rebuilt kernel configuration.
+ */
+class Trace {
+public:
+    // Controller side (BLE task)
+    bool start(uint32_t duration_ms);       // false when the rings cannot be allocated
+    void stop();
+    void service();                         // Ends the capture on timeout or when both rings are full
+    bool is_capturing() const { return capturing.load(std::memory_order_relaxed); }
+
+    // Writer side (any task, either core)
+    void span_begin(TraceId id, uint16_t arg = 0) { if (is_capturing()) record(TracePhase::BEGIN, id, arg); }
+    void span_end(TraceId id, uint16_t arg = 0) { if (is_capturing()) record(TracePhase::END, id, arg); }
+    void instant(TraceId id, uint16_t arg = 0) { if (is_capturing()) record(TracePhase::INSTANT, id, arg); }
+
+    // Reader side, only while no capture is running
+    uint32_t get_event_count(uint8_t core) const;
+    uint32_t get_dropped_count(uint8_t core) const;
+    uint32_t get_cpu_mhz() const { return cpu_mhz; }
+    // The newest events of a core, oldest first; also from a crash handler, mid-capture
+    uint32_t copy_tail(uint8_t core, TraceEvent* out, uint32_t max_events) const;
+
+    static const char* get_name(TraceId id);
+
+    // Dump lines for the host, each ending in '\n':
+    //   TRACE_BEGIN mhz=<n> names=<id names, comma separated>
+    //   TRACE_CORE <core> events=<n> dropped=<n> base_cycles=<n> base_us=<n>   (one per core)
+    //   TRACE_DATA <core> <events as hex>                                      (repeated)
+    //   TRACE_END
+    size_t format_header(char* buffer, size_t buffer_size) const;
+    size_t format_core(uint8_t core, char* buffer, size_t buffer_size) const;
+    // As many events from first as fit; returns how many were written (0 past the last event)
+    uint32_t format_data(uint8_t core, uint32_t first, char* buffer, size_t buffer_size) const;
+
+private:
+    struct Ring {
+        TraceEvent* events = nullptr;
+        std::atomic<uint32_t> head{0};      // Slots claimed, may run past the capacity
+        uint32_t base_cycles = 0;           // Written by the slot 0 writer
+        int64_t base_us = 0;
+    };
+
+    Ring rings[2];
+    std::atomic<bool> capturing{false};
+    int64_t capture_start_us = 0;
+    uint32_t capture_duration_ms = 0;
+    uint32_t cpu_mhz = 0;
+
+    void record(TracePhase phase, TraceId id, uint16_t arg);
+};
+
+extern Trace trace;
@@ -0,0 +1,36 @@
+#include "ui_snapshot.h"
+#include "../controllers/grind_channels.h"
+
+UISnapshotBuffer ui_snapshot;
+
+void UISnapshotBuffer::publish(uint8_t grinder_channel, const UISnapshot& snapshot) {
+    Slot& target = slots[grinder_channel < HW_GRINDER_CHANNELS ? grinder_channel : 0];
+    uint32_t seq = target.sequence.load(std::memory_order_relaxed);
+    target.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    target.data = snapshot;
+    target.sequence.store(seq + 2, std::memory_order_release);
+}
+
+UISnapshot UISnapshotBuffer::read() const {
+    return read(grind_channels.get_selected());
+}
+
+UISnapshot UISnapshotBuffer::read(uint8_t grinder_channel) const {
+    const Slot& source = slot(grinder_channel);
+    UISnapshot copy;
+    uint32_t before;
+    uint32_t after;
+    do {
+        before = source.sequence.load(std::memory_order_acquire);
+        copy = source.data;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = source.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    copy.sequence = before >> 1;
+    return copy;
+}
+
+uint32_t UISnapshotBuffer::get_sequence() const {
+    return slot(grind_channels.get_selected()).sequence.load(std::memory_order_acquire) >> 1;
+}
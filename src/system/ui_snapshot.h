@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "../config/hardware.h"
+
+// Weight values for one control tick, published together so screens never mix ticks
+struct UISnapshot {
+    uint32_t sequence;              // Publish count, filled by read(); unchanged means nothing new
+    uint32_t sample_timestamp_us;   // Newest load cell sample, esp_timer µs (32-bit)
+    float display_weight;           // 300ms window + asymmetric display filter
+    float live_weight;              // Low-latency weight (cup detection, auto return)
+    float instant_weight;           // Latest single sample
+    int32_t instant_raw;            // Latest raw ADC counts (calibration, diagnostics)
+    float flow_rate;                // g/s over the 200ms flow window
+};
+
+/**
+ * UISnapshotBuffer - Core 0 weight readings for every UI reader
+ *
+ * GrindController::publish_ui_snapshot() fills one UISnapshot per
+ * GrindControlTask tick; while grinding it reuses the controller's own pass
+ * over the sample ring. This is the only place the display filter advances,
+ * so UI code reads weights here instead of calling WeightSensor getters.
+ *
+ * A sequence lock: the single writer makes the sequence odd, copies the
+ * struct and makes it even again; read() retries while the sequence is odd
+ * or moved during its copy. Neither side blocks.
+ *
+ * Every grinder channel publishes into a slot of its own. read() and
+ * get_sequence() follow the selected channel (GrindChannels), as the screens
+ * do; read(channel) is for code watching a grinder in the background.
+ */
+class UISnapshotBuffer {
+public:
+    void publish(uint8_t grinder_channel, const UISnapshot& snapshot);   // Core 0 (GrindControlTask) only
+    UISnapshot read() const;
+    UISnapshot read(uint8_t grinder_channel) const;
+    uint32_t get_sequence() const;
+
+private:
+    struct Slot {
+        UISnapshot data = {};
+        std::atomic<uint32_t> sequence{0};
+    };
+    const Slot& slot(uint8_t grinder_channel) const {
+        return slots[grinder_channel < HW_GRINDER_CHANNELS ? grinder_channel : 0];
+    }
+
+    Slot slots[HW_GRINDER_CHANNELS];
+};
+
+extern UISnapshotBuffer ui_snapshot;
@@ -1,9 +1,18 @@
 #include "file_io_task.h"
 #include "../logging/grind_logging.h"
+#include "../logging/deferred_log.h"
+#include "../controllers/grind_channels.h"
 #include "../config/constants.h"
+#include "../system/statistics_manager.h"
+#include "../system/preference_cache.h"
+#include "../system/storage_benchmark.h"
+#include "../system/trace.h"
 #include <Arduino.h>
+#include <esp_timer.h>
 #include <LittleFS.h>
 #include <Preferences.h>
+#include <cstddef>
+#include <cstring>
 
 // Global instance
 FileIOTask file_io_task;
@@ -14,7 +23,9 @@ FileIOTask* FileIOTask::instance = nullptr;
 FileIOTask::FileIOTask() {
     task_handle = nullptr;
     task_running = false;
-    file_io_queue = nullptr;
+    for (size_t i = 0; i < FILE_IO_LANE_COUNT; i++) {
+        lanes[i] = nullptr;
+    }
     
     // Initialize file I/O state
     filesystem_available = false;
@@ -23,10 +34,6 @@ FileIOTask::FileIOTask() {
     last_filesystem_check_time = 0;
     
     // Initialize performance metrics
-    cycle_count = 0;
-    cycle_time_sum_ms = 0;
-    cycle_time_min_ms = UINT32_MAX;
-    cycle_time_max_ms = 0;
     last_heartbeat_time = 0;
     
     // Initialize operation statistics
@@ -35,6 +42,9 @@ FileIOTask::FileIOTask() {
     preference_operations_processed = 0;
     data_export_operations_processed = 0;
     
+    log_batch[0] = '\0';
+    log_batch_length = 0;
+    
     instance = this;
 }
 
@@ -46,8 +56,10 @@ FileIOTask::~FileIOTask() {
     }
 }
 
-void FileIOTask::init(QueueHandle_t io_queue) {
-    file_io_queue = io_queue;
+void FileIOTask::init(RingbufHandle_t session_ring, RingbufHandle_t preference_ring, RingbufHandle_t log_ring) {
+    lanes[(size_t)FileIOLane::SESSION] = session_ring;
+    lanes[(size_t)FileIOLane::PREFERENCE] = preference_ring;
+    lanes[(size_t)FileIOLane::LOG] = log_ring;
     
     // Check initial filesystem availability
     filesystem_available = LittleFS.begin(true);
@@ -57,7 +69,79 @@ void FileIOTask::init(QueueHandle_t io_queue) {
         LOG_BLE("FileIOTask: LittleFS filesystem unavailable\n");
     }
     
-    LOG_BLE("FileIOTask: Initialized with file I/O queue\n");
+    LOG_BLE("FileIOTask: Initialized with session, preference and log lanes\n");
+}
+
+bool FileIOTask::post_flash_operation(const FlashOpRequest& request) {
+    return post(FileIOOperationType::FLASH_OPERATION, &request, sizeof(request), nullptr, 0);
+}
+
+bool FileIOTask::post_log_message(const char* message) {
+    return post(FileIOOperationType::LOG_MESSAGE, nullptr, 0, message, LOG_MESSAGE_MAX_LENGTH);
+}
+
+bool FileIOTask::post_preference_write(const char* key, const char* value) {
+    char padded_key[sizeof(FileIOPreferencePayload::key)] = {};
+    strncpy(padded_key, key, sizeof(padded_key) - 1);
+    return post(FileIOOperationType::PREFERENCE_WRITE, padded_key, sizeof(padded_key),
+                value, sizeof(FileIOPreferencePayload::value));
+}
+
+bool FileIOTask::post_data_export(const char* export_path, uint32_t start_id, uint32_t end_id) {
+    uint32_t range[2] = { start_id, end_id };
+    static_assert(sizeof(range) == offsetof(FileIODataExportPayload, export_path), "Unexpected FileIODataExportPayload layout");
+    return post(FileIOOperationType::DATA_EXPORT, range, sizeof(range),
+                export_path, sizeof(FileIODataExportPayload::export_path));
+}
+
+FileIOLane FileIOTask::lane_of(FileIOOperationType type) {
+    switch (type) {
+        case FileIOOperationType::PREFERENCE_WRITE:
+            return FileIOLane::PREFERENCE;
+        case FileIOOperationType::LOG_MESSAGE:
+            return FileIOLane::LOG;
+        default:
+            return FileIOLane::SESSION;
+    }
+}
+
+bool FileIOTask::post(FileIOOperationType type, const void* fixed, size_t fixed_size, const char* text, size_t text_limit) {
+    FileIOLane lane = lane_of(type);
+    RingbufHandle_t ring = lanes[(size_t)lane];
+    if (!ring) {
+        count_dropped(lane);
+        return false;
+    }
+
+    // The item is filled in place: header, fixed payload part, then the text up to its terminator
+    size_t text_size = text ? strnlen(text, text_limit - 1) + 1 : 0;
+    void* item = nullptr;
+    if (xRingbufferSendAcquire(ring, &item, sizeof(FileIORequestHeader) + fixed_size + text_size, 0) != pdTRUE) {
+        count_dropped(lane);
+        return false;
+    }
+    FileIORequestHeader* header = (FileIORequestHeader*)item;
+    header->operation_type = type;
+    memset(header->reserved, 0, sizeof(header->reserved));
+    uint8_t* payload = (uint8_t*)(header + 1);
+    if (fixed_size > 0) {
+        memcpy(payload, fixed, fixed_size);
+    }
+    if (text_size > 0) {
+        memcpy(payload + fixed_size, text, text_size - 1);
+        payload[fixed_size + text_size - 1] = '\0';
+    }
+    if (xRingbufferSendComplete(ring, item) != pdTRUE) {
+        count_dropped(lane);
+        return false;
+    }
+
+    // Session work should not sit out the rest of the poll interval
+    TaskHandle_t consumer = task_handle;
+    if (lane == FileIOLane::SESSION && consumer) {
+        xTaskNotifyGive(consumer);
+    }
+    return true;
 }
 
 bool FileIOTask::start_task() {
@@ -66,8 +150,8 @@ bool FileIOTask::start_task() {
         return false;
     }
     
-    if (!file_io_queue) {
-        LOG_BLE("ERROR: File I/O queue not initialized\n");
+    if (!lanes[(size_t)FileIOLane::SESSION]) {
+        LOG_BLE("ERROR: File I/O lanes not initialized\n");
         return false;
     }
     
@@ -81,7 +165,7 @@ bool FileIOTask::start_task() {
         nullptr,
         SYS_TASK_PRIORITY_FILE_IO,
         &task_handle,
-        1  // Pin to Core 1
+        SYS_TASK_CORE_FILE_IO
     );
     
     if (result != pdPASS) {
@@ -131,24 +215,55 @@ void FileIOTask::task_impl() {
             xPortGetCoreID(), 1000 / SYS_TASK_FILE_IO_INTERVAL_MS);
     
     // When invoked via TaskManager wrapper, start_task() isn't used.
-    // Ensure the internal run flag is set so the loop executes.
+    // Ensure the internal run flag is set so the loop executes, and that posts can wake us.
     task_running = true;
+    task_handle = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < grind_channels.count(); i++) {
+        grind_channels.get_controller(i)->set_flash_op_consumer(task_handle);
+    }
     
     // Reset performance metrics
     reset_performance_metrics();
     
     // Main file I/O processing loop
     while (task_running) {
+        int64_t cycle_start_us = esp_timer_get_time();
         uint32_t cycle_start_time = millis();
+        trace.span_begin(TraceId::FILE_IO_CYCLE);
         
-        // Process file I/O operations from queue
-        process_file_io_operations();
-
-        // Also drain legacy GrindController queues here so flash operations
-        // (start/end session) run on Core 1 in this low-priority task
-        extern GrindController grind_controller;
-        grind_controller.process_queued_flash_operations();
-        grind_controller.process_queued_log_messages();
+        // Session data first: GrindController's flash operations (start/end session,
+        // model saves) run on Core 1 in this low-priority task, then the SESSION lane;
+        // every grinder channel's
+        for (uint8_t i = 0; i < grind_channels.count(); i++) {
+            grind_channels.get_controller(i)->process_queued_flash_operations();
+        }
+        process_lane(FileIOLane::SESSION);
+
+        // Append full measurement blocks of the running session to its file
+        grind_logger.service_session_stream();
+
+        // Then preferences, and write back statistics and preferences once the grinder is idle
+        process_lane(FileIOLane::PREFERENCE);
+        bool idle = !grind_channels.any_active();
+        for (uint8_t ch = 0; ch < HW_GRINDER_CHANNELS; ch++) {
+            channel_statistics(ch).service(cycle_start_time, idle);
+        }
+        preference_cache.service(cycle_start_time, idle);
+
+#if FEATURE_DEBUG_TOOLS
+        // The storage benchmark needs the filesystem to itself; a grind that starts stops it
+        if (storage_benchmark.take_request()) {
+            if (!idle) {
+                LOG_BLE("[%lums STORAGE_BENCHMARK] Not started: the grinder is active\n", millis());
+            } else {
+                storage_benchmark.run([]() { return grind_channels.any_active(); });
+            }
+        }
+#endif
+
+        // Logs last: the LOG lane and what Core 0 logged with LOG_RT, printed in batches
+        process_lane(FileIOLane::LOG);
+        process_log_lines();
         
         // Periodic filesystem health check
         if (cycle_start_time - last_filesystem_check_time >= 30000) { // Every 30 seconds
@@ -156,59 +271,110 @@ void FileIOTask::task_impl() {
             last_filesystem_check_time = cycle_start_time;
         }
         
-        uint32_t cycle_end_time = millis();
-        
         // Record performance metrics
-        record_timing(cycle_start_time, cycle_end_time);
+        trace.span_end(TraceId::FILE_IO_CYCLE);
+        record_timing(cycle_start_us, esp_timer_get_time());
         
-        // Use vTaskDelayUntil for predictable timing (eliminates busy-wait)
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        wait_for_work(xLastWakeTime, xFrequency);
     }
     
+    for (uint8_t i = 0; i < grind_channels.count(); i++) {
+        grind_channels.get_controller(i)->set_flash_op_consumer(nullptr);
+    }
     LOG_BLE("FileIOTask: I/O processing loop stopped\n");
 }
 
-void FileIOTask::process_file_io_operations() {
-    // If init() has not been called yet by main (queue not set), skip this cycle
-    if (!file_io_queue) {
+void FileIOTask::wait_for_work(TickType_t& last_wake_time, TickType_t period) {
+    // Sleep until the next period like vTaskDelayUntil, unless session work notifies us first.
+    // An early wake keeps the period schedule; an overrun drops pending notifications, the
+    // cycle that follows handles their work anyway.
+    TickType_t next_wake = last_wake_time + period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(next_wake - now) <= 0) {
+        ulTaskNotifyTake(pdTRUE, 0);
+        last_wake_time = next_wake;
+        return;
+    }
+    if (ulTaskNotifyTake(pdTRUE, next_wake - now) > 0) {
+        perf_counters.increment(PerfCount::FILE_IO_URGENT_WAKES);
         return;
     }
+    last_wake_time = next_wake;
+}
 
-    FileIORequest request;
-    
-    // Process all queued file I/O operations (non-blocking)
-    while (xQueueReceive(file_io_queue, &request, 0) == pdPASS) {
+void FileIOTask::process_lane(FileIOLane lane) {
+    // If init() has not been called yet by main (lane not set), skip this cycle
+    RingbufHandle_t ring = lanes[(size_t)lane];
+    if (!ring) {
+        return;
+    }
+
+    // Process all queued requests of this lane (non-blocking), straight from the ring
+    size_t item_size;
+    void* item;
+    while ((item = xRingbufferReceive(ring, &item_size, 0)) != nullptr) {
         total_operations_processed++;
-        
-        switch (request.operation_type) {
-            case FileIOOperationType::FLASH_OPERATION:
-                process_flash_operation(request.flash_op);
+        if (item_size >= sizeof(FileIORequestHeader)) {
+            const FileIORequestHeader* header = (const FileIORequestHeader*)item;
+            process_request(*header, (const uint8_t*)(header + 1), item_size - sizeof(FileIORequestHeader));
+        } else {
+            failed_operations_count++;
+        }
+        vRingbufferReturnItem(ring, item);
+    }
+    if (lane == FileIOLane::LOG) {
+        flush_log_batch();
+    }
+}
+
+void FileIOTask::process_request(const FileIORequestHeader& header, const uint8_t* payload, size_t payload_size) {
+    // Text payloads end with their terminator; anything else is a malformed item
+    bool text_terminated = payload_size > 0 && payload[payload_size - 1] == '\0';
+
+    switch (header.operation_type) {
+        case FileIOOperationType::FLASH_OPERATION:
+            if (payload_size == sizeof(FlashOpRequest)) {
+                FlashOpRequest request;     // Copied out: the ring only guarantees 4-byte alignment
+                memcpy(&request, payload, sizeof(request));
+                process_flash_operation(request);
                 flash_operations_processed++;
-                break;
-                
-            case FileIOOperationType::LOG_MESSAGE:
-                process_log_message(request.log_msg);
+                return;
+            }
+            break;
+            
+        case FileIOOperationType::LOG_MESSAGE:
+            if (text_terminated) {
+                process_log_message((const char*)payload);
                 log_messages_processed++;
-                break;
-                
-            case FileIOOperationType::PREFERENCE_WRITE:
-                process_preference_write(request.preference.key, request.preference.value);
+                return;
+            }
+            break;
+            
+        case FileIOOperationType::PREFERENCE_WRITE:
+            if (text_terminated && payload_size > sizeof(FileIOPreferencePayload::key)) {
+                const FileIOPreferencePayload* preference = (const FileIOPreferencePayload*)payload;
+                process_preference_write(preference->key, preference->value);
                 preference_operations_processed++;
-                break;
-                
-            case FileIOOperationType::DATA_EXPORT:
-                process_data_export(request.data_export.export_path, 
-                                  request.data_export.start_session_id,
-                                  request.data_export.end_session_id);
+                return;
+            }
+            break;
+            
+        case FileIOOperationType::DATA_EXPORT:
+            if (text_terminated && payload_size > offsetof(FileIODataExportPayload, export_path)) {
+                const FileIODataExportPayload* data_export = (const FileIODataExportPayload*)payload;
+                process_data_export(data_export->export_path, data_export->start_session_id,
+                                    data_export->end_session_id);
                 data_export_operations_processed++;
-                break;
-                
-            default:
-                LOG_BLE("WARNING: FileIOTask unknown operation type %d\n", (int)request.operation_type);
-                failed_operations_count++;
-                break;
-        }
+                return;
+            }
+            break;
+            
+        default:
+            break;
     }
+
+    LOG_BLE("WARNING: FileIOTask malformed request type %d (%u bytes)\n", (int)header.operation_type, (unsigned)payload_size);
+    failed_operations_count++;
 }
 
 void FileIOTask::process_flash_operation(const FlashOpRequest& request) {
@@ -224,7 +390,8 @@ void FileIOTask::process_flash_operation(const FlashOpRequest& request) {
         case FlashOpRequest::END_GRIND_SESSION:
             LOG_BLE("[%lums FLASH_OP] Processing END_GRIND_SESSION: %s, %.2fg, %d pulses\n", 
                     millis(), request.result_string, request.final_weight, request.pulse_count);
-            grind_logger.end_grind_session(request.result_string, request.final_weight, request.pulse_count);
+            grind_logger.end_grind_session(request.descriptor.grinder_channel, request.result_string, request.final_weight,
+                                           request.pulse_count);
             break;
             
         default:
@@ -234,33 +401,45 @@ void FileIOTask::process_flash_operation(const FlashOpRequest& request) {
     }
 }
 
-void FileIOTask::process_log_message(const LogMessage& message) {
-    // Output the log message using BLE_LOG (extracted from GrindController)
-    LOG_BLE("%s", message.message);
+void FileIOTask::process_log_message(const char* message) {
+    // Printed with the rest of the batch at the end of the lane
+    append_log_line(message);
 }
 
-void FileIOTask::process_preference_write(const char* key, const char* value) {
-    if (!filesystem_available) {
-        failed_operations_count++;
+void FileIOTask::process_log_lines() {
+    char line[DEFERRED_LOG_MAX_LINE];
+    while (deferred_log.next_line(line, sizeof(line))) {
+        append_log_line(line);
+    }
+    flush_log_batch();
+}
+
+void FileIOTask::append_log_line(const char* line) {
+    size_t length = strlen(line);
+    if (log_batch_length + length >= sizeof(log_batch)) {
+        flush_log_batch();
+    }
+    if (length >= sizeof(log_batch)) {
+        LOG_BLE("%s", line);    // Longer than a whole batch
         return;
     }
-    
-    // Write preference/setting to persistent storage
-    Preferences prefs;
-    if (prefs.begin("grinder", false)) {
-        size_t written = prefs.putString(key, value);
-        prefs.end();
-        
-        if (written == 0) {
-            LOG_BLE("WARNING: Failed to write preference %s=%s\n", key, value);
-            failed_operations_count++;
-        } else {
-            LOG_BLE("FileIOTask: Preference written %s=%s\n", key, value);
-        }
-    } else {
-        LOG_BLE("ERROR: Failed to open preferences for writing\n");
-        failed_operations_count++;
+    memcpy(log_batch + log_batch_length, line, length + 1);
+    log_batch_length += length;
+}
+
+void FileIOTask::flush_log_batch() {
+    if (log_batch_length == 0) {
+        return;
     }
+    LOG_BLE("%s", log_batch);
+    log_batch_length = 0;
+    log_batch[0] = '\0';
+}
+
+void FileIOTask::process_preference_write(const char* key, const char* value) {
+    // Coalesced in the write-back cache; service() writes it to the "grinder" namespace when idle
+    preference_cache.put_string(key, value);
+    LOG_BLE("FileIOTask: Preference queued %s=%s\n", key, value);
 }
 
 void FileIOTask::process_data_export(const char* export_path, uint32_t start_id, uint32_t end_id) {
@@ -349,21 +528,13 @@ void FileIOTask::log_operation_failure(FileIOOperationType type, const char* det
     failed_operations_count++;
 }
 
-void FileIOTask::record_timing(uint32_t start_time, uint32_t end_time) {
-    uint32_t cycle_duration = end_time - start_time;
-    
-    cycle_count++;
-    cycle_time_sum_ms += cycle_duration;
-    
-    if (cycle_duration < cycle_time_min_ms) {
-        cycle_time_min_ms = cycle_duration;
-    }
-    if (cycle_duration > cycle_time_max_ms) {
-        cycle_time_max_ms = cycle_duration;
-    }
+void FileIOTask::record_timing(int64_t start_us, int64_t end_us) {
+    perf_counters.record(PerfTimer::FILE_IO_CYCLE, (uint32_t)(end_us - start_us));
     
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // Print task heartbeat every 10 seconds
+    uint32_t start_time = (uint32_t)(start_us / 1000);
+    uint32_t end_time = (uint32_t)(end_us / 1000);
     if (last_heartbeat_time == 0) {
         last_heartbeat_time = start_time;
     }
@@ -378,31 +549,30 @@ void FileIOTask::record_timing(uint32_t start_time, uint32_t end_time) {
 
 void FileIOTask::print_heartbeat() const {
 #if SYS_ENABLE_REALTIME_HEARTBEAT
-    uint32_t avg_cycle_time = cycle_count > 0 ? cycle_time_sum_ms / cycle_count : 0;
+    PerfTimerWindow cycles = perf_counters.get_window(PerfTimer::FILE_IO_CYCLE);
     const char* fs_status = filesystem_available ? "OK" : "ERROR";
     
-    LOG_BLE("[%lums FILE_IO_HEARTBEAT] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | FS: %s | Ops: %lu | Failed: %lu | Build: #%d\n",
-           millis(), cycle_count, avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms,
-           fs_status, total_operations_processed, failed_operations_count, BUILD_NUMBER);
+    LOG_BLE("[%lums FILE_IO_HEARTBEAT] Cycles: %lu/10s | Avg: %luus (%lu-%luus) | FS: %s | Ops: %lu | Failed: %lu | Dropped S/P/L: %lu/%lu/%lu | Urgent: %lu | Build: #%d\n",
+           millis(), cycles.count, cycles.avg_us, cycles.min_us, cycles.max_us,
+           fs_status, total_operations_processed, failed_operations_count,
+           get_dropped_count(FileIOLane::SESSION), get_dropped_count(FileIOLane::PREFERENCE),
+           get_dropped_count(FileIOLane::LOG), perf_counters.get_count(PerfCount::FILE_IO_URGENT_WAKES), BUILD_NUMBER);
 #endif
 }
 
 void FileIOTask::reset_performance_metrics() {
-    cycle_count = 0;
-    cycle_time_sum_ms = 0;
-    cycle_time_min_ms = UINT32_MAX;
-    cycle_time_max_ms = 0;
+    perf_counters.reset_window(PerfTimer::FILE_IO_CYCLE);
 }
 
 void FileIOTask::print_performance_stats() const {
     LOG_BLE("=== FileIOTask Performance ===\n");
     LOG_BLE("Task running: %s\n", task_running ? "YES" : "NO");
     LOG_BLE("Filesystem available: %s\n", filesystem_available ? "YES" : "NO");
-    LOG_BLE("Cycle count: %lu\n", cycle_count);
+    PerfTimerWindow cycles = perf_counters.get_window(PerfTimer::FILE_IO_CYCLE);
+    LOG_BLE("Cycle count: %lu\n", cycles.total_count);
     
-    if (cycle_count > 0) {
-        uint32_t avg_cycle_time = cycle_time_sum_ms / cycle_count;
-        LOG_BLE("Average cycle time: %lums (%lu-%lums)\n", avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms);
+    if (cycles.count > 0) {
+        LOG_BLE("Average cycle time: %luus (%lu-%luus)\n", cycles.avg_us, cycles.min_us, cycles.max_us);
     }
     
     LOG_BLE("Total operations: %lu\n", total_operations_processed);
@@ -416,6 +586,10 @@ void FileIOTask::print_operation_stats() const {
     LOG_BLE("Log messages: %lu\n", log_messages_processed);
     LOG_BLE("Preference writes: %lu\n", preference_operations_processed);
     LOG_BLE("Data exports: %lu\n", data_export_operations_processed);
+    LOG_BLE("Dropped (lane full): session %lu, preference %lu, log %lu\n",
+            get_dropped_count(FileIOLane::SESSION), get_dropped_count(FileIOLane::PREFERENCE),
+            get_dropped_count(FileIOLane::LOG));
+    LOG_BLE("Urgent wakes: %lu\n", perf_counters.get_count(PerfCount::FILE_IO_URGENT_WAKES));
     LOG_BLE("Total operations: %lu\n", total_operations_processed);
     LOG_BLE("Failed operations: %lu\n", failed_operations_count);
     LOG_BLE("Success rate: %.1f%%\n", 
@@ -2,33 +2,56 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
-#include <freertos/queue.h>
+#include <freertos/ringbuf.h>
 #include "../config/constants.h"
-#include "../controllers/grind_controller.h" // For FlashOpRequest and LogMessage structures
+#include "../controllers/grind_controller.h" // For FlashOpRequest
+#include "../system/perf_counters.h"
 
 // File I/O operation types
-enum class FileIOOperationType {
+enum class FileIOOperationType : uint8_t {
     FLASH_OPERATION,        // Flash operations (start/end grind session)
     LOG_MESSAGE,           // Log message output
     PREFERENCE_WRITE,      // Preference/settings persistence
     DATA_EXPORT           // Data export operations
 };
 
-// Generic file I/O request structure
-struct FileIORequest {
-    FileIOOperationType operation_type = FileIOOperationType::LOG_MESSAGE;
+constexpr size_t LOG_MESSAGE_MAX_LENGTH = 128;     // Longer LOG_MESSAGE text is cut
 
-    FlashOpRequest flash_op{};           // For FLASH_OPERATION
-    LogMessage log_msg{};                // For LOG_MESSAGE
-    struct {                            // For PREFERENCE_WRITE
-        char key[32];
-        char value[64];
-    } preference{};
-    struct {                            // For DATA_EXPORT
-        char export_path[64];
-        uint32_t start_session_id;
-        uint32_t end_session_id;
-    } data_export{};
+// Each lane is its own ring, so a burst of log lines cannot crowd out a session flush.
+// Lanes are drained in this order every cycle.
+enum class FileIOLane : uint8_t {
+    SESSION,               // FLASH_OPERATION, DATA_EXPORT - posting wakes the task
+    PREFERENCE,            // PREFERENCE_WRITE
+    LOG,                   // LOG_MESSAGE - printed in batches
+    COUNT
+};
+
+constexpr size_t FILE_IO_LANE_COUNT = (size_t)FileIOLane::COUNT;
+static_assert((size_t)PerfCount::FILE_IO_PREFERENCE_DROPPED == (size_t)PerfCount::FILE_IO_SESSION_DROPPED + (size_t)FileIOLane::PREFERENCE &&
+              (size_t)PerfCount::FILE_IO_LOG_DROPPED == (size_t)PerfCount::FILE_IO_SESSION_DROPPED + (size_t)FileIOLane::LOG,
+              "Lane drop counters must follow FileIOLane order");
+
+// File I/O request: a ring buffer item holding this header and then the payload of its type,
+// trimmed to its content, so a short log line costs a few dozen bytes instead of the largest
+// request. Payloads by type:
+//   FLASH_OPERATION   FlashOpRequest
+//   LOG_MESSAGE       NUL-terminated text (at most LOG_MESSAGE_MAX_LENGTH)
+//   PREFERENCE_WRITE  FileIOPreferencePayload, value cut after its NUL
+//   DATA_EXPORT       FileIODataExportPayload, export_path cut after its NUL
+struct FileIORequestHeader {
+    FileIOOperationType operation_type;
+    uint8_t reserved[3];                // Keeps the payload 4-byte aligned
+};
+
+struct FileIOPreferencePayload {
+    char key[16];                       // NVS keys are at most 15 characters
+    char value[64];
+};
+
+struct FileIODataExportPayload {
+    uint32_t start_session_id;
+    uint32_t end_session_id;
+    char export_path[64];
 };
 
 /**
@@ -46,8 +69,13 @@ struct FileIORequest {
  * 
  * Architecture:
  * - Runs on Core 1 at low priority (1)
- * - Uses vTaskDelayUntil for predictable timing
- * - Receives requests via FreeRTOS queue from any task
+ * - Runs every SYS_TASK_FILE_IO_INTERVAL_MS, and wakes early by task notification when
+ *   session work arrives (SESSION lane posts, GrindController flash operations)
+ * - Receives variable-length requests via one FreeRTOS no-split ring buffer per lane
+ *   from any task (post_*()); items are processed in place and returned to the ring
+ * - Posting never blocks: a full lane drops the request and counts it per lane
+ * - Log lines (LOG lane and LOG_RT records) are joined into batches of up to
+ *   SYS_FILE_IO_LOG_BATCH_BYTES before they are printed
  * - All blocking LittleFS operations isolated here
  */
 class FileIOTask {
@@ -57,7 +85,7 @@ private:
     volatile bool task_running;
     
     // Inter-task communication
-    QueueHandle_t file_io_queue;
+    RingbufHandle_t lanes[FILE_IO_LANE_COUNT];
     
     // File I/O state
     bool filesystem_available;
@@ -66,11 +94,7 @@ private:
     uint32_t last_filesystem_check_time;
     
     // Performance monitoring
-    uint32_t cycle_count;
-    uint32_t cycle_time_sum_ms;
-    uint32_t cycle_time_min_ms;
-    uint32_t cycle_time_max_ms;
-    uint32_t last_heartbeat_time;
+    uint32_t last_heartbeat_time;   // Cycle timing, drops and urgent wakes live in perf_counters
     
     // Operation statistics
     uint32_t flash_operations_processed;
@@ -78,6 +102,10 @@ private:
     uint32_t preference_operations_processed;
     uint32_t data_export_operations_processed;
     
+    // Log lines waiting to be printed together
+    char log_batch[SYS_FILE_IO_LOG_BATCH_BYTES];
+    size_t log_batch_length;
+    
     // Static instance for task callback
     static FileIOTask* instance;
     
@@ -86,7 +114,13 @@ public:
     ~FileIOTask();
     
     // Initialization
-    void init(QueueHandle_t io_queue);
+    void init(RingbufHandle_t session_ring, RingbufHandle_t preference_ring, RingbufHandle_t log_ring);
+    
+    // Requests from any task; false if the lane is full or not set up yet (never blocks)
+    bool post_flash_operation(const FlashOpRequest& request);
+    bool post_log_message(const char* message);
+    bool post_preference_write(const char* key, const char* value);
+    bool post_data_export(const char* export_path, uint32_t start_id, uint32_t end_id);
     
     // Task lifecycle
     bool start_task();
@@ -97,9 +131,12 @@ public:
     bool is_filesystem_available() const { return filesystem_available; }
     uint32_t get_total_operations() const { return total_operations_processed; }
     uint32_t get_failed_operations() const { return failed_operations_count; }
+    uint32_t get_dropped_count(FileIOLane lane) const {
+        return perf_counters.get_count((PerfCount)((size_t)PerfCount::FILE_IO_SESSION_DROPPED + (size_t)lane));
+    }
     
     // Performance monitoring
-    uint32_t get_cycle_count() const { return cycle_count; }
+    uint32_t get_cycle_count() const { return perf_counters.get_window(PerfTimer::FILE_IO_CYCLE).total_count; }
     void print_performance_stats() const;
     void print_operation_stats() const;
     
@@ -112,9 +149,19 @@ public:
 private:
     
     // File I/O operation processing
-    void process_file_io_operations();
+    static FileIOLane lane_of(FileIOOperationType type);
+    static void count_dropped(FileIOLane lane) {
+        perf_counters.increment((PerfCount)((size_t)PerfCount::FILE_IO_SESSION_DROPPED + (size_t)lane));
+    }
+    bool post(FileIOOperationType type, const void* fixed, size_t fixed_size, const char* text, size_t text_limit);
+    void process_lane(FileIOLane lane);
+    void process_log_lines();
+    void wait_for_work(TickType_t& last_wake_time, TickType_t period);
+    void process_request(const FileIORequestHeader& header, const uint8_t* payload, size_t payload_size);
     void process_flash_operation(const FlashOpRequest& request);
-    void process_log_message(const LogMessage& message);
+    void process_log_message(const char* message);
+    void append_log_line(const char* line);
+    void flush_log_batch();
     void process_preference_write(const char* key, const char* value);
     void process_data_export(const char* export_path, uint32_t start_id, uint32_t end_id);
     
@@ -124,7 +171,7 @@ private:
     void perform_filesystem_maintenance();
     
     // Performance tracking
-    void record_timing(uint32_t start_time, uint32_t end_time);
+    void record_timing(int64_t start_us, int64_t end_us);
     void print_heartbeat() const;
     void reset_performance_metrics();
     
@@ -1,11 +1,17 @@
 #include "grind_control_task.h"
 #include "../controllers/grind_controller.h"
+#include "../controllers/grind_channels.h"
 #include "../hardware/WeightSensor.h"
 #include "../hardware/grinder.h"
 #include "../logging/grind_logging.h"
+#include "weight_sampling_task.h"
+#include "../system/perf_counters.h"
+#include "../system/power_manager.h"
+#include "../system/trace.h"
 #include "../config/constants.h"
 #include <Arduino.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 
 // Global instance
 GrindControlTask grind_control_task;
@@ -23,11 +29,9 @@ GrindControlTask::GrindControlTask() {
     task_running = false;
     
     // Initialize performance metrics
-    cycle_count = 0;
-    cycle_time_sum_ms = 0;
-    cycle_time_min_ms = UINT32_MAX;
-    cycle_time_max_ms = 0;
     last_heartbeat_time = 0;
+    deadline_stats = {};
+    deadline_lock = portMUX_INITIALIZER_UNLOCKED;
     
     // Initialize grind state
     grind_active = false;
@@ -76,7 +80,7 @@ bool GrindControlTask::start_task() {
         nullptr,
         SYS_TASK_PRIORITY_GRIND_CONTROL,
         &task_handle,
-        0  // Pin to Core 0
+        SYS_TASK_CORE_GRIND_CONTROL
     );
     
     if (result != pdPASS) {
@@ -86,8 +90,9 @@ bool GrindControlTask::start_task() {
         return false;
     }
     
-    LOG_BLE("✅ GrindControlTask created successfully (Core 0, Priority %d, %dHz)\n", 
-            SYS_TASK_PRIORITY_GRIND_CONTROL, 1000 / SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
+    LOG_BLE("✅ GrindControlTask created successfully (Core 0, Priority %d, %dHz, %dHz in critical phases)\n", 
+            SYS_TASK_PRIORITY_GRIND_CONTROL, 1000 / SYS_TASK_GRIND_CONTROL_INTERVAL_MS,
+            1000 / SYS_TASK_GRIND_CONTROL_FAST_INTERVAL_MS);
     return true;
 }
 
@@ -120,10 +125,14 @@ void GrindControlTask::task_wrapper(void* parameter) {
 
 void GrindControlTask::task_impl() {
     TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xFrequency = pdMS_TO_TICKS(SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
     
-    LOG_BLE("GrindControlTask started on Core %d at %dHz\n", 
+#if SYS_GRIND_CONTROL_SAMPLE_DRIVEN
+    LOG_BLE("GrindControlTask started on Core %d at %dHz (per sample in critical phases)\n", 
             xPortGetCoreID(), 1000 / SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
+#else
+    LOG_BLE("GrindControlTask started on Core %d at %dHz (%dHz in critical phases)\n", 
+            xPortGetCoreID(), 1000 / SYS_TASK_GRIND_CONTROL_INTERVAL_MS, 1000 / SYS_TASK_GRIND_CONTROL_FAST_INTERVAL_MS);
+#endif
     
     // When invoked via TaskManager wrapper, start_task() isn't used.
     // Ensure the internal run flag is set so the loop executes.
@@ -135,9 +144,23 @@ void GrindControlTask::task_impl() {
     // Reset performance metrics
     reset_performance_metrics();
     
-    // Main grind control loop
+#if SYS_GRIND_CONTROL_SAMPLE_DRIVEN
+    // Sample-driven phases wake on the sampling task's notification instead of the timer
+    weight_sampling_task.set_sample_listener(xTaskGetCurrentTaskHandle());
+#endif
+    
+    // Main grind control loop; the period follows the phase (GrindController::get_control_interval_ms())
+    uint32_t period_ms = SYS_TASK_GRIND_CONTROL_INTERVAL_MS;
+    int64_t last_cycle_start_us = 0;
+    int64_t next_release_us = 0;
     while (task_running) {
-        uint32_t cycle_start_time = millis();
+        int64_t cycle_start_us = esp_timer_get_time();
+        int64_t release_us = next_release_us != 0 ? next_release_us : cycle_start_us;
+        if (last_cycle_start_us != 0) {
+            perf_counters.record(PerfHistogram::GRIND_LOOP_PERIOD, (uint32_t)(cycle_start_us - last_cycle_start_us));
+        }
+        last_cycle_start_us = cycle_start_us;
+        trace.span_begin(TraceId::GRIND_CONTROL_CYCLE);
         
         // Update grind control logic
         update_grind_control();
@@ -148,15 +171,43 @@ void GrindControlTask::task_impl() {
         // Feed watchdog to prevent timeout
         esp_task_wdt_reset();
         
-        uint32_t cycle_end_time = millis();
-        
         // Record performance metrics
-        record_timing(cycle_start_time, cycle_end_time);
+        trace.span_end(TraceId::GRIND_CONTROL_CYCLE);
+        int64_t cycle_end_us = esp_timer_get_time();
+        record_timing(cycle_start_us, cycle_end_us);
+
+        // This cycle's deadline is one period of the rate it was released at
+        const int64_t period_us = (int64_t)period_ms * 1000;
+        if (check_deadline(release_us, cycle_start_us, cycle_end_us, period_us)) {
+            // Start over from now rather than letting vTaskDelayUntil run catch-up cycles back to back
+            xLastWakeTime = xTaskGetTickCount();
+            next_release_us = 0;
+        } else {
+            next_release_us = release_us + period_us;
+        }
+        
+        // A phase change this cycle sets the next period, so the first critical tick follows at the fast rate
+        period_ms = grind_channels.get_control_interval_ms();
+        if (next_release_us != 0) {
+            next_release_us = release_us + (int64_t)period_ms * 1000;
+        }
         
-        // Use vTaskDelayUntil for predictable timing (eliminates busy-wait)
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        if (grind_channels.is_sample_driven()) {
+            // One cycle per new sample, released when it arrives; the base interval is only the
+            // timeout for a stalled sensor, which the controller's own timeouts then handle
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SYS_TASK_GRIND_CONTROL_INTERVAL_MS));
+            xLastWakeTime = xTaskGetTickCount();
+            next_release_us = 0;
+        } else {
+            // Use vTaskDelayUntil for predictable timing (eliminates busy-wait)
+            vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(period_ms));
+        }
     }
     
+#if SYS_GRIND_CONTROL_SAMPLE_DRIVEN
+    weight_sampling_task.set_sample_listener(nullptr);
+#endif
+    
     // Remove task from watchdog monitoring before exit
     task_running = false;
     esp_task_wdt_delete(nullptr);
@@ -167,10 +218,22 @@ void GrindControlTask::task_impl() {
 void GrindControlTask::update_grind_control() {
     if (!grind_controller) return;
     
+#if HW_MOTOR_CURRENT_ENABLED
+    // Every cycle, grinding or not: motor-off windows track the sensor's zero
+    if (grinder) {
+        grinder->service_motor_current();
+    }
+#endif
+    
     // Execute main grind controller logic
     // This calls the existing GrindController::update() method which contains
-    // all the grinding algorithms, state machine, and pulse control logic
-    grind_controller->update();
+    // all the grinding algorithms, state machine, and pulse control logic;
+    // every grinder channel's, each publishing its weights into its own UI snapshot slot
+    for (uint8_t i = 0; i < grind_channels.count(); i++) {
+        GrindController* controller = grind_channels.get_controller(i);
+        controller->update();
+        controller->publish_ui_snapshot();
+    }
     
     // Update timing for performance tracking
     last_grind_update_time = millis();
@@ -179,19 +242,21 @@ void GrindControlTask::update_grind_control() {
 void GrindControlTask::monitor_grind_state() {
     if (!grind_controller) return;
     
-    bool current_grind_active = grind_controller->is_active();
+    bool current_grind_active = grind_channels.any_active();
     
     // Detect grind start
     if (!grind_active && current_grind_active) {
         grind_active = true;
         grind_start_time = millis();
-        LOG_BLE("GrindControlTask: Grind session started\n");
+        power_manager.set_hold(PowerHold::GRIND, true);
+        LOG_RT("GrindControlTask: Grind session started\n");
     }
     // Detect grind end
     else if (grind_active && !current_grind_active) {
         grind_active = false;
+        power_manager.set_hold(PowerHold::GRIND, false);
         uint32_t grind_duration = millis() - grind_start_time;
-        LOG_BLE("GrindControlTask: Grind session ended (duration: %lums)\n", grind_duration);
+        LOG_RT("GrindControlTask: Grind session ended (duration: %lums)\n", grind_duration);
     }
 }
 
@@ -200,14 +265,24 @@ bool GrindControlTask::validate_hardware_ready() const {
     bool weight_sensor_ready = (weight_sensor != nullptr && weight_sensor->is_initialized());
     bool grinder_ready = (grinder != nullptr && grinder->is_initialized());
     bool logger_ready = (logger != nullptr);
+    bool channels_ready = grind_channels.count() > 0;
+    for (uint8_t i = 0; i < grind_channels.count(); i++) {
+        WeightSensor* channel_sensor = grind_channels.get_weight_sensor(i);
+        Grinder* channel_grinder = grind_channels.get_grinder(i);
+        if (!channel_sensor || !channel_sensor->is_initialized() ||
+            !channel_grinder || !channel_grinder->is_initialized()) {
+            channels_ready = false;
+        }
+    }
     
     LOG_BLE("GrindControlTask hardware validation:\n");
     LOG_BLE("  grind_controller != nullptr: %s\n", grind_controller_ready ? "YES" : "NO");
     LOG_BLE("  weight_sensor ready: %s\n", weight_sensor_ready ? "YES" : "NO");
     LOG_BLE("  grinder ready: %s\n", grinder_ready ? "YES" : "NO");
     LOG_BLE("  logger != nullptr: %s\n", logger_ready ? "YES" : "NO");
+    LOG_BLE("  grinder channels ready: %s (%u)\n", channels_ready ? "YES" : "NO", (unsigned)grind_channels.count());
     
-    return grind_controller_ready && weight_sensor_ready && grinder_ready && logger_ready;
+    return grind_controller_ready && weight_sensor_ready && grinder_ready && logger_ready && channels_ready;
 }
 
 uint32_t GrindControlTask::get_grind_duration_ms() const {
@@ -217,21 +292,13 @@ uint32_t GrindControlTask::get_grind_duration_ms() const {
     return millis() - grind_start_time;
 }
 
-void GrindControlTask::record_timing(uint32_t start_time, uint32_t end_time) {
-    uint32_t cycle_duration = end_time - start_time;
-    
-    cycle_count++;
-    cycle_time_sum_ms += cycle_duration;
-    
-    if (cycle_duration < cycle_time_min_ms) {
-        cycle_time_min_ms = cycle_duration;
-    }
-    if (cycle_duration > cycle_time_max_ms) {
-        cycle_time_max_ms = cycle_duration;
-    }
+void GrindControlTask::record_timing(int64_t start_us, int64_t end_us) {
+    perf_counters.record(PerfTimer::GRIND_CONTROL_CYCLE, (uint32_t)(end_us - start_us));
     
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // Print task heartbeat every 10 seconds
+    uint32_t start_time = (uint32_t)(start_us / 1000);
+    uint32_t end_time = (uint32_t)(end_us / 1000);
     if (last_heartbeat_time == 0) {
         last_heartbeat_time = start_time;
     }
@@ -244,41 +311,114 @@ void GrindControlTask::record_timing(uint32_t start_time, uint32_t end_time) {
 #endif
 }
 
+bool GrindControlTask::check_deadline(int64_t release_us, int64_t start_us, int64_t end_us, int64_t period_us) {
+    int64_t deadline_us = release_us + period_us;
+    if (end_us <= deadline_us) {
+        if (deadline_stats.consecutive_missed != 0) {
+            portENTER_CRITICAL(&deadline_lock);
+            deadline_stats.consecutive_missed = 0;
+            portEXIT_CRITICAL(&deadline_lock);
+        }
+        return false;
+    }
+
+    uint32_t overrun_us = (uint32_t)(end_us - deadline_us);
+    DeadlineMissCause cause = (end_us - start_us) > period_us ? DeadlineMissCause::SLOW_CYCLE
+                                                                : DeadlineMissCause::LATE_WAKE;
+    // Only the selected grinder can be running (GrindChannels::select)
+    GrindController* selected = grind_channels.get_selected_controller();
+    uint8_t phase_id = selected ? selected->get_current_phase_id() : 0;
+    perf_counters.increment(PerfCount::GRIND_CONTROL_DEADLINE_MISSED);
+
+    portENTER_CRITICAL(&deadline_lock);
+    deadline_stats.missed_count++;
+    deadline_stats.consecutive_missed++;
+    deadline_stats.last_overrun_us = overrun_us;
+    if (overrun_us > deadline_stats.max_overrun_us) {
+        deadline_stats.max_overrun_us = overrun_us;
+    }
+    deadline_stats.last_missed_ms = millis();
+    deadline_stats.last_phase_id = phase_id;
+    deadline_stats.last_cause = cause;
+    uint32_t consecutive = deadline_stats.consecutive_missed;
+    portEXIT_CRITICAL(&deadline_lock);
+
+    // One line per run of misses, not per cycle
+    if (consecutive == 1) {
+        LOG_RT("[%lums GRIND_DEADLINE] Missed by %luus (%s, busy %luus, phase %s)\n",
+               millis(), overrun_us, get_cause_name(cause), (uint32_t)(end_us - start_us),
+               selected ? selected->get_phase_name() : "?");
+    }
+
+#if SYS_GRIND_CONTROL_DEADLINE_SAFE_OFF
+    // The same stall time at any rate: more misses in a row at the fast rate
+    const uint32_t max_missed = SYS_GRIND_CONTROL_MAX_MISSED_DEADLINES *
+        (uint32_t)((int64_t)SYS_TASK_GRIND_CONTROL_INTERVAL_MS * 1000 / period_us);
+    if (consecutive >= max_missed && grind_channels.fail_safe_stop("Err: overrun")) {
+        portENTER_CRITICAL(&deadline_lock);
+        deadline_stats.safe_off_count++;
+        portEXIT_CRITICAL(&deadline_lock);
+        LOG_RT("[%lums GRIND_DEADLINE] %lu deadlines missed in a row - motor stopped\n", millis(), consecutive);
+    }
+#endif
+    return true;
+}
+
+ControlLoopDeadlineStats GrindControlTask::get_deadline_stats() const {
+    portENTER_CRITICAL(&deadline_lock);
+    ControlLoopDeadlineStats stats = deadline_stats;
+    portEXIT_CRITICAL(&deadline_lock);
+    return stats;
+}
+
+const char* GrindControlTask::get_cause_name(DeadlineMissCause cause) {
+    switch (cause) {
+        case DeadlineMissCause::SLOW_CYCLE: return "slow_cycle";
+        case DeadlineMissCause::LATE_WAKE: return "late_wake";
+        default: return "none";
+    }
+}
+
 void GrindControlTask::print_heartbeat() const {
 #if SYS_ENABLE_REALTIME_HEARTBEAT
-    uint32_t avg_cycle_time = cycle_count > 0 ? cycle_time_sum_ms / cycle_count : 0;
-    float target_weight = grind_controller ? grind_controller->get_target_weight() : 0.0f;
-    float current_weight = weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f;
+    PerfTimerWindow cycles = perf_counters.get_window(PerfTimer::GRIND_CONTROL_CYCLE);
+    GrindController* selected = grind_channels.get_selected_controller();
+    WeightSensor* selected_sensor = grind_channels.get_weight_sensor(grind_channels.get_selected());
+    float target_weight = selected ? selected->get_target_weight() : 0.0f;
+    float current_weight = selected_sensor ? selected_sensor->get_weight_low_latency() : 0.0f;
     const char* grind_status = grind_active ? "ACTIVE" : "IDLE";
     
-    LOG_BLE("[%lums GRIND_CONTROL_HEARTBEAT] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | Status: %s | Target: %.1fg | Current: %.3fg | Build: #%d\n",
-           millis(), cycle_count, avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms,
+    ControlLoopDeadlineStats deadlines = get_deadline_stats();
+    
+    LOG_RT("[%lums GRIND_CONTROL_HEARTBEAT] Cycles: %lu/10s | Avg: %luus (%lu-%luus) | Missed: %lu (max +%luus) | Status: %s | Target: %.1fg | Current: %.3fg | Build: #%d\n",
+           millis(), cycles.count, cycles.avg_us, cycles.min_us, cycles.max_us,
+           deadlines.missed_count, deadlines.max_overrun_us,
            grind_status, target_weight, current_weight, BUILD_NUMBER);
 #endif
 }
 
 void GrindControlTask::reset_performance_metrics() {
-    cycle_count = 0;
-    cycle_time_sum_ms = 0;
-    cycle_time_min_ms = UINT32_MAX;
-    cycle_time_max_ms = 0;
+    perf_counters.reset_window(PerfTimer::GRIND_CONTROL_CYCLE);
 }
 
 void GrindControlTask::print_performance_stats() const {
     LOG_BLE("=== GrindControlTask Performance ===\n");
     LOG_BLE("Task running: %s\n", task_running ? "YES" : "NO");
     LOG_BLE("Grind active: %s\n", grind_active ? "YES" : "NO");
-    LOG_BLE("Cycle count: %lu\n", cycle_count);
+    PerfTimerWindow cycles = perf_counters.get_window(PerfTimer::GRIND_CONTROL_CYCLE);
+    LOG_BLE("Cycle count: %lu\n", cycles.total_count);
     
-    if (cycle_count > 0) {
-        uint32_t avg_cycle_time = cycle_time_sum_ms / cycle_count;
-        LOG_BLE("Average cycle time: %lums (%lu-%lums)\n", avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms);
+    if (cycles.count > 0) {
+        LOG_BLE("Average cycle time: %luus (%lu-%luus)\n", cycles.avg_us, cycles.min_us, cycles.max_us);
     }
     
     if (grind_active) {
         LOG_BLE("Current grind duration: %lums\n", get_grind_duration_ms());
     }
     
+    ControlLoopDeadlineStats deadlines = get_deadline_stats();
+    LOG_BLE("Missed deadlines: %lu (max overrun %luus, fail-safe stops %lu)\n",
+            deadlines.missed_count, deadlines.max_overrun_us, deadlines.safe_off_count);
     LOG_BLE("Last grind update: %lums ago\n", millis() - last_grind_update_time);
     LOG_BLE("===================================\n");
 }
@@ -286,10 +426,13 @@ void GrindControlTask::print_performance_stats() const {
 void GrindControlTask::handle_grind_error() {
     LOG_BLE("GrindControlTask: Grind error detected\n");
     
-    // Stop any active grinding
-    if (grinder && grinder->is_grinding()) {
-        grinder->stop();
-        LOG_BLE("GrindControlTask: Emergency grinder stop executed\n");
+    // Stop any active grinding, on every grinder channel
+    for (uint8_t i = 0; i < grind_channels.count(); i++) {
+        Grinder* channel_grinder = grind_channels.get_grinder(i);
+        if (channel_grinder && channel_grinder->is_grinding()) {
+            channel_grinder->stop();
+            LOG_BLE("GrindControlTask: Emergency grinder %u stop executed\n", (unsigned)i + 1);
+        }
     }
     
     // Reset grind state
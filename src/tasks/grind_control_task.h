@@ -3,6 +3,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include "../config/constants.h"
+#include "../system/perf_counters.h"
 
 // Forward declarations
 class GrindController;
@@ -10,6 +11,25 @@ class WeightSensor;
 class Grinder;
 class GrindLogger;
 
+// Why a control cycle ended past its deadline
+enum class DeadlineMissCause : uint8_t {
+    NONE,
+    SLOW_CYCLE,         // The cycle's own work took longer than a period (e.g. a blocking call)
+    LATE_WAKE,          // The work fit, but the cycle started late (preempted, or flash cache disabled)
+};
+
+// Deadline accounting of the control loop; a cycle's deadline is its scheduled wake plus one period
+struct ControlLoopDeadlineStats {
+    uint32_t missed_count;          // Cycles that ended past their deadline, since boot
+    uint32_t consecutive_missed;    // Current run of missed cycles
+    uint32_t max_overrun_us;        // Worst end-past-deadline since boot
+    uint32_t last_overrun_us;
+    uint32_t last_missed_ms;        // millis() of the last miss, 0 if none
+    uint8_t last_phase_id;          // GrindPhase at the last miss
+    DeadlineMissCause last_cause;
+    uint32_t safe_off_count;        // Grinds stopped by the missed-deadline fail-safe
+};
+
 /**
  * GrindControlTask - Dedicated Grind Control Processing
  * 
@@ -17,15 +37,18 @@ class GrindLogger;
  * that handles ONLY grind control operations and algorithms.
  * 
  * Responsibilities:
- * - Execute GrindController logic at 50Hz on Core 0
+ * - Execute GrindController logic at 50Hz on Core 0, once per new sample in the
+ *   critical phases (200Hz there without SYS_GRIND_CONTROL_SAMPLE_DRIVEN)
  * - Handle predictive grinding algorithms
  * - Manage grind state machine transitions
  * - Process pulse correction logic
  * - Coordinate with WeightSamplingTask for real-time data
+ * - Every grinder channel's controller (GrindChannels) in the same cycle
  * 
  * Architecture:
  * - Runs on Core 0 at high priority (3)
- * - Uses vTaskDelayUntil for predictable timing
+ * - Uses vTaskDelayUntil for predictable timing, or waits on WeightSamplingTask's
+ *   new-sample notification with the base interval as timeout
  * - Thread-safe coordination with weight sampling
  * - Real-time grind control without file I/O blocking
  */
@@ -42,11 +65,9 @@ private:
     volatile bool task_running;
     
     // Performance monitoring
-    uint32_t cycle_count;
-    uint32_t cycle_time_sum_ms;
-    uint32_t cycle_time_min_ms;
-    uint32_t cycle_time_max_ms;
-    uint32_t last_heartbeat_time;
+    uint32_t last_heartbeat_time;   // Cycle timing itself lives in perf_counters
+    ControlLoopDeadlineStats deadline_stats;
+    mutable portMUX_TYPE deadline_lock;
     
     // Grind control state
     bool grind_active;
@@ -73,7 +94,9 @@ public:
     uint32_t get_grind_duration_ms() const;
     
     // Performance monitoring
-    uint32_t get_cycle_count() const { return cycle_count; }
+    uint32_t get_cycle_count() const { return perf_counters.get_window(PerfTimer::GRIND_CONTROL_CYCLE).total_count; }
+    ControlLoopDeadlineStats get_deadline_stats() const;   // Any task
+    static const char* get_cause_name(DeadlineMissCause cause);
     void print_performance_stats() const;
     
     // Static task wrapper
@@ -92,7 +115,8 @@ private:
     void monitor_grind_state();
     
     // Performance tracking
-    void record_timing(uint32_t start_time, uint32_t end_time);
+    void record_timing(int64_t start_us, int64_t end_us);
+    bool check_deadline(int64_t release_us, int64_t start_us, int64_t end_us, int64_t period_us);  // true when missed
     void print_heartbeat() const;
     void reset_performance_metrics();
     
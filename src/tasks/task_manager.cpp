@@ -6,24 +6,55 @@
 #include "../system/state_machine.h"
 #include "../controllers/profile_controller.h"
 #include "../controllers/grind_controller.h"
+#include "../controllers/grind_channels.h"
+#include "../controllers/order_queue.h"
 #include "../bluetooth/manager.h"
 #include "../ui/ui_manager.h"
+#include "../network/mqtt_manager.h"
 #include "../hardware/WeightSensor.h"
 #include "../hardware/grinder.h"
 #include "../logging/grind_logging.h"
+#include "../system/trace.h"
+#include "../system/power_manager.h"
+#include "../system/boot_sequence.h"
+#include "../system/statistics_manager.h"
+#include "../system/binary_writer.h"
+#include "../system/crash_snapshot.h"
 #include "../config/constants.h"
 #include <esp_task_wdt.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <Arduino.h>
+#include <atomic>
+
+// Core 0 reservation: only the realtime tasks may be pinned there
+static_assert(SYS_TASK_CORE_WEIGHT_SAMPLING == SYS_CORE_REALTIME, "Weight sampling must run on the realtime core");
+static_assert(SYS_TASK_CORE_GRIND_CONTROL == SYS_CORE_REALTIME, "Grind control must run on the realtime core");
+static_assert(SYS_TASK_CORE_UI != SYS_CORE_REALTIME, "UI task must stay off the realtime core");
+static_assert(SYS_TASK_CORE_BLUETOOTH != SYS_CORE_REALTIME, "Bluetooth task must stay off the realtime core");
+static_assert(SYS_TASK_CORE_FILE_IO != SYS_CORE_REALTIME, "File I/O task must stay off the realtime core");
+static_assert(SYS_BLE_STACK_CORE != SYS_CORE_REALTIME, "BLE stack must stay off the realtime core");
+#if defined(ARDUINO_RUNNING_CORE) && ARDUINO_RUNNING_CORE == SYS_CORE_REALTIME
+#error "Arduino loop task must not run on the realtime core"
+#endif
 
 // Global instance
 TaskManager task_manager;
 
+namespace {
+// Written by the heap's failed-allocation hook, which can run on any task
+std::atomic<uint32_t> alloc_failure_count{0};
+std::atomic<uint32_t> last_alloc_failure_bytes{0};
+
+} // namespace
+
 // Static instance pointer for callbacks
 TaskManager* TaskManager::instance = nullptr;
 
 TaskManager::TaskManager() {
     memset(&task_handles, 0, sizeof(TaskHandles));
     memset(&task_queues, 0, sizeof(TaskQueues));
+    memset(job_timers, 0, sizeof(job_timers));
     
     hardware_manager = nullptr;
     state_machine = nullptr;
@@ -34,12 +65,22 @@ TaskManager::TaskManager() {
     
     tasks_initialized = false;
     ota_suspended = false;
+    memset(last_heartbeat_time, 0, sizeof(last_heartbeat_time));
+    memset(&memory_stats, 0, sizeof(memory_stats));
+    last_memory_sample_ms = 0;
+    memory_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+    memset(&cpu_stats, 0, sizeof(cpu_stats));
+    cpu_task_status = nullptr;
+    memset(last_cpu_run_time, 0, sizeof(last_cpu_run_time));
+    last_cpu_total_run_time = 0;
+    memset(last_cpu_cycle_count, 0, sizeof(last_cpu_cycle_count));
     instance = this;
 }
 
 TaskManager::~TaskManager() {
     delete_all_tasks();
     cleanup_queues();
+    heap_caps_free(cpu_task_status);
     
     if (instance == this) {
         instance = nullptr;
@@ -56,6 +97,7 @@ bool TaskManager::init(HardwareManager* hw_mgr, StateMachine* sm, ProfileControl
     ui_manager = ui;
     
     LOG_BLE("TaskManager: Initializing FreeRTOS task architecture...\n");
+    heap_caps_register_failed_alloc_callback(on_alloc_failed);
     
     // Validate hardware is ready
     if (!validate_hardware_ready()) {
@@ -76,6 +118,14 @@ bool TaskManager::init(HardwareManager* hw_mgr, StateMachine* sm, ProfileControl
         return false;
     }
     
+    // Periodic jobs notify the UI task, so they start once it exists
+    if (!create_job_timers()) {
+        LOG_BLE("ERROR: Failed to create periodic job timers\n");
+        delete_all_tasks();
+        cleanup_queues();
+        return false;
+    }
+    
     tasks_initialized = true;
     LOG_BLE("TaskManager: All tasks created successfully\n");
     
@@ -92,10 +142,12 @@ bool TaskManager::create_inter_task_queues() {
         return false;
     }
     
-    // File I/O queue
-    task_queues.file_io_queue = xQueueCreate(SYS_QUEUE_FILE_IO_SIZE, sizeof(FileIORequest));
-    if (!task_queues.file_io_queue) {
-        LOG_BLE("ERROR: Failed to create file_io_queue\n");
+    // File I/O lanes
+    task_queues.file_io_session_ring = xRingbufferCreate(SYS_FILE_IO_SESSION_RING_BYTES, RINGBUF_TYPE_NOSPLIT);
+    task_queues.file_io_preference_ring = xRingbufferCreate(SYS_FILE_IO_PREFERENCE_RING_BYTES, RINGBUF_TYPE_NOSPLIT);
+    task_queues.file_io_log_ring = xRingbufferCreate(SYS_FILE_IO_LOG_RING_BYTES, RINGBUF_TYPE_NOSPLIT);
+    if (!task_queues.file_io_session_ring || !task_queues.file_io_preference_ring || !task_queues.file_io_log_ring) {
+        LOG_BLE("ERROR: Failed to create file I/O lanes\n");
         return false;
     }
     
@@ -110,14 +162,21 @@ void TaskManager::cleanup_queues() {
         task_queues.ui_to_grind_queue = nullptr;
     }
     
-    if (task_queues.file_io_queue) {
-        vQueueDelete(task_queues.file_io_queue);
-        task_queues.file_io_queue = nullptr;
+    RingbufHandle_t* file_io_rings[] = {
+        &task_queues.file_io_session_ring, &task_queues.file_io_preference_ring, &task_queues.file_io_log_ring
+    };
+    for (RingbufHandle_t* ring : file_io_rings) {
+        if (*ring) {
+            vRingbufferDelete(*ring);
+            *ring = nullptr;
+        }
     }
 }
 
 bool TaskManager::create_all_tasks() {
     // Create tasks in order of priority (highest to lowest)
+    LOG_BLE("TaskManager: Core %d reserved for sampling/grind control, application tasks on Core %d\n",
+            SYS_CORE_REALTIME, SYS_CORE_APPLICATION);
     
     if (!create_weight_sampling_task()) {
         LOG_BLE("ERROR: Failed to create weight sampling task\n");
@@ -156,7 +215,7 @@ bool TaskManager::create_weight_sampling_task() {
         nullptr,
         SYS_TASK_PRIORITY_WEIGHT_SAMPLING,
         &task_handles.weight_sampling_task,
-        0  // Pin to Core 0
+        SYS_TASK_CORE_WEIGHT_SAMPLING
     );
     
     if (result != pdPASS) {
@@ -164,8 +223,8 @@ bool TaskManager::create_weight_sampling_task() {
         return false;
     }
     
-    LOG_BLE("✅ Weight Sampling Task created (Core 0, Priority %d, %dHz)\n", 
-            SYS_TASK_PRIORITY_WEIGHT_SAMPLING, 1000 / SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS);
+    LOG_BLE("✅ Weight Sampling Task created (Core %d, Priority %d, %dHz)\n", 
+            SYS_TASK_CORE_WEIGHT_SAMPLING, SYS_TASK_PRIORITY_WEIGHT_SAMPLING, 1000 / SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS);
     return true;
 }
 
@@ -177,7 +236,7 @@ bool TaskManager::create_grind_control_task() {
         nullptr,
         SYS_TASK_PRIORITY_GRIND_CONTROL,
         &task_handles.grind_control_task,
-        0  // Pin to Core 0
+        SYS_TASK_CORE_GRIND_CONTROL
     );
     
     if (result != pdPASS) {
@@ -185,8 +244,8 @@ bool TaskManager::create_grind_control_task() {
         return false;
     }
     
-    LOG_BLE("✅ Grind Control Task created (Core 0, Priority %d, %dHz)\n", 
-            SYS_TASK_PRIORITY_GRIND_CONTROL, 1000 / SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
+    LOG_BLE("✅ Grind Control Task created (Core %d, Priority %d, %dHz)\n", 
+            SYS_TASK_CORE_GRIND_CONTROL, SYS_TASK_PRIORITY_GRIND_CONTROL, 1000 / SYS_TASK_GRIND_CONTROL_INTERVAL_MS);
     return true;
 }
 
@@ -198,7 +257,7 @@ bool TaskManager::create_ui_render_task() {
         nullptr,
         SYS_TASK_PRIORITY_UI,
         &task_handles.ui_render_task,
-        1  // Pin to Core 1
+        SYS_TASK_CORE_UI
     );
     
     if (result != pdPASS) {
@@ -206,8 +265,8 @@ bool TaskManager::create_ui_render_task() {
         return false;
     }
     
-    LOG_BLE("✅ UI Render Task created (Core 1, Priority %d, %dHz)\n", 
-            SYS_TASK_PRIORITY_UI, 1000 / SYS_TASK_UI_INTERVAL_MS);
+    LOG_BLE("✅ UI Render Task created (Core %d, Priority %d, %dHz)\n", 
+            SYS_TASK_CORE_UI, SYS_TASK_PRIORITY_UI, 1000 / SYS_TASK_UI_INTERVAL_MS);
     return true;
 }
 
@@ -220,7 +279,7 @@ bool TaskManager::create_bluetooth_task() {
         nullptr,
         SYS_TASK_PRIORITY_BLUETOOTH,
         &task_handles.bluetooth_task,
-        1  // Pin to Core 1
+        SYS_TASK_CORE_BLUETOOTH
     );
     
     if (result != pdPASS) {
@@ -228,8 +287,8 @@ bool TaskManager::create_bluetooth_task() {
         return false;
     }
     
-    LOG_BLE("✅ Bluetooth Task created (Core 1, Priority %d, %dHz)\n", 
-            SYS_TASK_PRIORITY_BLUETOOTH, 1000 / SYS_TASK_BLUETOOTH_INTERVAL_MS);
+    LOG_BLE("✅ Bluetooth Task created (Core %d, Priority %d, %dHz)\n", 
+            SYS_TASK_CORE_BLUETOOTH, SYS_TASK_PRIORITY_BLUETOOTH, 1000 / SYS_TASK_BLUETOOTH_INTERVAL_MS);
     return true;
 }
 
@@ -241,7 +300,7 @@ bool TaskManager::create_file_io_task() {
         nullptr,
         SYS_TASK_PRIORITY_FILE_IO,
         &task_handles.file_io_task,
-        1  // Pin to Core 1
+        SYS_TASK_CORE_FILE_IO
     );
     
     if (result != pdPASS) {
@@ -249,11 +308,19 @@ bool TaskManager::create_file_io_task() {
         return false;
     }
     
-    LOG_BLE("✅ File I/O Task created (Core 1, Priority %d, %dHz)\n", 
-            SYS_TASK_PRIORITY_FILE_IO, 1000 / SYS_TASK_FILE_IO_INTERVAL_MS);
+    LOG_BLE("✅ File I/O Task created (Core %d, Priority %d, %dHz)\n", 
+            SYS_TASK_CORE_FILE_IO, SYS_TASK_PRIORITY_FILE_IO, 1000 / SYS_TASK_FILE_IO_INTERVAL_MS);
     return true;
 }
 
+void TaskManager::set_sampling_power_mode(SamplingPowerMode mode) {
+    weight_sampling_task.request_power_mode(mode);
+}
+
+bool TaskManager::consume_sampling_weight_wake() {
+    return weight_sampling_task.consume_weight_wake();
+}
+
 void TaskManager::suspend_hardware_tasks() {
     if (ota_suspended) return;
     
@@ -294,7 +361,66 @@ void TaskManager::resume_hardware_tasks() {
     ota_suspended = false;
 }
 
+bool TaskManager::create_job_timers() {
+    static const char* const kJobNames[(size_t)PeriodicJob::COUNT] = {"job_diag", "job_screen", "job_uptime"};
+    const TickType_t periods[(size_t)PeriodicJob::COUNT] = {
+        pdMS_TO_TICKS(SYS_JOB_DIAGNOSTICS_INTERVAL_MS),
+        pdMS_TO_TICKS(SYS_JOB_SCREEN_TIMEOUT_INTERVAL_MS),
+        pdMS_TO_TICKS(SYS_JOB_UPTIME_INTERVAL_MINUTES * 60UL * 1000UL),
+    };
+
+    for (size_t i = 0; i < (size_t)PeriodicJob::COUNT; i++) {
+        job_timers[i] = xTimerCreate(kJobNames[i], periods[i], pdTRUE, (void*)(uintptr_t)i, on_job_timer);
+        if (!job_timers[i] || xTimerStart(job_timers[i], 0) != pdPASS) {
+            delete_job_timers();
+            return false;
+        }
+    }
+    return true;
+}
+
+void TaskManager::delete_job_timers() {
+    for (TimerHandle_t& timer : job_timers) {
+        if (timer) {
+            xTimerDelete(timer, 0);
+            timer = nullptr;
+        }
+    }
+}
+
+// Timer service task: only hand the job to the UI task, never run it here
+void TaskManager::on_job_timer(TimerHandle_t timer) {
+    uint32_t job = (uint32_t)(uintptr_t)pvTimerGetTimerID(timer);
+    if (instance && instance->task_handles.ui_render_task) {
+        xTaskNotify(instance->task_handles.ui_render_task, 1UL << job, eSetBits);
+    }
+}
+
+void TaskManager::run_periodic_jobs(uint32_t job_bits) {
+    if (ui_manager && (job_bits & (1UL << (uint32_t)PeriodicJob::DIAGNOSTICS))) {
+        ui_manager->run_diagnostics();
+    }
+    if (ui_manager && (job_bits & (1UL << (uint32_t)PeriodicJob::SCREEN_TIMEOUT))) {
+        ui_manager->run_screen_timeout();
+    }
+    if (job_bits & (1UL << (uint32_t)PeriodicJob::UPTIME)) {
+        statistics_manager.update_uptime(SYS_JOB_UPTIME_INTERVAL_MINUTES);
+    }
+}
+
+// Bluetooth task: an OTA transfer starts and ends in BluetoothManager::handle()
+void TaskManager::update_ota_suspension() {
+    bool updating = bluetooth_manager && bluetooth_manager->is_updating();
+    if (updating && !ota_suspended) {
+        suspend_hardware_tasks();
+    } else if (!updating && ota_suspended) {
+        resume_hardware_tasks();
+    }
+}
+
 void TaskManager::delete_all_tasks() {
+    delete_job_timers();
+    
     if (task_handles.weight_sampling_task) {
         vTaskDelete(task_handles.weight_sampling_task);
         task_handles.weight_sampling_task = nullptr;
@@ -408,18 +534,45 @@ void TaskManager::grind_control_task_impl() {
 }
 
 void TaskManager::ui_render_task_impl() {
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xFrequency = pdMS_TO_TICKS(SYS_TASK_UI_INTERVAL_MS);
+    uint32_t job_bits = 0;
     
     LOG_BLE("UI Render Task started on Core %d\n", xPortGetCoreID());
+
+    // Queued grind events, state events and BLE status messages wake an idle UI at once
+    if (state_machine) {
+        state_machine->set_event_consumer(xTaskGetCurrentTaskHandle());
+    }
+    for (uint8_t i = 0; i < grind_channels.count(); i++) {
+        grind_channels.get_controller(i)->set_ui_event_consumer(xTaskGetCurrentTaskHandle());
+    }
+    if (bluetooth_manager) {
+        bluetooth_manager->set_ui_status_consumer(xTaskGetCurrentTaskHandle());
+    }
+    order_queue.set_consumer(xTaskGetCurrentTaskHandle());
+#if NETWORK_MQTT_ENABLED
+    mqtt_manager.set_command_consumer(xTaskGetCurrentTaskHandle());
+#endif
+    // So does a touch when the controller's INT line is wired
+    if (hardware_manager &&
+        hardware_manager->get_display()->get_touch_driver()->enable_interrupt(xTaskGetCurrentTaskHandle())) {
+        LOG_BLE("UI Render Task: touch interrupt on GPIO %d\n", HW_TOUCH_INT_PIN);
+    }
     
     while (true) {
-        uint32_t start_time = millis();
+        TickType_t frame_start = xTaskGetTickCount();
+        int64_t start_us = esp_timer_get_time();
+        trace.span_begin(TraceId::UI_RENDER_CYCLE);
+
+        // Periodic jobs whose timers fired since the last frame
+        if (job_bits) {
+            run_periodic_jobs(job_bits);
+        }
 
         // Process queued UI events from Core 0 here to ensure
-        // all LVGL interactions happen on the UI task context
-        if (grind_controller) {
-            grind_controller->process_queued_ui_events();
+        // all LVGL interactions happen on the UI task context; every grinder
+        // channel's, the unselected ones' without a UI callback
+        for (uint8_t i = 0; i < grind_channels.count(); i++) {
+            grind_channels.get_controller(i)->process_queued_ui_events();
         }
 
         // UI rendering separated from touch handling
@@ -440,15 +593,35 @@ void TaskManager::ui_render_task_impl() {
         }
         
         // LVGL processing and display update - this contains lv_timer_handler()
+        uint32_t until_next_timer_ms = LV_NO_TIMER_READY;
+        bool render_idle = false;
         if (hardware_manager) {
-            hardware_manager->get_display()->update();
+            DisplayManager* display = hardware_manager->get_display();
+            until_next_timer_ms = display->update();
+            bool render_active = display->is_render_active();
+            render_idle = ui_manager && ui_manager->allows_idle_rendering() && !render_active;
+            // Touch feedback and animations draw at the full clock
+            power_manager.set_hold(PowerHold::UI_ACTIVE, render_active);
+            display->set_render_idle(render_idle);
         }
         
-        uint32_t end_time = millis();
-        record_task_timing(2, start_time, end_time); // Task index 2 for UI render
+        trace.span_end(TraceId::UI_RENDER_CYCLE);
+        record_task_timing(PerfTimer::UI_RENDER_CYCLE, start_us, esp_timer_get_time());
         
-        // Use vTaskDelayUntil for predictable timing
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        // Screen's frame rate while anything is drawing or was touched; an idle screen sleeps until
+        // the next LVGL timer, a touch poll or a notification (job timers, queued UI work)
+        TickType_t wait_ticks;
+        if (render_idle) {
+            wait_ticks = pdMS_TO_TICKS(min(until_next_timer_ms, (uint32_t)SYS_TASK_UI_IDLE_POLL_MS));
+        } else {
+            // Active cycles follow the current screen's frame period (UIManager::frame_period_for_state)
+            TickType_t frame_ticks = pdMS_TO_TICKS(hardware_manager ? hardware_manager->get_display()->get_frame_period_ms()
+                                                                    : SYS_TASK_UI_INTERVAL_MS);
+            TickType_t elapsed = xTaskGetTickCount() - frame_start;
+            wait_ticks = elapsed < frame_ticks ? frame_ticks - elapsed : 0;
+        }
+        job_bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &job_bits, wait_ticks);
     }
 }
 
@@ -459,16 +632,37 @@ void TaskManager::bluetooth_task_impl() {
     
     LOG_BLE("Bluetooth Task started on Core %d\n", xPortGetCoreID());
     
+    // Enable BLE by default during bootup with 2-minute timeout; bringing up the
+    // stack here keeps it off setup()'s path to the first frame
+    if (bluetooth_manager) {
+        bluetooth_manager->enable_during_bootup();
+    }
+    boot_sequence.mark(BootStage::BLUETOOTH);
+    bool boot_timeline_printed = false;
+    
     while (true) {
+        int64_t start_us = esp_timer_get_time();
         uint32_t start_time = millis();
+        trace.span_begin(TraceId::BLUETOOTH_CYCLE);
         
         // Use existing bluetooth manager handle method
         if (bluetooth_manager) {
             bluetooth_manager->handle();
         }
+        update_ota_suspension();
+        
+        if (!boot_timeline_printed && boot_sequence.is_complete()) {
+            boot_sequence.print();
+            boot_timeline_printed = true;
+        }
+        
+        if (start_time - last_memory_sample_ms >= SYS_TASK_MEMORY_SAMPLE_INTERVAL_MS) {
+            sample_memory_stats();
+            sample_cpu_stats();
+        }
         
-        uint32_t end_time = millis();
-        record_task_timing(4, start_time, end_time); // Task index 4 for bluetooth
+        trace.span_end(TraceId::BLUETOOTH_CYCLE);
+        record_task_timing(PerfTimer::BLUETOOTH_CYCLE, start_us, esp_timer_get_time());
         
         // Use vTaskDelayUntil for predictable timing
         vTaskDelayUntil(&xLastWakeTime, xFrequency);
@@ -480,46 +674,28 @@ void TaskManager::file_io_task_impl() {
     file_io_task.task_impl();
 }
 
-void TaskManager::record_task_timing(int task_index, uint32_t start_time, uint32_t end_time) {
-    if (task_index < 0 || task_index >= 6) return;
-    
-    TaskMetrics& metrics = task_metrics[task_index];
-    uint32_t cycle_duration = end_time - start_time;
-    
-    metrics.cycle_count++;
-    metrics.cycle_time_sum_ms += cycle_duration;
-    
-    if (cycle_duration < metrics.cycle_time_min_ms) {
-        metrics.cycle_time_min_ms = cycle_duration;
-    }
-    if (cycle_duration > metrics.cycle_time_max_ms) {
-        metrics.cycle_time_max_ms = cycle_duration;
-    }
+void TaskManager::record_task_timing(PerfTimer timer, int64_t start_us, int64_t end_us) {
+    perf_counters.record(timer, (uint32_t)(end_us - start_us));
     
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // Print task heartbeat every 10 seconds
-    if (end_time - metrics.last_heartbeat_time >= SYS_REALTIME_HEARTBEAT_INTERVAL_MS) {
-        const char* task_names[] = {"WeightSampling", "GrindControl", "UIRender", "Bluetooth", "FileIO"};
-        print_task_heartbeat(task_index, task_names[task_index]);
-        
-        // Reset metrics
-        metrics.cycle_count = 0;
-        metrics.cycle_time_sum_ms = 0;
-        metrics.cycle_time_min_ms = UINT32_MAX;
-        metrics.cycle_time_max_ms = 0;
-        metrics.last_heartbeat_time = end_time;
+    uint32_t end_time = (uint32_t)(end_us / 1000);
+    uint32_t& last_heartbeat = last_heartbeat_time[(size_t)timer];
+    if (end_time - last_heartbeat >= SYS_REALTIME_HEARTBEAT_INTERVAL_MS) {
+        print_task_heartbeat(timer);
+        perf_counters.reset_window(timer);
+        last_heartbeat = end_time;
     }
 #endif
 }
 
-void TaskManager::print_task_heartbeat(int task_index, const char* task_name) const {
+void TaskManager::print_task_heartbeat(PerfTimer timer) const {
 #if SYS_ENABLE_REALTIME_HEARTBEAT
-    const TaskMetrics& metrics = task_metrics[task_index];
-    uint32_t avg_cycle_time = metrics.cycle_count > 0 ? metrics.cycle_time_sum_ms / metrics.cycle_count : 0;
+    PerfTimerWindow cycles = perf_counters.get_window(timer);
     
-    LOG_BLE("[%lums TASK_HEARTBEAT_%s] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | Build: #%d\n",
-           millis(), task_name, metrics.cycle_count, avg_cycle_time, 
-           metrics.cycle_time_min_ms, metrics.cycle_time_max_ms, BUILD_NUMBER);
+    LOG_BLE("[%lums TASK_HEARTBEAT %s] Cycles: %lu/10s | Avg: %luus (%lu-%luus) | Build: #%d\n",
+           millis(), PerfCounters::get_name(timer), cycles.count, cycles.avg_us,
+           cycles.min_us, cycles.max_us, BUILD_NUMBER);
 #endif
 }
 
@@ -544,3 +720,230 @@ void TaskManager::print_task_status() const {
     LOG_BLE("  FileIO: %s\n", task_handles.file_io_task ? "RUNNING" : "NULL");
     LOG_BLE("========================\n");
 }
+
+void TaskManager::on_alloc_failed(size_t size, uint32_t caps, const char* function_name) {
+    alloc_failure_count.fetch_add(1, std::memory_order_relaxed);
+    last_alloc_failure_bytes.store((uint32_t)size, std::memory_order_relaxed);
+}
+
+void TaskManager::sample_memory_stats() {
+    const TaskHandle_t handles[TASK_MANAGER_TASK_COUNT] = {
+        task_handles.weight_sampling_task, task_handles.grind_control_task, task_handles.ui_render_task,
+        task_handles.bluetooth_task, task_handles.file_io_task
+    };
+    const uint32_t stack_sizes[TASK_MANAGER_TASK_COUNT] = {
+        SYS_TASK_WEIGHT_SAMPLING_STACK_SIZE, SYS_TASK_GRIND_CONTROL_STACK_SIZE, SYS_TASK_UI_STACK_SIZE,
+        SYS_TASK_BLUETOOTH_STACK_SIZE, SYS_TASK_FILE_IO_STACK_SIZE
+    };
+
+    TaskMemoryStats stats;
+    for (int i = 0; i < TASK_MANAGER_TASK_COUNT; i++) {
+        stats.stack_size_bytes[i] = stack_sizes[i];
+        // ESP-IDF counts stack depth in bytes, so the high-water mark is bytes too
+        stats.stack_min_free_bytes[i] = handles[i] ? (uint32_t)uxTaskGetStackHighWaterMark(handles[i]) : 0;
+    }
+    stats.internal_free_bytes = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    stats.internal_min_free_bytes = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    stats.internal_largest_block_bytes = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    stats.psram_free_bytes = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    stats.psram_largest_block_bytes = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    stats.alloc_failure_count = alloc_failure_count.load(std::memory_order_relaxed);
+    stats.last_alloc_failure_bytes = last_alloc_failure_bytes.load(std::memory_order_relaxed);
+    stats.sampled_ms = millis();
+
+    portENTER_CRITICAL(&memory_stats_lock);
+    memory_stats = stats;
+    portEXIT_CRITICAL(&memory_stats_lock);
+    last_memory_sample_ms = stats.sampled_ms;
+    crash_snapshot.refresh(stats, grind_control_task.get_deadline_stats());
+
+    print_memory_heartbeat(stats);
+}
+
+TaskMemoryStats TaskManager::get_memory_stats() const {
+    portENTER_CRITICAL(&memory_stats_lock);
+    TaskMemoryStats stats = memory_stats;
+    portEXIT_CRITICAL(&memory_stats_lock);
+    return stats;
+}
+
+size_t TaskManager::format_memory_json(char* buffer, size_t buffer_size) const {
+    // "stack_free":[bytes per task],"heap_kb":[int free,int min,int largest,psram free,psram largest]
+    TaskMemoryStats stats = get_memory_stats();
+    int written = snprintf(buffer, buffer_size,
+        "\"stack_free\":[%lu,%lu,%lu,%lu,%lu],"
+        "\"heap_kb\":[%lu,%lu,%lu,%lu,%lu],"
+        "\"alloc_fail\":%lu",
+        (unsigned long)stats.stack_min_free_bytes[0], (unsigned long)stats.stack_min_free_bytes[1],
+        (unsigned long)stats.stack_min_free_bytes[2], (unsigned long)stats.stack_min_free_bytes[3],
+        (unsigned long)stats.stack_min_free_bytes[4],
+        (unsigned long)(stats.internal_free_bytes / 1024), (unsigned long)(stats.internal_min_free_bytes / 1024),
+        (unsigned long)(stats.internal_largest_block_bytes / 1024), (unsigned long)(stats.psram_free_bytes / 1024),
+        (unsigned long)(stats.psram_largest_block_bytes / 1024),
+        (unsigned long)stats.alloc_failure_count);
+    if (written < 0 || (size_t)written >= buffer_size) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return (size_t)written;
+}
+
+void TaskManager::format_memory_binary(BinaryWriter& writer) const {
+    TaskMemoryStats stats = get_memory_stats();
+    writer.u8(TASK_MANAGER_TASK_COUNT);
+    for (uint32_t bytes : stats.stack_min_free_bytes) {
+        writer.u16_clamped(bytes);
+    }
+    writer.u16_clamped(stats.internal_free_bytes / 1024);
+    writer.u16_clamped(stats.internal_min_free_bytes / 1024);
+    writer.u16_clamped(stats.internal_largest_block_bytes / 1024);
+    writer.u16_clamped(stats.psram_free_bytes / 1024);
+    writer.u16_clamped(stats.psram_largest_block_bytes / 1024);
+    writer.u32(stats.alloc_failure_count);
+}
+
+void TaskManager::sample_cpu_stats() {
+    if (!cpu_task_status) {
+        cpu_task_status = (TaskStatus_t*)heap_caps_malloc(SYS_TASK_CPU_STATS_MAX_TASKS * sizeof(TaskStatus_t), MALLOC_CAP_SPIRAM);
+        if (!cpu_task_status) {
+            return;
+        }
+    }
+    // Our tasks, then the idle task of each core
+    const TaskHandle_t handles[TASK_MANAGER_TASK_COUNT + 2] = {
+        task_handles.weight_sampling_task, task_handles.grind_control_task, task_handles.ui_render_task,
+        task_handles.bluetooth_task, task_handles.file_io_task,
+        xTaskGetIdleTaskHandleForCore(0), xTaskGetIdleTaskHandleForCore(1)
+    };
+
+    // The run-time counter is esp_timer µs, so the total is wall time and each core has all of it.
+    // The 32-bit deltas wrap after 71 minutes, far beyond a sample window.
+    configRUN_TIME_COUNTER_TYPE total_run_time = 0;
+    UBaseType_t count = uxTaskGetSystemState(cpu_task_status, SYS_TASK_CPU_STATS_MAX_TASKS, &total_run_time);
+    if (count == 0) {
+        return;                                 // More tasks than the array holds
+    }
+    uint32_t run_time[TASK_MANAGER_TASK_COUNT + 2] = {};
+    for (UBaseType_t t = 0; t < count; t++) {
+        for (int i = 0; i < TASK_MANAGER_TASK_COUNT + 2; i++) {
+            if (handles[i] && cpu_task_status[t].xHandle == handles[i]) {
+                run_time[i] = (uint32_t)cpu_task_status[t].ulRunTimeCounter;
+            }
+        }
+    }
+    uint32_t cycle_count[TASK_MANAGER_TASK_COUNT];
+    for (int i = 0; i < TASK_MANAGER_TASK_COUNT; i++) {
+        cycle_count[i] = perf_counters.get_window((PerfTimer)i).total_count;
+    }
+
+    TaskCpuStats stats;
+    memset(&stats, 0, sizeof(stats));
+    const uint32_t window_us = (uint32_t)total_run_time - last_cpu_total_run_time;
+    const bool have_window = last_cpu_total_run_time != 0 && window_us > 0;
+    stats.window_ms = have_window ? window_us / 1000 : 0;
+    stats.sampled_ms = millis();
+    uint32_t core_busy_permille[2] = {0, 0};
+    for (int i = 0; i < TASK_MANAGER_TASK_COUNT; i++) {
+        BaseType_t core = handles[i] ? xTaskGetCoreID(handles[i]) : tskNO_AFFINITY;
+        stats.task_core[i] = (core == 0 || core == 1) ? (int8_t)core : -1;
+        if (have_window) {
+            stats.task_permille[i] = (uint16_t)((uint64_t)(run_time[i] - last_cpu_run_time[i]) * 1000 / window_us);
+            stats.task_wakeups_per_s[i] = (uint16_t)min<uint64_t>(
+                (uint64_t)(cycle_count[i] - last_cpu_cycle_count[i]) * 1000000 / window_us, UINT16_MAX);
+            if (stats.task_core[i] >= 0) {
+                core_busy_permille[stats.task_core[i]] += stats.task_permille[i];
+            }
+        }
+    }
+    for (int core = 0; core < 2 && have_window; core++) {
+        uint32_t idle = (uint32_t)((uint64_t)(run_time[TASK_MANAGER_TASK_COUNT + core] -
+                                              last_cpu_run_time[TASK_MANAGER_TASK_COUNT + core]) * 1000 / window_us);
+        stats.idle_permille[core] = (uint16_t)min<uint32_t>(idle, 1000);
+        uint32_t accounted = stats.idle_permille[core] + core_busy_permille[core];
+        stats.other_permille[core] = accounted < 1000 ? (uint16_t)(1000 - accounted) : 0;
+    }
+
+    memcpy(last_cpu_run_time, run_time, sizeof(last_cpu_run_time));
+    memcpy(last_cpu_cycle_count, cycle_count, sizeof(last_cpu_cycle_count));
+    last_cpu_total_run_time = (uint32_t)total_run_time;
+
+    portENTER_CRITICAL(&memory_stats_lock);
+    cpu_stats = stats;
+    portEXIT_CRITICAL(&memory_stats_lock);
+
+    if (have_window) {
+        print_cpu_heartbeat(stats);
+    }
+}
+
+TaskCpuStats TaskManager::get_cpu_stats() const {
+    portENTER_CRITICAL(&memory_stats_lock);
+    TaskCpuStats stats = cpu_stats;
+    portEXIT_CRITICAL(&memory_stats_lock);
+    return stats;
+}
+
+size_t TaskManager::format_cpu_json(char* buffer, size_t buffer_size) const {
+    // "cpu_pm":[permille per task],"wake_hz":[per task],"idle_pm":[core 0,core 1]
+    TaskCpuStats stats = get_cpu_stats();
+    int written = snprintf(buffer, buffer_size,
+        "\"cpu_pm\":[%u,%u,%u,%u,%u],"
+        "\"wake_hz\":[%u,%u,%u,%u,%u],"
+        "\"idle_pm\":[%u,%u]",
+        stats.task_permille[0], stats.task_permille[1], stats.task_permille[2],
+        stats.task_permille[3], stats.task_permille[4],
+        stats.task_wakeups_per_s[0], stats.task_wakeups_per_s[1], stats.task_wakeups_per_s[2],
+        stats.task_wakeups_per_s[3], stats.task_wakeups_per_s[4],
+        stats.idle_permille[0], stats.idle_permille[1]);
+    if (written < 0 || (size_t)written >= buffer_size) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return (size_t)written;
+}
+
+void TaskManager::format_cpu_binary(BinaryWriter& writer) const {
+    TaskCpuStats stats = get_cpu_stats();
+    writer.u8(TASK_MANAGER_TASK_COUNT);
+    for (int i = 0; i < TASK_MANAGER_TASK_COUNT; i++) {
+        writer.u8((uint8_t)stats.task_core[i]);
+        writer.u16(stats.task_permille[i]);
+        writer.u16(stats.task_wakeups_per_s[i]);
+    }
+    writer.u16(stats.idle_permille[0]);
+    writer.u16(stats.idle_permille[1]);
+}
+
+void TaskManager::print_cpu_heartbeat(const TaskCpuStats& stats) const {
+#if SYS_ENABLE_REALTIME_HEARTBEAT
+    LOG_BLE("[%lums CPU_HEARTBEAT] %% of a core (wakeups/s) over %lums: WS %u.%u (%u) GC %u.%u (%u) UI %u.%u (%u) "
+            "BT %u.%u (%u) IO %u.%u (%u) | Core 0: idle %u.%u other %u.%u | Core 1: idle %u.%u other %u.%u\n",
+            (unsigned long)stats.sampled_ms, (unsigned long)stats.window_ms,
+            stats.task_permille[0] / 10, stats.task_permille[0] % 10, stats.task_wakeups_per_s[0],
+            stats.task_permille[1] / 10, stats.task_permille[1] % 10, stats.task_wakeups_per_s[1],
+            stats.task_permille[2] / 10, stats.task_permille[2] % 10, stats.task_wakeups_per_s[2],
+            stats.task_permille[3] / 10, stats.task_permille[3] % 10, stats.task_wakeups_per_s[3],
+            stats.task_permille[4] / 10, stats.task_permille[4] % 10, stats.task_wakeups_per_s[4],
+            stats.idle_permille[0] / 10, stats.idle_permille[0] % 10,
+            stats.other_permille[0] / 10, stats.other_permille[0] % 10,
+            stats.idle_permille[1] / 10, stats.idle_permille[1] % 10,
+            stats.other_permille[1] / 10, stats.other_permille[1] % 10);
+#endif
+}
+
+void TaskManager::print_memory_heartbeat(const TaskMemoryStats& stats) const {
+#if SYS_ENABLE_REALTIME_HEARTBEAT
+    LOG_BLE("[%lums MEMORY_HEARTBEAT] Stack free: WS %lu/%lu GC %lu/%lu UI %lu/%lu BT %lu/%lu IO %lu/%lu | "
+            "Internal: %luKB (min %luKB, block %luKB) | PSRAM: %luKB (block %luKB) | Alloc fail: %lu\n",
+            (unsigned long)stats.sampled_ms,
+            (unsigned long)stats.stack_min_free_bytes[0], (unsigned long)stats.stack_size_bytes[0],
+            (unsigned long)stats.stack_min_free_bytes[1], (unsigned long)stats.stack_size_bytes[1],
+            (unsigned long)stats.stack_min_free_bytes[2], (unsigned long)stats.stack_size_bytes[2],
+            (unsigned long)stats.stack_min_free_bytes[3], (unsigned long)stats.stack_size_bytes[3],
+            (unsigned long)stats.stack_min_free_bytes[4], (unsigned long)stats.stack_size_bytes[4],
+            (unsigned long)(stats.internal_free_bytes / 1024), (unsigned long)(stats.internal_min_free_bytes / 1024),
+            (unsigned long)(stats.internal_largest_block_bytes / 1024),
+            (unsigned long)(stats.psram_free_bytes / 1024), (unsigned long)(stats.psram_largest_block_bytes / 1024),
+            (unsigned long)stats.alloc_failure_count);
+#endif
+}
@@ -3,7 +3,11 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
+#include <freertos/ringbuf.h>
+#include <freertos/timers.h>
 #include "../config/constants.h"
+#include "weight_sampling_task.h"
+#include "../system/perf_counters.h"
 
 // Forward declarations
 class HardwareManager;
@@ -12,6 +16,7 @@ class ProfileController;
 class GrindController;
 class BluetoothManager;
 class UIManager;
+class BinaryWriter;
 
 // Task handle storage for all FreeRTOS tasks
 struct TaskHandles {
@@ -25,20 +30,49 @@ struct TaskHandles {
 // Inter-task communication queues
 struct TaskQueues {
     QueueHandle_t ui_to_grind_queue;        // UI events → Grind Controller
-    QueueHandle_t file_io_queue;            // Any task → File I/O
+    RingbufHandle_t file_io_session_ring;       // Any task → File I/O lanes (variable-length FileIORequestHeader items)
+    RingbufHandle_t file_io_preference_ring;
+    RingbufHandle_t file_io_log_ring;
 };
 
-// Task timing metrics for monitoring
-struct TaskMetrics {
-    uint32_t cycle_count;
-    uint32_t cycle_time_sum_ms;
-    uint32_t cycle_time_min_ms;
-    uint32_t cycle_time_max_ms;
-    uint32_t last_heartbeat_time;
-    
-    TaskMetrics() : cycle_count(0), cycle_time_sum_ms(0), 
-                   cycle_time_min_ms(UINT32_MAX), cycle_time_max_ms(0), 
-                   last_heartbeat_time(0) {}
+#define TASK_MANAGER_TASK_COUNT 5
+
+// Periodic jobs: each software timer sets its bit in the UI task's notification value and the
+// UI task runs the job at the start of its next frame, so no job runs on the timer service task.
+enum class PeriodicJob : uint8_t {
+    DIAGNOSTICS,                    // UIManager::run_diagnostics()
+    SCREEN_TIMEOUT,                 // UIManager::run_screen_timeout()
+    UPTIME,                         // StatisticsManager::update_uptime()
+    COUNT
+};
+
+// Memory headroom, sampled every SYS_TASK_MEMORY_SAMPLE_INTERVAL_MS on the Bluetooth task.
+// Stack figures are the least free stack each task has had since it started, in task order
+// WeightSampling, GrindControl, UIRender, Bluetooth, FileIO; 0 for a task that does not exist.
+struct TaskMemoryStats {
+    uint32_t stack_size_bytes[TASK_MANAGER_TASK_COUNT];
+    uint32_t stack_min_free_bytes[TASK_MANAGER_TASK_COUNT];
+    uint32_t internal_free_bytes;
+    uint32_t internal_min_free_bytes;       // Lowest since boot
+    uint32_t internal_largest_block_bytes;
+    uint32_t psram_free_bytes;
+    uint32_t psram_largest_block_bytes;
+    uint32_t alloc_failure_count;           // heap_caps allocations that returned NULL
+    uint32_t last_alloc_failure_bytes;
+    uint32_t sampled_ms;
+};
+
+// CPU load over the window between the last two samples (FreeRTOS run-time stats, esp_timer µs),
+// taken with the memory figures. Permille of one core; tasks in TaskMemoryStats order. FreeRTOS
+// counts no context switches, so wakeups are the task's cycles per second from perf_counters.
+struct TaskCpuStats {
+    int8_t task_core[TASK_MANAGER_TASK_COUNT];          // Pinned core, -1 unpinned or missing
+    uint16_t task_permille[TASK_MANAGER_TASK_COUNT];
+    uint16_t task_wakeups_per_s[TASK_MANAGER_TASK_COUNT];
+    uint16_t idle_permille[2];                          // Per core
+    uint16_t other_permille[2];                         // Everything else that ran there (BLE stack, timers, LVGL tick)
+    uint32_t window_ms;                                 // 0 until two samples exist
+    uint32_t sampled_ms;
 };
 
 /**
@@ -49,6 +83,7 @@ struct TaskMetrics {
  * - Setup inter-task communication queues
  * - Monitor task health and performance
  * - Handle task suspend/resume for OTA operations
+ * - Own the periodic job timers (diagnostics, screen timeout, uptime)
  * - Provide task-based heartbeat reporting
  * 
  * Architecture:
@@ -62,6 +97,7 @@ private:
     // Task handles and queues
     TaskHandles task_handles;
     TaskQueues task_queues;
+    TimerHandle_t job_timers[(size_t)PeriodicJob::COUNT];
     
     // Hardware and system references
     HardwareManager* hardware_manager;
@@ -72,7 +108,15 @@ private:
     UIManager* ui_manager;
     
     // Task monitoring
-    TaskMetrics task_metrics[5]; // One for each task
+    uint32_t last_heartbeat_time[(size_t)PerfTimer::COUNT];   // Cycle timing lives in perf_counters
+    TaskMemoryStats memory_stats;
+    uint32_t last_memory_sample_ms;
+    mutable portMUX_TYPE memory_stats_lock;
+    TaskCpuStats cpu_stats;                                 // Under memory_stats_lock
+    TaskStatus_t* cpu_task_status;                          // PSRAM, SYS_TASK_CPU_STATS_MAX_TASKS entries
+    uint32_t last_cpu_run_time[TASK_MANAGER_TASK_COUNT + 2];  // Our tasks, then the idle tasks
+    uint32_t last_cpu_total_run_time;
+    uint32_t last_cpu_cycle_count[TASK_MANAGER_TASK_COUNT];
     bool tasks_initialized;
     bool ota_suspended;
     
@@ -91,15 +135,31 @@ public:
     bool create_all_tasks();
     void suspend_hardware_tasks();  // For OTA operations
     void resume_hardware_tasks();   // After OTA operations
+    
+    // Idle sampling power (screen dimmed); forwarded to WeightSamplingTask
+    void set_sampling_power_mode(SamplingPowerMode mode);
+    bool consume_sampling_weight_wake();
     void delete_all_tasks();
     
     // Queue access
     QueueHandle_t get_ui_to_grind_queue() const { return task_queues.ui_to_grind_queue; }
-    QueueHandle_t get_file_io_queue() const { return task_queues.file_io_queue; }
+    RingbufHandle_t get_file_io_session_ring() const { return task_queues.file_io_session_ring; }
+    RingbufHandle_t get_file_io_preference_ring() const { return task_queues.file_io_preference_ring; }
+    RingbufHandle_t get_file_io_log_ring() const { return task_queues.file_io_log_ring; }
     
     // Task monitoring
     bool are_tasks_healthy() const;
     void print_task_status() const;
+    void sample_memory_stats();                             // Bluetooth task; also on demand
+    TaskMemoryStats get_memory_stats() const;
+    size_t format_memory_json(char* buffer, size_t buffer_size) const;
+    // [n]{stack free u16} then heap KB u16 {int free,int min,int largest,psram free,psram largest}, alloc fails u32
+    void format_memory_binary(BinaryWriter& writer) const;
+    void sample_cpu_stats();                                // Bluetooth task, with the memory figures
+    TaskCpuStats get_cpu_stats() const;
+    size_t format_cpu_json(char* buffer, size_t buffer_size) const;
+    // [n]{core i8, permille u16, wakeups/s u16} then idle permille u16 per core
+    void format_cpu_binary(BinaryWriter& writer) const;
     
     // Static task function wrappers
     static void weight_sampling_task_wrapper(void* parameter);
@@ -120,6 +180,13 @@ private:
     bool create_inter_task_queues();
     void cleanup_queues();
     
+    // Periodic jobs
+    bool create_job_timers();
+    void delete_job_timers();
+    void run_periodic_jobs(uint32_t job_bits);
+    static void on_job_timer(TimerHandle_t timer);
+    void update_ota_suspension();
+    
     // Task implementation methods
     void weight_sampling_task_impl();
     void grind_control_task_impl();
@@ -128,8 +195,11 @@ private:
     void file_io_task_impl();
     
     // Performance monitoring
-    void record_task_timing(int task_index, uint32_t start_time, uint32_t end_time);
-    void print_task_heartbeat(int task_index, const char* task_name) const;
+    void record_task_timing(PerfTimer timer, int64_t start_us, int64_t end_us);
+    void print_task_heartbeat(PerfTimer timer) const;
+    void print_memory_heartbeat(const TaskMemoryStats& stats) const;
+    void print_cpu_heartbeat(const TaskCpuStats& stats) const;
+    static void on_alloc_failed(size_t size, uint32_t caps, const char* function_name);
     
     // Task validation
     bool validate_hardware_ready() const;
@@ -1,9 +1,16 @@
 #include "weight_sampling_task.h"
 #include "../hardware/WeightSensor.h"
 #include "../logging/grind_logging.h"
+#include "../logging/deferred_log.h"
+#include "../system/perf_counters.h"
+#include "../system/radio_coexistence.h"
+#include "../system/trace.h"
+#include "../system/telemetry.h"
+#include "../system/boot_sequence.h"
 #include "../config/constants.h"
 #include <Arduino.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 
 // Global instance
 WeightSamplingTask weight_sampling_task;
@@ -11,18 +18,40 @@ WeightSamplingTask weight_sampling_task;
 // Static instance pointer for task callback
 WeightSamplingTask* WeightSamplingTask::instance = nullptr;
 
+// A frame of the sensor's newest sample, when the grinder's telemetry stream wants one
+static void record_telemetry(Telemetry& grinder_telemetry, WeightSensor* sensor) {
+    uint32_t sample_time_us = sensor->get_latest_sample_time_us();
+    if (!grinder_telemetry.is_due(sample_time_us)) {
+        return;
+    }
+    float estimated_weight = 0.0f;
+    float flow_rate = 0.0f;
+    bool flow_valid = sensor->get_estimated_weight(&estimated_weight, &flow_rate);
+    grinder_telemetry.record(sample_time_us, sensor->get_raw_adc_instant(),
+                             sensor->get_instant_weight(), flow_rate, flow_valid);
+}
+
 WeightSamplingTask::WeightSamplingTask() {
     weight_sensor = nullptr;
+    memset(channel_sensors, 0, sizeof(channel_sensors));
+    memset(channel_ready, 0, sizeof(channel_ready));
     logger = nullptr;
     task_handle = nullptr;
     task_running = false;
     
     // Initialize performance metrics
-    cycle_count = 0;
-    cycle_time_sum_ms = 0;
-    cycle_time_min_ms = UINT32_MAX;
-    cycle_time_max_ms = 0;
     last_heartbeat_time = 0;
+    last_wake_time_us = 0;
+    last_fed_sample_time_us = 0;
+    
+    drdy_interrupt_mode = false;
+    poll_interval_ms = SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS;
+    power_mode = SamplingPowerMode::ACTIVE;
+    requested_power_mode.store(SamplingPowerMode::ACTIVE);
+    weight_wake_pending.store(false);
+    sample_listener.store(nullptr);
+    watch_reference_valid = false;
+    watch_reference_weight = 0.0f;
     
     // Initialize hardware state
     hardware_initialized = false;
@@ -41,11 +70,18 @@ WeightSamplingTask::~WeightSamplingTask() {
 
 void WeightSamplingTask::init(WeightSensor* ws, GrindLogger* log) {
     weight_sensor = ws;
+    channel_sensors[0] = ws;
     logger = log;
     
     LOG_BLE("WeightSamplingTask: Initialized with hardware interfaces\n");
 }
 
+void WeightSamplingTask::set_channel_sensor(uint8_t channel, WeightSensor* ws) {
+    if (channel > 0 && channel < HW_GRINDER_CHANNELS) {
+        channel_sensors[channel] = ws;
+    }
+}
+
 bool WeightSamplingTask::start_task() {
     if (task_running) {
         LOG_BLE("WARNING: WeightSamplingTask already running\n");
@@ -68,7 +104,7 @@ bool WeightSamplingTask::start_task() {
         nullptr,
         SYS_TASK_PRIORITY_WEIGHT_SAMPLING,
         &task_handle,
-        0  // Pin to Core 0
+        SYS_TASK_CORE_WEIGHT_SAMPLING
     );
     
     if (result != pdPASS) {
@@ -112,14 +148,16 @@ void WeightSamplingTask::task_wrapper(void* parameter) {
 
 void WeightSamplingTask::task_impl() {
     TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xFrequency = pdMS_TO_TICKS(SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS);
+    
+    // TaskManager creates this task itself; keep the handle for power mode wake-ups
+    task_handle = xTaskGetCurrentTaskHandle();
     
     LOG_BLE("WeightSamplingTask started on Core %d at %dHz\n", 
             xPortGetCoreID(), 1000 / SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS);
     
-    // Initialize HX711 hardware on Core 0 before starting sampling loop
-    if (!initialize_hx711_hardware()) {
-        LOG_BLE("ERROR: Failed to initialize HX711 hardware on Core 0\n");
+    // The Core 0 boot job brings up the HX711 while setup() finishes on Core 1
+    boot_sequence.wait(BootStage::LOAD_CELL);
+    if (!is_hardware_ready()) {
         task_running = false;
         return;
     }
@@ -134,29 +172,92 @@ void WeightSamplingTask::task_impl() {
     
     // Reset performance metrics
     reset_performance_metrics();
+    last_wake_time_us = 0;
+    last_fed_sample_time_us = 0;
+    
+    // Prefer DOUT data-ready interrupt over fixed-rate polling when the driver supports it
+    drdy_interrupt_mode = false;
+#if HW_LOADCELL_DRDY_INTERRUPT_ENABLED
+    drdy_interrupt_mode = weight_sensor->enable_data_ready_interrupt(xTaskGetCurrentTaskHandle());
+    // Further scales wake the same task; one that cannot interrupt puts every scale on polling
+    for (uint8_t i = 1; i < HW_GRINDER_CHANNELS && drdy_interrupt_mode; i++) {
+        WeightSensor* sensor = channel_sensors[i];
+        if (channel_ready[i] &&
+            !sensor->enable_data_ready_interrupt(xTaskGetCurrentTaskHandle())) {
+            drdy_interrupt_mode = false;
+        }
+    }
+    if (!drdy_interrupt_mode) {
+        for (uint8_t i = 0; i < HW_GRINDER_CHANNELS; i++) {
+            if (channel_sensors[i]) {
+                channel_sensors[i]->disable_data_ready_interrupt();
+            }
+        }
+    }
+#endif
+    LOG_BLE("WeightSamplingTask: Acquisition mode: %s\n",
+            drdy_interrupt_mode ? "DOUT interrupt" : "polling");
+    power_mode = SamplingPowerMode::ACTIVE;
+    poll_interval_ms = SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS;
     
     // Main sampling loop
     while (task_running) {
-        uint32_t cycle_start_time = millis();
+        SamplingPowerMode requested_mode = requested_power_mode.load();
+        if (requested_mode != power_mode) {
+            apply_power_mode(requested_mode);
+            xLastWakeTime = xTaskGetTickCount();
+        }
+        if (power_mode == SamplingPowerMode::IDLE_OFF) {
+            sleep_while_powered_down();
+            continue;
+        }
+        
+        if (drdy_interrupt_mode && !any_data_waiting()) {
+            // Sleep until the HX711 signals a conversion; the timeout keeps the
+            // watchdog fed and recovers a missed edge by polling once. Samples the
+            // ISR staged during a stall (HW_LOADCELL_ISR_READOUT_ENABLED) drain
+            // one per cycle without waiting.
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SYS_TASK_WEIGHT_SAMPLING_DRDY_TIMEOUT_MS));
+        }
+        
+        int64_t cycle_start_us = esp_timer_get_time();
+        trace.span_begin(TraceId::WEIGHT_SAMPLING_CYCLE);
+        record_wake_jitter(cycle_start_us);
         
         // Core sampling operations (extracted from RealtimeController)
-        sample_and_feed_weight_sensor();
+        bool sample_taken = sample_and_feed_weight_sensor();
         
         // Weight sensor state management (non-blocking operations only)
         if (weight_sensor) {
             weight_sensor->update();  // Coordinate tare state management
         }
+        if (sample_and_feed_channel_sensors()) {
+            sample_taken = true;
+        }
         
         // Feed watchdog to prevent timeout
         esp_task_wdt_reset();
         
-        uint32_t cycle_end_time = millis();
-        
         // Record performance metrics
-        record_timing(cycle_start_time, cycle_end_time);
+        trace.span_end(TraceId::WEIGHT_SAMPLING_CYCLE);
+        record_timing(cycle_start_us, esp_timer_get_time());
         
-        // Use vTaskDelayUntil for predictable timing (eliminates busy-wait)
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        // The listener runs at a lower priority on this core, so it starts once this cycle blocks
+        TaskHandle_t listener = sample_listener.load();
+        if (sample_taken && listener) {
+            xTaskNotifyGive(listener);
+        }
+        
+        // Polling mode: use vTaskDelayUntil for predictable timing (eliminates busy-wait)
+        if (!drdy_interrupt_mode) {
+            vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(poll_interval_ms));
+        }
+    }
+    
+    for (uint8_t i = 0; i < HW_GRINDER_CHANNELS; i++) {
+        if (channel_sensors[i]) {
+            channel_sensors[i]->disable_data_ready_interrupt();
+        }
     }
     
     // Mark hardware as no longer initialized
@@ -179,89 +280,232 @@ bool WeightSamplingTask::initialize_hx711_hardware() {
     hardware_initialized = false;
     hardware_validation_passed = false;
     
-    LOG_BLE("WeightSamplingTask: Initializing WeightSensor hardware on Core 0...\n");
+    memset(channel_ready, 0, sizeof(channel_ready));
+    if (!initialize_sensor_hardware(weight_sensor, 0)) {
+        return false;
+    }
+    hardware_initialized = true;
+    channel_ready[0] = true;
+    
+    // A further grinder's scale that fails keeps its fault and is left out of the
+    // sampling pass; the first grinder samples regardless
+    for (uint8_t i = 1; i < HW_GRINDER_CHANNELS; i++) {
+        if (channel_sensors[i]) {
+            channel_ready[i] = initialize_sensor_hardware(channel_sensors[i], i);
+        }
+    }
+    
+    // Hardware validation already succeeded, so initialization is successful
+    hardware_validation_passed = true;
+    return hardware_validation_passed;
+}
+
+bool WeightSamplingTask::initialize_sensor_hardware(WeightSensor* sensor, uint8_t channel) {
+    LOG_BLE("WeightSamplingTask: Initializing grinder %u WeightSensor hardware on Core 0...\n", (unsigned)channel + 1);
     
     // Hardware reset sequence (extracted from RealtimeController)
-    weight_sensor->power_down();
+    sensor->power_down();
     vTaskDelay(pdMS_TO_TICKS(1000)); // Use vTaskDelay instead of delay()
-    weight_sensor->power_up();
+    sensor->power_up();
     vTaskDelay(pdMS_TO_TICKS(500));  // Use vTaskDelay instead of delay()
     
-    bool begin_success = weight_sensor->begin();
+    bool begin_success = sensor->begin();
     if (!begin_success) {
         LOG_BLE("ERROR: HX711 begin() failed - sensor not responding\n");
-        weight_sensor->set_hardware_fault(WeightSensor::HardwareFault::NOT_CONNECTED);
-        weight_sensor->power_down();
+        sensor->set_hardware_fault(WeightSensor::HardwareFault::NOT_CONNECTED);
+        sensor->power_down();
         return false;
     }
-    weight_sensor->set_hardware_fault(WeightSensor::HardwareFault::NONE);
+    sensor->set_hardware_fault(WeightSensor::HardwareFault::NONE);
     
-    // Apply saved calibration factor
-    float saved_cal_factor = weight_sensor->get_saved_calibration_factor();
-    weight_sensor->set_calibration_factor(saved_cal_factor);
+    // Saved calibration factor, the multi-point curve over it when one is stored, notch tone and channel balance
+    sensor->load_calibration();
     
     // Hardware stabilization - wait for hardware to be ready
     LOG_BLE("  Waiting for WeightSensor hardware stabilization...\n");
     uint32_t start_time = millis();
     while (millis() - start_time < 2000) {
-        if (weight_sensor->data_waiting_async()) {
-            weight_sensor->update_async();
+        if (sensor->data_waiting_async()) {
+            sensor->update_async();
         }
         vTaskDelay(pdMS_TO_TICKS(10)); // Use vTaskDelay instead of delay()
     }
     
     // Validate hardware responds
-    if (!weight_sensor->validate_hardware()) {
+    if (!sensor->validate_hardware()) {
         LOG_BLE("ERROR: WeightSensor hardware validation failed - check wiring!\n");
-        if (weight_sensor->get_hardware_fault() == WeightSensor::HardwareFault::NONE) {
-            weight_sensor->set_hardware_fault(WeightSensor::HardwareFault::NO_DATA);
+        if (sensor->get_hardware_fault() == WeightSensor::HardwareFault::NONE) {
+            sensor->set_hardware_fault(WeightSensor::HardwareFault::NO_DATA);
         }
-        weight_sensor->power_down();
+        sensor->power_down();
         return false;
     }
     
-    weight_sensor->set_hardware_fault(WeightSensor::HardwareFault::NONE);
+    sensor->set_hardware_fault(WeightSensor::HardwareFault::NONE);
     
     // Verify initialization
     LOG_BLE("  WeightSensor initialization complete:\n");
-    LOG_BLE("    Calibration factor: %.2f\n", weight_sensor->get_calibration_factor());
-    LOG_BLE("    Tare offset: %ld\n", weight_sensor->get_zero_offset());
-    LOG_BLE("    Hardware ready: %s\n", weight_sensor->is_data_ready() ? "TRUE" : "FALSE");
-    LOG_BLE("    Sample rate detected: %.1f SPS\n", weight_sensor->get_detected_sample_rate_sps());
+    LOG_BLE("    Calibration factor: %.2f\n", sensor->get_calibration_factor());
+    LOG_BLE("    Tare offset: %ld\n", sensor->get_zero_offset());
+    LOG_BLE("    Hardware ready: %s\n", sensor->is_data_ready() ? "TRUE" : "FALSE");
+    LOG_BLE("    Sample rate detected: %.1f SPS\n", sensor->get_detected_sample_rate_sps());
     
     // Mark WeightSensor as hardware-ready
-    weight_sensor->set_hardware_initialized();
-    hardware_initialized = true;
+    sensor->set_hardware_initialized();
     
     // Attempt single verification reading (optional since validation already succeeded)
-    if (weight_sensor->update_async()) {
-        float test_reading = weight_sensor->get_instant_weight();
+    if (sensor->update_async()) {
+        float test_reading = sensor->get_instant_weight();
         LOG_BLE("    Verification reading: %.3fg\n", test_reading);
     } else {
         LOG_BLE("    Verification reading: No sample ready yet (normal for 10 SPS after validation)\n");
     }
     
-    // Hardware validation already succeeded, so initialization is successful
-    hardware_validation_passed = true;
-    
     LOG_BLE("✅ WeightSensor hardware initialization successful on Core 0\n");
-    return hardware_validation_passed;
+    return true;
 }
 
-void WeightSamplingTask::sample_and_feed_weight_sensor() {
-    if (!weight_sensor) return;
+bool WeightSamplingTask::sample_and_feed_weight_sensor() {
+    if (!weight_sensor) return false;
     
     // Call WeightSensor's Core 0 sampling method - this performs HX711 sampling
     // and feeds data to CircularBufferMath, updating all weight readings
     // (Extracted from RealtimeController::sample_and_feed_weight_sensor)
     bool sample_taken = weight_sensor->sample_and_feed_filter();
     
+    if (sample_taken && power_mode == SamplingPowerMode::IDLE_WATCH) {
+        check_watch_wake();
+    }
+    
+    if (sample_taken) {
+        trace.instant(TraceId::SAMPLE_ARRIVAL);
+        // Interval between capture timestamps, and capture-to-filter latency
+        uint32_t sample_time_us = weight_sensor->get_latest_sample_time_us();
+        uint32_t now_us = (uint32_t)esp_timer_get_time();
+        if (last_fed_sample_time_us != 0) {
+            perf_counters.record(PerfHistogram::SAMPLE_INTERVAL, sample_time_us - last_fed_sample_time_us);
+        }
+        perf_counters.record(PerfHistogram::DRDY_LATENCY, now_us - sample_time_us);
+        last_fed_sample_time_us = sample_time_us;
+        
+        record_telemetry(telemetry, weight_sensor);
+    }
+    
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // Record timestamp for SPS tracking when a sample was actually taken
     if (sample_taken) {
         weight_sensor->record_sample_timestamp();
     }
 #endif
+    return sample_taken;
+}
+
+bool WeightSamplingTask::sample_and_feed_channel_sensors() {
+    bool sample_taken = false;
+    for (uint8_t i = 1; i < HW_GRINDER_CHANNELS; i++) {
+        WeightSensor* sensor = channel_sensors[i];
+        if (!channel_ready[i]) {
+            continue;
+        }
+        // Filters, tare and the grinder's own telemetry; the timing histograms follow the first grinder
+        if (sensor->sample_and_feed_filter()) {
+            sample_taken = true;
+            record_telemetry(channel_telemetry(i), sensor);
+        }
+        sensor->update();
+    }
+    return sample_taken;
+}
+
+bool WeightSamplingTask::any_data_waiting() {
+    for (uint8_t i = 0; i < HW_GRINDER_CHANNELS; i++) {
+        WeightSensor* sensor = channel_sensors[i];
+        if (channel_ready[i] && sensor->data_waiting_async()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WeightSamplingTask::request_power_mode(SamplingPowerMode mode) {
+#if !SYS_SAMPLING_IDLE_POWER_ENABLED
+    mode = SamplingPowerMode::ACTIVE;
+#endif
+    if (requested_power_mode.exchange(mode) != mode && task_handle) {
+        // Wake the task now instead of at the next sample or sleep timeout
+        xTaskNotifyGive(task_handle);
+    }
+}
+
+void WeightSamplingTask::apply_power_mode(SamplingPowerMode mode) {
+    if (!weight_sensor) {
+        return;
+    }
+    
+    SamplingPowerMode previous = power_mode;
+    power_mode = mode;
+    
+    if (mode == SamplingPowerMode::IDLE_OFF) {
+        // Also detaches the data-ready interrupt
+        for (uint8_t i = 0; i < HW_GRINDER_CHANNELS; i++) {
+            if (channel_ready[i]) {
+                channel_sensors[i]->power_down();
+            }
+        }
+        LOG_RT("WeightSamplingTask: Screen idle - ADC powered down\n");
+        return;
+    }
+    
+    if (previous == SamplingPowerMode::IDLE_OFF) {
+        for (uint8_t i = 0; i < HW_GRINDER_CHANNELS; i++) {
+            WeightSensor* sensor = channel_sensors[i];
+            if (!channel_ready[i]) {
+                continue;
+            }
+            sensor->power_up();
+#if HW_LOADCELL_DRDY_INTERRUPT_ENABLED
+            if (drdy_interrupt_mode) {
+                drdy_interrupt_mode = sensor->enable_data_ready_interrupt(xTaskGetCurrentTaskHandle());
+            }
+#endif
+        }
+        // The power-down gap is neither jitter nor a late sample
+        last_wake_time_us = 0;
+        last_fed_sample_time_us = 0;
+    }
+    
+    if (mode == SamplingPowerMode::IDLE_WATCH) {
+        poll_interval_ms = SYS_SAMPLING_IDLE_WATCH_POLL_INTERVAL_MS;
+        watch_reference_valid = false;
+        LOG_RT("WeightSamplingTask: Screen idle - watching for cup (%s)\n",
+                drdy_interrupt_mode ? "DOUT interrupt" : "slow polling");
+    } else {
+        poll_interval_ms = SYS_TASK_WEIGHT_SAMPLING_INTERVAL_MS;
+        LOG_RT("WeightSamplingTask: Active sampling resumed\n");
+    }
+}
+
+void WeightSamplingTask::sleep_while_powered_down() {
+    // Nothing to sample: leave the watchdog and sleep until request_power_mode() notifies
+    esp_task_wdt_delete(nullptr);
+    while (task_running && requested_power_mode.load() == SamplingPowerMode::IDLE_OFF) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SYS_SAMPLING_IDLE_OFF_CHECK_MS));
+    }
+    esp_task_wdt_add(nullptr);
+}
+
+void WeightSamplingTask::check_watch_wake() {
+    float weight = weight_sensor->get_weight_low_latency();
+    if (!watch_reference_valid) {
+        watch_reference_weight = weight;
+        watch_reference_valid = true;
+        return;
+    }
+    
+    if (fabsf(weight - watch_reference_weight) >= SYS_SAMPLING_IDLE_WAKE_DELTA_G) {
+        watch_reference_weight = weight;
+        weight_wake_pending.store(true);
+    }
 }
 
 bool WeightSamplingTask::validate_hardware_ready() const {
@@ -274,21 +518,13 @@ bool WeightSamplingTask::validate_hardware_ready() const {
     return weight_sensor_ready;
 }
 
-void WeightSamplingTask::record_timing(uint32_t start_time, uint32_t end_time) {
-    uint32_t cycle_duration = end_time - start_time;
-    
-    cycle_count++;
-    cycle_time_sum_ms += cycle_duration;
-    
-    if (cycle_duration < cycle_time_min_ms) {
-        cycle_time_min_ms = cycle_duration;
-    }
-    if (cycle_duration > cycle_time_max_ms) {
-        cycle_time_max_ms = cycle_duration;
-    }
+void WeightSamplingTask::record_timing(int64_t start_us, int64_t end_us) {
+    perf_counters.record(PerfTimer::WEIGHT_SAMPLING_CYCLE, (uint32_t)(end_us - start_us));
     
 #if SYS_ENABLE_REALTIME_HEARTBEAT
     // Print task heartbeat every 10 seconds
+    uint32_t start_time = (uint32_t)(start_us / 1000);
+    uint32_t end_time = (uint32_t)(end_us / 1000);
     if (last_heartbeat_time == 0) {
         last_heartbeat_time = start_time;
     }
@@ -301,25 +537,56 @@ void WeightSamplingTask::record_timing(uint32_t start_time, uint32_t end_time) {
 #endif
 }
 
+void WeightSamplingTask::record_wake_jitter(int64_t wake_time_us) {
+    int64_t previous_wake_us = last_wake_time_us;
+    last_wake_time_us = wake_time_us;
+    if (previous_wake_us == 0 || !weight_sensor) {
+        return;
+    }
+    
+    // Interrupt mode wakes once per conversion, polling mode once per task period
+    uint32_t sample_rate = weight_sensor->get_adc_sample_rate_sps();
+    uint32_t expected_us = (drdy_interrupt_mode && sample_rate > 0)
+        ? 1000000UL / sample_rate
+        : poll_interval_ms * 1000UL;
+    
+    int64_t interval_us = wake_time_us - previous_wake_us;
+    if (interval_us > (int64_t)expected_us * SYS_SAMPLING_JITTER_GAP_FACTOR) {
+        perf_counters.increment(PerfCount::WEIGHT_SAMPLING_JITTER_GAPS);
+        return;
+    }
+    
+    int64_t deviation_us = interval_us - (int64_t)expected_us;
+    uint32_t jitter_us = (uint32_t)(deviation_us < 0 ? -deviation_us : deviation_us);
+    perf_counters.record(PerfHistogram::WAKE_JITTER, jitter_us);
+    
+    // The same for an export, upload or OTA open, to compare against all cycles
+    if (radio_coexistence.is_transfer_active()) {
+        perf_counters.record(PerfHistogram::TRANSFER_WAKE_JITTER, jitter_us);
+    }
+}
+
 void WeightSamplingTask::print_heartbeat() const {
 #if SYS_ENABLE_REALTIME_HEARTBEAT
-    uint32_t avg_cycle_time = cycle_count > 0 ? cycle_time_sum_ms / cycle_count : 0;
+    PerfTimerWindow cycles = perf_counters.get_window(PerfTimer::WEIGHT_SAMPLING_CYCLE);
     float current_sps = weight_sensor ? weight_sensor->get_current_sps() : 0.0f;
     int current_sample_count = weight_sensor ? weight_sensor->get_sample_count() : 0;
     int32_t raw_reading = weight_sensor ? weight_sensor->get_raw_adc_instant() : 0;
     
-    LOG_BLE("[%lums WEIGHT_SAMPLING_HEARTBEAT] Cycles: %lu/10s | Avg: %lums (%lu-%lums) | Weight: %.3fg | Raw: %ld | SPS: %.1f | Samples: %d | Build: #%d\n",
-           millis(), cycle_count, avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms,
+    LOG_RT("[%lums WEIGHT_SAMPLING_HEARTBEAT] Cycles: %lu/10s | Avg: %luus (%lu-%luus) | Weight: %.3fg | Raw: %ld | SPS: %.1f | Samples: %d | Build: #%d\n",
+           millis(), cycles.count, cycles.avg_us, cycles.min_us, cycles.max_us,
            weight_sensor ? weight_sensor->get_weight_low_latency() : 0.0f,
            (long)raw_reading, current_sps, current_sample_count, BUILD_NUMBER);
+    perf_counters.print_histogram_summary();
+    // Radio passes held back by a grind (RadioCoexistence)
+    LOG_RT("[%lums WEIGHT_SAMPLING_DEFERRED] export %lu, upload %lu\n", millis(),
+           radio_coexistence.get_deferred_count(RadioWork::BLE_EXPORT),
+           radio_coexistence.get_deferred_count(RadioWork::MQTT_UPLOAD));
 #endif
 }
 
 void WeightSamplingTask::reset_performance_metrics() {
-    cycle_count = 0;
-    cycle_time_sum_ms = 0;
-    cycle_time_min_ms = UINT32_MAX;
-    cycle_time_max_ms = 0;
+    perf_counters.reset_window(PerfTimer::WEIGHT_SAMPLING_CYCLE);
 }
 
 float WeightSamplingTask::get_current_sps() const {
@@ -332,12 +599,13 @@ void WeightSamplingTask::print_performance_stats() const {
     LOG_BLE("Hardware initialized: %s\n", hardware_initialized ? "YES" : "NO");
     LOG_BLE("Hardware validation passed: %s\n", hardware_validation_passed ? "YES" : "NO");
     LOG_BLE("Current SPS: %.1f\n", get_current_sps());
-    LOG_BLE("Cycle count: %lu\n", cycle_count);
+    PerfTimerWindow cycles = perf_counters.get_window(PerfTimer::WEIGHT_SAMPLING_CYCLE);
+    LOG_BLE("Cycle count: %lu\n", cycles.total_count);
     
-    if (cycle_count > 0) {
-        uint32_t avg_cycle_time = cycle_time_sum_ms / cycle_count;
-        LOG_BLE("Average cycle time: %lums (%lu-%lums)\n", avg_cycle_time, cycle_time_min_ms, cycle_time_max_ms);
+    if (cycles.count > 0) {
+        LOG_BLE("Average cycle time: %luus (%lu-%luus)\n", cycles.avg_us, cycles.min_us, cycles.max_us);
     }
+    perf_counters.print_histogram_summary();
     LOG_BLE("====================================\n");
 }
 
@@ -2,12 +2,21 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <atomic>
 #include "../config/constants.h"
+#include "../system/perf_counters.h"
 
 // Forward declarations
 class WeightSensor;
 class GrindLogger;
 
+// Sampling power mode, requested by the UI from the screen dim state
+enum class SamplingPowerMode : uint8_t {
+    ACTIVE,         // Normal sampling
+    IDLE_WATCH,     // Screen dimmed, Start-on-Cup armed: slow polling, wake on coarse weight change
+    IDLE_OFF,       // Screen dimmed, nothing armed: ADC powered down until woken
+};
+
 /**
  * WeightSamplingTask - Dedicated Weight Sensor Sampling
  * 
@@ -15,15 +24,20 @@ class GrindLogger;
  * that handles ONLY weight sensor sampling operations.
  * 
  * Responsibilities:
- * - Non-blocking HX711 sampling (polling at fixed rate; sensor delivers at HW rate)
+ * - Non-blocking HX711 sampling (woken by DOUT data-ready interrupt, or polling at
+ *   fixed rate when the interrupt is disabled or unsupported by the driver)
  * - Feed data to CircularBufferMath filters
+ * - Wake the sample listener (GrindControlTask) once per new sample
  * - Hardware initialization on Core 0
+ * - Every grinder channel's scale (HW_GRINDER_CHANNELS) in the same pass
  * - SPS performance monitoring
  * - Hardware validation and error recovery
+ * - Idle power modes while the screen is dimmed (ADC power-down or slow
+ *   polling with a coarse weight-change wake)
  * 
  * Architecture:
  * - Runs on Core 0 at highest priority (4)
- * - Uses vTaskDelayUntil for predictable timing
+ * - Blocks on a task notification from the DOUT ISR (vTaskDelayUntil when polling)
  * - Thread-safe access to weight sensor hardware
  * - No file I/O or blocking operations
  */
@@ -31,6 +45,8 @@ class WeightSamplingTask {
 private:
     // Hardware interface
     WeightSensor* weight_sensor;
+    WeightSensor* channel_sensors[HW_GRINDER_CHANNELS];   // [0] is weight_sensor; see GrindChannels
+    bool channel_ready[HW_GRINDER_CHANNELS];            // Passed initialize_hx711_hardware(), sampled each pass
     GrindLogger* logger;
     
     // Task timing and performance
@@ -38,11 +54,23 @@ private:
     volatile bool task_running;
     
     // Performance monitoring
-    uint32_t cycle_count;
-    uint32_t cycle_time_sum_ms;
-    uint32_t cycle_time_min_ms;
-    uint32_t cycle_time_max_ms;
-    uint32_t last_heartbeat_time;
+    uint32_t last_heartbeat_time;   // Cycle timing itself lives in perf_counters
+    
+    // Wake jitter (|wake interval - expected sample period|) goes to PerfHistogram::WAKE_JITTER,
+    // evidence that nothing else preempts sampling on Core 0; the cycles that ran with a
+    // radio transfer open (RadioCoexistence) to TRANSFER_WAKE_JITTER as well
+    int64_t last_wake_time_us;
+    uint32_t last_fed_sample_time_us;   // Previous sample timestamp for the interval histogram
+    
+    // Acquisition and power mode (applied on Core 0 only)
+    bool drdy_interrupt_mode;
+    uint32_t poll_interval_ms;
+    SamplingPowerMode power_mode;
+    std::atomic<SamplingPowerMode> requested_power_mode;
+    std::atomic<bool> weight_wake_pending;
+    std::atomic<TaskHandle_t> sample_listener;  // Notified once per cycle that fed a sample
+    bool watch_reference_valid;
+    float watch_reference_weight;
     
     // Hardware state
     bool hardware_initialized;
@@ -57,18 +85,29 @@ public:
     
     // Initialization
     void init(WeightSensor* ws, GrindLogger* log);
+    void set_channel_sensor(uint8_t channel, WeightSensor* ws);   // Further grinders' scales, before boot
     
     // Task lifecycle
     bool start_task();
     void stop_task();
     bool is_running() const { return task_running; }
     bool is_hardware_ready() const { return hardware_initialized && hardware_validation_passed; }
+    WeightSensor* get_weight_sensor() const { return weight_sensor; }
     
     // Performance monitoring
     float get_current_sps() const;
-    uint32_t get_cycle_count() const { return cycle_count; }
+    uint32_t get_cycle_count() const { return perf_counters.get_window(PerfTimer::WEIGHT_SAMPLING_CYCLE).total_count; }
     void print_performance_stats() const;
     
+    // Idle power handling; safe to call from any task
+    void request_power_mode(SamplingPowerMode mode);
+    SamplingPowerMode get_power_mode() const { return power_mode; }
+    bool consume_weight_wake() { return weight_wake_pending.exchange(false); }
+    
+    // A task notification (xTaskNotifyGive) after every cycle that fed a new sample to the filter,
+    // once the weight sensor update ran; nullptr stops them. Safe to call from any task.
+    void set_sample_listener(TaskHandle_t listener) { sample_listener.store(listener); }
+    
     // Static task wrapper
     static void task_wrapper(void* parameter);
     
@@ -78,14 +117,26 @@ public:
     // Hardware validation (public for TaskManager access)
     bool validate_hardware_ready() const;
     
+    // HX711 power cycle, calibration load and stabilization; run once by the
+    // Core 0 boot job (main.cpp) before task_impl() starts sampling
+    bool initialize_hx711_hardware();
+    
 private:
     
     // Hardware management (extracted from RealtimeController)
-    bool initialize_hx711_hardware();
-    void sample_and_feed_weight_sensor();
+    bool sample_and_feed_weight_sensor();
+    bool sample_and_feed_channel_sensors();     // Further grinder channels; true if any took a sample
+    bool initialize_sensor_hardware(WeightSensor* sensor, uint8_t channel);
+    bool any_data_waiting();
+    
+    // Power mode transitions
+    void apply_power_mode(SamplingPowerMode mode);
+    void sleep_while_powered_down();
+    void check_watch_wake();
     
     // Performance tracking
-    void record_timing(uint32_t start_time, uint32_t end_time);
+    void record_timing(int64_t start_us, int64_t end_us);
+    void record_wake_jitter(int64_t wake_time_us);
     void print_heartbeat() const;
     void reset_performance_metrics();
     
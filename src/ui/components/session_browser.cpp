@@ -0,0 +1,203 @@
+#include "session_browser.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include "../../config/constants.h"
+#include "../../config/logging.h"
+#include "../../logging/grind_logging.h"
+
+namespace {
+const char* const kTerminationNames[] = {"Completed", "Timeout", "Overshoot", "Max pulses", "Flow stalled",
+                                         "Flow unstable"};
+
+const char* termination_name(uint8_t reason) {
+    return reason < sizeof(kTerminationNames) / sizeof(kTerminationNames[0]) ? kTerminationNames[reason] : "Unknown";
+}
+} // namespace
+
+void SessionBrowser::create(lv_obj_t* parent) {
+    chart = lv_chart_create(parent);
+    lv_obj_set_size(chart, 260, 140);
+    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_point_count(chart, GRIND_SESSION_PREVIEW_POINTS);
+    lv_chart_set_div_line_count(chart, 0, 0);
+    lv_obj_set_style_bg_opa(chart, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(chart, 0, 0);
+    lv_obj_set_style_width(chart, 0, LV_PART_INDICATOR);       // No point markers
+    lv_obj_set_style_height(chart, 0, LV_PART_INDICATOR);
+    lv_obj_set_style_line_width(chart, 3, LV_PART_ITEMS);
+    weight_series = lv_chart_add_series(chart, lv_color_hex(THEME_COLOR_PRIMARY), LV_CHART_AXIS_PRIMARY_Y);
+    target_series = lv_chart_add_series(chart, lv_color_hex(THEME_COLOR_TEXT_SECONDARY), LV_CHART_AXIS_PRIMARY_Y);
+
+    detail_label = lv_label_create(parent);
+    lv_obj_set_width(detail_label, 260);
+    lv_obj_set_style_text_font(detail_label, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_color(detail_label, lv_color_hex(THEME_COLOR_TEXT_SECONDARY), 0);
+    lv_obj_set_style_text_align(detail_label, LV_TEXT_ALIGN_CENTER, 0);
+
+    // No layout: rows are placed by hand at their list position
+    list = lv_obj_create(parent);
+    lv_obj_set_size(list, 260, VISIBLE_ROWS * ROW_HEIGHT);
+    lv_obj_set_style_bg_opa(list, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(list, 0, 0);
+    lv_obj_set_style_pad_all(list, 0, 0);
+    lv_obj_set_scroll_dir(list, LV_DIR_VER);
+    lv_obj_set_scrollbar_mode(list, LV_SCROLLBAR_MODE_AUTO);
+    lv_obj_add_event_cb(list, scroll_cb, LV_EVENT_SCROLL, this);
+
+    spacer = lv_obj_create(list);
+    lv_obj_set_size(spacer, 1, 0);
+    lv_obj_set_style_bg_opa(spacer, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(spacer, 0, 0);
+    lv_obj_clear_flag(spacer, LV_OBJ_FLAG_CLICKABLE);
+
+    for (uint8_t i = 0; i < ROW_POOL; i++) {
+        lv_obj_t* row = lv_obj_create(list);
+        lv_obj_set_size(row, LV_PCT(100), ROW_HEIGHT - 4);
+        lv_obj_set_style_radius(row, 8, 0);
+        lv_obj_set_style_border_width(row, 0, 0);
+        lv_obj_set_style_pad_hor(row, 10, 0);
+        lv_obj_set_style_bg_color(row, lv_color_hex(THEME_COLOR_NEUTRAL), 0);
+        lv_obj_set_style_bg_color(row, lv_color_hex(THEME_COLOR_ACCENT), LV_STATE_CHECKED);
+        lv_obj_clear_flag(row, LV_OBJ_FLAG_SCROLLABLE);
+        lv_obj_add_flag(row, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_HIDDEN);
+        lv_obj_add_event_cb(row, row_clicked_cb, LV_EVENT_CLICKED, this);
+
+        lv_obj_t* label = lv_label_create(row);
+        lv_obj_set_style_text_font(label, &lv_font_montserrat_24, 0);
+        lv_obj_set_style_text_color(label, lv_color_hex(THEME_COLOR_TEXT_PRIMARY), 0);
+        lv_obj_align(label, LV_ALIGN_LEFT_MID, 0, 0);
+
+        rows[i] = row;
+        row_labels[i] = label;
+    }
+
+    clear_preview("No sessions");
+}
+
+void SessionBrowser::open() {
+    close();
+
+    uint32_t count = grind_logger.get_total_flash_sessions();
+    if (count > 0) {
+        entries = (SessionIndexEntry*)heap_caps_malloc(count * sizeof(SessionIndexEntry), MALLOC_CAP_SPIRAM);
+        if (!entries) {
+            LOG_BLE("ERROR: Failed to allocate the session list (%lu sessions)\n", (unsigned long)count);
+            bind_rows();
+            clear_preview("Out of memory");
+            return;
+        }
+        entry_count = grind_logger.get_session_entries(entries, count);
+    }
+
+    lv_obj_set_height(spacer, (int32_t)entry_count * ROW_HEIGHT);
+    lv_obj_scroll_to_y(list, 0, LV_ANIM_OFF);
+    bind_rows();
+    if (entry_count > 0) {
+        select(0);
+    } else {
+        clear_preview("No sessions");
+    }
+}
+
+void SessionBrowser::close() {
+    if (entries) {
+        heap_caps_free(entries);
+        entries = nullptr;
+    }
+    entry_count = 0;
+    selected = -1;
+    first_bound = -1;
+}
+
+const SessionIndexEntry& SessionBrowser::entry_at(uint32_t position) const {
+    return entries[entry_count - 1 - position];
+}
+
+void SessionBrowser::bind_rows() {
+    int32_t first = lv_obj_get_scroll_y(list) / ROW_HEIGHT;
+    if (first < 0) {
+        first = 0;
+    }
+    if (first == first_bound) {
+        return;
+    }
+    first_bound = first;
+
+    for (uint8_t i = 0; i < ROW_POOL; i++) {
+        uint32_t position = (uint32_t)first + i;
+        if (!entries || position >= entry_count) {
+            lv_obj_add_flag(rows[i], LV_OBJ_FLAG_HIDDEN);
+            continue;
+        }
+        const SessionIndexEntry& entry = entry_at(position);
+        lv_obj_set_y(rows[i], (int32_t)position * ROW_HEIGHT);
+        lv_label_set_text_fmt(row_labels[i], "#%lu  %.1fg  %+.2f", (unsigned long)entry.session_id,
+                              entry.final_weight, entry.error_grams);
+        lv_obj_set_state(rows[i], LV_STATE_CHECKED, (int32_t)position == selected);
+        lv_obj_clear_flag(rows[i], LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+void SessionBrowser::select(int32_t position) {
+    if (!entries || position < 0 || (uint32_t)position >= entry_count) {
+        return;
+    }
+    selected = position;
+    for (uint8_t i = 0; i < ROW_POOL; i++) {
+        lv_obj_set_state(rows[i], LV_STATE_CHECKED, first_bound + i == selected);
+    }
+
+    const SessionIndexEntry& entry = entry_at((uint32_t)position);
+    SessionSummary summary;
+    bool have_preview = grind_logger.get_session_summaries().find(entry.session_id, &summary) &&
+                        summary.preview_count > 0;
+
+    lv_label_set_text_fmt(detail_label, "%.2fg / %.1fg, %.1fs\n%u pulses, %s", entry.final_weight,
+                          entry.target_weight, entry.total_time_ms / 1000.0f, (unsigned)entry.pulse_count,
+                          termination_name(entry.termination_reason));
+    if (!have_preview) {
+        lv_chart_set_all_values(chart, weight_series, LV_CHART_POINT_NONE);
+        lv_chart_set_all_values(chart, target_series, LV_CHART_POINT_NONE);
+        lv_chart_refresh(chart);
+        return;
+    }
+
+    // Tenths of a gram, like the grinding chart; the points are a fraction of the full scale
+    int32_t full_scale = (int32_t)lroundf(summary.preview_full_scale_g * 10.0f);
+    int32_t target = (int32_t)lroundf(summary.target_weight * 10.0f);
+    int32_t top = target > full_scale ? target : full_scale;
+    lv_chart_set_point_count(chart, summary.preview_count);
+    lv_chart_set_axis_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, top + top / 10);
+    for (uint8_t i = 0; i < summary.preview_count; i++) {
+        lv_chart_set_value_by_id(chart, weight_series, i, (int32_t)summary.preview[i] * full_scale / 255);
+    }
+    lv_chart_set_all_values(chart, target_series, target > 0 ? target : LV_CHART_POINT_NONE);
+    lv_chart_refresh(chart);
+}
+
+void SessionBrowser::clear_preview(const char* text) {
+    lv_label_set_text(detail_label, text);
+    lv_chart_set_all_values(chart, weight_series, LV_CHART_POINT_NONE);
+    lv_chart_set_all_values(chart, target_series, LV_CHART_POINT_NONE);
+    lv_chart_refresh(chart);
+}
+
+void SessionBrowser::scroll_cb(lv_event_t* e) {
+    if (auto* browser = static_cast<SessionBrowser*>(lv_event_get_user_data(e))) {
+        browser->bind_rows();
+    }
+}
+
+void SessionBrowser::row_clicked_cb(lv_event_t* e) {
+    auto* browser = static_cast<SessionBrowser*>(lv_event_get_user_data(e));
+    lv_obj_t* row = static_cast<lv_obj_t*>(lv_event_get_current_target(e));
+    if (!browser || browser->first_bound < 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < ROW_POOL; i++) {
+        if (browser->rows[i] == row) {
+            browser->select(browser->first_bound + i);
+            return;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <lvgl.h>
+#include <cstdint>
+
+struct SessionIndexEntry;
+
+/**
+ * SessionBrowser - Stored grind sessions on the device, newest first
+ *
+ * The list is virtualized: a spacer gives it the height of every session,
+ * and a fixed pool of ROW_POOL rows is moved to and rebound for the rows in
+ * view as it scrolls, so a log of two thousand sessions costs the same LVGL
+ * objects as a log of ten. The entries come from the session index (one read
+ * when the page opens, freed when it closes). Tapping a row draws the weight
+ * curve stored with the session's summary (SessionPreviewBuilder); no session
+ * file is opened. Sessions older than the summary table list without a curve.
+ *
+ * UI task only.
+ */
+class SessionBrowser {
+public:
+    void create(lv_obj_t* parent);
+    void open();                    // Page shown: load the list
+    void close();                   // Page left: release it
+    bool is_open() const { return entries != nullptr; }
+
+private:
+    static const uint8_t VISIBLE_ROWS = 4;
+    static const uint8_t ROW_POOL = VISIBLE_ROWS + 2;      // A partly scrolled row at each end
+    static const int32_t ROW_HEIGHT = 52;
+
+    lv_obj_t* chart = nullptr;
+    lv_chart_series_t* weight_series = nullptr;
+    lv_chart_series_t* target_series = nullptr;
+    lv_obj_t* detail_label = nullptr;
+    lv_obj_t* list = nullptr;
+    lv_obj_t* spacer = nullptr;
+    lv_obj_t* rows[ROW_POOL] = {};
+    lv_obj_t* row_labels[ROW_POOL] = {};
+
+    SessionIndexEntry* entries = nullptr;   // PSRAM, oldest first (index order)
+    uint32_t entry_count = 0;
+    int32_t first_bound = -1;               // List position of the top pooled row, -1 = rebind
+    int32_t selected = -1;                  // List position (0 = newest), -1 = none
+
+    const SessionIndexEntry& entry_at(uint32_t position) const;
+    void bind_rows();
+    void select(int32_t position);
+    void clear_preview(const char* text);
+
+    static void scroll_cb(lv_event_t* e);
+    static void row_clicked_cb(lv_event_t* e);
+};
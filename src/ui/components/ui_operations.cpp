@@ -19,8 +19,9 @@ void UIOperations::execute_calibration(HardwareManager* hw_manager, float cal_we
     
     auto calibration_operation = [hw_manager, cal_weight]() {
         // This will now block and wait for settlement internally
-        hw_manager->get_load_cell()->calibrate(cal_weight);
-        LOG_BLE("Scale calibrated with %.2fg weight\n", cal_weight);
+        if (hw_manager->get_load_cell()->add_calibration_point(cal_weight)) {
+            LOG_BLE("Scale calibrated with %.2fg weight\n", cal_weight);
+        }
     };
     
     overlay.show_and_execute(BlockingOperation::CALIBRATING, calibration_operation, completion);
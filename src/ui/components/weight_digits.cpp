@@ -0,0 +1,163 @@
+#include "weight_digits.h"
+#include <esp_heap_caps.h>
+#include <cstring>
+
+WeightDigits::TileSet WeightDigits::tile_sets[WeightDigits::MAX_FONTS] = {};
+
+void WeightDigits::create(lv_obj_t* parent, const lv_font_t* font, lv_color_t color) {
+    container = lv_obj_create(parent);
+    lv_obj_set_size(container, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+    lv_obj_set_style_bg_opa(container, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(container, 0, 0);
+    lv_obj_set_style_pad_all(container, 0, 0);
+    lv_obj_set_style_pad_gap(container, 0, 0);
+    lv_obj_clear_flag(container, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_clear_flag(container, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_layout(container, LV_LAYOUT_FLEX);
+    lv_obj_set_flex_flow(container, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(container, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    tile_set = get_tile_set(font);
+    for (lv_obj_t*& cell : cells) {
+        cell = lv_image_create(container);
+        // A8 tiles are drawn in the recolor color
+        lv_obj_set_style_image_recolor(cell, color, 0);
+        lv_obj_set_style_image_recolor_opa(cell, LV_OPA_COVER, 0);
+        lv_obj_add_flag(cell, LV_OBJ_FLAG_HIDDEN);
+    }
+
+    fallback_label = lv_label_create(container);
+    lv_obj_set_style_text_font(fallback_label, font, 0);
+    lv_obj_set_style_text_color(fallback_label, color, 0);
+    lv_obj_add_flag(fallback_label, LV_OBJ_FLAG_HIDDEN);
+}
+
+void WeightDigits::set_text(const char* text) {
+    if (!container || strcmp(text, shown_text) == 0) {
+        return;
+    }
+
+    size_t length = strlen(text);
+    bool tiled = tile_set && length <= MAX_CELLS && length < sizeof(shown_text);
+    for (size_t i = 0; tiled && i < length; i++) {
+        tiled = strchr(GLYPHS, text[i]) != nullptr;
+    }
+
+    if (!tiled) {
+        for (lv_obj_t* cell : cells) {
+            lv_obj_add_flag(cell, LV_OBJ_FLAG_HIDDEN);
+        }
+        lv_label_set_text(fallback_label, text);
+        lv_obj_clear_flag(fallback_label, LV_OBJ_FLAG_HIDDEN);
+        shown_text[0] = '\0';           // Next tiled text redraws every cell
+        return;
+    }
+
+    bool from_fallback = !lv_obj_has_flag(fallback_label, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_flag(fallback_label, LV_OBJ_FLAG_HIDDEN);
+    size_t shown_length = strlen(shown_text);
+    for (size_t i = 0; i < MAX_CELLS; i++) {
+        if (i >= length) {
+            lv_obj_add_flag(cells[i], LV_OBJ_FLAG_HIDDEN);
+            continue;
+        }
+        if (from_fallback || i >= shown_length || shown_text[i] != text[i]) {
+            size_t glyph = strchr(GLYPHS, text[i]) - GLYPHS;
+            lv_image_set_src(cells[i], &tile_set->tiles[glyph]);
+            lv_obj_clear_flag(cells[i], LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+    memcpy(shown_text, text, length + 1);
+}
+
+WeightDigits::TileSet* WeightDigits::get_tile_set(const lv_font_t* font) {
+    for (TileSet& set : tile_sets) {
+        if (set.font == font) {
+            return &set;
+        }
+    }
+    TileSet* set = nullptr;
+    for (TileSet& candidate : tile_sets) {
+        if (!candidate.font) {
+            set = &candidate;
+            break;
+        }
+    }
+    if (!set) {
+        return nullptr;
+    }
+
+    // Tabular digits: every digit gets the widest digit's cell
+    int32_t digit_width = 0;
+    for (char digit = '0'; digit <= '9'; digit++) {
+        int32_t width = lv_font_get_glyph_width(font, digit, 0);
+        digit_width = width > digit_width ? width : digit_width;
+    }
+    for (size_t i = 0; i < GLYPH_COUNT; i++) {
+        char glyph = GLYPHS[i];
+        int32_t cell_width = (glyph >= '0' && glyph <= '9') ? digit_width : lv_font_get_glyph_width(font, glyph, 0);
+        if (!render_tile(font, glyph, cell_width, &set->tiles[i])) {
+            for (size_t j = 0; j < i; j++) {
+                heap_caps_free((void*)set->tiles[j].data);
+            }
+            memset(set, 0, sizeof(*set));
+            return nullptr;
+        }
+    }
+    set->font = font;
+    return set;
+}
+
+// Rasterize one glyph through LVGL's label renderer into a scratch ARGB8888 canvas and
+// keep its alpha (white text on transparent) as the A8 tile
+bool WeightDigits::render_tile(const lv_font_t* font, char glyph, int32_t cell_width, lv_image_dsc_t* tile) {
+    int32_t height = lv_font_get_line_height(font);
+    // Rows padded to LV_DRAW_BUF_STRIDE_ALIGN so the image decoder uses the tile in place
+    uint32_t stride = lv_draw_buf_width_to_stride(cell_width, LV_COLOR_FORMAT_A8);
+    uint8_t* coverage = (uint8_t*)heap_caps_calloc(stride * height, 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    lv_draw_buf_t* scratch = lv_draw_buf_create(cell_width, height, LV_COLOR_FORMAT_ARGB8888, 0);
+    if (!coverage || !scratch) {
+        heap_caps_free(coverage);
+        if (scratch) {
+            lv_draw_buf_destroy(scratch);
+        }
+        return false;
+    }
+
+    lv_obj_t* canvas = lv_canvas_create(lv_layer_sys());
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_draw_buf(canvas, scratch);
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_TRANSP);
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+    char text[2] = {glyph, '\0'};
+    lv_draw_label_dsc_t label;
+    lv_draw_label_dsc_init(&label);
+    label.font = font;
+    label.color = lv_color_white();
+    label.text = text;
+    int32_t x_offset = (cell_width - lv_font_get_glyph_width(font, glyph, 0)) / 2;
+    lv_area_t coords = {x_offset, 0, cell_width - 1, height - 1};
+    lv_draw_label(&layer, &label, &coords);
+    lv_canvas_finish_layer(canvas, &layer);
+    lv_obj_delete(canvas);
+
+    for (int32_t y = 0; y < height; y++) {
+        const uint8_t* row = scratch->data + y * scratch->header.stride;
+        for (int32_t x = 0; x < cell_width; x++) {
+            coverage[y * stride + x] = row[x * 4 + 3];
+        }
+    }
+    lv_draw_buf_destroy(scratch);
+
+    memset(tile, 0, sizeof(*tile));
+    tile->header.magic = LV_IMAGE_HEADER_MAGIC;
+    tile->header.cf = LV_COLOR_FORMAT_A8;
+    tile->header.w = cell_width;
+    tile->header.h = height;
+    tile->header.stride = stride;
+    tile->data_size = stride * height;
+    tile->data = coverage;
+    return true;
+}
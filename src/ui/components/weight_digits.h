@@ -0,0 +1,41 @@
+#pragma once
+#include <lvgl.h>
+
+/**
+ * WeightDigits - Large numeric readout drawn from pre-rendered glyph tiles
+ *
+ * The glyphs of "0123456789.g-" are rasterized once per font into A8 coverage
+ * tiles in PSRAM (shared by every readout using that font) and shown as one
+ * lv_image per character. Digits sit in fixed-width cells, so a changed digit
+ * swaps one image source and invalidates only that cell; the label path
+ * re-decodes and re-kerns every glyph of the string on each change. Tiles are
+ * recolored when drawn, so the readout works on any background.
+ *
+ * Text with other characters ("TARE") is shown by a fallback label in the font.
+ */
+class WeightDigits {
+public:
+    void create(lv_obj_t* parent, const lv_font_t* font, lv_color_t color);
+    void set_text(const char* text);
+    lv_obj_t* get_obj() const { return container; }
+
+private:
+    static const size_t MAX_CELLS = 8;
+    static const size_t MAX_FONTS = 2;
+    static constexpr const char* GLYPHS = "0123456789.g-";
+    static const size_t GLYPH_COUNT = 13;
+
+    struct TileSet {
+        const lv_font_t* font;
+        lv_image_dsc_t tiles[GLYPH_COUNT];
+    };
+    static TileSet tile_sets[MAX_FONTS];
+    static TileSet* get_tile_set(const lv_font_t* font);
+    static bool render_tile(const lv_font_t* font, char glyph, int32_t cell_width, lv_image_dsc_t* tile);
+
+    lv_obj_t* container = nullptr;
+    lv_obj_t* cells[MAX_CELLS] = {};
+    lv_obj_t* fallback_label = nullptr;
+    TileSet* tile_set = nullptr;
+    char shown_text[16] = "";
+};
@@ -3,6 +3,8 @@
 #include "../../config/constants.h"
 #include <Arduino.h>
 
+#if FEATURE_AUTOTUNE_UI
+
 AutoTuneUIController::AutoTuneUIController(UIManager* manager)
     : ui_manager_(manager)
     , autotune_started_(false)
@@ -155,3 +157,5 @@ void AutoTuneUIController::handle_ok() {
 
     ui_manager_->switch_to_state(UIState::MENU);
 }
+
+#endif // FEATURE_AUTOTUNE_UI
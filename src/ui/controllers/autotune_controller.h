@@ -1,8 +1,11 @@
 #pragma once
 #include <lvgl.h>
+#include "../../config/constants.h"
 
 class UIManager;
 
+#if FEATURE_AUTOTUNE_UI
+
 // Handles the auto-tune workflow and UI state transitions
 class AutoTuneUIController {
 public:
@@ -20,3 +23,15 @@ private:
     UIManager* ui_manager_;
     bool autotune_started_;
 };
+
+#else
+// Built without FEATURE_AUTOTUNE_UI: nothing to drive
+class AutoTuneUIController {
+public:
+    explicit AutoTuneUIController(UIManager*) {}
+
+    void register_events() {}
+    void update() {}
+    void confirm_and_begin() {}
+};
+#endif // FEATURE_AUTOTUNE_UI
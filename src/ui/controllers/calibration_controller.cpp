@@ -4,6 +4,7 @@
 #include <limits>
 #include "../../config/constants.h"
 #include "../../system/diagnostics_controller.h"
+#include "../../system/ui_snapshot.h"
 #include "../components/ui_operations.h"
 #include "../ui_manager.h"
 
@@ -53,9 +54,11 @@ void CalibrationUIController::update() {
 
     // Continuously reset noise diagnostic during entire calibration sequence
     if (ui_manager_->diagnostics_controller_) {
-        auto active_diagnostics = ui_manager_->diagnostics_controller_->get_active_diagnostics();
-        for (const auto& diagnostic : active_diagnostics) {
-            if (diagnostic.code == DiagnosticCode::LOAD_CELL_NOISY_SUSTAINED) {
+        DiagnosticState active_diagnostics[(size_t)DiagnosticCode::COUNT];
+        size_t active_count = ui_manager_->diagnostics_controller_->get_active_diagnostics(
+            active_diagnostics, (size_t)DiagnosticCode::COUNT);
+        for (size_t i = 0; i < active_count; i++) {
+            if (active_diagnostics[i].code == DiagnosticCode::LOAD_CELL_NOISY_SUSTAINED) {
                 ui_manager_->diagnostics_controller_->reset_diagnostic(DiagnosticCode::LOAD_CELL_NOISY_SUSTAINED);
                 ui_manager_->diagnostics_controller_->reset_noise_tracking();
                 break;
@@ -73,12 +76,11 @@ void CalibrationUIController::update() {
         return;
     }
 
+    UISnapshot weights = ui_snapshot.read();
     if (current_step == CAL_STEP_COMPLETE) {
-        float weight = ui_manager_->get_hardware_manager()->get_weight_sensor()->get_display_weight();
-        ui_manager_->calibration_screen.update_current_weight(weight);
+        ui_manager_->calibration_screen.update_current_weight(weights.display_weight);
     } else {
-        int32_t raw_reading = ui_manager_->get_hardware_manager()->get_weight_sensor()->get_raw_adc_instant();
-        ui_manager_->calibration_screen.update_current_weight(static_cast<float>(raw_reading));
+        ui_manager_->calibration_screen.update_current_weight(static_cast<float>(weights.instant_raw));
 
         // In weight step, verify user has placed weight on scale
         if (current_step == CAL_STEP_WEIGHT) {
@@ -101,8 +103,10 @@ void CalibrationUIController::handle_ok() {
     switch (step) {
         case CAL_STEP_EMPTY:
             UIOperations::execute_tare(ui_manager_->get_hardware_manager(), [this]() {
-                // Capture baseline ADC value after taring
-                baseline_adc_value_ = ui_manager_->get_hardware_manager()->get_weight_sensor()->get_raw_adc_instant();
+                // Capture baseline ADC value after taring; points are collected from here
+                auto* weight_sensor = ui_manager_->get_hardware_manager()->get_weight_sensor();
+                weight_sensor->begin_calibration();
+                baseline_adc_value_ = weight_sensor->get_raw_adc_instant();
                 ui_manager_->calibration_screen.set_step(CAL_STEP_WEIGHT);
                 if (ui_manager_) {
                     ui_manager_->refresh_auto_action_settings();
@@ -111,15 +115,34 @@ void CalibrationUIController::handle_ok() {
             break;
         case CAL_STEP_WEIGHT: {
             float cal_weight = ui_manager_->calibration_screen.get_calibration_weight();
-            UIOperations::execute_calibration(ui_manager_->get_hardware_manager(), cal_weight, [this]() {
-                ui_manager_->calibration_screen.set_step(CAL_STEP_NOISE_CHECK);
-                start_noise_check();
+            uint8_t points_before = ui_manager_->get_hardware_manager()->get_weight_sensor()->get_calibration_point_count();
+            UIOperations::execute_calibration(ui_manager_->get_hardware_manager(), cal_weight, [this, points_before]() {
+                auto* weight_sensor = ui_manager_->get_hardware_manager()->get_weight_sensor();
+                uint8_t points = weight_sensor->get_calibration_point_count();
+#if DEBUG_ENABLE_LOADCELL_MOCK
+                points = HW_LOADCELL_CAL_MAX_POINTS;    // Fixed factor: nothing to collect
+#endif
+                if (points == points_before) {
+                    // Rejected (not heavier than the previous point): stay on this step
+                    ui_manager_->calibration_screen.set_instruction_text("Point rejected\nUse a heavier weight\nthan the last point");
+                } else if (points < HW_LOADCELL_CAL_MAX_POINTS) {
+                    // Next point must clear this one, not the empty scale
+                    baseline_adc_value_ = weight_sensor->get_raw_adc_instant();
+                    ui_manager_->calibration_screen.set_step(CAL_STEP_POINT_SAVED);
+                } else {
+                    ui_manager_->calibration_screen.set_step(CAL_STEP_NOISE_CHECK);
+                    start_noise_check();
+                }
                 if (ui_manager_) {
                     ui_manager_->refresh_auto_action_settings();
                 }
             });
             break;
         }
+        case CAL_STEP_POINT_SAVED:
+            ui_manager_->calibration_screen.set_step(CAL_STEP_NOISE_CHECK);
+            start_noise_check();
+            break;
         case CAL_STEP_NOISE_CHECK:
             if (noise_check_passed_) {
                 complete_calibration();
@@ -145,6 +168,13 @@ void CalibrationUIController::handle_cancel() {
 void CalibrationUIController::handle_plus(lv_event_code_t code) {
     if (!ui_manager_) return;
 
+    if (ui_manager_->calibration_screen.get_step() == CAL_STEP_POINT_SAVED) {
+        if (code == LV_EVENT_CLICKED) {
+            ui_manager_->calibration_screen.set_step(CAL_STEP_WEIGHT);
+        }
+        return;
+    }
+
     if (code == LV_EVENT_CLICKED) {
         float cal_weight = ui_manager_->calibration_screen.get_calibration_weight();
         cal_weight = ui_manager_->get_profile_controller()->clamp_weight(cal_weight + USER_FINE_WEIGHT_ADJUSTMENT_G);
@@ -307,9 +337,7 @@ void CalibrationUIController::complete_calibration() {
     baseline_adc_value_ = 0;
     ui_manager_->calibration_screen.set_step(CAL_STEP_COMPLETE);
 
-    if (weight_sensor) {
-        ui_manager_->calibration_screen.update_current_weight(weight_sensor->get_display_weight());
-    }
+    ui_manager_->calibration_screen.update_current_weight(ui_snapshot.read().display_weight);
 
     ui_manager_->refresh_auto_action_settings();
 }
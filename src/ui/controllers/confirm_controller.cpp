@@ -55,6 +55,7 @@ void ConfirmUIController::show(const char* title,
     on_confirm_ = std::move(on_confirm);
     on_cancel_ = std::move(on_cancel);
 
+    ui_manager_->ensure_screen(UIScreen::CONFIRM);
     ui_manager_->confirm_screen.show(title, message, confirm_text, confirm_color, cancel_text);
     ui_manager_->switch_to_state(UIState::CONFIRM);
 }
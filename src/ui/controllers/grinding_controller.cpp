@@ -5,9 +5,12 @@
 #include <cstring>
 
 #include "../../config/constants.h"
+#include "../../controllers/grind_channels.h"
 #include "../../controllers/grind_events.h"
 #include "../../controllers/grind_mode.h"
 #include "../../logging/grind_logging.h"
+#include "../../system/telemetry.h"
+#include "../../system/ui_snapshot.h"
 #include "../ui_manager.h"
 
 GrindingUIController* GrindingUIController::instance_ = nullptr;
@@ -79,6 +82,12 @@ void GrindingUIController::register_events() {
             }
         }, LV_EVENT_CLICKED, this);
     }
+}
+
+void GrindingUIController::register_screen_events() {
+    if (!ui_manager_) {
+        return;
+    }
 
     if (lv_obj_t* arc = ui_manager_->grinding_screen.get_arc_screen_obj()) {
         lv_obj_add_event_cb(arc, [](lv_event_t* e) {
@@ -99,9 +108,25 @@ void GrindingUIController::register_events() {
             }
         }, LV_EVENT_CLICKED, this);
     }
+
+#if HW_GRINDER_CHANNELS > 1
+    // A long press (which LVGL does not follow with a click) switches grinders
+    auto grinder_switch_cb = [](lv_event_t* e) {
+        if (auto* controller = static_cast<GrindingUIController*>(lv_event_get_user_data(e))) {
+            controller->handle_grinder_switch();
+        }
+    };
+    if (lv_obj_t* arc = ui_manager_->grinding_screen.get_arc_screen_obj()) {
+        lv_obj_add_event_cb(arc, grinder_switch_cb, LV_EVENT_LONG_PRESSED, this);
+    }
+    if (lv_obj_t* chart = ui_manager_->grinding_screen.get_chart_screen_obj()) {
+        lv_obj_add_event_cb(chart, grinder_switch_cb, LV_EVENT_LONG_PRESSED, this);
+    }
+#endif
 }
 
-void GrindingUIController::on_state_changed(UIState new_state) {
+void GrindingUIController::on_state_enter(UIState new_state, UIState previous) {
+    (void)previous;
     if (!ui_manager_) {
         return;
     }
@@ -145,32 +170,16 @@ void GrindingUIController::on_state_changed(UIState new_state) {
     update_grind_button_icon();
 }
 
-void GrindingUIController::update(UIState current_state) {
+void GrindingUIController::update_grind_complete() {
     if (!ui_manager_) {
         return;
     }
 
-    switch (current_state) {
-        case UIState::GRIND_COMPLETE: {
-            WeightSensor* weight_sensor = ui_manager_->hardware_manager->get_weight_sensor();
-            if (weight_sensor) {
-                float current_weight = weight_sensor->get_display_weight();
-                ui_manager_->grinding_screen.update_current_weight(current_weight);
-            }
-            ui_manager_->grinding_screen.update_progress(final_grind_progress_);
-            break;
-        }
-        case UIState::GRIND_TIMEOUT: {
-            ui_manager_->grinding_screen.update_current_weight(error_grind_weight_);
-            ui_manager_->grinding_screen.update_progress(error_grind_progress_);
-            char error_display[64];
-            const char* message = error_message_[0] ? error_message_ : "Error";
-            std::snprintf(error_display, sizeof(error_display), "%s", message);
-            ui_manager_->grinding_screen.update_target_weight_text(error_display);
-            break;
-        }
-        default:
-            break;
+    // Progress and the timeout screen are set on entry; only the weight on the scale moves
+    float weight = ui_snapshot.read().display_weight;
+    if (weight != complete_weight_shown_) {
+        ui_manager_->grinding_screen.update_current_weight(weight);
+        complete_weight_shown_ = weight;
     }
 }
 
@@ -193,6 +202,11 @@ void GrindingUIController::handle_grind_button() {
 
         if (ui_manager_->grind_controller && ui_manager_->profile_controller) {
             ui_manager_->grind_controller->set_grind_profile_id(ui_manager_->profile_controller->get_current_profile());
+            // A start outside a batch opens one when the batch setting asks for several doses
+            if (!ui_manager_->grind_controller->is_batch_active() &&
+                ui_manager_->profile_controller->get_batch_doses() > 1) {
+                ui_manager_->grind_controller->start_batch(ui_manager_->profile_controller->get_batch_doses());
+            }
         }
 
         LOG_BLE("[%lums GRIND_START] About to call start_grind()\n", millis());
@@ -250,6 +264,46 @@ void GrindingUIController::handle_layout_toggle() {
     }
 }
 
+void GrindingUIController::handle_grinder_switch() {
+    if (!ui_manager_ || grind_channels.count() < 2) {
+        return;
+    }
+    uint8_t next = (grind_channels.get_selected() + 1) % grind_channels.count();
+    LOG_BLE("[UIManager] Switching the screens to grinder %u\n", (unsigned)next + 1);
+    ui_manager_->select_grinder_channel(next);
+}
+
+void GrindingUIController::show_selected_grinder() {
+    if (!ui_manager_ || !ui_manager_->state_machine || !ui_manager_->grind_controller) {
+        return;
+    }
+    GrindController* controller = ui_manager_->grind_controller;
+    GrindPhase phase = static_cast<GrindPhase>(channel_telemetry(controller->get_grinder_channel()).get_phase());
+    cancel_timers();
+    chart_updates_enabled_ = false;
+
+    // A result left waiting while another grinder was on screen counts as seen
+    if (phase == GrindPhase::COMPLETED || phase == GrindPhase::TIMEOUT) {
+        controller->return_to_idle();
+        phase = GrindPhase::IDLE;
+    }
+    if (phase == GrindPhase::IDLE) {
+        if (!ui_manager_->state_machine->is_state(UIState::READY)) {
+            ui_manager_->switch_to_state(UIState::READY);
+        }
+        return;
+    }
+
+    // Running: the grinding screen as PHASE_CHANGED sets it up, its chart starting from now
+    ui_manager_->ensure_screen(UIScreen::GRINDING);
+    ui_manager_->current_mode = controller->get_session_descriptor().mode;
+    ui_manager_->switch_to_state(UIState::GRINDING);
+    update_profile_name();
+    if (phase == GrindPhase::INITIALIZING) {
+        controller->ui_acknowledge_phase_transition();
+    }
+}
+
 void GrindingUIController::update_grind_button_icon() {
     if (!ui_manager_ || !grind_button_ || !grind_icon_) {
         return;
@@ -319,7 +373,10 @@ void GrindingUIController::update_grinding_targets() {
     }
 
     const auto& session = ui_manager_->grind_controller->get_session_descriptor();
-    ui_manager_->grinding_screen.set_chart_time_prediction(session.target_time_ms);
+    // Sized once for the late end of the planned duration, so the chart rarely has to compress
+    uint32_t chart_time_ms = session.mode == GrindMode::TIME ? session.target_time_ms
+                                                            : ui_manager_->grind_controller->get_planned_grind_ms();
+    ui_manager_->grinding_screen.set_chart_time_prediction(chart_time_ms);
     ui_manager_->grinding_screen.update_target_weight(session.target_weight);
     if (session.mode == GrindMode::TIME && session.target_time_ms > 0) {
         float target_time_seconds = static_cast<float>(session.target_time_ms) / 1000.0f;
@@ -343,6 +400,7 @@ void GrindingUIController::handle_grind_event(const GrindEventData& event_data)
     if (!ui_manager_ || !ui_manager_->state_machine) {
         return;
     }
+    ui_manager_->ensure_screen(UIScreen::GRINDING);
 
     switch (event_data.event) {
         case UIGrindEvent::PHASE_CHANGED: {
@@ -352,14 +410,11 @@ void GrindingUIController::handle_grind_event(const GrindEventData& event_data)
                 !ui_manager_->state_machine->is_state(UIState::GRINDING)) {
                 LOG_UI_DEBUG("[%lums UI_TRANSITION] Switching to GRINDING state due to phase: %s\n",
                              millis(), event_data.phase_display_text);
-                WeightSensor* weight_sensor = ui_manager_->hardware_manager->get_weight_sensor();
-                ui_manager_->grinding_screen.update_profile_name(ui_manager_->profile_controller->get_current_name());
+                update_profile_name();
                 ui_manager_->grinding_screen.set_mode(ui_manager_->current_mode);
                 chart_updates_enabled_ = true;
                 update_grinding_targets();
-                if (weight_sensor) {
-                    ui_manager_->grinding_screen.update_current_weight(weight_sensor->get_display_weight());
-                }
+                ui_manager_->grinding_screen.update_current_weight(ui_snapshot.read().display_weight);
                 ui_manager_->grinding_screen.update_progress(0);
                 ui_manager_->switch_to_state(UIState::GRINDING);
 
@@ -390,6 +445,8 @@ void GrindingUIController::handle_grind_event(const GrindEventData& event_data)
             break;
         }
         case UIGrindEvent::PROGRESS_UPDATED: {
+            ui_manager_->grinding_screen.update_eta(event_data.eta.remaining_ms, event_data.eta.band_ms,
+                                                    event_data.eta.known);
             if (event_data.show_taring_text) {
                 ui_manager_->grinding_screen.update_tare_display();
             } else {
@@ -415,6 +472,11 @@ void GrindingUIController::handle_grind_event(const GrindEventData& event_data)
             final_grind_progress_ = event_data.progress_percent;
             LOG_BLE("GRIND COMPLETE - Final settled weight captured: %.2fg (Progress: %d%%)\n",
                     final_grind_weight_, final_grind_progress_);
+            if (event_data.calibrated_time_ms > 0 && ui_manager_->profile_controller && ui_manager_->grind_controller) {
+                // Time mode calibration: the next grind of this profile runs the corrected time
+                int profile = ui_manager_->grind_controller->get_session_descriptor().profile_id;
+                ui_manager_->profile_controller->set_profile_time(profile, event_data.calibrated_time_ms / 1000.0f);
+            }
             chart_updates_enabled_ = false;
             ui_manager_->switch_to_state(UIState::GRIND_COMPLETE);
             start_grind_complete_timer();
@@ -523,15 +585,12 @@ void GrindingUIController::enter_edit_state() {
 }
 
 void GrindingUIController::enter_grinding_state() {
-    WeightSensor* weight_sensor = ui_manager_->hardware_manager->get_weight_sensor();
     ui_manager_->grinding_screen.reset_chart_data();
     ui_manager_->grinding_screen.update_profile_name(ui_manager_->profile_controller->get_current_name());
     ui_manager_->grinding_screen.set_mode(ui_manager_->current_mode);
     chart_updates_enabled_ = true;
     update_grinding_targets();
-    if (weight_sensor) {
-        ui_manager_->grinding_screen.update_current_weight(weight_sensor->get_display_weight());
-    }
+    ui_manager_->grinding_screen.update_current_weight(ui_snapshot.read().display_weight);
     ui_manager_->grinding_screen.update_progress(0);
     if (grind_button_) {
         lv_obj_clear_flag(grind_button_, LV_OBJ_FLAG_HIDDEN);
@@ -546,6 +605,7 @@ void GrindingUIController::enter_grind_complete_state() {
     ui_manager_->grinding_screen.set_mode(ui_manager_->current_mode);
     ui_manager_->grinding_screen.update_current_weight(final_grind_weight_);
     ui_manager_->grinding_screen.update_progress(final_grind_progress_);
+    complete_weight_shown_ = final_grind_weight_;
 }
 
 void GrindingUIController::enter_grind_timeout_state() {
@@ -571,6 +631,19 @@ void GrindingUIController::enter_menu_state() {
     }
 }
 
+void GrindingUIController::update_profile_name() {
+    const char* name = ui_manager_->profile_controller->get_current_name();
+    GrindController* grind_controller = ui_manager_->grind_controller;
+    if (!grind_controller || grind_controller->get_batch_total() < 2) {
+        ui_manager_->grinding_screen.update_profile_name(name);
+        return;
+    }
+    char text[USER_PROFILE_NAME_MAX_LENGTH + 8];
+    snprintf(text, sizeof(text), "%s %u/%u", name, (unsigned)(grind_controller->get_batch_completed() + 1),
+             (unsigned)grind_controller->get_batch_total());
+    ui_manager_->grinding_screen.update_profile_name(text);
+}
+
 void GrindingUIController::start_grind_complete_timer() {
     if (grind_complete_timer_) {
         lv_timer_del(grind_complete_timer_);
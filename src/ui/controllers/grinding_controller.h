@@ -1,25 +1,28 @@
 #pragma once
 #include <lvgl.h>
+#include "../../system/state_machine.h"
 
 class UIManager;
-enum class UIState;
 struct GrindEventData;
 
 // Controls grind/pulse buttons, state transitions, chart updates, and auto-return timers
 
-class GrindingUIController {
+class GrindingUIController : public StateObserver {
 public:
     explicit GrindingUIController(UIManager* manager);
 
     void build_controls();
     void register_events();
+    void register_screen_events();          // Layout toggle taps (and grinder switch presses), once the grinding screen is built
 
-    void on_state_changed(UIState new_state);
-    void update(UIState current_state);
+    void on_state_enter(UIState new_state, UIState previous) override;
+    void update_grind_complete();           // Live weight on the complete screen, per frame while it shows
 
     void handle_grind_button();
     void handle_pulse_button();
     void handle_layout_toggle();
+    void handle_grinder_switch();           // Long press on the grinding screen: the next grinder, the shown one runs on
+    void show_selected_grinder();           // After a grinder switch: the screens take up its grind where it is
 
     void update_grind_button_icon();
     void update_button_layout();
@@ -37,6 +40,8 @@ private:
     void enter_grind_timeout_state();
     void enter_menu_state();
 
+    void update_profile_name();     // Profile name, plus the dose number while a batch runs
+
     void start_grind_complete_timer();
     void start_grind_timeout_timer();
     void cancel_timers();
@@ -56,6 +61,7 @@ private:
     bool chart_updates_enabled_ = false;
     float final_grind_weight_ = 0.0f;
     int final_grind_progress_ = 0;
+    float complete_weight_shown_ = 0.0f;
     float error_grind_weight_ = 0.0f;
     int error_grind_progress_ = 0;
     char error_message_[32] = {0};
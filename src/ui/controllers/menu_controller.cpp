@@ -2,17 +2,20 @@
 
 #include <Arduino.h>
 #include <LittleFS.h>
-#include <Preferences.h>
 #include <esp_err.h>
 #include <esp_system.h>
 #include <nvs_flash.h>
 #include <cstdint>
 #include "../../config/constants.h"
 #include "../../controllers/grind_controller.h"
+#include "../../controllers/grind_channels.h"
 #include "../../controllers/grind_mode_traits.h"
 #include "../../logging/grind_logging.h"
+#include "../../system/config_store.h"
 #include "../../system/diagnostics_controller.h"
+#include "../../system/hot_path_benchmark.h"
 #include "../../system/statistics_manager.h"
+#include "../../system/ui_snapshot.h"
 #include "../components/blocking_overlay.h"
 #include "../components/ui_operations.h"
 #include "../event_bridge_lvgl.h"
@@ -29,31 +32,39 @@ void MenuUIController::register_events() {
 
     using ET = EventBridgeLVGL::EventType;
 
-    EventBridgeLVGL::register_handler(ET::MENU_CALIBRATE, [this](lv_event_t*) { handle_calibrate(); });
-    EventBridgeLVGL::register_handler(ET::MENU_RESET, [this](lv_event_t*) { handle_reset(); });
-    EventBridgeLVGL::register_handler(ET::MENU_PURGE, [this](lv_event_t*) { handle_purge(); });
-    EventBridgeLVGL::register_handler(ET::MENU_MOTOR_TEST, [this](lv_event_t*) { handle_motor_test(); });
-    EventBridgeLVGL::register_handler(ET::MENU_SCALE_OPEN, [this](lv_event_t*) { handle_scale_open(); });
-    EventBridgeLVGL::register_handler(ET::MENU_SCALE_TARE, [this](lv_event_t*) { handle_scale_tare(); });
-    EventBridgeLVGL::register_handler(ET::MENU_AUTOTUNE, [this](lv_event_t*) { handle_autotune(); });
-    EventBridgeLVGL::register_handler(ET::MENU_DIAGNOSTIC_RESET, [this](lv_event_t*) { handle_diagnostics_reset(); });
-    EventBridgeLVGL::register_handler(ET::MENU_BACK, [this](lv_event_t*) { handle_back(); });
-    EventBridgeLVGL::register_handler(ET::MENU_REFRESH_STATS, [this](lv_event_t*) { handle_refresh_stats(); });
-
-    EventBridgeLVGL::register_handler(ET::BLE_TOGGLE, [this](lv_event_t*) { handle_ble_toggle(); });
-    EventBridgeLVGL::register_handler(ET::BLE_STARTUP_TOGGLE, [this](lv_event_t*) { handle_ble_startup_toggle(); });
-    EventBridgeLVGL::register_handler(ET::LOGGING_TOGGLE, [this](lv_event_t*) { handle_logging_toggle(); });
-
-    EventBridgeLVGL::register_handler(ET::GRIND_MODE_SWIPE_TOGGLE, [this](lv_event_t*) { handle_grind_mode_swipe_toggle(); });
-    EventBridgeLVGL::register_handler(ET::GRIND_MODE_RADIO_BUTTON, [this](lv_event_t*) { handle_grind_mode_radio_button(); });
-    EventBridgeLVGL::register_handler(ET::AUTO_START_TOGGLE, [this](lv_event_t*) { handle_auto_start_toggle(); });
-    EventBridgeLVGL::register_handler(ET::AUTO_RETURN_TOGGLE, [this](lv_event_t*) { handle_auto_return_toggle(); });
-    EventBridgeLVGL::register_handler(ET::GRIND_PRIME_TOGGLE, [this](lv_event_t*) { handle_prime_toggle(); });
-
-    EventBridgeLVGL::register_handler(ET::BRIGHTNESS_NORMAL_SLIDER, [this](lv_event_t*) { handle_brightness_normal_slider(); });
-    EventBridgeLVGL::register_handler(ET::BRIGHTNESS_NORMAL_SLIDER_RELEASED, [this](lv_event_t*) { handle_brightness_normal_slider_released(); });
-    EventBridgeLVGL::register_handler(ET::BRIGHTNESS_SCREENSAVER_SLIDER, [this](lv_event_t*) { handle_brightness_screensaver_slider(); });
-    EventBridgeLVGL::register_handler(ET::BRIGHTNESS_SCREENSAVER_SLIDER_RELEASED, [this](lv_event_t*) { handle_brightness_screensaver_slider_released(); });
+    EventBridgeLVGL::bind<&MenuUIController::handle_calibrate>(ET::MENU_CALIBRATE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_reset>(ET::MENU_RESET, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_purge>(ET::MENU_PURGE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_motor_test>(ET::MENU_MOTOR_TEST, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_scale_open>(ET::MENU_SCALE_OPEN, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_scale_tare>(ET::MENU_SCALE_TARE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_autotune>(ET::MENU_AUTOTUNE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_diagnostics_reset>(ET::MENU_DIAGNOSTIC_RESET, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_back>(ET::MENU_BACK, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_refresh_stats>(ET::MENU_REFRESH_STATS, this);
+
+    EventBridgeLVGL::bind<&MenuUIController::handle_ble_toggle>(ET::BLE_TOGGLE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_ble_startup_toggle>(ET::BLE_STARTUP_TOGGLE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_logging_toggle>(ET::LOGGING_TOGGLE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_perf_monitor_toggle>(ET::PERF_MONITOR_TOGGLE, this);
+#if FEATURE_DEBUG_TOOLS
+    // Runs on the next UI cycle, outside the button's event
+    EventBridgeLVGL::register_handler(ET::HOT_PATH_BENCHMARK_START, [](void*, lv_event_t*) { hot_path_benchmark.request(); });
+#endif
+
+    EventBridgeLVGL::bind<&MenuUIController::handle_grind_mode_swipe_toggle>(ET::GRIND_MODE_SWIPE_TOGGLE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_grind_mode_radio_button>(ET::GRIND_MODE_RADIO_BUTTON, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_grinder_channel_radio_button>(ET::GRINDER_CHANNEL_RADIO_BUTTON, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_auto_start_toggle>(ET::AUTO_START_TOGGLE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_auto_return_toggle>(ET::AUTO_RETURN_TOGGLE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_prime_toggle>(ET::GRIND_PRIME_TOGGLE, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_batch_doses_slider>(ET::BATCH_DOSES_SLIDER, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_batch_doses_slider_released>(ET::BATCH_DOSES_SLIDER_RELEASED, this);
+
+    EventBridgeLVGL::bind<&MenuUIController::handle_brightness_normal_slider>(ET::BRIGHTNESS_NORMAL_SLIDER, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_brightness_normal_slider_released>(ET::BRIGHTNESS_NORMAL_SLIDER_RELEASED, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_brightness_screensaver_slider>(ET::BRIGHTNESS_SCREENSAVER_SLIDER, this);
+    EventBridgeLVGL::bind<&MenuUIController::handle_brightness_screensaver_slider_released>(ET::BRIGHTNESS_SCREENSAVER_SLIDER_RELEASED, this);
 
     // Note: Event registration for menu widgets is done in the page creation functions
     // (menu_screen.cpp) because the menu is created lazily and destroyed on hide.
@@ -74,8 +85,7 @@ void MenuUIController::update() {
     ui_manager_->menu_screen.update_ble_status();
 
     if (ui_manager_->menu_screen.is_scale_page_active()) {
-        float display_weight = sensor ? sensor->get_display_weight() : 0.0f;
-        ui_manager_->menu_screen.update_scale_weight(display_weight);
+        ui_manager_->menu_screen.update_scale_weight(ui_snapshot.read().display_weight);
     }
 }
 
@@ -148,10 +158,8 @@ void MenuUIController::handle_scale_open() {
         if (!ui_manager_) return;
         ui_manager_->refresh_auto_action_settings();
 
-        auto* sensor = ui_manager_->hardware_manager->get_weight_sensor();
-        float weight = sensor ? sensor->get_display_weight() : 0.0f;
         if (ui_manager_->menu_screen.is_scale_page_active()) {
-            ui_manager_->menu_screen.update_scale_weight(weight);
+            ui_manager_->menu_screen.update_scale_weight(ui_snapshot.read().display_weight);
         }
     });
 }
@@ -165,10 +173,8 @@ void MenuUIController::handle_scale_tare() {
         if (!ui_manager_) return;
         ui_manager_->refresh_auto_action_settings();
 
-        auto* sensor = ui_manager_->hardware_manager->get_weight_sensor();
-        float weight = sensor ? sensor->get_display_weight() : 0.0f;
         if (ui_manager_->menu_screen.is_scale_page_active()) {
-            ui_manager_->menu_screen.update_scale_weight(weight);
+            ui_manager_->menu_screen.update_scale_weight(ui_snapshot.read().display_weight);
         }
     });
 }
@@ -227,6 +233,7 @@ void MenuUIController::perform_diagnostics_reset() {
         diagnostics->reset_diagnostic(DiagnosticCode::LOAD_CELL_NOISY_SUSTAINED);
         diagnostics->reset_diagnostic(DiagnosticCode::MECHANICAL_INSTABILITY);
         diagnostics->reset_noise_tracking();
+        diagnostics->reset_throughput_trend();
     }
 
     auto* grind_controller = ui_manager_->get_grind_controller();
@@ -273,10 +280,7 @@ void MenuUIController::handle_ble_startup_toggle() {
 
     bool startup_enabled = lv_obj_has_state(toggle, LV_STATE_CHECKED);
 
-    Preferences prefs;
-    prefs.begin("bluetooth", false);
-    prefs.putBool("startup", startup_enabled);
-    prefs.end();
+    config_store.set_flag(ConfigFlag::BLE_STARTUP, startup_enabled);
 
     LOG_DEBUG_PRINTLN(startup_enabled ? "Bluetooth startup enabled" : "Bluetooth startup disabled");
 }
@@ -289,14 +293,22 @@ void MenuUIController::handle_logging_toggle() {
 
     bool logging_enabled = lv_obj_has_state(toggle, LV_STATE_CHECKED);
 
-    Preferences prefs;
-    prefs.begin("logging", false);
-    prefs.putBool("enabled", logging_enabled);
-    prefs.end();
+    config_store.set_flag(ConfigFlag::LOGGING, logging_enabled);
 
     LOG_DEBUG_PRINTLN(logging_enabled ? "Logging enabled" : "Logging disabled");
 }
 
+void MenuUIController::handle_perf_monitor_toggle() {
+    if (!ui_manager_) return;
+
+    auto* toggle = ui_manager_->menu_screen.get_perf_monitor_toggle();
+    if (!toggle) return;
+
+    // Not persisted: a measurement aid for the current session only
+    ui_manager_->get_hardware_manager()->get_display()->set_perf_monitor_visible(
+        lv_obj_has_state(toggle, LV_STATE_CHECKED));
+}
+
 void MenuUIController::handle_grind_mode_swipe_toggle() {
     if (!ui_manager_) return;
 
@@ -305,10 +317,7 @@ void MenuUIController::handle_grind_mode_swipe_toggle() {
 
     bool swipe_enabled = lv_obj_has_state(toggle, LV_STATE_CHECKED);
 
-    Preferences prefs;
-    prefs.begin("swipe", false);
-    prefs.putBool("enabled", swipe_enabled);
-    prefs.end();
+    config_store.set_flag(ConfigFlag::SWIPE, swipe_enabled);
 
     LOG_DEBUG_PRINTLN(swipe_enabled ? "Grind mode swipe gestures enabled" : "Grind mode swipe gestures disabled");
 }
@@ -338,6 +347,21 @@ void MenuUIController::handle_grind_mode_radio_button() {
     LOG_DEBUG_PRINTLN(selected_index == 0 ? "Grind mode set to WEIGHT via radio button" : "Grind mode set to TIME via radio button");
 }
 
+void MenuUIController::handle_grinder_channel_radio_button() {
+    if (!ui_manager_) return;
+
+    lv_obj_t* radio_group = ui_manager_->menu_screen.get_grinder_channel_radio_group();
+    if (!radio_group) return;
+
+    int selected_index = radio_button_group_get_selection(radio_group);
+    if (selected_index < 0) return;
+
+    // A refused channel (not fitted) leaves the radio on the one still selected
+    if (!ui_manager_->select_grinder_channel((uint8_t)selected_index)) {
+        radio_button_group_set_selection(radio_group, grind_channels.get_selected());
+    }
+}
+
 void MenuUIController::handle_auto_start_toggle() {
     if (!ui_manager_) return;
 
@@ -346,10 +370,7 @@ void MenuUIController::handle_auto_start_toggle() {
 
     bool enabled = lv_obj_has_state(toggle, LV_STATE_CHECKED);
 
-    Preferences prefs;
-    prefs.begin("autogrind", false);
-    prefs.putBool("auto_start", enabled);
-    prefs.end();
+    config_store.set_flag(ConfigFlag::AUTO_START, enabled);
 
     if (ui_manager_) {
         ui_manager_->refresh_auto_action_settings();
@@ -366,10 +387,7 @@ void MenuUIController::handle_auto_return_toggle() {
 
     bool enabled = lv_obj_has_state(toggle, LV_STATE_CHECKED);
 
-    Preferences prefs;
-    prefs.begin("autogrind", false);
-    prefs.putBool("auto_return", enabled);
-    prefs.end();
+    config_store.set_flag(ConfigFlag::AUTO_RETURN, enabled);
 
     if (ui_manager_) {
         ui_manager_->refresh_auto_action_settings();
@@ -386,15 +404,30 @@ void MenuUIController::handle_prime_toggle() {
 
     bool enabled = lv_obj_has_state(toggle, LV_STATE_CHECKED);
 
-    auto* hardware = ui_manager_->get_hardware_manager();
-    Preferences* prefs = hardware ? hardware->get_preferences() : nullptr;
-    if (prefs) {
-        prefs->putBool(GrindController::PREF_KEY_PRIME_ENABLED, enabled);
-    }
+    config_store.set_flag(ConfigFlag::PRIME, enabled);
 
     LOG_DEBUG_PRINTLN(enabled ? "Chute priming enabled" : "Chute priming disabled");
 }
 
+void MenuUIController::handle_batch_doses_slider() {
+    if (!ui_manager_) return;
+
+    auto* slider = ui_manager_->menu_screen.get_batch_doses_slider();
+    if (!slider) return;
+
+    ui_manager_->menu_screen.update_batch_doses_label(lv_slider_get_value(slider));
+}
+
+void MenuUIController::handle_batch_doses_slider_released() {
+    if (!ui_manager_ || !ui_manager_->profile_controller) return;
+
+    auto* slider = ui_manager_->menu_screen.get_batch_doses_slider();
+    if (!slider) return;
+
+    ui_manager_->profile_controller->set_batch_doses(lv_slider_get_value(slider));
+    LOG_DEBUG_PRINTF("Batch doses set to %d\n", ui_manager_->profile_controller->get_batch_doses());
+}
+
 void MenuUIController::handle_brightness_normal_slider() {
     if (!ui_manager_) return;
 
@@ -424,10 +457,7 @@ void MenuUIController::handle_brightness_normal_slider_released() {
     }
     float brightness = brightness_percent / 100.0f;
 
-    Preferences prefs;
-    prefs.begin("brightness", false);
-    prefs.putFloat("normal", brightness);
-    prefs.end();
+    config_store.set_float(ConfigFloat::BRIGHTNESS_NORMAL, brightness);
 }
 
 void MenuUIController::handle_brightness_screensaver_slider() {
@@ -459,10 +489,7 @@ void MenuUIController::handle_brightness_screensaver_slider_released() {
     }
     float brightness = brightness_percent / 100.0f;
 
-    Preferences prefs;
-    prefs.begin("brightness", false);
-    prefs.putFloat("screensaver", brightness);
-    prefs.end();
+    config_store.set_float(ConfigFloat::BRIGHTNESS_SCREENSAVER, brightness);
 
     float normal = get_normal_brightness();
     ui_manager_->get_hardware_manager()->get_display()->set_brightness(normal);
@@ -474,6 +501,11 @@ void MenuUIController::perform_factory_reset() {
 
     LOG_DEBUG_PRINTLN("Factory reset: clearing NVS preferences and rebooting...");
 
+    // Statistics journal lives on LittleFS, outside the NVS erase
+    for (uint8_t ch = 0; ch < HW_GRINDER_CHANNELS; ch++) {
+        channel_statistics(ch).reset_all();
+    }
+
     nvs_flash_deinit();
     esp_err_t erase_result = nvs_flash_erase();
 
@@ -522,7 +554,7 @@ void MenuUIController::run_motor_test() {
     grinder->start_pulse_rmt(1000);
 
     // Update statistics for motor test (1000ms = 1 second)
-    statistics_manager.update_motor_test(1000);
+    channel_statistics(grind_channels.get_selected()).update_motor_test(1000);
 
     stop_motor_timer();
     motor_timer_ = lv_timer_create(static_motor_timer_cb, 2000, this);
@@ -542,10 +574,7 @@ float MenuUIController::get_normal_brightness() const {
         return USER_SCREEN_BRIGHTNESS_NORMAL;
     }
 
-    Preferences prefs;
-    prefs.begin("brightness", true);
-    float brightness = prefs.getFloat("normal", USER_SCREEN_BRIGHTNESS_NORMAL);
-    prefs.end();
+    float brightness = config_store.get_float(ConfigFloat::BRIGHTNESS_NORMAL);
 
     if (brightness < 0.15f) {
         brightness = 0.15f;
@@ -558,10 +587,7 @@ float MenuUIController::get_screensaver_brightness() const {
         return USER_SCREEN_BRIGHTNESS_DIMMED;
     }
 
-    Preferences prefs;
-    prefs.begin("brightness", true);
-    float brightness = prefs.getFloat("screensaver", USER_SCREEN_BRIGHTNESS_DIMMED);
-    prefs.end();
+    float brightness = config_store.get_float(ConfigFloat::BRIGHTNESS_SCREENSAVER);
 
     if (brightness < 0.15f) {
         brightness = 0.15f;
@@ -24,11 +24,15 @@ public:
     void handle_ble_toggle();
     void handle_ble_startup_toggle();
     void handle_logging_toggle();
+    void handle_perf_monitor_toggle();
     void handle_grind_mode_swipe_toggle();
     void handle_grind_mode_radio_button();
+    void handle_grinder_channel_radio_button();
     void handle_auto_start_toggle();
     void handle_auto_return_toggle();
     void handle_prime_toggle();
+    void handle_batch_doses_slider();
+    void handle_batch_doses_slider_released();
     void handle_brightness_normal_slider();
     void handle_brightness_normal_slider_released();
     void handle_brightness_screensaver_slider();
@@ -28,35 +28,42 @@ void OtaDataExportController::register_events() {
 }
 
 bool OtaDataExportController::update() {
-    if (!ui_manager_ || !ui_manager_->bluetooth_manager) {
+    if (!ui_manager_ || !ui_manager_->bluetooth_manager ||
+        !ui_manager_->state_machine->is_state(UIState::OTA_UPDATE)) {
         return false;
     }
 
     auto* bluetooth = ui_manager_->bluetooth_manager;
 
     if (bluetooth->is_updating()) {
-        if (!ui_manager_->state_machine->is_state(UIState::OTA_UPDATE)) {
-            ui_manager_->ota_screen.show_ota_mode();
-            ui_manager_->switch_to_state(UIState::OTA_UPDATE);
-        } else {
-            int progress = static_cast<int>(bluetooth->get_ota_progress());
-            ui_manager_->ota_screen.update_progress(progress);
-        }
+        int progress = static_cast<int>(bluetooth->get_ota_progress());
+        ui_manager_->ota_screen.update_progress(progress);
         return true;
     }
 
-    if (bluetooth->is_data_export_active()) {
-        if (!data_export_active_) {
-            start_data_export_ui();
-        }
+    if (data_export_active_) {
         poll_data_export();
-    } else if (data_export_active_) {
-        stop_data_export_ui();
     }
 
     return false;
 }
 
+void OtaDataExportController::on_state_enter(UIState state, UIState previous) {
+    (void)previous;
+    if (state != UIState::OTA_UPDATE || !ui_manager_ || !ui_manager_->bluetooth_manager) {
+        return;
+    }
+
+    if (ui_manager_->bluetooth_manager->is_updating()) {
+        ui_manager_->ota_screen.show_ota_mode();
+        return;
+    }
+
+    // An export that already finished ends on the first poll
+    data_export_active_ = true;
+    ui_manager_->ota_screen.show_data_export_mode();
+}
+
 void OtaDataExportController::update_progress(int percent) {
     if (!ui_manager_ || !ui_manager_->state_machine) {
         return;
@@ -114,18 +121,6 @@ void OtaDataExportController::handle_failure_acknowledged() {
     ui_manager_->switch_to_state(UIState::READY);
 }
 
-void OtaDataExportController::start_data_export_ui() {
-    if (!ui_manager_ || !ui_manager_->bluetooth_manager) {
-        return;
-    }
-
-    if (ui_manager_->bluetooth_manager->is_data_export_active()) {
-        data_export_active_ = true;
-        ui_manager_->ota_screen.show_data_export_mode();
-        ui_manager_->switch_to_state(UIState::OTA_UPDATE);
-    }
-}
-
 void OtaDataExportController::poll_data_export() {
     if (!ui_manager_ || !ui_manager_->bluetooth_manager) {
         return;
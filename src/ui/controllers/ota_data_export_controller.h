@@ -1,12 +1,14 @@
 #pragma once
 
 #include <lvgl.h>
+#include "../../system/state_machine.h"
 
 class UIManager;
 
-// Tracks OTA progress, handles failures, and manages data export UI
+// Tracks OTA progress, handles failures, and manages data export UI. BLE posts OTA_UPDATE when an
+// update or an export starts; entering it picks the screen mode, update() follows the progress.
 
-class OtaDataExportController {
+class OtaDataExportController : public StateObserver {
 public:
     explicit OtaDataExportController(UIManager* manager);
 
@@ -14,6 +16,7 @@ public:
 
     // Returns true when OTA handling consumed the frame (skip further updates)
     bool update();
+    void on_state_enter(UIState state, UIState previous) override;
 
     void update_progress(int percent);
     void update_status(const char* status);
@@ -23,7 +26,6 @@ public:
 
 private:
     void handle_failure_acknowledged();
-    void start_data_export_ui();
     void poll_data_export();
     void stop_data_export_ui();
     void clear_failure_info();
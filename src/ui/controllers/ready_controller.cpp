@@ -1,27 +1,38 @@
 #include "ready_controller.h"
 
-#include <Preferences.h>
 #include <lvgl.h>
 #include "../../config/constants.h"
 #include "../../controllers/grind_mode_traits.h"
+#include "../../system/config_store.h"
 #include "../event_bridge_lvgl.h"
 #include "../ui_manager.h"
 
 ReadyUIController::ReadyUIController(UIManager* manager)
     : ui_manager_(manager) {}
 
-void ReadyUIController::update() {}
+void ReadyUIController::update() {
+    // A profile recalled over BLE or MQTT changes a tab behind the screen
+    if (ui_manager_ && ui_manager_->profile_controller &&
+        ui_manager_->profile_controller->get_change_count() != profile_change_count_) {
+        refresh_profiles();
+    }
+}
 
 void ReadyUIController::refresh_profiles() {
     if (!ui_manager_ || !ui_manager_->profile_controller) {
         return;
     }
 
+    ProfileController& profiles = *ui_manager_->profile_controller;
+    profile_change_count_ = profiles.get_change_count();
     float values[USER_PROFILE_COUNT];
+    const char* names[USER_PROFILE_COUNT];
     for (int i = 0; i < USER_PROFILE_COUNT; ++i) {
-        values[i] = get_profile_target(*ui_manager_->profile_controller, ui_manager_->current_mode, i);
+        values[i] = get_profile_target(profiles, ui_manager_->current_mode, i);
+        names[i] = profiles.get_profile_name(i);
     }
     ui_manager_->ready_screen.update_profile_values(values, ui_manager_->current_mode);
+    ui_manager_->ready_screen.update_profile_names(names);
 }
 
 void ReadyUIController::handle_tab_change(int tab) {
@@ -51,6 +62,7 @@ void ReadyUIController::handle_profile_long_press() {
 
     ui_manager_->original_target = get_current_profile_target(*ui_manager_->profile_controller, ui_manager_->current_mode);
     ui_manager_->edit_target = ui_manager_->original_target;
+    ui_manager_->ensure_screen(UIScreen::EDIT);
     ui_manager_->edit_screen.set_mode(ui_manager_->current_mode);
     if (ui_manager_->edit_controller_) {
         ui_manager_->edit_controller_->update_display();
@@ -63,12 +75,7 @@ void ReadyUIController::toggle_mode() {
         return;
     }
 
-    Preferences prefs;
-    prefs.begin("swipe", true); // read-only
-    bool swipe_enabled = prefs.getBool("enabled", false);
-    prefs.end();
-
-    if (!swipe_enabled) {
+    if (!config_store.get_flag(ConfigFlag::SWIPE)) {
         return;
     }
 
@@ -138,14 +145,14 @@ void ReadyUIController::register_events() {
     lv_obj_add_event_cb(lv_scr_act(), gesture_handler, LV_EVENT_GESTURE, ui_manager_);
 
     EventBridgeLVGL::register_handler(EventBridgeLVGL::EventType::TAB_CHANGE,
-                                      [this](lv_event_t* event) {
+                                      [](void* context, lv_event_t* event) {
                                           lv_obj_t* tabview_obj = static_cast<lv_obj_t*>(lv_event_get_target(event));
                                           uint32_t tab_id = lv_tabview_get_tab_act(tabview_obj);
-                                          handle_tab_change(static_cast<int>(tab_id));
-                                      });
+                                          static_cast<ReadyUIController*>(context)->handle_tab_change(static_cast<int>(tab_id));
+                                      }, this);
 
-    EventBridgeLVGL::register_handler(EventBridgeLVGL::EventType::PROFILE_LONG_PRESS,
-                                      [this](lv_event_t*) { handle_profile_long_press(); });
+    EventBridgeLVGL::bind<&ReadyUIController::handle_profile_long_press>(EventBridgeLVGL::EventType::PROFILE_LONG_PRESS,
+                                                                         this);
 
     ui_manager_->ready_screen.set_profile_long_press_handler(EventBridgeLVGL::profile_long_press_handler);
 
@@ -19,4 +19,5 @@ public:
 
 private:
     UIManager* ui_manager_;
+    uint32_t profile_change_count_ = 0;     // ProfileController::get_change_count() at the last refresh
 };
@@ -3,6 +3,8 @@
 #include "../../config/constants.h"
 #include "../../hardware/display_manager.h"
 #include "../../hardware/hardware_manager.h"
+#include "../../system/power_manager.h"
+#include "../../tasks/task_manager.h"
 #include "../ui_manager.h"
 
 ScreenTimeoutController::ScreenTimeoutController(UIManager* manager)
@@ -39,14 +41,18 @@ void ScreenTimeoutController::update() {
             display->set_brightness(normal);
             screen_dimmed_ = false;
         }
+        update_sampling_power(false);
+        update_light_sleep(false);
         return;
     }
 
     uint32_t ms_since_touch = touch_driver->get_ms_since_last_touch();
     auto* sensor = hardware->get_weight_sensor();
-    bool recent_weight_activity = sensor &&
-                                  sensor->weight_range_exceeds(USER_SCREEN_AUTO_DIM_TIMEOUT_MS,
-                                                               USER_WEIGHT_ACTIVITY_THRESHOLD_G);
+    // Watch mode flags a coarse weight change on Core 0 before the range scan sees it
+    bool recent_weight_activity = task_manager.consume_sampling_weight_wake() ||
+                                  (sensor &&
+                                   sensor->weight_range_exceeds(USER_SCREEN_AUTO_DIM_TIMEOUT_MS,
+                                                                USER_WEIGHT_ACTIVITY_THRESHOLD_G));
 
     bool should_dim = (ms_since_touch >= USER_SCREEN_AUTO_DIM_TIMEOUT_MS) && !recent_weight_activity;
 
@@ -65,4 +71,27 @@ void ScreenTimeoutController::update() {
         display->set_brightness(normal);
         screen_dimmed_ = false;
     }
+
+    update_sampling_power(screen_dimmed_);
+    update_light_sleep(screen_dimmed_);
+}
+
+void ScreenTimeoutController::update_sampling_power(bool screen_dimmed) {
+    SamplingPowerMode mode = SamplingPowerMode::ACTIVE;
+    if (screen_dimmed && ui_manager_->state_machine &&
+        ui_manager_->state_machine->is_state(UIState::READY)) {
+        // Start-on-Cup still needs weight samples to trigger; otherwise only a touch wakes us
+        mode = ui_manager_->is_auto_start_enabled() ? SamplingPowerMode::IDLE_WATCH
+                                                     : SamplingPowerMode::IDLE_OFF;
+    }
+    task_manager.set_sampling_power_mode(mode);
+}
+
+void ScreenTimeoutController::update_light_sleep(bool screen_dimmed) {
+    // Light sleep stops the DOUT interrupt, USB serial and the radio's connection timing
+    auto* bluetooth = ui_manager_->bluetooth_manager;
+    bool may_sleep = screen_dimmed && !NETWORK_MQTT_ENABLED &&
+                     ui_manager_->state_machine && ui_manager_->state_machine->is_state(UIState::READY) &&
+                     !(bluetooth && bluetooth->is_enabled());
+    power_manager.set_hold(PowerHold::AWAKE, !may_sleep);
 }
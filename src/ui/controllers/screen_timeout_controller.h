@@ -4,7 +4,9 @@
 
 class UIManager;
 
-// Implements automatic screen dimming based on touch/weight activity
+// Implements automatic screen dimming based on touch/weight activity, and
+// drops load cell sampling to an idle power mode while the screen is dimmed.
+// A dimmed Ready screen with the radios off also allows light sleep.
 
 class ScreenTimeoutController {
 public:
@@ -14,6 +16,9 @@ public:
     void update();
 
 private:
+    void update_sampling_power(bool screen_dimmed);
+    void update_light_sleep(bool screen_dimmed);
+
     UIManager* ui_manager_;
     bool screen_dimmed_;
 };
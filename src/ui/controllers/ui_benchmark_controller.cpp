@@ -0,0 +1,325 @@
+#include "ui_benchmark_controller.h"
+
+#include <Arduino.h>
+#include <algorithm>
+#include "../../config/constants.h"
+#include "../../controllers/grind_controller.h"
+#include "../../hardware/display_manager.h"
+#include "../../hardware/hardware_manager.h"
+#include "../event_bridge_lvgl.h"
+#include "../ui_manager.h"
+
+#if FEATURE_DEBUG_TOOLS
+
+// The menu stage ends between drags: a pointer released before the drag turns into a
+// scroll would click whatever is under it
+static_assert(SYS_UI_BENCHMARK_STAGE_MS % (2 * (SYS_UI_BENCHMARK_SWIPE_MS + SYS_UI_BENCHMARK_SWIPE_MS / 4)) == 0,
+              "UI benchmark stage must be a whole number of drag cycles");
+
+namespace {
+const char* const kStageNames[(size_t)UIBenchmarkStage::COUNT] = {
+    "ready", "grinding_arc", "grinding_chart", "menu_scroll"
+};
+} // namespace
+
+UIBenchmarkController::UIBenchmarkController(UIManager* manager)
+    : ui_manager_(manager),
+      start_requested_(false),
+      running_(false),
+      stage_(UIBenchmarkStage::READY),
+      stage_start_ms_(0),
+      start_state_(UIState::READY),
+      start_layout_(GrindScreenLayout::MINIMAL_ARC),
+      menu_scrollable_(false),
+      results_{} {}
+
+void UIBenchmarkController::register_events() {
+    using ET = EventBridgeLVGL::EventType;
+    // Started on the next cycle, outside the button's event
+    EventBridgeLVGL::register_handler(ET::UI_BENCHMARK_START, [](void* context, lv_event_t*) {
+        static_cast<UIBenchmarkController*>(context)->start_requested_ = true;
+    }, this);
+}
+
+bool UIBenchmarkController::update() {
+    if (!ui_manager_) {
+        return false;
+    }
+
+    if (!running_) {
+        auto* bluetooth = ui_manager_->bluetooth_manager;
+        if (bluetooth && bluetooth->take_ui_benchmark_request()) {
+            start_requested_ = true;
+        }
+        if (!start_requested_) {
+            return false;
+        }
+        start_requested_ = false;
+        if (!can_start()) {
+            LOG_BLE("[%lums UI_BENCHMARK] Not started: needs the Ready screen or the menu with the grinder idle\n",
+                    millis());
+            return false;
+        }
+        start();
+        return true;
+    }
+
+    // A grind started under the benchmark owns the screen from here
+    if (ui_manager_->grind_controller && ui_manager_->grind_controller->is_active()) {
+        LOG_BLE("[%lums UI_BENCHMARK] Aborted: grind started during stage %s\n", millis(), get_name(stage_));
+        finish(false);
+        return false;
+    }
+
+    uint32_t elapsed_ms = millis() - stage_start_ms_;
+    if (elapsed_ms < SYS_UI_BENCHMARK_STAGE_MS) {
+        drive_stage(elapsed_ms);
+        return true;
+    }
+
+    finish_stage(elapsed_ms);
+    UIBenchmarkStage next = (UIBenchmarkStage)((uint8_t)stage_ + 1);
+    if (next < UIBenchmarkStage::COUNT) {
+        enter_stage(next);
+    } else {
+        finish(true);
+    }
+    return running_;
+}
+
+bool UIBenchmarkController::can_start() const {
+    if (!ui_manager_->hardware_manager || !ui_manager_->state_machine) {
+        return false;
+    }
+    if (!ui_manager_->state_machine->is_state(UIState::READY) &&
+        !ui_manager_->state_machine->is_state(UIState::MENU)) {
+        return false;
+    }
+    if (ui_manager_->grind_controller && ui_manager_->grind_controller->is_active()) {
+        return false;
+    }
+    auto* bluetooth = ui_manager_->bluetooth_manager;
+    return !bluetooth || (!bluetooth->is_updating() && !bluetooth->is_data_export_active());
+}
+
+void UIBenchmarkController::start() {
+    running_ = true;
+    start_state_ = ui_manager_->state_machine->get_current_state();
+    start_layout_ = ui_manager_->grinding_screen.get_layout();
+    for (StageResult& result : results_) {
+        result = {};
+    }
+    ui_manager_->hardware_manager->get_display()->set_frame_callback(on_frame, this);
+
+    LOG_BLE("[%lums UI_BENCHMARK] Starting: %u stages of %lums\n", millis(),
+            (unsigned)UIBenchmarkStage::COUNT, (unsigned long)SYS_UI_BENCHMARK_STAGE_MS);
+    enter_stage(UIBenchmarkStage::READY);
+}
+
+void UIBenchmarkController::enter_stage(UIBenchmarkStage stage) {
+    stage_ = stage;
+    frame_count_ = 0;
+    frame_sum_us_ = 0;
+    flush_sum_us_ = 0;
+    invalidated_sum_px_ = 0;
+    flushed_sum_px_ = 0;
+    frame_max_us_ = 0;
+    render_max_us_ = 0;
+    flush_max_us_ = 0;
+    input_count_ = 0;
+    input_sum_us_ = 0;
+    input_max_us_ = 0;
+
+    DisplayManager* display = ui_manager_->hardware_manager->get_display();
+    display->clear_injected_touch();
+
+    switch (stage) {
+        case UIBenchmarkStage::READY:
+            ui_manager_->switch_to_state(UIState::READY);
+            break;
+        case UIBenchmarkStage::GRINDING_ARC:
+            ui_manager_->ensure_screen(UIScreen::GRINDING);
+            ui_manager_->grinding_screen.set_layout(GrindScreenLayout::MINIMAL_ARC);
+            ui_manager_->switch_to_state(UIState::GRINDING);
+            break;
+        case UIBenchmarkStage::GRINDING_CHART:
+            ui_manager_->grinding_screen.set_layout(GrindScreenLayout::NERDY_CHART);
+            ui_manager_->grinding_screen.reset_chart_data();
+            ui_manager_->grinding_screen.set_chart_time_prediction(SYS_UI_BENCHMARK_STAGE_MS);
+            break;
+        case UIBenchmarkStage::MENU_SCROLL: {
+            ui_manager_->switch_to_state(UIState::MENU);
+            // The Diagnostics page is long and has no sliders, so a drag can only scroll it
+            lv_obj_t* page = ui_manager_->menu_screen.get_diagnostics_page();
+            lv_menu_set_page(ui_manager_->menu_screen.get_tabview(), page);
+            lv_obj_scroll_to_y(page, 0, LV_ANIM_OFF);
+            lv_obj_update_layout(page);
+            menu_scrollable_ = lv_obj_get_scroll_bottom(page) > 0;
+            if (!menu_scrollable_) {
+                // Nothing to scroll: a drag would end as a click on whatever is under it
+                LOG_BLE("[%lums UI_BENCHMARK] Diagnostics page fits the screen, no touch injection\n", millis());
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    stage_start_ms_ = millis();
+}
+
+void UIBenchmarkController::drive_stage(uint32_t elapsed_ms) {
+    switch (stage_) {
+        case UIBenchmarkStage::READY: {
+            // Step every label each frame
+            auto* profiles = ui_manager_->profile_controller;
+            float step = (float)(elapsed_ms / SYS_UI_FRAME_PERIOD_CALM_MS) * 0.1f;
+            float values[3];
+            for (int i = 0; i < 3; i++) {
+                float base = ui_manager_->current_mode == GrindMode::TIME ? profiles->get_profile_time(i)
+                                                                          : profiles->get_profile_weight(i);
+                values[i] = base + step;
+            }
+            ui_manager_->ready_screen.update_profile_values(values, ui_manager_->current_mode);
+            break;
+        }
+        case UIBenchmarkStage::GRINDING_ARC:
+        case UIBenchmarkStage::GRINDING_CHART: {
+            // A dose ground at a steady rate over the stage; chart points are fed in both layouts, as in a grind
+            float target = ui_manager_->profile_controller->get_current_weight();
+            float fraction = (float)elapsed_ms / SYS_UI_BENCHMARK_STAGE_MS;
+            float weight = target * fraction;
+            float flow_rate = target * 1000.0f / SYS_UI_BENCHMARK_STAGE_MS;
+            GrindingScreen& screen = ui_manager_->grinding_screen;
+            screen.update_current_weight(weight);
+            screen.update_progress((int)(fraction * 100.0f));
+            screen.update_eta(SYS_UI_BENCHMARK_STAGE_MS - elapsed_ms, SYS_UI_BENCHMARK_STAGE_MS / 10, true);
+            screen.add_chart_data_point(weight, flow_rate, elapsed_ms);
+            break;
+        }
+        case UIBenchmarkStage::MENU_SCROLL: {
+            if (!menu_scrollable_) {
+                break;
+            }
+            // Drag up, release, drag down, release
+            DisplayManager* display = ui_manager_->hardware_manager->get_display();
+            const uint32_t swipe_ms = SYS_UI_BENCHMARK_SWIPE_MS;
+            const uint32_t release_ms = swipe_ms / 4;
+            uint32_t t = elapsed_ms % (2 * (swipe_ms + release_ms));
+            uint16_t x = display->get_width() / 2;
+            uint16_t top = display->get_height() * 3 / 10;
+            uint16_t bottom = display->get_height() * 7 / 10;
+            uint16_t span = bottom - top;
+            if (t < swipe_ms) {
+                display->inject_touch(true, x, bottom - span * t / swipe_ms);
+            } else if (t < swipe_ms + release_ms) {
+                display->inject_touch(false, x, top);
+            } else if (t < 2 * swipe_ms + release_ms) {
+                display->inject_touch(true, x, top + span * (t - swipe_ms - release_ms) / swipe_ms);
+            } else {
+                display->inject_touch(false, x, bottom);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void UIBenchmarkController::finish_stage(uint32_t elapsed_ms) {
+    StageResult& result = results_[(size_t)stage_];
+    result.frames = frame_count_;
+    result.duration_ms = elapsed_ms;
+    if (frame_count_ > 0) {
+        uint32_t kept = std::min<uint32_t>(frame_count_, SYS_UI_BENCHMARK_MAX_FRAMES);
+        result.frame_avg_us = (uint32_t)(frame_sum_us_ / frame_count_);
+        result.frame_p95_us = percentile_95(frame_us_, kept);
+        result.frame_max_us = frame_max_us_;
+        result.render_avg_us = (uint32_t)((frame_sum_us_ - flush_sum_us_) / frame_count_);
+        result.render_p95_us = percentile_95(render_us_, kept);
+        result.render_max_us = render_max_us_;
+        result.flush_avg_us = (uint32_t)(flush_sum_us_ / frame_count_);
+        result.flush_max_us = flush_max_us_;
+        result.invalidated_px = (uint32_t)(invalidated_sum_px_ / frame_count_);
+        result.flushed_px = (uint32_t)(flushed_sum_px_ / frame_count_);
+    }
+    result.input_count = input_count_;
+    result.input_avg_us = input_count_ > 0 ? (uint32_t)(input_sum_us_ / input_count_) : 0;
+    result.input_max_us = input_max_us_;
+}
+
+void UIBenchmarkController::finish(bool completed) {
+    running_ = false;
+    DisplayManager* display = ui_manager_->hardware_manager->get_display();
+    display->clear_injected_touch();
+    display->set_frame_callback(nullptr, nullptr);
+    ui_manager_->grinding_screen.set_layout(start_layout_);
+    if (!completed) {
+        return;
+    }
+
+    ui_manager_->switch_to_state(start_state_);
+    print_report();
+}
+
+void UIBenchmarkController::print_report() const {
+    LOG_BLE("=== UI Benchmark ===\n");
+    for (size_t i = 0; i < (size_t)UIBenchmarkStage::COUNT; i++) {
+        const StageResult& r = results_[i];
+        uint32_t fps_x10 = r.duration_ms > 0 ? r.frames * 10000 / r.duration_ms : 0;
+        LOG_BLE("  %s: %lu frames in %lums, %lu.%lu fps\n", kStageNames[i], (unsigned long)r.frames,
+                (unsigned long)r.duration_ms, (unsigned long)(fps_x10 / 10), (unsigned long)(fps_x10 % 10));
+        LOG_BLE("    frame avg %luus p95 %luus max %luus\n", (unsigned long)r.frame_avg_us,
+                (unsigned long)r.frame_p95_us, (unsigned long)r.frame_max_us);
+        LOG_BLE("    render avg %luus p95 %luus max %luus, flush avg %luus max %luus\n",
+                (unsigned long)r.render_avg_us, (unsigned long)r.render_p95_us, (unsigned long)r.render_max_us,
+                (unsigned long)r.flush_avg_us, (unsigned long)r.flush_max_us);
+        LOG_BLE("    invalidated %lu px/frame, flushed %lu px/frame\n", (unsigned long)r.invalidated_px,
+                (unsigned long)r.flushed_px);
+        if (r.input_count > 0) {
+            LOG_BLE("    touch to pixel: %lu moves, avg %luus max %luus\n", (unsigned long)r.input_count,
+                    (unsigned long)r.input_avg_us, (unsigned long)r.input_max_us);
+        }
+    }
+    LOG_BLE("====================\n");
+}
+
+void UIBenchmarkController::record_frame(const DisplayFrameSample& sample) {
+    uint32_t render_us = sample.frame_us > sample.flush_us ? sample.frame_us - sample.flush_us : 0;
+    if (frame_count_ < SYS_UI_BENCHMARK_MAX_FRAMES) {
+        frame_us_[frame_count_] = sample.frame_us;
+        render_us_[frame_count_] = render_us;
+    }
+    frame_count_++;
+    frame_sum_us_ += sample.frame_us;
+    flush_sum_us_ += sample.flush_us;
+    invalidated_sum_px_ += sample.invalidated_px;
+    flushed_sum_px_ += sample.flushed_px;
+    frame_max_us_ = std::max(frame_max_us_, sample.frame_us);
+    render_max_us_ = std::max(render_max_us_, render_us);
+    flush_max_us_ = std::max(flush_max_us_, sample.flush_us);
+    if (sample.input_latency_us > 0) {
+        input_count_++;
+        input_sum_us_ += sample.input_latency_us;
+        input_max_us_ = std::max(input_max_us_, sample.input_latency_us);
+    }
+}
+
+// Called from lv_timer_handler() on the UI task
+void UIBenchmarkController::on_frame(const DisplayFrameSample& sample, void* context) {
+    static_cast<UIBenchmarkController*>(context)->record_frame(sample);
+}
+
+uint32_t UIBenchmarkController::percentile_95(uint32_t* values, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t index = count * 95 / 100;
+    std::nth_element(values, values + index, values + count);
+    return values[index];
+}
+
+const char* UIBenchmarkController::get_name(UIBenchmarkStage stage) {
+    return stage < UIBenchmarkStage::COUNT ? kStageNames[(size_t)stage] : "?";
+}
+
+#endif // FEATURE_DEBUG_TOOLS
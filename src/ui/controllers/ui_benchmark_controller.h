@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include "../../config/constants.h"
+#include "../../system/state_machine.h"
+#include "../screens/grinding_screen_base.h"
+
+class UIManager;
+struct DisplayFrameSample;
+
+// Benchmark stages, run in this order
+enum class UIBenchmarkStage : uint8_t {
+    READY,                          // Profile values rewritten every cycle
+    GRINDING_ARC,                   // Synthetic grind: weight, progress and ETA
+    GRINDING_CHART,                 // The same with chart points
+    MENU_SCROLL,                    // Injected drags up and down the Diagnostics page
+    COUNT
+};
+
+/**
+ * UIBenchmarkController - Frame time and touch-to-pixel benchmark
+ *
+ * Started from the Diagnostics page or BLE_DEBUG_CMD_UI_BENCHMARK, from the
+ * Ready screen or the menu with the grinder idle. Each stage shows its screen
+ * for SYS_UI_BENCHMARK_STAGE_MS and drives it with synthetic data; the motor
+ * and the grind controller are never touched. The menu stage injects drags
+ * through DisplayManager::inject_touch(), which LVGL reads in place of the
+ * touch panel, and measures each injected move to the end of the frame that
+ * drew it. DisplayManager reports every frame that flushed pixels: frame time
+ * (refresh start to ready), the part of it spent flushing, and the invalidated
+ * and flushed areas. The report is logged when the last stage ends and the
+ * starting screen is restored.
+ *
+ * Runs on the UI task; auto start and auto return are held off while running.
+ */
+class UIBenchmarkController {
+public:
+    explicit UIBenchmarkController(UIManager* manager);
+
+    void register_events();
+    // Start a pending request or advance the running benchmark; true while running
+    bool update();
+    bool is_running() const { return running_; }
+
+private:
+    struct StageResult {
+        uint32_t frames;
+        uint32_t duration_ms;
+        uint32_t frame_avg_us;
+        uint32_t frame_p95_us;
+        uint32_t frame_max_us;
+        uint32_t render_avg_us;         // frame_us less flush_us
+        uint32_t render_p95_us;
+        uint32_t render_max_us;
+        uint32_t flush_avg_us;
+        uint32_t flush_max_us;
+        uint32_t invalidated_px;        // Per frame
+        uint32_t flushed_px;
+        uint32_t input_count;           // Frames answering an injected touch change
+        uint32_t input_avg_us;
+        uint32_t input_max_us;
+    };
+
+    UIManager* ui_manager_;
+    bool start_requested_;
+    bool running_;
+    UIBenchmarkStage stage_;
+    uint32_t stage_start_ms_;
+    UIState start_state_;
+    GrindScreenLayout start_layout_;
+    bool menu_scrollable_;              // Diagnostics page overflows: drags are injected
+
+    // Frames of the current stage
+    uint32_t frame_count_;
+    uint64_t frame_sum_us_;
+    uint64_t flush_sum_us_;
+    uint64_t invalidated_sum_px_;
+    uint64_t flushed_sum_px_;
+    uint32_t frame_max_us_;
+    uint32_t render_max_us_;
+    uint32_t flush_max_us_;
+    uint32_t input_count_;
+    uint64_t input_sum_us_;
+    uint32_t input_max_us_;
+    uint32_t frame_us_[SYS_UI_BENCHMARK_MAX_FRAMES];
+    uint32_t render_us_[SYS_UI_BENCHMARK_MAX_FRAMES];
+
+    StageResult results_[(size_t)UIBenchmarkStage::COUNT];
+
+    bool can_start() const;
+    void start();
+    void enter_stage(UIBenchmarkStage stage);
+    void drive_stage(uint32_t elapsed_ms);
+    void finish_stage(uint32_t elapsed_ms);
+    void finish(bool completed);
+    void print_report() const;
+    void record_frame(const DisplayFrameSample& sample);
+    static void on_frame(const DisplayFrameSample& sample, void* context);
+    static uint32_t percentile_95(uint32_t* values, uint32_t count);
+    static const char* get_name(UIBenchmarkStage stage);
+};
@@ -1,10 +1,9 @@
 #include "event_bridge_lvgl.h"
 #include "ui_manager.h"
 #include "../config/constants.h"
-#include <utility>
 
 UIManager* EventBridgeLVGL::ui_manager = nullptr;
-std::array<EventBridgeLVGL::EventHandler, static_cast<size_t>(EventBridgeLVGL::EventType::COUNT)> EventBridgeLVGL::custom_handlers{};
+EventBridgeLVGL::Binding EventBridgeLVGL::handlers[static_cast<size_t>(EventBridgeLVGL::EventType::COUNT)] = {};
 
 void EventBridgeLVGL::set_ui_manager(UIManager* mgr) {
     ui_manager = mgr;
@@ -27,18 +26,15 @@ void EventBridgeLVGL::profile_long_press_handler(lv_event_t* e) {
 
 void EventBridgeLVGL::handle_event(EventType event_type, lv_event_t* e) {
     size_t index = static_cast<size_t>(event_type);
-    if (index < custom_handlers.size()) {
-        auto& handler = custom_handlers[index];
-        if (handler) {
-            handler(e);
-            return;
-        }
+    if (index < static_cast<size_t>(EventType::COUNT) && handlers[index].handler) {
+        handlers[index].handler(handlers[index].context, e);
+        return;
     }
 
     LOG_BLE("[WARNING] EventBridgeLVGL: No handler registered for event type: %d\n",
             static_cast<int>(event_type));
 }
 
-void EventBridgeLVGL::register_handler(EventType event_type, EventHandler handler) {
-    custom_handlers[static_cast<size_t>(event_type)] = std::move(handler);
+void EventBridgeLVGL::register_handler(EventType event_type, EventHandler handler, void* context) {
+    handlers[static_cast<size_t>(event_type)] = {handler, context};
 }
@@ -1,7 +1,6 @@
 #pragma once
 #include <lvgl.h>
-#include <array>
-#include <functional>
+#include <cstddef>
 
 // Forward declaration
 class UIManager;
@@ -31,11 +30,17 @@ public:
         BLE_TOGGLE,
         BLE_STARTUP_TOGGLE,
         LOGGING_TOGGLE,
+        PERF_MONITOR_TOGGLE,
+        UI_BENCHMARK_START,
+        HOT_PATH_BENCHMARK_START,
         GRIND_MODE_SWIPE_TOGGLE,
         GRIND_MODE_RADIO_BUTTON,
+        GRINDER_CHANNEL_RADIO_BUTTON,
         AUTO_START_TOGGLE,
         AUTO_RETURN_TOGGLE,
         GRIND_PRIME_TOGGLE,
+        BATCH_DOSES_SLIDER,
+        BATCH_DOSES_SLIDER_RELEASED,
         BRIGHTNESS_NORMAL_SLIDER,
         BRIGHTNESS_NORMAL_SLIDER_RELEASED,
         BRIGHTNESS_SCREENSAVER_SLIDER,
@@ -49,7 +54,8 @@ public:
         COUNT
     };
 
-    using EventHandler = std::function<void(lv_event_t*)>;
+    // A plain function and the controller it acts on: nothing captured, nothing allocated
+    using EventHandler = void (*)(void* context, lv_event_t* e);
 
     static void set_ui_manager(UIManager* mgr);
 
@@ -63,9 +69,21 @@ public:
     static void handle_event(EventType event_type, lv_event_t* e);
 
     // Controller registration hook
-    static void register_handler(EventType event_type, EventHandler handler);
+    static void register_handler(EventType event_type, EventHandler handler, void* context = nullptr);
+
+    // A controller method as the handler; its thunk is generated at compile time
+    template <auto Method, typename Controller>
+    static void bind(EventType event_type, Controller* controller) {
+        register_handler(event_type, [](void* context, lv_event_t*) { (static_cast<Controller*>(context)->*Method)(); },
+                         controller);
+    }
 
 private:
+    struct Binding {
+        EventHandler handler;
+        void* context;
+    };
+
     static UIManager* ui_manager;
-    static std::array<EventHandler, static_cast<size_t>(EventType::COUNT)> custom_handlers;
+    static Binding handlers[static_cast<size_t>(EventType::COUNT)];
 };
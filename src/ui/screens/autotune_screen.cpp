@@ -4,6 +4,8 @@
 #include <algorithm>
 #include <cstring>
 
+#if FEATURE_AUTOTUNE_UI
+
 void AutoTuneScreen::create() {
     screen = lv_obj_create(lv_scr_act());
     lv_obj_set_size(screen, LV_PCT(100), LV_PCT(100));
@@ -101,6 +103,13 @@ void AutoTuneScreen::hide() {
     visible = false;
 }
 
+void AutoTuneScreen::destroy() {
+    if (!screen) return;
+    lv_obj_delete_async(screen);
+    screen = nullptr;
+    visible = false;
+}
+
 void AutoTuneScreen::show_console_screen() {
     current_state = AutoTuneScreenState::CONSOLE;
 
@@ -222,3 +231,5 @@ void AutoTuneScreen::update_progress(const AutoTuneProgress& progress) {
         // which overwrites the buffer with new content.
     }
 }
+
+#endif // FEATURE_AUTOTUNE_UI
@@ -3,6 +3,8 @@
 #include "../../config/constants.h"
 #include "../../controllers/autotune_controller.h"
 
+#if FEATURE_AUTOTUNE_UI
+
 enum class AutoTuneScreenState {
     CONSOLE,        // Running with console log
     RESULT          // Final success/failure screen
@@ -10,7 +12,7 @@ enum class AutoTuneScreenState {
 
 class AutoTuneScreen {
 private:
-    lv_obj_t* screen;
+    lv_obj_t* screen = nullptr;
     lv_obj_t* title_label;
 
     // Console screen elements
@@ -33,6 +35,7 @@ private:
 
 public:
     void create();
+    void destroy();                         // Deletes the widgets; create() rebuilds them
     void show();
     void hide();
 
@@ -44,8 +47,21 @@ public:
     void update_progress(const AutoTuneProgress& progress);
 
     bool is_visible() const { return visible; }
+    bool is_created() const { return screen != nullptr; }
     AutoTuneScreenState get_state() const { return current_state; }
     lv_obj_t* get_screen() const { return screen; }
     lv_obj_t* get_cancel_button() const { return cancel_button; }
     lv_obj_t* get_ok_button() const { return ok_button; }
 };
+
+#else
+// Built without FEATURE_AUTOTUNE_UI: the menu has no entry that leads here
+class AutoTuneScreen {
+public:
+    void create() {}
+    void destroy() {}
+    void show() {}
+    void hide() {}
+    bool is_created() const { return false; }
+};
+#endif // FEATURE_AUTOTUNE_UI
@@ -91,6 +91,13 @@ void CalibrationScreen::hide() {
     visible = false;
 }
 
+void CalibrationScreen::destroy() {
+    if (!screen) return;
+    lv_obj_delete_async(screen);
+    screen = nullptr;
+    visible = false;
+}
+
 void CalibrationScreen::set_step(CalibrationStep step) {
     current_step = step;
     
@@ -124,6 +131,19 @@ void CalibrationScreen::set_step(CalibrationStep step) {
             update_calibration_weight(calibration_weight);
             break;
 
+        case CAL_STEP_POINT_SAVED:
+            lv_label_set_text(title_label, "CALIBRATION");
+            lv_label_set_text(instruction_label, "Point saved\nOK to finish or +\nfor a heavier weight");
+            lv_obj_clear_flag(cancel_button, LV_OBJ_FLAG_HIDDEN);
+            lv_obj_clear_flag(plus_btn, LV_OBJ_FLAG_HIDDEN);
+            lv_obj_add_flag(minus_btn, LV_OBJ_FLAG_HIDDEN);
+            lv_obj_clear_flag(weight_label, LV_OBJ_FLAG_HIDDEN);
+            set_noise_ui_visible(false);
+            set_ok_button_text(LV_SYMBOL_OK);
+            set_cancel_button_text(LV_SYMBOL_CLOSE);
+            set_ok_button_enabled(true);
+            break;
+
         case CAL_STEP_NOISE_CHECK:
             lv_label_set_text(title_label, "NOISE CHECK");
             lv_label_set_text(instruction_label,
@@ -187,6 +207,12 @@ void CalibrationScreen::update_calibration_weight(float weight) {
     }
 }
 
+void CalibrationScreen::set_instruction_text(const char* text) {
+    if (instruction_label) {
+        lv_label_set_text(instruction_label, text);
+    }
+}
+
 void CalibrationScreen::update_noise_status(const char* text, lv_color_t color) {
     if (!noise_status_label) {
         return;
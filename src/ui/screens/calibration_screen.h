@@ -5,13 +5,14 @@
 enum CalibrationStep {
     CAL_STEP_EMPTY,
     CAL_STEP_WEIGHT,
+    CAL_STEP_POINT_SAVED,       // Point captured: finish, or + for a heavier weight
     CAL_STEP_NOISE_CHECK,
     CAL_STEP_COMPLETE
 };
 
 class CalibrationScreen {
 private:
-    lv_obj_t* screen;
+    lv_obj_t* screen = nullptr;
     lv_obj_t* title_label;
     lv_obj_t* instruction_label;
     lv_obj_t* weight_label;
@@ -29,11 +30,13 @@ private:
 
 public:
     void create();
+    void destroy();                         // Deletes the widgets; create() rebuilds them
     void show();
     void hide();
     void set_step(CalibrationStep step);
     void update_current_weight(float weight);
     void update_calibration_weight(float weight);
+    void set_instruction_text(const char* text);
     void update_noise_status(const char* text, lv_color_t color);
     void update_noise_metric(float std_dev_g);
     void set_noise_ui_visible(bool visible);
@@ -42,6 +45,7 @@ public:
     void set_cancel_button_text(const char* text);
     
     bool is_visible() const { return visible; }
+    bool is_created() const { return screen != nullptr; }
     CalibrationStep get_step() const { return current_step; }
     lv_obj_t* get_screen() const { return screen; }
     lv_obj_t* get_ok_button() const { return ok_button; }
@@ -7,7 +7,7 @@
 
 class ConfirmScreen {
 private:
-    lv_obj_t* screen;
+    lv_obj_t* screen = nullptr;
     lv_obj_t* title_label;
     lv_obj_t* message_label;
     lv_obj_t* confirm_button;
@@ -25,6 +25,7 @@ public:
     void hide();
     
     bool is_visible() const { return visible; }
+    bool is_created() const { return screen != nullptr; }
     lv_obj_t* get_screen() const { return screen; }
     lv_obj_t* get_confirm_button() const { return confirm_button; }
     lv_obj_t* get_cancel_button() const { return cancel_button; }
@@ -5,7 +5,7 @@
 
 class EditScreen {
 private:
-    lv_obj_t* screen;
+    lv_obj_t* screen = nullptr;
     lv_obj_t* profile_label;
     lv_obj_t* weight_label;
     lv_obj_t* save_btn;
@@ -24,6 +24,7 @@ public:
     void set_mode(GrindMode time_mode);
     
     bool is_visible() const { return visible; }
+    bool is_created() const { return screen != nullptr; }
     lv_obj_t* get_screen() const { return screen; }
     lv_obj_t* get_save_btn() const { return save_btn; }
     lv_obj_t* get_cancel_btn() const { return cancel_btn; }
@@ -1,21 +1,16 @@
 #include "grinding_screen.h"
-#include <Preferences.h>
+#include "../../system/config_store.h"
 
-GrindingScreen::GrindingScreen() : current_layout(GrindScreenLayout::MINIMAL_ARC), preferences(nullptr), current_mode(GrindMode::WEIGHT) {
-    // Layout will be loaded in init() when preferences are available
+GrindingScreen::GrindingScreen() : current_layout(GrindScreenLayout::MINIMAL_ARC), current_mode(GrindMode::WEIGHT), created(false) {
+    // Layout will be loaded in init() once the configuration is loaded
     active_screen = (IGrindingScreen*)&arc_screen; // Default to arc screen
 }
 
-void GrindingScreen::init(Preferences* prefs) {
-    preferences = prefs;
-    
-    // Load saved layout preference using the provided preferences instance
-    if (preferences && preferences->isKey("grind_layout")) {
-        int saved_layout = preferences->getInt("grind_layout", (int)GrindScreenLayout::MINIMAL_ARC);
-        current_layout = (GrindScreenLayout)saved_layout;
-    } else {
-        current_layout = GrindScreenLayout::MINIMAL_ARC;
-    }
+void GrindingScreen::init() {
+    current_layout = (GrindScreenLayout)config_store.get_byte(ConfigByte::GRIND_LAYOUT);
+#if !FEATURE_GRIND_CHART
+    current_layout = GrindScreenLayout::MINIMAL_ARC;    // A stored chart layout falls back to the arc
+#endif
     
     // Set active screen based on loaded layout
     active_screen = (current_layout == GrindScreenLayout::NERDY_CHART) 
@@ -24,6 +19,9 @@ void GrindingScreen::init(Preferences* prefs) {
 }
 
 void GrindingScreen::set_layout(GrindScreenLayout layout) {
+#if !FEATURE_GRIND_CHART
+    layout = GrindScreenLayout::MINIMAL_ARC;
+#endif
     if (current_layout == layout) return;
     
     bool was_visible = is_visible();
@@ -44,10 +42,7 @@ void GrindingScreen::set_layout(GrindScreenLayout layout) {
         active_screen->show();
     }
     
-    // Save preference using the provided preferences instance
-    if (preferences) {
-        preferences->putInt("grind_layout", (int)layout);
-    }
+    config_store.set_byte(ConfigByte::GRIND_LAYOUT, (uint8_t)layout);
 }
 
 // Delegate all calls to active screen
@@ -63,6 +58,7 @@ void GrindingScreen::create() {
     } else {
         chart_screen.hide();
     }
+    created = true;
 }
 
 void GrindingScreen::show() {
@@ -123,12 +119,20 @@ void GrindingScreen::add_chart_data_point(float current_weight, float flow_rate,
     chart_screen.add_chart_data_point(current_weight, flow_rate, current_time_ms);
 }
 
+void GrindingScreen::update_eta(uint32_t remaining_ms, uint32_t band_ms, bool known) {
+    arc_screen.update_eta(remaining_ms, band_ms, known);
+    chart_screen.update_eta(remaining_ms, band_ms, known);
+}
+
 void GrindingScreen::reset_chart_data() {
     chart_screen.reset_chart_data();
 }
 
 void GrindingScreen::set_mode(GrindMode mode) {
+    // Called with every progress update; reapplying would resize the chart each frame
+    if (created && mode == current_mode) return;
     current_mode = mode;
+    if (!created) return;
     bool time_enabled = (mode == GrindMode::TIME);
     arc_screen.set_time_mode(time_enabled);
     chart_screen.set_time_mode(time_enabled);
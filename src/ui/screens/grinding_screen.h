@@ -2,7 +2,6 @@
 #include "grinding_screen_base.h"
 #include "grinding_screen_arc.h"
 #include "grinding_screen_chart.h"
-#include <Preferences.h>
 #include "../../controllers/grind_mode.h"
 
 // Unified grinding screen that wraps both implementations
@@ -12,14 +11,15 @@ private:
     GrindScreenLayout current_layout;
     GrindingScreenArc arc_screen;
     GrindingScreenChart chart_screen;
-    Preferences* preferences;
     GrindMode current_mode;
+    bool created;
     
 public:
     GrindingScreen();
-    void init(Preferences* prefs);
+    void init();                            // Layout from the configuration (ConfigStore)
     void set_layout(GrindScreenLayout layout);
     GrindScreenLayout get_layout() const { return current_layout; }
+    bool is_created() const { return created; }
     
     // IGrindingScreen implementation - delegates to active screen
     void create() override;
@@ -35,8 +35,9 @@ public:
     bool is_visible() const override;
     lv_obj_t* get_screen() const override;
     void add_chart_data_point(float current_weight, float flow_rate, uint32_t current_time_ms) override;
+    void update_eta(uint32_t remaining_ms, uint32_t band_ms, bool known) override;
     void reset_chart_data();
-    void set_mode(GrindMode mode);
+    void set_mode(GrindMode mode);          // Kept and applied by create() when not built yet
     void set_chart_time_prediction(uint32_t predicted_time_ms);
 
     // ADDED: Public accessors for individual screen objects
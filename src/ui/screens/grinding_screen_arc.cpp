@@ -1,6 +1,8 @@
 #include "grinding_screen_arc.h"
 #include <Arduino.h>
 #include "../../config/constants.h"
+#include "../ui_helpers.h"
+#include <cstring>
 
 void GrindingScreenArc::create() {
     screen = lv_obj_create(lv_scr_act());
@@ -43,12 +45,18 @@ void GrindingScreenArc::create() {
     lv_obj_set_style_arc_width(progress_arc, 12, LV_PART_MAIN);
     lv_obj_remove_style(progress_arc, nullptr, LV_PART_KNOB);
 
-    // Current weight label (inside arc)
-    weight_label = lv_label_create(progress_arc);
-    lv_label_set_text(weight_label, "0.0g");
-    lv_obj_set_style_text_font(weight_label, &lv_font_montserrat_56, 0);
-    lv_obj_set_style_text_color(weight_label, lv_color_hex(THEME_COLOR_TEXT_PRIMARY), 0);
-    lv_obj_center(weight_label);
+    // Current weight (inside arc), redrawn per changed digit
+    weight_digits.create(progress_arc, &lv_font_montserrat_56, lv_color_hex(THEME_COLOR_TEXT_PRIMARY));
+    weight_digits.set_text("0.0g");
+    lv_obj_center(weight_digits.get_obj());
+
+    // Time to target (inside arc, under the weight)
+    eta_label = lv_label_create(progress_arc);
+    lv_label_set_text(eta_label, "");
+    lv_obj_set_style_text_font(eta_label, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_color(eta_label, lv_color_hex(THEME_COLOR_TEXT_SECONDARY), 0);
+    lv_obj_align(eta_label, LV_ALIGN_CENTER, 0, 56);
+    shown_eta_text[0] = '\0';
     
     // MODIFIED: Ensure all child widgets pass click events to the parent screen
     for (uint32_t i = 0; i < lv_obj_get_child_cnt(screen); i++) {
@@ -96,11 +104,11 @@ void GrindingScreenArc::update_target_time(float seconds) {
 void GrindingScreenArc::update_current_weight(float weight) {
     char weight_text[16];
     snprintf(weight_text, sizeof(weight_text), SYS_WEIGHT_DISPLAY_FORMAT, weight);
-    lv_label_set_text(weight_label, weight_text);
+    weight_digits.set_text(weight_text);    // Unchanged digits are not redrawn
 }
 
 void GrindingScreenArc::update_tare_display() {
-    lv_label_set_text(weight_label, "TARE");
+    weight_digits.set_text("TARE");
     lv_arc_set_value(progress_arc, 0);  // Reset arc to 0 during taring
 }
 
@@ -108,6 +116,17 @@ void GrindingScreenArc::update_progress(int percent) {
     lv_arc_set_value(progress_arc, percent);
 }
 
+void GrindingScreenArc::update_eta(uint32_t remaining_ms, uint32_t band_ms, bool known) {
+    char eta_text[sizeof(shown_eta_text)];
+    format_eta_text(eta_text, sizeof(eta_text), remaining_ms, band_ms, known);
+    // Called every UI frame while grinding; the text only changes once a second
+    if (strcmp(eta_text, shown_eta_text) == 0) {
+        return;
+    }
+    lv_label_set_text(eta_label, eta_text);
+    memcpy(shown_eta_text, eta_text, sizeof(shown_eta_text));
+}
+
 void GrindingScreenArc::set_time_mode(bool enabled) {
     time_mode = enabled;
 }
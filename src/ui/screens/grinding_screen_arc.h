@@ -2,16 +2,19 @@
 #include <lvgl.h>
 #include "../../config/constants.h"
 #include "grinding_screen_base.h"
+#include "../components/weight_digits.h"
 
 class GrindingScreenArc : public IGrindingScreen {
 private:
     lv_obj_t* screen;
     lv_obj_t* profile_label;
     lv_obj_t* target_label;
-    lv_obj_t* weight_label;
+    WeightDigits weight_digits;
     lv_obj_t* progress_arc;
+    lv_obj_t* eta_label;            // Time to target, under the weight inside the arc
     bool visible;
     bool time_mode;
+    char shown_eta_text[16];        // eta_label text last set
 
 public:
     void create() override;
@@ -24,6 +27,7 @@ public:
     void update_current_weight(float weight) override;
     void update_tare_display() override;
     void update_progress(int percent) override;
+    void update_eta(uint32_t remaining_ms, uint32_t band_ms, bool known) override;
     void set_time_mode(bool enabled);
     
     bool is_visible() const override { return visible; }
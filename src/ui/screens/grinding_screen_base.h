@@ -20,6 +20,8 @@ public:
     
     // Chart-specific method (only implemented by chart screen)
     virtual void add_chart_data_point(float current_weight, float flow_rate, uint32_t current_time_ms) {}
+    // Predicted time to target with its +/- band; hidden when not known
+    virtual void update_eta(uint32_t remaining_ms, uint32_t band_ms, bool known) {}
 };
 
 enum class GrindScreenLayout {
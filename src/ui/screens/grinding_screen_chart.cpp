@@ -1,8 +1,12 @@
 #include "grinding_screen_chart.h"
 #include <Arduino.h>
 #include "../../config/constants.h"
+#include "../ui_helpers.h"
 #include <lvgl.h>
 #include <widgets/span/lv_span.h>
+#include <cstring>
+
+#if FEATURE_GRIND_CHART
 
 void GrindingScreenChart::create() {
     screen = lv_obj_create(lv_scr_act());
@@ -46,11 +50,15 @@ void GrindingScreenChart::create() {
     predicted_time_override_ms = 0;
     max_y_value = target_weight_value + 0.2f;
     last_data_point_time_ms = 0;
+    ms_per_point = DATA_POINT_INTERVAL_MS;
+    last_point_index = -1;
     time_mode = false;
     target_time_seconds = 0.0f;
+    eta_text[0] = '\0';
     
-    // Set chart update mode (point count is finalized after series creation)
-    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT); // Slide data left when full
+    // Points are placed by elapsed time and written in place: CIRCULAR mode makes LVGL
+    // invalidate only the segments around a changed point (SHIFT redraws the whole chart)
+    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_CIRCULAR);
     
     // Set Y-axis ranges (scale by 10 to handle decimals)
     lv_chart_set_axis_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, (int32_t)(max_y_value * 10)); // Weight axis
@@ -106,6 +114,7 @@ void GrindingScreenChart::create() {
     lv_span_set_text(separator_span, " / 18.0g");
     
     lv_spangroup_refresh(weight_spangroup);
+    shown_weight_text[0] = '\0';
     
     // MODIFIED: Ensure all child widgets pass click events to the parent screen
     for (uint32_t i = 0; i < lv_obj_get_child_cnt(screen); i++) {
@@ -149,6 +158,7 @@ void GrindingScreenChart::update_target_weight(float weight) {
             lv_span_set_text(current_span, current_text);
             lv_span_set_text(separator_span, target_text);
             lv_spangroup_refresh(weight_spangroup);
+        shown_weight_text[0] = '\0';
         }
     }
     
@@ -174,6 +184,7 @@ void GrindingScreenChart::update_target_weight_text(const char* text) {
         }
         lv_span_set_text(separator_span, formatted_text);
         lv_spangroup_refresh(weight_spangroup);
+        shown_weight_text[0] = '\0';
     }
 }
 
@@ -188,6 +199,7 @@ void GrindingScreenChart::update_target_time(float seconds) {
         snprintf(target_text, sizeof(target_text), "\nTime: %.1fs", seconds);
         lv_span_set_text(separator_span, target_text);
         lv_spangroup_refresh(weight_spangroup);
+        shown_weight_text[0] = '\0';
     }
 
     uint32_t predicted_ms = (seconds > 0.0f) ? static_cast<uint32_t>(seconds * 1000.0f) : 0;
@@ -195,46 +207,47 @@ void GrindingScreenChart::update_target_time(float seconds) {
 }
 
 void GrindingScreenChart::update_current_weight(float weight) {
-    char current_text[16], target_text[16];
+    char current_text[16];
     snprintf(current_text, sizeof(current_text), SYS_WEIGHT_DISPLAY_FORMAT, weight);
-    snprintf(target_text, sizeof(target_text), " / " SYS_WEIGHT_DISPLAY_FORMAT, target_weight_value);
-    
+    set_weight_spans(current_text);
+}
+
+void GrindingScreenChart::update_tare_display() {
+    set_weight_spans("TARE");
+}
+
+void GrindingScreenChart::set_weight_spans(const char* current_text) {
+    char separator_text[48];
+    const char* eta_prefix = eta_text[0] ? "  ~" : "";
+    if (time_mode) {
+        snprintf(separator_text, sizeof(separator_text), "\nTime: %.1fs%s%s", target_time_seconds, eta_prefix, eta_text);
+    } else {
+        snprintf(separator_text, sizeof(separator_text), " / " SYS_WEIGHT_DISPLAY_FORMAT "%s%s",
+                 target_weight_value, eta_prefix, eta_text);
+    }
+
+    // Called every UI frame while grinding; unchanged text would only invalidate the spangroup
+    char shown_text[sizeof(shown_weight_text)];
+    snprintf(shown_text, sizeof(shown_text), "%s|%s", current_text, separator_text);
+    if (strcmp(shown_text, shown_weight_text) == 0) {
+        return;
+    }
+
     // Update spans
     lv_span_t* current_span = lv_spangroup_get_child(weight_spangroup, 0);
     lv_span_t* separator_span = lv_spangroup_get_child(weight_spangroup, 1);
     
     if (current_span && separator_span) {
         lv_span_set_text(current_span, current_text);
-        if (time_mode) {
-            char time_text[48];
-            snprintf(time_text, sizeof(time_text), "\nTime: %.1fs", target_time_seconds);
-            lv_span_set_text(separator_span, time_text);
-        } else {
-            lv_span_set_text(separator_span, target_text);
-        }
+        lv_span_set_text(separator_span, separator_text);
         lv_spangroup_refresh(weight_spangroup);
+        memcpy(shown_weight_text, shown_text, sizeof(shown_weight_text));
     }
 }
 
-void GrindingScreenChart::update_tare_display() {
-    char target_text[16];
-    snprintf(target_text, sizeof(target_text), " / " SYS_WEIGHT_DISPLAY_FORMAT, target_weight_value);
-    
-    // Update spans for tare display
-    lv_span_t* current_span = lv_spangroup_get_child(weight_spangroup, 0);
-    lv_span_t* separator_span = lv_spangroup_get_child(weight_spangroup, 1);
-    
-    if (current_span && separator_span) {
-        lv_span_set_text(current_span, "TARE");
-        if (time_mode) {
-            char time_text[48];
-            snprintf(time_text, sizeof(time_text), "\nTime: %.1fs", target_time_seconds);
-            lv_span_set_text(separator_span, time_text);
-        } else {
-            lv_span_set_text(separator_span, target_text);
-        }
-        lv_spangroup_refresh(weight_spangroup);
-    }
+void GrindingScreenChart::update_eta(uint32_t remaining_ms, uint32_t band_ms, bool known) {
+    // Shown by the next set_weight_spans(), which skips unchanged text
+    format_eta_text(eta_text, sizeof(eta_text), remaining_ms, band_ms, known);
 }
 
 void GrindingScreenChart::update_progress(int percent) {
@@ -251,16 +264,38 @@ void GrindingScreenChart::add_chart_data_point(float current_weight, float flow_
     last_data_point_time_ms = current_time_ms;
     
     // Scale weight and flow rate by 10 to handle decimals in LVGL chart
-    lv_coord_t weight_value = (lv_coord_t)(current_weight * 10);
+    int32_t weight_value = (int32_t)(current_weight * 10);
     // Clamp flow rate to 0-2.5 g/s range then scale by 10
     float clamped_flow_rate = (flow_rate < 0.0f) ? 0.0f : ((flow_rate > 2.5f) ? 2.5f : flow_rate);
-    lv_coord_t flow_rate_value = (lv_coord_t)(clamped_flow_rate * 10);
+    int32_t flow_rate_value = (int32_t)(clamped_flow_rate * 10);
     
-    // Add data points to series (LVGL will handle sliding window due to SHIFT mode)
-    lv_chart_set_next_value(chart, weight_series, weight_value);
-    lv_chart_set_next_value(chart, flow_rate_series, flow_rate_value);
+    // Each point is one ms_per_point bucket of grind time and keeps the newest sample in it
+    int32_t index = (int32_t)((current_time_ms - chart_start_time_ms) / ms_per_point);
+    while (index >= (int32_t)lv_chart_get_point_count(chart)) {
+        compress_history();
+        index = (int32_t)((current_time_ms - chart_start_time_ms) / ms_per_point);
+    }
     
-    lv_chart_refresh(chart);
+    // Frames slower than a bucket skip points: interpolate them so the lines stay joined
+    if (last_point_index >= 0 && index > last_point_index + 1) {
+        int32_t* weights = lv_chart_get_y_array(chart, weight_series);
+        int32_t* flows = lv_chart_get_y_array(chart, flow_rate_series);
+        int32_t from_weight = weights[last_point_index];
+        int32_t from_flow = flows[last_point_index];
+        int32_t span = index - last_point_index;
+        for (int32_t i = last_point_index + 1; i < index; i++) {
+            int32_t step = i - last_point_index;
+            lv_chart_set_value_by_id(chart, weight_series, i, from_weight + (weight_value - from_weight) * step / span);
+            lv_chart_set_value_by_id(chart, flow_rate_series, i, from_flow + (flow_rate_value - from_flow) * step / span);
+        }
+    }
+    
+    // Invalidates only the segments next to the point
+    lv_chart_set_value_by_id(chart, weight_series, index, weight_value);
+    lv_chart_set_value_by_id(chart, flow_rate_series, index, flow_rate_value);
+    if (index > last_point_index) {
+        last_point_index = index;
+    }
 }
 
 void GrindingScreenChart::set_chart_time_prediction(uint32_t predicted_time_ms) {
@@ -276,14 +311,41 @@ void GrindingScreenChart::reset_chart_data() {
         return;
     }
 
+    clear_series();
+    update_chart_point_configuration();     // Restores ms_per_point after compress_history()
+}
+
+void GrindingScreenChart::clear_series() {
+    // Unwritten points are not drawn, so the lines grow from the left as the grind runs
     if (weight_series) {
-        lv_chart_set_all_values(chart, weight_series, 0);
+        lv_chart_set_all_values(chart, weight_series, LV_CHART_POINT_NONE);
     }
     if (flow_rate_series) {
-        lv_chart_set_all_values(chart, flow_rate_series, 0);
+        lv_chart_set_all_values(chart, flow_rate_series, LV_CHART_POINT_NONE);
     }
+    last_point_index = -1;
+}
 
-    predicted_chart_points = static_cast<uint16_t>(lv_chart_get_point_count(chart));
+// The grind outlasted the prediction: halve the resolution instead of scrolling, keeping
+// the newer sample of each pair. One full redraw, at most a few times per grind.
+void GrindingScreenChart::compress_history() {
+    uint32_t point_count = lv_chart_get_point_count(chart);
+    lv_chart_series_t* all_series[] = {weight_series, flow_rate_series};
+    for (lv_chart_series_t* series : all_series) {
+        int32_t* values = lv_chart_get_y_array(chart, series);
+        for (uint32_t i = 0; i < point_count; i++) {
+            uint32_t newer = 2 * i + 1;
+            if (i < point_count / 2) {
+                values[i] = newer < point_count && values[newer] != LV_CHART_POINT_NONE ? values[newer] : values[2 * i];
+            } else {
+                values[i] = LV_CHART_POINT_NONE;
+            }
+        }
+    }
+    ms_per_point *= 2;
+    last_point_index = last_point_index >= 0 ? last_point_index / 2 : -1;
+    predicted_grind_time_ms = point_count * ms_per_point;
+    lv_chart_refresh(chart);
 }
 
 void GrindingScreenChart::set_time_mode(bool enabled) {
@@ -324,15 +386,17 @@ void GrindingScreenChart::update_chart_point_configuration() {
 
     if (new_count != current_count) {
         lv_chart_set_point_count(chart, new_count);
-        if (weight_series) {
-            lv_chart_set_all_values(chart, weight_series, 0);
-        }
-        if (flow_rate_series) {
-            lv_chart_set_all_values(chart, flow_rate_series, 0);
-        }
+        clear_series();
         current_count = new_count;
     }
 
+    // Long grinds share a point between several control cycles (downsampled to pixel columns)
+    ms_per_point = (effective_time_ms + current_count - 1) / current_count;
+    if (ms_per_point < DATA_POINT_INTERVAL_MS) {
+        ms_per_point = DATA_POINT_INTERVAL_MS;
+    }
     predicted_chart_points = current_count;
-    predicted_grind_time_ms = static_cast<uint32_t>(current_count) * DATA_POINT_INTERVAL_MS;
+    predicted_grind_time_ms = static_cast<uint32_t>(current_count) * ms_per_point;
 }
+
+#endif // FEATURE_GRIND_CHART
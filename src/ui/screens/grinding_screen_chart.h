@@ -3,6 +3,8 @@
 #include "grinding_screen_base.h"
 #include "../../config/constants.h"
 
+#if FEATURE_GRIND_CHART
+
 class GrindingScreenChart : public IGrindingScreen {
 private:
     lv_obj_t* screen;
@@ -16,9 +18,9 @@ private:
     
     // Chart data management
     static const uint16_t MIN_CHART_POINTS = 32;
-    static const uint16_t MAX_CHART_POINTS = 1000;
+    static const uint16_t MAX_CHART_POINTS = HW_DISPLAY_WIDTH_PX;   // At most one point per pixel column
     static constexpr float REFERENCE_FLOW_RATE_GPS = 1.6f;  // Reference flow rate for time prediction
-    static const uint32_t DATA_POINT_INTERVAL_MS = SYS_TASK_GRIND_CONTROL_INTERVAL_MS; // Match grind control loop (50Hz)
+    static const uint32_t DATA_POINT_INTERVAL_MS = SYS_GRIND_REPORT_INTERVAL_MS; // Match the measurement log rows (50Hz)
     uint32_t chart_start_time_ms;
     uint32_t predicted_grind_time_ms;
     uint16_t predicted_chart_points;
@@ -26,9 +28,16 @@ private:
     float target_weight_value;
     float max_y_value;
     uint32_t last_data_point_time_ms;
+    uint32_t ms_per_point;          // Grind time covered by one chart point (downsampling bucket)
+    int32_t last_point_index;       // Newest point written since reset, -1 = none
     float target_time_seconds;
+    char eta_text[16];              // Time to target appended to the separator span, "" when not known
+    char shown_weight_text[72];     // Current and separator span text last set, '|'-joined
 
     void update_chart_point_configuration();
+    void clear_series();
+    void compress_history();
+    void set_weight_spans(const char* current_text);
 
 public:
     void create() override;
@@ -42,6 +51,7 @@ public:
     void update_tare_display() override;
     void update_progress(int percent) override;
     void add_chart_data_point(float current_weight, float flow_rate, uint32_t current_time_ms) override;
+    void update_eta(uint32_t remaining_ms, uint32_t band_ms, bool known) override;
     void set_chart_time_prediction(uint32_t predicted_time_ms);
     void reset_chart_data();
     void set_time_mode(bool enabled);
@@ -49,3 +59,28 @@ public:
     bool is_visible() const override { return visible; }
     lv_obj_t* get_screen() const override { return screen; }
 };
+
+#else
+// Built without FEATURE_GRIND_CHART: GrindingScreen keeps the arc layout, so this is never shown
+class GrindingScreenChart : public IGrindingScreen {
+public:
+    void create() override {}
+    void show() override {}
+    void hide() override {}
+    void update_profile_name(const char*) override {}
+    void update_target_weight(float) override {}
+    void update_target_weight_text(const char*) override {}
+    void update_target_time(float) {}
+    void update_current_weight(float) override {}
+    void update_tare_display() override {}
+    void update_progress(int) override {}
+    void add_chart_data_point(float, float, uint32_t) override {}
+    void update_eta(uint32_t, uint32_t, bool) override {}
+    void set_chart_time_prediction(uint32_t) {}
+    void reset_chart_data() {}
+    void set_time_mode(bool) {}
+
+    bool is_visible() const override { return false; }
+    lv_obj_t* get_screen() const override { return nullptr; }
+};
+#endif // FEATURE_GRIND_CHART
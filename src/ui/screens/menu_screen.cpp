@@ -2,8 +2,12 @@
 #include <Arduino.h>
 #include "../../config/constants.h"
 #include "../../logging/grind_logging.h"
+#include "../../system/config_store.h"
 #include "../../system/statistics_manager.h"
+#include "../../system/ui_snapshot.h"
 #include "../../hardware/hardware_manager.h"
+#include "../../controllers/profile_controller.h"
+#include "../../controllers/grind_channels.h"
 #include "grinding_screen.h"
 #include "../event_bridge_lvgl.h"
 #include "../../config/logging.h"
@@ -37,10 +41,16 @@ void MenuScreen::create(BluetoothManager* bluetooth, GrindController* grind_ctrl
     visible = false;
     scale_active = false;
     scale_page = nullptr;
-    scale_weight_label = nullptr;
     scale_tare_button = nullptr;
     scale_item = nullptr;
     prime_toggle = nullptr;
+    grinder_channel_radio_group = nullptr;
+    batch_doses_slider = nullptr;
+    batch_doses_label = nullptr;
+    perf_monitor_toggle = nullptr;
+    autotune_button = nullptr;
+    ui_benchmark_button = nullptr;
+    hot_path_benchmark_button = nullptr;
     lv_obj_add_flag(screen, LV_OBJ_FLAG_HIDDEN);
 
     // Create menu UI immediately at boot for instant access
@@ -133,6 +143,10 @@ void MenuScreen::create_menu_ui() {
     data_page = lv_menu_page_create(menu, "Logs & Data");
     create_data_page(data_page);
 
+    sessions_page = lv_menu_page_create(menu, "Sessions");
+    create_sessions_page(sessions_page);
+    lv_menu_set_load_page_event(menu, sessions_item, sessions_page);
+
     stats_page = lv_menu_page_create(menu, "Lifetime Stats");
     create_stats_page(stats_page);
 
@@ -143,14 +157,16 @@ void MenuScreen::create_menu_ui() {
     create_separator(main_page, "Tools");
     scale_item = create_menu_item(main_page, "Scale");
     cal_button = create_menu_item(main_page, "Calibrate");
+#if FEATURE_AUTOTUNE_UI
     autotune_button = create_menu_item(main_page, "Tune Pulses");
+#endif
     motor_test_button = create_menu_item(main_page, "Motor Test");
 
     lv_menu_set_load_page_event(menu, scale_item, scale_page);
 
     lv_obj_add_flag(scale_item, LV_OBJ_FLAG_CLICKABLE);
     lv_obj_add_flag(cal_button, LV_OBJ_FLAG_CLICKABLE);
-    lv_obj_add_flag(autotune_button, LV_OBJ_FLAG_CLICKABLE);
+    if (autotune_button) lv_obj_add_flag(autotune_button, LV_OBJ_FLAG_CLICKABLE);
     lv_obj_add_flag(motor_test_button, LV_OBJ_FLAG_CLICKABLE);
 
     using ET = EventBridgeLVGL::EventType;
@@ -212,6 +228,13 @@ void MenuScreen::create_menu_ui() {
         } else if (self->scale_active) {
             self->scale_active = false;
         }
+
+        // The session list is held only while its page shows
+        if (cur == self->sessions_page) {
+            self->session_browser.open();
+        } else if (self->session_browser.is_open()) {
+            self->session_browser.close();
+        }
     };
 
     lv_obj_add_event_cb(menu, changing_page_callback, LV_EVENT_VALUE_CHANGED, this);
@@ -322,6 +345,13 @@ static void grind_mode_callback(int selected_index, void* user_data) {
     EventBridgeLVGL::handle_event(EventBridgeLVGL::EventType::GRIND_MODE_RADIO_BUTTON, nullptr);
 }
 
+#if HW_GRINDER_CHANNELS > 1
+// Callback for grinder channel radio button selection
+static void grinder_channel_callback(int selected_index, void* user_data) {
+    EventBridgeLVGL::handle_event(EventBridgeLVGL::EventType::GRINDER_CHANNEL_RADIO_BUTTON, nullptr);
+}
+#endif
+
 void MenuScreen::create_grind_mode_page(lv_obj_t* parent) {
     lv_obj_set_layout(parent, LV_LAYOUT_FLEX);
     lv_obj_set_flex_flow(parent, LV_FLEX_FLOW_COLUMN);
@@ -331,6 +361,23 @@ void MenuScreen::create_grind_mode_page(lv_obj_t* parent) {
     lv_obj_set_scroll_dir(parent, LV_DIR_VER);
     lv_obj_set_scrollbar_mode(parent, LV_SCROLLBAR_MODE_AUTO);
 
+#if HW_GRINDER_CHANNELS > 1
+    // Grinder the screens, profiles' targets and calibration act on (GrindChannels)
+    create_separator(parent, "Grinder");
+    static_assert(HW_GRINDER_CHANNELS == 2, "Grinder radio labels cover two channels");
+    const char* grinder_channels[] = {"1", "2"};
+    grinder_channel_radio_group = create_radio_button_group(
+        parent,
+        grinder_channels,
+        HW_GRINDER_CHANNELS,
+        LV_FLEX_FLOW_ROW,
+        grind_channels.get_selected(),
+        135, 100,  // Width, Height
+        grinder_channel_callback,
+        this
+    );
+#endif
+
     // Mode Selection separator/label
     create_separator(parent, "Mode Selection");
 
@@ -365,6 +412,9 @@ void MenuScreen::create_grind_mode_page(lv_obj_t* parent) {
     create_toggle_row(parent, "Start", &auto_start_toggle);
     create_description_label(parent, "Exit the completion screen once that cup weight drops away.");
     create_toggle_row(parent, "Return", &auto_return_toggle);
+    create_description_label(parent, "Grind several doses from one start. Swap the cup and the next dose starts by itself.");
+    create_slider_row(parent, "Batch", &batch_doses_label, &batch_doses_slider, lv_color_hex(THEME_COLOR_ACCENT),
+                      1, USER_BATCH_MAX_DOSES);
 
     // Advanced priming option
     create_separator(parent, "Advanced");
@@ -389,6 +439,12 @@ void MenuScreen::create_grind_mode_page(lv_obj_t* parent) {
         lv_obj_add_event_cb(prime_toggle, EventBridgeLVGL::dispatch_event, LV_EVENT_VALUE_CHANGED,
                            reinterpret_cast<void*>(static_cast<intptr_t>(ET::GRIND_PRIME_TOGGLE)));
     }
+    if (batch_doses_slider) {
+        lv_obj_add_event_cb(batch_doses_slider, EventBridgeLVGL::dispatch_event, LV_EVENT_VALUE_CHANGED,
+                           reinterpret_cast<void*>(static_cast<intptr_t>(ET::BATCH_DOSES_SLIDER)));
+        lv_obj_add_event_cb(batch_doses_slider, EventBridgeLVGL::dispatch_event, LV_EVENT_RELEASED,
+                           reinterpret_cast<void*>(static_cast<intptr_t>(ET::BATCH_DOSES_SLIDER_RELEASED)));
+    }
 }
 
 void MenuScreen::create_scale_page(lv_obj_t* parent) {
@@ -405,11 +461,8 @@ void MenuScreen::create_scale_page(lv_obj_t* parent) {
     lv_obj_set_style_text_font(subtitle, &lv_font_montserrat_24, 0);
     lv_obj_set_style_text_color(subtitle, lv_color_hex(THEME_COLOR_TEXT_SECONDARY), 0);
 
-    scale_weight_label = lv_label_create(parent);
-    lv_label_set_text(scale_weight_label, "0.0g");
-    lv_obj_set_style_text_font(scale_weight_label, &lv_font_montserrat_56, 0);
-    lv_obj_set_style_text_color(scale_weight_label, lv_color_hex(THEME_COLOR_TEXT_PRIMARY), 0);
-    lv_obj_set_style_text_align(scale_weight_label, LV_TEXT_ALIGN_CENTER, 0);
+    scale_weight.create(parent, &lv_font_montserrat_56, lv_color_hex(THEME_COLOR_TEXT_PRIMARY));
+    scale_weight.set_text("0.0g");
 
     lv_obj_t* spacer = lv_obj_create(parent);
     lv_obj_set_size(spacer, LV_PCT(100), 0);
@@ -443,6 +496,7 @@ void MenuScreen::create_data_page(lv_obj_t* parent) {
     create_data_label(parent, "Sessions:", &sessions_label);
     create_data_label(parent, "Events:", &events_label);
     create_data_label(parent, "Metrics:", &measurements_label);
+    sessions_item = create_menu_item(parent, "Browse Sessions");
 
     // Reset separator
     create_separator(parent, "Reset");
@@ -467,6 +521,16 @@ void MenuScreen::create_data_page(lv_obj_t* parent) {
     }
 }
 
+void MenuScreen::create_sessions_page(lv_obj_t* parent) {
+    lv_obj_set_layout(parent, LV_LAYOUT_FLEX);
+    lv_obj_set_flex_flow(parent, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(parent, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_scroll_dir(parent, LV_DIR_VER);
+    lv_obj_set_scrollbar_mode(parent, LV_SCROLLBAR_MODE_AUTO);
+
+    session_browser.create(parent);
+}
+
 void MenuScreen::create_stats_page(lv_obj_t* parent) {
     lv_obj_set_layout(parent, LV_LAYOUT_FLEX);
     lv_obj_set_flex_flow(parent, LV_FLEX_FLOW_COLUMN);
@@ -486,6 +550,13 @@ void MenuScreen::create_stats_page(lv_obj_t* parent) {
     create_data_label(parent, "Mode (W/T):", &stat_mode_grinds_label, true);
     create_data_label(parent, "Avg Accuracy:", &stat_avg_accuracy_label, true);
     create_data_label(parent, "Total Pulses:", &stat_total_pulses_label, true);
+    create_data_label(parent, "Error p50/p95:", &stat_error_percentile_label, true);
+    create_data_label(parent, "Time p50/p95:", &stat_time_percentile_label, true);
+
+    create_separator(parent, "Recent Sessions");
+    create_data_label(parent, "Error (abs/bias):", &stat_recent_error_label, true);
+    create_data_label(parent, "Flow / Latency:", &stat_recent_flow_label, true);
+    create_data_label(parent, "Coast / Pulses:", &stat_recent_coast_label, true);
 
     refresh_stats_button = create_button(parent, "Refresh Stats");
     lv_obj_set_style_margin_top(refresh_stats_button, 10, 0);
@@ -554,12 +625,40 @@ void MenuScreen::create_diagnostics_page(lv_obj_t* parent) {
     // Motor latency
     create_data_label(parent, "Motor Latency:", &diag_motor_latency_label, true);
 
-    // Register event for the button (done here because widgets are created lazily)
+    // Rendering separator
+    create_separator(parent, "Rendering");
+    create_toggle_row(parent, "Perf monitor", &perf_monitor_toggle);
+    if (hardware_manager && hardware_manager->get_display()->is_perf_monitor_visible()) {
+        lv_obj_add_state(perf_monitor_toggle, LV_STATE_CHECKED);
+    }
+#if FEATURE_DEBUG_TOOLS
+    ui_benchmark_button = create_button(parent, "UI Benchmark");
+    lv_obj_set_style_margin_bottom(ui_benchmark_button, 10, 0);
+
+    // Weight filter query timings, logged (BLE debug / serial)
+    create_separator(parent, "Hot Paths");
+    hot_path_benchmark_button = create_button(parent, "Hot Path Benchmark");
+    lv_obj_set_style_margin_bottom(hot_path_benchmark_button, 10, 0);
+#endif
+
+    // Register events for the button and toggle (done here because widgets are created lazily)
     using ET = EventBridgeLVGL::EventType;
     if (diag_reset_button) {
         lv_obj_add_event_cb(diag_reset_button, EventBridgeLVGL::dispatch_event, LV_EVENT_CLICKED,
                            reinterpret_cast<void*>(static_cast<intptr_t>(ET::MENU_DIAGNOSTIC_RESET)));
     }
+    if (perf_monitor_toggle) {
+        lv_obj_add_event_cb(perf_monitor_toggle, EventBridgeLVGL::dispatch_event, LV_EVENT_VALUE_CHANGED,
+                           reinterpret_cast<void*>(static_cast<intptr_t>(ET::PERF_MONITOR_TOGGLE)));
+    }
+    if (ui_benchmark_button) {
+        lv_obj_add_event_cb(ui_benchmark_button, EventBridgeLVGL::dispatch_event, LV_EVENT_CLICKED,
+                           reinterpret_cast<void*>(static_cast<intptr_t>(ET::UI_BENCHMARK_START)));
+    }
+    if (hot_path_benchmark_button) {
+        lv_obj_add_event_cb(hot_path_benchmark_button, EventBridgeLVGL::dispatch_event, LV_EVENT_CLICKED,
+                           reinterpret_cast<void*>(static_cast<intptr_t>(ET::HOT_PATH_BENCHMARK_START)));
+    }
 }
 
 void MenuScreen::show() {
@@ -593,9 +692,10 @@ void MenuScreen::hide() {
 void MenuScreen::update_info(const WeightSensor* weight_sensor, unsigned long uptime_ms, size_t free_heap) {
     if (!visible) return;
 
-    set_label_text_float(instant_label, weight_sensor->get_instant_weight(), "g");
+    UISnapshot weights = ui_snapshot.read();
+    set_label_text_float(instant_label, weights.instant_weight, "g");
     set_label_text_int(samples_label, weight_sensor->get_sample_count());
-    set_label_text_int(raw_label, weight_sensor->get_raw_adc_instant());
+    set_label_text_int(raw_label, weights.instant_raw);
 
     // Update uptime - use compact format to avoid horizontal scrolling
     unsigned long seconds = uptime_ms / 1000;
@@ -726,19 +826,21 @@ void MenuScreen::refresh_statistics(bool show_overlay) {
         set_label_text_int(events_label, grind_logger.count_total_events_in_flash());
         set_label_text_int(measurements_label, grind_logger.count_total_measurements_in_flash());
 
-        // Lifetime statistics
-        set_label_text_int(stat_total_grinds_label, statistics_manager.get_total_grinds());
+        // The selected grinder's lifetime statistics, one consistent copy; static keeps the 800 bytes off the UI task stack
+        static StatisticsSnapshot stats;
+        channel_statistics(grind_channels.get_selected()).get_snapshot(&stats);
+        set_label_text_int(stat_total_grinds_label, stats.total_grinds);
 
         // Shot type breakdown (Single/Double/Custom)
         char shot_text[32];
         snprintf(shot_text, sizeof(shot_text), "%lu / %lu / %lu",
-                 statistics_manager.get_single_shots(),
-                 statistics_manager.get_double_shots(),
-                 statistics_manager.get_custom_shots());
+                 stats.single_shots,
+                 stats.double_shots,
+                 stats.custom_shots);
         lv_label_set_text(stat_shots_label, shot_text);
 
         // Motor runtime (convert seconds to hours:minutes)
-        uint64_t runtime_ms = statistics_manager.get_motor_runtime_ms();
+        uint64_t runtime_ms = stats.motor_runtime_ms();
         uint32_t runtime_sec = static_cast<uint32_t>(runtime_ms / 1000ULL);
         uint32_t hours = runtime_sec / 3600;
         uint32_t minutes = (runtime_sec % 3600) / 60;
@@ -758,34 +860,64 @@ void MenuScreen::refresh_statistics(bool show_overlay) {
 
         // Device uptime
         char uptime_text[32];
-        uint32_t uptime_hours = statistics_manager.get_device_uptime_hrs();
+        uint32_t uptime_hours = statistics_manager.get_device_uptime_hrs();     // Device-wide, kept by grinder 1's
         uint32_t uptime_minutes = statistics_manager.get_device_uptime_min_remainder();
         snprintf(uptime_text, sizeof(uptime_text), "%luh %lum", uptime_hours, uptime_minutes);
         lv_label_set_text(stat_device_uptime_label, uptime_text);
 
         // Total weight
         char weight_text[32];
-        snprintf(weight_text, sizeof(weight_text), "%.2f kg", statistics_manager.get_total_weight_kg());
+        snprintf(weight_text, sizeof(weight_text), "%.2f kg", stats.total_weight_kg);
         lv_label_set_text(stat_total_weight_label, weight_text);
 
         // Mode grinds (Weight/Time)
         char mode_text[32];
         snprintf(mode_text, sizeof(mode_text), "%lu / %lu",
-                 statistics_manager.get_weight_mode_grinds(),
-                 statistics_manager.get_time_mode_grinds());
+                 stats.weight_mode_grinds,
+                 stats.time_mode_grinds);
         lv_label_set_text(stat_mode_grinds_label, mode_text);
 
         // Average accuracy
         char accuracy_text[32];
-        snprintf(accuracy_text, sizeof(accuracy_text), "%.2fg", statistics_manager.get_avg_accuracy_g());
+        snprintf(accuracy_text, sizeof(accuracy_text), "%.2fg", stats.avg_accuracy_g());
         lv_label_set_text(stat_avg_accuracy_label, accuracy_text);
 
         // Total pulses (also show average)
         char pulses_text[32];
         snprintf(pulses_text, sizeof(pulses_text), "%lu (avg: %.1f)",
-                 statistics_manager.get_total_pulses(),
-                 statistics_manager.get_avg_pulses());
+                 stats.total_pulses,
+                 stats.avg_pulses());
         lv_label_set_text(stat_total_pulses_label, pulses_text);
+
+        // Lifetime percentiles, all profiles
+        char percentile_text[32] = "-";
+        const StreamingQuantiles& error = stats.percentiles(kStatisticsAllProfiles, StatisticsMetric::ABS_ERROR_G);
+        if (!error.empty()) {
+            snprintf(percentile_text, sizeof(percentile_text), "%.2f / %.2fg", error.p50(), error.p95());
+        }
+        lv_label_set_text(stat_error_percentile_label, percentile_text);
+        strcpy(percentile_text, "-");
+        const StreamingQuantiles& time = stats.percentiles(kStatisticsAllProfiles, StatisticsMetric::GRIND_TIME_S);
+        if (!time.empty()) {
+            snprintf(percentile_text, sizeof(percentile_text), "%.1f / %.1fs", time.p50(), time.p95());
+        }
+        lv_label_set_text(stat_time_percentile_label, percentile_text);
+
+        // The selected grinder's weight-mode trend from the session summary table, no session files opened
+        char error_text[32] = "-";
+        char flow_text[32] = "-";
+        char coast_text[32] = "-";
+        SessionTrend trend;
+        if (grind_logger.get_session_summaries().get_trend(SYS_LOG_SUMMARY_TREND_SESSIONS,
+                                                           static_cast<int>(GrindMode::WEIGHT), &trend, -1,
+                                                           grind_channels.get_selected())) {
+            snprintf(error_text, sizeof(error_text), "%.2fg / %+.2fg", trend.mean_abs_error_grams, trend.mean_error_grams);
+            snprintf(flow_text, sizeof(flow_text), "%.2fg/s / %.0fms", trend.mean_flow_g_per_s, trend.mean_latency_ms);
+            snprintf(coast_text, sizeof(coast_text), "%.2fg / %.1f", trend.mean_coast_grams, trend.mean_pulses);
+        }
+        lv_label_set_text(stat_recent_error_label, error_text);
+        lv_label_set_text(stat_recent_flow_label, flow_text);
+        lv_label_set_text(stat_recent_coast_label, coast_text);
     };
 
     // Used for when we reload the statistics after a data purge
@@ -802,15 +934,8 @@ void MenuScreen::refresh_statistics(bool show_overlay) {
 void MenuScreen::update_brightness_sliders() {
     if (!hardware_manager || !brightness_normal_slider || !brightness_screensaver_slider) return;
     
-    // Read from the dedicated "brightness" namespace using a local Preferences
-    // instance so we don't interfere with the global shared handle.
-    Preferences prefs;
-    prefs.begin("brightness", true); // read-only
-    
-    // Load brightness values from preferences (default to compile-time values)
-    float normal_brightness = prefs.getFloat("normal", USER_SCREEN_BRIGHTNESS_NORMAL);
-    float screensaver_brightness = prefs.getFloat("screensaver", USER_SCREEN_BRIGHTNESS_DIMMED);
-    prefs.end();
+    float normal_brightness = config_store.get_float(ConfigFloat::BRIGHTNESS_NORMAL);
+    float screensaver_brightness = config_store.get_float(ConfigFloat::BRIGHTNESS_SCREENSAVER);
     
     // Convert from 0.0-1.0 to 15-100 range
     int normal_percent = (int)(normal_brightness * 100);
@@ -885,13 +1010,7 @@ lv_obj_t* MenuScreen::create_separator(lv_obj_t* parent, const char* text) {
 void MenuScreen::update_bluetooth_startup_toggle() {
     if (!ble_startup_toggle) return;
 
-    // Read from the "bluetooth" namespace using a local Preferences instance
-    Preferences prefs;
-    prefs.begin("bluetooth", true); // read-only
-
-    // Load startup value from preferences (default to false)
-    bool startup_enabled = prefs.getBool("startup", true);
-    prefs.end();
+    bool startup_enabled = config_store.get_flag(ConfigFlag::BLE_STARTUP);
 
     // Update toggle state
     if (startup_enabled) {
@@ -904,13 +1023,7 @@ void MenuScreen::update_bluetooth_startup_toggle() {
 void MenuScreen::update_logging_toggle() {
     if (!logging_toggle) return;
 
-    // Read from the "logging" namespace using a local Preferences instance
-    Preferences prefs;
-    prefs.begin("logging", true); // read-only
-
-    // Load logging enabled value from preferences (default to false)
-    bool logging_enabled = prefs.getBool("enabled", false);
-    prefs.end();
+    bool logging_enabled = config_store.get_flag(ConfigFlag::LOGGING);
 
     // Update toggle state
     if (logging_enabled) {
@@ -1022,42 +1135,30 @@ lv_obj_t* MenuScreen::create_description_label(lv_obj_t* parent, const char* tex
 }
 
 void MenuScreen::reset_scale_display() {
-    if (scale_weight_label) {
-        lv_label_set_text(scale_weight_label, "0.0g");
-    }
+    scale_weight.set_text("0.0g");
 }
 
 void MenuScreen::update_scale_weight(float weight) {
-    if (!scale_weight_label) {
-        return;
-    }
     char buffer[24];
     snprintf(buffer, sizeof(buffer), SYS_WEIGHT_DISPLAY_FORMAT, weight);
-    lv_label_set_text(scale_weight_label, buffer);
+    scale_weight.set_text(buffer);
 }
 
 void MenuScreen::update_grind_mode_toggles() {
-    // Read swipe enabled from "swipe" namespace
-    Preferences swipe_prefs;
-    swipe_prefs.begin("swipe", true); // read-only
-    bool swipe_enabled = swipe_prefs.getBool("enabled", false);
-    swipe_prefs.end();
-
-    // Read current grind mode from main grinder preferences using hardware manager
-    int mode_index = 0; // Default to Weight (index 0)
-    bool prime_enabled = false;
-    if (hardware_manager) {
-        Preferences* main_prefs = hardware_manager->get_preferences();
-        if (main_prefs) {
-            int stored_mode = main_prefs->getInt("grind_mode", static_cast<int>(GrindMode::WEIGHT));
-            mode_index = (stored_mode == static_cast<int>(GrindMode::TIME)) ? 1 : 0;
-            prime_enabled = main_prefs->getBool(GrindController::PREF_KEY_PRIME_ENABLED, false);
-        }
-    }
+    bool swipe_enabled = config_store.get_flag(ConfigFlag::SWIPE);
+
+    // Grind mode and batch size come from ProfileController: its NVS writes are cached until idle
+    extern ProfileController profile_controller;
+    int mode_index = (profile_controller.get_grind_mode() == GrindMode::TIME) ? 1 : 0;
+    int batch_doses = profile_controller.get_batch_doses();
+    bool prime_enabled = config_store.get_flag(ConfigFlag::PRIME);
 
     if (grind_mode_radio_group) {
         radio_button_group_set_selection(grind_mode_radio_group, mode_index);
     }
+    if (grinder_channel_radio_group) {
+        radio_button_group_set_selection(grinder_channel_radio_group, grind_channels.get_selected());
+    }
 
     if (grind_mode_swipe_toggle) {
         if (swipe_enabled) {
@@ -1068,11 +1169,8 @@ void MenuScreen::update_grind_mode_toggles() {
     }
 
     // Auto actions toggles (defaults disabled)
-    Preferences auto_prefs;
-    auto_prefs.begin("autogrind", true);
-    bool auto_start_enabled = auto_prefs.getBool("auto_start", false);
-    bool auto_return_enabled = auto_prefs.getBool("auto_return", false);
-    auto_prefs.end();
+    bool auto_start_enabled = config_store.get_flag(ConfigFlag::AUTO_START);
+    bool auto_return_enabled = config_store.get_flag(ConfigFlag::AUTO_RETURN);
 
     if (auto_start_toggle) {
         if (auto_start_enabled) {
@@ -1097,4 +1195,22 @@ void MenuScreen::update_grind_mode_toggles() {
             lv_obj_clear_state(prime_toggle, LV_STATE_CHECKED);
         }
     }
+
+    if (batch_doses_slider) {
+        lv_slider_set_value(batch_doses_slider, batch_doses, LV_ANIM_OFF);
+    }
+    update_batch_doses_label(batch_doses);
+}
+
+void MenuScreen::update_batch_doses_label(int doses) {
+    if (!batch_doses_label) {
+        return;
+    }
+    char text[32];
+    if (doses > 1) {
+        snprintf(text, sizeof(text), "Batch: %d doses", doses);
+    } else {
+        snprintf(text, sizeof(text), "Batch: Off");
+    }
+    lv_label_set_text(batch_doses_label, text);
 }
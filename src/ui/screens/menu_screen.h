@@ -5,18 +5,21 @@
 #include "../../controllers/grind_controller.h"
 #include "../../system/diagnostics_controller.h"
 #include "../ui_helpers.h"
+#include "../components/session_browser.h"
+#include "../components/weight_digits.h"
 
 class GrindingScreen;  // Forward declaration
 
 class MenuScreen {
 private:
-    lv_obj_t* screen;
+    lv_obj_t* screen = nullptr;
     lv_obj_t* menu;
     lv_obj_t* info_page;
     lv_obj_t* bluetooth_page;
     lv_obj_t* display_page;
     lv_obj_t* grind_mode_page;
     lv_obj_t* data_page;
+    lv_obj_t* sessions_page;
     lv_obj_t* stats_page;
     lv_obj_t* diagnostics_page;
     lv_obj_t* scale_page;
@@ -42,6 +45,11 @@ private:
     lv_obj_t* stat_mode_grinds_label;
     lv_obj_t* stat_avg_accuracy_label;
     lv_obj_t* stat_total_pulses_label;
+    lv_obj_t* stat_error_percentile_label;  // Lifetime streaming p50/p95, all profiles
+    lv_obj_t* stat_time_percentile_label;
+    lv_obj_t* stat_recent_error_label;      // Session summary trend over SYS_LOG_SUMMARY_TREND_SESSIONS
+    lv_obj_t* stat_recent_flow_label;
+    lv_obj_t* stat_recent_coast_label;
     
     // Menu toggle elements
     lv_obj_t* ble_toggle;
@@ -55,20 +63,25 @@ private:
     lv_obj_t* brightness_screensaver_label;
     lv_obj_t* purge_button;
     lv_obj_t* reset_button;
+    lv_obj_t* sessions_item;
+    SessionBrowser session_browser;
     
     // Grind mode tab elements
     lv_obj_t* grind_mode_radio_group;
+    lv_obj_t* grinder_channel_radio_group;     // HW_GRINDER_CHANNELS > 1 only
     lv_obj_t* grind_mode_swipe_toggle;
     lv_obj_t* auto_start_toggle;
     lv_obj_t* auto_return_toggle;
     lv_obj_t* prime_toggle;
+    lv_obj_t* batch_doses_slider;
+    lv_obj_t* batch_doses_label;
     
     // Tools entries / scale page elements
     lv_obj_t* scale_item;
     lv_obj_t* cal_button;
     lv_obj_t* motor_test_button;
     lv_obj_t* autotune_button;
-    lv_obj_t* scale_weight_label;
+    WeightDigits scale_weight;
     lv_obj_t* scale_tare_button;
 
     // Diagnostics tab elements
@@ -80,6 +93,9 @@ private:
     lv_obj_t* diag_motor_latency_label;
     lv_obj_t* diag_info_label;
     lv_obj_t* diag_reset_button;
+    lv_obj_t* perf_monitor_toggle;
+    lv_obj_t* ui_benchmark_button;
+    lv_obj_t* hot_path_benchmark_button;
 
     // Common elements
     bool visible;
@@ -104,10 +120,12 @@ public:
     void update_bluetooth_startup_toggle();
     void update_logging_toggle();
     void update_grind_mode_toggles();
+    void update_batch_doses_label(int doses);
     void reset_scale_display();
     void update_scale_weight(float weight);
 
     bool is_visible() const { return visible; }
+    bool is_created() const { return screen != nullptr; }
     lv_obj_t* get_screen() const { return screen; }
     lv_obj_t* get_tabview() const { return menu; }
     lv_obj_t* get_diagnostics_page() const { return diagnostics_page; }
@@ -122,13 +140,18 @@ public:
     lv_obj_t* get_logging_toggle() const { return logging_toggle; }
     lv_obj_t* get_refresh_stats_button() const { return refresh_stats_button; }
     lv_obj_t* get_diag_reset_button() const { return diag_reset_button; }
+    lv_obj_t* get_perf_monitor_toggle() const { return perf_monitor_toggle; }
+    lv_obj_t* get_ui_benchmark_button() const { return ui_benchmark_button; }
     lv_obj_t* get_brightness_normal_slider() const { return brightness_normal_slider; }
     lv_obj_t* get_brightness_screensaver_slider() const { return brightness_screensaver_slider; }
     lv_obj_t* get_grind_mode_radio_group() const { return grind_mode_radio_group; }
+    lv_obj_t* get_grinder_channel_radio_group() const { return grinder_channel_radio_group; }
+    void set_grind_controller(GrindController* grind_ctrl) { grind_controller = grind_ctrl; }
     lv_obj_t* get_grind_mode_swipe_toggle() const { return grind_mode_swipe_toggle; }
     lv_obj_t* get_auto_start_toggle() const { return auto_start_toggle; }
     lv_obj_t* get_auto_return_toggle() const { return auto_return_toggle; }
     lv_obj_t* get_prime_toggle() const { return prime_toggle; }
+    lv_obj_t* get_batch_doses_slider() const { return batch_doses_slider; }
 
 private:
     void create_menu_ui();
@@ -138,6 +161,7 @@ private:
     void create_grind_mode_page(lv_obj_t* parent);
     void create_scale_page(lv_obj_t* parent);
     void create_data_page(lv_obj_t* parent);
+    void create_sessions_page(lv_obj_t* parent);
     void create_stats_page(lv_obj_t* parent);
     void create_diagnostics_page(lv_obj_t* parent);
     lv_obj_t* create_separator(lv_obj_t* parent, const char* text = nullptr);
@@ -67,6 +67,13 @@ void OTAScreen::hide() {
     visible = false;
 }
 
+void OTAScreen::destroy() {
+    if (!screen) return;
+    lv_obj_delete_async(screen);
+    screen = nullptr;
+    visible = false;
+}
+
 void OTAScreen::update_progress(int percent) {
     lv_arc_set_value(progress_arc, percent);
     
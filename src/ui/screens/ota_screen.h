@@ -4,7 +4,7 @@
 
 class OTAScreen {
 private:
-    lv_obj_t* screen;
+    lv_obj_t* screen = nullptr;
     lv_obj_t* title_label;
     lv_obj_t* status_label;
     lv_obj_t* percentage_label;
@@ -13,6 +13,7 @@ private:
 
 public:
     void create();
+    void destroy();                         // Deletes the widgets; create() rebuilds them
     void show();
     void hide();
     void update_progress(int percent);
@@ -24,5 +25,6 @@ public:
     void show_data_export_mode();
     
     bool is_visible() const { return visible; }
+    bool is_created() const { return screen != nullptr; }
     lv_obj_t* get_screen() const { return screen; }
 };
\ No newline at end of file
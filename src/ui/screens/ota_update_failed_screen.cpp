@@ -92,4 +92,11 @@ void OtaUpdateFailedScreen::show(const char* expected_build) {
 void OtaUpdateFailedScreen::hide() {
     lv_obj_add_flag(screen, LV_OBJ_FLAG_HIDDEN);
     visible = false;
-}
\ No newline at end of file
+}
+
+void OtaUpdateFailedScreen::destroy() {
+    if (!screen) return;
+    lv_obj_delete_async(screen);
+    screen = nullptr;
+    visible = false;
+}
@@ -7,7 +7,7 @@
 
 class OtaUpdateFailedScreen {
 private:
-    lv_obj_t* screen;
+    lv_obj_t* screen = nullptr;
     lv_obj_t* title_label;
     lv_obj_t* message_label;
     lv_obj_t* details_label;
@@ -17,10 +17,12 @@ private:
 
 public:
     void create();
+    void destroy();                         // Deletes the widgets; create() rebuilds them
     void show(const char* expected_build);
     void hide();
     
     bool is_visible() const { return visible; }
+    bool is_created() const { return screen != nullptr; }
     lv_obj_t* get_screen() const { return screen; }
     lv_obj_t* get_ok_button() const { return ok_button; }
 };
\ No newline at end of file
@@ -56,10 +56,9 @@ void ReadyScreen::create_profile_page(lv_obj_t* parent, int profile_index, const
     lv_obj_set_flex_align(parent, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
     lv_obj_set_style_pad_gap(parent, 0, 0);
 
-    lv_obj_t* name_label;
-    (void)create_profile_label(parent, &name_label, &weight_labels[profile_index]);
-    lv_label_set_text(name_label, profile_name);
-    lv_obj_add_flag(name_label, LV_OBJ_FLAG_CLICKABLE);
+    (void)create_profile_label(parent, &name_labels[profile_index], &weight_labels[profile_index]);
+    lv_label_set_text(name_labels[profile_index], profile_name);
+    lv_obj_add_flag(name_labels[profile_index], LV_OBJ_FLAG_CLICKABLE);
     
     char weight_text[16];
     snprintf(weight_text, sizeof(weight_text), SYS_WEIGHT_DISPLAY_FORMAT, weight);
@@ -101,6 +100,15 @@ void ReadyScreen::update_profile_values(const float values[3], GrindMode mode) {
     }
 }
 
+// Tab names follow the profile controller once a stored profile is recalled into a tab
+void ReadyScreen::update_profile_names(const char* const names[3]) {
+    for (int i = 0; i < 3; i++) {
+        if (name_labels[i] && names[i] && strcmp(lv_label_get_text(name_labels[i]), names[i]) != 0) {
+            lv_label_set_text(name_labels[i], names[i]);
+        }
+    }
+}
+
 void ReadyScreen::set_active_tab(int tab) {
     if (tab >= 0 && tab < 4) {
         lv_tabview_set_act(tabview, tab, LV_ANIM_OFF);
@@ -58,6 +58,22 @@ void set_label_text_float(lv_obj_t* label, float value, const char* unit) {
     lv_label_set_text(label, buf);
 }
 
+void format_eta_text(char* buffer, size_t buffer_size, uint32_t remaining_ms, uint32_t band_ms, bool known) {
+    if (!known) {
+        snprintf(buffer, buffer_size, "%s", "");
+        return;
+    }
+    // Rounded up, as a countdown reads: "1s" until the last second is over
+    uint32_t remaining_s = (remaining_ms + 999) / 1000;
+    uint32_t early_s = remaining_ms > band_ms ? (remaining_ms - band_ms + 999) / 1000 : 0;
+    uint32_t late_s = (remaining_ms + band_ms + 999) / 1000;
+    if (late_s - early_s > 1) {
+        snprintf(buffer, buffer_size, "%lu-%lus", (unsigned long)early_s, (unsigned long)late_s);
+    } else {
+        snprintf(buffer, buffer_size, "%lus", (unsigned long)remaining_s);
+    }
+}
+
 lv_obj_t* create_profile_label(lv_obj_t* parent, lv_obj_t** profile_label, lv_obj_t** weight_label){
     lv_obj_t* label_container = lv_obj_create(parent);
     lv_obj_set_size(label_container, LV_PCT(100), LV_SIZE_CONTENT);
@@ -14,6 +14,9 @@ void set_label_text_int(lv_obj_t* label, int32_t value, const char* unit = nullp
 
 void set_label_text_float(lv_obj_t* label, float value, const char* unit = nullptr);
 
+// Time to target in whole seconds: "12s", or "10-14s" when the band spans more than a second; "" when not known
+void format_eta_text(char* buffer, size_t buffer_size, uint32_t remaining_ms, uint32_t band_ms, bool known);
+
 lv_obj_t* create_profile_label(lv_obj_t* parent, lv_obj_t** profile_label, lv_obj_t** weight_label);
 
 lv_obj_t* create_dual_button_row(lv_obj_t* parent, lv_obj_t** left_button, lv_obj_t** right_button, 
@@ -1,11 +1,19 @@
 #include "ui_manager.h"
 #include <Arduino.h>
-#include <Preferences.h>
 #include <cmath>
 #include "../config/constants.h"
 #include "screens/calibration_screen.h"
 #include "../logging/grind_logging.h"
 #include "../controllers/grind_mode_traits.h"
+#include "../controllers/order_queue.h"
+#include "../controllers/grind_channels.h"
+#include "../system/config_store.h"
+#include "../system/hot_path_benchmark.h"
+#include "../system/noise_spectrum.h"
+#include "../system/perf_counters.h"
+#include "../system/telemetry.h"
+#include "../system/ui_snapshot.h"
+#include "../network/mqtt_manager.h"
 #include <utility>
 // Static instance pointer for grind event callbacks
 UIManager* UIManager::instance = nullptr;
@@ -33,10 +41,16 @@ void UIManager::init(HardwareManager* hw_mgr, StateMachine* sm,
     BlockingOperationOverlay::getInstance().init();
     jog_start_time = 0;
     jog_stage = 1;
+    warm_up_index = 0;
     
     // Initialize controller scaffolding (instances only)
     init_controllers();
 
+    // Screens first, then the controllers that fill them
+    state_machine->add_observer(this);
+    state_machine->add_observer(grinding_controller_.get());
+    state_machine->add_observer(ota_data_export_controller_.get());
+
     create_ui();
 
     // Register controller event hooks now that the UI elements exist
@@ -73,18 +87,11 @@ void UIManager::create_ui() {
 #endif
     lv_obj_add_style(lv_scr_act(), &style_screen, 0);
 
-    // Create all screens
+    // Boot builds only the Ready screen and the controls layered over the screens;
+    // everything else is built by ensure_screen() on first use or by warm_up_screens()
     ready_screen.create();
-    edit_screen.create();
-    grinding_screen.init(hardware_manager->get_preferences());
-    grinding_screen.create();
+    grinding_screen.init();
     grinding_screen.set_mode(current_mode);
-    menu_screen.create(bluetooth_manager, grind_controller, &grinding_screen, hardware_manager, diagnostics_controller_.get());
-    calibration_screen.create();
-    confirm_screen.create();
-    autotune_screen.create();
-    ota_screen.create();
-    ota_update_failed_screen.create();
     
     if (ready_controller_) {
         ready_controller_->refresh_profiles();
@@ -100,30 +107,168 @@ void UIManager::create_ui() {
     
     // Set up initial state
     ready_screen.hide();
-    edit_screen.hide();
-    grinding_screen.hide();
-    menu_screen.hide();
-    calibration_screen.hide();
-    confirm_screen.hide();
-    autotune_screen.hide();
-    ota_screen.hide();
-    ota_update_failed_screen.hide();
     
     // Initialize UI to current state (set by state_machine during boot)
-    switch_to_state(state_machine->get_current_state());
+    state_machine->reenter();
 }
 
-void UIManager::update() {
-    if (!initialized) return;
+void UIManager::ensure_screen(UIScreen screen) {
+    if (is_screen_created(screen)) return;
+
+    uint32_t start_ms = millis();
+    lv_obj_t* root = lv_scr_act();
+    uint32_t first_new = lv_obj_get_child_count(root);
+    switch (screen) {
+        case UIScreen::GRINDING:
+            grinding_screen.create();
+            grinding_screen.hide();
+            if (grinding_controller_) grinding_controller_->register_screen_events();
+            break;
+        case UIScreen::EDIT:
+            edit_screen.create();
+            edit_screen.hide();
+            if (edit_controller_) edit_controller_->register_events();
+            break;
+        case UIScreen::CONFIRM:
+            confirm_screen.create();
+            confirm_screen.hide();
+            if (confirm_controller_) confirm_controller_->register_events();
+            break;
+        case UIScreen::MENU:
+            menu_screen.create(bluetooth_manager, grind_controller, &grinding_screen, hardware_manager, diagnostics_controller_.get());
+            break;
+        case UIScreen::CALIBRATION:
+            calibration_screen.create();
+            calibration_screen.hide();
+            if (calibration_controller_) calibration_controller_->register_events();
+            break;
+        case UIScreen::AUTOTUNE:
+            autotune_screen.create();
+            autotune_screen.hide();
+            if (autotune_controller_) autotune_controller_->register_events();
+            break;
+        case UIScreen::OTA:
+            ota_screen.create();
+            ota_screen.hide();
+            break;
+        case UIScreen::OTA_UPDATE_FAILED:
+            ota_update_failed_screen.create();
+            ota_update_failed_screen.hide();
+            if (ota_data_export_controller_) ota_data_export_controller_->register_events();
+            break;
+        case UIScreen::COUNT:
+            return;
+    }
 
-    // Update diagnostics controller
-    if (diagnostics_controller_) {
-        diagnostics_controller_->update(hardware_manager, grind_controller, millis());
+    // Keep new screens beneath the boot-time controls (grind buttons, status indicators),
+    // in the stacking order they had when every screen was built before them
+    uint32_t new_children = lv_obj_get_child_count(root) - first_new;
+    for (uint32_t i = 0; i < new_children; i++) {
+        lv_obj_move_to_index(lv_obj_get_child(root, first_new + i), i);
+    }
+    LOG_UI_DEBUG("[%lums UI_SCREEN_BUILT] screen %d in %lums\n", millis(), (int)screen, millis() - start_ms);
+}
+
+bool UIManager::is_screen_created(UIScreen screen) const {
+    switch (screen) {
+        case UIScreen::GRINDING: return grinding_screen.is_created();
+        case UIScreen::EDIT: return edit_screen.is_created();
+        case UIScreen::CONFIRM: return confirm_screen.is_created();
+        case UIScreen::MENU: return menu_screen.is_created();
+        case UIScreen::CALIBRATION: return calibration_screen.is_created();
+        case UIScreen::AUTOTUNE: return autotune_screen.is_created();
+        case UIScreen::OTA: return ota_screen.is_created();
+        case UIScreen::OTA_UPDATE_FAILED: return ota_update_failed_screen.is_created();
+        case UIScreen::COUNT: break;
     }
+    return true;
+}
 
-    if (screen_timeout_controller_) {
-        screen_timeout_controller_->update();
+// Resident screens are built one per UI cycle once the Ready screen has reached the
+// panel, so boot shows it without waiting for them and a grind never waits for its screen
+void UIManager::warm_up_screens() {
+    static const UIScreen kResidentScreens[] = {UIScreen::GRINDING, UIScreen::EDIT, UIScreen::CONFIRM};
+    if (warm_up_index >= sizeof(kResidentScreens) / sizeof(kResidentScreens[0]) ||
+        perf_counters.get_count(PerfCount::DISPLAY_FRAMES) == 0) {
+        return;
     }
+    ensure_screen(kResidentScreens[warm_up_index++]);
+}
+
+void UIManager::hide_screens() {
+    ready_screen.hide();
+    if (edit_screen.is_created()) edit_screen.hide();
+    if (grinding_screen.is_created()) grinding_screen.hide();
+    if (menu_screen.is_created()) menu_screen.hide();
+    if (calibration_screen.is_created()) calibration_screen.hide();
+    if (confirm_screen.is_created()) confirm_screen.hide();
+    if (autotune_screen.is_created()) autotune_screen.hide();
+    if (ota_screen.is_created()) ota_screen.hide();
+    if (ota_update_failed_screen.is_created()) ota_update_failed_screen.hide();
+}
+
+// destroy() deletes asynchronously: the switch is often made from one of the screen's own buttons
+void UIManager::evict_rare_screens(UIScreen keep) {
+#if SYS_UI_EVICT_RARE_SCREENS
+    if (keep != UIScreen::CALIBRATION) calibration_screen.destroy();
+    if (keep != UIScreen::AUTOTUNE) autotune_screen.destroy();
+    if (keep != UIScreen::OTA) ota_screen.destroy();
+    if (keep != UIScreen::OTA_UPDATE_FAILED) ota_update_failed_screen.destroy();
+#else
+    (void)keep;
+#endif
+}
+
+UIScreen UIManager::screen_for_state(UIState state) {
+    switch (state) {
+        case UIState::EDIT: return UIScreen::EDIT;
+        case UIState::GRINDING:
+        case UIState::GRIND_COMPLETE:
+        case UIState::GRIND_TIMEOUT: return UIScreen::GRINDING;
+        case UIState::MENU: return UIScreen::MENU;
+        case UIState::CALIBRATION: return UIScreen::CALIBRATION;
+        case UIState::CONFIRM: return UIScreen::CONFIRM;
+        case UIState::AUTOTUNING: return UIScreen::AUTOTUNE;
+        case UIState::OTA_UPDATE: return UIScreen::OTA;
+        case UIState::OTA_UPDATE_FAILED: return UIScreen::OTA_UPDATE_FAILED;
+        default: return UIScreen::COUNT;
+    }
+}
+
+// Full rate where the picture moves or scrolls (grinding arc/chart, menu, edit lists);
+// screens that only change a value a few times per second refresh at 30 Hz
+uint32_t UIManager::frame_period_for_state(UIState state) {
+    switch (state) {
+        case UIState::READY:
+        case UIState::GRIND_COMPLETE:
+        case UIState::GRIND_TIMEOUT:
+        case UIState::CALIBRATION:
+        case UIState::AUTOTUNING:
+        case UIState::OTA_UPDATE:
+        case UIState::OTA_UPDATE_FAILED:
+            return SYS_UI_FRAME_PERIOD_CALM_MS;
+        default:
+            return SYS_TASK_UI_INTERVAL_MS;
+    }
+}
+
+void UIManager::run_diagnostics() {
+    if (!initialized || !diagnostics_controller_) return;
+    diagnostics_controller_->update(hardware_manager, grind_controller, millis());
+}
+
+void UIManager::run_screen_timeout() {
+    if (!initialized || !screen_timeout_controller_) return;
+    screen_timeout_controller_->update();
+}
+
+void UIManager::update() {
+    if (!initialized) return;
+
+    // Transitions posted by other tasks since the last cycle
+    state_machine->dispatch_events();
+
+    warm_up_screens();
 
     bool ota_cycle_consumed = false;
     if (ota_data_export_controller_) {
@@ -134,6 +279,24 @@ void UIManager::update() {
         return;
     }
     
+    // Stages switch screens themselves; the per-state updates below still run on them
+#if FEATURE_DEBUG_TOOLS
+    bool benchmark_running = ui_benchmark_controller_ && ui_benchmark_controller_->update();
+
+    // Holds this frame for the whole run; only with the grinder idle, so the timings are not its load
+    if (hot_path_benchmark.take_request()) {
+        if (grind_controller && grind_controller->is_active()) {
+            LOG_BLE("[%lums HOT_PATH_BENCHMARK] Not started: the grinder is active\n", millis());
+        } else {
+            hot_path_benchmark.run(hardware_manager->get_weight_sensor());
+        }
+    }
+#else
+    const bool benchmark_running = false;
+#endif
+    noise_spectrum.service(hardware_manager->get_weight_sensor(), &hardware_manager->get_grinder()->get_edge_timeline(),
+                           grind_controller && grind_controller->is_active());
+
     // Update based on current state
     UIState current = state_machine->get_current_state();
     
@@ -161,37 +324,54 @@ void UIManager::update() {
             break;
 
         case UIState::READY:
-            // Ready state - no special handling needed
+            if (ready_controller_) {
+                ready_controller_->update();
+            }
+            break;
+
+        case UIState::GRIND_COMPLETE:
+            if (grinding_controller_) {
+                grinding_controller_->update_grind_complete();
+            }
             break;
             
         default:
             break;
     }
 
-    update_auto_actions();
-
-    if (grinding_controller_) {
-        grinding_controller_->update(current);
+    if (!benchmark_running) {
+        update_auto_actions();
     }
+    update_background_grinders();
+    update_remote_commands();
+    update_orders();
 
     if (status_indicator_controller_) {
         status_indicator_controller_->update();
     }
 }
 
+bool UIManager::allows_idle_rendering() const {
+    return initialized && state_machine->is_state(UIState::READY);
+}
+
 void UIManager::switch_to_state(UIState new_state) {
+    if (state_machine->is_state(new_state)) {
+        state_machine->reenter();
+        return;
+    }
     state_machine->transition_to(new_state);
+}
 
-    // Hide all screens before showing the requested one
-    ready_screen.hide();
-    edit_screen.hide();
-    grinding_screen.hide();
-    menu_screen.hide();
-    calibration_screen.hide();
-    confirm_screen.hide();
-    autotune_screen.hide();
-    ota_screen.hide();
-    ota_update_failed_screen.hide();
+void UIManager::on_state_enter(UIState new_state, UIState previous) {
+    (void)previous;
+
+    // Hide all screens before showing the requested one, built now if this is its first use
+    UIScreen target = screen_for_state(new_state);
+    ensure_screen(target);
+    hide_screens();
+    evict_rare_screens(target);
+    hardware_manager->get_display()->set_frame_period(frame_period_for_state(new_state));
 
     switch (new_state) {
         case UIState::READY:
@@ -254,11 +434,6 @@ void UIManager::switch_to_state(UIState new_state) {
             }
             break;
     }
-
-    if (grinding_controller_) {
-        grinding_controller_->on_state_changed(new_state);
-        grinding_controller_->update_grind_button_icon();
-    }
 }
 
 void UIManager::show_confirmation(const char* title, const char* message, 
@@ -284,6 +459,9 @@ void UIManager::init_controllers() {
     ota_data_export_controller_ = std::make_unique<OtaDataExportController>(this);
     screen_timeout_controller_ = std::make_unique<ScreenTimeoutController>(this);
     jog_adjust_controller_ = std::make_unique<JogAdjustController>(this);
+#if FEATURE_DEBUG_TOOLS
+    ui_benchmark_controller_ = std::make_unique<UIBenchmarkController>(this);
+#endif
     diagnostics_controller_ = std::make_unique<DiagnosticsController>();
 
     // Initialize diagnostics controller
@@ -295,15 +473,15 @@ void UIManager::init_controllers() {
 void UIManager::register_controller_events() {
     EventBridgeLVGL::set_ui_manager(this);
     if (ready_controller_) ready_controller_->register_events();
-    if (edit_controller_) edit_controller_->register_events();
     if (grinding_controller_) grinding_controller_->register_events();
     if (menu_controller_) menu_controller_->register_events();
-    if (calibration_controller_) calibration_controller_->register_events();
-    if (autotune_controller_) autotune_controller_->register_events();
-    if (confirm_controller_) confirm_controller_->register_events();
-    if (ota_data_export_controller_) ota_data_export_controller_->register_events();
+    // Edit, calibration, autotune, confirm and OTA-failed controllers only bind their screen's
+    // widgets; ensure_screen() registers them each time it builds that screen
     if (screen_timeout_controller_) screen_timeout_controller_->register_events();
     if (jog_adjust_controller_) jog_adjust_controller_->register_events();
+#if FEATURE_DEBUG_TOOLS
+    if (ui_benchmark_controller_) ui_benchmark_controller_->register_events();
+#endif
 }
 
 void UIManager::set_background_active(bool active) {
@@ -328,25 +506,74 @@ void UIManager::set_background_active(bool active) {
 }
 
 void UIManager::refresh_auto_action_settings() {
-    Preferences prefs;
-    prefs.begin("autogrind", true);
-    auto_actions_.auto_start_enabled = prefs.getBool("auto_start", false);
-    auto_actions_.auto_return_enabled = prefs.getBool("auto_return", false);
-    prefs.end();
+    auto_actions_.auto_start_enabled = config_store.get_flag(ConfigFlag::AUTO_START);
+    auto_actions_.auto_return_enabled = config_store.get_flag(ConfigFlag::AUTO_RETURN);
 
     uint32_t now = millis();
     auto_actions_.last_auto_start_ms = now;
     auto_actions_.last_auto_return_ms = now;
 }
 
+bool UIManager::select_grinder_channel(uint8_t channel) {
+    GrindController* previous = grind_controller;
+    WeightSensor* previous_sensor = hardware_manager->get_weight_sensor();
+    if (!grind_channels.select(channel)) {
+        return false;
+    }
+    GrindController* selected = grind_channels.get_selected_controller();
+    if (selected == previous) {
+        return true;
+    }
+
+    // The grinder left behind keeps running its controller, unseen and unarmed
+    previous_sensor->set_cup_detection_armed(false);
+    previous->set_ui_event_callback(nullptr);
+    previous->set_diagnostics_controller(nullptr);
+
+    grind_controller = selected;
+    selected->set_diagnostics_controller(diagnostics_controller_.get());
+    selected->set_ui_event_callback(GrindingUIController::dispatch_event);
+    hardware_manager->set_grind_controller(selected);
+    profile_controller->set_grind_controller(selected);
+    menu_screen.set_grind_controller(selected);
+    background_finished_ms_[channel] = 0;
+
+    // A cup already standing on the new scale is not a placement
+    auto_actions_.cup_placement_sequence = hardware_manager->get_weight_sensor()->get_cup_placement_sequence();
+    refresh_auto_action_settings();
+
+    // The grinding screens take up the new grinder where it is; the Ready screen does so on its next update
+    if (grinding_controller_ &&
+        (state_machine->is_state(UIState::GRINDING) || state_machine->is_state(UIState::GRIND_COMPLETE) ||
+         state_machine->is_state(UIState::GRIND_TIMEOUT))) {
+        grinding_controller_->show_selected_grinder();
+    }
+    return true;
+}
+
 void UIManager::update_auto_actions() {
-    if ((!auto_actions_.auto_start_enabled && !auto_actions_.auto_return_enabled) ||
-        !hardware_manager || !state_machine) {
+    // A running batch arms both detectors: cup off returns, the next cup starts the next dose
+    const bool batch_active = grind_controller && grind_controller->is_batch_active();
+    const bool auto_start_enabled = auto_actions_.auto_start_enabled || batch_active;
+    const bool auto_return_enabled = auto_actions_.auto_return_enabled || batch_active;
+    auto* sensor = hardware_manager ? hardware_manager->get_weight_sensor() : nullptr;
+    if (!sensor || !state_machine) {
         return;
     }
 
-    auto* sensor = hardware_manager->get_weight_sensor();
-    if (!sensor || !sensor->data_ready() || sensor->is_tare_in_progress()) {
+    // The sampling task watches for the cup step only while a placement would start a grind
+    const bool grinder_active = (grind_controller && grind_controller->is_active());
+    const bool on_ready_tab = state_machine->is_state(UIState::READY) && current_tab < 3;
+    const bool cup_armed = auto_start_enabled && on_ready_tab && !grinder_active && grinding_controller_;
+    sensor->set_cup_detection_armed(cup_armed);
+    const uint32_t cup_sequence = sensor->get_cup_placement_sequence();
+    bool cup_placed = false;
+    if ((cup_sequence & 1u) == 0) {     // Odd: being published, seen next tick
+        cup_placed = cup_sequence != auto_actions_.cup_placement_sequence;
+        auto_actions_.cup_placement_sequence = cup_sequence;
+    }
+
+    if ((!auto_start_enabled && !auto_return_enabled) || !sensor->data_ready() || sensor->is_tare_in_progress()) {
         return;
     }
 
@@ -356,57 +583,29 @@ void UIManager::update_auto_actions() {
     }
 
     const uint32_t now = millis();
-    const bool grinder_active = (grind_controller && grind_controller->is_active());
-    const bool on_ready_tab = state_machine->is_state(UIState::READY) && current_tab < 3;
 
-    if (auto_actions_.auto_start_enabled && on_ready_tab && !grinder_active && grinding_controller_) {
-        auto* filter = sensor->get_raw_filter();
-
-        // Extended window = settling period + trigger window
-        constexpr uint32_t kExtendedWindow = USER_AUTO_GRIND_TRIGGER_SETTLING_MS + USER_AUTO_GRIND_TRIGGER_WINDOW_MS;
-
-        if (filter && filter->get_buffer_time_span_ms() >= kExtendedWindow) {
-            constexpr int kBaseSampleRequirement =
-                (HW_LOADCELL_SAMPLE_RATE_SPS * kExtendedWindow) / 1000;
-            constexpr int kMinSamplesForWindow = (kBaseSampleRequirement > 2) ? kBaseSampleRequirement : 2;
-
-            if (sensor->get_sample_count() >= kMinSamplesForWindow) {
-                // Check settled state first (cheap) to short-circuit expensive delta calculation
-                if (sensor->is_settled()) {
-                    float delta_g = 0.0f;
-                    int samples_used = 0;
-                    uint32_t span_ms = 0;
-
-                    // Weight is settled - now check delta over extended window
-                    if (sensor->get_weight_delta(kExtendedWindow, &delta_g, &samples_used, &span_ms) &&
-                        samples_used >= kMinSamplesForWindow &&
-                        span_ms <= kExtendedWindow &&
-                        delta_g >= USER_AUTO_GRIND_TRIGGER_DELTA_G) {
-
-                        const bool rearm_ready =
-                            (now - auto_actions_.last_auto_start_ms) >= USER_AUTO_GRIND_REARM_DELAY_MS;
-
-                        if (rearm_ready) {
-                            LOG_BLE("[AUTO ACTION] Trigger confirmed: %.1fg over %lums with settled weight - auto-starting grind\n",
-                                    static_cast<double>(delta_g),
-                                    static_cast<unsigned long>(span_ms));
-                            auto_actions_.last_auto_start_ms = now;
-                            grinding_controller_->handle_grind_button();
-                        }
-                    }
-                }
-            }
+    CupDetector::Placement placement;
+    if (cup_armed && cup_placed && sensor->get_cup_placement(&placement)) {
+        const bool rearm_ready =
+            (now - auto_actions_.last_auto_start_ms) >= USER_AUTO_GRIND_REARM_DELAY_MS;
+
+        if (rearm_ready) {
+            LOG_BLE("[AUTO ACTION] Cup placed: %.1fg step settled in %lums - auto-starting grind\n",
+                    static_cast<double>(placement.step_g),
+                    static_cast<unsigned long>((placement.settled_us - placement.step_us) / 1000));
+            auto_actions_.last_auto_start_ms = now;
+            grinding_controller_->handle_grind_button();
         }
     }
 
-    if (!auto_actions_.auto_return_enabled) {
+    if (!auto_return_enabled) {
         return;
     }
 
     if (state_machine->is_state(UIState::GRIND_COMPLETE) ||
         state_machine->is_state(UIState::GRIND_TIMEOUT)) {
         constexpr float kCompleteExitThresholdG = 2.0f;  // Treat scale as empty once weight drops below this point
-        const float live_weight = sensor->get_weight_low_latency();
+        const float live_weight = ui_snapshot.read().live_weight;
         const bool rearm_ready =
             (now - auto_actions_.last_auto_return_ms) >= USER_AUTO_GRIND_REARM_DELAY_MS;
 
@@ -419,3 +618,175 @@ void UIManager::update_auto_actions() {
         }
     }
 }
+
+void UIManager::update_background_grinders() {
+    constexpr float kCupRemovedThresholdG = 2.0f;       // As the auto return on the selected grinder
+    constexpr uint32_t kResultHoldMs = 60000;           // As the grinding screen's result timers
+
+    const uint8_t selected = grind_channels.get_selected();
+    const uint32_t now = millis();
+    for (uint8_t ch = 0; ch < grind_channels.count(); ch++) {
+        if (ch == selected) {
+            continue;
+        }
+        GrindController* controller = grind_channels.get_controller(ch);
+        const GrindPhase phase = static_cast<GrindPhase>(channel_telemetry(ch).get_phase());
+        if (phase == GrindPhase::INITIALIZING) {
+            controller->ui_acknowledge_phase_transition();  // No screen to wait for
+        }
+        if (phase != GrindPhase::COMPLETED && phase != GrindPhase::TIMEOUT) {
+            background_finished_ms_[ch] = 0;
+            continue;
+        }
+        if (background_finished_ms_[ch] == 0) {
+            background_finished_ms_[ch] = now | 1;          // 0 means no result
+            continue;
+        }
+        // The cup taken off returns it when auto return (or its batch) asks for that; otherwise the result times out
+        const bool cup_return = (auto_actions_.auto_return_enabled || controller->is_batch_active()) &&
+                                ui_snapshot.read(ch).live_weight <= kCupRemovedThresholdG &&
+                                now - background_finished_ms_[ch] >= USER_AUTO_GRIND_REARM_DELAY_MS;
+        if (cup_return || now - background_finished_ms_[ch] >= kResultHoldMs) {
+            LOG_BLE("[AUTO ACTION] Grinder %u (in the background) returning to idle\n", (unsigned)ch + 1);
+            controller->return_to_idle();
+            background_finished_ms_[ch] = 0;
+        }
+    }
+
+    // The Ready screen on a grinder that is running or holds a result (selected from the menu meanwhile)
+    if (grinding_controller_ && state_machine->is_state(UIState::READY) &&
+        static_cast<GrindPhase>(channel_telemetry(selected).get_phase()) != GrindPhase::IDLE) {
+        grinding_controller_->show_selected_grinder();
+    }
+}
+
+bool UIManager::is_ready_idle() const {
+    const bool grinder_active = grind_controller && grind_controller->is_active();
+#if FEATURE_DEBUG_TOOLS
+    const bool benchmark_running = ui_benchmark_controller_ && ui_benchmark_controller_->is_running();
+#else
+    const bool benchmark_running = false;
+#endif
+    const bool transfer_active = bluetooth_manager &&
+                                 (bluetooth_manager->is_updating() || bluetooth_manager->is_data_export_active());
+    return state_machine->is_state(UIState::READY) && !grinder_active && !benchmark_running && !transfer_active;
+}
+
+void UIManager::apply_remote_profile(int8_t profile, int16_t stored_profile, float weight_g, float time_s) {
+    if (!profile_controller) {
+        return;
+    }
+    if (stored_profile >= 0 && !profile_controller->recall_profile(profile, stored_profile)) {
+        LOG_BLE("[REMOTE] Stored profile %d not recalled\n", stored_profile);
+    }
+    if (weight_g > 0.0f) {
+        profile_controller->set_profile_weight(profile, profile_controller->clamp_weight(weight_g));
+    }
+    if (time_s > 0.0f) {
+        profile_controller->set_profile_time(profile, profile_controller->clamp_time(time_s));
+    }
+    ready_screen.set_active_tab(profile);
+    if (ready_controller_) {
+        ready_controller_->handle_tab_change(profile);
+    }
+}
+
+void UIManager::update_orders() {
+    if (!grind_controller || !state_machine || !profile_controller) {
+        return;
+    }
+
+    if (order_queue.has_active()) {
+        // Dose outcomes from the order grinder's phase, selected or not: each dose ends in IDLE, and what came before says how
+        GrindController* order_controller = grind_channels.get_controller(order_channel_);
+        const GrindPhase phase = static_cast<GrindPhase>(channel_telemetry(order_channel_).get_phase());
+        if (phase == GrindPhase::COMPLETED) {
+            order_dose_weight_ = order_controller->get_final_weight();  // Again after any extra pulse
+        }
+        if (phase != order_phase_) {
+            const GrindPhase previous = order_phase_;
+            order_phase_ = phase;
+            if (phase == GrindPhase::IDLE) {
+                if (previous == GrindPhase::COMPLETED) {
+                    order_queue.add_dose(order_dose_weight_);
+                    if (order_queue.get_active_completed() >= order_queue.get_active().count) {
+                        order_queue.finish(GrindOrderStatus::DONE);
+                        return;
+                    }
+                } else if (previous == GrindPhase::TIMEOUT) {
+                    order_queue.finish(GrindOrderStatus::FAILED);
+                    return;
+                } else {
+                    order_queue.finish(GrindOrderStatus::CANCELLED);    // Stopped mid-dose
+                    return;
+                }
+            }
+        }
+        // A remote cancel lets the running dose finish; a batch ended some other way ends the order
+        if (phase == GrindPhase::IDLE && (order_queue.is_cancel_requested() || !order_controller->is_batch_active())) {
+            order_controller->end_batch();
+            order_queue.finish(GrindOrderStatus::CANCELLED);
+        }
+        return;
+    }
+
+    // The next order waits for the Ready screen with nothing running, a manual batch included
+    if (order_queue.get_pending_count() == 0 || !is_ready_idle() || grind_controller->is_batch_active()) {
+        return;
+    }
+    GrindOrder order;
+    if (!order_queue.take_next(&order)) {
+        return;
+    }
+    int8_t profile = order.profile;
+    if (profile < 0) {
+        profile = current_tab < USER_PROFILE_COUNT ? current_tab : profile_controller->get_current_profile();
+    }
+    apply_remote_profile(profile, order.stored_profile, order.weight_g, 0.0f);
+    grind_controller->start_batch(order.count);
+    order_channel_ = grind_channels.get_selected();
+    order_phase_ = GrindPhase::IDLE;
+    order_dose_weight_ = 0.0f;
+    order_queue.start(current_mode == GrindMode::WEIGHT ? profile_controller->get_current_weight() : 0.0f);
+}
+
+void UIManager::update_remote_commands() {
+#if NETWORK_MQTT_ENABLED
+    if (diagnostics_controller_) {
+        DiagnosticCode diagnostic = diagnostics_controller_->get_highest_priority_warning();
+        mqtt_manager.set_diagnostic((uint8_t)diagnostic, diagnostics_controller_->get_diagnostic_message(diagnostic));
+    }
+
+    MqttCommand command;
+    while (mqtt_manager.take_command(&command)) {
+        if (command.type == MqttCommandType::STOP) {
+            if (grind_controller && grind_controller->is_active() && state_machine->is_state(UIState::GRINDING)) {
+                LOG_BLE("[MQTT] Stop command - stopping grind\n");
+                grind_controller->stop_grind();
+            }
+            continue;
+        }
+
+        // Profile changes and starts only where a touch could make them: the Ready screen, nothing running
+        if (!is_ready_idle()) {
+            LOG_BLE("[MQTT] %s command ignored: Ready screen not idle\n",
+                    command.type == MqttCommandType::START ? "Start" : "Profile");
+            continue;
+        }
+
+        if (command.profile >= 0) {
+            apply_remote_profile(command.profile, command.stored_profile, command.weight_g, command.time_s);
+            LOG_BLE("[MQTT] Profile %d selected\n", command.profile);
+        }
+
+        if (command.type == MqttCommandType::START && grinding_controller_) {
+            if (current_tab >= USER_PROFILE_COUNT) {
+                LOG_BLE("[MQTT] Start command ignored: no profile tab selected\n");
+                continue;
+            }
+            LOG_BLE("[MQTT] Start command - profile %d\n", current_tab);
+            grinding_controller_->handle_grind_button();
+        }
+    }
+#endif
+}
@@ -26,6 +26,7 @@
 #include "controllers/screen_timeout_controller.h"
 #include "controllers/menu_controller.h"
 #include "controllers/status_indicator_controller.h"
+#include "controllers/ui_benchmark_controller.h"
 #include "../system/state_machine.h"
 #include "../system/diagnostics_controller.h"
 #include "../controllers/profile_controller.h"
@@ -49,7 +50,20 @@
  * - Stage 4 (6s+): 20.3g/s (64ms intervals, 13x multiplier)
  */
 
-class UIManager {
+// Screens built on first use; the Ready screen is built at boot
+enum class UIScreen : uint8_t {
+    GRINDING,                       // Resident: warmed up after the first frame
+    EDIT,
+    CONFIRM,
+    MENU,                           // Resident once opened
+    CALIBRATION,                    // Rare: deleted on leaving (SYS_UI_EVICT_RARE_SCREENS)
+    AUTOTUNE,
+    OTA,
+    OTA_UPDATE_FAILED,
+    COUNT                           // No screen (Ready)
+};
+
+class UIManager : public StateObserver {
     friend class ReadyUIController;
     friend class EditUIController;
     friend class MenuUIController;
@@ -60,6 +74,7 @@ class UIManager {
     friend class OtaDataExportController;
     friend class ScreenTimeoutController;
     friend class JogAdjustController;
+    friend class UIBenchmarkController;
     
 private:
     HardwareManager* hardware_manager;
@@ -79,6 +94,7 @@ private:
     unsigned long jog_start_time;
     int jog_stage;
     int jog_direction;
+    uint8_t warm_up_index;                  // Next entry of the resident warm-up list
 
     // Static instance pointer for grind event callback
     static UIManager* instance;
@@ -95,6 +111,9 @@ private:
     std::unique_ptr<OtaDataExportController> ota_data_export_controller_;
     std::unique_ptr<ScreenTimeoutController> screen_timeout_controller_;
     std::unique_ptr<JogAdjustController> jog_adjust_controller_;
+#if FEATURE_DEBUG_TOOLS
+    std::unique_ptr<UIBenchmarkController> ui_benchmark_controller_;
+#endif
     std::unique_ptr<DiagnosticsController> diagnostics_controller_;
 
 public:
@@ -112,7 +131,17 @@ public:
     void init(HardwareManager* hw_mgr, StateMachine* sm, 
               ProfileController* pc, GrindController* gc, BluetoothManager* bluetooth);
     void update();
+    // Screens with nothing to poll between touches and queued events (the Ready screen)
+    bool allows_idle_rendering() const;
+    // Periodic jobs, dispatched by TaskManager on the UI task
+    void run_diagnostics();
+    void run_screen_timeout();
+    // A transition through the state machine; the same state shows its screen again
     void switch_to_state(UIState new_state);
+    // Screen for the new state: built if needed, the others hidden, the frame period set
+    void on_state_enter(UIState state, UIState previous) override;
+    // Build a screen (and bind its controller's widget events) if it does not exist yet
+    void ensure_screen(UIScreen screen);
     // Helper method to show confirmation dialog
     void show_confirmation(const char* title, const char* message,
                            const char* confirm_text, lv_color_t confirm_color,
@@ -127,16 +156,30 @@ public:
     ProfileController* get_profile_controller() { return profile_controller; }
     HardwareManager* get_hardware_manager() { return hardware_manager; }
     GrindController* get_grind_controller() { return grind_controller; }
+    // Point the screens, autotune and profiles at another grinder (GrindChannels), running or not
+    bool select_grinder_channel(uint8_t channel);
     OtaDataExportController* get_ota_data_export_controller() { return ota_data_export_controller_.get(); }
     void set_current_tab(int tab) { current_tab = tab; }
     
     void set_background_active(bool active);
     void refresh_auto_action_settings();
+    bool is_auto_start_enabled() const { return auto_actions_.auto_start_enabled; }
     
 
 private:
     void create_ui();
+    bool is_screen_created(UIScreen screen) const;
+    void warm_up_screens();
+    void hide_screens();
+    void evict_rare_screens(UIScreen keep);
+    static UIScreen screen_for_state(UIState state);
+    static uint32_t frame_period_for_state(UIState state);
     void update_auto_actions();
+    void update_background_grinders();  // Grinders not on screen: acknowledge their phases, return finished ones
+    void update_remote_commands();      // MQTT cmd/ topics, applied as the matching touch input; diagnostics out
+    void update_orders();               // Remote grind orders (OrderQueue): one at a time as a batch, outcomes reported
+    bool is_ready_idle() const;         // Ready screen, no grind, benchmark or BLE transfer: remote input may act
+    void apply_remote_profile(int8_t profile, int16_t stored_profile, float weight_g, float time_s);
     
     // State-specific update methods
 
@@ -148,5 +191,10 @@ private:
         bool auto_return_enabled = false;
         uint32_t last_auto_start_ms = 0;
         uint32_t last_auto_return_ms = 0;
+        uint32_t cup_placement_sequence = 0;    // WeightSensor placement last seen
     } auto_actions_;
+    uint32_t background_finished_ms_[HW_GRINDER_CHANNELS] = {};   // When an unselected grinder's result came up, 0: none
+    uint8_t order_channel_ = 0;                     // Grinder the active order runs on
+    GrindPhase order_phase_ = GrindPhase::IDLE;    // Controller phase last seen for the active order
+    float order_dose_weight_ = 0.0f;                // Final weight of the order's dose in COMPLETED
 };
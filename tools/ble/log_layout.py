@@ -0,0 +1,254 @@
+"""
+Session file struct layouts, as the firmware describes them
+
+The firmware serializes TimeSeriesSessionHeader, GrindSession, GrindEvent and
+GrindMeasurement field by field (src/logging/grind_log_layout.h) and sends the
+table on BLE_DATA_CMD_GET_LOG_LAYOUT. parse() turns that reply into a LogLayout;
+each StructLayout then decodes records with a numpy structured dtype built from
+the offsets and types (many records in one frombuffer call), or with a generated
+struct format where numpy is not installed.
+
+builtin() is the layout this tool was written against, for firmware that
+predates the command. for_schema() derives the layout of files written by an
+older schema: fields newer than the file are dropped (and read as absent), and
+LEGACY_FIELD_COUNTS restores arrays that have since shrunk.
+"""
+import struct
+from typing import Dict, List, NamedTuple, Optional, Sequence
+
+LAYOUT_MAGIC = 0x59414C47           # "GLAY"
+LAYOUT_VERSION = 1
+
+TYPE_SIZES = {'B': 1, 'H': 2, 'I': 4, 'i': 4, 'f': 4, 's': 1}
+TYPE_DTYPES = {'B': '<u1', 'H': '<u2', 'I': '<u4', 'i': '<i4', 'f': '<f4'}
+
+# (struct, field): (first schema with today's count, count before it)
+LEGACY_FIELD_COUNTS = {
+    ('GrindSession', 'result_status'): (7, 16),
+}
+
+
+class FieldLayout(NamedTuple):
+    name: str
+    offset: int
+    type: str                       # Python struct character, 's' for NUL padded strings
+    count: int
+    since_schema: int
+
+    @property
+    def size(self) -> int:
+        return TYPE_SIZES[self.type] * self.count
+
+
+class StructLayout:
+    """One packed little-endian struct; decodes records from bytes."""
+
+    def __init__(self, name: str, size: int, fields: Sequence[FieldLayout]):
+        self.name = name
+        self.size = size
+        self.fields = sorted(fields, key=lambda field: field.offset)
+        self._dtype = None
+        self._struct = None
+
+    @property
+    def field_names(self) -> List[str]:
+        return [field.name for field in self.fields]
+
+    def for_schema(self, schema_version: int) -> 'StructLayout':
+        """This struct as files of an older schema hold it."""
+        fields = []
+        for field in self.fields:
+            if field.since_schema > schema_version:
+                continue
+            legacy = LEGACY_FIELD_COUNTS.get((self.name, field.name))
+            if legacy and schema_version < legacy[0]:
+                field = field._replace(count=legacy[1])
+            fields.append(field)
+        if len(fields) == len(self.fields) and all(a == b for a, b in zip(fields, self.fields)):
+            return self
+        size = max((field.offset + field.size for field in fields), default=0)
+        return StructLayout(self.name, size if len(fields) < len(self.fields) else self.size, fields)
+
+    def dtype(self):
+        """numpy structured dtype with the firmware's offsets and record size."""
+        if self._dtype is None:
+            import numpy as np
+            formats = []
+            for field in self.fields:
+                if field.type == 's':
+                    formats.append(f'S{field.count}')
+                elif field.count > 1:
+                    formats.append((TYPE_DTYPES[field.type], (field.count,)))
+                else:
+                    formats.append(TYPE_DTYPES[field.type])
+            self._dtype = np.dtype({'names': self.field_names, 'formats': formats,
+                                    'offsets': [field.offset for field in self.fields], 'itemsize': self.size})
+        return self._dtype
+
+    def struct_format(self) -> str:
+        """Equivalent struct module format, with padding for any bytes no field covers."""
+        parts = ['<']
+        position = 0
+        for field in self.fields:
+            if field.offset > position:
+                parts.append(f'{field.offset - position}x')
+            parts.append(f'{field.count}{field.type}' if field.count > 1 or field.type == 's' else field.type)
+            position = field.offset + field.size
+        if self.size > position:
+            parts.append(f'{self.size - position}x')
+        return ''.join(parts)
+
+    def decode_columns(self, data: bytes, offset: int = 0, count: int = 1) -> Dict[str, list]:
+        """count consecutive records from offset, as one Python list per field."""
+        if count <= 0:
+            return {name: [] for name in self.field_names}
+        if offset + count * self.size > len(data):
+            raise ValueError(f"{self.name}: {count} records at offset {offset} run past {len(data)} bytes")
+        try:
+            import numpy as np
+        except ImportError:
+            return self._decode_columns_struct(data, offset, count)
+        records = np.frombuffer(data, dtype=self.dtype(), count=count, offset=offset)
+        return {name: records[name].tolist() for name in self.field_names}
+
+    def decode(self, data: bytes, offset: int = 0) -> Dict[str, object]:
+        """One record as a field dict."""
+        return {name: values[0] for name, values in self.decode_columns(data, offset, 1).items()}
+
+    def _decode_columns_struct(self, data: bytes, offset: int, count: int) -> Dict[str, list]:
+        if self._struct is None:
+            self._struct = struct.Struct(self.struct_format())
+        columns = {name: [] for name in self.field_names}
+        for index in range(count):
+            values = self._struct.unpack_from(data, offset + index * self.size)
+            position = 0
+            for field in self.fields:
+                width = 1 if field.type == 's' else field.count
+                columns[field.name].append(values[position] if width == 1 else list(values[position:position + width]))
+                position += width
+        return columns
+
+
+class LogLayout:
+    """Every described struct of one schema version."""
+
+    def __init__(self, schema_version: int, structs: Sequence[StructLayout], source: str):
+        self.schema_version = schema_version
+        self.structs = {layout.name: layout for layout in structs}
+        self.source = source            # 'grinder' or 'builtin'
+
+    def __getitem__(self, name: str) -> StructLayout:
+        return self.structs[name]
+
+    def for_schema(self, schema_version: int) -> 'LogLayout':
+        if schema_version == self.schema_version:
+            return self
+        return LogLayout(schema_version, [layout.for_schema(schema_version) for layout in self.structs.values()],
+                         self.source)
+
+    def describe(self) -> str:
+        sizes = ", ".join(f"{name} {layout.size} B" for name, layout in self.structs.items())
+        return f"schema {self.schema_version} ({self.source}): {sizes}"
+
+
+def parse(blob: bytes) -> LogLayout:
+    """A BLE_DATA_CMD_GET_LOG_LAYOUT reply; raises ValueError when it is not one."""
+    if len(blob) < 8:
+        raise ValueError(f"Log layout too short: {len(blob)} bytes")
+    magic, version, struct_count, schema_version = struct.unpack_from('<IBBH', blob, 0)
+    if magic != LAYOUT_MAGIC or version != LAYOUT_VERSION:
+        raise ValueError(f"Unexpected log layout (magic 0x{magic:08x}, version {version})")
+    position = 8
+
+    def name() -> str:
+        nonlocal position
+        length = blob[position]
+        text = blob[position + 1:position + 1 + length].decode('ascii')
+        position += 1 + length
+        return text
+
+    structs = []
+    try:
+        for _ in range(struct_count):
+            struct_name = name()
+            size, field_count = struct.unpack_from('<HB', blob, position)
+            position += 3
+            fields = []
+            for _ in range(field_count):
+                field_name = name()
+                offset, type_code, count, since = struct.unpack_from('<HBBB', blob, position)
+                position += 5
+                field_type = chr(type_code)
+                if field_type not in TYPE_SIZES:
+                    raise ValueError(f"{struct_name}.{field_name} has unknown type {field_type!r}")
+                fields.append(FieldLayout(field_name, offset, field_type, count, since))
+            structs.append(StructLayout(struct_name, size, fields))
+    except (IndexError, struct.error) as e:
+        raise ValueError(f"Log layout truncated at byte {position}") from e
+    return LogLayout(schema_version, structs, 'grinder')
+
+
+def _fields(*specs) -> List[FieldLayout]:
+    fields = []
+    offset = 0
+    for spec in specs:
+        field_name, field_type = spec[0], spec[1]
+        count = spec[2] if len(spec) > 2 else 1
+        since = spec[3] if len(spec) > 3 else 1
+        fields.append(FieldLayout(field_name, offset, field_type, count, since))
+        offset += TYPE_SIZES[field_type] * count
+    return fields
+
+
+_BUILTIN: Optional[LogLayout] = None
+
+
+def builtin() -> LogLayout:
+    """The schema 8 layout of src/logging/grind_logging.h, for firmware without the layout command."""
+    global _BUILTIN
+    if _BUILTIN is None:
+        _BUILTIN = LogLayout(8, [
+            StructLayout('TimeSeriesSessionHeader', 24, _fields(
+                ('session_id', 'I'), ('session_timestamp', 'I'), ('session_size', 'I'), ('checksum', 'I'),
+                ('event_count', 'H'), ('measurement_count', 'H'), ('schema_version', 'H'), ('flags', 'H'))),
+            StructLayout('GrindSession', 80, _fields(
+                ('session_id', 'I'), ('session_timestamp', 'I'), ('target_time_ms', 'I'), ('total_time_ms', 'I'),
+                ('total_motor_on_time_ms', 'I'), ('time_error_ms', 'i'), ('target_weight', 'f'), ('tolerance', 'f'),
+                ('final_weight', 'f'), ('error_grams', 'f'), ('start_weight', 'f'),
+                ('initial_motor_stop_offset', 'f'), ('latency_to_coast_ratio', 'f'), ('flow_rate_threshold', 'f'),
+                ('profile_id', 'B'), ('grind_mode', 'B'), ('max_pulse_attempts', 'B'), ('pulse_count', 'B'),
+                ('termination_reason', 'B'), ('flow_detection_window_steps', 'B'),
+                ('flow_prediction_window_steps', 'B'), ('grinder_channel', 'B'), ('result_status', 's', 12),
+                ('events_dropped', 'H', 1, 7), ('measurements_dropped', 'H', 1, 7))),
+            StructLayout('GrindEvent', 44, _fields(
+                ('timestamp_ms', 'I'), ('duration_ms', 'I'), ('grind_latency_ms', 'I'), ('settling_duration_ms', 'I'),
+                ('start_weight', 'f'), ('end_weight', 'f'), ('motor_stop_target_weight', 'f'),
+                ('pulse_duration_ms', 'f'), ('pulse_flow_rate', 'f'), ('event_sequence_id', 'H'), ('loop_count', 'H'),
+                ('phase_id', 'B'), ('pulse_attempt_number', 'B'), ('event_flags', 'B'), ('reserved', 'B'))),
+            StructLayout('GrindMeasurement', 28, _fields(
+                ('timestamp_ms', 'I'), ('weight_grams', 'f'), ('weight_delta', 'f'), ('flow_rate_g_per_s', 'f'),
+                ('motor_stop_target_weight', 'f'), ('sequence_id', 'H'), ('motor_is_on', 'B'), ('phase_id', 'B'),
+                ('sample_timestamp_us', 'I', 1, 3))),
+        ], 'builtin')
+    return _BUILTIN
+
+
+def differences(layout: LogLayout, reference: Optional[LogLayout] = None) -> List[str]:
+    """Where layout departs from the built-in one (or reference): one line per struct or field."""
+    reference = reference or builtin()
+    lines = []
+    for name, expected in reference.structs.items():
+        actual = layout.structs.get(name)
+        if actual is None:
+            lines.append(f"{name}: missing")
+            continue
+        if actual.size != expected.size:
+            lines.append(f"{name}: {actual.size} bytes, expected {expected.size}")
+        known = {field.name: field for field in expected.fields}
+        for field in actual.fields:
+            if field.name not in known:
+                lines.append(f"{name}.{field.name}: new at offset {field.offset}")
+            elif field[:4] != known[field.name][:4]:
+                lines.append(f"{name}.{field.name}: offset {field.offset} {field.type}x{field.count}, "
+                             f"expected {known[field.name].offset} {known[field.name].type}x{known[field.name].count}")
+    return lines
@@ -1,6 +1,8 @@
 #!/usr/bin/env python3
 """
-PlatformIO post-build script to archive firmware binaries.
+PlatformIO post-build script to archive firmware binaries and report the image
+size of each feature module (src/config/features.h, networking in
+src/config/network.h) from the linker map.
 """
 
 Import("env")
@@ -9,6 +11,24 @@ import json
 import hashlib
 from datetime import datetime
 import shutil
+import re
+
+# Feature modules: (name, build flag, default when unset, sources under src/)
+FEATURE_MODULES = [
+    ("debug tools", "FEATURE_DEBUG_TOOLS", 1,
+     ["system/hot_path_benchmark", "system/storage_benchmark", "ui/controllers/ui_benchmark_controller"]),
+    ("autotune UI", "FEATURE_AUTOTUNE_UI", 1,
+     ["ui/screens/autotune_screen", "ui/controllers/autotune_controller"]),
+    ("charts", "FEATURE_GRIND_CHART", 1, ["ui/screens/grinding_screen_chart"]),
+    ("networking", "NETWORK_MQTT_ENABLED", 0, ["network/"]),
+]
+
+# Input sections that take no room in the image
+UNLOADED_SECTIONS = (".bss", ".sbss", ".noinit", ".ext_ram.bss", "COMMON", ".debug", ".comment", ".xt.", ".xtensa.")
+
+MAP_SECTION = re.compile(r"^ (\S+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$")
+MAP_SECTION_NAME = re.compile(r"^ (\S+)$")
+MAP_SECTION_WRAPPED = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$")
 
 
 def get_build_number(env):
@@ -27,6 +47,76 @@ def get_build_number(env):
         print(f"Warning: Could not read BUILD_NUMBER: {e}")
     return 0
 
+def get_build_flag(env, name, default):
+    """Value of a -D flag of this environment, default when it is not set."""
+    for define in env.get("CPPDEFINES", []):
+        if isinstance(define, (tuple, list)) and define[0] == name:
+            return int(define[1]) if len(define) > 1 else 1
+        if isinstance(define, str) and define.split("=")[0] == name:
+            return int(define.split("=")[1]) if "=" in define else 1
+    return default
+
+
+def read_map_sizes(map_path):
+    """Loaded bytes per object file, from the input sections of a GNU ld map."""
+    sizes = {}
+    pending = None
+    in_memory_map = False
+    with open(map_path, "r", errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not in_memory_map:
+                in_memory_map = line.startswith("Linker script and memory map")
+                continue
+            match = MAP_SECTION.match(line)
+            wrapped = MAP_SECTION_WRAPPED.match(line) if pending else None
+            if match:
+                section, address, size, source = match.groups()
+            elif wrapped:
+                section = pending
+                address, size, source = wrapped.groups()
+            else:
+                # Long section names end their line; the address, size and file follow on the next
+                name = MAP_SECTION_NAME.match(line)
+                pending = name.group(1) if name else None
+                continue
+            pending = None
+            if int(address, 16) == 0 or section.startswith(UNLOADED_SECTIONS):
+                continue
+            source = source.replace("\\", "/")
+            sizes[source] = sizes.get(source, 0) + int(size, 16)
+    return sizes
+
+
+def report_module_sizes(env, build_dir):
+    """Print the flash each feature module takes, and what the rest of the image is."""
+    map_path = os.path.join(build_dir, "firmware.map")
+    if not os.path.exists(map_path):
+        print(f"⚠️  No linker map, module sizes skipped: {map_path}")
+        return
+
+    totals = {name: 0 for name, _, _, _ in FEATURE_MODULES}
+    firmware_other = 0
+    libraries = 0
+    for source, size in read_map_sizes(map_path).items():
+        if "/src/" not in source or ".a(" in source:
+            libraries += size
+            continue
+        module = next((name for name, _, _, sources in FEATURE_MODULES
+                       if any(f"/src/{part}" in source for part in sources)), None)
+        if module:
+            totals[module] += size
+        else:
+            firmware_other += size
+
+    print("📐 Image by module (linker map):")
+    for name, flag, default, _ in FEATURE_MODULES:
+        setting = f"{flag}={get_build_flag(env, flag, default)}"
+        print(f"   {name:<22} {setting:<24} {totals[name]/1024:8.1f} KB")
+    print(f"   {'rest of src/':<22} {'':<24} {firmware_other/1024:8.1f} KB")
+    print(f"   {'libraries, framework':<22} {'':<24} {libraries/1024:8.1f} KB")
+
+
 def archive_firmware(source, target, env):
     """Archive firmware binary with build number naming"""
     print("=== Post-Build Firmware Archive ===")
@@ -52,6 +142,7 @@ def archive_firmware(source, target, env):
     
     print(f"📦 Firmware: {firmware_size:,} bytes ({firmware_size/1024:.1f} KB)")
     print(f"🔢 Build number: {build_number}")
+    report_module_sizes(env, build_dir)
     
     # Create cache directory if needed
     os.makedirs(cache_dir, exist_ok=True)
@@ -70,6 +161,9 @@ def archive_firmware(source, target, env):
     
     print("==========================================")
 
+# Linker map for the module size report
+env.Append(LINKFLAGS=["-Wl,-Map," + os.path.join(env.subst("$BUILD_DIR"), "firmware.map")])
+
 # This function is called by PlatformIO
 env.AddPostAction("buildprog", archive_firmware)
 env.AddPostAction("upload", archive_firmware)
\ No newline at end of file
@@ -15,6 +15,10 @@ from pathlib import Path
 from typing import Optional, List, Dict, Any
 import shutil
 import stat
+import json
+import math
+import sqlite3
+import statistics
 
 # Color support for cross-platform output
 try:
@@ -255,6 +259,8 @@ class GrinderTool:
         
         if hasattr(args, 'db') and args.db:
             cmd.extend(["--db", args.db])
+        if getattr(args, 'incremental', False):
+            cmd.append("--incremental")
         if hasattr(args, 'device') and args.device:
             cmd.extend(["--device", args.device])
         
@@ -394,6 +400,62 @@ class GrinderTool:
 
         return await self.run_async_command(cmd)
 
+    async def cmd_trace(self, args: argparse.Namespace) -> int:
+        """Capture an event trace (or take a saved dump) and convert it to Chrome trace JSON."""
+        self.print_header("Event Trace")
+
+        out_path = Path(args.out)
+        if args.from_dump:
+            dump_path = Path(args.from_dump)
+        else:
+            if not self.check_venv():
+                return 1
+            dump_path = out_path.with_suffix('.txt')
+            cmd = [str(self.venv_python), str(self.ble_tool), "trace",
+                   "--duration-ms", str(args.duration_ms), "--save", str(dump_path)]
+            if hasattr(args, 'device') and args.device:
+                cmd.extend(["--device", args.device])
+            result = await self.run_async_command(cmd)
+            if result != 0:
+                return result
+
+        if not dump_path.exists():
+            self.print_error(f"Trace dump not found: {dump_path}")
+            return 1
+        try:
+            event_count = convert_trace_dump(dump_path, out_path)
+        except ValueError as e:
+            self.print_error(f"Invalid trace dump: {e}")
+            return 1
+        self.print_success(f"{event_count} events written to {out_path}")
+        self.print_info("Open it at https://ui.perfetto.dev or chrome://tracing")
+        return 0
+
+    def cmd_fit_model(self, args: argparse.Namespace) -> int:
+        """Fit the host simulation's mock grinder to exported sessions."""
+        self.print_header("Mock Grinder Model Fit")
+
+        db_file = self.db_path
+        if hasattr(args, 'db') and args.db:
+            db_file = Path(args.db) if Path(args.db).is_absolute() else self.script_dir / "database" / args.db
+        if not db_file.exists():
+            self.print_error(f"Database file not found: {db_file}")
+            self.print_info("Run: python3 grinder.py export")
+            return 1
+
+        model, notes, session_count = fit_grinder_model(db_file)
+        if not model:
+            self.print_error(f"No weight-mode session with a predictive phase in {db_file} ({session_count} sessions)")
+            return 1
+        for key, value in model.items():
+            self.safe_print(f"  {key:<18} {value:>10}  {notes[key]}")
+        self.print_info("Chute retention is not observable in the weight track; it keeps its default")
+        if 'idle_noise' not in model:
+            self.print_info("No ADC capture in the sessions: noise keeps its defaults (record with ADC capture on)")
+        model_arg = ",".join(f"{key}={value}" for key, value in model.items())
+        self.safe_print(f"\n  sim --model {model_arg}")
+        return 0
+
     def cmd_install(self, args: argparse.Namespace) -> int:
         """Manually install Python dependencies."""
         self.print_header("Installing Dependencies")
@@ -446,6 +508,245 @@ class GrinderTool:
             self.print_error(f"Failed to run release script: {e}")
             return 1
 
+# Mock grinder model fit (src/hardware/mock_hx711_driver.h MockGrinderModel, sim --model keys)
+MOCK_CAL_FACTOR = 7050.0            # |DEBUG_MOCK_CAL_FACTOR|, mock raw counts per gram
+UNIFORM_PEAK_PER_STD = math.sqrt(3) # The mock's noise is uniform in +-peak
+PHASE_PREDICTIVE = 5
+PHASE_PULSE_EXECUTE = 7
+EDGE_START, EDGE_STOP = 0, 1
+
+def _median(values):
+    return statistics.median(values) if values else None
+
+def _detrend(times, values):
+    """Residuals of a least-squares line through (times, values)."""
+    t_mean = sum(times) / len(times)
+    v_mean = sum(values) / len(values)
+    spread = sum((t - t_mean) ** 2 for t in times)
+    slope = sum((t - t_mean) * (v - v_mean) for t, v in zip(times, values)) / spread if spread else 0.0
+    return [v - v_mean - slope * (t - t_mean) for t, v in zip(times, values)]
+
+def _strongest_tone(values, sample_hz):
+    """(frequency Hz, amplitude) of the largest DFT bin above 2 Hz."""
+    n = len(values)
+    best = (0.0, 0.0)
+    for k in range(1, n // 2):
+        hz = k * sample_hz / n
+        if hz < 2.0:
+            continue
+        re = sum(v * math.cos(2 * math.pi * k * i / n) for i, v in enumerate(values))
+        im = sum(v * math.sin(2 * math.pi * k * i / n) for i, v in enumerate(values))
+        amplitude = 2.0 * math.hypot(re, im) / n
+        if amplitude > best[1]:
+            best = (hz, amplitude)
+    return best
+
+def fit_grinder_model(db_file: Path):
+    """Fit the mock grinder to the weight-mode sessions in an export database.
+
+    Returns (model, notes, session count): model maps sim --model keys to values, notes says what
+    each came from. Keys without evidence in the data are left out (the mock keeps
+    its debug.h default).
+    """
+    conn = sqlite3.connect(str(db_file))
+    sessions = [row[0] for row in conn.execute(
+        "SELECT session_id FROM grind_sessions WHERE grind_mode = 0 ORDER BY session_id")]
+    flows, start_delays, coasts, taus, clump_masses = [], [], [], [], []
+    clump_count, steady_s = 0, 0.0
+    idle_noise, vibration_noise, tones = [], [], []
+
+    for session_id in sessions:
+        rows = conn.execute(
+            "SELECT timestamp_ms, weight_grams, flow_rate_g_per_s, motor_is_on, phase_id "
+            "FROM grind_measurements WHERE session_id = ? ORDER BY timestamp_ms", (session_id,)).fetchall()
+        predictive = [r for r in rows if r[4] == PHASE_PREDICTIVE and r[3]]
+        if len(predictive) < 10:
+            continue
+
+        # Flow: the second half of the predictive run, past the spin-up
+        steady = predictive[len(predictive) // 2:]
+        flow = _median([r[2] for r in steady if r[2] > 0])
+        if not flow:
+            continue
+        flows.append(flow)
+
+        # Clumps: weight steps well above the steady median step
+        steps = [b[1] - a[1] for a, b in zip(steady, steady[1:])]
+        if len(steps) >= 5:
+            step_median = _median(steps)
+            mad = _median([abs(x - step_median) for x in steps]) or 1e-6
+            jumps = [x - step_median for x in steps if x - step_median > 6 * mad]
+            clump_count += len(jumps)
+            clump_masses.extend(jumps)
+            steady_s += (steady[-1][0] - steady[0][0]) / 1000.0
+
+        # Coast: mass after the predictive stop and how fast the flow fell off
+        stop_ms, stop_weight = predictive[-1][0], predictive[-1][1]
+        after = []
+        for r in rows:
+            if r[0] <= stop_ms:
+                continue
+            if r[3] or r[4] == PHASE_PULSE_EXECUTE:
+                break
+            after.append(r)
+        if len(after) >= 3:
+            mass = after[-1][1] - stop_weight
+            half = None
+            previous = (stop_ms, flow)
+            for r in after:
+                if r[2] < flow / 2:
+                    # Interpolated between the rows around the half-flow crossing
+                    share = (previous[1] - flow / 2) / (previous[1] - r[2]) if previous[1] > r[2] else 1.0
+                    half = previous[0] + share * (r[0] - previous[0]) - stop_ms
+                    break
+                previous = (r[0], r[2])
+            if mass > 0 and half is not None:
+                full_ms = mass / flow * 1000.0
+                tau = max(0.0, (full_ms - half) / (1.0 - math.log(2)))
+                coasts.append(max(0.0, full_ms - tau))
+                taus.append(tau)
+
+        latency = conn.execute(
+            "SELECT grind_latency_ms FROM grind_events WHERE session_id = ? AND phase_id = ? AND grind_latency_ms > 0",
+            (session_id, PHASE_PREDICTIVE)).fetchone()
+        if latency:
+            start_delays.append(latency[0])
+
+        # Noise from the raw ADC track, when the session was recorded with capture on
+        samples = conn.execute("SELECT timestamp_us, raw_value FROM adc_samples WHERE session_id = ? ORDER BY timestamp_us",
+                               (session_id,)).fetchall()
+        edges = dict(conn.execute("SELECT edge_type, MIN(timestamp_us) FROM motor_edges WHERE session_id = ? GROUP BY edge_type",
+                                  (session_id,)).fetchall())
+        if len(samples) < 100 or EDGE_START not in edges or EDGE_STOP not in edges:
+            continue
+        grams = (after[-1][1] if after else predictive[-1][1]) - rows[0][1]
+        counts_per_g = abs(_median([v for _, v in samples[-20:]]) - _median([v for _, v in samples[:20]])) / grams if grams > 1 else 0
+        if not counts_per_g:
+            continue
+        to_mock_raw = MOCK_CAL_FACTOR / counts_per_g
+        idle = [(t, v) for t, v in samples if t < edges[EDGE_START]]
+        flowing_from = edges[EDGE_START] + (latency[0] if latency else 0) * 1000 + 500000
+        flowing = [(t, v) for t, v in samples if flowing_from < t < edges[EDGE_STOP]]
+        if len(idle) >= 10:
+            residual = _detrend([t for t, _ in idle], [v for _, v in idle])
+            idle_noise.append(statistics.pstdev(residual) * to_mock_raw * UNIFORM_PEAK_PER_STD)
+        if len(flowing) >= 32:
+            flowing = flowing[:512]
+            residual = _detrend([t for t, _ in flowing], [v for _, v in flowing])
+            sample_hz = (len(flowing) - 1) * 1e6 / (flowing[-1][0] - flowing[0][0])
+            hz, amplitude = _strongest_tone(residual, sample_hz)
+            variance = statistics.pvariance(residual)
+            tone_variance = amplitude ** 2 / 2
+            # A tone counts when it carries a third of the variance; the rest is broadband
+            if tone_variance > variance / 3:
+                tones.append((hz, amplitude * to_mock_raw))
+                variance -= tone_variance
+            vibration_noise.append(math.sqrt(max(variance, 0.0)) * to_mock_raw * UNIFORM_PEAK_PER_STD)
+    conn.close()
+
+    model, notes = {}, {}
+    def put(key, values, note, digits=0):
+        value = _median(values)
+        if value is not None:
+            model[key] = round(value, digits) if digits else int(round(value))
+            notes[key] = f"{note} ({len(values)} sessions)"
+    put('flow', flows, "median steady predictive flow, g/s", 2)
+    put('start_delay', start_delays, "median predictive grind latency, ms")
+    put('coast', coasts, "full-flow hold after the predictive stop, ms")
+    put('coast_tau', taus, "exponential tail of the coast, ms")
+    put('idle_noise', idle_noise, "ADC capture before the motor start, mock raw peak", 1)
+    put('vibration_noise', vibration_noise, "ADC capture while grinding, mock raw peak at full load", 1)
+    if len(tones) * 2 >= len(vibration_noise) and tones:
+        put('vibration_hz', [hz for hz, _ in tones], "strongest ADC tone while grinding, Hz", 1)
+        put('vibration_tone', [a for _, a in tones], "its amplitude, mock raw", 1)
+    if steady_s > 0 and clump_masses:
+        model['clump_rate'] = round(clump_count / steady_s, 3)
+        notes['clump_rate'] = f"weight steps above 6 MAD per second of steady flow ({clump_count} steps)"
+        model['clump_mass'] = round(_median(clump_masses), 3)
+        notes['clump_mass'] = "median excess of those steps, g"
+    return model, notes, len(sessions)
+
+MOTOR_EDGE_NAMES = ['start', 'stop', 'pulse_start', 'pulse_end']  # MotorEdgeType order
+
+def convert_trace_dump(dump_path: Path, json_path: Path) -> int:
+    """Convert a firmware trace dump (TRACE_* lines) to Chrome trace event JSON.
+
+    Each core becomes a process and each trace id a thread in it, so every task
+    gets its own track. CCOUNT stamps are unwrapped per core and placed on the
+    esp_timer clock through that core's base; timestamps start at 0 µs.
+    Returns the number of trace events written.
+    """
+    mhz = 0
+    names: List[str] = []
+    cores: Dict[int, Dict[str, Any]] = {}
+    for line in dump_path.read_text().splitlines():
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == 'TRACE_BEGIN':
+            values = dict(f.split('=', 1) for f in fields[1:])
+            mhz = int(values['mhz'])
+            names = values['names'].split(',')
+        elif fields[0] == 'TRACE_CORE':
+            values = dict(f.split('=', 1) for f in fields[2:])
+            cores[int(fields[1])] = {
+                'base_cycles': int(values['base_cycles']),
+                'base_us': int(values['base_us']),
+                'dropped': int(values['dropped']),
+                'data': bytearray(),
+            }
+        elif fields[0] == 'TRACE_DATA' and len(fields) == 3:
+            cores[int(fields[1])]['data'] += bytes.fromhex(fields[2])
+    if mhz <= 0 or not names:
+        raise ValueError("missing TRACE_BEGIN header")
+
+    raw_events = []
+    for core, info in cores.items():
+        previous = info['base_cycles']
+        elapsed_cycles = 0
+        data = info['data']
+        for offset in range(0, len(data) - len(data) % 8, 8):
+            cycles = int.from_bytes(data[offset:offset + 4], 'little')
+            phase, trace_id = data[offset + 4], data[offset + 5]
+            arg = int.from_bytes(data[offset + 6:offset + 8], 'little')
+            # Signed 32-bit step: handles the CCOUNT wrap and slots stamped slightly out of order
+            elapsed_cycles += ((cycles - previous + 0x80000000) & 0xFFFFFFFF) - 0x80000000
+            previous = cycles
+            raw_events.append((info['base_us'] + elapsed_cycles / mhz, core, phase, trace_id, arg))
+    if not raw_events:
+        raise ValueError("no events in dump")
+
+    start_us = min(event[0] for event in raw_events)
+    trace_events: List[Dict[str, Any]] = []
+    threads = set()
+    for ts_us, core, phase, trace_id, arg in raw_events:
+        name = names[trace_id] if trace_id < len(names) else f"id_{trace_id}"
+        event: Dict[str, Any] = {'name': name, 'pid': core, 'tid': trace_id, 'ts': round(ts_us - start_us, 3)}
+        if phase == 0:
+            event['ph'] = 'B'
+        elif phase == 1:
+            event['ph'] = 'E'
+        else:
+            event['ph'] = 'i'
+            event['s'] = 't'
+            if name == 'motor_edge' and arg < len(MOTOR_EDGE_NAMES):
+                event['name'] = f"motor_{MOTOR_EDGE_NAMES[arg]}"
+        if arg:
+            event['args'] = {'arg': arg}
+        trace_events.append(event)
+        threads.add((core, trace_id, name))
+
+    for core, info in cores.items():
+        label = f"Core {core}" + (f" ({info['dropped']} dropped)" if info['dropped'] else "")
+        trace_events.append({'name': 'process_name', 'ph': 'M', 'pid': core, 'args': {'name': label}})
+    for core, trace_id, name in threads:
+        trace_events.append({'name': 'thread_name', 'ph': 'M', 'pid': core, 'tid': trace_id, 'args': {'name': name}})
+        trace_events.append({'name': 'thread_sort_index', 'ph': 'M', 'pid': core, 'tid': trace_id,
+                             'args': {'sort_index': trace_id}})
+
+    json_path.write_text(json.dumps({'traceEvents': trace_events, 'displayTimeUnit': 'ms'}))
+    return len(raw_events)
+
 def create_parser() -> argparse.ArgumentParser:
     """Create the argument parser with all subcommands."""
     parser = argparse.ArgumentParser(
@@ -458,9 +759,12 @@ def create_parser() -> argparse.ArgumentParser:
   python3 grinder.py analyze                   # Export data and show interactive report
   python3 grinder.py report                    # Just show report from existing data
   python3 grinder.py export --db session1.db  # Export to custom database
+  python3 grinder.py export --incremental     # Add only new sessions to the database
   python3 grinder.py upload --device MyGrinder # Upload to specific device
   python3 grinder.py connect                   # Connect to grinder device
   python3 grinder.py info                      # Get device system information
+  python3 grinder.py trace --duration-ms 5000  # Capture an event trace for Perfetto
+  python3 grinder.py fit-model                 # Mock grinder model for the host simulation
         """
     )
     
@@ -481,6 +785,8 @@ def create_parser() -> argparse.ArgumentParser:
     # Data & Analysis Commands
     export_parser = subparsers.add_parser('export', help='Export grind data from device to database')
     export_parser.add_argument('--db', help='Specify database file (default: grinder_data.db)')
+    export_parser.add_argument('--incremental', action='store_true',
+                               help='Only pull sessions newer than those already in the database')
     export_parser.add_argument('--device', default='GrindByWeight', help='Specify device name')
     
     analyze_parser = subparsers.add_parser('analyze', help='Export data and launch Streamlit report')
@@ -493,6 +799,9 @@ def create_parser() -> argparse.ArgumentParser:
     analyze_offline_parser = subparsers.add_parser('analyze-offline', help='Alias for report - uses existing database')
     analyze_offline_parser.add_argument('--db', help='Specify database file (default: grinder_data.db)')
     
+    fit_model_parser = subparsers.add_parser('fit-model', help='Fit the host simulation mock grinder to exported sessions')
+    fit_model_parser.add_argument('--db', help='Specify database file (default: grinder_data.db)')
+
     # BLE Commands
     scan_parser = subparsers.add_parser('scan', help='Scan for BLE devices')
     
@@ -509,6 +818,12 @@ def create_parser() -> argparse.ArgumentParser:
     diagnostics_parser.add_argument('--device', default='GrindByWeight', help='Specify device name')
     diagnostics_parser.add_argument('--save', metavar='FILE', help='Save report to file (default: print to console)')
 
+    trace_parser = subparsers.add_parser('trace', help='Capture an event trace and convert it for Perfetto / chrome://tracing')
+    trace_parser.add_argument('--device', default='GrindByWeight', help='Specify device name')
+    trace_parser.add_argument('--duration-ms', type=int, default=3000, help='Capture length (device caps it at 10000)')
+    trace_parser.add_argument('--out', default='trace.json', help='Chrome trace JSON file; the raw dump goes next to it as .txt')
+    trace_parser.add_argument('--from-dump', metavar='FILE', help='Convert a saved raw dump instead of capturing')
+
     # Development Commands
     install_parser = subparsers.add_parser('install', help='Manually install Python dependencies (auto-setup when needed)')
     monitor_parser = subparsers.add_parser('monitor', help='Monitor live debug output via BLE (alias for debug)')
@@ -541,6 +856,8 @@ async def main():
             return tool.cmd_report(args)
         elif args.command in ['analyze-offline', 'analyse-offline']:
             return tool.cmd_report(args)  # Same as report
+        elif args.command == 'fit-model':
+            return tool.cmd_fit_model(args)
         elif args.command == 'scan':
             return await tool.cmd_scan(args)
         elif args.command == 'connect':
@@ -551,6 +868,8 @@ async def main():
             return await tool.cmd_info(args)
         elif args.command == 'diagnostics':
             return await tool.cmd_diagnostics(args)
+        elif args.command == 'trace':
+            return await tool.cmd_trace(args)
         elif args.command == 'install':
             return tool.cmd_install(args)
         elif args.command == 'clean':
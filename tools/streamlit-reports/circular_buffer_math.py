@@ -1,15 +1,24 @@
 """
 Python implementation of the CircularBufferMath 95th percentile flow rate calculation
 that exactly matches the C++ implementation in circular_buffer_math.cpp
+
+calculate_95th_percentile_series() runs the firmware's own C++ through firmware_math
+when the host library is available, and this implementation otherwise.
 """
 
 import numpy as np
 import pandas as pd
 from typing import List, Tuple, Optional
 
+import firmware_math
+from firmware_math import FirmwareQuery
+
 # Hardware constants - must match hardware_config.h
 HW_LOADCELL_SAMPLE_RATE_SPS = 10  # Current sample rate setting
 
+# Gram frames without 'raw_value' are fed to the firmware math at this resolution (1 mg)
+FIRMWARE_COUNTS_PER_GRAM = 1000.0
+
 def calculate_95th_percentile_flow_rate(measurements_df: pd.DataFrame, 
                                        current_timestamp_ms: int, # This is the 'now' timestamp
                                        window_ms: int = 200,
@@ -126,19 +135,41 @@ def calculate_simple_flow_rate(measurements_df: pd.DataFrame,
     return raw_change * 1000.0 / time_change
 
 
+def firmware_raw_series(df: pd.DataFrame) -> Tuple[np.ndarray, float]:
+    """
+    Raw counts to feed the firmware math for a 'timestamp_ms' / 'weight_grams' frame,
+    and the grams per count to convert its results back.
+
+    A frame from adc_samples_to_measurements() keeps the captured 'raw_value', so the
+    firmware sees the counts it saw on the device. Other frames are quantized at
+    FIRMWARE_COUNTS_PER_GRAM.
+    """
+    if 'raw_value' in df.columns and df['raw_value'].nunique() >= 2:
+        grams_per_count, _ = np.polyfit(df['raw_value'].astype(float), df['weight_grams'].astype(float), 1)
+        return df['raw_value'].to_numpy(dtype=np.int32), float(grams_per_count)
+    counts = np.round(df['weight_grams'].to_numpy(dtype=float) * FIRMWARE_COUNTS_PER_GRAM)
+    return counts.astype(np.int32), 1.0 / FIRMWARE_COUNTS_PER_GRAM
+
+
 def calculate_95th_percentile_series(measurements_df: pd.DataFrame, 
                                    window_ms: int = 200,
                                    sub_window_ms: Optional[int] = None,
-                                   step_ms: Optional[int] = None) -> pd.DataFrame:
+                                   step_ms: Optional[int] = None,
+                                   use_firmware: bool = True) -> pd.DataFrame:
     """
     Calculate 95th percentile flow rate for each measurement timestamp.
     This simulates calling the C++ function at each measurement point.
     
+    The firmware's own CircularBufferMath (firmware_math) computes the series when its
+    library is available and the sub-window/step are the firmware's (300ms/100ms);
+    experiments with other values, or use_firmware=False, take the Python path.
+    
     Args:
         measurements_df: DataFrame with 'timestamp_ms' and 'weight_grams'
         window_ms: Time window in milliseconds
         sub_window_ms: Sub-window size in ms (if None, uses C++ fraction approach)
         step_ms: Step size in ms (if None, uses C++ fraction approach)
+        use_firmware: Allow the firmware math library
     
     Returns:
         DataFrame with original data plus 'flow_rate_95p_cpp' column
@@ -149,6 +180,15 @@ def calculate_95th_percentile_series(measurements_df: pd.DataFrame,
     # Sort once and copy to avoid modifying the original DataFrame
     df = measurements_df.sort_values('timestamp_ms').copy()
     
+    firmware_windows = (sub_window_ms in (None, firmware_math.PERCENTILE_SUB_WINDOW_MS) and
+                        step_ms in (None, firmware_math.PERCENTILE_STEP_MS))
+    if use_firmware and firmware_windows and firmware_math.available():
+        raw, grams_per_count = firmware_raw_series(df)
+        rates = firmware_math.replay(raw, df['timestamp_ms'].to_numpy(dtype=float),
+                                     [(FirmwareQuery.FLOW_RATE_95TH_RAW, window_ms)])
+        df['flow_rate_95p_cpp'] = rates[:, 0].astype(float) * grams_per_count
+        return df
+    
     # OPTIMIZED: Use pandas .apply() for a vectorized-like operation.
     # This is much faster than iterating row-by-row in Python.
     # The lambda function simulates calling the C++ function at each point in time.
@@ -164,4 +204,38 @@ def calculate_95th_percentile_series(measurements_df: pd.DataFrame,
         axis=1
     )
 
-    return df
\ No newline at end of file
+    return df
+
+
+def adc_samples_to_measurements(adc_df: pd.DataFrame, measurements_df: pd.DataFrame,
+                                min_phase_id: int = 5) -> pd.DataFrame:
+    """
+    Turn a session's raw ADC capture into the 'timestamp_ms' / 'weight_grams' frame the
+    functions above take, so they run on every ADC sample instead of the logged control loop.
+
+    The capture holds raw counts; grams come from a least-squares fit of raw_value against
+    the logged weight_grams at the same sample_timestamp_us. Only measurements from
+    min_phase_id on (PREDICTIVE, after the tare) take part, since the tare shifts the zero.
+    The logged weights are filtered, so the fit is a good scale but not an exact calibration.
+
+    Args:
+        adc_df: GrindDataLoader.get_adc_samples() for one session
+        measurements_df: GrindDataLoader.get_measurements() for the same session
+
+    Returns:
+        DataFrame with 'timestamp_ms' (float, from session start), 'weight_grams' and 'raw_value'
+    """
+    if adc_df.empty or measurements_df.empty:
+        return pd.DataFrame(columns=['timestamp_ms', 'weight_grams', 'raw_value'])
+
+    fitted = measurements_df[measurements_df['phase_id'] >= min_phase_id]
+    matched = fitted.merge(adc_df[['timestamp_us', 'raw_value']], left_on='sample_timestamp_us',
+                           right_on='timestamp_us', how='inner')
+    if len(matched) < 2 or matched['raw_value'].nunique() < 2:
+        return pd.DataFrame(columns=['timestamp_ms', 'weight_grams', 'raw_value'])
+    grams_per_count, offset_grams = np.polyfit(matched['raw_value'].astype(float), matched['weight_grams'], 1)
+
+    df = adc_df[['timestamp_us', 'raw_value']].copy()
+    df['timestamp_ms'] = df['timestamp_us'] / 1000.0
+    df['weight_grams'] = df['raw_value'] * grams_per_count + offset_grams
+    return df[['timestamp_ms', 'weight_grams', 'raw_value']]
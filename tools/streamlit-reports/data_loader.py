@@ -6,6 +6,7 @@ import pandas as pd
 import os
 from typing import Optional, Dict, Any
 from flow_analysis import calculate_flow_rate_stats, calculate_grind_efficiency
+import session_store
 
 class GrindDataLoader:
     def __init__(self, db_path: str = None):
@@ -51,6 +52,10 @@ class GrindDataLoader:
     def get_measurements(self, session_id: Optional[int] = None) -> pd.DataFrame:
         """Load grind measurements, optionally filtered by session"""
         with self._get_connection() as conn:
+            if session_id and self._has_cache(conn):
+                cached = session_store.load_measurements(conn, [session_id])
+                if not cached.empty:
+                    return cached
             query = "SELECT * FROM grind_measurements"
             params = ()
             if session_id:
@@ -59,6 +64,32 @@ class GrindDataLoader:
             measurements = pd.read_sql_query(query, conn, params=params)
             return measurements
     
+    def get_session_metrics(self) -> pd.DataFrame:
+        """Per-session metrics from the session cache (built on the first call for new sessions)"""
+        with self._get_connection() as conn:
+            session_store.refresh(conn)
+            return session_store.load_metrics(conn)
+    
+    def _has_cache(self, conn) -> bool:
+        return conn.execute("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'measurement_columns'").fetchone() is not None
+    
+    def get_adc_samples(self, session_id: int) -> pd.DataFrame:
+        """Raw ADC capture of a session (timestamp_us, raw_value); empty without capture"""
+        return self._get_capture_table("adc_samples", session_id)
+    
+    def get_motor_edges(self, session_id: int) -> pd.DataFrame:
+        """Motor edges recorded with the ADC capture (timestamp_us, edge_type, edge_name)"""
+        return self._get_capture_table("motor_edges", session_id)
+    
+    def _get_capture_table(self, table: str, session_id: int) -> pd.DataFrame:
+        with self._get_connection() as conn:
+            # Databases exported before schema 6 have no capture tables
+            exists = conn.execute("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?", (table,)).fetchone()
+            if not exists:
+                return pd.DataFrame()
+            return pd.read_sql_query(f"SELECT * FROM {table} WHERE session_id = ? ORDER BY timestamp_us", conn,
+                                     params=(session_id,))
+    
     def get_session_summary(self, session_id: int) -> Dict[str, Any]:
         """Get comprehensive session summary"""
         sessions = self.get_sessions()
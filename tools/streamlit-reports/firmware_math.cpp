@@ -0,0 +1,86 @@
+// Host build of the firmware's filter math for the Streamlit reports (loaded by
+// firmware_math.py through ctypes). Compiled with src/native/shim, like env:native,
+// so the queries run the same code and float arithmetic as the grind loop.
+#include "hardware/circular_buffer_math/circular_buffer_math.h"
+#include "native_sim.h"
+#include <math.h>
+#include <memory>
+#include <mutex>
+
+namespace {
+// Query ids, kept in step with FirmwareQuery in firmware_math.py
+enum FirmwareQuery : uint8_t {
+    QUERY_SMOOTHED_RAW = 0,          // get_smoothed_raw()
+    QUERY_STD_DEV_RAW = 1,           // get_standard_deviation_raw()
+    QUERY_FLOW_RATE_RAW = 2,         // get_raw_flow_rate()
+    QUERY_FLOW_RATE_95TH_RAW = 3,    // get_raw_flow_rate_95th_percentile()
+    QUERY_FLOW_FIT_RAW = 4,          // get_raw_flow_regression() slope, NAN without a fit
+    QUERY_MIN_RAW = 5,               // get_min_raw()
+    QUERY_MAX_RAW = 6,               // get_max_raw()
+    QUERY_COUNT
+};
+
+// The shim's virtual clock is process wide; replays take turns on it
+std::mutex replay_mutex;
+
+float evaluate(const CircularBufferMath& math, uint8_t query, uint32_t window_ms) {
+    switch (query) {
+        case QUERY_SMOOTHED_RAW: return (float)math.get_smoothed_raw(window_ms);
+        case QUERY_STD_DEV_RAW: return math.get_standard_deviation_raw(window_ms);
+        case QUERY_FLOW_RATE_RAW: return math.get_raw_flow_rate(window_ms);
+        case QUERY_FLOW_RATE_95TH_RAW: return math.get_raw_flow_rate_95th_percentile(window_ms);
+        case QUERY_FLOW_FIT_RAW: {
+            float rate;
+            return math.get_raw_flow_regression(window_ms, &rate) ? rate : NAN;
+        }
+        case QUERY_MIN_RAW: return (float)math.get_min_raw(window_ms);
+        case QUERY_MAX_RAW: return (float)math.get_max_raw(window_ms);
+        default: return NAN;
+    }
+}
+}
+
+extern "C" {
+
+int firmware_math_query_count() {
+    return QUERY_COUNT;
+}
+
+/**
+ * Feeds count samples (oldest first) into a fresh CircularBufferMath and, after
+ * each one, evaluates every (queries[q], windows_ms[q]) with "now" at that
+ * sample's capture time, as the grind loop does right after a sample lands.
+ * out receives count * query_count floats, row major per sample. Timestamps are
+ * the capture µs clock; only their differences matter (wrap safe, like the ring).
+ * Returns the samples replayed, -1 on bad arguments.
+ */
+int firmware_math_replay(const int32_t* raw, const uint32_t* timestamps_us, int count, uint32_t sample_rate_sps,
+                         const uint8_t* queries, const uint32_t* windows_ms, int query_count, float* out) {
+    if (count < 0 || query_count < 0 || (count > 0 && (!raw || !timestamps_us)) ||
+        (query_count > 0 && (!queries || !windows_ms || !out))) {
+        return -1;
+    }
+    for (int q = 0; q < query_count; q++) {
+        if (queries[q] >= QUERY_COUNT) {
+            return -1;
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(replay_mutex);
+    std::unique_ptr<CircularBufferMath> math(new CircularBufferMath());
+    math->set_sample_rate(sample_rate_sps);
+
+    // Each replay starts a second past the previous one, so the clock never runs back
+    int64_t base_us = native_sim::now_us() + 1000000;
+    for (int i = 0; i < count; i++) {
+        int64_t time_us = base_us + (uint32_t)(timestamps_us[i] - timestamps_us[0]);
+        native_sim::advance_to_us(time_us);
+        math->add_sample(raw[i], (uint32_t)time_us);
+        for (int q = 0; q < query_count; q++) {
+            out[(size_t)i * query_count + q] = evaluate(*math, queries[q], windows_ms[q]);
+        }
+    }
+    return count;
+}
+
+}
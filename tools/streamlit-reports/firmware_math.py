@@ -0,0 +1,211 @@
+"""
+Host build of the firmware's CircularBufferMath for offline analysis
+
+firmware_math.cpp is compiled together with src/hardware/circular_buffer_math and the
+src/native shim (the same sources env:native builds) into a shared library next to
+this file, and loaded through ctypes. Reports then replay a session through the
+exact C++ the grind loop runs, at native speed, instead of a Python re-implementation.
+
+The library is (re)built on first use when it is missing or older than its sources;
+this needs a C++17 compiler (CXX, default c++). Without one, available() is False and
+callers fall back to their Python versions.
+
+    python3 firmware_math.py [--db grinder_data.db] [--window 2500]
+
+replays every captured session in the database as a quick end-to-end check.
+"""
+import ctypes
+import os
+import subprocess
+import sys
+import time
+from enum import IntEnum
+from pathlib import Path
+from typing import Optional, Sequence, Tuple
+
+import numpy as np
+
+REPORTS_DIR = Path(__file__).resolve().parent
+REPO_ROOT = REPORTS_DIR.parent.parent
+BINDING_SOURCE = REPORTS_DIR / "firmware_math.cpp"
+
+# Firmware sources compiled into the library; new estimators are added here and in firmware_math.cpp
+FIRMWARE_SOURCES = [
+    "src/native/shim/native_shim.cpp",
+    "src/hardware/circular_buffer_math/circular_buffer_math.cpp",
+    "src/hardware/circular_buffer_math/compact_sample_history.cpp",
+    "src/hardware/circular_buffer_math/window_kernels.cpp",
+]
+HEADER_DIRS = ["src/hardware/circular_buffer_math", "src/config", "src/hardware", "src/native/shim"]
+
+# Fixed inside CircularBufferMath::get_raw_flow_rate_95th_percentile()
+PERCENTILE_SUB_WINDOW_MS = 300
+PERCENTILE_STEP_MS = 100
+
+
+class FirmwareQuery(IntEnum):
+    """Query ids of firmware_math.cpp"""
+    SMOOTHED_RAW = 0
+    STD_DEV_RAW = 1
+    FLOW_RATE_RAW = 2
+    FLOW_RATE_95TH_RAW = 3
+    FLOW_FIT_RAW = 4
+    MIN_RAW = 5
+    MAX_RAW = 6
+
+
+def _library_path() -> Path:
+    suffix = {"darwin": ".dylib", "win32": ".dll"}.get(sys.platform, ".so")
+    return REPORTS_DIR / f"libfirmware_math{suffix}"
+
+
+def _needs_build(library: Path) -> bool:
+    if not library.exists():
+        return True
+    built = library.stat().st_mtime
+    inputs = [BINDING_SOURCE] + [REPO_ROOT / source for source in FIRMWARE_SOURCES]
+    for directory in HEADER_DIRS:
+        inputs.extend((REPO_ROOT / directory).glob("*.h"))
+    return any(path.stat().st_mtime > built for path in inputs if path.exists())
+
+
+def build(verbose: bool = False) -> Path:
+    """Compile the shared library; raises CalledProcessError / OSError on failure"""
+    library = _library_path()
+    command = [os.environ.get("CXX", "c++"), "-std=gnu++17", "-O2", "-shared", "-fPIC",
+               "-I" + str(REPO_ROOT / "include"), "-I" + str(REPO_ROOT / "src"),
+               "-I" + str(REPO_ROOT / "src/native/shim"), "-DMOCK_BUILD",
+               str(BINDING_SOURCE)] + [str(REPO_ROOT / source) for source in FIRMWARE_SOURCES] + \
+              ["-o", str(library)]
+    if verbose:
+        print(" ".join(command))
+    subprocess.run(command, check=True, capture_output=not verbose)
+    return library
+
+
+_library = None
+_load_error: Optional[str] = None
+
+
+def _load():
+    global _library, _load_error
+    if _library is not None or _load_error is not None:
+        return _library
+    try:
+        library = _library_path()
+        if _needs_build(library):
+            build()
+        lib = ctypes.CDLL(str(library))
+        lib.firmware_math_query_count.restype = ctypes.c_int
+        lib.firmware_math_replay.restype = ctypes.c_int
+        lib.firmware_math_replay.argtypes = [
+            ctypes.POINTER(ctypes.c_int32), ctypes.POINTER(ctypes.c_uint32), ctypes.c_int, ctypes.c_uint32,
+            ctypes.POINTER(ctypes.c_uint8), ctypes.POINTER(ctypes.c_uint32), ctypes.c_int,
+            ctypes.POINTER(ctypes.c_float)]
+        if lib.firmware_math_query_count() != len(FirmwareQuery):
+            raise OSError("libfirmware_math query table does not match firmware_math.py")
+        _library = lib
+    except (OSError, subprocess.CalledProcessError) as error:
+        _load_error = str(error)
+    return _library
+
+
+def available() -> bool:
+    """True once the library is built and loaded"""
+    return _load() is not None
+
+
+def load_error() -> Optional[str]:
+    """Why the library could not be used, None if it loaded"""
+    _load()
+    return _load_error
+
+
+def estimate_sample_rate_sps(timestamps_ms: Sequence[float]) -> int:
+    """Sample rate as WeightSensor would have set it, from the median sample spacing"""
+    spacing = np.diff(np.asarray(timestamps_ms, dtype=float))
+    spacing = spacing[spacing > 0]
+    if spacing.size == 0:
+        return 10
+    return max(1, int(round(1000.0 / float(np.median(spacing)))))
+
+
+def replay(raw: Sequence[int], timestamps_ms: Sequence[float],
+           queries: Sequence[Tuple[FirmwareQuery, int]], sample_rate_sps: Optional[int] = None) -> np.ndarray:
+    """
+    Feed samples (oldest first) through CircularBufferMath and evaluate each
+    (query, window_ms) after every sample, with "now" at that sample's time.
+
+    Args:
+        raw: Raw ADC counts (int32)
+        timestamps_ms: Capture times in ms (µs resolution is kept)
+        queries: (FirmwareQuery, window_ms) pairs
+        sample_rate_sps: set_sample_rate() value; estimated from the timestamps if None
+
+    Returns:
+        float32 array of shape (samples, queries), in raw units (per second for flow rates)
+    """
+    lib = _load()
+    if lib is None:
+        raise RuntimeError(f"firmware math library unavailable: {_load_error}")
+
+    raw_values = np.ascontiguousarray(raw, dtype=np.int32)
+    timestamps = np.asarray(timestamps_ms, dtype=np.float64)
+    origin_ms = timestamps[0] if len(timestamps) else 0.0
+    timestamps_us = np.ascontiguousarray(np.round((timestamps - origin_ms) * 1000.0).astype(np.int64).astype(np.uint32))
+    if sample_rate_sps is None:
+        sample_rate_sps = estimate_sample_rate_sps(timestamps)
+    query_ids = np.ascontiguousarray([int(query) for query, _ in queries], dtype=np.uint8)
+    windows = np.ascontiguousarray([int(window_ms) for _, window_ms in queries], dtype=np.uint32)
+    out = np.zeros((len(raw_values), len(queries)), dtype=np.float32)
+
+    replayed = lib.firmware_math_replay(
+        raw_values.ctypes.data_as(ctypes.POINTER(ctypes.c_int32)),
+        timestamps_us.ctypes.data_as(ctypes.POINTER(ctypes.c_uint32)), len(raw_values), int(sample_rate_sps),
+        query_ids.ctypes.data_as(ctypes.POINTER(ctypes.c_uint8)),
+        windows.ctypes.data_as(ctypes.POINTER(ctypes.c_uint32)), len(queries),
+        out.ctypes.data_as(ctypes.POINTER(ctypes.c_float)))
+    if replayed != len(raw_values):
+        raise ValueError("firmware_math_replay rejected its arguments")
+    return out
+
+
+def main() -> int:
+    import argparse
+    from data_loader import GrindDataLoader
+
+    parser = argparse.ArgumentParser(description="Replay every captured session through the firmware math")
+    parser.add_argument("--db", help="Database file (default: GRIND_DB_PATH or ../database/grinder_data.db)")
+    parser.add_argument("--window", type=int, default=2500, help="95th percentile flow window in ms")
+    args = parser.parse_args()
+
+    try:
+        build(verbose=True)
+    except (OSError, subprocess.CalledProcessError) as error:
+        print(f"Build failed: {error}")
+        return 1
+    if not available():
+        print(f"Library failed to load: {load_error()}")
+        return 1
+
+    loader = GrindDataLoader(args.db)
+    sessions = loader.get_sessions()
+    replayed_sessions = 0
+    replayed_samples = 0
+    started = time.perf_counter()
+    for session_id in sessions['session_id']:
+        adc = loader.get_adc_samples(int(session_id))
+        if adc.empty:
+            continue
+        result = replay(adc['raw_value'].values, adc['timestamp_us'].values / 1000.0,
+                        [(FirmwareQuery.FLOW_RATE_95TH_RAW, args.window), (FirmwareQuery.FLOW_FIT_RAW, 200)])
+        replayed_sessions += 1
+        replayed_samples += len(result)
+    elapsed = time.perf_counter() - started
+    print(f"Replayed {replayed_samples} samples from {replayed_sessions} captured sessions "
+          f"({len(sessions)} total) in {elapsed:.2f}s")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
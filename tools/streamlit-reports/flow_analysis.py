@@ -5,6 +5,10 @@ import pandas as pd
 import numpy as np
 from typing import Dict, List, Optional, Tuple
 
+import firmware_math
+from firmware_math import FirmwareQuery
+from circular_buffer_math import firmware_raw_series
+
 def calculate_flow_rate_stats(measurements_df: pd.DataFrame) -> Dict:
     """Calculate comprehensive flow rate statistics for a session"""
     if measurements_df.empty:
@@ -153,6 +157,24 @@ def smooth_flow_rate(measurements_df: pd.DataFrame, window_ms: int = 500) -> pd.
     
     return df.drop(columns=['timestamp_dt'])
 
+def calculate_firmware_flow_series(measurements_df: pd.DataFrame, window_ms: int = 200) -> pd.DataFrame:
+    """
+    Flow rate as the firmware computes it, replayed through its CircularBufferMath
+    (firmware_math): 'flow_rate_fw' is get_raw_flow_rate() (newest minus oldest
+    sample) and 'flow_rate_fit_fw' the get_raw_flow_regression() slope, both in g/s.
+    Returns the frame unchanged when the firmware math library is unavailable.
+    """
+    if measurements_df.empty or not firmware_math.available():
+        return measurements_df
+
+    df = measurements_df.sort_values('timestamp_ms').copy()
+    raw, grams_per_count = firmware_raw_series(df)
+    rates = firmware_math.replay(raw, df['timestamp_ms'].to_numpy(dtype=float),
+                                 [(FirmwareQuery.FLOW_RATE_RAW, window_ms), (FirmwareQuery.FLOW_FIT_RAW, window_ms)])
+    df['flow_rate_fw'] = rates[:, 0].astype(float) * grams_per_count
+    df['flow_rate_fit_fw'] = rates[:, 1].astype(float) * grams_per_count
+    return df
+
 def compare_sessions(sessions_list: List[Dict], measurements_dict: Dict[int, pd.DataFrame]) -> Dict:
     """Compare multiple grinding sessions for performance analysis"""
     if not sessions_list:
@@ -7,6 +7,8 @@ import os
 from scipy import signal
 import numpy as np
 from circular_buffer_math import calculate_95th_percentile_series
+from flow_analysis import calculate_firmware_flow_series
+import session_store
 
 # --- Configuration ---
 DB_FILE = os.environ.get('GRIND_DB_PATH', '../database/grinder_data.db')
@@ -18,6 +20,9 @@ TERMINATION_REASON_MAP = {
     1: "TIMEOUT",
     2: "OVERSHOOT",
     3: "MAX_PULSES",
+    4: "FLOW_STALLED",
+    5: "FLOW_UNSTABLE",
+    6: "PROJECTED_TIMEOUT",
     255: "UNKNOWN"
 }
 
@@ -28,41 +33,46 @@ if not os.path.exists(DB_FILE):
     st.stop()
 
 # --- Optimized Data Loading ---
+# Loaders take the database token (mtime, size) so their caches follow a new export
+# without a restart. Measurements come from the per-session column cache (session_store),
+# which is brought up to date once per database change and only for sessions it lacks.
 @st.cache_data
-def load_session_list():
-    """Loads just the list of sessions from the database."""
+def refresh_session_cache(db_token):
+    """Builds cached metrics and measurement columns for sessions that lack them."""
     with sqlite3.connect(DB_FILE) as conn:
-        sessions = pd.read_sql_query("SELECT * FROM grind_sessions", conn)
-    return sessions
+        return session_store.refresh(conn)
 
 @st.cache_data
-def load_session_details(session_id):
-    """Loads all event and measurement data for a single session ID."""
+def load_session_list(db_token):
+    """Loads the list of sessions with their cached metrics."""
     with sqlite3.connect(DB_FILE) as conn:
-        # Added ORDER BY to ensure data is always time-sorted on load
-        events = pd.read_sql_query(f"SELECT * FROM grind_events WHERE session_id = {session_id} ORDER BY timestamp_ms", conn)
-        measurements = pd.read_sql_query(f"SELECT * FROM grind_measurements WHERE session_id = {session_id} ORDER BY timestamp_ms", conn)
+        sessions = pd.read_sql_query("SELECT * FROM grind_sessions", conn)
+        metrics = session_store.load_metrics(conn)
+    return pd.merge(sessions, metrics, on='session_id', how='left')
+
+def load_events(conn, session_ids):
+    placeholders = ",".join("?" * len(session_ids))
+    events = pd.read_sql_query(f"SELECT * FROM grind_events WHERE session_id IN ({placeholders}) "
+                               "ORDER BY session_id, timestamp_ms", conn, params=[int(i) for i in session_ids])
     # Clean up whitespace in phase names to prevent filtering issues
     if 'phase_name' in events.columns:
         events['phase_name'] = events['phase_name'].str.strip()
-    if 'phase_name' in measurements.columns:
-        measurements['phase_name'] = measurements['phase_name'].str.strip()
-    return events, measurements
+    return events
 
 @st.cache_data
-def load_all_details():
-    """Loads all event and measurement data for multi-session analysis."""
+def load_session_details(session_id, db_token):
+    """Loads all event and measurement data for a single session ID, time-sorted."""
     with sqlite3.connect(DB_FILE) as conn:
-        # Added ORDER BY for consistency
-        events = pd.read_sql_query("SELECT * FROM grind_events ORDER BY session_id, timestamp_ms", conn)
-        measurements = pd.read_sql_query("SELECT * FROM grind_measurements ORDER BY session_id, timestamp_ms", conn)
-    # Clean up whitespace in phase names to prevent filtering issues
-    if 'phase_name' in events.columns:
-        events['phase_name'] = events['phase_name'].str.strip()
-    if 'phase_name' in measurements.columns:
-        measurements['phase_name'] = measurements['phase_name'].str.strip()
+        events = load_events(conn, [session_id])
+        measurements = session_store.load_measurements(conn, [session_id])
     return events, measurements
 
+@st.cache_data
+def load_selected_events(session_ids, db_token):
+    """Loads event data of the selected sessions; per-session figures come from the metrics cache."""
+    with sqlite3.connect(DB_FILE) as conn:
+        return load_events(conn, session_ids)
+
 # --- Helper Functions ---
 def get_phase_specific_hover_data(events_df):
     """
@@ -301,8 +311,12 @@ def plot_event_markers(fig, events_df, measurements_df, weight_col_name='weight_
 st.set_page_config(page_title="Grind Performance Analysis", layout="wide")
 st.title("Grind-By-Weight Performance Analysis")
 
-# Load only the session list initially for speed
-sessions_df = load_session_list()
+# Load only the session list initially for speed; new sessions are cached first
+db_token = session_store.database_token(DB_FILE)
+with st.spinner("Caching new sessions..."):
+    refresh_session_cache(db_token)
+db_token = session_store.database_token(DB_FILE)
+sessions_df = load_session_list(db_token)
 
 # --- Sidebar ---
 st.sidebar.header("Analysis Mode")
@@ -388,7 +402,7 @@ if analysis_mode == "Single Session":
 
     # --- Load detailed data only for the selected session ---
     session_data = sessions_df[sessions_df['session_id'] == selected_session_id].iloc[0]
-    session_events, session_measurements = load_session_details(selected_session_id)
+    session_events, session_measurements = load_session_details(selected_session_id, db_token)
     
     # --- Single Taring Control (define early so it can be used in filters) ---
     include_taring_process = st.sidebar.checkbox("Include taring process", value=False,
@@ -531,6 +545,13 @@ if analysis_mode == "Single Session":
         fig.add_trace(go.Scatter(x=chart_measurements['timestamp_ms'], y=chart_measurements[flow_rate_col],
                                  mode='lines', name=f'Flow Rate ({smoothing_option})', line=dict(color='darkgreen', width=1)),
                       secondary_y=True)
+        # The firmware's own 200ms regression flow, replayed over the logged weights (needs the firmware math library)
+        firmware_flow = calculate_firmware_flow_series(chart_measurements, window_ms=200)
+        if 'flow_rate_fit_fw' in firmware_flow.columns:
+            fig.add_trace(go.Scatter(x=firmware_flow['timestamp_ms'], y=firmware_flow['flow_rate_fit_fw'],
+                                     mode='lines', name='Firmware Flow Fit (200ms)', visible='legendonly',
+                                     line=dict(color='seagreen', width=1, dash='dot')),
+                          secondary_y=True)
         if mode_name == 'WEIGHT':
             fig.add_hline(y=session_data['target_weight'], line_dash="dash", line_color="salmon",
                           annotation_text="Target (g)", annotation_position="bottom right", secondary_y=False)
@@ -972,27 +993,9 @@ else: # Multi-Session Analysis
             # Create tabs for different analysis focuses
             tab1, tab2, tab3 = st.tabs(["Grind Session Overview", "Predictive Phase Analysis", "Pulse Phase Analysis"])
             
-            # Load details for all selected sessions at once
-            multi_session_events, multi_session_measurements = load_all_details()
-            multi_session_events = multi_session_events[multi_session_events['session_id'].isin(analysis_df['session_id'])]
-            multi_session_measurements = multi_session_measurements[multi_session_measurements['session_id'].isin(analysis_df['session_id'])]
-
-            # Calculate grind time for each session
-            grind_times = []
-            for session_id in analysis_df['session_id']:
-                events = multi_session_events[multi_session_events['session_id'] == session_id]
-                predictive_start = events[events['phase_name'] == 'PREDICTIVE']
-                if not predictive_start.empty:
-                    start_time = predictive_start['timestamp_ms'].min()
-                    settling_phases = ['FINAL_SETTLING', 'PULSE_SETTLING', 'PRIME_SETTLING']
-                    last_settle = events[events['phase_name'].isin(settling_phases)]
-                    if not last_settle.empty:
-                        end_time = (last_settle['timestamp_ms'] + last_settle['duration_ms']).max()
-                        grind_times.append({'session_id': session_id, 'grind_time_s': (end_time - start_time) / 1000.0})
-
-            if grind_times:
-                grind_times_df = pd.DataFrame(grind_times)
-                analysis_df = pd.merge(analysis_df, grind_times_df, on='session_id', how='left')
+            # Load details for the selected sessions only; grind time comes from the metrics cache
+            multi_session_events = load_selected_events(
+                tuple(int(i) for i in analysis_df['session_id']), db_token)
 
             with tab1:
                 st.subheader("Overall Grind Performance Metrics")
@@ -1219,31 +1222,8 @@ else: # Multi-Session Analysis
                         for _, event in predictive_events.iterrows():
                             pulse_flow_rates[event['session_id']] = event['pulse_flow_rate']
                 
-                    # Calculate average flow rate over last 1500ms of predictive phase for each session
-                    avg_flow_rates_1500ms = {}
-                    for session_id in analysis_df['session_id']:
-                        # Get predictive event for this session
-                        pred_event = predictive_events[predictive_events['session_id'] == session_id]
-                        if not pred_event.empty:
-                            pred_start = pred_event['timestamp_ms'].iloc[0]
-                            pred_end = pred_start + pred_event['duration_ms'].iloc[0]
-                        
-                            # Get measurements for last 1500ms of predictive phase
-                            window_start = pred_end - 1500  # Last 1500ms
-                            session_measurements = multi_session_measurements[
-                                (multi_session_measurements['session_id'] == session_id) &
-                                (multi_session_measurements['timestamp_ms'] >= window_start) &
-                                (multi_session_measurements['timestamp_ms'] <= pred_end) &
-                                (multi_session_measurements['phase_name'] == 'PREDICTIVE')
-                            ]
-                            
-                            if not session_measurements.empty:
-                                avg_flow_rate = session_measurements['flow_rate_g_per_s'].mean()
-                                avg_flow_rates_1500ms[session_id] = avg_flow_rate
-                            else:
-                                avg_flow_rates_1500ms[session_id] = 0
-                        else:
-                            avg_flow_rates_1500ms[session_id] = 0
+                    # Average flow rate over the last 1500ms of the predictive phase, from the metrics cache
+                    avg_flow_rates_1500ms = analysis_df.set_index('session_id')['late_predictive_flow_g_per_s'].fillna(0).to_dict()
 
                     merged_pulses = pd.merge_asof(
                         pulse_executes, pulse_settles,
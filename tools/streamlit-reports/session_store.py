@@ -0,0 +1,243 @@
+"""
+Incremental per-session cache for the grind database
+
+grind_measurements holds one row per logged sample, so a report that re-reads it
+for every session slows down as the history grows. This module keeps, per session,
+what the reports need in a form that is cheap to load, and builds it only for
+sessions it has not seen yet:
+
+- session_metrics: derived figures the multi-session views used to recompute on
+  every run from all events and measurements (grind time, predictive and coasting
+  yield, late predictive flow, active flow statistics).
+- measurement_columns: the session's measurements as one typed array per column
+  (int32 / float32 / int8, little-endian blobs), with phase names dictionary
+  coded. A session loads in a handful of blob reads instead of a row scan.
+
+refresh() fills both for sessions missing from the cache or cached by an older
+STORE_VERSION. grinder-ble.py runs it after each export (incremental exports add
+only the new sessions) and the report runs it at start for databases written
+otherwise. Re-sent sessions are dropped from the cache by the exporter and
+rebuilt here. Writing needs only the standard library; loading returns pandas
+frames.
+"""
+import json
+import os
+import sqlite3
+import sys
+from array import array
+from typing import Dict, Iterable, List, Optional, Tuple
+
+# Bump when a metric or the column layout changes: every session is rebuilt once
+STORE_VERSION = 1
+
+# Measurement columns kept as arrays: (column, array typecode)
+MEASUREMENT_COLUMNS = [
+    ('sequence_id', 'i'),
+    ('timestamp_ms', 'i'),
+    ('weight_grams', 'f'),
+    ('weight_delta', 'f'),
+    ('flow_rate_g_per_s', 'f'),
+    ('motor_is_on', 'b'),
+    ('phase_id', 'b'),
+    ('motor_stop_target_weight', 'f'),
+    ('sample_timestamp_us', 'q'),
+]
+FIELD = {name: index for index, (name, _) in enumerate(MEASUREMENT_COLUMNS)}    # Row positions as queried
+MISSING_TIMESTAMP = -(1 << 63)      # sample_timestamp_us of sessions logged before it existed
+PHASE_COLUMN = 'phase_name'         # Stored as codes into session_metrics.phase_names
+
+SETTLING_PHASES = ('FINAL_SETTLING', 'PULSE_SETTLING', 'PRIME_SETTLING')
+LATE_FLOW_WINDOW_MS = 1500          # Predictive flow is averaged over its last 1.5 s
+
+CACHE_TABLES = ('session_metrics', 'measurement_columns')
+
+
+def ensure_schema(conn: sqlite3.Connection):
+    """Cache tables and the per-session indexes the reports and the exporter query by."""
+    conn.execute("""
+        CREATE TABLE IF NOT EXISTS session_metrics (
+            session_id INTEGER PRIMARY KEY,
+            store_version INTEGER,
+            measurement_count INTEGER,
+            event_count INTEGER,
+            grind_time_s REAL,
+            predictive_start_ms INTEGER,
+            predictive_end_ms INTEGER,
+            predictive_yield_g REAL,
+            coasting_yield_g REAL,
+            late_predictive_flow_g_per_s REAL,
+            mean_active_flow_g_per_s REAL,
+            max_active_flow_g_per_s REAL,
+            phase_names TEXT
+        )""")
+    conn.execute("""
+        CREATE TABLE IF NOT EXISTS measurement_columns (
+            session_id INTEGER,
+            column_name TEXT,
+            type_code TEXT,
+            data BLOB,
+            PRIMARY KEY (session_id, column_name)
+        ) WITHOUT ROWID""")
+    conn.execute("CREATE INDEX IF NOT EXISTS idx_events_session_time ON grind_events (session_id, timestamp_ms)")
+    conn.execute("CREATE INDEX IF NOT EXISTS idx_measurements_session_time ON grind_measurements (session_id, timestamp_ms)")
+    if _table_exists(conn, 'motor_edges'):
+        conn.execute("CREATE INDEX IF NOT EXISTS idx_motor_edges_session ON motor_edges (session_id, timestamp_us)")
+
+
+def invalidate(conn: sqlite3.Connection, session_ids: Iterable[int]):
+    """Drop cached data of sessions about to be replaced (incremental re-export)."""
+    rows = [(session_id,) for session_id in session_ids]
+    for table in CACHE_TABLES:
+        if _table_exists(conn, table):
+            conn.executemany(f"DELETE FROM {table} WHERE session_id = ?", rows)
+
+
+def refresh(conn: sqlite3.Connection) -> int:
+    """Build the cache for every session that lacks it; returns the number built."""
+    ensure_schema(conn)
+    pending = [row[0] for row in conn.execute("""
+        SELECT s.session_id FROM grind_sessions s
+        LEFT JOIN session_metrics m ON m.session_id = s.session_id
+        WHERE m.session_id IS NULL OR m.store_version != ?
+        ORDER BY s.session_id""", (STORE_VERSION,))]
+    for session_id in pending:
+        _build_session(conn, session_id)
+    conn.commit()
+    return len(pending)
+
+
+def database_token(db_path: str) -> Tuple[int, int]:
+    """Changes whenever the database file does: a cache key for report loaders."""
+    stat = os.stat(db_path)
+    return stat.st_mtime_ns, stat.st_size
+
+
+def _table_exists(conn: sqlite3.Connection, table: str) -> bool:
+    return conn.execute("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?", (table,)).fetchone() is not None
+
+
+def _build_session(conn: sqlite3.Connection, session_id: int):
+    # Databases from older exports may lack later columns; those read as NULL
+    present = {row[1] for row in conn.execute("PRAGMA table_info(grind_measurements)")}
+    fields = [name if name in present else 'NULL' for name, _ in MEASUREMENT_COLUMNS] + [PHASE_COLUMN]
+    measurements = conn.execute(
+        f"SELECT {', '.join(fields)} FROM grind_measurements WHERE session_id = ? ORDER BY timestamp_ms",
+        (session_id,)).fetchall()
+    events = conn.execute(
+        "SELECT phase_name, timestamp_ms, duration_ms, start_weight, end_weight FROM grind_events "
+        "WHERE session_id = ? ORDER BY timestamp_ms", (session_id,)).fetchall()
+
+    phase_names: List[str] = []
+    phase_codes: Dict[str, int] = {}
+    columns = {name: array(code) for name, code in MEASUREMENT_COLUMNS}
+    codes = array('h')
+    for row in measurements:
+        for (name, code), value in zip(MEASUREMENT_COLUMNS, row):
+            if value is None:
+                value = MISSING_TIMESTAMP if name == 'sample_timestamp_us' else 0
+            columns[name].append(int(value) if code in 'bhiq' else float(value))
+        phase = (row[-1] or '').strip()
+        if phase not in phase_codes:
+            phase_codes[phase] = len(phase_names)
+            phase_names.append(phase)
+        codes.append(phase_codes[phase])
+    columns[PHASE_COLUMN] = codes
+
+    metrics = _session_metrics(measurements, events)
+    conn.execute("DELETE FROM measurement_columns WHERE session_id = ?", (session_id,))
+    conn.executemany("INSERT INTO measurement_columns VALUES (?, ?, ?, ?)",
+                     [(session_id, name, values.typecode, _to_little_endian(values)) for name, values in columns.items()])
+    conn.execute("INSERT OR REPLACE INTO session_metrics VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?)",
+                 (session_id, STORE_VERSION, len(measurements), len(events), metrics['grind_time_s'],
+                  metrics['predictive_start_ms'], metrics['predictive_end_ms'], metrics['predictive_yield_g'],
+                  metrics['coasting_yield_g'], metrics['late_predictive_flow_g_per_s'],
+                  metrics['mean_active_flow_g_per_s'], metrics['max_active_flow_g_per_s'], json.dumps(phase_names)))
+
+
+def _session_metrics(measurements: List[tuple], events: List[tuple]) -> Dict[str, Optional[float]]:
+    """The per-session figures of the multi-session report, from one session's rows."""
+    metrics: Dict[str, Optional[float]] = dict.fromkeys([
+        'grind_time_s', 'predictive_start_ms', 'predictive_end_ms', 'predictive_yield_g', 'coasting_yield_g',
+        'late_predictive_flow_g_per_s', 'mean_active_flow_g_per_s', 'max_active_flow_g_per_s'])
+    events = [(name.strip() if name else '', start, duration, start_weight, end_weight)
+              for name, start, duration, start_weight, end_weight in events]
+
+    predictive = [event for event in events if event[0] == 'PREDICTIVE']
+    settles = [event for event in events if event[0] in SETTLING_PHASES]
+    if predictive:
+        _, start, duration, start_weight, end_weight = predictive[0]
+        end = start + duration
+        metrics['predictive_start_ms'] = start
+        metrics['predictive_end_ms'] = end
+        if settles:
+            last_end = max(event[1] + event[2] for event in settles)
+            metrics['grind_time_s'] = (last_end - start) / 1000.0
+        after = [event for event in settles if event[1] >= end]
+        if after:
+            first_settle_end_weight = after[0][4]
+            metrics['predictive_yield_g'] = first_settle_end_weight - start_weight
+            metrics['coasting_yield_g'] = first_settle_end_weight - end_weight
+
+        late = [row[FIELD['flow_rate_g_per_s']] for row in measurements
+                if (row[-1] or '').strip() == 'PREDICTIVE' and end - LATE_FLOW_WINDOW_MS <= row[FIELD['timestamp_ms']] <= end]
+        metrics['late_predictive_flow_g_per_s'] = sum(late) / len(late) if late else 0.0
+
+    flow, motor = FIELD['flow_rate_g_per_s'], FIELD['motor_is_on']
+    active = [row[flow] for row in measurements if row[flow] is not None and row[flow] > 0 and row[motor] == 1]
+    if active:
+        metrics['mean_active_flow_g_per_s'] = sum(active) / len(active)
+        metrics['max_active_flow_g_per_s'] = max(active)
+    return metrics
+
+
+def _to_little_endian(values: array) -> bytes:
+    if sys.byteorder != 'little':
+        values = array(values.typecode, values)
+        values.byteswap()
+    return values.tobytes()
+
+
+# === Loading (pandas) ===
+
+# grind_measurements column order, so cached frames match SELECT * ones
+MEASUREMENT_TABLE_ORDER = ['session_id', 'sequence_id', 'timestamp_ms', 'weight_grams', 'weight_delta',
+                           'flow_rate_g_per_s', 'motor_is_on', 'phase_id', PHASE_COLUMN, 'motor_stop_target_weight',
+                           'sample_timestamp_us']
+_NUMPY_TYPES = {'b': '<i1', 'h': '<i2', 'i': '<i4', 'q': '<i8', 'f': '<f4', 'd': '<f8'}
+
+
+def load_metrics(conn: sqlite3.Connection):
+    """session_metrics as a DataFrame (without the bookkeeping columns)."""
+    import pandas as pd
+    metrics = pd.read_sql_query("SELECT * FROM session_metrics", conn)
+    return metrics.drop(columns=['store_version', 'phase_names'])
+
+
+def load_measurements(conn: sqlite3.Connection, session_ids: Iterable[int]):
+    """Measurements of the given sessions from the column cache, ordered by session and time, with the
+    columns and names of grind_measurements. Sessions without a cache entry are left out."""
+    import numpy as np
+    import pandas as pd
+
+    frames = []
+    for session_id in session_ids:
+        row = conn.execute("SELECT phase_names FROM session_metrics WHERE session_id = ? AND store_version = ?",
+                           (int(session_id), STORE_VERSION)).fetchone()
+        if row is None:
+            continue
+        blobs = {name: (code, data) for name, code, data in conn.execute(
+            "SELECT column_name, type_code, data FROM measurement_columns WHERE session_id = ?", (int(session_id),))}
+        # Widened to pandas' default int64 / float64 so frames mix with SQL-read ones
+        frame = pd.DataFrame({name: np.frombuffer(data, dtype=_NUMPY_TYPES[code]).astype('int64' if code in 'bhiq' else 'float64')
+                              for name, (code, data) in blobs.items() if name != PHASE_COLUMN})
+        timestamps = frame['sample_timestamp_us']
+        if (timestamps == MISSING_TIMESTAMP).any():
+            frame['sample_timestamp_us'] = timestamps.where(timestamps != MISSING_TIMESTAMP).astype('float64')
+        phase_code, phase_data = blobs[PHASE_COLUMN]
+        frame[PHASE_COLUMN] = np.asarray(json.loads(row[0]), dtype=object)[
+            np.frombuffer(phase_data, dtype=_NUMPY_TYPES[phase_code])]
+        frame['session_id'] = int(session_id)
+        frames.append(frame[MEASUREMENT_TABLE_ORDER])
+    if not frames:
+        return pd.DataFrame(columns=MEASUREMENT_TABLE_ORDER)
+    return pd.concat(frames, ignore_index=True)
@@ -612,12 +612,14 @@ async function getDiagnosticReport() {
 
         // Set up notification handler
         await debugTxChar.startNotifications();
+        // Notifications are MTU-sized slices of the text: characters and the end marker may span two
+        const reportDecoder = new TextDecoder();
         debugTxChar.addEventListener('characteristicvaluechanged', (event) => {
-            const chunk = new TextDecoder().decode(event.target.value);
+            const chunk = reportDecoder.decode(event.target.value, { stream: true });
             reportChunks.push(chunk);
 
             // Check if report is complete
-            if (chunk.includes('=== END OF REPORT ===')) {
+            if (reportChunks.slice(-2).join('').includes('=== END OF REPORT ===')) {
                 reportComplete = true;
             }
         });